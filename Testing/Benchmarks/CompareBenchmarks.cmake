@@ -0,0 +1,179 @@
+#---------------------------------------------------------------------
+# Compares the latest benchmark run against a baseline. Called in script
+# mode by the benchmarkcompare target and the BenchmarkRegression test,
+# see CMakeLists.txt, with the variables:
+#   ResultFile:     the csv file written by RunBenchmarks.cmake
+#   BaselineFile:   a csv file in the same format, e.g. an older ResultFile
+#   Threshold:      the allowed change in percent
+#   ReportFile:     the file to which the comparison is written
+#   UpdateBaseline: replace the baseline by the latest run if it has no
+#                   regressions, optional
+#   Measurements:   print the results as CDash measurements, optional
+#
+# Of both files only the latest run, the rows with the date of the last
+# row, is used. A benchmark, i.e. a tool, dimension, size, component type
+# and number of threads, regresses if its throughput in voxels/s drops by
+# more than Threshold percent, or if its peak memory grows by more than
+# Threshold percent. Benchmarks that are missing from the baseline are
+# reported as new. Without a baseline file, the latest run becomes the
+# baseline. The script fails if a benchmark regresses.
+#---------------------------------------------------------------------
+
+# Empty columns, e.g. a missing peak memory, are list elements too
+cmake_policy( SET CMP0007 NEW )
+
+if( NOT EXISTS ${ResultFile} )
+  message( FATAL_ERROR "There are no benchmark results in ${ResultFile}, "
+    "run the benchmark target first." )
+endif()
+if( "${Threshold}" STREQUAL "" )
+  set( Threshold 10 )
+endif()
+
+# Convert a number with at most three decimals, e.g. the peak memory in MB,
+# to an integer number of thousandths, for math( EXPR )
+function( to_thousandths value result )
+  if( NOT "${value}" MATCHES "^([0-9]+)(\\.([0-9]*))?$" )
+    set( ${result} "" PARENT_SCOPE )
+    return()
+  endif()
+  set( whole ${CMAKE_MATCH_1} )
+  set( fraction "${CMAKE_MATCH_3}000" )
+  string( SUBSTRING ${fraction} 0 3 fraction )
+  string( REGEX REPLACE "^0+" "" fraction "${fraction}" )
+  if( "${fraction}" STREQUAL "" )
+    set( fraction 0 )
+  endif()
+  math( EXPR thousandths "${whole} * 1000 + ${fraction}" )
+  set( ${result} ${thousandths} PARENT_SCOPE )
+endfunction()
+
+# Read the latest run of a result file
+#  file: the csv file
+#  prefix: the variables are ${prefix}_Keys, the list of benchmarks, and
+#    ${prefix}_<key>_VoxelsPerSecond and ${prefix}_<key>_PeakMemory per
+#    benchmark; ${prefix}_Lines are the csv lines of the run
+macro( read_latest_run file prefix )
+  file( STRINGS ${file} lines REGEX "^[^,]+,[^,]+,[0-9]+," )
+  set( ${prefix}_Keys "" )
+  set( ${prefix}_Lines "" )
+  set( ${prefix}_Date "" )
+  list( LENGTH lines numberOfLines )
+  if( numberOfLines GREATER 0 )
+    list( GET lines -1 lastLine )
+    string( REGEX REPLACE ",.*" "" ${prefix}_Date "${lastLine}" )
+  endif()
+  foreach( line ${lines} )
+    string( REPLACE "," ";" fields "${line}" )
+    list( GET fields 0 date )
+    if( "${date}" STREQUAL "${${prefix}_Date}" )
+      list( GET fields 1 tool )
+      list( GET fields 2 dim )
+      list( GET fields 3 size )
+      list( GET fields 4 type )
+      list( GET fields 5 threads )
+      list( GET fields 8 vps )
+      list( LENGTH fields numberOfFields )
+      set( peak "" )
+      if( numberOfFields GREATER 10 )
+        list( GET fields 10 peak )
+      endif()
+      set( key "${tool}_${dim}D_${size}_${type}_${threads}t" )
+      list( APPEND ${prefix}_Keys ${key} )
+      list( APPEND ${prefix}_Lines "${line}" )
+      set( ${prefix}_${key}_VoxelsPerSecond "${vps}" )
+      set( ${prefix}_${key}_PeakMemory "${peak}" )
+    endif()
+  endforeach()
+endmacro()
+
+read_latest_run( ${ResultFile} Current )
+if( "${Current_Keys}" STREQUAL "" )
+  message( FATAL_ERROR "There are no benchmark results in ${ResultFile}, "
+    "run the benchmark target first." )
+endif()
+
+# CDash keeps the measurements of a test, which gives the history
+if( Measurements )
+  foreach( key ${Current_Keys} )
+    if( NOT "${Current_${key}_VoxelsPerSecond}" STREQUAL "" )
+      message( STATUS "<DartMeasurement name=\"${key} voxels/s\" type=\"numeric/integer\">"
+        "${Current_${key}_VoxelsPerSecond}</DartMeasurement>" )
+    endif()
+    if( NOT "${Current_${key}_PeakMemory}" STREQUAL "" )
+      message( STATUS "<DartMeasurement name=\"${key} MB\" type=\"numeric/double\">"
+        "${Current_${key}_PeakMemory}</DartMeasurement>" )
+    endif()
+  endforeach()
+endif()
+
+# Without a baseline, the latest run becomes the baseline
+file( STRINGS ${ResultFile} header LIMIT_COUNT 1 )
+if( NOT EXISTS ${BaselineFile} )
+  string( REPLACE ";" "\n" lines "${Current_Lines}" )
+  file( WRITE ${BaselineFile} "${header}\n${lines}\n" )
+  file( WRITE ${ReportFile}
+    "No benchmark baseline, the run of ${Current_Date} is the new baseline ${BaselineFile}\n" )
+  message( STATUS "No benchmark baseline, the run of ${Current_Date} "
+    "is the new baseline ${BaselineFile}" )
+  return()
+endif()
+read_latest_run( ${BaselineFile} Baseline )
+
+# Compare every benchmark of the latest run
+math( EXPR lowerPercentage "100 - ${Threshold}" )
+math( EXPR upperPercentage "100 + ${Threshold}" )
+set( report "Benchmark run of ${Current_Date} against the baseline of ${Baseline_Date}, threshold ${Threshold}%\n" )
+set( report "${report}benchmark,voxelsPerSecond,baselineVoxelsPerSecond,peakMemoryMB,baselinePeakMemoryMB,status\n" )
+set( regressions "" )
+foreach( key ${Current_Keys} )
+  set( vps ${Current_${key}_VoxelsPerSecond} )
+  set( peak ${Current_${key}_PeakMemory} )
+  set( baseVps "${Baseline_${key}_VoxelsPerSecond}" )
+  set( basePeak "${Baseline_${key}_PeakMemory}" )
+
+  set( status ok )
+  list( FIND Baseline_Keys ${key} index )
+  if( index EQUAL -1 )
+    set( status new )
+  else()
+    if( NOT "${vps}" STREQUAL "" AND NOT "${baseVps}" STREQUAL "" )
+      math( EXPR scaled "${vps} * 100" )
+      math( EXPR limit "${baseVps} * ${lowerPercentage}" )
+      if( scaled LESS limit )
+        set( status "slower" )
+      endif()
+    endif()
+    to_thousandths( "${peak}" peakThousandths )
+    to_thousandths( "${basePeak}" basePeakThousandths )
+    if( NOT "${peakThousandths}" STREQUAL "" AND NOT "${basePeakThousandths}" STREQUAL "" )
+      math( EXPR scaled "${peakThousandths} * 100" )
+      math( EXPR limit "${basePeakThousandths} * ${upperPercentage}" )
+      if( scaled GREATER limit )
+        if( status STREQUAL "ok" )
+          set( status "more memory" )
+        else()
+          set( status "slower and more memory" )
+        endif()
+      endif()
+    endif()
+    if( NOT status STREQUAL "ok" )
+      list( APPEND regressions "${key}: ${baseVps} -> ${vps} voxels/s, ${basePeak} -> ${peak} MB" )
+    endif()
+  endif()
+  set( report "${report}${key},${vps},${baseVps},${peak},${basePeak},${status}\n" )
+endforeach()
+file( WRITE ${ReportFile} "${report}" )
+message( STATUS "The benchmark comparison is written to ${ReportFile}" )
+
+if( NOT "${regressions}" STREQUAL "" )
+  string( REPLACE ";" "\n  " regressions "${regressions}" )
+  message( FATAL_ERROR "Benchmarks regressed by more than ${Threshold}%:\n  ${regressions}" )
+endif()
+message( STATUS "No benchmark regressed by more than ${Threshold}%" )
+
+if( UpdateBaseline )
+  string( REPLACE ";" "\n" lines "${Current_Lines}" )
+  file( WRITE ${BaselineFile} "${header}\n${lines}\n" )
+  message( STATUS "The run of ${Current_Date} is the new baseline ${BaselineFile}" )
+endif()
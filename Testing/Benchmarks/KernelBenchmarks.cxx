@@ -0,0 +1,211 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+/** \file
+ \brief Benchmark the hot loops of the tools on synthetic buffers.
+ */
+
+#include "itkCommandLineArgumentParser.h"
+#include "ITKToolsBase.h"
+#include "ITKToolsHelpers.h"
+#include "ITKToolsSIMD.h"
+#include "KernelBenchmarks.h"
+#include <iomanip>
+#include <sstream>
+#include <ctime>
+
+double g_KernelBenchmarkChecksum = 0.0;
+
+
+/**
+ * ******************* GetHelpString *******************
+ */
+
+std::string GetHelpString( void )
+{
+  std::stringstream ss;
+  ss << "ITKTools v" << itktools::GetITKToolsVersion() << "\n"
+    << "This program benchmarks the kernels of the tools on synthetic buffers:\n"
+    << "the functors of unary-, binary- and naryimageoperator, the vesselness and\n"
+    << "sheetness functors of enhancement, the parabolic line kernels of morphology\n"
+    << "and the co-occurrence matrix and features of texture.\n"
+    << "For every kernel, component type and dimension the fastest of several runs\n"
+    << "is reported in ns per voxel and GB/s, on a single thread.\n"
+    << "Usage:\n"
+    << "pxkernelbenchmark\n"
+    << "  [-dim]      the image dimensions, default 2 3\n"
+    << "  [-size]     the size along every axis per dimension, default 2048 160\n"
+    << "  [-time]     the minimum time per kernel in seconds, default 0.2\n"
+    << "  [-kernel]   only run the kernels whose name contains this text\n"
+    << "  [-out]      append the results to this csv file\n"
+    << "  [-affinity] the cores to run on, e.g. a single core for stable timings\n"
+    << "  [-simd]     the instruction set of the kernels that have variants,\n"
+    << "              one of auto, scalar, sse2, sse4.2, avx2, avx512, neon\n"
+    << "The results are also printed as csv to the standard output.";
+
+  return ss.str();
+
+} // end GetHelpString()
+
+
+/**
+ * ******************* PrintKernelBenchmarkHeader *******************
+ */
+
+void PrintKernelBenchmarkHeader( void )
+{
+  std::cout << "kernel,type,dimension,voxels,nsPerVoxel,GBPerSecond" << std::endl;
+
+} // end PrintKernelBenchmarkHeader()
+
+
+/**
+ * ******************* ReportKernelBenchmark *******************
+ */
+
+void ReportKernelBenchmark( const KernelBenchmarkSettings & settings,
+  const std::string & kernel, const std::string & type, unsigned int dim,
+  itk::SizeValueType elements, double bytesPerElement, double seconds )
+{
+  const double nsPerElement = 1.0e9 * seconds / static_cast<double>( elements );
+  const double gbPerSecond = static_cast<double>( elements ) * bytesPerElement / seconds / 1.0e9;
+
+  std::ostringstream line;
+  line << kernel << "," << type << "," << dim << "," << elements << ","
+    << std::fixed << std::setprecision( 3 ) << nsPerElement << ","
+    << std::setprecision( 3 ) << gbPerSecond;
+  std::cout << line.str() << std::endl;
+
+  if( settings.m_ResultFileName.empty() ) return;
+
+  /** Append to the result file, with the date, as RunBenchmarks.cmake does. */
+  std::ifstream existing( settings.m_ResultFileName.c_str() );
+  const bool writeHeader = !existing.good() || existing.peek() == std::ifstream::traits_type::eof();
+  existing.close();
+
+  std::ofstream results( settings.m_ResultFileName.c_str(), std::ios::app );
+  if( writeHeader )
+  {
+    results << "date,kernel,type,dimension,voxels,nsPerVoxel,GBPerSecond\n";
+  }
+  char date[ 32 ];
+  const std::time_t now = std::time( 0 );
+  std::strftime( date, sizeof( date ), "%Y-%m-%dT%H:%M:%S", std::localtime( &now ) );
+  results << date << "," << line.str() << "\n";
+
+} // end ReportKernelBenchmark()
+
+//-------------------------------------------------------------------------------------
+
+int main( int argc, char** argv )
+{
+  /** Create a command line argument parser. */
+  itk::CommandLineArgumentParser::Pointer parser = itk::CommandLineArgumentParser::New();
+  parser->SetCommandLineArguments( argc, argv );
+  parser->SetProgramHelpText( GetHelpString() );
+
+  itk::CommandLineArgumentParser::ReturnValue validateArguments = parser->CheckForRequiredArguments();
+
+  if( validateArguments == itk::CommandLineArgumentParser::FAILED )
+  {
+    return EXIT_FAILURE;
+  }
+  else if( validateArguments == itk::CommandLineArgumentParser::HELPREQUESTED )
+  {
+    return EXIT_SUCCESS;
+  }
+
+  /** Get arguments. */
+  /** The vectors are empty, the parser would otherwise broadcast a single
+   * value over the defaults. */
+  KernelBenchmarkSettings settings;
+  if( !parser->GetCommandLineArgument( "-dim", settings.m_Dimensions ) )
+  {
+    settings.m_Dimensions.push_back( 2 );
+    settings.m_Dimensions.push_back( 3 );
+  }
+
+  std::vector<unsigned int> sizes;
+  bool retsize = parser->GetCommandLineArgument( "-size", sizes );
+
+  settings.m_MinimumTime = 0.2;
+  parser->GetCommandLineArgument( "-time", settings.m_MinimumTime );
+
+  parser->GetCommandLineArgument( "-kernel", settings.m_Filter );
+  parser->GetCommandLineArgument( "-out", settings.m_ResultFileName );
+
+  /** Restrict the process to the given cores, and select the variants. */
+  itktools::ReadThreadingArguments( parser );
+  itktools::ReadSIMDArguments( parser );
+
+  /** Checks. The default sizes give about 4M voxels in 2D and 3D. */
+  for( unsigned int i = 0; i < settings.m_Dimensions.size(); ++i )
+  {
+    const unsigned int dim = settings.m_Dimensions[ i ];
+    if( dim != 2 && dim != 3 )
+    {
+      std::cerr << "ERROR: only dimensions 2 and 3 are supported, not " << dim << "." << std::endl;
+      return EXIT_FAILURE;
+    }
+    unsigned int size = dim == 2 ? 2048 : 160;
+    if( retsize )
+    {
+      size = sizes.size() == settings.m_Dimensions.size() ? sizes[ i ] : sizes[ 0 ];
+    }
+    if( size < 4 )
+    {
+      std::cerr << "ERROR: the size should be at least 4." << std::endl;
+      return EXIT_FAILURE;
+    }
+    settings.m_Sizes.push_back( size );
+  }
+  if( retsize && sizes.size() != 1 && sizes.size() != settings.m_Dimensions.size() )
+  {
+    std::cerr << "ERROR: give one size, or one size per dimension." << std::endl;
+    return EXIT_FAILURE;
+  }
+  if( settings.m_MinimumTime < 0.0 )
+  {
+    std::cerr << "ERROR: the minimum time should not be negative." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  /** Run the benchmarks. */
+  std::cerr << "simd: " << itktools::SIMD::GetReport() << std::endl;
+  PrintKernelBenchmarkHeader();
+  try
+  {
+    RunUnaryFunctorBenchmarks( settings );
+    RunBinaryFunctorBenchmarks( settings );
+    RunNaryFunctorBenchmarks( settings );
+    RunEnhancementFunctorBenchmarks( settings );
+    RunParabolicLineBenchmarks( settings );
+    RunCooccurrenceMatrixBenchmarks( settings );
+  }
+  catch( itk::ExceptionObject & excp )
+  {
+    std::cerr << "Caught ITK exception: " << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  /** Print the checksum of the outputs, see g_KernelBenchmarkChecksum. */
+  std::cerr << "checksum: " << g_KernelBenchmarkChecksum << std::endl;
+
+  /** End program. */
+  return EXIT_SUCCESS;
+
+} // end main()
@@ -0,0 +1,174 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __KernelBenchmarks_h_
+#define __KernelBenchmarks_h_
+
+#include "itkTimeProbe.h"
+#include "itkIntTypes.h"
+#include "itkNumericTraits.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/** \file
+ * The harness of pxkernelbenchmark: the settings, the timing loop, the
+ * synthetic inputs and the reporting shared by the kernel benchmarks.
+ *
+ * A kernel is an object with a void operator()( void ) that processes a
+ * fixed number of elements, usually voxels. It is run repeatedly until
+ * the minimum time has passed, and the fastest run is reported, as the
+ * time per element and the memory throughput of the elements read and
+ * written. The numbers are those of a single thread; restrict the
+ * process to one core with -affinity for stable numbers.
+ */
+
+/** The settings shared by all kernel benchmarks. */
+struct KernelBenchmarkSettings
+{
+  /** The image dimensions, and the size along every axis per dimension. */
+  std::vector<unsigned int> m_Dimensions;
+  std::vector<unsigned int> m_Sizes;
+
+  /** The minimum time in seconds that every kernel is run. */
+  double m_MinimumTime;
+
+  /** Only kernels with a name containing this text are run, if not empty. */
+  std::string m_Filter;
+
+  /** The csv file to which the results are appended, if not empty. */
+  std::string m_ResultFileName;
+
+  /** The number of voxels of an image of dimension dim. */
+  itk::SizeValueType GetNumberOfVoxels( unsigned int dim ) const
+  {
+    itk::SizeValueType n = 1;
+    for( unsigned int i = 0; i < dim; ++i ) n *= this->GetSize( dim );
+    return n;
+  }
+
+  /** The size along every axis of an image of dimension dim. */
+  unsigned int GetSize( unsigned int dim ) const
+  {
+    for( unsigned int i = 0; i < this->m_Dimensions.size(); ++i )
+    {
+      if( this->m_Dimensions[ i ] == dim ) return this->m_Sizes[ i ];
+    }
+    return 0;
+  }
+
+  /** Whether the kernel should be run. */
+  bool IsSelected( const std::string & kernel ) const
+  {
+    return this->m_Filter.empty() || kernel.find( this->m_Filter ) != std::string::npos;
+  }
+};
+
+
+/** The name of a component type in the results. */
+template< class T > struct KernelBenchmarkTypeName { static const char * Get( void ) { return "unknown"; } };
+template<> struct KernelBenchmarkTypeName<unsigned char> { static const char * Get( void ) { return "unsigned_char"; } };
+template<> struct KernelBenchmarkTypeName<short> { static const char * Get( void ) { return "short"; } };
+template<> struct KernelBenchmarkTypeName<unsigned short> { static const char * Get( void ) { return "unsigned_short"; } };
+template<> struct KernelBenchmarkTypeName<int> { static const char * Get( void ) { return "int"; } };
+template<> struct KernelBenchmarkTypeName<float> { static const char * Get( void ) { return "float"; } };
+template<> struct KernelBenchmarkTypeName<double> { static const char * Get( void ) { return "double"; } };
+
+
+/** The checksum of the outputs, printed at the end, so that the compiler
+ * cannot remove the work of a kernel whose output is not used otherwise. */
+extern double g_KernelBenchmarkChecksum;
+
+/** Add a buffer to the checksum. */
+template< class T >
+void AddToKernelBenchmarkChecksum( const T * buffer, itk::SizeValueType n )
+{
+  double sum = 0.0;
+  for( itk::SizeValueType i = 0; i < n; ++i )
+  {
+    sum += static_cast<double>( buffer[ i ] );
+  }
+  g_KernelBenchmarkChecksum += sum;
+}
+
+
+/** Fill a buffer with deterministic pseudo-random values in [low, high),
+ * from a hash of the seed and the position, see CounterBasedRandomImageSource. */
+template< class T >
+void FillSynthetic( T * buffer, itk::SizeValueType n,
+  double low, double high, unsigned long long seed = 0 )
+{
+  for( itk::SizeValueType i = 0; i < n; ++i )
+  {
+    unsigned long long z = seed * 0x9E3779B97F4A7C15ULL + ( i + 1 ) * 0xBF58476D1CE4E5B9ULL;
+    z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+    z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBULL;
+    z = z ^ ( z >> 31 );
+    const double u = static_cast<double>( z >> 11 ) * ( 1.0 / 9007199254740992.0 );
+    buffer[ i ] = static_cast<T>( low + ( high - low ) * u );
+  }
+}
+
+
+/** Run a kernel until the minimum time has passed, at least three times,
+ * and return the time in seconds of the fastest run. */
+template< class TKernel >
+double TimeKernel( TKernel & kernel, const KernelBenchmarkSettings & settings )
+{
+  /** Warm up the caches and the page tables. */
+  kernel();
+
+  double fastest = itk::NumericTraits<double>::max();
+  double total = 0.0;
+  unsigned int runs = 0;
+  while( runs < 3 || total < settings.m_MinimumTime )
+  {
+    itk::TimeProbe probe;
+    probe.Start();
+    kernel();
+    probe.Stop();
+    const double seconds = probe.GetTotal();
+    fastest = std::min( fastest, seconds );
+    total += seconds;
+    ++runs;
+  }
+  return fastest;
+
+} // end TimeKernel()
+
+
+/** Print the header of the results. */
+void PrintKernelBenchmarkHeader( void );
+
+/** Report the time of a kernel that processed the given number of
+ * elements, reading and writing bytesPerElement bytes per element. */
+void ReportKernelBenchmark( const KernelBenchmarkSettings & settings,
+  const std::string & kernel, const std::string & type, unsigned int dim,
+  itk::SizeValueType elements, double bytesPerElement, double seconds );
+
+
+/** The kernel benchmarks, one function per group of kernels. */
+void RunUnaryFunctorBenchmarks( const KernelBenchmarkSettings & settings );
+void RunBinaryFunctorBenchmarks( const KernelBenchmarkSettings & settings );
+void RunNaryFunctorBenchmarks( const KernelBenchmarkSettings & settings );
+void RunEnhancementFunctorBenchmarks( const KernelBenchmarkSettings & settings );
+void RunParabolicLineBenchmarks( const KernelBenchmarkSettings & settings );
+void RunCooccurrenceMatrixBenchmarks( const KernelBenchmarkSettings & settings );
+
+#endif // end #ifndef __KernelBenchmarks_h_
@@ -0,0 +1,136 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+/** \file
+ \brief Benchmarks of the functors of binaryimageoperator.
+ */
+
+#include "KernelBenchmarks.h"
+#include "itkBinaryFunctors.h"
+
+
+/** A per-voxel loop over two contiguous buffers. */
+template< class TFunctor, class TInput, class TOutput >
+class BinaryFunctorKernel
+{
+public:
+  BinaryFunctorKernel( const TFunctor & functor, const TInput * input1,
+    const TInput * input2, TOutput * output, itk::SizeValueType n )
+    : m_Functor( functor ), m_Input1( input1 ), m_Input2( input2 ),
+    m_Output( output ), m_N( n ) {}
+
+  void operator()( void )
+  {
+    for( itk::SizeValueType i = 0; i < this->m_N; ++i )
+    {
+      this->m_Output[ i ] = this->m_Functor( this->m_Input1[ i ], this->m_Input2[ i ] );
+    }
+  }
+
+private:
+  TFunctor            m_Functor;
+  const TInput *      m_Input1;
+  const TInput *      m_Input2;
+  TOutput *           m_Output;
+  itk::SizeValueType  m_N;
+};
+
+
+/**
+ * ******************* BenchmarkBinaryFunctor *******************
+ */
+
+template< class TPixel, class TFunctor >
+void BenchmarkBinaryFunctor( const KernelBenchmarkSettings & settings,
+  const std::string & name, const TFunctor & functor, unsigned int dim )
+{
+  const std::string kernel = "binary_" + name;
+  if( !settings.IsSelected( kernel ) ) return;
+
+  /** Inputs of at least 1, so that DIVIDE, POWER and LOG are finite. */
+  const itk::SizeValueType n = settings.GetNumberOfVoxels( dim );
+  std::vector<TPixel> input1( n );
+  std::vector<TPixel> input2( n );
+  std::vector<TPixel> output( n );
+  FillSynthetic( &input1[ 0 ], n, 2.0, 10.0, 1 );
+  FillSynthetic( &input2[ 0 ], n, 1.0, 4.0, 2 );
+
+  BinaryFunctorKernel<TFunctor, TPixel, TPixel> run( functor,
+    &input1[ 0 ], &input2[ 0 ], &output[ 0 ], n );
+  const double seconds = TimeKernel( run, settings );
+  AddToKernelBenchmarkChecksum( &output[ 0 ], n );
+
+  ReportKernelBenchmark( settings, kernel, KernelBenchmarkTypeName<TPixel>::Get(),
+    dim, n, 3.0 * sizeof( TPixel ), seconds );
+
+} // end BenchmarkBinaryFunctor()
+
+
+/** Benchmark a functor, with or without its argument. */
+#define BinaryFunctorBenchmarkMacro( name ) \
+  { \
+    itk::Functor::name< TPixel, TPixel, TPixel > functor; \
+    BenchmarkBinaryFunctor<TPixel>( settings, #name, functor, dim ); \
+  }
+#define BinaryFunctorWithArgumentBenchmarkMacro( name, argument ) \
+  { \
+    itk::Functor::name< TPixel, TPixel, TPixel > functor; \
+    functor.SetArgument( argument ); \
+    BenchmarkBinaryFunctor<TPixel>( settings, #name, functor, dim ); \
+  }
+
+
+/**
+ * ******************* RunBinaryFunctorBenchmarksForType *******************
+ */
+
+template< class TPixel >
+void RunBinaryFunctorBenchmarksForType( const KernelBenchmarkSettings & settings, unsigned int dim )
+{
+  BinaryFunctorBenchmarkMacro( ADDITION );
+  BinaryFunctorWithArgumentBenchmarkMacro( WEIGHTEDADDITION, 0.3 );
+  BinaryFunctorBenchmarkMacro( MINUS );
+  BinaryFunctorBenchmarkMacro( TIMES );
+  BinaryFunctorBenchmarkMacro( DIVIDE );
+  BinaryFunctorBenchmarkMacro( POWER );
+  BinaryFunctorBenchmarkMacro( MAXIMUM );
+  BinaryFunctorBenchmarkMacro( MINIMUM );
+  BinaryFunctorBenchmarkMacro( ABSOLUTEDIFFERENCE );
+  BinaryFunctorBenchmarkMacro( SQUAREDDIFFERENCE );
+  BinaryFunctorBenchmarkMacro( BINARYMAGNITUDE );
+  BinaryFunctorWithArgumentBenchmarkMacro( MASK, 0.0 );
+  BinaryFunctorWithArgumentBenchmarkMacro( MASKNEGATED, 0.0 );
+  BinaryFunctorBenchmarkMacro( LOG );
+
+} // end RunBinaryFunctorBenchmarksForType()
+
+
+/**
+ * ******************* RunBinaryFunctorBenchmarks *******************
+ */
+
+void RunBinaryFunctorBenchmarks( const KernelBenchmarkSettings & settings )
+{
+  for( unsigned int i = 0; i < settings.m_Dimensions.size(); ++i )
+  {
+    const unsigned int dim = settings.m_Dimensions[ i ];
+    RunBinaryFunctorBenchmarksForType<short>( settings, dim );
+    RunBinaryFunctorBenchmarksForType<float>( settings, dim );
+    RunBinaryFunctorBenchmarksForType<double>( settings, dim );
+  }
+
+} // end RunBinaryFunctorBenchmarks()
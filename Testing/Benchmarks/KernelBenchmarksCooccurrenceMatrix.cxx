@@ -0,0 +1,198 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+/** \file
+ \brief Benchmarks of the co-occurrence matrix kernels of texture.
+ */
+
+#include "KernelBenchmarks.h"
+#include "itkHistogram.h"
+#include "itkDenseFrequencyContainer2.h"
+#include "itkGrayLevelCooccurrenceMatrixTextureCoefficientsCalculator.h"
+#include <sstream>
+
+
+/** The accumulation of the co-occurrence matrix of an image of bins over
+ * the offsets of a neighborhood of radius 1, both combinations per pair,
+ * as in TextureImageToImageFilter::UpdateMatrixFromBins. The border of the
+ * image is skipped, instead of checking every pair. */
+class CooccurrenceMatrixKernel
+{
+public:
+  CooccurrenceMatrixKernel( const unsigned char * binImage, unsigned int dim,
+    unsigned int size, unsigned int bins, std::vector<unsigned int> & matrix )
+    : m_BinImage( binImage ), m_Dimension( dim ), m_Size( size ),
+    m_Bins( bins ), m_Matrix( matrix )
+  {
+    /** The offsets with a positive first nonzero component: 4 in 2D, 13 in 3D. */
+    const long strides[ 3 ] = { 1, static_cast<long>( size ),
+      static_cast<long>( size ) * static_cast<long>( size ) };
+    const int numberOfNeighbours = dim == 2 ? 9 : 27;
+    for( int k = 0; k < numberOfNeighbours; ++k )
+    {
+      const int component[ 3 ] = { k % 3 - 1, ( k / 3 ) % 3 - 1, k / 9 - 1 };
+      long offset = 0;
+      int firstNonZero = 0;
+      for( int i = static_cast<int>( dim ) - 1; i >= 0; --i )
+      {
+        offset += component[ i ] * strides[ i ];
+        if( component[ i ] != 0 && firstNonZero == 0 ) firstNonZero = component[ i ];
+      }
+      if( firstNonZero > 0 ) this->m_Offsets.push_back( offset );
+    }
+  }
+
+  unsigned int GetNumberOfOffsets( void ) const { return this->m_Offsets.size(); }
+
+  void operator()( void )
+  {
+    std::fill( this->m_Matrix.begin(), this->m_Matrix.end(), 0 );
+    const unsigned int bins = this->m_Bins;
+    const unsigned int numberOfOffsets = this->m_Offsets.size();
+    const long size = this->m_Size;
+    const long zBegin = this->m_Dimension == 3 ? 1 : 0;
+    const long zEnd = this->m_Dimension == 3 ? size - 1 : 1;
+    for( long z = zBegin; z < zEnd; ++z )
+    {
+      for( long y = 1; y < size - 1; ++y )
+      {
+        const long lineStart = z * size * size + y * size;
+        for( long x = 1; x < size - 1; ++x )
+        {
+          const long center = lineStart + x;
+          const unsigned int centerBin = this->m_BinImage[ center ];
+          for( unsigned int k = 0; k < numberOfOffsets; ++k )
+          {
+            const unsigned int bin = this->m_BinImage[ center + this->m_Offsets[ k ] ];
+            this->m_Matrix[ centerBin + bin * bins ] += 1;
+            this->m_Matrix[ bin + centerBin * bins ] += 1;
+          }
+        }
+      }
+    }
+  }
+
+private:
+  const unsigned char *       m_BinImage;
+  unsigned int                m_Dimension;
+  unsigned int                m_Size;
+  unsigned int                m_Bins;
+  std::vector<unsigned int> & m_Matrix;
+  std::vector<long>           m_Offsets;
+};
+
+
+/** The computation of all texture features from a dense co-occurrence
+ * matrix, as done for every voxel by TextureImageToImageFilter. */
+template< class TCalculator >
+class TextureFeaturesKernel
+{
+public:
+  TextureFeaturesKernel( TCalculator * calculator, const std::vector<unsigned int> & matrix,
+    unsigned int bins, unsigned int repetitions )
+    : m_Calculator( calculator ), m_Matrix( matrix ), m_Bins( bins ),
+    m_Repetitions( repetitions ), m_Sum( 0.0 )
+  {
+    for( unsigned int k = 0; k < 8; ++k ) this->m_Features.push_back( k );
+  }
+
+  double GetSum( void ) const { return this->m_Sum; }
+
+  void operator()( void )
+  {
+    for( unsigned int r = 0; r < this->m_Repetitions; ++r )
+    {
+      this->m_Calculator->ComputeFromMatrix( &this->m_Matrix[ 0 ], this->m_Bins, this->m_Features );
+      this->m_Sum += this->m_Calculator->GetEnergy();
+    }
+  }
+
+private:
+  TCalculator *                     m_Calculator;
+  const std::vector<unsigned int> & m_Matrix;
+  unsigned int                      m_Bins;
+  unsigned int                      m_Repetitions;
+  std::vector<unsigned int>         m_Features;
+  double                            m_Sum;
+};
+
+
+/**
+ * ******************* RunCooccurrenceMatrixBenchmarks *******************
+ */
+
+void RunCooccurrenceMatrixBenchmarks( const KernelBenchmarkSettings & settings )
+{
+  typedef itk::Statistics::Histogram< double,
+    itk::Statistics::DenseFrequencyContainer2 >             HistogramType;
+  typedef itk::Statistics::GrayLevelCooccurrenceMatrixTextureCoefficientsCalculator<
+    HistogramType >                                         CalculatorType;
+
+  /** The numbers of bins; 64 is the default of pxtexture. */
+  std::vector<unsigned int> binCounts;
+  binCounts.push_back( 16 );
+  binCounts.push_back( 32 );
+  binCounts.push_back( 64 );
+
+  for( unsigned int i = 0; i < settings.m_Dimensions.size(); ++i )
+  {
+    const unsigned int dim = settings.m_Dimensions[ i ];
+    const unsigned int size = settings.GetSize( dim );
+    const itk::SizeValueType n = settings.GetNumberOfVoxels( dim );
+    std::vector<unsigned char> binImage( n );
+
+    for( unsigned int b = 0; b < binCounts.size(); ++b )
+    {
+      const unsigned int bins = binCounts[ b ];
+      FillSynthetic( &binImage[ 0 ], n, 0.0, bins );
+      std::vector<unsigned int> matrix( bins * bins, 0 );
+
+      /** The accumulation, per interior voxel. */
+      CooccurrenceMatrixKernel accumulate( &binImage[ 0 ], dim, size, bins, matrix );
+      std::ostringstream kernel;
+      kernel << "texture_cooccurrence_bins" << bins;
+      if( settings.IsSelected( kernel.str() ) )
+      {
+        const double seconds = TimeKernel( accumulate, settings );
+        AddToKernelBenchmarkChecksum( &matrix[ 0 ], matrix.size() );
+
+        itk::SizeValueType interior = 1;
+        for( unsigned int d = 0; d < dim; ++d ) interior *= size - 2;
+        ReportKernelBenchmark( settings, kernel.str(), "unsigned_char",
+          dim, interior, 1.0, seconds );
+      }
+
+      /** The features, per matrix cell, from the matrix of this image. */
+      kernel.str( "" );
+      kernel << "texture_features_bins" << bins;
+      if( !settings.IsSelected( kernel.str() ) ) continue;
+
+      accumulate();
+      CalculatorType::Pointer calculator = CalculatorType::New();
+      const unsigned int cells = bins * bins;
+      const unsigned int repetitions = std::max( 1u, ( 1u << 20 ) / cells );
+      TextureFeaturesKernel<CalculatorType> features( calculator, matrix, bins, repetitions );
+      const double seconds = TimeKernel( features, settings );
+      g_KernelBenchmarkChecksum += features.GetSum();
+
+      ReportKernelBenchmark( settings, kernel.str(), "unsigned_int",
+        dim, static_cast<itk::SizeValueType>( repetitions ) * cells,
+        sizeof( unsigned int ), seconds );
+    }
+  }
+
+} // end RunCooccurrenceMatrixBenchmarks()
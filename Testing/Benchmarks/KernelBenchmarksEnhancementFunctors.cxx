@@ -0,0 +1,191 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+/** \file
+ \brief Benchmarks of the vesselness and sheetness functors of enhancement.
+ */
+
+#include "KernelBenchmarks.h"
+#include "itkFixedArray.h"
+#include "itkFrangiVesselnessFunctor.h"
+#include "itkFrangiSheetnessFunctor.h"
+#include "itkDescoteauxSheetnessFunctor.h"
+#include "itkModifiedKrissianVesselnessFunctor.h"
+#include "itkStrainEnergyVesselnessFunctor.h"
+#include "itkStrainEnergySheetnessFunctor.h"
+#include "itkFrangiXiaoSheetnessFunctor.h"
+#include "itkDescoteauxXiaoSheetnessFunctor.h"
+
+
+/** A loop over the lines of an image of eigenvalues, with one
+ * EvaluateRange() call per line, as in UnaryFunctorImageFilter2. */
+template< class TFunctor, class TInput, class TOutput >
+class EigenValueFunctorKernel
+{
+public:
+  EigenValueFunctorKernel( const TFunctor * functor, const TInput * input,
+    TOutput * output, itk::SizeValueType n, itk::SizeValueType lineLength )
+    : m_Functor( functor ), m_Input( input ), m_Output( output ),
+    m_N( n ), m_LineLength( lineLength ) {}
+
+  void operator()( void )
+  {
+    for( itk::SizeValueType i = 0; i < this->m_N; i += this->m_LineLength )
+    {
+      this->m_Functor->EvaluateRange( this->m_Input + i, this->m_Output + i, this->m_LineLength );
+    }
+  }
+
+private:
+  const TFunctor *    m_Functor;
+  const TInput *      m_Input;
+  TOutput *           m_Output;
+  itk::SizeValueType  m_N;
+  itk::SizeValueType  m_LineLength;
+};
+
+
+/** The same, for the functors that also take the gradient magnitude,
+ * as in BinaryFunctorImageFilter2. */
+template< class TFunctor, class TInput1, class TInput2, class TOutput >
+class GradientEigenValueFunctorKernel
+{
+public:
+  GradientEigenValueFunctorKernel( const TFunctor * functor, const TInput1 * input1,
+    const TInput2 * input2, TOutput * output, itk::SizeValueType n,
+    itk::SizeValueType lineLength )
+    : m_Functor( functor ), m_Input1( input1 ), m_Input2( input2 ),
+    m_Output( output ), m_N( n ), m_LineLength( lineLength ) {}
+
+  void operator()( void )
+  {
+    for( itk::SizeValueType i = 0; i < this->m_N; i += this->m_LineLength )
+    {
+      this->m_Functor->EvaluateRange( this->m_Input1 + i, this->m_Input2 + i,
+        this->m_Output + i, this->m_LineLength );
+    }
+  }
+
+private:
+  const TFunctor *    m_Functor;
+  const TInput1 *     m_Input1;
+  const TInput2 *     m_Input2;
+  TOutput *           m_Output;
+  itk::SizeValueType  m_N;
+  itk::SizeValueType  m_LineLength;
+};
+
+
+/**
+ * ******************* RunEnhancementFunctorBenchmarksForType *******************
+ */
+
+template< class TReal >
+void RunEnhancementFunctorBenchmarksForType( const KernelBenchmarkSettings & settings )
+{
+  /** The functors need three eigenvalues, so only 3D is benchmarked. */
+  const unsigned int dim = 3;
+  if( settings.GetSize( dim ) == 0 ) return;
+
+  typedef itk::FixedArray< TReal, 3 >                       EigenValueArrayType;
+  typedef itk::Functor::UnaryFunctorBase<
+    EigenValueArrayType, TReal >                            UnaryFunctorType;
+  typedef itk::Functor::BinaryFunctorBase<
+    TReal, EigenValueArrayType, TReal >                     BinaryFunctorType;
+
+  /** The functors, with their default parameters. */
+  std::vector< std::string > unaryNames;
+  std::vector< typename UnaryFunctorType::Pointer > unaryFunctors;
+  unaryNames.push_back( "FrangiVesselness" );
+  unaryFunctors.push_back( itk::Functor::FrangiVesselnessFunctor<
+    EigenValueArrayType, TReal >::New().GetPointer() );
+  unaryNames.push_back( "FrangiSheetness" );
+  unaryFunctors.push_back( itk::Functor::FrangiSheetnessFunctor<
+    EigenValueArrayType, TReal >::New().GetPointer() );
+  unaryNames.push_back( "DescoteauxSheetness" );
+  unaryFunctors.push_back( itk::Functor::DescoteauxSheetnessFunctor<
+    EigenValueArrayType, TReal >::New().GetPointer() );
+  unaryNames.push_back( "ModifiedKrissianVesselness" );
+  unaryFunctors.push_back( itk::Functor::ModifiedKrissianVesselnessFunctor<
+    EigenValueArrayType, TReal >::New().GetPointer() );
+
+  std::vector< std::string > binaryNames;
+  std::vector< typename BinaryFunctorType::Pointer > binaryFunctors;
+  binaryNames.push_back( "StrainEnergyVesselness" );
+  binaryFunctors.push_back( itk::Functor::StrainEnergyVesselnessFunctor<
+    TReal, EigenValueArrayType, TReal >::New().GetPointer() );
+  binaryNames.push_back( "StrainEnergySheetness" );
+  binaryFunctors.push_back( itk::Functor::StrainEnergySheetnessFunctor<
+    TReal, EigenValueArrayType, TReal >::New().GetPointer() );
+  binaryNames.push_back( "FrangiXiaoSheetness" );
+  binaryFunctors.push_back( itk::Functor::FrangiXiaoSheetnessFunctor<
+    TReal, EigenValueArrayType, TReal >::New().GetPointer() );
+  binaryNames.push_back( "DescoteauxXiaoSheetness" );
+  binaryFunctors.push_back( itk::Functor::DescoteauxXiaoSheetnessFunctor<
+    TReal, EigenValueArrayType, TReal >::New().GetPointer() );
+
+  /** Synthetic eigenvalues of both signs, and gradient magnitudes. */
+  const itk::SizeValueType n = settings.GetNumberOfVoxels( dim );
+  const itk::SizeValueType lineLength = settings.GetSize( dim );
+  std::vector< EigenValueArrayType > eigenValues( n );
+  std::vector< TReal > gradientMagnitudes( n );
+  std::vector< TReal > output( n );
+  FillSynthetic( eigenValues[ 0 ].GetDataPointer(), 3 * n, -100.0, 100.0, 1 );
+  FillSynthetic( &gradientMagnitudes[ 0 ], n, 0.0, 100.0, 2 );
+
+  for( unsigned int k = 0; k < unaryFunctors.size(); ++k )
+  {
+    const std::string kernel = "enhancement_" + unaryNames[ k ];
+    if( !settings.IsSelected( kernel ) ) continue;
+
+    EigenValueFunctorKernel< UnaryFunctorType, EigenValueArrayType, TReal > run(
+      unaryFunctors[ k ].GetPointer(), &eigenValues[ 0 ], &output[ 0 ], n, lineLength );
+    const double seconds = TimeKernel( run, settings );
+    AddToKernelBenchmarkChecksum( &output[ 0 ], n );
+
+    ReportKernelBenchmark( settings, kernel, KernelBenchmarkTypeName<TReal>::Get(),
+      dim, n, 4.0 * sizeof( TReal ), seconds );
+  }
+
+  for( unsigned int k = 0; k < binaryFunctors.size(); ++k )
+  {
+    const std::string kernel = "enhancement_" + binaryNames[ k ];
+    if( !settings.IsSelected( kernel ) ) continue;
+
+    GradientEigenValueFunctorKernel< BinaryFunctorType, TReal, EigenValueArrayType, TReal > run(
+      binaryFunctors[ k ].GetPointer(), &gradientMagnitudes[ 0 ], &eigenValues[ 0 ],
+      &output[ 0 ], n, lineLength );
+    const double seconds = TimeKernel( run, settings );
+    AddToKernelBenchmarkChecksum( &output[ 0 ], n );
+
+    ReportKernelBenchmark( settings, kernel, KernelBenchmarkTypeName<TReal>::Get(),
+      dim, n, 5.0 * sizeof( TReal ), seconds );
+  }
+
+} // end RunEnhancementFunctorBenchmarksForType()
+
+
+/**
+ * ******************* RunEnhancementFunctorBenchmarks *******************
+ */
+
+void RunEnhancementFunctorBenchmarks( const KernelBenchmarkSettings & settings )
+{
+  RunEnhancementFunctorBenchmarksForType<float>( settings );
+  RunEnhancementFunctorBenchmarksForType<double>( settings );
+
+} // end RunEnhancementFunctorBenchmarks()
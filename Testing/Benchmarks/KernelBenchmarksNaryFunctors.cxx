@@ -0,0 +1,134 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+/** \file
+ \brief Benchmarks of the functors of naryimageoperator.
+ */
+
+#include "KernelBenchmarks.h"
+#include "itkNaryFunctors.h"
+
+
+/** A per-voxel loop over several contiguous buffers. The values of a voxel
+ * are gathered in a vector, as in NaryFunctorImageFilter. */
+template< class TFunctor, class TInput, class TOutput >
+class NaryFunctorKernel
+{
+public:
+  NaryFunctorKernel( const TFunctor & functor,
+    const std::vector< const TInput * > & inputs,
+    TOutput * output, itk::SizeValueType n )
+    : m_Functor( functor ), m_Inputs( inputs ), m_Output( output ), m_N( n ) {}
+
+  void operator()( void )
+  {
+    const unsigned int numberOfInputs = this->m_Inputs.size();
+    std::vector< TInput > values( numberOfInputs );
+    for( itk::SizeValueType i = 0; i < this->m_N; ++i )
+    {
+      for( unsigned int k = 0; k < numberOfInputs; ++k )
+      {
+        values[ k ] = this->m_Inputs[ k ][ i ];
+      }
+      this->m_Output[ i ] = this->m_Functor( values );
+    }
+  }
+
+private:
+  TFunctor                      m_Functor;
+  std::vector< const TInput * > m_Inputs;
+  TOutput *                     m_Output;
+  itk::SizeValueType            m_N;
+};
+
+
+/**
+ * ******************* BenchmarkNaryFunctor *******************
+ */
+
+template< class TPixel, class TFunctor >
+void BenchmarkNaryFunctor( const KernelBenchmarkSettings & settings,
+  const std::string & name, const TFunctor & functor, unsigned int dim )
+{
+  const std::string kernel = "nary_" + name;
+  if( !settings.IsSelected( kernel ) ) return;
+
+  /** Four inputs of at least 1, so that NaryDIVIDE is finite. */
+  const unsigned int numberOfInputs = 4;
+  const itk::SizeValueType n = settings.GetNumberOfVoxels( dim );
+  std::vector< std::vector<TPixel> > inputs( numberOfInputs, std::vector<TPixel>( n ) );
+  std::vector< const TPixel * > inputPointers( numberOfInputs );
+  for( unsigned int k = 0; k < numberOfInputs; ++k )
+  {
+    FillSynthetic( &inputs[ k ][ 0 ], n, 1.0, 10.0, k );
+    inputPointers[ k ] = &inputs[ k ][ 0 ];
+  }
+  std::vector<TPixel> output( n );
+
+  NaryFunctorKernel<TFunctor, TPixel, TPixel> run( functor, inputPointers, &output[ 0 ], n );
+  const double seconds = TimeKernel( run, settings );
+  AddToKernelBenchmarkChecksum( &output[ 0 ], n );
+
+  ReportKernelBenchmark( settings, kernel, KernelBenchmarkTypeName<TPixel>::Get(),
+    dim, n, ( numberOfInputs + 1.0 ) * sizeof( TPixel ), seconds );
+
+} // end BenchmarkNaryFunctor()
+
+
+/** Benchmark a functor. */
+#define NaryFunctorBenchmarkMacro( name ) \
+  { \
+    itk::Functor::name< TPixel, TPixel > functor; \
+    BenchmarkNaryFunctor<TPixel>( settings, #name, functor, dim ); \
+  }
+
+
+/**
+ * ******************* RunNaryFunctorBenchmarksForType *******************
+ */
+
+template< class TPixel >
+void RunNaryFunctorBenchmarksForType( const KernelBenchmarkSettings & settings, unsigned int dim )
+{
+  NaryFunctorBenchmarkMacro( NaryADDITION );
+  NaryFunctorBenchmarkMacro( NaryMEAN );
+  NaryFunctorBenchmarkMacro( NaryMINUS );
+  NaryFunctorBenchmarkMacro( NaryTIMES );
+  NaryFunctorBenchmarkMacro( NaryDIVIDE );
+  NaryFunctorBenchmarkMacro( NaryMAXIMUM );
+  NaryFunctorBenchmarkMacro( NaryMINIMUM );
+  NaryFunctorBenchmarkMacro( NaryABSOLUTEDIFFERENCE );
+  NaryFunctorBenchmarkMacro( NaryNARYMAGNITUDE );
+
+} // end RunNaryFunctorBenchmarksForType()
+
+
+/**
+ * ******************* RunNaryFunctorBenchmarks *******************
+ */
+
+void RunNaryFunctorBenchmarks( const KernelBenchmarkSettings & settings )
+{
+  for( unsigned int i = 0; i < settings.m_Dimensions.size(); ++i )
+  {
+    const unsigned int dim = settings.m_Dimensions[ i ];
+    RunNaryFunctorBenchmarksForType<short>( settings, dim );
+    RunNaryFunctorBenchmarksForType<float>( settings, dim );
+    RunNaryFunctorBenchmarksForType<double>( settings, dim );
+  }
+
+} // end RunNaryFunctorBenchmarks()
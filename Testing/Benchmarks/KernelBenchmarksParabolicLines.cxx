@@ -0,0 +1,135 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+/** \file
+ \brief Benchmarks of the parabolic line kernels of morphology.
+ */
+
+#include "KernelBenchmarks.h"
+#include "itkParabolicMorphUtils.h"
+#include <sstream>
+
+
+/** The lines along one direction of an image are copied to a line buffer,
+ * processed by DoLine, and copied back, as in doOneDimension. The lines
+ * along x are contiguous, the others are strided. */
+template< class TReal, bool doDilate >
+class ParabolicLineKernel
+{
+public:
+  typedef itk::Array< TReal > LineBufferType;
+
+  ParabolicLineKernel( TReal * image, unsigned int dim, unsigned int size,
+    unsigned int direction, TReal magnitude )
+    : m_Image( image ), m_Dimension( dim ), m_Size( size ),
+    m_Direction( direction ), m_Magnitude( magnitude ),
+    m_LineBuffer( size ), m_TmpLineBuffer( size )
+  {
+    this->m_Extreme = doDilate
+      ? itk::NumericTraits< TReal >::NonpositiveMin()
+      : itk::NumericTraits< TReal >::max();
+  }
+
+  void operator()( void )
+  {
+    /** The stride of the lines, and the outer stride of the line starts. */
+    itk::SizeValueType stride = 1;
+    for( unsigned int i = 0; i < this->m_Direction; ++i ) stride *= this->m_Size;
+    const itk::SizeValueType outerStride = stride * this->m_Size;
+    itk::SizeValueType numberOfVoxels = 1;
+    for( unsigned int i = 0; i < this->m_Dimension; ++i ) numberOfVoxels *= this->m_Size;
+
+    for( itk::SizeValueType outer = 0; outer < numberOfVoxels; outer += outerStride )
+    {
+      for( itk::SizeValueType inner = 0; inner < stride; ++inner )
+      {
+        TReal * line = this->m_Image + outer + inner;
+        for( unsigned int pos = 0; pos < this->m_Size; ++pos )
+        {
+          this->m_LineBuffer[ pos ] = line[ pos * stride ];
+        }
+        itk::DoLine< LineBufferType, TReal, doDilate >(
+          this->m_LineBuffer, this->m_TmpLineBuffer, this->m_Magnitude, this->m_Extreme );
+        for( unsigned int pos = 0; pos < this->m_Size; ++pos )
+        {
+          line[ pos * stride ] = this->m_LineBuffer[ pos ];
+        }
+      }
+    }
+  }
+
+private:
+  TReal *         m_Image;
+  unsigned int    m_Dimension;
+  unsigned int    m_Size;
+  unsigned int    m_Direction;
+  TReal           m_Magnitude;
+  TReal           m_Extreme;
+  LineBufferType  m_LineBuffer;
+  LineBufferType  m_TmpLineBuffer;
+};
+
+
+/**
+ * ******************* BenchmarkParabolicLines *******************
+ */
+
+template< class TReal, bool doDilate >
+void BenchmarkParabolicLines( const KernelBenchmarkSettings & settings, unsigned int dim )
+{
+  /** The magnitude of a scale of 2, 1 / ( 2 * scale ); the work of DoLine
+   * grows with the scale and the contrast. The image is processed in place,
+   * so it is refilled before every direction. */
+  const TReal magnitude = ( doDilate ? 1.0 : -1.0 ) / ( 2.0 * 2.0 );
+  const unsigned int size = settings.GetSize( dim );
+  const itk::SizeValueType n = settings.GetNumberOfVoxels( dim );
+  std::vector< TReal > image( n );
+
+  for( unsigned int direction = 0; direction < dim; ++direction )
+  {
+    std::ostringstream kernel;
+    kernel << "parabolic_" << ( doDilate ? "dilate" : "erode" ) << "_direction" << direction;
+    if( !settings.IsSelected( kernel.str() ) ) continue;
+
+    FillSynthetic( &image[ 0 ], n, 0.0, 100.0 );
+    ParabolicLineKernel< TReal, doDilate > run( &image[ 0 ], dim, size, direction, magnitude );
+    const double seconds = TimeKernel( run, settings );
+    AddToKernelBenchmarkChecksum( &image[ 0 ], n );
+
+    ReportKernelBenchmark( settings, kernel.str(), KernelBenchmarkTypeName<TReal>::Get(),
+      dim, n, 2.0 * sizeof( TReal ), seconds );
+  }
+
+} // end BenchmarkParabolicLines()
+
+
+/**
+ * ******************* RunParabolicLineBenchmarks *******************
+ */
+
+void RunParabolicLineBenchmarks( const KernelBenchmarkSettings & settings )
+{
+  for( unsigned int i = 0; i < settings.m_Dimensions.size(); ++i )
+  {
+    const unsigned int dim = settings.m_Dimensions[ i ];
+    BenchmarkParabolicLines< float, true >( settings, dim );
+    BenchmarkParabolicLines< float, false >( settings, dim );
+    BenchmarkParabolicLines< double, true >( settings, dim );
+    BenchmarkParabolicLines< double, false >( settings, dim );
+  }
+
+} // end RunParabolicLineBenchmarks()
@@ -0,0 +1,171 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+/** \file
+ \brief Benchmarks of the functors of unaryimageoperator.
+ */
+
+#include "KernelBenchmarks.h"
+#include "itkUnaryFunctors.h"
+#include "ITKToolsSIMD.h"
+
+
+/** The per-voxel loop of ScanlineUnaryFunctorImageFilter over a contiguous
+ * buffer, in its variant for the instruction set selected with -simd. */
+template< class TFunctor, class TInput, class TOutput >
+class UnaryFunctorKernel
+{
+public:
+  typedef void (*RunFunctionType)( TFunctor &,
+    const TInput *, TOutput *, const itk::SizeValueType );
+
+  UnaryFunctorKernel( const TFunctor & functor, const TInput * input,
+    TOutput * output, itk::SizeValueType n )
+    : m_Functor( functor ), m_Input( input ), m_Output( output ), m_N( n )
+  {
+    itktools::SIMDDispatch< RunFunctionType > dispatch(
+      &itk::ScanlineUnaryFunctorRun< TFunctor, TInput, TOutput > );
+#ifdef ITKTOOLS_SIMD_TARGETS
+    dispatch.Set( itktools::SIMDAVX2,
+      &itk::ScanlineUnaryFunctorRunAVX2< TFunctor, TInput, TOutput > );
+    dispatch.Set( itktools::SIMDAVX512,
+      &itk::ScanlineUnaryFunctorRunAVX512< TFunctor, TInput, TOutput > );
+#endif
+    this->m_Run = dispatch.Get();
+  }
+
+  void operator()( void )
+  {
+    this->m_Run( this->m_Functor, this->m_Input, this->m_Output, this->m_N );
+  }
+
+private:
+  RunFunctionType     m_Run;
+  TFunctor            m_Functor;
+  const TInput *      m_Input;
+  TOutput *           m_Output;
+  itk::SizeValueType  m_N;
+};
+
+
+/**
+ * ******************* BenchmarkUnaryFunctor *******************
+ */
+
+template< class TPixel, class TFunctor >
+void BenchmarkUnaryFunctor( const KernelBenchmarkSettings & settings,
+  const std::string & name, const TFunctor & functor,
+  unsigned int dim, double low, double high )
+{
+  const std::string kernel = "unary_" + name;
+  if( !settings.IsSelected( kernel ) ) return;
+
+  const itk::SizeValueType n = settings.GetNumberOfVoxels( dim );
+  std::vector<TPixel> input( n );
+  std::vector<TPixel> output( n );
+  FillSynthetic( &input[ 0 ], n, low, high );
+
+  UnaryFunctorKernel<TFunctor, TPixel, TPixel> run( functor, &input[ 0 ], &output[ 0 ], n );
+  const double seconds = TimeKernel( run, settings );
+  AddToKernelBenchmarkChecksum( &output[ 0 ], n );
+
+  ReportKernelBenchmark( settings, kernel, KernelBenchmarkTypeName<TPixel>::Get(),
+    dim, n, 2.0 * sizeof( TPixel ), seconds );
+
+} // end BenchmarkUnaryFunctor()
+
+
+/** Benchmark a functor, with or without its argument, on inputs in
+ * [low, high); the ranges keep the divisions and logarithms finite. */
+#define UnaryFunctorBenchmarkMacro( name, low, high ) \
+  { \
+    itk::Functor::name< TPixel > functor; \
+    BenchmarkUnaryFunctor<TPixel>( settings, #name, functor, dim, low, high ); \
+  }
+#define UnaryFunctorWithArgumentBenchmarkMacro( name, argument, low, high ) \
+  { \
+    itk::Functor::name< TPixel > functor; \
+    functor.SetArgument( static_cast<TPixel>( argument ) ); \
+    BenchmarkUnaryFunctor<TPixel>( settings, #name, functor, dim, low, high ); \
+  }
+
+
+/**
+ * ******************* RunUnaryFunctorBenchmarksForType *******************
+ */
+
+template< class TPixel >
+void RunUnaryFunctorBenchmarksForType( const KernelBenchmarkSettings & settings, unsigned int dim )
+{
+  UnaryFunctorWithArgumentBenchmarkMacro( PLUS, 3, 1.0, 100.0 );
+  UnaryFunctorWithArgumentBenchmarkMacro( RMINUS, 3, 1.0, 100.0 );
+  UnaryFunctorWithArgumentBenchmarkMacro( LMINUS, 3, 1.0, 100.0 );
+  UnaryFunctorWithArgumentBenchmarkMacro( TIMES, 3, 1.0, 100.0 );
+  UnaryFunctorWithArgumentBenchmarkMacro( RDIVIDE, 3, 1.0, 100.0 );
+  UnaryFunctorWithArgumentBenchmarkMacro( LDIVIDE, 3, 1.0, 100.0 );
+  UnaryFunctorWithArgumentBenchmarkMacro( RMODINT, 3, 1.0, 100.0 );
+  UnaryFunctorWithArgumentBenchmarkMacro( RMODDOUBLE, 3, 1.0, 100.0 );
+  UnaryFunctorWithArgumentBenchmarkMacro( LMODINT, 3, 1.0, 100.0 );
+  UnaryFunctorWithArgumentBenchmarkMacro( LMODDOUBLE, 3, 1.0, 100.0 );
+  UnaryFunctorWithArgumentBenchmarkMacro( NLOG, 3, 1.0, 100.0 );
+  UnaryFunctorWithArgumentBenchmarkMacro( EQUAL, 3, 1.0, 100.0 );
+  UnaryFunctorWithArgumentBenchmarkMacro( RPOWER, 2, 1.0, 100.0 );
+  UnaryFunctorWithArgumentBenchmarkMacro( LPOWER, 2, 1.0, 10.0 );
+  UnaryFunctorBenchmarkMacro( NEG, 1.0, 100.0 );
+  UnaryFunctorBenchmarkMacro( SIGNINT, -100.0, 100.0 );
+  UnaryFunctorBenchmarkMacro( SIGNDOUBLE, -100.0, 100.0 );
+  UnaryFunctorBenchmarkMacro( ABSINT, -100.0, 100.0 );
+  UnaryFunctorBenchmarkMacro( ABSDOUBLE, -100.0, 100.0 );
+  UnaryFunctorBenchmarkMacro( FLOOR, -100.0, 100.0 );
+  UnaryFunctorBenchmarkMacro( CEIL, -100.0, 100.0 );
+  UnaryFunctorBenchmarkMacro( ROUND, -100.0, 100.0 );
+  UnaryFunctorBenchmarkMacro( SQR, -100.0, 100.0 );
+  UnaryFunctorBenchmarkMacro( SQRT, 1.0, 100.0 );
+  UnaryFunctorBenchmarkMacro( LN, 1.0, 100.0 );
+  UnaryFunctorBenchmarkMacro( LOG10, 1.0, 100.0 );
+  UnaryFunctorBenchmarkMacro( EXP, 0.0, 4.0 );
+  UnaryFunctorBenchmarkMacro( SIN, -100.0, 100.0 );
+  UnaryFunctorBenchmarkMacro( COS, -100.0, 100.0 );
+  UnaryFunctorBenchmarkMacro( TAN, -1.0, 1.0 );
+  UnaryFunctorBenchmarkMacro( ARCSIN, -1.0, 1.0 );
+  UnaryFunctorBenchmarkMacro( ARCCOS, -1.0, 1.0 );
+  UnaryFunctorBenchmarkMacro( ARCTAN, -100.0, 100.0 );
+
+  /** LINEAR has two arguments. */
+  itk::Functor::LINEAR< TPixel > linear;
+  linear.SetArgument1( static_cast<TPixel>( 2 ) );
+  linear.SetArgument2( static_cast<TPixel>( 3 ) );
+  BenchmarkUnaryFunctor<TPixel>( settings, "LINEAR", linear, dim, -100.0, 100.0 );
+
+} // end RunUnaryFunctorBenchmarksForType()
+
+
+/**
+ * ******************* RunUnaryFunctorBenchmarks *******************
+ */
+
+void RunUnaryFunctorBenchmarks( const KernelBenchmarkSettings & settings )
+{
+  for( unsigned int i = 0; i < settings.m_Dimensions.size(); ++i )
+  {
+    const unsigned int dim = settings.m_Dimensions[ i ];
+    RunUnaryFunctorBenchmarksForType<short>( settings, dim );
+    RunUnaryFunctorBenchmarksForType<float>( settings, dim );
+    RunUnaryFunctorBenchmarksForType<double>( settings, dim );
+  }
+
+} // end RunUnaryFunctorBenchmarks()
@@ -0,0 +1,191 @@
+#---------------------------------------------------------------------
+# Runs the ITKTools benchmarks. Called in script mode by the benchmark
+# target, see CMakeLists.txt, with the variables:
+#   ExeDir:         the directory with the px executables
+#   OutDir:         directory for the generated inputs and outputs
+#   Sizes, Dimensions, ComponentTypes, Threads, Tools:
+#                   comma separated lists, see CMakeLists.txt
+#   ResultFile:     the csv file to which the results are appended
+#
+# The wall time is taken from the "total" stage of -profile when the tool
+# supports it, and is measured in whole seconds otherwise; the column
+# "timer" says which. The peak memory in MB is taken from the same stage,
+# and is left empty without -profile. Failing runs are reported and skipped.
+# All rows of one run share the date, which CompareBenchmarks.cmake uses
+# to find the latest run.
+#---------------------------------------------------------------------
+
+foreach( var Sizes Dimensions ComponentTypes Threads Tools )
+  string( REPLACE "," ";" ${var} "${${var}}" )
+endforeach()
+
+file( MAKE_DIRECTORY ${OutDir} )
+set( header "date,tool,dimension,size,componentType,threads,voxels,wallTime,voxelsPerSecond,timer,peakMemoryMB" )
+if( EXISTS ${ResultFile} )
+  # Keep a result file with other columns aside, instead of mixing them
+  file( STRINGS ${ResultFile} oldHeader LIMIT_COUNT 1 )
+  if( NOT "${oldHeader}" STREQUAL "${header}" )
+    message( WARNING "The columns of ${ResultFile} changed, "
+      "the old results are moved to ${ResultFile}.old" )
+    file( RENAME ${ResultFile} ${ResultFile}.old )
+  endif()
+endif()
+if( NOT EXISTS ${ResultFile} )
+  file( WRITE ${ResultFile} "${header}\n" )
+endif()
+string( TIMESTAMP date "%Y-%m-%dT%H:%M:%S" )
+
+# Run a command that generates an input, fail on error
+function( generate_input )
+  execute_process( COMMAND ${ARGN}
+    RESULT_VARIABLE result OUTPUT_QUIET ERROR_VARIABLE error )
+  if( NOT result EQUAL 0 )
+    string( REPLACE ";" " " commandLine "${ARGN}" )
+    message( FATAL_ERROR "Generating a benchmark input failed:\n${commandLine}\n${error}" )
+  endif()
+endfunction()
+
+# Run and time a tool, and append the result to the result file
+#  tool: the tool name, without px
+#  dim, size, type: the input, used for reporting
+#  threads: the number of threads
+#  ARGN: the command line arguments of the tool
+function( run_benchmark tool dim size type threads )
+  list( FIND Tools ${tool} index )
+  if( index EQUAL -1 )
+    return()
+  endif()
+
+  set( profileFile ${OutDir}/profile.json )
+  file( REMOVE ${profileFile} )
+  string( TIMESTAMP start "%s" )
+  execute_process(
+    COMMAND ${ExeDir}/px${tool} ${ARGN} -threads ${threads} -profile ${profileFile}
+    RESULT_VARIABLE result OUTPUT_QUIET ERROR_VARIABLE error )
+  string( TIMESTAMP stop "%s" )
+  if( NOT result EQUAL 0 )
+    string( REPLACE ";" " " commandLine "${ARGN}" )
+    message( WARNING "Benchmark of px${tool} failed, skipped:\n${commandLine}\n${error}" )
+    return()
+  endif()
+
+  # Get the wall time in microseconds, and the peak memory
+  set( timer clock )
+  set( peakMemory "" )
+  math( EXPR microseconds "( ${stop} - ${start} ) * 1000000" )
+  if( EXISTS ${profileFile} )
+    file( READ ${profileFile} profile )
+    string( REGEX MATCH "\"total\", \"count\": [0-9]+, \"wallTime\": ([0-9]+)\\.([0-9]+)"
+      match "${profile}" )
+    if( match )
+      set( seconds ${CMAKE_MATCH_1} )
+      string( REGEX REPLACE "^0+" "" fraction "${CMAKE_MATCH_2}" )
+      if( "${fraction}" STREQUAL "" )
+        set( fraction 0 )
+      endif()
+      math( EXPR microseconds "${seconds} * 1000000 + ${fraction}" )
+      set( timer profile )
+    endif()
+    string( REGEX MATCH "\"total\", \"count\": [0-9]+, [^}]*\"peakMemoryMB\": ([0-9.]+)"
+      match "${profile}" )
+    if( match )
+      set( peakMemory ${CMAKE_MATCH_1} )
+    endif()
+  endif()
+
+  # Compute the throughput
+  set( voxels 1 )
+  foreach( d RANGE 1 ${dim} )
+    math( EXPR voxels "${voxels} * ${size}" )
+  endforeach()
+  set( voxelsPerSecond "" )
+  if( microseconds GREATER 0 )
+    math( EXPR voxelsPerSecond "${voxels} * 1000000 / ${microseconds}" )
+  endif()
+  math( EXPR seconds "${microseconds} / 1000000" )
+  math( EXPR fraction "${microseconds} % 1000000 + 1000000" )
+  string( SUBSTRING ${fraction} 1 6 fraction )
+  set( wallTime ${seconds}.${fraction} )
+
+  file( APPEND ${ResultFile}
+    "${date},${tool},${dim},${size},${type},${threads},${voxels},${wallTime},${voxelsPerSecond},${timer},${peakMemory}\n" )
+  message( STATUS "px${tool} ${dim}D size ${size} ${type}, ${threads} threads: "
+    "${wallTime} s, ${voxelsPerSecond} voxels/s, ${peakMemory} MB" )
+endfunction()
+
+
+foreach( dim ${Dimensions} )
+  foreach( size ${Sizes} )
+
+    # The size, center and radius arguments
+    set( sizeArgs "" )
+    set( centerArgs "" )
+    set( sizeFlags "" )
+    math( EXPR center "${size} / 2" )
+    math( EXPR lastDim "${dim} - 1" )
+    foreach( d RANGE 0 ${lastDim} )
+      list( APPEND sizeArgs ${size} )
+      list( APPEND centerArgs ${center} )
+      list( APPEND sizeFlags -d${d} ${size} )
+    endforeach()
+
+    # Binary inputs: three spheres with slightly different radii
+    set( spheres "" )
+    foreach( k 1 2 3 )
+      math( EXPR radius "${size} / 4 + ${k}" )
+      set( radiusArgs "" )
+      foreach( d RANGE 0 ${lastDim} )
+        list( APPEND radiusArgs ${radius} )
+      endforeach()
+      set( sphere ${OutDir}/sphere${dim}D_${size}_${k}.mhd )
+      generate_input( ${ExeDir}/pxcreatesphere -out ${sphere}
+        -sz ${sizeArgs} -c ${centerArgs} -r ${radiusArgs}
+        -dim ${dim} -opct unsigned_char )
+      list( APPEND spheres ${sphere} )
+    endforeach()
+    list( GET spheres 0 sphere )
+
+    foreach( threads ${Threads} )
+      run_benchmark( distancetransform ${dim} ${size} unsigned_char ${threads}
+        -in ${sphere} -out ${OutDir}/distancetransform.mhd -m Maurer )
+      run_benchmark( morphology ${dim} ${size} unsigned_char ${threads}
+        -in ${sphere} -out ${OutDir}/morphology.mhd
+        -op dilation -type binary -r 3 )
+      run_benchmark( combinesegmentations ${dim} ${size} unsigned_char ${threads}
+        -in ${spheres} -m STAPLE -outh ${OutDir}/combinesegmentations.mhd )
+    endforeach()
+
+    # Gray value inputs: two random images per component type
+    foreach( type ${ComponentTypes} )
+      set( randomImages "" )
+      foreach( seed 1 2 )
+        set( randomImage ${OutDir}/random${dim}D_${size}_${type}_${seed}.mhd )
+        generate_input( ${ExeDir}/pxcreaterandomimage -out ${randomImage}
+          -pt ${type} -id ${dim} ${sizeFlags} -seed ${seed} )
+        list( APPEND randomImages ${randomImage} )
+      endforeach()
+      list( GET randomImages 0 randomImage )
+
+      foreach( threads ${Threads} )
+        run_benchmark( enhancement ${dim} ${size} ${type} ${threads}
+          -in ${randomImage} -out ${OutDir}/enhancement.mhd
+          -std 1.0 -m FrangiVesselness )
+        run_benchmark( texture ${dim} ${size} ${type} ${threads}
+          -in ${randomImage} -out ${OutDir}/ -r 2 -b 32 )
+        run_benchmark( pca ${dim} ${size} ${type} ${threads}
+          -in ${randomImages} -out ${OutDir}/ )
+      endforeach()
+
+      file( REMOVE ${randomImages} )
+      string( REPLACE ".mhd" ".raw" randomRaws "${randomImages}" )
+      file( REMOVE ${randomRaws} )
+    endforeach()
+
+    file( REMOVE ${spheres} )
+    string( REPLACE ".mhd" ".raw" sphereRaws "${spheres}" )
+    file( REMOVE ${sphereRaws} )
+
+  endforeach()
+endforeach()
+
+message( STATUS "The benchmark results are appended to ${ResultFile}" )
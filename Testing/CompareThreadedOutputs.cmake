@@ -0,0 +1,71 @@
+#---------------------------------------------------------------------
+# Runs a tool with different numbers of threads and compares the results.
+# Called in script mode by the _THREADS tests, see CMakeLists.txt, with
+# the variables:
+#   Command:   the px executable
+#   Arguments: comma separated command line of the tool, without -threads
+#   Outputs:   comma separated files written by the tool, optional
+#   Threads:   comma separated numbers of threads, default 1,4
+#
+# Every run writes the same output files, so that the standard output,
+# which may contain their names, is comparable as well. The script fails
+# if a run fails, or if its standard output or one of its output files
+# differs from that of the first run, i.e. if the result depends on the
+# number of threads.
+#---------------------------------------------------------------------
+
+foreach( var Arguments Outputs Threads )
+  string( REPLACE "," ";" ${var} "${${var}}" )
+endforeach()
+if( "${Threads}" STREQUAL "" )
+  set( Threads 1 4 )
+endif()
+
+set( firstThreads "" )
+foreach( threads ${Threads} )
+  # A stale output of an earlier run should not pass for this run
+  foreach( output ${Outputs} )
+    file( REMOVE ${output} )
+  endforeach()
+
+  execute_process( COMMAND ${Command} ${Arguments} -threads ${threads}
+    RESULT_VARIABLE result OUTPUT_VARIABLE stdout ERROR_VARIABLE stderr )
+  if( NOT result EQUAL 0 )
+    message( FATAL_ERROR "${Command} failed with -threads ${threads}:\n"
+      "${stdout}${stderr}" )
+  endif()
+
+  set( hashes "" )
+  foreach( output ${Outputs} )
+    if( NOT EXISTS ${output} )
+      message( FATAL_ERROR "${Command} did not write ${output} "
+        "with -threads ${threads}." )
+    endif()
+    file( SHA256 ${output} hash )
+    list( APPEND hashes ${hash} )
+  endforeach()
+
+  if( "${firstThreads}" STREQUAL "" )
+    set( firstThreads ${threads} )
+    set( firstStdout "${stdout}" )
+    set( firstHashes "${hashes}" )
+  else()
+    if( NOT "${stdout}" STREQUAL "${firstStdout}" )
+      message( FATAL_ERROR "The output of ${Command} differs between "
+        "-threads ${firstThreads}:\n${firstStdout}\nand -threads ${threads}:\n${stdout}" )
+    endif()
+    set( index 0 )
+    foreach( output ${Outputs} )
+      list( GET hashes ${index} hash )
+      list( GET firstHashes ${index} firstHash )
+      if( NOT "${hash}" STREQUAL "${firstHash}" )
+        message( FATAL_ERROR "${output} differs between "
+          "-threads ${firstThreads} and -threads ${threads}." )
+      endif()
+      math( EXPR index "${index} + 1" )
+    endforeach()
+  endif()
+endforeach()
+
+string( REPLACE ";" ", " Threads "${Threads}" )
+message( STATUS "The results of ${Command} are equal with -threads ${Threads}." )
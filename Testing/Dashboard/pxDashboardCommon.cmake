@@ -31,6 +31,14 @@
 #   dashboard_do_coverage = True to enable coverage (ex: gcov)
 #   dashboard_do_memcheck = True to enable memcheck (ex: valgrind)
 #   dashboard_no_clean    = True to skip build tree wipeout
+#   dashboard_do_benchmark = True to run the benchmarks, see Testing/Benchmarks;
+#                           use a Release build on an otherwise idle machine
+#   dashboard_benchmark_directory = Where the benchmark results and the
+#                           baseline are kept, outside the wiped build tree
+#                           (default: CTEST_DASHBOARD_ROOT/Benchmarks)
+#   dashboard_benchmark_threshold = Regression threshold in percent (default: 10)
+#   dashboard_benchmark_update_baseline = True to replace the baseline by
+#                           every run without regressions
 #   CTEST_GIT_COMMAND     = path to git command-line client
 #   CTEST_BUILD_FLAGS     = build tool arguments (ex: -j2)
 #   CTEST_DASHBOARD_ROOT  = Where to put source and build trees
@@ -147,6 +155,37 @@ list( APPEND CTEST_NOTES_FILES
   "${CTEST_SCRIPT_DIRECTORY}/${CTEST_SCRIPT_NAME}"
   "${CMAKE_CURRENT_LIST_FILE}" )
 
+# The benchmarks are the tests Benchmark and BenchmarkRegression. Their
+# results are kept next to the build tree, so that they are compared
+# against the baseline of an earlier dashboard. The comparison is sent as
+# a note, and its numbers as measurements of BenchmarkRegression.
+if( dashboard_do_benchmark )
+  if( NOT DEFINED dashboard_benchmark_directory )
+    set( dashboard_benchmark_directory "${CTEST_DASHBOARD_ROOT}/Benchmarks" )
+  endif()
+  if( NOT DEFINED dashboard_benchmark_threshold )
+    set( dashboard_benchmark_threshold 10 )
+  endif()
+  if( dashboard_benchmark_update_baseline )
+    set( benchmark_update_baseline ON )
+  else()
+    set( benchmark_update_baseline OFF )
+  endif()
+  file( MAKE_DIRECTORY "${dashboard_benchmark_directory}" )
+  set( dashboard_cache "${dashboard_cache}
+// Benchmark settings
+ITKTOOLS_BUILD_TESTING:BOOL=ON
+ITKTOOLS_BUILD_BENCHMARKS:BOOL=ON
+ITKTOOLS_BENCHMARK_TESTS:BOOL=ON
+ITKTOOLS_BENCHMARK_RESULTS:FILEPATH=${dashboard_benchmark_directory}/results.csv
+ITKTOOLS_BENCHMARK_BASELINE:FILEPATH=${dashboard_benchmark_directory}/baseline.csv
+ITKTOOLS_BENCHMARK_THRESHOLD:STRING=${dashboard_benchmark_threshold}
+ITKTOOLS_BENCHMARK_UPDATE_BASELINE:BOOL=${benchmark_update_baseline}
+" )
+  list( APPEND CTEST_NOTES_FILES
+    "${CTEST_BINARY_DIRECTORY}/Benchmarks/comparison.csv" )
+endif()
+
 # Check for required variables.
 foreach( req
   CTEST_CMAKE_GENERATOR
@@ -176,6 +215,8 @@ foreach( v
   dashboard_git_url
   dashboard_git_branch
   dashboard_model
+  dashboard_do_benchmark
+  dashboard_benchmark_directory
   )
   set( vars "${vars}  ${v}=[${${v}}]\n" )
 endforeach()
@@ -263,7 +304,8 @@ else()
     ctest_coverage()
   endif()
   if( dashboard_do_memcheck )
-    ctest_memcheck()
+    # Running the benchmarks under valgrind is pointless
+    ctest_memcheck( EXCLUDE_LABEL Benchmark )
   endif()
   # Submit results, retry every 5 minutes for a maximum of two hours
   ctest_submit( RETRY_COUNT 24 RETRY_DELAY 300 )
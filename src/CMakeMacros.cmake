@@ -17,13 +17,74 @@ macro( ADD_ITKTOOL name )
   file( GLOB filelist RELATIVE ${CMAKE_CURRENT_SOURCE_DIR} * )
   list( REMOVE_ITEM filelist "CMakeLists.txt" )
 
-  # Create the executable
-  add_executable( px${name} ${filelist} )
+  if( ITKTOOLS_BUILD_MULTICALL )
+    # Create a library that is linked into the multi-call binary pxtools.
+    # The main() and GetHelpString() of every tool are renamed, since
+    # they would clash otherwise. pxtools runs the main() of a tool once
+    # for every job with --batch, see ITKToolsBatch.h.
+    add_library( px${name} STATIC ${filelist} )
+    set_target_properties( px${name} PROPERTIES COMPILE_DEFINITIONS
+      "main=px${name}_main;GetHelpString=px${name}_GetHelpString" )
+    set_property( GLOBAL APPEND PROPERTY ITKTOOLS_MULTICALL_TOOLS ${name} )
+
+    # Link
+    target_link_libraries( px${name} ${ITKTOOLS_LIBRARIES} ${ITK_LIBRARIES} )
+  else()
+    # Create the executable. Its main() is generated, and runs the renamed
+    # main() of the tool, once for every job with --batch, see ITKToolsBatch.h.
+    set( ITKTOOLS_TOOL_NAME ${name} )
+    set( mainSource ${CMAKE_CURRENT_BINARY_DIR}/px${name}_main.cxx )
+    configure_file( ${ITKTOOLS_SOURCE_DIR}/common/ITKToolsMain.cxx.in
+      ${mainSource} @ONLY )
+    set_source_files_properties( ${filelist} PROPERTIES COMPILE_DEFINITIONS
+      "main=px${name}_main" )
+    add_executable( px${name} ${filelist} ${mainSource} )
+
+    # Link
+    target_link_libraries( px${name} ${ITKTOOLS_LIBRARIES} ${ITK_LIBRARIES} )
+
+    # Install
+    install( TARGETS px${name}
+      RUNTIME DESTINATION ${ITKTOOLS_INSTALL_DIR} )
+  endif()
+endmacro()
+
+#---------------------------------------------------------------------
+# Macro to add a module of an ITKTool: a shared library with one
+# instantiation of its templated class, which the tool loads when its
+# input needs it, see common/ITKToolsModules.h. Call it after ADD_ITKTOOL.
+#  name:   the tool name
+#  header: the header in the tool directory that defines the class
+#  class:  the templated class, e.g. ITKToolsUnaryImageOperator
+#  base:   its untemplated base class, e.g. ITKToolsUnaryImageOperatorBase
+#  dim:    the dimension
+#  ARGN:   the component types as ITK names them, e.g. unsigned_char
+macro( ADD_ITKTOOL_MODULE name header class base dim )
+  set( moduleName px${name}-${dim}D )
+  set( ITKTOOLS_MODULE_ARGUMENTS ${dim} )
+  foreach( type ${ARGN} )
+    set( moduleName ${moduleName}-${type} )
+    string( REPLACE "_" " " cxxType ${type} )
+    set( ITKTOOLS_MODULE_ARGUMENTS "${ITKTOOLS_MODULE_ARGUMENTS}, ${cxxType}" )
+  endforeach()
+  set( ITKTOOLS_MODULE_HEADER ${CMAKE_CURRENT_SOURCE_DIR}/${header} )
+  set( ITKTOOLS_MODULE_CLASS ${class} )
+  set( ITKTOOLS_MODULE_BASE ${base} )
+
+  # Generate the source, and create the module
+  set( moduleSource ${CMAKE_CURRENT_BINARY_DIR}/${moduleName}.cxx )
+  configure_file( ${ITKTOOLS_SOURCE_DIR}/common/ITKToolsModule.cxx.in
+    ${moduleSource} @ONLY )
+  add_library( ${moduleName} MODULE ${moduleSource} )
+  set_target_properties( ${moduleName} PROPERTIES PREFIX "" )
 
   # Link
-  target_link_libraries( px${name} ${ITKTOOLS_LIBRARIES} ${ITK_LIBRARIES} )
+  target_link_libraries( ${moduleName} ${ITKTOOLS_LIBRARIES} ${ITK_LIBRARIES} )
+
+  # Building the tool builds its modules
+  add_dependencies( px${name} ${moduleName} )
 
   # Install
-  install( TARGETS px${name}
-    RUNTIME DESTINATION ${ITKTOOLS_INSTALL_DIR} )
+  install( TARGETS ${moduleName}
+    LIBRARY DESTINATION ${ITKTOOLS_INSTALL_DIR} )
 endmacro()
@@ -17,7 +17,7 @@
 *=========================================================================*/
 
 /** \file
- \brief Calculate the average magnitude of the vectors in a vector image.
+ \brief Calculate the average magnitude of the vectors in a set of vector images.
 
  \verbinclude averagevectormagnitude.help
  */
@@ -38,11 +38,17 @@ std::string GetHelpString( void )
 {
   std::stringstream ss;
   ss << "ITKTools v" << itktools::GetITKToolsVersion() << "\n"
-    << "Calculate the average magnitude of the vectors in a vector image.\n"
+    << "Calculate the average magnitude of the vectors in a set of vector images,\n"
+    << "for example of the deformation fields of a cohort.\n"
     << "Usage:\n"
     << "AverageVectorMagnitude\n"
-    << "  -in      InputVectorImageFileName\n"
-    << "  [-out]   OutputImageFileName]\n";
+    << "  -in      InputVectorImageFileNames\n"
+    << "  [-out]   OutputImageFileName\n"
+    << "The magnitudes of an input are added to a single float output, while the next\n"
+    << "input is read on a background thread. With one input the magnitude is computed.\n"
+    << "With -streams or -memoryLimit the images are processed in slabs along the last\n"
+    << "dimension, reading only one slab of every input at a time; this requires input\n"
+    << "and output formats that support streaming, like uncompressed mhd.\n";
 
   return ss.str();
 
@@ -59,9 +65,7 @@ int main( int argc, char** argv )
   parser->SetCommandLineArguments( argc, argv );
   parser->SetProgramHelpText( GetHelpString() );
 
-  parser->MarkArgumentAsRequired( "-in", "The input filename." );
-  parser->MarkArgumentAsRequired( "-id", "Image dimension." );
-  parser->MarkArgumentAsRequired( "-sd", "Space dimension." );
+  parser->MarkArgumentAsRequired( "-in", "The input filenames." );
 
   itk::CommandLineArgumentParser::ReturnValue validateArguments = parser->CheckForRequiredArguments();
 
@@ -75,10 +79,10 @@ int main( int argc, char** argv )
   }
 
   /** Get arguments. */
-  std::string inputFileName = "";
-  parser->GetCommandLineArgument( "-in", inputFileName );
+  std::vector<std::string> inputFileNames;
+  parser->GetCommandLineArgument( "-in", inputFileNames );
 
-  std::string outputFileName( inputFileName + "AverageVectorMagnitude.mhd" );
+  std::string outputFileName( inputFileNames[ 0 ] + "AverageVectorMagnitude.mhd" );
   parser->GetCommandLineArgument( "-out", outputFileName );
 
   /** Determine image properties. */
@@ -87,7 +91,7 @@ int main( int argc, char** argv )
   unsigned int dim = 0;
   unsigned int numberOfComponents = 0;
   bool retgip = itktools::GetImageProperties(
-    inputFileName, pixelType, componentType, dim, numberOfComponents );
+    inputFileNames[ 0 ], pixelType, componentType, dim, numberOfComponents );
   if( !retgip ) return EXIT_FAILURE;
 
   /** Class that does the work. */
@@ -108,9 +112,10 @@ int main( int argc, char** argv )
     if( !supported ) return EXIT_FAILURE;
 
     /** Set the filter arguments. */
-    filter->m_InputFileName = inputFileName;
+    filter->m_InputFileNames = inputFileNames;
     filter->m_OutputFileName = outputFileName;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
@@ -21,11 +21,11 @@
 
 #include "ITKToolsBase.h"
 
-#include "itkImageFileReader.h"
-#include "itkImageFileWriter.h"
-#include "itkVector.h"
 #include "itkImage.h"
-#include "itkGradientToMagnitudeImageFilter.h"
+#include "itkVector.h"
+#include "itkMultiThreader.h"
+#include <string>
+#include <vector>
 
 
 /** \class ITKToolsAverageVectorMagnitudeBase
@@ -40,20 +40,22 @@ public:
   /** Constructor. */
   ITKToolsAverageVectorMagnitudeBase()
   {
-    this->m_InputFileName = "";
     this->m_OutputFileName = "";
   }
   /** Destructor. */
   ~ITKToolsAverageVectorMagnitudeBase(){};
 
   /** Input member parameters */
-  std::string m_InputFileName;
+  std::vector<std::string> m_InputFileNames;
   std::string m_OutputFileName;
 
+  /** This tool supports streaming, by processing the images in slabs. */
+  virtual bool GetSupportsStreaming( void ) const { return true; }
+
 }; // end class ITKToolsAverageVectorMagnitudeBase
 
 
-/** \class ITKToolsUnaryImageOperator
+/** \class ITKToolsAverageVectorMagnitude
  *
  * Templated class that implements the Run() function
  * and the New() function for its creation.
@@ -82,39 +84,59 @@ public:
     return 0;
   }
 
+  /** Typedefs */
+  typedef itk::Vector< TComponentType, VVectorDimension >   InputPixelType;
+  typedef TComponentType                                    OutputPixelType;
+  typedef itk::Image< InputPixelType, VDimension >          InputImageType;
+  typedef itk::Image< OutputPixelType, VDimension >         OutputImageType;
+  typedef typename InputImageType::Pointer                  InputImagePointer;
+  typedef typename InputImageType::RegionType               RegionType;
+
   /** Run function. */
-  void Run( void )
-  {
-    // \todo: support vector images with any number of components
-    // probably by using VariableLebgthVector
+  void Run( void );
 
-    /** Typedefs */
-    typedef itk::Vector< TComponentType, VVectorDimension >   InputPixelType;
-    typedef TComponentType                                    OutputPixelType;
-    typedef itk::Image< InputPixelType, VDimension >          InputImageType;
-    typedef itk::Image< OutputPixelType, VDimension >         OutputImageType;
+protected:
 
-    typedef itk::ImageFileReader< InputImageType >            ReaderType;
-    typedef itk::GradientToMagnitudeImageFilter<
-      InputImageType, OutputImageType >                       FilterType;
-    typedef itk::ImageFileWriter< OutputImageType >           WriterType;
+  /** The arguments of the thread that reads the next input. */
+  struct ReadStruct
+  {
+    std::string       m_FileName;
+    RegionType        m_Region;
+    InputImagePointer m_Image;
+    std::string       m_ErrorMessage;
+  };
+
+  /** The arguments of the threads that accumulate the magnitudes of one input. */
+  struct AccumulateStruct
+  {
+    const InputPixelType * m_Input;
+    OutputPixelType *      m_Output;
+    double                 m_Weight;
+    std::size_t            m_NumberOfPixels;
+  };
 
-    /** Setup the pipeline */
-    typename ReaderType::Pointer reader = ReaderType::New();
-    reader->SetFileName( this->m_InputFileName );
+  /** Compute the average magnitude of one slab of the images. */
+  void ComputeSlab( const RegionType & region, const RegionType & slab,
+    OutputImageType * output );
 
-    typename FilterType::Pointer filter = FilterType::New();
-    filter->SetInput( reader->GetOutput() );
+  /** Write one slab of the output image. */
+  void WriteSlab( OutputImageType * image, const RegionType & slab,
+    const bool streaming );
 
-    typename WriterType::Pointer writer = WriterType::New();
-    writer->SetFileName( this->m_OutputFileName );
-    writer->SetInput( filter->GetOutput() );
-    writer->Update();
+  /** Read a region of an image, disconnected from its reader. */
+  static InputImagePointer ReadInputImage( const std::string & fileName,
+    const RegionType & region );
 
-  } // end Run()
+  /** The pixels of a slab in the buffer of an image. */
+  static const InputPixelType * GetSlabBuffer( const InputImageType * image,
+    const RegionType & slab );
+
+  /** Thread callbacks. */
+  static ITK_THREAD_RETURN_TYPE ReadThreaderCallback( void * arg );
+  static ITK_THREAD_RETURN_TYPE AccumulateThreaderCallback( void * arg );
 
 }; // end class ITKToolsAverageVectorMagnitude
 
+#include "averagevectormagnitude.hxx"
 
 #endif // end #ifndef __averagevectormagnitude_h_
-
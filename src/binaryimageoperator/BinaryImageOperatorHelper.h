@@ -57,6 +57,9 @@ public:
   bool m_UseCompression;
   std::string m_Arg;
 
+  /** This tool supports streaming. */
+  virtual bool GetSupportsStreaming( void ) const { return true; }
+
 }; // end class ITKToolsBinaryImageOperatorBase
 
 
@@ -89,7 +92,7 @@ public:
     typedef typename InputImage1Type::PixelType         InputPixel1Type;
     typedef typename InputImage2Type::PixelType         InputPixel2Type;
     typedef typename OutputImageType::PixelType         OutputPixelType;
-    typedef itk::ImageToImageFilter<InputImage1Type, OutputImageType> BaseFilterType;
+    typedef itk::InPlaceImageFilter<InputImage1Type, OutputImageType> BaseFilterType;
     typedef itk::ImageFileReader< InputImage1Type >     Reader1Type;
     typedef itk::ImageFileReader< InputImage2Type >     Reader2Type;
     typedef itk::ImageFileWriter< OutputImageType >     WriterType;
@@ -141,8 +144,10 @@ public:
     /** Read the input images. */
     typename Reader1Type::Pointer reader1 = Reader1Type::New();
     reader1->SetFileName( this->m_InputFileName1.c_str() );
+    itktools::SetCachedImageIOBase( reader1.GetPointer() );
     typename Reader2Type::Pointer reader2 = Reader2Type::New();
     reader2->SetFileName( this->m_InputFileName2.c_str() );
+    itktools::SetCachedImageIOBase( reader2.GetPointer() );
 
     /** Get the argument. */
     double argument = atof( this->m_Arg.c_str() );
@@ -230,12 +235,25 @@ public:
     binaryFilter->SetInput( 0, reader1->GetOutput() );
     binaryFilter->SetInput( 1, reader2->GetOutput() );
 
+    /** The output reuses the buffer of the first input, if it has the same
+     * type; the filter falls back to a new buffer otherwise. */
+    binaryFilter->InPlaceOn();
+    const bool inPlace
+      = dynamic_cast<OutputImageType *>( reader1->GetOutput() ) != 0;
+
     /** Write the image to disk */
     typename WriterType::Pointer writer = WriterType::New();
     writer->SetFileName( this->m_OutputFileName.c_str() );
     writer->SetInput( binaryFilter->GetOutput() );
     writer->SetUseCompression( this->m_UseCompression );
-    writer->Update();
+    this->SetStreamingOnWriter( writer.GetPointer(), sizeof( InputPixel2Type )
+      + ( inPlace ? 0 : sizeof( InputPixel1Type ) ) );
+
+    this->ObserveProcess( reader1.GetPointer(), "read input 1" );
+    this->ObserveProcess( reader2.GetPointer(), "read input 2" );
+    this->ObserveProcess( binaryFilter.GetPointer(), "binary operator" );
+    this->ObserveProcess( writer.GetPointer(), "write" );
+    this->UpdateWriter( writer.GetPointer() );
 
   } // end Run()
 
@@ -30,7 +30,7 @@
  * ******************* DetermineComponentTypes *******************
  */
 
-int DetermineComponentTypes(
+static int DetermineComponentTypes(
   const std::vector<std::string> & inputFileNames,
   itk::ImageIOBase::IOComponentType & componentType1,
   itk::ImageIOBase::IOComponentType & componentType2,
@@ -148,7 +148,7 @@ int DetermineComponentTypes(
  * ******************* CheckOperator *******************
  */
 
-int CheckOperator( std::string & operatoR )
+static int CheckOperator( std::string & operatoR )
 {
   if( operatoR == "ADDITION" || operatoR == "ADD" || operatoR == "PLUS" )
   {
@@ -245,7 +245,7 @@ int CheckOperator( std::string & operatoR )
  * ******************* OperatorNeedsArgument *******************
  */
 
-bool OperatorNeedsArgument( const std::string & operatoR )
+static bool OperatorNeedsArgument( const std::string & operatoR )
 {
   /** A map to store if OperatorNeedsArgument. */
   std::map< std::string, bool > operatorMap;
@@ -278,7 +278,7 @@ bool OperatorNeedsArgument( const std::string & operatoR )
  * ******************* CreateOutputFileName *******************
  */
 
-void CreateOutputFileName( const std::vector<std::string> & inputFileNames,
+static void CreateOutputFileName( const std::vector<std::string> & inputFileNames,
   std::string & outputFileName,
   const std::string & ops,
   const std::string & arg )
@@ -322,7 +322,7 @@ void CreateOutputFileName( const std::vector<std::string> & inputFileNames,
  * ******************* CheckOperatorAndArgument *******************
  */
 
-bool CheckOperatorAndArgument( const std::string & operatoR,
+static bool CheckOperatorAndArgument( const std::string & operatoR,
   const std::string & argument, const bool & retarg )
 {
   bool operatorNeedsArgument = OperatorNeedsArgument( operatoR );
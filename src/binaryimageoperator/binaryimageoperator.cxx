@@ -31,6 +31,7 @@
 
 #include "BinaryImageOperatorMainHelper.h"
 #include "BinaryImageOperatorHelper.h"
+#include "ITKToolsModules.h"
 
 
 /**
@@ -62,6 +63,9 @@ std::string GetHelpString( void )
     << "  [-z]     compression flag; if provided, the output image is compressed\n"
     << "  [-opct]  output component type, by default the largest of the two input images\n"
     << "           choose one of: {[unsigned_]{char,short,int,long},float,double}\n"
+    << "If the output component type equals that of the first input, the\n"
+    << "output is computed in place, in the buffer of the first input.\n"
+    << "With -memoryLimit or -streams the images are processed in pieces.\n"
     << "Supported: 2D, 3D, (unsigned) char, (unsigned) short, (unsigned) int, (unsigned) long, float, double.";
   return ss.str();
 
@@ -166,6 +170,11 @@ int main( int argc, char **argv )
 
   try
   {
+#ifdef ITKTOOLS_USE_MODULES
+    // only load the instantiation of this combination
+    filter = itktools::NewFromModule< ITKToolsBinaryImageOperatorBase >(
+      "binaryimageoperator", dim, inCType1, inCType2, outCType );
+#else
     // now call all possible template combinations.
     if( !filter ) filter = ITKToolsBinaryImageOperator< 2, long, long, char >::New( dim, inCType1, inCType2, outCType );
     if( !filter ) filter = ITKToolsBinaryImageOperator< 2, long, long, unsigned char >::New( dim, inCType1, inCType2, outCType );
@@ -190,6 +199,7 @@ int main( int argc, char **argv )
     if( !filter ) filter = ITKToolsBinaryImageOperator< 3, double, double, float >::New( dim, inCType1, inCType2, outCType );
     if( !filter ) filter = ITKToolsBinaryImageOperator< 3, double, double, double >::New( dim, inCType1, inCType2, outCType );
 #endif
+#endif // ITKTOOLS_USE_MODULES
     /** Check if filter was instantiated. */
     bool supported = itktools::IsFilterSupportedCheck( filter, dim, inCType1, inCType2, outCType );
     if( !supported ) return EXIT_FAILURE;
@@ -202,6 +212,7 @@ int main( int argc, char **argv )
     filter->m_UseCompression = useCompression;
     filter->m_Arg = argument;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
@@ -41,9 +41,14 @@ std::string GetHelpString( void )
     << "pxbinarythinning\n"
     << "-in      inputFilename\n"
     << "[-out]   outputFilename, default in + THINNED.mhd\n"
+    << "[-3d]    use the 3D thinning, only for 3D images\n"
+    << "[-threads] maximum number of threads\n"
     << "Supported: 2D, 3D, (unsigned) char, (unsigned) short, (unsigned) int, (unsigned) long, float, double.\n"
     << "Note that the thinning algorithm used here is really a 2D thinning algortihm.\n"
-    << "In 3D the thinning is performed slice by slice.";
+    << "In 3D the thinning is performed slice by slice, unless -3d is given.\n"
+    << "With -3d a topology preserving 3D thinning is used: the border voxels\n"
+    << "that are simple points and no end points are removed in parallel\n"
+    << "subfields, until the skeleton of curves and surfaces remains.";
   return ss.str();
 
 } // end GetHelpString()
@@ -69,6 +74,8 @@ int main( int argc, char ** argv )
   outputFileName += "THINNED.mhd";
   parser->GetCommandLineArgument( "-out", outputFileName );
 
+  const bool use3DThinning = parser->ArgumentExists( "-3d" );
+
   itk::CommandLineArgumentParser::ReturnValue validateArguments = parser->CheckForRequiredArguments();
 
   if( validateArguments == itk::CommandLineArgumentParser::FAILED )
@@ -93,6 +100,13 @@ int main( int argc, char ** argv )
   bool retNOCCheck = itktools::NumberOfComponentsCheck( numberOfComponents );
   if( !retNOCCheck ) return EXIT_FAILURE;
 
+  /** The 3D thinning only works on 3D images. */
+  if( use3DThinning && dim != 3 )
+  {
+    std::cerr << "ERROR: -3d is only supported for 3D images." << std::endl;
+    return EXIT_FAILURE;
+  }
+
   /** Class that does the work. */
   ITKToolsBinaryThinningBase * filter = 0;
 
@@ -130,7 +144,9 @@ int main( int argc, char ** argv )
     /** Set the filter arguments. */
     filter->m_InputFileName = inputFileName;
     filter->m_OutputFileName = outputFileName;
+    filter->m_Use3DThinning = use3DThinning;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
@@ -22,6 +22,7 @@
 
 #include "itkImageFileReader.h"
 #include "itkBinaryThinningImageFilter.h"
+#include "itkBinaryThinning3DImageFilter.h"
 #include "itkImageFileWriter.h"
 
 
@@ -39,6 +40,7 @@ public:
   {
     this->m_InputFileName = "";
     this->m_OutputFileName = "";
+    this->m_Use3DThinning = false;
   }
   /** Destructor. */
   ~ITKToolsBinaryThinningBase(){};
@@ -46,6 +48,7 @@ public:
   /** Input member parameters. */
   std::string m_InputFileName;
   std::string m_OutputFileName;
+  bool m_Use3DThinning;
 
 }; // end class ITKToolsBinaryThinningBase
 
@@ -75,20 +78,31 @@ public:
     typedef itk::ImageFileReader< InputImageType >        ReaderType;
     typedef itk::BinaryThinningImageFilter<
       InputImageType, InputImageType >                    FilterType;
+    typedef itk::BinaryThinning3DImageFilter<
+      InputImageType, InputImageType >                    Filter3DType;
     typedef itk::ImageFileWriter< InputImageType >        WriterType;
 
     /** Read in the input images. */
     typename ReaderType::Pointer reader = ReaderType::New();
     reader->SetFileName( this->m_InputFileName );
 
-    /** Thin the image. */
-    typename FilterType::Pointer filter = FilterType::New();
-    filter->SetInput( reader->GetOutput() );
-
     /** Write image. */
     typename WriterType::Pointer writer = WriterType::New();
     writer->SetFileName( this->m_OutputFileName );
-    writer->SetInput( filter->GetOutput() );
+
+    /** Thin the image. */
+    if( VDimension == 3 && this->m_Use3DThinning )
+    {
+      typename Filter3DType::Pointer filter = Filter3DType::New();
+      filter->SetInput( reader->GetOutput() );
+      writer->SetInput( filter->GetOutput() );
+    }
+    else
+    {
+      typename FilterType::Pointer filter = FilterType::New();
+      filter->SetInput( reader->GetOutput() );
+      writer->SetInput( filter->GetOutput() );
+    }
     writer->Update();
 
   } // end Run()
@@ -0,0 +1,148 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkBinaryThinning3DImageFilter_h_
+#define __itkBinaryThinning3DImageFilter_h_
+
+#include "itkImageToImageFilter.h"
+#include "itkMultiThreader.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/** \class BinaryThinning3DImageFilter
+ * \brief Topology preserving thinning of a 3D binary image.
+ *
+ * The object (the nonzero voxels, 26-connected) is peeled in directional
+ * sub-iterations, one for each of the six face directions. In a
+ * sub-iteration a voxel is deleted if its neighbor in that direction is
+ * background, if it is not the end point of a curve (it has more than
+ * one object neighbor), and if it is a simple point: deleting it changes
+ * neither the 26-connected components of the object nor the 6-connected
+ * components of the background in its 3x3x3 neighborhood. This is tested
+ * with the topological numbers, using tables of the adjacencies within
+ * the neighborhood. The result is a thin skeleton of curves and surfaces
+ * with the topology of the input.
+ *
+ * Every sub-iteration is split in eight subfields by the parity of the
+ * voxel coordinates. Two voxels of a subfield are never neighbors, so
+ * the voxels of a subfield are tested in parallel and deleted at once,
+ * with the same result as deleting them one by one. The first iteration
+ * tests the border voxels of the object, later iterations only the
+ * object voxels next to a voxel that was deleted in the iteration
+ * before, since the tests of the others cannot have changed. The result
+ * does not depend on the number of threads.
+ *
+ * The output is 1 on the skeleton and 0 elsewhere. Only 3D images are
+ * supported.
+ *
+ * \sa BinaryThinningImageFilter
+ */
+
+template< class TInputImage, class TOutputImage >
+class ITK_EXPORT BinaryThinning3DImageFilter :
+  public ImageToImageFilter< TInputImage, TOutputImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef BinaryThinning3DImageFilter                     Self;
+  typedef ImageToImageFilter< TInputImage, TOutputImage > Superclass;
+  typedef SmartPointer<Self>                              Pointer;
+  typedef SmartPointer<const Self>                        ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( BinaryThinning3DImageFilter, ImageToImageFilter );
+
+  /** Typedefs. */
+  typedef TInputImage                                 InputImageType;
+  typedef TOutputImage                                OutputImageType;
+  typedef typename InputImageType::PixelType          InputPixelType;
+  typedef typename OutputImageType::PixelType         OutputPixelType;
+  typedef typename OutputImageType::RegionType        OutputImageRegionType;
+
+  itkStaticConstMacro( ImageDimension, unsigned int, TInputImage::ImageDimension );
+
+  /** Get the number of iterations of the last run. */
+  itkGetConstMacro( NumberOfIterations, unsigned int );
+
+protected:
+  BinaryThinning3DImageFilter();
+  virtual ~BinaryThinning3DImageFilter() {};
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** The filter needs the whole input and produces the whole output. */
+  void GenerateInputRequestedRegion();
+  void EnlargeOutputRequestedRegion( DataObject * output );
+
+  /** Standard pipeline method. */
+  void GenerateData();
+
+  /** The voxel offsets in the padded work buffer. */
+  typedef SizeValueType                     WorkOffsetType;
+  typedef std::vector<WorkOffsetType>       WorkOffsetListType;
+
+  /** Test all candidates of a chunk of the current subfield. */
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback( void * arg );
+  void ThreadedTestCandidates( unsigned int threadId, unsigned int numberOfThreads );
+
+  /** Whether the voxel can be deleted in the current direction. */
+  bool IsDeletable( WorkOffsetType voxel ) const;
+
+  /** The subfield of a voxel, by the parity of its coordinates. */
+  unsigned int GetSubfield( WorkOffsetType voxel ) const;
+
+  /** Add a voxel to the candidates, if it is object and not there yet. */
+  void AddCandidate( WorkOffsetType voxel );
+
+private:
+  BinaryThinning3DImageFilter( const Self & ); // purposely not implemented
+  void operator=( const Self & );              // purposely not implemented
+
+  /** The work buffer: the input with a border of one background voxel,
+   * bit 1 is the object, bit 2 marks a candidate. */
+  std::vector<unsigned char>  m_Work;
+  SizeValueType               m_Strides[ 3 ];
+  long                        m_NeighborOffsets[ 27 ];
+
+  /** The adjacency tables of the 3x3x3 neighborhood, with the positions
+   * numbered x fastest and 13 the center: for the object the 26-adjacent
+   * positions in the 26-neighborhood, for the background the 6-adjacent
+   * positions in the 18-neighborhood. */
+  std::vector< std::vector<unsigned int> > m_ObjectAdjacency;
+  std::vector< std::vector<unsigned int> > m_BackgroundAdjacency;
+
+  /** The candidates per subfield, and the deletions of every thread. */
+  std::vector<WorkOffsetListType> m_Candidates;
+  std::vector<WorkOffsetListType> m_Deletions;
+  unsigned int                    m_CurrentDirection;
+  unsigned int                    m_CurrentSubfield;
+  unsigned int                    m_NumberOfIterations;
+
+}; // end class BinaryThinning3DImageFilter
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkBinaryThinning3DImageFilter.txx"
+#endif
+
+#endif // end #ifndef __itkBinaryThinning3DImageFilter_h_
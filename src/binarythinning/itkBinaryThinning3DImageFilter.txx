@@ -0,0 +1,450 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef _itkBinaryThinning3DImageFilter_txx_
+#define _itkBinaryThinning3DImageFilter_txx_
+
+#include "itkBinaryThinning3DImageFilter.h"
+
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkNumericTraits.h"
+
+#include <cstdlib>
+
+namespace itk
+{
+
+  /** The positions of the face neighbors, one per direction. */
+  static const unsigned int BinaryThinning3DFaceNeighbors[ 6 ] = { 12, 14, 10, 16, 4, 22 };
+
+
+  /**
+   * ******************* Constructor *******************
+   */
+
+  template< class TInputImage, class TOutputImage >
+    BinaryThinning3DImageFilter< TInputImage, TOutputImage >
+    ::BinaryThinning3DImageFilter()
+  {
+    this->m_CurrentDirection = 0;
+    this->m_CurrentSubfield = 0;
+    this->m_NumberOfIterations = 0;
+    for( unsigned int d = 0; d < 3; ++d ) this->m_Strides[ d ] = 0;
+    for( unsigned int i = 0; i < 27; ++i ) this->m_NeighborOffsets[ i ] = 0;
+
+    /** Fill the adjacency tables of the neighborhood. */
+    this->m_ObjectAdjacency.resize( 27 );
+    this->m_BackgroundAdjacency.resize( 27 );
+    for( unsigned int i = 0; i < 27; ++i )
+    {
+      const int xi = i % 3, yi = ( i / 3 ) % 3, zi = i / 9;
+      const int ni = std::abs( xi - 1 ) + std::abs( yi - 1 ) + std::abs( zi - 1 );
+      for( unsigned int j = 0; j < 27; ++j )
+      {
+        if( i == 13 || j == 13 || i == j ) continue;
+        const int xj = j % 3, yj = ( j / 3 ) % 3, zj = j / 9;
+        const int nj = std::abs( xj - 1 ) + std::abs( yj - 1 ) + std::abs( zj - 1 );
+        const int dx = std::abs( xi - xj ), dy = std::abs( yi - yj ), dz = std::abs( zi - zj );
+        if( dx <= 1 && dy <= 1 && dz <= 1 )
+        {
+          this->m_ObjectAdjacency[ i ].push_back( j );
+        }
+        if( dx + dy + dz == 1 && ni < 3 && nj < 3 )
+        {
+          this->m_BackgroundAdjacency[ i ].push_back( j );
+        }
+      }
+    }
+
+  } // end Constructor
+
+
+  /**
+   * ******************* GenerateInputRequestedRegion *******************
+   */
+
+  template< class TInputImage, class TOutputImage >
+    void
+    BinaryThinning3DImageFilter< TInputImage, TOutputImage >
+    ::GenerateInputRequestedRegion()
+  {
+    Superclass::GenerateInputRequestedRegion();
+
+    InputImageType * input = const_cast<InputImageType *>( this->GetInput() );
+    if( input )
+    {
+      input->SetRequestedRegion( input->GetLargestPossibleRegion() );
+    }
+  } // end GenerateInputRequestedRegion()
+
+
+  /**
+   * ******************* EnlargeOutputRequestedRegion *******************
+   */
+
+  template< class TInputImage, class TOutputImage >
+    void
+    BinaryThinning3DImageFilter< TInputImage, TOutputImage >
+    ::EnlargeOutputRequestedRegion( DataObject * output )
+  {
+    OutputImageType * out = dynamic_cast<OutputImageType *>( output );
+    if( out )
+    {
+      out->SetRequestedRegion( out->GetLargestPossibleRegion() );
+    }
+  } // end EnlargeOutputRequestedRegion()
+
+
+  /**
+   * ******************* GenerateData *******************
+   */
+
+  template< class TInputImage, class TOutputImage >
+    void
+    BinaryThinning3DImageFilter< TInputImage, TOutputImage >
+    ::GenerateData()
+  {
+    if( ImageDimension != 3 )
+    {
+      itkExceptionMacro( << "ERROR: BinaryThinning3DImageFilter only supports 3D images." );
+    }
+
+    this->AllocateOutputs();
+    const InputImageType * input = this->GetInput();
+    OutputImageType * output = this->GetOutput();
+    const OutputImageRegionType region = output->GetRequestedRegion();
+
+    /** The work buffer, with a border of background. */
+    SizeValueType paddedSize[ 3 ] = { 1, 1, 1 };
+    for( unsigned int d = 0; d < ImageDimension && d < 3; ++d )
+    {
+      paddedSize[ d ] = region.GetSize()[ d ] + 2;
+    }
+    this->m_Strides[ 0 ] = 1;
+    this->m_Strides[ 1 ] = paddedSize[ 0 ];
+    this->m_Strides[ 2 ] = paddedSize[ 0 ] * paddedSize[ 1 ];
+    this->m_Work.assign( this->m_Strides[ 2 ] * paddedSize[ 2 ], 0 );
+    for( unsigned int i = 0; i < 27; ++i )
+    {
+      this->m_NeighborOffsets[ i ]
+        = ( static_cast<long>( i % 3 ) - 1 ) * static_cast<long>( this->m_Strides[ 0 ] )
+        + ( static_cast<long>( ( i / 3 ) % 3 ) - 1 ) * static_cast<long>( this->m_Strides[ 1 ] )
+        + ( static_cast<long>( i / 9 ) - 1 ) * static_cast<long>( this->m_Strides[ 2 ] );
+    }
+
+    /** Copy the object, in raster order. */
+    const SizeValueType nx = paddedSize[ 0 ] - 2;
+    const SizeValueType ny = paddedSize[ 1 ] - 2;
+    ImageRegionConstIterator<InputImageType> it( input, region );
+    it.GoToBegin();
+    for( SizeValueType z = 1; z + 1 < paddedSize[ 2 ]; ++z )
+    {
+      for( SizeValueType y = 1; y <= ny; ++y )
+      {
+        unsigned char * row = &this->m_Work[ z * this->m_Strides[ 2 ] + y * this->m_Strides[ 1 ] ];
+        for( SizeValueType x = 1; x <= nx; ++x, ++it )
+        {
+          row[ x ] = it.Get() != NumericTraits<InputPixelType>::Zero ? 1 : 0;
+        }
+      }
+    }
+
+    /** The first candidates are the border voxels of the object. */
+    this->m_Candidates.assign( 8, WorkOffsetListType() );
+    for( WorkOffsetType v = 0; v < this->m_Work.size(); ++v )
+    {
+      if( !( this->m_Work[ v ] & 1 ) ) continue;
+      for( unsigned int dir = 0; dir < 6; ++dir )
+      {
+        if( !( this->m_Work[ v + this->m_NeighborOffsets[ BinaryThinning3DFaceNeighbors[ dir ] ] ] & 1 ) )
+        {
+          this->AddCandidate( v );
+          break;
+        }
+      }
+    }
+
+    /** Set up the threads. */
+    this->GetMultiThreader()->SetNumberOfThreads( this->GetNumberOfThreads() );
+    this->GetMultiThreader()->SetSingleMethod( this->ThreaderCallback, this );
+    this->m_Deletions.assign( this->GetMultiThreader()->GetNumberOfThreads(), WorkOffsetListType() );
+
+    /** Peel until nothing can be deleted. */
+    this->m_NumberOfIterations = 0;
+    WorkOffsetListType deleted;
+    do
+    {
+      deleted.clear();
+      for( unsigned int dir = 0; dir < 6; ++dir )
+      {
+        for( unsigned int subfield = 0; subfield < 8; ++subfield )
+        {
+          if( this->m_Candidates[ subfield ].empty() ) continue;
+
+          this->m_CurrentDirection = dir;
+          this->m_CurrentSubfield = subfield;
+          this->GetMultiThreader()->SingleMethodExecute();
+
+          /** Delete the voxels of this subfield at once, in thread order. */
+          for( unsigned int t = 0; t < this->m_Deletions.size(); ++t )
+          {
+            const WorkOffsetListType & deletions = this->m_Deletions[ t ];
+            for( std::size_t i = 0; i < deletions.size(); ++i )
+            {
+              this->m_Work[ deletions[ i ] ] = 0;
+              deleted.push_back( deletions[ i ] );
+            }
+          }
+        }
+      }
+      ++this->m_NumberOfIterations;
+
+      /** The next candidates are the object voxels next to a deletion. */
+      for( unsigned int subfield = 0; subfield < 8; ++subfield )
+      {
+        WorkOffsetListType & candidates = this->m_Candidates[ subfield ];
+        for( std::size_t i = 0; i < candidates.size(); ++i )
+        {
+          this->m_Work[ candidates[ i ] ] &= 1;
+        }
+        candidates.clear();
+      }
+      for( std::size_t i = 0; i < deleted.size(); ++i )
+      {
+        for( unsigned int n = 0; n < 27; ++n )
+        {
+          if( n != 13 ) this->AddCandidate( deleted[ i ] + this->m_NeighborOffsets[ n ] );
+        }
+      }
+
+      itkDebugMacro( << "Iteration " << this->m_NumberOfIterations
+        << ": deleted " << deleted.size() << " voxels." );
+    } while( !deleted.empty() );
+
+    /** Write the skeleton. */
+    ImageRegionIterator<OutputImageType> ot( output, region );
+    ot.GoToBegin();
+    for( SizeValueType z = 1; z + 1 < paddedSize[ 2 ]; ++z )
+    {
+      for( SizeValueType y = 1; y <= ny; ++y )
+      {
+        const unsigned char * row = &this->m_Work[ z * this->m_Strides[ 2 ] + y * this->m_Strides[ 1 ] ];
+        for( SizeValueType x = 1; x <= nx; ++x, ++ot )
+        {
+          ot.Set( ( row[ x ] & 1 ) ? NumericTraits<OutputPixelType>::One
+            : NumericTraits<OutputPixelType>::Zero );
+        }
+      }
+    }
+
+    /** Free the memory. */
+    std::vector<unsigned char>().swap( this->m_Work );
+    this->m_Candidates.clear();
+    this->m_Deletions.clear();
+
+  } // end GenerateData()
+
+
+  /**
+   * ******************* ThreaderCallback *******************
+   */
+
+  template< class TInputImage, class TOutputImage >
+    ITK_THREAD_RETURN_TYPE
+    BinaryThinning3DImageFilter< TInputImage, TOutputImage >
+    ::ThreaderCallback( void * arg )
+  {
+    typedef MultiThreader::ThreadInfoStruct ThreadInfoType;
+    ThreadInfoType * info = static_cast<ThreadInfoType *>( arg );
+    Self * filter = static_cast<Self *>( info->UserData );
+
+    filter->ThreadedTestCandidates( info->ThreadID, info->NumberOfThreads );
+
+    return ITK_THREAD_RETURN_VALUE;
+  } // end ThreaderCallback()
+
+
+  /**
+   * ******************* ThreadedTestCandidates *******************
+   */
+
+  template< class TInputImage, class TOutputImage >
+    void
+    BinaryThinning3DImageFilter< TInputImage, TOutputImage >
+    ::ThreadedTestCandidates( unsigned int threadId, unsigned int numberOfThreads )
+  {
+    const WorkOffsetListType & candidates = this->m_Candidates[ this->m_CurrentSubfield ];
+    WorkOffsetListType & deletions = this->m_Deletions[ threadId ];
+    deletions.clear();
+
+    /** The work buffer is only read here, the deletions are done after. */
+    const std::size_t n = candidates.size();
+    const std::size_t begin = n * threadId / numberOfThreads;
+    const std::size_t end = n * ( threadId + 1 ) / numberOfThreads;
+    for( std::size_t i = begin; i < end; ++i )
+    {
+      if( this->IsDeletable( candidates[ i ] ) )
+      {
+        deletions.push_back( candidates[ i ] );
+      }
+    }
+
+  } // end ThreadedTestCandidates()
+
+
+  /**
+   * ******************* IsDeletable *******************
+   */
+
+  template< class TInputImage, class TOutputImage >
+    bool
+    BinaryThinning3DImageFilter< TInputImage, TOutputImage >
+    ::IsDeletable( WorkOffsetType voxel ) const
+  {
+    /** It must be object, with background in the current direction. */
+    const unsigned char * center = &this->m_Work[ voxel ];
+    if( !( *center & 1 ) ) return false;
+    const unsigned int face = BinaryThinning3DFaceNeighbors[ this->m_CurrentDirection ];
+    if( center[ this->m_NeighborOffsets[ face ] ] & 1 ) return false;
+
+    /** Get the neighborhood. */
+    unsigned char neighborhood[ 27 ];
+    unsigned int numberOfObjectNeighbors = 0;
+    for( unsigned int i = 0; i < 27; ++i )
+    {
+      neighborhood[ i ] = center[ this->m_NeighborOffsets[ i ] ] & 1;
+      numberOfObjectNeighbors += neighborhood[ i ];
+    }
+    --numberOfObjectNeighbors;
+
+    /** Keep end points, and isolated voxels. */
+    if( numberOfObjectNeighbors <= 1 ) return false;
+
+    /** The object neighbors must form one 26-connected component. */
+    unsigned int stack[ 27 ];
+    unsigned char visited[ 27 ] = { 0 };
+    unsigned int top = 0;
+    unsigned int numberOfVisited = 0;
+    for( unsigned int i = 0; i < 27 && top == 0; ++i )
+    {
+      if( i != 13 && neighborhood[ i ] )
+      {
+        stack[ top++ ] = i;
+        visited[ i ] = 1;
+      }
+    }
+    while( top > 0 )
+    {
+      const unsigned int i = stack[ --top ];
+      ++numberOfVisited;
+      const std::vector<unsigned int> & adjacent = this->m_ObjectAdjacency[ i ];
+      for( std::size_t k = 0; k < adjacent.size(); ++k )
+      {
+        const unsigned int j = adjacent[ k ];
+        if( neighborhood[ j ] && !visited[ j ] )
+        {
+          visited[ j ] = 1;
+          stack[ top++ ] = j;
+        }
+      }
+    }
+    if( numberOfVisited != numberOfObjectNeighbors ) return false;
+
+    /** The background face neighbors must be in one 6-connected component
+     * of the background in the 18-neighborhood. */
+    for( unsigned int i = 0; i < 27; ++i ) visited[ i ] = 0;
+    top = 0;
+    stack[ top++ ] = face;
+    visited[ face ] = 1;
+    while( top > 0 )
+    {
+      const unsigned int i = stack[ --top ];
+      const std::vector<unsigned int> & adjacent = this->m_BackgroundAdjacency[ i ];
+      for( std::size_t k = 0; k < adjacent.size(); ++k )
+      {
+        const unsigned int j = adjacent[ k ];
+        if( !neighborhood[ j ] && !visited[ j ] )
+        {
+          visited[ j ] = 1;
+          stack[ top++ ] = j;
+        }
+      }
+    }
+    for( unsigned int dir = 0; dir < 6; ++dir )
+    {
+      const unsigned int j = BinaryThinning3DFaceNeighbors[ dir ];
+      if( !neighborhood[ j ] && !visited[ j ] ) return false;
+    }
+
+    return true;
+
+  } // end IsDeletable()
+
+
+  /**
+   * ******************* GetSubfield *******************
+   */
+
+  template< class TInputImage, class TOutputImage >
+    unsigned int
+    BinaryThinning3DImageFilter< TInputImage, TOutputImage >
+    ::GetSubfield( WorkOffsetType voxel ) const
+  {
+    const SizeValueType z = voxel / this->m_Strides[ 2 ];
+    const SizeValueType rest = voxel % this->m_Strides[ 2 ];
+    const SizeValueType y = rest / this->m_Strides[ 1 ];
+    const SizeValueType x = rest % this->m_Strides[ 1 ];
+    return static_cast<unsigned int>( ( x & 1 ) + 2 * ( y & 1 ) + 4 * ( z & 1 ) );
+  } // end GetSubfield()
+
+
+  /**
+   * ******************* AddCandidate *******************
+   */
+
+  template< class TInputImage, class TOutputImage >
+    void
+    BinaryThinning3DImageFilter< TInputImage, TOutputImage >
+    ::AddCandidate( WorkOffsetType voxel )
+  {
+    unsigned char & value = this->m_Work[ voxel ];
+    if( value == 1 )
+    {
+      value |= 2;
+      this->m_Candidates[ this->GetSubfield( voxel ) ].push_back( voxel );
+    }
+  } // end AddCandidate()
+
+
+  /**
+   * ******************* PrintSelf *******************
+   */
+
+  template< class TInputImage, class TOutputImage >
+    void
+    BinaryThinning3DImageFilter< TInputImage, TOutputImage >
+    ::PrintSelf( std::ostream & os, Indent indent ) const
+  {
+    Superclass::PrintSelf( os, indent );
+    os << indent << "NumberOfIterations: " << this->m_NumberOfIterations << std::endl;
+  } // end PrintSelf()
+
+} // end namespace itk
+
+#endif // end #ifndef _itkBinaryThinning3DImageFilter_txx_
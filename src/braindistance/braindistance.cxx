@@ -29,19 +29,14 @@
 #include "ITKToolsBase.h"
 
 #include "itkImageFileReader.h"
-#include "itkBinaryThresholdImageFilter.h"
-#include "itkImageRegionIteratorWithIndex.h"
-#include "itkDisplacementFieldJacobianDeterminantFilter.h"
-#include "itkDeformationFieldBendingEnergyFilter.h"
-#include "itkLabelStatisticsImageFilter.h"
-#include "itkStatisticsImageFilter.h"
-#include "itkUnaryFunctorImageFilter.h"
-#include "itkCropImageFilter.h"
-#include "itkRegionOfInterestImageFilter.h"
-#include "itkIntensityWindowingImageFilter.h"
-#include "itkLogImageFilter.h"
+#include "itkImage.h"
+#include "itkVector.h"
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
 #include "vnl/vnl_math.h"
 #include <fstream>
+#include <sstream>
+#include <cmath>
 
 
 /**
@@ -61,8 +56,15 @@ std::string GetHelpString( void )
     << "           one contains mu_tot and sigma_tot. the second one contains mu_i, sigma_i, and sigma_itot.\n"
     << "  -mask    maskFileName: the name of the label image (deformed HAMMER atlas)\n"
     << "  [-m]     method: 0 (jacobian), 1 (bending energy), or 2 (log(jacobian)); default: 0\n"
+    << "  [-list]  listFilename: batch mode, a text file with per line the\n"
+    << "           deformation field, the label image and the two output filenames\n"
+    << "           of a subject. -in, -mask and -out are then not needed.\n"
+    << "  [-jobs]  the number of subjects processed concurrently in batch mode;\n"
+    << "           default: 1. The threads are divided over the jobs.\n"
     << "Supported: -in: 3D vector of floats, 3 elements per vector\n"
-    << "-mask: 3D unsigned char or anything that is valid after casting to unsigned char";
+    << "-mask: 3D unsigned char or anything that is valid after casting to unsigned char\n"
+    << "The measure and its statistics per label are computed in a single\n"
+    << "threaded pass over the interior of the field, without intermediate images.";
   return ss.str();
 
 } // end GetHelpString()
@@ -70,28 +72,50 @@ std::string GetHelpString( void )
 
 //-------------------------------------------------------------------------------------
 
+/** Typedefs. */
+const unsigned int Dimension = 3;
+typedef itk::Vector< float, Dimension >                 InputPixelType;
+typedef unsigned char                                   MaskPixelType;
+typedef itk::Image< InputPixelType, Dimension >         InputImageType;
+typedef itk::Image< MaskPixelType, Dimension >          MaskImageType;
+typedef InputImageType::OffsetValueType                 OffsetValueType;
+typedef InputImageType::SizeType                        SizeType;
+
+/** The number of labels of the mask pixel type. */
+const unsigned int NumberOfLabels = 256;
+
 /* Declare ComputeBrainDistance function. */
 void ComputeBrainDistance(
   const std::string & inputFileName,
   const std::string & maskFileName,
   const std::vector<std::string> & outputFileNames,
-  unsigned int method );
+  unsigned int method,
+  unsigned int numberOfThreads,
+  bool verbose );
+
+/* Declare RunBatch function. */
+int RunBatch( const std::string & listFileName,
+  unsigned int method, unsigned int numberOfJobs );
 
 //-------------------------------------------------------------------------------------
 
 int main( int argc, char ** argv )
 {
   RegisterMevisDicomTiff();
-  
+
   /** Create a command line argument parser. */
   itk::CommandLineArgumentParser::Pointer parser
     = itk::CommandLineArgumentParser::New();
   parser->SetCommandLineArguments( argc, argv );
   parser->SetProgramHelpText( GetHelpString() );
 
-  parser->MarkArgumentAsRequired( "-in", "The input filename." );
-  parser->MarkArgumentAsRequired( "-mask", "The mask filename." );
-  parser->MarkArgumentAsRequired( "-out", "The output filenames." );
+  const bool batchMode = parser->ArgumentExists( "-list" );
+  if( !batchMode )
+  {
+    parser->MarkArgumentAsRequired( "-in", "The input filename." );
+    parser->MarkArgumentAsRequired( "-mask", "The mask filename." );
+    parser->MarkArgumentAsRequired( "-out", "The output filenames." );
+  }
 
   itk::CommandLineArgumentParser::ReturnValue validateArguments = parser->CheckForRequiredArguments();
 
@@ -104,6 +128,28 @@ int main( int argc, char ** argv )
     return EXIT_SUCCESS;
   }
 
+  /** Threading. */
+  itktools::ReadThreadingArguments( parser );
+
+  /** Get arguments (optional): method */
+  unsigned int method = 0;
+  parser->GetCommandLineArgument( "-m", method );
+  if( method > 2 )
+  {
+    std::cerr << "ERROR: the method should be 0, 1 or 2." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  /** Batch mode. */
+  if( batchMode )
+  {
+    std::string listFileName = "";
+    parser->GetCommandLineArgument( "-list", listFileName );
+    unsigned int numberOfJobs = 1;
+    parser->GetCommandLineArgument( "-jobs", numberOfJobs );
+    return RunBatch( listFileName, method, numberOfJobs );
+  }
+
   /** Get arguments (mandatory): input deformation field */
   std::string inputFileName = "";
   parser->GetCommandLineArgument( "-in", inputFileName );
@@ -112,16 +158,13 @@ int main( int argc, char ** argv )
   std::string maskFileName = "";
   parser->GetCommandLineArgument( "-mask", maskFileName );
 
-  /** Get arguments (optional): method */
-  unsigned int method = 0;
-  parser->GetCommandLineArgument( "-m", method );
-
   /** Get arguments (mandatory): Output filenames */
   std::vector< std::string > outputFileNames;
   parser->GetCommandLineArgument( "-out", outputFileNames );
   if( outputFileNames.size() != 2 )
   {
     std::cerr << "ERROR: You should specify \"-out\", followed by 2 filenames." << std::endl;
+    return EXIT_FAILURE;
   }
 
   /** Determine image properties. */
@@ -140,20 +183,12 @@ int main( int argc, char ** argv )
       << "vectors of length 3 it should be!" << std::endl;
     return EXIT_FAILURE;
   }
-  for( unsigned int i = 0; i < dim; ++i )
-  {
-    if( imageSize[ i ] < 3 )
-    {
-      std::cerr << "ERROR: the image is too small in one of the dimensions. "
-        << "Minimum size is 3 for each dimension." << std::endl;
-      return EXIT_FAILURE;
-    }
-  }
 
   /** Run the program. */
   try
   {
-    ComputeBrainDistance( inputFileName, maskFileName, outputFileNames, method );
+    ComputeBrainDistance( inputFileName, maskFileName, outputFileNames, method,
+      itk::MultiThreader::GetGlobalDefaultNumberOfThreads(), true );
   }
   catch( itk::ExceptionObject & excp )
   {
@@ -167,69 +202,177 @@ int main( int argc, char ** argv )
 } // end main
 
 
-//------------------------------------------------------------------
+//---------------------------------------------------------------------
 
-/* Function that does (x-b)^2 */
-namespace itk
+/* write a vector of doubles to an ostream */
+std::ostream& operator<<(std::ostream& os, std::vector<double>& vec)
 {
-  namespace Function {
-
-  template< class TInput, class TOutput = TInput>
-  class SubtractSquare
+  for( unsigned int i =0; i< (vec.size()-1); ++i )
   {
-  public:
-    typedef typename NumericTraits<TInput>::RealType RealType;
+    os << vec[ i ] << "\t";
+  }
+  os << vec[ vec.size()-1 ];
+  return os;
+}
 
-    SubtractSquare()
-    {
-      this->m_ScalarToSubtract = itk::NumericTraits<RealType>::Zero;
-    }
-    ~SubtractSquare() {}
 
-    bool operator!=( const SubtractSquare & ) const
-    {
-      return false;
-    }
+/**
+ * ******************* BrainDistanceStruct *******************
+ * The data of the fused pass. The field and the mask have the same
+ * buffered region, so that one offset addresses both.
+ */
+
+struct BrainDistanceStruct
+{
+  const InputPixelType *  m_Field;
+  const MaskPixelType *   m_Mask;
+  OffsetValueType         m_Strides[ Dimension ];
+  SizeType                m_Size;
+  double                  m_HalfDerivativeWeights[ Dimension ];
+  unsigned int            m_Method;
+
+  /** Per thread and label: the count, the sum and the sum of squares. */
+  std::vector<double> *   m_Sums;
+};
+
+
+/**
+ * ******************* EvaluateJacobian *******************
+ * The determinant of I + du/dx, with central differences, as in
+ * itk::DisplacementFieldJacobianDeterminantFilter.
+ */
 
-    bool operator==( const SubtractSquare & other ) const
+inline double EvaluateJacobian( const InputPixelType * center,
+  const OffsetValueType * strides, const double * weights )
+{
+  double J[ Dimension ][ Dimension ];
+  for( unsigned int i = 0; i < Dimension; ++i )
+  {
+    const InputPixelType & next = center[ strides[ i ] ];
+    const InputPixelType & previous = center[ -strides[ i ] ];
+    for( unsigned int j = 0; j < Dimension; ++j )
     {
-      return !(*this != other);
+      J[ i ][ j ] = weights[ i ] * ( static_cast<double>( next[ j ] )
+        - static_cast<double>( previous[ j ] ) );
     }
+    J[ i ][ i ] += 1.0;
+  }
+
+  return J[ 0 ][ 0 ] * ( J[ 1 ][ 1 ] * J[ 2 ][ 2 ] - J[ 1 ][ 2 ] * J[ 2 ][ 1 ] )
+    - J[ 0 ][ 1 ] * ( J[ 1 ][ 0 ] * J[ 2 ][ 2 ] - J[ 1 ][ 2 ] * J[ 2 ][ 0 ] )
+    + J[ 0 ][ 2 ] * ( J[ 1 ][ 0 ] * J[ 2 ][ 1 ] - J[ 1 ][ 1 ] * J[ 2 ][ 0 ] );
+
+} // end EvaluateJacobian()
+
+
+/**
+ * ******************* EvaluateBendingEnergy *******************
+ * The sum of the squared second order differences, with the weights of
+ * itk::DeformationFieldBendingEnergyFilter.
+ */
 
-    void SetScalarToSubtract( RealType scalar )
+inline double EvaluateBendingEnergy( const InputPixelType * center,
+  const OffsetValueType * strides, const double * weights )
+{
+  double bending = 0.0;
+  /** diagonal terms: */
+  for( unsigned int i = 0; i < Dimension; ++i )
+  {
+    const InputPixelType & p = center[ strides[ i ] ];
+    const InputPixelType & q = center[ -strides[ i ] ];
+    double squaredNorm = 0.0;
+    for( unsigned int k = 0; k < Dimension; ++k )
     {
-      this->m_ScalarToSubtract = scalar;
+      const double pqc = static_cast<double>( p[ k ] ) + static_cast<double>( q[ k ] )
+        - 2.0 * static_cast<double>( ( *center )[ k ] );
+      squaredNorm += pqc * pqc;
     }
-    RealType GetScalarToSubtract( void )
+    bending += squaredNorm * vnl_math_sqr( vnl_math_sqr( weights[ i ] ) );
+  }
+  /** off-diagonal: */
+  for( unsigned int i = 0; i < Dimension; ++i )
+  {
+    for( unsigned int j = i + 1; j < Dimension; ++j )
     {
-      return this->m_ScalarToSubtract;
+      const InputPixelType & p = center[ strides[ i ] + strides[ j ] ];
+      const InputPixelType & q = center[ -strides[ i ] - strides[ j ] ];
+      const InputPixelType & r = center[ strides[ i ] - strides[ j ] ];
+      const InputPixelType & s = center[ -strides[ i ] + strides[ j ] ];
+      double squaredNorm = 0.0;
+      for( unsigned int k = 0; k < Dimension; ++k )
+      {
+        const double pqrs = static_cast<double>( p[ k ] ) + static_cast<double>( q[ k ] )
+          - static_cast<double>( r[ k ] ) - static_cast<double>( s[ k ] );
+        squaredNorm += pqrs * pqrs;
+      }
+      bending += squaredNorm * 2.0 * vnl_math_sqr( weights[ i ] * weights[ j ] );
     }
+  }
 
-    inline TOutput operator()( const TInput & A )
-    {
-      const RealType ra = static_cast<RealType>( A ) - this->m_ScalarToSubtract;
-      return static_cast<TOutput>( ra * ra );
-    }
-  protected:
-    RealType m_ScalarToSubtract;
+  return bending;
 
-  }; // end class
+} // end EvaluateBendingEnergy()
 
-  } // end Function namespace
-} // end itk namespace
 
-//---------------------------------------------------------------------
+/**
+ * ******************* BrainDistanceThreaderCallback *******************
+ * Every thread takes a contiguous range of the interior slices, computes
+ * the measure per voxel and adds it to the sums of its label.
+ */
 
-/* write a vector of doubles to an ostream */
-std::ostream& operator<<(std::ostream& os, std::vector<double>& vec)
+ITK_THREAD_RETURN_TYPE BrainDistanceThreaderCallback( void * arg )
 {
-  for( unsigned int i =0; i< (vec.size()-1); ++i )
+  itk::MultiThreader::ThreadInfoStruct * info
+    = static_cast<itk::MultiThreader::ThreadInfoStruct *>( arg );
+  BrainDistanceStruct * data = static_cast<BrainDistanceStruct *>( info->UserData );
+
+  /** The interior, without the outer layer of voxels. */
+  const SizeType & size = data->m_Size;
+  const OffsetValueType * strides = data->m_Strides;
+  const itk::SizeValueType numberOfSlices = size[ 2 ] - 2;
+  const itk::SizeValueType begin = numberOfSlices * info->ThreadID / info->NumberOfThreads;
+  const itk::SizeValueType end = numberOfSlices * ( info->ThreadID + 1 ) / info->NumberOfThreads;
+
+  const double minJac = 1.0 / 3.0;
+  const double maxJac = 3.0;
+  double * sums = &( *data->m_Sums )[ 3 * NumberOfLabels * info->ThreadID ];
+  for( itk::SizeValueType z = begin + 1; z < end + 1; ++z )
   {
-    os << vec[ i ] << "\t";
+    for( itk::SizeValueType y = 1; y < size[ 1 ] - 1; ++y )
+    {
+      const OffsetValueType lineOffset = z * strides[ 2 ] + y * strides[ 1 ];
+      for( itk::SizeValueType x = 1; x < size[ 0 ] - 1; ++x )
+      {
+        const OffsetValueType offset = lineOffset + x;
+        const InputPixelType * center = data->m_Field + offset;
+
+        double value = 0.0;
+        if( data->m_Method == 1 )
+        {
+          value = EvaluateBendingEnergy( center, strides, data->m_HalfDerivativeWeights );
+        }
+        else
+        {
+          value = EvaluateJacobian( center, strides, data->m_HalfDerivativeWeights );
+          if( data->m_Method == 2 )
+          {
+            /** Clamp and take log */
+            value = vcl_log( std::min( std::max( value, minJac ), maxJac ) );
+          }
+        }
+
+        double * labelSums = sums + 3 * data->m_Mask[ offset ];
+        labelSums[ 0 ] += 1.0;
+        labelSums[ 1 ] += value;
+        labelSums[ 2 ] += value * value;
+      }
+    }
   }
-  os << vec[ vec.size()-1 ];
-  return os;
-}
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end BrainDistanceThreaderCallback()
+
 
 //------------------------------------------------------------------
 
@@ -238,229 +381,143 @@ void ComputeBrainDistance(
   const std::string & inputFileName,
   const std::string & maskFileName,
   const std::vector<std::string> & outputFileNames,
-  unsigned int method )
+  unsigned int method,
+  unsigned int numberOfThreads,
+  bool verbose )
 {
   /** Typedefs. */
-  typedef float                                           InputComponentType;
-  const unsigned int Dimension = 3;
-  typedef itk::Vector<InputComponentType, Dimension>      InputPixelType;
-  typedef unsigned char                                   MaskPixelType;
-  typedef float                                           InternalPixelType;
-
-  typedef itk::Image< InputPixelType, Dimension >         InputImageType;
-  typedef itk::Image< MaskPixelType, Dimension >          MaskImageType;
-  typedef itk::Image< InternalPixelType, Dimension >      InternalImageType;
-
   typedef itk::ImageFileReader< InputImageType >          InputReaderType;
   typedef itk::ImageFileReader< MaskImageType >           MaskReaderType;
 
-  typedef itk::ImageRegionIteratorWithIndex<
-    InputImageType >                                      IteratorType;
-  typedef InputImageType::IndexType                       IndexType;
-  typedef InputImageType::PointType                       PointType;
-  typedef InputImageType::RegionType                      RegionType;
-  typedef RegionType::SizeType                            SizeType;
-
-  typedef itk::DisplacementFieldJacobianDeterminantFilter<
-    InputImageType, InternalPixelType, InternalImageType> JacobianFilterType;
-  typedef itk::DeformationFieldBendingEnergyFilter<
-    InputImageType, InternalPixelType, InternalImageType> BendingEnergyFilterType;
-
-  typedef itk::BinaryThresholdImageFilter<
-    MaskImageType, MaskImageType >                        ThresholderType;
-  typedef itk::LabelStatisticsImageFilter<
-    InternalImageType, MaskImageType >                    StatFilterType;
-  typedef itk::StatisticsImageFilter< MaskImageType >     MaximumComputerType;
-
-  typedef itk::RegionOfInterestImageFilter<
-    InternalImageType, InternalImageType >                JacobianCropFilterType;
-  typedef itk::RegionOfInterestImageFilter<
-    MaskImageType, MaskImageType >                        MaskCropFilterType;
-
-  typedef itk::Function::SubtractSquare<
-    InternalPixelType >                                   SubtractSquareFunctionType;
-  typedef itk::UnaryFunctorImageFilter<
-    InternalImageType, InternalImageType,
-     SubtractSquareFunctionType >                         SubtractSquareFilterType;
-
-  typedef itk::IntensityWindowingImageFilter<
-    InternalImageType, InternalImageType >                WindowFilterType;
-  typedef itk::LogImageFilter<
-    InternalImageType, InternalImageType >                LogFilterType;
-
-  /** Instantiate main variables */
+  /** Read image. */
+  if( verbose ) std::cout << "Reading input image..." << std::endl;
   InputReaderType::Pointer inputReader = InputReaderType::New();
-  InputImageType::Pointer inputImage = 0;
+  inputReader->SetFileName( inputFileName );
+  inputReader->Update();
+  InputImageType::Pointer inputImage = inputReader->GetOutput();
+
+  /** Read the label mask. */
+  if( verbose ) std::cout << "Reading label mask image..." << std::endl;
   MaskReaderType::Pointer maskReader = MaskReaderType::New();
-  MaskCropFilterType::Pointer maskCropFilter = MaskCropFilterType::New();
-  MaskImageType::Pointer labelMask = 0;
-  MaskImageType::Pointer brainMask = 0;
-  InternalImageType::Pointer jacobian = 0;
-  JacobianCropFilterType::Pointer jacobianCropFilter = JacobianCropFilterType::New();
-  ThresholderType::Pointer thresholder = ThresholderType::New();
-  StatFilterType::Pointer statFilterBrainMask = StatFilterType::New();
-  StatFilterType::Pointer statFilterLabels = StatFilterType::New();
-  StatFilterType::Pointer statFilterLabelsSpecial = StatFilterType::New();
-  MaximumComputerType::Pointer maximumComputer  = MaximumComputerType::New();
-  SubtractSquareFilterType::Pointer subsqFilter = SubtractSquareFilterType::New();
-  WindowFilterType::Pointer windowFilter = WindowFilterType::New();
-  LogFilterType::Pointer logFilter = LogFilterType::New();
-
-  /** method 0 or 1 */
-  JacobianFilterType::Pointer jacobianFilter = 0;
-  if( method==0 || method ==2 )
+  maskReader->SetFileName( maskFileName );
+  maskReader->Update();
+  MaskImageType::Pointer labelMask = maskReader->GetOutput();
+
+  const SizeType size = inputImage->GetBufferedRegion().GetSize();
+  if( labelMask->GetBufferedRegion().GetSize() != size )
   {
-    jacobianFilter = JacobianFilterType::New();
+    itkGenericExceptionMacro( << "ERROR: the label mask " << maskFileName
+      << " and the deformation field " << inputFileName
+      << " do not have the same size." );
   }
-  else
+  for( unsigned int i = 0; i < Dimension; ++i )
   {
-    jacobianFilter = BendingEnergyFilterType::New();
+    if( size[ i ] < 3 )
+    {
+      itkGenericExceptionMacro( << "ERROR: the image " << inputFileName
+        << " is too small in one of the dimensions. "
+        << "Minimum size is 3 for each dimension." );
+    }
   }
 
-  /** Read image. */
-  std::cout << "Reading input image..." << std::endl;
-  inputReader->SetFileName( inputFileName );
-  inputImage = inputReader->GetOutput();
-  inputImage->Update();
-
-  /** Compute the 'jacobian' (or bending energy) and crop */
-  std::cout << "Computing jacobian image..." << std::endl;
-  jacobianFilter->SetUseImageSpacingOn();
-  jacobianFilter->SetInput( inputImage );
-  jacobianFilter->UpdateLargestPossibleRegion();
-  RegionType oldregion = jacobianFilter->GetOutput()->GetLargestPossibleRegion();
-  SizeType oldsize = oldregion.GetSize();
-  IndexType oldindex = oldregion.GetIndex();
-  RegionType newregion;
-  SizeType newsize;
-  IndexType newindex;
-  for( unsigned int d = 0; d < Dimension; ++d)
+  /** Compute the 'jacobian' (or bending energy) over the interior, and
+   * accumulate its statistics per label in the same pass.
+   */
+  if( verbose ) std::cout << "Computing jacobian statistics per label..." << std::endl;
+  std::vector<double> sums( 3 * NumberOfLabels * numberOfThreads, 0.0 );
+  BrainDistanceStruct data;
+  data.m_Field = inputImage->GetBufferPointer();
+  data.m_Mask = labelMask->GetBufferPointer();
+  data.m_Size = size;
+  data.m_Method = method;
+  data.m_Sums = &sums;
+  const OffsetValueType * offsetTable = inputImage->GetOffsetTable();
+  for( unsigned int i = 0; i < Dimension; ++i )
   {
-    newsize[d] = oldsize[d] - 2;
-    newindex[d] = oldindex[d] + 1;
+    data.m_Strides[ i ] = offsetTable[ i ];
+    data.m_HalfDerivativeWeights[ i ] = 0.5 / inputImage->GetSpacing()[ i ];
   }
-  newregion.SetIndex( newindex);
-  newregion.SetSize( newsize );
-  jacobianCropFilter->SetRegionOfInterest( newregion );
-  jacobianCropFilter->SetInput( jacobianFilter->GetOutput() );
-  jacobianCropFilter->Update();
 
-  const double maxJac = 3.0;
-  if( method ==2 )
-  {
-    /** Clamp and take log */
-    windowFilter->SetInput( jacobianCropFilter->GetOutput() );
-    windowFilter->SetOutputMinimum( 1.0 / maxJac );
-    windowFilter->SetWindowMinimum( 1.0 / maxJac );
-    windowFilter->SetOutputMaximum( maxJac );
-    windowFilter->SetWindowMaximum( maxJac );
-    logFilter->SetInput( windowFilter->GetOutput() );
-    logFilter->Update();
-    jacobian = logFilter->GetOutput();
-  }
-  else
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  const unsigned int numberOfSlices = size[ 2 ] - 2;
+  threader->SetNumberOfThreads( std::max( 1u, std::min( numberOfThreads, numberOfSlices ) ) );
+  threader->SetSingleMethod( BrainDistanceThreaderCallback, &data );
+  threader->SingleMethodExecute();
+
+  /** Sum the threads, in thread order. */
+  std::vector<double> count( NumberOfLabels, 0.0 );
+  std::vector<double> sum( NumberOfLabels, 0.0 );
+  std::vector<double> sumOfSquares( NumberOfLabels, 0.0 );
+  for( unsigned int t = 0; t < static_cast<unsigned int>( threader->GetNumberOfThreads() ); ++t )
   {
-    /** Do nothing */
-    jacobian = jacobianCropFilter->GetOutput();
+    const double * threadSums = &sums[ 3 * NumberOfLabels * t ];
+    for( unsigned int i = 0; i < NumberOfLabels; ++i )
+    {
+      count[ i ] += threadSums[ 3 * i ];
+      sum[ i ] += threadSums[ 3 * i + 1 ];
+      sumOfSquares[ i ] += threadSums[ 3 * i + 2 ];
+    }
   }
 
-  /** Read the label mask and crop */
-  std::cout << "Reading label mask image..." << std::endl;
-  maskReader->SetFileName( maskFileName );
-  maskReader->Update();
-  maskCropFilter->SetRegionOfInterest( newregion );
-  maskCropFilter->SetInput( maskReader->GetOutput() );
-  labelMask = maskCropFilter->GetOutput();
-  labelMask->Update();
-
-  /** Generate brain mask by thresholding at 0 (assumes Hammer atlas) */
-  std::cout << "Thresholding label image..." << std::endl;
-  thresholder->SetLowerThreshold( itk::NumericTraits<MaskPixelType>::Zero );
-  thresholder->SetUpperThreshold( itk::NumericTraits<MaskPixelType>::Zero );
-  thresholder->SetInsideValue( itk::NumericTraits<MaskPixelType>::Zero );
-  thresholder->SetOutsideValue( itk::NumericTraits<MaskPixelType>::One );
-  thresholder->SetInput( labelMask );
-  brainMask = thresholder->GetOutput();
-  brainMask->Update();
-
-  /** Compute mu_tot and sigma_tot over brain mask */
-  std::cout << "Compute mu_tot and sigma_tot over entire brain..."  << std::endl;
-  statFilterBrainMask->SetInput( jacobian );
-  statFilterBrainMask->SetLabelInput( brainMask );
-  statFilterBrainMask->UseHistogramsOff();
-  statFilterBrainMask->Update();
-  double mu_tot = 0.0;
-  double sigma_tot = 0.0;
-  if( statFilterBrainMask->HasLabel( 1 ) )
+  /** Compute mu_tot and sigma_tot over the brain, the labels other than 0
+   * (assumes Hammer atlas). The sigma's are unbiased, as in
+   * itk::LabelStatisticsImageFilter.
+   */
+  double brainCount = 0.0, brainSum = 0.0, brainSumOfSquares = 0.0;
+  unsigned int maxLabelNr = 0;
+  for( unsigned int i = 0; i < NumberOfLabels; ++i )
   {
-    mu_tot = statFilterBrainMask->GetMean(1);
-    sigma_tot = statFilterBrainMask->GetSigma(1);
+    if( count[ i ] > 0.0 ) maxLabelNr = i;
+    if( i == 0 ) continue;
+    brainCount += count[ i ];
+    brainSum += sum[ i ];
+    brainSumOfSquares += sumOfSquares[ i ];
   }
-  else
+  if( brainCount == 0.0 )
   {
     itkGenericExceptionMacro( << "ERROR: the thresholded label mask image "
       << "does not contain any 1's" );
   }
 
-  /** Compute maximum label nr */
-  std::cout << "Compute maximum label nr..." << std::endl;
-  maximumComputer->SetInput( labelMask );
-  maximumComputer->Update();
-  MaskPixelType maxLabelNr = maximumComputer->GetMaximum();
-
-  /** Compute mean_i and sigma_i for each segment_i */
-  std::cout << "Compute mu_i and sigma_i for each brain segment_i in the "
-    << "label image..."  << std::endl;
-  statFilterLabels->SetInput( jacobian );
-  statFilterLabels->SetLabelInput( labelMask );
-  statFilterLabels->UseHistogramsOff();
-  statFilterLabels->Update();
-  std::vector<double> mu_i( maxLabelNr + 1, 0.0);
-  std::vector<double> sigma_i( maxLabelNr + 1, 0.0);
-  for ( MaskPixelType i = 0; i <= maxLabelNr; ++i )
+  const double mu_tot = brainSum / brainCount;
+  double sigma_tot = 0.0;
+  if( brainCount > 1.0 )
   {
-    if( statFilterLabels->HasLabel( i ) )
-    {
-      mu_i[ i ] = statFilterLabels->GetMean( i );
-      sigma_i[ i ] = statFilterLabels->GetSigma( i );
-    }
-    else
-    {
-      /** Some bogus value which will never occur */
-      mu_i[ i ] = -1000.0;
-      sigma_i[ i ] = -1000.0;
-    }
+    sigma_tot = vcl_sqrt( std::max( 0.0,
+      ( brainSumOfSquares - brainSum * brainSum / brainCount ) / ( brainCount - 1.0 ) ) );
   }
 
-  /** Compute (Jac - mu_tot)^2 image */
-  std::cout << "Compute ( jacobian - mu_tot )^2... " << std::endl;
-  subsqFilter->GetFunctor().SetScalarToSubtract( mu_tot );
-  subsqFilter->SetInput( jacobian );
-  subsqFilter->Update();
-
-  /** Compute sigma_i,tot for each segment_i */
-  std::cout << "Compute sigma_i,tot = sqrt[ mean[ ( jacobian - mu_tot )^2 ] ] "
-    << "per segment_i... " << std::endl;
-  statFilterLabelsSpecial->SetInput( subsqFilter->GetOutput() );
-  statFilterLabelsSpecial->SetLabelInput( labelMask );
-  statFilterLabelsSpecial->UseHistogramsOff();
-  statFilterLabelsSpecial->Update();
-  std::vector<double> sigma_itot( maxLabelNr + 1, 0.0);
-  for ( MaskPixelType i = 0; i <= maxLabelNr; ++i )
+  /** Compute mu_i, sigma_i and sigma_i,tot = sqrt[ mean[ ( jacobian - mu_tot )^2 ] ]
+   * for each segment_i, from the same sums.
+   */
+  std::vector<double> mu_i( maxLabelNr + 1, 0.0 );
+  std::vector<double> sigma_i( maxLabelNr + 1, 0.0 );
+  std::vector<double> sigma_itot( maxLabelNr + 1, 0.0 );
+  for( unsigned int i = 0; i <= maxLabelNr; ++i )
   {
-    if( statFilterLabelsSpecial->HasLabel( i ) )
+    const double n = count[ i ];
+    if( n > 0.0 )
     {
-      sigma_itot[ i ] = vcl_sqrt( statFilterLabelsSpecial->GetMean( i ) );
+      mu_i[ i ] = sum[ i ] / n;
+      if( n > 1.0 )
+      {
+        sigma_i[ i ] = vcl_sqrt( std::max( 0.0,
+          ( sumOfSquares[ i ] - sum[ i ] * sum[ i ] / n ) / ( n - 1.0 ) ) );
+      }
+      sigma_itot[ i ] = vcl_sqrt( std::max( 0.0,
+        ( sumOfSquares[ i ] - 2.0 * mu_tot * sum[ i ] + n * mu_tot * mu_tot ) / n ) );
     }
     else
     {
       /** Some bogus value which will never occur */
+      mu_i[ i ] = -1000.0;
+      sigma_i[ i ] = -1000.0;
       sigma_itot[ i ] = -1000.0;
     }
   }
 
   /** Write results to files */
-  std::cout << "Write results to files" << std::endl;
+  if( verbose ) std::cout << "Write results to files" << std::endl;
   std::ofstream mutotsigmatot( outputFileNames[0].c_str() );
   if( ! mutotsigmatot.is_open() )
   {
@@ -480,6 +537,130 @@ void ComputeBrainDistance(
   musigmaperlabel << sigma_itot << std::endl;
   musigmaperlabel.close();
 
-  std::cout << "Ready!" << std::endl;
+  if( verbose ) std::cout << "Ready!" << std::endl;
 
 } // end ComputeBrainDistance()
+
+
+/**
+ * ******************* BrainDistanceBatchStruct *******************
+ * The shared work queue of the batch mode: the next subject to process.
+ */
+
+struct BrainDistanceBatchStruct
+{
+  const std::vector< std::vector<std::string> > * m_Subjects;
+  std::vector<std::string> *  m_ErrorMessages;
+  unsigned int                m_Method;
+  unsigned int                m_NumberOfThreadsPerJob;
+  std::size_t                 m_NextSubject;
+  itk::SimpleFastMutexLock    m_Lock;
+};
+
+
+/**
+ * ******************* BrainDistanceBatchThreaderCallback *******************
+ * Every job takes the next subject from the queue until it is empty, so
+ * that a large field does not hold up the subjects after it.
+ */
+
+ITK_THREAD_RETURN_TYPE BrainDistanceBatchThreaderCallback( void * arg )
+{
+  itk::MultiThreader::ThreadInfoStruct * info
+    = static_cast<itk::MultiThreader::ThreadInfoStruct *>( arg );
+  BrainDistanceBatchStruct * data = static_cast<BrainDistanceBatchStruct *>( info->UserData );
+
+  const std::size_t n = data->m_Subjects->size();
+  while( true )
+  {
+    data->m_Lock.Lock();
+    const std::size_t k = data->m_NextSubject++;
+    data->m_Lock.Unlock();
+    if( k >= n ) break;
+
+    const std::vector<std::string> & subject = ( *data->m_Subjects )[ k ];
+    std::vector<std::string> outputFileNames( subject.begin() + 2, subject.end() );
+    try
+    {
+      ComputeBrainDistance( subject[ 0 ], subject[ 1 ], outputFileNames,
+        data->m_Method, data->m_NumberOfThreadsPerJob, false );
+    }
+    catch( itk::ExceptionObject & excp )
+    {
+      ( *data->m_ErrorMessages )[ k ] = excp.GetDescription();
+    }
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end BrainDistanceBatchThreaderCallback()
+
+
+/**
+ * ******************* RunBatch *******************
+ */
+
+int RunBatch( const std::string & listFileName,
+  unsigned int method, unsigned int numberOfJobs )
+{
+  /** Read the subjects: field, mask and two output files per line. */
+  std::ifstream listFile( listFileName.c_str() );
+  if( !listFile.is_open() )
+  {
+    std::cerr << "ERROR: could not open \"" << listFileName << "\"." << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::vector< std::vector<std::string> > subjects;
+  std::string line;
+  while( std::getline( listFile, line ) )
+  {
+    std::istringstream lineStream( line );
+    std::vector<std::string> subject;
+    std::string name;
+    while( lineStream >> name ) subject.push_back( name );
+    if( subject.empty() || subject[ 0 ][ 0 ] == '#' ) continue;
+    if( subject.size() != 4 )
+    {
+      std::cerr << "ERROR: the line \"" << line << "\" of \"" << listFileName
+        << "\" does not contain four file names." << std::endl;
+      return EXIT_FAILURE;
+    }
+    subjects.push_back( subject );
+  }
+  if( subjects.empty() ) return EXIT_SUCCESS;
+
+  /** Divide the threads over the jobs. */
+  const unsigned int numberOfThreads = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+  numberOfJobs = std::max( 1u, numberOfJobs );
+  if( numberOfJobs > subjects.size() )
+  {
+    numberOfJobs = static_cast<unsigned int>( subjects.size() );
+  }
+
+  std::vector<std::string> errorMessages( subjects.size(), "" );
+  BrainDistanceBatchStruct data;
+  data.m_Subjects = &subjects;
+  data.m_ErrorMessages = &errorMessages;
+  data.m_Method = method;
+  data.m_NumberOfThreadsPerJob = std::max( 1u, numberOfThreads / numberOfJobs );
+  data.m_NextSubject = 0;
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads( numberOfJobs );
+  threader->SetSingleMethod( BrainDistanceBatchThreaderCallback, &data );
+  threader->SingleMethodExecute();
+
+  /** Report the subjects that failed. */
+  bool allSucceeded = true;
+  for( std::size_t k = 0; k < subjects.size(); ++k )
+  {
+    if( errorMessages[ k ] != "" )
+    {
+      std::cerr << "ERROR: " << subjects[ k ][ 0 ] << ": " << errorMessages[ k ] << std::endl;
+      allSucceeded = false;
+    }
+  }
+
+  return allSucceeded ? EXIT_SUCCESS : EXIT_FAILURE;
+
+} // end RunBatch()
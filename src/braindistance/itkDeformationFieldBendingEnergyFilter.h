@@ -19,11 +19,13 @@
 #define __itkDeformationFieldBendingEnergyFilter_h_
 
 #include "itkConstNeighborhoodIterator.h"
+#include "itkProgressReporter.h"
 #include "itkNeighborhoodIterator.h"
 #include "itkImageToImageFilter.h"
 #include "itkImage.h"
 #include "itkVector.h"
 #include "vnl/vnl_matrix.h"
+#include <vector>
 
 //This class inherits from itkDisplacementFieldJacobianDeterminantFilter
 //and simply overrides the EvaluateAtNeighborhood function.
@@ -40,6 +42,14 @@ namespace itk
  *
  * Bending energy = sum of all squared second order derivatives.
  *
+ * The second order differences are computed directly on the buffer of
+ * the input, from the strides of the image, and the work is threaded over
+ * the output region. Outside the buffer the field is extended as constant
+ * (zero flux Neumann). The sum of the bending energy over the output
+ * region is available in GetBendingEnergy() after an update. If only that
+ * sum is needed, set ComputeEnergyOnly: the output image is then not
+ * allocated nor written.
+ *
  * This class is a specialization of the DisplacementFieldJacobianDeterminantFilter, further
  * details regarding it's implementation should be reviewed in
  * itkDisplacementFieldJacobianDeterminantFilter.h.
@@ -113,6 +123,16 @@ public:
 
   /** Superclass typedefs. */
   typedef typename Superclass::OutputImageRegionType OutputImageRegionType;
+  typedef typename InputImageType::IndexType         IndexType;
+  typedef typename InputImageType::OffsetValueType   OffsetValueType;
+
+  /** Only compute the summed bending energy, not the output image. */
+  itkSetMacro( ComputeEnergyOnly, bool );
+  itkGetConstMacro( ComputeEnergyOnly, bool );
+  itkBooleanMacro( ComputeEnergyOnly );
+
+  /** Get the bending energy summed over the output region. */
+  itkGetConstMacro( BendingEnergy, double );
 
   void PrintSelf(std::ostream& os, Indent indent) const;
   virtual TRealType EvaluateAtNeighborhood(const ConstNeighborhoodIteratorType &it) const;
@@ -120,9 +140,35 @@ protected:
   DeformationFieldBendingEnergyFilter();
   virtual ~DeformationFieldBendingEnergyFilter() {}
 
+  /** Do not allocate the output when only the energy is computed. */
+  virtual void AllocateOutputs();
+
+  /** Prepare the weights and the per-thread sums. */
+  virtual void BeforeThreadedGenerateData();
+
+  /** Compute the bending energy of a region, from buffer offsets. */
+  virtual void ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+    ThreadIdType threadId );
+
+  /** Sum the energies of the threads. */
+  virtual void AfterThreadedGenerateData();
+
+  /** The bending energy at center, given the offsets to the previous
+   * and next pixel in every dimension. */
+  RealType EvaluateAtOffsets( const InputPixelType * center,
+    const OffsetValueType * previous, const OffsetValueType * next ) const;
+
 private:
   DeformationFieldBendingEnergyFilter(const Self&); //purposely not implemented
   void operator=(const Self&); //purposely not implemented
+
+  bool                m_ComputeEnergyOnly;
+  double              m_BendingEnergy;
+  std::vector<double> m_ThreadEnergies;
+
+  /** The weights of the squared second order differences. */
+  RealType m_DiagonalWeights[ ImageDimension ];
+  RealType m_OffDiagonalWeights[ ImageDimension ][ ImageDimension ];
 };
 
 } // end namespace itk
@@ -29,6 +29,8 @@ template <typename TInputImage, typename TRealType, typename TOutputImage>
 DeformationFieldBendingEnergyFilter<TInputImage, TRealType, TOutputImage>
 ::DeformationFieldBendingEnergyFilter()
 {
+  this->m_ComputeEnergyOnly = false;
+  this->m_BendingEnergy = 0.0;
 }
 
 template <typename TInputImage, typename TRealType, typename TOutputImage>
@@ -65,12 +67,176 @@ DeformationFieldBendingEnergyFilter< TInputImage, TRealType, TOutputImage >
   return bending;
 }
 
+template <typename TInputImage, typename TRealType, typename TOutputImage>
+void
+DeformationFieldBendingEnergyFilter< TInputImage, TRealType, TOutputImage >
+::AllocateOutputs()
+{
+  if( !this->m_ComputeEnergyOnly )
+  {
+    Superclass::AllocateOutputs();
+    return;
+  }
+
+  /** Free the buffer of a previous update; the regions are kept. */
+  this->GetOutput()->Initialize();
+}
+
+template <typename TInputImage, typename TRealType, typename TOutputImage>
+void
+DeformationFieldBendingEnergyFilter< TInputImage, TRealType, TOutputImage >
+::BeforeThreadedGenerateData()
+{
+  /** Computes the half derivative weights. */
+  Superclass::BeforeThreadedGenerateData();
+
+  /** The same weights as in EvaluateAtNeighborhood(). */
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    this->m_DiagonalWeights[ i ]
+      = vcl_pow( this->m_HalfDerivativeWeights[ i ], static_cast<int>(4) );
+    for( unsigned int j = 0; j < ImageDimension; ++j )
+    {
+      this->m_OffDiagonalWeights[ i ][ j ] = 2.0 * vnl_math_sqr(
+        this->m_HalfDerivativeWeights[ i ] * this->m_HalfDerivativeWeights[ j ] );
+    }
+  }
+
+  this->m_ThreadEnergies.assign( this->GetNumberOfThreads(), 0.0 );
+}
+
+template <typename TInputImage, typename TRealType, typename TOutputImage>
+TRealType
+DeformationFieldBendingEnergyFilter< TInputImage, TRealType, TOutputImage >
+::EvaluateAtOffsets( const InputPixelType * center,
+  const OffsetValueType * previous, const OffsetValueType * next ) const
+{
+  double bending = 0.0;
+  /** diagonal terms: */
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    const InputPixelType & p = center[ next[ i ] ];
+    const InputPixelType & q = center[ previous[ i ] ];
+    double squaredNorm = 0.0;
+    for( unsigned int k = 0; k < VectorDimension; ++k )
+    {
+      const double pqc = static_cast<double>( p[ k ] ) + static_cast<double>( q[ k ] )
+        - 2.0 * static_cast<double>( ( *center )[ k ] );
+      squaredNorm += pqc * pqc;
+    }
+    bending += squaredNorm * this->m_DiagonalWeights[ i ];
+  }
+  /** off-diagonal: */
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    for( unsigned int j = i+1; j < ImageDimension; ++j )
+    {
+      const InputPixelType & p = center[ next[ i ] + next[ j ] ];
+      const InputPixelType & q = center[ previous[ i ] + previous[ j ] ];
+      const InputPixelType & r = center[ next[ i ] + previous[ j ] ];
+      const InputPixelType & s = center[ previous[ i ] + next[ j ] ];
+      double squaredNorm = 0.0;
+      for( unsigned int k = 0; k < VectorDimension; ++k )
+      {
+        const double pqrs = static_cast<double>( p[ k ] ) + static_cast<double>( q[ k ] )
+          - static_cast<double>( r[ k ] ) - static_cast<double>( s[ k ] );
+        squaredNorm += pqrs * pqrs;
+      }
+      bending += squaredNorm * this->m_OffDiagonalWeights[ i ][ j ];
+    }
+  }
+
+  return static_cast<RealType>( bending );
+}
+
+template <typename TInputImage, typename TRealType, typename TOutputImage>
+void
+DeformationFieldBendingEnergyFilter< TInputImage, TRealType, TOutputImage >
+::ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+  ThreadIdType threadId )
+{
+  const InputImageType * input = this->GetInput();
+  OutputImageType * output = this->GetOutput();
+  const SizeValueType lineLength = outputRegionForThread.GetSize()[ 0 ];
+  if( lineLength == 0 ) return;
+  const SizeValueType numberOfLines
+    = outputRegionForThread.GetNumberOfPixels() / lineLength;
+  ProgressReporter progress( this, threadId, numberOfLines );
+
+  /** The neighbors are clamped to the buffered region of the input. */
+  const typename InputImageType::RegionType bufferedRegion = input->GetBufferedRegion();
+  const IndexType bufferedBegin = bufferedRegion.GetIndex();
+  const IndexType bufferedLast = bufferedRegion.GetUpperIndex();
+  const OffsetValueType * strides = input->GetOffsetTable();
+  const InputPixelType * inBuffer = input->GetBufferPointer();
+  OutputPixelType * outBuffer = this->m_ComputeEnergyOnly
+    ? 0 : output->GetBufferPointer();
+
+  OffsetValueType previous[ ImageDimension ];
+  OffsetValueType next[ ImageDimension ];
+  IndexType index = outputRegionForThread.GetIndex();
+  const IndexType lineBegin = outputRegionForThread.GetIndex();
+  const IndexType regionLast = outputRegionForThread.GetUpperIndex();
+  double energy = 0.0;
+  for( SizeValueType line = 0; line < numberOfLines; ++line )
+  {
+    /** The offsets across the line are constant along it. */
+    for( unsigned int d = 1; d < ImageDimension; ++d )
+    {
+      previous[ d ] = index[ d ] > bufferedBegin[ d ] ? -strides[ d ] : 0;
+      next[ d ] = index[ d ] < bufferedLast[ d ] ? strides[ d ] : 0;
+    }
+
+    const InputPixelType * in = inBuffer + input->ComputeOffset( index );
+    OutputPixelType * out = outBuffer ? outBuffer + output->ComputeOffset( index ) : 0;
+    IndexValueType x = index[ 0 ];
+    for( SizeValueType i = 0; i < lineLength; ++i, ++x, ++in )
+    {
+      previous[ 0 ] = x > bufferedBegin[ 0 ] ? -1 : 0;
+      next[ 0 ] = x < bufferedLast[ 0 ] ? 1 : 0;
+      const RealType bending = this->EvaluateAtOffsets( in, previous, next );
+      energy += bending;
+      if( out ) out[ i ] = static_cast<OutputPixelType>( bending );
+    }
+
+    /** Go to the next line. */
+    for( unsigned int d = 1; d < ImageDimension; ++d )
+    {
+      if( index[ d ] < regionLast[ d ] )
+      {
+        ++index[ d ];
+        break;
+      }
+      index[ d ] = lineBegin[ d ];
+    }
+    progress.CompletedPixel();
+  }
+
+  this->m_ThreadEnergies[ threadId ] = energy;
+}
+
+template <typename TInputImage, typename TRealType, typename TOutputImage>
+void
+DeformationFieldBendingEnergyFilter< TInputImage, TRealType, TOutputImage >
+::AfterThreadedGenerateData()
+{
+  /** In thread order, so that the sum does not vary between runs. */
+  this->m_BendingEnergy = 0.0;
+  for( std::size_t t = 0; t < this->m_ThreadEnergies.size(); ++t )
+  {
+    this->m_BendingEnergy += this->m_ThreadEnergies[ t ];
+  }
+  this->m_ThreadEnergies.clear();
+}
+
 template <typename TInputImage, typename TRealType, typename TOutputImage>
 void
 DeformationFieldBendingEnergyFilter< TInputImage, TRealType, TOutputImage >
 ::PrintSelf(std::ostream& os, Indent indent) const
 {
   Superclass::PrintSelf(os,indent);
+  os << indent << "ComputeEnergyOnly: " << this->m_ComputeEnergyOnly << std::endl;
+  os << indent << "BendingEnergy: " << this->m_BendingEnergy << std::endl;
 }
 
 } // end namespace itk
@@ -0,0 +1,620 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+/** \file
+ \brief Run a tool through a content-addressed cache of its outputs.
+
+ \verbinclude cache.help
+ */
+
+#include "ITKToolsHelpers.h"
+#include "ITKToolsChecksum.h"
+#include "itkUseMevisDicomTiff.h"
+
+#include "itksys/Directory.hxx"
+#include "itksys/Process.h"
+#include "itksys/SystemTools.hxx"
+
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined( _WIN32 )
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+
+/**
+ * ******************* GetHelpString *******************
+ */
+
+std::string GetHelpString( void )
+{
+  std::stringstream ss;
+  ss << "ITKTools v" << itktools::GetITKToolsVersion() << "\n"
+    << "Run a tool through a content-addressed cache of its outputs.\n"
+    << "Usage:\n"
+    << "pxcache [-dir cacheDirectory] [-link] [-v] tool [arguments]\n"
+    << "  -dir     the cache directory, default the environment variable\n"
+    << "           ITKTOOLS_CACHE_DIR\n"
+    << "  -link    link the outputs to the cache instead of copying them\n"
+    << "  -v       report the key of the run, and whether it was cached\n"
+    << "The run is keyed by a hash of the tool executable, the ITKTools version\n"
+    << "and the arguments, sorted by option. An argument that is a file is an\n"
+    << "input, and enters the key with the checksum of its pixel data and\n"
+    << "its geometry, or of its bytes if it is not an image. The arguments of\n"
+    << "the options -out* are outputs, and enter the key with their file name,\n"
+    << "not their directory. The options -threads, -affinity, -profile, -progress,\n"
+    << "-cancelFile, -numa, -streams, -memoryLimit, -asyncWrite, -asyncQueue\n"
+    << "and -mapOutput do not change the result, and are left out.\n"
+    << "If the cache has an entry with the key, the outputs are copied from it.\n"
+    << "Otherwise the tool is run, and if it succeeds, the files it wrote for\n"
+    << "every output, e.g. out.mhd and out.raw, or the files in an output\n"
+    << "directory, are stored in a new entry. A run that does not write its\n"
+    << "-out* files themselves, e.g. pxtimeseries -outframes, which writes\n"
+    << "out_T0.mhd, ..., or pxextractslice with a pattern, or that leaves an\n"
+    << "output directory empty, is not stored. The entries are directories\n"
+    << "named after the key; an entry is touched when it is used, so that\n"
+    << "unused entries can be deleted by age. Runs with an input directory,\n"
+    << "an in-memory image or a @manifest are not cached.";
+  return ss.str();
+
+} // end GetHelpString()
+
+
+/** An output of the tool: the argument, and whether it is a directory. */
+struct CacheOutputType
+{
+  std::string m_Path;
+  bool        m_IsDirectory;
+};
+
+
+/**
+ * ******************* IsIgnoredOption *******************
+ *
+ * The common options that do not change the result of a tool.
+ */
+
+bool IsIgnoredOption( const std::string & option )
+{
+  static const char * ignored[] = { "-threads", "-affinity", "-profile",
+    "-progress", "-cancelFile", "-numa", "-streams", "-memoryLimit",
+    "-asyncWrite", "-asyncQueue", "-mapOutput", 0 };
+  for( unsigned int i = 0; ignored[ i ] != 0; ++i )
+  {
+    if( option == ignored[ i ] ) return true;
+  }
+  return false;
+
+} // end IsIgnoredOption()
+
+
+/**
+ * ******************* GetImageGeometry *******************
+ *
+ * The spacing, origin and direction of an image, from its header, which
+ * GetImageChecksum() leaves out. Printed exactly, so that any change
+ * changes the key.
+ */
+
+std::string GetImageGeometry( const std::string & fileName )
+{
+  itk::ImageIOBase::Pointer imageIOBase;
+  if( !itktools::GetImageIOBase( fileName, imageIOBase ) ) return "";
+
+  std::ostringstream geometry;
+  geometry << std::setprecision( std::numeric_limits<double>::digits10 + 2 );
+  const unsigned int dimension = imageIOBase->GetNumberOfDimensions();
+  geometry << " spacing";
+  for( unsigned int i = 0; i < dimension; ++i )
+  {
+    geometry << ( i == 0 ? ":" : "," ) << imageIOBase->GetSpacing( i );
+  }
+  geometry << " origin";
+  for( unsigned int i = 0; i < dimension; ++i )
+  {
+    geometry << ( i == 0 ? ":" : "," ) << imageIOBase->GetOrigin( i );
+  }
+  geometry << " direction";
+  for( unsigned int i = 0; i < dimension; ++i )
+  {
+    const std::vector<double> axis = imageIOBase->GetDirection( i );
+    for( unsigned int j = 0; j < axis.size(); ++j )
+    {
+      geometry << ( i == 0 && j == 0 ? ":" : "," ) << axis[ j ];
+    }
+  }
+  return geometry.str();
+
+} // end GetImageGeometry()
+
+
+/**
+ * ******************* ComputeRunKey *******************
+ *
+ * The key of a run, and its outputs. Returns false, with the reason, if
+ * the run cannot be cached.
+ */
+
+bool ComputeRunKey( const std::vector<std::string> & command,
+  std::string & key, std::vector<CacheOutputType> & outputs, std::string & reason )
+{
+  /** The tool, by the checksum of its executable. */
+  const std::string executable = itksys::SystemTools::FindProgram( command[ 0 ].c_str() );
+  std::string executableChecksum;
+  if( executable.empty() || !itktools::GetFileChecksum( executable, executableChecksum ) )
+  {
+    reason = "the tool " + command[ 0 ] + " is not found";
+    return false;
+  }
+
+  /** Group the arguments by option; the order of the options does not matter. */
+  std::map< std::string, std::vector<std::string> > options;
+  std::string option = "";
+  for( std::size_t i = 1; i < command.size(); ++i )
+  {
+    const std::string & arg = command[ i ];
+    if( arg.size() > 1 && arg[ 0 ] == '@' )
+    {
+      reason = "the manifest " + arg.substr( 1 ) + " is not checksummed";
+      return false;
+    }
+
+    /** As the argument parser: a key, unless it is a negative number. */
+    if( arg.size() > 1 && arg[ 0 ] == '-'
+      && std::string( "0123456789" ).find( arg[ 1 ] ) == std::string::npos )
+    {
+      option = arg;
+      options[ option ];
+    }
+    else
+    {
+      options[ option ].push_back( arg );
+    }
+  }
+
+  std::ostringstream description;
+  description << "pxcache 2\n"
+    << itksys::SystemTools::GetFilenameName( command[ 0 ] ) << " "
+    << executableChecksum << " " << itktools::GetITKToolsVersion() << "\n";
+  std::map< std::string, std::vector<std::string> >::const_iterator it;
+  for( it = options.begin(); it != options.end(); ++it )
+  {
+    if( IsIgnoredOption( it->first ) ) continue;
+    const bool isOutput = it->first.compare( 0, 4, "-out" ) == 0;
+    description << it->first;
+    for( std::size_t v = 0; v < it->second.size(); ++v )
+    {
+      const std::string & value = it->second[ v ];
+      if( value.compare( 0, 4, "mem:" ) == 0 )
+      {
+        reason = "the image " + value + " is in memory";
+        return false;
+      }
+
+      if( isOutput )
+      {
+        CacheOutputType output;
+        output.m_Path = value;
+        output.m_IsDirectory = itksys::SystemTools::FileIsDirectory( value.c_str() )
+          || ( !value.empty() && ( value[ value.size() - 1 ] == '/'
+          || value[ value.size() - 1 ] == '\\' ) );
+        outputs.push_back( output );
+        description << " output:" << ( output.m_IsDirectory ? "/"
+          : itksys::SystemTools::GetFilenameName( value ) );
+      }
+      else if( itksys::SystemTools::FileIsDirectory( value.c_str() ) )
+      {
+        reason = "the input " + value + " is a directory";
+        return false;
+      }
+      else if( itksys::SystemTools::FileExists( value.c_str(), true ) )
+      {
+        std::string checksum, errorMessage;
+        if( itktools::GetImageChecksum( value, false, checksum, errorMessage ) )
+        {
+          /** The checksum is of the pixels only; the geometry changes the result too. */
+          description << " input:" << checksum << GetImageGeometry( value );
+        }
+        else if( itktools::GetFileChecksum( value, checksum ) )
+        {
+          description << " input:" << checksum;
+        }
+        else
+        {
+          reason = "the input " + value + " could not be read";
+          return false;
+        }
+      }
+      else
+      {
+        description << " value:" << value;
+      }
+    }
+    description << "\n";
+  }
+
+  if( outputs.empty() )
+  {
+    reason = "the tool has no -out* arguments";
+    return false;
+  }
+
+  key = itktools::GetStringChecksum( description.str() );
+  return true;
+
+} // end ComputeRunKey()
+
+
+/**
+ * ******************* GetCompanionFile *******************
+ *
+ * The data file that belongs to the header file of an output, in the same
+ * directory, e.g. out.raw for out.mhd, or "" if there is none.
+ */
+
+std::string GetCompanionFile( const std::string & path )
+{
+  const std::string extension = itksys::SystemTools::LowerCase(
+    itksys::SystemTools::GetFilenameLastExtension( path ) );
+  const std::string stem = itksys::SystemTools::GetFilenameWithoutLastExtension( path );
+
+  /** Analyze pairs. */
+  if( extension == ".hdr" ) return stem + ".img";
+  if( extension == ".img" ) return stem + ".hdr";
+
+  /** The ElementDataFile of a MetaImage header, unless the data are in
+   * the header, or in a list or pattern of files.
+   */
+  if( extension != ".mhd" ) return "";
+  std::ifstream header( path.c_str() );
+  std::string line;
+  while( std::getline( header, line ) )
+  {
+    const std::string::size_type equals = line.find( '=' );
+    if( equals == std::string::npos ) continue;
+    std::string field = line.substr( 0, equals );
+    std::string value = line.substr( equals + 1 );
+    field.erase( field.find_last_not_of( " \t\r" ) + 1 );
+    value.erase( 0, value.find_first_not_of( " \t" ) );
+    value.erase( value.find_last_not_of( " \t\r" ) + 1 );
+    if( field != "ElementDataFile" ) continue;
+    if( value == "LOCAL" || value.compare( 0, 4, "LIST" ) == 0
+      || value.find( ' ' ) != std::string::npos
+      || itksys::SystemTools::GetFilenameName( value ) != value )
+    {
+      return "";
+    }
+    return value;
+  }
+  return "";
+
+} // end GetCompanionFile()
+
+
+/**
+ * ******************* GetWrittenFiles *******************
+ *
+ * The files a run wrote for an output, i.e. that were modified since
+ * startTime: for a file out.ext the file itself and its data file, e.g.
+ * out.mhd and out.raw; for a directory the files in it. Other files in
+ * the directory of a file output are never taken, since concurrent runs
+ * may write there.
+ */
+
+std::vector<std::string> GetWrittenFiles( const CacheOutputType & output,
+  const long startTime )
+{
+  std::string directory = output.m_Path;
+  std::vector<std::string> candidates;
+  if( !output.m_IsDirectory )
+  {
+    directory = itksys::SystemTools::GetFilenamePath( output.m_Path );
+    candidates.push_back( itksys::SystemTools::GetFilenameName( output.m_Path ) );
+    const std::string companion = GetCompanionFile( output.m_Path );
+    if( !companion.empty() && companion != candidates[ 0 ] )
+    {
+      candidates.push_back( companion );
+    }
+  }
+  if( directory.empty() ) directory = ".";
+
+  if( output.m_IsDirectory )
+  {
+    itksys::Directory listing;
+    if( !listing.Load( directory.c_str() ) ) return candidates;
+    for( unsigned long i = 0; i < listing.GetNumberOfFiles(); ++i )
+    {
+      candidates.push_back( listing.GetFile( i ) );
+    }
+  }
+
+  std::vector<std::string> files;
+  for( std::size_t i = 0; i < candidates.size(); ++i )
+  {
+    const std::string path = directory + "/" + candidates[ i ];
+    if( !itksys::SystemTools::FileExists( path.c_str(), true )
+      || itksys::SystemTools::ModifiedTime( path.c_str() ) < startTime )
+    {
+      continue;
+    }
+    files.push_back( candidates[ i ] );
+  }
+  std::sort( files.begin(), files.end() );
+  return files;
+
+} // end GetWrittenFiles()
+
+
+/**
+ * ******************* RestoreEntry *******************
+ *
+ * Copy or link the files of every output from the entry. The entry has
+ * a subdirectory 0, 1, ... per output.
+ */
+
+bool RestoreEntry( const std::string & entry,
+  const std::vector<CacheOutputType> & outputs, const bool link )
+{
+  for( std::size_t o = 0; o < outputs.size(); ++o )
+  {
+    std::ostringstream stored;
+    stored << entry << "/" << o;
+    std::string directory = outputs[ o ].m_IsDirectory ? outputs[ o ].m_Path
+      : itksys::SystemTools::GetFilenamePath( outputs[ o ].m_Path );
+    if( directory.empty() ) directory = ".";
+    itksys::SystemTools::MakeDirectory( directory.c_str() );
+
+    itksys::Directory listing;
+    if( !listing.Load( stored.str().c_str() ) ) return false;
+    for( unsigned long i = 0; i < listing.GetNumberOfFiles(); ++i )
+    {
+      const std::string name = listing.GetFile( i );
+      const std::string source = stored.str() + "/" + name;
+      if( itksys::SystemTools::FileIsDirectory( source.c_str() ) ) continue;
+
+      /** Never write through an earlier link into the cache. */
+      const std::string destination = directory + "/" + name;
+      itksys::SystemTools::RemoveFile( destination.c_str() );
+      const std::string absoluteSource
+        = itksys::SystemTools::CollapseFullPath( source.c_str() );
+      if( !( link && itksys::SystemTools::CreateSymlink(
+          absoluteSource.c_str(), destination.c_str() ) )
+        && !itksys::SystemTools::CopyFileAlways( source.c_str(), destination.c_str() ) )
+      {
+        std::cerr << "ERROR: could not copy " << source << " to "
+          << destination << "." << std::endl;
+        return false;
+      }
+    }
+  }
+
+  /** Mark the entry as used. */
+  itksys::SystemTools::Touch( entry.c_str(), false );
+  return true;
+
+} // end RestoreEntry()
+
+
+/**
+ * ******************* StoreEntry *******************
+ *
+ * Store the files written for every output in a new entry. The entry is
+ * filled under a temporary name and then renamed, so that concurrent
+ * runs never see an incomplete entry. Nothing is stored if the tool did
+ * not write a file output itself, e.g. since it wrote out_T0.mhd, ... for
+ * -outframes out.mhd, or a pattern of slices, or an output directory
+ * stayed empty; a hit on such an entry would restore nothing. Returns
+ * whether the entry was stored.
+ */
+
+bool StoreEntry( const std::string & cacheDirectory, const std::string & entry,
+  const std::vector<CacheOutputType> & outputs, const long startTime )
+{
+  /** Collect the files first, so that an incomplete entry is never made. */
+  std::vector< std::vector<std::string> > writtenFiles( outputs.size() );
+  for( std::size_t o = 0; o < outputs.size(); ++o )
+  {
+    writtenFiles[ o ] = GetWrittenFiles( outputs[ o ], startTime );
+    const std::string name = itksys::SystemTools::GetFilenameName( outputs[ o ].m_Path );
+    if( writtenFiles[ o ].empty() || ( !outputs[ o ].m_IsDirectory
+      && std::find( writtenFiles[ o ].begin(), writtenFiles[ o ].end(), name )
+      == writtenFiles[ o ].end() ) )
+    {
+      std::cerr << "WARNING: the tool did not write the output "
+        << outputs[ o ].m_Path << " itself, so the run is not cached." << std::endl;
+      return false;
+    }
+  }
+
+  std::ostringstream temporary;
+  temporary << entry << ".tmp" << getpid();
+  itksys::SystemTools::RemoveADirectory( temporary.str().c_str() );
+
+  bool success = itksys::SystemTools::MakeDirectory( cacheDirectory.c_str() );
+  for( std::size_t o = 0; success && o < outputs.size(); ++o )
+  {
+    std::ostringstream stored;
+    stored << temporary.str() << "/" << o;
+    success = itksys::SystemTools::MakeDirectory( stored.str().c_str() );
+
+    std::string directory = outputs[ o ].m_IsDirectory ? outputs[ o ].m_Path
+      : itksys::SystemTools::GetFilenamePath( outputs[ o ].m_Path );
+    if( directory.empty() ) directory = ".";
+    const std::vector<std::string> & files = writtenFiles[ o ];
+    for( std::size_t f = 0; success && f < files.size(); ++f )
+    {
+      success = itksys::SystemTools::CopyFileAlways(
+        ( directory + "/" + files[ f ] ).c_str(),
+        ( stored.str() + "/" + files[ f ] ).c_str() );
+    }
+  }
+
+  /** A concurrent run may have stored the same entry already. */
+  if( !success || !itksys::SystemTools::RenameFile(
+    temporary.str().c_str(), entry.c_str() ) )
+  {
+    itksys::SystemTools::RemoveADirectory( temporary.str().c_str() );
+    if( !success )
+    {
+      std::cerr << "WARNING: the outputs could not be stored in the cache "
+        << cacheDirectory << "." << std::endl;
+    }
+    return success && itksys::SystemTools::FileIsDirectory( entry.c_str() );
+  }
+  return true;
+
+} // end StoreEntry()
+
+
+/**
+ * ******************* RunCommand *******************
+ *
+ * Run the tool, with the standard streams of this program. Returns its
+ * exit code.
+ */
+
+int RunCommand( const std::vector<std::string> & command )
+{
+  std::vector<const char *> commandLine;
+  for( std::size_t i = 0; i < command.size(); ++i )
+  {
+    commandLine.push_back( command[ i ].c_str() );
+  }
+  commandLine.push_back( 0 );
+
+  itksysProcess * process = itksysProcess_New();
+  itksysProcess_SetCommand( process, &commandLine[ 0 ] );
+  itksysProcess_SetPipeShared( process, itksysProcess_Pipe_STDIN, 1 );
+  itksysProcess_SetPipeShared( process, itksysProcess_Pipe_STDOUT, 1 );
+  itksysProcess_SetPipeShared( process, itksysProcess_Pipe_STDERR, 1 );
+  itksysProcess_Execute( process );
+  itksysProcess_WaitForExit( process, 0 );
+
+  int result = EXIT_FAILURE;
+  switch( itksysProcess_GetState( process ) )
+  {
+    case itksysProcess_State_Exited:
+      result = itksysProcess_GetExitValue( process );
+      break;
+    case itksysProcess_State_Error:
+      std::cerr << "ERROR: could not run " << command[ 0 ] << ": "
+        << itksysProcess_GetErrorString( process ) << std::endl;
+      break;
+    case itksysProcess_State_Exception:
+      std::cerr << "ERROR: " << command[ 0 ] << " crashed: "
+        << itksysProcess_GetExceptionString( process ) << std::endl;
+      break;
+    default:
+      break;
+  }
+  itksysProcess_Delete( process );
+  return result;
+
+} // end RunCommand()
+
+//-------------------------------------------------------------------------------------
+
+int main( int argc, char ** argv )
+{
+  /** The cache has its own options, up to the tool. */
+  std::string cacheDirectory = "";
+  itksys::SystemTools::GetEnv( "ITKTOOLS_CACHE_DIR", cacheDirectory );
+  bool link = false;
+  bool verbose = false;
+  int first = 1;
+  for( ; first < argc; ++first )
+  {
+    const std::string arg = argv[ first ];
+    if( arg == "-dir" && first + 1 < argc ) cacheDirectory = argv[ ++first ];
+    else if( arg == "-link" ) link = true;
+    else if( arg == "-v" ) verbose = true;
+    else break;
+  }
+
+  if( first >= argc || std::string( argv[ first ] ) == "--help" )
+  {
+    std::cerr << GetHelpString() << std::endl;
+    return first >= argc ? EXIT_FAILURE : EXIT_SUCCESS;
+  }
+  if( argv[ first ][ 0 ] == '-' )
+  {
+    std::cerr << "ERROR: Unknown option \"" << argv[ first ] << "\".\n"
+      << "Call pxcache --help for the usage." << std::endl;
+    return EXIT_FAILURE;
+  }
+  const std::vector<std::string> command( argv + first, argv + argc );
+
+  /** The inputs are checksummed through the image readers. */
+  RegisterMevisDicomTiff();
+
+  /** Without a cache directory, or a key, just run the tool. */
+  std::string key, reason;
+  std::vector<CacheOutputType> outputs;
+  if( cacheDirectory.empty() )
+  {
+    reason = "no cache directory is given";
+  }
+  else if( ComputeRunKey( command, key, outputs, reason ) )
+  {
+    reason = "";
+  }
+  if( !reason.empty() )
+  {
+    if( verbose ) std::cerr << "pxcache: not cached, " << reason << "." << std::endl;
+    return RunCommand( command );
+  }
+
+  const std::string entry = cacheDirectory + "/" + key;
+  if( itksys::SystemTools::FileIsDirectory( entry.c_str() ) )
+  {
+    if( RestoreEntry( entry, outputs, link ) )
+    {
+      if( verbose ) std::cerr << "pxcache: " << key << " restored from the cache." << std::endl;
+      return EXIT_SUCCESS;
+    }
+    std::cerr << "WARNING: the cache entry " << entry
+      << " is incomplete, the tool is run." << std::endl;
+  }
+
+  /** Run the tool, and store its outputs if it succeeds. The modification
+   * times have a resolution of seconds, so the start is rounded down. */
+  const long startTime = static_cast<long>( std::time( 0 ) ) - 1;
+  const int result = RunCommand( command );
+  if( result == EXIT_SUCCESS )
+  {
+    if( StoreEntry( cacheDirectory, entry, outputs, startTime ) && verbose )
+    {
+      std::cerr << "pxcache: " << key << " stored in the cache." << std::endl;
+    }
+  }
+
+  return result;
+
+} // end main
@@ -37,6 +37,11 @@
 #include "itkCommandLineArgumentParser.h"
 #include "castconvert.h"
 #include "castconverthelpers2.h"
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
+#include <itksys/SystemTools.hxx>
+#include <algorithm>
+#include <set>
 
 // Some non-standard IO Factories
 #include "itkGE4ImageIOFactory.h"
@@ -76,6 +81,14 @@ std::string GetHelpString( void )
     << "  by supplying the seriesUID.\n"
     << "- Output images can be in all file formats ITK supports and for which\n"
     << "  the itk::ImageFileWriter works. Dicom output is not supported yet.\n"
+    << "- The .mhc format is compressed in independent blocks, which are\n"
+    << "  compressed and decompressed in parallel; other tools read only the\n"
+    << "  blocks they need, e.g. to crop or extract a slice. It is available\n"
+    << "  when ITKTools is built with ITKTOOLS_USE_CHUNKEDDEFLATE, the default.\n"
+    << "  E.g. pxcastconvert -in a.mhd -out a.mhc -z\n"
+    << "- Converting an uncompressed MetaImage to .mhd or .mha, without casting\n"
+    << "  and without \"-z\", copies the pixel data as is, in blocks, so that\n"
+    << "  it runs at disk speed with constant memory.\n"
     << "\n" << std::endl
     << "Usage:\n"
     << "pxcastconvert\n"
@@ -90,7 +103,19 @@ std::string GetHelpString( void )
     << "  [-s]     seriesUID, default the first UID found\n"
     << "  [-r]     add restrictions to generate a unique seriesUID\n"
     << "           e.g. \"0020|0012\" to add a check for acquisition number.\n"
-    << "  [-z]     compression flag; if provided, the output image is compressed\n\n"
+    << "  [-index] index file of the directory, see pxgetDICOMseriesUIDs;\n"
+    << "           only new and changed files are parsed\n"
+    << "  [-z]     compression flag; if provided, the output image is compressed\n"
+    << "OR pxcastconvert\n"
+    << "  -in      inputfilenames, or @manifest\n"
+    << "  -out     output pattern, in which %s is replaced by the name of\n"
+    << "           the input without directory and extension, e.g. out/%s.nii.gz\n"
+    << "  [-opct]  outputPixelComponentType, default equal to input\n"
+    << "  [-jobs]  maximum number of images converted concurrently;\n"
+    << "           default the number of threads\n"
+    << "  [-z]     compression flag; if provided, the output image is compressed\n"
+    << "           In this batch mode the images are converted by a pool of jobs.\n"
+    << "           A failing image is reported, and does not stop the others.\n\n"
     << "OutputPixelComponentType should be one of {[unsigned_]char, [unsigned_]short,\n"
     << "  [unsigned_]int, [unsigned_]long, float, double}.\n"
     << "NB: Not every image format supports all OutputPixelComponentTypes.\n"
@@ -119,22 +144,242 @@ extern void ITKToolsCastConvertDICOM3D(
   itk::ImageIOBase::IOComponentType outputComponentType,
   ITKToolsCastConvertBase * & castConvert );
 
-//-------------------------------------------------------------------------------------
+/**
+ * ******************* CreateCastConvert *******************
+ */
 
-int main( int argc, char **argv )
+ITKToolsCastConvertBase * CreateCastConvert(
+  unsigned int dim,
+  itk::ImageIOBase::IOComponentType componentType,
+  bool isDICOM )
 {
-  /** Register some non-standard IO Factories to make the tool more useful.
-   * Copied from the Insight Applications.
-   */
-  itk::GE4ImageIOFactory::RegisterOneFactory();
-  itk::GE5ImageIOFactory::RegisterOneFactory();
-  itk::GEAdwImageIOFactory::RegisterOneFactory();
-#ifdef ITKTOOLS_ITKIOPhilipsREC_Found
-  itk::PhilipsRECImageIOFactory::RegisterOneFactory();
+  ITKToolsCastConvertBase * castConvert = NULL;
+
+  if( !isDICOM )
+  {
+    if( !castConvert ) ITKToolsCastConvert2D( dim, componentType, castConvert );
+
+#ifdef ITKTOOLS_3D_SUPPORT
+    if( !castConvert ) ITKToolsCastConvert3D( dim, componentType, castConvert );
 #endif
 
-  RegisterMevisDicomTiff();
+#ifdef ITKTOOLS_4D_SUPPORT
+    if( !castConvert ) ITKToolsCastConvert4D( dim, componentType, castConvert );
+#endif
+  }
+  else
+  {
+#ifdef ITKTOOLS_3D_SUPPORT
+    if( !castConvert ) ITKToolsCastConvertDICOM3D( dim, componentType, castConvert );
+#endif
+  }
+
+  return castConvert;
+
+} // end CreateCastConvert()
+
+
+/**
+ * ******************* GetBatchOutputFileName *******************
+ */
+
+std::string GetBatchOutputFileName(
+  const std::string & outputPattern,
+  const std::string & inputFileName )
+{
+  /** The name without directory and extension, also for e.g. ".nii.gz". */
+  std::string baseName
+    = itksys::SystemTools::GetFilenameWithoutLastExtension( inputFileName );
+  if( itksys::SystemTools::GetFilenameLastExtension( inputFileName ) == ".gz" )
+  {
+    baseName = itksys::SystemTools::GetFilenameWithoutLastExtension( baseName );
+  }
+
+  std::string outputFileName = outputPattern;
+  std::string::size_type pos = outputFileName.find( "%s" );
+  while( pos != std::string::npos )
+  {
+    outputFileName.replace( pos, 2, baseName );
+    pos = outputFileName.find( "%s", pos + baseName.size() );
+  }
+
+  return outputFileName;
+
+} // end GetBatchOutputFileName()
+
+
+/** The data shared by the jobs of the batch mode. */
+struct CastConvertJobStruct
+{
+  std::vector<ITKToolsCastConvertBase *>  CastConverts;
+  std::vector<std::string>                Errors;
+  std::size_t                             NextJob;
+  itk::SimpleFastMutexLock                Mutex;
+};
+
+/** Every job thread takes the next image from the list until none is left. */
+static ITK_THREAD_RETURN_TYPE CastConvertJobThreaderCallback( void * arg )
+{
+  typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+  ThreadInfoType * info = static_cast<ThreadInfoType *>( arg );
+  CastConvertJobStruct * str = static_cast<CastConvertJobStruct *>( info->UserData );
+
+  while( true )
+  {
+    str->Mutex.Lock();
+    const std::size_t job = str->NextJob++;
+    str->Mutex.Unlock();
+    if( job >= str->CastConverts.size() ) break;
+
+    /** Images that could not be set up already have their error. */
+    ITKToolsCastConvertBase * castConvert = str->CastConverts[ job ];
+    if( castConvert == NULL ) continue;
+
+    std::string error = "";
+    try
+    {
+      castConvert->Run();
+    }
+    catch( itk::ExceptionObject & excp )
+    {
+      error = excp.GetDescription();
+    }
+    catch( std::exception & excp )
+    {
+      error = excp.what();
+    }
+
+    if( !error.empty() )
+    {
+      str->Mutex.Lock();
+      str->Errors[ job ] = error;
+      str->Mutex.Unlock();
+    }
+
+    /** Release the tool, and thereby the images of this job. */
+    delete castConvert;
+    str->CastConverts[ job ] = NULL;
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end CastConvertJobThreaderCallback()
+
+
+/**
+ * ******************* CastConvertBatch *******************
+ */
 
+int CastConvertBatch(
+  itk::CommandLineArgumentParser * parser,
+  const std::vector<std::string> & inputFileNames,
+  const std::string & outputPattern,
+  bool retopct,
+  itk::ImageIOBase::IOComponentType outputComponentType,
+  bool useCompression,
+  unsigned int numberOfJobs )
+{
+  const std::size_t numberOfImages = inputFileNames.size();
+
+  /** Determine the output names, which should all differ. */
+  if( outputPattern.find( "%s" ) == std::string::npos )
+  {
+    std::cerr << "ERROR: with more than one input, \"-out\" should be a pattern "
+      << "containing %s." << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::vector<std::string> outputFileNames( numberOfImages );
+  std::set<std::string> uniqueOutputFileNames;
+  for( std::size_t i = 0; i < numberOfImages; ++i )
+  {
+    outputFileNames[ i ] = GetBatchOutputFileName( outputPattern, inputFileNames[ i ] );
+    if( !uniqueOutputFileNames.insert( outputFileNames[ i ] ).second )
+    {
+      std::cerr << "ERROR: more than one input is converted to "
+        << outputFileNames[ i ] << "." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  /** Read all headers up front, in parallel. The jobs then only read the
+   * cache of ImageIOBase objects, and never modify it concurrently.
+   */
+  itktools::ValidateImageHeaders( inputFileNames );
+
+  /** Set up a tool for every image. An image that cannot be set up is
+   * reported as failed, the others are converted anyway.
+   */
+  CastConvertJobStruct str;
+  str.CastConverts.resize( numberOfImages, NULL );
+  str.Errors.resize( numberOfImages );
+  str.NextJob = 0;
+  for( std::size_t i = 0; i < numberOfImages; ++i )
+  {
+    if( itktools::GetCachedImageIOBase( inputFileNames[ i ] ).IsNull() )
+    {
+      str.Errors[ i ] = "could not read the image header.";
+      continue;
+    }
+
+    unsigned int dim = 0;
+    itktools::GetImageDimension( inputFileNames[ i ], dim );
+    itk::ImageIOBase::IOComponentType componentType = retopct
+      ? outputComponentType : itktools::GetImageComponentType( inputFileNames[ i ] );
+
+    ITKToolsCastConvertBase * castConvert = CreateCastConvert( dim, componentType, false );
+    if( castConvert == NULL )
+    {
+      std::ostringstream error;
+      error << "dimension " << dim << " and component type "
+        << itk::ImageIOBase::GetComponentTypeAsString( componentType )
+        << " are not supported.";
+      str.Errors[ i ] = error.str();
+      continue;
+    }
+
+    castConvert->m_InputFileName = inputFileNames[ i ];
+    castConvert->m_OutputFileName = outputFileNames[ i ];
+    castConvert->m_UseCompression = useCompression;
+    castConvert->ReadCommonArguments( parser );
+    str.CastConverts[ i ] = castConvert;
+  }
+
+  /** Determine the number of concurrent jobs. The threads are divided
+   * over the jobs, so that the filters of a job do not oversubscribe.
+   */
+  const unsigned int numberOfThreads = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+  if( numberOfJobs == 0 ) numberOfJobs = numberOfThreads;
+  numberOfJobs = std::min( numberOfJobs, static_cast<unsigned int>( numberOfImages ) );
+  numberOfJobs = std::min( numberOfJobs, static_cast<unsigned int>( ITK_MAX_THREADS ) );
+  itk::MultiThreader::SetGlobalDefaultNumberOfThreads(
+    std::max( numberOfThreads / numberOfJobs, 1u ) );
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads( numberOfJobs );
+  threader->SetSingleMethod( CastConvertJobThreaderCallback, &str );
+  threader->SingleMethodExecute();
+
+  itk::MultiThreader::SetGlobalDefaultNumberOfThreads( numberOfThreads );
+
+  /** Report the images that failed. */
+  std::size_t numberOfFailures = 0;
+  for( std::size_t i = 0; i < numberOfImages; ++i )
+  {
+    if( str.Errors[ i ].empty() ) continue;
+    std::cerr << "ERROR: " << inputFileNames[ i ] << ": " << str.Errors[ i ] << std::endl;
+    ++numberOfFailures;
+  }
+  std::cout << "Converted " << numberOfImages - numberOfFailures << " of "
+    << numberOfImages << " images." << std::endl;
+
+  return numberOfFailures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+
+} // end CastConvertBatch()
+
+//-------------------------------------------------------------------------------------
+
+int CastConvertMain( int argc, char ** argv )
+{
   /** Construct the command line argument parser. */
   itk::CommandLineArgumentParser::Pointer parser = itk::CommandLineArgumentParser::New();
   parser->SetCommandLineArguments( argc, argv );
@@ -156,8 +401,8 @@ int main( int argc, char **argv )
   }
 
   /** Get the command line arguments. */
-  std::string input = "";
-  parser->GetCommandLineArgument( "-in", input );
+  std::vector<std::string> inputs;
+  parser->GetCommandLineArgument( "-in", inputs );
 
   std::string outputFileName = "";
   parser->GetCommandLineArgument( "-out", outputFileName );
@@ -171,8 +416,14 @@ int main( int argc, char **argv )
   std::vector<std::string> restrictions;
   parser->GetCommandLineArgument( "-r", restrictions );
 
+  std::string indexFileName = "";
+  parser->GetCommandLineArgument( "-index", indexFileName );
+
   bool useCompression = parser->ArgumentExists( "-z" );
 
+  unsigned int numberOfJobs = 0;
+  parser->GetCommandLineArgument( "-jobs", numberOfJobs );
+
   /** Check -opct. */
   if( retopct )
   {
@@ -186,6 +437,15 @@ int main( int argc, char **argv )
     }
   }
 
+  /** Convert a list of images concurrently. */
+  if( inputs.size() > 1 )
+  {
+    return CastConvertBatch( parser, inputs, outputFileName, retopct,
+      itk::ImageIOBase::GetComponentTypeFromString( outputPixelComponentType ),
+      useCompression, numberOfJobs );
+  }
+  std::string input = inputs.empty() ? "" : inputs[ 0 ];
+
   /** Are we dealing with an image or a DICOM series? */
   bool isDICOM = false;
   bool allOK = IsDICOM( input, isDICOM );
@@ -198,6 +458,7 @@ int main( int argc, char **argv )
   /** Get image information. */
   std::string inputFileName = "";
   std::string inputDirectoryName = "";
+  std::vector<std::string> seriesFileNames;
   unsigned int dim = 0;
   if( !isDICOM )
   {
@@ -212,7 +473,7 @@ int main( int argc, char **argv )
     std::string errorMessage = "";
     bool allOK = GetFileNameFromDICOMDirectory(
       inputDirectoryName, fileNameOfFirstDICOMImage,
-      seriesUID, restrictions, errorMessage );
+      seriesUID, restrictions, indexFileName, seriesFileNames, errorMessage );
     if( !allOK )
     {
       std::cerr << errorMessage << std::endl;
@@ -236,24 +497,8 @@ int main( int argc, char **argv )
 
   try
   {
-    if( !isDICOM )
-    {
-      if( !castConvert ) ITKToolsCastConvert2D( dim, componentType, castConvert );
+    castConvert = CreateCastConvert( dim, componentType, isDICOM );
 
-#ifdef ITKTOOLS_3D_SUPPORT
-      if( !castConvert ) ITKToolsCastConvert3D( dim, componentType, castConvert );
-#endif
-
-#ifdef ITKTOOLS_4D_SUPPORT
-      if( !castConvert ) ITKToolsCastConvert4D( dim, componentType, castConvert );
-#endif
-    }
-    else
-    {
-#ifdef ITKTOOLS_3D_SUPPORT
-      if( !castConvert ) ITKToolsCastConvertDICOM3D( dim, componentType, castConvert );
-#endif
-    }
     /** Check if filter was instantiated. */
     bool supported = itktools::IsFilterSupportedCheck( castConvert, dim, componentType );
     if( !supported ) return EXIT_FAILURE;
@@ -266,7 +511,9 @@ int main( int argc, char **argv )
     castConvert->m_InputDirectoryName = inputDirectoryName;
     castConvert->m_DICOMSeriesUID = seriesUID;
     castConvert->m_DICOMSeriesRestrictions = restrictions;
+    castConvert->m_DICOMFileNames = seriesFileNames;
 
+    castConvert->ReadCommonArguments( parser );
     castConvert->Run();
 
     delete castConvert;
@@ -281,4 +528,31 @@ int main( int argc, char **argv )
   /** End  program. Return success. */
   return EXIT_SUCCESS;
 
-}  // end main
+} // end CastConvertMain()
+
+
+//-------------------------------------------------------------------------------------
+
+int main( int argc, char ** argv )
+{
+  /** Register some non-standard IO Factories to make the tool more useful.
+   * Copied from the Insight Applications. Only once, since main() runs
+   * for every job with --batch.
+   */
+  static bool registered = false;
+  if( !registered )
+  {
+    registered = true;
+    itk::GE4ImageIOFactory::RegisterOneFactory();
+    itk::GE5ImageIOFactory::RegisterOneFactory();
+    itk::GEAdwImageIOFactory::RegisterOneFactory();
+#ifdef ITKTOOLS_ITKIOPhilipsREC_Found
+    itk::PhilipsRECImageIOFactory::RegisterOneFactory();
+#endif
+  }
+
+  RegisterMevisDicomTiff();
+
+  return CastConvertMain( argc, argv );
+
+} // end main
@@ -35,6 +35,7 @@
 /** DICOM headers. */
 #include "itkGDCMImageIO.h"
 #include "itkGDCMSeriesFileNames.h"
+#include "itkParallelDICOMSeriesReader.h"
 
 /** One of these is used to cast the image. */
 #include "itkCastImageFilter.h"
@@ -77,6 +78,14 @@ public:
   std::string m_DICOMSeriesUID;
   std::vector<std::string> m_DICOMSeriesRestrictions;
 
+  /** The ordered files of the series, if already known. Otherwise they
+   * are determined from the directory, with GDCMSeriesFileNames.
+   */
+  std::vector<std::string> m_DICOMFileNames;
+
+  /** This tool supports streaming. */
+  virtual bool GetSupportsStreaming( void ) const { return true; }
+
 }; // end class ITKToolsCastConvertBase
 
 
@@ -107,10 +116,24 @@ public:
     typedef typename itk::ImageFileReader< InputVectorImageType >     ImageReaderType;
     typedef typename itk::ImageFileWriter< OutputVectorImageType >    ImageWriterType;
 
+    /** Converting an uncompressed MetaImage to another one, without
+     * casting, only needs a new header and a copy of the pixel data.
+     */
+    itk::ImageIOBase::Pointer imageIOBase;
+    if( !this->m_UseCompression
+      && itktools::GetImageIOBase( this->m_InputFileName, imageIOBase )
+      && imageIOBase->GetComponentType()
+        == itk::ImageIOBase::MapPixelType<TComponentType>::CType
+      && itktools::CopyMetaImageData( this->m_InputFileName,
+        this->m_OutputFileName, imageIOBase ) )
+    {
+      return;
+    }
+
     /** Create and setup the reader. */
     typename ImageReaderType::Pointer reader = ImageReaderType::New();
     reader->SetFileName( this->m_InputFileName.c_str() );
-    reader->Update();
+    itktools::SetCachedImageIOBase( reader.GetPointer() );
 
     // Create the disassembler
     typedef itk::VectorIndexSelectionCastImageFilter<
@@ -128,13 +151,20 @@ public:
     typename CastImageFilterType::Pointer castImageFilter = CastImageFilterType::New();
 
     castImageFilter->SetInput( reader->GetOutput() );
-    castImageFilter->Update();
 
+    /** Setup writer. No intermediate calls to Update() are allowed,
+     * otherwise streaming does not work.
+     */
     typename ImageWriterType::Pointer writer = ImageWriterType::New();
     writer->SetFileName( this->m_OutputFileName.c_str() );
     writer->SetUseCompression( this->m_UseCompression );
     writer->SetInput( castImageFilter->GetOutput() );
-    writer->Update();
+    this->SetStreamingOnWriter( writer.GetPointer() );
+
+    this->ObserveProcess( reader.GetPointer(), "read" );
+    this->ObserveProcess( castImageFilter.GetPointer(), "cast" );
+    this->ObserveProcess( writer.GetPointer(), "write" );
+    this->UpdateWriter( writer.GetPointer() );
 
   } // end Run()
 
@@ -161,50 +191,48 @@ public:
   /** Run function. */
   virtual void Run( void )
   {
-    /** Typedef the correct reader, caster and writer. */
-    typedef itk::Image< double, VDimension >                          InputScalarImageType;
+    /** Typedef the correct reader and writer. */
     typedef itk::Image< TComponentType, VDimension >                  OutputScalarImageType;
-
-    typedef typename itk::ImageSeriesReader< InputScalarImageType >   SeriesReaderType;
-    typedef typename itk::CastImageFilter<
-      InputScalarImageType, OutputScalarImageType >                   CastFilterType;
+    typedef itk::ParallelDICOMSeriesReader< OutputScalarImageType >   SeriesReaderType;
     typedef typename itk::ImageFileWriter< OutputScalarImageType >    ImageWriterType;
 
     /** Typedef DICOM stuff. */
-    typedef itk::GDCMImageIO                  GDCMImageIOType;
     typedef itk::GDCMSeriesFileNames          GDCMNamesGeneratorType;
     typedef std::vector< std::string >        FileNamesContainerType;
 
-    /** Create the DICOM ImageIO. */
-    typename GDCMImageIOType::Pointer dicomIO = GDCMImageIOType::New();
-
     /** Get a list of the filenames of the 2D input DICOM images. */
-    GDCMNamesGeneratorType::Pointer nameGenerator = GDCMNamesGeneratorType::New();
-    nameGenerator->SetUseSeriesDetails( true );
-    for( unsigned int i = 0; i < this->m_DICOMSeriesRestrictions.size(); ++i )
+    FileNamesContainerType fileNames = this->m_DICOMFileNames;
+    if( fileNames.empty() )
     {
-      nameGenerator->AddSeriesRestriction( this->m_DICOMSeriesRestrictions[ i ] );
+      GDCMNamesGeneratorType::Pointer nameGenerator = GDCMNamesGeneratorType::New();
+      nameGenerator->SetUseSeriesDetails( true );
+      for( unsigned int i = 0; i < this->m_DICOMSeriesRestrictions.size(); ++i )
+      {
+        nameGenerator->AddSeriesRestriction( this->m_DICOMSeriesRestrictions[ i ] );
+      }
+      nameGenerator->SetInputDirectory( this->m_InputDirectoryName.c_str() );
+      fileNames = nameGenerator->GetFileNames( this->m_DICOMSeriesUID );
     }
-    nameGenerator->SetInputDirectory( this->m_InputDirectoryName.c_str() );
-    FileNamesContainerType fileNames = nameGenerator->GetFileNames( this->m_DICOMSeriesUID );
 
-    /** Create and setup the seriesReader. */
+    /** Create and setup the seriesReader. The slices are decoded in
+     * parallel, directly to the output component type.
+     */
     typename SeriesReaderType::Pointer seriesReader = SeriesReaderType::New();
     seriesReader->SetFileNames( fileNames );
-    seriesReader->SetImageIO( dicomIO );
 
-    /** Create and setup caster and writer. */
-    typename CastFilterType::Pointer caster = CastFilterType::New();
+    /** Create and setup the writer. */
     typename ImageWriterType::Pointer writer = ImageWriterType::New();
     writer->SetFileName( this->m_OutputFileName.c_str()  );
     writer->SetUseCompression( this->m_UseCompression );
 
     /** Connect the pipeline. */
-    caster->SetInput(  seriesReader->GetOutput()  );
-    writer->SetInput(  caster->GetOutput()  );
+    writer->SetInput(  seriesReader->GetOutput()  );
+    this->SetStreamingOnWriter( writer.GetPointer() );
 
     /**  Do the actual  conversion.  */
-    writer->Update();
+    this->ObserveProcess( seriesReader.GetPointer(), "read" );
+    this->ObserveProcess( writer.GetPointer(), "write" );
+    this->UpdateWriter( writer.GetPointer() );
 
   } // end Run()
 
@@ -20,6 +20,7 @@
 
 #include <itksys/SystemTools.hxx>
 #include "itkGDCMSeriesFileNames.h"
+#include "ITKToolsDICOMSeriesIndex.h"
 
 
 // NOTE that these functions can not be moved to castconverthelpers.h,
@@ -64,11 +65,38 @@ bool GetFileNameFromDICOMDirectory(
   std::string & fileName,
   const std::string & seriesUID,
   const std::vector<std::string> & restrictions,
+  const std::string & indexFileName,
+  std::vector<std::string> & seriesFileNames,
   std::string & errorMessage )
 {
   typedef itk::GDCMSeriesFileNames                GDCMNamesGeneratorType;
   typedef std::vector< std::string >              FileNamesContainerType;
 
+  /** With an index, only new and changed files are parsed, and the files
+   * of the series are known without scanning the directory again.
+   */
+  if( indexFileName != "" )
+  {
+    itktools::DICOMSeriesIndex seriesIndex;
+    seriesIndex.SetDirectory( inputDirectoryName );
+    for( unsigned int i = 0; i < restrictions.size(); ++i )
+    {
+      seriesIndex.AddSeriesRestriction( restrictions[ i ] );
+    }
+    seriesIndex.SetIndexFileName( indexFileName );
+    if( !seriesIndex.Update( errorMessage ) ) return false;
+
+    seriesFileNames = seriesIndex.GetFileNames( seriesUID );
+    if( !seriesFileNames.size() )
+    {
+      errorMessage = "ERROR: no DICOM series " + seriesUID
+        + " in directory " + inputDirectoryName + ".";
+      return false;
+    }
+    fileName = seriesFileNames[ 0 ];
+    return true;
+  }
+
   /** Create vector of filenames from the DICOM directory. */
   GDCMNamesGeneratorType::Pointer nameGenerator = GDCMNamesGeneratorType::New();
   nameGenerator->SetUseSeriesDetails( true );
@@ -114,6 +142,7 @@ bool GetFileNameFromDICOMDirectory(
 
   /** Get a name of a 2D image. */
   fileName = fileNames[ 0 ];
+  seriesFileNames = fileNames;
 
   /** Return a value. */
   return true;
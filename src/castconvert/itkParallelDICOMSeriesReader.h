@@ -0,0 +1,119 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkParallelDICOMSeriesReader_h_
+#define __itkParallelDICOMSeriesReader_h_
+
+#include "itkImageSource.h"
+#include "itkSimpleFastMutexLock.h"
+#include <string>
+#include <vector>
+
+namespace itk
+{
+
+/** \class ParallelDICOMSeriesReader
+ * \brief Read a DICOM series into a volume, decoding the slices in parallel.
+ *
+ * The geometry is determined from the headers of the first and the last
+ * slice only, before any pixel data is decoded: the in-plane size, spacing
+ * and direction of the first slice, and the slice spacing from the distance
+ * between the first and the last slice along the slice normal. The file
+ * names should therefore be sorted along the normal, as done by
+ * GDCMSeriesFileNames.
+ *
+ * The volume is then allocated once, and the threads take the next slice
+ * until none is left. Every thread decodes its slices with its own
+ * GDCMImageIO, which pays off for compressed transfer syntaxes, such as
+ * JPEG-2000 and JPEG-lossless, where decoding dominates the reading time.
+ * Every slice should have the size of the first slice.
+ *
+ * \ingroup IOFilters
+ */
+
+template< class TOutputImage >
+class ITK_EXPORT ParallelDICOMSeriesReader :
+  public ImageSource< TOutputImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef ParallelDICOMSeriesReader       Self;
+  typedef ImageSource< TOutputImage >     Superclass;
+  typedef SmartPointer<Self>              Pointer;
+  typedef SmartPointer<const Self>        ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( ParallelDICOMSeriesReader, ImageSource );
+
+  /** Typedefs. */
+  typedef TOutputImage                                OutputImageType;
+  typedef typename OutputImageType::PixelType         OutputPixelType;
+  typedef typename OutputImageType::RegionType        OutputImageRegionType;
+  typedef std::vector<std::string>                    FileNamesContainerType;
+
+  itkStaticConstMacro( ImageDimension, unsigned int, TOutputImage::ImageDimension );
+
+  /** Set/Get the file names of the slices, sorted along the slice normal. */
+  void SetFileNames( const FileNamesContainerType & fileNames );
+  const FileNamesContainerType & GetFileNames( void ) const
+  {
+    return this->m_FileNames;
+  }
+
+protected:
+  ParallelDICOMSeriesReader();
+  virtual ~ParallelDICOMSeriesReader() {};
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** Determine the geometry of the volume from the first and last header. */
+  virtual void GenerateOutputInformation( void );
+
+  /** The volume is always produced as a whole. */
+  virtual void EnlargeOutputRequestedRegion( DataObject * output );
+
+  /** Allocate the volume, and decode the slices in parallel. */
+  virtual void GenerateData( void );
+
+  /** Decode one slice into the volume. */
+  void ReadSlice( std::size_t slice );
+
+  /** Every thread takes the next slice until none is left. */
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback( void * arg );
+
+private:
+  ParallelDICOMSeriesReader( const Self & ); // purposely not implemented
+  void operator=( const Self & );            // purposely not implemented
+
+  FileNamesContainerType  m_FileNames;
+
+  /** The slice counter and the first error of the threads. */
+  std::size_t             m_NextSlice;
+  std::string             m_ErrorMessage;
+  SimpleFastMutexLock     m_Mutex;
+
+}; // end class ParallelDICOMSeriesReader
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkParallelDICOMSeriesReader.txx"
+#endif
+
+#endif // end #ifndef __itkParallelDICOMSeriesReader_h_
@@ -0,0 +1,299 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkParallelDICOMSeriesReader_txx_
+#define __itkParallelDICOMSeriesReader_txx_
+
+#include "itkParallelDICOMSeriesReader.h"
+#include "itkGDCMImageIO.h"
+#include "itkImageFileReader.h"
+#include "itkMultiThreader.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk
+{
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template< class TOutputImage >
+ParallelDICOMSeriesReader< TOutputImage >
+::ParallelDICOMSeriesReader()
+{
+  this->m_NextSlice = 0;
+  this->m_ErrorMessage = "";
+
+} // end Constructor
+
+
+/**
+ * ******************* SetFileNames *******************
+ */
+
+template< class TOutputImage >
+void
+ParallelDICOMSeriesReader< TOutputImage >
+::SetFileNames( const FileNamesContainerType & fileNames )
+{
+  if( this->m_FileNames != fileNames )
+  {
+    this->m_FileNames = fileNames;
+    this->Modified();
+  }
+
+} // end SetFileNames()
+
+
+/**
+ * ******************* GenerateOutputInformation *******************
+ */
+
+template< class TOutputImage >
+void
+ParallelDICOMSeriesReader< TOutputImage >
+::GenerateOutputInformation( void )
+{
+  if( ImageDimension != 3 )
+  {
+    itkExceptionMacro( << "Only 3D volumes can be read from a DICOM series." );
+  }
+  if( this->m_FileNames.empty() )
+  {
+    itkExceptionMacro( << "No DICOM files were given." );
+  }
+  const std::size_t numberOfFiles = this->m_FileNames.size();
+
+  /** Read the header of the first slice, for the in-plane geometry. */
+  GDCMImageIO::Pointer firstIO = GDCMImageIO::New();
+  firstIO->SetFileName( this->m_FileNames[ 0 ].c_str() );
+  firstIO->ReadImageInformation();
+  const SizeValueType framesPerFile = firstIO->GetNumberOfDimensions() > 2
+    ? firstIO->GetDimensions( 2 ) : 1;
+  if( numberOfFiles > 1 && framesPerFile > 1 )
+  {
+    itkExceptionMacro( << "The series holds multi-frame files, "
+      << "which can only be read one at a time." );
+  }
+
+  typename OutputImageType::SizeType size;
+  typename OutputImageType::SpacingType spacing;
+  typename OutputImageType::PointType origin;
+  typename OutputImageType::DirectionType direction;
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    const std::vector<double> axis = firstIO->GetDirection( i );
+    for( unsigned int j = 0; j < ImageDimension; ++j )
+    {
+      direction[ j ][ i ] = axis[ j ];
+    }
+    origin[ i ] = firstIO->GetOrigin( i );
+    spacing[ i ] = firstIO->GetSpacing( i );
+  }
+  size[ 0 ] = firstIO->GetDimensions( 0 );
+  size[ 1 ] = firstIO->GetDimensions( 1 );
+  size[ 2 ] = numberOfFiles * framesPerFile;
+
+  /** The slice spacing is the distance between the first and the last
+   * slice along the normal, divided by the number of gaps.
+   */
+  if( numberOfFiles > 1 )
+  {
+    GDCMImageIO::Pointer lastIO = GDCMImageIO::New();
+    lastIO->SetFileName( this->m_FileNames[ numberOfFiles - 1 ].c_str() );
+    lastIO->ReadImageInformation();
+    double distance = 0.0;
+    for( unsigned int j = 0; j < ImageDimension; ++j )
+    {
+      distance += ( lastIO->GetOrigin( j ) - origin[ j ] ) * direction[ j ][ 2 ];
+    }
+    distance = std::abs( distance ) / static_cast<double>( numberOfFiles - 1 );
+    if( distance > 1e-6 ) spacing[ 2 ] = distance;
+  }
+
+  OutputImageType * output = this->GetOutput();
+  OutputImageRegionType region;
+  region.SetSize( size );
+  output->SetLargestPossibleRegion( region );
+  output->SetSpacing( spacing );
+  output->SetOrigin( origin );
+  output->SetDirection( direction );
+
+} // end GenerateOutputInformation()
+
+
+/**
+ * ******************* EnlargeOutputRequestedRegion *******************
+ */
+
+template< class TOutputImage >
+void
+ParallelDICOMSeriesReader< TOutputImage >
+::EnlargeOutputRequestedRegion( DataObject * output )
+{
+  output->SetRequestedRegionToLargestPossibleRegion();
+
+} // end EnlargeOutputRequestedRegion()
+
+
+/**
+ * ******************* GenerateData *******************
+ */
+
+template< class TOutputImage >
+void
+ParallelDICOMSeriesReader< TOutputImage >
+::GenerateData( void )
+{
+  OutputImageType * output = this->GetOutput();
+  output->SetBufferedRegion( output->GetRequestedRegion() );
+  output->Allocate();
+
+  this->m_NextSlice = 1;
+  this->m_ErrorMessage = "";
+
+  /** Decode the first file in this thread, which also sets up the global
+   * state of GDCM before the other threads use it.
+   */
+  this->ReadSlice( 0 );
+
+  const std::size_t remainingFiles = this->m_FileNames.size() - 1;
+  if( remainingFiles > 0 )
+  {
+    MultiThreader * threader = this->GetMultiThreader();
+    threader->SetNumberOfThreads( static_cast<ThreadIdType>( std::min(
+      static_cast<std::size_t>( this->GetNumberOfThreads() ), remainingFiles ) ) );
+    threader->SetSingleMethod( Self::ThreaderCallback, this );
+    threader->SingleMethodExecute();
+  }
+
+  if( !this->m_ErrorMessage.empty() )
+  {
+    itkExceptionMacro( << this->m_ErrorMessage );
+  }
+
+} // end GenerateData()
+
+
+/**
+ * ******************* ReadSlice *******************
+ */
+
+template< class TOutputImage >
+void
+ParallelDICOMSeriesReader< TOutputImage >
+::ReadSlice( std::size_t slice )
+{
+  typedef ImageFileReader< OutputImageType > SliceReaderType;
+
+  /** Every slice gets its own ImageIO, so that they are independent. */
+  typename SliceReaderType::Pointer reader = SliceReaderType::New();
+  reader->SetImageIO( GDCMImageIO::New() );
+  reader->SetFileName( this->m_FileNames[ slice ].c_str() );
+  reader->Update();
+
+  OutputImageType * output = this->GetOutput();
+  const typename OutputImageType::SizeType & size
+    = output->GetLargestPossibleRegion().GetSize();
+  const typename OutputImageType::SizeType & sliceSize
+    = reader->GetOutput()->GetLargestPossibleRegion().GetSize();
+  if( sliceSize[ 0 ] != size[ 0 ] || sliceSize[ 1 ] != size[ 1 ]
+    || sliceSize[ 2 ] * this->m_FileNames.size() != size[ 2 ] )
+  {
+    itkExceptionMacro( << "The slice " << this->m_FileNames[ slice ]
+      << " does not have the size of " << this->m_FileNames[ 0 ] << "." );
+  }
+
+  /** Copy the decoded pixels to their place in the volume. */
+  const SizeValueType numberOfPixels
+    = reader->GetOutput()->GetLargestPossibleRegion().GetNumberOfPixels();
+  const OutputPixelType * sliceBuffer = reader->GetOutput()->GetBufferPointer();
+  std::copy( sliceBuffer, sliceBuffer + numberOfPixels,
+    output->GetBufferPointer() + slice * numberOfPixels );
+
+} // end ReadSlice()
+
+
+/**
+ * ******************* ThreaderCallback *******************
+ */
+
+template< class TOutputImage >
+ITK_THREAD_RETURN_TYPE
+ParallelDICOMSeriesReader< TOutputImage >
+::ThreaderCallback( void * arg )
+{
+  typedef MultiThreader::ThreadInfoStruct ThreadInfoType;
+  ThreadInfoType * info = static_cast<ThreadInfoType *>( arg );
+  Self * self = static_cast<Self *>( info->UserData );
+
+  while( true )
+  {
+    /** Take the next slice, unless a thread failed. */
+    self->m_Mutex.Lock();
+    const std::size_t slice = self->m_NextSlice++;
+    const bool failed = !self->m_ErrorMessage.empty();
+    self->m_Mutex.Unlock();
+    if( failed || slice >= self->m_FileNames.size() ) break;
+
+    std::string error = "";
+    try
+    {
+      self->ReadSlice( slice );
+    }
+    catch( ExceptionObject & excp )
+    {
+      error = excp.GetDescription();
+    }
+    catch( std::exception & excp )
+    {
+      error = excp.what();
+    }
+
+    if( !error.empty() )
+    {
+      self->m_Mutex.Lock();
+      if( self->m_ErrorMessage.empty() ) self->m_ErrorMessage = error;
+      self->m_Mutex.Unlock();
+    }
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end ThreaderCallback()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template< class TOutputImage >
+void
+ParallelDICOMSeriesReader< TOutputImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "FileNames: " << this->m_FileNames.size() << " files" << std::endl;
+
+} // end PrintSelf()
+
+} // end namespace itk
+
+#endif // end #ifndef __itkParallelDICOMSeriesReader_txx_
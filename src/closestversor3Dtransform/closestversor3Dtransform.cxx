@@ -39,11 +39,102 @@ std::string GetHelpString( void )
     << "Usage:\n"
     << "pxclosestversor3Dtransform\n"
     << "-f       the file containing the fixed landmarks\n"
-    << "-m       the file containing the moving landmarks";
+    << "-m       the file containing the moving landmarks\n"
+    << "[-list]  batch mode: a file with on every line the fixed and the moving\n"
+    << "         landmark file of one pair, instead of -f and -m\n"
+    << "[-out]   batch mode: the output table, default standard output\n"
+    << "In batch mode all pairs are fitted in parallel, and one table is written with on\n"
+    << "every line the two file names, the versor parameters, the Euler parameters and\n"
+    << "the center of rotation. Pairs that fail are reported, and skipped in the table.";
   return ss.str();
 
 } // end GetHelpString()
 
+
+/**
+ * ******************* RunBatch *******************
+ */
+
+int RunBatch( const std::string & listFileName, const std::string & outputFileName )
+{
+  /** Read the pairs of landmark files. */
+  std::ifstream listFile( listFileName.c_str() );
+  if( !listFile.is_open() )
+  {
+    std::cerr << "ERROR: could not open \"" << listFileName << "\"." << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::vector<std::string> fixedLandmarkFileNames, movingLandmarkFileNames;
+  std::string line;
+  while( std::getline( listFile, line ) )
+  {
+    std::istringstream lineStream( line );
+    std::string fixedName, movingName;
+    if( !( lineStream >> fixedName ) || fixedName[ 0 ] == '#' ) continue;
+    if( !( lineStream >> movingName ) )
+    {
+      std::cerr << "ERROR: the line \"" << line << "\" of \"" << listFileName
+        << "\" does not contain two file names." << std::endl;
+      return EXIT_FAILURE;
+    }
+    fixedLandmarkFileNames.push_back( fixedName );
+    movingLandmarkFileNames.push_back( movingName );
+  }
+
+  /** Fit them in parallel. */
+  std::vector< std::vector<double> > parVersors, centersOfRotation;
+  std::vector<std::string> errorMessages;
+  try
+  {
+    ComputeClosestVersorBatch( fixedLandmarkFileNames, movingLandmarkFileNames,
+      parVersors, centersOfRotation, errorMessages );
+  }
+  catch( itk::ExceptionObject &excp )
+  {
+    std::cerr << "Caught ITK exception: " << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  /** Write the table. */
+  std::ofstream outputFile;
+  if( outputFileName != "" )
+  {
+    outputFile.open( outputFileName.c_str() );
+    if( !outputFile.is_open() )
+    {
+      std::cerr << "ERROR: could not open \"" << outputFileName << "\"." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  std::ostream & table = outputFileName != "" ? outputFile : std::cout;
+  table << std::fixed << std::showpoint << std::setprecision( 6 );
+  table << "# fixed moving versor(6) Euler(6) center(3)" << std::endl;
+
+  bool allSucceeded = true;
+  for( std::size_t k = 0; k < fixedLandmarkFileNames.size(); ++k )
+  {
+    if( errorMessages[ k ] != "" )
+    {
+      std::cerr << errorMessages[ k ] << std::endl;
+      allSucceeded = false;
+      continue;
+    }
+
+    std::vector<double> parEuler;
+    ConvertVersorToEuler( parVersors[ k ], parEuler );
+
+    table << fixedLandmarkFileNames[ k ] << " " << movingLandmarkFileNames[ k ];
+    for( std::size_t i = 0; i < parVersors[ k ].size(); ++i ) table << " " << parVersors[ k ][ i ];
+    for( std::size_t i = 0; i < parEuler.size(); ++i ) table << " " << parEuler[ i ];
+    for( std::size_t i = 0; i < centersOfRotation[ k ].size(); ++i ) table << " " << centersOfRotation[ k ][ i ];
+    table << "\n";
+  }
+  table.flush();
+
+  return allSucceeded ? EXIT_SUCCESS : EXIT_FAILURE;
+
+} // end RunBatch()
+
 //-------------------------------------------------------------------------------------
 
 int main( int argc, char *argv[] )
@@ -53,8 +144,12 @@ int main( int argc, char *argv[] )
   parser->SetCommandLineArguments( argc, argv );
   parser->SetProgramHelpText( GetHelpString() );
 
-  parser->MarkArgumentAsRequired( "-f", "The fixed landmark filename." );
-  parser->MarkArgumentAsRequired( "-m", "The moving landmark filename." );
+  const bool batchMode = parser->ArgumentExists( "-list" );
+  if( !batchMode )
+  {
+    parser->MarkArgumentAsRequired( "-f", "The fixed landmark filename." );
+    parser->MarkArgumentAsRequired( "-m", "The moving landmark filename." );
+  }
 
   /** Get arguments. */
   std::string fixedLandmarkFileName = "";
@@ -63,6 +158,12 @@ int main( int argc, char *argv[] )
   std::string movingLandmarkFileName = "";
   parser->GetCommandLineArgument( "-m", movingLandmarkFileName );
 
+  std::string listFileName = "";
+  parser->GetCommandLineArgument( "-list", listFileName );
+
+  std::string outputFileName = "";
+  parser->GetCommandLineArgument( "-out", outputFileName );
+
   itk::CommandLineArgumentParser::ReturnValue validateArguments = parser->CheckForRequiredArguments();
 
   if( validateArguments == itk::CommandLineArgumentParser::FAILED )
@@ -74,6 +175,12 @@ int main( int argc, char *argv[] )
     return EXIT_SUCCESS;
   }
 
+  /** Fit all pairs of the list in one go. */
+  if( batchMode )
+  {
+    return RunBatch( listFileName, outputFileName );
+  }
+
   /** Compute the closest rigid transformation. */
   std::vector<double> parVersor, centerOfRotation;
   try
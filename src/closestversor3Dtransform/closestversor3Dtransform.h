@@ -22,12 +22,24 @@
 #include "itkPoint.h"
 #include "itkLandmarkBasedTransformInitializer.h"
 #include "itkVersorRigid3DTransform.h"
+#include "itkMultiThreader.h"
+#include "ITKToolsColumnReader.h"
 
 #include "vnl/vnl_math.h"
 
 #include <iostream>
 #include <fstream>
 #include <iomanip>
+#include <string>
+#include <vector>
+
+
+/** Typedef's. */
+typedef itk::Image< short, 3 >                      ClosestVersorImageType;
+typedef itk::VersorRigid3DTransform< double >       ClosestVersorTransformType;
+typedef itk::LandmarkBasedTransformInitializer<
+  ClosestVersorTransformType,
+  ClosestVersorImageType, ClosestVersorImageType >  ClosestVersorEstimatorType;
 
 
 /**
@@ -40,57 +52,56 @@ void ReadLandmarks(
 {
   /** Typedef's. */
   const unsigned int Dimension = 3;
-  typedef itk::Image< short, Dimension >              ImageType;
-  typedef itk::VersorRigid3DTransform< double >       TransformType;
-  typedef TransformType::ParametersType               ParametersType;
-  typedef itk::LandmarkBasedTransformInitializer<
-    TransformType, ImageType, ImageType >             EstimatorType;
-  typedef EstimatorType::LandmarkPointType            LandmarkType;
-  typedef EstimatorType::LandmarkPointContainer       LandmarkContainer;
-
-  /** Open file for reading and read landmarks. */
-  std::ifstream landmarkFile( landmarkFileName.c_str() );
-  if( landmarkFile.is_open() )
+  typedef ClosestVersorEstimatorType::LandmarkPointType LandmarkType;
+
+  /** Read the three columns of the landmarks at once. */
+  std::vector<unsigned int> columns( Dimension );
+  for( unsigned int i = 0; i < Dimension; ++i ) columns[ i ] = i;
+  std::vector< std::vector<double> > columnData;
+  unsigned int numberOfColumns = 0;
+  if( !itktools::ReadNumericColumns( landmarkFileName, columns, columnData, numberOfColumns ) )
+  {
+    itkGenericExceptionMacro( << "ERROR: could not read the landmarks from \""
+      << landmarkFileName << "\"." );
+  }
+
+  const std::size_t numberOfLandmarks = columnData[ 0 ].size();
+  landmarkContainer.clear();
+  landmarkContainer.reserve( numberOfLandmarks );
+  for( std::size_t j = 0; j < numberOfLandmarks; ++j )
   {
     LandmarkType landmark;
-    while ( !landmarkFile.eof() )
+    for( unsigned int i = 0; i < Dimension; ++i )
     {
-      for( unsigned int i = 0; i < Dimension; i++ )
-      {
-        landmarkFile >> landmark[ i ];
-      }
-      landmarkContainer.push_back( landmark );
+      landmark[ i ] = columnData[ i ][ j ];
     }
+    landmarkContainer.push_back( landmark );
   }
-  landmarkFile.close();
-  landmarkContainer.pop_back();
 
 } // end ReadLandMarks()
 
 
 /**
  * ******************* ComputeClosestVersor *******************
+ * The transform and estimator are passed in, so that they can be
+ * reused for many landmark sets.
  */
 
 void ComputeClosestVersor(
   std::string fixedLandmarkFileName,
   std::string movingLandmarkFileName,
+  ClosestVersorTransformType * transform,
+  ClosestVersorEstimatorType * estimator,
   std::vector<double> & parameters,
   std::vector<double> & centerOfRotation )
 {
   /** Some consts. */
   const unsigned int  Dimension = 3;
-  typedef short PixelType;
 
   /** Typedefs. */
-  typedef itk::Image< PixelType, Dimension >          ImageType;
-  typedef itk::VersorRigid3DTransform< double >       TransformType;
-  typedef TransformType::ParametersType               ParametersType;
-  typedef TransformType::CenterType                   CenterType;
-  typedef itk::LandmarkBasedTransformInitializer<
-    TransformType, ImageType, ImageType >             EstimatorType;
-  typedef EstimatorType::LandmarkPointType            LandmarkType;
-  typedef EstimatorType::LandmarkPointContainer       LandmarkContainer;
+  typedef ClosestVersorTransformType::ParametersType    ParametersType;
+  typedef ClosestVersorTransformType::CenterType        CenterType;
+  typedef ClosestVersorEstimatorType::LandmarkPointContainer LandmarkContainer;
 
   /** Read the fixed landmark points. */
   LandmarkContainer fixedLandmarkContainer;
@@ -103,16 +114,15 @@ void ComputeClosestVersor(
   /** Check the sizes. */
   if( fixedLandmarkContainer.size() != movingLandmarkContainer.size() )
   {
-    std::cerr << "ERROR: the two sets of landmarks are not of the same size." << std::endl;
-    return;
+    itkGenericExceptionMacro( << "ERROR: the two sets of landmarks in \""
+      << fixedLandmarkFileName << "\" and \"" << movingLandmarkFileName
+      << "\" are not of the same size." );
   }
 
-  /** Create transform. */
-  TransformType::Pointer transform = TransformType::New();
+  /** Reset the transform. */
   transform->SetIdentity();
 
-  /** Create estimator. */
-  EstimatorType::Pointer estimator = EstimatorType::New();
+  /** Set up the estimator. */
   estimator->SetTransform( transform );
   estimator->SetFixedLandmarks(  fixedLandmarkContainer );
   estimator->SetMovingLandmarks( movingLandmarkContainer );
@@ -140,6 +150,110 @@ void ComputeClosestVersor(
 } // end ComputeClosestVersor()
 
 
+/**
+ * ******************* ComputeClosestVersor *******************
+ */
+
+void ComputeClosestVersor(
+  std::string fixedLandmarkFileName,
+  std::string movingLandmarkFileName,
+  std::vector<double> & parameters,
+  std::vector<double> & centerOfRotation )
+{
+  ClosestVersorTransformType::Pointer transform = ClosestVersorTransformType::New();
+  ClosestVersorEstimatorType::Pointer estimator = ClosestVersorEstimatorType::New();
+  ComputeClosestVersor( fixedLandmarkFileName, movingLandmarkFileName,
+    transform, estimator, parameters, centerOfRotation );
+
+} // end ComputeClosestVersor()
+
+
+/** The arguments of the threads that fit a list of landmark pairs. */
+struct ClosestVersorBatchStruct
+{
+  const std::vector<std::string> *      m_FixedLandmarkFileNames;
+  const std::vector<std::string> *      m_MovingLandmarkFileNames;
+  std::vector< std::vector<double> > *  m_Parameters;
+  std::vector< std::vector<double> > *  m_CentersOfRotation;
+  std::vector<std::string> *            m_ErrorMessages;
+};
+
+
+/**
+ * ******************* ClosestVersorBatchThreaderCallback *******************
+ * Every thread fits a contiguous part of the list, reusing one transform
+ * and estimator.
+ */
+
+ITK_THREAD_RETURN_TYPE ClosestVersorBatchThreaderCallback( void * arg )
+{
+  itk::MultiThreader::ThreadInfoStruct * info
+    = static_cast<itk::MultiThreader::ThreadInfoStruct *>( arg );
+  ClosestVersorBatchStruct * data = static_cast<ClosestVersorBatchStruct *>( info->UserData );
+
+  const std::size_t n = data->m_FixedLandmarkFileNames->size();
+  const std::size_t begin = n * info->ThreadID / info->NumberOfThreads;
+  const std::size_t end = n * ( info->ThreadID + 1 ) / info->NumberOfThreads;
+
+  ClosestVersorTransformType::Pointer transform = ClosestVersorTransformType::New();
+  ClosestVersorEstimatorType::Pointer estimator = ClosestVersorEstimatorType::New();
+  for( std::size_t k = begin; k < end; ++k )
+  {
+    try
+    {
+      ComputeClosestVersor(
+        ( *data->m_FixedLandmarkFileNames )[ k ],
+        ( *data->m_MovingLandmarkFileNames )[ k ],
+        transform, estimator,
+        ( *data->m_Parameters )[ k ], ( *data->m_CentersOfRotation )[ k ] );
+    }
+    catch( itk::ExceptionObject & excp )
+    {
+      ( *data->m_ErrorMessages )[ k ] = excp.GetDescription();
+    }
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end ClosestVersorBatchThreaderCallback()
+
+
+/**
+ * ******************* ComputeClosestVersorBatch *******************
+ * Fit all landmark pairs in parallel. The error message of a pair that
+ * could not be fitted is non-empty.
+ */
+
+void ComputeClosestVersorBatch(
+  const std::vector<std::string> & fixedLandmarkFileNames,
+  const std::vector<std::string> & movingLandmarkFileNames,
+  std::vector< std::vector<double> > & parameters,
+  std::vector< std::vector<double> > & centersOfRotation,
+  std::vector<std::string> & errorMessages )
+{
+  const std::size_t n = fixedLandmarkFileNames.size();
+  parameters.assign( n, std::vector<double>() );
+  centersOfRotation.assign( n, std::vector<double>() );
+  errorMessages.assign( n, "" );
+
+  ClosestVersorBatchStruct data;
+  data.m_FixedLandmarkFileNames = &fixedLandmarkFileNames;
+  data.m_MovingLandmarkFileNames = &movingLandmarkFileNames;
+  data.m_Parameters = &parameters;
+  data.m_CentersOfRotation = &centersOfRotation;
+  data.m_ErrorMessages = &errorMessages;
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  if( static_cast<std::size_t>( threader->GetNumberOfThreads() ) > n )
+  {
+    threader->SetNumberOfThreads( n > 0 ? n : 1 );
+  }
+  threader->SetSingleMethod( ClosestVersorBatchThreaderCallback, &data );
+  threader->SingleMethodExecute();
+
+} // end ComputeClosestVersorBatch()
+
+
 /**
  * ******************* ConvertVersorToEuler *******************
  */
@@ -46,6 +46,8 @@ std::string GetHelpString( void )
     << "-in      inputFilename0 [inputFileName1 ... ]: the input segmentations,\n"
     << "        as unsigned char images. More than 2 labels are allowed, but\n"
     << "        with some restrictions: {0,1,2}=ok, {0,3,4}=bad, {1,2,3}=bad.\n"
+    << "        Use @file to read them from a manifest, optionally with the\n"
+    << "        trust factor of each observer in the second column.\n"
     << "[-n]     numberOfClasses: the number of classes to segment;\n"
     << "        default: 2 (so, 0 and 1).\n"
     << "[-P]     priorProbImageFilename0 priorProbImageFilename1 [...]:\n"
@@ -79,6 +81,25 @@ std::string GetHelpString( void )
     << "        Pixels that are outside the mask, will have class of the first observer.\n"
     << "        Other pixels are passed through the combination algorithm.\n"
     << "        The confusion matrix will be only based on the pixels within the mask.\n"
+    << "[-sparse] Compress the pixels where all observers agree. The EM iterations\n"
+    << "        then only visit the pixels where the observers disagree, which is much\n"
+    << "        faster when most pixels are unanimous, with the same result.\n"
+    << "        Only taken into account by [VOTE_]MULTISTAPLE2 without -P.\n"
+    << "[-accel] Accelerate the EM iterations with squared extrapolation (SQUAREM).\n"
+    << "        Reaches the same result in fewer iterations; each iteration is a pass\n"
+    << "        over the image. Only taken into account by [VOTE_]MULTISTAPLE2.\n"
+    << "[-coarse] [factor]: Initialize the confusion matrices by running the EM\n"
+    << "        first on every factor-th voxel in each dimension, default 4. The\n"
+    << "        iterations on the full image then start close to convergence.\n"
+    << "        Only taken into account by [VOTE_]MULTISTAPLE2 without -P, and not\n"
+    << "        when streaming.\n"
+    << "[-quantize] Store the soft segmentations as unsigned char images; the\n"
+    << "        probability p is stored as round( 255 p ).\n"
+    << "[-rle]   Take the votes on run-length encoded scanlines: once per run of\n"
+    << "        unchanged labels, skipping the scanlines that are background in all\n"
+    << "        observers. Much faster for sparse segmentations, with the same result.\n"
+    << "        Only taken into account by VOTE without -mask, -outs, -outc and\n"
+    << "        unequal trust factors.\n"
     << "[-ord]   The order of preferred classes, in cases of undecided pixels. Default: 0 1 2...\n"
     << "        Ignored by STAPLE and MULTISTAPLE. In the default case, class 0 will be\n"
     << "        preferred over class 1, for example.\n"
@@ -88,6 +109,12 @@ std::string GetHelpString( void )
     << "        valid for the situation after relabeling!\n"
     << "[-z]    compression flag; if provided, the output image is compressed\n"
     << "[-threads] maximum number of threads to use.\n"
+    << "[-streams] number of slabs in which the image is processed.\n"
+    << "[-memoryLimit] approximate memory limit, e.g. 4G; MB without a unit. The number of slabs\n"
+    << "        is derived from it. When processing in slabs, only the slabs of the\n"
+    << "        input segmentations are read, which bounds the memory. Only VOTE and\n"
+    << "        MULTISTAPLE2 support this, without -mask, -P and -z. MULTISTAPLE2 reads\n"
+    << "        all slabs for every EM iteration, and ignores -accel.\n"
     << "Supported: 2D/3D.";
 
   return ss.str();
@@ -126,6 +153,9 @@ int main( int argc, char **argv )
   std::vector< std::string >  inputSegmentationFileNames;
   parser->GetCommandLineArgument( "-in", inputSegmentationFileNames );
 
+  /** Read the headers of all inputs before processing starts. */
+  if( !itktools::ValidateImageHeaders( inputSegmentationFileNames ) ) return EXIT_FAILURE;
+
   /** Get the settings for the change label image filter (not mandatory) */
   std::vector<unsigned int>  inValues;
   std::vector<unsigned int>  outValues;
@@ -188,6 +218,11 @@ int main( int argc, char **argv )
   /** Get the trust factor for each observer (not mandatory) */
   std::vector< float > trust(0);
   bool rett = parser->GetCommandLineArgument( "-t", trust );
+  if( !rett )
+  {
+    /** The trust factors can also be given in the second column of an -in manifest. */
+    rett = parser->GetManifestColumn( "-in", 1, trust );
+  }
   if( rett )
   {
     if( trust.size() != inputSegmentationFileNames.size() )
@@ -238,6 +273,26 @@ int main( int argc, char **argv )
   bool useMask = parser->ArgumentExists( "-mask" );
   parser->GetCommandLineArgument( "-mask", maskDilationRadius );
 
+  /** Compress the unanimous pixels or not? */
+  const bool compressUnanimousPixels = parser->ArgumentExists( "-sparse" );
+
+  /** Accelerate the EM iterations or not? */
+  const bool useSquaredExtrapolation = parser->ArgumentExists( "-accel" );
+
+  /** Initialize the EM on a subsample or not? */
+  unsigned int initializationSubsamplingFactor = 1;
+  if( parser->ArgumentExists( "-coarse" ) )
+  {
+    initializationSubsamplingFactor = 4;
+    parser->GetCommandLineArgument( "-coarse", initializationSubsamplingFactor );
+  }
+
+  /** Quantize the soft segmentations or not? */
+  const bool quantizeSoftSegmentations = parser->ArgumentExists( "-quantize" );
+
+  /** Vote on run-length encoded scanlines or not? */
+  const bool useRunLengthVoting = parser->ArgumentExists( "-rle" );
+
   /** Read the preferred order of classes in case of undecided pixels */
   std::vector<unsigned int> prefOrder(numberOfClasses);
   for( unsigned int i = 0; i < numberOfClasses; ++i )
@@ -249,14 +304,6 @@ int main( int argc, char **argv )
   /** Use compression */
   const bool useCompression = parser->ArgumentExists( "-z" );
 
-  /** Threads. */
-  unsigned int maximumNumberOfThreads
-    = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
-  parser->GetCommandLineArgument(
-    "-threads", maximumNumberOfThreads );
-  itk::MultiThreader::SetGlobalMaximumNumberOfThreads(
-    maximumNumberOfThreads );
-
   /** Determine image properties. */
   itk::ImageIOBase::IOPixelType pixelType = itk::ImageIOBase::UNKNOWNPIXELTYPE;
   itk::ImageIOBase::IOComponentType componentType = itk::ImageIOBase::UNKNOWNCOMPONENTTYPE;
@@ -307,11 +354,17 @@ int main( int argc, char **argv )
     filter->m_CombinationMethod = combinationMethod;
     filter->m_UseMask = useMask;
     filter->m_MaskDilationRadius = maskDilationRadius;
+    filter->m_CompressUnanimousPixels = compressUnanimousPixels;
+    filter->m_UseSquaredExtrapolation = useSquaredExtrapolation;
+    filter->m_InitializationSubsamplingFactor = initializationSubsamplingFactor;
+    filter->m_QuantizeSoftSegmentations = quantizeSoftSegmentations;
+    filter->m_UseRunLengthVoting = useRunLengthVoting;
     filter->m_PrefOrder = prefOrder;
     filter->m_InValues = inValues;
     filter->m_OutValues = outValues;
     filter->m_UseCompression = useCompression;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
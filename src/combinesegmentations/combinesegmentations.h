@@ -35,6 +35,10 @@
 #include "itkBinaryThresholdImageFilter.h"
 #include "itkImageRegionIteratorWithIndex.h"
 #include "itkNaryUnequalityTestImageFilter.h"
+#include "itkTimeProbe.h"
+#include "itkImageIORegion.h"
+#include <itksys/SystemTools.hxx>
+#include <algorithm>
 #include "itkBinaryDilateImageFilter.h"
 #include "itkBinaryBallStructuringElement.h"
 #include "itkChangeLabelImageFilter.h"
@@ -60,6 +64,11 @@ public:
     this->m_CombinationMethod = "MULTISTAPLE2";
     this->m_UseMask = false;
     this->m_MaskDilationRadius = 1;
+    this->m_CompressUnanimousPixels = false;
+    this->m_UseSquaredExtrapolation = false;
+    this->m_InitializationSubsamplingFactor = 1;
+    this->m_QuantizeSoftSegmentations = false;
+    this->m_UseRunLengthVoting = false;
     this->m_UseCompression = false;
   };
   /** Destructor. */
@@ -78,6 +87,11 @@ public:
   std::string                 m_CombinationMethod;
   bool                        m_UseMask;
   unsigned int                m_MaskDilationRadius;
+  bool                        m_CompressUnanimousPixels;
+  bool                        m_UseSquaredExtrapolation;
+  unsigned int                m_InitializationSubsamplingFactor;
+  bool                        m_QuantizeSoftSegmentations;
+  bool                        m_UseRunLengthVoting;
   std::vector< unsigned int > m_PrefOrder;
   std::vector< unsigned int > m_InValues;
   std::vector< unsigned int > m_OutValues;
@@ -103,28 +117,31 @@ public:
   ITKToolsCombineSegmentations(){};
   ~ITKToolsCombineSegmentations(){};
 
+  /** Typedefs. */
+  typedef TComponentType                              LabelPixelType;
+  typedef float                                       ProbPixelType;
+  typedef unsigned char                               QuantizedPixelType;
+  typedef itk::Image< LabelPixelType, VDimension >    LabelImageType;
+  typedef itk::Image< ProbPixelType, VDimension >     ProbImageType;
+  typedef itk::Image< QuantizedPixelType, VDimension > QuantizedImageType;
+  typedef typename LabelImageType::RegionType         RegionType;
+  typedef typename LabelImageType::Pointer            LabelImagePointer;
+  typedef typename ProbImageType::Pointer             ProbImagePointer;
+  typedef std::vector< LabelImagePointer >            LabelImageArrayType;
+
+  /** VOTE and MULTISTAPLE2 are computed slab by slab when streaming. */
+  virtual bool GetSupportsStreaming( void ) const { return true; }
+
   /** Run function. */
   void Run( void )
   {
-    //typedef unsigned char   LabelPixelType;
-    typedef TComponentType  LabelPixelType;
-    typedef float           ProbPixelType;
     typedef float           ConfusionMatrixPixelType;
-
-    typedef itk::Image< LabelPixelType, VDimension >    LabelImageType;
-    typedef itk::Image< ProbPixelType, VDimension >     ProbImageType;
     typedef itk::Image< ConfusionMatrixPixelType, 3 >   ConfusionMatrixImageType;
-
-    typedef typename LabelImageType::RegionType         RegionType;
-
-    typedef typename LabelImageType::Pointer            LabelImagePointer;
-    typedef typename ProbImageType::Pointer             ProbImagePointer;
     typedef typename ConfusionMatrixImageType::Pointer  ConfusionMatrixImagePointer;
 
     typedef itk::ImageFileReader< LabelImageType >    LabelImageReaderType;
     typedef itk::ImageFileReader< ProbImageType >     ProbImageReaderType;
     typedef itk::ImageFileWriter< LabelImageType >    LabelImageWriterType;
-    typedef itk::ImageFileWriter< ProbImageType >     ProbImageWriterType;
     typedef itk::ImageFileWriter<
       ConfusionMatrixImageType >                      ConfusionMatrixImageWriterType;
 
@@ -181,7 +198,6 @@ public:
       MaskImageType,
       StructuringElementType >                       DilateFilterType;
 
-    typedef std::vector< LabelImagePointer >         LabelImageArrayType;
     typedef std::vector< ProbImagePointer >          ProbImageArrayType;
 
     /** Declare some variables */
@@ -195,6 +211,27 @@ public:
 
     /** Initialize some variables */
     numberOfObservers = this->m_InputSegmentationFileNames.size();
+
+    /** Estimate the memory needed without streaming: the input segmentations,
+     * also after relabeling, the hard segmentation and the soft segmentations.
+     * If it does not fit in the memory limit, or streaming is requested,
+     * process the image in slabs. */
+    typename LabelImageReaderType::Pointer informationReader = LabelImageReaderType::New();
+    informationReader->SetFileName( this->m_InputSegmentationFileNames[ 0 ].c_str() );
+    informationReader->UpdateOutputInformation();
+    const RegionType largestRegion
+      = informationReader->GetOutput()->GetLargestPossibleRegion();
+    const double bytesPerPixel
+      = numberOfObservers * sizeof( LabelPixelType ) * ( this->m_InValues.size() > 0 ? 2.0 : 1.0 )
+      + sizeof( LabelPixelType ) + this->m_NumberOfClasses * sizeof( ProbPixelType );
+    const unsigned int numberOfSlabs = this->GetNumberOfStreams(
+      largestRegion.GetNumberOfPixels() * bytesPerPixel / 1048576.0 );
+    if( numberOfSlabs > 1 )
+    {
+      this->RunStreamed( informationReader->GetOutput(), numberOfSlabs );
+      return;
+    }
+
     labelImageArray.resize( numberOfObservers );
     softSegmentationArray.resize( this->m_NumberOfClasses );
     priorProbImageArray.resize( this->m_NumberOfClasses );
@@ -208,6 +245,7 @@ public:
       typename LabelImageReaderType::Pointer labelImageReader =
         LabelImageReaderType::New();
       labelImageReader->SetFileName( this->m_InputSegmentationFileNames[ i ].c_str() );
+      this->ObserveProcess( labelImageReader.GetPointer(), "read" );
       labelImageReader->Update();
 
       /** Check size. */
@@ -249,6 +287,7 @@ public:
         typename ProbImageReaderType::Pointer probImageReader =
           ProbImageReaderType::New();
         probImageReader->SetFileName( this->m_PriorProbImageFileNames[ i ].c_str() );
+        this->ObserveProcess( probImageReader.GetPointer(), "read" );
         probImageReader->Update();
         priorProbImageArray[ i ] = probImageReader->GetOutput();
       }
@@ -283,6 +322,7 @@ public:
         staple->SetConfidenceWeight( this->m_PriorProbs[1] );
       }
       std::cout << "Performing STAPLE algorithm..." << std::endl;
+      this->ObserveProcess( staple.GetPointer(), "STAPLE" );
       staple->Update();
       std::cout << "Done performing STAPLE algorithm." << std::endl;
       std::cout << "NumberOfIterations = " << staple->GetElapsedIterations() << std::endl;
@@ -364,6 +404,7 @@ public:
       std::cout << "TerminationUpdateThreshold = " << this->m_TerminationThreshold << std::endl;
       multistaple->SetTerminationUpdateThreshold( this->m_TerminationThreshold );
       std::cout << "Performing MULTISTAPLE algorithm..." << std::endl;
+      this->ObserveProcess( multistaple.GetPointer(), "multi-label STAPLE" );
       multistaple->Update();
       std::cout << "Done performing MULTISTAPLE algorithm." << std::endl;
       std::cout
@@ -475,6 +516,9 @@ public:
         multistaple2->SetObserverTrust( observerTrustCast );
       }
 
+      multistaple2->SetCompressUnanimousPixels( this->m_CompressUnanimousPixels );
+      multistaple2->SetUseSquaredExtrapolation( this->m_UseSquaredExtrapolation );
+      multistaple2->SetInitializationSubsamplingFactor( this->m_InitializationSubsamplingFactor );
       multistaple2->SetInitializeWithMajorityVoting( ( this->m_CombinationMethod == "VOTE_MULTISTAPLE2" ) );
 
       /** Set whether soft segmentations are required */
@@ -489,7 +533,11 @@ public:
 
       /** Run!! */
       std::cout << "Performing " << this->m_CombinationMethod << " algorithm..." << std::endl;
+      itk::TimeProbe timer;
+      timer.Start();
+      this->ObserveProcess( multistaple2.GetPointer(), "multi-label STAPLE" );
       multistaple2->Update();
+      timer.Stop();
       std::cout << "Done performing " << this->m_CombinationMethod << " algorithm." << std::endl;
       if( this->m_PriorProbImageFileNames.size() != this->m_NumberOfClasses )
       {
@@ -502,7 +550,23 @@ public:
         << "Estimated/supplied initial observer this->m_Trust was: "
         << multistaple2->GetObserverTrust()
         << std::endl;
+      if( this->m_CompressUnanimousPixels )
+      {
+        std::cout << "NumberOfDisagreementPixels = "
+          << multistaple2->GetNumberOfDisagreementPixels() << std::endl;
+      }
+      if( this->m_InitializationSubsamplingFactor > 1 )
+      {
+        std::cout << "NumberOfInitializationIterations = "
+          << multistaple2->GetElapsedInitializationIterations() << std::endl;
+      }
       std::cout << "NumberOfIterations = " << multistaple2->GetElapsedIterations() << std::endl;
+      if( multistaple2->GetElapsedIterations() > 0 )
+      {
+        std::cout << "Time per iteration = "
+          << timer.GetTotal() / multistaple2->GetElapsedIterations()
+          << " s" << std::endl;
+      }
       std::cout << "Last maximum confusion matrix element update = "
         << multistaple2->GetMaximumConfusionMatrixElementUpdate() << std::endl;
 
@@ -554,6 +618,7 @@ public:
 
       /** Set the number of classes */
       voting->SetNumberOfClasses( this->m_NumberOfClasses );
+      voting->SetUseRunLengthVoting( this->m_UseRunLengthVoting );
 
       /** Set the inputs */
       for( unsigned int i = 0; i < numberOfObservers; ++i )
@@ -612,6 +677,7 @@ public:
 
       /** Run!! */
       std::cout << "Performing VOTE algorithm..." << std::endl;
+      this->ObserveProcess( voting.GetPointer(), "voting" );
       voting->Update();
       std::cout << "Done performing VOTE algorithm." << std::endl;
 
@@ -672,16 +738,13 @@ public:
       std::cout << "Writing soft segmentations..." << std::endl;
       for( unsigned int i = 0; i < this->m_SoftOutputFileNames.size(); ++i )
       {
-        typename ProbImageWriterType::Pointer softWriter =
-          ProbImageWriterType::New();
-        softWriter->SetFileName( this->m_SoftOutputFileNames[ i ].c_str() );
         /** Check if the soft segmentation is available. MULTISTAPLE does not
         * generate soft segmentations */
         if( softSegmentationArray[ i ].IsNotNull() )
         {
-          softWriter->SetInput( softSegmentationArray[ i ] );
-          softWriter->SetUseCompression( this->m_UseCompression );
-          softWriter->Update();
+          this->WriteSoftSegmentation( softSegmentationArray[ i ],
+            this->m_SoftOutputFileNames[ i ],
+            softSegmentationArray[ i ]->GetLargestPossibleRegion(), false );
         }
       }
       std::cout << "Done writing soft segmentations." << std::endl;
@@ -698,6 +761,7 @@ public:
         hardWriter->SetInput( hardSegmentation );
         hardWriter->SetUseCompression( this->m_UseCompression );
         std::cout << "Writing hard segmentation..." << std::endl;
+        this->ObserveProcess( hardWriter.GetPointer(), "write" );
         hardWriter->Update();
         std::cout << "Done writing hard segmentation." << std::endl;
       }
@@ -714,12 +778,415 @@ public:
         confusionWriter->SetInput( confusionMatrixImage );
         confusionWriter->SetUseCompression( this->m_UseCompression );
         std::cout << "Writing confusion matrix image..." << std::endl;
+        this->ObserveProcess( confusionWriter.GetPointer(), "write" );
         confusionWriter->Update();
         std::cout << "Done writing confusion matrix image..." << std::endl;
       }
     }
   } // end Run()
 
+
+  /** Streamed version of Run(), for VOTE and MULTISTAPLE2. The input
+   * segmentations are read, combined and written slab by slab, so that the
+   * memory is bounded by the size of a slab. MULTISTAPLE2 first estimates
+   * the confusion matrices of the complete image, with a pass over all
+   * slabs for each EM iteration, and then computes the output of each slab
+   * from these global confusion matrices.
+   */
+  void RunStreamed( const LabelImageType * information, const unsigned int numberOfSlabs )
+  {
+    typedef itk::LabelVoting2ImageFilter<
+      LabelImageType, LabelImageType, ProbPixelType > LabelVotingType;
+    typedef itk::MultiLabelSTAPLE2ImageFilter<
+      LabelImageType, LabelImageType, ProbPixelType > MultiLabelSTAPLE2Type;
+    typedef typename MultiLabelSTAPLE2Type::WeightsType         WeightsType;
+    typedef typename MultiLabelSTAPLE2Type::ConfusionMatrixType ConfusionMatrixType;
+    typedef typename MultiLabelSTAPLE2Type::ObserverTrustType   ObserverTrustType;
+    typedef typename MultiLabelSTAPLE2Type::PriorPreferenceType PriorPreferenceType;
+    typedef typename MultiLabelSTAPLE2Type::
+      PriorProbabilitiesType                                    PriorProbabilitiesType;
+    typedef itk::Image< float, 3 >                              ConfusionMatrixImageType;
+    typedef itk::ImageRegionIterator< ConfusionMatrixImageType > ConfusionMatrixImageIteratorType;
+    typedef itk::ImageRegionConstIterator< LabelImageType >     LabelIteratorType;
+
+    /** Check that the settings can be streamed */
+    const bool useStaple = this->m_CombinationMethod == "MULTISTAPLE2";
+    if( !useStaple && this->m_CombinationMethod != "VOTE" )
+    {
+      itkGenericExceptionMacro( << "ERROR: streaming is only supported for VOTE and MULTISTAPLE2." );
+    }
+    if( this->m_UseMask || this->m_PriorProbImageFileNames.size() > 0 )
+    {
+      itkGenericExceptionMacro( << "ERROR: -mask and -P can not be combined with streaming." );
+    }
+    if( !useStaple && this->m_ConfusionOutputFileName != "" )
+    {
+      itkGenericExceptionMacro( << "ERROR: -outc can not be combined with streaming for VOTE." );
+    }
+    if( this->m_UseCompression )
+    {
+      itkGenericExceptionMacro( << "ERROR: compression can not be combined with streaming." );
+    }
+
+    /** Determine the slabs; they span the full image in all but the last dimension. */
+    const RegionType region = information->GetLargestPossibleRegion();
+    const unsigned int lastDimension = VDimension - 1;
+    const unsigned int lastSize = region.GetSize()[ lastDimension ];
+    std::vector< RegionType > slabs( std::min( numberOfSlabs, lastSize ), region );
+    for( unsigned int s = 0; s < slabs.size(); ++s )
+    {
+      const unsigned int begin = static_cast<unsigned int>(
+        static_cast<unsigned long long>( lastSize ) * s / slabs.size() );
+      const unsigned int end = static_cast<unsigned int>(
+        static_cast<unsigned long long>( lastSize ) * ( s + 1 ) / slabs.size() );
+      slabs[ s ].SetIndex( lastDimension, region.GetIndex()[ lastDimension ] + begin );
+      slabs[ s ].SetSize( lastDimension, end - begin );
+    }
+    std::cout << "Processing the image in " << slabs.size() << " slabs." << std::endl;
+
+    /** Convert the settings, as in Run() */
+    const unsigned int numberOfObservers = this->m_InputSegmentationFileNames.size();
+    PriorPreferenceType priorPref( this->m_NumberOfClasses );
+    for( unsigned int i = 0; i < this->m_NumberOfClasses; ++i )
+    {
+      priorPref[ this->m_PrefOrder[ i ] ] = i;
+    }
+    ObserverTrustType trust( numberOfObservers );
+    trust.Fill( useStaple ? 0.99999 : 1.0 );
+    if( this->m_Trust.size() == numberOfObservers )
+    {
+      for( unsigned int i = 0; i < numberOfObservers; ++i )
+      {
+        trust[ i ] = static_cast<WeightsType>( this->m_Trust[ i ] );
+      }
+    }
+
+    /** Estimate the global prior probabilities and confusion matrices */
+    PriorProbabilitiesType priorProbs( this->m_NumberOfClasses );
+    std::vector< ConfusionMatrixType > confusion;
+    if( useStaple )
+    {
+      /** The prior probabilities are the trust weighted label frequencies,
+       * as in the MultiLabelSTAPLE2ImageFilter. */
+      if( this->m_PriorProbs.size() == this->m_NumberOfClasses )
+      {
+        for( unsigned int i = 0; i < this->m_NumberOfClasses; ++i )
+        {
+          priorProbs[ i ] = static_cast<WeightsType>( this->m_PriorProbs[ i ] );
+        }
+      }
+      else
+      {
+        priorProbs.Fill( 0.0 );
+        for( unsigned int s = 0; s < slabs.size(); ++s )
+        {
+          for( unsigned int k = 0; k < numberOfObservers; ++k )
+          {
+            LabelImagePointer input = this->ReadSlab( this->m_InputSegmentationFileNames[ k ], slabs[ s ] );
+            for( LabelIteratorType it( input, slabs[ s ] ); !it.IsAtEnd(); ++it )
+            {
+              priorProbs[ it.Get() ] += trust[ k ];
+            }
+          }
+        }
+        const WeightsType sumP = priorProbs.sum();
+        if( sumP ) priorProbs /= sumP;
+      }
+      std::cout << "Estimated/supplied priorProbabilities were: " << priorProbs << std::endl;
+
+      /** The EM iterations: every slab adds its sums, which are normalized
+       * to give the confusion matrices of the next iteration. */
+      std::cout << "TerminationUpdateThreshold = " << this->m_TerminationThreshold << std::endl;
+      std::cout << "Estimating the confusion matrices..." << std::endl;
+      unsigned int iterations = 0;
+      itk::TimeProbe timer;
+      timer.Start();
+      for( ;; )
+      {
+        std::vector< ConfusionMatrixType > sums;
+        for( unsigned int s = 0; s < slabs.size(); ++s )
+        {
+          LabelImageArrayType inputs = this->ReadSlabs( slabs[ s ] );
+          typename MultiLabelSTAPLE2Type::Pointer multistaple2 = MultiLabelSTAPLE2Type::New();
+          for( unsigned int k = 0; k < numberOfObservers; ++k )
+          {
+            multistaple2->SetInput( k, inputs[ k ] );
+          }
+          multistaple2->SetNumberOfClasses( this->m_NumberOfClasses );
+          multistaple2->SetPriorPreference( priorPref );
+          multistaple2->SetPriorProbabilities( priorProbs );
+          multistaple2->SetObserverTrust( trust );
+          multistaple2->SetCompressUnanimousPixels( this->m_CompressUnanimousPixels );
+          multistaple2->SetMaximumNumberOfIterations( 1 );
+          if( iterations > 0 ) multistaple2->SetConfusionMatrixArray( confusion );
+          multistaple2->GetOutput()->SetRequestedRegion( slabs[ s ] );
+          this->ObserveProcess( multistaple2.GetPointer(), "multi-label STAPLE" );
+          multistaple2->Update();
+
+          for( unsigned int k = 0; k < numberOfObservers; ++k )
+          {
+            if( s == 0 ) sums.push_back( multistaple2->GetConfusionMatrixSum( k ) );
+            else sums[ k ] += multistaple2->GetConfusionMatrixSum( k );
+          }
+        }
+
+        /** Normalize the columns, and determine the maximum update */
+        WeightsType maximumUpdate = 0.0;
+        for( unsigned int k = 0; k < numberOfObservers; ++k )
+        {
+          for( unsigned int ci = 0; ci < this->m_NumberOfClasses; ++ci )
+          {
+            WeightsType sumW = 0.0;
+            for( unsigned int j = 0; j < this->m_NumberOfClasses; ++j )
+            {
+              sumW += sums[ k ][ j ][ ci ];
+            }
+            if( sumW ) sums[ k ].scale_column( ci, 1.0 / sumW );
+          }
+          if( iterations > 0 )
+          {
+            maximumUpdate = vnl_math_max( maximumUpdate, static_cast<WeightsType>(
+              ( sums[ k ] - confusion[ k ] ).array_inf_norm() ) );
+          }
+        }
+        confusion = sums;
+        ++iterations;
+
+        if( iterations > 1 && maximumUpdate < this->m_TerminationThreshold )
+        {
+          std::cout << "Last maximum confusion matrix element update = "
+            << maximumUpdate << std::endl;
+          break;
+        }
+      }
+      timer.Stop();
+      std::cout << "NumberOfIterations = " << iterations << std::endl;
+      std::cout << "Time per iteration = " << timer.GetTotal() / iterations
+        << " s" << std::endl;
+    } // end if useStaple
+
+    /** The outputs are pasted slab by slab into new files */
+    if( this->m_HardOutputFileName != "" )
+    {
+      itksys::SystemTools::RemoveFile( this->m_HardOutputFileName.c_str() );
+    }
+    for( unsigned int i = 0; i < this->m_SoftOutputFileNames.size(); ++i )
+    {
+      itksys::SystemTools::RemoveFile( this->m_SoftOutputFileNames[ i ].c_str() );
+    }
+
+    /** Compute and write the output of every slab */
+    const bool generateProbSeg = this->m_SoftOutputFileNames.size() > 0;
+    std::cout << "Performing " << this->m_CombinationMethod << " algorithm..." << std::endl;
+    for( unsigned int s = 0; s < slabs.size(); ++s )
+    {
+      std::cout << "Processing slab " << s + 1 << " of " << slabs.size() << std::endl;
+      LabelImageArrayType inputs = this->ReadSlabs( slabs[ s ] );
+
+      LabelImagePointer hardSegmentation;
+      std::vector< ProbImagePointer > softSegmentationArray;
+      if( useStaple )
+      {
+        typename MultiLabelSTAPLE2Type::Pointer multistaple2 = MultiLabelSTAPLE2Type::New();
+        for( unsigned int k = 0; k < numberOfObservers; ++k )
+        {
+          multistaple2->SetInput( k, inputs[ k ] );
+        }
+        multistaple2->SetNumberOfClasses( this->m_NumberOfClasses );
+        multistaple2->SetPriorPreference( priorPref );
+        multistaple2->SetPriorProbabilities( priorProbs );
+        multistaple2->SetObserverTrust( trust );
+        multistaple2->SetCompressUnanimousPixels( this->m_CompressUnanimousPixels );
+        multistaple2->SetConfusionMatrixArray( confusion );
+        multistaple2->SetMaximumNumberOfIterations( 0 );
+        multistaple2->SetGenerateProbabilisticSegmentations( generateProbSeg );
+        multistaple2->GetOutput()->SetRequestedRegion( slabs[ s ] );
+        this->ObserveProcess( multistaple2.GetPointer(), "multi-label STAPLE" );
+        multistaple2->Update();
+        hardSegmentation = multistaple2->GetOutput();
+        if( generateProbSeg )
+        {
+          softSegmentationArray = multistaple2->GetProbabilisticSegmentationArray();
+        }
+      }
+      else
+      {
+        typename LabelVotingType::Pointer voting = LabelVotingType::New();
+        for( unsigned int k = 0; k < numberOfObservers; ++k )
+        {
+          voting->SetInput( k, inputs[ k ] );
+        }
+        voting->SetNumberOfClasses( this->m_NumberOfClasses );
+        voting->SetUseRunLengthVoting( this->m_UseRunLengthVoting );
+        voting->SetPriorPreference( priorPref );
+        voting->SetObserverTrust( trust );
+        voting->SetGenerateProbabilisticSegmentations( generateProbSeg );
+        voting->GetOutput()->SetRequestedRegion( slabs[ s ] );
+        this->ObserveProcess( voting.GetPointer(), "voting" );
+        voting->Update();
+        hardSegmentation = voting->GetOutput();
+        if( generateProbSeg )
+        {
+          softSegmentationArray = voting->GetProbabilisticSegmentationArray();
+        }
+      }
+      hardSegmentation->DisconnectPipeline();
+      inputs.clear();
+
+      /** Write the slab of the outputs */
+      if( this->m_HardOutputFileName != "" )
+      {
+        this->WriteSlab( hardSegmentation.GetPointer(), this->m_HardOutputFileName, slabs[ s ], true );
+      }
+      for( unsigned int i = 0; i < this->m_SoftOutputFileNames.size(); ++i )
+      {
+        this->WriteSoftSegmentation( softSegmentationArray[ i ],
+          this->m_SoftOutputFileNames[ i ], slabs[ s ], true );
+      }
+    } // end for slabs
+    std::cout << "Done performing " << this->m_CombinationMethod << " algorithm." << std::endl;
+
+    /** Write the confusion matrices, as in Run() */
+    if( this->m_ConfusionOutputFileName != "" )
+    {
+      typename ConfusionMatrixImageType::SizeType csize;
+      csize[0] = this->m_NumberOfClasses;
+      csize[1] = this->m_NumberOfClasses;
+      csize[2] = numberOfObservers;
+      typename ConfusionMatrixImageType::Pointer confusionMatrixImage = ConfusionMatrixImageType::New();
+      confusionMatrixImage->SetRegions( csize );
+      confusionMatrixImage->Allocate();
+      ConfusionMatrixImageIteratorType cit( confusionMatrixImage,
+        confusionMatrixImage->GetLargestPossibleRegion() );
+      for( unsigned int k = 0; k < numberOfObservers; ++k )
+      {
+        for( unsigned int i = 0; i < this->m_NumberOfClasses; ++i )
+        {
+          for( unsigned int j = 0; j < this->m_NumberOfClasses; ++j )
+          {
+            cit.Value() = confusion[ k ][ i ][ j ];
+            ++cit;
+          }
+        }
+      }
+      typedef itk::ImageFileWriter< ConfusionMatrixImageType > ConfusionMatrixImageWriterType;
+      typename ConfusionMatrixImageWriterType::Pointer confusionWriter =
+        ConfusionMatrixImageWriterType::New();
+      confusionWriter->SetFileName( this->m_ConfusionOutputFileName.c_str() );
+      confusionWriter->SetInput( confusionMatrixImage );
+      std::cout << "Writing confusion matrix image..." << std::endl;
+      this->ObserveProcess( confusionWriter.GetPointer(), "write" );
+      confusionWriter->Update();
+      std::cout << "Done writing confusion matrix image..." << std::endl;
+    }
+
+  } // end RunStreamed()
+
+
+  /** Read a slab of an input segmentation, and relabel it if requested. */
+  LabelImagePointer ReadSlab( const std::string & fileName, const RegionType & slab ) const
+  {
+    typedef itk::ImageFileReader< LabelImageType >      ReaderType;
+    typedef itk::ChangeLabelImageFilter<
+      LabelImageType, LabelImageType >                  RelabelFilterType;
+
+    typename ReaderType::Pointer reader = ReaderType::New();
+    reader->SetFileName( fileName.c_str() );
+    reader->UpdateOutputInformation();
+    const RegionType & region = reader->GetOutput()->GetLargestPossibleRegion();
+    bool sameSize = region.IsInside( slab );
+    for( unsigned int d = 0; d + 1 < VDimension; ++d )
+    {
+      sameSize &= region.GetSize()[ d ] == slab.GetSize()[ d ];
+    }
+    if( !sameSize )
+    {
+      itkGenericExceptionMacro( << "ERROR: input label images are not of the same size!" );
+    }
+
+    LabelImagePointer image = reader->GetOutput();
+    typename RelabelFilterType::Pointer relabeler = RelabelFilterType::New();
+    if( this->m_InValues.size() > 0 )
+    {
+      relabeler->SetInput( reader->GetOutput() );
+      for( unsigned int lab = 0; lab < this->m_InValues.size(); ++lab )
+      {
+        relabeler->SetChange( static_cast<LabelPixelType>( this->m_InValues[ lab ] ),
+          static_cast<LabelPixelType>( this->m_OutValues[ lab ] ) );
+      }
+      image = relabeler->GetOutput();
+    }
+    image->SetRequestedRegion( slab );
+    image->Update();
+    image->DisconnectPipeline();
+
+    return image;
+  } // end ReadSlab()
+
+
+  /** Read the slab of all input segmentations. */
+  LabelImageArrayType ReadSlabs( const RegionType & slab ) const
+  {
+    LabelImageArrayType inputs( this->m_InputSegmentationFileNames.size() );
+    for( unsigned int k = 0; k < inputs.size(); ++k )
+    {
+      inputs[ k ] = this->ReadSlab( this->m_InputSegmentationFileNames[ k ], slab );
+    }
+    return inputs;
+  } // end ReadSlabs()
+
+
+  /** Write an image, or paste a slab of it into the file when streaming. */
+  template< class TImage >
+  void WriteSlab( TImage * image, const std::string & fileName,
+    const RegionType & slab, const bool streaming ) const
+  {
+    typedef itk::ImageFileWriter< TImage >    WriterType;
+
+    typename WriterType::Pointer writer = WriterType::New();
+    writer->SetFileName( fileName.c_str() );
+    writer->SetInput( image );
+    writer->SetUseCompression( this->m_UseCompression );
+    if( streaming )
+    {
+      itk::ImageIORegion ioRegion( VDimension );
+      itk::ImageIORegionAdaptor< VDimension >::Convert(
+        slab, ioRegion, image->GetLargestPossibleRegion().GetIndex() );
+      writer->SetIORegion( ioRegion );
+    }
+    writer->Update();
+  } // end WriteSlab()
+
+
+  /** Write a soft segmentation, quantized to unsigned char if requested:
+   * the probability p is stored as round( 255 p ). */
+  void WriteSoftSegmentation( ProbImageType * image, const std::string & fileName,
+    const RegionType & slab, const bool streaming ) const
+  {
+    if( !this->m_QuantizeSoftSegmentations )
+    {
+      this->WriteSlab( image, fileName, slab, streaming );
+      return;
+    }
+
+    typename QuantizedImageType::Pointer quantized = QuantizedImageType::New();
+    quantized->CopyInformation( image );
+    quantized->SetBufferedRegion( image->GetBufferedRegion() );
+    quantized->SetRequestedRegion( image->GetBufferedRegion() );
+    quantized->Allocate();
+
+    itk::ImageRegionConstIterator< ProbImageType > pit( image, image->GetBufferedRegion() );
+    itk::ImageRegionIterator< QuantizedImageType > qit( quantized, image->GetBufferedRegion() );
+    for( ; !pit.IsAtEnd(); ++pit, ++qit )
+    {
+      const ProbPixelType p = vnl_math_min( vnl_math_max( pit.Get(), 0.0f ), 1.0f );
+      qit.Set( static_cast<QuantizedPixelType>( p * 255.0f + 0.5f ) );
+    }
+
+    this->WriteSlab( quantized.GetPointer(), fileName, slab, streaming );
+  } // end WriteSoftSegmentation()
+
+
 }; // end class ITKToolsCombineSegmentations
 
 
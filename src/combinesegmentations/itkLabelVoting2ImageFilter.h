@@ -23,6 +23,8 @@
 
 #include "itkImageRegionIterator.h"
 #include "itkImageRegionConstIterator.h"
+#include "itkImageLinearConstIteratorWithIndex.h"
+#include "itkRunLengthLabelImage.h"
 
 #include <vector>
 #include "itkArray.h"
@@ -237,6 +239,12 @@ namespace itk
     itkSetMacro(GenerateConfusionMatrix, bool);
     itkGetConstMacro(GenerateConfusionMatrix, bool);
 
+    /** Setting: turn on/off to whether the votes are taken on run-length
+     * encoded scanlines, see ThreadedRunLengthVoting(); default: false */
+    itkSetMacro(UseRunLengthVoting, bool);
+    itkGetConstMacro(UseRunLengthVoting, bool);
+    itkBooleanMacro(UseRunLengthVoting);
+
     /** Get confusion matrix for the i-th input segmentation. */
     virtual const ConfusionMatrixType & GetConfusionMatrix( const unsigned int i ) const
     {
@@ -274,6 +282,26 @@ namespace itk
     void ThreadedGenerateData
       ( const OutputImageRegionType &outputRegionForThread, ThreadIdType threadId);
 
+    /** A faster version of ThreadedGenerateData for a small, fixed number
+     * of classes. It counts the votes in unsigned char counters, one
+     * scanline at a time, reading the scanline of every observer contiguously.
+     * Only valid when all observers have the same positive trust, there are
+     * less than 256 observers, and neither the probabilistic segmentations
+     * nor the confusion matrices are requested. The result is the same as
+     * that of the generic version. */
+    template< unsigned int VNumberOfClasses >
+    void ThreadedCompactVoting( const OutputImageRegionType & outputRegionForThread );
+
+    /** A version of ThreadedGenerateData for sparse segmentations. The
+     * region of every observer is run-length encoded, see
+     * RunLengthLabelImage, and the votes are taken once per segment of a
+     * scanline on which no observer changes its label; scanlines that are
+     * background in all observers are skipped. Only valid under the
+     * conditions of ThreadedCompactVoting(), for any number of classes,
+     * and without a mask. The result is the same as that of the generic
+     * version. */
+    void ThreadedRunLengthVoting( const OutputImageRegionType & outputRegionForThread );
+
     void PrintSelf(std::ostream&, Indent) const;
 
     /** The number of different labels found in the input segmentations */
@@ -282,6 +310,12 @@ namespace itk
     /** The label with the highest priorPreference number */
     OutputPixelType m_LeastPreferredLabel;
 
+    /** Whether ThreadedCompactVoting() is used */
+    bool m_UseCompactVoting;
+
+    /** Whether ThreadedRunLengthVoting() is used */
+    bool m_UseRunLengthKernel;
+
     /** Variables that store whether the a specific parameter has been
     * set by the user */
     bool m_HasObserverTrust;
@@ -314,6 +348,7 @@ namespace itk
     /** Settings that can be accessed via the set/get member functions */
     bool m_GenerateProbabilisticSegmentations;
     bool m_GenerateConfusionMatrix;
+    bool m_UseRunLengthVoting;
     MaskImagePointer m_MaskImage;
 
 
@@ -20,6 +20,8 @@
 
 #include "itkLabelVoting2ImageFilter.h"
 
+#include <algorithm>
+
 #include "vnl/vnl_math.h"
 
 namespace itk
@@ -38,6 +40,9 @@ namespace itk
     this->m_LeastPreferredLabel = 1;
     this->m_MaskImage = 0;
     this->m_GenerateConfusionMatrix = false;
+    this->m_UseCompactVoting = false;
+    this->m_UseRunLengthVoting = false;
+    this->m_UseRunLengthKernel = false;
   } // end constructor
 
 
@@ -182,15 +187,198 @@ namespace itk
       this->AllocateConfusionMatrixArray();
     }
 
+    /** Check if the compact voting kernels can be used */
+    bool uniformTrust = this->m_ObserverTrust[ 0 ] > 0.0;
+    for( unsigned int i = 1; i < numberOfInputs; ++i )
+    {
+      uniformTrust &= ( this->m_ObserverTrust[ i ] == this->m_ObserverTrust[ 0 ] );
+    }
+    this->m_UseCompactVoting = uniformTrust
+      && ( numberOfInputs < 256 )
+      && ( this->m_NumberOfClasses >= 2 ) && ( this->m_NumberOfClasses <= 10 )
+      && !generateProbSeg && !this->GetGenerateConfusionMatrix();
+    this->m_UseRunLengthKernel = this->m_UseRunLengthVoting && uniformTrust
+      && this->m_MaskImage.IsNull()
+      && !generateProbSeg && !this->GetGenerateConfusionMatrix();
+
   } // end BeforeThreadedGenerateData
 
 
+  template< typename TInputImage, typename TOutputImage, typename TWeights >
+  template< unsigned int VNumberOfClasses >
+    void
+    LabelVoting2ImageFilter< TInputImage, TOutputImage, TWeights >
+    ::ThreadedCompactVoting( const OutputImageRegionType & outputRegionForThread )
+  {
+    typedef ImageLinearConstIteratorWithIndex< OutputImageType > LineIteratorType;
+
+    OutputImageType * output = this->GetOutput();
+    const unsigned int numberOfInputs = this->GetNumberOfInputs();
+    const MaskImageType * mask = this->m_MaskImage.GetPointer();
+    const MaskPixelType zeroMaskPixel = itk::NumericTraits<MaskPixelType>::Zero;
+    const SizeValueType lineLength = outputRegionForThread.GetSize( 0 );
+
+    /** The prior preference, and the inputs */
+    unsigned int preference[ VNumberOfClasses ];
+    for( unsigned int ci = 0; ci < VNumberOfClasses; ++ci )
+    {
+      preference[ ci ] = this->m_PriorPreference[ ci ];
+    }
+    std::vector<const InputImageType *> inputs( numberOfInputs );
+    for( unsigned int k = 0; k < numberOfInputs; ++k )
+    {
+      inputs[ k ] = this->GetInput( k );
+    }
+
+    /** The vote counts of all pixels of a scanline */
+    std::vector<unsigned char> votes( lineLength * VNumberOfClasses );
+
+    LineIteratorType lit( output, outputRegionForThread );
+    lit.SetDirection( 0 );
+    for( lit.GoToBegin(); !lit.IsAtEnd(); lit.NextLine() )
+    {
+      const typename OutputImageType::IndexType & lineIndex = lit.GetIndex();
+
+      /** Count the votes; the scanline of each observer is read contiguously */
+      std::fill( votes.begin(), votes.end(), 0 );
+      for( unsigned int k = 0; k < numberOfInputs; ++k )
+      {
+        const InputPixelType * in = inputs[ k ]->GetBufferPointer()
+          + inputs[ k ]->ComputeOffset( lineIndex );
+        unsigned char * v = &votes[ 0 ];
+        for( SizeValueType x = 0; x < lineLength; ++x, v += VNumberOfClasses )
+        {
+          ++v[ in[ x ] ];
+        }
+      }
+
+      const InputPixelType * firstInput = inputs[ 0 ]->GetBufferPointer()
+        + inputs[ 0 ]->ComputeOffset( lineIndex );
+      const MaskPixelType * maskLine = 0;
+      if( mask )
+      {
+        maskLine = mask->GetBufferPointer() + mask->ComputeOffset( lineIndex );
+      }
+      OutputPixelType * out = output->GetBufferPointer()
+        + output->ComputeOffset( lineIndex );
+
+      /** Determine the label with the most votes, as in ThreadedGenerateData */
+      const unsigned char * v = &votes[ 0 ];
+      for( SizeValueType x = 0; x < lineLength; ++x, v += VNumberOfClasses )
+      {
+        /** For pixels outside the mask use the decision of the first observer */
+        if( maskLine && maskLine[ x ] == zeroMaskPixel )
+        {
+          out[ x ] = static_cast<OutputPixelType>( firstInput[ x ] );
+          continue;
+        }
+
+        unsigned int winningLabel = this->m_LeastPreferredLabel;
+        unsigned int winningVotes = 0;
+        for( unsigned int ci = 0; ci < VNumberOfClasses; ++ci )
+        {
+          if( v[ ci ] > winningVotes )
+          {
+            winningVotes = v[ ci ];
+            winningLabel = ci;
+          }
+          else if( v[ ci ] == winningVotes
+            && preference[ ci ] < preference[ winningLabel ] )
+          {
+            winningLabel = ci;
+          }
+        }
+        out[ x ] = static_cast<OutputPixelType>( winningLabel );
+      } // end for x
+
+    } // end for lines
+
+  } // end ThreadedCompactVoting
+
+
+  template< typename TInputImage, typename TOutputImage, typename TWeights >
+    void
+    LabelVoting2ImageFilter< TInputImage, TOutputImage, TWeights >
+    ::ThreadedRunLengthVoting( const OutputImageRegionType & outputRegionForThread )
+  {
+    typedef RunLengthLabelImage< InputImageType >   EncodingType;
+    typedef typename EncodingType::RunType          RunType;
+
+    OutputImageType * output = this->GetOutput();
+    const unsigned int numberOfInputs = this->GetNumberOfInputs();
+    const SizeValueType lineLength = outputRegionForThread.GetSize( 0 );
+
+    /** The prior preference */
+    std::vector<unsigned int> preference( this->m_NumberOfClasses );
+    for( unsigned int ci = 0; ci < this->m_NumberOfClasses; ++ci )
+    {
+      preference[ ci ] = this->m_PriorPreference[ ci ];
+    }
+
+    /** Encode the region of every observer, within this thread */
+    std::vector<typename EncodingType::Pointer> encodings( numberOfInputs );
+    std::vector<const EncodingType *> inputs( numberOfInputs );
+    for( unsigned int k = 0; k < numberOfInputs; ++k )
+    {
+      encodings[ k ] = EncodingType::New();
+      encodings[ k ]->SetNumberOfThreads( 1 );
+      encodings[ k ]->Encode( this->GetInput( k ), outputRegionForThread );
+      inputs[ k ] = encodings[ k ];
+    }
+    typename EncodingType::Pointer votes = EncodingType::New();
+    EncodingType::Vote( inputs, preference, votes );
+
+    /** Write the runs of the winning labels; the rest is background */
+    const OutputPixelType background = static_cast<OutputPixelType>( votes->GetBackgroundValue() );
+    for( SizeValueType line = 0; line < votes->GetNumberOfLines(); ++line )
+    {
+      OutputPixelType * out = output->GetBufferPointer()
+        + output->ComputeOffset( votes->GetLineIndex( line ) );
+      SizeValueType position = 0;
+      for( const RunType * run = votes->GetLineBegin( line ); run != votes->GetLineEnd( line ); ++run )
+      {
+        std::fill( out + position, out + run->Start, background );
+        std::fill( out + run->Start, out + run->Start + run->Length,
+          static_cast<OutputPixelType>( run->Label ) );
+        position = run->Start + run->Length;
+      }
+      std::fill( out + position, out + lineLength, background );
+    }
+
+  } // end ThreadedRunLengthVoting
+
+
   template< typename TInputImage, typename TOutputImage, typename TWeights >
     void
     LabelVoting2ImageFilter< TInputImage, TOutputImage, TWeights >
     ::ThreadedGenerateData( const OutputImageRegionType &outputRegionForThread,
     ThreadIdType threadId)
   {
+    /** Use the run-length kernel for sparse segmentations, if requested */
+    if( this->m_UseRunLengthKernel )
+    {
+      this->ThreadedRunLengthVoting( outputRegionForThread );
+      return;
+    }
+
+    /** Use the specialized kernels for small numbers of classes */
+    if( this->m_UseCompactVoting )
+    {
+      switch( this->m_NumberOfClasses )
+      {
+        case 2: this->template ThreadedCompactVoting<2>( outputRegionForThread ); return;
+        case 3: this->template ThreadedCompactVoting<3>( outputRegionForThread ); return;
+        case 4: this->template ThreadedCompactVoting<4>( outputRegionForThread ); return;
+        case 5: this->template ThreadedCompactVoting<5>( outputRegionForThread ); return;
+        case 6: this->template ThreadedCompactVoting<6>( outputRegionForThread ); return;
+        case 7: this->template ThreadedCompactVoting<7>( outputRegionForThread ); return;
+        case 8: this->template ThreadedCompactVoting<8>( outputRegionForThread ); return;
+        case 9: this->template ThreadedCompactVoting<9>( outputRegionForThread ); return;
+        case 10: this->template ThreadedCompactVoting<10>( outputRegionForThread ); return;
+        default: break;
+      }
+    }
+
     typedef Array<WeightsType>                  WType;
     typedef std::vector<InputConstIteratorType> InputConstIteratorArrayType;
     typedef std::vector<ProbIteratorType>       ProbIteratorArrayType;
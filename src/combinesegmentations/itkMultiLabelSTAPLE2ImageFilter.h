@@ -23,6 +23,7 @@
 
 #include "itkImageRegionIterator.h"
 #include "itkImageRegionConstIterator.h"
+#include "itkMultiThreader.h"
 
 #include <vector>
 #include "itkArray.h"
@@ -318,6 +319,54 @@ namespace itk
     itkSetObjectMacro( MaskImage, MaskImageType );
     itkGetObjectMacro( MaskImage, MaskImageType );
 
+    /** Setting: turn on/off whether the pixels where all observers agree
+     * are compressed; default: false.
+     *
+     * In multi-atlas fusion most pixels have a unanimous vote. The posterior
+     * of such a pixel only depends on its label, so these pixels are counted
+     * per label once, and the EM iterations only visit a compact list of the
+     * pixels where the observers disagree. The result is the same as without
+     * compression, up to rounding. The option is ignored when a prior
+     * probability image array is supplied, since then the posterior differs
+     * per pixel. */
+    itkSetMacro( CompressUnanimousPixels, bool );
+    itkGetConstMacro( CompressUnanimousPixels, bool );
+    itkBooleanMacro( CompressUnanimousPixels );
+
+    /** Get the number of pixels where the observers disagree, after updating
+     * with CompressUnanimousPixels on. */
+    itkGetConstMacro( NumberOfDisagreementPixels, SizeValueType );
+
+    /** Setting: turn on/off the squared extrapolation (SQUAREM) acceleration
+     * of the EM iterations; default: false.
+     *
+     * Every iteration then takes two EM steps, extrapolates the confusion
+     * matrices along them, and takes a third EM step from the extrapolated
+     * point, on which the convergence is checked. This reaches the same fixed
+     * point in far fewer EM steps. The ElapsedIterations count all EM steps,
+     * each of which is a pass over the image. */
+    itkSetMacro( UseSquaredExtrapolation, bool );
+    itkGetConstMacro( UseSquaredExtrapolation, bool );
+    itkBooleanMacro( UseSquaredExtrapolation );
+
+    /** Set/get the subsampling factor of the initialization; default 1, off.
+     *
+     * With a factor f > 1, the EM is first run to convergence on the voxels
+     * whose index is a multiple of f in every dimension, using the compact
+     * representation of CompressUnanimousPixels, and the iterations on the
+     * full image start from the confusion matrices found there. These are
+     * close to the final ones, so that usually a few full iterations
+     * remain, and the cheap coarse iterations do most of the work. A class
+     * that does not occur in the subsample keeps its initial column. The
+     * option is ignored when a prior probability image array or initial
+     * confusion matrices are supplied. */
+    itkSetMacro( InitializationSubsamplingFactor, unsigned int );
+    itkGetConstMacro( InitializationSubsamplingFactor, unsigned int );
+
+    /** Get the number of EM iterations on the subsample, after updating
+     * with an InitializationSubsamplingFactor larger than 1. */
+    itkGetConstMacro( ElapsedInitializationIterations, unsigned int );
+
     /** Set whether a majority voting step should be used
      * to initialize the confusion matrix */
     itkSetMacro( InitializeWithMajorityVoting, bool)
@@ -358,6 +407,35 @@ namespace itk
       return this->m_ConfusionMatrixArray[ i ];
     }
 
+    /** Set/unset the initial confusion matrices, one for each input. If not
+     * set, they are initialized from the observer trust or by majority voting.
+     * Together with a maximum number of iterations of 0, the output is
+     * computed from the given confusion matrices. */
+    virtual void SetConfusionMatrixArray( const std::vector<ConfusionMatrixType> & arg )
+    {
+      this->m_InitialConfusionMatrixArray = arg;
+      this->m_HasConfusionMatrixArray = true;
+      this->Modified();
+    }
+
+    virtual void UnsetConfusionMatrixArray( void )
+    {
+      if( this->m_HasConfusionMatrixArray )
+      {
+        this->m_HasConfusionMatrixArray = false;
+        this->Modified();
+      }
+    }
+
+    /** Get the sums of the class probabilities of the last iteration for the
+     * i-th input segmentation, before the normalization of the columns.
+     * Adding these for disjoint parts of an image, and normalizing the
+     * columns, gives the iteration for the complete image. */
+    virtual const ConfusionMatrixType & GetConfusionMatrixSum( const unsigned int i ) const
+    {
+      return this->m_ConfusionMatrixSumArray[ i ];
+    }
+
     /** Get the number of elapsed iterations */
     itkGetConstMacro( ElapsedIterations, unsigned int );
 
@@ -385,6 +463,65 @@ namespace itk
     virtual void AllocateConfusionMatrixArray();
     virtual void InitializeConfusionMatrixArray();
 
+    /** The thread info passed to the thread callbacks. */
+    typedef MultiThreader::ThreadInfoStruct           ThreadInfoType;
+
+    /** The E and M step of one iteration, on a region of the image.
+     * The updates of the confusion matrices are accumulated in the
+     * partials of the thread. */
+    virtual void ThreadedEMStep( const OutputImageRegionType & region,
+      ThreadIdType threadId );
+
+    /** Compute the output labels, and the probabilistic segmentations,
+     * of a region of the image. */
+    virtual void ThreadedGenerateOutput( const OutputImageRegionType & region,
+      ThreadIdType threadId );
+
+    /** The E step of one pixel: the normalized class probabilities. */
+    void ComputeWeights( const std::vector<InputConstIteratorType> & it,
+      std::vector<ProbConstIteratorType> & pit, Array<WeightsType> & W ) const;
+
+    /** The E step of one pixel with the given labels of all observers,
+     * using the prior probabilities. */
+    void ComputeWeights( const InputPixelType * labels, Array<WeightsType> & W ) const;
+
+    /** The label with the maximum weight, with the prior preference
+     * deciding between equal weights. */
+    OutputPixelType ComputeWinningLabel( const Array<WeightsType> & W ) const;
+
+    /** Collect the labels of the pixels where the observers disagree,
+     * and count the unanimous pixels per label. Only used with
+     * CompressUnanimousPixels on, or for the initialization, which only
+     * visits the voxels whose index is a multiple of subsamplingFactor
+     * in every dimension. */
+    virtual void BuildDisagreementList( unsigned int subsamplingFactor = 1 );
+
+    /** Run the EM on the subsample of the InitializationSubsamplingFactor,
+     * starting from and replacing m_ConfusionMatrixArray. */
+    virtual void InitializeConfusionMatrixArrayOnSubsample( void );
+
+    /** The E and M step of one iteration, on a part of the compact list
+     * of disagreement pixels. */
+    virtual void ThreadedCompressedEMStep( SizeValueType begin, SizeValueType end,
+      ThreadIdType threadId );
+
+    /** Add the contribution of the unanimous pixels to the updated
+     * confusion matrices. */
+    virtual void AddUnanimousPixelsEMStep( void );
+
+    /** One EM step: compute the normalized m_UpdatedConfusionMatrixArray
+     * from m_ConfusionMatrixArray, in parallel. */
+    virtual void ComputeUpdatedConfusionMatrices( void );
+
+    /** Take two EM steps from the current confusion matrices, and
+     * replace them by the SQUAREM extrapolation. */
+    virtual void ExtrapolateConfusionMatrices( void );
+
+    /** Static callbacks for the multithreader; they split the requested
+     * region and call ThreadedEMStep() and ThreadedGenerateOutput(). */
+    static ITK_THREAD_RETURN_TYPE EMStepThreaderCallback( void * arg );
+    static ITK_THREAD_RETURN_TYPE OutputThreaderCallback( void * arg );
+
     /** The number of different labels found in the input segmentations */
     InputPixelType m_NumberOfClasses;
 
@@ -396,6 +533,7 @@ namespace itk
     bool m_HasPriorProbabilityImageArray;
     bool m_HasNumberOfClasses;
     bool m_HasPriorPreference;
+    bool m_HasConfusionMatrixArray;
 
     /** These variables could in principle be accessed via the member functions,
      * but for inheriting classes this would be annoying. So, make them protected. */
@@ -404,12 +542,28 @@ namespace itk
     ObserverTrustType                  m_ObserverTrust;
     std::vector<ConfusionMatrixType>   m_ConfusionMatrixArray;
     std::vector<ConfusionMatrixType>   m_UpdatedConfusionMatrixArray;
+    std::vector<ConfusionMatrixType>   m_InitialConfusionMatrixArray;
+    std::vector<ConfusionMatrixType>   m_ConfusionMatrixSumArray;
+    std::vector< std::vector<ConfusionMatrixType> > m_ThreadUpdatedConfusionMatrixArray;
     ProbabilisticSegmentationArrayType m_ProbabilisticSegmentationArray;
     PriorPreferenceType                m_PriorPreference;
 
     /** Variables updated during iterating: */
     WeightsType m_MaximumConfusionMatrixElementUpdate;
     unsigned int m_ElapsedIterations;
+    unsigned int m_ElapsedInitializationIterations;
+    OutputPixelType m_LeastPreferredLabel;
+
+    /** The compressed representation of the inputs: the labels of all
+     * observers for each disagreement pixel, and the number of unanimous
+     * pixels for each label. The weights and winning label of a
+     * unanimous pixel are computed once per label for the output. */
+    bool                               m_UseCompressedPixels;
+    SizeValueType                      m_NumberOfDisagreementPixels;
+    std::vector<InputPixelType>        m_DisagreementLabels;
+    std::vector<SizeValueType>         m_UnanimousPixelCount;
+    ConfusionMatrixType                m_UnanimousWeights;
+    std::vector<OutputPixelType>       m_UnanimousWinningLabel;
 
   private:
     MultiLabelSTAPLE2ImageFilter(const Self&); //purposely not implemented
@@ -421,6 +575,9 @@ namespace itk
     WeightsType m_TerminationUpdateThreshold;
     MaskImagePointer m_MaskImage;
     bool m_InitializeWithMajorityVoting;
+    bool m_CompressUnanimousPixels;
+    bool m_UseSquaredExtrapolation;
+    unsigned int m_InitializationSubsamplingFactor;
 
 
   };
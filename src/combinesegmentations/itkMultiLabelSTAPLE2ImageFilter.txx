@@ -22,6 +22,7 @@
 #include "itkLabelVoting2ImageFilter.h"
 
 #include "vnl/vnl_math.h"
+#include <algorithm>
 
 namespace itk
 {
@@ -36,6 +37,7 @@ namespace itk
     this->m_HasNumberOfClasses = false;
     this->m_HasMaximumNumberOfIterations = false;
     this->m_HasObserverTrust = false;
+    this->m_HasConfusionMatrixArray = false;
 
     this->m_TerminationUpdateThreshold = 1e-5;
     this->m_ElapsedIterations = 0;
@@ -44,6 +46,12 @@ namespace itk
     this->m_NumberOfClasses = 2;
     this->m_MaskImage = 0;
     this->m_InitializeWithMajorityVoting = false;
+    this->m_CompressUnanimousPixels = false;
+    this->m_UseSquaredExtrapolation = false;
+    this->m_InitializationSubsamplingFactor = 1;
+    this->m_ElapsedInitializationIterations = 0;
+    this->m_UseCompressedPixels = false;
+    this->m_NumberOfDisagreementPixels = 0;
   } // end constructor
 
 
@@ -243,24 +251,668 @@ namespace itk
   } // end InitializePriorProbabilities
 
 
+  template< typename TInputImage, typename TOutputImage, typename TWeights >
+    ITK_THREAD_RETURN_TYPE
+    MultiLabelSTAPLE2ImageFilter< TInputImage, TOutputImage, TWeights >
+    ::EMStepThreaderCallback( void * arg )
+  {
+    ThreadInfoType * info = static_cast<ThreadInfoType *>( arg );
+    Self * filter = static_cast<Self *>( info->UserData );
+
+    /** With compressed pixels, split the list of disagreement pixels */
+    if( filter->m_UseCompressedPixels )
+    {
+      const SizeValueType n = filter->m_NumberOfDisagreementPixels;
+      const SizeValueType begin = n * info->ThreadID / info->NumberOfThreads;
+      const SizeValueType end = n * ( info->ThreadID + 1 ) / info->NumberOfThreads;
+      filter->ThreadedCompressedEMStep( begin, end, info->ThreadID );
+      return ITK_THREAD_RETURN_VALUE;
+    }
+
+    /** Otherwise, split the requested region like ImageSource does */
+    OutputImageRegionType splitRegion;
+    const ThreadIdType total = filter->SplitRequestedRegion(
+      info->ThreadID, info->NumberOfThreads, splitRegion );
+    if( info->ThreadID < total )
+    {
+      filter->ThreadedEMStep( splitRegion, info->ThreadID );
+    }
+
+    return ITK_THREAD_RETURN_VALUE;
+  } // end EMStepThreaderCallback
+
+
+  template< typename TInputImage, typename TOutputImage, typename TWeights >
+    ITK_THREAD_RETURN_TYPE
+    MultiLabelSTAPLE2ImageFilter< TInputImage, TOutputImage, TWeights >
+    ::OutputThreaderCallback( void * arg )
+  {
+    ThreadInfoType * info = static_cast<ThreadInfoType *>( arg );
+    Self * filter = static_cast<Self *>( info->UserData );
+
+    OutputImageRegionType splitRegion;
+    const ThreadIdType total = filter->SplitRequestedRegion(
+      info->ThreadID, info->NumberOfThreads, splitRegion );
+    if( info->ThreadID < total )
+    {
+      filter->ThreadedGenerateOutput( splitRegion, info->ThreadID );
+    }
+
+    return ITK_THREAD_RETURN_VALUE;
+  } // end OutputThreaderCallback
+
+
+  template< typename TInputImage, typename TOutputImage, typename TWeights >
+    void
+    MultiLabelSTAPLE2ImageFilter< TInputImage, TOutputImage, TWeights >
+    ::ComputeWeights( const std::vector<InputConstIteratorType> & it,
+      std::vector<ProbConstIteratorType> & pit, Array<WeightsType> & W ) const
+  {
+    /** the E step for one pixel: the prior times the confusion matrix
+     * elements of all observers, normalized */
+    if( this->m_HasPriorProbabilityImageArray )
+    {
+      for ( OutputPixelType ci = 0; ci < this->m_NumberOfClasses; ++ci )
+      {
+        W[ci] = pit[ci].Get();
+      }
+    }
+    else
+    {
+      W = this->m_PriorProbabilities;
+    }
+
+    const unsigned int numberOfInputs = it.size();
+    for( unsigned int k = 0; k < numberOfInputs; ++k )
+    {
+      const InputPixelType j = it[k].Get();
+      for ( OutputPixelType ci = 0; ci < this->m_NumberOfClasses; ++ci )
+      {
+        W[ci] *= this->m_ConfusionMatrixArray[k][j][ci];
+      }
+    }
+
+    /** normalize: */
+    WeightsType sumW = W.sum();
+    if( sumW )
+    {
+      W /= sumW;
+    }
+  } // end ComputeWeights
+
+
+  template< typename TInputImage, typename TOutputImage, typename TWeights >
+    void
+    MultiLabelSTAPLE2ImageFilter< TInputImage, TOutputImage, TWeights >
+    ::ComputeWeights( const InputPixelType * labels, Array<WeightsType> & W ) const
+  {
+    W = this->m_PriorProbabilities;
+
+    const unsigned int numberOfInputs = this->GetNumberOfInputs();
+    for( unsigned int k = 0; k < numberOfInputs; ++k )
+    {
+      const InputPixelType j = labels[k];
+      for ( OutputPixelType ci = 0; ci < this->m_NumberOfClasses; ++ci )
+      {
+        W[ci] *= this->m_ConfusionMatrixArray[k][j][ci];
+      }
+    }
+
+    /** normalize: */
+    WeightsType sumW = W.sum();
+    if( sumW )
+    {
+      W /= sumW;
+    }
+  } // end ComputeWeights
+
+
+  template< typename TInputImage, typename TOutputImage, typename TWeights >
+    typename MultiLabelSTAPLE2ImageFilter< TInputImage, TOutputImage, TWeights >::OutputPixelType
+    MultiLabelSTAPLE2ImageFilter< TInputImage, TOutputImage, TWeights >
+    ::ComputeWinningLabel( const Array<WeightsType> & W ) const
+  {
+    OutputPixelType winningLabel = this->m_LeastPreferredLabel;
+    WeightsType winningLabelW = 0.0;
+    for ( OutputPixelType ci = 0; ci < this->m_NumberOfClasses; ++ci )
+    {
+      if( W[ci] > winningLabelW )
+      {
+        winningLabelW = W[ci];
+        winningLabel = ci;
+      }
+      else
+      {
+        if( ! (W[ci] < winningLabelW ) )
+        {
+          if( this->m_PriorPreference[ci] < this->m_PriorPreference[winningLabel] )
+          {
+            winningLabel = ci;
+          }
+        }
+      }
+    } // next ci
+
+    return winningLabel;
+  } // end ComputeWinningLabel
+
+
+  template< typename TInputImage, typename TOutputImage, typename TWeights >
+    void
+    MultiLabelSTAPLE2ImageFilter< TInputImage, TOutputImage, TWeights >
+    ::BuildDisagreementList( unsigned int subsamplingFactor )
+  {
+    const bool useMask = this->m_MaskImage.IsNotNull();
+    const unsigned int numberOfInputs = this->GetNumberOfInputs();
+    const MaskPixelType zeroMaskPixel = itk::NumericTraits<MaskPixelType>::Zero;
+    const OutputImageRegionType region = this->GetOutput()->GetRequestedRegion();
+
+    this->m_DisagreementLabels.clear();
+    this->m_UnanimousPixelCount.assign( this->m_NumberOfClasses, 0 );
+
+    /** create and initialize the iterators */
+    std::vector<InputConstIteratorType> it( numberOfInputs );
+    for( unsigned int k = 0; k < numberOfInputs; ++k )
+    {
+      it[k] = InputConstIteratorType( this->GetInput( k ), region );
+    }
+    MaskConstIteratorType mit;
+    if( useMask )
+    {
+      mit = MaskConstIteratorType( this->m_MaskImage, region );
+    }
+
+    /** Count the unanimous pixels, and store the labels of the others */
+    std::vector<InputPixelType> labels( numberOfInputs );
+    const typename OutputImageRegionType::IndexType start = region.GetIndex();
+    while ( ! it[0].IsAtEnd() )
+    {
+      bool onLattice = true;
+      if( subsamplingFactor > 1 )
+      {
+        const typename OutputImageRegionType::IndexType index = it[0].GetIndex();
+        for( unsigned int d = 0; d < ImageDimension; ++d )
+        {
+          onLattice &= ( ( index[d] - start[d] ) % subsamplingFactor == 0 );
+        }
+      }
+
+      if( onLattice && ( !useMask || mit.Get() != zeroMaskPixel ) )
+      {
+        bool unanimous = true;
+        for( unsigned int k = 0; k < numberOfInputs; ++k )
+        {
+          labels[k] = it[k].Get();
+          unanimous &= ( labels[k] == labels[0] );
+        }
+
+        if( unanimous )
+        {
+          ++(this->m_UnanimousPixelCount[ labels[0] ]);
+        }
+        else
+        {
+          this->m_DisagreementLabels.insert(
+            this->m_DisagreementLabels.end(), labels.begin(), labels.end() );
+        }
+      }
+
+      if( useMask ) ++mit;
+      for( unsigned int k = 0; k < numberOfInputs; ++k )
+      {
+        ++(it[k]);
+      }
+    }
+
+    this->m_NumberOfDisagreementPixels
+      = this->m_DisagreementLabels.size() / numberOfInputs;
+
+  } // end BuildDisagreementList
+
+
+  template< typename TInputImage, typename TOutputImage, typename TWeights >
+    void
+    MultiLabelSTAPLE2ImageFilter< TInputImage, TOutputImage, TWeights >
+    ::ThreadedCompressedEMStep( SizeValueType begin, SizeValueType end,
+      ThreadIdType threadId )
+  {
+    const unsigned int numberOfInputs = this->GetNumberOfInputs();
+    std::vector<ConfusionMatrixType> & updated
+      = this->m_ThreadUpdatedConfusionMatrixArray[ threadId ];
+    Array<WeightsType> W( this->m_NumberOfClasses );
+
+    for( SizeValueType i = begin; i < end; ++i )
+    {
+      const InputPixelType * labels = &( this->m_DisagreementLabels[ i * numberOfInputs ] );
+
+      /** the E step */
+      this->ComputeWeights( labels, W );
+
+      /** the M step */
+      for( unsigned int k = 0; k < numberOfInputs; ++k )
+      {
+        const InputPixelType j = labels[k];
+        for ( OutputPixelType ci = 0; ci < this->m_NumberOfClasses; ++ci )
+        {
+          updated[k][j][ci] += W[ci];
+        }
+      }
+    }
+
+  } // end ThreadedCompressedEMStep
+
+
+  template< typename TInputImage, typename TOutputImage, typename TWeights >
+    void
+    MultiLabelSTAPLE2ImageFilter< TInputImage, TOutputImage, TWeights >
+    ::AddUnanimousPixelsEMStep( void )
+  {
+    const unsigned int numberOfInputs = this->GetNumberOfInputs();
+    std::vector<InputPixelType> labels( numberOfInputs );
+    Array<WeightsType> W( this->m_NumberOfClasses );
+
+    /** All unanimous pixels with label j have the same weights */
+    for( InputPixelType j = 0; j < this->m_NumberOfClasses; ++j )
+    {
+      const SizeValueType count = this->m_UnanimousPixelCount[ j ];
+      if( count == 0 ) continue;
+
+      std::fill( labels.begin(), labels.end(), j );
+      this->ComputeWeights( &labels[0], W );
+      W *= static_cast<WeightsType>( count );
+
+      for( unsigned int k = 0; k < numberOfInputs; ++k )
+      {
+        for ( OutputPixelType ci = 0; ci < this->m_NumberOfClasses; ++ci )
+        {
+          this->m_UpdatedConfusionMatrixArray[k][j][ci] += W[ci];
+        }
+      }
+    }
+
+  } // end AddUnanimousPixelsEMStep
+
+
+  template< typename TInputImage, typename TOutputImage, typename TWeights >
+    void
+    MultiLabelSTAPLE2ImageFilter< TInputImage, TOutputImage, TWeights >
+    ::ThreadedEMStep( const OutputImageRegionType & region, ThreadIdType threadId )
+  {
+    const bool useMask = this->m_MaskImage.IsNotNull();
+    const unsigned int numberOfInputs = this->GetNumberOfInputs();
+    const MaskPixelType zeroMaskPixel = itk::NumericTraits<MaskPixelType>::Zero;
+    std::vector<ConfusionMatrixType> & updated
+      = this->m_ThreadUpdatedConfusionMatrixArray[ threadId ];
+    Array<WeightsType> W( this->m_NumberOfClasses );
+
+    /** create and initialize the iterators over this region */
+    std::vector<InputConstIteratorType> it( numberOfInputs );
+    for( unsigned int k = 0; k < numberOfInputs; ++k )
+    {
+      it[k] = InputConstIteratorType( this->GetInput( k ), region );
+    }
+    std::vector<ProbConstIteratorType> pit;
+    if( this->m_HasPriorProbabilityImageArray )
+    {
+      pit.resize( this->m_NumberOfClasses );
+      for( unsigned int k = 0; k < this->m_NumberOfClasses; ++k )
+      {
+        pit[k] = ProbConstIteratorType( this->m_PriorProbabilityImageArray[k], region );
+      }
+    }
+    MaskConstIteratorType mit;
+    if( useMask )
+    {
+      mit = MaskConstIteratorType( this->m_MaskImage, region );
+    }
+
+    /** Loop over voxels and do the E and M step
+     * use it[0] as indicator for image pixel count */
+    while ( ! it[0].IsAtEnd() )
+    {
+      if( !useMask || mit.Get() != zeroMaskPixel )
+      {
+        /** the E step */
+        this->ComputeWeights( it, pit, W );
+
+        /** the M step */
+        for( unsigned int k = 0; k < numberOfInputs; ++k )
+        {
+          const InputPixelType j = it[k].Get();
+          for ( OutputPixelType ci = 0; ci < this->m_NumberOfClasses; ++ci )
+          {
+            updated[k][j][ci] += W[ci];
+          }
+        }
+      }
+
+      /** Move all iterators to the next pixel */
+      if( useMask ) ++mit;
+      for( unsigned int k = 0; k < numberOfInputs; ++k )
+      {
+        ++(it[k]);
+      }
+      for( unsigned int ci = 0; ci < pit.size(); ++ci )
+      {
+        ++(pit[ci]);
+      }
+    } // end loop over voxels
+
+  } // end ThreadedEMStep
+
+
+  template< typename TInputImage, typename TOutputImage, typename TWeights >
+    void
+    MultiLabelSTAPLE2ImageFilter< TInputImage, TOutputImage, TWeights >
+    ::ThreadedGenerateOutput( const OutputImageRegionType & region, ThreadIdType )
+  {
+    const bool generateProbSeg = this->GetGenerateProbabilisticSegmentations();
+    const bool useMask = this->m_MaskImage.IsNotNull();
+    const unsigned int numberOfInputs = this->GetNumberOfInputs();
+    const MaskPixelType zeroMaskPixel = itk::NumericTraits<MaskPixelType>::Zero;
+    Array<WeightsType> W( this->m_NumberOfClasses );
+
+    /** create and initialize the iterators over this region */
+    std::vector<InputConstIteratorType> it( numberOfInputs );
+    for( unsigned int k = 0; k < numberOfInputs; ++k )
+    {
+      it[k] = InputConstIteratorType( this->GetInput( k ), region );
+    }
+    std::vector<ProbConstIteratorType> pit;
+    if( this->m_HasPriorProbabilityImageArray )
+    {
+      pit.resize( this->m_NumberOfClasses );
+      for( unsigned int k = 0; k < this->m_NumberOfClasses; ++k )
+      {
+        pit[k] = ProbConstIteratorType( this->m_PriorProbabilityImageArray[k], region );
+      }
+    }
+    std::vector<ProbIteratorType> psit;
+    if( generateProbSeg )
+    {
+      psit.resize( this->m_NumberOfClasses );
+      for( unsigned int k = 0; k < this->m_NumberOfClasses; ++k )
+      {
+        psit[k] = ProbIteratorType( this->m_ProbabilisticSegmentationArray[k], region );
+      }
+    }
+    MaskConstIteratorType mit;
+    if( useMask )
+    {
+      mit = MaskConstIteratorType( this->m_MaskImage, region );
+    }
+    OutputIteratorType out( this->GetOutput(), region );
+
+    for ( out.GoToBegin(); !out.IsAtEnd(); ++out )
+    {
+      OutputPixelType winningLabel = this->m_LeastPreferredLabel;
+
+      bool unanimous = false;
+      if( this->m_UseCompressedPixels )
+      {
+        unanimous = true;
+        for( unsigned int k = 1; k < numberOfInputs; ++k )
+        {
+          unanimous &= ( it[k].Get() == it[0].Get() );
+        }
+      }
+
+      if( useMask && mit.Get() == zeroMaskPixel )
+      {
+        /** For pixels outside the mask use the decision
+         * of th first observer */
+        W.Fill( 0.0 );
+        winningLabel = it[0].Get();
+        W[ winningLabel ] = 1.0;
+      }
+      else if( unanimous )
+      {
+        /** the weights of unanimous pixels are computed once per label */
+        const InputPixelType j = it[0].Get();
+        winningLabel = this->m_UnanimousWinningLabel[ j ];
+        if( generateProbSeg )
+        {
+          W.copy_in( this->m_UnanimousWeights[ j ] );
+        }
+      }
+      else
+      {
+        // basically, we'll repeat the E step from above
+        this->ComputeWeights( it, pit, W );
+
+        // now determine the label with the maximum W
+        winningLabel = this->ComputeWinningLabel( W );
+      }
+
+      /** Set the winning label to the output pixel */
+      out.Set( winningLabel );
+
+      /** copy the W values into the probabilistic segmentation images
+       * and move the psit iterators */
+      if( generateProbSeg )
+      {
+        for ( OutputPixelType ci = 0; ci < this->m_NumberOfClasses; ++ci )
+        {
+          psit[ci].Set( W[ci] );
+          ++(psit[ci]);
+        }
+      }
+
+      /** Move the input iterators to the next pixel */
+      if( useMask ) ++mit;
+      for( unsigned int k = 0; k < numberOfInputs; ++k )
+      {
+        ++(it[k]);
+      }
+      for( unsigned int ci = 0; ci < pit.size(); ++ci )
+      {
+        ++(pit[ci]);
+      }
+    } // end loop over output pixels
+
+  } // end ThreadedGenerateOutput
+
+
   template< typename TInputImage, typename TOutputImage, typename TWeights >
     void
     MultiLabelSTAPLE2ImageFilter< TInputImage, TOutputImage, TWeights >
-    ::GenerateData()
+    ::ComputeUpdatedConfusionMatrices( void )
+  {
+    const unsigned int numberOfInputs = this->GetNumberOfInputs();
+    const ThreadIdType numberOfThreads = this->m_ThreadUpdatedConfusionMatrixArray.size();
+
+    /** reset the updated confusion matrices of all threads */
+    for( ThreadIdType t = 0; t < numberOfThreads; ++t )
+    {
+      for( unsigned int k = 0; k < numberOfInputs; ++k )
+      {
+        this->m_ThreadUpdatedConfusionMatrixArray[t][k].Fill( 0.0 );
+      }
+    }
+
+    /** Do the E and M step on all voxels, in parallel. Every thread
+     * accumulates the updated confusion matrices of its own region,
+     * or its own part of the disagreement pixels. */
+    this->GetMultiThreader()->SetSingleMethod( this->EMStepThreaderCallback, this );
+    this->GetMultiThreader()->SingleMethodExecute();
+
+    /** Merge the partial updates, in a fixed order */
+    for( unsigned int k = 0; k < numberOfInputs; ++k )
+    {
+      this->m_UpdatedConfusionMatrixArray[k] = this->m_ThreadUpdatedConfusionMatrixArray[0][k];
+      for( ThreadIdType t = 1; t < numberOfThreads; ++t )
+      {
+        this->m_UpdatedConfusionMatrixArray[k] += this->m_ThreadUpdatedConfusionMatrixArray[t][k];
+      }
+    }
+    if( this->m_UseCompressedPixels )
+    {
+      this->AddUnanimousPixelsEMStep();
+    }
+    this->m_ConfusionMatrixSumArray = this->m_UpdatedConfusionMatrixArray;
+
+    /** Normalize matrix elements of each of the updated confusion matrices
+     * with sum over all expert decisions. */
+    for( unsigned int k = 0; k < numberOfInputs; ++k )
+    {
+      // compute sum over all output classifications
+      for ( OutputPixelType ci = 0; ci < this->m_NumberOfClasses; ++ci )
+      {
+        WeightsType sumW = this->m_UpdatedConfusionMatrixArray[k][0][ci];
+        for ( InputPixelType j = 1; j < this->m_NumberOfClasses; ++j )
+        {
+          sumW += this->m_UpdatedConfusionMatrixArray[k][j][ci];
+        }
+
+        // normalize with sumW for each class ci
+        if( sumW )
+        {
+          this->m_UpdatedConfusionMatrixArray[k].scale_column(ci, 1.0/sumW);
+        }
+      }
+    } // end for k: end normalization of updated confusion matrix
+
+  } // end ComputeUpdatedConfusionMatrices
+
+
+  template< typename TInputImage, typename TOutputImage, typename TWeights >
+    void
+    MultiLabelSTAPLE2ImageFilter< TInputImage, TOutputImage, TWeights >
+    ::ExtrapolateConfusionMatrices( void )
+  {
+    const unsigned int numberOfInputs = this->GetNumberOfInputs();
+
+    /** Two plain EM steps from theta0: theta1 = F(theta0), theta2 = F(theta1) */
+    const std::vector<ConfusionMatrixType> theta0 = this->m_ConfusionMatrixArray;
+    this->ComputeUpdatedConfusionMatrices();
+    this->m_ConfusionMatrixArray = this->m_UpdatedConfusionMatrixArray;
+    this->ComputeUpdatedConfusionMatrices();
+    this->m_ElapsedIterations += 2;
+
+    /** r = theta1 - theta0, v = theta2 - 2 theta1 + theta0 */
+    std::vector<ConfusionMatrixType> r( numberOfInputs );
+    std::vector<ConfusionMatrixType> v( numberOfInputs );
+    double normR2 = 0.0;
+    double normV2 = 0.0;
+    for( unsigned int k = 0; k < numberOfInputs; ++k )
+    {
+      r[k] = this->m_ConfusionMatrixArray[k] - theta0[k];
+      v[k] = this->m_UpdatedConfusionMatrixArray[k] - this->m_ConfusionMatrixArray[k] - r[k];
+      normR2 += r[k].frobenius_norm() * r[k].frobenius_norm();
+      normV2 += v[k].frobenius_norm() * v[k].frobenius_norm();
+    }
+
+    /** The step length of SQUAREM (Varadhan and Roland, 2008, scheme S3).
+     * A step length of -1 gives theta2, the plain EM result. */
+    double alpha = -1.0;
+    if( normV2 > 0.0 )
+    {
+      alpha = vnl_math_min( -1.0, -vcl_sqrt( normR2 / normV2 ) );
+    }
+
+    /** theta' = theta0 - 2 alpha r + alpha^2 v, projected back on valid
+     * confusion matrices: nonnegative elements, and columns summing to one. */
+    for( unsigned int k = 0; k < numberOfInputs; ++k )
+    {
+      ConfusionMatrixType & theta = this->m_ConfusionMatrixArray[k];
+      for ( InputPixelType j = 0; j < this->m_NumberOfClasses; ++j )
+      {
+        for ( OutputPixelType ci = 0; ci < this->m_NumberOfClasses; ++ci )
+        {
+          const double value = theta0[k][j][ci] - 2.0 * alpha * r[k][j][ci]
+            + alpha * alpha * v[k][j][ci];
+          theta[j][ci] = static_cast<WeightsType>( vnl_math_max( 0.0, value ) );
+        }
+      }
+
+      for ( OutputPixelType ci = 0; ci < this->m_NumberOfClasses; ++ci )
+      {
+        WeightsType sumW = theta[0][ci];
+        for ( InputPixelType j = 1; j < this->m_NumberOfClasses; ++j )
+        {
+          sumW += theta[j][ci];
+        }
+        if( sumW )
+        {
+          theta.scale_column( ci, 1.0/sumW );
+        }
+      }
+    } // end for k
+
+  } // end ExtrapolateConfusionMatrices
+
+
+  template< typename TInputImage, typename TOutputImage, typename TWeights >
+    void
+    MultiLabelSTAPLE2ImageFilter< TInputImage, TOutputImage, TWeights >
+    ::InitializeConfusionMatrixArrayOnSubsample( void )
   {
-    typedef Array<WeightsType>                  WType;
-    typedef std::vector<InputConstIteratorType> InputConstIteratorArrayType;
-    typedef std::vector<ProbIteratorType>       ProbIteratorArrayType;
-    typedef std::vector<ProbConstIteratorType>  ProbConstIteratorArrayType;
+    const unsigned int numberOfInputs = this->GetNumberOfInputs();
+    const std::vector<ConfusionMatrixType> initialConfusionMatrixArray
+      = this->m_ConfusionMatrixArray;
+
+    /** The compact representation of the subsample */
+    this->m_UseCompressedPixels = true;
+    this->BuildDisagreementList( this->m_InitializationSubsamplingFactor );
+
+    /** Plain EM iterations, with the termination criteria of the full image */
+    this->m_ElapsedInitializationIterations = 0;
+    while (  ( !this->m_HasMaximumNumberOfIterations ) ||
+             ( this->m_ElapsedInitializationIterations < this->m_MaximumNumberOfIterations ) )
+    {
+      this->ComputeUpdatedConfusionMatrices();
+
+      WeightsType maximumUpdate = 0;
+      for( unsigned int k = 0; k < numberOfInputs; ++k )
+      {
+        const WeightsType maximumUpdate_k = static_cast<WeightsType>(
+          (this->m_UpdatedConfusionMatrixArray[k]-this->m_ConfusionMatrixArray[k]).array_inf_norm() );
+        maximumUpdate = vnl_math_max( maximumUpdate, maximumUpdate_k );
+
+        this->m_ConfusionMatrixArray[k] = this->m_UpdatedConfusionMatrixArray[k];
+      }
+      ++(this->m_ElapsedInitializationIterations);
+
+      if( this->GetAbortGenerateData() ) break;
+      if( maximumUpdate < this->m_TerminationUpdateThreshold ) break;
+    }
+
+    /** A class without any weight in the subsample has an empty column;
+     * it would keep a zero probability in the full iterations. */
+    for( unsigned int k = 0; k < numberOfInputs; ++k )
+    {
+      for ( OutputPixelType ci = 0; ci < this->m_NumberOfClasses; ++ci )
+      {
+        WeightsType sumW = 0.0;
+        for ( InputPixelType j = 0; j < this->m_NumberOfClasses; ++j )
+        {
+          sumW += this->m_ConfusionMatrixArray[k][j][ci];
+        }
+        if( !sumW )
+        {
+          this->m_ConfusionMatrixArray[k].set_column( ci,
+            initialConfusionMatrixArray[k].get_column( ci ) );
+        }
+      }
+    }
+
+    this->m_UseCompressedPixels = false;
+    std::vector<InputPixelType>().swap( this->m_DisagreementLabels );
 
+  } // end InitializeConfusionMatrixArrayOnSubsample
+
+
+  template< typename TInputImage, typename TOutputImage, typename TWeights >
+    void
+    MultiLabelSTAPLE2ImageFilter< TInputImage, TOutputImage, TWeights >
+    ::GenerateData()
+  {
     /** Initialize some variables */
     this->m_MaximumConfusionMatrixElementUpdate = 0.0;
     this->m_ElapsedIterations = 0;
     const bool generateProbSeg =
       this->GetGenerateProbabilisticSegmentations();
-    const bool useMask = this->m_MaskImage.IsNotNull();
     const unsigned int numberOfInputs = this->GetNumberOfInputs();
-    WType W( this->m_NumberOfClasses );
     OutputImagePointer output = this->GetOutput();
     this->AllocateOutputs();
 
@@ -296,7 +948,30 @@ namespace itk
     /** Initialize prior probabilities and confusion matrices */
     this->InitializePriorProbabilities();
     this->AllocateConfusionMatrixArray();
-    this->InitializeConfusionMatrixArray();
+    if( this->m_HasConfusionMatrixArray )
+    {
+      if( this->m_InitialConfusionMatrixArray.size() != numberOfInputs )
+      {
+        itkExceptionMacro( "m_ConfusionMatrixArray has wrong size: "
+          << this->m_InitialConfusionMatrixArray.size() << "; should have "
+          << numberOfInputs << " elements!" );
+      }
+      for( unsigned int k = 0; k < numberOfInputs; ++k )
+      {
+        if( this->m_InitialConfusionMatrixArray[k].rows() != this->m_NumberOfClasses
+          || this->m_InitialConfusionMatrixArray[k].cols() != this->m_NumberOfClasses )
+        {
+          itkExceptionMacro( "The confusion matrix of input " << k
+            << " should be of size " << this->m_NumberOfClasses << "x"
+            << this->m_NumberOfClasses << "!" );
+        }
+        this->m_ConfusionMatrixArray[k] = this->m_InitialConfusionMatrixArray[k];
+      }
+    }
+    else
+    {
+      this->InitializeConfusionMatrixArray();
+    }
 
     /** If probabilistic segmentations are desired, allocate them */
     if( generateProbSeg )
@@ -314,155 +989,49 @@ namespace itk
       }
     }
 
-    /** create and initialize all input image iterators */
-    InputConstIteratorArrayType it(numberOfInputs);
-    for( unsigned int k = 0; k < numberOfInputs; ++k )
-    {
-      it[k] = InputConstIteratorType
-        ( this->GetInput( k ), output->GetRequestedRegion() );
-    }
-
-    /** Create and initialize the prior prob image iterators */
-    ProbConstIteratorArrayType pit;
-    if( this->m_HasPriorProbabilityImageArray )
+    /** The per-thread partial updates of the confusion matrices */
+    const ThreadIdType numberOfThreads = this->GetNumberOfThreads();
+    this->m_ThreadUpdatedConfusionMatrixArray.resize( numberOfThreads );
+    for( ThreadIdType t = 0; t < numberOfThreads; ++t )
     {
-      pit = ProbConstIteratorArrayType( this->m_NumberOfClasses );
-      for( unsigned int k = 0; k < this->m_NumberOfClasses; ++k )
-      {
-        pit[k] = ProbConstIteratorType(
-          this->m_PriorProbabilityImageArray[k], output->GetRequestedRegion() );
-      }
+      this->m_ThreadUpdatedConfusionMatrixArray[t] = this->m_UpdatedConfusionMatrixArray;
     }
-
-    /** Create and initialize the output probabilistic segmentation image iterators */
-    ProbIteratorArrayType psit;
-    if( generateProbSeg )
+    this->GetMultiThreader()->SetNumberOfThreads( numberOfThreads );
+    this->m_LeastPreferredLabel = leastPreferredLabel;
+
+    /** Initialize the confusion matrices on a subsample, if desired */
+    this->m_ElapsedInitializationIterations = 0;
+    if( this->m_InitializationSubsamplingFactor > 1
+      && !this->m_HasConfusionMatrixArray
+      && !this->m_HasPriorProbabilityImageArray )
     {
-      psit = ProbIteratorArrayType( this->m_NumberOfClasses );
-      for( unsigned int k = 0; k < this->m_NumberOfClasses; ++k )
-      {
-        psit[k] = ProbIteratorType(
-          this->m_ProbabilisticSegmentationArray[k], output->GetRequestedRegion() );
-      }
+      this->InitializeConfusionMatrixArrayOnSubsample();
     }
 
-    /** Create and initialize the mask iterator */
-    MaskConstIteratorType mit;
-    const MaskPixelType zeroMaskPixel = itk::NumericTraits<MaskPixelType>::Zero;
-    if( useMask )
+    /** Compress the unanimous pixels, if desired and possible */
+    this->m_UseCompressedPixels = this->m_CompressUnanimousPixels
+      && !this->m_HasPriorProbabilityImageArray;
+    this->m_NumberOfDisagreementPixels = 0;
+    if( this->m_UseCompressedPixels )
     {
-      mit = MaskConstIteratorType(
-        this->m_MaskImage, this->GetOutput()->GetRequestedRegion() );
+      this->BuildDisagreementList();
     }
 
-    /** Create and initialize the output iterator */
-    OutputIteratorType out = OutputIteratorType( output, output->GetRequestedRegion() );
-
     /** Start iterating! */
     while (  ( !this->m_HasMaximumNumberOfIterations ) ||
              ( this->m_ElapsedIterations < this->m_MaximumNumberOfIterations )   )
     {
-      /** reset updated confusion matrix */
-      for( unsigned int k = 0; k < numberOfInputs; ++k )
+      /** Accelerate with a squared extrapolation step, if there is room
+       * for the two extra EM steps it needs */
+      if( this->m_UseSquaredExtrapolation
+        && ( ( !this->m_HasMaximumNumberOfIterations ) ||
+           ( this->m_ElapsedIterations + 3 <= this->m_MaximumNumberOfIterations ) ) )
       {
-        this->m_UpdatedConfusionMatrixArray[k].Fill( 0.0 );
+        this->ExtrapolateConfusionMatrices();
       }
 
-      /** Loop over voxels and do the E and M step
-       * use it[0] as indicator for image pixel count */
-      while ( ! it[0].IsAtEnd() )
-      {
-        if(useMask)
-        {
-          if( mit.Get() == zeroMaskPixel )
-          {
-            /** Move all iterators to the next pixel and go to the
-             * next cycle of the while loop */
-            ++mit;
-            for( unsigned int k = 0; k < numberOfInputs; ++k )
-            {
-              ++(it[k]);
-            }
-            if( this->m_HasPriorProbabilityImageArray )
-            {
-              for ( OutputPixelType ci = 0; ci < this->m_NumberOfClasses; ++ci )
-              {
-                ++(pit[ci]);
-              }
-            }
-            continue;
-          } // end if mit==zero
-          /** Move the iterator to the next pixel */
-          ++mit;
-        } // end if useMask
-
-        /** the following is the E step for one pixel, only performed when this
-         * pixel is inside the mask */
-        if( this->m_HasPriorProbabilityImageArray )
-        {
-          for ( OutputPixelType ci = 0; ci < this->m_NumberOfClasses; ++ci )
-          {
-            W[ci] = pit[ci].Get();
-            /** move already to next pixel */
-            ++(pit[ci]);
-          }
-        }
-        else
-        {
-          W = this->m_PriorProbabilities;
-        }
-
-        for( unsigned int k = 0; k < numberOfInputs; ++k )
-        {
-          const InputPixelType j = it[k].Get();
-          for ( OutputPixelType ci = 0; ci < this->m_NumberOfClasses; ++ci )
-          {
-            W[ci] *= this->m_ConfusionMatrixArray[k][j][ci];
-          }
-        }
-
-        // the following is the M step
-        /** normalize: */
-        WeightsType sumW = W.sum();
-        if( sumW )
-        {
-          W /= sumW;
-        }
-
-        for( unsigned int k = 0; k < numberOfInputs; ++k )
-        {
-          const InputPixelType j = it[k].Get();
-          for ( OutputPixelType ci = 0; ci < this->m_NumberOfClasses; ++ci )
-          {
-            this->m_UpdatedConfusionMatrixArray[k][j][ci] += W[ci];
-          }
-
-          // we're now done with this input pixel, so update.
-          ++(it[k]);
-        }
-
-      } // end loop over voxels
-
-      /** Normalize matrix elements of each of the updated confusion matrices
-       * with sum over all expert decisions. */
-      for( unsigned int k = 0; k < numberOfInputs; ++k )
-      {
-        // compute sum over all output classifications
-        for ( OutputPixelType ci = 0; ci < this->m_NumberOfClasses; ++ci )
-        {
-          WeightsType sumW = this->m_UpdatedConfusionMatrixArray[k][0][ci];
-          for ( InputPixelType j = 1; j < this->m_NumberOfClasses; ++j )
-          {
-            sumW += this->m_UpdatedConfusionMatrixArray[k][j][ci];
-          }
-
-          // normalize with sumW for each class ci
-          if( sumW )
-          {
-            this->m_UpdatedConfusionMatrixArray[k].scale_column(ci, 1.0/sumW);
-          }
-        }
-      } // end for k: end normalization of updated confusion matrix
+      /** Do the E and M step on all voxels */
+      this->ComputeUpdatedConfusionMatrices();
 
       // now we're applying the update to the confusion matrices and compute the
       // maximum parameter change in the process, to check for convergence.
@@ -479,24 +1048,10 @@ namespace itk
 
       /** We have finished this iteration */
       ++(this->m_ElapsedIterations);
-
-      /** reset all input iterators to start, to be prepared for next iteration
-       * or for generating the final segmentation, if the current iteration
-       * happened to be the last one */
-      if(useMask)
-      {
-        mit.GoToBegin();
-      }
-      for( unsigned int k = 0; k < numberOfInputs; ++k )
-      {
-        it[k].GoToBegin();
-      }
-      if( this->m_HasPriorProbabilityImageArray )
+      if( this->m_HasMaximumNumberOfIterations )
       {
-        for( unsigned int k = 0; k < this->m_NumberOfClasses; ++k )
-        {
-          pit[k].GoToBegin();
-        }
+        this->UpdateProgress( static_cast<float>( this->m_ElapsedIterations )
+          / static_cast<float>( this->m_MaximumNumberOfIterations + 1 ) );
       }
 
       /** Allow user to do something */
@@ -515,113 +1070,30 @@ namespace itk
 
     } // end for ( iteration )
 
+    /** The partial updates and the disagreement list are not needed anymore */
+    this->m_ThreadUpdatedConfusionMatrixArray.clear();
+    std::vector<InputPixelType>().swap( this->m_DisagreementLabels );
 
-    /** now we'll build the combined output image based on the estimated
-     * confusion matrices */
-    for ( out.GoToBegin(); !out.IsAtEnd(); ++out )
+    /** Compute the weights and winning label of the unanimous pixels */
+    if( this->m_UseCompressedPixels )
     {
-      OutputPixelType winningLabel = leastPreferredLabel;
-
-      bool insideMask = true;
-      if(useMask)
-      {
-        /** For pixels outside the mask use the decision
-         * of th first observer */
-        if( mit.Get() == zeroMaskPixel )
-        {
-          insideMask = false;
-          W.Fill( 0.0 );
-          winningLabel = it[0].Get();
-          W[ winningLabel ] = 1.0;
-          /** Set the winning label to the output pixel */
-          out.Set( winningLabel );
-          /** move the pit and it iterators */
-          if( this->m_HasPriorProbabilityImageArray )
-          {
-            for ( OutputPixelType ci = 0; ci < this->m_NumberOfClasses; ++ci )
-            {
-              ++(pit[ci]);
-            }
-          }
-          for( unsigned int k = 0; k < numberOfInputs; ++k )
-          {
-            ++(it[k]);
-          }
-        } // if mit==zero
-        ++mit;
-      } // end if useMask
-
-      if( insideMask )
-      {
-        // basically, we'll repeat the E step from above
-        if( this->m_HasPriorProbabilityImageArray )
-        {
-          for ( OutputPixelType ci = 0; ci < this->m_NumberOfClasses; ++ci )
-          {
-            W[ci] = pit[ci].Get();
-            ++(pit[ci]);
-          }
-        }
-        else
-        {
-          W = this->m_PriorProbabilities;
-        }
-
-        for( unsigned int k = 0; k < numberOfInputs; ++k )
-        {
-          const InputPixelType j = it[k].Get();
-          for ( OutputPixelType ci = 0; ci < this->m_NumberOfClasses; ++ci )
-          {
-            W[ci] *= this->m_ConfusionMatrixArray[k][j][ci];
-          }
-          ++(it[k]);
-        }
-
-        /** normalize: */
-        WeightsType sumW = W.sum();
-        if( sumW )
-        {
-          W /= sumW;
-        }
-
-        // now determine the label with the maximum W
-        WeightsType winningLabelW = 0.0;
-        for ( OutputPixelType ci = 0; ci < this->m_NumberOfClasses; ++ci )
-        {
-          if( W[ci] > winningLabelW )
-          {
-            winningLabelW = W[ci];
-            winningLabel = ci;
-          }
-          else
-          {
-            if( ! (W[ci] < winningLabelW ) )
-            {
-              if( this->m_PriorPreference[ci] < this->m_PriorPreference[winningLabel] )
-              {
-                winningLabel = ci;
-              }
-            }
-          }
-        } // next ci
-
-        /** Set the winning label to the output pixel */
-        out.Set( winningLabel );
-      } // end if insideMask
-
-
-      /** copy the W values into the probabilistic segmentation images
-       * and move the psit iterators */
-      if( generateProbSeg )
+      std::vector<InputPixelType> labels( numberOfInputs );
+      Array<WeightsType> W( this->m_NumberOfClasses );
+      this->m_UnanimousWeights.SetSize( this->m_NumberOfClasses, this->m_NumberOfClasses );
+      this->m_UnanimousWinningLabel.resize( this->m_NumberOfClasses );
+      for( InputPixelType j = 0; j < this->m_NumberOfClasses; ++j )
       {
-        for ( OutputPixelType ci = 0; ci < this->m_NumberOfClasses; ++ci )
-        {
-          psit[ci].Set( W[ci] );
-          ++(psit[ci]);
-        }
+        std::fill( labels.begin(), labels.end(), j );
+        this->ComputeWeights( &labels[0], W );
+        this->m_UnanimousWeights.set_row( j, W );
+        this->m_UnanimousWinningLabel[ j ] = this->ComputeWinningLabel( W );
       }
+    }
 
-    } // end loop over output pixels
+    /** now we'll build the combined output image based on the estimated
+     * confusion matrices, in parallel */
+    this->GetMultiThreader()->SetSingleMethod( this->OutputThreaderCallback, this );
+    this->GetMultiThreader()->SingleMethodExecute();
 
   } // end GenerateData
 
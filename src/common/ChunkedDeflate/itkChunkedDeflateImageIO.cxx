@@ -0,0 +1,762 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#include "itkChunkedDeflateImageIO.h"
+
+#include "itkByteSwapper.h"
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
+#include "itk_zlib.h"
+#include <itksys/SystemTools.hxx>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+
+namespace itk
+{
+
+// block engine
+//
+// a block is deflated on its own. the threads take the next block from a
+// shared counter; for reading every thread has its own file stream,
+// writing is done by the calling thread.
+
+struct ChunkedDeflateThreadStruct
+{
+  // the block layout
+  unsigned int    Dimension;
+  SizeValueType   PixelBytes;
+  std::vector<SizeValueType> ImageSize;
+  std::vector<SizeValueType> BlockSize;
+  std::vector<SizeValueType> GridSize;
+  bool            Compressed;
+  int             CompressionLevel;
+
+  // reading: the file, the index, the blocks to read, and the region
+  std::string     FileName;
+  std::streamoff  DataStart;
+  const std::vector<unsigned long long> * BlockOffsets;
+  std::vector<SizeValueType> Blocks;
+  std::vector<SizeValueType> RegionStart;
+  std::vector<SizeValueType> RegionSize;
+  unsigned char * Buffer;
+
+  // writing: the image, and the blocks of the current batch
+  const unsigned char * Image;
+  std::vector< std::vector<unsigned char> > BlockData;
+  SizeValueType   FirstBlock;
+
+  SizeValueType   NextBlock;
+  SizeValueType   EndBlock;
+  std::string     Error;
+  SimpleFastMutexLock Mutex;
+};
+
+// take the next block, unless a thread failed; returns false if done
+static bool GetNextBlock( ChunkedDeflateThreadStruct * s, SizeValueType & i )
+{
+  s->Mutex.Lock();
+  i = s->NextBlock++;
+  const bool failed = !s->Error.empty();
+  s->Mutex.Unlock();
+  return !failed && i < s->EndBlock;
+}
+
+static void SetBlockError( ChunkedDeflateThreadStruct * s, const std::string & error )
+{
+  s->Mutex.Lock();
+  if( s->Error.empty() )
+  {
+    s->Error = error;
+  }
+  s->Mutex.Unlock();
+}
+
+// the start and size of a block in the image; returns the number of pixels
+static SizeValueType GetBlockBox( const ChunkedDeflateThreadStruct * s, SizeValueType block,
+  std::vector<SizeValueType> & start, std::vector<SizeValueType> & size )
+{
+  SizeValueType numberOfPixels = 1;
+  start.resize( s->Dimension );
+  size.resize( s->Dimension );
+  for( unsigned int d = 0; d < s->Dimension; ++d )
+  {
+    start[ d ] = ( block % s->GridSize[ d ] ) * s->BlockSize[ d ];
+    size[ d ] = std::min( s->BlockSize[ d ], s->ImageSize[ d ] - start[ d ] );
+    block /= s->GridSize[ d ];
+    numberOfPixels *= size[ d ];
+  }
+  return numberOfPixels;
+}
+
+// copy the box [boxStart, boxStart+boxSize) from the array src, that holds
+// the box at srcStart of srcSize, to the array dst, line by line
+static void CopyBox( unsigned int dim, SizeValueType pixelBytes,
+  const unsigned char * src, const std::vector<SizeValueType> & srcStart,
+  const std::vector<SizeValueType> & srcSize,
+  unsigned char * dst, const std::vector<SizeValueType> & dstStart,
+  const std::vector<SizeValueType> & dstSize,
+  const std::vector<SizeValueType> & boxStart, const std::vector<SizeValueType> & boxSize )
+{
+  for( unsigned int d = 0; d < dim; ++d )
+  {
+    if( boxSize[ d ] == 0 ) return;
+  }
+
+  const SizeValueType lineBytes = boxSize[ 0 ] * pixelBytes;
+  std::vector<SizeValueType> position( dim, 0 );
+  bool done = false;
+  while( !done )
+  {
+    SizeValueType srcOffset = 0;
+    SizeValueType dstOffset = 0;
+    for( unsigned int d = dim; d-- > 0; )
+    {
+      srcOffset = srcOffset * srcSize[ d ] + boxStart[ d ] + position[ d ] - srcStart[ d ];
+      dstOffset = dstOffset * dstSize[ d ] + boxStart[ d ] + position[ d ] - dstStart[ d ];
+    }
+    std::memcpy( dst + dstOffset * pixelBytes, src + srcOffset * pixelBytes, lineBytes );
+
+    /** The next line of the box. */
+    done = true;
+    for( unsigned int d = 1; d < dim && done; ++d )
+    {
+      if( ++position[ d ] < boxSize[ d ] )
+      {
+        done = false;
+      }
+      else
+      {
+        position[ d ] = 0;
+      }
+    }
+  }
+}
+
+static ITK_THREAD_RETURN_TYPE ChunkedDeflateReadThreaderCallback( void * arg )
+{
+  MultiThreader::ThreadInfoStruct * info
+    = static_cast<MultiThreader::ThreadInfoStruct *>( arg );
+  ChunkedDeflateThreadStruct * s = static_cast<ChunkedDeflateThreadStruct *>( info->UserData );
+
+  std::ifstream file( s->FileName.c_str(), std::ios::in | std::ios::binary );
+  if( !file.is_open() )
+  {
+    SetBlockError( s, "Could not open " + s->FileName + " for reading." );
+    return ITK_THREAD_RETURN_VALUE;
+  }
+
+  std::vector<unsigned char> stored;
+  std::vector<unsigned char> blockData;
+  std::vector<SizeValueType> blockStart, blockSize;
+  std::vector<SizeValueType> overlapStart( s->Dimension ), overlapSize( s->Dimension );
+  SizeValueType i = 0;
+  while( GetNextBlock( s, i ) )
+  {
+    const SizeValueType block = s->Blocks[ i ];
+    const unsigned long long begin = ( *s->BlockOffsets )[ block ];
+    const unsigned long long end = ( *s->BlockOffsets )[ block + 1 ];
+    const SizeValueType blockBytes
+      = GetBlockBox( s, block, blockStart, blockSize ) * s->PixelBytes;
+
+    stored.resize( static_cast<std::size_t>( end - begin ) + 1 );
+    file.seekg( s->DataStart + static_cast<std::streamoff>( begin ) );
+    file.read( reinterpret_cast<char *>( &stored[ 0 ] ),
+      static_cast<std::streamsize>( end - begin ) );
+    if( !file )
+    {
+      std::ostringstream error;
+      error << "Could not read block " << block << " of " << s->FileName << ".";
+      SetBlockError( s, error.str() );
+      break;
+    }
+
+    const unsigned char * pixels = &stored[ 0 ];
+    if( s->Compressed )
+    {
+      blockData.resize( blockBytes );
+      uLongf length = static_cast<uLongf>( blockBytes );
+      if( uncompress( &blockData[ 0 ], &length, &stored[ 0 ],
+        static_cast<uLong>( end - begin ) ) != Z_OK || length != blockBytes )
+      {
+        std::ostringstream error;
+        error << "Could not decompress block " << block << " of " << s->FileName << ".";
+        SetBlockError( s, error.str() );
+        break;
+      }
+      pixels = &blockData[ 0 ];
+    }
+    else if( end - begin != blockBytes )
+    {
+      std::ostringstream error;
+      error << "Block " << block << " of " << s->FileName << " has the wrong size.";
+      SetBlockError( s, error.str() );
+      break;
+    }
+
+    /** Copy the part of the block inside the region. */
+    for( unsigned int d = 0; d < s->Dimension; ++d )
+    {
+      overlapStart[ d ] = std::max( blockStart[ d ], s->RegionStart[ d ] );
+      const SizeValueType overlapEnd = std::min( blockStart[ d ] + blockSize[ d ],
+        s->RegionStart[ d ] + s->RegionSize[ d ] );
+      overlapSize[ d ] = overlapEnd > overlapStart[ d ] ? overlapEnd - overlapStart[ d ] : 0;
+    }
+    CopyBox( s->Dimension, s->PixelBytes, pixels, blockStart, blockSize,
+      s->Buffer, s->RegionStart, s->RegionSize, overlapStart, overlapSize );
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+static ITK_THREAD_RETURN_TYPE ChunkedDeflateWriteThreaderCallback( void * arg )
+{
+  MultiThreader::ThreadInfoStruct * info
+    = static_cast<MultiThreader::ThreadInfoStruct *>( arg );
+  ChunkedDeflateThreadStruct * s = static_cast<ChunkedDeflateThreadStruct *>( info->UserData );
+
+  const std::vector<SizeValueType> imageStart( s->Dimension, 0 );
+  std::vector<unsigned char> pixels;
+  std::vector<SizeValueType> blockStart, blockSize;
+  SizeValueType i = 0;
+  while( GetNextBlock( s, i ) )
+  {
+    /** Gather the block. */
+    const SizeValueType blockBytes
+      = GetBlockBox( s, i, blockStart, blockSize ) * s->PixelBytes;
+    std::vector<unsigned char> & data = s->BlockData[ i - s->FirstBlock ];
+    std::vector<unsigned char> & gathered = s->Compressed ? pixels : data;
+    gathered.resize( blockBytes );
+    CopyBox( s->Dimension, s->PixelBytes, s->Image, imageStart, s->ImageSize,
+      &gathered[ 0 ], blockStart, blockSize, blockStart, blockSize );
+    if( !s->Compressed ) continue;
+
+    uLongf length = compressBound( static_cast<uLong>( blockBytes ) );
+    data.resize( length );
+    if( compress2( &data[ 0 ], &length, &pixels[ 0 ], static_cast<uLong>( blockBytes ),
+      s->CompressionLevel ) != Z_OK )
+    {
+      SetBlockError( s, "Could not compress a block." );
+      break;
+    }
+    data.resize( length );
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+/**
+ * ******************* Constructor *******************
+ */
+
+ChunkedDeflateImageIO::ChunkedDeflateImageIO()
+{
+  this->m_ChunkSize = 1048576;
+  this->m_CompressionLevel = 1;
+  this->m_FileIsMSB = false;
+  this->m_FileIsCompressed = false;
+  this->m_DataStart = 0;
+
+  this->AddSupportedReadExtension( ".mhc" );
+  this->AddSupportedWriteExtension( ".mhc" );
+
+} // end Constructor
+
+
+/**
+ * ******************* Destructor *******************
+ */
+
+ChunkedDeflateImageIO::~ChunkedDeflateImageIO()
+{
+} // end Destructor
+
+
+/**
+ * ******************* HasExtension *******************
+ */
+
+bool
+ChunkedDeflateImageIO::HasExtension( const char * fileName )
+{
+  if( !fileName ) return false;
+  const std::string extension = itksys::SystemTools::LowerCase(
+    itksys::SystemTools::GetFilenameLastExtension( fileName ) );
+  return extension == ".mhc";
+
+} // end HasExtension()
+
+
+/**
+ * ******************* CanReadFile *******************
+ */
+
+bool
+ChunkedDeflateImageIO::CanReadFile( const char * fileName )
+{
+  if( !HasExtension( fileName ) ) return false;
+
+  std::ifstream file( fileName, std::ios::in | std::ios::binary );
+  std::string line;
+  return file.is_open() && std::getline( file, line )
+    && line.compare( 0, 10, "ObjectType" ) == 0;
+
+} // end CanReadFile()
+
+
+/**
+ * ******************* CanWriteFile *******************
+ */
+
+bool
+ChunkedDeflateImageIO::CanWriteFile( const char * fileName )
+{
+  return HasExtension( fileName );
+
+} // end CanWriteFile()
+
+
+/**
+ * ******************* ReadImageInformation *******************
+ */
+
+void
+ChunkedDeflateImageIO::ReadImageInformation( void )
+{
+  std::ifstream file( this->m_FileName.c_str(), std::ios::in | std::ios::binary );
+  if( !file.is_open() )
+  {
+    itkExceptionMacro( << "Could not open " << this->m_FileName << " for reading." );
+  }
+
+  /** The header, up to ElementDataFile. */
+  std::map<std::string, std::string> header;
+  std::string line;
+  while( std::getline( file, line ) )
+  {
+    const std::string::size_type is = line.find( '=' );
+    if( is == std::string::npos ) continue;
+    const std::string key = itksys::SystemTools::TrimWhitespace( line.substr( 0, is ) );
+    header[ key ] = itksys::SystemTools::TrimWhitespace( line.substr( is + 1 ) );
+    if( key == "ElementDataFile" ) break;
+  }
+  if( header[ "ElementDataFile" ] != "LOCAL" || header[ "NDims" ].empty() )
+  {
+    itkExceptionMacro( << this->m_FileName << " is not a chunked image." );
+  }
+
+  /** The geometry. */
+  unsigned int dim = 0;
+  std::istringstream( header[ "NDims" ] ) >> dim;
+  this->SetNumberOfDimensions( dim );
+  std::istringstream dimSize( header[ "DimSize" ] );
+  std::istringstream spacing( header[ "ElementSpacing" ] );
+  std::istringstream origin( header[ "Offset" ] );
+  std::istringstream matrix( header[ "TransformMatrix" ] );
+  for( unsigned int i = 0; i < dim; ++i )
+  {
+    SizeValueType size = 0;
+    double value = 1.0;
+    dimSize >> size;
+    this->SetDimensions( i, size );
+    spacing >> value;
+    this->SetSpacing( i, value );
+    value = 0.0;
+    origin >> value;
+    this->SetOrigin( i, value );
+    std::vector<double> direction( dim, 0.0 );
+    direction[ i ] = 1.0;
+    for( unsigned int j = 0; j < dim && !header[ "TransformMatrix" ].empty(); ++j )
+    {
+      matrix >> direction[ j ];
+    }
+    this->SetDirection( i, direction );
+  }
+
+  /** The pixel type. */
+  this->SetComponentType( UNKNOWNCOMPONENTTYPE );
+  for( int t = UCHAR; t <= DOUBLE; ++t )
+  {
+    if( header[ "ElementType" ]
+      == GetComponentTypeAsString( static_cast<IOComponentType>( t ) ) )
+    {
+      this->SetComponentType( static_cast<IOComponentType>( t ) );
+    }
+  }
+  this->SetPixelType( SCALAR );
+  for( int t = SCALAR; t <= MATRIX; ++t )
+  {
+    if( header[ "PixelType" ] == GetPixelTypeAsString( static_cast<IOPixelType>( t ) ) )
+    {
+      this->SetPixelType( static_cast<IOPixelType>( t ) );
+    }
+  }
+  unsigned int numberOfComponents = 1;
+  std::istringstream( header[ "ElementNumberOfChannels" ] ) >> numberOfComponents;
+  this->SetNumberOfComponents( numberOfComponents );
+  if( this->GetComponentType() == UNKNOWNCOMPONENTTYPE )
+  {
+    itkExceptionMacro( << "Unknown ElementType " << header[ "ElementType" ]
+      << " in " << this->m_FileName << "." );
+  }
+
+  /** The blocks. */
+  this->m_FileIsMSB = header[ "BinaryDataByteOrderMSB" ] == "True";
+  this->m_FileIsCompressed = header[ "CompressedData" ] == "True";
+  this->SetUseCompression( this->m_FileIsCompressed );
+  this->m_FileBlockSize.assign( dim, 0 );
+  std::istringstream blockSize( header[ "BlockSize" ] );
+  SizeValueType numberOfBlocks = 1;
+  for( unsigned int i = 0; i < dim; ++i )
+  {
+    blockSize >> this->m_FileBlockSize[ i ];
+    if( this->m_FileBlockSize[ i ] == 0 )
+    {
+      itkExceptionMacro( << "Invalid BlockSize in " << this->m_FileName << "." );
+    }
+    numberOfBlocks *= ( this->GetDimensions( i ) + this->m_FileBlockSize[ i ] - 1 )
+      / this->m_FileBlockSize[ i ];
+  }
+  SizeValueType storedNumberOfBlocks = 0;
+  std::istringstream( header[ "NumberOfBlocks" ] ) >> storedNumberOfBlocks;
+  if( storedNumberOfBlocks != numberOfBlocks )
+  {
+    itkExceptionMacro( << "The NumberOfBlocks of " << this->m_FileName
+      << " does not match the image size." );
+  }
+
+  /** The index. */
+  this->m_BlockOffsets.assign( numberOfBlocks + 1, 0 );
+  for( SizeValueType c = 0; c <= numberOfBlocks; ++c )
+  {
+    unsigned char bytes[ 8 ];
+    file.read( reinterpret_cast<char *>( bytes ), 8 );
+    for( int b = 7; b >= 0; --b )
+    {
+      this->m_BlockOffsets[ c ] = ( this->m_BlockOffsets[ c ] << 8 ) | bytes[ b ];
+    }
+  }
+  if( !file )
+  {
+    itkExceptionMacro( << "Could not read the block index of " << this->m_FileName << "." );
+  }
+  this->m_DataStart = file.tellg();
+
+} // end ReadImageInformation()
+
+
+/**
+ * ******************* Read *******************
+ */
+
+void
+ChunkedDeflateImageIO::Read( void * buffer )
+{
+  const unsigned int dim = this->GetNumberOfDimensions();
+
+  ChunkedDeflateThreadStruct str;
+  str.Dimension = dim;
+  str.PixelBytes = this->GetComponentSize() * this->GetNumberOfComponents();
+  str.BlockSize = this->m_FileBlockSize;
+  str.Compressed = this->m_FileIsCompressed;
+  str.CompressionLevel = this->m_CompressionLevel;
+  str.FileName = this->m_FileName;
+  str.DataStart = this->m_DataStart;
+  str.BlockOffsets = &this->m_BlockOffsets;
+  str.Buffer = static_cast<unsigned char *>( buffer );
+  str.Image = 0;
+  str.FirstBlock = 0;
+
+  /** The region, and the range of blocks it intersects. */
+  SizeValueType numberOfPixels = 1;
+  std::vector<SizeValueType> firstBlock( dim, 0 ), numberOfBlocks( dim, 0 );
+  for( unsigned int i = 0; i < dim; ++i )
+  {
+    str.ImageSize.push_back( this->GetDimensions( i ) );
+    str.GridSize.push_back( ( str.ImageSize[ i ] + str.BlockSize[ i ] - 1 ) / str.BlockSize[ i ] );
+    str.RegionStart.push_back( 0 );
+    str.RegionSize.push_back( str.ImageSize[ i ] );
+    if( i < this->m_IORegion.GetImageDimension() )
+    {
+      str.RegionStart[ i ] = this->m_IORegion.GetIndex( i );
+      str.RegionSize[ i ] = this->m_IORegion.GetSize( i );
+    }
+    numberOfPixels *= str.RegionSize[ i ];
+    if( str.RegionSize[ i ] > 0 )
+    {
+      firstBlock[ i ] = str.RegionStart[ i ] / str.BlockSize[ i ];
+      numberOfBlocks[ i ] = ( str.RegionStart[ i ] + str.RegionSize[ i ] - 1 )
+        / str.BlockSize[ i ] - firstBlock[ i ] + 1;
+    }
+  }
+  if( numberOfPixels == 0 ) return;
+
+  std::vector<SizeValueType> position( dim, 0 );
+  bool done = false;
+  while( !done )
+  {
+    SizeValueType block = 0;
+    for( unsigned int i = dim; i-- > 0; )
+    {
+      block = block * str.GridSize[ i ] + firstBlock[ i ] + position[ i ];
+    }
+    str.Blocks.push_back( block );
+
+    /** The next block. */
+    done = true;
+    for( unsigned int i = 0; i < dim && done; ++i )
+    {
+      if( ++position[ i ] < numberOfBlocks[ i ] )
+      {
+        done = false;
+      }
+      else
+      {
+        position[ i ] = 0;
+      }
+    }
+  }
+
+  str.NextBlock = 0;
+  str.EndBlock = str.Blocks.size();
+
+  MultiThreader::Pointer threader = MultiThreader::New();
+  threader->SetNumberOfThreads( static_cast<ThreadIdType>( std::max<SizeValueType>( 1,
+    std::min<SizeValueType>( threader->GetNumberOfThreads(), str.Blocks.size() ) ) ) );
+  threader->SetSingleMethod( ChunkedDeflateReadThreaderCallback, &str );
+  threader->SingleMethodExecute();
+
+  if( !str.Error.empty() )
+  {
+    itkExceptionMacro( << str.Error );
+  }
+
+  this->SwapBytes( buffer, numberOfPixels * this->GetNumberOfComponents() );
+
+} // end Read()
+
+
+/**
+ * ******************* GetBlockSizeForWriting *******************
+ */
+
+std::vector<SizeValueType>
+ChunkedDeflateImageIO::GetBlockSizeForWriting( void ) const
+{
+  const unsigned int dim = this->GetNumberOfDimensions();
+  std::vector<SizeValueType> blockSize( dim, 1 );
+  if( this->m_BlockSize.size() == dim )
+  {
+    for( unsigned int i = 0; i < dim; ++i )
+    {
+      blockSize[ i ] = std::max<SizeValueType>( 1,
+        std::min<SizeValueType>( this->m_BlockSize[ i ], this->GetDimensions( i ) ) );
+    }
+    return blockSize;
+  }
+
+  /** As cubic as possible; the pixels a small dimension does not use go
+   * to the next dimensions. */
+  const SizeValueType pixelBytes = this->GetComponentSize() * this->GetNumberOfComponents();
+  double remaining = std::max( 1.0,
+    static_cast<double>( this->m_ChunkSize ) / static_cast<double>( pixelBytes ) );
+  for( unsigned int i = 0; i < dim; ++i )
+  {
+    const double edge = std::floor( std::pow( remaining, 1.0 / ( dim - i ) ) + 0.5 );
+    blockSize[ i ] = std::max<SizeValueType>( 1, std::min<SizeValueType>(
+      static_cast<SizeValueType>( edge ), this->GetDimensions( i ) ) );
+    remaining = std::max( 1.0, remaining / blockSize[ i ] );
+  }
+  return blockSize;
+
+} // end GetBlockSizeForWriting()
+
+
+/**
+ * ******************* Write *******************
+ */
+
+void
+ChunkedDeflateImageIO::Write( const void * buffer )
+{
+  const unsigned int dim = this->GetNumberOfDimensions();
+
+  ChunkedDeflateThreadStruct str;
+  str.Dimension = dim;
+  str.PixelBytes = this->GetComponentSize() * this->GetNumberOfComponents();
+  str.BlockSize = this->GetBlockSizeForWriting();
+  SizeValueType numberOfBlocks = 1;
+  for( unsigned int i = 0; i < dim; ++i )
+  {
+    str.ImageSize.push_back( this->GetDimensions( i ) );
+    str.GridSize.push_back( ( str.ImageSize[ i ] + str.BlockSize[ i ] - 1 ) / str.BlockSize[ i ] );
+    numberOfBlocks *= str.GridSize[ i ];
+  }
+  str.Compressed = this->GetUseCompression();
+  str.CompressionLevel = this->m_CompressionLevel;
+  str.Image = static_cast<const unsigned char *>( buffer );
+  str.BlockOffsets = 0;
+  str.Buffer = 0;
+
+  std::ofstream file( this->m_FileName.c_str(), std::ios::out | std::ios::binary );
+  if( !file.is_open() )
+  {
+    itkExceptionMacro( << "Could not open " << this->m_FileName << " for writing." );
+  }
+
+  /** The header. */
+  std::ostringstream header;
+  header.precision( 16 );
+  header << "ObjectType = Image\n";
+  header << "NDims = " << dim << "\n";
+  header << "DimSize =";
+  for( unsigned int i = 0; i < dim; ++i ) header << " " << this->GetDimensions( i );
+  header << "\nElementSpacing =";
+  for( unsigned int i = 0; i < dim; ++i ) header << " " << this->GetSpacing( i );
+  header << "\nOffset =";
+  for( unsigned int i = 0; i < dim; ++i ) header << " " << this->GetOrigin( i );
+  header << "\nTransformMatrix =";
+  for( unsigned int i = 0; i < dim; ++i )
+  {
+    const std::vector<double> direction = this->GetDirection( i );
+    for( unsigned int j = 0; j < dim; ++j ) header << " " << direction[ j ];
+  }
+  header << "\nElementType = " << GetComponentTypeAsString( this->GetComponentType() ) << "\n";
+  header << "PixelType = " << GetPixelTypeAsString( this->GetPixelType() ) << "\n";
+  header << "ElementNumberOfChannels = " << this->GetNumberOfComponents() << "\n";
+  header << "BinaryDataByteOrderMSB = "
+    << ( ByteSwapper<int>::SystemIsBigEndian() ? "True" : "False" ) << "\n";
+  header << "CompressedData = " << ( str.Compressed ? "True" : "False" ) << "\n";
+  header << "BlockSize =";
+  for( unsigned int i = 0; i < dim; ++i ) header << " " << str.BlockSize[ i ];
+  header << "\nNumberOfBlocks = " << numberOfBlocks << "\n";
+  header << "ElementDataFile = LOCAL\n";
+  file << header.str();
+
+  /** Room for the index, written when the blocks are. */
+  const std::streamoff indexStart = file.tellp();
+  const std::vector<char> zeros( 8 * ( numberOfBlocks + 1 ), 0 );
+  file.write( &zeros[ 0 ], static_cast<std::streamsize>( zeros.size() ) );
+
+  /** The blocks are compressed in parallel, per batch of blocks to bound
+   * the memory, and written in order by this thread. */
+  std::vector<unsigned long long> offsets( 1, 0 );
+  MultiThreader::Pointer threader = MultiThreader::New();
+  const SizeValueType numberOfThreads = threader->GetNumberOfThreads();
+  const SizeValueType batchSize = 4 * numberOfThreads;
+  threader->SetSingleMethod( ChunkedDeflateWriteThreaderCallback, &str );
+
+  for( str.FirstBlock = 0; str.FirstBlock < numberOfBlocks; str.FirstBlock += batchSize )
+  {
+    str.NextBlock = str.FirstBlock;
+    str.EndBlock = std::min( str.FirstBlock + batchSize, numberOfBlocks );
+    str.BlockData.resize( str.EndBlock - str.FirstBlock );
+    threader->SetNumberOfThreads( static_cast<ThreadIdType>(
+      std::min( numberOfThreads, str.EndBlock - str.FirstBlock ) ) );
+    threader->SingleMethodExecute();
+    if( !str.Error.empty() )
+    {
+      itkExceptionMacro( << str.Error );
+    }
+
+    for( SizeValueType i = 0; i < str.BlockData.size(); ++i )
+    {
+      const std::vector<unsigned char> & data = str.BlockData[ i ];
+      file.write( reinterpret_cast<const char *>( &data[ 0 ] ),
+        static_cast<std::streamsize>( data.size() ) );
+      offsets.push_back( offsets.back() + data.size() );
+    }
+  }
+
+  /** The index. */
+  file.seekp( indexStart );
+  for( SizeValueType c = 0; c < offsets.size(); ++c )
+  {
+    unsigned char bytes[ 8 ];
+    for( int b = 0; b < 8; ++b )
+    {
+      bytes[ b ] = static_cast<unsigned char>( ( offsets[ c ] >> ( 8 * b ) ) & 0xff );
+    }
+    file.write( reinterpret_cast<const char *>( bytes ), 8 );
+  }
+
+  if( !file )
+  {
+    itkExceptionMacro( << "Could not write " << this->m_FileName << "." );
+  }
+
+} // end Write()
+
+
+
+/**
+ * ******************* SwapBytes *******************
+ */
+
+void
+ChunkedDeflateImageIO::SwapBytes( void * buffer, SizeValueType numberOfComponents ) const
+{
+  if( this->m_FileIsMSB == ByteSwapper<int>::SystemIsBigEndian() ) return;
+
+  /** Swapping from and to big endian is the same, on a little endian system. */
+  switch( this->GetComponentSize() )
+  {
+    case 2:
+      ByteSwapper<unsigned short>::SwapRangeFromSystemToBigEndian(
+        static_cast<unsigned short *>( buffer ), numberOfComponents );
+      break;
+    case 4:
+      ByteSwapper<unsigned int>::SwapRangeFromSystemToBigEndian(
+        static_cast<unsigned int *>( buffer ), numberOfComponents );
+      break;
+    case 8:
+      ByteSwapper<double>::SwapRangeFromSystemToBigEndian(
+        static_cast<double *>( buffer ), numberOfComponents );
+      break;
+    default:
+      break;
+  }
+
+} // end SwapBytes()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+void
+ChunkedDeflateImageIO::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "ChunkSize: " << this->m_ChunkSize << std::endl;
+  os << indent << "CompressionLevel: " << this->m_CompressionLevel << std::endl;
+  os << indent << "BlockSize:";
+  for( std::size_t i = 0; i < this->m_BlockSize.size(); ++i ) os << " " << this->m_BlockSize[ i ];
+  os << std::endl;
+  os << indent << "NumberOfBlocks: "
+    << ( this->m_BlockOffsets.empty() ? 0 : this->m_BlockOffsets.size() - 1 ) << std::endl;
+
+} // end PrintSelf()
+
+} // end namespace itk
@@ -0,0 +1,146 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkChunkedDeflateImageIO_h
+#define __itkChunkedDeflateImageIO_h
+
+#ifdef _MSC_VER
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkImageIOBase.h"
+
+#include <string>
+#include <vector>
+
+
+namespace itk
+{
+
+/** \class ChunkedDeflateImageIO
+ * \brief ImageIO for images that are compressed in independent blocks.
+ *
+ * The file, extension ".mhc", starts with a MetaImage style text header,
+ * followed by a block index and the blocks. The image is divided in
+ * blocks of a fixed size, smaller at the border, and every block is
+ * stored in scanline order and deflated on its own. Therefore
+ *   - the blocks are compressed and decompressed in parallel, with the
+ *     number of threads of the global itk::MultiThreader,
+ *   - only the blocks that intersect the requested region are read, so
+ *     that the reader streams, and cropping or extracting a slice reads a
+ *     fraction of the file.
+ *
+ * The header keys are ObjectType, NDims, DimSize, ElementSpacing, Offset,
+ * TransformMatrix, ElementType, PixelType, ElementNumberOfChannels,
+ * BinaryDataByteOrderMSB, CompressedData, BlockSize, NumberOfBlocks
+ * and ElementDataFile = LOCAL, which ends the header. The blocks are
+ * ordered with x fastest. The index holds NumberOfBlocks+1 little endian
+ * 64 bit offsets, the start of every block and the end of the last,
+ * relative to the end of the index.
+ *
+ * Without UseCompression the blocks are stored uncompressed. The default
+ * compression level is the fastest, since the format is meant for
+ * the intermediate images of a pipeline.
+ *
+ * \ingroup IOFilters
+ */
+
+class ITK_EXPORT ChunkedDeflateImageIO : public ImageIOBase
+{
+public:
+  /** Standard class typedefs. */
+  typedef ChunkedDeflateImageIO         Self;
+  typedef ImageIOBase                   Superclass;
+  typedef SmartPointer<Self>            Pointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( ChunkedDeflateImageIO, ImageIOBase );
+
+  /** Set/Get the approximate uncompressed size of a block in bytes, used
+   * when writing without a BlockSize; the blocks are then as cubic as the
+   * image allows. Default 1 MB. */
+  itkSetMacro( ChunkSize, SizeValueType );
+  itkGetConstMacro( ChunkSize, SizeValueType );
+
+  /** Set/Get the size of the blocks for writing, one value per dimension.
+   * Empty, the default, derives it from the ChunkSize. */
+  void SetBlockSize( const std::vector<SizeValueType> & blockSize )
+  {
+    this->m_BlockSize = blockSize;
+    this->Modified();
+  }
+  const std::vector<SizeValueType> & GetBlockSize( void ) const
+  {
+    return this->m_BlockSize;
+  }
+
+  /** Set/Get the zlib compression level, 1 to 9. Default 1, the fastest. */
+  itkSetClampMacro( CompressionLevel, int, 1, 9 );
+  itkGetConstMacro( CompressionLevel, int );
+
+  /** Reading. */
+  virtual bool CanReadFile( const char * fileName );
+  virtual void ReadImageInformation( void );
+  virtual void Read( void * buffer );
+
+  /** Only the chunks of the requested region are read. */
+  virtual bool CanStreamRead( void ) { return true; }
+
+  /** Writing. */
+  virtual bool CanWriteFile( const char * fileName );
+  virtual void WriteImageInformation( void ) {};
+  virtual void Write( const void * buffer );
+
+protected:
+  ChunkedDeflateImageIO();
+  ~ChunkedDeflateImageIO();
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+private:
+  ChunkedDeflateImageIO( const Self & ); // purposely not implemented
+  void operator=( const Self & );        // purposely not implemented
+
+  /** Whether the file name has the extension of this format. */
+  static bool HasExtension( const char * fileName );
+
+  /** Swap the bytes of a buffer between the system and the file order. */
+  void SwapBytes( void * buffer, SizeValueType numberOfComponents ) const;
+
+  /** The block size for writing, from m_BlockSize or m_ChunkSize. */
+  std::vector<SizeValueType> GetBlockSizeForWriting( void ) const;
+
+  SizeValueType   m_ChunkSize;
+  int             m_CompressionLevel;
+
+  /** The block size set for writing. */
+  std::vector<SizeValueType> m_BlockSize;
+
+  /** Read from the header. */
+  bool            m_FileIsMSB;
+  bool            m_FileIsCompressed;
+  std::vector<SizeValueType> m_FileBlockSize;
+  std::vector<unsigned long long> m_BlockOffsets;
+  std::streamoff  m_DataStart;
+
+}; // end class ChunkedDeflateImageIO
+
+} // end namespace itk
+
+#endif // end #ifndef __itkChunkedDeflateImageIO_h
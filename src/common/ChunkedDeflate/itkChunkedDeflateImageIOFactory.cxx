@@ -0,0 +1,56 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#include "itkChunkedDeflateImageIOFactory.h"
+#include "itkCreateObjectFunction.h"
+#include "itkChunkedDeflateImageIO.h"
+#include "itkVersion.h"
+
+
+namespace itk
+{
+
+ChunkedDeflateImageIOFactory
+::ChunkedDeflateImageIOFactory()
+{
+  this->RegisterOverride( "itkImageIOBase",
+    "itkChunkedDeflateImageIO",
+    "Chunked Deflate Image IO",
+    1,
+    CreateObjectFunction<ChunkedDeflateImageIO>::New() );
+}
+
+ChunkedDeflateImageIOFactory
+::~ChunkedDeflateImageIOFactory()
+{
+}
+
+const char*
+ChunkedDeflateImageIOFactory
+::GetITKSourceVersion( void ) const
+{
+  return ITK_SOURCE_VERSION;
+}
+
+const char*
+ChunkedDeflateImageIOFactory
+::GetDescription( void ) const
+{
+  return "Chunked Deflate ImageIO Factory, allows the parallel compression and region reading of .mhc images";
+}
+
+} // end namespace itk
@@ -0,0 +1,36 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#include "itkUseChunkedDeflate.h"
+
+#include "itkChunkedDeflateImageIOFactory.h"
+
+
+/**
+ * ***************** RegisterChunkedDeflate ************************
+ */
+
+void RegisterChunkedDeflate( void )
+{
+  /** Register once, also when several tools run in one process. */
+  static bool registered = false;
+  if( registered ) return;
+  registered = true;
+
+  itk::ChunkedDeflateImageIOFactory::RegisterOneFactory();
+
+} // end RegisterChunkedDeflate()
@@ -0,0 +1,26 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkUseChunkedDeflate_h
+#define __itkUseChunkedDeflate_h
+
+/** Function that registers the factory of the chunked .mhc format of
+ *  ChunkedDeflateImageIO. Call this in your program, before you
+ *  load/write any images. */
+void RegisterChunkedDeflate( void );
+
+#endif
@@ -0,0 +1,347 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#include "ITKToolsAsyncWriter.h"
+#include "ITKToolsBase.h"
+
+#include "itkConditionVariable.h"
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <set>
+#include <vector>
+
+
+namespace itktools
+{
+
+/** The state of the writer: the queue, the writer threads, the files
+ * that are pending, and the errors of the background writes.
+ */
+struct AsyncWriterState
+{
+  AsyncWriterState()
+    : m_QueueSize( 0 ), m_MaximumQueueSize( std::size_t( 1 ) << 30 ),
+    m_NumberOfActiveJobs( 0 ), m_Stop( false ), m_FlushAtExitRegistered( false )
+  {
+    this->m_Condition = itk::ConditionVariable::New();
+    this->m_Threader = itk::MultiThreader::New();
+  }
+
+  std::deque< AsyncWriteJob * >       m_Queue;
+  std::size_t                         m_QueueSize;
+  std::size_t                         m_MaximumQueueSize;
+  unsigned int                        m_NumberOfActiveJobs;
+  std::multiset< std::string >        m_PendingFileNames;
+  std::vector< std::string >          m_Errors;
+  bool                                m_Stop;
+  bool                                m_FlushAtExitRegistered;
+
+  itk::SimpleMutexLock                m_Lock;
+  itk::ConditionVariable::Pointer     m_Condition;
+  itk::MultiThreader::Pointer         m_Threader;
+  std::vector< itk::ThreadIdType >    m_ThreadIds;
+};
+
+static AsyncWriterState & GetAsyncWriterState( void )
+{
+  static AsyncWriterState state;
+  return state;
+}
+
+
+/**
+ * ***************** AsyncWriterThread ************************
+ *
+ * Takes the jobs from the queue until the writer is stopped. The lock is
+ * released while a job writes.
+ */
+
+static ITK_THREAD_RETURN_TYPE AsyncWriterThread( void * )
+{
+  AsyncWriterState & state = GetAsyncWriterState();
+  state.m_Lock.Lock();
+  while( true )
+  {
+    while( state.m_Queue.empty() && !state.m_Stop )
+    {
+      state.m_Condition->Wait( &state.m_Lock );
+    }
+    if( state.m_Queue.empty() ) break;
+
+    AsyncWriteJob * job = state.m_Queue.front();
+    state.m_Queue.pop_front();
+    ++state.m_NumberOfActiveJobs;
+    state.m_Lock.Unlock();
+
+    std::string error = "";
+    try
+    {
+      job->Write();
+    }
+    catch( itk::ExceptionObject & excp )
+    {
+      error = excp.GetDescription();
+    }
+    catch( std::exception & excp )
+    {
+      error = excp.what();
+    }
+
+    state.m_Lock.Lock();
+    if( !error.empty() )
+    {
+      state.m_Errors.push_back( "could not write \"" + job->GetFileName() + "\": " + error );
+    }
+    state.m_QueueSize -= job->GetNumberOfBytes();
+    state.m_PendingFileNames.erase( state.m_PendingFileNames.find( job->GetFileName() ) );
+    --state.m_NumberOfActiveJobs;
+    delete job;
+    state.m_Condition->Broadcast();
+  }
+  state.m_Lock.Unlock();
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end AsyncWriterThread()
+
+
+/**
+ * ***************** FlushAtExit ************************
+ *
+ * No output is lost when a tool returns from main() without a Flush();
+ * a failed write then changes the exit code.
+ */
+
+static void FlushAtExit( void )
+{
+  if( AsyncWriter::Flush() > 0 )
+  {
+    std::cerr.flush();
+    std::_Exit( EXIT_FAILURE );
+  }
+  AsyncWriter::SetNumberOfWriterThreads( 0 );
+
+} // end FlushAtExit()
+
+
+/**
+ * ***************** SetNumberOfWriterThreads ************************
+ */
+
+void
+AsyncWriter
+::SetNumberOfWriterThreads( unsigned int numberOfThreads )
+{
+  AsyncWriterState & state = GetAsyncWriterState();
+
+  /** Stop the current threads, after they emptied the queue. */
+  state.m_Lock.Lock();
+  state.m_Stop = true;
+  state.m_Condition->Broadcast();
+  state.m_Lock.Unlock();
+  for( std::size_t i = 0; i < state.m_ThreadIds.size(); ++i )
+  {
+    state.m_Threader->TerminateThread( state.m_ThreadIds[ i ] );
+  }
+  state.m_ThreadIds.clear();
+  state.m_Stop = false;
+
+  for( unsigned int i = 0; i < numberOfThreads; ++i )
+  {
+    state.m_ThreadIds.push_back(
+      state.m_Threader->SpawnThread( AsyncWriterThread, 0 ) );
+  }
+
+  if( numberOfThreads > 0 && !state.m_FlushAtExitRegistered )
+  {
+    std::atexit( FlushAtExit );
+    state.m_FlushAtExitRegistered = true;
+  }
+
+} // end SetNumberOfWriterThreads()
+
+
+/**
+ * ***************** GetNumberOfWriterThreads ************************
+ */
+
+unsigned int
+AsyncWriter
+::GetNumberOfWriterThreads( void )
+{
+  return static_cast<unsigned int>( GetAsyncWriterState().m_ThreadIds.size() );
+
+} // end GetNumberOfWriterThreads()
+
+
+/**
+ * ***************** SetMaximumQueueSize ************************
+ */
+
+void
+AsyncWriter
+::SetMaximumQueueSize( std::size_t numberOfBytes )
+{
+  AsyncWriterState & state = GetAsyncWriterState();
+  state.m_Lock.Lock();
+  state.m_MaximumQueueSize = numberOfBytes;
+  state.m_Lock.Unlock();
+
+} // end SetMaximumQueueSize()
+
+
+/**
+ * ***************** GetMaximumQueueSize ************************
+ */
+
+std::size_t
+AsyncWriter
+::GetMaximumQueueSize( void )
+{
+  return GetAsyncWriterState().m_MaximumQueueSize;
+
+} // end GetMaximumQueueSize()
+
+
+/**
+ * ***************** Submit ************************
+ */
+
+void
+AsyncWriter
+::Submit( AsyncWriteJob * job )
+{
+  AsyncWriterState & state = GetAsyncWriterState();
+
+  /** Without writer threads, write right away. */
+  if( state.m_ThreadIds.empty() )
+  {
+    try
+    {
+      job->Write();
+    }
+    catch( ... )
+    {
+      delete job;
+      throw;
+    }
+    delete job;
+    return;
+  }
+
+  /** Wait until the job fits in the queue; an empty queue takes any job. */
+  const std::size_t numberOfBytes = job->GetNumberOfBytes();
+  state.m_Lock.Lock();
+  while( state.m_QueueSize > 0
+    && state.m_QueueSize + numberOfBytes > state.m_MaximumQueueSize )
+  {
+    state.m_Condition->Wait( &state.m_Lock );
+  }
+  state.m_Queue.push_back( job );
+  state.m_QueueSize += numberOfBytes;
+  state.m_PendingFileNames.insert( job->GetFileName() );
+  state.m_Condition->Broadcast();
+  state.m_Lock.Unlock();
+
+} // end Submit()
+
+
+/**
+ * ***************** IsPending ************************
+ */
+
+bool
+AsyncWriter
+::IsPending( const std::string & fileName )
+{
+  AsyncWriterState & state = GetAsyncWriterState();
+  state.m_Lock.Lock();
+  const bool pending = state.m_PendingFileNames.count( fileName ) > 0;
+  state.m_Lock.Unlock();
+  return pending;
+
+} // end IsPending()
+
+
+/**
+ * ***************** Flush ************************
+ */
+
+unsigned int
+AsyncWriter
+::Flush( void )
+{
+  AsyncWriterState & state = GetAsyncWriterState();
+  state.m_Lock.Lock();
+  while( !state.m_Queue.empty() || state.m_NumberOfActiveJobs > 0 )
+  {
+    state.m_Condition->Wait( &state.m_Lock );
+  }
+  std::vector< std::string > errors;
+  errors.swap( state.m_Errors );
+  state.m_Lock.Unlock();
+
+  for( std::size_t i = 0; i < errors.size(); ++i )
+  {
+    std::cerr << "ERROR: " << errors[ i ] << std::endl;
+  }
+  return static_cast<unsigned int>( errors.size() );
+
+} // end Flush()
+
+
+/**
+ * ***************** ReadAsyncWriteArguments ************************
+ */
+
+void ReadAsyncWriteArguments( itk::CommandLineArgumentParser * parser )
+{
+  if( !parser->ArgumentExists( "-asyncWrite" ) ) return;
+
+  std::vector<unsigned int> numberOfThreads;
+  parser->GetCommandLineArgument( "-asyncWrite", numberOfThreads );
+  const unsigned int threads = numberOfThreads.empty() ? 1 : numberOfThreads[ 0 ];
+
+  std::string queue = "";
+  if( parser->GetCommandLineArgument( "-asyncQueue", queue ) )
+  {
+    double queueInMB = 0.0;
+    if( ParseMemorySize( queue, queueInMB ) )
+    {
+      AsyncWriter::SetMaximumQueueSize(
+        static_cast<std::size_t>( queueInMB * 1048576.0 ) );
+    }
+    else
+    {
+      std::cerr << "WARNING: \"" << queue << "\" is not a valid memory size.\n"
+        << "  The argument -asyncQueue is ignored." << std::endl;
+    }
+  }
+
+  /** In batch mode the threads are kept from one job to the next. */
+  if( AsyncWriter::GetNumberOfWriterThreads() != threads )
+  {
+    AsyncWriter::SetNumberOfWriterThreads( threads );
+  }
+
+} // end ReadAsyncWriteArguments()
+
+} // end namespace itktools
@@ -0,0 +1,167 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __ITKToolsAsyncWriter_h_
+#define __ITKToolsAsyncWriter_h_
+
+#include "itkCommandLineArgumentParser.h"
+#include "itkImageFileWriter.h"
+#include <cstddef>
+#include <string>
+
+
+namespace itktools
+{
+
+/** \class AsyncWriteJob
+ * \brief The writing of one output file, for the AsyncWriter.
+ */
+
+class AsyncWriteJob
+{
+public:
+  virtual ~AsyncWriteJob() {}
+
+  /** Write the file. Throws itk::ExceptionObject on failure. */
+  virtual void Write( void ) = 0;
+
+  /** The file that is written. */
+  virtual const std::string & GetFileName( void ) const = 0;
+
+  /** The memory held by the job until it is written. */
+  virtual std::size_t GetNumberOfBytes( void ) const = 0;
+
+}; // end class AsyncWriteJob
+
+
+/** \class AsyncImageWriteJob
+ * \brief Write an image with an itk::ImageFileWriter.
+ *
+ * The image is disconnected from its pipeline, so that the job holds its
+ * buffer, and the source of the image cannot overwrite it.
+ */
+
+template< class TImage >
+class AsyncImageWriteJob : public AsyncWriteJob
+{
+public:
+  AsyncImageWriteJob( TImage * image, const std::string & fileName,
+    bool useCompression )
+    : m_Image( image ), m_FileName( fileName ), m_UseCompression( useCompression )
+  {
+    this->m_Image->DisconnectPipeline();
+  }
+
+  virtual void Write( void )
+  {
+    typedef itk::ImageFileWriter< TImage >  WriterType;
+    typename WriterType::Pointer writer = WriterType::New();
+    writer->SetFileName( this->m_FileName.c_str() );
+    writer->SetInput( this->m_Image );
+    writer->SetUseCompression( this->m_UseCompression );
+    writer->Update();
+  }
+
+  virtual const std::string & GetFileName( void ) const
+  {
+    return this->m_FileName;
+  }
+
+  virtual std::size_t GetNumberOfBytes( void ) const
+  {
+    typedef typename TImage::PixelContainer PixelContainerType;
+    return this->m_Image->GetPixelContainer()->Size()
+      * sizeof( typename PixelContainerType::Element );
+  }
+
+private:
+  typename TImage::Pointer  m_Image;
+  std::string               m_FileName;
+  bool                      m_UseCompression;
+
+}; // end class AsyncImageWriteJob
+
+
+/** \class AsyncWriter
+ * \brief Write output files in the background, while the process proceeds.
+ *
+ * A tool hands its computed output to Submit(), and continues; writer
+ * threads write, and compress, the outputs in the order they are
+ * submitted. With several writer threads, several outputs are compressed
+ * at the same time. The memory of the outputs in the queue is bounded by
+ * MaximumQueueSize: Submit() waits while a new output does not fit, but
+ * an output is always accepted by an empty queue.
+ *
+ * Flush() is the barrier: it waits until all outputs are written, and
+ * reports the failed ones. It is called before the process exits, and in
+ * batch mode before a job that reads a file that is being written. With 0
+ * writer threads, the default, Submit() writes right away.
+ */
+
+class AsyncWriter
+{
+public:
+  /** Set/Get the number of writer threads; 0 writes synchronously. */
+  static void SetNumberOfWriterThreads( unsigned int numberOfThreads );
+  static unsigned int GetNumberOfWriterThreads( void );
+
+  /** Set/Get the maximum memory of the queued outputs in bytes.
+   * Default 1 GB. */
+  static void SetMaximumQueueSize( std::size_t numberOfBytes );
+  static std::size_t GetMaximumQueueSize( void );
+
+  /** Write the job, in the background if there are writer threads. The
+   * AsyncWriter takes ownership of the job. A synchronous write throws
+   * on failure; a background failure is reported by Flush(). */
+  static void Submit( AsyncWriteJob * job );
+
+  /** Whether the file is queued or being written. */
+  static bool IsPending( const std::string & fileName );
+
+  /** Wait until all outputs are written. Prints an error for every
+   * failed write since the last Flush(), and returns the number of them. */
+  static unsigned int Flush( void );
+
+}; // end class AsyncWriter
+
+
+/** Write an image with the AsyncWriter. Executes its pipeline first, in
+ * the calling thread. */
+template< class TImage >
+void WriteImageAsync( TImage * image, const std::string & fileName,
+  bool useCompression )
+{
+  image->Update();
+  AsyncWriter::Submit(
+    new AsyncImageWriteJob< TImage >( image, fileName, useCompression ) );
+}
+
+
+/** Read the background writing arguments that are shared by all tools:
+ *   [-asyncWrite] write the outputs in the background, with the given
+ *                 number of writer threads, default 1
+ *   [-asyncQueue] the maximum memory of the outputs waiting to be
+ *                 written, e.g. 2G, default 1G
+ * The outputs are flushed before the process exits; if one could not be
+ * written, the exit code is EXIT_FAILURE. Called by
+ * ITKToolsBase::ReadCommonArguments().
+ */
+void ReadAsyncWriteArguments( itk::CommandLineArgumentParser * parser );
+
+} // end namespace itktools
+
+#endif // end #ifndef __ITKToolsAsyncWriter_h_
@@ -0,0 +1,329 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#include "ITKToolsBase.h"
+#include "ITKToolsBufferPool.h"
+#include "ITKToolsSIMD.h"
+
+#include "itkMultiThreader.h"
+#include <cctype>
+#include <sstream>
+#include <vector>
+
+#if defined( _WIN32 )
+#include <windows.h>
+#elif defined( __linux__ )
+#include <sched.h>
+#endif
+
+
+namespace itktools
+{
+
+/**
+ * ***************** SetProcessAffinity ************************
+ */
+
+static bool SetProcessAffinity( const std::vector<unsigned int> & cores )
+{
+#if defined( _WIN32 )
+  DWORD_PTR mask = 0;
+  for( std::size_t i = 0; i < cores.size(); ++i )
+  {
+    if( cores[ i ] >= 8 * sizeof( DWORD_PTR ) ) return false;
+    mask |= static_cast<DWORD_PTR>( 1 ) << cores[ i ];
+  }
+  return SetProcessAffinityMask( GetCurrentProcess(), mask ) != 0;
+#elif defined( __linux__ )
+  /** Threads inherit the affinity of the thread that creates them,
+   * so setting it on the main thread suffices.
+   */
+  cpu_set_t cpuSet;
+  CPU_ZERO( &cpuSet );
+  for( std::size_t i = 0; i < cores.size(); ++i )
+  {
+    if( cores[ i ] >= CPU_SETSIZE ) return false;
+    CPU_SET( cores[ i ], &cpuSet );
+  }
+  return sched_setaffinity( 0, sizeof( cpuSet ), &cpuSet ) == 0;
+#else
+  return false;
+#endif
+
+} // end SetProcessAffinity()
+
+
+/**
+ * ***************** GetProcessAffinity ************************
+ */
+
+static bool GetProcessAffinity( std::vector<unsigned int> & cores )
+{
+  cores.clear();
+#if defined( _WIN32 )
+  DWORD_PTR processMask = 0;
+  DWORD_PTR systemMask = 0;
+  if( !GetProcessAffinityMask( GetCurrentProcess(), &processMask, &systemMask ) )
+  {
+    return false;
+  }
+  for( unsigned int i = 0; i < 8 * sizeof( DWORD_PTR ); ++i )
+  {
+    if( processMask & ( static_cast<DWORD_PTR>( 1 ) << i ) ) cores.push_back( i );
+  }
+  return true;
+#elif defined( __linux__ )
+  cpu_set_t cpuSet;
+  CPU_ZERO( &cpuSet );
+  if( sched_getaffinity( 0, sizeof( cpuSet ), &cpuSet ) != 0 ) return false;
+  for( unsigned int i = 0; i < CPU_SETSIZE; ++i )
+  {
+    if( CPU_ISSET( i, &cpuSet ) ) cores.push_back( i );
+  }
+  return true;
+#else
+  return false;
+#endif
+
+} // end GetProcessAffinity()
+
+
+/**
+ * ***************** ReadThreadingArguments ************************
+ */
+
+void ReadThreadingArguments( itk::CommandLineArgumentParser * parser )
+{
+  unsigned int numberOfThreads = 0;
+  parser->GetCommandLineArgument( "-threads", numberOfThreads );
+
+  std::vector<unsigned int> cores;
+  bool retaffinity = parser->GetCommandLineArgument( "-affinity", cores );
+  if( retaffinity && !cores.empty() )
+  {
+    if( SetProcessAffinity( cores ) )
+    {
+      if( numberOfThreads == 0 )
+      {
+        numberOfThreads = static_cast<unsigned int>( cores.size() );
+      }
+    }
+    else
+    {
+      std::cerr << "WARNING: could not set the thread affinity.\n"
+        << "  The argument -affinity is ignored." << std::endl;
+    }
+  }
+
+  if( numberOfThreads > 0 )
+  {
+    itk::MultiThreader::SetGlobalDefaultNumberOfThreads( numberOfThreads );
+  }
+
+} // end ReadThreadingArguments()
+
+
+/**
+ * ***************** GetThreadingState ************************
+ */
+
+ThreadingState GetThreadingState( void )
+{
+  ThreadingState state;
+  state.m_DefaultNumberOfThreads = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+  GetProcessAffinity( state.m_Cores );
+  return state;
+
+} // end GetThreadingState()
+
+
+/**
+ * ***************** SetThreadingState ************************
+ */
+
+void SetThreadingState( const ThreadingState & state )
+{
+  itk::MultiThreader::SetGlobalDefaultNumberOfThreads( state.m_DefaultNumberOfThreads );
+
+  /** Only restore the affinity if a job changed it. */
+  std::vector<unsigned int> cores;
+  if( !state.m_Cores.empty() && GetProcessAffinity( cores ) && cores != state.m_Cores )
+  {
+    SetProcessAffinity( state.m_Cores );
+  }
+
+} // end SetThreadingState()
+
+
+/**
+ * ***************** ReadNUMAArguments ************************
+ */
+
+void ReadNUMAArguments( itk::CommandLineArgumentParser * parser )
+{
+  std::string numa = "";
+  if( !parser->GetCommandLineArgument( "-numa", numa ) ) return;
+
+  if( numa == "parallel" )
+  {
+    BufferPool::SetPlacement( BufferPool::ParallelPlacement );
+  }
+  else if( numa == "interleave" )
+  {
+    BufferPool::SetPlacement( BufferPool::InterleavedPlacement );
+  }
+  else
+  {
+    std::cerr << "WARNING: -numa should be parallel or interleave, not \""
+      << numa << "\".\n  The argument -numa is ignored." << std::endl;
+    return;
+  }
+  RegisterPooledScalarImageTypes();
+
+} // end ReadNUMAArguments()
+
+
+/**
+ * ***************** ParseMemorySize ************************
+ */
+
+bool ParseMemorySize( const std::string & text, double & sizeInMB )
+{
+  std::istringstream stream( text );
+  double value = 0.0;
+  if( !( stream >> value ) || value < 0.0 ) return false;
+
+  std::string unit, rest;
+  stream >> unit;
+  if( stream >> rest ) return false;
+  for( std::size_t i = 0; i < unit.size(); ++i )
+  {
+    unit[ i ] = static_cast<char>( std::toupper( unit[ i ] ) );
+  }
+  if( unit.size() == 2 && unit[ 1 ] == 'B' ) unit.erase( 1 );
+
+  if( unit.empty() || unit == "M" ) sizeInMB = value;
+  else if( unit == "K" ) sizeInMB = value / 1024.0;
+  else if( unit == "G" ) sizeInMB = value * 1024.0;
+  else if( unit == "T" ) sizeInMB = value * 1048576.0;
+  else return false;
+  return true;
+
+} // end ParseMemorySize()
+
+
+/**
+ * ***************** ~ITKToolsBase ************************
+ */
+
+ITKToolsBase
+::~ITKToolsBase()
+{
+  if( !this->m_Profile ) return;
+
+  this->m_Profiler.Stop( "total" );
+  if( this->m_ProfileFileName.empty() )
+  {
+    std::cout << "Profile:\n";
+    this->m_Profiler.Print( std::cout );
+  }
+  else if( !this->m_Profiler.WriteJSON( this->m_ProfileFileName ) )
+  {
+    std::cerr << "WARNING: could not write the profile to \""
+      << this->m_ProfileFileName << "\"." << std::endl;
+  }
+
+} // end ~ITKToolsBase()
+
+
+/**
+ * ***************** ReadCommonArguments ************************
+ */
+
+void
+ITKToolsBase
+::ReadCommonArguments( itk::CommandLineArgumentParser * parser )
+{
+  /** Threading. */
+  ReadThreadingArguments( parser );
+
+  /** Placement of the image buffers. */
+  ReadNUMAArguments( parser );
+
+  /** Progress and cancellation. */
+  ReadProgressArguments( parser );
+
+  /** The instruction set of the kernels. */
+  ReadSIMDArguments( parser );
+
+  /** Background writing of the outputs. */
+  ReadAsyncWriteArguments( parser );
+
+  /** Streaming. */
+  unsigned int numberOfStreams = 0;
+  std::string memoryLimit = "";
+  bool retstreams = parser->GetCommandLineArgument( "-streams", numberOfStreams );
+  bool retmem = parser->GetCommandLineArgument( "-memoryLimit", memoryLimit );
+  if( retstreams || retmem )
+  {
+    if( this->GetSupportsStreaming() )
+    {
+      if( retstreams ) this->m_NumberOfStreams = numberOfStreams;
+
+      /** The limit in whole MB, at least 1 for any positive size. */
+      double memoryLimitInMB = 0.0;
+      if( retmem && ParseMemorySize( memoryLimit, memoryLimitInMB ) )
+      {
+        this->m_MemoryLimit = static_cast<unsigned int>( std::ceil( memoryLimitInMB ) );
+      }
+      else if( retmem )
+      {
+        std::cerr << "WARNING: \"" << memoryLimit << "\" is not a valid memory size.\n"
+          << "  The argument -memoryLimit is ignored." << std::endl;
+      }
+    }
+    else
+    {
+      std::cerr << "WARNING: this tool does not support streamed execution.\n"
+        << "  The arguments -streams and -memoryLimit are ignored,\n"
+        << "  and the complete image is processed in memory." << std::endl;
+    }
+  }
+
+  /** Computing the outputs into memory mapped files. */
+  if( parser->ArgumentExists( "-mapOutput" ) )
+  {
+    this->m_MapOutput = true;
+  }
+
+  /** Profiling. */
+  std::vector<std::string> profile;
+  if( parser->GetCommandLineArgument( "-profile", profile ) )
+  {
+    this->m_Profile = true;
+    if( !profile.empty() ) this->m_ProfileFileName = profile[ 0 ];
+    this->m_Profiler.Start( "total" );
+    this->m_Profiler.AddNote( "simd", SIMD::GetReport() );
+    std::ostringstream threads;
+    threads << itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+    this->m_Profiler.AddNote( "threads", threads.str() );
+  }
+
+} // end ReadCommonArguments()
+
+
+} // end namespace itktools
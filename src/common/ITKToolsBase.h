@@ -18,6 +18,19 @@
 #ifndef __ITKToolsBase_h_
 #define __ITKToolsBase_h_
 
+#include "itkCommandLineArgumentParser.h"
+#include "itkNumericTraits.h"
+#include "ITKToolsAsyncWriter.h"
+#include "ITKToolsMemoryMapping.h"
+#include "ITKToolsProfiler.h"
+#include "ITKToolsProgress.h"
+#include "itkImage.h"
+#include "itkVectorImage.h"
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <sstream>
+#include <vector>
 
 namespace itktools
 {
@@ -41,6 +54,23 @@ static object * New( unsigned int dim,
   return 0;                                                                     \
 }
 
+/** As itktoolsOneTypeNewMacro, for tools that also select the type of
+ * their internal computations, float or double, in TInternalType.
+ */
+#define itktoolsOneTypeWithInternalTypeNewMacro( object )                       \
+static object * New( unsigned int dim,                                          \
+  itk::ImageIOBase::IOComponentType componentType,                              \
+  itk::ImageIOBase::IOComponentType internalComponentType )                     \
+{                                                                               \
+  if( VDimension == dim                                                         \
+    && itktools::IsType<TComponentType>( componentType )                        \
+    && itktools::IsType<TInternalType>( internalComponentType ) )               \
+  {                                                                             \
+    return new object;                                                          \
+  }                                                                             \
+  return 0;                                                                     \
+}
+
 #define itktoolsTwoTypeNewMacro( object )                                       \
 static object * New( unsigned int dim,                                          \
   itk::ImageIOBase::IOComponentType inputComponentType,                         \
@@ -72,6 +102,151 @@ static object * New( unsigned int dim,
 }
 
 
+/** Read the threading arguments that are shared by all tools, and apply
+ * them to the global itk::MultiThreader:
+ *   [-threads]  default number of threads of every filter
+ *   [-affinity] list of cores the process is restricted to; if -threads
+ *               is not given, one thread per listed core is used
+ * This affects all filters created afterwards. Only the default number of
+ * threads is set, not the global maximum, so that a later run in the same
+ * process can use more threads again, see GetThreadingState(). Called by
+ * ITKToolsBase::ReadCommonArguments(); tools that do not use
+ * ITKToolsBase call it directly after checking the arguments.
+ */
+void ReadThreadingArguments( itk::CommandLineArgumentParser * parser );
+
+
+/** The process-wide state that ReadThreadingArguments() changes: the
+ * default number of threads of itk::MultiThreader, and the cores the
+ * process may run on, empty if they are not known on this platform.
+ */
+struct ThreadingState
+{
+  unsigned int              m_DefaultNumberOfThreads;
+  std::vector<unsigned int> m_Cores;
+};
+
+/** Get the current threading state, e.g. before a --batch job or a
+ * pxpipeline stage, so that SetThreadingState() can restore it after the
+ * job, and the -threads and -affinity of one job do not carry over to the
+ * next jobs.
+ */
+ThreadingState GetThreadingState( void );
+void SetThreadingState( const ThreadingState & state );
+
+
+/** Read the NUMA placement argument that is shared by all tools:
+ *   [-numa] parallel:   first touch the pages of new image buffers by
+ *                       the threads that later process them
+ *           interleave: spread the pages over all NUMA nodes (Linux)
+ * With either value the images of all scalar component types, including
+ * reader and filter outputs, are allocated from the BufferPool, which
+ * then places the new buffers. Called by ITKToolsBase::ReadCommonArguments().
+ */
+void ReadNUMAArguments( itk::CommandLineArgumentParser * parser );
+
+
+/** Parse a memory size, a number with an optional unit K, M, G or T,
+ * optionally followed by B, e.g. "4G" or "512MB". Without a unit the
+ * number is in MB. Returns false if the text is not a valid size.
+ */
+bool ParseMemorySize( const std::string & text, double & sizeInMB );
+
+
+/** The size of the components of an image, if it is an itk::Image or an
+ * itk::VectorImage of a scalar type; otherwise defaultSize.
+ */
+template< class TComponent, unsigned int VDimension >
+bool IsImageOfComponentType( const itk::DataObject * data )
+{
+  return dynamic_cast< const itk::Image< TComponent, VDimension > * >( data ) != 0
+    || dynamic_cast< const itk::VectorImage< TComponent, VDimension > * >( data ) != 0;
+}
+
+template< unsigned int VDimension >
+std::size_t GetComponentSize( const itk::DataObject * data,
+  const std::size_t defaultSize )
+{
+  if( IsImageOfComponentType< unsigned char, VDimension >( data ) ) return sizeof( unsigned char );
+  if( IsImageOfComponentType< char, VDimension >( data ) ) return sizeof( char );
+  if( IsImageOfComponentType< unsigned short, VDimension >( data ) ) return sizeof( unsigned short );
+  if( IsImageOfComponentType< short, VDimension >( data ) ) return sizeof( short );
+  if( IsImageOfComponentType< unsigned int, VDimension >( data ) ) return sizeof( unsigned int );
+  if( IsImageOfComponentType< int, VDimension >( data ) ) return sizeof( int );
+  if( IsImageOfComponentType< unsigned long, VDimension >( data ) ) return sizeof( unsigned long );
+  if( IsImageOfComponentType< long, VDimension >( data ) ) return sizeof( long );
+  if( IsImageOfComponentType< float, VDimension >( data ) ) return sizeof( float );
+  if( IsImageOfComponentType< double, VDimension >( data ) ) return sizeof( double );
+  return defaultSize;
+}
+
+
+/** Estimate the memory per output pixel of the pipeline that produces
+ * output, when it is streamed: every process object upstream holds its
+ * image outputs for the requested piece. An output smaller than the final
+ * output, e.g. of a shrinking filter, counts for its fraction; a larger
+ * one counts as the same size, since a region-local pipeline only
+ * produces the piece that is requested. The stages and their bytes per
+ * pixel are appended to stages, for the streaming plan.
+ */
+template< unsigned int VDimension >
+double EstimatePipelineBytesPerPixel( const itk::DataObject * output,
+  const std::size_t defaultComponentSize, std::string & stages )
+{
+  typedef itk::ImageBase< VDimension >  ImageBaseType;
+
+  const ImageBaseType * outputImage = dynamic_cast< const ImageBaseType * >( output );
+  if( !outputImage ) return 0.0;
+  const double outputPixels = static_cast<double>(
+    outputImage->GetLargestPossibleRegion().GetNumberOfPixels() );
+
+  double total = 0.0;
+  std::ostringstream description;
+  std::set< itk::ProcessObject * > visited;
+  std::vector< itk::ProcessObject * > pending;
+  if( output->GetSource() ) pending.push_back( output->GetSource().GetPointer() );
+  while( !pending.empty() )
+  {
+    itk::ProcessObject * process = pending.back();
+    pending.pop_back();
+    if( !visited.insert( process ).second ) continue;
+
+    double stageBytes = 0.0;
+    itk::ProcessObject::DataObjectPointerArray outputs = process->GetOutputs();
+    for( std::size_t i = 0; i < outputs.size(); ++i )
+    {
+      const ImageBaseType * image
+        = dynamic_cast< const ImageBaseType * >( outputs[ i ].GetPointer() );
+      if( !image ) continue;
+      double fraction = 1.0;
+      if( outputPixels > 0.0 )
+      {
+        fraction = std::min( 1.0, static_cast<double>(
+          image->GetLargestPossibleRegion().GetNumberOfPixels() ) / outputPixels );
+      }
+      stageBytes += fraction * image->GetNumberOfComponentsPerPixel()
+        * GetComponentSize< VDimension >( image, defaultComponentSize );
+    }
+    total += stageBytes;
+    description << ( description.str().empty() ? "" : ", " )
+      << process->GetNameOfClass() << " " << stageBytes;
+
+    itk::ProcessObject::DataObjectPointerArray inputs = process->GetInputs();
+    for( std::size_t i = 0; i < inputs.size(); ++i )
+    {
+      if( inputs[ i ] && inputs[ i ]->GetSource() )
+      {
+        pending.push_back( inputs[ i ]->GetSource().GetPointer() );
+      }
+    }
+  }
+
+  stages += description.str();
+  return total;
+
+} // end EstimatePipelineBytesPerPixel()
+
+
 /** \class ITKToolsBase
  * \brief Base class for all ITKTools applications.
  */
@@ -79,12 +254,177 @@ static object * New( unsigned int dim,
 class ITKToolsBase
 {
 public:
-  ITKToolsBase(){};
-  virtual ~ITKToolsBase(){};
+  ITKToolsBase()
+  {
+    this->m_NumberOfStreams = 0;
+    this->m_MemoryLimit = 0;
+    this->m_Profile = false;
+    this->m_ProfileFileName = "";
+    this->m_MapOutput = false;
+  };
+
+  /** Reports the profile, if requested. */
+  virtual ~ITKToolsBase();
 
   /** All sub-classes should overwrite Run() to implement functionality. */
   virtual void Run( void ) = 0;
 
+  /** Read the command line arguments that are shared by all tools:
+   *   [-threads]     number of threads, see ReadThreadingArguments()
+   *   [-affinity]    cores to run on, see ReadThreadingArguments()
+   *   [-streams]     number of stream divisions used for writing the output
+   *   [-memoryLimit] approximate memory limit, e.g. 4G or 512M, in MB
+   *                  without a unit; the number of stream divisions is
+   *                  derived from it, and reported under -profile
+   *   [-profile]     print the wall time, CPU time and peak memory of
+   *                  the stages of the tool, and the number of threads
+   *                  it used; with a file name, write
+   *                  them as JSON to that file instead
+   *   [-numa]        placement of image buffers on the NUMA nodes, one of
+   *                  {parallel, interleave}, see ReadNUMAArguments()
+   *   [-progress]    print the progress of the stages, and
+   *   [-cancelFile]  cancel when this file appears, see ReadProgressArguments()
+   *   [-simd]        instruction set of the kernels, see ReadSIMDArguments()
+   *   [-asyncWrite]  write the outputs in the background, and
+   *   [-asyncQueue]  bound the memory of the waiting outputs, see
+   *                  ReadAsyncWriteArguments()
+   *   [-mapOutput]   compute uncompressed .mhd/.mha outputs straight into
+   *                  a memory mapping of the file, see UpdateWriter()
+   * A warning is printed if streaming is requested for a tool that does
+   * not support it.
+   */
+  virtual void ReadCommonArguments( itk::CommandLineArgumentParser * parser );
+
+  /** Sub-classes whose pipeline consists of region-local filters only,
+   * and that do not call Update() before the writer, overwrite this to
+   * return true. Only then -streams and -memoryLimit have an effect.
+   */
+  virtual bool GetSupportsStreaming( void ) const { return false; }
+
+  /** Number of stream divisions, 0 means not set. */
+  unsigned int m_NumberOfStreams;
+
+  /** Memory limit in MB, 0 means no limit. */
+  unsigned int m_MemoryLimit;
+
+  /** Profiling, and the JSON file to write the profile to. */
+  bool        m_Profile;
+  std::string m_ProfileFileName;
+
+  /** Compute the outputs into memory mapped files, see UpdateWriter(). */
+  bool        m_MapOutput;
+
+protected:
+
+  /** Observe a process object (reader, filter, writer) as a stage: time
+   * its execution for the profile, and report its progress and cancel it
+   * through the ProgressMonitor, each only if requested.
+   */
+  void ObserveProcess( itk::ProcessObject * process,
+    const std::string & stageName )
+  {
+    if( this->m_Profile ) this->m_Profiler.Observe( process, stageName );
+    ProgressMonitor::Observe( process, stageName );
+  }
+
+  /** The profiler; stage "total" covers everything after argument parsing. */
+  Profiler m_Profiler;
+
+  /** The number of stream divisions for a pipeline that would hold
+   * sizeInMB when it is not streamed, based on m_NumberOfStreams and
+   * m_MemoryLimit. Under -profile the plan is added to the profile, with
+   * the stages of the estimate, if given.
+   */
+  unsigned int GetNumberOfStreams( const double sizeInMB,
+    const std::string & stages = "" )
+  {
+    unsigned int numberOfStreams = this->m_NumberOfStreams;
+    if( this->m_MemoryLimit > 0 && this->GetSupportsStreaming() )
+    {
+      const unsigned int streamsForLimit = static_cast<unsigned int>(
+        std::ceil( sizeInMB / static_cast<double>( this->m_MemoryLimit ) ) );
+      if( streamsForLimit > numberOfStreams ) numberOfStreams = streamsForLimit;
+
+      if( this->m_Profile )
+      {
+        std::ostringstream plan;
+        plan << "memory limit " << this->m_MemoryLimit << " MB, estimated "
+          << sizeInMB << " MB unstreamed";
+        if( !stages.empty() ) plan << " (bytes per voxel: " << stages << ")";
+        plan << ", " << std::max( numberOfStreams, 1u ) << " stream division(s)";
+        this->m_Profiler.AddNote( "streaming", plan.str() );
+      }
+    }
+    return numberOfStreams;
+  } // end GetNumberOfStreams()
+
+  /** Set the number of stream divisions on a writer, based on
+   * m_NumberOfStreams and m_MemoryLimit. The memory of the pipeline is
+   * estimated from the pixel types of the images produced upstream of the
+   * writer, see EstimatePipelineBytesPerPixel(). Tools can give a lower
+   * bound for inputs the pipeline does not show: the inputs then hold at
+   * least inputBytesPerPixel bytes for every output pixel, in addition to
+   * the output itself; for example for a filter with many inputs.
+   */
+  template< class TWriter >
+  void SetStreamingOnWriter( TWriter * writer,
+    const double inputBytesPerPixel = 0.0 )
+  {
+    typedef typename TWriter::InputImageType        ImageType;
+    typedef typename ImageType::InternalPixelType   InternalPixelType;
+    typedef typename itk::NumericTraits<
+      InternalPixelType >::ValueType                ValueType;
+
+    double sizeInMB = 0.0;
+    std::string stages;
+    if( this->m_MemoryLimit > 0 && this->GetSupportsStreaming() )
+    {
+      /** Estimate the size of the full pipeline in MB. */
+      ImageType * image = const_cast<ImageType *>( writer->GetInput() );
+      image->UpdateOutputInformation();
+      const double outputBytesPerPixel
+        = image->GetNumberOfComponentsPerPixel() * sizeof( ValueType );
+      const double pipelineBytesPerPixel
+        = EstimatePipelineBytesPerPixel< ImageType::ImageDimension >(
+        image, sizeof( ValueType ), stages );
+      sizeInMB
+        = static_cast<double>( image->GetLargestPossibleRegion().GetNumberOfPixels() )
+        * std::max( pipelineBytesPerPixel, outputBytesPerPixel + inputBytesPerPixel )
+        / 1048576.0;
+    }
+
+    const unsigned int numberOfStreams = this->GetNumberOfStreams( sizeInMB, stages );
+    if( numberOfStreams > 1 )
+    {
+      writer->SetNumberOfStreamDivisions( numberOfStreams );
+    }
+  } // end SetStreamingOnWriter()
+
+  /** Execute a writer. Under -mapOutput an uncompressed MetaImage output
+   * is computed straight into its file, see WriteImageMapped(). Under
+   * -asyncWrite its input is computed here, and written in the background
+   * by the AsyncWriter. A streamed writer computes its input while it
+   * writes, and always writes right away.
+   */
+  template< class TWriter >
+  void UpdateWriter( TWriter * writer )
+  {
+    typedef typename TWriter::InputImageType        ImageType;
+    ImageType * image = const_cast<ImageType *>( writer->GetInput() );
+    const bool streamed = writer->GetNumberOfStreamDivisions() > 1;
+    if( !streamed && this->m_MapOutput && !writer->GetUseCompression()
+      && WriteImageMapped( image, writer->GetFileName() ) )
+    {
+      return;
+    }
+    if( !streamed && AsyncWriter::GetNumberOfWriterThreads() > 0 )
+    {
+      WriteImageAsync( image, writer->GetFileName(), writer->GetUseCompression() );
+      return;
+    }
+    writer->Update();
+  } // end UpdateWriter()
+
 }; // end class ITKToolsBase()
 
 } // end namespace itktools
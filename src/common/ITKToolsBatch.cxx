@@ -0,0 +1,204 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#include "ITKToolsBatch.h"
+#include "ITKToolsAsyncWriter.h"
+#include "ITKToolsBase.h"
+#include "ITKToolsHelpers.h"
+#include "ITKToolsImageProperties.h"
+
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+
+
+namespace itktools
+{
+
+/**
+ * ***************** SplitCommandLine ************************
+ */
+
+bool SplitCommandLine(
+  const std::string & commandLine,
+  std::vector<std::string> & arguments )
+{
+  arguments.clear();
+
+  std::string current = "";
+  bool inQuotes = false;
+  bool inArgument = false;
+  for( std::size_t i = 0; i < commandLine.size(); ++i )
+  {
+    const char c = commandLine[ i ];
+    if( c == '"' )
+    {
+      inQuotes = !inQuotes;
+      inArgument = true;
+    }
+    else if( !inQuotes && ( c == ' ' || c == '\t' || c == '\r' || c == '\n' ) )
+    {
+      if( inArgument )
+      {
+        arguments.push_back( current );
+        current = "";
+        inArgument = false;
+      }
+    }
+    else
+    {
+      current += c;
+      inArgument = true;
+    }
+  }
+
+  if( inArgument ) arguments.push_back( current );
+
+  return !inQuotes;
+
+} // end SplitCommandLine()
+
+
+/**
+ * ***************** RunToolMain ************************
+ */
+
+int RunToolMain( int argc, char ** argv, ToolMainFunctionType toolMain )
+{
+  /** The IO factories are registered once for all jobs. */
+  RegisterImageIOFactories();
+
+  /** Check if batch mode is requested. */
+  int batchIndex = -1;
+  if( argc > 1 && std::string( argv[ 1 ] ) == "--batch" )
+  {
+    batchIndex = 1;
+  }
+
+  /** Normal mode: run the tool once. */
+  if( batchIndex == -1 )
+  {
+    int exitCode = toolMain( argc, argv );
+    if( AsyncWriter::Flush() > 0 ) exitCode = EXIT_FAILURE;
+    return exitCode;
+  }
+
+  /** Batch mode: open the file with command lines, or use stdin. */
+  std::string batchFileName = "-";
+  if( batchIndex + 1 < argc ) batchFileName = argv[ batchIndex + 1 ];
+
+  std::ifstream batchFile;
+  std::istream * batchInput = &std::cin;
+  if( batchFileName != "-" )
+  {
+    batchFile.open( batchFileName.c_str() );
+    if( !batchFile.is_open() )
+    {
+      std::cerr << "ERROR: could not open batch file \""
+        << batchFileName << "\"." << std::endl;
+      return EXIT_FAILURE;
+    }
+    batchInput = &batchFile;
+  }
+
+  /** Run all jobs. A failing job does not stop the batch. The -threads
+   * and -affinity of a job only apply to that job. */
+  const ThreadingState threadingState = GetThreadingState();
+  const std::string programName = argv[ 0 ];
+  unsigned int jobNumber = 0;
+  unsigned int numberOfFailedJobs = 0;
+  unsigned int numberOfFailedWrites = 0;
+  std::string line = "";
+  while( std::getline( *batchInput, line ) )
+  {
+    std::vector<std::string> tokens;
+    bool validLine = SplitCommandLine( line, tokens );
+    if( validLine && ( tokens.empty() || tokens[ 0 ][ 0 ] == '#' ) ) continue;
+
+    ++jobNumber;
+    int exitCode = EXIT_FAILURE;
+    if( !validLine )
+    {
+      std::cerr << "ERROR: unbalanced quotes in batch job " << jobNumber
+        << ": " << line << std::endl;
+    }
+    else
+    {
+      /** Construct argv, skipping an optional program name on the line. */
+      std::vector<std::string> arguments( 1, programName );
+      std::size_t first = tokens[ 0 ][ 0 ] == '-' ? 0 : 1;
+      arguments.insert( arguments.end(), tokens.begin() + first, tokens.end() );
+
+      /** Wait for the background writes of files this job uses. */
+      for( std::size_t i = 1; i < arguments.size(); ++i )
+      {
+        if( AsyncWriter::IsPending( arguments[ i ] ) )
+        {
+          numberOfFailedWrites += AsyncWriter::Flush();
+          break;
+        }
+      }
+
+      std::vector<char *> jobArgv( arguments.size() + 1, 0 );
+      for( std::size_t i = 0; i < arguments.size(); ++i )
+      {
+        jobArgv[ i ] = &arguments[ i ][ 0 ];
+      }
+
+      try
+      {
+        exitCode = toolMain( static_cast<int>( arguments.size() ), &jobArgv[ 0 ] );
+      }
+      catch( std::exception & excp )
+      {
+        std::cerr << "ERROR: Caught exception in batch job "
+          << jobNumber << ": " << excp.what() << std::endl;
+        exitCode = EXIT_FAILURE;
+      }
+    }
+
+    if( exitCode != EXIT_SUCCESS ) ++numberOfFailedJobs;
+
+    /** A job may have written files that a next job reads. */
+    ClearImageIOBaseCache();
+    SetThreadingState( threadingState );
+
+    std::cerr.flush();
+    std::cout << "ITKTools batch job " << jobNumber
+      << " finished with exit code " << exitCode << std::endl;
+  }
+
+  numberOfFailedWrites += AsyncWriter::Flush();
+  if( numberOfFailedJobs > 0 || numberOfFailedWrites > 0 )
+  {
+    std::cerr << "ERROR: " << numberOfFailedJobs << " of " << jobNumber
+      << " batch jobs failed";
+    if( numberOfFailedWrites > 0 )
+    {
+      std::cerr << ", and " << numberOfFailedWrites << " background write(s) failed";
+    }
+    std::cerr << "." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+
+} // end RunToolMain()
+
+
+} // end namespace itktools
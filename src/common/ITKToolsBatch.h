@@ -0,0 +1,66 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __ITKToolsBatch_h_
+#define __ITKToolsBatch_h_
+
+#include <string>
+#include <vector>
+
+
+namespace itktools
+{
+
+/** The signature of the entry point of a tool, i.e. its former main(). */
+typedef int ( * ToolMainFunctionType )( int argc, char ** argv );
+
+/** Split a single command line into its arguments.
+ * Arguments are separated by white space. Double quotes can be used
+ * to group arguments containing spaces. Returns false on unbalanced quotes.
+ */
+bool SplitCommandLine(
+  const std::string & commandLine,
+  std::vector<std::string> & arguments );
+
+/** Run the tool entry point toolMain with the given arguments.
+ *
+ * Normally toolMain is simply called once. When the first argument is
+ * "--batch", the process instead stays alive and runs toolMain once for
+ * every line read from the file following "--batch", or from standard
+ * input when no file or "-" is given. Each line holds the arguments of
+ * one job, optionally preceded by the program name. Empty lines and
+ * lines starting with '#' are skipped. Only the first argument counts,
+ * so that tools that pass on their arguments to another tool, like
+ * pxcache, pass on a "--batch" as well.
+ *
+ * The main() that ADD_ITKTOOL generates for every tool, and the
+ * dispatcher of the multi-call binary pxtools, call this with the main()
+ * of the tool, so that all tools support --batch.
+ *
+ * IO factories, the ITK thread pool and other process-wide state are
+ * thus set up only once for all jobs. After each job a line
+ * "ITKTools batch job <n> finished with exit code <code>" is printed
+ * and the output is flushed, so that a driving process knows when to
+ * submit the next job.
+ *
+ * Returns EXIT_SUCCESS if all jobs succeeded, EXIT_FAILURE otherwise.
+ */
+int RunToolMain( int argc, char ** argv, ToolMainFunctionType toolMain );
+
+} // end namespace itktools
+
+#endif // end #ifndef __ITKToolsBatch_h_
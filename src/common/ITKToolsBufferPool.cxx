@@ -0,0 +1,400 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#include "ITKToolsBufferPool.h"
+
+#include "itkImage.h"
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
+#include <fstream>
+#include <map>
+#include <new>
+#include <vector>
+
+#if defined( __linux__ )
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+namespace itktools
+{
+
+/** The state of the pool: the idle buffers by size, the size of every
+ * buffer that is handed out, and the settings.
+ */
+struct BufferPoolState
+{
+  BufferPoolState()
+    : m_IdleSize( 0 ), m_MaximumIdleSize( std::size_t( 1 ) << 30 ), m_Prefault( true ),
+    m_Placement( BufferPool::SerialPlacement ) {}
+
+  std::multimap< std::size_t, void * >  m_Idle;
+  std::map< void *, std::size_t >       m_Acquired;
+  std::size_t                           m_IdleSize;
+  std::size_t                           m_MaximumIdleSize;
+  bool                                  m_Prefault;
+  BufferPool::PlacementType             m_Placement;
+  itk::SimpleFastMutexLock              m_Lock;
+};
+
+static BufferPoolState & GetBufferPoolState( void )
+{
+  static BufferPoolState state;
+  return state;
+}
+
+/** The page size used for pre-faulting; a smaller value than the actual
+ * page size only writes more bytes. */
+static const std::size_t BufferPoolPageSize = 4096;
+
+/** Buffers smaller than this are pre-faulted serially in any case. */
+static const std::size_t BufferPoolParallelMinimumSize = std::size_t( 1 ) << 22;
+
+
+/**
+ * ***************** PrefaultThreaderCallback ************************
+ */
+
+struct PrefaultThreadStruct
+{
+  char *        Buffer;
+  std::size_t   NumberOfBytes;
+};
+
+static ITK_THREAD_RETURN_TYPE PrefaultThreaderCallback( void * arg )
+{
+  typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+  ThreadInfoType * info = static_cast<ThreadInfoType *>( arg );
+  PrefaultThreadStruct * str = static_cast<PrefaultThreadStruct *>( info->UserData );
+
+  /** The same contiguous share as the thread gets of a region, whose
+   * split is along the last dimension, i.e. in buffer order. */
+  const std::size_t numberOfPages
+    = ( str->NumberOfBytes + BufferPoolPageSize - 1 ) / BufferPoolPageSize;
+  const std::size_t begin = static_cast<std::size_t>(
+    static_cast<unsigned long long>( numberOfPages ) * info->ThreadID / info->NumberOfThreads );
+  const std::size_t end = static_cast<std::size_t>(
+    static_cast<unsigned long long>( numberOfPages ) * ( info->ThreadID + 1 ) / info->NumberOfThreads );
+  for( std::size_t p = begin; p < end; ++p )
+  {
+    str->Buffer[ p * BufferPoolPageSize ] = 0;
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+} // end PrefaultThreaderCallback()
+
+
+/**
+ * ***************** InterleavePages ************************
+ */
+
+static bool InterleavePages( void * buffer, std::size_t numberOfBytes )
+{
+#if defined( __linux__ ) && defined( SYS_mbind )
+  /** The online nodes, e.g. "0-1" or "0,2-3". */
+  unsigned long nodeMask[ 16 ] = { 0 };
+  const unsigned long bitsPerLong = 8 * sizeof( unsigned long );
+  std::ifstream online( "/sys/devices/system/node/online" );
+  unsigned long first = 0, last = 0, numberOfNodes = 0;
+  char separator = ',';
+  while( separator == ',' && online >> first )
+  {
+    last = first;
+    if( online.peek() == '-' ) online >> separator >> last;
+    for( unsigned long n = first; n <= last && n < 16 * bitsPerLong; ++n )
+    {
+      nodeMask[ n / bitsPerLong ] |= 1UL << ( n % bitsPerLong );
+      ++numberOfNodes;
+    }
+    separator = ' ';
+    online >> separator;
+  }
+  if( numberOfNodes < 2 ) return numberOfNodes == 1;
+
+  /** Only whole pages can be bound. */
+  const long pageSize = sysconf( _SC_PAGESIZE );
+  if( pageSize <= 0 ) return false;
+  const std::size_t page = static_cast<std::size_t>( pageSize );
+  const std::size_t address = reinterpret_cast<std::size_t>( buffer );
+  const std::size_t begin = ( address + page - 1 ) / page * page;
+  const std::size_t end = ( address + numberOfBytes ) / page * page;
+  if( end <= begin ) return true;
+
+  const int interleave = 3; // MPOL_INTERLEAVE, as in <numaif.h>
+  return syscall( SYS_mbind, reinterpret_cast<void *>( begin ), end - begin,
+    interleave, nodeMask, 16 * bitsPerLong, 0 ) == 0;
+#else
+  (void)buffer;
+  (void)numberOfBytes;
+  return false;
+#endif
+
+} // end InterleavePages()
+
+
+/**
+ * ***************** Acquire ************************
+ */
+
+void *
+BufferPool::Acquire( std::size_t numberOfBytes )
+{
+  if( numberOfBytes == 0 ) numberOfBytes = 1;
+  BufferPoolState & state = GetBufferPoolState();
+
+  /** Reuse the smallest idle buffer that is large enough, if it is not
+   * more than 1/8 larger than requested. */
+  state.m_Lock.Lock();
+  std::multimap< std::size_t, void * >::iterator it
+    = state.m_Idle.lower_bound( numberOfBytes );
+  if( it != state.m_Idle.end() && it->first <= numberOfBytes + numberOfBytes / 8 )
+  {
+    void * buffer = it->second;
+    state.m_Acquired[ buffer ] = it->first;
+    state.m_IdleSize -= it->first;
+    state.m_Idle.erase( it );
+    state.m_Lock.Unlock();
+    return buffer;
+  }
+  const bool prefault = state.m_Prefault;
+  const PlacementType placement = state.m_Placement;
+  state.m_Lock.Unlock();
+
+  /** A new buffer, placed and pre-faulted outside the lock. If the pages
+   * cannot be interleaved, they are placed as by a serial pre-fault. */
+  char * buffer = static_cast<char *>( ::operator new( numberOfBytes ) );
+  if( placement == InterleavedPlacement )
+  {
+    InterleavePages( buffer, numberOfBytes );
+  }
+  if( prefault && placement == ParallelPlacement
+    && numberOfBytes >= BufferPoolParallelMinimumSize )
+  {
+    PrefaultThreadStruct str;
+    str.Buffer = buffer;
+    str.NumberOfBytes = numberOfBytes;
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    threader->SetSingleMethod( PrefaultThreaderCallback, &str );
+    threader->SingleMethodExecute();
+  }
+  else if( prefault )
+  {
+    for( std::size_t i = 0; i < numberOfBytes; i += BufferPoolPageSize )
+    {
+      buffer[ i ] = 0;
+    }
+  }
+
+  state.m_Lock.Lock();
+  state.m_Acquired[ buffer ] = numberOfBytes;
+  state.m_Lock.Unlock();
+  return buffer;
+
+} // end Acquire()
+
+
+/**
+ * ***************** Release ************************
+ */
+
+bool
+BufferPool::Release( void * buffer )
+{
+  BufferPoolState & state = GetBufferPoolState();
+
+  state.m_Lock.Lock();
+  std::map< void *, std::size_t >::iterator it = state.m_Acquired.find( buffer );
+  if( it == state.m_Acquired.end() )
+  {
+    state.m_Lock.Unlock();
+    return false;
+  }
+  const std::size_t numberOfBytes = it->second;
+  state.m_Acquired.erase( it );
+  const bool keep = state.m_IdleSize + numberOfBytes <= state.m_MaximumIdleSize;
+  if( keep )
+  {
+    state.m_Idle.insert( std::make_pair( numberOfBytes, buffer ) );
+    state.m_IdleSize += numberOfBytes;
+  }
+  state.m_Lock.Unlock();
+
+  if( !keep ) ::operator delete( buffer );
+  return true;
+
+} // end Release()
+
+
+/**
+ * ***************** Clear ************************
+ */
+
+void
+BufferPool::Clear( void )
+{
+  BufferPoolState & state = GetBufferPoolState();
+
+  std::vector< void * > buffers;
+  state.m_Lock.Lock();
+  for( std::multimap< std::size_t, void * >::iterator it = state.m_Idle.begin();
+    it != state.m_Idle.end(); ++it )
+  {
+    buffers.push_back( it->second );
+  }
+  state.m_Idle.clear();
+  state.m_IdleSize = 0;
+  state.m_Lock.Unlock();
+
+  for( std::size_t i = 0; i < buffers.size(); ++i )
+  {
+    ::operator delete( buffers[ i ] );
+  }
+
+} // end Clear()
+
+
+/**
+ * ***************** SetMaximumIdleSize ************************
+ */
+
+void
+BufferPool::SetMaximumIdleSize( std::size_t numberOfBytes )
+{
+  BufferPoolState & state = GetBufferPoolState();
+
+  /** Drop the largest idle buffers until the rest fits. */
+  std::vector< void * > buffers;
+  state.m_Lock.Lock();
+  state.m_MaximumIdleSize = numberOfBytes;
+  while( state.m_IdleSize > numberOfBytes )
+  {
+    std::multimap< std::size_t, void * >::iterator it = --state.m_Idle.end();
+    buffers.push_back( it->second );
+    state.m_IdleSize -= it->first;
+    state.m_Idle.erase( it );
+  }
+  state.m_Lock.Unlock();
+
+  for( std::size_t i = 0; i < buffers.size(); ++i )
+  {
+    ::operator delete( buffers[ i ] );
+  }
+
+} // end SetMaximumIdleSize()
+
+
+/**
+ * ***************** GetMaximumIdleSize ************************
+ */
+
+std::size_t
+BufferPool::GetMaximumIdleSize( void )
+{
+  BufferPoolState & state = GetBufferPoolState();
+  state.m_Lock.Lock();
+  const std::size_t size = state.m_MaximumIdleSize;
+  state.m_Lock.Unlock();
+  return size;
+
+} // end GetMaximumIdleSize()
+
+
+/**
+ * ***************** GetIdleSize ************************
+ */
+
+std::size_t
+BufferPool::GetIdleSize( void )
+{
+  BufferPoolState & state = GetBufferPoolState();
+  state.m_Lock.Lock();
+  const std::size_t size = state.m_IdleSize;
+  state.m_Lock.Unlock();
+  return size;
+
+} // end GetIdleSize()
+
+
+/**
+ * ***************** SetPrefault ************************
+ */
+
+void
+BufferPool::SetPrefault( bool prefault )
+{
+  BufferPoolState & state = GetBufferPoolState();
+  state.m_Lock.Lock();
+  state.m_Prefault = prefault;
+  state.m_Lock.Unlock();
+
+} // end SetPrefault()
+
+
+/**
+ * ***************** SetPlacement ************************
+ */
+
+void
+BufferPool::SetPlacement( PlacementType placement )
+{
+  BufferPoolState & state = GetBufferPoolState();
+  state.m_Lock.Lock();
+  state.m_Placement = placement;
+  state.m_Lock.Unlock();
+
+} // end SetPlacement()
+
+
+/**
+ * ***************** GetPlacement ************************
+ */
+
+BufferPool::PlacementType
+BufferPool::GetPlacement( void )
+{
+  BufferPoolState & state = GetBufferPoolState();
+  state.m_Lock.Lock();
+  const PlacementType placement = state.m_Placement;
+  state.m_Lock.Unlock();
+  return placement;
+
+} // end GetPlacement()
+
+
+/**
+ * ***************** RegisterPooledScalarImageTypes ************************
+ */
+
+void RegisterPooledScalarImageTypes( void )
+{
+  /** The pixel container does not depend on the dimension. */
+  RegisterPooledImageType< itk::Image< unsigned char, 2 > >();
+  RegisterPooledImageType< itk::Image< char, 2 > >();
+  RegisterPooledImageType< itk::Image< unsigned short, 2 > >();
+  RegisterPooledImageType< itk::Image< short, 2 > >();
+  RegisterPooledImageType< itk::Image< unsigned int, 2 > >();
+  RegisterPooledImageType< itk::Image< int, 2 > >();
+  RegisterPooledImageType< itk::Image< unsigned long, 2 > >();
+  RegisterPooledImageType< itk::Image< long, 2 > >();
+  RegisterPooledImageType< itk::Image< float, 2 > >();
+  RegisterPooledImageType< itk::Image< double, 2 > >();
+
+} // end RegisterPooledScalarImageTypes()
+
+
+} // end namespace itktools
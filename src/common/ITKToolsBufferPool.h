@@ -0,0 +1,250 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __ITKToolsBufferPool_h_
+#define __ITKToolsBufferPool_h_
+
+#include <cstddef>
+#include <typeinfo>
+#include <algorithm>
+#include "itkImportImageContainer.h"
+#include "itkObjectFactoryBase.h"
+#include "itkCreateObjectFunction.h"
+#include "itkVersion.h"
+
+
+namespace itktools
+{
+
+/** \class BufferPool
+ * \brief A process wide pool of the memory of released image buffers.
+ *
+ * Multi-stage tools allocate a sequence of temporary images of the same
+ * size, each released right after use. Every allocation of a large image
+ * is a fresh mapping from the system, which costs a page fault per page
+ * when it is first written. The pool keeps released buffers, and hands
+ * them out again for a request of the same size, or at most 1/8 smaller,
+ * so that the pages are recycled across the stages of a tool and across
+ * the jobs of a batch. New buffers are pre-faulted, by writing one byte
+ * per page, unless that is switched off.
+ *
+ * The idle buffers are bounded by MaximumIdleSize, default 1 GB; buffers
+ * that do not fit are returned to the system. The pool is thread safe.
+ *
+ * On machines with several NUMA nodes a page is placed on the node of the
+ * thread that first writes it, which after a serial pre-fault is the node
+ * of the allocating thread. With ParallelPlacement large new buffers are
+ * pre-faulted by the threads of a MultiThreader, each the same share of
+ * the buffer it gets in the split of a region over the threads, so that
+ * the threaded filters find their part of the image on their own node.
+ * With InterleavedPlacement the pages are spread over all nodes instead
+ * (Linux only), which balances the traffic for any access pattern.
+ *
+ * Images use the pool through PooledImportImageContainer, usually by
+ * calling RegisterPooledImageType() for the image types of a pipeline.
+ */
+
+class BufferPool
+{
+public:
+  /** Get a buffer of at least numberOfBytes bytes. Throws std::bad_alloc
+   * if no memory is available. */
+  static void * Acquire( std::size_t numberOfBytes );
+
+  /** Return a buffer obtained from Acquire(). Returns false, and does
+   * nothing, if the buffer was not obtained from the pool. */
+  static bool Release( void * buffer );
+
+  /** Return all idle buffers to the system. */
+  static void Clear( void );
+
+  /** Set/Get the maximum total size of the idle buffers in bytes. */
+  static void SetMaximumIdleSize( std::size_t numberOfBytes );
+  static std::size_t GetMaximumIdleSize( void );
+
+  /** The total size of the idle buffers in bytes. */
+  static std::size_t GetIdleSize( void );
+
+  /** Set whether new buffers are pre-faulted. Default true. */
+  static void SetPrefault( bool prefault );
+
+  /** The placement of the pages of new buffers on the NUMA nodes. */
+  typedef enum { SerialPlacement, ParallelPlacement, InterleavedPlacement } PlacementType;
+
+  /** Set/Get the placement. Default SerialPlacement. */
+  static void SetPlacement( PlacementType placement );
+  static PlacementType GetPlacement( void );
+
+}; // end class BufferPool
+
+
+/** \class PooledImportImageContainer
+ * \brief An ImportImageContainer that allocates its memory from the BufferPool.
+ *
+ * Memory the container owns is returned to the pool, instead of freed,
+ * when the container is released or reallocated. Memory that is imported
+ * from elsewhere is handled as by the superclass.
+ *
+ * Only for pixel types without a destructor, i.e. scalars and fixed
+ * length vectors, as all pixel types of the tools.
+ */
+
+template< typename TElementIdentifier, typename TElement >
+class PooledImportImageContainer
+  : public itk::ImportImageContainer< TElementIdentifier, TElement >
+{
+public:
+  /** Standard class typedefs. */
+  typedef PooledImportImageContainer        Self;
+  typedef itk::ImportImageContainer<
+    TElementIdentifier, TElement >          Superclass;
+  typedef itk::SmartPointer< Self >         Pointer;
+  typedef itk::SmartPointer< const Self >   ConstPointer;
+  typedef TElementIdentifier                ElementIdentifier;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( PooledImportImageContainer, ImportImageContainer );
+
+protected:
+  PooledImportImageContainer() {}
+  virtual ~PooledImportImageContainer() { this->DeallocateManagedMemory(); }
+
+  /** Allocate from the pool. */
+  virtual TElement * AllocateElements( ElementIdentifier size,
+    bool UseDefaultConstructor = false ) const
+  {
+    TElement * data = 0;
+    try
+    {
+      data = static_cast<TElement *>( BufferPool::Acquire(
+        static_cast<std::size_t>( size ) * sizeof( TElement ) ) );
+    }
+    catch( ... )
+    {
+      data = 0;
+    }
+    if( !data )
+    {
+      throw itk::MemoryAllocationError( __FILE__, __LINE__,
+        "Failed to allocate memory for image.", ITK_LOCATION );
+    }
+    if( UseDefaultConstructor )
+    {
+      std::fill( data, data + size, TElement() );
+    }
+    return data;
+  }
+
+  /** Return owned memory to the pool; the superclass then only resets. */
+  virtual void DeallocateManagedMemory( void )
+  {
+    if( this->GetContainerManageMemory() && this->GetImportPointer()
+      && BufferPool::Release( this->GetImportPointer() ) )
+    {
+      this->SetContainerManageMemory( false );
+    }
+    Superclass::DeallocateManagedMemory();
+  }
+
+private:
+  PooledImportImageContainer( const Self & ); // purposely not implemented
+  void operator=( const Self & );             // purposely not implemented
+
+}; // end class PooledImportImageContainer
+
+
+/** \class PooledImportImageContainerFactory
+ * \brief Let the pixel containers of one type be created as pooled containers.
+ */
+
+template< typename TElementIdentifier, typename TElement >
+class PooledImportImageContainerFactory : public itk::ObjectFactoryBase
+{
+public:
+  /** Standard class typedefs. */
+  typedef PooledImportImageContainerFactory Self;
+  typedef itk::ObjectFactoryBase            Superclass;
+  typedef itk::SmartPointer< Self >         Pointer;
+  typedef itk::SmartPointer< const Self >   ConstPointer;
+  typedef itk::ImportImageContainer<
+    TElementIdentifier, TElement >          ContainerType;
+  typedef PooledImportImageContainer<
+    TElementIdentifier, TElement >          PooledContainerType;
+
+  /** Class methods used to interface with the registered factories. */
+  virtual const char * GetITKSourceVersion( void ) const { return ITK_SOURCE_VERSION; }
+  virtual const char * GetDescription( void ) const
+  {
+    return "Pooled image container factory, recycles the memory of released images";
+  }
+
+  /** Method for class instantiation. */
+  itkFactorylessNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( PooledImportImageContainerFactory, ObjectFactoryBase );
+
+protected:
+  PooledImportImageContainerFactory()
+  {
+    this->RegisterOverride( typeid( ContainerType ).name(),
+      typeid( PooledContainerType ).name(),
+      "Pooled image container",
+      true,
+      itk::CreateObjectFunction< PooledContainerType >::New() );
+  }
+
+private:
+  PooledImportImageContainerFactory( const Self & ); // purposely not implemented
+  void operator=( const Self & );                    // purposely not implemented
+
+}; // end class PooledImportImageContainerFactory
+
+
+/** Let every image of type TImage created afterwards, by the tool or by
+ * the filters of its pipeline, allocate its buffer from the BufferPool.
+ * Registering a type more than once has no effect.
+ */
+template< class TImage >
+void RegisterPooledImageType( void )
+{
+  typedef typename TImage::PixelContainer             ContainerType;
+  typedef PooledImportImageContainerFactory<
+    typename ContainerType::ElementIdentifier,
+    typename ContainerType::Element >                 FactoryType;
+
+  static bool registered = false;
+  if( registered ) return;
+  registered = true;
+  typename FactoryType::Pointer factory = FactoryType::New();
+  itk::ObjectFactoryBase::RegisterFactory( factory );
+
+} // end RegisterPooledImageType()
+
+
+/** Let the images of all scalar component types allocate their buffers
+ * from the BufferPool, so also the outputs of readers and filters. This
+ * covers itk::Image of scalars and itk::VectorImage, in any dimension.
+ */
+void RegisterPooledScalarImageTypes( void );
+
+} // end namespace itktools
+
+#endif // end #ifndef __ITKToolsBufferPool_h_
@@ -0,0 +1,289 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#include "ITKToolsChecksum.h"
+#include "ITKToolsImageProperties.h"
+
+#include "itkImageIOBase.h"
+#include "itkMultiThreader.h"
+#include "itksys/SystemTools.hxx"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+namespace itktools
+{
+
+/** The size of the chunks that are hashed independently. */
+static const std::size_t ChecksumChunkSize = 1048576;
+
+/** The SplitMix64 finalizer, a bijective 64 bit mixing function. */
+static unsigned long long ChecksumMix( unsigned long long z )
+{
+  z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+  z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBULL;
+  return z ^ ( z >> 31 );
+} // end ChecksumMix()
+
+
+/** Hash a chunk of bytes, 8 bytes at a time. */
+static unsigned long long HashChunk( const unsigned char * data,
+  std::size_t numberOfBytes, unsigned long long seed )
+{
+  unsigned long long h = ChecksumMix( seed ^ numberOfBytes );
+  std::size_t i = 0;
+  for( ; i + 8 <= numberOfBytes; i += 8 )
+  {
+    unsigned long long word;
+    std::memcpy( &word, data + i, 8 );
+    h = ChecksumMix( h ^ ( word * 0x9E3779B97F4A7C15ULL ) );
+  }
+  if( i < numberOfBytes )
+  {
+    unsigned long long word = 0;
+    std::memcpy( &word, data + i, numberOfBytes - i );
+    h = ChecksumMix( h ^ ( word * 0x9E3779B97F4A7C15ULL ) );
+  }
+  return h;
+} // end HashChunk()
+
+
+/** The data shared by the threads of ComputeBufferChecksum(). */
+struct ChecksumStruct
+{
+  const unsigned char *           m_Buffer;
+  std::size_t                     m_NumberOfBytes;
+  std::vector<unsigned long long> m_ChunkHashes;
+};
+
+static ITK_THREAD_RETURN_TYPE ChecksumThreaderCallback( void * arg )
+{
+  itk::MultiThreader::ThreadInfoStruct * info
+    = static_cast<itk::MultiThreader::ThreadInfoStruct *>( arg );
+  ChecksumStruct * data = static_cast<ChecksumStruct *>( info->UserData );
+
+  /** Every thread hashes every NumberOfThreads-th chunk. */
+  for( std::size_t c = info->ThreadID; c < data->m_ChunkHashes.size();
+    c += info->NumberOfThreads )
+  {
+    const std::size_t begin = c * ChecksumChunkSize;
+    const std::size_t size = std::min( ChecksumChunkSize, data->m_NumberOfBytes - begin );
+    data->m_ChunkHashes[ c ] = HashChunk( data->m_Buffer + begin, size, c );
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end ChecksumThreaderCallback()
+
+
+/** The checksum of a buffer, starting from the hash of its description. */
+static std::string ComputeBufferChecksum( const unsigned char * buffer,
+  std::size_t numberOfBytes, const std::string & description )
+{
+  ChecksumStruct data;
+  data.m_Buffer = buffer;
+  data.m_NumberOfBytes = numberOfBytes;
+  data.m_ChunkHashes.resize( ( numberOfBytes + ChecksumChunkSize - 1 ) / ChecksumChunkSize );
+
+  if( !data.m_ChunkHashes.empty() )
+  {
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    const std::size_t numberOfThreads = std::min<std::size_t>(
+      data.m_ChunkHashes.size(), itk::MultiThreader::GetGlobalDefaultNumberOfThreads() );
+    threader->SetNumberOfThreads( static_cast<itk::ThreadIdType>( numberOfThreads ) );
+    threader->SetSingleMethod( ChecksumThreaderCallback, &data );
+    threader->SingleMethodExecute();
+  }
+
+  /** Combine the description and the chunks in order. */
+  unsigned long long h = HashChunk(
+    reinterpret_cast<const unsigned char *>( description.c_str() ),
+    description.size(), 0x5043484BULL );
+  for( std::size_t c = 0; c < data.m_ChunkHashes.size(); ++c )
+  {
+    h = ChecksumMix( h ^ data.m_ChunkHashes[ c ] );
+  }
+
+  std::ostringstream checksum;
+  checksum << std::hex << std::setw( 16 ) << std::setfill( '0' ) << h;
+  return checksum.str();
+
+} // end ComputeBufferChecksum()
+
+
+/**
+ * ***************** GetCachedImageChecksum ************************
+ */
+
+bool GetCachedImageChecksum(
+  const std::string & filename,
+  std::string & checksum )
+{
+  std::ifstream cacheFile( ( filename + ".checksum" ).c_str() );
+  std::string cachedChecksum;
+  unsigned long fileSize = 0;
+  long modificationTime = 0;
+  if( !( cacheFile >> cachedChecksum >> fileSize >> modificationTime ) )
+  {
+    return false;
+  }
+
+  if( fileSize != itksys::SystemTools::FileLength( filename.c_str() )
+    || modificationTime != itksys::SystemTools::ModifiedTime( filename.c_str() ) )
+  {
+    return false;
+  }
+
+  checksum = cachedChecksum;
+  return true;
+
+} // end GetCachedImageChecksum()
+
+
+/**
+ * ***************** GetImageChecksum ************************
+ */
+
+bool GetImageChecksum(
+  const std::string & filename,
+  const bool useCacheFile,
+  std::string & checksum,
+  std::string & errorMessage )
+{
+  if( useCacheFile && GetCachedImageChecksum( filename, checksum ) )
+  {
+    return true;
+  }
+
+  /** Read the decoded pixel buffer with the ImageIO of the file. */
+  itk::ImageIOBase::Pointer imageIOBase;
+  if( !GetImageIOBase( filename, imageIOBase ) )
+  {
+    errorMessage = "Could not read the header of " + filename;
+    return false;
+  }
+
+  const unsigned int dim = imageIOBase->GetNumberOfDimensions();
+  itk::ImageIORegion region( dim );
+  std::vector<unsigned long> size( dim );
+  for( unsigned int i = 0; i < dim; ++i )
+  {
+    region.SetIndex( i, 0 );
+    region.SetSize( i, imageIOBase->GetDimensions( i ) );
+    size[ i ] = imageIOBase->GetDimensions( i );
+  }
+
+  std::vector<unsigned char> buffer(
+    static_cast<std::size_t>( imageIOBase->GetImageSizeInBytes() ) );
+  try
+  {
+    imageIOBase->SetIORegion( region );
+    imageIOBase->Read( buffer.empty() ? 0 : &buffer[ 0 ] );
+  }
+  catch( itk::ExceptionObject & excp )
+  {
+    std::stringstream ss;
+    ss << excp;
+    errorMessage = ss.str();
+    return false;
+  }
+
+  checksum = GetPixelBufferChecksum( buffer.empty() ? 0 : &buffer[ 0 ],
+    buffer.size(), size,
+    imageIOBase->GetComponentTypeAsString( imageIOBase->GetComponentType() ),
+    imageIOBase->GetNumberOfComponents() );
+
+  /** Failing to write the cache file is not an error. */
+  if( useCacheFile )
+  {
+    std::ofstream cacheFile( ( filename + ".checksum" ).c_str() );
+    cacheFile << checksum << " "
+      << itksys::SystemTools::FileLength( filename.c_str() ) << " "
+      << itksys::SystemTools::ModifiedTime( filename.c_str() ) << "\n";
+  }
+
+  return true;
+
+} // end GetImageChecksum()
+
+
+/**
+ * ***************** GetPixelBufferChecksum ************************
+ */
+
+std::string GetPixelBufferChecksum(
+  const void * buffer,
+  const std::size_t numberOfBytes,
+  const std::vector<unsigned long> & size,
+  const std::string & componentType,
+  const unsigned int numberOfComponents )
+{
+  std::ostringstream description;
+  description << size.size() << " " << componentType << " " << numberOfComponents;
+  for( std::size_t i = 0; i < size.size(); ++i )
+  {
+    description << " " << size[ i ];
+  }
+
+  return ComputeBufferChecksum( static_cast<const unsigned char *>( buffer ),
+    numberOfBytes, description.str() );
+
+} // end GetPixelBufferChecksum()
+
+
+/**
+ * ***************** GetFileChecksum ************************
+ */
+
+bool GetFileChecksum(
+  const std::string & filename,
+  std::string & checksum )
+{
+  std::ifstream file( filename.c_str(), std::ios::binary );
+  if( !file.is_open() ) return false;
+
+  std::vector<unsigned char> buffer(
+    static_cast<std::size_t>( itksys::SystemTools::FileLength( filename.c_str() ) ) );
+  if( !buffer.empty()
+    && !file.read( reinterpret_cast<char *>( &buffer[ 0 ] ), buffer.size() ) )
+  {
+    return false;
+  }
+
+  checksum = ComputeBufferChecksum( buffer.empty() ? 0 : &buffer[ 0 ],
+    buffer.size(), "file" );
+  return true;
+
+} // end GetFileChecksum()
+
+
+/**
+ * ***************** GetStringChecksum ************************
+ */
+
+std::string GetStringChecksum( const std::string & text )
+{
+  return ComputeBufferChecksum(
+    reinterpret_cast<const unsigned char *>( text.c_str() ), text.size(), "string" );
+
+} // end GetStringChecksum()
+
+} // end namespace itktools
@@ -0,0 +1,88 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __ITKToolsChecksum_h_
+#define __ITKToolsChecksum_h_
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+
+namespace itktools
+{
+
+/** Compute a checksum of the pixel data of an image.
+ *
+ * The checksum is taken over the decoded pixel buffer, as the ImageIO of
+ * the file delivers it, together with the dimension, size, component
+ * type and number of components. It is therefore the same for the same
+ * image in different file formats, or compressed and uncompressed, but
+ * differs for a different component type. Geometry (spacing, origin,
+ * direction) is not part of it. The buffer is hashed in fixed chunks of
+ * 1 MB by the threads of the global itk::MultiThreader, and the chunk
+ * hashes are combined in order, so that the result does not depend on
+ * the number of threads. The checksum is 16 hexadecimal digits; it is a
+ * fast 64 bit hash to detect equal images, not a cryptographic one.
+ *
+ * With useCacheFile the checksum is stored in the file filename.checksum,
+ * together with the size and modification time of filename, and taken
+ * from there as long as those did not change. Note that for formats with
+ * a separate data file, like mhd/raw, only the header file is checked.
+ *
+ * Returns false, with an error message, if the image could not be read.
+ */
+bool GetImageChecksum(
+  const std::string & filename,
+  const bool useCacheFile,
+  std::string & checksum,
+  std::string & errorMessage );
+
+/** Get a checksum from the cache file of filename. Returns false if
+ * there is none, or if filename changed since it was written.
+ */
+bool GetCachedImageChecksum(
+  const std::string & filename,
+  std::string & checksum );
+
+/** Compute the checksum of a decoded pixel buffer, of the given size per
+ * dimension, component type, e.g. "short", and number of components. It
+ * equals the checksum of GetImageChecksum() for an image file whose
+ * ImageIO delivers this buffer, so an image that was read without a cast
+ * can be checked without reading the file again.
+ */
+std::string GetPixelBufferChecksum(
+  const void * buffer,
+  const std::size_t numberOfBytes,
+  const std::vector<unsigned long> & size,
+  const std::string & componentType,
+  const unsigned int numberOfComponents );
+
+/** Compute a checksum of the bytes of any file, e.g. a parameter file or
+ * an executable, with the same hash as GetImageChecksum(). Returns false
+ * if the file could not be read.
+ */
+bool GetFileChecksum(
+  const std::string & filename,
+  std::string & checksum );
+
+/** Compute a checksum of a string, with the same hash. */
+std::string GetStringChecksum( const std::string & text );
+
+} // end namespace itktools
+
+#endif // end #ifndef __ITKToolsChecksum_h_
@@ -0,0 +1,274 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#include "ITKToolsColumnReader.h"
+#include "ITKToolsMemoryMapping.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+
+namespace itktools
+{
+
+/** Exact powers of ten, for the fast path of ParseNumber(). */
+static const double ExactPowersOfTen[] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+
+/**
+ * ***************** IsBlank ************************
+ */
+
+static inline bool IsBlank( const char c )
+{
+  return c == ' ' || c == '\t' || c == '\r';
+
+} // end IsBlank()
+
+
+/**
+ * ***************** ParseNumber ************************
+ *
+ * Parse the number in [begin, end). Numbers with at most 15 significant
+ * digits and a small exponent, like most exported data, are exact as the
+ * product or quotient of two exactly representable doubles. Other numbers,
+ * and nan and inf, are parsed by strtod() on a copy of the token; ITKTools
+ * does not change the C locale, so that also uses a '.' decimal point.
+ */
+
+bool ParseNumber( const char * begin, const char * end, double & value )
+{
+  const char * p = begin;
+  bool negative = false;
+  if( p != end && ( *p == '-' || *p == '+' ) )
+  {
+    negative = *p == '-';
+    ++p;
+  }
+
+  /** The significant digits and the decimal exponent. */
+  unsigned long long mantissa = 0;
+  int numberOfDigits = 0;
+  int exponent = 0;
+  bool anyDigit = false;
+  for( ; p != end && *p >= '0' && *p <= '9'; ++p )
+  {
+    anyDigit = true;
+    if( mantissa == 0 && *p == '0' ) continue;
+    if( numberOfDigits < 19 )
+    {
+      mantissa = mantissa * 10 + ( *p - '0' );
+      ++numberOfDigits;
+    }
+    else ++exponent;
+  }
+  if( p != end && *p == '.' )
+  {
+    for( ++p; p != end && *p >= '0' && *p <= '9'; ++p )
+    {
+      anyDigit = true;
+      if( mantissa == 0 && *p == '0' )
+      {
+        --exponent;
+        continue;
+      }
+      if( numberOfDigits < 19 )
+      {
+        mantissa = mantissa * 10 + ( *p - '0' );
+        ++numberOfDigits;
+        --exponent;
+      }
+    }
+  }
+  if( anyDigit && p != end && ( *p == 'e' || *p == 'E' ) )
+  {
+    const char * q = p + 1;
+    bool negativeExponent = false;
+    if( q != end && ( *q == '-' || *q == '+' ) )
+    {
+      negativeExponent = *q == '-';
+      ++q;
+    }
+    if( q != end && *q >= '0' && *q <= '9' )
+    {
+      int explicitExponent = 0;
+      for( ; q != end && *q >= '0' && *q <= '9'; ++q )
+      {
+        if( explicitExponent < 100000 ) explicitExponent = explicitExponent * 10 + ( *q - '0' );
+      }
+      exponent += negativeExponent ? -explicitExponent : explicitExponent;
+      p = q;
+    }
+  }
+
+  /** The fast path. */
+  if( anyDigit && p == end && numberOfDigits <= 15
+    && exponent >= -22 && exponent <= 22 )
+  {
+    value = static_cast<double>( mantissa );
+    value = exponent < 0 ? value / ExactPowersOfTen[ -exponent ]
+      : value * ExactPowersOfTen[ exponent ];
+    if( negative ) value = -value;
+    return true;
+  }
+
+  /** The slow path. */
+  char buffer[ 128 ];
+  const std::size_t length = static_cast<std::size_t>( end - begin );
+  if( length >= sizeof( buffer ) ) return false;
+  std::memcpy( buffer, begin, length );
+  buffer[ length ] = '\0';
+  char * parsedEnd = 0;
+  value = std::strtod( buffer, &parsedEnd );
+  return length > 0 && parsedEnd == buffer + length;
+
+} // end ParseNumber()
+
+
+/**
+ * ***************** ReadNumericColumns ************************
+ */
+
+bool ReadNumericColumns(
+  const std::string & fileName,
+  const std::vector<unsigned int> & columns,
+  std::vector< std::vector<double> > & columnData,
+  unsigned int & numberOfColumns )
+{
+  columnData.clear();
+  numberOfColumns = 0;
+
+  /** Map the file, or read it if that fails, e.g. for an empty file. */
+  MemoryMappedFile mappedFile;
+  std::string contents;
+  const char * begin = 0;
+  const char * end = 0;
+  if( mappedFile.Open( fileName ) )
+  {
+    begin = mappedFile.GetPointer();
+    end = begin + mappedFile.GetSize();
+  }
+  else
+  {
+    std::ifstream file( fileName.c_str(), std::ios::in | std::ios::binary );
+    if( !file.is_open() )
+    {
+      std::cerr << "ERROR: Could not open \"" << fileName << "\"." << std::endl;
+      return false;
+    }
+    contents.assign( std::istreambuf_iterator<char>( file ),
+      std::istreambuf_iterator<char>() );
+    begin = contents.data();
+    end = begin + contents.size();
+  }
+
+  /** Count the columns of the first non-empty line. */
+  const char * p = begin;
+  while( p != end )
+  {
+    const char * lineEnd = std::find( p, end, '\n' );
+    for( const char * q = p; q != lineEnd; )
+    {
+      while( q != lineEnd && IsBlank( *q ) ) ++q;
+      if( q == lineEnd ) break;
+      while( q != lineEnd && !IsBlank( *q ) ) ++q;
+      ++numberOfColumns;
+    }
+    if( numberOfColumns > 0 ) break;
+    p = lineEnd == end ? end : lineEnd + 1;
+  }
+
+  /** Determine where every column is stored, -1 for columns that are skipped. */
+  std::vector<unsigned int> selectedColumns = columns;
+  if( selectedColumns.empty() )
+  {
+    for( unsigned int i = 0; i < numberOfColumns; ++i ) selectedColumns.push_back( i );
+  }
+  unsigned int requiredColumns = 0;
+  for( std::size_t i = 0; i < selectedColumns.size(); ++i )
+  {
+    requiredColumns = std::max( requiredColumns, selectedColumns[ i ] + 1 );
+  }
+  if( requiredColumns > numberOfColumns )
+  {
+    std::cerr << "ERROR: Requesting an unexisting column. There are only "
+      << numberOfColumns << " columns in \"" << fileName << "\"." << std::endl;
+    return false;
+  }
+  std::vector<int> slots( requiredColumns, -1 );
+  for( std::size_t i = 0; i < selectedColumns.size(); ++i )
+  {
+    slots[ selectedColumns[ i ] ] = static_cast<int>( i );
+  }
+
+  /** Reserve one value per line. */
+  const std::size_t numberOfLines = std::count( begin, end, '\n' ) + 1;
+  columnData.resize( selectedColumns.size() );
+  for( std::size_t i = 0; i < columnData.size(); ++i )
+  {
+    columnData[ i ].reserve( numberOfLines );
+  }
+
+  /** Parse the lines. */
+  std::size_t lineNumber = 0;
+  for( p = begin; p != end; )
+  {
+    const char * lineEnd = std::find( p, end, '\n' );
+    ++lineNumber;
+
+    unsigned int column = 0;
+    for( const char * q = p; q != lineEnd && column < requiredColumns; ++column )
+    {
+      while( q != lineEnd && IsBlank( *q ) ) ++q;
+      if( q == lineEnd ) break;
+      const char * tokenBegin = q;
+      while( q != lineEnd && !IsBlank( *q ) ) ++q;
+
+      if( slots[ column ] < 0 ) continue;
+      double value = 0.0;
+      if( !ParseNumber( tokenBegin, q, value ) )
+      {
+        std::cerr << "ERROR: \"" << std::string( tokenBegin, q )
+          << "\" on line " << lineNumber << " of \"" << fileName
+          << "\" is not a number." << std::endl;
+        return false;
+      }
+      columnData[ slots[ column ] ].push_back( value );
+    }
+
+    /** Skip empty lines, and check that the others are complete. */
+    if( column > 0 && column < requiredColumns )
+    {
+      std::cerr << "ERROR: Line " << lineNumber << " of \"" << fileName
+        << "\" has only " << column << " columns." << std::endl;
+      return false;
+    }
+
+    p = lineEnd == end ? end : lineEnd + 1;
+  }
+
+  return true;
+
+} // end ReadNumericColumns()
+
+} // end namespace itktools
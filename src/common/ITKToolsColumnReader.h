@@ -0,0 +1,55 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __ITKToolsColumnReader_h_
+#define __ITKToolsColumnReader_h_
+
+#include <string>
+#include <vector>
+
+
+namespace itktools
+{
+
+/** Read numeric columns from a text file.
+ * The columns are separated by spaces or tabs, and the file should not
+ * contain text or headers; empty lines are skipped. The file is memory
+ * mapped when possible, and the numbers are parsed without iostreams, so
+ * independent of the locale.
+ *
+ * Only the requested columns are parsed and returned, columnData[ i ]
+ * holding the values of columns[ i ]. If columns is empty, all columns
+ * of the first line are returned. numberOfColumns is set to the number
+ * of columns of the first line.
+ * Errors, like a line that lacks a requested column or a value that is
+ * not a number, are reported on std::cerr, and false is returned.
+ */
+bool ReadNumericColumns(
+  const std::string & fileName,
+  const std::vector<unsigned int> & columns,
+  std::vector< std::vector<double> > & columnData,
+  unsigned int & numberOfColumns );
+
+
+/** Parse the number in [begin, end), the complete token, independent of
+ * the locale. Returns false if the token is not a number.
+ */
+bool ParseNumber( const char * begin, const char * end, double & value );
+
+} // end namespace itktools
+
+#endif // end #ifndef __ITKToolsColumnReader_h_
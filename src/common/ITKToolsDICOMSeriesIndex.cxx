@@ -0,0 +1,596 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#include "ITKToolsDICOMSeriesIndex.h"
+
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
+#include <itksys/Directory.hxx>
+#include <itksys/SystemTools.hxx>
+
+#include "gdcmReader.h"
+#include "gdcmStringFilter.h"
+#include "gdcmTag.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+
+namespace itktools
+{
+
+/** The first line of an index file. */
+static const char * DICOMSeriesIndexHeader = "# ITKTools DICOM series index 1";
+
+/** The tags that are always parsed, besides those of the identifier. */
+static const gdcm::Tag SeriesInstanceUIDTag( 0x0020, 0x000e );
+static const gdcm::Tag InstanceNumberTag( 0x0020, 0x0013 );
+static const gdcm::Tag ImagePositionTag( 0x0020, 0x0032 );
+static const gdcm::Tag ImageOrientationTag( 0x0020, 0x0037 );
+
+
+/**
+ * ***************** KeepCharacters ************************
+ *
+ * Keep only the characters for which keep() is true, e.g. to strip the
+ * padding of DICOM values, and tabs that would break the index file.
+ */
+
+static std::string KeepCharacters( const std::string & value, bool ( * keep )( char ) )
+{
+  std::string result;
+  result.reserve( value.size() );
+  for( std::size_t i = 0; i < value.size(); ++i )
+  {
+    if( keep( value[ i ] ) ) result += value[ i ];
+  }
+  return result;
+
+} // end KeepCharacters()
+
+
+static bool IsIdentifierCharacter( char c )
+{
+  return c == '.' || ( c >= 'a' && c <= 'z' )
+    || ( c >= 'A' && c <= 'Z' ) || ( c >= '0' && c <= '9' );
+}
+
+
+static bool IsNumberCharacter( char c )
+{
+  return c == '.' || c == '-' || c == '+' || c == 'e' || c == 'E'
+    || c == '\\' || ( c >= '0' && c <= '9' );
+}
+
+
+/**
+ * ***************** ParseMultiValue ************************
+ *
+ * Parse a backslash separated value like "1\0\0". Returns false if it
+ * does not hold exactly numberOfValues numbers.
+ */
+
+static bool ParseMultiValue( const std::string & value,
+  std::size_t numberOfValues, std::vector<double> & values )
+{
+  values.clear();
+  std::istringstream stream( value );
+  std::string item;
+  while( std::getline( stream, item, '\\' ) )
+  {
+    char * end = 0;
+    const double number = std::strtod( item.c_str(), &end );
+    if( item.empty() || *end != '\0' ) return false;
+    values.push_back( number );
+  }
+  return values.size() == numberOfValues;
+
+} // end ParseMultiValue()
+
+
+/**
+ * ***************** Constructor ************************
+ */
+
+DICOMSeriesIndex
+::DICOMSeriesIndex()
+{
+  /** The series details of GDCMSeriesFileNames: series number, sequence
+   * name, slice thickness, rows and columns.
+   */
+  this->m_IdentifierTags.push_back( "0020|0011" );
+  this->m_IdentifierTags.push_back( "0018|0024" );
+  this->m_IdentifierTags.push_back( "0018|0050" );
+  this->m_IdentifierTags.push_back( "0028|0010" );
+  this->m_IdentifierTags.push_back( "0028|0011" );
+
+  this->m_NumberOfThreads = 0;
+  this->m_NumberOfParsedFiles = 0;
+
+} // end Constructor
+
+
+/**
+ * ***************** Set functions ************************
+ */
+
+void
+DICOMSeriesIndex
+::SetDirectory( const std::string & directory )
+{
+  this->m_Directory = directory;
+}
+
+
+void
+DICOMSeriesIndex
+::AddSeriesRestriction( const std::string & tag )
+{
+  this->m_IdentifierTags.push_back( tag );
+}
+
+
+void
+DICOMSeriesIndex
+::SetIndexFileName( const std::string & indexFileName )
+{
+  this->m_IndexFileName = indexFileName;
+}
+
+
+void
+DICOMSeriesIndex
+::SetNumberOfThreads( unsigned int numberOfThreads )
+{
+  this->m_NumberOfThreads = numberOfThreads;
+}
+
+
+/**
+ * ***************** ParseFile ************************
+ */
+
+void
+DICOMSeriesIndex
+::ParseFile( FileEntry & entry, const std::vector<std::string> & identifierTags )
+{
+  entry.InstanceNumber = 0;
+  entry.ImagePosition = "";
+  entry.ImageOrientation = "";
+  entry.SeriesIdentifier = "";
+
+  /** Read only the tags we need; reading stops after the last of them,
+   * so well before the pixel data.
+   */
+  std::vector<gdcm::Tag> tags( identifierTags.size() );
+  std::set<gdcm::Tag> selectedTags;
+  for( std::size_t i = 0; i < identifierTags.size(); ++i )
+  {
+    tags[ i ].ReadFromPipeSeparatedString( identifierTags[ i ].c_str() );
+    selectedTags.insert( tags[ i ] );
+  }
+  selectedTags.insert( SeriesInstanceUIDTag );
+  selectedTags.insert( InstanceNumberTag );
+  selectedTags.insert( ImagePositionTag );
+  selectedTags.insert( ImageOrientationTag );
+
+  gdcm::Reader reader;
+  reader.SetFileName( entry.FileName.c_str() );
+  if( !reader.ReadSelectedTags( selectedTags ) ) return;
+  const gdcm::DataSet & dataSet = reader.GetFile().GetDataSet();
+  if( !dataSet.FindDataElement( SeriesInstanceUIDTag ) ) return;
+
+  gdcm::StringFilter stringFilter;
+  stringFilter.SetFile( reader.GetFile() );
+
+  /** The series identifier, built as GDCMSeriesFileNames does. */
+  const std::string uid = stringFilter.ToString( SeriesInstanceUIDTag );
+  std::string identifier = uid;
+  for( std::size_t i = 0; i < tags.size(); ++i )
+  {
+    std::string value = "";
+    if( dataSet.FindDataElement( tags[ i ] ) )
+    {
+      value = stringFilter.ToString( tags[ i ] );
+    }
+    if( identifier == uid && !value.empty() ) identifier += ".";
+    identifier += value;
+  }
+  entry.SeriesIdentifier = KeepCharacters( identifier, IsIdentifierCharacter );
+
+  /** The values for the ordering of the slices. */
+  if( dataSet.FindDataElement( InstanceNumberTag ) )
+  {
+    entry.InstanceNumber = std::atol( stringFilter.ToString( InstanceNumberTag ).c_str() );
+  }
+  if( dataSet.FindDataElement( ImagePositionTag ) )
+  {
+    entry.ImagePosition = KeepCharacters(
+      stringFilter.ToString( ImagePositionTag ), IsNumberCharacter );
+  }
+  if( dataSet.FindDataElement( ImageOrientationTag ) )
+  {
+    entry.ImageOrientation = KeepCharacters(
+      stringFilter.ToString( ImageOrientationTag ), IsNumberCharacter );
+  }
+
+} // end ParseFile()
+
+
+/** The data shared by the threads of Update(). */
+struct DICOMSeriesIndexThreadStruct
+{
+  std::vector<DICOMSeriesIndex::FileEntry> *                    Entries;
+  const std::map<std::string, DICOMSeriesIndex::FileEntry> *    IndexedEntries;
+  const std::vector<std::string> *                              IdentifierTags;
+  std::size_t                                                   NextEntry;
+  std::size_t                                                   NumberOfParsedFiles;
+  itk::SimpleFastMutexLock                                      Mutex;
+};
+
+
+/**
+ * ***************** UpdateEntry ************************
+ *
+ * Take the entry from the index if the file did not change, and parse
+ * the file otherwise. Returns true if the file was parsed.
+ */
+
+static bool UpdateEntry( DICOMSeriesIndex::FileEntry & entry,
+  const std::map<std::string, DICOMSeriesIndex::FileEntry> & indexedEntries,
+  const std::vector<std::string> & identifierTags )
+{
+  entry.ModificationTime = itksys::SystemTools::ModifiedTime( entry.FileName.c_str() );
+  entry.FileSize = itksys::SystemTools::FileLength( entry.FileName.c_str() );
+
+  std::map<std::string, DICOMSeriesIndex::FileEntry>::const_iterator it
+    = indexedEntries.find( itksys::SystemTools::GetFilenameName( entry.FileName ) );
+  if( it != indexedEntries.end()
+    && it->second.ModificationTime == entry.ModificationTime
+    && it->second.FileSize == entry.FileSize )
+  {
+    entry.InstanceNumber = it->second.InstanceNumber;
+    entry.ImagePosition = it->second.ImagePosition;
+    entry.ImageOrientation = it->second.ImageOrientation;
+    entry.SeriesIdentifier = it->second.SeriesIdentifier;
+    return false;
+  }
+
+  DICOMSeriesIndex::ParseFile( entry, identifierTags );
+  return true;
+
+} // end UpdateEntry()
+
+
+static ITK_THREAD_RETURN_TYPE DICOMSeriesIndexThreaderCallback( void * arg )
+{
+  itk::MultiThreader::ThreadInfoStruct * info
+    = static_cast<itk::MultiThreader::ThreadInfoStruct *>( arg );
+  DICOMSeriesIndexThreadStruct * data
+    = static_cast<DICOMSeriesIndexThreadStruct *>( info->UserData );
+
+  /** Every thread takes the next chunk of files until none is left. */
+  const std::size_t chunkSize = 64;
+  const std::size_t numberOfEntries = data->Entries->size();
+  while( true )
+  {
+    data->Mutex.Lock();
+    const std::size_t begin = data->NextEntry;
+    data->NextEntry += chunkSize;
+    data->Mutex.Unlock();
+    if( begin >= numberOfEntries ) break;
+
+    const std::size_t end = std::min( begin + chunkSize, numberOfEntries );
+    std::size_t numberOfParsedFiles = 0;
+    for( std::size_t i = begin; i < end; ++i )
+    {
+      if( UpdateEntry( ( *data->Entries )[ i ],
+        *data->IndexedEntries, *data->IdentifierTags ) )
+      {
+        ++numberOfParsedFiles;
+      }
+    }
+
+    data->Mutex.Lock();
+    data->NumberOfParsedFiles += numberOfParsedFiles;
+    data->Mutex.Unlock();
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end DICOMSeriesIndexThreaderCallback()
+
+
+/**
+ * ***************** Update ************************
+ */
+
+bool
+DICOMSeriesIndex
+::Update( std::string & errorMessage )
+{
+  this->m_Entries.clear();
+  this->m_NumberOfParsedFiles = 0;
+
+  /** List the files of the directory. */
+  itksys::Directory directory;
+  if( !directory.Load( this->m_Directory.c_str() ) )
+  {
+    errorMessage = "ERROR: could not read the directory " + this->m_Directory + ".";
+    return false;
+  }
+  std::vector<std::string> fileNames;
+  for( unsigned long i = 0; i < directory.GetNumberOfFiles(); ++i )
+  {
+    const std::string fileName = this->m_Directory + "/" + directory.GetFile( i );
+    if( !itksys::SystemTools::FileIsDirectory( fileName.c_str() ) )
+    {
+      fileNames.push_back( fileName );
+    }
+  }
+  std::sort( fileNames.begin(), fileNames.end() );
+  if( fileNames.empty() ) return true;
+
+  /** The entries of the index, if any. */
+  std::map<std::string, FileEntry> indexedEntries;
+  if( !this->m_IndexFileName.empty() )
+  {
+    this->ReadIndex( indexedEntries );
+  }
+
+  this->m_Entries.resize( fileNames.size() );
+  for( std::size_t i = 0; i < fileNames.size(); ++i )
+  {
+    this->m_Entries[ i ].FileName = fileNames[ i ];
+  }
+
+  /** Update the first entry in this thread, so that GDCM is set up
+   * before the other threads use it, and the others in parallel.
+   */
+  DICOMSeriesIndexThreadStruct data;
+  data.Entries = &this->m_Entries;
+  data.IndexedEntries = &indexedEntries;
+  data.IdentifierTags = &this->m_IdentifierTags;
+  data.NextEntry = 1;
+  data.NumberOfParsedFiles = UpdateEntry(
+    this->m_Entries[ 0 ], indexedEntries, this->m_IdentifierTags ) ? 1 : 0;
+
+  if( this->m_Entries.size() > 1 )
+  {
+    unsigned int numberOfThreads = this->m_NumberOfThreads > 0
+      ? this->m_NumberOfThreads : itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+    numberOfThreads = std::min( numberOfThreads, static_cast<unsigned int>( ITK_MAX_THREADS ) );
+
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    threader->SetNumberOfThreads( numberOfThreads );
+    threader->SetSingleMethod( DICOMSeriesIndexThreaderCallback, &data );
+    threader->SingleMethodExecute();
+  }
+  this->m_NumberOfParsedFiles = data.NumberOfParsedFiles;
+
+  /** Rewrite the index if files changed, appeared or disappeared. */
+  const std::size_t numberOfReusedFiles
+    = this->m_Entries.size() - this->m_NumberOfParsedFiles;
+  if( !this->m_IndexFileName.empty()
+    && ( this->m_NumberOfParsedFiles > 0 || numberOfReusedFiles != indexedEntries.size() ) )
+  {
+    return this->WriteIndex( errorMessage );
+  }
+
+  return true;
+
+} // end Update()
+
+
+/**
+ * ***************** ReadIndex ************************
+ */
+
+bool
+DICOMSeriesIndex
+::ReadIndex( std::map<std::string, FileEntry> & entries ) const
+{
+  std::ifstream index( this->m_IndexFileName.c_str() );
+  if( !index.is_open() ) return false;
+
+  /** An index made with other identifier tags is of no use. */
+  std::string tagsLine = "# tags";
+  for( std::size_t i = 0; i < this->m_IdentifierTags.size(); ++i )
+  {
+    tagsLine += " " + this->m_IdentifierTags[ i ];
+  }
+  std::string line;
+  if( !std::getline( index, line ) || line != DICOMSeriesIndexHeader ) return false;
+  if( !std::getline( index, line ) || line != tagsLine ) return false;
+
+  while( std::getline( index, line ) )
+  {
+    std::istringstream fields( line );
+    std::string modificationTime, fileSize, instanceNumber;
+    FileEntry entry;
+    if( !std::getline( fields, modificationTime, '\t' )
+      || !std::getline( fields, fileSize, '\t' )
+      || !std::getline( fields, instanceNumber, '\t' )
+      || !std::getline( fields, entry.ImagePosition, '\t' )
+      || !std::getline( fields, entry.ImageOrientation, '\t' )
+      || !std::getline( fields, entry.SeriesIdentifier, '\t' )
+      || !std::getline( fields, entry.FileName ) )
+    {
+      continue;
+    }
+    entry.ModificationTime = std::atol( modificationTime.c_str() );
+    entry.FileSize = std::strtoul( fileSize.c_str(), 0, 10 );
+    entry.InstanceNumber = std::atol( instanceNumber.c_str() );
+    entries[ entry.FileName ] = entry;
+  }
+
+  return true;
+
+} // end ReadIndex()
+
+
+/**
+ * ***************** WriteIndex ************************
+ */
+
+bool
+DICOMSeriesIndex
+::WriteIndex( std::string & errorMessage ) const
+{
+  std::ofstream index( this->m_IndexFileName.c_str() );
+  if( !index.is_open() )
+  {
+    errorMessage = "ERROR: could not write the index " + this->m_IndexFileName + ".";
+    return false;
+  }
+
+  index << DICOMSeriesIndexHeader << "\n# tags";
+  for( std::size_t i = 0; i < this->m_IdentifierTags.size(); ++i )
+  {
+    index << " " << this->m_IdentifierTags[ i ];
+  }
+  index << "\n";
+
+  /** The file names are stored relative to the directory, so that the
+   * index remains valid when the directory is given differently.
+   */
+  for( std::size_t i = 0; i < this->m_Entries.size(); ++i )
+  {
+    const FileEntry & entry = this->m_Entries[ i ];
+    index << entry.ModificationTime << "\t" << entry.FileSize << "\t"
+      << entry.InstanceNumber << "\t" << entry.ImagePosition << "\t"
+      << entry.ImageOrientation << "\t" << entry.SeriesIdentifier << "\t"
+      << itksys::SystemTools::GetFilenameName( entry.FileName ) << "\n";
+  }
+
+  if( !index.good() )
+  {
+    errorMessage = "ERROR: could not write the index " + this->m_IndexFileName + ".";
+    return false;
+  }
+
+  return true;
+
+} // end WriteIndex()
+
+
+/**
+ * ***************** GetSeriesIdentifiers ************************
+ */
+
+std::vector<std::string>
+DICOMSeriesIndex
+::GetSeriesIdentifiers( void ) const
+{
+  std::set<std::string> identifiers;
+  for( std::size_t i = 0; i < this->m_Entries.size(); ++i )
+  {
+    if( !this->m_Entries[ i ].SeriesIdentifier.empty() )
+    {
+      identifiers.insert( this->m_Entries[ i ].SeriesIdentifier );
+    }
+  }
+
+  return std::vector<std::string>( identifiers.begin(), identifiers.end() );
+
+} // end GetSeriesIdentifiers()
+
+
+/**
+ * ***************** GetFileNames ************************
+ */
+
+/** A file with its sort key. */
+typedef std::pair<double, std::string> SortedFileType;
+
+std::vector<std::string>
+DICOMSeriesIndex
+::GetFileNames( const std::string & seriesIdentifier ) const
+{
+  /** The first series by default. */
+  std::string identifier = seriesIdentifier;
+  if( identifier.empty() )
+  {
+    const std::vector<std::string> identifiers = this->GetSeriesIdentifiers();
+    if( identifiers.empty() ) return std::vector<std::string>();
+    identifier = identifiers[ 0 ];
+  }
+
+  std::vector<const FileEntry *> entries;
+  for( std::size_t i = 0; i < this->m_Entries.size(); ++i )
+  {
+    if( this->m_Entries[ i ].SeriesIdentifier == identifier )
+    {
+      entries.push_back( &this->m_Entries[ i ] );
+    }
+  }
+  if( entries.empty() ) return std::vector<std::string>();
+
+  /** Order along the normal of the first slice, if all slices have a
+   * position and the positions differ.
+   */
+  std::vector<SortedFileType> sortedFiles( entries.size() );
+  std::vector<double> orientation, position;
+  bool sorted = ParseMultiValue( entries[ 0 ]->ImageOrientation, 6, orientation );
+  if( sorted )
+  {
+    const double normal[ 3 ] = {
+      orientation[ 1 ] * orientation[ 5 ] - orientation[ 2 ] * orientation[ 4 ],
+      orientation[ 2 ] * orientation[ 3 ] - orientation[ 0 ] * orientation[ 5 ],
+      orientation[ 0 ] * orientation[ 4 ] - orientation[ 1 ] * orientation[ 3 ] };
+    for( std::size_t i = 0; i < entries.size() && sorted; ++i )
+    {
+      sorted = ParseMultiValue( entries[ i ]->ImagePosition, 3, position );
+      if( !sorted ) break;
+      sortedFiles[ i ].first = position[ 0 ] * normal[ 0 ]
+        + position[ 1 ] * normal[ 1 ] + position[ 2 ] * normal[ 2 ];
+      sortedFiles[ i ].second = entries[ i ]->FileName;
+    }
+  }
+  if( sorted )
+  {
+    std::sort( sortedFiles.begin(), sortedFiles.end() );
+    sorted = std::abs( sortedFiles.back().first - sortedFiles.front().first ) > 1e-6
+      || entries.size() == 1;
+  }
+
+  /** Otherwise order by instance number, and finally by file name. */
+  if( !sorted )
+  {
+    for( std::size_t i = 0; i < entries.size(); ++i )
+    {
+      sortedFiles[ i ].first = static_cast<double>( entries[ i ]->InstanceNumber );
+      sortedFiles[ i ].second = entries[ i ]->FileName;
+    }
+    std::sort( sortedFiles.begin(), sortedFiles.end() );
+  }
+
+  std::vector<std::string> fileNames( sortedFiles.size() );
+  for( std::size_t i = 0; i < sortedFiles.size(); ++i )
+  {
+    fileNames[ i ] = sortedFiles[ i ].second;
+  }
+
+  return fileNames;
+
+} // end GetFileNames()
+
+} // end namespace itktools
@@ -0,0 +1,137 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __ITKToolsDICOMSeriesIndex_h_
+#define __ITKToolsDICOMSeriesIndex_h_
+
+#include <map>
+#include <string>
+#include <vector>
+
+
+namespace itktools
+{
+
+/** \class DICOMSeriesIndex
+ *
+ * Find the DICOM series in a directory, like itk::GDCMSeriesFileNames with
+ * SetUseSeriesDetails( true ), but much faster for large directories:
+ *  - only the tags needed for the series identifier and the ordering of
+ *    the slices are parsed, and parsing stops before the pixel data,
+ *  - the files are parsed in parallel,
+ *  - optionally, the result is kept in an index file. A next scan of the
+ *    same directory then only compares the modification time and the size
+ *    of every file with the index, and parses new and changed files only.
+ *
+ * The series identifiers are those of GDCMSeriesFileNames: the series
+ * instance UID, followed by the series number, sequence name, slice
+ * thickness, rows, columns, and the values of the extra restrictions,
+ * stripped of all characters but letters, digits and dots. They can thus
+ * be passed to pxcastconvert -s. The files of a series are ordered along
+ * the slice normal, or by instance number, or by file name, like
+ * GDCMSeriesFileNames does.
+ *
+ * The index is a text file, holding one line per file with the tab
+ * separated modification time, size, instance number, image position,
+ * image orientation, series identifier and file name. It is rewritten
+ * whenever files changed, appeared or disappeared.
+ */
+
+class DICOMSeriesIndex
+{
+public:
+
+  /** The part of the header of one file that is stored in the index. */
+  struct FileEntry
+  {
+    std::string   FileName;
+    long          ModificationTime;
+    unsigned long FileSize;
+    long          InstanceNumber;
+    std::string   ImagePosition;
+    std::string   ImageOrientation;
+    /** Empty for files that are not DICOM images. */
+    std::string   SeriesIdentifier;
+  };
+
+  DICOMSeriesIndex();
+  ~DICOMSeriesIndex(){};
+
+  /** The directory to scan; sub directories are not scanned. */
+  void SetDirectory( const std::string & directory );
+
+  /** Add a tag "gggg|eeee" to the series identifier, like
+   * GDCMSeriesFileNames::AddSeriesRestriction().
+   */
+  void AddSeriesRestriction( const std::string & tag );
+
+  /** The index file; none by default, which always parses all files. */
+  void SetIndexFileName( const std::string & indexFileName );
+
+  /** The number of threads that parse files; 0, the default, means the
+   * default number of threads of ITK.
+   */
+  void SetNumberOfThreads( unsigned int numberOfThreads );
+
+  /** Scan the directory, using and updating the index file if given.
+   * Returns false, with an error message, if the directory could not be
+   * read or the index could not be written.
+   */
+  bool Update( std::string & errorMessage );
+
+  /** The sorted identifiers of the series found. */
+  std::vector<std::string> GetSeriesIdentifiers( void ) const;
+
+  /** The ordered files of a series. For "" those of the first series. */
+  std::vector<std::string> GetFileNames( const std::string & seriesIdentifier ) const;
+
+  /** The number of files that were parsed by the last Update(), i.e. that
+   * were not up to date in the index.
+   */
+  std::size_t GetNumberOfParsedFiles( void ) const
+  {
+    return this->m_NumberOfParsedFiles;
+  }
+
+  /** Parse the header of a single file into entry, with the given tags
+   * of the series identifier. Used by the parsing threads.
+   */
+  static void ParseFile( FileEntry & entry, const std::vector<std::string> & identifierTags );
+
+private:
+
+  /** Read the index file into a map from file name to entry. Returns
+   * false if there is none, or if it was made with other identifier tags.
+   */
+  bool ReadIndex( std::map<std::string, FileEntry> & entries ) const;
+
+  /** Write all entries to the index file. */
+  bool WriteIndex( std::string & errorMessage ) const;
+
+  std::string               m_Directory;
+  std::string               m_IndexFileName;
+  std::vector<std::string>  m_IdentifierTags;
+  unsigned int              m_NumberOfThreads;
+
+  std::vector<FileEntry>    m_Entries;
+  std::size_t               m_NumberOfParsedFiles;
+
+}; // end class DICOMSeriesIndex
+
+} // end namespace itktools
+
+#endif // end #ifndef __ITKToolsDICOMSeriesIndex_h_
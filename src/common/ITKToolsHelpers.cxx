@@ -18,6 +18,11 @@
 #include "ITKToolsHelpers.h"
 
 #include "itkImageIOFactory.h"
+#include "itkUseMemoryImageIO.h"
+#include "itkUseMevisDicomTiff.h"
+#ifdef _ITKTOOLS_USE_CHUNKEDDEFLATE
+#include "itkUseChunkedDeflate.h"
+#endif
 
 
 namespace itktools
@@ -33,6 +38,20 @@ std::string GetITKToolsVersion( void )
 } // end GetITKToolsVersion()
 
 
+/**
+ * ***************** RegisterImageIOFactories ************************
+ */
+
+void RegisterImageIOFactories( void )
+{
+  RegisterMemoryImageIO();
+#ifdef _ITKTOOLS_USE_CHUNKEDDEFLATE
+  RegisterChunkedDeflate();
+#endif
+  RegisterMevisDicomTiff();
+} // end RegisterImageIOFactories()
+
+
 /**
  * ******************* StringIsInteger *******************
  */
@@ -314,4 +333,28 @@ bool NumberOfComponentsCheck( const unsigned int & numberOfComponents )
 } // end NumberOfComponentsCheck()
 
 
+/**
+ * *************** GetInternalComponentType ***********************
+ */
+
+bool GetInternalComponentType( itk::CommandLineArgumentParser * parser,
+  itk::ImageIOBase::IOComponentType & internalComponentType )
+{
+  std::string internalType = "double";
+  parser->GetCommandLineArgument( "-internalType", internalType );
+
+  internalComponentType = itk::ImageIOBase::GetComponentTypeFromString( internalType );
+  if( internalComponentType != itk::ImageIOBase::FLOAT
+    && internalComponentType != itk::ImageIOBase::DOUBLE )
+  {
+    std::cerr << "ERROR: -internalType should be float or double, not \""
+      << internalType << "\"." << std::endl;
+    return false;
+  }
+
+  return true;
+
+} // end GetInternalComponentType()
+
+
 } // end itktools namespace
@@ -32,6 +32,13 @@ namespace itktools
 /** Return the version number. */
 std::string GetITKToolsVersion( void );
 
+/** Register the IO factories of the ITKTools image formats: the in-memory
+ * images of MemoryImageIO, the chunked .mhc format when built with
+ * ITKTOOLS_USE_CHUNKEDDEFLATE, and those of RegisterMevisDicomTiff().
+ * Called once by RunToolMain() for every tool.
+ */
+void RegisterImageIOFactories( void );
+
 /** Test if a ComponentType corresponds to the template parameter. */
 template <class T>
 bool IsType( itk::ImageIOBase::IOComponentType ct )
@@ -93,6 +100,13 @@ bool IsFilterSupportedCheck(
 /** NumberOfComponentsCheck. Unify error message printing. */
 bool NumberOfComponentsCheck( const unsigned int & numberOfComponents );
 
+/** Read the internal precision of a numeric tool from the optional
+ * argument [-internalType] float|double; the default is double.
+ * Unify error message printing: returns false for other values.
+ */
+bool GetInternalComponentType( itk::CommandLineArgumentParser * parser,
+  itk::ImageIOBase::IOComponentType & internalComponentType );
+
 } // end itktools namespace
 
 #endif // end #ifndef __ITKToolsHelpers_h_
@@ -19,10 +19,62 @@
 
 #include "itkImage.h"
 #include "itkImageFileReader.h"
+#include "itkMultiThreader.h"
+
+#include <algorithm>
+#include <map>
+#include <sstream>
 
 namespace itktools
 {
 
+/** The cache of ImageIOBase objects, indexed by file name. */
+typedef std::map< std::string, itk::ImageIOBase::Pointer > ImageIOBaseCacheType;
+
+static ImageIOBaseCacheType & GetImageIOBaseCache( void )
+{
+  static ImageIOBaseCacheType imageIOBaseCache;
+  return imageIOBaseCache;
+} // end GetImageIOBaseCache()
+
+
+/** Create the ImageIOBase of a file by reading its header.
+ * Does not use the cache, so that it can be called from several threads.
+ */
+static bool ReadImageIOBase(
+  const std::string & filename,
+  itk::ImageIOBase::Pointer & imageIOBase,
+  std::string & errorMessage )
+{
+  /** Dummy image type. */
+  const unsigned int DummyDimension = 3;
+  typedef short      DummyPixelType;
+  typedef itk::Image< DummyPixelType, DummyDimension >   DummyImageType;
+
+  /** Create a testReader. */
+  typedef itk::ImageFileReader< DummyImageType >     ReaderType;
+  ReaderType::Pointer testReader = ReaderType::New();
+  testReader->SetFileName( filename.c_str() );
+
+  /** Generate all information. */
+  try
+  {
+    testReader->GenerateOutputInformation();
+  }
+  catch( itk::ExceptionObject & excp )
+  {
+    std::stringstream ss;
+    ss << excp;
+    errorMessage = ss.str();
+    return false;
+  }
+
+  imageIOBase = testReader->GetImageIO();
+  return true;
+
+} // end ReadImageIOBase()
+
+
 /**
  * ***************** GetImagePixelType ************************
  */
@@ -66,14 +118,11 @@ bool GetImageComponentType(
 
 itk::ImageIOBase::IOComponentType GetImageComponentType( const std::string & filename )
 {
-  itk::ImageIOBase::Pointer imageIO = itk::ImageIOFactory::CreateImageIO(
-    filename.c_str(), itk::ImageIOFactory::ReadMode);
-  if( imageIO.IsNull() )
+  itk::ImageIOBase::Pointer imageIO;
+  if( !GetImageIOBase( filename, imageIO ) )
   {
     return itk::ImageIOBase::UNKNOWNCOMPONENTTYPE; // complain
   }
-  imageIO->SetFileName( filename.c_str() );
-  imageIO->ReadImageInformation();
 
   return imageIO->GetComponentType();
 
@@ -395,33 +444,138 @@ bool GetImageIOBase(
   const std::string & filename,
   itk::ImageIOBase::Pointer & testImageIOBase )
 {
-  /** Dummy image type. */
-  const unsigned int DummyDimension = 3;
-  typedef short      DummyPixelType;
-  typedef itk::Image< DummyPixelType, DummyDimension >   DummyImageType;
+  /** Reuse the ImageIOBase if this file was seen before. */
+  testImageIOBase = GetCachedImageIOBase( filename );
+  if( testImageIOBase.IsNotNull() ) return true;
 
-  /** Create a testReader. */
-  typedef itk::ImageFileReader< DummyImageType >     ReaderType;
-  ReaderType::Pointer testReader = ReaderType::New();
-  testReader->SetFileName( filename.c_str() );
+  /** Read the header, and store the ImageIO for later use. */
+  std::string errorMessage;
+  if( !ReadImageIOBase( filename, testImageIOBase, errorMessage ) )
+  {
+    std::cerr << "ERROR: Caught ITK exception: " << errorMessage << std::endl;
+    return false;
+  }
+  GetImageIOBaseCache()[ filename ] = testImageIOBase;
 
-  /** Generate all information. */
-  try
+  return true;
+
+} // end GetImageIOBase()
+
+
+/**
+ * ***************** GetCachedImageIOBase ************************
+ */
+
+itk::ImageIOBase::Pointer GetCachedImageIOBase( const std::string & filename )
+{
+  ImageIOBaseCacheType & cache = GetImageIOBaseCache();
+  ImageIOBaseCacheType::const_iterator it = cache.find( filename );
+  if( it == cache.end() ) return 0;
+
+  return it->second;
+
+} // end GetCachedImageIOBase()
+
+
+/**
+ * ***************** ValidateImageHeaders ************************
+ */
+
+/** The data shared by the threads of ValidateImageHeaders(). */
+struct ValidateImageHeadersStruct
+{
+  std::vector<std::string>                m_FileNames;
+  std::vector<itk::ImageIOBase::Pointer>  m_ImageIOBases;
+  std::vector<std::string>                m_ErrorMessages;
+};
+
+static ITK_THREAD_RETURN_TYPE ValidateImageHeadersThreaderCallback( void * arg )
+{
+  itk::MultiThreader::ThreadInfoStruct * info
+    = static_cast<itk::MultiThreader::ThreadInfoStruct *>( arg );
+  ValidateImageHeadersStruct * data
+    = static_cast<ValidateImageHeadersStruct *>( info->UserData );
+
+  /** Every thread reads the headers of every NumberOfThreads-th file.
+   * The first file was already read before starting the threads.
+   */
+  for( std::size_t i = 1 + info->ThreadID; i < data->m_FileNames.size();
+    i += info->NumberOfThreads )
   {
-    testReader->GenerateOutputInformation();
+    ReadImageIOBase( data->m_FileNames[ i ],
+      data->m_ImageIOBases[ i ], data->m_ErrorMessages[ i ] );
   }
-  catch( itk::ExceptionObject & excp )
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end ValidateImageHeadersThreaderCallback()
+
+
+bool ValidateImageHeaders( const std::vector<std::string> & filenames )
+{
+  /** Gather the files that are not in the cache yet. */
+  ValidateImageHeadersStruct data;
+  for( std::size_t i = 0; i < filenames.size(); ++i )
   {
-    std::cerr << "ERROR: Caught ITK exception: " << excp << std::endl;
-    return false;
+    if( GetCachedImageIOBase( filenames[ i ] ).IsNull() )
+    {
+      data.m_FileNames.push_back( filenames[ i ] );
+    }
+  }
+  if( data.m_FileNames.empty() ) return true;
+  data.m_ImageIOBases.resize( data.m_FileNames.size() );
+  data.m_ErrorMessages.resize( data.m_FileNames.size() );
+
+  /** Read the first header in this thread, so that the ImageIO factories
+   * are registered before the other threads use them.
+   */
+  ReadImageIOBase( data.m_FileNames[ 0 ],
+    data.m_ImageIOBases[ 0 ], data.m_ErrorMessages[ 0 ] );
+
+  /** Read the other headers in parallel. Reading a header is mostly
+   * waiting for the file system, so this pays off on network storage.
+   */
+  if( data.m_FileNames.size() > 1 )
+  {
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    const std::size_t numberOfThreads = std::min<std::size_t>(
+      data.m_FileNames.size() - 1, itk::MultiThreader::GetGlobalDefaultNumberOfThreads() );
+    threader->SetNumberOfThreads( static_cast<itk::ThreadIdType>( numberOfThreads ) );
+    threader->SetSingleMethod( ValidateImageHeadersThreaderCallback, &data );
+    threader->SingleMethodExecute();
+  }
+
+  /** Cache the results and report all failures. */
+  bool success = true;
+  for( std::size_t i = 0; i < data.m_FileNames.size(); ++i )
+  {
+    if( data.m_ImageIOBases[ i ].IsNull() )
+    {
+      std::cerr << "ERROR: Could not read the header of \""
+        << data.m_FileNames[ i ] << "\": "
+        << data.m_ErrorMessages[ i ] << std::endl;
+      success = false;
+    }
+    else
+    {
+      GetImageIOBaseCache()[ data.m_FileNames[ i ] ] = data.m_ImageIOBases[ i ];
+    }
   }
 
-  /** Extract the ImageIO from the testReader. */
-  testImageIOBase = testReader->GetImageIO();
+  return success;
+
+} // end ValidateImageHeaders()
 
-  return true;
 
-} // end GetImageProperties()
+/**
+ * ***************** ClearImageIOBaseCache ************************
+ */
+
+void ClearImageIOBaseCache( void )
+{
+  GetImageIOBaseCache().clear();
+
+} // end ClearImageIOBaseCache()
 
 
 /**
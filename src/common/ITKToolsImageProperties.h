@@ -19,6 +19,7 @@
 #define __ITKToolsImageProperties_h_
 
 #include <string>
+#include <vector>
 #include "itkImageIOBase.h"
 
 
@@ -146,11 +147,47 @@ int GetImageProperties(
   std::vector<double> & origin,
   std::vector<double> & direction );
 
-/** Determine image properties, returning an ImageIOBase. */
+/** Determine image properties, returning an ImageIOBase.
+ * The resulting ImageIOBase is cached, so that asking for the
+ * properties of the same file again does not re-open the file.
+ */
 bool GetImageIOBase(
   const std::string & filename,
   itk::ImageIOBase::Pointer & imageIOBase );
 
+/** Get the ImageIOBase that was created for filename by an earlier
+ * call to GetImageIOBase(). Returns a null pointer if there is none.
+ */
+itk::ImageIOBase::Pointer GetCachedImageIOBase( const std::string & filename );
+
+/** Read the headers of many files in parallel, and cache their ImageIOBase,
+ * e.g. to validate a long list of inputs before processing starts.
+ * All files that cannot be read are reported. Returns false if any failed.
+ */
+bool ValidateImageHeaders( const std::vector<std::string> & filenames );
+
+/** Clear the cache of ImageIOBase objects. Call this when files may have
+ * changed on disk, e.g. between jobs in batch mode.
+ */
+void ClearImageIOBaseCache( void );
+
+/** Let a reader use the cached ImageIOBase of its file, if available.
+ * The file name should already be set on the reader. This avoids that
+ * the reader probes all registered ImageIO factories again, which opens
+ * the file once for every candidate ImageIO.
+ */
+template< class TReader >
+void SetCachedImageIOBase( TReader * reader )
+{
+  if( reader->GetFileName() == 0 ) return;
+  itk::ImageIOBase::Pointer imageIOBase
+    = GetCachedImageIOBase( reader->GetFileName() );
+  if( imageIOBase.IsNotNull() )
+  {
+    reader->SetImageIO( imageIOBase );
+  }
+} // end SetCachedImageIOBase()
+
 /** Fill an ImageIOBase with values. */
 void FillImageIOBase(
   itk::ImageIOBase::Pointer & imageIOBase,
@@ -0,0 +1,599 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#include "ITKToolsMemoryMapping.h"
+
+#include "itkMetaImageIO.h"
+#include "itkByteSwapper.h"
+#include "itkSimpleFastMutexLock.h"
+#include <itksys/SystemTools.hxx>
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace itktools
+{
+
+/**
+ * ***************** MemoryMappedFile ************************
+ */
+
+MemoryMappedFile::MemoryMappedFile()
+{
+  this->m_Pointer = 0;
+  this->m_Size = 0;
+#ifdef _WIN32
+  this->m_FileHandle = INVALID_HANDLE_VALUE;
+  this->m_MappingHandle = 0;
+#else
+  this->m_FileDescriptor = -1;
+#endif
+
+} // end MemoryMappedFile()
+
+
+/**
+ * ***************** ~MemoryMappedFile ************************
+ */
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+  this->Close();
+
+} // end ~MemoryMappedFile()
+
+
+/**
+ * ***************** Open ************************
+ */
+
+bool
+MemoryMappedFile::Open( const std::string & fileName )
+{
+  this->Close();
+
+#ifdef _WIN32
+  this->m_FileHandle = CreateFileA( fileName.c_str(), GENERIC_READ,
+    FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0 );
+  if( this->m_FileHandle == INVALID_HANDLE_VALUE ) return false;
+
+  LARGE_INTEGER fileSize;
+  if( !GetFileSizeEx( this->m_FileHandle, &fileSize ) || fileSize.QuadPart == 0 )
+  {
+    this->Close();
+    return false;
+  }
+  this->m_Size = static_cast<std::size_t>( fileSize.QuadPart );
+
+  /** PAGE_WRITECOPY and FILE_MAP_COPY give a copy-on-write view. */
+  this->m_MappingHandle = CreateFileMappingA(
+    this->m_FileHandle, 0, PAGE_WRITECOPY, 0, 0, 0 );
+  if( this->m_MappingHandle == 0 )
+  {
+    this->Close();
+    return false;
+  }
+  this->m_Pointer = static_cast<char *>(
+    MapViewOfFile( this->m_MappingHandle, FILE_MAP_COPY, 0, 0, 0 ) );
+#else
+  this->m_FileDescriptor = open( fileName.c_str(), O_RDONLY );
+  if( this->m_FileDescriptor < 0 ) return false;
+
+  struct stat fileStatus;
+  if( fstat( this->m_FileDescriptor, &fileStatus ) != 0 || fileStatus.st_size == 0 )
+  {
+    this->Close();
+    return false;
+  }
+  this->m_Size = static_cast<std::size_t>( fileStatus.st_size );
+
+  /** MAP_PRIVATE gives a copy-on-write mapping. */
+  void * pointer = mmap( 0, this->m_Size, PROT_READ | PROT_WRITE,
+    MAP_PRIVATE, this->m_FileDescriptor, 0 );
+  if( pointer != MAP_FAILED ) this->m_Pointer = static_cast<char *>( pointer );
+#endif
+
+  if( this->m_Pointer == 0 )
+  {
+    this->Close();
+    return false;
+  }
+
+  return true;
+
+} // end Open()
+
+
+/**
+ * ***************** Create ************************
+ */
+
+bool
+MemoryMappedFile::Create( const std::string & fileName, std::size_t size )
+{
+  this->Close();
+  if( size == 0 ) return false;
+
+#ifdef _WIN32
+  this->m_FileHandle = CreateFileA( fileName.c_str(), GENERIC_READ | GENERIC_WRITE,
+    0, 0, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, 0 );
+  if( this->m_FileHandle == INVALID_HANDLE_VALUE ) return false;
+
+  LARGE_INTEGER fileSize;
+  fileSize.QuadPart = static_cast<LONGLONG>( size );
+  if( !SetFilePointerEx( this->m_FileHandle, fileSize, 0, FILE_BEGIN )
+    || !SetEndOfFile( this->m_FileHandle ) )
+  {
+    this->Close();
+    return false;
+  }
+  this->m_Size = size;
+
+  this->m_MappingHandle = CreateFileMappingA(
+    this->m_FileHandle, 0, PAGE_READWRITE, 0, 0, 0 );
+  if( this->m_MappingHandle == 0 )
+  {
+    this->Close();
+    return false;
+  }
+  this->m_Pointer = static_cast<char *>(
+    MapViewOfFile( this->m_MappingHandle, FILE_MAP_WRITE, 0, 0, 0 ) );
+#else
+  this->m_FileDescriptor = open( fileName.c_str(), O_RDWR | O_CREAT, 0666 );
+  if( this->m_FileDescriptor < 0 ) return false;
+
+  if( ftruncate( this->m_FileDescriptor, static_cast<off_t>( size ) ) != 0 )
+  {
+    this->Close();
+    return false;
+  }
+  this->m_Size = size;
+
+  /** MAP_SHARED writes the changes to the file. */
+  void * pointer = mmap( 0, this->m_Size, PROT_READ | PROT_WRITE,
+    MAP_SHARED, this->m_FileDescriptor, 0 );
+  if( pointer != MAP_FAILED ) this->m_Pointer = static_cast<char *>( pointer );
+#endif
+
+  if( this->m_Pointer == 0 )
+  {
+    this->Close();
+    return false;
+  }
+
+  return true;
+
+} // end Create()
+
+
+/**
+ * ***************** Close ************************
+ */
+
+void
+MemoryMappedFile::Close( void )
+{
+#ifdef _WIN32
+  if( this->m_Pointer != 0 ) UnmapViewOfFile( this->m_Pointer );
+  if( this->m_MappingHandle != 0 ) CloseHandle( this->m_MappingHandle );
+  if( this->m_FileHandle != INVALID_HANDLE_VALUE ) CloseHandle( this->m_FileHandle );
+  this->m_MappingHandle = 0;
+  this->m_FileHandle = INVALID_HANDLE_VALUE;
+#else
+  if( this->m_Pointer != 0 ) munmap( this->m_Pointer, this->m_Size );
+  if( this->m_FileDescriptor >= 0 ) close( this->m_FileDescriptor );
+  this->m_FileDescriptor = -1;
+#endif
+  this->m_Pointer = 0;
+  this->m_Size = 0;
+
+} // end Close()
+
+
+/**
+ * ***************** GetMetaImageDataFile ************************
+ *
+ * The data file of an uncompressed MetaImage with a single data file,
+ * and the offset of the pixel data in it, in any byte order.
+ */
+
+static bool GetMetaImageDataFile(
+  const std::string & fileName,
+  MetaImage * metaImage,
+  std::size_t dataSize,
+  std::string & dataFileName,
+  std::size_t & dataOffset )
+{
+  /** The data should be stored uncompressed, in a single file. */
+  if( metaImage->CompressedData() ) return false;
+
+  const std::string elementDataFile = metaImage->ElementDataFileName();
+  if( elementDataFile == "LIST"
+    || elementDataFile.find( '%' ) != std::string::npos )
+  {
+    return false;
+  }
+
+  /** Determine the data file name, relative to the header file. */
+  if( elementDataFile == "LOCAL" )
+  {
+    dataFileName = fileName;
+  }
+  else if( itksys::SystemTools::FileIsFullPath( elementDataFile.c_str() ) )
+  {
+    dataFileName = elementDataFile;
+  }
+  else
+  {
+    const std::string path = itksys::SystemTools::GetFilenamePath( fileName );
+    dataFileName = path.empty() ? elementDataFile : path + "/" + elementDataFile;
+  }
+
+  /** Determine the offset of the data. Like MetaImage, a header size
+   * of -1 means that the data is stored at the end of the file.
+   * For LOCAL data, the data also always follows the header directly.
+   */
+  const int headerSize = metaImage->HeaderSize();
+  if( headerSize > 0 && elementDataFile != "LOCAL" )
+  {
+    dataOffset = static_cast<std::size_t>( headerSize );
+  }
+  else if( headerSize == 0 && elementDataFile != "LOCAL" )
+  {
+    dataOffset = 0;
+  }
+  else
+  {
+    const unsigned long fileSize
+      = itksys::SystemTools::FileLength( dataFileName.c_str() );
+    if( fileSize < dataSize ) return false;
+    dataOffset = fileSize - dataSize;
+  }
+
+  return true;
+
+} // end GetMetaImageDataFile()
+
+
+/**
+ * ***************** GetMemoryMappableDataFile ************************
+ */
+
+bool GetMemoryMappableDataFile(
+  const std::string & fileName,
+  itk::ImageIOBase * imageIOBase,
+  std::size_t dataSize,
+  std::string & dataFileName,
+  std::size_t & dataOffset )
+{
+  /** Only MetaImage files are supported. */
+  itk::MetaImageIO * metaImageIO = dynamic_cast<itk::MetaImageIO *>( imageIOBase );
+  if( metaImageIO == 0 ) return false;
+  MetaImage * metaImage = metaImageIO->GetMetaImagePointer();
+
+  /** The data should be in the byte order of this machine. */
+  const bool systemIsBigEndian = itk::ByteSwapper<char>::SystemIsBigEndian();
+  if( metaImage->BinaryDataByteOrderMSB() != systemIsBigEndian ) return false;
+
+  return GetMetaImageDataFile( fileName, metaImage, dataSize,
+    dataFileName, dataOffset );
+
+} // end GetMemoryMappableDataFile()
+
+
+/**
+ * ***************** GetMetaValueType ************************
+ *
+ * The MetaImage type of a component type, as in itk::MetaImageIO.
+ */
+
+static bool GetMetaValueType( itk::ImageIOBase::IOComponentType componentType,
+  MET_ValueEnumType & valueType )
+{
+  switch( componentType )
+  {
+    case itk::ImageIOBase::UCHAR:   valueType = MET_UCHAR; break;
+    case itk::ImageIOBase::CHAR:    valueType = MET_CHAR; break;
+    case itk::ImageIOBase::USHORT:  valueType = MET_USHORT; break;
+    case itk::ImageIOBase::SHORT:   valueType = MET_SHORT; break;
+    case itk::ImageIOBase::UINT:    valueType = MET_UINT; break;
+    case itk::ImageIOBase::INT:     valueType = MET_INT; break;
+    case itk::ImageIOBase::ULONG:
+      valueType = sizeof( unsigned long ) == MET_ValueTypeSize[ MET_ULONG ]
+        ? MET_ULONG : MET_ULONG_LONG;
+      break;
+    case itk::ImageIOBase::LONG:
+      valueType = sizeof( long ) == MET_ValueTypeSize[ MET_LONG ]
+        ? MET_LONG : MET_LONG_LONG;
+      break;
+    case itk::ImageIOBase::FLOAT:   valueType = MET_FLOAT; break;
+    case itk::ImageIOBase::DOUBLE:  valueType = MET_DOUBLE; break;
+    default: return false;
+  }
+  return true;
+
+} // end GetMetaValueType()
+
+
+/**
+ * ***************** WriteMetaImageHeader ************************
+ *
+ * Write the header of an uncompressed MetaImage with the geometry,
+ * component type and number of components of imageIOBase, and
+ * determine where its pixel data goes.
+ */
+
+static bool WriteMetaImageHeader(
+  const std::string & fileName,
+  itk::ImageIOBase * imageIOBase,
+  bool byteOrderMSB,
+  std::string & dataFileName,
+  std::size_t & dataOffset )
+{
+  MET_ValueEnumType valueType = MET_NONE;
+  if( !GetMetaValueType( imageIOBase->GetComponentType(), valueType ) ) return false;
+
+  /** The geometry, with the direction cosines as written by MetaImageIO. */
+  const unsigned int dimension = imageIOBase->GetNumberOfDimensions();
+  std::vector<int> size( dimension );
+  std::vector<double> spacing( dimension );
+  std::vector<double> transformMatrix( dimension * dimension );
+  for( unsigned int i = 0; i < dimension; ++i )
+  {
+    size[ i ] = static_cast<int>( imageIOBase->GetDimensions( i ) );
+    spacing[ i ] = imageIOBase->GetSpacing( i );
+    for( unsigned int j = 0; j < dimension; ++j )
+    {
+      transformMatrix[ i * dimension + j ] = imageIOBase->GetDirection( i )[ j ];
+    }
+  }
+
+  MetaImage metaImage( dimension, &size[ 0 ], &spacing[ 0 ], valueType,
+    imageIOBase->GetNumberOfComponents() );
+  for( unsigned int i = 0; i < dimension; ++i )
+  {
+    metaImage.Position( i, imageIOBase->GetOrigin( i ) );
+  }
+  metaImage.TransformMatrix( &transformMatrix[ 0 ] );
+  metaImage.CompressedData( false );
+  metaImage.BinaryDataByteOrderMSB( byteOrderMSB );
+
+  /** Write the header only; MetaIO names the data file, LOCAL for .mha. */
+  if( !metaImage.Write( fileName.c_str(), 0, false ) ) return false;
+
+  const std::string elementDataFile = metaImage.ElementDataFileName();
+  if( elementDataFile == "LOCAL" )
+  {
+    dataFileName = fileName;
+    dataOffset = static_cast<std::size_t>(
+      itksys::SystemTools::FileLength( fileName.c_str() ) );
+  }
+  else
+  {
+    const std::string path = itksys::SystemTools::GetFilenamePath( fileName );
+    dataFileName = path.empty()
+      || itksys::SystemTools::FileIsFullPath( elementDataFile.c_str() )
+      ? elementDataFile : path + "/" + elementDataFile;
+    dataOffset = 0;
+  }
+
+  return true;
+
+} // end WriteMetaImageHeader()
+
+
+/**
+ * ***************** CreateMemoryMappedMetaImage ************************
+ */
+
+bool CreateMemoryMappedMetaImage(
+  const std::string & fileName,
+  itk::ImageIOBase * imageIOBase,
+  std::size_t dataSize,
+  MemoryMappedFile * mappedFile,
+  std::string & dataFileName,
+  std::size_t & dataOffset )
+{
+  if( !WriteMetaImageHeader( fileName, imageIOBase,
+    itk::ByteSwapper<char>::SystemIsBigEndian(), dataFileName, dataOffset ) )
+  {
+    return false;
+  }
+
+  return mappedFile->Create( dataFileName, dataOffset + dataSize );
+
+} // end CreateMemoryMappedMetaImage()
+
+
+/**
+ * ***************** CopyMetaImageData ************************
+ */
+
+bool CopyMetaImageData(
+  const std::string & inputFileName,
+  const std::string & outputFileName,
+  itk::ImageIOBase * imageIOBase,
+  std::size_t blockSize )
+{
+  /** The output should be a MetaImage too, and not the input itself. */
+  const std::string extension = itksys::SystemTools::LowerCase(
+    itksys::SystemTools::GetFilenameLastExtension( outputFileName ) );
+  if( extension != ".mhd" && extension != ".mha" ) return false;
+  if( itksys::SystemTools::FileExists( outputFileName.c_str() )
+    && itksys::SystemTools::SameFile( inputFileName.c_str(), outputFileName.c_str() ) )
+  {
+    return false;
+  }
+
+  /** The input should be an uncompressed MetaImage with a single data file. */
+  itk::MetaImageIO * metaImageIO = dynamic_cast<itk::MetaImageIO *>( imageIOBase );
+  if( metaImageIO == 0 ) return false;
+  MetaImage * metaImage = metaImageIO->GetMetaImagePointer();
+
+  const std::size_t dataSize = static_cast<std::size_t>(
+    imageIOBase->GetImageSizeInBytes() );
+  std::string inputDataFileName = "";
+  std::size_t inputDataOffset = 0;
+  if( !GetMetaImageDataFile( inputFileName, metaImage, dataSize,
+    inputDataFileName, inputDataOffset ) )
+  {
+    return false;
+  }
+
+  /** Write the header, in the byte order of the input data. */
+  std::string outputDataFileName = "";
+  std::size_t outputDataOffset = 0;
+  if( !WriteMetaImageHeader( outputFileName, imageIOBase,
+    metaImage->BinaryDataByteOrderMSB(), outputDataFileName, outputDataOffset ) )
+  {
+    return false;
+  }
+
+  /** Never overwrite the data that is copied. */
+  if( itksys::SystemTools::FileExists( outputDataFileName.c_str() )
+    && itksys::SystemTools::SameFile(
+      inputDataFileName.c_str(), outputDataFileName.c_str() ) )
+  {
+    return false;
+  }
+
+  /** Copy the pixel data in blocks; the header of an .mha file precedes it. */
+  std::ifstream input( inputDataFileName.c_str(), std::ios::in | std::ios::binary );
+  input.seekg( static_cast<std::streamoff>( inputDataOffset ) );
+  std::ofstream output( outputDataFileName.c_str(), outputDataOffset > 0
+    ? std::ios::out | std::ios::binary | std::ios::app
+    : std::ios::out | std::ios::binary | std::ios::trunc );
+  if( !input || !output )
+  {
+    itkGenericExceptionMacro( << "Could not copy the pixel data of \""
+      << inputFileName << "\" to \"" << outputDataFileName << "\"." );
+  }
+
+  std::vector<char> buffer( std::max<std::size_t>(
+    std::min( blockSize, dataSize ), 1 ) );
+  std::size_t remaining = dataSize;
+  while( remaining > 0 )
+  {
+    const std::size_t n = std::min( remaining, buffer.size() );
+    input.read( &buffer[ 0 ], static_cast<std::streamsize>( n ) );
+    output.write( &buffer[ 0 ], static_cast<std::streamsize>( n ) );
+    if( !input || !output )
+    {
+      itkGenericExceptionMacro( << "Could not copy the pixel data of \""
+        << inputFileName << "\" to \"" << outputDataFileName
+        << "\": the input is truncated or the output could not be written." );
+    }
+    remaining -= n;
+  }
+
+  return true;
+
+} // end CopyMetaImageData()
+
+
+/** The armed mapping of the MappedOutput. */
+struct MappedOutputState
+{
+  MappedOutputState()
+    : m_MappedFile( 0 ), m_DataOffset( 0 ), m_NumberOfBytes( 0 ), m_ElementType( 0 ) {}
+
+  itk::SimpleFastMutexLock  m_Lock;
+  MemoryMappedFile *        m_MappedFile;
+  std::size_t               m_DataOffset;
+  std::size_t               m_NumberOfBytes;
+  const std::type_info *    m_ElementType;
+};
+
+static MappedOutputState & GetMappedOutputState( void )
+{
+  static MappedOutputState state;
+  return state;
+}
+
+
+/**
+ * ***************** MappedOutput::Arm ************************
+ */
+
+void
+MappedOutput::Arm( MemoryMappedFile * mappedFile, std::size_t dataOffset,
+  std::size_t numberOfBytes, const std::type_info & elementType )
+{
+  MappedOutputState & state = GetMappedOutputState();
+  state.m_Lock.Lock();
+  delete state.m_MappedFile;
+  state.m_MappedFile = mappedFile;
+  state.m_DataOffset = dataOffset;
+  state.m_NumberOfBytes = numberOfBytes;
+  state.m_ElementType = &elementType;
+  state.m_Lock.Unlock();
+
+} // end MappedOutput::Arm()
+
+
+/**
+ * ***************** MappedOutput::Claim ************************
+ */
+
+MemoryMappedFile *
+MappedOutput::Claim( std::size_t numberOfBytes,
+  const std::type_info & elementType, char *& pointer )
+{
+  MappedOutputState & state = GetMappedOutputState();
+  MemoryMappedFile * mappedFile = 0;
+  state.m_Lock.Lock();
+  if( state.m_MappedFile != 0 && state.m_NumberOfBytes == numberOfBytes
+    && *state.m_ElementType == elementType )
+  {
+    mappedFile = state.m_MappedFile;
+    pointer = mappedFile->GetPointer() + state.m_DataOffset;
+    state.m_MappedFile = 0;
+  }
+  state.m_Lock.Unlock();
+  return mappedFile;
+
+} // end MappedOutput::Claim()
+
+
+/**
+ * ***************** MappedOutput::Disarm ************************
+ */
+
+MemoryMappedFile *
+MappedOutput::Disarm( void )
+{
+  MappedOutputState & state = GetMappedOutputState();
+  state.m_Lock.Lock();
+  MemoryMappedFile * mappedFile = state.m_MappedFile;
+  state.m_MappedFile = 0;
+  state.m_Lock.Unlock();
+  return mappedFile;
+
+} // end MappedOutput::Disarm()
+
+
+} // end namespace itktools
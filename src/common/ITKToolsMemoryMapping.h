@@ -0,0 +1,396 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __ITKToolsMemoryMapping_h_
+#define __ITKToolsMemoryMapping_h_
+
+#include <string>
+#include <typeinfo>
+#include <algorithm>
+#include "itkImageIOBase.h"
+#include "itkImportImageContainer.h"
+#include "itkObjectFactoryBase.h"
+#include "itkCreateObjectFunction.h"
+#include "itkVersion.h"
+
+
+namespace itktools
+{
+
+/** \class MemoryMappedFile
+ * \brief Maps a complete file in memory.
+ *
+ * A mapping made by Open() is private and copy-on-write: the mapped
+ * memory may be modified, e.g. by in-place filters, but the file on disk
+ * is untouched. A mapping made by Create() is shared: what is written to
+ * the memory ends up in the file.
+ */
+
+class MemoryMappedFile
+{
+public:
+  MemoryMappedFile();
+  ~MemoryMappedFile();
+
+  /** Map the file. Returns false if that is not possible. */
+  bool Open( const std::string & fileName );
+
+  /** Create the file if it does not exist, set its size to size bytes,
+   * and map it writable. Returns false if that is not possible. */
+  bool Create( const std::string & fileName, std::size_t size );
+
+  /** Unmap the file. Called by the destructor. */
+  void Close( void );
+
+  /** Get the start and the size in bytes of the mapped file. */
+  char * GetPointer( void ) const { return this->m_Pointer; }
+  std::size_t GetSize( void ) const { return this->m_Size; }
+
+private:
+  MemoryMappedFile( const MemoryMappedFile & ); // purposely not implemented
+  void operator=( const MemoryMappedFile & );   // purposely not implemented
+
+  char *        m_Pointer;
+  std::size_t   m_Size;
+#ifdef _WIN32
+  void *        m_FileHandle;
+  void *        m_MappingHandle;
+#else
+  int           m_FileDescriptor;
+#endif
+
+}; // end class MemoryMappedFile
+
+
+/** Determine if the pixel data of an image file can be memory mapped,
+ * i.e. if it is an uncompressed MetaImage (.mhd or .mha) with a single
+ * data file in the native byte order. If so, the name of the data file
+ * and the offset of the pixel data in that file are returned.
+ * The size of the pixel data in bytes is needed to determine the offset
+ * when the header size is not explicitly specified.
+ */
+bool GetMemoryMappableDataFile(
+  const std::string & fileName,
+  itk::ImageIOBase * imageIOBase,
+  std::size_t dataSize,
+  std::string & dataFileName,
+  std::size_t & dataOffset );
+
+
+/** Create a MetaImage whose pixel data can be written through a memory
+ * mapping: the header is written, with the geometry, component type and
+ * number of components of imageIOBase, and the data file is created with
+ * room for dataSize bytes and mapped writable. An .mha file stores the
+ * data after the header, an .mhd file in a .raw file next to it. The
+ * data file and the offset of the pixel data in it are returned.
+ */
+bool CreateMemoryMappedMetaImage(
+  const std::string & fileName,
+  itk::ImageIOBase * imageIOBase,
+  std::size_t dataSize,
+  MemoryMappedFile * mappedFile,
+  std::string & dataFileName,
+  std::size_t & dataOffset );
+
+
+/** Convert an uncompressed MetaImage to another uncompressed MetaImage
+ * without decoding its pixels: a new header is written for outputFileName,
+ * and the pixel data is copied in blocks of blockSize bytes, with constant
+ * memory. The byte order of the data is kept. imageIOBase is the header
+ * of the input, as read by GetImageIOBase().
+ *
+ * Returns false, before any data is copied, if the input or the output is
+ * not such a MetaImage or if the output would overwrite the input data;
+ * the image should then be converted the normal way. Throws
+ * itk::ExceptionObject if the copy itself fails.
+ */
+bool CopyMetaImageData(
+  const std::string & inputFileName,
+  const std::string & outputFileName,
+  itk::ImageIOBase * imageIOBase,
+  std::size_t blockSize = 16 * 1024 * 1024 );
+
+
+/** \class MappedOutput
+ * \brief Hands a writable file mapping to the next matching image buffer.
+ *
+ * A tool arms the mapping just before the last filter of its pipeline
+ * executes; the first pixel container of the element type and the size
+ * of the mapping that then allocates memory, normally the output of that
+ * filter, gets the mapping instead, so that the filter writes its output
+ * straight into the file. Only containers of a type registered with
+ * RegisterMappedOutputImageType() take part.
+ */
+
+class MappedOutput
+{
+public:
+  /** Offer the mapping, from dataOffset for numberOfBytes bytes, to the
+   * next allocation of numberOfBytes bytes of elements of elementType.
+   * Takes ownership of the mapped file. */
+  static void Arm( MemoryMappedFile * mappedFile, std::size_t dataOffset,
+    std::size_t numberOfBytes, const std::type_info & elementType );
+
+  /** Take the armed mapping, if it matches. Returns the mapped file,
+   * whose owner the caller becomes, and the memory to use; or 0. */
+  static MemoryMappedFile * Claim( std::size_t numberOfBytes,
+    const std::type_info & elementType, char *& pointer );
+
+  /** Withdraw the mapping. Returns it if it was not claimed, otherwise 0. */
+  static MemoryMappedFile * Disarm( void );
+
+}; // end class MappedOutput
+
+
+/** \class MappedOutputImportImageContainer
+ * \brief An ImportImageContainer that can allocate in the MappedOutput.
+ *
+ * Memory is taken from the armed MappedOutput if it matches, and
+ * allocated normally otherwise. The mapping is unmapped when the memory
+ * is released; the data stays in the file.
+ */
+
+template< typename TElementIdentifier, typename TElement >
+class MappedOutputImportImageContainer
+  : public itk::ImportImageContainer< TElementIdentifier, TElement >
+{
+public:
+  /** Standard class typedefs. */
+  typedef MappedOutputImportImageContainer  Self;
+  typedef itk::ImportImageContainer<
+    TElementIdentifier, TElement >          Superclass;
+  typedef itk::SmartPointer< Self >         Pointer;
+  typedef itk::SmartPointer< const Self >   ConstPointer;
+  typedef TElementIdentifier                ElementIdentifier;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( MappedOutputImportImageContainer, ImportImageContainer );
+
+protected:
+  MappedOutputImportImageContainer()
+  {
+    this->m_MappedFile = 0;
+    this->m_MappedPointer = 0;
+  }
+  virtual ~MappedOutputImportImageContainer() { this->DeallocateManagedMemory(); }
+
+  /** Allocate in the mapping if it is armed and matches. */
+  virtual TElement * AllocateElements( ElementIdentifier size,
+    bool UseDefaultConstructor = false ) const
+  {
+    char * pointer = 0;
+    MemoryMappedFile * mappedFile = MappedOutput::Claim(
+      static_cast<std::size_t>( size ) * sizeof( TElement ),
+      typeid( TElement ), pointer );
+    if( mappedFile == 0 )
+    {
+      return Superclass::AllocateElements( size, UseDefaultConstructor );
+    }
+
+    delete this->m_MappedFile;
+    this->m_MappedFile = mappedFile;
+    this->m_MappedPointer = reinterpret_cast<TElement *>( pointer );
+    if( UseDefaultConstructor )
+    {
+      std::fill( this->m_MappedPointer, this->m_MappedPointer + size, TElement() );
+    }
+    return this->m_MappedPointer;
+  }
+
+  /** Unmap mapped memory; the superclass then only resets. */
+  virtual void DeallocateManagedMemory( void )
+  {
+    if( this->m_MappedFile != 0 && this->GetContainerManageMemory()
+      && this->GetImportPointer() == this->m_MappedPointer )
+    {
+      delete this->m_MappedFile;
+      this->m_MappedFile = 0;
+      this->m_MappedPointer = 0;
+      this->SetContainerManageMemory( false );
+    }
+    Superclass::DeallocateManagedMemory();
+  }
+
+private:
+  MappedOutputImportImageContainer( const Self & ); // purposely not implemented
+  void operator=( const Self & );                   // purposely not implemented
+
+  mutable MemoryMappedFile *  m_MappedFile;
+  mutable TElement *          m_MappedPointer;
+
+}; // end class MappedOutputImportImageContainer
+
+
+/** \class MappedOutputImportImageContainerFactory
+ * \brief Let the pixel containers of one type take part in the MappedOutput.
+ */
+
+template< typename TElementIdentifier, typename TElement >
+class MappedOutputImportImageContainerFactory : public itk::ObjectFactoryBase
+{
+public:
+  /** Standard class typedefs. */
+  typedef MappedOutputImportImageContainerFactory Self;
+  typedef itk::ObjectFactoryBase                  Superclass;
+  typedef itk::SmartPointer< Self >               Pointer;
+  typedef itk::SmartPointer< const Self >         ConstPointer;
+  typedef itk::ImportImageContainer<
+    TElementIdentifier, TElement >                ContainerType;
+  typedef MappedOutputImportImageContainer<
+    TElementIdentifier, TElement >                MappedContainerType;
+
+  /** Class methods used to interface with the registered factories. */
+  virtual const char * GetITKSourceVersion( void ) const { return ITK_SOURCE_VERSION; }
+  virtual const char * GetDescription( void ) const
+  {
+    return "Mapped output image container factory, allocates outputs in their file";
+  }
+
+  /** Method for class instantiation. */
+  itkFactorylessNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( MappedOutputImportImageContainerFactory, ObjectFactoryBase );
+
+protected:
+  MappedOutputImportImageContainerFactory()
+  {
+    this->RegisterOverride( typeid( ContainerType ).name(),
+      typeid( MappedContainerType ).name(),
+      "Mapped output image container",
+      true,
+      itk::CreateObjectFunction< MappedContainerType >::New() );
+  }
+
+private:
+  MappedOutputImportImageContainerFactory( const Self & ); // purposely not implemented
+  void operator=( const Self & );                          // purposely not implemented
+
+}; // end class MappedOutputImportImageContainerFactory
+
+
+/** Let every image of type TImage created afterwards take part in the
+ * MappedOutput. Registering a type more than once has no effect. A type
+ * whose containers are already pooled, see RegisterPooledImageType(),
+ * keeps its pooled containers; WriteImageMapped() then copies.
+ */
+template< class TImage >
+void RegisterMappedOutputImageType( void )
+{
+  typedef typename TImage::PixelContainer             ContainerType;
+  typedef MappedOutputImportImageContainerFactory<
+    typename ContainerType::ElementIdentifier,
+    typename ContainerType::Element >                 FactoryType;
+
+  static bool registered = false;
+  if( registered ) return;
+  registered = true;
+  typename FactoryType::Pointer factory = FactoryType::New();
+  itk::ObjectFactoryBase::RegisterFactory( factory );
+
+} // end RegisterMappedOutputImageType()
+
+
+/** \class MemoryMappedImportImageContainer
+ * \brief An ImportImageContainer whose memory is a memory mapped file.
+ *
+ * The container owns the MemoryMappedFile, and unmaps it when it is
+ * destroyed, i.e. when the last image using it is released.
+ */
+
+template< typename TElementIdentifier, typename TElement >
+class MemoryMappedImportImageContainer
+  : public itk::ImportImageContainer< TElementIdentifier, TElement >
+{
+public:
+  /** Standard class typedefs. */
+  typedef MemoryMappedImportImageContainer  Self;
+  typedef itk::ImportImageContainer<
+    TElementIdentifier, TElement >          Superclass;
+  typedef itk::SmartPointer< Self >         Pointer;
+  typedef itk::SmartPointer< const Self >   ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( MemoryMappedImportImageContainer, ImportImageContainer );
+
+  /** Take ownership of a mapped file, and import its memory. */
+  void SetMemoryMappedFile( MemoryMappedFile * mappedFile,
+    std::size_t dataOffset, TElementIdentifier numberOfElements )
+  {
+    delete this->m_MemoryMappedFile;
+    this->m_MemoryMappedFile = mappedFile;
+    this->SetImportPointer( reinterpret_cast<TElement *>(
+      mappedFile->GetPointer() + dataOffset ), numberOfElements, false );
+  }
+
+protected:
+  MemoryMappedImportImageContainer() { this->m_MemoryMappedFile = 0; }
+  virtual ~MemoryMappedImportImageContainer() { delete this->m_MemoryMappedFile; }
+
+private:
+  MemoryMappedImportImageContainer( const Self & ); // purposely not implemented
+  void operator=( const Self & );                   // purposely not implemented
+
+  MemoryMappedFile * m_MemoryMappedFile;
+
+}; // end class MemoryMappedImportImageContainer
+
+
+/** Read an image from disk.
+ * If the file is an uncompressed MetaImage whose component type, number
+ * of components, dimension and byte order match TImage, the pixel data
+ * is memory mapped and used directly as the pixel buffer of the image.
+ * This avoids copying the data, and the data is only paged in when it is
+ * accessed. Otherwise, or if allowMemoryMapping is false, the image is
+ * read with an itk::ImageFileReader.
+ *
+ * TImage should be an itk::Image of scalar or fixed length vector pixels.
+ */
+template< class TImage >
+typename TImage::Pointer ReadImage(
+  const std::string & fileName, bool allowMemoryMapping = true );
+
+
+/** Compute an image straight into an uncompressed MetaImage file.
+ * The pipeline up to the inputs of the source of the image is executed
+ * first; then the file is created at its final size and mapped, and the
+ * source writes its output in the mapped file, through the MappedOutput.
+ * This saves the copy of a writer, and the output may exceed the memory.
+ * If the source does not use the mapping, e.g. because it runs in place,
+ * the output is copied into the file.
+ *
+ * Returns false if the file is not an .mhd or .mha file, or cannot be
+ * mapped; the image should then be written the normal way, which only
+ * executes what did not run yet. Throws itk::ExceptionObject if the
+ * pipeline fails.
+ *
+ * TImage may be an itk::Image or an itk::VectorImage.
+ */
+template< class TImage >
+bool WriteImageMapped( TImage * image, const std::string & fileName );
+
+} // end namespace itktools
+
+#include "ITKToolsMemoryMapping.hxx"
+
+#endif // end #ifndef __ITKToolsMemoryMapping_h_
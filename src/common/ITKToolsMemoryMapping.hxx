@@ -0,0 +1,225 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __ITKToolsMemoryMapping_hxx_
+#define __ITKToolsMemoryMapping_hxx_
+
+#include "ITKToolsImageProperties.h"
+#include "itkImageFileReader.h"
+#include "itkMetaImageIO.h"
+#include "itkNumericTraits.h"
+#include <itksys/SystemTools.hxx>
+#include <cstring>
+
+
+namespace itktools
+{
+
+/**
+ * ***************** ReadImage ************************
+ */
+
+template< class TImage >
+typename TImage::Pointer ReadImage(
+  const std::string & fileName, bool allowMemoryMapping )
+{
+  typedef TImage                                      ImageType;
+  typedef typename ImageType::PixelType               PixelType;
+  typedef typename ImageType::PixelContainer          PixelContainerType;
+  typedef typename PixelContainerType::ElementIdentifier ElementIdentifierType;
+  typedef typename itk::NumericTraits<PixelType>::ValueType ValueType;
+  typedef MemoryMappedImportImageContainer<
+    ElementIdentifierType, PixelType >                MappedContainerType;
+  const unsigned int Dimension = ImageType::ImageDimension;
+  const unsigned int numberOfComponents = sizeof( PixelType ) / sizeof( ValueType );
+
+  /** Try to memory map the pixel data. */
+  itk::ImageIOBase::Pointer imageIOBase;
+  if( allowMemoryMapping && GetImageIOBase( fileName, imageIOBase )
+    && imageIOBase->GetNumberOfDimensions() == Dimension
+    && imageIOBase->GetNumberOfComponents() == numberOfComponents
+    && imageIOBase->GetComponentType()
+      == itk::ImageIOBase::MapPixelType<ValueType>::CType )
+  {
+    /** Get the image geometry. */
+    typename ImageType::SizeType      size;
+    typename ImageType::SpacingType   spacing;
+    typename ImageType::PointType     origin;
+    typename ImageType::DirectionType direction;
+    ElementIdentifierType numberOfPixels = 1;
+    for( unsigned int i = 0; i < Dimension; ++i )
+    {
+      size[ i ] = imageIOBase->GetDimensions( i );
+      spacing[ i ] = imageIOBase->GetSpacing( i );
+      origin[ i ] = imageIOBase->GetOrigin( i );
+      for( unsigned int j = 0; j < Dimension; ++j )
+      {
+        direction[ j ][ i ] = imageIOBase->GetDirection( i )[ j ];
+      }
+      numberOfPixels *= size[ i ];
+    }
+
+    /** Map the data file, and check that it is large enough and aligned. */
+    const std::size_t dataSize = numberOfPixels * sizeof( PixelType );
+    std::string dataFileName = "";
+    std::size_t dataOffset = 0;
+    MemoryMappedFile * mappedFile = new MemoryMappedFile;
+    if( GetMemoryMappableDataFile( fileName, imageIOBase, dataSize,
+        dataFileName, dataOffset )
+      && dataOffset % sizeof( ValueType ) == 0
+      && mappedFile->Open( dataFileName )
+      && dataOffset + dataSize <= mappedFile->GetSize() )
+    {
+      /** The container takes ownership of the mapped file. */
+      typename MappedContainerType::Pointer container = MappedContainerType::New();
+      container->SetMemoryMappedFile( mappedFile, dataOffset, numberOfPixels );
+
+      typename ImageType::Pointer image = ImageType::New();
+      image->SetRegions( size );
+      image->SetSpacing( spacing );
+      image->SetOrigin( origin );
+      image->SetDirection( direction );
+      image->SetPixelContainer( container );
+
+      return image;
+    }
+    delete mappedFile;
+  }
+
+  /** Otherwise read the image the normal way. */
+  typedef itk::ImageFileReader< ImageType >           ReaderType;
+  typename ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( fileName.c_str() );
+  SetCachedImageIOBase( reader.GetPointer() );
+  reader->Update();
+
+  return reader->GetOutput();
+
+} // end ReadImage()
+
+
+/**
+ * ***************** WriteImageMapped ************************
+ */
+
+template< class TImage >
+bool WriteImageMapped( TImage * image, const std::string & fileName )
+{
+  typedef TImage                                      ImageType;
+  typedef typename ImageType::PixelContainer          PixelContainerType;
+  typedef typename PixelContainerType::Element        ElementType;
+  typedef typename itk::NumericTraits<
+    typename ImageType::InternalPixelType >::ValueType ValueType;
+  const unsigned int Dimension = ImageType::ImageDimension;
+
+  /** Only uncompressed MetaImage files can be mapped. */
+  const std::string extension = itksys::SystemTools::LowerCase(
+    itksys::SystemTools::GetFilenameLastExtension( fileName ) );
+  if( extension != ".mhd" && extension != ".mha" ) return false;
+
+  RegisterMappedOutputImageType< ImageType >();
+
+  /** Execute the pipeline up to the inputs of the source. The file is
+   * only created after that, as an input may be read from it.
+   */
+  image->UpdateOutputInformation();
+  image->SetRequestedRegionToLargestPossibleRegion();
+  image->PropagateRequestedRegion();
+  itk::ProcessObject * source = image->GetSource();
+  if( source != 0 )
+  {
+    itk::ProcessObject::DataObjectPointerArray inputs = source->GetInputs();
+    for( std::size_t i = 0; i < inputs.size(); ++i )
+    {
+      if( inputs[ i ] ) inputs[ i ]->UpdateOutputData();
+    }
+  }
+
+  /** Create the file, with the geometry of the image. */
+  const typename ImageType::RegionType region = image->GetLargestPossibleRegion();
+  itk::MetaImageIO::Pointer imageIO = itk::MetaImageIO::New();
+  imageIO->SetNumberOfDimensions( Dimension );
+  for( unsigned int i = 0; i < Dimension; ++i )
+  {
+    imageIO->SetDimensions( i, region.GetSize()[ i ] );
+    imageIO->SetSpacing( i, image->GetSpacing()[ i ] );
+    imageIO->SetOrigin( i, image->GetOrigin()[ i ] );
+    std::vector<double> direction( Dimension );
+    for( unsigned int j = 0; j < Dimension; ++j )
+    {
+      direction[ j ] = image->GetDirection()[ j ][ i ];
+    }
+    imageIO->SetDirection( i, direction );
+  }
+  imageIO->SetComponentType( itk::ImageIOBase::MapPixelType<ValueType>::CType );
+  imageIO->SetNumberOfComponents( image->GetNumberOfComponentsPerPixel() );
+
+  const std::size_t dataSize = static_cast<std::size_t>( region.GetNumberOfPixels() )
+    * image->GetNumberOfComponentsPerPixel() * sizeof( ValueType );
+  MemoryMappedFile * mappedFile = new MemoryMappedFile;
+  std::string dataFileName = "";
+  std::size_t dataOffset = 0;
+  if( !CreateMemoryMappedMetaImage( fileName, imageIO, dataSize,
+      mappedFile, dataFileName, dataOffset )
+    || dataOffset % sizeof( ValueType ) != 0 )
+  {
+    delete mappedFile;
+    return false;
+  }
+
+  /** Let the source allocate its output in the file. */
+  const ElementType * mappedPointer
+    = reinterpret_cast<ElementType *>( mappedFile->GetPointer() + dataOffset );
+  MappedOutput::Arm( mappedFile, dataOffset, dataSize, typeid( ElementType ) );
+  try
+  {
+    image->Update();
+  }
+  catch( ... )
+  {
+    delete MappedOutput::Disarm();
+    throw;
+  }
+  mappedFile = MappedOutput::Disarm();
+
+  /** Copy the output if it was computed elsewhere. If the mapping was
+   * claimed by another image, map the file again. */
+  const ElementType * buffer = image->GetPixelContainer()->GetBufferPointer();
+  if( buffer != mappedPointer )
+  {
+    if( mappedFile == 0 )
+    {
+      mappedFile = new MemoryMappedFile;
+      if( !mappedFile->Create( dataFileName, dataOffset + dataSize ) )
+      {
+        delete mappedFile;
+        itkGenericExceptionMacro( << "Could not map \"" << dataFileName
+          << "\" for writing." );
+      }
+    }
+    std::memcpy( mappedFile->GetPointer() + dataOffset, buffer, dataSize );
+  }
+  delete mappedFile;
+
+  return true;
+
+} // end WriteImageMapped()
+
+
+} // end namespace itktools
+
+#endif // end #ifndef __ITKToolsMemoryMapping_hxx_
@@ -0,0 +1,110 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#include "ITKToolsModules.h"
+
+#include "itksys/DynamicLoader.hxx"
+#include "itksys/SystemTools.hxx"
+
+#include <iostream>
+#include <sstream>
+
+/** The directories and the suffix of the modules, set by CMake. */
+#ifndef ITKTOOLS_MODULE_BUILD_DIR
+#define ITKTOOLS_MODULE_BUILD_DIR ""
+#endif
+#ifndef ITKTOOLS_MODULE_INSTALL_DIR
+#define ITKTOOLS_MODULE_INSTALL_DIR ""
+#endif
+#ifndef ITKTOOLS_MODULE_SUFFIX
+#if defined( _WIN32 )
+#define ITKTOOLS_MODULE_SUFFIX ".dll"
+#else
+#define ITKTOOLS_MODULE_SUFFIX ".so"
+#endif
+#endif
+
+namespace itktools
+{
+
+/** The type of the creation function of a module. */
+typedef void * ( *ModuleNewFunction )( void );
+
+/**
+ * ***************** GetModuleName ************************
+ */
+
+std::string GetModuleName( const std::string & tool, unsigned int dim,
+  const std::vector<itk::ImageIOBase::IOComponentType> & componentTypes )
+{
+  std::ostringstream name;
+  name << "px" << tool << "-" << dim << "D";
+  for( std::size_t i = 0; i < componentTypes.size(); ++i )
+  {
+    name << "-" << itk::ImageIOBase::GetComponentTypeAsString( componentTypes[ i ] );
+  }
+  return name.str();
+
+} // end GetModuleName()
+
+
+/**
+ * ***************** NewFromModule ************************
+ */
+
+void * NewFromModule( const std::string & tool, unsigned int dim,
+  const std::vector<itk::ImageIOBase::IOComponentType> & componentTypes )
+{
+  /** The directories to search, in order. */
+  std::vector<std::string> directories;
+  itksys::SystemTools::GetPath( directories, "ITKTOOLS_MODULE_PATH" );
+  directories.push_back( ITKTOOLS_MODULE_BUILD_DIR );
+  directories.push_back( ITKTOOLS_MODULE_INSTALL_DIR );
+
+  const std::string fileName
+    = GetModuleName( tool, dim, componentTypes ) + ITKTOOLS_MODULE_SUFFIX;
+  for( std::size_t i = 0; i < directories.size(); ++i )
+  {
+    if( directories[ i ].empty() ) continue;
+    const std::string path = directories[ i ] + "/" + fileName;
+    if( !itksys::SystemTools::FileExists( path.c_str(), true ) ) continue;
+
+    itksys::DynamicLoader::LibraryHandle library
+      = itksys::DynamicLoader::OpenLibrary( path.c_str() );
+    if( !library )
+    {
+      std::cerr << "ERROR: could not load the module " << path << ":\n  "
+        << itksys::DynamicLoader::LastError() << std::endl;
+      return 0;
+    }
+    ModuleNewFunction newFunction = reinterpret_cast<ModuleNewFunction>(
+      itksys::DynamicLoader::GetSymbolAddress( library, "itktoolsModuleNew" ) );
+    if( !newFunction )
+    {
+      std::cerr << "ERROR: " << path << " is not an ITKTools module." << std::endl;
+      itksys::DynamicLoader::CloseLibrary( library );
+      return 0;
+    }
+    return newFunction();
+  }
+
+  /** Not found: the combination is not supported. */
+  return 0;
+
+} // end NewFromModule()
+
+} // end namespace itktools
@@ -0,0 +1,109 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __ITKToolsModules_h_
+#define __ITKToolsModules_h_
+
+#include "itkImageIOBase.h"
+#include <string>
+#include <vector>
+
+
+/** Modules: instantiations of the templated class of a tool that are
+ * compiled into separate shared libraries, one per combination of the
+ * dimension and the component types, instead of into the executable.
+ * With ITKTOOLS_BUILD_MODULES the tools that support this only load the
+ * module of the combination of their input, see ADD_ITKTOOL_MODULE in
+ * CMakeMacros.cmake. A module is named
+ *   px<tool>-<dim>D-<type>[-<type>...]
+ * with the component types as ITK names them, e.g.
+ * pxunaryimageoperator-3D-double-float, followed by the platform suffix
+ * of loadable modules. It is searched for in the directories in the
+ * environment variable ITKTOOLS_MODULE_PATH, then in the build and the
+ * install directory of ITKTools.
+ */
+
+/** The symbol a module exports. */
+#if defined( _WIN32 )
+#define ITKTOOLS_MODULE_EXPORT __declspec( dllexport )
+#else
+#define ITKTOOLS_MODULE_EXPORT __attribute__ ((visibility ("default")))
+#endif
+
+/** Define the creation function of a module, which returns a new object
+ * as a pointer to its untemplated base class. The object is typically a
+ * typedef, since a template argument list contains commas.
+ */
+#define itktoolsModuleMacro( object, base )                                     \
+extern "C" ITKTOOLS_MODULE_EXPORT void * itktoolsModuleNew( void )              \
+{                                                                               \
+  return static_cast< void * >( static_cast< base * >( new object ) );          \
+}
+
+namespace itktools
+{
+
+/** The name of the module of a tool, without the platform suffix. */
+std::string GetModuleName( const std::string & tool, unsigned int dim,
+  const std::vector<itk::ImageIOBase::IOComponentType> & componentTypes );
+
+/** Load the module of a tool and create its object, as a pointer to the
+ * untemplated base class. Returns 0 if the module does not exist, i.e.
+ * the combination is not supported, and also, with an error message, if
+ * it could not be loaded. A loaded module is never unloaded, since the
+ * code of the object is in it.
+ */
+void * NewFromModule( const std::string & tool, unsigned int dim,
+  const std::vector<itk::ImageIOBase::IOComponentType> & componentTypes );
+
+/** NewFromModule for the tools with one, two or three component types,
+ * the counterparts of itktoolsOneTypeNewMacro, itktoolsTwoTypeNewMacro and
+ * itktoolsThreeTypeNewMacro.
+ */
+template< class TBase >
+TBase * NewFromModule( const std::string & tool, unsigned int dim,
+  itk::ImageIOBase::IOComponentType componentType )
+{
+  std::vector<itk::ImageIOBase::IOComponentType> componentTypes( 1, componentType );
+  return static_cast< TBase * >( NewFromModule( tool, dim, componentTypes ) );
+}
+
+template< class TBase >
+TBase * NewFromModule( const std::string & tool, unsigned int dim,
+  itk::ImageIOBase::IOComponentType componentType1,
+  itk::ImageIOBase::IOComponentType componentType2 )
+{
+  std::vector<itk::ImageIOBase::IOComponentType> componentTypes( 1, componentType1 );
+  componentTypes.push_back( componentType2 );
+  return static_cast< TBase * >( NewFromModule( tool, dim, componentTypes ) );
+}
+
+template< class TBase >
+TBase * NewFromModule( const std::string & tool, unsigned int dim,
+  itk::ImageIOBase::IOComponentType componentType1,
+  itk::ImageIOBase::IOComponentType componentType2,
+  itk::ImageIOBase::IOComponentType componentType3 )
+{
+  std::vector<itk::ImageIOBase::IOComponentType> componentTypes( 1, componentType1 );
+  componentTypes.push_back( componentType2 );
+  componentTypes.push_back( componentType3 );
+  return static_cast< TBase * >( NewFromModule( tool, dim, componentTypes ) );
+}
+
+} // end namespace itktools
+
+#endif // end #ifndef __ITKToolsModules_h_
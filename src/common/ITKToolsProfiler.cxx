@@ -0,0 +1,284 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#include "ITKToolsProfiler.h"
+
+#include "itkCommand.h"
+#include <fstream>
+#include <iomanip>
+
+#if defined( _WIN32 )
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+
+namespace itktools
+{
+
+/** \class ProfilerCommand
+ * \brief Starts and stops a stage of a Profiler on StartEvent and EndEvent.
+ */
+
+class ProfilerCommand : public itk::Command
+{
+public:
+  typedef ProfilerCommand                 Self;
+  typedef itk::Command                    Superclass;
+  typedef itk::SmartPointer< Self >       Pointer;
+
+  itkNewMacro( Self );
+
+  void SetProfiler( Profiler * profiler, const std::string & stageName )
+  {
+    this->m_Profiler = profiler;
+    this->m_StageName = stageName;
+  }
+
+  virtual void Execute( itk::Object * caller, const itk::EventObject & event )
+  {
+    this->Execute( const_cast<const itk::Object *>( caller ), event );
+  }
+
+  virtual void Execute( const itk::Object *, const itk::EventObject & event )
+  {
+    if( itk::StartEvent().CheckEvent( &event ) )
+    {
+      this->m_Profiler->Start( this->m_StageName );
+    }
+    else if( itk::EndEvent().CheckEvent( &event ) )
+    {
+      this->m_Profiler->Stop( this->m_StageName );
+    }
+  }
+
+protected:
+  ProfilerCommand() { this->m_Profiler = 0; }
+
+private:
+  Profiler *    m_Profiler;
+  std::string   m_StageName;
+
+}; // end class ProfilerCommand
+
+
+/**
+ * ***************** Profiler ************************
+ */
+
+Profiler::Profiler()
+{
+} // end Profiler()
+
+
+/**
+ * ***************** Start ************************
+ */
+
+void
+Profiler::Start( const std::string & stageName )
+{
+  if( this->m_Stages.find( stageName ) == this->m_Stages.end() )
+  {
+    this->m_StageNames.push_back( stageName );
+  }
+
+  StageType & stage = this->m_Stages[ stageName ];
+  stage.m_CPUStart = std::clock();
+  stage.m_WallTime.Start();
+
+} // end Start()
+
+
+/**
+ * ***************** Stop ************************
+ */
+
+void
+Profiler::Stop( const std::string & stageName )
+{
+  std::map< std::string, StageType >::iterator it
+    = this->m_Stages.find( stageName );
+  if( it == this->m_Stages.end() ) return;
+
+  StageType & stage = it->second;
+  stage.m_WallTime.Stop();
+  stage.m_CPUTime += static_cast<double>( std::clock() - stage.m_CPUStart )
+    / static_cast<double>( CLOCKS_PER_SEC );
+  stage.m_PeakMemory = GetPeakMemoryUsage();
+
+} // end Stop()
+
+
+/**
+ * ***************** Observe ************************
+ */
+
+void
+Profiler::Observe( itk::ProcessObject * process, const std::string & stageName )
+{
+  ProfilerCommand::Pointer command = ProfilerCommand::New();
+  command->SetProfiler( this, stageName );
+  process->AddObserver( itk::StartEvent(), command );
+  process->AddObserver( itk::EndEvent(), command );
+
+} // end Observe()
+
+
+/**
+ * ***************** AddNote ************************
+ */
+
+void
+Profiler::AddNote( const std::string & name, const std::string & value )
+{
+  for( std::size_t i = 0; i < this->m_Notes.size(); ++i )
+  {
+    if( this->m_Notes[ i ].first == name )
+    {
+      this->m_Notes[ i ].second = value;
+      return;
+    }
+  }
+  this->m_Notes.push_back( std::make_pair( name, value ) );
+
+} // end AddNote()
+
+
+/**
+ * ***************** EscapeJSON ************************
+ */
+
+static std::string EscapeJSON( const std::string & text )
+{
+  std::string escaped;
+  for( std::size_t i = 0; i < text.size(); ++i )
+  {
+    if( text[ i ] == '"' || text[ i ] == '\\' ) escaped += '\\';
+    escaped += text[ i ];
+  }
+  return escaped;
+
+} // end EscapeJSON()
+
+
+/**
+ * ***************** Print ************************
+ */
+
+void
+Profiler::Print( std::ostream & os ) const
+{
+  os << std::left << std::setw( 24 ) << "stage"
+    << std::right << std::setw( 8 ) << "count"
+    << std::setw( 14 ) << "wall (s)"
+    << std::setw( 14 ) << "cpu (s)"
+    << std::setw( 16 ) << "peak RSS (MB)" << "\n";
+
+  for( std::size_t i = 0; i < this->m_StageNames.size(); ++i )
+  {
+    const StageType & stage = this->m_Stages.find( this->m_StageNames[ i ] )->second;
+    os << std::left << std::setw( 24 ) << this->m_StageNames[ i ]
+      << std::right << std::setw( 8 ) << stage.m_WallTime.GetNumberOfStops()
+      << std::fixed << std::setprecision( 3 )
+      << std::setw( 14 ) << stage.m_WallTime.GetTotal()
+      << std::setw( 14 ) << stage.m_CPUTime
+      << std::setprecision( 1 )
+      << std::setw( 16 ) << stage.m_PeakMemory << "\n";
+  }
+  for( std::size_t i = 0; i < this->m_Notes.size(); ++i )
+  {
+    os << this->m_Notes[ i ].first << ": " << this->m_Notes[ i ].second << "\n";
+  }
+  os << std::flush;
+
+} // end Print()
+
+
+/**
+ * ***************** WriteJSON ************************
+ */
+
+bool
+Profiler::WriteJSON( const std::string & fileName ) const
+{
+  std::ofstream file( fileName.c_str() );
+  if( !file.is_open() ) return false;
+
+  file << "{\n  \"stages\": [";
+  for( std::size_t i = 0; i < this->m_StageNames.size(); ++i )
+  {
+    const StageType & stage = this->m_Stages.find( this->m_StageNames[ i ] )->second;
+    file << ( i == 0 ? "\n" : ",\n" )
+      << "    { \"name\": \"" << this->m_StageNames[ i ] << "\""
+      << ", \"count\": " << stage.m_WallTime.GetNumberOfStops()
+      << std::fixed << std::setprecision( 6 )
+      << ", \"wallTime\": " << stage.m_WallTime.GetTotal()
+      << ", \"cpuTime\": " << stage.m_CPUTime
+      << std::setprecision( 3 )
+      << ", \"peakMemoryMB\": " << stage.m_PeakMemory << " }";
+  }
+  file << "\n  ]";
+  if( !this->m_Notes.empty() )
+  {
+    file << ",\n  \"notes\": {";
+    for( std::size_t i = 0; i < this->m_Notes.size(); ++i )
+    {
+      file << ( i == 0 ? "\n" : ",\n" )
+        << "    \"" << EscapeJSON( this->m_Notes[ i ].first ) << "\": \""
+        << EscapeJSON( this->m_Notes[ i ].second ) << "\"";
+    }
+    file << "\n  }";
+  }
+  file << "\n}\n";
+
+  return !file.fail();
+
+} // end WriteJSON()
+
+
+/**
+ * ***************** GetPeakMemoryUsage ************************
+ */
+
+double
+Profiler::GetPeakMemoryUsage( void )
+{
+#if defined( _WIN32 )
+  PROCESS_MEMORY_COUNTERS counters;
+  if( GetProcessMemoryInfo( GetCurrentProcess(), &counters, sizeof( counters ) ) )
+  {
+    return static_cast<double>( counters.PeakWorkingSetSize ) / 1048576.0;
+  }
+  return 0.0;
+#else
+  struct rusage usage;
+  if( getrusage( RUSAGE_SELF, &usage ) != 0 ) return 0.0;
+#if defined( __APPLE__ )
+  /** ru_maxrss is in bytes on Mac, and in kilobytes elsewhere. */
+  return static_cast<double>( usage.ru_maxrss ) / 1048576.0;
+#else
+  return static_cast<double>( usage.ru_maxrss ) / 1024.0;
+#endif
+#endif
+
+} // end GetPeakMemoryUsage()
+
+
+} // end namespace itktools
@@ -0,0 +1,97 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __ITKToolsProfiler_h_
+#define __ITKToolsProfiler_h_
+
+#include <ctime>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include "itkProcessObject.h"
+#include "itkTimeProbe.h"
+
+
+namespace itktools
+{
+
+/** \class Profiler
+ * \brief Records the wall time, CPU time and peak memory of the stages of a tool.
+ *
+ * A stage is started and stopped explicitly, or by the StartEvent and
+ * EndEvent of a process object passed to Observe(). A stage that is run
+ * several times, e.g. when streaming, accumulates its times.
+ * Note that the stages nest: the StartEvent of an ImageFileWriter is
+ * invoked before, and its EndEvent after, the update of its input, so the
+ * writer stage always includes the complete upstream pipeline, and the
+ * time of every observed upstream stage is counted again in it. The same
+ * holds for a filter that updates its input itself, e.g. a streaming filter.
+ * Stages are therefore not additive; the writer time minus that of the
+ * upstream stages is the time of the actual writing.
+ */
+
+class Profiler
+{
+public:
+  Profiler();
+
+  /** Start and stop a stage. */
+  void Start( const std::string & stageName );
+  void Stop( const std::string & stageName );
+
+  /** Add observers to a process object, timing its execution as a stage. */
+  void Observe( itk::ProcessObject * process, const std::string & stageName );
+
+  /** Add a note, e.g. a decision the tool made, to the profile. A note
+   * with the same name is replaced. */
+  void AddNote( const std::string & name, const std::string & value );
+
+  /** Print a table with the stages, followed by the notes. */
+  void Print( std::ostream & os ) const;
+
+  /** Write the stages to a JSON file. Returns false on failure. */
+  bool WriteJSON( const std::string & fileName ) const;
+
+  /** Get the peak resident memory of this process in MB, if available. */
+  static double GetPeakMemoryUsage( void );
+
+private:
+  Profiler( const Profiler & );     // purposely not implemented
+  void operator=( const Profiler & ); // purposely not implemented
+
+  struct StageType
+  {
+    StageType() : m_CPUTime( 0.0 ), m_CPUStart( 0 ), m_PeakMemory( 0.0 ) {}
+    itk::TimeProbe  m_WallTime;
+    double          m_CPUTime;
+    std::clock_t    m_CPUStart;
+    double          m_PeakMemory;
+  };
+
+  /** The stages, and their names in the order they were first started. */
+  std::map< std::string, StageType >  m_Stages;
+  std::vector< std::string >          m_StageNames;
+
+  /** The notes, in the order they were first added. */
+  std::vector< std::pair< std::string, std::string > > m_Notes;
+
+}; // end class Profiler
+
+} // end namespace itktools
+
+#endif // end #ifndef __ITKToolsProfiler_h_
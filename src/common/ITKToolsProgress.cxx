@@ -0,0 +1,279 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#include "ITKToolsProgress.h"
+
+#include "itkCommand.h"
+#include "itkCommandLineArgumentParser.h"
+#include <itksys/SystemTools.hxx>
+#include <csignal>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+
+
+namespace itktools
+{
+
+/** The state of the monitor. The flag is set by the signal handler. */
+static bool                           s_ReportProgress = false;
+static std::string                    s_CancelFileName = "";
+static bool                           s_SignalHandlerInstalled = false;
+static volatile std::sig_atomic_t     s_Cancelled = 0;
+static std::time_t                    s_LastCancelFileCheck = 0;
+
+
+/**
+ * ***************** HandleTerminationSignal ************************
+ */
+
+static void HandleTerminationSignal( int signalNumber )
+{
+  /** Only setting the flag is safe here. The default is restored,
+   * so that a second signal terminates the process. */
+  s_Cancelled = 1;
+  std::signal( signalNumber, SIG_DFL );
+
+} // end HandleTerminationSignal()
+
+
+/** \class ProgressCommand
+ * \brief Reports the progress of a stage, and aborts it when cancelled.
+ */
+
+class ProgressCommand : public itk::Command
+{
+public:
+  typedef ProgressCommand                 Self;
+  typedef itk::Command                    Superclass;
+  typedef itk::SmartPointer< Self >       Pointer;
+
+  itkNewMacro( Self );
+
+  void SetStageName( const std::string & stageName )
+  {
+    this->m_StageName = stageName;
+  }
+
+  virtual void Execute( itk::Object * caller, const itk::EventObject & event )
+  {
+    itk::ProcessObject * process = dynamic_cast< itk::ProcessObject * >( caller );
+    if( !process ) return;
+
+    if( itk::StartEvent().CheckEvent( &event ) )
+    {
+      this->m_LastPercentage = -1;
+    }
+    else if( itk::ProgressEvent().CheckEvent( &event ) )
+    {
+      this->Report( process->GetProgress() );
+      if( ProgressMonitor::IsCancelled() && !process->GetAbortGenerateData() )
+      {
+        std::cerr << "CANCELLED " << this->m_StageName << std::endl;
+        process->AbortGenerateDataOn();
+      }
+    }
+    else if( itk::EndEvent().CheckEvent( &event ) )
+    {
+      /** Filters that do not check AbortGenerateData stop here. */
+      ProgressMonitor::ThrowIfCancelled();
+      this->Report( 1.0f );
+    }
+  }
+
+  virtual void Execute( const itk::Object *, const itk::EventObject & )
+  {
+  }
+
+protected:
+  ProgressCommand() { this->m_LastPercentage = -1; }
+
+  /** Print a line for every whole percent. */
+  void Report( const float progress )
+  {
+    if( !s_ReportProgress ) return;
+    const int percentage = static_cast<int>( 100.0f * progress );
+    if( percentage == this->m_LastPercentage ) return;
+    this->m_LastPercentage = percentage;
+
+    std::cerr << "PROGRESS " << this->m_StageName << " "
+      << std::fixed << std::setprecision( 2 ) << 0.01 * percentage
+      << std::endl;
+  }
+
+private:
+  std::string   m_StageName;
+  int           m_LastPercentage;
+
+}; // end class ProgressCommand
+
+
+/**
+ * ***************** SetReportProgress ************************
+ */
+
+void
+ProgressMonitor::SetReportProgress( bool report )
+{
+  s_ReportProgress = report;
+
+} // end SetReportProgress()
+
+
+/**
+ * ***************** GetReportProgress ************************
+ */
+
+bool
+ProgressMonitor::GetReportProgress( void )
+{
+  return s_ReportProgress;
+
+} // end GetReportProgress()
+
+
+/**
+ * ***************** SetCancelFileName ************************
+ */
+
+void
+ProgressMonitor::SetCancelFileName( const std::string & fileName )
+{
+  s_CancelFileName = fileName;
+  s_LastCancelFileCheck = 0;
+
+} // end SetCancelFileName()
+
+
+/**
+ * ***************** InstallSignalHandler ************************
+ */
+
+void
+ProgressMonitor::InstallSignalHandler( void )
+{
+  if( s_SignalHandlerInstalled ) return;
+  std::signal( SIGTERM, HandleTerminationSignal );
+  s_SignalHandlerInstalled = true;
+
+} // end InstallSignalHandler()
+
+
+/**
+ * ***************** GetEnabled ************************
+ */
+
+bool
+ProgressMonitor::GetEnabled( void )
+{
+  return s_ReportProgress || s_SignalHandlerInstalled || !s_CancelFileName.empty();
+
+} // end GetEnabled()
+
+
+/**
+ * ***************** Cancel ************************
+ */
+
+void
+ProgressMonitor::Cancel( void )
+{
+  s_Cancelled = 1;
+
+} // end Cancel()
+
+
+/**
+ * ***************** IsCancelled ************************
+ */
+
+bool
+ProgressMonitor::IsCancelled( void )
+{
+  if( s_Cancelled ) return true;
+
+  /** Look for the control file at most once per second. */
+  if( !s_CancelFileName.empty() )
+  {
+    const std::time_t now = std::time( 0 );
+    if( now != s_LastCancelFileCheck )
+    {
+      s_LastCancelFileCheck = now;
+      if( itksys::SystemTools::FileExists( s_CancelFileName.c_str() ) )
+      {
+        s_Cancelled = 1;
+      }
+    }
+  }
+  return s_Cancelled != 0;
+
+} // end IsCancelled()
+
+
+/**
+ * ***************** Observe ************************
+ */
+
+void
+ProgressMonitor::Observe( itk::ProcessObject * process, const std::string & stageName )
+{
+  if( !GetEnabled() ) return;
+
+  ProgressCommand::Pointer command = ProgressCommand::New();
+  command->SetStageName( stageName );
+  process->AddObserver( itk::StartEvent(), command );
+  process->AddObserver( itk::ProgressEvent(), command );
+  process->AddObserver( itk::EndEvent(), command );
+
+} // end Observe()
+
+
+/**
+ * ***************** ThrowIfCancelled ************************
+ */
+
+void
+ProgressMonitor::ThrowIfCancelled( void )
+{
+  if( !IsCancelled() ) return;
+
+  itk::ProcessAborted exception( __FILE__, __LINE__ );
+  exception.SetDescription( "The tool was cancelled." );
+  throw exception;
+
+} // end ThrowIfCancelled()
+
+
+/**
+ * ***************** ReadProgressArguments ************************
+ */
+
+void ReadProgressArguments( itk::CommandLineArgumentParser * parser )
+{
+  const bool retprogress = parser->ArgumentExists( "-progress" );
+
+  std::string cancelFileName = "";
+  const bool retcancel = parser->GetCommandLineArgument( "-cancelFile", cancelFileName );
+
+  if( retprogress ) ProgressMonitor::SetReportProgress( true );
+  if( retcancel ) ProgressMonitor::SetCancelFileName( cancelFileName );
+  if( retprogress || retcancel ) ProgressMonitor::InstallSignalHandler();
+
+} // end ReadProgressArguments()
+
+
+} // end namespace itktools
@@ -0,0 +1,96 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __ITKToolsProgress_h_
+#define __ITKToolsProgress_h_
+
+#include <string>
+#include "itkProcessObject.h"
+
+namespace itk
+{
+class CommandLineArgumentParser;
+}
+
+
+namespace itktools
+{
+
+/** \class ProgressMonitor
+ * \brief Reports the progress of the filters of a tool, and cancels them on request.
+ *
+ * With -progress, every observed process object prints a line
+ *   PROGRESS <stage> <fraction>
+ * to std::cerr when it starts, every whole percent, and when it ends, so
+ * that a scheduler can follow a long running tool. The fraction, between
+ * 0 and 1, is the last field; the stage name may contain spaces.
+ *
+ * A tool is cancelled by SIGTERM, or by creating the file given with
+ * -cancelFile, which is checked at most once per second. On the next
+ * progress event the running filter is asked to stop through
+ * AbortGenerateData, and at the latest when it ends a ProcessAborted
+ * exception is thrown. The tool then unwinds through its usual error
+ * handling, releasing its images, and exits with a failure. A second
+ * SIGTERM terminates the process immediately.
+ *
+ * The monitor is process wide; all members are static.
+ */
+
+class ProgressMonitor
+{
+public:
+  /** Switch the progress lines on or off. Default off. */
+  static void SetReportProgress( bool report );
+  static bool GetReportProgress( void );
+
+  /** Set the control file whose existence cancels the tool. */
+  static void SetCancelFileName( const std::string & fileName );
+
+  /** Route SIGTERM to a cancellation, instead of terminating. */
+  static void InstallSignalHandler( void );
+
+  /** Whether the tool is observed at all, i.e. progress is reported or
+   * a cancellation can be requested. */
+  static bool GetEnabled( void );
+
+  /** Request a cancellation, and check if one was requested. */
+  static void Cancel( void );
+  static bool IsCancelled( void );
+
+  /** Observe a process object as a stage. Does nothing if not enabled. */
+  static void Observe( itk::ProcessObject * process, const std::string & stageName );
+
+  /** Throw a ProcessAborted exception if the tool was cancelled, for
+   * tools that check in between their own steps. */
+  static void ThrowIfCancelled( void );
+
+}; // end class ProgressMonitor
+
+
+/** Read the progress arguments that are shared by all tools, and set up
+ * the ProgressMonitor:
+ *   [-progress]    print machine-readable progress lines
+ *   [-cancelFile]  cancel the tool when this file appears
+ * With either argument, SIGTERM cancels the tool as well. Called by
+ * ITKToolsBase::ReadCommonArguments(); tools that do not use
+ * ITKToolsBase call it directly after checking the arguments.
+ */
+void ReadProgressArguments( itk::CommandLineArgumentParser * parser );
+
+} // end namespace itktools
+
+#endif // end #ifndef __ITKToolsProgress_h_
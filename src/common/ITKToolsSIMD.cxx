@@ -0,0 +1,325 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#include "ITKToolsSIMD.h"
+#include "itkCommandLineArgumentParser.h"
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#if defined( _MSC_VER ) && ( defined( _M_X64 ) || defined( _M_IX86 ) )
+#include <intrin.h>
+#define ITKTOOLS_SIMD_CPUID_MSVC
+#elif ( defined( __GNUC__ ) || defined( __clang__ ) ) \
+  && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#include <cpuid.h>
+#define ITKTOOLS_SIMD_CPUID_GNU
+#endif
+
+namespace itktools
+{
+
+/** The detected features, and the active level. */
+struct SIMDState
+{
+  SIMDState() : m_Detected( false ), m_DetectedLevel( SIMDScalar ),
+    m_Level( SIMDScalar ), m_LevelSet( false ) {}
+  bool                      m_Detected;
+  SIMDLevel                 m_DetectedLevel;
+  SIMDLevel                 m_Level;
+  bool                      m_LevelSet;
+  std::vector<std::string>  m_Features;
+};
+
+static SIMDState & GetSIMDState( void )
+{
+  static SIMDState state;
+  return state;
+}
+
+
+/**
+ * ***************** CPUID ************************
+ */
+
+#if defined( ITKTOOLS_SIMD_CPUID_MSVC ) || defined( ITKTOOLS_SIMD_CPUID_GNU )
+
+/** The registers eax, ebx, ecx, edx of cpuid leaf, subleaf. */
+static void CPUID( unsigned int leaf, unsigned int subleaf, unsigned int regs[ 4 ] )
+{
+#if defined( ITKTOOLS_SIMD_CPUID_MSVC )
+  int r[ 4 ];
+  __cpuidex( r, static_cast<int>( leaf ), static_cast<int>( subleaf ) );
+  for( unsigned int i = 0; i < 4; ++i ) regs[ i ] = static_cast<unsigned int>( r[ i ] );
+#else
+  regs[ 0 ] = regs[ 1 ] = regs[ 2 ] = regs[ 3 ] = 0;
+  __cpuid_count( leaf, subleaf, regs[ 0 ], regs[ 1 ], regs[ 2 ], regs[ 3 ] );
+#endif
+} // end CPUID()
+
+
+/** The register state the operating system saves, XCR0. */
+static unsigned long long XGETBV( void )
+{
+#if defined( ITKTOOLS_SIMD_CPUID_MSVC )
+  return _xgetbv( 0 );
+#else
+  unsigned int eax = 0, edx = 0;
+  __asm__ __volatile__( "xgetbv" : "=a"( eax ), "=d"( edx ) : "c"( 0 ) );
+  return ( static_cast<unsigned long long>( edx ) << 32 ) | eax;
+#endif
+} // end XGETBV()
+
+#endif
+
+
+/**
+ * ***************** DetectSIMD ************************
+ */
+
+static void DetectSIMD( SIMDState & state )
+{
+  state.m_Detected = true;
+  state.m_DetectedLevel = SIMDScalar;
+
+#if defined( ITKTOOLS_SIMD_CPUID_MSVC ) || defined( ITKTOOLS_SIMD_CPUID_GNU )
+  unsigned int regs[ 4 ];
+  CPUID( 0, 0, regs );
+  const unsigned int maximumLeaf = regs[ 0 ];
+  if( maximumLeaf < 1 ) return;
+
+  CPUID( 1, 0, regs );
+  const unsigned int ecx1 = regs[ 2 ];
+  const unsigned int edx1 = regs[ 3 ];
+  unsigned int ebx7 = 0;
+  if( maximumLeaf >= 7 )
+  {
+    CPUID( 7, 0, regs );
+    ebx7 = regs[ 1 ];
+  }
+
+  /** The YMM and ZMM registers must be saved by the operating system. */
+  unsigned long long xcr0 = 0;
+  if( ecx1 & ( 1u << 27 ) ) xcr0 = XGETBV(); // OSXSAVE
+  const bool ymm = ( xcr0 & 0x6 ) == 0x6;
+  const bool zmm = ymm && ( xcr0 & 0xE0 ) == 0xE0;
+
+  const bool sse2   = ( edx1 & ( 1u << 26 ) ) != 0;
+  const bool sse42  = ( ecx1 & ( 1u << 20 ) ) != 0;
+  const bool avx    = ymm && ( ecx1 & ( 1u << 28 ) ) != 0;
+  const bool fma    = avx && ( ecx1 & ( 1u << 12 ) ) != 0;
+  const bool avx2   = avx && ( ebx7 & ( 1u << 5 ) ) != 0;
+  const bool avx512f  = zmm && ( ebx7 & ( 1u << 16 ) ) != 0;
+  const bool avx512dq = zmm && ( ebx7 & ( 1u << 17 ) ) != 0;
+  const bool avx512bw = zmm && ( ebx7 & ( 1u << 30 ) ) != 0;
+  const bool avx512vl = zmm && ( ebx7 & ( 1u << 31 ) ) != 0;
+
+  if( sse2 ) state.m_Features.push_back( "sse2" );
+  if( sse42 ) state.m_Features.push_back( "sse4.2" );
+  if( avx ) state.m_Features.push_back( "avx" );
+  if( avx2 ) state.m_Features.push_back( "avx2" );
+  if( fma ) state.m_Features.push_back( "fma" );
+  if( avx512f ) state.m_Features.push_back( "avx512f" );
+  if( avx512dq ) state.m_Features.push_back( "avx512dq" );
+  if( avx512bw ) state.m_Features.push_back( "avx512bw" );
+  if( avx512vl ) state.m_Features.push_back( "avx512vl" );
+
+  if( sse2 ) state.m_DetectedLevel = SIMDSSE2;
+  if( sse2 && sse42 ) state.m_DetectedLevel = SIMDSSE42;
+  if( sse2 && sse42 && avx2 ) state.m_DetectedLevel = SIMDAVX2;
+  if( sse2 && sse42 && avx2 && avx512f && avx512dq && avx512bw && avx512vl )
+  {
+    state.m_DetectedLevel = SIMDAVX512;
+  }
+#elif defined( __aarch64__ ) || defined( __ARM_NEON )
+  /** NEON is part of AArch64, and required by builds with __ARM_NEON. */
+  state.m_Features.push_back( "neon" );
+  state.m_DetectedLevel = SIMDNEON;
+#endif
+
+} // end DetectSIMD()
+
+
+/**
+ * ***************** GetDetectedLevel ************************
+ */
+
+SIMDLevel
+SIMD::GetDetectedLevel( void )
+{
+  SIMDState & state = GetSIMDState();
+  if( !state.m_Detected ) DetectSIMD( state );
+  return state.m_DetectedLevel;
+
+} // end GetDetectedLevel()
+
+
+/**
+ * ***************** IsSupported ************************
+ */
+
+bool
+SIMD::IsSupported( SIMDLevel level )
+{
+  for( SIMDLevel supported = GetDetectedLevel(); ;
+    supported = GetFallbackLevel( supported ) )
+  {
+    if( supported == level ) return true;
+    if( supported == SIMDScalar ) return false;
+  }
+
+} // end IsSupported()
+
+
+/**
+ * ***************** GetLevel ************************
+ */
+
+SIMDLevel
+SIMD::GetLevel( void )
+{
+  const SIMDState & state = GetSIMDState();
+  return state.m_LevelSet ? state.m_Level : GetDetectedLevel();
+
+} // end GetLevel()
+
+
+/**
+ * ***************** SetLevel ************************
+ */
+
+bool
+SIMD::SetLevel( SIMDLevel level )
+{
+  if( !IsSupported( level ) ) return false;
+
+  SIMDState & state = GetSIMDState();
+  state.m_Level = level;
+  state.m_LevelSet = true;
+  return true;
+
+} // end SetLevel()
+
+
+/**
+ * ***************** GetFallbackLevel ************************
+ */
+
+SIMDLevel
+SIMD::GetFallbackLevel( SIMDLevel level )
+{
+  switch( level )
+  {
+    case SIMDAVX512: return SIMDAVX2;
+    case SIMDAVX2:   return SIMDSSE42;
+    case SIMDSSE42:  return SIMDSSE2;
+    default:         return SIMDScalar;
+  }
+
+} // end GetFallbackLevel()
+
+
+/**
+ * ***************** GetLevelName ************************
+ */
+
+std::string
+SIMD::GetLevelName( SIMDLevel level )
+{
+  switch( level )
+  {
+    case SIMDSSE2:   return "sse2";
+    case SIMDSSE42:  return "sse4.2";
+    case SIMDAVX2:   return "avx2";
+    case SIMDAVX512: return "avx512";
+    case SIMDNEON:   return "neon";
+    default:         return "scalar";
+  }
+
+} // end GetLevelName()
+
+
+/**
+ * ***************** GetLevelFromName ************************
+ */
+
+bool
+SIMD::GetLevelFromName( const std::string & name, SIMDLevel & level )
+{
+  for( unsigned int i = 0; i < NumberOfSIMDLevels; ++i )
+  {
+    if( name == GetLevelName( static_cast<SIMDLevel>( i ) ) )
+    {
+      level = static_cast<SIMDLevel>( i );
+      return true;
+    }
+  }
+  return false;
+
+} // end GetLevelFromName()
+
+
+/**
+ * ***************** GetReport ************************
+ */
+
+std::string
+SIMD::GetReport( void )
+{
+  const SIMDState & state = GetSIMDState();
+  std::ostringstream report;
+  report << GetLevelName( GetLevel() )
+    << " (detected " << GetLevelName( GetDetectedLevel() ) << ":";
+  for( unsigned int i = 0; i < state.m_Features.size(); ++i )
+  {
+    report << " " << state.m_Features[ i ];
+  }
+  if( state.m_Features.empty() ) report << " none";
+  report << ")";
+#ifndef ITKTOOLS_SIMD_TARGETS
+  report << ", built without variants";
+#endif
+  return report.str();
+
+} // end GetReport()
+
+
+/**
+ * ***************** ReadSIMDArguments ************************
+ */
+
+void ReadSIMDArguments( itk::CommandLineArgumentParser * parser )
+{
+  std::string simd = "";
+  if( !parser->GetCommandLineArgument( "-simd", simd ) || simd == "auto" ) return;
+
+  SIMDLevel level = SIMDScalar;
+  if( !SIMD::GetLevelFromName( simd, level ) )
+  {
+    std::cerr << "WARNING: -simd should be one of auto, scalar, sse2, sse4.2, avx2,\n"
+      << "  avx512 or neon, not \"" << simd << "\". The argument -simd is ignored." << std::endl;
+  }
+  else if( !SIMD::SetLevel( level ) )
+  {
+    std::cerr << "WARNING: this CPU does not support " << simd << ", the best it supports is "
+      << SIMD::GetLevelName( SIMD::GetDetectedLevel() ) << ".\n"
+      << "  The argument -simd is ignored." << std::endl;
+  }
+
+} // end ReadSIMDArguments()
+
+} // end namespace itktools
@@ -0,0 +1,167 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __ITKToolsSIMD_h_
+#define __ITKToolsSIMD_h_
+
+#include <string>
+
+namespace itk
+{
+class CommandLineArgumentParser;
+}
+
+/** Attributes that compile a function for an instruction set, in addition
+ * to the baseline of the build, so that one binary carries variants of a
+ * kernel for several CPUs. They are defined on x86 with GCC and Clang only;
+ * elsewhere ITKTOOLS_SIMD_TARGETS is not defined and the kernels have their
+ * baseline variant only. A function compiled for a target can inline the
+ * baseline code it calls, e.g. the operator() of a functor.
+ *
+ * The variants do not contract a * b + c to a fused multiply-add, so that
+ * they give the same results as the baseline: GCC through the attribute,
+ * Clang through ITKTOOLS_SIMD_BEGIN, which starts the body of a variant.
+ */
+#if ( defined( __GNUC__ ) || defined( __clang__ ) ) \
+  && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#define ITKTOOLS_SIMD_TARGETS
+#if defined( __clang__ )
+#define ITKTOOLS_TARGET_SSE42   __attribute__(( target( "sse4.2" ) ))
+#define ITKTOOLS_TARGET_AVX2    __attribute__(( target( "avx2" ) ))
+#define ITKTOOLS_TARGET_AVX512  __attribute__(( target( "avx512f,avx512dq,avx512bw,avx512vl" ) ))
+#define ITKTOOLS_SIMD_BEGIN     _Pragma( "clang fp contract(off)" )
+#else
+#define ITKTOOLS_TARGET_SSE42   __attribute__(( target( "sse4.2" ) ))
+#define ITKTOOLS_TARGET_AVX2    __attribute__(( target( "avx2" ) ))
+#define ITKTOOLS_TARGET_AVX512  __attribute__(( target( "avx512f,avx512dq,avx512bw,avx512vl" ), \
+  optimize( "fp-contract=off" ) ))
+#define ITKTOOLS_SIMD_BEGIN
+#endif
+#endif
+
+
+namespace itktools
+{
+
+/** The instruction sets that kernels are compiled for. On x86 every level
+ * includes the ones below it; NEON only includes scalar. */
+enum SIMDLevel { SIMDScalar = 0, SIMDSSE2, SIMDSSE42, SIMDAVX2, SIMDAVX512,
+  SIMDNEON, NumberOfSIMDLevels };
+
+
+/** \class SIMD
+ * \brief Detects the instruction sets of the CPU, and selects the one the kernels use.
+ *
+ * The CPU is queried once, on first use. The active level is the best
+ * detected level, unless it is lowered with SetLevel(), e.g. by -simd to
+ * compare variants or to work around a problem. AVX2 requires the operating
+ * system to save the YMM registers, and AVX-512 the ZMM registers.
+ *
+ * The level is process wide; all members are static.
+ */
+
+class SIMD
+{
+public:
+  /** The best level the CPU and the operating system support. */
+  static SIMDLevel GetDetectedLevel( void );
+
+  /** Whether the CPU supports a level. */
+  static bool IsSupported( SIMDLevel level );
+
+  /** Get and set the level used by the kernels. A level that is not
+   * supported is not set, and false is returned. */
+  static SIMDLevel GetLevel( void );
+  static bool SetLevel( SIMDLevel level );
+
+  /** The level below a level, whose kernels can run instead. */
+  static SIMDLevel GetFallbackLevel( SIMDLevel level );
+
+  /** Convert between levels and their names: scalar, sse2, sse4.2, avx2,
+   * avx512 and neon. */
+  static std::string GetLevelName( SIMDLevel level );
+  static bool GetLevelFromName( const std::string & name, SIMDLevel & level );
+
+  /** The used and the detected level, and the detected features, for the
+   * profile, e.g. "avx2 (detected avx512: sse2 sse4.2 avx avx2 fma avx512f)". */
+  static std::string GetReport( void );
+
+}; // end class SIMD
+
+
+/** \class SIMDDispatch
+ * \brief Selects the variant of a kernel for the active instruction set.
+ *
+ * A kernel is a function with the same signature for all variants,
+ * typically a template instantiated per type and compiled with one of the
+ * ITKTOOLS_TARGET_* attributes per level. The scalar variant is the
+ * baseline and is always present. Get() returns the variant of the active
+ * level, or of the closest level below it that has one. Select the
+ * variant once per call of a filter or thread, outside the hot loop:
+ *
+ *   itktools::SIMDDispatch< RunFunctionType > dispatch( &Run<T> );
+ *   #ifdef ITKTOOLS_SIMD_TARGETS
+ *   dispatch.Set( itktools::SIMDAVX2, &RunAVX2<T> );
+ *   #endif
+ *   const RunFunctionType run = dispatch.Get();
+ */
+
+template< class TFunction >
+class SIMDDispatch
+{
+public:
+  explicit SIMDDispatch( TFunction scalar )
+  {
+    for( unsigned int i = 0; i < NumberOfSIMDLevels; ++i ) this->m_Variants[ i ] = 0;
+    this->m_Variants[ SIMDScalar ] = scalar;
+  }
+
+  /** Set the variant of a level. */
+  void Set( SIMDLevel level, TFunction variant )
+  {
+    this->m_Variants[ level ] = variant;
+  }
+
+  /** Get the variant for the active level. */
+  TFunction Get( void ) const
+  {
+    SIMDLevel level = SIMD::GetLevel();
+    while( level != SIMDScalar && this->m_Variants[ level ] == 0 )
+    {
+      level = SIMD::GetFallbackLevel( level );
+    }
+    return this->m_Variants[ level ];
+  }
+
+private:
+  TFunction m_Variants[ NumberOfSIMDLevels ];
+
+}; // end class SIMDDispatch
+
+
+/** Read the instruction set argument that is shared by all tools:
+ *   [-simd] the instruction set of the kernels, one of {auto, scalar,
+ *           sse2, sse4.2, avx2, avx512, neon}; default auto, the best
+ *           one the CPU supports
+ * A level the CPU does not support is ignored with a warning. Called by
+ * ITKToolsBase::ReadCommonArguments().
+ */
+void ReadSIMDArguments( itk::CommandLineArgumentParser * parser );
+
+} // end namespace itktools
+
+#endif // end #ifndef __ITKToolsSIMD_h_
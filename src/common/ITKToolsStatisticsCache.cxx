@@ -0,0 +1,359 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#include "ITKToolsStatisticsCache.h"
+
+#include "itksys/SystemTools.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace itktools
+{
+
+/** The first line of a statistics cache file, with its version. */
+static const char * StatisticsCacheTag = "itktools statistics 1";
+
+
+/**
+ * ***************** ComputeMomentsFromHistogram ************************
+ */
+
+void ImageStatistics::ComputeMomentsFromHistogram( void )
+{
+  this->Minimum.clear();
+  this->Maximum.clear();
+  this->Mean.clear();
+  this->Sigma.clear();
+  this->NumberOfPixels = 0.0;
+
+  /** Sum the offsets from the first value, which avoids cancellation. */
+  double sum = 0.0;
+  double sumOfSquares = 0.0;
+  std::size_t first = this->Histogram.size();
+  std::size_t last = 0;
+  for( std::size_t i = 0; i < this->Histogram.size(); ++i )
+  {
+    const double count = this->Histogram[ i ];
+    if( count == 0.0 ) continue;
+    if( first == this->Histogram.size() ) first = i;
+    last = i;
+    this->NumberOfPixels += count;
+    sum += count * i;
+    sumOfSquares += count * i * i;
+  }
+  if( this->NumberOfPixels == 0.0 ) return;
+
+  const double n = this->NumberOfPixels;
+  const double variance = n > 1.0
+    ? std::max( ( sumOfSquares - sum * sum / n ) / ( n - 1.0 ), 0.0 ) : 0.0;
+  this->Minimum.push_back( this->HistogramMinimum + first );
+  this->Maximum.push_back( this->HistogramMinimum + last );
+  this->Mean.push_back( this->HistogramMinimum + sum / n );
+  this->Sigma.push_back( std::sqrt( variance ) );
+
+} // end ComputeMomentsFromHistogram()
+
+
+/**
+ * ***************** GetPercentile ************************
+ */
+
+double ImageStatistics::GetPercentile( const double percentage ) const
+{
+  double numberOfPixels = 0.0;
+  for( std::size_t i = 0; i < this->Histogram.size(); ++i )
+  {
+    numberOfPixels += this->Histogram[ i ];
+  }
+  if( numberOfPixels == 0.0 ) return this->HistogramMinimum;
+
+  const double fraction = std::min( std::max( percentage / 100.0, 0.0 ), 1.0 );
+  const double rank = std::floor( fraction * ( numberOfPixels - 1.0 ) );
+  double cumulative = 0.0;
+  for( std::size_t i = 0; i < this->Histogram.size(); ++i )
+  {
+    cumulative += this->Histogram[ i ];
+    if( cumulative > rank ) return this->HistogramMinimum + i;
+  }
+  return this->HistogramMinimum + ( this->Histogram.size() - 1 );
+
+} // end GetPercentile()
+
+
+/**
+ * ***************** IsExactConversion ************************
+ */
+
+/** The number of bits of the values of a component type, without the sign
+ * bit; for floating point types the bits of the significand.
+ */
+static bool GetValueBits( const itk::ImageIOBase::IOComponentType componentType,
+  unsigned int & bits, bool & isSigned, bool & isInteger )
+{
+  isInteger = true;
+  switch( componentType )
+  {
+    case itk::ImageIOBase::UCHAR:  bits = 8;  isSigned = false; break;
+    case itk::ImageIOBase::CHAR:   bits = 7;  isSigned = true;  break;
+    case itk::ImageIOBase::USHORT: bits = 16; isSigned = false; break;
+    case itk::ImageIOBase::SHORT:  bits = 15; isSigned = true;  break;
+    case itk::ImageIOBase::UINT:   bits = 32; isSigned = false; break;
+    case itk::ImageIOBase::INT:    bits = 31; isSigned = true;  break;
+    case itk::ImageIOBase::ULONG:  bits = 8 * sizeof( long );     isSigned = false; break;
+    case itk::ImageIOBase::LONG:   bits = 8 * sizeof( long ) - 1; isSigned = true;  break;
+    case itk::ImageIOBase::FLOAT:  bits = 24; isSigned = true; isInteger = false; break;
+    case itk::ImageIOBase::DOUBLE: bits = 53; isSigned = true; isInteger = false; break;
+    default: return false;
+  }
+  return true;
+
+} // end GetValueBits()
+
+
+bool IsExactConversion(
+  const itk::ImageIOBase::IOComponentType fileComponentType,
+  const itk::ImageIOBase::IOComponentType readComponentType )
+{
+  if( fileComponentType == readComponentType ) return true;
+
+  unsigned int fileBits = 0, readBits = 0;
+  bool fileSigned = false, readSigned = false;
+  bool fileInteger = false, readInteger = false;
+  if( !GetValueBits( fileComponentType, fileBits, fileSigned, fileInteger )
+    || !GetValueBits( readComponentType, readBits, readSigned, readInteger ) )
+  {
+    return false;
+  }
+
+  /** Floating point values only fit in a wider floating point type. */
+  if( !fileInteger ) return !readInteger && readBits >= fileBits;
+  if( fileSigned && !readSigned ) return false;
+  return readBits >= fileBits;
+
+} // end IsExactConversion()
+
+
+/**
+ * ***************** ReadStatisticsCacheFile ************************
+ */
+
+/** Read a statistics cache file, with the size and modification time of
+ * the image, and its component type, when it was written.
+ */
+static bool ReadStatisticsCacheFile(
+  const std::string & filename,
+  ImageStatistics & statistics,
+  unsigned long & fileSize,
+  long & modificationTime,
+  std::string & componentType )
+{
+  std::ifstream cacheFile( ( filename + ".statistics" ).c_str() );
+  std::string line;
+  if( !std::getline( cacheFile, line ) || line != StatisticsCacheTag )
+  {
+    return false;
+  }
+
+  bool hasFile = false;
+  bool hasType = false;
+  while( std::getline( cacheFile, line ) )
+  {
+    std::istringstream fields( line );
+    std::string keyword;
+    if( !( fields >> keyword ) ) continue;
+
+    if( keyword == "file" )
+    {
+      hasFile = !( fields >> fileSize >> modificationTime ).fail();
+    }
+    else if( keyword == "checksum" )
+    {
+      fields >> statistics.Checksum;
+    }
+    else if( keyword == "type" )
+    {
+      hasType = !( fields >> componentType ).fail();
+    }
+    else if( keyword == "pixels" )
+    {
+      fields >> statistics.NumberOfPixels;
+    }
+    else if( keyword == "component" )
+    {
+      double minimum, maximum, mean, sigma;
+      if( !( fields >> minimum >> maximum >> mean >> sigma ) ) return false;
+      statistics.Minimum.push_back( minimum );
+      statistics.Maximum.push_back( maximum );
+      statistics.Mean.push_back( mean );
+      statistics.Sigma.push_back( sigma );
+    }
+    else if( keyword == "histogram" )
+    {
+      /** The values with a nonzero count follow, one per line. */
+      unsigned long numberOfValues = 0;
+      unsigned long numberOfEntries = 0;
+      if( !( fields >> statistics.HistogramMinimum >> numberOfValues >> numberOfEntries )
+        || numberOfValues > MaximumNumberOfHistogramValues )
+      {
+        return false;
+      }
+      statistics.Histogram.assign( numberOfValues, 0.0 );
+      for( unsigned long e = 0; e < numberOfEntries; ++e )
+      {
+        unsigned long offset = 0;
+        double count = 0.0;
+        if( !( cacheFile >> offset >> count ) || offset >= numberOfValues ) return false;
+        statistics.Histogram[ offset ] = count;
+      }
+    }
+  }
+
+  return hasFile && hasType;
+
+} // end ReadStatisticsCacheFile()
+
+
+/**
+ * ***************** ReadStatisticsCache ************************
+ */
+
+bool ReadStatisticsCache(
+  const std::string & filename,
+  const itk::ImageIOBase::IOComponentType readComponentType,
+  ImageStatistics & statistics )
+{
+  ImageStatistics cached;
+  unsigned long fileSize = 0;
+  long modificationTime = 0;
+  std::string componentType = "";
+  if( !ReadStatisticsCacheFile( filename, cached, fileSize, modificationTime, componentType ) )
+  {
+    return false;
+  }
+
+  /** A file that was only touched or copied still has the same checksum. */
+  bool valid = fileSize == itksys::SystemTools::FileLength( filename.c_str() )
+    && modificationTime == itksys::SystemTools::ModifiedTime( filename.c_str() );
+  if( !valid && cached.Checksum != "" )
+  {
+    std::string checksum = "";
+    valid = GetCachedImageChecksum( filename, checksum ) && checksum == cached.Checksum;
+  }
+  if( !valid
+    || !IsExactConversion( itk::ImageIOBase::GetComponentTypeFromString( componentType ),
+      readComponentType ) )
+  {
+    return false;
+  }
+
+  statistics = cached;
+  return true;
+
+} // end ReadStatisticsCache()
+
+
+/**
+ * ***************** WriteStatisticsCache ************************
+ */
+
+void WriteStatisticsCache(
+  const std::string & filename,
+  const itk::ImageIOBase::IOComponentType readComponentType,
+  const ImageStatistics & statistics )
+{
+  itk::ImageIOBase::Pointer imageIOBase;
+  if( !GetImageIOBase( filename, imageIOBase ) ) return;
+  const itk::ImageIOBase::IOComponentType componentType = imageIOBase->GetComponentType();
+  if( !IsExactConversion( componentType, readComponentType ) ) return;
+
+  /** Keep what is missing from the statistics stored before. */
+  ImageStatistics merged = statistics;
+  ImageStatistics stored;
+  if( ReadStatisticsCache( filename, componentType, stored )
+    && ( stored.Checksum == "" || merged.Checksum == "" || stored.Checksum == merged.Checksum ) )
+  {
+    if( !merged.HasMoments() )
+    {
+      merged.NumberOfPixels = stored.NumberOfPixels;
+      merged.Minimum = stored.Minimum;
+      merged.Maximum = stored.Maximum;
+      merged.Mean = stored.Mean;
+      merged.Sigma = stored.Sigma;
+    }
+    if( !merged.HasHistogram() )
+    {
+      merged.HistogramMinimum = stored.HistogramMinimum;
+      merged.Histogram = stored.Histogram;
+    }
+    if( merged.Checksum == "" ) merged.Checksum = stored.Checksum;
+  }
+  if( merged.Checksum == "" )
+  {
+    std::string errorMessage = "";
+    GetImageChecksum( filename, true, merged.Checksum, errorMessage );
+  }
+
+  /** The moments are per component, the histogram is of a scalar image. */
+  const unsigned int numberOfComponents = imageIOBase->GetNumberOfComponents();
+  if( merged.Minimum.size() != numberOfComponents ) merged.Minimum.clear();
+  if( numberOfComponents != 1 ) merged.Histogram.clear();
+
+  std::ofstream cacheFile( ( filename + ".statistics" ).c_str() );
+  cacheFile << StatisticsCacheTag << "\n"
+    << "file " << itksys::SystemTools::FileLength( filename.c_str() ) << " "
+    << itksys::SystemTools::ModifiedTime( filename.c_str() ) << "\n"
+    << "type " << imageIOBase->GetComponentTypeAsString( componentType )
+    << " " << numberOfComponents << "\n";
+  if( merged.Checksum != "" )
+  {
+    cacheFile << "checksum " << merged.Checksum << "\n";
+  }
+  cacheFile << std::setprecision( 17 );
+  if( merged.HasMoments() )
+  {
+    cacheFile << "pixels " << merged.NumberOfPixels << "\n";
+    for( std::size_t c = 0; c < merged.Minimum.size(); ++c )
+    {
+      cacheFile << "component " << merged.Minimum[ c ] << " " << merged.Maximum[ c ]
+        << " " << merged.Mean[ c ] << " " << merged.Sigma[ c ] << "\n";
+    }
+  }
+  if( merged.HasHistogram() )
+  {
+    unsigned long numberOfEntries = 0;
+    for( std::size_t i = 0; i < merged.Histogram.size(); ++i )
+    {
+      if( merged.Histogram[ i ] != 0.0 ) ++numberOfEntries;
+    }
+    cacheFile << "histogram " << merged.HistogramMinimum << " "
+      << merged.Histogram.size() << " " << numberOfEntries << "\n";
+    for( std::size_t i = 0; i < merged.Histogram.size(); ++i )
+    {
+      if( merged.Histogram[ i ] != 0.0 )
+      {
+        cacheFile << i << " " << merged.Histogram[ i ] << "\n";
+      }
+    }
+  }
+
+} // end WriteStatisticsCache()
+
+} // end namespace itktools
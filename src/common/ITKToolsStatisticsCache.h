@@ -0,0 +1,192 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __ITKToolsStatisticsCache_h_
+#define __ITKToolsStatisticsCache_h_
+
+#include "ITKToolsChecksum.h"
+#include "ITKToolsImageProperties.h"
+
+#include "itkImageIOBase.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkNumericTraits.h"
+
+#include <string>
+#include <vector>
+
+
+namespace itktools
+{
+
+/** \struct ImageStatistics
+ * The statistics of the pixel values of an image file, that several tools
+ * need: the minimum, maximum, mean and sigma per component, and for an
+ * integer scalar image the number of pixels of every value, from which
+ * any histogram and percentile of the image can be derived exactly.
+ * Either part may be missing.
+ */
+struct ImageStatistics
+{
+  ImageStatistics()
+  {
+    this->NumberOfPixels = 0.0;
+    this->HistogramMinimum = 0.0;
+  }
+
+  /** The checksum of the pixel data, see GetImageChecksum(). */
+  std::string Checksum;
+
+  /** The number of pixels, and the moments per component. */
+  double NumberOfPixels;
+  std::vector<double> Minimum;
+  std::vector<double> Maximum;
+  std::vector<double> Mean;
+  std::vector<double> Sigma;
+
+  /** Histogram[ i ] is the number of pixels with value HistogramMinimum + i. */
+  double HistogramMinimum;
+  std::vector<double> Histogram;
+
+  bool HasMoments( void ) const { return !this->Minimum.empty(); }
+  bool HasHistogram( void ) const { return !this->Histogram.empty(); }
+
+  /** Compute the moments of a scalar image from the histogram. */
+  void ComputeMomentsFromHistogram( void );
+
+  /** The value below which percentage percent of the pixels lie: the value
+   * of rank floor( percentage / 100 * ( n - 1 ) ) of the n sorted pixels.
+   * Needs the histogram.
+   */
+  double GetPercentile( const double percentage ) const;
+};
+
+/** The largest number of values of a histogram, 2^20. */
+const unsigned long MaximumNumberOfHistogramValues = 1UL << 20;
+
+/** Read the statistics of an image file from the file filename.statistics.
+ *
+ * The statistics are valid if the image did not change since they were
+ * written, according to its size and modification time, or, if it did,
+ * if its checksum in filename.checksum equals the stored one. As with the
+ * checksum cache, for formats with a separate data file, like mhd/raw, only
+ * the header file is checked. The statistics are of the values in the file;
+ * they are only returned if reading the file as readComponentType gives the
+ * same values.
+ *
+ * Returns false if there are no valid statistics.
+ */
+bool ReadStatisticsCache(
+  const std::string & filename,
+  const itk::ImageIOBase::IOComponentType readComponentType,
+  ImageStatistics & statistics );
+
+/** Store the statistics of an image file in filename.statistics, computed
+ * from the image read as readComponentType. Nothing is written if that may
+ * have changed the values. The moments or the histogram that are missing
+ * are kept from the statistics that were stored before, if valid. Without
+ * a checksum, it is taken from filename.checksum, or computed, which reads
+ * the image again. Failing to write the cache file is not an error.
+ */
+void WriteStatisticsCache(
+  const std::string & filename,
+  const itk::ImageIOBase::IOComponentType readComponentType,
+  const ImageStatistics & statistics );
+
+/** Whether reading a file of component type fileComponentType as
+ * readComponentType keeps all values exactly.
+ */
+bool IsExactConversion(
+  const itk::ImageIOBase::IOComponentType fileComponentType,
+  const itk::ImageIOBase::IOComponentType readComponentType );
+
+/** Get the component type as which an image of type TImage is read. */
+template< class TImage >
+itk::ImageIOBase::IOComponentType GetReadComponentType( void )
+{
+  typedef typename itk::NumericTraits<
+    typename TImage::InternalPixelType >::ValueType ValueType;
+  return itk::ImageIOBase::MapPixelType<ValueType>::CType;
+}
+
+/** Store the statistics of an image file, computed from the image read
+ * from it, see above. If the image was read without a cast, the checksum
+ * is computed from its buffer, instead of from the file.
+ *
+ * TImage should be an itk::Image of scalar pixels, or an itk::VectorImage.
+ */
+template< class TImage >
+void WriteStatisticsCache(
+  const std::string & filename,
+  const TImage * image,
+  ImageStatistics statistics )
+{
+  const itk::ImageIOBase::IOComponentType readComponentType
+    = GetReadComponentType<TImage>();
+  const typename TImage::RegionType region = image->GetLargestPossibleRegion();
+
+  itk::ImageIOBase::Pointer imageIOBase;
+  if( statistics.Checksum == ""
+    && image->GetBufferedRegion() == region
+    && GetImageIOBase( filename, imageIOBase )
+    && imageIOBase->GetComponentType() == readComponentType
+    && imageIOBase->GetNumberOfComponents() == image->GetNumberOfComponentsPerPixel()
+    && imageIOBase->GetNumberOfDimensions() == TImage::ImageDimension )
+  {
+    std::vector<unsigned long> size( TImage::ImageDimension );
+    for( unsigned int i = 0; i < TImage::ImageDimension; ++i )
+    {
+      size[ i ] = region.GetSize()[ i ];
+    }
+    statistics.Checksum = GetPixelBufferChecksum( image->GetBufferPointer(),
+      region.GetNumberOfPixels() * image->GetNumberOfComponentsPerPixel()
+        * sizeof( typename TImage::InternalPixelType ),
+      size, itk::ImageIOBase::GetComponentTypeAsString( readComponentType ),
+      image->GetNumberOfComponentsPerPixel() );
+  }
+
+  WriteStatisticsCache( filename, readComponentType, statistics );
+
+} // end WriteStatisticsCache()
+
+
+/** Compute the histogram of a scalar image with integer values between
+ * minimum and maximum, one bin per value, see ImageStatistics. Returns
+ * false if there are more than MaximumNumberOfHistogramValues values.
+ */
+template< class TImage >
+bool ComputeValueHistogram( const TImage * image,
+  const double minimum, const double maximum,
+  ImageStatistics & statistics )
+{
+  typedef itk::ImageRegionConstIterator< TImage >     IteratorType;
+
+  statistics.Histogram.clear();
+  if( !( maximum - minimum < MaximumNumberOfHistogramValues ) ) return false;
+  statistics.HistogramMinimum = minimum;
+  statistics.Histogram.assign( static_cast<std::size_t>( maximum - minimum ) + 1, 0.0 );
+  for( IteratorType it( image, image->GetBufferedRegion() ); !it.IsAtEnd(); ++it )
+  {
+    statistics.Histogram[ static_cast<std::size_t>(
+      static_cast<double>( it.Get() ) - minimum ) ] += 1.0;
+  }
+  return true;
+
+} // end ComputeValueHistogram()
+
+} // end namespace itktools
+
+#endif // end #ifndef __ITKToolsStatisticsCache_h_
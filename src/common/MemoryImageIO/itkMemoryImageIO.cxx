@@ -0,0 +1,316 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#include "itkMemoryImageIO.h"
+#include "itkSimpleFastMutexLock.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <vector>
+
+
+namespace itk
+{
+
+/** An image in the store: the geometry, the pixel type and the pixels. */
+struct MemoryImageEntry
+{
+  std::vector<SizeValueType>          Size;
+  std::vector<double>                 Spacing;
+  std::vector<double>                 Origin;
+  std::vector< std::vector<double> >  Direction;
+  ImageIOBase::IOComponentType        ComponentType;
+  ImageIOBase::IOPixelType            PixelType;
+  unsigned int                        NumberOfComponents;
+  std::vector<unsigned char>          Buffer;
+};
+
+typedef std::map< std::string, MemoryImageEntry > MemoryImageStoreType;
+
+/** The store and its lock, constructed on first use. */
+static MemoryImageStoreType & GetMemoryImageStore( void )
+{
+  static MemoryImageStoreType store;
+  return store;
+}
+
+static SimpleFastMutexLock & GetMemoryImageStoreLock( void )
+{
+  static SimpleFastMutexLock lock;
+  return lock;
+}
+
+
+/**
+ * ******************* Constructor *******************
+ */
+
+MemoryImageIO::MemoryImageIO()
+{
+} // end Constructor
+
+
+/**
+ * ******************* Destructor *******************
+ */
+
+MemoryImageIO::~MemoryImageIO()
+{
+} // end Destructor
+
+
+/**
+ * ******************* IsMemoryFileName *******************
+ */
+
+bool
+MemoryImageIO::IsMemoryFileName( const std::string & fileName )
+{
+  return fileName.size() > 4 && fileName.compare( 0, 4, "mem:" ) == 0;
+
+} // end IsMemoryFileName()
+
+
+/**
+ * ******************* HasImage *******************
+ */
+
+bool
+MemoryImageIO::HasImage( const std::string & fileName )
+{
+  GetMemoryImageStoreLock().Lock();
+  const bool found = GetMemoryImageStore().count( fileName ) > 0;
+  GetMemoryImageStoreLock().Unlock();
+  return found;
+
+} // end HasImage()
+
+
+/**
+ * ******************* RemoveImage *******************
+ */
+
+void
+MemoryImageIO::RemoveImage( const std::string & fileName )
+{
+  GetMemoryImageStoreLock().Lock();
+  GetMemoryImageStore().erase( fileName );
+  GetMemoryImageStoreLock().Unlock();
+
+} // end RemoveImage()
+
+
+/**
+ * ******************* RemoveAllImages *******************
+ */
+
+void
+MemoryImageIO::RemoveAllImages( void )
+{
+  GetMemoryImageStoreLock().Lock();
+  GetMemoryImageStore().clear();
+  GetMemoryImageStoreLock().Unlock();
+
+} // end RemoveAllImages()
+
+
+/**
+ * ******************* CanReadFile *******************
+ */
+
+bool
+MemoryImageIO::CanReadFile( const char * fileName )
+{
+  return fileName && IsMemoryFileName( fileName ) && HasImage( fileName );
+
+} // end CanReadFile()
+
+
+/**
+ * ******************* CanWriteFile *******************
+ */
+
+bool
+MemoryImageIO::CanWriteFile( const char * fileName )
+{
+  return fileName && IsMemoryFileName( fileName );
+
+} // end CanWriteFile()
+
+
+/**
+ * ******************* ReadImageInformation *******************
+ */
+
+void
+MemoryImageIO::ReadImageInformation( void )
+{
+  GetMemoryImageStoreLock().Lock();
+  MemoryImageStoreType::const_iterator it = GetMemoryImageStore().find( this->m_FileName );
+  if( it == GetMemoryImageStore().end() )
+  {
+    GetMemoryImageStoreLock().Unlock();
+    itkExceptionMacro( << "There is no image " << this->m_FileName << " in memory." );
+  }
+  const MemoryImageEntry & entry = it->second;
+
+  const unsigned int dim = static_cast<unsigned int>( entry.Size.size() );
+  this->SetNumberOfDimensions( dim );
+  for( unsigned int i = 0; i < dim; ++i )
+  {
+    this->SetDimensions( i, entry.Size[ i ] );
+    this->SetSpacing( i, entry.Spacing[ i ] );
+    this->SetOrigin( i, entry.Origin[ i ] );
+    this->SetDirection( i, entry.Direction[ i ] );
+  }
+  this->SetComponentType( entry.ComponentType );
+  this->SetPixelType( entry.PixelType );
+  this->SetNumberOfComponents( entry.NumberOfComponents );
+  GetMemoryImageStoreLock().Unlock();
+
+} // end ReadImageInformation()
+
+
+/**
+ * ******************* Read *******************
+ */
+
+void
+MemoryImageIO::Read( void * buffer )
+{
+  GetMemoryImageStoreLock().Lock();
+  MemoryImageStoreType::iterator it = GetMemoryImageStore().find( this->m_FileName );
+  if( it == GetMemoryImageStore().end() )
+  {
+    GetMemoryImageStoreLock().Unlock();
+    itkExceptionMacro( << "There is no image " << this->m_FileName << " in memory." );
+  }
+  this->CopyRegion( &it->second.Buffer[ 0 ], static_cast<unsigned char *>( buffer ), false );
+  GetMemoryImageStoreLock().Unlock();
+
+} // end Read()
+
+
+/**
+ * ******************* Write *******************
+ *
+ * The first piece of a streamed write, the one that starts at the first
+ * pixel, (re)creates the image in the store.
+ */
+
+void
+MemoryImageIO::Write( const void * buffer )
+{
+  const unsigned int dim = this->GetNumberOfDimensions();
+  bool firstPiece = true;
+  for( unsigned int i = 0; i < this->m_IORegion.GetImageDimension(); ++i )
+  {
+    firstPiece &= this->m_IORegion.GetIndex( i ) == 0;
+  }
+
+  GetMemoryImageStoreLock().Lock();
+  MemoryImageEntry & entry = GetMemoryImageStore()[ this->m_FileName ];
+  if( firstPiece || entry.Buffer.empty() )
+  {
+    entry.Size.resize( dim );
+    entry.Spacing.resize( dim );
+    entry.Origin.resize( dim );
+    entry.Direction.resize( dim );
+    for( unsigned int i = 0; i < dim; ++i )
+    {
+      entry.Size[ i ] = this->GetDimensions( i );
+      entry.Spacing[ i ] = this->GetSpacing( i );
+      entry.Origin[ i ] = this->GetOrigin( i );
+      entry.Direction[ i ] = this->GetDirection( i );
+    }
+    entry.ComponentType = this->GetComponentType();
+    entry.PixelType = this->GetPixelType();
+    entry.NumberOfComponents = this->GetNumberOfComponents();
+    std::vector<unsigned char>( static_cast<std::size_t>( this->GetImageSizeInBytes() ) ).swap( entry.Buffer );
+  }
+  this->CopyRegion( &entry.Buffer[ 0 ],
+    const_cast<unsigned char *>( static_cast<const unsigned char *>( buffer ) ), true );
+  GetMemoryImageStoreLock().Unlock();
+
+} // end Write()
+
+
+/**
+ * ******************* CopyRegion *******************
+ */
+
+void
+MemoryImageIO::CopyRegion( unsigned char * image, unsigned char * region,
+  bool toImage ) const
+{
+  const unsigned int dim = this->GetNumberOfDimensions();
+  const SizeValueType pixelBytes = this->GetComponentSize() * this->GetNumberOfComponents();
+
+  /** The region and the strides of the image, in pixels. */
+  std::vector<SizeValueType> start( dim, 0 );
+  std::vector<SizeValueType> size( dim, 1 );
+  std::vector<SizeValueType> strides( dim, 1 );
+  for( unsigned int i = 0; i < dim; ++i )
+  {
+    if( i < this->m_IORegion.GetImageDimension() )
+    {
+      start[ i ] = this->m_IORegion.GetIndex( i );
+      size[ i ] = this->m_IORegion.GetSize( i );
+    }
+    if( i > 0 ) strides[ i ] = strides[ i - 1 ] * this->GetDimensions( i - 1 );
+  }
+
+  /** Copy row by row. */
+  const std::size_t rowBytes = size[ 0 ] * pixelBytes;
+  std::vector<SizeValueType> position( dim, 0 );
+  SizeValueType numberOfRows = 1;
+  for( unsigned int i = 1; i < dim; ++i ) numberOfRows *= size[ i ];
+  for( SizeValueType row = 0; row < numberOfRows; ++row )
+  {
+    SizeValueType offset = start[ 0 ];
+    for( unsigned int i = 1; i < dim; ++i )
+    {
+      offset += ( start[ i ] + position[ i ] ) * strides[ i ];
+    }
+    unsigned char * imageRow = image + offset * pixelBytes;
+    unsigned char * regionRow = region + row * rowBytes;
+    if( toImage ) std::memcpy( imageRow, regionRow, rowBytes );
+    else std::memcpy( regionRow, imageRow, rowBytes );
+
+    for( unsigned int i = 1; i < dim; ++i )
+    {
+      if( ++position[ i ] < size[ i ] ) break;
+      position[ i ] = 0;
+    }
+  }
+
+} // end CopyRegion()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+void
+MemoryImageIO::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+} // end PrintSelf()
+
+} // end namespace itk
@@ -0,0 +1,101 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkMemoryImageIO_h
+#define __itkMemoryImageIO_h
+
+#ifdef _MSC_VER
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkImageIOBase.h"
+#include <string>
+
+
+namespace itk
+{
+
+/** \class MemoryImageIO
+ * \brief ImageIO for images that are kept in the memory of the process.
+ *
+ * A file name that starts with "mem:" does not refer to a file, but to an
+ * image in a store that lives as long as the process. Writing to such a
+ * name copies the image into the store, reading it copies it out again,
+ * with the geometry and the pixel type of the written image. This passes
+ * images between tools that run in one process, such as the stages of
+ * pxtools pipeline, without temporary files.
+ *
+ * Reading and writing both stream: only the pixels of the requested
+ * region are copied. The store is thread safe. An image stays in the
+ * store until it is removed with RemoveImage().
+ *
+ * \ingroup IOFilters
+ */
+
+class ITK_EXPORT MemoryImageIO : public ImageIOBase
+{
+public:
+  /** Standard class typedefs. */
+  typedef MemoryImageIO                 Self;
+  typedef ImageIOBase                   Superclass;
+  typedef SmartPointer<Self>            Pointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( MemoryImageIO, ImageIOBase );
+
+  /** Reading. */
+  virtual bool CanReadFile( const char * fileName );
+  virtual void ReadImageInformation( void );
+  virtual void Read( void * buffer );
+  virtual bool CanStreamRead( void ) { return true; }
+
+  /** Writing. */
+  virtual bool CanWriteFile( const char * fileName );
+  virtual void WriteImageInformation( void ) {};
+  virtual void Write( const void * buffer );
+  virtual bool CanStreamWrite( void ) { return true; }
+
+  /** Whether a file name refers to the store, and whether it holds it. */
+  static bool IsMemoryFileName( const std::string & fileName );
+  static bool HasImage( const std::string & fileName );
+
+  /** Release an image of the store, and all images. */
+  static void RemoveImage( const std::string & fileName );
+  static void RemoveAllImages( void );
+
+protected:
+  MemoryImageIO();
+  ~MemoryImageIO();
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+private:
+  MemoryImageIO( const Self & );  // purposely not implemented
+  void operator=( const Self & ); // purposely not implemented
+
+  /** Copy the pixels of the IO region between the image in the store
+   * and a buffer of the IO region, in either direction. */
+  void CopyRegion( unsigned char * image, unsigned char * region,
+    bool toImage ) const;
+
+}; // end class MemoryImageIO
+
+} // end namespace itk
+
+#endif // end #ifndef __itkMemoryImageIO_h
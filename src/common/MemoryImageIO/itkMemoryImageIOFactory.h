@@ -0,0 +1,69 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkMemoryImageIOFactory_h
+#define __itkMemoryImageIOFactory_h
+
+#include "itkObjectFactoryBase.h"
+#include "itkImageIOBase.h"
+
+namespace itk
+{
+
+/** \class MemoryImageIOFactory
+ * \brief Create instances of MemoryImageIO objects using an object factory.
+ */
+
+class ITK_EXPORT MemoryImageIOFactory : public ObjectFactoryBase
+{
+public:
+  /** Standard class typedefs. */
+  typedef MemoryImageIOFactory    Self;
+  typedef ObjectFactoryBase               Superclass;
+  typedef SmartPointer<Self>              Pointer;
+  typedef SmartPointer<const Self>        ConstPointer;
+
+  /** Class methods used to interface with the registered factories. */
+  virtual const char* GetITKSourceVersion( void ) const;
+  virtual const char* GetDescription( void ) const;
+
+  /** Method for class instantiation. */
+  itkFactorylessNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( MemoryImageIOFactory, ObjectFactoryBase );
+
+  /** Register one factory of this type  */
+  static void RegisterOneFactory( void )
+  {
+    MemoryImageIOFactory::Pointer factory = MemoryImageIOFactory::New();
+    ObjectFactoryBase::RegisterFactory( factory );
+  }
+
+protected:
+  MemoryImageIOFactory();
+  ~MemoryImageIOFactory();
+
+private:
+  MemoryImageIOFactory(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+}; // end class MemoryImageIOFactory
+
+} // end namespace itk
+
+#endif // end #ifndef __itkMemoryImageIOFactory_h
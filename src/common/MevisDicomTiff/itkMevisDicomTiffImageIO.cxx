@@ -43,6 +43,7 @@ PURPOSE.  See the above copyright notices for more information.
 #include "gdcmException.h"
 #include "gdcmFileMetaInformation.h"
 
+#include <algorithm>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -54,9 +55,177 @@ PURPOSE.  See the above copyright notices for more information.
 
 #include <itksys/SystemTools.hxx>
 
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
+#include "itk_zlib.h"
+
 namespace itk
 {
 
+// tile engine
+//
+// the tiles are decoded, and for writing filled and compressed, by a
+// pool of threads. libtiff handles are not thread safe, so every reading
+// thread opens the tiff file itself. writing is done by the calling
+// thread, with TIFFWriteRawTile for the tiles that are deflated here.
+
+struct MevisTile
+{
+  unsigned int x0, y0, z0;   // position of the tile in the tiff
+  std::size_t  offset;       // offset of its slice in the buffer, in bytes
+};
+
+struct MevisTileThreadStruct
+{
+  std::vector<MevisTile> Tiles;
+
+  // the x,y range of the buffer, and the tile layout
+  unsigned int  Start[2];
+  unsigned int  End[2];
+  std::size_t   RegionRowBytes;
+  unsigned int  TileWidth;
+  unsigned int  TileLength;
+  unsigned int  TileSize;
+  unsigned int  TileRowBytes;
+  unsigned int  BytesPerSample;
+  unsigned char * Buffer;
+
+  // reading: the file, and the handle of the calling thread
+  std::string   FileName;
+  TIFF *        MainTIFF;
+
+  // writing: the filled and possibly deflated tiles of the current batch
+  std::vector< std::vector<unsigned char> > TileData;
+  bool          Deflate;
+
+  std::size_t   FirstTile;
+  std::size_t   NextTile;
+  std::size_t   EndTile;
+  std::string   Error;
+  SimpleFastMutexLock Mutex;
+};
+
+// copy the part of a tile inside the buffer region, from the tile to the
+// buffer, or from the buffer to the tile
+static void CopyMevisTile(const MevisTileThreadStruct & s, const MevisTile & tile,
+  unsigned char * tilebuf, bool toBuffer)
+{
+  const unsigned int xa = std::max( tile.x0, s.Start[0] );
+  const unsigned int xb = std::min( tile.x0 + s.TileWidth, s.End[0] );
+  const unsigned int ya = std::max( tile.y0, s.Start[1] );
+  const unsigned int yb = std::min( tile.y0 + s.TileLength, s.End[1] );
+  if (xa >= xb || ya >= yb)
+  {
+    return;
+  }
+  const std::size_t rowbytes = static_cast<std::size_t>( xb - xa ) * s.BytesPerSample;
+
+  unsigned char * pv = s.Buffer + tile.offset + ( ya - s.Start[1] ) * s.RegionRowBytes
+    + ( xa - s.Start[0] ) * s.BytesPerSample;
+  unsigned char * pb = tilebuf + ( ya - tile.y0 ) * s.TileRowBytes
+    + ( xa - tile.x0 ) * s.BytesPerSample;
+  for (unsigned int r = ya; r < yb; ++r)
+  {
+    if (toBuffer)
+    {
+      memcpy(pv,pb,rowbytes);
+    }
+    else
+    {
+      memcpy(pb,pv,rowbytes);
+    }
+    pv += s.RegionRowBytes;
+    pb += s.TileRowBytes;
+  }
+}
+
+// take the next tile, unless a thread failed; returns false if done
+static bool GetNextMevisTile(MevisTileThreadStruct * s, std::size_t & i)
+{
+  s->Mutex.Lock();
+  i = s->NextTile++;
+  const bool failed = !s->Error.empty();
+  s->Mutex.Unlock();
+  return !failed && i < s->EndTile;
+}
+
+static void SetMevisTileError(MevisTileThreadStruct * s, const std::string & error)
+{
+  s->Mutex.Lock();
+  if (s->Error.empty())
+  {
+    s->Error = error;
+  }
+  s->Mutex.Unlock();
+}
+
+static ITK_THREAD_RETURN_TYPE MevisReadTilesThreaderCallback(void * arg)
+{
+  MultiThreader::ThreadInfoStruct * info
+    = static_cast<MultiThreader::ThreadInfoStruct *>( arg );
+  MevisTileThreadStruct * s = static_cast<MevisTileThreadStruct *>( info->UserData );
+
+  TIFF * tiff = info->ThreadID == 0 ? s->MainTIFF : TIFFOpen(s->FileName.c_str(), "rc");
+  if (!tiff)
+  {
+    SetMevisTileError( s, "mevisIO:read(): error opening tiff file in reading thread" );
+    return ITK_THREAD_RETURN_VALUE;
+  }
+  unsigned char *tilebuf = static_cast<unsigned char*>(_TIFFmalloc(s->TileSize));
+
+  std::size_t i = 0;
+  while (GetNextMevisTile( s, i ))
+  {
+    const MevisTile & tile = s->Tiles[i];
+    if (TIFFReadTile(tiff, tilebuf, tile.x0, tile.y0, tile.z0, 0) < 0)
+    {
+      std::ostringstream error;
+      error << "mevisIO:read(): error reading tile ("
+        << tile.x0 << "," << tile.y0 << "," << tile.z0 << ")";
+      SetMevisTileError( s, error.str() );
+      break;
+    }
+    CopyMevisTile( *s, tile, tilebuf, true );
+  }
+
+  _TIFFfree(tilebuf);
+  if (tiff != s->MainTIFF)
+  {
+    TIFFClose(tiff);
+  }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+static ITK_THREAD_RETURN_TYPE MevisFillTilesThreaderCallback(void * arg)
+{
+  MultiThreader::ThreadInfoStruct * info
+    = static_cast<MultiThreader::ThreadInfoStruct *>( arg );
+  MevisTileThreadStruct * s = static_cast<MevisTileThreadStruct *>( info->UserData );
+
+  std::size_t i = 0;
+  while (GetNextMevisTile( s, i ))
+  {
+    // the tiles at the border are padded with zeros
+    std::vector<unsigned char> & data = s->TileData[i - s->FirstTile];
+    data.assign( s->TileSize, 0 );
+    CopyMevisTile( *s, s->Tiles[i], &data[0], false );
+
+    if (s->Deflate)
+    {
+      uLongf length = compressBound( s->TileSize );
+      std::vector<unsigned char> deflated( length );
+      if (compress2( &deflated[0], &length, &data[0], s->TileSize, Z_DEFAULT_COMPRESSION ) != Z_OK)
+      {
+        SetMevisTileError( s, "mevisIO:write(): error compressing tile" );
+        break;
+      }
+      deflated.resize( length );
+      data.swap( deflated );
+    }
+  }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
 // constructor
 MevisDicomTiffImageIO
 ::MevisDicomTiffImageIO():
@@ -75,6 +244,8 @@ MevisDicomTiffImageIO
   m_TileLength(0),
   m_TileDepth(0),
   m_NumberOfTiles(0),
+  m_CompressionMethod("deflate"),
+  m_WriteTileSize(128),
   m_RescaleSlope(NumericTraits<double>::One),
   m_RescaleIntercept(NumericTraits<double>::Zero),
   m_GantryTilt(NumericTraits<double>::Zero),
@@ -126,6 +297,8 @@ void MevisDicomTiffImageIO::PrintSelf(std::ostream& os, Indent indent) const
   os << indent << "TileLength       : " << m_TileLength << std::endl;
   os << indent << "TileDepth        : " << m_TileDepth << std::endl;
   os << indent << "NumberOfTiles    : " << m_NumberOfTiles << std::endl;
+  os << indent << "CompressionMethod: " << m_CompressionMethod << std::endl;
+  os << indent << "WriteTileSize    : " << m_WriteTileSize << std::endl;
   os << indent << "RescaleIntercept : " << m_RescaleIntercept << std::endl;
   os << indent << "RescaleSlope     : " << m_RescaleSlope << std::endl;
   os << indent << "GantryTilt       : " << m_GantryTilt << std::endl;
@@ -788,8 +961,10 @@ void MevisDicomTiffImageIO::ReadImageInformation()
   // 1 none
   // 2 ccit
   // 5 lzw
+  // 8, 32946 deflate
   // 32773 packbits
-  if (m_Compression == 2 || m_Compression == 5 || m_Compression == 32773)
+  if (m_Compression == 2 || m_Compression == 5 || m_Compression == 8
+    || m_Compression == 32946 || m_Compression == 32773)
   {
     //m_UseCompression = true;
     this->SetUseCompression(true);
@@ -842,337 +1017,73 @@ void MevisDicomTiffImageIO::Read(void* buffer)
       return;
     }
 
-    // buffer pointer is scanline based (one dimensional array)
-    // tile is positioned on x,y,z; we read each tile, and fill
-    // the corresponding positions in the onedimensional array
-    unsigned char *vol = reinterpret_cast<unsigned char*>(buffer);
-
-    const unsigned int tilesize = TIFFTileSize(m_TIFFImage);
-    const unsigned int tilerowbytes = TIFFTileRowSize(m_TIFFImage);
-    const unsigned int bytespersample = m_BitsPerSample/8;
-
-    unsigned char *tilebuf = static_cast<unsigned char*>(_TIFFmalloc(tilesize));
-
-    //
-    // special cases, if the tilexy is larger than or equal to the image
-    // size itself, treat as three separate cases, both are larger/equal,
-    // or only direction
-    //
-    bool tileoversized(false);
-
-    if (m_TileLength >= m_Length || m_TileWidth >= m_Width)
+    // the requested region, which is the whole image unless the
+    // reader streams; the buffer holds only this region, in scanline
+    // order. x,y,z,t; a 4D image is stored as one 3D tiff, of which
+    // the z-direction runs over z first and then over t.
+    unsigned int start[4] = { 0, 0, 0, 0 };
+    unsigned int size[4] = { 1, 1, 1, 1 };
+    const unsigned int dim = std::min( this->GetNumberOfDimensions(), 4u );
+    for (unsigned int i = 0; i < std::min( dim, m_IORegion.GetImageDimension() ); ++i)
     {
-      tileoversized = true;
-
-      // case one both x,y is larger
-      if (m_TileLength >= m_Length && m_TileWidth >= m_Width)
-      {
-        for (unsigned int z0 = 0; z0< (m_TIFFDimension == 3 ? m_Depth :1); z0++)
-        {
-          if (TIFFReadTile(m_TIFFImage, tilebuf, 0, 0, z0, 0) < 0)
-          {
-            _TIFFfree(tilebuf);
-            itkExceptionMacro( << "mevisIO:read(): error reading tile (topleft)" );
-            return;
-          }
-          else
-          {
-            // do row based copy of tile into volume
-            const unsigned lenx = m_Width;
-            const unsigned leny = m_Length;
-            const unsigned int tilexbytes = lenx * bytespersample;
-
-            unsigned char * pv = vol;
-            const unsigned int p = z0 * m_Length * m_Width;
-            pv += p * bytespersample;
-
-            unsigned char * pb = tilebuf;
-            for (unsigned int r = 0; r<leny; ++r)
-            {
-              memcpy(pv,pb,tilexbytes);
-              pv += tilexbytes;
-              pb += tilerowbytes;
-            }
-          }
-        }
-      } // end case one
-
-      // case two, larger x, smaller y
-      if (m_TileWidth >= m_Width && m_TileLength < m_Length)
-      {
-
-        const unsigned lenx = m_Width;
-        const unsigned int tilexbytes = lenx * bytespersample;
-
-        const bool my = ( m_Length%m_TileLength == 0) ? true : false;
-        for (unsigned int z0 = 0; z0 < (m_TIFFDimension == 3 ? m_Depth : 1); z0++)
-        {
-          for (unsigned int y0 = 0; y0 < (my ? m_Length : m_Length-m_TileLength); y0 += m_TileLength)
-          {
-            if (TIFFReadTile(m_TIFFImage, tilebuf, 0, y0, z0, 0) < 0)
-            {
-              _TIFFfree(tilebuf);
-              itkExceptionMacro( << "mevisIO:read(): error reading tile (top image)" );
-              return;
-            }
-            else
-            {
-
-              unsigned char * pb = tilebuf;
-              unsigned char * pv = vol;
-              const unsigned int p = z0 * m_Length * m_Width + y0 * m_Width;
-              pv += p * bytespersample;
-
-              for (unsigned int r = 0; r<m_TileLength; ++r)
-              {
-                memcpy(pv,pb,tilerowbytes);
-                pv += tilexbytes;
-                pb += tilerowbytes;
-              }
-            }
-          }
-
-          if (!my)
-          {
-            const unsigned leny = m_Length%m_TileLength;
-            const unsigned int y0 = m_Length - leny;
-
-            if (TIFFReadTile(m_TIFFImage, tilebuf, 0, y0, z0, 0) < 0)
-            {
-              _TIFFfree(tilebuf);
-              itkExceptionMacro( << "mevisIO:read(): error reading tile (strip bottom)" );
-              return;
-            }
-            else
-            {
-              unsigned char * pb = tilebuf;
-              unsigned char * pv = vol;
-              const unsigned int p = z0 * m_Length * m_Width + y0 * m_Width;
-              pv += p * bytespersample;
-
-              for (unsigned int r = 0; r<leny; ++r)
-              {
-                memcpy(pv,pb,tilexbytes);
-                pv += tilexbytes;
-                pb += tilerowbytes;
-              }
-            }
-          }
-        }
-
-      } // end case two
-
-      // case three, smaller x, larger y
-      if (m_TileWidth < m_Width && m_TileLength >= m_Length)
+      start[i] = static_cast<unsigned int>( m_IORegion.GetIndex(i) );
+      size[i] = static_cast<unsigned int>( m_IORegion.GetSize(i) );
+    }
+    const unsigned int xend = start[0] + size[0];
+    const unsigned int yend = start[1] + size[1];
+    const unsigned int depth = dim > 2 ? m_Dimensions[2] : 1;
+
+    // only the tiles that intersect the region are decoded, in parallel,
+    // and of every tile only the rows and columns inside the region are
+    // copied. tiles at the border of the image, or larger than the
+    // image, are padded.
+    MevisTileThreadStruct str;
+    str.Start[0] = start[0];
+    str.Start[1] = start[1];
+    str.End[0] = xend;
+    str.End[1] = yend;
+    str.TileWidth = m_TileWidth;
+    str.TileLength = m_TileLength;
+    str.TileSize = TIFFTileSize(m_TIFFImage);
+    str.TileRowBytes = TIFFTileRowSize(m_TIFFImage);
+    str.BytesPerSample = m_BitsPerSample/8;
+    str.RegionRowBytes = static_cast<std::size_t>( size[0] ) * str.BytesPerSample;
+    str.Buffer = reinterpret_cast<unsigned char*>(buffer);
+    str.FileName = m_TiffFileName;
+    str.MainTIFF = m_TIFFImage;
+    str.Deflate = false;
+
+    for (unsigned int t = start[3]; t < start[3] + size[3]; ++t)
+    {
+      for (unsigned int z = start[2]; z < start[2] + size[2]; ++z)
       {
-
-        const unsigned leny = m_Length;
-        const bool mx = ( m_Width%m_TileWidth == 0) ? true: false;
-
-        for (unsigned int z0 = 0; z0 < (m_TIFFDimension == 3 ? m_Depth : 1); z0++)
+        MevisTile tile;
+        tile.z0 = (m_TIFFDimension == 3) ? t * depth + z : 0;
+        tile.offset = ( static_cast<std::size_t>( t - start[3] ) * size[2]
+          + ( z - start[2] ) ) * size[1] * str.RegionRowBytes;
+        for (tile.y0 = start[1] - start[1] % m_TileLength; tile.y0 < yend; tile.y0 += m_TileLength)
         {
-          for (unsigned int x0 = 0; x0 < (mx ? m_Width : m_Width-m_TileWidth); x0 += m_TileWidth)
-          {
-            // read tile
-            if (TIFFReadTile(m_TIFFImage, tilebuf, x0, 0, z0, 0) < 0)
-            {
-              _TIFFfree(tilebuf);
-              itkExceptionMacro( << "mevisIO:read(): error reading tile (top image)" );
-              return;
-            }
-            else
-            {
-              unsigned char * pb = tilebuf;
-              unsigned char * pv = vol;
-              const unsigned int p = z0 * m_Length * m_Width + x0;
-              pv += p * bytespersample;
-
-              for (unsigned int r = 0; r<leny; ++r)
-              {
-                memcpy(pv,pb,tilerowbytes);
-                pv += m_Width * bytespersample;
-                pb += tilerowbytes;
-              }
-            }
-          }
-          // fill strip right
-          if (!mx)
+          for (tile.x0 = start[0] - start[0] % m_TileWidth; tile.x0 < xend; tile.x0 += m_TileWidth)
           {
-            const unsigned lenx = m_Width%m_TileWidth;
-            const unsigned int x0 = m_Width - lenx;
-            const unsigned int tilexbytes = lenx * bytespersample;
-
-            if (TIFFReadTile(m_TIFFImage, tilebuf, x0, 0, z0, 0) < 0)
-            {
-              _TIFFfree(tilebuf);
-              itkExceptionMacro( << "mevisIO:read(): error reading tile (strip right)" );
-              return;
-            }
-            else
-            {
-              unsigned char * pb = tilebuf;
-              unsigned char * pv = vol;
-              const unsigned int p = z0 * m_Length * m_Width + x0;
-              pv += p * bytespersample;
-
-              for (unsigned int r = 0; r<leny; ++r)
-              {
-                memcpy(pv,pb,tilexbytes);
-                pv += m_Width * bytespersample;
-                pb += tilerowbytes;
-              }
-            }
+            str.Tiles.push_back(tile);
           }
         }
+      }
+    }
+    str.FirstTile = 0;
+    str.NextTile = 0;
+    str.EndTile = str.Tiles.size();
 
-      } // end case three
-
-    } // end oversized tile
-
+    MultiThreader::Pointer threader = MultiThreader::New();
+    threader->SetNumberOfThreads( static_cast<ThreadIdType>( std::max<std::size_t>( 1,
+      std::min<std::size_t>( threader->GetNumberOfThreads(), str.Tiles.size() ) ) ) );
+    threader->SetSingleMethod( MevisReadTilesThreaderCallback, &str );
+    threader->SingleMethodExecute();
 
-    //
-    // normal case, tile is smaller than image
-    //
-    if (!tileoversized)
+    if (!str.Error.empty())
     {
-      // is volume direction a multiple of tiledirection?
-      const bool mx = ( m_Width%m_TileWidth == 0) ? true: false;
-      const bool my = ( m_Length%m_TileLength == 0) ? true : false;
-
-      // fill everything inside ie from topleft
-      for (unsigned int z0 = 0; z0 < (m_TIFFDimension == 3 ? m_Depth : 1); z0++)
-      {
-        for (unsigned int y0 = 0; y0 < (my ? m_Length : m_Length-m_TileLength); y0 += m_TileLength)
-          for (unsigned int x0 = 0; x0 < (mx ? m_Width : m_Width-m_TileWidth); x0 += m_TileWidth)
-          {
-            // x0,y0,z0 is position of tile in volume, top left corner
-            // pointer to volume (at 0,0,0)
-            unsigned char * pv = vol;
-
-            // set pointer of volume to y0,x0,z0 position
-            const unsigned int p = z0 * m_Length * m_Width + y0 * m_Width + x0;
-            pv += p * bytespersample;
-
-            // read tile
-            if (TIFFReadTile(m_TIFFImage, tilebuf, x0, y0, z0, 0) < 0)
-            {
-              _TIFFfree(tilebuf);
-              itkExceptionMacro( << "mevisIO:read(): error reading tile (topleft image)" );
-              return;
-            }
-            else
-            {
-              // do row based copy of tile into volume
-              unsigned char * pb = tilebuf;
-              for (unsigned int r = 0; r<m_TileLength; ++r)
-              {
-                memcpy(pv,pb,tilerowbytes);
-                // move pointers
-                // x remain same, y is one complete vol line
-                // (ie width of image)
-                pv += m_Width * bytespersample;
-                pb += tilerowbytes;
-              }
-            }
-
-          }
-          // fill boundaries
-          if (!mx)
-          {
-            // x is fixed
-            const unsigned lenx = m_Width%m_TileWidth;
-            const unsigned int x0 = m_Width - lenx;
-            const unsigned int tilexbytes = lenx * bytespersample;
-
-            for (unsigned int y0 = 0; y0 < (my ? m_Length: m_Length - m_TileLength); y0 += m_TileLength)
-            {
-              unsigned char * pv = vol;
-              const unsigned int p = z0 * m_Length * m_Width + y0 * m_Width + x0;
-              pv += p * bytespersample;
-
-              if (TIFFReadTile(m_TIFFImage, tilebuf, x0, y0, z0, 0) < 0)
-              {
-                _TIFFfree(tilebuf);
-                itkExceptionMacro( << "mevisIO:read(): error reading tile (ydirection)" );
-                return;
-              }
-              else
-              {
-                unsigned char * pb = tilebuf;
-                for (unsigned int r = 0; r<m_TileLength; ++r)
-                {
-                  memcpy(pv,pb,tilexbytes);
-                  pv += m_Width * bytespersample;
-                  pb += tilerowbytes;
-                }
-              }
-            }
-          }
-          if (!my)
-          {
-            // y is fixed
-            const unsigned leny = m_Length%m_TileLength;
-            const unsigned int y0 = m_Length - leny;
-
-            for (unsigned int x0 = 0; x0 < (mx ? m_Width : m_Width-m_TileWidth); x0 += m_TileWidth)
-            {
-              unsigned char * pv = vol;
-              const unsigned int p = z0 * m_Length * m_Width + y0 * m_Width + x0;
-              pv += p * bytespersample;
-
-              if (TIFFReadTile(m_TIFFImage, tilebuf, x0, y0, z0, 0) < 0)
-              {
-                _TIFFfree(tilebuf);
-                itkExceptionMacro( << "mevisIO:read(): error reading tile (x-direction)");
-                return;
-              }
-              else
-              {
-                unsigned char * pb = tilebuf;
-                for (unsigned int r = 0; r<leny; ++r)
-                {
-                  memcpy(pv,pb,tilerowbytes);
-                  pv += m_Width * bytespersample;
-                  pb += tilerowbytes;
-                }
-              }
-            }
-          }
-          // fill corner bottom
-          if (!mx && !my)
-          {
-            // x0,y0 is fixed
-            const unsigned lenx = m_Width%m_TileWidth;
-            const unsigned int x0 = m_Width - lenx;
-            const unsigned int tilexbytes = lenx * bytespersample;
-            const unsigned leny = m_Length%m_TileLength;
-            const unsigned int y0 = m_Length - leny;
-
-            unsigned char * pv = vol;
-            const unsigned int p = z0 * m_Length * m_Width + y0 * m_Width + x0;
-            pv += p * bytespersample;
-
-            if (TIFFReadTile(m_TIFFImage, tilebuf, x0, y0, z0, 0) < 0)
-            {
-              _TIFFfree(tilebuf);
-              itkExceptionMacro( << "mevisIO:read(): error reading tile (corner bottom)" );
-              return;
-            }
-            else
-            {
-              unsigned char * pb = tilebuf;
-              for (unsigned int r = 0; r<leny; ++r)
-              {
-                memcpy(pv,pb,tilexbytes);
-                pv += m_Width * bytespersample;
-                pb += tilerowbytes;
-              }
-            }
-          }
-      }
+      itkExceptionMacro( << str.Error );
     }
-
-    _TIFFfree(tilebuf);
   }
   else
   {
@@ -1855,14 +1766,24 @@ void MevisDicomTiffImageIO
     itkExceptionMacro( << "mevisIO:write(): error setting BITSPERSAMPLE " );
   }
 
-  // compression, default always using lzw (overriding
+  // compression, default deflate, or lzw (overriding
   // member values)
   // 1 none
   // 2 ccit
   // 5 lzw
+  // 8 deflate
   // 32773 packbits
 
-  if (this->GetUseCompression())
+  // deflated tiles are compressed in parallel below, lzw by libtiff
+  const bool deflate = this->GetUseCompression() && m_CompressionMethod != "lzw";
+  if (deflate)
+  {
+    if (!TIFFSetField(m_TIFFImage, TIFFTAG_COMPRESSION, COMPRESSION_ADOBE_DEFLATE))
+    {
+      itkDebugMacro( << "WARNING: mevisIO:write(): error setting COMPRESSION to DEFLATE" );
+    }
+  }
+  else if (this->GetUseCompression())
   {
     if (!TIFFSetField(m_TIFFImage, TIFFTAG_COMPRESSION, 5))
     {
@@ -1909,8 +1830,8 @@ void MevisDicomTiffImageIO
   // (which usually is a reasonable assumption, since
   // the images we're dealing with are usually large)
   // defaults (multiple of 16)
-  m_TileWidth = 128;
-  m_TileLength = 128;
+  m_TileWidth = std::max( 16u, m_WriteTileSize - m_WriteTileSize % 16 );
+  m_TileLength = m_TileWidth;
 
   bool smallimg(false);
   if (m_Width < 16)
@@ -1972,142 +1893,71 @@ void MevisDicomTiffImageIO
   }
   else
   {
-    const unsigned int tilesize = TIFFTileSize(m_TIFFImage);
-    const unsigned int tilerowbytes = TIFFTileRowSize(m_TIFFImage);
-    const unsigned int bytespersample = m_BitsPerSample/8;
-
-    const unsigned char *vol = reinterpret_cast<const unsigned char*>(buffer);
-    unsigned char *tilebuf = static_cast<unsigned char*>(_TIFFmalloc(tilesize));
-
-    // is volume direction a multiple of tiledirection?
-    const bool mx = ( m_Width%m_TileWidth == 0) ? true: false;
-    const bool my = ( m_Length%m_TileLength == 0) ? true : false;
+    // the tiles are filled, and deflated, in parallel, per batch of
+    // tiles to bound the memory, and written in order by this thread
+    MevisTileThreadStruct str;
+    str.Start[0] = 0;
+    str.Start[1] = 0;
+    str.End[0] = m_Width;
+    str.End[1] = m_Length;
+    str.TileWidth = m_TileWidth;
+    str.TileLength = m_TileLength;
+    str.TileSize = TIFFTileSize(m_TIFFImage);
+    str.TileRowBytes = TIFFTileRowSize(m_TIFFImage);
+    str.BytesPerSample = m_BitsPerSample/8;
+    str.RegionRowBytes = static_cast<std::size_t>( m_Width ) * str.BytesPerSample;
+    str.Buffer = const_cast<unsigned char*>(reinterpret_cast<const unsigned char*>(buffer));
+    str.MainTIFF = m_TIFFImage;
+    str.Deflate = deflate;
 
     for (unsigned int z0 = 0; z0 < (m_TIFFDimension == 3 ? m_Depth:1); z0++)
     {
-      for (unsigned int y0 = 0; y0 < (my ? m_Length : m_Length-m_TileLength); y0 += m_TileLength)
-        for (unsigned int x0 = 0; x0 < (mx ? m_Width : m_Width-m_TileWidth); x0 += m_TileWidth)
-        {
-          // set bufferpointer to begin of tile
-          const unsigned char * pv = vol;
-          const unsigned int p = z0 * m_Length * m_Width + y0 * m_Width + x0;
-          pv += p * bytespersample;
-
-          // fill tile
-          unsigned char * pb = tilebuf;
-          for (unsigned int r=0; r<m_TileLength; ++r)
-          {
-            memcpy(pb,pv,tilerowbytes);
-            pv += m_Width * bytespersample;
-            pb += tilerowbytes;
-          }
-          // write tile
-          if (TIFFWriteTile(m_TIFFImage, tilebuf,x0,y0,z0,0)< 0)
-          {
-
-            _TIFFfree(tilebuf);
-            TIFFClose(m_TIFFImage);
-            itkExceptionMacro( << "mevisIO:write(): error writing tile." );
-            return;
-          }
-        }
-        // boundaries
-        if (!mx)
-        {
-          // x is fixed
-          const unsigned lenx = m_Width%m_TileWidth;
-          const unsigned int x0 = m_Width - lenx;
-          const unsigned int tilexbytes = lenx * bytespersample;
-
-          for (unsigned int y0 = 0; y0 < (my ? m_Length: m_Length - m_TileLength); y0 += m_TileLength)
-          {
-            const unsigned char * pv = vol;
-            const unsigned int p = z0 * m_Length * m_Width + y0 * m_Width + x0;
-            pv += p * bytespersample;
-
-            unsigned char * pb = tilebuf;
-            memset (pb,0,tilesize);
-
-            // fill tile
-            for (unsigned int r = 0; r<m_TileLength; ++r)
-            {
-              memcpy(pb,pv,tilexbytes);
-              pv += m_Width * bytespersample;
-              pb += tilerowbytes;
-            }
-
-            if (TIFFWriteTile(m_TIFFImage, tilebuf, x0, y0, z0, 0) < 0)
-            {
-              _TIFFfree(tilebuf);
-              TIFFClose(m_TIFFImage);
-              itkExceptionMacro( << "mevisIO:write(): error writing tile (ydirection)" );
-              return;
-            }
-          }
-        }
-        if (!my)
+      MevisTile tile;
+      tile.z0 = z0;
+      tile.offset = static_cast<std::size_t>( z0 ) * m_Length * str.RegionRowBytes;
+      for (tile.y0 = 0; tile.y0 < m_Length; tile.y0 += m_TileLength)
+      {
+        for (tile.x0 = 0; tile.x0 < m_Width; tile.x0 += m_TileWidth)
         {
-          const unsigned leny = m_Length%m_TileLength;
-          const unsigned int y0 = m_Length - leny;
-
-          for (unsigned int x0 = 0; x0 < (mx ? m_Width : m_Width-m_TileWidth); x0 += m_TileWidth)
-          {
-            const unsigned char * pv = vol;
-            const unsigned int p = z0 * m_Length * m_Width + y0 * m_Width + x0;
-            pv += p * bytespersample;
-
-            unsigned char * pb = tilebuf;
-            memset (pb,0,tilesize);
-
-            for (unsigned int r = 0; r<leny; ++r)
-            {
-              memcpy(pb,pv,tilerowbytes);
-              pv += m_Width * bytespersample;
-              pb += tilerowbytes;
-            }
-
-            if (TIFFWriteTile(m_TIFFImage, tilebuf, x0, y0, z0, 0) < 0)
-            {
-              _TIFFfree(tilebuf);
-              TIFFClose(m_TIFFImage);
-              itkExceptionMacro( << "mevisIO:write(): error writing tile (x-direction)" );
-              return;
-            }
-          }
+          str.Tiles.push_back(tile);
         }
-        if (!mx && !my)
-        {
-          // x0,y0 is fixed
-          const unsigned lenx = m_Width%m_TileWidth;
-          const unsigned int x0 = m_Width - lenx;
-          const unsigned int tilexbytes = lenx * bytespersample;
-          const unsigned leny = m_Length%m_TileLength;
-          const unsigned int y0 = m_Length - leny;
-
-          const unsigned char * pv = vol;
-          const unsigned int p = z0 * m_Length * m_Width + y0 * m_Width + x0;
-          pv += p * bytespersample;
+      }
+    }
 
-          unsigned char * pb = tilebuf;
-          memset (pb,0,tilesize);
+    MultiThreader::Pointer threader = MultiThreader::New();
+    const std::size_t numberOfThreads = threader->GetNumberOfThreads();
+    const std::size_t batchSize = 16 * numberOfThreads;
+    threader->SetSingleMethod( MevisFillTilesThreaderCallback, &str );
 
-          for (unsigned int r = 0; r<leny; ++r)
-          {
-            memcpy(pb,pv,tilexbytes);
-            pv += m_Width * bytespersample;
-            pb += tilerowbytes;
-          }
+    for (str.FirstTile = 0; str.FirstTile < str.Tiles.size(); str.FirstTile += batchSize)
+    {
+      str.NextTile = str.FirstTile;
+      str.EndTile = std::min( str.FirstTile + batchSize, str.Tiles.size() );
+      str.TileData.resize( str.EndTile - str.FirstTile );
+      threader->SetNumberOfThreads( static_cast<ThreadIdType>(
+        std::min( numberOfThreads, str.EndTile - str.FirstTile ) ) );
+      threader->SingleMethodExecute();
+      if (!str.Error.empty())
+      {
+        TIFFClose(m_TIFFImage);
+        itkExceptionMacro( << str.Error );
+      }
 
-          if (TIFFWriteTile(m_TIFFImage, tilebuf, x0, y0, z0, 0) < 0)
-          {
-            _TIFFfree(tilebuf);
-            TIFFClose(m_TIFFImage);
-            itkExceptionMacro( << "mevisIO:write(): error writing tile (corner bottom)" );
-            return;
-          }
+      for (std::size_t i = str.FirstTile; i < str.EndTile; ++i)
+      {
+        const MevisTile & tile = str.Tiles[i];
+        std::vector<unsigned char> & data = str.TileData[i - str.FirstTile];
+        const tsize_t written = deflate
+          ? TIFFWriteRawTile(m_TIFFImage, TIFFComputeTile(m_TIFFImage, tile.x0, tile.y0, tile.z0, 0),
+              &data[0], static_cast<tsize_t>( data.size() ))
+          : TIFFWriteTile(m_TIFFImage, &data[0], tile.x0, tile.y0, tile.z0, 0);
+        if (written < 0)
+        {
+          TIFFClose(m_TIFFImage);
+          itkExceptionMacro( << "mevisIO:write(): error writing tile." );
         }
-    } // end z
-    _TIFFfree(tilebuf);
+      }
+    }
   }
 
   TIFFClose(m_TIFFImage);
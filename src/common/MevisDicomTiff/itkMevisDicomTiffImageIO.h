@@ -121,15 +121,28 @@ public:
   itkGetMacro(RescaleIntercept, double);
   itkGetMacro(GantryTilt, double);
 
+  /** Set/Get the compression of written tiles, if UseCompression is on:
+   * "deflate", the default, whose tiles are compressed in parallel, or
+   * "lzw", which libtiff compresses tile by tile. */
+  itkSetStringMacro(CompressionMethod);
+  itkGetStringMacro(CompressionMethod);
+
+  /** Set/Get the width and length of written tiles, a multiple of 16,
+   * and smaller for small images. Default 128. */
+  itkSetMacro(WriteTileSize, unsigned int);
+  itkGetConstMacro(WriteTileSize, unsigned int);
+
   virtual bool CanReadFile(const char*);
   virtual void ReadImageInformation();
   virtual void Read(void* buffer);
   virtual bool CanWriteFile(const char*);
   virtual void WriteImageInformation();
   virtual void Write(const void* buffer);
+  /** Tiled images can be read per region: only the tiles that
+   * intersect the requested region are decoded. */
   virtual bool CanStreamRead()
     {
-    return false;
+    return true;
     }
 
   virtual bool CanStreamWrite()
@@ -166,6 +179,8 @@ private:
   unsigned int                          m_TileLength;
   unsigned int                          m_TileDepth;
   unsigned short                        m_NumberOfTiles;
+  std::string                           m_CompressionMethod;
+  unsigned int                          m_WriteTileSize;
 
   double                                m_RescaleSlope;
   double                                m_RescaleIntercept;
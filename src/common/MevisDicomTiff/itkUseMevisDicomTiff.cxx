@@ -23,6 +23,11 @@
  *  Call this in your program, before you load/write any images. */
 void RegisterMevisDicomTiff(void)
 {
+  /** Register once, also when several tools run in one process. */
+  static bool registered = false;
+  if( registered ) return;
+  registered = true;
+
 #ifdef _ITKTOOLS_USE_MEVISDICOMTIFF
   itk::ObjectFactoryBase::RegisterFactory( itk::MevisDicomTiffImageIOFactory::New(), 
     itk::ObjectFactoryBase::INSERT_AT_FRONT );
@@ -0,0 +1,151 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkBoundingBoxImageCalculator_h
+#define __itkBoundingBoxImageCalculator_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkMultiThreader.h"
+#include <vector>
+
+
+namespace itk
+{
+
+/** \class BoundingBoxImageCalculator
+ * \brief Compute the bounding box of the pixels larger than zero.
+ *
+ * For sparse images this is much cheaper than visiting every pixel:
+ *   - the slices of the last dimension are tested inward from both faces,
+ *     a batch of one slice per thread at a time, until a slice with a
+ *     pixel larger than zero is found; the slices outside are not read
+ *     again,
+ *   - the slices in between are divided over the threads. Every thread
+ *     scans its lines from both ends only up to the extent it already
+ *     found, and tests the middle of a line only if the line lies outside
+ *     that extent in the other dimensions.
+ * The tests are done on contiguous parts of the buffer, in fixed-size
+ * blocks without early exit inside a block, so that they vectorize.
+ *
+ * The buffered region of the image is searched. If no pixel is larger
+ * than zero, IsEmpty is true, and as in ImageReductionsFilter the minimum
+ * index is the last index of the region and the maximum index the first.
+ */
+
+template< class TInputImage >
+class ITK_EXPORT BoundingBoxImageCalculator : public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef BoundingBoxImageCalculator    Self;
+  typedef Object                        Superclass;
+  typedef SmartPointer<Self>            Pointer;
+  typedef SmartPointer<const Self>      ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( BoundingBoxImageCalculator, Object );
+
+  itkStaticConstMacro( ImageDimension, unsigned int, TInputImage::ImageDimension );
+
+  /** Typedefs. */
+  typedef TInputImage                             ImageType;
+  typedef typename ImageType::PixelType           PixelType;
+  typedef typename ImageType::RegionType          RegionType;
+  typedef typename ImageType::IndexType           IndexType;
+  typedef typename ImageType::SizeType            SizeType;
+  typedef typename ImageType::OffsetValueType     OffsetValueType;
+
+  /** Set the image. */
+  itkSetConstObjectMacro( Image, ImageType );
+
+  /** Set/Get the number of threads. Default the global default. */
+  itkSetMacro( NumberOfThreads, ThreadIdType );
+  itkGetConstMacro( NumberOfThreads, ThreadIdType );
+
+  /** Compute the bounding box. */
+  void Compute( void );
+
+  /** Get the results. */
+  itkGetConstReferenceMacro( MinimumIndex, IndexType );
+  itkGetConstReferenceMacro( MaximumIndex, IndexType );
+  itkGetConstMacro( IsEmpty, bool );
+
+  /** The bounding box as a region; empty if IsEmpty. */
+  RegionType GetRegion( void ) const;
+
+protected:
+  BoundingBoxImageCalculator();
+  virtual ~BoundingBoxImageCalculator() {};
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** Whether any of n contiguous pixels is larger than zero. */
+  static bool AnyPositive( const PixelType * p, SizeValueType n );
+
+  /** The first and last position of a pixel larger than zero in [begin,
+   * end) of a line, or -1. */
+  static OffsetValueType FindFirstPositive( const PixelType * line,
+    OffsetValueType begin, OffsetValueType end );
+  static OffsetValueType FindLastPositive( const PixelType * line,
+    OffsetValueType begin, OffsetValueType end );
+
+  /** Whether a slice of the last dimension has a pixel larger than zero. */
+  bool SliceHasPositive( SizeValueType slice ) const;
+
+  /** The threaded passes. */
+  static ITK_THREAD_RETURN_TYPE FaceThreaderCallback( void * arg );
+  static ITK_THREAD_RETURN_TYPE InteriorThreaderCallback( void * arg );
+  void ThreadedScanSlices( SizeValueType sliceBegin, SizeValueType sliceEnd,
+    ThreadIdType threadId );
+
+private:
+  BoundingBoxImageCalculator( const Self & ); // purposely not implemented
+  void operator=( const Self & );             // purposely not implemented
+
+  typename ImageType::ConstPointer  m_Image;
+  MultiThreader::Pointer            m_Threader;
+  ThreadIdType                      m_NumberOfThreads;
+
+  IndexType         m_MinimumIndex;
+  IndexType         m_MaximumIndex;
+  bool              m_IsEmpty;
+
+  /** The state of the passes: the buffer and its geometry, the slices of
+   * the current face batch and their results, the interior slice range,
+   * and the extent found per thread, relative to the region. */
+  const PixelType *             m_Buffer;
+  SizeType                      m_Size;
+  OffsetValueType               m_Strides[ ImageDimension ];
+  std::vector<SizeValueType>    m_BatchSlices;
+  std::vector<unsigned char>    m_BatchResults;
+  SizeValueType                 m_InteriorBegin;
+  SizeValueType                 m_InteriorEnd;
+  std::vector< std::vector<OffsetValueType> > m_ThreadMinimum;
+  std::vector< std::vector<OffsetValueType> > m_ThreadMaximum;
+
+}; // end class BoundingBoxImageCalculator
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkBoundingBoxImageCalculator.txx"
+#endif
+
+#endif // end #ifndef __itkBoundingBoxImageCalculator_h
@@ -0,0 +1,458 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkBoundingBoxImageCalculator_txx
+#define __itkBoundingBoxImageCalculator_txx
+
+#include "itkBoundingBoxImageCalculator.h"
+#include "itkNumericTraits.h"
+#include <algorithm>
+
+
+namespace itk
+{
+
+/** The number of pixels tested without early exit. */
+static const SizeValueType BoundingBoxImageCalculatorBlockSize = 64;
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template< class TInputImage >
+BoundingBoxImageCalculator< TInputImage >
+::BoundingBoxImageCalculator()
+{
+  this->m_Threader = MultiThreader::New();
+  this->m_NumberOfThreads = this->m_Threader->GetNumberOfThreads();
+  this->m_MinimumIndex.Fill( 0 );
+  this->m_MaximumIndex.Fill( 0 );
+  this->m_IsEmpty = true;
+  this->m_Buffer = 0;
+  this->m_InteriorBegin = 0;
+  this->m_InteriorEnd = 0;
+
+} // end Constructor
+
+
+/**
+ * ******************* Compute *******************
+ */
+
+template< class TInputImage >
+void
+BoundingBoxImageCalculator< TInputImage >
+::Compute( void )
+{
+  if( this->m_Image.IsNull() )
+  {
+    itkExceptionMacro( << "ERROR: no image is set." );
+  }
+
+  const unsigned int last = ImageDimension - 1;
+  const RegionType region = this->m_Image->GetBufferedRegion();
+  const IndexType start = region.GetIndex();
+  this->m_Size = region.GetSize();
+  this->m_Buffer = this->m_Image->GetBufferPointer();
+  this->m_Strides[ 0 ] = 1;
+  for( unsigned int i = 1; i < ImageDimension; ++i )
+  {
+    this->m_Strides[ i ] = this->m_Strides[ i - 1 ] * this->m_Size[ i - 1 ];
+  }
+
+  /** The empty result, as in ImageReductionsFilter. */
+  this->m_IsEmpty = true;
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    this->m_MinimumIndex[ i ] = start[ i ] + static_cast<OffsetValueType>( this->m_Size[ i ] ) - 1;
+    this->m_MaximumIndex[ i ] = start[ i ];
+  }
+  const SizeValueType numberOfSlices = this->m_Size[ last ];
+  if( region.GetNumberOfPixels() == 0 ) return;
+
+  const ThreadIdType numberOfThreads = std::max<ThreadIdType>( this->m_NumberOfThreads, 1 );
+  this->m_Threader->SetSingleMethod( Self::FaceThreaderCallback, this );
+
+  /** Search the first slice from the low face, a batch at a time. */
+  SizeValueType firstSlice = numberOfSlices;
+  for( SizeValueType b = 0; b < numberOfSlices && firstSlice == numberOfSlices; b += numberOfThreads )
+  {
+    const SizeValueType batch = std::min<SizeValueType>( numberOfThreads, numberOfSlices - b );
+    this->m_BatchSlices.resize( batch );
+    this->m_BatchResults.assign( batch, 0 );
+    for( SizeValueType t = 0; t < batch; ++t ) this->m_BatchSlices[ t ] = b + t;
+    this->m_Threader->SetNumberOfThreads( batch );
+    this->m_Threader->SingleMethodExecute();
+    for( SizeValueType t = 0; t < batch; ++t )
+    {
+      if( this->m_BatchResults[ t ] ) { firstSlice = b + t; break; }
+    }
+  }
+  if( firstSlice == numberOfSlices ) return;
+
+  /** Search the last slice from the high face, down to the first. */
+  SizeValueType lastSlice = firstSlice;
+  bool foundLast = false;
+  for( SizeValueType b = numberOfSlices; b > firstSlice + 1 && !foundLast; )
+  {
+    const SizeValueType batch = std::min<SizeValueType>( numberOfThreads, b - firstSlice - 1 );
+    this->m_BatchSlices.resize( batch );
+    this->m_BatchResults.assign( batch, 0 );
+    for( SizeValueType t = 0; t < batch; ++t ) this->m_BatchSlices[ t ] = b - 1 - t;
+    this->m_Threader->SetNumberOfThreads( batch );
+    this->m_Threader->SingleMethodExecute();
+    for( SizeValueType t = 0; t < batch; ++t )
+    {
+      if( this->m_BatchResults[ t ] ) { lastSlice = b - 1 - t; foundLast = true; break; }
+    }
+    b -= batch;
+  }
+
+  this->m_IsEmpty = false;
+  this->m_MinimumIndex[ last ] = start[ last ] + static_cast<OffsetValueType>( firstSlice );
+  this->m_MaximumIndex[ last ] = start[ last ] + static_cast<OffsetValueType>( lastSlice );
+  if( ImageDimension == 1 ) return;
+
+  /** Scan the slices in between for the other dimensions. */
+  this->m_InteriorBegin = firstSlice;
+  this->m_InteriorEnd = lastSlice + 1;
+  const ThreadIdType interiorThreads = static_cast<ThreadIdType>(
+    std::min<SizeValueType>( numberOfThreads, this->m_InteriorEnd - this->m_InteriorBegin ) );
+  this->m_ThreadMinimum.assign( interiorThreads,
+    std::vector<OffsetValueType>( ImageDimension, NumericTraits<OffsetValueType>::max() ) );
+  this->m_ThreadMaximum.assign( interiorThreads,
+    std::vector<OffsetValueType>( ImageDimension, -1 ) );
+  this->m_Threader->SetNumberOfThreads( interiorThreads );
+  this->m_Threader->SetSingleMethod( Self::InteriorThreaderCallback, this );
+  this->m_Threader->SingleMethodExecute();
+
+  /** Merge the extents of the threads. */
+  for( unsigned int i = 0; i < last; ++i )
+  {
+    OffsetValueType minimum = NumericTraits<OffsetValueType>::max();
+    OffsetValueType maximum = -1;
+    for( ThreadIdType t = 0; t < interiorThreads; ++t )
+    {
+      minimum = std::min( minimum, this->m_ThreadMinimum[ t ][ i ] );
+      maximum = std::max( maximum, this->m_ThreadMaximum[ t ][ i ] );
+    }
+    this->m_MinimumIndex[ i ] = start[ i ] + minimum;
+    this->m_MaximumIndex[ i ] = start[ i ] + maximum;
+  }
+
+} // end Compute()
+
+
+/**
+ * ******************* FaceThreaderCallback *******************
+ */
+
+template< class TInputImage >
+ITK_THREAD_RETURN_TYPE
+BoundingBoxImageCalculator< TInputImage >
+::FaceThreaderCallback( void * arg )
+{
+  typedef MultiThreader::ThreadInfoStruct ThreadInfoType;
+  ThreadInfoType * info = static_cast<ThreadInfoType *>( arg );
+  Self * calculator = static_cast<Self *>( info->UserData );
+  const ThreadIdType threadId = info->ThreadID;
+
+  if( threadId < calculator->m_BatchSlices.size() )
+  {
+    calculator->m_BatchResults[ threadId ]
+      = calculator->SliceHasPositive( calculator->m_BatchSlices[ threadId ] );
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end FaceThreaderCallback()
+
+
+/**
+ * ******************* InteriorThreaderCallback *******************
+ */
+
+template< class TInputImage >
+ITK_THREAD_RETURN_TYPE
+BoundingBoxImageCalculator< TInputImage >
+::InteriorThreaderCallback( void * arg )
+{
+  typedef MultiThreader::ThreadInfoStruct ThreadInfoType;
+  ThreadInfoType * info = static_cast<ThreadInfoType *>( arg );
+  Self * calculator = static_cast<Self *>( info->UserData );
+  const ThreadIdType threadId = info->ThreadID;
+  const SizeValueType numberOfThreads = info->NumberOfThreads;
+
+  const SizeValueType n = calculator->m_InteriorEnd - calculator->m_InteriorBegin;
+  const SizeValueType begin = calculator->m_InteriorBegin + n * threadId / numberOfThreads;
+  const SizeValueType end = calculator->m_InteriorBegin + n * ( threadId + 1 ) / numberOfThreads;
+  calculator->ThreadedScanSlices( begin, end, threadId );
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end InteriorThreaderCallback()
+
+
+/**
+ * ******************* ThreadedScanSlices *******************
+ */
+
+template< class TInputImage >
+void
+BoundingBoxImageCalculator< TInputImage >
+::ThreadedScanSlices( SizeValueType sliceBegin, SizeValueType sliceEnd,
+  ThreadIdType threadId )
+{
+  const unsigned int last = ImageDimension - 1;
+  const OffsetValueType lineLength = static_cast<OffsetValueType>( this->m_Size[ 0 ] );
+  const SizeValueType linesPerSlice = this->m_Strides[ last ] / this->m_Size[ 0 ];
+  std::vector<OffsetValueType> & minimum = this->m_ThreadMinimum[ threadId ];
+  std::vector<OffsetValueType> & maximum = this->m_ThreadMaximum[ threadId ];
+
+  for( SizeValueType slice = sliceBegin; slice < sliceEnd; ++slice )
+  {
+    const PixelType * sliceBuffer = this->m_Buffer + slice * this->m_Strides[ last ];
+
+    /** The index of the line in the dimensions between 0 and last. */
+    OffsetValueType lineIndex[ ImageDimension ];
+    std::fill( lineIndex, lineIndex + ImageDimension, 0 );
+
+    for( SizeValueType l = 0; l < linesPerSlice; ++l )
+    {
+      const PixelType * line = sliceBuffer + l * lineLength;
+      bool found = false;
+
+      if( maximum[ 0 ] < 0 )
+      {
+        /** Nothing found yet: scan the whole line from both ends. */
+        const OffsetValueType first = FindFirstPositive( line, 0, lineLength );
+        if( first >= 0 )
+        {
+          minimum[ 0 ] = first;
+          maximum[ 0 ] = FindLastPositive( line, first, lineLength );
+          found = true;
+        }
+      }
+      else
+      {
+        /** Only the parts outside the extent of dimension 0 can extend it. */
+        if( minimum[ 0 ] > 0 )
+        {
+          const OffsetValueType first = FindFirstPositive( line, 0, minimum[ 0 ] );
+          if( first >= 0 ) { minimum[ 0 ] = first; found = true; }
+        }
+        if( maximum[ 0 ] < lineLength - 1 )
+        {
+          const OffsetValueType lastPositive
+            = FindLastPositive( line, maximum[ 0 ] + 1, lineLength );
+          if( lastPositive >= 0 ) { maximum[ 0 ] = lastPositive; found = true; }
+        }
+
+        /** The middle matters only if the line is outside the extent of the
+         * other dimensions. */
+        if( !found )
+        {
+          bool outside = false;
+          for( unsigned int i = 1; i < last; ++i )
+          {
+            outside |= lineIndex[ i ] < minimum[ i ] || lineIndex[ i ] > maximum[ i ];
+          }
+          if( outside )
+          {
+            found = AnyPositive( line + minimum[ 0 ],
+              static_cast<SizeValueType>( maximum[ 0 ] - minimum[ 0 ] + 1 ) );
+          }
+        }
+      }
+
+      if( found )
+      {
+        for( unsigned int i = 1; i < last; ++i )
+        {
+          minimum[ i ] = std::min( minimum[ i ], lineIndex[ i ] );
+          maximum[ i ] = std::max( maximum[ i ], lineIndex[ i ] );
+        }
+      }
+
+      /** Next line. */
+      for( unsigned int i = 1; i < last; ++i )
+      {
+        if( ++lineIndex[ i ] < static_cast<OffsetValueType>( this->m_Size[ i ] ) ) break;
+        lineIndex[ i ] = 0;
+      }
+    }
+
+    /** Stop when the extent is the whole slice. */
+    bool full = minimum[ 0 ] == 0 && maximum[ 0 ] == lineLength - 1;
+    for( unsigned int i = 1; i < last; ++i )
+    {
+      full &= minimum[ i ] == 0
+        && maximum[ i ] == static_cast<OffsetValueType>( this->m_Size[ i ] ) - 1;
+    }
+    if( full ) break;
+  }
+
+} // end ThreadedScanSlices()
+
+
+/**
+ * ******************* SliceHasPositive *******************
+ */
+
+template< class TInputImage >
+bool
+BoundingBoxImageCalculator< TInputImage >
+::SliceHasPositive( SizeValueType slice ) const
+{
+  const unsigned int last = ImageDimension - 1;
+  return AnyPositive( this->m_Buffer + slice * this->m_Strides[ last ],
+    static_cast<SizeValueType>( this->m_Strides[ last ] ) );
+
+} // end SliceHasPositive()
+
+
+/**
+ * ******************* AnyPositive *******************
+ */
+
+template< class TInputImage >
+bool
+BoundingBoxImageCalculator< TInputImage >
+::AnyPositive( const PixelType * p, SizeValueType n )
+{
+  /** Test a block without branches, and stop after the first hit. */
+  const PixelType zero = NumericTraits<PixelType>::Zero;
+  SizeValueType i = 0;
+  for( ; i + BoundingBoxImageCalculatorBlockSize <= n; i += BoundingBoxImageCalculatorBlockSize )
+  {
+    const PixelType * block = p + i;
+    unsigned int any = 0;
+    for( SizeValueType j = 0; j < BoundingBoxImageCalculatorBlockSize; ++j )
+    {
+      any |= ( block[ j ] > zero );
+    }
+    if( any ) return true;
+  }
+
+  unsigned int any = 0;
+  for( ; i < n; ++i )
+  {
+    any |= ( p[ i ] > zero );
+  }
+  return any != 0;
+
+} // end AnyPositive()
+
+
+/**
+ * ******************* FindFirstPositive *******************
+ */
+
+template< class TInputImage >
+typename BoundingBoxImageCalculator< TInputImage >::OffsetValueType
+BoundingBoxImageCalculator< TInputImage >
+::FindFirstPositive( const PixelType * line, OffsetValueType begin, OffsetValueType end )
+{
+  const PixelType zero = NumericTraits<PixelType>::Zero;
+  const OffsetValueType blockSize = BoundingBoxImageCalculatorBlockSize;
+  for( OffsetValueType b = begin; b < end; b += blockSize )
+  {
+    const OffsetValueType e = std::min( b + blockSize, end );
+    if( !AnyPositive( line + b, static_cast<SizeValueType>( e - b ) ) ) continue;
+    for( OffsetValueType i = b; i < e; ++i )
+    {
+      if( line[ i ] > zero ) return i;
+    }
+  }
+  return -1;
+
+} // end FindFirstPositive()
+
+
+/**
+ * ******************* FindLastPositive *******************
+ */
+
+template< class TInputImage >
+typename BoundingBoxImageCalculator< TInputImage >::OffsetValueType
+BoundingBoxImageCalculator< TInputImage >
+::FindLastPositive( const PixelType * line, OffsetValueType begin, OffsetValueType end )
+{
+  const PixelType zero = NumericTraits<PixelType>::Zero;
+  const OffsetValueType blockSize = BoundingBoxImageCalculatorBlockSize;
+  for( OffsetValueType e = end; e > begin; e -= blockSize )
+  {
+    const OffsetValueType b = std::max( e - blockSize, begin );
+    if( !AnyPositive( line + b, static_cast<SizeValueType>( e - b ) ) ) continue;
+    for( OffsetValueType i = e - 1; i >= b; --i )
+    {
+      if( line[ i ] > zero ) return i;
+    }
+  }
+  return -1;
+
+} // end FindLastPositive()
+
+
+/**
+ * ******************* GetRegion *******************
+ */
+
+template< class TInputImage >
+typename BoundingBoxImageCalculator< TInputImage >::RegionType
+BoundingBoxImageCalculator< TInputImage >
+::GetRegion( void ) const
+{
+  RegionType region;
+  SizeType size; size.Fill( 0 );
+  region.SetIndex( this->m_MaximumIndex );
+  if( !this->m_IsEmpty )
+  {
+    region.SetIndex( this->m_MinimumIndex );
+    for( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+      size[ i ] = static_cast<SizeValueType>(
+        this->m_MaximumIndex[ i ] - this->m_MinimumIndex[ i ] + 1 );
+    }
+  }
+  region.SetSize( size );
+  return region;
+
+} // end GetRegion()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template< class TInputImage >
+void
+BoundingBoxImageCalculator< TInputImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "NumberOfThreads: " << this->m_NumberOfThreads << std::endl;
+  os << indent << "MinimumIndex: " << this->m_MinimumIndex << std::endl;
+  os << indent << "MaximumIndex: " << this->m_MaximumIndex << std::endl;
+  os << indent << "IsEmpty: " << this->m_IsEmpty << std::endl;
+
+} // end PrintSelf()
+
+} // end namespace itk
+
+#endif // end #ifndef __itkBoundingBoxImageCalculator_txx
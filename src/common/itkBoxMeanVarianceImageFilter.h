@@ -0,0 +1,141 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkBoxMeanVarianceImageFilter_h
+#define __itkBoxMeanVarianceImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkMultiThreader.h"
+#include <vector>
+
+
+namespace itk
+{
+
+/** \class BoxMeanVarianceImageFilter
+ * \brief Compute the local mean and variance over a box around every pixel.
+ *
+ * The box of a pixel spans Radius pixels on both sides in every dimension,
+ * truncated at the border of the image. The sums of the values and of the
+ * squared values over the boxes are separable: they are computed with one
+ * running sum per line, one dimension after the other, which costs O(D)
+ * per pixel for any radius instead of the O(r^D) of a neighborhood
+ * iterator. The lines of a dimension are divided over the threads.
+ *
+ * Output 0 is the mean and output 1 the variance, the population variance
+ * of the box, or with ComputeStandardDeviation the standard deviation. The
+ * sums are accumulated in double precision, relative to the first value
+ * of the image, which reduces the cancellation in the variance.
+ *
+ * \ingroup IntensityImageFilters
+ */
+
+template< class TInputImage, class TOutputImage >
+class ITK_EXPORT BoxMeanVarianceImageFilter :
+  public ImageToImageFilter< TInputImage, TOutputImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef BoxMeanVarianceImageFilter      Self;
+  typedef ImageToImageFilter<
+    TInputImage, TOutputImage >           Superclass;
+  typedef SmartPointer<Self>              Pointer;
+  typedef SmartPointer<const Self>        ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( BoxMeanVarianceImageFilter, ImageToImageFilter );
+
+  itkStaticConstMacro( ImageDimension, unsigned int, TInputImage::ImageDimension );
+
+  /** Typedefs. */
+  typedef TInputImage                             InputImageType;
+  typedef typename InputImageType::PixelType      InputPixelType;
+  typedef typename InputImageType::RegionType     RegionType;
+  typedef typename InputImageType::SizeType       SizeType;
+  typedef TOutputImage                            OutputImageType;
+  typedef typename OutputImageType::PixelType     OutputPixelType;
+
+  /** Set/Get the radius of the box. Default 1. */
+  itkSetMacro( Radius, SizeType );
+  itkGetConstReferenceMacro( Radius, SizeType );
+  void SetRadius( SizeValueType radius )
+  {
+    SizeType r; r.Fill( radius );
+    this->SetRadius( r );
+  }
+
+  /** Write the standard deviation instead of the variance. Default off. */
+  itkSetMacro( ComputeStandardDeviation, bool );
+  itkGetConstMacro( ComputeStandardDeviation, bool );
+  itkBooleanMacro( ComputeStandardDeviation );
+
+  /** Get the outputs. */
+  OutputImageType * GetMeanOutput( void ) { return this->GetOutput( 0 ); }
+  OutputImageType * GetVarianceOutput( void ) { return this->GetOutput( 1 ); }
+
+protected:
+  BoxMeanVarianceImageFilter();
+  virtual ~BoxMeanVarianceImageFilter() {};
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** The filter needs all of its input, and produces all of its outputs. */
+  virtual void GenerateInputRequestedRegion( void );
+  virtual void EnlargeOutputRequestedRegion( DataObject * data );
+
+  /** Run the passes over the dimensions, and the final pass. */
+  virtual void GenerateData( void );
+
+  /** The threaded passes. */
+  static ITK_THREAD_RETURN_TYPE LineSumsThreaderCallback( void * arg );
+  static ITK_THREAD_RETURN_TYPE OutputThreaderCallback( void * arg );
+
+  /** Replace the lines begin to end of the current dimension by their box
+   * sums. */
+  void ThreadedLineSums( SizeValueType lineBegin, SizeValueType lineEnd );
+
+  /** Compute the outputs of the rows begin to end of dimension 0. */
+  void ThreadedOutput( SizeValueType rowBegin, SizeValueType rowEnd );
+
+private:
+  BoxMeanVarianceImageFilter( const Self & ); // purposely not implemented
+  void operator=( const Self & );             // purposely not implemented
+
+  SizeType              m_Radius;
+  bool                  m_ComputeStandardDeviation;
+
+  /** The state of the passes: the sums and the sums of squares in buffer
+   * order, the dimension of the current pass, the strides of the buffer,
+   * and the number of pixels in the box per position and dimension. */
+  std::vector<double>   m_Sums;
+  std::vector<double>   m_SumsOfSquares;
+  double                m_Shift;
+  unsigned int          m_CurrentDimension;
+  SizeValueType         m_Strides[ ImageDimension ];
+  std::vector<double>   m_BoxCounts[ ImageDimension ];
+
+}; // end class BoxMeanVarianceImageFilter
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkBoxMeanVarianceImageFilter.txx"
+#endif
+
+#endif // end #ifndef __itkBoxMeanVarianceImageFilter_h
@@ -0,0 +1,315 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkBoxMeanVarianceImageFilter_txx
+#define __itkBoxMeanVarianceImageFilter_txx
+
+#include "itkBoxMeanVarianceImageFilter.h"
+#include <algorithm>
+#include <cmath>
+
+
+namespace itk
+{
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+BoxMeanVarianceImageFilter< TInputImage, TOutputImage >
+::BoxMeanVarianceImageFilter()
+{
+  this->m_Radius.Fill( 1 );
+  this->m_ComputeStandardDeviation = false;
+  this->m_Shift = 0.0;
+  this->m_CurrentDimension = 0;
+
+  /** The second output, the variance. */
+  this->SetNumberOfRequiredOutputs( 2 );
+  this->SetNthOutput( 1, this->MakeOutput( 1 ) );
+
+} // end Constructor
+
+
+/**
+ * ******************* GenerateInputRequestedRegion *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+BoxMeanVarianceImageFilter< TInputImage, TOutputImage >
+::GenerateInputRequestedRegion( void )
+{
+  Superclass::GenerateInputRequestedRegion();
+  if( this->GetInput() )
+  {
+    InputImageType * input = const_cast< InputImageType * >( this->GetInput() );
+    input->SetRequestedRegionToLargestPossibleRegion();
+  }
+
+} // end GenerateInputRequestedRegion()
+
+
+/**
+ * ******************* EnlargeOutputRequestedRegion *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+BoxMeanVarianceImageFilter< TInputImage, TOutputImage >
+::EnlargeOutputRequestedRegion( DataObject * data )
+{
+  Superclass::EnlargeOutputRequestedRegion( data );
+  data->SetRequestedRegionToLargestPossibleRegion();
+
+} // end EnlargeOutputRequestedRegion()
+
+
+/**
+ * ******************* GenerateData *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+BoxMeanVarianceImageFilter< TInputImage, TOutputImage >
+::GenerateData( void )
+{
+  this->AllocateOutputs();
+
+  const InputImageType * input = this->GetInput();
+  const SizeType size = input->GetBufferedRegion().GetSize();
+  const SizeValueType numberOfPixels = input->GetBufferedRegion().GetNumberOfPixels();
+  if( numberOfPixels == 0 ) return;
+
+  this->m_Strides[ 0 ] = 1;
+  for( unsigned int i = 1; i < ImageDimension; ++i )
+  {
+    this->m_Strides[ i ] = this->m_Strides[ i - 1 ] * size[ i - 1 ];
+  }
+
+  /** The number of pixels of the truncated box, per position and dimension. */
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    const OffsetValueType n = static_cast<OffsetValueType>( size[ i ] );
+    const OffsetValueType r = static_cast<OffsetValueType>( this->m_Radius[ i ] );
+    this->m_BoxCounts[ i ].resize( size[ i ] );
+    for( OffsetValueType k = 0; k < n; ++k )
+    {
+      this->m_BoxCounts[ i ][ k ] = static_cast<double>(
+        std::min( k + r, n - 1 ) - std::max( k - r, OffsetValueType( 0 ) ) + 1 );
+    }
+  }
+
+  this->m_Shift = static_cast<double>( input->GetBufferPointer()[ 0 ] );
+  this->m_Sums.resize( numberOfPixels );
+  this->m_SumsOfSquares.resize( numberOfPixels );
+
+  /** One pass of running sums per dimension, then the outputs. */
+  MultiThreader * threader = this->GetMultiThreader();
+  threader->SetNumberOfThreads( this->GetNumberOfThreads() );
+  threader->SetSingleMethod( Self::LineSumsThreaderCallback, this );
+  for( unsigned int d = 0; d < ImageDimension; ++d )
+  {
+    this->m_CurrentDimension = d;
+    threader->SingleMethodExecute();
+  }
+  threader->SetSingleMethod( Self::OutputThreaderCallback, this );
+  threader->SingleMethodExecute();
+
+  /** Release the memory of the sums. */
+  std::vector<double>().swap( this->m_Sums );
+  std::vector<double>().swap( this->m_SumsOfSquares );
+
+} // end GenerateData()
+
+
+/**
+ * ******************* LineSumsThreaderCallback *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+ITK_THREAD_RETURN_TYPE
+BoxMeanVarianceImageFilter< TInputImage, TOutputImage >
+::LineSumsThreaderCallback( void * arg )
+{
+  typedef MultiThreader::ThreadInfoStruct ThreadInfoType;
+  ThreadInfoType * info = static_cast<ThreadInfoType *>( arg );
+  Self * filter = static_cast<Self *>( info->UserData );
+  const SizeValueType threadId = info->ThreadID;
+  const SizeValueType numberOfThreads = info->NumberOfThreads;
+
+  const SizeValueType numberOfLines = filter->m_Sums.size()
+    / filter->GetInput()->GetBufferedRegion().GetSize()[ filter->m_CurrentDimension ];
+  filter->ThreadedLineSums( numberOfLines * threadId / numberOfThreads,
+    numberOfLines * ( threadId + 1 ) / numberOfThreads );
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end LineSumsThreaderCallback()
+
+
+/**
+ * ******************* ThreadedLineSums *******************
+ *
+ * Lines are numbered with the positions in the lower dimensions fastest,
+ * so that consecutive lines of the higher dimensions share cache lines.
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+BoxMeanVarianceImageFilter< TInputImage, TOutputImage >
+::ThreadedLineSums( SizeValueType lineBegin, SizeValueType lineEnd )
+{
+  const unsigned int d = this->m_CurrentDimension;
+  const SizeValueType n = this->GetInput()->GetBufferedRegion().GetSize()[ d ];
+  const SizeValueType r = this->m_Radius[ d ];
+  const SizeValueType stride = this->m_Strides[ d ];
+  const InputPixelType * inputBuffer = this->GetInput()->GetBufferPointer();
+  const double shift = this->m_Shift;
+  double * sums = &this->m_Sums[ 0 ];
+  double * sumsOfSquares = &this->m_SumsOfSquares[ 0 ];
+
+  /** The prefix sums of a line. */
+  std::vector<double> prefix( n + 1, 0.0 );
+  std::vector<double> prefixOfSquares( n + 1, 0.0 );
+
+  for( SizeValueType l = lineBegin; l < lineEnd; ++l )
+  {
+    const SizeValueType base = ( l / stride ) * stride * n + l % stride;
+
+    /** The first pass reads the input, the others the sums so far. */
+    if( d == 0 )
+    {
+      const InputPixelType * line = inputBuffer + base;
+      for( SizeValueType k = 0; k < n; ++k )
+      {
+        const double value = static_cast<double>( line[ k ] ) - shift;
+        prefix[ k + 1 ] = prefix[ k ] + value;
+        prefixOfSquares[ k + 1 ] = prefixOfSquares[ k ] + value * value;
+      }
+    }
+    else
+    {
+      for( SizeValueType k = 0; k < n; ++k )
+      {
+        prefix[ k + 1 ] = prefix[ k ] + sums[ base + k * stride ];
+        prefixOfSquares[ k + 1 ] = prefixOfSquares[ k ] + sumsOfSquares[ base + k * stride ];
+      }
+    }
+
+    /** The box sums are differences of the prefix sums. */
+    for( SizeValueType k = 0; k < n; ++k )
+    {
+      const SizeValueType lo = k > r ? k - r : 0;
+      const SizeValueType hi = std::min( k + r, n - 1 ) + 1;
+      sums[ base + k * stride ] = prefix[ hi ] - prefix[ lo ];
+      sumsOfSquares[ base + k * stride ] = prefixOfSquares[ hi ] - prefixOfSquares[ lo ];
+    }
+  }
+
+} // end ThreadedLineSums()
+
+
+/**
+ * ******************* OutputThreaderCallback *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+ITK_THREAD_RETURN_TYPE
+BoxMeanVarianceImageFilter< TInputImage, TOutputImage >
+::OutputThreaderCallback( void * arg )
+{
+  typedef MultiThreader::ThreadInfoStruct ThreadInfoType;
+  ThreadInfoType * info = static_cast<ThreadInfoType *>( arg );
+  Self * filter = static_cast<Self *>( info->UserData );
+  const SizeValueType threadId = info->ThreadID;
+  const SizeValueType numberOfThreads = info->NumberOfThreads;
+
+  const SizeValueType numberOfRows = filter->m_Sums.size()
+    / filter->GetInput()->GetBufferedRegion().GetSize()[ 0 ];
+  filter->ThreadedOutput( numberOfRows * threadId / numberOfThreads,
+    numberOfRows * ( threadId + 1 ) / numberOfThreads );
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end OutputThreaderCallback()
+
+
+/**
+ * ******************* ThreadedOutput *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+BoxMeanVarianceImageFilter< TInputImage, TOutputImage >
+::ThreadedOutput( SizeValueType rowBegin, SizeValueType rowEnd )
+{
+  const SizeType size = this->GetInput()->GetBufferedRegion().GetSize();
+  const SizeValueType n = size[ 0 ];
+  const double shift = this->m_Shift;
+  const bool computeStandardDeviation = this->m_ComputeStandardDeviation;
+  const double * counts = &this->m_BoxCounts[ 0 ][ 0 ];
+  OutputPixelType * means = this->GetOutput( 0 )->GetBufferPointer();
+  OutputPixelType * variances = this->GetOutput( 1 )->GetBufferPointer();
+
+  for( SizeValueType row = rowBegin; row < rowEnd; ++row )
+  {
+    /** The number of pixels of the box in the other dimensions. */
+    double rowCount = 1.0;
+    SizeValueType rest = row;
+    for( unsigned int i = 1; i < ImageDimension; ++i )
+    {
+      rowCount *= this->m_BoxCounts[ i ][ rest % size[ i ] ];
+      rest /= size[ i ];
+    }
+
+    const SizeValueType base = row * n;
+    for( SizeValueType k = 0; k < n; ++k )
+    {
+      const double count = rowCount * counts[ k ];
+      const double mean = this->m_Sums[ base + k ] / count;
+      const double variance = std::max(
+        this->m_SumsOfSquares[ base + k ] / count - mean * mean, 0.0 );
+      means[ base + k ] = static_cast<OutputPixelType>( mean + shift );
+      variances[ base + k ] = static_cast<OutputPixelType>(
+        computeStandardDeviation ? std::sqrt( variance ) : variance );
+    }
+  }
+
+} // end ThreadedOutput()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+BoxMeanVarianceImageFilter< TInputImage, TOutputImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "Radius: " << this->m_Radius << std::endl;
+  os << indent << "ComputeStandardDeviation: " << this->m_ComputeStandardDeviation << std::endl;
+
+} // end PrintSelf()
+
+} // end namespace itk
+
+#endif // end #ifndef __itkBoxMeanVarianceImageFilter_txx
@@ -18,16 +18,31 @@
 #ifndef __itkChannelByChannelVectorImageFilter2_h
 #define __itkChannelByChannelVectorImageFilter2_h
 
-#include "itkVectorIndexSelectionCastImageFilter.h" // decompose
-#include "itkImageToVectorImageFilter.h" // reassemble
 #include "itkImage.h"
 #include "itkVectorImage.h"
 #include "itkImageToImageFilter.h"
+#include "itkPlanarVectorImage.h"
+#include <vector>
 
 namespace itk
 {
 /** \class ChannelByChannelVectorImageFilter2
  *  \brief This filter is a helper class to apply per channel a standard itk::ImageToImageFilter to a VectorImage.
+ *
+ *  The input is transposed once into a PlanarVectorImage, with one plane
+ *  per channel, in a cache-blocked pass. The scalar filter runs on a view
+ *  of a plane, without a copy, and its output is copied directly into the
+ *  output vector buffer. Besides the planes, no full-size image is kept
+ *  per channel.
+ *
+ *  With a single filter (SetFilter()) the channels are processed one after
+ *  the other. When several filters with identical settings are given
+ *  (SetFilters()), that many channels are processed concurrently, but never
+ *  more than the number of threads of this filter. The threads are then
+ *  divided over the concurrent filters. Memory use is the planes, one copy
+ *  of the input, and one scalar output image per concurrent filter.
+ *
+ *  The scalar filter should produce an output of the same size as its input.
  */
 template <class TInputImage, class TFilter, class TOutputImage = TInputImage>
 class ITK_EXPORT ChannelByChannelVectorImageFilter2
@@ -57,14 +72,28 @@ public:
   typedef typename OutputVectorImageType::InternalPixelType             OutputPixelType;
   typedef Image<OutputPixelType, OutputVectorImageType::ImageDimension> OutputImageType;
 
+  typedef PlanarVectorImage<InputPixelType,
+    InputVectorImageType::ImageDimension>                             PlanarInputImageType;
+
   typedef TFilter                      FilterType;
   typedef typename FilterType::Pointer FilterPointerType;
 
+  /** Use a single filter; the channels are processed sequentially. */
   void SetFilter(FilterPointerType);
 
+  /** Use several filters with identical settings; as many channels are
+   * processed concurrently.
+   */
+  void SetFilters(const std::vector<FilterPointerType> & filters);
+
 protected:
   /** Main computation method */
   virtual void GenerateData(void);
+  /** The output has the number of channels of the input. */
+  virtual void GenerateOutputInformation(void);
+  /** The channels are filtered as a whole. */
+  virtual void GenerateInputRequestedRegion(void);
+  virtual void EnlargeOutputRequestedRegion(DataObject * output);
   /** Constructor */
   ChannelByChannelVectorImageFilter2();
   /** Destructor */
@@ -72,7 +101,20 @@ protected:
   /**PrintSelf method */
   virtual void PrintSelf(std::ostream& os, itk::Indent indent) const;
 
-  FilterPointerType m_Filter;
+  /** Process the channels worker, worker + numberOfWorkers, ... */
+  void ProcessChannels(unsigned int worker, unsigned int numberOfWorkers);
+
+  /** Static function used as a "callback" by the MultiThreader. */
+  static ITK_THREAD_RETURN_TYPE ProcessChannelsThreaderCallback(void *arg);
+
+  std::vector<FilterPointerType> m_Filters;
+
+  /** The channels of the input, one plane each, while filtering. */
+  typename PlanarInputImageType::Pointer m_PlanarInput;
+
+  /** Error messages of the workers, rethrown after all have finished. */
+  std::vector<std::string> m_WorkerErrors;
+
 private:
   ChannelByChannelVectorImageFilter2(const Self &); //purposely not implemented
   void operator =(const Self&); //purposely not implemented
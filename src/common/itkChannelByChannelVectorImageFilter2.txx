@@ -19,6 +19,8 @@
 #define __itkChannelByChannelVectorImageFilter2_txx
 
 #include "itkChannelByChannelVectorImageFilter2.h"
+#include "itkMultiThreader.h"
+#include <algorithm>
 
 namespace itk
 {
@@ -33,16 +35,71 @@ ChannelByChannelVectorImageFilter2<TInputImage, TFilter, TOutputImage>
 }
 
 /**
- * Main computation method
+ * Set a single filter
  */
 template <class TInputImage, class TFilter, class TOutputImage>
 void
 ChannelByChannelVectorImageFilter2<TInputImage, TFilter, TOutputImage>
 ::SetFilter(typename TFilter::Pointer filter)
 {
-  m_Filter = filter;
+  m_Filters.assign(1, filter);
+  this->Modified();
+}
+
+/**
+ * Set the filters for concurrent processing
+ */
+template <class TInputImage, class TFilter, class TOutputImage>
+void
+ChannelByChannelVectorImageFilter2<TInputImage, TFilter, TOutputImage>
+::SetFilters(const std::vector<FilterPointerType> & filters)
+{
+  m_Filters = filters;
+  this->Modified();
+}
+
+/**
+ * The output has as many channels as the input
+ */
+template <class TInputImage, class TFilter, class TOutputImage>
+void
+ChannelByChannelVectorImageFilter2<TInputImage, TFilter, TOutputImage>
+::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+
+  this->GetOutput()->SetNumberOfComponentsPerPixel(
+    this->GetInput()->GetNumberOfComponentsPerPixel());
 }
 
+/**
+ * Request the complete input
+ */
+template <class TInputImage, class TFilter, class TOutputImage>
+void
+ChannelByChannelVectorImageFilter2<TInputImage, TFilter, TOutputImage>
+::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  InputVectorImageType * input = const_cast<InputVectorImageType *>(this->GetInput());
+  if(input)
+    {
+    input->SetRequestedRegionToLargestPossibleRegion();
+    }
+}
+
+/**
+ * Produce the complete output
+ */
+template <class TInputImage, class TFilter, class TOutputImage>
+void
+ChannelByChannelVectorImageFilter2<TInputImage, TFilter, TOutputImage>
+::EnlargeOutputRequestedRegion(DataObject * output)
+{
+  Superclass::EnlargeOutputRequestedRegion(output);
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
 
 /**
  * Main computation method
@@ -52,40 +109,130 @@ void
 ChannelByChannelVectorImageFilter2<TInputImage, TFilter, TOutputImage>
 ::GenerateData()
 {
-  // Create the disassembler
-  typedef itk::VectorIndexSelectionCastImageFilter<TInputImage, InputScalarImageType> IndexSelectionType;
-  typename IndexSelectionType::Pointer indexSelectionFilter = IndexSelectionType::New();
-  indexSelectionFilter->SetInput(this->GetInput());
+  if(m_Filters.empty())
+    {
+    itkExceptionMacro(<< "No filter was set.");
+    }
+  for(unsigned int i = 0; i < m_Filters.size(); i++)
+    {
+    if(m_Filters[i].IsNull())
+      {
+      itkExceptionMacro(<< "Filter " << i << " was not set.");
+      }
+    }
 
-  // Create the re-assembler
-  typedef itk::ImageToVectorImageFilter<InputScalarImageType> ImageToVectorImageFilterType;
-  typename ImageToVectorImageFilterType::Pointer imageToVectorImageFilter = ImageToVectorImageFilterType::New();
+  this->AllocateOutputs();
 
-  // Create a filter for each channel - duplicating all of the settings of the input filter
-  std::vector<typename TFilter::Pointer> filters;
-  filters[0] = m_Filter;
+  // Process at most one channel per thread, and divide the threads over the filters
+  const unsigned int numberOfChannels = this->GetInput()->GetNumberOfComponentsPerPixel();
+  unsigned int numberOfWorkers = static_cast<unsigned int>(m_Filters.size());
+  numberOfWorkers = std::min(numberOfWorkers, numberOfChannels);
+  numberOfWorkers = std::min(numberOfWorkers, static_cast<unsigned int>(this->GetNumberOfThreads()));
+  numberOfWorkers = std::max(numberOfWorkers, 1u);
 
-  for(unsigned int i = 1; i < this->GetInput()->GetNumberOfComponentsPerPixel(); i++)
+  const ThreadIdType threadsPerFilter
+    = std::max(this->GetNumberOfThreads() / numberOfWorkers, static_cast<ThreadIdType>(1));
+  for(unsigned int i = 0; i < numberOfWorkers; i++)
     {
-    filters[i] = dynamic_cast<FilterType*>(m_Filter->CreateAnother().GetPointer());
+    m_Filters[i]->SetNumberOfThreads(threadsPerFilter);
     }
 
-  // Apply the filter to each channel
-  for(unsigned int channel = 0; channel < this->GetInput()->GetNumberOfComponentsPerPixel(); channel++)
+  // Transpose the input into one plane per channel, once for all channels
+  m_PlanarInput = PlanarInputImageType::New();
+  m_PlanarInput->DeinterleaveFrom(this->GetInput());
+
+  m_WorkerErrors.assign(numberOfWorkers, "");
+  if(numberOfWorkers == 1)
+    {
+    this->ProcessChannels(0, 1);
+    }
+  else
     {
-    indexSelectionFilter->SetIndex(channel);
-    indexSelectionFilter->Update();
+    MultiThreader::Pointer threader = MultiThreader::New();
+    threader->SetNumberOfThreads(numberOfWorkers);
+    threader->SetSingleMethod(Self::ProcessChannelsThreaderCallback, this);
+    threader->SingleMethodExecute();
+    }
 
-    filters[channel]->SetInput(indexSelectionFilter->GetOutput());
-    filters[channel]->Update();
+  m_PlanarInput = NULL;
 
-    imageToVectorImageFilter->SetNthInput(channel, filters[channel]->GetOutput());
+  // Rethrow the first error of a worker
+  for(unsigned int i = 0; i < m_WorkerErrors.size(); i++)
+    {
+    if(!m_WorkerErrors[i].empty())
+      {
+      itkExceptionMacro(<< "Filtering failed: " << m_WorkerErrors[i]);
+      }
     }
+}
 
-  imageToVectorImageFilter->Update();
+/**
+ * Threader callback
+ */
+template <class TInputImage, class TFilter, class TOutputImage>
+ITK_THREAD_RETURN_TYPE
+ChannelByChannelVectorImageFilter2<TInputImage, TFilter, TOutputImage>
+::ProcessChannelsThreaderCallback(void *arg)
+{
+  MultiThreader::ThreadInfoStruct * info
+    = static_cast<MultiThreader::ThreadInfoStruct *>(arg);
+  Self * self = static_cast<Self *>(info->UserData);
 
-  this->GraftOutput(imageToVectorImageFilter->GetOutput());
+  self->ProcessChannels(info->ThreadID, info->NumberOfThreads);
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+/**
+ * Process the channels of one worker
+ */
+template <class TInputImage, class TFilter, class TOutputImage>
+void
+ChannelByChannelVectorImageFilter2<TInputImage, TFilter, TOutputImage>
+::ProcessChannels(unsigned int worker, unsigned int numberOfWorkers)
+{
+  try
+    {
+    OutputVectorImageType * output = this->GetOutput();
+    const unsigned int numberOfChannels = m_PlanarInput->GetNumberOfComponentsPerPixel();
+    const SizeValueType numberOfPixels = m_PlanarInput->GetNumberOfPixelsPerChannel();
+    OutputPixelType * outputBuffer = output->GetBufferPointer();
+
+    FilterType * filter = m_Filters[worker];
+
+    for(unsigned int channel = worker; channel < numberOfChannels; channel += numberOfWorkers)
+      {
+      // The plane of the channel is the input of the filter, without a copy
+      filter->SetInput(m_PlanarInput->GetChannel(channel));
+      filter->Update();
+
+      // Copy the result directly into the interleaved output buffer
+      const typename FilterType::OutputImageType * filtered = filter->GetOutput();
+      if(filtered->GetBufferedRegion().GetSize() != output->GetBufferedRegion().GetSize())
+        {
+        itkExceptionMacro(<< "The filter output does not have the size of its input.");
+        }
+      const OutputPixelType * filteredBuffer = filtered->GetBufferPointer();
+      for(SizeValueType i = 0; i < numberOfPixels; i++)
+        {
+        outputBuffer[i * numberOfChannels + channel] = filteredBuffer[i];
+        }
+      }
+
+    // Release the memory of this worker
+    filter->GetOutput()->ReleaseData();
+    filter->SetInput(NULL);
+    }
+  catch(ExceptionObject & excp)
+    {
+    m_WorkerErrors[worker] = excp.GetDescription();
+    }
+  catch(std::exception & excp)
+    {
+    m_WorkerErrors[worker] = excp.what();
+    }
 }
+
 /**
  * PrintSelf Method
  */
@@ -95,6 +242,7 @@ ChannelByChannelVectorImageFilter2<TInputImage, TFilter, TOutputImage>
 ::PrintSelf(std::ostream& os, itk::Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
+  os << indent << "Number of filters: " << m_Filters.size() << std::endl;
 }
 } // End namespace itk
 #endif
@@ -19,8 +19,11 @@
 #define __itkCommandLineArgumentParser_cxx_
 
 #include "itkCommandLineArgumentParser.h"
+#include "ITKToolsBatch.h"
 
+#include <fstream>
 #include <limits>
+#include <sstream>
 
 namespace itk
 {
@@ -47,10 +50,22 @@ void
 CommandLineArgumentParser
 ::SetCommandLineArguments( int argc, char **argv )
 {
-  this->m_Argv.resize( argc );
+  this->m_Argv.clear();
+  this->m_ManifestColumns.clear();
+  this->m_ManifestErrors.clear();
   for ( IndexType i = 0; i < static_cast<IndexType>( argc ); i++ )
   {
-    this->m_Argv[ i ] = argv [ i ];
+    const std::string argument = argv[ i ];
+
+    /** Replace @file by the entries of the manifest file. */
+    if( i > 0 && argument.size() > 1 && argument[ 0 ] == '@' )
+    {
+      this->ReadManifest( argument.substr( 1 ) );
+    }
+    else
+    {
+      this->m_Argv.push_back( argument );
+    }
   }
   this->CreateArgumentMap();
 
@@ -65,18 +80,85 @@ void
 CommandLineArgumentParser
 ::CreateArgumentMap( void )
 {
+  this->m_ArgumentMap.clear();
   for ( IndexType i = 1; i < this->m_Argv.size(); ++i )
   {
     if( this->m_Argv[ i ].substr( 0, 1 ) == "-" )
     {
-      /** All key entries are removed, the latest is stored. */
-      this->m_ArgumentMap.erase( this->m_Argv[ i ] );
+      /** Only the first occurrence of a key is stored, as found by FindKey(). */
       this->m_ArgumentMap.insert( EntryType( this->m_Argv[ i ], i ) );
     }
   }
+
+  /** Store for every index the index of the next key, so that FindKey()
+   * does not need to scan the arguments, which are many for long lists.
+   * Negative numbers are values, not keys.
+   */
+  this->m_NextKeyIndices.resize( this->m_Argv.size() );
+  IndexType nextKeyIndex = this->m_Argv.size();
+  for ( IndexType i = this->m_Argv.size(); i > 0; --i )
+  {
+    this->m_NextKeyIndices[ i - 1 ] = nextKeyIndex;
+    const std::string & argument = this->m_Argv[ i - 1 ];
+    if( argument.substr( 0, 1 ) == "-" && !this->IsANumber( argument ) )
+    {
+      nextKeyIndex = i - 1;
+    }
+  }
+
 } // end CreateArgumentMap()
 
 
+/**
+ * ******************* ReadManifest *******************
+ */
+
+bool
+CommandLineArgumentParser
+::ReadManifest( const std::string & fileName )
+{
+  std::ifstream manifest( fileName.c_str() );
+  if( !manifest.is_open() )
+  {
+    this->m_ManifestErrors.push_back(
+      "ERROR: Could not open the manifest file \"" + fileName + "\"." );
+    return false;
+  }
+
+  std::string line;
+  unsigned int lineNumber = 0;
+  while( std::getline( manifest, line ) )
+  {
+    ++lineNumber;
+
+    /** Split the line into its columns. */
+    std::vector<std::string> columns;
+    if( !itktools::SplitCommandLine( line, columns ) )
+    {
+      std::stringstream ss;
+      ss << "ERROR: Unbalanced quotes on line " << lineNumber
+        << " of the manifest file \"" << fileName << "\".";
+      this->m_ManifestErrors.push_back( ss.str() );
+      return false;
+    }
+
+    /** Skip empty lines and comments. */
+    if( columns.empty() || columns[ 0 ].substr( 0, 1 ) == "#" ) continue;
+
+    /** Store the value and its extra columns. */
+    if( columns.size() > 1 )
+    {
+      this->m_ManifestColumns[ this->m_Argv.size() ].assign(
+        columns.begin() + 1, columns.end() );
+    }
+    this->m_Argv.push_back( columns[ 0 ] );
+  }
+
+  return true;
+
+} // end ReadManifest()
+
+
 /**
  * ******************* ArgumentExists *******************
  */
@@ -148,32 +230,15 @@ CommandLineArgumentParser
 ::FindKey( const std::string & key,
   IndexType & keyIndex, IndexType & nextKeyIndex ) const
 {
-  /** Loop once over the arguments, to get the index of the key,
-   * and that of the next key.
-   */
-  bool keyFound = false;
+  /** Look up the index of the key, and that of the next key. */
   keyIndex = 0;
   nextKeyIndex = this->m_Argv.size();
-  for ( IndexType i = 0; i < this->m_Argv.size(); i++ )
-  {
-    if( !keyFound && this->m_Argv[ i ] == key )
-    {
-      keyFound = true;
-      keyIndex = i;
-      continue;
-    }
-    if( keyFound && this->m_Argv[ i ].substr(0,1) == "-" )
-    {
-      if( !this->IsANumber( this->m_Argv[ i ] ) )
-      {
-        nextKeyIndex = i;
-        break;
-      }
-    }
-  } // end for loop
+  ArgumentMapType::const_iterator it = this->m_ArgumentMap.find( key );
+  if( it == this->m_ArgumentMap.end() ) return false;
+  keyIndex = it->second;
+  nextKeyIndex = this->m_NextKeyIndices[ keyIndex ];
 
-  /** Check if the key was found and if the next argument is not also a key. */
-  if( !keyFound ) return false;
+  /** Check if the next argument is not also a key. */
   if( nextKeyIndex - keyIndex == 1 ) return false;
 
   return true;
@@ -261,6 +326,16 @@ CommandLineArgumentParser::ReturnValue
 CommandLineArgumentParser
 ::CheckForRequiredArguments() const
 {
+  // Report manifest files that could not be read.
+  if( !this->m_ManifestErrors.empty() )
+  {
+    for ( std::size_t i = 0; i < this->m_ManifestErrors.size(); ++i )
+    {
+      std::cerr << this->m_ManifestErrors[ i ] << std::endl;
+    }
+    return FAILED;
+  }
+
   // If no arguments were specified at all, display the help text.
   if( this->m_Argv.size() == 1 )
   {
@@ -69,6 +69,19 @@ namespace itk
  * one (1) argument is provided in the command line, we create a
  * vector of size "size" and fill it with the single argument.
  *
+ * An argument "@file" is replaced by the entries of the manifest file
+ * "file", which makes it possible to pass very long lists of inputs without
+ * hitting the length limit of the command line, e.g.:
+ *
+ *   pxmeanstdimage -in @atlases.txt -outmean mean.mhd
+ *
+ * A manifest holds one entry per line. Empty lines and lines starting
+ * with '#' are skipped. The first column is the value, e.g. a file name,
+ * further columns separated by white space hold optional per-entry data,
+ * such as a weight or a mask file name, and can be retrieved with
+ * GetManifestColumn(). Double quotes can be used for values containing
+ * spaces. Relative paths are taken relative to the current directory.
+ *
  * Internally, the command line arguments are stored in an std::map
  * of the argument (key) as an std::string together with the index.
  * We make use of the casting functionality of string streams to
@@ -203,6 +216,63 @@ public:
 
   }; // end GetCommandLineArgument()
 
+  /** Get an extra column of the manifest entries given with key.
+   * Column 0 holds the values themselves, so column 1 is the first extra
+   * column. Returns false if the key does not exist, or if not all of its
+   * values come from a manifest line with this column.
+   */
+  template <class T>
+  bool GetManifestColumn(
+    const std::string & key, unsigned int column, std::vector<T> & arg )
+  {
+    /** Check for the key. */
+    IndexType keyIndex, nextKeyIndex;
+    keyIndex = nextKeyIndex = 0;
+    bool keyFound = this->FindKey( key, keyIndex, nextKeyIndex );
+    if( !keyFound || column == 0 ) return false;
+
+    /** Check that all values have this column. */
+    for ( IndexType i = keyIndex + 1; i < nextKeyIndex; i++ )
+    {
+      ManifestColumnsMapType::const_iterator it = this->m_ManifestColumns.find( i );
+      if( it == this->m_ManifestColumns.end() || it->second.size() < column )
+      {
+        return false;
+      }
+    }
+
+    arg.resize( nextKeyIndex - keyIndex - 1 );
+    IndexType j = 0;
+    for ( IndexType i = keyIndex + 1; i < nextKeyIndex; i++ )
+    {
+      const std::string & value
+        = this->m_ManifestColumns.find( i )->second[ column - 1 ];
+
+      /** Cast the string to type T. */
+      T casted;
+      bool castSuccesful = this->StringCast( value, casted );
+
+      /** Check if the cast was successful. */
+      if( !castSuccesful )
+      {
+        std::stringstream ss;
+        ss << "ERROR: Casting column " << column << " of manifest entry "
+          << j << " for the parameter \"" << key
+          << "\" failed!\n"
+          << "  You tried to cast \"" << value
+          << "\" from std::string to "
+          << typeid( arg[ j ] ).name() << std::endl;
+
+        itkExceptionMacro( << ss.str() );
+      }
+
+      arg[ j ] = casted;
+      ++j;
+    }
+    return true;
+
+  }; // end GetManifestColumn()
+
   /** Get command line argument if arg is not a vector type.
     * We do this by creating a 1D vector, using the GetCommandLineArgument
     * for vector types, and then returning the first element.
@@ -226,6 +296,9 @@ protected:
   bool FindKey( const std::string & key,
     IndexType & keyIndex, IndexType & nextKeyIndex ) const;
 
+  /** Read the entries of the manifest file fileName, and append them to m_Argv. */
+  bool ReadManifest( const std::string & fileName );
+
   /** General functionality: Check if key is a number or not. */
   bool IsANumber( const std::string & arg ) const;
 
@@ -263,10 +336,21 @@ protected:
   std::vector<std::string> m_Argv;
 
   /** A map to store the arguments and their indices. The arguments are stored
-    * INCLUDING the leading dash. I.e. an example pair is ("-test", 2)
+    * INCLUDING the leading dash. I.e. an example pair is ("-test", 2).
+    * For keys given more than once, the first occurrence is stored.
     */
   ArgumentMapType m_ArgumentMap;
 
+  /** For every index in m_Argv, the index of the next key. */
+  std::vector<IndexType> m_NextKeyIndices;
+
+  /** The extra columns of the manifest entries, indexed by their index in m_Argv. */
+  typedef std::map< IndexType, std::vector<std::string> > ManifestColumnsMapType;
+  ManifestColumnsMapType m_ManifestColumns;
+
+  /** Errors that occurred while reading the manifests. */
+  std::vector<std::string> m_ManifestErrors;
+
   /** The list of required arguments. They are stored with an accompanying help text string. */
   std::vector<std::pair<std::string, std::string> > m_RequiredArguments;
 
@@ -0,0 +1,186 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkConvexShapeImageSource_h
+#define __itkConvexShapeImageSource_h
+
+#include "itkImageSource.h"
+#include "itkMatrix.h"
+#include "itkVector.h"
+#include <vector>
+
+
+namespace itk
+{
+
+/** \class ConvexShapeImageSource
+ * \brief Rasterize a convex shape by computing its span on every scanline.
+ *
+ * The shape is given in physical coordinates around a center c, as the
+ * intersection of
+ *   - a quadric, the points p with (p-c)^T A (p-c) <= 1, for a positive
+ *     semi-definite A; a sphere, an ellipsoid or a cylinder,
+ *   - any number of slabs, the points with |n.(p-c)| < r; a (rotated) box.
+ * Along a scanline both conditions are a quadratic or linear inequality in
+ * the index, so the inside of a convex shape is a single span, which is
+ * computed in closed form. The voxels at the ends of the span are checked
+ * with the inequalities, so that the result is the same as evaluating
+ * every voxel. A scanline is filled with two std::fill calls, in parallel
+ * over the scanlines.
+ *
+ * With PartialVolumeSubsamples n > 1, the edges are anti-aliased: a voxel
+ * gets the fraction of its volume inside the shape. The fraction is exact
+ * along the scanline and sampled with n sub-scanlines per other dimension.
+ * The value is OutsideValue + fraction * ( InsideValue - OutsideValue ),
+ * rounded for integer pixel types.
+ *
+ * \ingroup DataSources
+ */
+
+template< class TOutputImage >
+class ITK_EXPORT ConvexShapeImageSource :
+  public ImageSource< TOutputImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef ConvexShapeImageSource          Self;
+  typedef ImageSource< TOutputImage >     Superclass;
+  typedef SmartPointer<Self>              Pointer;
+  typedef SmartPointer<const Self>        ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( ConvexShapeImageSource, ImageSource );
+
+  itkStaticConstMacro( ImageDimension, unsigned int, TOutputImage::ImageDimension );
+
+  /** Typedefs. */
+  typedef TOutputImage                                OutputImageType;
+  typedef typename OutputImageType::PixelType         OutputPixelType;
+  typedef typename OutputImageType::RegionType        OutputImageRegionType;
+  typedef typename OutputImageType::SizeType          SizeType;
+  typedef typename OutputImageType::IndexType         IndexType;
+  typedef typename OutputImageType::PointType         PointType;
+  typedef typename OutputImageType::SpacingType       SpacingType;
+  typedef typename OutputImageType::DirectionType     DirectionType;
+  typedef Vector< double,
+    itkGetStaticConstMacro( ImageDimension ) >        VectorType;
+  typedef Matrix< double,
+    itkGetStaticConstMacro( ImageDimension ),
+    itkGetStaticConstMacro( ImageDimension ) >        MatrixType;
+
+  /** Set/Get the geometry of the output. */
+  itkSetMacro( Size, SizeType );
+  itkGetConstReferenceMacro( Size, SizeType );
+  itkSetMacro( Spacing, SpacingType );
+  itkGetConstReferenceMacro( Spacing, SpacingType );
+  itkSetMacro( Origin, PointType );
+  itkGetConstReferenceMacro( Origin, PointType );
+  itkSetMacro( Direction, DirectionType );
+  itkGetConstReferenceMacro( Direction, DirectionType );
+
+  /** Set/Get the center of the shape. */
+  itkSetMacro( Center, PointType );
+  itkGetConstReferenceMacro( Center, PointType );
+
+  /** Set the matrix A of the quadric, which switches the quadric on. */
+  void SetQuadric( const MatrixType & A );
+  itkGetConstReferenceMacro( Quadric, MatrixType );
+  itkGetConstMacro( UseQuadric, bool );
+
+  /** Add the slab |normal.(p-c)| < halfWidth, remove them all. */
+  void AddSlab( const VectorType & normal, double halfWidth );
+  void ClearSlabs( void );
+
+  /** Set/Get the values inside and outside the shape. Default 1 and 0. */
+  itkSetMacro( InsideValue, OutputPixelType );
+  itkGetConstMacro( InsideValue, OutputPixelType );
+  itkSetMacro( OutsideValue, OutputPixelType );
+  itkGetConstMacro( OutsideValue, OutputPixelType );
+
+  /** Set/Get the number of sub-scanlines per dimension for anti-aliased
+   * edges. Values 0 and 1 give a binary image, the default. */
+  itkSetMacro( PartialVolumeSubsamples, unsigned int );
+  itkGetConstMacro( PartialVolumeSubsamples, unsigned int );
+
+protected:
+  ConvexShapeImageSource();
+  virtual ~ConvexShapeImageSource() {};
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** Set the geometry of the output. */
+  virtual void GenerateOutputInformation( void );
+
+  /** Convert the shape to index space, once. */
+  virtual void BeforeThreadedGenerateData( void );
+
+  /** Fill the scanlines of the region of a thread. */
+  void ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+    ThreadIdType threadId );
+
+  /** The continuous span [tlo, thi] of the scanline p0 + t d inside the
+   * shape, with p0 relative to the center. Returns false if it is empty. */
+  bool ComputeSpan( const VectorType & p0, double & tlo, double & thi ) const;
+
+  /** Whether the point p, relative to the center, is inside. */
+  bool IsInside( const VectorType & p ) const;
+
+  /** Fill a scanline of lineLength voxels at lineStart. */
+  void FillLine( OutputPixelType * line, const IndexType & lineStart,
+    SizeValueType lineLength, std::vector<double> & coverage ) const;
+
+  /** The point of a continuous index, relative to the center. */
+  VectorType GetRelativePoint( const VectorType & index ) const;
+
+private:
+  ConvexShapeImageSource( const Self & ); // purposely not implemented
+  void operator=( const Self & );         // purposely not implemented
+
+  SizeType              m_Size;
+  SpacingType           m_Spacing;
+  PointType             m_Origin;
+  DirectionType         m_Direction;
+
+  PointType             m_Center;
+  MatrixType            m_Quadric;
+  bool                  m_UseQuadric;
+  std::vector<VectorType> m_SlabNormals;
+  std::vector<double>     m_SlabHalfWidths;
+
+  OutputPixelType       m_InsideValue;
+  OutputPixelType       m_OutsideValue;
+  unsigned int          m_PartialVolumeSubsamples;
+
+  /** The index to point matrix, direction times spacing, and A times the
+   * scanline direction, for the span computation. */
+  MatrixType            m_IndexToPhysical;
+  VectorType            m_ScanlineDirection;
+  VectorType            m_QuadricTimesDirection;
+  double                m_QuadricDirectionSquared;
+  std::vector<double>   m_SlabDirectionDots;
+
+}; // end class ConvexShapeImageSource
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkConvexShapeImageSource.txx"
+#endif
+
+#endif // end #ifndef __itkConvexShapeImageSource_h
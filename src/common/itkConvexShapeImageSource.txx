@@ -0,0 +1,428 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkConvexShapeImageSource_txx
+#define __itkConvexShapeImageSource_txx
+
+#include "itkConvexShapeImageSource.h"
+#include "itkProgressReporter.h"
+#include "itkNumericTraits.h"
+#include "vnl/vnl_math.h"
+#include <algorithm>
+
+
+namespace itk
+{
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template< class TOutputImage >
+ConvexShapeImageSource< TOutputImage >
+::ConvexShapeImageSource()
+{
+  this->m_Size.Fill( 0 );
+  this->m_Spacing.Fill( 1.0 );
+  this->m_Origin.Fill( 0.0 );
+  this->m_Direction.SetIdentity();
+  this->m_Center.Fill( 0.0 );
+  this->m_Quadric.SetIdentity();
+  this->m_UseQuadric = false;
+  this->m_InsideValue = NumericTraits<OutputPixelType>::One;
+  this->m_OutsideValue = NumericTraits<OutputPixelType>::Zero;
+  this->m_PartialVolumeSubsamples = 0;
+  this->m_QuadricDirectionSquared = 0.0;
+
+} // end Constructor
+
+
+/**
+ * ******************* SetQuadric *******************
+ */
+
+template< class TOutputImage >
+void
+ConvexShapeImageSource< TOutputImage >
+::SetQuadric( const MatrixType & A )
+{
+  this->m_Quadric = A;
+  this->m_UseQuadric = true;
+  this->Modified();
+
+} // end SetQuadric()
+
+
+/**
+ * ******************* AddSlab *******************
+ */
+
+template< class TOutputImage >
+void
+ConvexShapeImageSource< TOutputImage >
+::AddSlab( const VectorType & normal, double halfWidth )
+{
+  this->m_SlabNormals.push_back( normal );
+  this->m_SlabHalfWidths.push_back( halfWidth );
+  this->Modified();
+
+} // end AddSlab()
+
+
+/**
+ * ******************* ClearSlabs *******************
+ */
+
+template< class TOutputImage >
+void
+ConvexShapeImageSource< TOutputImage >
+::ClearSlabs( void )
+{
+  this->m_SlabNormals.clear();
+  this->m_SlabHalfWidths.clear();
+  this->Modified();
+
+} // end ClearSlabs()
+
+
+/**
+ * ******************* GenerateOutputInformation *******************
+ */
+
+template< class TOutputImage >
+void
+ConvexShapeImageSource< TOutputImage >
+::GenerateOutputInformation( void )
+{
+  OutputImageType * output = this->GetOutput( 0 );
+
+  OutputImageRegionType region;
+  region.SetSize( this->m_Size );
+  output->SetLargestPossibleRegion( region );
+  output->SetSpacing( this->m_Spacing );
+  output->SetOrigin( this->m_Origin );
+  output->SetDirection( this->m_Direction );
+
+} // end GenerateOutputInformation()
+
+
+/**
+ * ******************* BeforeThreadedGenerateData *******************
+ */
+
+template< class TOutputImage >
+void
+ConvexShapeImageSource< TOutputImage >
+::BeforeThreadedGenerateData( void )
+{
+  /** The matrix from index to physical space, and the step of a scanline. */
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    for( unsigned int j = 0; j < ImageDimension; ++j )
+    {
+      this->m_IndexToPhysical[ i ][ j ] = this->m_Direction[ i ][ j ] * this->m_Spacing[ j ];
+    }
+    this->m_ScanlineDirection[ i ] = this->m_IndexToPhysical[ i ][ 0 ];
+  }
+
+  /** The parts of the inequalities that are the same for all scanlines. */
+  if( this->m_UseQuadric )
+  {
+    this->m_QuadricTimesDirection = this->m_Quadric * this->m_ScanlineDirection;
+    this->m_QuadricDirectionSquared
+      = this->m_ScanlineDirection * this->m_QuadricTimesDirection;
+  }
+  this->m_SlabDirectionDots.resize( this->m_SlabNormals.size() );
+  for( std::size_t k = 0; k < this->m_SlabNormals.size(); ++k )
+  {
+    this->m_SlabDirectionDots[ k ] = this->m_SlabNormals[ k ] * this->m_ScanlineDirection;
+  }
+
+} // end BeforeThreadedGenerateData()
+
+
+/**
+ * ******************* ThreadedGenerateData *******************
+ */
+
+template< class TOutputImage >
+void
+ConvexShapeImageSource< TOutputImage >
+::ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+  ThreadIdType threadId )
+{
+  OutputImageType * output = this->GetOutput();
+
+  const IndexType regionIndex = outputRegionForThread.GetIndex();
+  const SizeType  regionSize = outputRegionForThread.GetSize();
+  const SizeValueType lineLength = regionSize[ 0 ];
+  if( lineLength == 0 ) return;
+  const SizeValueType numberOfLines
+    = outputRegionForThread.GetNumberOfPixels() / lineLength;
+
+  ProgressReporter progress( this, threadId, numberOfLines );
+  std::vector<double> coverage( lineLength );
+
+  /** Walk over the scanlines of the region. */
+  IndexType lineStart = regionIndex;
+  for( SizeValueType l = 0; l < numberOfLines; ++l )
+  {
+    OutputPixelType * line
+      = output->GetBufferPointer() + output->ComputeOffset( lineStart );
+    this->FillLine( line, lineStart, lineLength, coverage );
+    progress.CompletedPixel();
+
+    /** Go to the next scanline. */
+    for( unsigned int i = 1; i < ImageDimension; ++i )
+    {
+      ++lineStart[ i ];
+      if( lineStart[ i ] < static_cast<IndexValueType>( regionIndex[ i ] + regionSize[ i ] ) )
+      {
+        break;
+      }
+      lineStart[ i ] = regionIndex[ i ];
+    }
+  }
+
+} // end ThreadedGenerateData()
+
+
+/**
+ * ******************* FillLine *******************
+ */
+
+template< class TOutputImage >
+void
+ConvexShapeImageSource< TOutputImage >
+::FillLine( OutputPixelType * line, const IndexType & lineStart,
+  SizeValueType lineLength, std::vector<double> & coverage ) const
+{
+  const double begin = static_cast<double>( lineStart[ 0 ] );
+  const double end = begin + static_cast<double>( lineLength );
+  const VectorType & d = this->m_ScanlineDirection;
+
+  /** The continuous index of the start of the scanline, at index 0. */
+  VectorType index;
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    index[ i ] = static_cast<double>( lineStart[ i ] );
+  }
+  index[ 0 ] = 0.0;
+
+  double tlo, thi;
+  const unsigned int n = this->m_PartialVolumeSubsamples;
+  if( n <= 1 )
+  {
+    std::fill( line, line + lineLength, this->m_OutsideValue );
+
+    const VectorType p0 = this->GetRelativePoint( index );
+    if( !this->ComputeSpan( p0, tlo, thi ) ) return;
+
+    /** Round the span to voxels, and check its ends with the inequalities. */
+    long first = static_cast<long>( vcl_ceil( vnl_math_max( tlo, begin - 1.0 ) ) );
+    long last = static_cast<long>( vcl_floor( vnl_math_min( thi, end ) ) );
+    const long lbegin = lineStart[ 0 ];
+    const long lend = lbegin + static_cast<long>( lineLength );
+    first = std::max( first, lbegin );
+    last = std::min( last, lend - 1 );
+    while( first <= last && !this->IsInside( p0 + d * static_cast<double>( first ) ) ) ++first;
+    while( first > lbegin && this->IsInside( p0 + d * static_cast<double>( first - 1 ) ) ) --first;
+    while( last >= first && !this->IsInside( p0 + d * static_cast<double>( last ) ) ) --last;
+    while( last + 1 < lend && last + 1 >= first
+      && this->IsInside( p0 + d * static_cast<double>( last + 1 ) ) ) ++last;
+
+    if( first <= last )
+    {
+      std::fill( line + ( first - lbegin ), line + ( last - lbegin + 1 ), this->m_InsideValue );
+    }
+    return;
+  }
+
+  /** Anti-aliased: accumulate the coverage of the sub-scanlines, which is
+   * exact along the scanline. */
+  std::fill( coverage.begin(), coverage.end(), 0.0 );
+  unsigned long numberOfSubLines = 1;
+  for( unsigned int i = 1; i < ImageDimension; ++i ) numberOfSubLines *= n;
+  for( unsigned long k = 0; k < numberOfSubLines; ++k )
+  {
+    VectorType subIndex = index;
+    unsigned long kk = k;
+    for( unsigned int i = 1; i < ImageDimension; ++i )
+    {
+      subIndex[ i ] += ( static_cast<double>( kk % n ) + 0.5 ) / n - 0.5;
+      kk /= n;
+    }
+
+    if( !this->ComputeSpan( this->GetRelativePoint( subIndex ), tlo, thi ) ) continue;
+    tlo = vnl_math_max( tlo, begin - 0.5 );
+    thi = vnl_math_min( thi, end - 0.5 );
+    const long first = static_cast<long>( vcl_floor( tlo + 0.5 ) );
+    const long last = static_cast<long>( vcl_floor( thi + 0.5 ) );
+    for( long i = first; i <= last && i < lineStart[ 0 ] + static_cast<long>( lineLength ); ++i )
+    {
+      const double c = vnl_math_min( thi, i + 0.5 ) - vnl_math_max( tlo, i - 0.5 );
+      if( c > 0.0 ) coverage[ i - lineStart[ 0 ] ] += c;
+    }
+  }
+
+  /** Convert the coverage to pixel values. */
+  const double inside = static_cast<double>( this->m_InsideValue );
+  const double outside = static_cast<double>( this->m_OutsideValue );
+  const double weight = ( inside - outside ) / static_cast<double>( numberOfSubLines );
+  for( SizeValueType i = 0; i < lineLength; ++i )
+  {
+    const double value = outside + weight * coverage[ i ];
+    if( NumericTraits<OutputPixelType>::is_integer )
+    {
+      line[ i ] = static_cast<OutputPixelType>( vnl_math_rnd( value ) );
+    }
+    else
+    {
+      line[ i ] = static_cast<OutputPixelType>( value );
+    }
+  }
+
+} // end FillLine()
+
+
+/**
+ * ******************* ComputeSpan *******************
+ */
+
+template< class TOutputImage >
+bool
+ConvexShapeImageSource< TOutputImage >
+::ComputeSpan( const VectorType & p0, double & tlo, double & thi ) const
+{
+  tlo = -NumericTraits<double>::max();
+  thi = NumericTraits<double>::max();
+
+  /** The quadric: a t^2 + 2 b t + e <= 0. Since A is semi-definite, b is
+   * zero if a is, and the scanline is either inside or outside. */
+  if( this->m_UseQuadric )
+  {
+    const double a = this->m_QuadricDirectionSquared;
+    const double b = this->m_QuadricTimesDirection * p0;
+    const double e = p0 * ( this->m_Quadric * p0 ) - 1.0;
+    if( a > 0.0 )
+    {
+      const double discriminant = b * b - a * e;
+      if( discriminant < 0.0 ) return false;
+      const double root = vcl_sqrt( discriminant );
+      tlo = ( -b - root ) / a;
+      thi = ( -b + root ) / a;
+    }
+    else if( e > 0.0 )
+    {
+      return false;
+    }
+  }
+
+  /** The slabs: |s0 + t nd| < r. */
+  for( std::size_t k = 0; k < this->m_SlabNormals.size(); ++k )
+  {
+    const double s0 = this->m_SlabNormals[ k ] * p0;
+    const double nd = this->m_SlabDirectionDots[ k ];
+    const double r = this->m_SlabHalfWidths[ k ];
+    if( nd == 0.0 )
+    {
+      if( vcl_abs( s0 ) >= r ) return false;
+      continue;
+    }
+    double t1 = ( -r - s0 ) / nd;
+    double t2 = ( r - s0 ) / nd;
+    if( t1 > t2 ) std::swap( t1, t2 );
+    tlo = vnl_math_max( tlo, t1 );
+    thi = vnl_math_min( thi, t2 );
+  }
+
+  return tlo <= thi;
+
+} // end ComputeSpan()
+
+
+/**
+ * ******************* IsInside *******************
+ */
+
+template< class TOutputImage >
+bool
+ConvexShapeImageSource< TOutputImage >
+::IsInside( const VectorType & p ) const
+{
+  if( this->m_UseQuadric && p * ( this->m_Quadric * p ) > 1.0 )
+  {
+    return false;
+  }
+  for( std::size_t k = 0; k < this->m_SlabNormals.size(); ++k )
+  {
+    if( vcl_abs( this->m_SlabNormals[ k ] * p ) >= this->m_SlabHalfWidths[ k ] )
+    {
+      return false;
+    }
+  }
+  return true;
+
+} // end IsInside()
+
+
+/**
+ * ******************* GetRelativePoint *******************
+ */
+
+template< class TOutputImage >
+typename ConvexShapeImageSource< TOutputImage >::VectorType
+ConvexShapeImageSource< TOutputImage >
+::GetRelativePoint( const VectorType & index ) const
+{
+  VectorType p = this->m_IndexToPhysical * index;
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    p[ i ] += this->m_Origin[ i ] - this->m_Center[ i ];
+  }
+  return p;
+
+} // end GetRelativePoint()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template< class TOutputImage >
+void
+ConvexShapeImageSource< TOutputImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "Size: " << this->m_Size << std::endl;
+  os << indent << "Spacing: " << this->m_Spacing << std::endl;
+  os << indent << "Origin: " << this->m_Origin << std::endl;
+  os << indent << "Direction: " << this->m_Direction << std::endl;
+  os << indent << "Center: " << this->m_Center << std::endl;
+  os << indent << "UseQuadric: " << this->m_UseQuadric << std::endl;
+  os << indent << "Quadric: " << this->m_Quadric << std::endl;
+  os << indent << "NumberOfSlabs: " << this->m_SlabNormals.size() << std::endl;
+  os << indent << "PartialVolumeSubsamples: "
+    << this->m_PartialVolumeSubsamples << std::endl;
+
+} // end PrintSelf()
+
+} // end namespace itk
+
+#endif // end #ifndef __itkConvexShapeImageSource_txx
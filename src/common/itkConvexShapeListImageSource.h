@@ -0,0 +1,187 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkConvexShapeListImageSource_h
+#define __itkConvexShapeListImageSource_h
+
+#include "itkImageSource.h"
+#include "itkMatrix.h"
+#include "itkVector.h"
+#include <vector>
+
+
+namespace itk
+{
+
+/** \class ConvexShapeListImageSource
+ * \brief Rasterize a list of convex shapes into one image, in one pass.
+ *
+ * Every shape is defined as in ConvexShapeImageSource: the intersection
+ * of an optional quadric and any number of slabs around a center, in
+ * physical coordinates, and gets its own Value. The shapes are painted in
+ * the order of the list, so that a later shape overwrites an earlier one
+ * where they overlap; the other voxels get the BackgroundValue.
+ *
+ * Before the pass every shape gets a bounding box in index space, from
+ * the quadric if it is definite and from the first ImageDimension slabs
+ * if their normals are independent, and is binned to the slices of the
+ * last dimension that its box covers. A scanline only visits the shapes
+ * of its slice whose box contains it, and fills their spans, which are
+ * computed in closed form as in ConvexShapeImageSource. Shapes outside
+ * the image are dropped. The scanlines are filled in parallel.
+ *
+ * \ingroup DataSources
+ */
+
+template< class TOutputImage >
+class ITK_EXPORT ConvexShapeListImageSource :
+  public ImageSource< TOutputImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef ConvexShapeListImageSource      Self;
+  typedef ImageSource< TOutputImage >     Superclass;
+  typedef SmartPointer<Self>              Pointer;
+  typedef SmartPointer<const Self>        ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( ConvexShapeListImageSource, ImageSource );
+
+  itkStaticConstMacro( ImageDimension, unsigned int, TOutputImage::ImageDimension );
+
+  /** Typedefs. */
+  typedef TOutputImage                                OutputImageType;
+  typedef typename OutputImageType::PixelType         OutputPixelType;
+  typedef typename OutputImageType::RegionType        OutputImageRegionType;
+  typedef typename OutputImageType::SizeType          SizeType;
+  typedef typename OutputImageType::IndexType         IndexType;
+  typedef typename OutputImageType::PointType         PointType;
+  typedef typename OutputImageType::SpacingType       SpacingType;
+  typedef typename OutputImageType::DirectionType     DirectionType;
+  typedef Vector< double,
+    itkGetStaticConstMacro( ImageDimension ) >        VectorType;
+  typedef Matrix< double,
+    itkGetStaticConstMacro( ImageDimension ),
+    itkGetStaticConstMacro( ImageDimension ) >        MatrixType;
+
+  /** A shape: the points p with (p-c)^T A (p-c) <= 1 if UseQuadric, and
+   * |n_k.(p-c)| < r_k for all slabs k.
+   */
+  struct ShapeType
+  {
+    PointType                 Center;
+    bool                      UseQuadric;
+    MatrixType                Quadric;
+    std::vector<VectorType>   SlabNormals;
+    std::vector<double>       SlabHalfWidths;
+    OutputPixelType           Value;
+  };
+
+  /** Set/Get the geometry of the output. */
+  itkSetMacro( Size, SizeType );
+  itkGetConstReferenceMacro( Size, SizeType );
+  itkSetMacro( Spacing, SpacingType );
+  itkGetConstReferenceMacro( Spacing, SpacingType );
+  itkSetMacro( Origin, PointType );
+  itkGetConstReferenceMacro( Origin, PointType );
+  itkSetMacro( Direction, DirectionType );
+  itkGetConstReferenceMacro( Direction, DirectionType );
+
+  /** Add a shape to the end of the list, remove them all. */
+  void AddShape( const ShapeType & shape );
+  void ClearShapes( void );
+  std::size_t GetNumberOfShapes( void ) const
+  {
+    return this->m_Shapes.size();
+  }
+
+  /** Set/Get the value outside all shapes. Default 0. */
+  itkSetMacro( BackgroundValue, OutputPixelType );
+  itkGetConstMacro( BackgroundValue, OutputPixelType );
+
+protected:
+  ConvexShapeListImageSource();
+  virtual ~ConvexShapeListImageSource() {};
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** Set the geometry of the output. */
+  virtual void GenerateOutputInformation( void );
+
+  /** Convert the shapes to index space and bin them, once. */
+  virtual void BeforeThreadedGenerateData( void );
+
+  /** Fill the scanlines of the region of a thread. */
+  void ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+    ThreadIdType threadId );
+
+  /** A shape with the parts of its inequalities that are the same for all
+   * scanlines, and its bounding box in index space.
+   */
+  struct PreparedShapeType
+  {
+    const ShapeType *     Shape;
+    VectorType            CenterToOrigin;
+    VectorType            QuadricTimesDirection;
+    double                QuadricDirectionSquared;
+    std::vector<double>   SlabDirectionDots;
+    IndexType             First;
+    IndexType             Last;
+  };
+
+  /** Prepare a shape. Returns false if it is outside the image. */
+  bool PrepareShape( const ShapeType & shape, PreparedShapeType & prepared ) const;
+
+  /** The continuous span [tlo, thi] of the scanline p0 + t d inside a
+   * shape, with p0 relative to its center. Returns false if it is empty. */
+  bool ComputeSpan( const PreparedShapeType & shape, const VectorType & p0,
+    double & tlo, double & thi ) const;
+
+  /** Whether the point p, relative to the center, is inside a shape. */
+  bool IsInside( const ShapeType & shape, const VectorType & p ) const;
+
+private:
+  ConvexShapeListImageSource( const Self & ); // purposely not implemented
+  void operator=( const Self & );             // purposely not implemented
+
+  SizeType              m_Size;
+  SpacingType           m_Spacing;
+  PointType             m_Origin;
+  DirectionType         m_Direction;
+
+  std::vector<ShapeType> m_Shapes;
+  OutputPixelType       m_BackgroundValue;
+
+  /** The index to point matrix, direction times spacing, the step of a
+   * scanline, the prepared shapes, and per slice of the last dimension the
+   * prepared shapes that cover it, in the order of the list. */
+  MatrixType                              m_IndexToPhysical;
+  VectorType                              m_ScanlineDirection;
+  std::vector<PreparedShapeType>          m_PreparedShapes;
+  std::vector< std::vector<std::size_t> > m_SliceBins;
+
+}; // end class ConvexShapeListImageSource
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkConvexShapeListImageSource.txx"
+#endif
+
+#endif // end #ifndef __itkConvexShapeListImageSource_h
@@ -0,0 +1,455 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkConvexShapeListImageSource_txx
+#define __itkConvexShapeListImageSource_txx
+
+#include "itkConvexShapeListImageSource.h"
+#include "itkContinuousIndex.h"
+#include "itkProgressReporter.h"
+#include "itkNumericTraits.h"
+#include "vnl/vnl_math.h"
+#include "vnl/algo/vnl_svd.h"
+#include <algorithm>
+
+
+namespace itk
+{
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template< class TOutputImage >
+ConvexShapeListImageSource< TOutputImage >
+::ConvexShapeListImageSource()
+{
+  this->m_Size.Fill( 0 );
+  this->m_Spacing.Fill( 1.0 );
+  this->m_Origin.Fill( 0.0 );
+  this->m_Direction.SetIdentity();
+  this->m_BackgroundValue = NumericTraits<OutputPixelType>::Zero;
+
+} // end Constructor
+
+
+/**
+ * ******************* AddShape *******************
+ */
+
+template< class TOutputImage >
+void
+ConvexShapeListImageSource< TOutputImage >
+::AddShape( const ShapeType & shape )
+{
+  this->m_Shapes.push_back( shape );
+  this->Modified();
+
+} // end AddShape()
+
+
+/**
+ * ******************* ClearShapes *******************
+ */
+
+template< class TOutputImage >
+void
+ConvexShapeListImageSource< TOutputImage >
+::ClearShapes( void )
+{
+  this->m_Shapes.clear();
+  this->Modified();
+
+} // end ClearShapes()
+
+
+/**
+ * ******************* GenerateOutputInformation *******************
+ */
+
+template< class TOutputImage >
+void
+ConvexShapeListImageSource< TOutputImage >
+::GenerateOutputInformation( void )
+{
+  OutputImageType * output = this->GetOutput( 0 );
+
+  OutputImageRegionType region;
+  region.SetSize( this->m_Size );
+  output->SetLargestPossibleRegion( region );
+  output->SetSpacing( this->m_Spacing );
+  output->SetOrigin( this->m_Origin );
+  output->SetDirection( this->m_Direction );
+
+} // end GenerateOutputInformation()
+
+
+/**
+ * ******************* BeforeThreadedGenerateData *******************
+ */
+
+template< class TOutputImage >
+void
+ConvexShapeListImageSource< TOutputImage >
+::BeforeThreadedGenerateData( void )
+{
+  /** The matrix from index to physical space, and the step of a scanline. */
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    for( unsigned int j = 0; j < ImageDimension; ++j )
+    {
+      this->m_IndexToPhysical[ i ][ j ] = this->m_Direction[ i ][ j ] * this->m_Spacing[ j ];
+    }
+    this->m_ScanlineDirection[ i ] = this->m_IndexToPhysical[ i ][ 0 ];
+  }
+
+  /** Prepare the shapes, and bin them to the slices they cover. */
+  const unsigned int last = ImageDimension - 1;
+  this->m_PreparedShapes.clear();
+  this->m_SliceBins.assign( this->m_Size[ last ], std::vector<std::size_t>() );
+  for( std::size_t s = 0; s < this->m_Shapes.size(); ++s )
+  {
+    PreparedShapeType prepared;
+    if( !this->PrepareShape( this->m_Shapes[ s ], prepared ) ) continue;
+
+    const std::size_t p = this->m_PreparedShapes.size();
+    this->m_PreparedShapes.push_back( prepared );
+    for( IndexValueType z = prepared.First[ last ]; z <= prepared.Last[ last ]; ++z )
+    {
+      this->m_SliceBins[ z ].push_back( p );
+    }
+  }
+
+} // end BeforeThreadedGenerateData()
+
+
+/**
+ * ******************* PrepareShape *******************
+ */
+
+template< class TOutputImage >
+bool
+ConvexShapeListImageSource< TOutputImage >
+::PrepareShape( const ShapeType & shape, PreparedShapeType & prepared ) const
+{
+  prepared.Shape = &shape;
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    prepared.CenterToOrigin[ i ] = this->m_Origin[ i ] - shape.Center[ i ];
+  }
+
+  /** The parts of the inequalities that are the same for all scanlines. */
+  prepared.QuadricDirectionSquared = 0.0;
+  if( shape.UseQuadric )
+  {
+    prepared.QuadricTimesDirection = shape.Quadric * this->m_ScanlineDirection;
+    prepared.QuadricDirectionSquared
+      = this->m_ScanlineDirection * prepared.QuadricTimesDirection;
+  }
+  prepared.SlabDirectionDots.resize( shape.SlabNormals.size() );
+  for( std::size_t k = 0; k < shape.SlabNormals.size(); ++k )
+  {
+    prepared.SlabDirectionDots[ k ] = shape.SlabNormals[ k ] * this->m_ScanlineDirection;
+  }
+
+  /** The half extents of a physical box around the center. A definite
+   * quadric is inside |p_i| <= sqrt( (A^-1)_ii ), and D independent slabs
+   * are inside |p_i| <= sum_k r_k |(N^-1)_ik|, with N the normals as rows.
+   */
+  const double tolerance = 1e-12;
+  std::vector<double> halfExtent( ImageDimension, NumericTraits<double>::max() );
+  bool bounded = false;
+  if( shape.UseQuadric )
+  {
+    vnl_svd<double> svd( shape.Quadric.GetVnlMatrix() );
+    if( svd.W( ImageDimension - 1 ) > tolerance * svd.W( 0 ) )
+    {
+      const vnl_matrix<double> inverse = svd.inverse();
+      for( unsigned int i = 0; i < ImageDimension; ++i )
+      {
+        halfExtent[ i ] = vcl_sqrt( vnl_math_max( inverse( i, i ), 0.0 ) );
+      }
+      bounded = true;
+    }
+  }
+  if( shape.SlabNormals.size() >= ImageDimension )
+  {
+    vnl_matrix<double> normals( ImageDimension, ImageDimension );
+    for( unsigned int k = 0; k < ImageDimension; ++k )
+    {
+      for( unsigned int j = 0; j < ImageDimension; ++j )
+      {
+        normals( k, j ) = shape.SlabNormals[ k ][ j ];
+      }
+    }
+    vnl_svd<double> svd( normals );
+    if( svd.W( ImageDimension - 1 ) > tolerance * svd.W( 0 ) )
+    {
+      const vnl_matrix<double> inverse = svd.inverse();
+      for( unsigned int i = 0; i < ImageDimension; ++i )
+      {
+        double extent = 0.0;
+        for( unsigned int k = 0; k < ImageDimension; ++k )
+        {
+          extent += vcl_abs( shape.SlabHalfWidths[ k ] * inverse( i, k ) );
+        }
+        halfExtent[ i ] = vnl_math_min( halfExtent[ i ], extent );
+      }
+      bounded = true;
+    }
+  }
+
+  /** The box in index space, from the corners of the physical box, within
+   * the image. An unbounded shape covers the whole image.
+   */
+  const OutputImageType * output = this->GetOutput();
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    prepared.First[ i ] = 0;
+    prepared.Last[ i ] = static_cast<IndexValueType>( this->m_Size[ i ] ) - 1;
+  }
+  if( !bounded ) return true;
+
+  std::vector<double> lo( ImageDimension, NumericTraits<double>::max() );
+  std::vector<double> hi( ImageDimension, -NumericTraits<double>::max() );
+  for( unsigned int corner = 0; corner < ( 1u << ImageDimension ); ++corner )
+  {
+    PointType point;
+    for( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+      const double sign = ( corner >> i ) & 1u ? 1.0 : -1.0;
+      point[ i ] = shape.Center[ i ] + sign * halfExtent[ i ];
+    }
+    ContinuousIndex< double, ImageDimension > cindex;
+    output->TransformPhysicalPointToContinuousIndex( point, cindex );
+    for( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+      lo[ i ] = vnl_math_min( lo[ i ], cindex[ i ] );
+      hi[ i ] = vnl_math_max( hi[ i ], cindex[ i ] );
+    }
+  }
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    const double size = static_cast<double>( this->m_Size[ i ] );
+    if( hi[ i ] < 0.0 || lo[ i ] > size - 1.0 ) return false;
+    prepared.First[ i ] = static_cast<IndexValueType>( vcl_floor( vnl_math_max( lo[ i ], 0.0 ) ) );
+    prepared.Last[ i ] = static_cast<IndexValueType>( vcl_ceil( vnl_math_min( hi[ i ], size - 1.0 ) ) );
+  }
+  return true;
+
+} // end PrepareShape()
+
+
+/**
+ * ******************* ThreadedGenerateData *******************
+ */
+
+template< class TOutputImage >
+void
+ConvexShapeListImageSource< TOutputImage >
+::ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+  ThreadIdType threadId )
+{
+  OutputImageType * output = this->GetOutput();
+
+  const IndexType regionIndex = outputRegionForThread.GetIndex();
+  const SizeType  regionSize = outputRegionForThread.GetSize();
+  const SizeValueType lineLength = regionSize[ 0 ];
+  if( lineLength == 0 ) return;
+  const SizeValueType numberOfLines
+    = outputRegionForThread.GetNumberOfPixels() / lineLength;
+  const unsigned int last = ImageDimension - 1;
+  const VectorType & d = this->m_ScanlineDirection;
+
+  ProgressReporter progress( this, threadId, numberOfLines );
+
+  /** Walk over the scanlines of the region. */
+  IndexType lineStart = regionIndex;
+  for( SizeValueType l = 0; l < numberOfLines; ++l )
+  {
+    OutputPixelType * line
+      = output->GetBufferPointer() + output->ComputeOffset( lineStart );
+    std::fill( line, line + lineLength, this->m_BackgroundValue );
+
+    /** The continuous index of the start of the scanline, at index 0. */
+    VectorType index;
+    for( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+      index[ i ] = static_cast<double>( lineStart[ i ] );
+    }
+    index[ 0 ] = 0.0;
+    const VectorType start = this->m_IndexToPhysical * index;
+    const long lbegin = lineStart[ 0 ];
+    const long lend = lbegin + static_cast<long>( lineLength );
+
+    /** Paint the shapes of the slice whose box contains the scanline. */
+    const std::vector<std::size_t> & bin = this->m_SliceBins[ lineStart[ last ] ];
+    for( std::size_t b = 0; b < bin.size(); ++b )
+    {
+      const PreparedShapeType & shape = this->m_PreparedShapes[ bin[ b ] ];
+      bool inBox = shape.Last[ 0 ] >= lbegin && shape.First[ 0 ] < lend;
+      for( unsigned int i = 1; i < last && inBox; ++i )
+      {
+        inBox = lineStart[ i ] >= shape.First[ i ] && lineStart[ i ] <= shape.Last[ i ];
+      }
+      if( !inBox ) continue;
+
+      const VectorType p0 = start + shape.CenterToOrigin;
+      double tlo, thi;
+      if( !this->ComputeSpan( shape, p0, tlo, thi ) ) continue;
+
+      /** Round the span to voxels, and check its ends with the inequalities. */
+      const ShapeType & s = *shape.Shape;
+      long first = static_cast<long>( vcl_ceil( vnl_math_max( tlo, lbegin - 1.0 ) ) );
+      long lastVoxel = static_cast<long>( vcl_floor( vnl_math_min( thi, static_cast<double>( lend ) ) ) );
+      first = std::max( first, lbegin );
+      lastVoxel = std::min( lastVoxel, lend - 1 );
+      while( first <= lastVoxel && !this->IsInside( s, p0 + d * static_cast<double>( first ) ) ) ++first;
+      while( first > lbegin && this->IsInside( s, p0 + d * static_cast<double>( first - 1 ) ) ) --first;
+      while( lastVoxel >= first && !this->IsInside( s, p0 + d * static_cast<double>( lastVoxel ) ) ) --lastVoxel;
+      while( lastVoxel + 1 < lend && lastVoxel + 1 >= first
+        && this->IsInside( s, p0 + d * static_cast<double>( lastVoxel + 1 ) ) ) ++lastVoxel;
+
+      if( first <= lastVoxel )
+      {
+        std::fill( line + ( first - lbegin ), line + ( lastVoxel - lbegin + 1 ), s.Value );
+      }
+    }
+    progress.CompletedPixel();
+
+    /** Go to the next scanline. */
+    for( unsigned int i = 1; i < ImageDimension; ++i )
+    {
+      ++lineStart[ i ];
+      if( lineStart[ i ] < static_cast<IndexValueType>( regionIndex[ i ] + regionSize[ i ] ) )
+      {
+        break;
+      }
+      lineStart[ i ] = regionIndex[ i ];
+    }
+  }
+
+} // end ThreadedGenerateData()
+
+
+/**
+ * ******************* ComputeSpan *******************
+ */
+
+template< class TOutputImage >
+bool
+ConvexShapeListImageSource< TOutputImage >
+::ComputeSpan( const PreparedShapeType & shape, const VectorType & p0,
+  double & tlo, double & thi ) const
+{
+  const ShapeType & s = *shape.Shape;
+  tlo = -NumericTraits<double>::max();
+  thi = NumericTraits<double>::max();
+
+  /** The quadric: a t^2 + 2 b t + e <= 0. */
+  if( s.UseQuadric )
+  {
+    const double a = shape.QuadricDirectionSquared;
+    const double b = shape.QuadricTimesDirection * p0;
+    const double e = p0 * ( s.Quadric * p0 ) - 1.0;
+    if( a > 0.0 )
+    {
+      const double discriminant = b * b - a * e;
+      if( discriminant < 0.0 ) return false;
+      const double root = vcl_sqrt( discriminant );
+      tlo = ( -b - root ) / a;
+      thi = ( -b + root ) / a;
+    }
+    else if( e > 0.0 )
+    {
+      return false;
+    }
+  }
+
+  /** The slabs: |s0 + t nd| < r. */
+  for( std::size_t k = 0; k < s.SlabNormals.size(); ++k )
+  {
+    const double s0 = s.SlabNormals[ k ] * p0;
+    const double nd = shape.SlabDirectionDots[ k ];
+    const double r = s.SlabHalfWidths[ k ];
+    if( nd == 0.0 )
+    {
+      if( vcl_abs( s0 ) >= r ) return false;
+      continue;
+    }
+    double t1 = ( -r - s0 ) / nd;
+    double t2 = ( r - s0 ) / nd;
+    if( t1 > t2 ) std::swap( t1, t2 );
+    tlo = vnl_math_max( tlo, t1 );
+    thi = vnl_math_min( thi, t2 );
+  }
+
+  return tlo <= thi;
+
+} // end ComputeSpan()
+
+
+/**
+ * ******************* IsInside *******************
+ */
+
+template< class TOutputImage >
+bool
+ConvexShapeListImageSource< TOutputImage >
+::IsInside( const ShapeType & shape, const VectorType & p ) const
+{
+  if( shape.UseQuadric && p * ( shape.Quadric * p ) > 1.0 )
+  {
+    return false;
+  }
+  for( std::size_t k = 0; k < shape.SlabNormals.size(); ++k )
+  {
+    if( vcl_abs( shape.SlabNormals[ k ] * p ) >= shape.SlabHalfWidths[ k ] )
+    {
+      return false;
+    }
+  }
+  return true;
+
+} // end IsInside()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template< class TOutputImage >
+void
+ConvexShapeListImageSource< TOutputImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "Size: " << this->m_Size << std::endl;
+  os << indent << "Spacing: " << this->m_Spacing << std::endl;
+  os << indent << "Origin: " << this->m_Origin << std::endl;
+  os << indent << "Direction: " << this->m_Direction << std::endl;
+  os << indent << "NumberOfShapes: " << this->m_Shapes.size() << std::endl;
+  os << indent << "BackgroundValue: "
+    << static_cast<typename NumericTraits<OutputPixelType>::PrintType>(
+    this->m_BackgroundValue ) << std::endl;
+
+} // end PrintSelf()
+
+} // end namespace itk
+
+#endif // end #ifndef __itkConvexShapeListImageSource_txx
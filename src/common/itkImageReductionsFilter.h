@@ -0,0 +1,172 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkImageReductionsFilter_h
+#define __itkImageReductionsFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkNumericTraits.h"
+#include "itkParallelReducer.h"
+
+
+namespace itk
+{
+
+/** \class ImageReductionsFilter
+ * \brief Compute several scalar reductions of an image in one pass.
+ *
+ * Any subset of the following reductions can be switched on:
+ *   - the sum and the mean of the pixels,
+ *   - the number of non-zero pixels,
+ *   - the bounding box of the pixels larger than zero,
+ *   - the minimum and the maximum.
+ * The image is reduced by a ParallelReducer, in blocks of which the partial
+ * results are merged in a fixed order, so that the sum does not depend on the
+ * number of threads. The image is read only once, no matter how many
+ * reductions are requested.
+ *
+ * If no pixel is larger than zero, the minimum index of the bounding box is
+ * the last index of the image and the maximum index the first.
+ *
+ * The filter passes its input through unmodified.
+ */
+
+template< class TInputImage >
+class ITK_EXPORT ImageReductionsFilter :
+  public ImageToImageFilter< TInputImage, TInputImage >
+{
+public:
+  /** Standard Self typedef */
+  typedef ImageReductionsFilter             Self;
+  typedef ImageToImageFilter<
+    TInputImage, TInputImage >              Superclass;
+  typedef SmartPointer<Self>                Pointer;
+  typedef SmartPointer<const Self>          ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Runtime information support. */
+  itkTypeMacro( ImageReductionsFilter, ImageToImageFilter );
+
+  /** Image related typedefs. */
+  typedef TInputImage                               InputImageType;
+  typedef typename InputImageType::Pointer          InputImagePointer;
+  typedef typename InputImageType::RegionType       RegionType;
+  typedef typename InputImageType::IndexType        IndexType;
+  typedef typename InputImageType::PixelType        PixelType;
+
+  itkStaticConstMacro( ImageDimension, unsigned int,
+    InputImageType::ImageDimension );
+
+  /** Type to use for computations. */
+  typedef typename NumericTraits<PixelType>::RealType RealType;
+
+  /** Select the reductions. All are off by default. */
+  itkSetMacro( ComputeSum, bool );
+  itkGetConstMacro( ComputeSum, bool );
+  itkBooleanMacro( ComputeSum );
+  itkSetMacro( ComputeNonZeroCount, bool );
+  itkGetConstMacro( ComputeNonZeroCount, bool );
+  itkBooleanMacro( ComputeNonZeroCount );
+  itkSetMacro( ComputeBoundingBox, bool );
+  itkGetConstMacro( ComputeBoundingBox, bool );
+  itkBooleanMacro( ComputeBoundingBox );
+  itkSetMacro( ComputeMinimumMaximum, bool );
+  itkGetConstMacro( ComputeMinimumMaximum, bool );
+  itkBooleanMacro( ComputeMinimumMaximum );
+
+  /** Get the results. */
+  itkGetConstMacro( Sum, RealType );
+  itkGetConstMacro( Mean, RealType );
+  itkGetConstMacro( NonZeroCount, SizeValueType );
+  itkGetConstReferenceMacro( BoundingBoxMinimumIndex, IndexType );
+  itkGetConstReferenceMacro( BoundingBoxMaximumIndex, IndexType );
+  itkGetConstMacro( Minimum, PixelType );
+  itkGetConstMacro( Maximum, PixelType );
+
+protected:
+  ImageReductionsFilter();
+  ~ImageReductionsFilter(){};
+  void PrintSelf( std::ostream& os, Indent indent ) const;
+
+  /** Pass the input through unmodified. */
+  void AllocateOutputs( void );
+
+  /** Reduce the image with a ParallelReducer. */
+  void GenerateData( void );
+
+  /** The filter needs all of its input, and produces all of its output. */
+  void GenerateInputRequestedRegion( void );
+  void EnlargeOutputRequestedRegion( DataObject *data );
+
+private:
+  ImageReductionsFilter( const Self& ); // purposely not implemented
+  void operator=( const Self& ); // purposely not implemented
+
+  /** The partial results of a block. */
+  struct PartialType
+  {
+    RealType      Sum;
+    SizeValueType NonZeroCount;
+    IndexType     MinimumIndex;
+    IndexType     MaximumIndex;
+    PixelType     Minimum;
+    PixelType     Maximum;
+  };
+
+  /** The reducer of the ParallelReducer. */
+  class ReducerType
+  {
+  public:
+    typedef typename Self::RegionType   RegionType;
+    typedef typename Self::PartialType  PartialType;
+    const Self * m_Filter;
+    void Initialize( PartialType & partial ) const;
+    void Reduce( const RegionType & block, PartialType & partial ) const
+    {
+      this->m_Filter->ReduceBlock( block, partial );
+    }
+    void Merge( PartialType & partial, const PartialType & other ) const;
+  };
+
+  /** Add the pixels of a block to a partial result. */
+  void ReduceBlock( const RegionType & block, PartialType & partial ) const;
+
+  bool  m_ComputeSum;
+  bool  m_ComputeNonZeroCount;
+  bool  m_ComputeBoundingBox;
+  bool  m_ComputeMinimumMaximum;
+
+  RealType      m_Sum;
+  RealType      m_Mean;
+  SizeValueType m_NonZeroCount;
+  IndexType     m_BoundingBoxMinimumIndex;
+  IndexType     m_BoundingBoxMaximumIndex;
+  PixelType     m_Minimum;
+  PixelType     m_Maximum;
+
+}; // end class ImageReductionsFilter
+
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkImageReductionsFilter.txx"
+#endif
+
+#endif // end #ifndef __itkImageReductionsFilter_h
@@ -0,0 +1,316 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkImageReductionsFilter_txx
+#define __itkImageReductionsFilter_txx
+
+#include "itkImageReductionsFilter.h"
+
+#include "itkImageLinearConstIteratorWithIndex.h"
+
+
+namespace itk
+{
+
+/**
+ * ********************* Constructor ****************************
+ */
+
+template< class TInputImage >
+ImageReductionsFilter< TInputImage >
+::ImageReductionsFilter()
+{
+  this->m_ComputeSum = false;
+  this->m_ComputeNonZeroCount = false;
+  this->m_ComputeBoundingBox = false;
+  this->m_ComputeMinimumMaximum = false;
+
+  this->m_Sum = NumericTraits<RealType>::Zero;
+  this->m_Mean = NumericTraits<RealType>::Zero;
+  this->m_NonZeroCount = 0;
+  this->m_BoundingBoxMinimumIndex.Fill( 0 );
+  this->m_BoundingBoxMaximumIndex.Fill( 0 );
+  this->m_Minimum = NumericTraits<PixelType>::max();
+  this->m_Maximum = NumericTraits<PixelType>::NonpositiveMin();
+
+} // end Constructor
+
+
+/**
+ * ********************* GenerateInputRequestedRegion ****************************
+ */
+
+template< class TInputImage >
+void
+ImageReductionsFilter< TInputImage >
+::GenerateInputRequestedRegion( void )
+{
+  Superclass::GenerateInputRequestedRegion();
+  if( this->GetInput() )
+  {
+    InputImagePointer image =
+      const_cast< InputImageType * >( this->GetInput() );
+    image->SetRequestedRegionToLargestPossibleRegion();
+  }
+
+} // end GenerateInputRequestedRegion()
+
+
+/**
+ * ********************* EnlargeOutputRequestedRegion ****************************
+ */
+
+template< class TInputImage >
+void
+ImageReductionsFilter< TInputImage >
+::EnlargeOutputRequestedRegion( DataObject * data )
+{
+  Superclass::EnlargeOutputRequestedRegion( data );
+  data->SetRequestedRegionToLargestPossibleRegion();
+
+} // end EnlargeOutputRequestedRegion()
+
+
+/**
+ * ********************* AllocateOutputs ****************************
+ */
+
+template< class TInputImage >
+void
+ImageReductionsFilter< TInputImage >
+::AllocateOutputs( void )
+{
+  /** Pass the input through as the output. */
+  InputImagePointer image = const_cast< InputImageType * >( this->GetInput() );
+  this->GraftOutput( image );
+
+} // end AllocateOutputs()
+
+
+/**
+ * ********************* GenerateData ****************************
+ */
+
+template< class TInputImage >
+void
+ImageReductionsFilter< TInputImage >
+::GenerateData( void )
+{
+  this->AllocateOutputs();
+
+  ReducerType reducer;
+  reducer.m_Filter = this;
+
+  typedef ParallelReducer< ReducerType > ParallelReducerType;
+  typename ParallelReducerType::Pointer parallelReducer = ParallelReducerType::New();
+  parallelReducer->SetReducer( &reducer );
+  parallelReducer->SetRegion( this->GetOutput()->GetRequestedRegion() );
+  parallelReducer->SetNumberOfThreads( this->GetNumberOfThreads() );
+  parallelReducer->SetProgressFilter( this );
+  parallelReducer->Compute();
+  const PartialType & total = parallelReducer->GetResult();
+
+  const SizeValueType numberOfPixels
+    = this->GetInput()->GetLargestPossibleRegion().GetNumberOfPixels();
+  this->m_Sum = total.Sum;
+  this->m_Mean = total.Sum / static_cast<RealType>( numberOfPixels );
+  this->m_NonZeroCount = total.NonZeroCount;
+  this->m_BoundingBoxMinimumIndex = total.MinimumIndex;
+  this->m_BoundingBoxMaximumIndex = total.MaximumIndex;
+  this->m_Minimum = total.Minimum;
+  this->m_Maximum = total.Maximum;
+
+} // end GenerateData()
+
+
+/**
+ * ********************* ReducerType::Initialize ****************************
+ *
+ * The bounding box starts inverted: the first index of the image as the
+ * maximum, and the last index as the minimum.
+ */
+
+template< class TInputImage >
+void
+ImageReductionsFilter< TInputImage >
+::ReducerType::Initialize( PartialType & partial ) const
+{
+  const RegionType & region = this->m_Filter->GetInput()->GetLargestPossibleRegion();
+  IndexType lastIndex = region.GetIndex();
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    lastIndex[ i ] += region.GetSize()[ i ] - 1;
+  }
+
+  partial.Sum = NumericTraits<RealType>::Zero;
+  partial.NonZeroCount = 0;
+  partial.MinimumIndex = lastIndex;
+  partial.MaximumIndex = region.GetIndex();
+  partial.Minimum = NumericTraits<PixelType>::max();
+  partial.Maximum = NumericTraits<PixelType>::NonpositiveMin();
+
+} // end ReducerType::Initialize()
+
+
+/**
+ * ********************* ReduceBlock ****************************
+ *
+ * The image is processed line by line, directly on the buffer. Every
+ * requested reduction has its own loop over the line, without branches for
+ * the sum, the count and the minimum and maximum, so that these vectorize;
+ * a line is small enough to stay in the cache between the loops. For the
+ * bounding box, only the first and the last pixel larger than zero of a
+ * line are relevant, which are searched from both ends.
+ */
+
+template< class TInputImage >
+void
+ImageReductionsFilter< TInputImage >
+::ReduceBlock( const RegionType & block, PartialType & partial ) const
+{
+  const bool computeSum = this->m_ComputeSum;
+  const bool computeNonZeroCount = this->m_ComputeNonZeroCount;
+  const bool computeBoundingBox = this->m_ComputeBoundingBox;
+  const bool computeMinimumMaximum = this->m_ComputeMinimumMaximum;
+  const PixelType zero = NumericTraits<PixelType>::Zero;
+
+  const InputImageType * input = this->GetInput();
+  const PixelType * buffer = input->GetBufferPointer();
+  const OffsetValueType lineLength
+    = static_cast<OffsetValueType>( block.GetSize()[ 0 ] );
+
+  typedef ImageLinearConstIteratorWithIndex< InputImageType > IteratorType;
+  IteratorType it( input, block );
+  it.SetDirection( 0 );
+  it.GoToBegin();
+
+  PixelType minimum = partial.Minimum;
+  PixelType maximum = partial.Maximum;
+  while( !it.IsAtEnd() )
+  {
+    const IndexType lineIndex = it.GetIndex();
+    const PixelType * line = buffer + input->ComputeOffset( lineIndex );
+
+    if( computeSum )
+    {
+      RealType lineSum = NumericTraits<RealType>::Zero;
+      for( OffsetValueType i = 0; i < lineLength; ++i )
+      {
+        lineSum += static_cast<RealType>( line[ i ] );
+      }
+      partial.Sum += lineSum;
+    }
+
+    if( computeNonZeroCount )
+    {
+      SizeValueType lineCount = 0;
+      for( OffsetValueType i = 0; i < lineLength; ++i )
+      {
+        lineCount += ( line[ i ] != zero );
+      }
+      partial.NonZeroCount += lineCount;
+    }
+
+    if( computeMinimumMaximum )
+    {
+      for( OffsetValueType i = 0; i < lineLength; ++i )
+      {
+        minimum = line[ i ] < minimum ? line[ i ] : minimum;
+        maximum = line[ i ] > maximum ? line[ i ] : maximum;
+      }
+    }
+
+    if( computeBoundingBox )
+    {
+      OffsetValueType first = 0;
+      while( first < lineLength && !( line[ first ] > zero ) ) ++first;
+      if( first < lineLength )
+      {
+        OffsetValueType last = lineLength - 1;
+        while( !( line[ last ] > zero ) ) --last;
+
+        for( unsigned int i = 1; i < ImageDimension; ++i )
+        {
+          if( lineIndex[ i ] < partial.MinimumIndex[ i ] ) partial.MinimumIndex[ i ] = lineIndex[ i ];
+          if( lineIndex[ i ] > partial.MaximumIndex[ i ] ) partial.MaximumIndex[ i ] = lineIndex[ i ];
+        }
+        const OffsetValueType lineStart = lineIndex[ 0 ];
+        if( lineStart + first < partial.MinimumIndex[ 0 ] ) partial.MinimumIndex[ 0 ] = lineStart + first;
+        if( lineStart + last > partial.MaximumIndex[ 0 ] ) partial.MaximumIndex[ 0 ] = lineStart + last;
+      }
+    }
+
+    it.NextLine();
+  }
+  partial.Minimum = minimum;
+  partial.Maximum = maximum;
+
+} // end ReduceBlock()
+
+
+/**
+ * ********************* ReducerType::Merge ****************************
+ */
+
+template< class TInputImage >
+void
+ImageReductionsFilter< TInputImage >
+::ReducerType::Merge( PartialType & partial, const PartialType & other ) const
+{
+  partial.Sum += other.Sum;
+  partial.NonZeroCount += other.NonZeroCount;
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    if( other.MinimumIndex[ i ] < partial.MinimumIndex[ i ] ) partial.MinimumIndex[ i ] = other.MinimumIndex[ i ];
+    if( other.MaximumIndex[ i ] > partial.MaximumIndex[ i ] ) partial.MaximumIndex[ i ] = other.MaximumIndex[ i ];
+  }
+  if( other.Minimum < partial.Minimum ) partial.Minimum = other.Minimum;
+  if( other.Maximum > partial.Maximum ) partial.Maximum = other.Maximum;
+
+} // end ReducerType::Merge()
+
+
+/**
+ * ********************* PrintSelf ****************************
+ */
+
+template< class TInputImage >
+void
+ImageReductionsFilter< TInputImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "ComputeSum: " << this->m_ComputeSum << std::endl;
+  os << indent << "ComputeNonZeroCount: " << this->m_ComputeNonZeroCount << std::endl;
+  os << indent << "ComputeBoundingBox: " << this->m_ComputeBoundingBox << std::endl;
+  os << indent << "ComputeMinimumMaximum: " << this->m_ComputeMinimumMaximum << std::endl;
+  os << indent << "Sum: " << this->m_Sum << std::endl;
+  os << indent << "Mean: " << this->m_Mean << std::endl;
+  os << indent << "NonZeroCount: " << this->m_NonZeroCount << std::endl;
+  os << indent << "BoundingBoxMinimumIndex: " << this->m_BoundingBoxMinimumIndex << std::endl;
+  os << indent << "BoundingBoxMaximumIndex: " << this->m_BoundingBoxMaximumIndex << std::endl;
+  os << indent << "Minimum: "
+     << static_cast<typename NumericTraits<PixelType>::PrintType>( this->m_Minimum ) << std::endl;
+  os << indent << "Maximum: "
+     << static_cast<typename NumericTraits<PixelType>::PrintType>( this->m_Maximum ) << std::endl;
+
+} // end PrintSelf()
+
+} // end namespace itk
+
+#endif // end #ifndef __itkImageReductionsFilter_txx
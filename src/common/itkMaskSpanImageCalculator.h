@@ -0,0 +1,170 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkMaskSpanImageCalculator_h
+#define __itkMaskSpanImageCalculator_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkMultiThreader.h"
+#include <vector>
+
+
+namespace itk
+{
+
+/** \class MaskSpanImageCalculator
+ * \brief Run-length encode the inside of a mask, for mask-restricted loops.
+ *
+ * The pixels of the mask larger than zero are stored as spans: maximal runs
+ * of inside pixels along dimension 0, in buffer order. A filter that only
+ * processes the inside of the mask iterates the spans instead of testing
+ * every mask pixel, so that its cost scales with the volume of the mask,
+ * not with the volume of the image. The mask is scanned once, in parallel
+ * over the lines of the region.
+ *
+ * The bounding region of the spans is computed as well. A span is stored by
+ * the index of its first pixel, so that it can be used for images with
+ * other buffered regions than the mask.
+ *
+ * For the region of a thread, GetSpanRange() gives the spans that may
+ * intersect it, by a binary search, and GetSpanRegion() the part of a
+ * span inside it. SplitSpans() divides the spans over threads by pixel
+ * count, for filters that thread over the spans themselves.
+ */
+
+template< class TMaskImage >
+class ITK_EXPORT MaskSpanImageCalculator : public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef MaskSpanImageCalculator       Self;
+  typedef Object                        Superclass;
+  typedef SmartPointer<Self>            Pointer;
+  typedef SmartPointer<const Self>      ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( MaskSpanImageCalculator, Object );
+
+  itkStaticConstMacro( ImageDimension, unsigned int, TMaskImage::ImageDimension );
+
+  /** Typedefs. */
+  typedef TMaskImage                              MaskImageType;
+  typedef typename MaskImageType::PixelType       MaskPixelType;
+  typedef typename MaskImageType::RegionType      RegionType;
+  typedef typename MaskImageType::IndexType       IndexType;
+  typedef typename MaskImageType::SizeType        SizeType;
+
+  /** A run of inside pixels along dimension 0. */
+  struct SpanType
+  {
+    IndexType     Index;
+    SizeValueType Length;
+  };
+  typedef std::vector<SpanType>                   SpanContainerType;
+
+  /** Set the mask. */
+  itkSetConstObjectMacro( MaskImage, MaskImageType );
+
+  /** Set/Get the region to encode. Default the buffered region of the mask. */
+  void SetRegion( const RegionType & region );
+  itkGetConstReferenceMacro( Region, RegionType );
+
+  /** Set/Get the number of threads. Default the global default. */
+  itkSetMacro( NumberOfThreads, ThreadIdType );
+  itkGetConstMacro( NumberOfThreads, ThreadIdType );
+
+  /** Compute the spans. */
+  void Compute( void );
+
+  /** Get the spans, in buffer order. */
+  const SpanContainerType & GetSpans( void ) const
+  {
+    return this->m_Spans;
+  }
+  SizeValueType GetNumberOfSpans( void ) const
+  {
+    return this->m_Spans.size();
+  }
+
+  /** The number of pixels inside the mask. */
+  itkGetConstMacro( NumberOfInsidePixels, SizeValueType );
+
+  /** The bounding region of the inside; empty if there are no spans. */
+  itkGetConstReferenceMacro( BoundingRegion, RegionType );
+
+  /** The range [begin, end) of the spans that may intersect a region. */
+  void GetSpanRange( const RegionType & region,
+    SizeValueType & begin, SizeValueType & end ) const;
+
+  /** The part of a span inside a region. Returns false if it is empty. */
+  bool GetSpanRegion( SizeValueType span, const RegionType & region,
+    RegionType & spanRegion ) const;
+
+  /** The range [begin, end) of the spans of a part, when the spans are
+   * divided over numberOfParts parts of about the same number of pixels. */
+  void SplitSpans( ThreadIdType part, ThreadIdType numberOfParts,
+    SizeValueType & begin, SizeValueType & end ) const;
+
+  /** Compare the lines of two indices, ignoring dimension 0, in buffer
+   * order: -1 if the line of a is before that of b, 0 if equal, 1 if after. */
+  static int CompareLines( const IndexType & a, const IndexType & b );
+
+protected:
+  MaskSpanImageCalculator();
+  virtual ~MaskSpanImageCalculator() {};
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** Whether the span starts before the index, in buffer order. */
+  static bool IsBefore( const SpanType & span, const IndexType & index );
+
+  /** The threaded scan over the lines of the region. */
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback( void * arg );
+  void ThreadedCompute( SizeValueType lineBegin, SizeValueType lineEnd,
+    ThreadIdType threadId );
+
+private:
+  MaskSpanImageCalculator( const Self & ); // purposely not implemented
+  void operator=( const Self & );          // purposely not implemented
+
+  typename MaskImageType::ConstPointer  m_MaskImage;
+  RegionType                            m_Region;
+  bool                                  m_RegionSetByUser;
+  MultiThreader::Pointer                m_Threader;
+  ThreadIdType                          m_NumberOfThreads;
+
+  SpanContainerType           m_Spans;
+  SizeValueType               m_NumberOfInsidePixels;
+  RegionType                  m_BoundingRegion;
+
+  /** The cumulative number of pixels before every span, for SplitSpans(),
+   * and the spans found per thread. */
+  std::vector<SizeValueType>      m_CumulativeLengths;
+  std::vector<SpanContainerType>  m_ThreadSpans;
+
+}; // end class MaskSpanImageCalculator
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkMaskSpanImageCalculator.txx"
+#endif
+
+#endif // end #ifndef __itkMaskSpanImageCalculator_h
@@ -0,0 +1,374 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkMaskSpanImageCalculator_txx
+#define __itkMaskSpanImageCalculator_txx
+
+#include "itkMaskSpanImageCalculator.h"
+#include "itkNumericTraits.h"
+#include <algorithm>
+
+
+namespace itk
+{
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template< class TMaskImage >
+MaskSpanImageCalculator< TMaskImage >
+::MaskSpanImageCalculator()
+{
+  this->m_RegionSetByUser = false;
+  this->m_Threader = MultiThreader::New();
+  this->m_NumberOfThreads = this->m_Threader->GetNumberOfThreads();
+  this->m_NumberOfInsidePixels = 0;
+
+} // end Constructor
+
+
+/**
+ * ******************* SetRegion *******************
+ */
+
+template< class TMaskImage >
+void
+MaskSpanImageCalculator< TMaskImage >
+::SetRegion( const RegionType & region )
+{
+  this->m_Region = region;
+  this->m_RegionSetByUser = true;
+  this->Modified();
+
+} // end SetRegion()
+
+
+/**
+ * ******************* Compute *******************
+ */
+
+template< class TMaskImage >
+void
+MaskSpanImageCalculator< TMaskImage >
+::Compute( void )
+{
+  if( this->m_MaskImage.IsNull() )
+  {
+    itkExceptionMacro( << "ERROR: no mask is set." );
+  }
+  if( !this->m_RegionSetByUser )
+  {
+    this->m_Region = this->m_MaskImage->GetBufferedRegion();
+  }
+  else if( !this->m_MaskImage->GetBufferedRegion().IsInside( this->m_Region ) )
+  {
+    itkExceptionMacro( << "ERROR: the region " << this->m_Region
+      << " is not inside the buffered region of the mask." );
+  }
+
+  this->m_Spans.clear();
+  this->m_CumulativeLengths.clear();
+  this->m_NumberOfInsidePixels = 0;
+  RegionType empty;
+  empty.SetIndex( this->m_Region.GetIndex() );
+  this->m_BoundingRegion = empty;
+  if( this->m_Region.GetNumberOfPixels() == 0 ) return;
+
+  /** Scan the lines in parallel, every thread into its own spans. */
+  const SizeValueType numberOfLines
+    = this->m_Region.GetNumberOfPixels() / this->m_Region.GetSize( 0 );
+  const ThreadIdType numberOfThreads = static_cast<ThreadIdType>(
+    std::max<SizeValueType>( 1, std::min<SizeValueType>( this->m_NumberOfThreads, numberOfLines ) ) );
+  this->m_ThreadSpans.assign( numberOfThreads, SpanContainerType() );
+  this->m_Threader->SetNumberOfThreads( numberOfThreads );
+  this->m_Threader->SetSingleMethod( Self::ThreaderCallback, this );
+  this->m_Threader->SingleMethodExecute();
+
+  /** Concatenate the spans of the threads, which are in buffer order. */
+  SizeValueType numberOfSpans = 0;
+  for( ThreadIdType t = 0; t < numberOfThreads; ++t )
+  {
+    numberOfSpans += this->m_ThreadSpans[ t ].size();
+  }
+  this->m_Spans.reserve( numberOfSpans );
+  for( ThreadIdType t = 0; t < numberOfThreads; ++t )
+  {
+    this->m_Spans.insert( this->m_Spans.end(),
+      this->m_ThreadSpans[ t ].begin(), this->m_ThreadSpans[ t ].end() );
+    SpanContainerType().swap( this->m_ThreadSpans[ t ] );
+  }
+  if( this->m_Spans.empty() ) return;
+
+  /** The cumulative lengths and the bounding region. */
+  IndexType minimum = this->m_Spans[ 0 ].Index;
+  IndexType maximum = this->m_Spans[ 0 ].Index;
+  this->m_CumulativeLengths.resize( numberOfSpans );
+  for( SizeValueType s = 0; s < numberOfSpans; ++s )
+  {
+    const SpanType & span = this->m_Spans[ s ];
+    this->m_CumulativeLengths[ s ] = this->m_NumberOfInsidePixels;
+    this->m_NumberOfInsidePixels += span.Length;
+    for( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+      minimum[ i ] = std::min( minimum[ i ], span.Index[ i ] );
+      maximum[ i ] = std::max( maximum[ i ], span.Index[ i ] );
+    }
+    maximum[ 0 ] = std::max( maximum[ 0 ],
+      span.Index[ 0 ] + static_cast<OffsetValueType>( span.Length ) - 1 );
+  }
+  SizeType size;
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    size[ i ] = static_cast<SizeValueType>( maximum[ i ] - minimum[ i ] + 1 );
+  }
+  this->m_BoundingRegion.SetIndex( minimum );
+  this->m_BoundingRegion.SetSize( size );
+
+} // end Compute()
+
+
+/**
+ * ******************* ThreaderCallback *******************
+ */
+
+template< class TMaskImage >
+ITK_THREAD_RETURN_TYPE
+MaskSpanImageCalculator< TMaskImage >
+::ThreaderCallback( void * arg )
+{
+  typedef MultiThreader::ThreadInfoStruct ThreadInfoType;
+  ThreadInfoType * info = static_cast<ThreadInfoType *>( arg );
+  Self * calculator = static_cast<Self *>( info->UserData );
+
+  const ThreadIdType threadId = info->ThreadID;
+  const SizeValueType numberOfThreads = info->NumberOfThreads;
+  const SizeValueType numberOfLines = calculator->m_Region.GetNumberOfPixels()
+    / calculator->m_Region.GetSize( 0 );
+  calculator->ThreadedCompute(
+    numberOfLines * threadId / numberOfThreads,
+    numberOfLines * ( threadId + 1 ) / numberOfThreads, threadId );
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end ThreaderCallback()
+
+
+/**
+ * ******************* ThreadedCompute *******************
+ */
+
+template< class TMaskImage >
+void
+MaskSpanImageCalculator< TMaskImage >
+::ThreadedCompute( SizeValueType lineBegin, SizeValueType lineEnd,
+  ThreadIdType threadId )
+{
+  if( lineBegin >= lineEnd ) return;
+
+  const MaskImageType * mask = this->m_MaskImage.GetPointer();
+  const MaskPixelType * buffer = mask->GetBufferPointer();
+  const IndexType start = this->m_Region.GetIndex();
+  const SizeType size = this->m_Region.GetSize();
+  const OffsetValueType lineLength = static_cast<OffsetValueType>( size[ 0 ] );
+  const MaskPixelType zero = NumericTraits<MaskPixelType>::Zero;
+  SpanContainerType & spans = this->m_ThreadSpans[ threadId ];
+
+  /** The index of the first line, then stepped as an odometer. */
+  IndexType index = start;
+  SizeValueType rest = lineBegin;
+  for( unsigned int i = 1; i < ImageDimension; ++i )
+  {
+    index[ i ] += static_cast<OffsetValueType>( rest % size[ i ] );
+    rest /= size[ i ];
+  }
+
+  for( SizeValueType line = lineBegin; line < lineEnd; ++line )
+  {
+    const MaskPixelType * p = buffer + mask->ComputeOffset( index );
+    OffsetValueType i = 0;
+    while( i < lineLength )
+    {
+      while( i < lineLength && !( p[ i ] > zero ) ) ++i;
+      if( i == lineLength ) break;
+      const OffsetValueType first = i;
+      while( i < lineLength && p[ i ] > zero ) ++i;
+
+      SpanType span;
+      span.Index = index;
+      span.Index[ 0 ] += first;
+      span.Length = static_cast<SizeValueType>( i - first );
+      spans.push_back( span );
+    }
+
+    for( unsigned int d = 1; d < ImageDimension; ++d )
+    {
+      if( ++index[ d ] < start[ d ] + static_cast<OffsetValueType>( size[ d ] ) ) break;
+      index[ d ] = start[ d ];
+    }
+  }
+
+} // end ThreadedCompute()
+
+
+/**
+ * ******************* IsBefore *******************
+ */
+
+template< class TMaskImage >
+bool
+MaskSpanImageCalculator< TMaskImage >
+::IsBefore( const SpanType & span, const IndexType & index )
+{
+  const int line = Self::CompareLines( span.Index, index );
+  return line < 0 || ( line == 0 && span.Index[ 0 ] < index[ 0 ] );
+
+} // end IsBefore()
+
+
+/**
+ * ******************* CompareLines *******************
+ */
+
+template< class TMaskImage >
+int
+MaskSpanImageCalculator< TMaskImage >
+::CompareLines( const IndexType & a, const IndexType & b )
+{
+  for( unsigned int i = ImageDimension - 1; i > 0; --i )
+  {
+    if( a[ i ] != b[ i ] ) return a[ i ] < b[ i ] ? -1 : 1;
+  }
+  return 0;
+
+} // end CompareLines()
+
+
+/**
+ * ******************* GetSpanRange *******************
+ */
+
+template< class TMaskImage >
+void
+MaskSpanImageCalculator< TMaskImage >
+::GetSpanRange( const RegionType & region,
+  SizeValueType & begin, SizeValueType & end ) const
+{
+  begin = end = 0;
+  if( region.GetNumberOfPixels() == 0 || this->m_Spans.empty() ) return;
+
+  /** A span that starts earlier on the first line of the region may reach
+   * into it, so the search starts at the beginning of that line. The spans
+   * after the last pixel of the region are outside. */
+  IndexType first = region.GetIndex();
+  first[ 0 ] = this->m_Region.GetIndex( 0 );
+  IndexType last = region.GetUpperIndex();
+  last[ 0 ] += 1;
+
+  begin = std::lower_bound( this->m_Spans.begin(), this->m_Spans.end(),
+    first, Self::IsBefore ) - this->m_Spans.begin();
+  end = std::lower_bound( this->m_Spans.begin() + begin, this->m_Spans.end(),
+    last, Self::IsBefore ) - this->m_Spans.begin();
+
+} // end GetSpanRange()
+
+
+/**
+ * ******************* GetSpanRegion *******************
+ */
+
+template< class TMaskImage >
+bool
+MaskSpanImageCalculator< TMaskImage >
+::GetSpanRegion( SizeValueType span, const RegionType & region,
+  RegionType & spanRegion ) const
+{
+  const SpanType & s = this->m_Spans[ span ];
+  const IndexType & start = region.GetIndex();
+  const SizeType & size = region.GetSize();
+  for( unsigned int i = 1; i < ImageDimension; ++i )
+  {
+    if( s.Index[ i ] < start[ i ]
+      || s.Index[ i ] >= start[ i ] + static_cast<OffsetValueType>( size[ i ] ) )
+    {
+      return false;
+    }
+  }
+
+  const OffsetValueType lo = std::max( s.Index[ 0 ], start[ 0 ] );
+  const OffsetValueType hi = std::min(
+    s.Index[ 0 ] + static_cast<OffsetValueType>( s.Length ),
+    start[ 0 ] + static_cast<OffsetValueType>( size[ 0 ] ) );
+  if( lo >= hi ) return false;
+
+  IndexType index = s.Index;
+  index[ 0 ] = lo;
+  SizeType spanSize;
+  spanSize.Fill( 1 );
+  spanSize[ 0 ] = static_cast<SizeValueType>( hi - lo );
+  spanRegion.SetIndex( index );
+  spanRegion.SetSize( spanSize );
+  return true;
+
+} // end GetSpanRegion()
+
+
+/**
+ * ******************* SplitSpans *******************
+ */
+
+template< class TMaskImage >
+void
+MaskSpanImageCalculator< TMaskImage >
+::SplitSpans( ThreadIdType part, ThreadIdType numberOfParts,
+  SizeValueType & begin, SizeValueType & end ) const
+{
+  const SizeValueType total = this->m_NumberOfInsidePixels;
+  const SizeValueType from = total * part / numberOfParts;
+  const SizeValueType to = total * ( part + 1 ) / numberOfParts;
+
+  begin = std::lower_bound( this->m_CumulativeLengths.begin(),
+    this->m_CumulativeLengths.end(), from ) - this->m_CumulativeLengths.begin();
+  end = part + 1 == numberOfParts ? this->m_Spans.size()
+    : std::lower_bound( this->m_CumulativeLengths.begin() + begin,
+      this->m_CumulativeLengths.end(), to ) - this->m_CumulativeLengths.begin();
+
+} // end SplitSpans()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template< class TMaskImage >
+void
+MaskSpanImageCalculator< TMaskImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "Region: " << this->m_Region << std::endl;
+  os << indent << "NumberOfThreads: " << this->m_NumberOfThreads << std::endl;
+  os << indent << "NumberOfSpans: " << this->m_Spans.size() << std::endl;
+  os << indent << "NumberOfInsidePixels: " << this->m_NumberOfInsidePixels << std::endl;
+  os << indent << "BoundingRegion: " << this->m_BoundingRegion << std::endl;
+
+} // end PrintSelf()
+
+} // end namespace itk
+
+#endif // end #ifndef __itkMaskSpanImageCalculator_txx
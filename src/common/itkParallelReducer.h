@@ -0,0 +1,187 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkParallelReducer_h
+#define __itkParallelReducer_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkMultiThreader.h"
+#include "itkProcessObject.h"
+#include <vector>
+
+
+namespace itk
+{
+
+/** \class ParallelReducer
+ * \brief Reduce a region in parallel, with a result independent of the
+ * number of threads.
+ *
+ * The region is split into blocks of whole lines, in buffer order. The
+ * layout of the blocks depends only on the region and on the maximum number
+ * of blocks, never on the number of threads. Every block is reduced into
+ * its own partial result, starting from the identity, and the partials are
+ * merged pairwise in block order. So a floating point sum is bitwise the
+ * same for any number of threads, and it is more accurate than a running
+ * sum as well. The threads get contiguous ranges of blocks.
+ *
+ * When the merge is exact, as for counts, minima and histograms, the order
+ * does not matter: with ExactMerge on, every thread reduces its blocks
+ * into one partial of its own, which saves the memory of a partial per
+ * block. Either way the partials are stored a cache line apart, so that
+ * the threads do not share cache lines.
+ *
+ * The reduction is given by a reducer, a class with:
+ *   - typedefs RegionType and PartialType,
+ *   - void Initialize( PartialType & partial ) const, setting the identity,
+ *   - void Reduce( const RegionType & block, PartialType & partial ) const,
+ *     adding the pixels of a block,
+ *   - void Merge( PartialType & partial, const PartialType & other ) const,
+ *     adding other to partial.
+ * Reduce() is called from several threads at the same time.
+ *
+ * A filter that reduces its input overrides GenerateData() and calls
+ * Compute() between BeforeThreadedGenerateData() and AfterThreadedGenerateData().
+ * With the filter set, its progress is updated per block, and an abort of
+ * the filter stops the reduction.
+ */
+
+template< class TReducer >
+class ITK_EXPORT ParallelReducer : public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef ParallelReducer               Self;
+  typedef Object                        Superclass;
+  typedef SmartPointer<Self>            Pointer;
+  typedef SmartPointer<const Self>      ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( ParallelReducer, Object );
+
+  /** Typedefs. */
+  typedef TReducer                                ReducerType;
+  typedef typename ReducerType::RegionType        RegionType;
+  typedef typename ReducerType::PartialType       PartialType;
+  typedef typename RegionType::IndexType          IndexType;
+  typedef typename RegionType::SizeType           SizeType;
+  typedef std::vector<RegionType>                 RegionContainerType;
+
+  itkStaticConstMacro( ImageDimension, unsigned int, RegionType::ImageDimension );
+
+  /** The default maximum number of blocks. */
+  itkStaticConstMacro( DefaultMaximumNumberOfBlocks, unsigned int, 256 );
+
+  /** Set the reducer. It is not copied. */
+  void SetReducer( const ReducerType * reducer )
+  {
+    this->m_Reducer = reducer;
+  }
+
+  /** Set/Get the region to reduce. */
+  itkSetMacro( Region, RegionType );
+  itkGetConstReferenceMacro( Region, RegionType );
+
+  /** Set/Get the number of threads. Default the global default. */
+  itkSetMacro( NumberOfThreads, ThreadIdType );
+  itkGetConstMacro( NumberOfThreads, ThreadIdType );
+
+  /** Set/Get the maximum number of blocks. Changing it changes the order
+   * of the merge, so results are only comparable for the same value.
+   * Default DefaultMaximumNumberOfBlocks.
+   */
+  itkSetMacro( MaximumNumberOfBlocks, SizeValueType );
+  itkGetConstMacro( MaximumNumberOfBlocks, SizeValueType );
+
+  /** Set/Get whether the merge is exact, so that the partials may be
+   * merged in any order. Default false.
+   */
+  itkSetMacro( ExactMerge, bool );
+  itkGetConstMacro( ExactMerge, bool );
+  itkBooleanMacro( ExactMerge );
+
+  /** Set the filter of which the progress is updated. Default none. */
+  void SetProgressFilter( ProcessObject * filter )
+  {
+    this->m_ProgressFilter = filter;
+  }
+
+  /** Reduce the region. */
+  void Compute( void );
+
+  /** Get the merged result. */
+  const PartialType & GetResult( void ) const
+  {
+    return this->m_Result;
+  }
+
+  /** Split a region into at most maximumNumberOfBlocks blocks of whole
+   * lines, in buffer order. The blocks are slabs along the outermost
+   * dimension, which are split further along the next dimension when there
+   * are fewer slabs than the maximum. Every block is contiguous in the
+   * buffer if the region is the buffered region.
+   */
+  static void SplitRegion( const RegionType & region,
+    SizeValueType maximumNumberOfBlocks, RegionContainerType & blocks );
+
+protected:
+  ParallelReducer();
+  virtual ~ParallelReducer() {};
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** The threaded reduction of a range of blocks. */
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback( void * arg );
+  void ThreadedCompute( SizeValueType blockBegin, SizeValueType blockEnd,
+    ThreadIdType threadId );
+
+private:
+  ParallelReducer( const Self & ); // purposely not implemented
+  void operator=( const Self & );  // purposely not implemented
+
+  /** A partial result, followed by a cache line of padding, so that no
+   * cache line holds parts of two partials. */
+  struct PaddedPartialType
+  {
+    PartialType Value;
+    char        Padding[ 64 ];
+  };
+
+  const ReducerType *     m_Reducer;
+  RegionType              m_Region;
+  MultiThreader::Pointer  m_Threader;
+  ThreadIdType            m_NumberOfThreads;
+  SizeValueType           m_MaximumNumberOfBlocks;
+  bool                    m_ExactMerge;
+  ProcessObject *         m_ProgressFilter;
+
+  RegionContainerType             m_Blocks;
+  std::vector<PaddedPartialType>  m_Partials;
+  PartialType                     m_Result;
+
+}; // end class ParallelReducer
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkParallelReducer.txx"
+#endif
+
+#endif // end #ifndef __itkParallelReducer_h
@@ -0,0 +1,245 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkParallelReducer_txx
+#define __itkParallelReducer_txx
+
+#include "itkParallelReducer.h"
+#include <algorithm>
+
+
+namespace itk
+{
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template< class TReducer >
+ParallelReducer< TReducer >
+::ParallelReducer()
+{
+  this->m_Reducer = 0;
+  this->m_Threader = MultiThreader::New();
+  this->m_NumberOfThreads = this->m_Threader->GetNumberOfThreads();
+  this->m_MaximumNumberOfBlocks = DefaultMaximumNumberOfBlocks;
+  this->m_ExactMerge = false;
+  this->m_ProgressFilter = 0;
+
+} // end Constructor
+
+
+/**
+ * ******************* Compute *******************
+ */
+
+template< class TReducer >
+void
+ParallelReducer< TReducer >
+::Compute( void )
+{
+  if( !this->m_Reducer )
+  {
+    itkExceptionMacro( << "ERROR: no reducer is set." );
+  }
+
+  /** The blocks only depend on the region. */
+  Self::SplitRegion( this->m_Region, this->m_MaximumNumberOfBlocks, this->m_Blocks );
+  const SizeValueType numberOfBlocks = this->m_Blocks.size();
+  if( numberOfBlocks == 0 )
+  {
+    this->m_Reducer->Initialize( this->m_Result );
+    return;
+  }
+
+  /** A partial per block, or per thread for an exact merge. */
+  const ThreadIdType numberOfThreads = static_cast<ThreadIdType>(
+    std::max<SizeValueType>( 1, std::min<SizeValueType>( this->m_NumberOfThreads, numberOfBlocks ) ) );
+  this->m_Partials.resize( this->m_ExactMerge ? numberOfThreads : numberOfBlocks );
+  for( std::size_t i = 0; i < this->m_Partials.size(); ++i )
+  {
+    this->m_Reducer->Initialize( this->m_Partials[ i ].Value );
+  }
+
+  this->m_Threader->SetNumberOfThreads( numberOfThreads );
+  this->m_Threader->SetSingleMethod( Self::ThreaderCallback, this );
+  this->m_Threader->SingleMethodExecute();
+
+  /** Merge pairwise in block order: ((p0 p1)(p2 p3))((p4 p5)(p6 p7)).
+   * The partials of an exact merge are just merged in thread order. */
+  std::vector<PaddedPartialType> & partials = this->m_Partials;
+  if( this->m_ExactMerge )
+  {
+    for( std::size_t t = 1; t < partials.size(); ++t )
+    {
+      this->m_Reducer->Merge( partials[ 0 ].Value, partials[ t ].Value );
+    }
+  }
+  else
+  {
+    for( std::size_t step = 1; step < partials.size(); step *= 2 )
+    {
+      for( std::size_t b = 0; b + step < partials.size(); b += 2 * step )
+      {
+        this->m_Reducer->Merge( partials[ b ].Value, partials[ b + step ].Value );
+      }
+    }
+  }
+  this->m_Result = partials[ 0 ].Value;
+
+  std::vector<PaddedPartialType>().swap( this->m_Partials );
+  RegionContainerType().swap( this->m_Blocks );
+
+} // end Compute()
+
+
+/**
+ * ******************* ThreaderCallback *******************
+ */
+
+template< class TReducer >
+ITK_THREAD_RETURN_TYPE
+ParallelReducer< TReducer >
+::ThreaderCallback( void * arg )
+{
+  typedef MultiThreader::ThreadInfoStruct ThreadInfoType;
+  ThreadInfoType * info = static_cast<ThreadInfoType *>( arg );
+  Self * reducer = static_cast<Self *>( info->UserData );
+
+  const ThreadIdType threadId = info->ThreadID;
+  const SizeValueType numberOfThreads = info->NumberOfThreads;
+  const SizeValueType numberOfBlocks = reducer->m_Blocks.size();
+  reducer->ThreadedCompute(
+    numberOfBlocks * threadId / numberOfThreads,
+    numberOfBlocks * ( threadId + 1 ) / numberOfThreads, threadId );
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end ThreaderCallback()
+
+
+/**
+ * ******************* ThreadedCompute *******************
+ */
+
+template< class TReducer >
+void
+ParallelReducer< TReducer >
+::ThreadedCompute( SizeValueType blockBegin, SizeValueType blockEnd,
+  ThreadIdType threadId )
+{
+  ProcessObject * filter = threadId == 0 ? this->m_ProgressFilter : 0;
+  for( SizeValueType b = blockBegin; b < blockEnd; ++b )
+  {
+    PartialType & partial = this->m_ExactMerge
+      ? this->m_Partials[ threadId ].Value : this->m_Partials[ b ].Value;
+    this->m_Reducer->Reduce( this->m_Blocks[ b ], partial );
+
+    /** Only the first thread reports, like the ProgressReporter. */
+    if( filter )
+    {
+      filter->UpdateProgress( static_cast<float>( b - blockBegin + 1 )
+        / static_cast<float>( blockEnd - blockBegin ) );
+      if( filter->GetAbortGenerateData() )
+      {
+        ProcessAborted e( __FILE__, __LINE__ );
+        e.SetDescription( std::string( "Object " ) + filter->GetNameOfClass()
+          + ": AbortGenerateDataOn" );
+        throw e;
+      }
+    }
+  }
+
+} // end ThreadedCompute()
+
+
+/**
+ * ******************* SplitRegion *******************
+ */
+
+template< class TReducer >
+void
+ParallelReducer< TReducer >
+::SplitRegion( const RegionType & region,
+  SizeValueType maximumNumberOfBlocks, RegionContainerType & blocks )
+{
+  blocks.clear();
+  if( region.GetNumberOfPixels() == 0 ) return;
+  if( ImageDimension == 1 || maximumNumberOfBlocks <= 1 )
+  {
+    blocks.push_back( region );
+    return;
+  }
+
+  /** The dimensions above the split dimension d are split into single
+   * indices, d itself into parts; below d the blocks are whole. */
+  const SizeType & size = region.GetSize();
+  unsigned int d = ImageDimension - 1;
+  SizeValueType outer = 1;
+  while( d > 1 && outer * size[ d ] < maximumNumberOfBlocks )
+  {
+    outer *= size[ d ];
+    --d;
+  }
+  const SizeValueType parts = std::max<SizeValueType>( 1,
+    std::min<SizeValueType>( size[ d ], maximumNumberOfBlocks / outer ) );
+
+  blocks.reserve( outer * parts );
+  for( SizeValueType o = 0; o < outer; ++o )
+  {
+    RegionType block = region;
+    SizeValueType rest = o;
+    for( unsigned int k = d + 1; k < ImageDimension; ++k )
+    {
+      block.SetIndex( k, region.GetIndex( k ) + static_cast<IndexValueType>( rest % size[ k ] ) );
+      block.SetSize( k, 1 );
+      rest /= size[ k ];
+    }
+    for( SizeValueType p = 0; p < parts; ++p )
+    {
+      const SizeValueType begin = size[ d ] * p / parts;
+      const SizeValueType end = size[ d ] * ( p + 1 ) / parts;
+      block.SetIndex( d, region.GetIndex( d ) + static_cast<IndexValueType>( begin ) );
+      block.SetSize( d, end - begin );
+      blocks.push_back( block );
+    }
+  }
+
+} // end SplitRegion()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template< class TReducer >
+void
+ParallelReducer< TReducer >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "Region: " << this->m_Region << std::endl;
+  os << indent << "NumberOfThreads: " << this->m_NumberOfThreads << std::endl;
+  os << indent << "MaximumNumberOfBlocks: " << this->m_MaximumNumberOfBlocks << std::endl;
+  os << indent << "ExactMerge: " << this->m_ExactMerge << std::endl;
+
+} // end PrintSelf()
+
+} // end namespace itk
+
+#endif // end #ifndef __itkParallelReducer_txx
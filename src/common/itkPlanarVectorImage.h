@@ -0,0 +1,148 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkPlanarVectorImage_h
+#define __itkPlanarVectorImage_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkImage.h"
+#include "itkVectorImage.h"
+#include "itkImportImageContainer.h"
+#include <vector>
+
+
+namespace itk
+{
+
+/** \class PlanarVectorImage
+ * \brief A multi-channel image stored as one contiguous plane per channel.
+ *
+ * An itk::VectorImage stores its components interleaved, so a filter that
+ * works on one channel needs a copy of that channel first. This class
+ * stores the channels one after the other, in a single buffer, and views
+ * every plane as an ordinary itk::Image without copying: GetChannel()
+ * returns an image whose pixel container points into the plane.
+ *
+ * The views do not own their memory. They are valid as long as this
+ * object exists and is not reallocated; writing to a view writes the
+ * plane. Conversion to and from the interleaved layout is done only at
+ * the boundaries, e.g. after reading and before writing, by
+ * DeinterleaveFrom() and InterleaveTo(). These transpose the buffer in
+ * blocks of pixels that fit in the cache, reading each input once.
+ *
+ * This is not a DataObject: it does not take part in the pipeline, only
+ * its channel views do.
+ */
+
+template< class TPixel, unsigned int VImageDimension >
+class ITK_EXPORT PlanarVectorImage : public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef PlanarVectorImage             Self;
+  typedef Object                        Superclass;
+  typedef SmartPointer<Self>            Pointer;
+  typedef SmartPointer<const Self>      ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( PlanarVectorImage, Object );
+
+  itkStaticConstMacro( ImageDimension, unsigned int, VImageDimension );
+
+  /** Typedefs. */
+  typedef TPixel                                      PixelType;
+  typedef Image< TPixel, VImageDimension >            ChannelImageType;
+  typedef typename ChannelImageType::Pointer          ChannelImagePointer;
+  typedef VectorImage< TPixel, VImageDimension >      VectorImageType;
+  typedef ImageBase< VImageDimension >                ImageBaseType;
+  typedef typename ChannelImageType::RegionType       RegionType;
+  typedef typename ChannelImageType::PixelContainer   PixelContainerType;
+  typedef typename PixelContainerType::Pointer        PixelContainerPointer;
+
+  /** Take the geometry, i.e. the regions, origin, spacing and direction,
+   * of an image. Call Allocate() afterwards. */
+  void CopyInformation( const ImageBaseType * image );
+
+  /** Set/Get the number of channels. Call Allocate() afterwards. */
+  itkSetMacro( NumberOfComponentsPerPixel, unsigned int );
+  itkGetConstMacro( NumberOfComponentsPerPixel, unsigned int );
+
+  /** Allocate the planes of the buffered region, and create the views. */
+  void Allocate( void );
+
+  /** Get the number of pixels of a plane. */
+  SizeValueType GetNumberOfPixelsPerChannel( void ) const
+  {
+    return this->m_Geometry->GetBufferedRegion().GetNumberOfPixels();
+  }
+
+  /** Get a channel as a scalar image, sharing the memory of its plane. */
+  ChannelImageType * GetChannel( unsigned int channel ) const
+  {
+    return this->m_Channels[ channel ].GetPointer();
+  }
+
+  /** Get the first pixel of the plane of a channel. */
+  PixelType * GetChannelPointer( unsigned int channel ) const
+  {
+    return this->m_Buffer->GetBufferPointer()
+      + static_cast<SizeValueType>( channel ) * this->GetNumberOfPixelsPerChannel();
+  }
+
+  /** Take the geometry and the number of components of an interleaved
+   * image, allocate, and copy the channels of its buffer into the planes. */
+  void DeinterleaveFrom( const VectorImageType * image );
+
+  /** Give an interleaved image the geometry and the number of components of
+   * this image, allocate it, and copy the planes into its buffer. */
+  void InterleaveTo( VectorImageType * image ) const;
+
+  /** Release the planes and the views. */
+  void ReleaseData( void );
+
+protected:
+  PlanarVectorImage();
+  virtual ~PlanarVectorImage() {};
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+private:
+  PlanarVectorImage( const Self & );  // purposely not implemented
+  void operator=( const Self & );     // purposely not implemented
+
+  /** The number of pixels transposed at a time. */
+  itkStaticConstMacro( BlockSize, unsigned int, 1024 );
+
+  /** An image without buffer holding the geometry, and one view per
+   * channel with that geometry. */
+  ChannelImagePointer                 m_Geometry;
+  unsigned int                        m_NumberOfComponentsPerPixel;
+  PixelContainerPointer               m_Buffer;
+  std::vector<ChannelImagePointer>    m_Channels;
+
+}; // end class PlanarVectorImage
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkPlanarVectorImage.txx"
+#endif
+
+#endif // end #ifndef __itkPlanarVectorImage_h
@@ -0,0 +1,207 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkPlanarVectorImage_txx
+#define __itkPlanarVectorImage_txx
+
+#include "itkPlanarVectorImage.h"
+#include <algorithm>
+
+
+namespace itk
+{
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template< class TPixel, unsigned int VImageDimension >
+PlanarVectorImage< TPixel, VImageDimension >
+::PlanarVectorImage()
+{
+  this->m_Geometry = ChannelImageType::New();
+  this->m_NumberOfComponentsPerPixel = 1;
+
+} // end Constructor
+
+
+/**
+ * ******************* CopyInformation *******************
+ */
+
+template< class TPixel, unsigned int VImageDimension >
+void
+PlanarVectorImage< TPixel, VImageDimension >
+::CopyInformation( const ImageBaseType * image )
+{
+  this->m_Geometry->CopyInformation( image );
+  this->m_Geometry->SetBufferedRegion( image->GetBufferedRegion() );
+  this->m_Geometry->SetRequestedRegion( image->GetBufferedRegion() );
+  this->Modified();
+
+} // end CopyInformation()
+
+
+/**
+ * ******************* Allocate *******************
+ */
+
+template< class TPixel, unsigned int VImageDimension >
+void
+PlanarVectorImage< TPixel, VImageDimension >
+::Allocate( void )
+{
+  const unsigned int numberOfChannels = this->m_NumberOfComponentsPerPixel;
+  const SizeValueType numberOfPixels = this->GetNumberOfPixelsPerChannel();
+
+  /** One buffer for all planes. */
+  this->m_Buffer = PixelContainerType::New();
+  this->m_Buffer->Reserve( numberOfPixels * numberOfChannels );
+
+  /** A view per plane, which does not own its memory. */
+  this->m_Channels.resize( numberOfChannels );
+  for( unsigned int c = 0; c < numberOfChannels; ++c )
+  {
+    PixelContainerPointer plane = PixelContainerType::New();
+    plane->SetImportPointer( this->GetChannelPointer( c ), numberOfPixels, false );
+
+    ChannelImagePointer channel = ChannelImageType::New();
+    channel->CopyInformation( this->m_Geometry );
+    channel->SetBufferedRegion( this->m_Geometry->GetBufferedRegion() );
+    channel->SetRequestedRegion( this->m_Geometry->GetBufferedRegion() );
+    channel->SetPixelContainer( plane );
+    this->m_Channels[ c ] = channel;
+  }
+  this->Modified();
+
+} // end Allocate()
+
+
+/**
+ * ******************* DeinterleaveFrom *******************
+ */
+
+template< class TPixel, unsigned int VImageDimension >
+void
+PlanarVectorImage< TPixel, VImageDimension >
+::DeinterleaveFrom( const VectorImageType * image )
+{
+  this->CopyInformation( image );
+  this->SetNumberOfComponentsPerPixel( image->GetNumberOfComponentsPerPixel() );
+  this->Allocate();
+
+  /** Transpose per block of pixels, so that the interleaved block stays in
+   * the cache while it is scattered over the planes. */
+  const unsigned int numberOfChannels = this->m_NumberOfComponentsPerPixel;
+  const SizeValueType numberOfPixels = this->GetNumberOfPixelsPerChannel();
+  const PixelType * in = image->GetBufferPointer();
+  for( SizeValueType start = 0; start < numberOfPixels; start += BlockSize )
+  {
+    const SizeValueType end = std::min<SizeValueType>( start + BlockSize, numberOfPixels );
+    for( unsigned int c = 0; c < numberOfChannels; ++c )
+    {
+      PixelType * plane = this->GetChannelPointer( c );
+      for( SizeValueType p = start; p < end; ++p )
+      {
+        plane[ p ] = in[ p * numberOfChannels + c ];
+      }
+    }
+  }
+
+  for( unsigned int c = 0; c < numberOfChannels; ++c )
+  {
+    this->m_Channels[ c ]->Modified();
+  }
+
+} // end DeinterleaveFrom()
+
+
+/**
+ * ******************* InterleaveTo *******************
+ */
+
+template< class TPixel, unsigned int VImageDimension >
+void
+PlanarVectorImage< TPixel, VImageDimension >
+::InterleaveTo( VectorImageType * image ) const
+{
+  const unsigned int numberOfChannels = this->m_NumberOfComponentsPerPixel;
+  const SizeValueType numberOfPixels = this->GetNumberOfPixelsPerChannel();
+
+  image->CopyInformation( this->m_Geometry );
+  image->SetBufferedRegion( this->m_Geometry->GetBufferedRegion() );
+  image->SetRequestedRegion( this->m_Geometry->GetBufferedRegion() );
+  image->SetNumberOfComponentsPerPixel( numberOfChannels );
+  image->Allocate();
+
+  /** Gather per block of pixels, so that the interleaved block is written
+   * in the cache, from sequential reads of the planes. */
+  PixelType * out = image->GetBufferPointer();
+  for( SizeValueType start = 0; start < numberOfPixels; start += BlockSize )
+  {
+    const SizeValueType end = std::min<SizeValueType>( start + BlockSize, numberOfPixels );
+    for( unsigned int c = 0; c < numberOfChannels; ++c )
+    {
+      const PixelType * plane = this->GetChannelPointer( c );
+      for( SizeValueType p = start; p < end; ++p )
+      {
+        out[ p * numberOfChannels + c ] = plane[ p ];
+      }
+    }
+  }
+
+} // end InterleaveTo()
+
+
+/**
+ * ******************* ReleaseData *******************
+ */
+
+template< class TPixel, unsigned int VImageDimension >
+void
+PlanarVectorImage< TPixel, VImageDimension >
+::ReleaseData( void )
+{
+  this->m_Channels.clear();
+  this->m_Buffer = 0;
+
+} // end ReleaseData()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template< class TPixel, unsigned int VImageDimension >
+void
+PlanarVectorImage< TPixel, VImageDimension >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "BufferedRegion: "
+    << this->m_Geometry->GetBufferedRegion() << std::endl;
+  os << indent << "NumberOfComponentsPerPixel: "
+    << this->m_NumberOfComponentsPerPixel << std::endl;
+  os << indent << "Allocated: "
+    << ( this->m_Buffer.IsNotNull() ? "true" : "false" ) << std::endl;
+
+} // end PrintSelf()
+
+} // end namespace itk
+
+#endif // end #ifndef __itkPlanarVectorImage_txx
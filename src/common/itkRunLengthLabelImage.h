@@ -0,0 +1,206 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkRunLengthLabelImage_h
+#define __itkRunLengthLabelImage_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkMultiThreader.h"
+#include <map>
+#include <vector>
+
+
+namespace itk
+{
+
+/** \class RunLengthLabelImage
+ * \brief A label image stored as runs of equal labels along dimension 0.
+ *
+ * Every scanline of the region holds the runs of its foreground pixels,
+ * the pixels that differ from the BackgroundValue, as (start, length,
+ * label), in increasing order of the start. The runs of all lines are
+ * stored contiguously, with the offset of the first run of every line,
+ * so that a line with only background costs one offset.
+ *
+ * Encode() scans an image once, in parallel over the lines, and Decode()
+ * writes the runs back into an image. The kernels work on the runs only,
+ * so that their cost scales with the number of runs, not with the number
+ * of pixels:
+ *   - ComputeLabelCounts(): the number of pixels of every label,
+ *   - ComputeIntersectionCounts(): the number of pixels with the same
+ *     label in two encodings, per label, by merging the runs of a line,
+ *   - Vote(): the majority vote of several encodings, into an encoding,
+ *     by sweeping the run boundaries of a line.
+ * Lines without foreground in any input are skipped by the kernels.
+ *
+ * \ingroup DataRepresentation
+ */
+
+template< class TLabelImage >
+class ITK_EXPORT RunLengthLabelImage : public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef RunLengthLabelImage           Self;
+  typedef Object                        Superclass;
+  typedef SmartPointer<Self>            Pointer;
+  typedef SmartPointer<const Self>      ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( RunLengthLabelImage, Object );
+
+  itkStaticConstMacro( ImageDimension, unsigned int, TLabelImage::ImageDimension );
+
+  /** Typedefs. */
+  typedef TLabelImage                             LabelImageType;
+  typedef typename LabelImageType::Pointer        LabelImagePointer;
+  typedef typename LabelImageType::PixelType      LabelType;
+  typedef typename LabelImageType::RegionType     RegionType;
+  typedef typename LabelImageType::IndexType      IndexType;
+  typedef typename LabelImageType::SizeType       SizeType;
+  typedef typename LabelImageType::PointType      PointType;
+  typedef typename LabelImageType::SpacingType    SpacingType;
+  typedef typename LabelImageType::DirectionType  DirectionType;
+
+  /** A run of pixels with the same label along dimension 0; the start is
+   * relative to the first pixel of the line. */
+  struct RunType
+  {
+    SizeValueType Start;
+    SizeValueType Length;
+    LabelType     Label;
+  };
+  typedef std::vector<RunType>                    RunContainerType;
+  typedef std::map<LabelType, SizeValueType>      LabelCountsType;
+
+  /** Set/Get the label that is not stored. Default 0. Set it before Encode(). */
+  itkSetMacro( BackgroundValue, LabelType );
+  itkGetConstMacro( BackgroundValue, LabelType );
+
+  /** Set/Get the number of threads of Encode(). Default the global default. */
+  itkSetMacro( NumberOfThreads, ThreadIdType );
+  itkGetConstMacro( NumberOfThreads, ThreadIdType );
+
+  /** Encode a region of an image, by default its buffered region. The
+   * geometry of the image is kept, for Decode(). */
+  void Encode( const LabelImageType * image );
+  void Encode( const LabelImageType * image, const RegionType & region );
+
+  /** Decode into a new image of the region, with the geometry of the
+   * encoded image. */
+  LabelImagePointer Decode( void ) const;
+
+  /** Decode into the region of an image that buffers it. */
+  void Decode( LabelImageType * image ) const;
+
+  /** The encoded region. */
+  itkGetConstReferenceMacro( Region, RegionType );
+
+  /** The runs of a line, [GetLineBegin(), GetLineEnd()). The lines are
+   * numbered in buffer order. */
+  SizeValueType GetNumberOfLines( void ) const
+  {
+    return this->m_LineOffsets.empty() ? 0 : this->m_LineOffsets.size() - 1;
+  }
+  const RunType * GetLineBegin( SizeValueType line ) const
+  {
+    return this->GetRuns() + this->m_LineOffsets[ line ];
+  }
+  const RunType * GetLineEnd( SizeValueType line ) const
+  {
+    return this->GetRuns() + this->m_LineOffsets[ line + 1 ];
+  }
+  SizeValueType GetNumberOfRuns( void ) const
+  {
+    return this->m_Runs.size();
+  }
+  const RunType * GetRuns( void ) const
+  {
+    return this->m_Runs.empty() ? 0 : &this->m_Runs[ 0 ];
+  }
+
+  /** The index of the first pixel of a line. */
+  IndexType GetLineIndex( SizeValueType line ) const;
+
+  /** The number of foreground pixels. */
+  itkGetConstMacro( NumberOfForegroundPixels, SizeValueType );
+
+  /** Add the number of pixels of every foreground label to counts. */
+  void ComputeLabelCounts( LabelCountsType & counts ) const;
+
+  /** Add the number of pixels that have the same foreground label in a
+   * and b to intersections, per label. The number of pixels that are
+   * foreground in both, whatever their labels, is returned. */
+  static SizeValueType ComputeIntersectionCounts( const Self * a, const Self * b,
+    LabelCountsType & intersections );
+
+  /** The majority vote of the inputs, including the votes for the
+   * background, into output. Ties are broken by the lowest preference,
+   * indexed by the label; labels without a preference lose all ties.
+   * All inputs must encode the same region. */
+  static void Vote( const std::vector<const Self *> & inputs,
+    const std::vector<unsigned int> & preference, Self * output );
+
+protected:
+  RunLengthLabelImage();
+  virtual ~RunLengthLabelImage() {};
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** Start an empty encoding of a region. */
+  void Initialize( const RegionType & region );
+
+  /** The threaded scan over the lines of the region. */
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback( void * arg );
+  void ThreadedEncode( SizeValueType lineBegin, SizeValueType lineEnd,
+    ThreadIdType threadId );
+
+private:
+  RunLengthLabelImage( const Self & ); // purposely not implemented
+  void operator=( const Self & );      // purposely not implemented
+
+  LabelType                   m_BackgroundValue;
+  ThreadIdType                m_NumberOfThreads;
+  MultiThreader::Pointer      m_Threader;
+
+  RegionType                  m_Region;
+  SpacingType                 m_Spacing;
+  PointType                   m_Origin;
+  DirectionType               m_Direction;
+
+  /** The runs of all lines, and the offset of the first run of every
+   * line, followed by the total number of runs. */
+  RunContainerType            m_Runs;
+  std::vector<SizeValueType>  m_LineOffsets;
+  SizeValueType               m_NumberOfForegroundPixels;
+
+  /** The image that is encoded, and the runs found per thread. */
+  const LabelImageType *          m_Image;
+  std::vector<RunContainerType>   m_ThreadRuns;
+
+}; // end class RunLengthLabelImage
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkRunLengthLabelImage.txx"
+#endif
+
+#endif // end #ifndef __itkRunLengthLabelImage_h
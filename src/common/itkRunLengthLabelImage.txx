@@ -0,0 +1,501 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkRunLengthLabelImage_txx
+#define __itkRunLengthLabelImage_txx
+
+#include "itkRunLengthLabelImage.h"
+#include "itkNumericTraits.h"
+#include <algorithm>
+
+
+namespace itk
+{
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template< class TLabelImage >
+RunLengthLabelImage< TLabelImage >
+::RunLengthLabelImage()
+{
+  this->m_BackgroundValue = NumericTraits<LabelType>::Zero;
+  this->m_Threader = MultiThreader::New();
+  this->m_NumberOfThreads = this->m_Threader->GetNumberOfThreads();
+  this->m_Spacing.Fill( 1.0 );
+  this->m_Origin.Fill( 0.0 );
+  this->m_Direction.SetIdentity();
+  this->m_NumberOfForegroundPixels = 0;
+  this->m_Image = 0;
+
+} // end Constructor
+
+
+/**
+ * ******************* Initialize *******************
+ */
+
+template< class TLabelImage >
+void
+RunLengthLabelImage< TLabelImage >
+::Initialize( const RegionType & region )
+{
+  this->m_Region = region;
+  this->m_Runs.clear();
+  this->m_LineOffsets.assign( region.GetNumberOfPixels() == 0 ? 1
+    : region.GetNumberOfPixels() / region.GetSize( 0 ) + 1, 0 );
+  this->m_NumberOfForegroundPixels = 0;
+  this->Modified();
+
+} // end Initialize()
+
+
+/**
+ * ******************* Encode *******************
+ */
+
+template< class TLabelImage >
+void
+RunLengthLabelImage< TLabelImage >
+::Encode( const LabelImageType * image )
+{
+  this->Encode( image, image->GetBufferedRegion() );
+
+} // end Encode()
+
+
+template< class TLabelImage >
+void
+RunLengthLabelImage< TLabelImage >
+::Encode( const LabelImageType * image, const RegionType & region )
+{
+  if( !image->GetBufferedRegion().IsInside( region ) )
+  {
+    itkExceptionMacro( << "ERROR: the region " << region
+      << " is not inside the buffered region of the image." );
+  }
+
+  this->Initialize( region );
+  this->m_Spacing = image->GetSpacing();
+  this->m_Origin = image->GetOrigin();
+  this->m_Direction = image->GetDirection();
+  const SizeValueType numberOfLines = this->GetNumberOfLines();
+  if( region.GetNumberOfPixels() == 0 ) return;
+
+  /** Scan the lines in parallel, every thread into its own runs. The
+   * threads write the number of runs of their lines into the offsets. */
+  this->m_Image = image;
+  const ThreadIdType numberOfThreads = static_cast<ThreadIdType>(
+    std::max<SizeValueType>( 1, std::min<SizeValueType>( this->m_NumberOfThreads, numberOfLines ) ) );
+  this->m_ThreadRuns.assign( numberOfThreads, RunContainerType() );
+  this->m_Threader->SetNumberOfThreads( numberOfThreads );
+  this->m_Threader->SetSingleMethod( Self::ThreaderCallback, this );
+  this->m_Threader->SingleMethodExecute();
+  this->m_Image = 0;
+
+  /** Concatenate the runs of the threads, which are in line order. */
+  for( SizeValueType line = 0; line < numberOfLines; ++line )
+  {
+    this->m_LineOffsets[ line + 1 ] += this->m_LineOffsets[ line ];
+  }
+  this->m_Runs.reserve( this->m_LineOffsets[ numberOfLines ] );
+  for( ThreadIdType t = 0; t < numberOfThreads; ++t )
+  {
+    this->m_Runs.insert( this->m_Runs.end(),
+      this->m_ThreadRuns[ t ].begin(), this->m_ThreadRuns[ t ].end() );
+    RunContainerType().swap( this->m_ThreadRuns[ t ] );
+  }
+  for( SizeValueType r = 0; r < this->m_Runs.size(); ++r )
+  {
+    this->m_NumberOfForegroundPixels += this->m_Runs[ r ].Length;
+  }
+
+} // end Encode()
+
+
+/**
+ * ******************* ThreaderCallback *******************
+ */
+
+template< class TLabelImage >
+ITK_THREAD_RETURN_TYPE
+RunLengthLabelImage< TLabelImage >
+::ThreaderCallback( void * arg )
+{
+  typedef MultiThreader::ThreadInfoStruct ThreadInfoType;
+  ThreadInfoType * info = static_cast<ThreadInfoType *>( arg );
+  Self * encoding = static_cast<Self *>( info->UserData );
+
+  const ThreadIdType threadId = info->ThreadID;
+  const SizeValueType numberOfThreads = info->NumberOfThreads;
+  const SizeValueType numberOfLines = encoding->GetNumberOfLines();
+  encoding->ThreadedEncode(
+    numberOfLines * threadId / numberOfThreads,
+    numberOfLines * ( threadId + 1 ) / numberOfThreads, threadId );
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end ThreaderCallback()
+
+
+/**
+ * ******************* ThreadedEncode *******************
+ */
+
+template< class TLabelImage >
+void
+RunLengthLabelImage< TLabelImage >
+::ThreadedEncode( SizeValueType lineBegin, SizeValueType lineEnd,
+  ThreadIdType threadId )
+{
+  if( lineBegin >= lineEnd ) return;
+
+  const LabelImageType * image = this->m_Image;
+  const LabelType * buffer = image->GetBufferPointer();
+  const IndexType start = this->m_Region.GetIndex();
+  const SizeType size = this->m_Region.GetSize();
+  const SizeValueType lineLength = size[ 0 ];
+  const LabelType background = this->m_BackgroundValue;
+  RunContainerType & runs = this->m_ThreadRuns[ threadId ];
+
+  /** The index of the first line, then stepped as an odometer. */
+  IndexType index = this->GetLineIndex( lineBegin );
+  for( SizeValueType line = lineBegin; line < lineEnd; ++line )
+  {
+    const LabelType * p = buffer + image->ComputeOffset( index );
+    const SizeValueType numberOfRuns = runs.size();
+    SizeValueType i = 0;
+    while( i < lineLength )
+    {
+      const LabelType label = p[ i ];
+      const SizeValueType first = i;
+      while( ++i < lineLength && p[ i ] == label ) {}
+      if( label == background ) continue;
+
+      RunType run;
+      run.Start = first;
+      run.Length = i - first;
+      run.Label = label;
+      runs.push_back( run );
+    }
+    this->m_LineOffsets[ line + 1 ] = runs.size() - numberOfRuns;
+
+    for( unsigned int d = 1; d < ImageDimension; ++d )
+    {
+      if( ++index[ d ] < start[ d ] + static_cast<OffsetValueType>( size[ d ] ) ) break;
+      index[ d ] = start[ d ];
+    }
+  }
+
+} // end ThreadedEncode()
+
+
+/**
+ * ******************* GetLineIndex *******************
+ */
+
+template< class TLabelImage >
+typename RunLengthLabelImage< TLabelImage >::IndexType
+RunLengthLabelImage< TLabelImage >
+::GetLineIndex( SizeValueType line ) const
+{
+  IndexType index = this->m_Region.GetIndex();
+  SizeValueType rest = line;
+  for( unsigned int i = 1; i < ImageDimension; ++i )
+  {
+    index[ i ] += static_cast<OffsetValueType>( rest % this->m_Region.GetSize( i ) );
+    rest /= this->m_Region.GetSize( i );
+  }
+  return index;
+
+} // end GetLineIndex()
+
+
+/**
+ * ******************* Decode *******************
+ */
+
+template< class TLabelImage >
+typename RunLengthLabelImage< TLabelImage >::LabelImagePointer
+RunLengthLabelImage< TLabelImage >
+::Decode( void ) const
+{
+  LabelImagePointer image = LabelImageType::New();
+  image->SetRegions( this->m_Region );
+  image->SetSpacing( this->m_Spacing );
+  image->SetOrigin( this->m_Origin );
+  image->SetDirection( this->m_Direction );
+  image->Allocate();
+  this->Decode( image );
+  return image;
+
+} // end Decode()
+
+
+template< class TLabelImage >
+void
+RunLengthLabelImage< TLabelImage >
+::Decode( LabelImageType * image ) const
+{
+  if( !image->GetBufferedRegion().IsInside( this->m_Region ) )
+  {
+    itkExceptionMacro( << "ERROR: the region " << this->m_Region
+      << " is not inside the buffered region of the image." );
+  }
+
+  LabelType * buffer = image->GetBufferPointer();
+  const SizeValueType lineLength = this->m_Region.GetSize( 0 );
+  const LabelType background = this->m_BackgroundValue;
+  for( SizeValueType line = 0; line < this->GetNumberOfLines(); ++line )
+  {
+    /** Fill the gaps between the runs with the background. */
+    LabelType * out = buffer + image->ComputeOffset( this->GetLineIndex( line ) );
+    SizeValueType position = 0;
+    for( const RunType * run = this->GetLineBegin( line ); run != this->GetLineEnd( line ); ++run )
+    {
+      std::fill( out + position, out + run->Start, background );
+      std::fill( out + run->Start, out + run->Start + run->Length, run->Label );
+      position = run->Start + run->Length;
+    }
+    std::fill( out + position, out + lineLength, background );
+  }
+
+} // end Decode()
+
+
+/**
+ * ******************* ComputeLabelCounts *******************
+ */
+
+template< class TLabelImage >
+void
+RunLengthLabelImage< TLabelImage >
+::ComputeLabelCounts( LabelCountsType & counts ) const
+{
+  for( SizeValueType r = 0; r < this->m_Runs.size(); ++r )
+  {
+    counts[ this->m_Runs[ r ].Label ] += this->m_Runs[ r ].Length;
+  }
+
+} // end ComputeLabelCounts()
+
+
+/**
+ * ******************* ComputeIntersectionCounts *******************
+ *
+ * The runs of a line are merged as sorted lists: the run that ends
+ * first is passed.
+ */
+
+template< class TLabelImage >
+SizeValueType
+RunLengthLabelImage< TLabelImage >
+::ComputeIntersectionCounts( const Self * a, const Self * b,
+  LabelCountsType & intersections )
+{
+  if( a->m_Region != b->m_Region )
+  {
+    itkGenericExceptionMacro( << "ERROR: the encodings have different regions." );
+  }
+
+  SizeValueType foregroundIntersection = 0;
+  for( SizeValueType line = 0; line < a->GetNumberOfLines(); ++line )
+  {
+    const RunType * ra = a->GetLineBegin( line );
+    const RunType * rb = b->GetLineBegin( line );
+    const RunType * enda = a->GetLineEnd( line );
+    const RunType * endb = b->GetLineEnd( line );
+    while( ra != enda && rb != endb )
+    {
+      const SizeValueType lo = std::max( ra->Start, rb->Start );
+      const SizeValueType hia = ra->Start + ra->Length;
+      const SizeValueType hib = rb->Start + rb->Length;
+      const SizeValueType hi = std::min( hia, hib );
+      if( lo < hi )
+      {
+        foregroundIntersection += hi - lo;
+        if( ra->Label == rb->Label ) intersections[ ra->Label ] += hi - lo;
+      }
+      if( hia <= hib ) ++ra;
+      else ++rb;
+    }
+  }
+
+  return foregroundIntersection;
+
+} // end ComputeIntersectionCounts()
+
+
+/**
+ * ******************* Vote *******************
+ *
+ * The run boundaries of all inputs divide a line in segments on which
+ * every input has a single label. The vote is taken once per segment.
+ */
+
+template< class TLabelImage >
+void
+RunLengthLabelImage< TLabelImage >
+::Vote( const std::vector<const Self *> & inputs,
+  const std::vector<unsigned int> & preference, Self * output )
+{
+  if( inputs.empty() )
+  {
+    itkGenericExceptionMacro( << "ERROR: no inputs to vote." );
+  }
+  const Self * first = inputs[ 0 ];
+  for( std::size_t k = 1; k < inputs.size(); ++k )
+  {
+    if( inputs[ k ]->m_Region != first->m_Region
+      || inputs[ k ]->m_BackgroundValue != first->m_BackgroundValue )
+    {
+      itkGenericExceptionMacro( << "ERROR: the encodings have different regions or backgrounds." );
+    }
+  }
+
+  const LabelType background = first->m_BackgroundValue;
+  output->SetBackgroundValue( background );
+  output->Initialize( first->m_Region );
+  output->m_Spacing = first->m_Spacing;
+  output->m_Origin = first->m_Origin;
+  output->m_Direction = first->m_Direction;
+
+  const std::size_t numberOfInputs = inputs.size();
+  const unsigned int noPreference = NumericTraits<unsigned int>::max();
+  std::vector<SizeValueType> boundaries;
+  std::vector<const RunType *> cursors( numberOfInputs );
+  std::vector<LabelType> candidates;
+  std::vector<SizeValueType> votes;
+
+  for( SizeValueType line = 0; line < first->GetNumberOfLines(); ++line )
+  {
+    /** The boundaries of all runs of the line. */
+    boundaries.clear();
+    for( std::size_t k = 0; k < numberOfInputs; ++k )
+    {
+      cursors[ k ] = inputs[ k ]->GetLineBegin( line );
+      for( const RunType * run = cursors[ k ]; run != inputs[ k ]->GetLineEnd( line ); ++run )
+      {
+        boundaries.push_back( run->Start );
+        boundaries.push_back( run->Start + run->Length );
+      }
+    }
+    std::sort( boundaries.begin(), boundaries.end() );
+    boundaries.erase( std::unique( boundaries.begin(), boundaries.end() ), boundaries.end() );
+
+    for( std::size_t b = 0; b + 1 < boundaries.size(); ++b )
+    {
+      const SizeValueType lo = boundaries[ b ];
+      const SizeValueType hi = boundaries[ b + 1 ];
+
+      /** Collect the votes of the segment; the remaining inputs vote
+       * for the background. */
+      candidates.clear();
+      votes.clear();
+      SizeValueType foregroundVotes = 0;
+      for( std::size_t k = 0; k < numberOfInputs; ++k )
+      {
+        const RunType * end = inputs[ k ]->GetLineEnd( line );
+        while( cursors[ k ] != end && cursors[ k ]->Start + cursors[ k ]->Length <= lo )
+        {
+          ++cursors[ k ];
+        }
+        if( cursors[ k ] == end || cursors[ k ]->Start > lo ) continue;
+
+        const LabelType label = cursors[ k ]->Label;
+        const std::size_t c = std::find( candidates.begin(), candidates.end(), label )
+          - candidates.begin();
+        if( c == candidates.size() )
+        {
+          candidates.push_back( label );
+          votes.push_back( 0 );
+        }
+        ++votes[ c ];
+        ++foregroundVotes;
+      }
+      if( foregroundVotes == 0 ) continue;
+      if( foregroundVotes < numberOfInputs )
+      {
+        candidates.push_back( background );
+        votes.push_back( numberOfInputs - foregroundVotes );
+      }
+
+      /** The most votes win, then the lowest preference, then the lowest label. */
+      std::size_t winner = 0;
+      for( std::size_t c = 1; c < candidates.size(); ++c )
+      {
+        const std::size_t lw = static_cast<std::size_t>( candidates[ winner ] );
+        const std::size_t lc = static_cast<std::size_t>( candidates[ c ] );
+        const unsigned int pw = lw < preference.size() ? preference[ lw ] : noPreference;
+        const unsigned int pc = lc < preference.size() ? preference[ lc ] : noPreference;
+        if( votes[ c ] > votes[ winner ]
+          || ( votes[ c ] == votes[ winner ]
+          && ( pc < pw || ( pc == pw && candidates[ c ] < candidates[ winner ] ) ) ) )
+        {
+          winner = c;
+        }
+      }
+      const LabelType label = candidates[ winner ];
+      if( label == background ) continue;
+
+      /** Extend the last run of the line, or start a new one. */
+      RunContainerType & runs = output->m_Runs;
+      if( runs.size() > output->m_LineOffsets[ line ]
+        && runs.back().Label == label && runs.back().Start + runs.back().Length == lo )
+      {
+        runs.back().Length += hi - lo;
+      }
+      else
+      {
+        RunType run;
+        run.Start = lo;
+        run.Length = hi - lo;
+        run.Label = label;
+        runs.push_back( run );
+      }
+      output->m_NumberOfForegroundPixels += hi - lo;
+    }
+    output->m_LineOffsets[ line + 1 ] = output->m_Runs.size();
+  }
+
+} // end Vote()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template< class TLabelImage >
+void
+RunLengthLabelImage< TLabelImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "BackgroundValue: "
+    << static_cast<typename NumericTraits<LabelType>::PrintType>( this->m_BackgroundValue ) << std::endl;
+  os << indent << "NumberOfThreads: " << this->m_NumberOfThreads << std::endl;
+  os << indent << "Region: " << this->m_Region << std::endl;
+  os << indent << "NumberOfRuns: " << this->m_Runs.size() << std::endl;
+  os << indent << "NumberOfForegroundPixels: " << this->m_NumberOfForegroundPixels << std::endl;
+
+} // end PrintSelf()
+
+} // end namespace itk
+
+#endif // end #ifndef __itkRunLengthLabelImage_txx
@@ -19,8 +19,9 @@
 #define __itkTransformixInputPointFileReader_h_
 
 #include "itkMeshFileReaderBase.h"
+#include "ITKToolsMemoryMapping.h"
 
-#include <fstream>
+#include <string>
 
 namespace itk
 {
@@ -39,6 +40,15 @@ namespace itk
    *
    * The second word in the text file represents the number of points that
    * should be read.
+   *
+   * The file is memory mapped when possible, and the coordinates are parsed
+   * in bulk, without iostreams and independent of the locale, directly into
+   * a point container with the capacity for all points.
+   *
+   * Large point sets can also be stored in binary: the header line
+   * "binary point <n>" or "binary index <n>", ended by a single newline,
+   * followed by the n * dimension coordinates as doubles in the byte order
+   * of the machine, x0 y0 z0 x1 y1 z1 ...
    **/
 
   template <class TOutputMesh>
@@ -78,6 +88,9 @@ namespace itk
      * seems logic to store this kind of data in the inheriting reader classes. */
     itkGetConstMacro(NumberOfPoints, unsigned long);
 
+    /** Get whether the file is a binary point file. */
+    itkGetConstMacro(IsBinary, bool);
+
     /** Prepare the allocation of the output mesh during the first back
      * propagation of the pipeline. Updates the PointsAreIndices and NumberOfPoints. */
     virtual void GenerateOutputInformation( void );
@@ -89,10 +102,18 @@ namespace itk
     /** Fill the point container of the output. */
     virtual void GenerateData( void );
 
+    /** Get the next token in [m_Position, m_End), separated by white space. */
+    bool GetNextToken( const char * & tokenBegin, const char * & tokenEnd );
+
     unsigned long m_NumberOfPoints;
     bool m_PointsAreIndices;
+    bool m_IsBinary;
 
-    std::ifstream m_Reader;
+    /** The contents of the file, mapped or read, and the parse position. */
+    itktools::MemoryMappedFile m_MappedFile;
+    std::string m_Contents;
+    const char * m_Position;
+    const char * m_End;
 
   private:
     TransformixInputPointFileReader(const Self&); //purposely not implemented
@@ -0,0 +1,273 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkTransformixInputPointFileReader_hxx_
+#define __itkTransformixInputPointFileReader_hxx_
+
+#include "itkTransformixInputPointFileReader.h"
+#include "ITKToolsColumnReader.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace itk
+{
+
+  /**
+   * **************** Constructor ***************
+   */
+  template <class TOutputMesh>
+  TransformixInputPointFileReader<TOutputMesh>
+  ::TransformixInputPointFileReader()
+  {
+    this->m_NumberOfPoints = 0;
+    this->m_PointsAreIndices = false;
+    this->m_IsBinary = false;
+    this->m_Position = 0;
+    this->m_End = 0;
+
+  } // end constructor
+
+
+  /**
+   * **************** Destructor ***************
+   */
+  template <class TOutputMesh>
+  TransformixInputPointFileReader<TOutputMesh>
+  ::~TransformixInputPointFileReader()
+  {
+    this->m_MappedFile.Close();
+
+  } // end constructor
+
+
+  /**
+   * ***************GetNextToken ***********
+   */
+
+  template <class TOutputMesh>
+  bool
+  TransformixInputPointFileReader<TOutputMesh>
+  ::GetNextToken( const char * & tokenBegin, const char * & tokenEnd )
+  {
+    const char * p = this->m_Position;
+    while( p != this->m_End
+      && ( *p == ' ' || *p == '\t' || *p == '\r' || *p == '\n' ) ) ++p;
+    tokenBegin = p;
+    while( p != this->m_End
+      && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n' ) ++p;
+    tokenEnd = p;
+    this->m_Position = p;
+    return tokenBegin != tokenEnd;
+
+  } // end GetNextToken()
+
+
+  /**
+   * ***************GenerateOutputInformation ***********
+   */
+
+  template <class TOutputMesh>
+  void
+  TransformixInputPointFileReader<TOutputMesh>
+  ::GenerateOutputInformation( void )
+  {
+    this->Superclass::GenerateOutputInformation();
+
+    /** The superclass tests already if it's a valid file. Map it, or read
+     * it if that fails, e.g. for an empty file. */
+    this->m_MappedFile.Close();
+    this->m_Contents.clear();
+    if( this->m_MappedFile.Open( this->m_FileName ) )
+    {
+      this->m_Position = this->m_MappedFile.GetPointer();
+      this->m_End = this->m_Position + this->m_MappedFile.GetSize();
+    }
+    else
+    {
+      std::ifstream file( this->m_FileName.c_str(), std::ios::in | std::ios::binary );
+      this->m_Contents.assign( std::istreambuf_iterator<char>( file ),
+        std::istreambuf_iterator<char>() );
+      this->m_Position = this->m_Contents.data();
+      this->m_End = this->m_Position + this->m_Contents.size();
+    }
+
+    /** Read the first entry */
+    const char * tokenBegin = 0;
+    const char * tokenEnd = 0;
+    this->GetNextToken( tokenBegin, tokenEnd );
+    std::string indexOrPoint( tokenBegin, tokenEnd );
+
+    this->m_IsBinary = indexOrPoint == "binary";
+    if( this->m_IsBinary )
+    {
+      this->GetNextToken( tokenBegin, tokenEnd );
+      indexOrPoint.assign( tokenBegin, tokenEnd );
+    }
+
+    /** Set the IsIndex bool and the number of points.*/
+    if( indexOrPoint == "point" || indexOrPoint == "index" )
+    {
+      /** Input points are specified in world coordinates or as image indices. */
+      this->m_PointsAreIndices = indexOrPoint == "index";
+      this->GetNextToken( tokenBegin, tokenEnd );
+      this->m_NumberOfPoints = atol( std::string( tokenBegin, tokenEnd ).c_str() );
+    }
+    else if( !this->m_IsBinary )
+    {
+      /** Input points are assumed to be specified as image indices. */
+      this->m_PointsAreIndices = true;
+      this->m_NumberOfPoints = atol( indexOrPoint.c_str() );
+    }
+    else
+    {
+      std::ostringstream msg;
+      msg << "A binary point file should start with \"binary point\" or \"binary index\". "
+        << std::endl << "Filename: " << this->m_FileName
+        << std::endl;
+      MeshFileReaderException e( __FILE__, __LINE__, msg.str().c_str(), ITK_LOCATION );
+      throw e;
+    }
+
+    /** The binary data starts after the newline of the header line. */
+    if( this->m_IsBinary && this->m_Position != this->m_End )
+    {
+      if( *this->m_Position == '\r' ) ++this->m_Position;
+      if( this->m_Position != this->m_End && *this->m_Position == '\n' ) ++this->m_Position;
+    }
+
+    /** Leave the file open for the generate data method */
+
+  }  // end GenerateOutputInformation
+
+
+  /**
+   * ***************GenerateData ***********
+   */
+
+  template <class TOutputMesh>
+  void
+  TransformixInputPointFileReader<TOutputMesh>
+  ::GenerateData()
+  {
+    typedef typename OutputMeshType::PointsContainer  PointsContainerType;
+    typedef typename PointsContainerType::Pointer     PointsContainerPointer;
+    typedef typename OutputMeshType::PointType        PointType;
+    typedef typename PointType::ValueType             CoordinateType;
+    const unsigned int dimension = OutputMeshType::PointDimension;
+
+    OutputMeshPointer output = this->GetOutput();
+
+    PointsContainerPointer points = PointsContainerType::New();
+    points->reserve( this->m_NumberOfPoints );
+
+    if( this->m_Position == 0 )
+    {
+      std::ostringstream msg;
+      msg <<"The file has unexpectedly been closed. "
+          << std::endl << "Filename: " << this->m_FileName
+          << std::endl;
+      MeshFileReaderException e(__FILE__, __LINE__,msg.str().c_str(),ITK_LOCATION);
+      throw e;
+    }
+
+    if( this->m_IsBinary )
+    {
+      /** Copy the doubles, the data need not be aligned. */
+      const std::size_t numberOfBytes
+        = this->m_NumberOfPoints * dimension * sizeof( double );
+      if( static_cast<std::size_t>( this->m_End - this->m_Position ) < numberOfBytes )
+      {
+        std::ostringstream msg;
+        msg <<"The file is not large enough. "
+          << std::endl << "Filename: " << this->m_FileName
+          << std::endl;
+        MeshFileReaderException e(__FILE__, __LINE__,msg.str().c_str(),ITK_LOCATION);
+        throw e;
+      }
+      const char * p = this->m_Position;
+      for( unsigned long i = 0; i < this->m_NumberOfPoints; ++i )
+      {
+        double coordinates[ dimension ];
+        std::memcpy( coordinates, p, sizeof( coordinates ) );
+        p += sizeof( coordinates );
+        PointType point;
+        for( unsigned int j = 0; j < dimension; ++j )
+        {
+          point[ j ] = static_cast<CoordinateType>( coordinates[ j ] );
+        }
+        points->push_back( point );
+      }
+    }
+    else
+    {
+      const char * tokenBegin = 0;
+      const char * tokenEnd = 0;
+      for( unsigned long i = 0; i < this->m_NumberOfPoints; ++i )
+      {
+        //read point from textfile
+        PointType point;
+        for( unsigned int j = 0; j < dimension; j++ )
+        {
+          double value = 0.0;
+          if( !this->GetNextToken( tokenBegin, tokenEnd ) )
+          {
+            std::ostringstream msg;
+            msg <<"The file is not large enough. "
+              << std::endl << "Filename: " << this->m_FileName
+              << std::endl;
+            MeshFileReaderException e(__FILE__, __LINE__,msg.str().c_str(),ITK_LOCATION);
+            throw e;
+          }
+          if( !itktools::ParseNumber( tokenBegin, tokenEnd, value ) )
+          {
+            std::ostringstream msg;
+            msg << "\"" << std::string( tokenBegin, tokenEnd ) << "\" is not a number. "
+              << std::endl << "Filename: " << this->m_FileName
+              << std::endl;
+            MeshFileReaderException e(__FILE__, __LINE__,msg.str().c_str(),ITK_LOCATION);
+            throw e;
+          }
+          point[ j ] = static_cast<CoordinateType>( value );
+        }
+        points->push_back(point);
+      }
+    }
+
+    /** set in output */
+    output->Initialize();
+    output->SetPoints( points );
+
+    /** Close the file */
+    this->m_MappedFile.Close();
+    this->m_Contents.clear();
+    this->m_Position = 0;
+    this->m_End = 0;
+
+    /** This indicates that the current BufferedRegion is equal to the
+     * requested region. This action prevents useless re-executions of
+     * the pipeline.
+     * (I copied this from the BinaryMaskToNarrowBandPointSetFilter) */
+    output->SetBufferedRegion( output->GetRequestedRegion() );
+
+  } // end GenerateData
+
+
+} // end namespace itk
+
+#endif // end #ifndef __itkTransformixInputPointFileReader_hxx_
@@ -0,0 +1,111 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkVectorMagnitudeImageAdaptor_h
+#define __itkVectorMagnitudeImageAdaptor_h
+
+#include "itkImageAdaptor.h"
+#include "vnl/vnl_math.h"
+
+
+namespace itk
+{
+
+namespace Accessor
+{
+
+/** \class VectorMagnitudePixelAccessor
+ * \brief Give access to the magnitude of a vector pixel.
+ *
+ * The magnitude is computed on every access; it cannot be set.
+ * The number of components is a compile time constant, so the loop
+ * over the components is unrolled by the compiler.
+ */
+
+template< class TVectorPixelType, class TOutputPixelType >
+class ITK_EXPORT VectorMagnitudePixelAccessor
+{
+public:
+  /** Standard typedefs. */
+  typedef VectorMagnitudePixelAccessor    Self;
+
+  /** External and internal typedefs. */
+  typedef TOutputPixelType    ExternalType;
+  typedef TVectorPixelType    InternalType;
+
+  inline void Set( InternalType &, const ExternalType & ) const
+  {
+    itkGenericExceptionMacro( << "The vector magnitude is read only." );
+  }
+
+  inline ExternalType Get( const InternalType & input ) const
+  {
+    double sumOfSquares = 0.0;
+    for( unsigned int i = 0; i < InternalType::Dimension; ++i )
+    {
+      const double component = static_cast<double>( input[ i ] );
+      sumOfSquares += component * component;
+    }
+    return static_cast<ExternalType>( vcl_sqrt( sumOfSquares ) );
+  }
+
+}; // end class VectorMagnitudePixelAccessor
+
+} // end namespace Accessor
+
+
+/** \class VectorMagnitudeImageAdaptor
+ * \brief Presents an image of itk::Vector pixels as a scalar image of
+ * their magnitudes, without allocating that scalar image.
+ *
+ * This gives the same values as the GradientToMagnitudeImageFilter, for
+ * consumers that only read the pixels, like statistics filters.
+ */
+
+template< class TImage, class TOutputPixelType >
+class ITK_EXPORT VectorMagnitudeImageAdaptor
+  : public ImageAdaptor< TImage,
+    Accessor::VectorMagnitudePixelAccessor< typename TImage::PixelType, TOutputPixelType > >
+{
+public:
+  /** Standard class typedefs. */
+  typedef VectorMagnitudeImageAdaptor   Self;
+  typedef ImageAdaptor< TImage,
+    Accessor::VectorMagnitudePixelAccessor<
+    typename TImage::PixelType, TOutputPixelType > > Superclass;
+  typedef SmartPointer< Self >          Pointer;
+  typedef SmartPointer< const Self >    ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( VectorMagnitudeImageAdaptor, ImageAdaptor );
+
+protected:
+  VectorMagnitudeImageAdaptor() {}
+  virtual ~VectorMagnitudeImageAdaptor() {}
+
+private:
+  VectorMagnitudeImageAdaptor( const Self & ); // purposely not implemented
+  void operator=( const Self & ); // purposely not implemented
+
+}; // end class VectorMagnitudeImageAdaptor
+
+} // end namespace itk
+
+#endif // end #ifndef __itkVectorMagnitudeImageAdaptor_h
@@ -114,6 +114,7 @@ int main( int argc, char **argv )
     /** Set the filter arguments. */
     filter->m_InputFileName = inputFileName;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
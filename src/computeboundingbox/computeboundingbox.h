@@ -20,9 +20,8 @@
 
 #include "ITKToolsBase.h"
 
-#include "itkImageRegionConstIteratorWithIndex.h"
-#include "itkImageFileReader.h"
-#include "vnl/vnl_math.h"
+#include "itkBoundingBoxImageCalculator.h"
+#include "ITKToolsMemoryMapping.h"
 
 
 /** \class ITKToolsComputeBoundingBoxBase
@@ -72,48 +71,23 @@ public:
   {
     /** Typedefs. */
     typedef itk::Image<TComponentType, VDimension>      InputImageType;
-    typedef itk::ImageFileReader< InputImageType >      ReaderType;
-    typedef itk::ImageRegionConstIteratorWithIndex<
-      InputImageType>                                   IteratorType;
-    typedef typename InputImageType::PixelType          PixelType;
+    typedef itk::BoundingBoxImageCalculator<
+      InputImageType>                                   CalculatorType;
     typedef typename InputImageType::IndexType          IndexType;
     typedef typename InputImageType::PointType          PointType;
-    const unsigned int dimension = InputImageType::GetImageDimension();
-
-    /** Declarations */
-    typename ReaderType::Pointer reader = ReaderType::New();
-    typename InputImageType::Pointer image;
-    IndexType minIndex;
-    IndexType maxIndex;
-
-    /** Read input image */
-    reader->SetFileName( this->m_InputFileName.c_str() );
-    reader->Update();
-    image = reader->GetOutput();
-
-    /** Define iterator on input image */
-    IteratorType iterator( image, image->GetLargestPossibleRegion() );
-
-    /** Initialize the two corner points */
-    iterator.GoToReverseBegin();
-    minIndex = iterator.GetIndex();
-    iterator.GoToBegin();
-    maxIndex = iterator.GetIndex();
-    PixelType zero = itk::NumericTraits< PixelType>::Zero;
-
-    while ( ! iterator.IsAtEnd() )
-    {
-      if( iterator.Get() > zero )
-      {
-        const IndexType & index = iterator.GetIndex();
-        for( unsigned int i = 0; i < dimension; ++i )
-        {
-          minIndex[ i ] = vnl_math_min( index[ i ], minIndex[ i ] );
-          maxIndex[ i ] = vnl_math_max( index[ i ], maxIndex[ i ] );
-        }
-      }
-      ++iterator;
-    }
+
+    /** Read input image, memory mapped if possible. */
+    typename InputImageType::Pointer image
+      = itktools::ReadImage<InputImageType>( this->m_InputFileName );
+
+    /** Compute the bounding box of the pixels > 0, multithreaded,
+     * scanning inward from the faces.
+     */
+    typename CalculatorType::Pointer calculator = CalculatorType::New();
+    calculator->SetImage( image );
+    calculator->Compute();
+    const IndexType minIndex = calculator->GetMinimumIndex();
+    const IndexType maxIndex = calculator->GetMaximumIndex();
 
     PointType minPoint;
     PointType maxPoint;
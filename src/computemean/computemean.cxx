@@ -79,6 +79,9 @@ int main( int argc, char *argv[] )
     return EXIT_SUCCESS;
   }
 
+  /** Threading. */
+  itktools::ReadThreadingArguments( parser );
+
   /** Get arguments. */
   std::string inputTextFile = "";
   parser->GetCommandLineArgument( "-in", inputTextFile );
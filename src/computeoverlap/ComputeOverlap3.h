@@ -35,13 +35,17 @@ class ITKToolsComputeOverlap3Base : public itktools::ITKToolsBase
 {
 public:
   /** Constructor. */
-  ITKToolsComputeOverlap3Base(){};
+  ITKToolsComputeOverlap3Base()
+  {
+    this->m_PrintConfusionMatrix = false;
+  };
   /** Destructor. */
   ~ITKToolsComputeOverlap3Base(){};
 
   /** Input member parameters */
   std::vector<std::string> m_InputFileNames;
   std::vector<unsigned int> m_Labels;
+  bool m_PrintConfusionMatrix;
 
 }; // end ITKToolsComputeOverlap3Base
 
@@ -95,7 +99,14 @@ public:
     diceFilter->Update();
 
     /** Print the results. */
-    diceFilter->PrintRequestedDiceOverlaps();
+    if( this->m_PrintConfusionMatrix )
+    {
+      diceFilter->PrintRequestedOverlapMetrics();
+    }
+    else
+    {
+      diceFilter->PrintRequestedDiceOverlaps();
+    }
 
   } // end Run()
 
@@ -0,0 +1,331 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __ComputeOverlapAllPairs_h_
+#define __ComputeOverlapAllPairs_h_
+
+#include "itkImageFileReader.h"
+#include "itkMultiThreader.h"
+#include "itkRunLengthLabelImage.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+
+/** \class ITKToolsComputeOverlapAllPairsBase
+ *
+ * Untemplated pure virtual base class that holds
+ * the Run() function and all required parameters.
+ */
+
+class ITKToolsComputeOverlapAllPairsBase : public itktools::ITKToolsBase
+{
+public:
+  /** Constructor. */
+  ITKToolsComputeOverlapAllPairsBase()
+  {
+    this->m_OutputFileName = "";
+  };
+  /** Destructor. */
+  ~ITKToolsComputeOverlapAllPairsBase(){};
+
+  /** Input member parameters */
+  std::vector<std::string> m_InputFileNames;
+  std::vector<unsigned int> m_Labels;
+  std::string m_OutputFileName;
+
+  /** The images are read slab by slab when streaming. */
+  virtual bool GetSupportsStreaming( void ) const { return true; }
+
+}; // end ITKToolsComputeOverlapAllPairsBase
+
+
+/** \class ITKToolsComputeOverlapAllPairs
+ *
+ * Templated class that implements the Run() function
+ * and the New() function for its creation.
+ *
+ * The Dice overlap of the labels is computed for all pairs of the
+ * segmentations in m_InputFileNames. Every segmentation is read once,
+ * or slab by slab when streaming, and run-length encoded, see
+ * itk::RunLengthLabelImage. The label counts follow from the runs of
+ * every image, and the intersection counts of all pairs from merging
+ * the runs of both images, in parallel over the pairs, so that the cost
+ * of the pairs scales with the number of runs instead of the pixels.
+ */
+
+template< unsigned int VDimension, class TComponentType >
+class ITKToolsComputeOverlapAllPairs : public ITKToolsComputeOverlapAllPairsBase
+{
+public:
+  /** Standard ITKTools stuff. */
+  typedef ITKToolsComputeOverlapAllPairs Self;
+  itktoolsOneTypeNewMacro( Self );
+
+  ITKToolsComputeOverlapAllPairs(){};
+  ~ITKToolsComputeOverlapAllPairs(){};
+
+  /** Typedef's. */
+  typedef TComponentType                              PixelType;
+  typedef itk::Image<PixelType, VDimension>           ImageType;
+  typedef typename ImageType::Pointer                 ImagePointer;
+  typedef typename ImageType::RegionType              RegionType;
+  typedef itk::ImageFileReader<ImageType>             ImageReaderType;
+  typedef itk::RunLengthLabelImage<ImageType>        EncodingType;
+  typedef typename EncodingType::Pointer              EncodingPointer;
+  typedef typename EncodingType::LabelCountsType      LabelCountsType;
+  typedef std::vector<std::size_t>                    CountsType;
+  typedef std::map<long, CountsType>                  CountsMapType;
+
+  /** Run function. */
+  void Run( void )
+  {
+    const std::size_t numberOfImages = this->m_InputFileNames.size();
+    const std::size_t numberOfPairs = numberOfImages * ( numberOfImages - 1 ) / 2;
+    if( numberOfImages < 2 )
+    {
+      itkGenericExceptionMacro( << "ERROR: at least two segmentations are needed." );
+    }
+
+    /** Determine the slabs; they span the full image in all but the last dimension. */
+    typename ImageReaderType::Pointer informationReader = ImageReaderType::New();
+    informationReader->SetFileName( this->m_InputFileNames[ 0 ].c_str() );
+    informationReader->UpdateOutputInformation();
+    const RegionType region = informationReader->GetOutput()->GetLargestPossibleRegion();
+    const unsigned int numberOfSlabs = this->GetNumberOfStreams(
+      static_cast<double>( region.GetNumberOfPixels() )
+      * numberOfImages * sizeof( PixelType ) / 1048576.0 );
+
+    const unsigned int lastDimension = VDimension - 1;
+    const unsigned int lastSize = region.GetSize()[ lastDimension ];
+    std::vector< RegionType > slabs(
+      std::max( 1u, std::min( numberOfSlabs, lastSize ) ), region );
+    for( unsigned int s = 0; s < slabs.size(); ++s )
+    {
+      const unsigned int begin = static_cast<unsigned int>(
+        static_cast<unsigned long long>( lastSize ) * s / slabs.size() );
+      const unsigned int end = static_cast<unsigned int>(
+        static_cast<unsigned long long>( lastSize ) * ( s + 1 ) / slabs.size() );
+      slabs[ s ].SetIndex( lastDimension, region.GetIndex()[ lastDimension ] + begin );
+      slabs[ s ].SetSize( lastDimension, end - begin );
+    }
+
+    /** Per label: the number of pixels in every image, followed by the
+     * number of pixels having that label in both images of every pair. */
+    CountsMapType counts;
+    const std::size_t stride = numberOfImages + numberOfPairs;
+    const long background = 0;
+
+    for( unsigned int s = 0; s < slabs.size(); ++s )
+    {
+      if( slabs.size() > 1 )
+      {
+        std::cout << "Processing slab " << s + 1 << " of " << slabs.size() << std::endl;
+      }
+      const std::size_t numberOfPixels = slabs[ s ].GetNumberOfPixels();
+      if( numberOfPixels == 0 ) continue;
+
+      /** Read and run-length encode the slab of every image, and count
+       * its labels from the runs. Only the encodings are kept. */
+      ThreadStruct str;
+      str.Encodings.resize( numberOfImages );
+      for( std::size_t i = 0; i < numberOfImages; ++i )
+      {
+        ImagePointer image = this->ReadSlab( this->m_InputFileNames[ i ], region, slabs[ s ] );
+        str.Encodings[ i ] = EncodingType::New();
+        str.Encodings[ i ]->Encode( image );
+
+        LabelCountsType labelCounts;
+        str.Encodings[ i ]->ComputeLabelCounts( labelCounts );
+        for( typename LabelCountsType::const_iterator it = labelCounts.begin(); it != labelCounts.end(); ++it )
+        {
+          AddCount( counts, static_cast<long>( it->first ), stride, i, it->second );
+        }
+        AddCount( counts, background, stride, i,
+          numberOfPixels - str.Encodings[ i ]->GetNumberOfForegroundPixels() );
+      }
+
+      /** Intersect the runs of all pairs, in parallel over the pairs. */
+      str.Intersections.assign( numberOfPairs, LabelCountsType() );
+      str.ForegroundIntersections.assign( numberOfPairs, 0 );
+      itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+      threader->SetSingleMethod( Self::IntersectThreaderCallback, &str );
+      threader->SingleMethodExecute();
+
+      /** Both images of a pair are background outside the union of their
+       * foregrounds. */
+      std::size_t pair = 0;
+      for( std::size_t i = 0; i < numberOfImages; ++i )
+      {
+        const std::size_t foreground1 = str.Encodings[ i ]->GetNumberOfForegroundPixels();
+        for( std::size_t j = i + 1; j < numberOfImages; ++j, ++pair )
+        {
+          const LabelCountsType & intersections = str.Intersections[ pair ];
+          for( typename LabelCountsType::const_iterator it = intersections.begin(); it != intersections.end(); ++it )
+          {
+            AddCount( counts, static_cast<long>( it->first ), stride, numberOfImages + pair, it->second );
+          }
+          const std::size_t foreground2 = str.Encodings[ j ]->GetNumberOfForegroundPixels();
+          AddCount( counts, background, stride, numberOfImages + pair,
+            numberOfPixels + str.ForegroundIntersections[ pair ] - foreground1 - foreground2 );
+        }
+      }
+    } // end for slabs
+
+    this->WriteTable( counts );
+
+  } // end Run()
+
+protected:
+
+  /** The data shared by the threads intersecting a slab. */
+  struct ThreadStruct
+  {
+    std::vector<EncodingPointer>  Encodings;
+    std::vector<LabelCountsType>  Intersections;
+    std::vector<std::size_t>      ForegroundIntersections;
+  };
+
+  /** Intersect a contiguous range of the pairs (i,j), i < j. */
+  static ITK_THREAD_RETURN_TYPE IntersectThreaderCallback( void * arg )
+  {
+    typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+    ThreadInfoType * info = static_cast<ThreadInfoType *>( arg );
+    ThreadStruct * str = static_cast<ThreadStruct *>( info->UserData );
+    const std::size_t threadId = info->ThreadID;
+    const std::size_t numberOfThreads = info->NumberOfThreads;
+
+    const std::size_t numberOfImages = str->Encodings.size();
+    const std::size_t numberOfPairs = str->Intersections.size();
+    const std::size_t begin = numberOfPairs * threadId / numberOfThreads;
+    const std::size_t end = numberOfPairs * ( threadId + 1 ) / numberOfThreads;
+
+    std::size_t pair = 0;
+    for( std::size_t i = 0; i < numberOfImages; ++i )
+    {
+      for( std::size_t j = i + 1; j < numberOfImages; ++j, ++pair )
+      {
+        if( pair < begin || pair >= end ) continue;
+        str->ForegroundIntersections[ pair ] = EncodingType::ComputeIntersectionCounts(
+          str->Encodings[ i ], str->Encodings[ j ], str->Intersections[ pair ] );
+      }
+    }
+
+    return ITK_THREAD_RETURN_VALUE;
+  } // end IntersectThreaderCallback()
+
+
+  /** Add a count to a column of the counts of a label, if it is not zero. */
+  static void AddCount( CountsMapType & counts, const long label,
+    const std::size_t stride, const std::size_t column, const std::size_t count )
+  {
+    if( count == 0 ) return;
+    CountsType & total = counts[ label ];
+    total.resize( stride, 0 );
+    total[ column ] += count;
+  } // end AddCount()
+
+
+  /** Read a slab of a segmentation, checking that it matches the first one. */
+  ImagePointer ReadSlab( const std::string & fileName,
+    const RegionType & region, const RegionType & slab ) const
+  {
+    typename ImageReaderType::Pointer reader = ImageReaderType::New();
+    reader->SetFileName( fileName.c_str() );
+    reader->UpdateOutputInformation();
+    if( reader->GetOutput()->GetLargestPossibleRegion() != region )
+    {
+      itkGenericExceptionMacro( << "ERROR: the segmentation " << fileName
+        << " does not have the same size as " << this->m_InputFileNames[ 0 ] << "." );
+    }
+
+    ImagePointer image = reader->GetOutput();
+    image->SetRequestedRegion( slab );
+    image->Update();
+    image->DisconnectPipeline();
+
+    return image;
+  } // end ReadSlab()
+
+
+  /** Write one line per pair and label:
+   *   image1 image2 label size1 size2 intersection dice
+   * where the images are indices into the list of file names, which
+   * is written as a header. By default the labels of both images of a
+   * pair are listed, except the background 0; with m_Labels only those.
+   */
+  void WriteTable( const CountsMapType & counts ) const
+  {
+    const std::size_t numberOfImages = this->m_InputFileNames.size();
+
+    std::ofstream file;
+    if( this->m_OutputFileName != "" )
+    {
+      file.open( this->m_OutputFileName.c_str() );
+      if( !file.is_open() )
+      {
+        itkGenericExceptionMacro( << "ERROR: could not open " << this->m_OutputFileName );
+      }
+    }
+    std::ostream & out = this->m_OutputFileName != "" ? file : std::cout;
+
+    const std::set<long> requestedLabels( this->m_Labels.begin(), this->m_Labels.end() );
+    std::set<long> labels( requestedLabels );
+    if( requestedLabels.size() == 0 )
+    {
+      for( typename CountsMapType::const_iterator it = counts.begin(); it != counts.end(); ++it )
+      {
+        if( it->first != 0 ) labels.insert( it->first );
+      }
+    }
+    for( std::size_t i = 0; i < numberOfImages; ++i )
+    {
+      out << "# " << i << " " << this->m_InputFileNames[ i ] << "\n";
+    }
+    out << "# image1 image2 label size1 size2 intersection dice\n";
+    out << std::fixed << std::showpoint << std::setprecision( 6 );
+
+    std::size_t pair = numberOfImages;
+    for( std::size_t i = 0; i < numberOfImages; ++i )
+    {
+      for( std::size_t j = i + 1; j < numberOfImages; ++j, ++pair )
+      {
+        for( std::set<long>::const_iterator it = labels.begin(); it != labels.end(); ++it )
+        {
+          typename CountsMapType::const_iterator c = counts.find( *it );
+          const std::size_t size1 = c != counts.end() ? c->second[ i ] : 0;
+          const std::size_t size2 = c != counts.end() ? c->second[ j ] : 0;
+          const std::size_t intersection = c != counts.end() ? c->second[ pair ] : 0;
+          if( size1 + size2 == 0 && requestedLabels.size() == 0 ) continue;
+
+          const double dice = size1 + size2 > 0
+            ? 2.0 * intersection / static_cast<double>( size1 + size2 ) : 0.0;
+          out << i << " " << j << " " << *it << " " << size1 << " " << size2
+            << " " << intersection << " " << dice << "\n";
+        }
+      }
+    }
+  } // end WriteTable()
+
+}; // end class ITKToolsComputeOverlapAllPairs
+
+#endif // end #ifndef __ComputeOverlapAllPairs_h_
@@ -24,6 +24,7 @@
 #include "itkImageRegionConstIterator.h"
 #include "itkThresholdLabelerImageFilter.h"
 #include "itkNumericTraits.h"
+#include "itkSurfaceDistanceCalculator.h"
 
 #include "ITKToolsHelpers.h"
 #include "ITKToolsBase.h"
@@ -46,6 +47,8 @@ public:
     this->m_MaskFileName2 = "";
     this->m_T1 = 0;
     this->m_T2 = 0;
+    this->m_ComputeSurfaceDistances = false;
+    this->m_ComputeAverageSurfaceDistance = false;
   };
   /** Destructor. */
   ~ITKToolsComputeOverlapOldBase(){};
@@ -56,6 +59,8 @@ public:
   std::string m_MaskFileName2;
   unsigned int m_T1;
   unsigned int m_T2;
+  bool m_ComputeSurfaceDistances;
+  bool m_ComputeAverageSurfaceDistance;
 
 }; // end ITKToolsComputeOverlapOldBase
 
@@ -254,6 +259,28 @@ public:
     std::cout << std::fixed << std::showpoint;
     std::cout << "Overlap: " << overlap << std::endl;
 
+    /** The surface distances of both objects, after masking. */
+    if( !this->m_ComputeSurfaceDistances ) return;
+    if( sumA == 0 || sumB == 0 )
+    {
+      std::cout << "Hausdorff distance: undefined, an object is empty" << std::endl;
+      return;
+    }
+
+    typedef itk::SurfaceDistanceCalculator<ImageType>   SurfaceDistanceType;
+    typename SurfaceDistanceType::Pointer surfaceDistance = SurfaceDistanceType::New();
+    surfaceDistance->SetImage1( finalANDFilter->GetInput( 1 ) );
+    surfaceDistance->SetImage2( finalANDFilter->GetInput( 0 ) );
+    surfaceDistance->SetComputeAverageDistance( this->m_ComputeAverageSurfaceDistance );
+    surfaceDistance->Compute();
+
+    std::cout << "Hausdorff distance: " << surfaceDistance->GetHausdorffDistance() << std::endl;
+    if( this->m_ComputeAverageSurfaceDistance )
+    {
+      std::cout << "Average surface distance: "
+        << surfaceDistance->GetAverageDistance() << std::endl;
+    }
+
   } // end Run()
 
 }; // end ITKToolsComputeOverlapOld
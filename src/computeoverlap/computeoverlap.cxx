@@ -30,6 +30,9 @@
 #include "ComputeOverlapOld.h"
 //#include "ComputeOverlap2.h"
 #include "ComputeOverlap3.h"
+#include "ComputeOverlapAllPairs.h"
+
+#include <fstream>
 
 
 /**
@@ -59,6 +62,19 @@ std::string GetHelpString( void )
     << "          the overlap of exactly corresponding labels is computed" << std::endl
     << "           if \"-l\" is specified with no arguments, all labels in im1 are used," << std::endl
     << "           otherwise (e.g. \"-l 1 6 19\") the specified labels are used." << std::endl
+    << "  [-cm]    with \"-l\", also print the Jaccard overlap, the false positives and" << std::endl
+    << "           false negatives of the labels, and the confusion matrix of all labels." << std::endl
+    << "  [-hd]    without \"-l\", also print the Hausdorff distance of the boundaries of" << std::endl
+    << "           both objects, in physical units, found with a bounded nearest point search." << std::endl
+    << "  [-sd]    without \"-l\", print the Hausdorff and the average symmetric surface distance." << std::endl
+    << "  [-manifest] file with one segmentation filename per line, instead of \"-in\"" << std::endl
+    << "           the label overlaps of all pairs of segmentations are computed in a" << std::endl
+    << "           single pass, reading every segmentation once, or slab by slab when" << std::endl
+    << "           streaming; \"-l\" restricts the table to the specified labels." << std::endl
+    << "  [-out]   with \"-manifest\", the output table; default the standard output." << std::endl
+    << "          every line holds: image1 image2 label size1 size2 intersection dice" << std::endl
+    << "  [-streams] number of slabs, with \"-manifest\"" << std::endl
+    << "  [-memoryLimit] memory limit in MB, with \"-manifest\"" << std::endl
     << "Supported: 2D, 3D, (unsigned) char, (unsigned) short";
 
   return ss.str();
@@ -67,10 +83,8 @@ std::string GetHelpString( void )
 
 //-------------------------------------------------------------------------------------
 
-int main( int argc, char ** argv )
+int ComputeOverlapMain( int argc, char ** argv )
 {
-  RegisterMevisDicomTiff();
-
   /** Create a command line argument parser. */
   itk::CommandLineArgumentParser::Pointer parser = itk::CommandLineArgumentParser::New();
   parser->SetCommandLineArguments( argc, argv );
@@ -80,7 +94,13 @@ int main( int argc, char ** argv )
   std::vector<std::string> inputFileNames;
   bool retin = parser->GetCommandLineArgument( "-in", inputFileNames );
 
-  parser->MarkArgumentAsRequired( "-in", "Two input filenames." );
+  std::string manifestFileName = "";
+  bool retmanifest = parser->GetCommandLineArgument( "-manifest", manifestFileName );
+
+  if( !retmanifest )
+  {
+    parser->MarkArgumentAsRequired( "-in", "Two input filenames." );
+  }
 
   itk::CommandLineArgumentParser::ReturnValue validateArguments = parser->CheckForRequiredArguments();
 
@@ -106,9 +126,41 @@ int main( int argc, char ** argv )
   bool retlabel = parser->ArgumentExists( "-l" ); // default all labels
   std::vector<unsigned int> labels( 0 );
   parser->GetCommandLineArgument( "-l", labels );
+  const bool printConfusionMatrix = parser->ArgumentExists( "-cm" );
+  const bool computeAverageSurfaceDistance = parser->ArgumentExists( "-sd" );
+  const bool computeSurfaceDistances
+    = computeAverageSurfaceDistance || parser->ArgumentExists( "-hd" );
+
+  std::string outputFileName = "";
+  parser->GetCommandLineArgument( "-out", outputFileName );
+
+  /** Read the segmentation filenames from the manifest. */
+  if( retmanifest )
+  {
+    std::ifstream manifest( manifestFileName.c_str() );
+    if( !manifest.is_open() )
+    {
+      std::cerr << "ERROR: could not open the manifest " << manifestFileName << "." << std::endl;
+      return EXIT_FAILURE;
+    }
+    inputFileNames.clear();
+    std::string line;
+    while( std::getline( manifest, line ) )
+    {
+      const std::string::size_type begin = line.find_first_not_of( " \t\r" );
+      if( begin == std::string::npos ) continue;
+      const std::string::size_type end = line.find_last_not_of( " \t\r" );
+      inputFileNames.push_back( line.substr( begin, end - begin + 1 ) );
+    }
+    if( inputFileNames.size() < 2 )
+    {
+      std::cerr << "ERROR: The manifest should list at least two segmentations." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
 
   /** Checks. */
-  if( !retin || inputFileNames.size() != 2 )
+  if( !retmanifest && ( !retin || inputFileNames.size() != 2 ) )
   {
     std::cerr << "ERROR: You should specify two input file names with \"-in\"." << std::endl;
     return EXIT_FAILURE;
@@ -128,7 +180,45 @@ int main( int argc, char ** argv )
   if( !retNOCCheck ) return EXIT_FAILURE;
 
   /** Select overlap compute filter. */
-  if( retlabel )
+  if( retmanifest )
+  {
+    /** Class that does the work. */
+    ITKToolsComputeOverlapAllPairsBase * filterPairs = 0;
+
+    try
+    {
+      // now call all possible template combinations.
+      if( !filterPairs ) filterPairs = ITKToolsComputeOverlapAllPairs< 2, char >::New( dim, componentType );
+      if( !filterPairs ) filterPairs = ITKToolsComputeOverlapAllPairs< 2, short >::New( dim, componentType );
+
+#ifdef ITKTOOLS_3D_SUPPORT
+      if( !filterPairs ) filterPairs = ITKToolsComputeOverlapAllPairs< 3, char >::New( dim, componentType );
+      if( !filterPairs ) filterPairs = ITKToolsComputeOverlapAllPairs< 3, unsigned char >::New( dim, componentType );
+      if( !filterPairs ) filterPairs = ITKToolsComputeOverlapAllPairs< 3, short >::New( dim, componentType );
+      if( !filterPairs ) filterPairs = ITKToolsComputeOverlapAllPairs< 3, unsigned short >::New( dim, componentType );
+#endif
+      /** Check if filter was instantiated. */
+      bool supported = itktools::IsFilterSupportedCheck( filterPairs, dim, componentType );
+      if( !supported ) return EXIT_FAILURE;
+
+      /** Set the filter arguments. */
+      filterPairs->m_InputFileNames = inputFileNames;
+      filterPairs->m_Labels = labels;
+      filterPairs->m_OutputFileName = outputFileName;
+
+      filterPairs->ReadCommonArguments( parser );
+      filterPairs->Run();
+
+      delete filterPairs;
+    }
+    catch( itk::ExceptionObject & excp )
+    {
+      std::cerr << "Caught ITK exception: " << excp << std::endl;
+      delete filterPairs;
+      return EXIT_FAILURE;
+    }
+  }
+  else if( retlabel )
   {
     /** Class that does the work. */
     ITKToolsComputeOverlap3Base * filter3 = 0;
@@ -152,7 +242,9 @@ int main( int argc, char ** argv )
       /** Set the filter arguments. */
       filter3->m_InputFileNames = inputFileNames;
       filter3->m_Labels = labels;
+      filter3->m_PrintConfusionMatrix = printConfusionMatrix;
 
+      filter3->ReadCommonArguments( parser );
       filter3->Run();
 
       delete filter3;
@@ -192,7 +284,10 @@ int main( int argc, char ** argv )
       filterOld->m_MaskFileName2 = maskFileName2;
       filterOld->m_T1 = t1;
       filterOld->m_T2 = t2;
+      filterOld->m_ComputeSurfaceDistances = computeSurfaceDistances;
+      filterOld->m_ComputeAverageSurfaceDistance = computeAverageSurfaceDistance;
 
+      filterOld->ReadCommonArguments( parser );
       filterOld->Run();
 
       delete filterOld;
@@ -208,4 +303,15 @@ int main( int argc, char ** argv )
   /** End program. */
   return EXIT_SUCCESS;
 
+} // end ComputeOverlapMain()
+
+
+//-------------------------------------------------------------------------------------
+
+int main( int argc, char ** argv )
+{
+  RegisterMevisDicomTiff();
+
+  return ComputeOverlapMain( argc, argv );
+
 } // end main
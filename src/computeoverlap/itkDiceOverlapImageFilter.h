@@ -19,8 +19,11 @@
 #define __itkDiceOverlapImageFilter_h_
 
 #include "itkImageToImageFilter.h"
+#include "itkParallelReducer.h"
 #include <map>
 #include <set>
+#include <utility>
+#include <vector>
 
 
 namespace itk
@@ -29,6 +32,12 @@ namespace itk
 /** \class DiceOverlapImageFilter
  * \brief Computes the Dice overlap per label
  *
+ * In the same pass the full label-by-label confusion matrix is computed,
+ * from which the Jaccard overlap and the false positives and negatives of
+ * every label follow. When the labels of both images lie in a small range,
+ * at most MaximumDenseLabelRange values, every thread counts in a dense
+ * table; otherwise in a map. The tables are merged by a ParallelReducer.
+ *
  * \ingroup IntensityImageFilters
  * \ingroup Multithreaded
  */
@@ -70,6 +79,19 @@ public:
   typedef std::map<InputPixelType, ScalarRealType>          OverlapMapRealType;
   typedef std::set<InputPixelType>                          LabelsType;
 
+  /** The confusion matrix: for every pair of a label in the first and a
+   * label in the second image, the number of pixels. Only the nonzero
+   * entries are stored. */
+  typedef std::pair<InputPixelType, InputPixelType>         LabelPairType;
+  typedef std::map<LabelPairType, std::size_t>              ConfusionMatrixType;
+
+  /** The maximum number of label values between the smallest and the
+   * largest label of both images for which dense tables are used.
+   * Default: 256.
+   */
+  itkSetMacro( MaximumDenseLabelRange, std::size_t );
+  itkGetConstMacro( MaximumDenseLabelRange, std::size_t );
+
   /** Set and get the user-requested labels for which the overlaps a. */
   //itkSetMacro( RequestedLabels, LabelsType );
   virtual void SetRequestedLabels( const LabelsType & arg )
@@ -93,9 +115,35 @@ public:
     return this->m_DiceOverlap;
   }
 
+  /** Get the confusion matrix. */
+  virtual const ConfusionMatrixType & GetConfusionMatrix() const
+  {
+    return this->m_ConfusionMatrix;
+  }
+
+  /** Get the Jaccard overlaps, false positives and false negatives,
+   * for the same labels as the Dice overlaps. */
+  virtual const OverlapMapRealType & GetJaccardOverlap() const
+  {
+    return this->m_JaccardOverlap;
+  }
+  virtual const OverlapMapType & GetFalsePositives() const
+  {
+    return this->m_FalsePositives;
+  }
+  virtual const OverlapMapType & GetFalseNegatives() const
+  {
+    return this->m_FalseNegatives;
+  }
+
   /** Print the Dice overlaps, only the requested ones. */
   void PrintRequestedDiceOverlaps( void );
 
+  /** Print the Dice and Jaccard overlaps, false positives and negatives
+   * of the requested labels, and the nonzero entries of the confusion matrix.
+   */
+  void PrintRequestedOverlapMetrics( void );
+
 // #ifdef ITK_USE_CONCEPT_CHECKING
 //   /** Begin concept checking */
 //   itkConceptMacro( InputHasNumericTraitsCheck,
@@ -113,22 +161,55 @@ protected:
   virtual void BeforeThreadedGenerateData( void );
   virtual void AfterThreadedGenerateData( void );
 
-  /** ThreadedGenerateData. */
-  virtual void ThreadedGenerateData(
-    const InputImageRegionType & outputRegionForThread,
-    ThreadIdType threadId );
+  /** Count the label pairs with a ParallelReducer. */
+  virtual void GenerateData( void );
 
 private:
   DiceOverlapImageFilter(const Self&); //purposely not implemented
   void operator=(const Self&); //purposely not implemented
 
+  /** Check if all requested labels exist. */
+  void CheckRequestedLabels( void );
+
   /** Member variables. */
   LabelsType                    m_RequestedLabels;
+  std::size_t                   m_MaximumDenseLabelRange;
+
+  /** The partial confusion matrix of a thread: a dense table, indexed by
+   * ( labelA - min ) * range + labelB - min, or a map. */
+  struct PartialType
+  {
+    std::vector<std::size_t>  DenseConfusionMatrix;
+    ConfusionMatrixType       ConfusionMatrix;
+  };
+
+  /** The reducer of the ParallelReducer. */
+  class ReducerType
+  {
+  public:
+    typedef InputImageRegionType        RegionType;
+    typedef typename Self::PartialType  PartialType;
+    const Self * m_Filter;
+    void Initialize( PartialType & partial ) const;
+    void Reduce( const RegionType & block, PartialType & partial ) const
+    {
+      this->m_Filter->ReduceBlock( block, partial );
+    }
+    void Merge( PartialType & partial, const PartialType & other ) const;
+  };
+
+  /** Count the label pairs of a block. */
+  void ReduceBlock( const InputImageRegionType & block, PartialType & partial ) const;
+
+  bool                          m_UseDenseTables;
+  InputPixelType                m_MinimumLabel;
+  std::size_t                   m_LabelRange;
 
-  std::vector<OverlapMapType>   m_SumA;
-  std::vector<OverlapMapType>   m_SumB;
-  std::vector<OverlapMapType>   m_SumC;
+  ConfusionMatrixType           m_ConfusionMatrix;
   OverlapMapRealType            m_DiceOverlap;
+  OverlapMapRealType            m_JaccardOverlap;
+  OverlapMapType                m_FalsePositives;
+  OverlapMapType                m_FalseNegatives;
 
 }; // end class DiceOverlapImageFilter
 
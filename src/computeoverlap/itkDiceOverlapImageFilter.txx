@@ -21,7 +21,8 @@
 #include "itkDiceOverlapImageFilter.h"
 
 #include "itkImageRegionConstIterator.h"
-#include "itkProgressReporter.h"
+#include "itkMinimumMaximumImageCalculator.h"
+#include "vnl/vnl_math.h"
 
 
 namespace itk
@@ -37,6 +38,10 @@ DiceOverlapImageFilter<TInputImage>
 {
   /** Initialize variables. */
   //this->m_RequestedLabels = 0;
+  this->m_MaximumDenseLabelRange = 256;
+  this->m_UseDenseTables = false;
+  this->m_MinimumLabel = NumericTraits<InputPixelType>::Zero;
+  this->m_LabelRange = 0;
 
   this->SetNumberOfRequiredInputs( 2 );
 
@@ -52,118 +57,197 @@ void
 DiceOverlapImageFilter<TInputImage>
 ::BeforeThreadedGenerateData( void )
 {
-  const int numberOfThreads = this->GetNumberOfThreads();
-
-  // Create the thread temporaries
-  this->m_SumA.resize( numberOfThreads );
-  this->m_SumB.resize( numberOfThreads );
-  this->m_SumC.resize( numberOfThreads );
+  /** Determine the range of the labels of both images. */
+  typedef MinimumMaximumImageCalculator< InputImageType > CalculatorType;
+  typename CalculatorType::Pointer calculatorA = CalculatorType::New();
+  typename CalculatorType::Pointer calculatorB = CalculatorType::New();
+  calculatorA->SetImage( this->GetInput( 0 ) );
+  calculatorB->SetImage( this->GetInput( 1 ) );
+  calculatorA->SetRegion( this->GetOutput()->GetRequestedRegion() );
+  calculatorB->SetRegion( this->GetOutput()->GetRequestedRegion() );
+  calculatorA->Compute();
+  calculatorB->Compute();
+  this->m_MinimumLabel = vnl_math_min( calculatorA->GetMinimum(), calculatorB->GetMinimum() );
+  const InputPixelType maximumLabel
+    = vnl_math_max( calculatorA->GetMaximum(), calculatorB->GetMaximum() );
+  const double range = static_cast<double>( maximumLabel )
+    - static_cast<double>( this->m_MinimumLabel ) + 1.0;
+
+  /** Choose the kind of the tables. */
+  this->m_UseDenseTables = NumericTraits<InputPixelType>::is_integer
+    && range <= static_cast<double>( this->m_MaximumDenseLabelRange );
+  this->m_LabelRange = this->m_UseDenseTables ? static_cast<std::size_t>( range ) : 0;
 
 } // end BeforeThreadedGenerateData()
 
 
 /**
- * ******************* ThreadedGenerateData *******************
+ * ******************* GenerateData *******************
  */
 
 template <typename TInputImage>
 void
 DiceOverlapImageFilter<TInputImage>
-::ThreadedGenerateData(
-  const InputImageRegionType & inputRegionForThread,
-  ThreadIdType threadId )
+::GenerateData( void )
 {
-  typedef itk::ImageRegionConstIterator<InputImageType>    IteratorType;
+  this->AllocateOutputs();
+  this->BeforeThreadedGenerateData();
+
+  /** The counts are exact, so one table per thread suffices. */
+  ReducerType reducer;
+  reducer.m_Filter = this;
+
+  typedef ParallelReducer< ReducerType > ParallelReducerType;
+  typename ParallelReducerType::Pointer parallelReducer = ParallelReducerType::New();
+  parallelReducer->SetReducer( &reducer );
+  parallelReducer->SetRegion( this->GetOutput()->GetRequestedRegion() );
+  parallelReducer->SetNumberOfThreads( this->GetNumberOfThreads() );
+  parallelReducer->SetProgressFilter( this );
+  parallelReducer->ExactMergeOn();
+  parallelReducer->Compute();
+  const PartialType & total = parallelReducer->GetResult();
+
+  /** The confusion matrix, without the zero entries. */
+  this->m_ConfusionMatrix.clear();
+  if( this->m_UseDenseTables )
+  {
+    const std::size_t range = this->m_LabelRange;
+    const std::vector<std::size_t> & table = total.DenseConfusionMatrix;
+    for( std::size_t A = 0; A < range; ++A )
+    {
+      for( std::size_t B = 0; B < range; ++B )
+      {
+        if( table[ A * range + B ] == 0 ) continue;
+        const LabelPairType labels(
+          static_cast<InputPixelType>( this->m_MinimumLabel + A ),
+          static_cast<InputPixelType>( this->m_MinimumLabel + B ) );
+        this->m_ConfusionMatrix[ labels ] = table[ A * range + B ];
+      }
+    }
+  }
+  else
+  {
+    this->m_ConfusionMatrix = total.ConfusionMatrix;
+  }
 
-  /** Create a process reporter for tracking the progress of this filter. */
-  ProgressReporter progress( this, threadId, inputRegionForThread.GetNumberOfPixels() );
+  this->AfterThreadedGenerateData();
 
-  /** Create iterators. */
-  IteratorType itA( this->GetInput( 0 ), inputRegionForThread );
-  IteratorType itB( this->GetInput( 1 ), inputRegionForThread );
-  itA.GoToBegin();
-  itB.GoToBegin();
+} // end GenerateData()
 
-  /** Determine size of objects, and size in the overlap. */
-  OverlapMapType sumA, sumB, sumC;
-  while ( !itA.IsAtEnd() )
-  {
-    InputPixelType A = itA.Value();
-    InputPixelType B = itB.Value();
 
-    sumA[ A ]++;
-    sumB[ B ]++;
-    if( A == B  ) ++sumC[ A ];
+/**
+ * ******************* ReducerType::Initialize *******************
+ */
+
+template <typename TInputImage>
+void
+DiceOverlapImageFilter<TInputImage>
+::ReducerType::Initialize( PartialType & partial ) const
+{
+  const std::size_t range = this->m_Filter->m_LabelRange;
+  partial.DenseConfusionMatrix.assign( range * range, 0 );
+  partial.ConfusionMatrix.clear();
 
-    /** Increase iterators. */
-    ++itA; ++itB;
-    progress.CompletedPixel(); // potential exception thrown here
+} // end ReducerType::Initialize()
 
-  } // end while
 
-  /** Update sums for this thread. */
-  this->m_SumA[ threadId ] = sumA;
-  this->m_SumB[ threadId ] = sumB;
-  this->m_SumC[ threadId ] = sumC;
+/**
+ * ******************* ReducerType::Merge *******************
+ */
+
+template <typename TInputImage>
+void
+DiceOverlapImageFilter<TInputImage>
+::ReducerType::Merge( PartialType & partial, const PartialType & other ) const
+{
+  for( std::size_t i = 0; i < partial.DenseConfusionMatrix.size(); ++i )
+  {
+    partial.DenseConfusionMatrix[ i ] += other.DenseConfusionMatrix[ i ];
+  }
+  typename ConfusionMatrixType::const_iterator it;
+  for( it = other.ConfusionMatrix.begin(); it != other.ConfusionMatrix.end(); ++it )
+  {
+    partial.ConfusionMatrix[ (*it).first ] += (*it).second;
+  }
 
-} // end ThreadedGenerateData()
+} // end ReducerType::Merge()
 
 
 /**
- * ******************* AfterThreadedGenerateData *******************
+ * ******************* ReduceBlock *******************
  */
 
-template<class TInputImage>
+template <typename TInputImage>
 void
 DiceOverlapImageFilter<TInputImage>
-::AfterThreadedGenerateData( void )
+::ReduceBlock( const InputImageRegionType & block, PartialType & partial ) const
 {
-  /** Merge sums from all threads. */
-  OverlapMapType sumA = this->m_SumA[ 0 ];
-  OverlapMapType sumB = this->m_SumB[ 0 ];
-  OverlapMapType sumC = this->m_SumC[ 0 ];
-  typename OverlapMapType::const_iterator  it;
-  for( unsigned int threadId = 1; threadId < this->GetNumberOfThreads(); threadId++ )
+  typedef itk::ImageRegionConstIterator<InputImageType>    IteratorType;
+
+  /** Create iterators. */
+  IteratorType itA( this->GetInput( 0 ), block );
+  IteratorType itB( this->GetInput( 1 ), block );
+  itA.GoToBegin();
+  itB.GoToBegin();
+
+  /** Count the pixels of every pair of labels. */
+  if( this->m_UseDenseTables )
   {
-    for ( it = this->m_SumA[ threadId ].begin(); it != this->m_SumA[ threadId ].end(); it++ )
+    const InputPixelType minimumLabel = this->m_MinimumLabel;
+    const std::size_t range = this->m_LabelRange;
+    std::size_t * table = &( partial.DenseConfusionMatrix[ 0 ] );
+    while ( !itA.IsAtEnd() )
     {
-      if( sumA.count( (*it).first ) == 0 )
-      {
-        sumA[ (*it).first ] = (*it).second;
-      }
-      else
-      {
-        sumA[ (*it).first ] += (*it).second;
-      }
-    }
+      const std::size_t A = static_cast<std::size_t>( itA.Value() - minimumLabel );
+      const std::size_t B = static_cast<std::size_t>( itB.Value() - minimumLabel );
+      ++table[ A * range + B ];
 
-    for ( it = this->m_SumB[ threadId ].begin(); it != this->m_SumB[ threadId ].end(); it++ )
-    {
-      if( sumB.count( (*it).first ) == 0 )
-      {
-        sumB[ (*it).first ] = (*it).second;
-      }
-      else
-      {
-        sumB[ (*it).first ] += (*it).second;
-      }
+      /** Increase iterators. */
+      ++itA; ++itB;
     }
-
-    for ( it = this->m_SumC[ threadId ].begin(); it != this->m_SumC[ threadId ].end(); it++ )
+  }
+  else
+  {
+    ConfusionMatrixType & confusionMatrix = partial.ConfusionMatrix;
+    while ( !itA.IsAtEnd() )
     {
-      if( sumC.count( (*it).first ) == 0 )
-      {
-        sumC[ (*it).first ] = (*it).second;
-      }
-      else
-      {
-        sumC[ (*it).first ] += (*it).second;
-      }
+      ++confusionMatrix[ LabelPairType( itA.Value(), itB.Value() ) ];
+
+      /** Increase iterators. */
+      ++itA; ++itB;
     }
   }
 
-  /** Calculate the Dice overlaps. */
-  //typename OverlapMapType::const_iterator  it;
+} // end ReduceBlock()
+
+
+/**
+ * ******************* AfterThreadedGenerateData *******************
+ */
+
+template<class TInputImage>
+void
+DiceOverlapImageFilter<TInputImage>
+::AfterThreadedGenerateData( void )
+{
+  /** Determine size of objects, and size in the overlap. */
+  OverlapMapType sumA, sumB, sumC;
+  typename ConfusionMatrixType::const_iterator itC;
+  for( itC = this->m_ConfusionMatrix.begin(); itC != this->m_ConfusionMatrix.end(); ++itC )
+  {
+    const InputPixelType A = (*itC).first.first;
+    const InputPixelType B = (*itC).first.second;
+    sumA[ A ] += (*itC).second;
+    sumB[ B ] += (*itC).second;
+    if( A == B ) sumC[ A ] += (*itC).second;
+  }
+
+  /** Calculate the overlaps, for all labels of the first image. */
+  this->m_DiceOverlap.clear();
+  this->m_JaccardOverlap.clear();
+  this->m_FalsePositives.clear();
+  this->m_FalseNegatives.clear();
+  typename OverlapMapType::const_iterator  it;
   for ( it = sumA.begin(); it != sumA.end(); it++ )
   {
     InputPixelType currentLabel = (*it).first;
@@ -173,13 +257,19 @@ DiceOverlapImageFilter<TInputImage>
     if( sumAB == 0 )
     {
       this->m_DiceOverlap[ currentLabel ] = 0.0;
+      this->m_JaccardOverlap[ currentLabel ] = 0.0;
     }
     else
     {
       this->m_DiceOverlap[ currentLabel ]
         = static_cast<double>( 2 * sumC[ currentLabel ] )
         / static_cast<double>( sumAB );
+      this->m_JaccardOverlap[ currentLabel ]
+        = static_cast<double>( sumC[ currentLabel ] )
+        / static_cast<double>( sumAB - sumC[ currentLabel ] );
     }
+    this->m_FalsePositives[ currentLabel ] = sumB[ currentLabel ] - sumC[ currentLabel ];
+    this->m_FalseNegatives[ currentLabel ] = sumA[ currentLabel ] - sumC[ currentLabel ];
 
   } // end loop over all labels
 
@@ -187,19 +277,17 @@ DiceOverlapImageFilter<TInputImage>
 
 
 /**
- * ******************* PrintRequestedDiceOverlaps *******************
+ * ******************* CheckRequestedLabels *******************
  */
 
 template<class TInputImage>
 void
 DiceOverlapImageFilter<TInputImage>
-::PrintRequestedDiceOverlaps( void )
+::CheckRequestedLabels( void )
 {
-  /** Check if all requested labels exist. */
   for ( typename LabelsType::const_iterator itL = this->m_RequestedLabels.begin();
     itL != this->m_RequestedLabels.end(); itL++ )
   {
-    //if( sumA.count( *itL ) == 0 && sumB.count( *itL ) == 0 )
     if( this->m_DiceOverlap.count( *itL ) == 0 )
     {
       itkExceptionMacro( << "The selected label "
@@ -208,6 +296,21 @@ DiceOverlapImageFilter<TInputImage>
     }
   }
 
+} // end CheckRequestedLabels()
+
+
+/**
+ * ******************* PrintRequestedDiceOverlaps *******************
+ */
+
+template<class TInputImage>
+void
+DiceOverlapImageFilter<TInputImage>
+::PrintRequestedDiceOverlaps( void )
+{
+  /** Check if all requested labels exist. */
+  this->CheckRequestedLabels();
+
   /** Print the requested Dice overlaps. */
   //std::cout << "label => sum input1 \t, sum input2 \t, sum overlap \t, overlap" << std::endl;
   std::cout << "label => overlap" << std::endl;
@@ -238,6 +341,50 @@ DiceOverlapImageFilter<TInputImage>
 } // end PrintRequestedDiceOverlaps()
 
 
+/**
+ * ******************* PrintRequestedOverlapMetrics *******************
+ */
+
+template<class TInputImage>
+void
+DiceOverlapImageFilter<TInputImage>
+::PrintRequestedOverlapMetrics( void )
+{
+  /** Check if all requested labels exist. */
+  this->CheckRequestedLabels();
+
+  /** Print the metrics of the requested labels. */
+  std::cout << "label => dice\tjaccard\tfalsePositives\tfalseNegatives" << std::endl;
+  typename OverlapMapRealType::const_iterator  it;
+  for ( it = this->m_DiceOverlap.begin() ; it != this->m_DiceOverlap.end(); it++ )
+  {
+    InputPixelType currentLabel = (*it).first;
+    if( this->m_RequestedLabels.size() != 0
+      && this->m_RequestedLabels.count( currentLabel ) == 0 )
+    {
+      continue;
+    }
+
+    std::cout << static_cast<std::size_t>( currentLabel ) << " => "
+      << this->m_DiceOverlap[ currentLabel ]
+      << "\t" << this->m_JaccardOverlap[ currentLabel ]
+      << "\t" << this->m_FalsePositives[ currentLabel ]
+      << "\t" << this->m_FalseNegatives[ currentLabel ] << std::endl;
+  }
+
+  /** Print the nonzero entries of the confusion matrix. */
+  std::cout << "\nlabel1\tlabel2\tcount" << std::endl;
+  typename ConfusionMatrixType::const_iterator itC;
+  for( itC = this->m_ConfusionMatrix.begin(); itC != this->m_ConfusionMatrix.end(); ++itC )
+  {
+    std::cout << static_cast<std::size_t>( (*itC).first.first )
+      << "\t" << static_cast<std::size_t>( (*itC).first.second )
+      << "\t" << (*itC).second << std::endl;
+  }
+
+} // end PrintRequestedOverlapMetrics()
+
+
 /**
  * ******************* PrintSelf *******************
  */
@@ -0,0 +1,212 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkSurfaceDistanceCalculator_h_
+#define __itkSurfaceDistanceCalculator_h_
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkMultiThreader.h"
+#include <vector>
+
+
+namespace itk
+{
+
+/** \class SurfaceDistanceCalculator
+ * \brief Computes the Hausdorff and the average surface distance of two
+ * binary objects, without distance maps.
+ *
+ * The boundary voxels of both objects, the nonzero voxels with a zero face
+ * neighbour or at the edge of the image, are extracted as physical points
+ * in parallel. The boundary points of each object are put in a uniform
+ * grid, in which the nearest point of the other object is searched ring
+ * by ring around the cell of a query point; the search stops as soon as
+ * the next ring cannot hold a closer point. The directed distances are
+ * computed in parallel over the query points.
+ *
+ * The Hausdorff distance is the maximum of the two directed Hausdorff
+ * distances. The average surface distance is the mean of the distances of
+ * all boundary points of both objects to the other object. When the
+ * average is not needed, ComputeAverageDistanceOff(), the search of a point
+ * stops as soon as a point is found within the current maximum, since the
+ * point cannot raise it, and a point is skipped altogether when the
+ * distance bound of the previous point plus the distance between both is
+ * within the maximum. Then only the points that can exceed the current
+ * bound are refined.
+ *
+ * The result does not depend on the number of threads.
+ */
+
+template < typename TInputImage >
+class ITK_EXPORT SurfaceDistanceCalculator : public Object
+{
+public:
+
+  /** Standard class typedefs. */
+  typedef SurfaceDistanceCalculator     Self;
+  typedef Object                        Superclass;
+  typedef SmartPointer<Self>            Pointer;
+  typedef SmartPointer<const Self>      ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( SurfaceDistanceCalculator, Object );
+
+  /** Image dimension. */
+  itkStaticConstMacro( ImageDimension, unsigned int, TInputImage::ImageDimension );
+
+  /** Typedefs. */
+  typedef TInputImage                                 InputImageType;
+  typedef typename InputImageType::ConstPointer       InputImageConstPointer;
+  typedef typename InputImageType::PixelType          InputPixelType;
+  typedef typename InputImageType::RegionType         InputImageRegionType;
+  typedef typename InputImageType::IndexType          IndexType;
+  typedef typename InputImageType::PointType          PointType;
+  typedef std::vector<PointType>                      PointContainerType;
+
+  /** Set the two objects; nonzero voxels are foreground. */
+  itkSetConstObjectMacro( Image1, InputImageType );
+  itkSetConstObjectMacro( Image2, InputImageType );
+
+  /** Set/Get whether the average surface distance is computed. Without
+   * it, the Hausdorff distance is found with a bounded search. Default true.
+   */
+  itkSetMacro( ComputeAverageDistance, bool );
+  itkGetConstMacro( ComputeAverageDistance, bool );
+  itkBooleanMacro( ComputeAverageDistance );
+
+  /** Set/Get the number of threads. Default the global default. */
+  itkSetMacro( NumberOfThreads, ThreadIdType );
+  itkGetConstMacro( NumberOfThreads, ThreadIdType );
+
+  /** Compute the distances. Throws if an object is empty. */
+  void Compute( void );
+
+  /** Get the Hausdorff distance, and the average surface distance. */
+  itkGetConstMacro( HausdorffDistance, double );
+  itkGetConstMacro( AverageDistance, double );
+
+  /** Get the directed Hausdorff distance from object i to the other. With
+   * the bounded search, the second one is the maximum of both.
+   */
+  double GetDirectedHausdorffDistance( unsigned int i ) const
+  {
+    return this->m_DirectedHausdorffDistances[ i < 1 ? 0 : 1 ];
+  }
+
+  /** Get the number of boundary points of object i. */
+  std::size_t GetNumberOfBoundaryPoints( unsigned int i ) const
+  {
+    return this->m_BoundaryPoints[ i < 1 ? 0 : 1 ].size();
+  }
+
+  /** Extract the boundary voxels of an object as physical points, in
+   * buffer order. */
+  static void ExtractBoundaryPoints( const InputImageType * image,
+    PointContainerType & points, ThreadIdType numberOfThreads );
+
+protected:
+  SurfaceDistanceCalculator();
+  virtual ~SurfaceDistanceCalculator() {};
+
+  /** PrintSelf. */
+  void PrintSelf( std::ostream& os, Indent indent ) const;
+
+private:
+  SurfaceDistanceCalculator(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  /** A uniform grid of points: the points sorted by cell, with the start
+   * of every cell in CellStarts. */
+  class GridType
+  {
+  public:
+    void Build( const PointContainerType & points );
+    /** The squared distance to the nearest point. The search stops as soon
+     * as a point within sqrt( stopDistanceSquared ) is found. */
+    double FindNearestDistanceSquared( const PointType & point,
+      double stopDistanceSquared ) const;
+
+  private:
+    PointContainerType          m_Points;
+    std::vector<std::size_t>    m_CellStarts;
+    double                      m_Origin[ ImageDimension ];
+    long                        m_Size[ ImageDimension ];
+    double                      m_CellSize;
+  };
+
+  /** The boundary points of a block of lines. */
+  class ReducerType
+  {
+  public:
+    typedef InputImageRegionType        RegionType;
+    typedef PointContainerType          PartialType;
+    const InputImageType * m_Image;
+    void Initialize( PartialType & partial ) const
+    {
+      partial.clear();
+    }
+    void Reduce( const RegionType & block, PartialType & partial ) const;
+    void Merge( PartialType & partial, const PartialType & other ) const
+    {
+      partial.insert( partial.end(), other.begin(), other.end() );
+    }
+  };
+
+  /** The directed distances from a point set to a grid. */
+  struct ThreadStruct
+  {
+    const PointContainerType *  Points;
+    const GridType *            Grid;
+    bool                        Bounded;
+    double                      InitialBound;
+    std::vector<double>         Distances;
+    std::vector<double>         Maxima;
+  };
+
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback( void * arg );
+
+  /** The directed Hausdorff distance from points to grid, and the sum of
+   * the distances if not bounded. With bounded, the maximum is only exact
+   * when it exceeds the initial bound. */
+  void ComputeDirectedDistances( const PointContainerType & points,
+    const GridType & grid, bool bounded, double initialBound,
+    double & maximum, double & sum ) const;
+
+  /** Member variables. */
+  InputImageConstPointer        m_Image1;
+  InputImageConstPointer        m_Image2;
+  bool                          m_ComputeAverageDistance;
+  ThreadIdType                  m_NumberOfThreads;
+
+  PointContainerType            m_BoundaryPoints[ 2 ];
+  double                        m_DirectedHausdorffDistances[ 2 ];
+  double                        m_HausdorffDistance;
+  double                        m_AverageDistance;
+
+}; // end class SurfaceDistanceCalculator
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkSurfaceDistanceCalculator.txx"
+#endif
+
+#endif // end #ifndef __itkSurfaceDistanceCalculator_h_
@@ -0,0 +1,475 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef _itkSurfaceDistanceCalculator_txx_
+#define _itkSurfaceDistanceCalculator_txx_
+
+#include "itkSurfaceDistanceCalculator.h"
+
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkParallelReducer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+
+namespace itk
+{
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template <typename TInputImage>
+SurfaceDistanceCalculator<TInputImage>
+::SurfaceDistanceCalculator()
+{
+  this->m_Image1 = 0;
+  this->m_Image2 = 0;
+  this->m_ComputeAverageDistance = true;
+  this->m_NumberOfThreads = MultiThreader::GetGlobalDefaultNumberOfThreads();
+  this->m_DirectedHausdorffDistances[ 0 ] = 0.0;
+  this->m_DirectedHausdorffDistances[ 1 ] = 0.0;
+  this->m_HausdorffDistance = 0.0;
+  this->m_AverageDistance = 0.0;
+
+} // end Constructor
+
+
+/**
+ * ******************* Compute *******************
+ */
+
+template <typename TInputImage>
+void
+SurfaceDistanceCalculator<TInputImage>
+::Compute( void )
+{
+  if( this->m_Image1.IsNull() || this->m_Image2.IsNull() )
+  {
+    itkExceptionMacro( << "ERROR: both images should be set." );
+  }
+
+  /** Extract the boundaries. */
+  ExtractBoundaryPoints( this->m_Image1, this->m_BoundaryPoints[ 0 ], this->m_NumberOfThreads );
+  ExtractBoundaryPoints( this->m_Image2, this->m_BoundaryPoints[ 1 ], this->m_NumberOfThreads );
+  if( this->m_BoundaryPoints[ 0 ].empty() || this->m_BoundaryPoints[ 1 ].empty() )
+  {
+    itkExceptionMacro( << "ERROR: an object is empty, its surface distance is undefined." );
+  }
+
+  /** Index both boundaries. */
+  GridType grids[ 2 ];
+  grids[ 0 ].Build( this->m_BoundaryPoints[ 0 ] );
+  grids[ 1 ].Build( this->m_BoundaryPoints[ 1 ] );
+
+  /** The directed distances. Without the average, the second direction
+   * starts from the Hausdorff distance of the first, so that only the
+   * points that can exceed it are refined.
+   */
+  const bool bounded = !this->m_ComputeAverageDistance;
+  double sums[ 2 ];
+  this->ComputeDirectedDistances( this->m_BoundaryPoints[ 0 ], grids[ 1 ],
+    bounded, 0.0, this->m_DirectedHausdorffDistances[ 0 ], sums[ 0 ] );
+  this->ComputeDirectedDistances( this->m_BoundaryPoints[ 1 ], grids[ 0 ],
+    bounded, bounded ? this->m_DirectedHausdorffDistances[ 0 ] : 0.0,
+    this->m_DirectedHausdorffDistances[ 1 ], sums[ 1 ] );
+
+  this->m_HausdorffDistance = std::max(
+    this->m_DirectedHausdorffDistances[ 0 ], this->m_DirectedHausdorffDistances[ 1 ] );
+  this->m_AverageDistance = 0.0;
+  if( this->m_ComputeAverageDistance )
+  {
+    this->m_AverageDistance = ( sums[ 0 ] + sums[ 1 ] ) / static_cast<double>(
+      this->m_BoundaryPoints[ 0 ].size() + this->m_BoundaryPoints[ 1 ].size() );
+  }
+
+} // end Compute()
+
+
+/**
+ * ******************* ExtractBoundaryPoints *******************
+ */
+
+template <typename TInputImage>
+void
+SurfaceDistanceCalculator<TInputImage>
+::ExtractBoundaryPoints( const InputImageType * image,
+  PointContainerType & points, ThreadIdType numberOfThreads )
+{
+  ReducerType reducer;
+  reducer.m_Image = image;
+
+  /** The blocks are appended in buffer order. */
+  typedef ParallelReducer< ReducerType > ParallelReducerType;
+  typename ParallelReducerType::Pointer parallelReducer = ParallelReducerType::New();
+  parallelReducer->SetReducer( &reducer );
+  parallelReducer->SetRegion( image->GetBufferedRegion() );
+  parallelReducer->SetNumberOfThreads( numberOfThreads );
+  parallelReducer->Compute();
+  points = parallelReducer->GetResult();
+
+} // end ExtractBoundaryPoints()
+
+
+/**
+ * ******************* ReducerType::Reduce *******************
+ */
+
+template <typename TInputImage>
+void
+SurfaceDistanceCalculator<TInputImage>
+::ReducerType::Reduce( const RegionType & block, PartialType & partial ) const
+{
+  const InputImageType * image = this->m_Image;
+  const InputImageRegionType & region = image->GetBufferedRegion();
+  const InputPixelType * buffer = image->GetBufferPointer();
+  const OffsetValueType * offsetTable = image->GetOffsetTable();
+  const InputPixelType zero = NumericTraits<InputPixelType>::Zero;
+
+  /** A foreground voxel is on the boundary when a face neighbour is
+   * background or outside the image. */
+  PointType point;
+  ImageRegionConstIteratorWithIndex<InputImageType> it( image, block );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+  {
+    if( it.Get() == zero ) continue;
+
+    const IndexType index = it.GetIndex();
+    const OffsetValueType offset = image->ComputeOffset( index );
+    bool boundary = false;
+    for( unsigned int d = 0; d < ImageDimension && !boundary; ++d )
+    {
+      const IndexValueType first = region.GetIndex()[ d ];
+      const IndexValueType last = first + static_cast<IndexValueType>( region.GetSize()[ d ] ) - 1;
+      boundary = index[ d ] == first || index[ d ] == last
+        || buffer[ offset - offsetTable[ d ] ] == zero
+        || buffer[ offset + offsetTable[ d ] ] == zero;
+    }
+    if( boundary )
+    {
+      image->TransformIndexToPhysicalPoint( index, point );
+      partial.push_back( point );
+    }
+  }
+
+} // end ReducerType::Reduce()
+
+
+/**
+ * ******************* GridType::Build *******************
+ */
+
+template <typename TInputImage>
+void
+SurfaceDistanceCalculator<TInputImage>
+::GridType::Build( const PointContainerType & points )
+{
+  /** The bounding box. */
+  double extent[ ImageDimension ];
+  double maximumExtent = 0.0;
+  for( unsigned int d = 0; d < ImageDimension; ++d )
+  {
+    double minimum = points[ 0 ][ d ];
+    double maximum = points[ 0 ][ d ];
+    for( std::size_t i = 1; i < points.size(); ++i )
+    {
+      minimum = std::min( minimum, static_cast<double>( points[ i ][ d ] ) );
+      maximum = std::max( maximum, static_cast<double>( points[ i ][ d ] ) );
+    }
+    this->m_Origin[ d ] = minimum;
+    extent[ d ] = maximum - minimum;
+    maximumExtent = std::max( maximumExtent, extent[ d ] );
+  }
+
+  /** The smallest cell size with at most 4 cells per point, by bisection.
+   * Flat objects get few cells along their thin dimension. */
+  const double maximumNumberOfCells = 4.0 * static_cast<double>( points.size() );
+  this->m_CellSize = maximumExtent > 0.0 ? maximumExtent : 1.0;
+  double lower = this->m_CellSize * 1e-9;
+  for( unsigned int iteration = 0; iteration < 50 && maximumExtent > 0.0; ++iteration )
+  {
+    const double cellSize = 0.5 * ( lower + this->m_CellSize );
+    double numberOfCells = 1.0;
+    for( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+      numberOfCells *= std::floor( extent[ d ] / cellSize ) + 1.0;
+    }
+    if( numberOfCells <= maximumNumberOfCells ) this->m_CellSize = cellSize;
+    else lower = cellSize;
+  }
+
+  std::size_t numberOfCells = 1;
+  for( unsigned int d = 0; d < ImageDimension; ++d )
+  {
+    this->m_Size[ d ] = static_cast<long>( std::floor( extent[ d ] / this->m_CellSize ) ) + 1;
+    numberOfCells *= static_cast<std::size_t>( this->m_Size[ d ] );
+  }
+
+  /** Sort the points by cell, with a counting sort. */
+  std::vector<std::size_t> cells( points.size() );
+  this->m_CellStarts.assign( numberOfCells + 1, 0 );
+  for( std::size_t i = 0; i < points.size(); ++i )
+  {
+    std::size_t cell = 0;
+    for( int d = ImageDimension - 1; d >= 0; --d )
+    {
+      long c = static_cast<long>( ( points[ i ][ d ] - this->m_Origin[ d ] ) / this->m_CellSize );
+      c = std::max( 0L, std::min( c, this->m_Size[ d ] - 1 ) );
+      cell = cell * this->m_Size[ d ] + c;
+    }
+    cells[ i ] = cell;
+    ++this->m_CellStarts[ cell + 1 ];
+  }
+  for( std::size_t c = 0; c < numberOfCells; ++c )
+  {
+    this->m_CellStarts[ c + 1 ] += this->m_CellStarts[ c ];
+  }
+  std::vector<std::size_t> next( this->m_CellStarts.begin(), this->m_CellStarts.end() - 1 );
+  this->m_Points.resize( points.size() );
+  for( std::size_t i = 0; i < points.size(); ++i )
+  {
+    this->m_Points[ next[ cells[ i ] ]++ ] = points[ i ];
+  }
+
+} // end GridType::Build()
+
+
+/**
+ * ******************* GridType::FindNearestDistanceSquared *******************
+ */
+
+template <typename TInputImage>
+double
+SurfaceDistanceCalculator<TInputImage>
+::GridType::FindNearestDistanceSquared( const PointType & point,
+  double stopDistanceSquared ) const
+{
+  const double h = this->m_CellSize;
+
+  /** The cell of the point, clamped to the grid. */
+  long center[ ImageDimension ];
+  for( unsigned int d = 0; d < ImageDimension; ++d )
+  {
+    const double c = std::floor( ( point[ d ] - this->m_Origin[ d ] ) / h );
+    center[ d ] = static_cast<long>( std::max( 0.0,
+      std::min( c, static_cast<double>( this->m_Size[ d ] - 1 ) ) ) );
+  }
+
+  double best = std::numeric_limits<double>::max();
+  for( long r = 0; best > stopDistanceSquared; ++r )
+  {
+    /** The distance to the nearest face of the cells of ring r, on the
+     * sides where the ring lies in the grid. */
+    double lowerBound = std::numeric_limits<double>::max();
+    long lo[ ImageDimension ], hi[ ImageDimension ];
+    for( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+      lo[ d ] = std::max( 0L, center[ d ] - r );
+      hi[ d ] = std::min( this->m_Size[ d ] - 1, center[ d ] + r );
+      if( center[ d ] - r >= 0 )
+      {
+        const double gap = point[ d ] - ( this->m_Origin[ d ] + ( center[ d ] - r + 1 ) * h );
+        lowerBound = std::min( lowerBound, std::max( 0.0, gap ) );
+      }
+      if( center[ d ] + r < this->m_Size[ d ] )
+      {
+        const double gap = this->m_Origin[ d ] + ( center[ d ] + r ) * h - point[ d ];
+        lowerBound = std::min( lowerBound, std::max( 0.0, gap ) );
+      }
+    }
+    if( r == 0 ) lowerBound = 0.0;
+    if( lowerBound == std::numeric_limits<double>::max()
+      || best <= lowerBound * lowerBound )
+    {
+      break;
+    }
+
+    /** Visit the cells of the ring. Along dimension 0 only the two ends
+     * are on the ring when the other dimensions are inside it. */
+    long cell[ ImageDimension ];
+    for( unsigned int d = 1; d < ImageDimension; ++d ) cell[ d ] = lo[ d ];
+    bool done = false;
+    while( !done )
+    {
+      bool inside = r > 0;
+      for( unsigned int d = 1; d < ImageDimension; ++d )
+      {
+        inside &= std::abs( cell[ d ] - center[ d ] ) < r;
+      }
+      const long step = inside ? 2 * r : 1;
+      for( cell[ 0 ] = center[ 0 ] - r; cell[ 0 ] <= center[ 0 ] + r; cell[ 0 ] += step )
+      {
+        if( cell[ 0 ] < lo[ 0 ] || cell[ 0 ] > hi[ 0 ] ) continue;
+
+        /** Skip cells that cannot hold a closer point. */
+        double cellDistance = 0.0;
+        std::size_t c = 0;
+        for( int d = ImageDimension - 1; d >= 0; --d )
+        {
+          const double low = this->m_Origin[ d ] + cell[ d ] * h;
+          const double gap = std::max( low - point[ d ], point[ d ] - low - h );
+          if( gap > 0.0 ) cellDistance += gap * gap;
+          c = c * this->m_Size[ d ] + cell[ d ];
+        }
+        if( cellDistance >= best ) continue;
+
+        for( std::size_t i = this->m_CellStarts[ c ]; i < this->m_CellStarts[ c + 1 ]; ++i )
+        {
+          best = std::min( best, static_cast<double>(
+            point.SquaredEuclideanDistanceTo( this->m_Points[ i ] ) ) );
+        }
+      }
+
+      /** The next cell in the other dimensions. */
+      done = true;
+      for( unsigned int d = 1; d < ImageDimension; ++d )
+      {
+        if( ++cell[ d ] <= hi[ d ] )
+        {
+          done = false;
+          break;
+        }
+        cell[ d ] = lo[ d ];
+      }
+    }
+  }
+
+  return best;
+
+} // end GridType::FindNearestDistanceSquared()
+
+
+/**
+ * ******************* ComputeDirectedDistances *******************
+ */
+
+template <typename TInputImage>
+void
+SurfaceDistanceCalculator<TInputImage>
+::ComputeDirectedDistances( const PointContainerType & points,
+  const GridType & grid, bool bounded, double initialBound,
+  double & maximum, double & sum ) const
+{
+  ThreadStruct str;
+  str.Points = &points;
+  str.Grid = &grid;
+  str.Bounded = bounded;
+  str.InitialBound = initialBound;
+  str.Distances.assign( bounded ? 0 : points.size(), 0.0 );
+
+  MultiThreader::Pointer threader = MultiThreader::New();
+  threader->SetNumberOfThreads( this->m_NumberOfThreads );
+  str.Maxima.assign( threader->GetNumberOfThreads(), initialBound );
+  threader->SetSingleMethod( Self::ThreaderCallback, &str );
+  threader->SingleMethodExecute();
+
+  /** Every thread maximum is exact where it exceeds the initial bound. */
+  maximum = initialBound;
+  for( std::size_t t = 0; t < str.Maxima.size(); ++t )
+  {
+    maximum = std::max( maximum, str.Maxima[ t ] );
+  }
+
+  /** Sum in point order, independent of the number of threads. */
+  sum = 0.0;
+  for( std::size_t i = 0; i < str.Distances.size(); ++i )
+  {
+    sum += str.Distances[ i ];
+  }
+
+} // end ComputeDirectedDistances()
+
+
+/**
+ * ******************* ThreaderCallback *******************
+ */
+
+template <typename TInputImage>
+ITK_THREAD_RETURN_TYPE
+SurfaceDistanceCalculator<TInputImage>
+::ThreaderCallback( void * arg )
+{
+  typedef MultiThreader::ThreadInfoStruct ThreadInfoType;
+  ThreadInfoType * info = static_cast<ThreadInfoType *>( arg );
+  ThreadStruct * str = static_cast<ThreadStruct *>( info->UserData );
+  const unsigned int threadId = info->ThreadID;
+  const std::size_t numberOfThreads = info->NumberOfThreads;
+
+  const PointContainerType & points = *str->Points;
+  const std::size_t begin = points.size() * threadId / numberOfThreads;
+  const std::size_t end = points.size() * ( threadId + 1 ) / numberOfThreads;
+
+  double maximum = str->InitialBound;
+  if( !str->Bounded )
+  {
+    for( std::size_t i = begin; i < end; ++i )
+    {
+      const double distance = std::sqrt( str->Grid->FindNearestDistanceSquared( points[ i ], -1.0 ) );
+      str->Distances[ i ] = distance;
+      maximum = std::max( maximum, distance );
+    }
+  }
+  else
+  {
+    /** The distance to the nearest point is at most the bound of the
+     * previous point plus the distance between both. Points with a bound
+     * within the maximum cannot raise it, and are not searched; a search
+     * stops at the first point within the maximum. */
+    double previousBound = std::numeric_limits<double>::max();
+    for( std::size_t i = begin; i < end; ++i )
+    {
+      if( i > begin )
+      {
+        previousBound += points[ i ].EuclideanDistanceTo( points[ i - 1 ] );
+        if( previousBound <= maximum ) continue;
+      }
+      const double distance = std::sqrt(
+        str->Grid->FindNearestDistanceSquared( points[ i ], maximum * maximum ) );
+      maximum = std::max( maximum, distance );
+      previousBound = distance;
+    }
+  }
+  str->Maxima[ threadId ] = maximum;
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end ThreaderCallback()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template <typename TInputImage>
+void
+SurfaceDistanceCalculator<TInputImage>
+::PrintSelf( std::ostream& os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "ComputeAverageDistance: " << this->m_ComputeAverageDistance << std::endl;
+  os << indent << "NumberOfThreads: " << this->m_NumberOfThreads << std::endl;
+  os << indent << "HausdorffDistance: " << this->m_HausdorffDistance << std::endl;
+  os << indent << "AverageDistance: " << this->m_AverageDistance << std::endl;
+
+} // end PrintSelf()
+
+} // end namespace itk
+
+#endif // end #ifndef _itkSurfaceDistanceCalculator_txx_
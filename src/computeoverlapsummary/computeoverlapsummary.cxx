@@ -28,6 +28,8 @@
 #include "ITKToolsHelpers.h"
 #include "computeoverlapsummary.h"
 
+#include <fstream>
+
 
 /**
  * ******************* GetHelpString *******************
@@ -44,6 +46,14 @@ std::string GetHelpString( void )
     << "  -in2    Filename of second input image (Target Image)\n"
     << "  -out    Filename to write the results to\n"
     << "  -seperator    Seperator to use in csv file; default '\\t'\n"
+    << "  [-list] Filename of a list of pairs, instead of -in1, -in2 and -out;\n"
+    << "          every line holds: sourceImage targetImage outputFile\n"
+    << "          The pairs are processed concurrently, and images that occur\n"
+    << "          in more than one pair, e.g. the reference, are read once.\n"
+    << "  [-jobs] Maximum number of pairs processed concurrently;\n"
+    << "          default the number of threads\n"
+    << "  [-jobMemoryLimit] Approximate memory in MB for the concurrent pairs;\n"
+    << "          the number of jobs is bounded by it\n"
     << "The results file contains:\n"
     << "  Union Overlap or Jaccard coefficient; Mean Overlap or Dice coefficient;\n"
     << "Background is assumed to be 0. \n"
@@ -64,9 +74,15 @@ int main( int argc, char **argv )
   parser->SetCommandLineArguments( argc, argv );
   parser->SetProgramHelpText( GetHelpString() );
 
-  parser->MarkArgumentAsRequired( "-in1", "Filename of first input image (SourceImage)." );
-  parser->MarkArgumentAsRequired( "-in2", "Filename of second input image (Target Image)." );
-  parser->MarkArgumentAsRequired( "-out", "Filename to write the results to." );
+  std::string listFileName = "";
+  bool retlist = parser->GetCommandLineArgument( "-list", listFileName );
+
+  if( !retlist )
+  {
+    parser->MarkArgumentAsRequired( "-in1", "Filename of first input image (SourceImage)." );
+    parser->MarkArgumentAsRequired( "-in2", "Filename of second input image (Target Image)." );
+    parser->MarkArgumentAsRequired( "-out", "Filename to write the results to." );
+  }
 
   itk::CommandLineArgumentParser::ReturnValue validateArguments = parser->CheckForRequiredArguments();
 
@@ -97,6 +113,48 @@ int main( int argc, char **argv )
     seperator = "\t";
   }
 
+  unsigned int numberOfJobs = 0;
+  parser->GetCommandLineArgument( "-jobs", numberOfJobs );
+
+  unsigned int jobMemoryLimit = 0;
+  parser->GetCommandLineArgument( "-jobMemoryLimit", jobMemoryLimit );
+
+  /** Read the list of pairs. */
+  std::vector<std::string> inputFileNames1;
+  std::vector<std::string> inputFileNames2;
+  std::vector<std::string> outputFileNames;
+  if( retlist )
+  {
+    std::ifstream list( listFileName.c_str() );
+    if( !list.is_open() )
+    {
+      std::cerr << "ERROR: could not open the list " << listFileName << "." << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::string line;
+    while( std::getline( list, line ) )
+    {
+      std::istringstream lineStream( line );
+      std::string fileName1, fileName2, fileNameOut;
+      if( !( lineStream >> fileName1 ) || fileName1[ 0 ] == '#' ) continue;
+      if( !( lineStream >> fileName2 >> fileNameOut ) )
+      {
+        std::cerr << "ERROR: every line of the list should hold"
+          << " a source image, a target image and an output file." << std::endl;
+        return EXIT_FAILURE;
+      }
+      inputFileNames1.push_back( fileName1 );
+      inputFileNames2.push_back( fileName2 );
+      outputFileNames.push_back( fileNameOut );
+    }
+    if( outputFileNames.empty() )
+    {
+      std::cerr << "ERROR: the list " << listFileName << " holds no pairs." << std::endl;
+      return EXIT_FAILURE;
+    }
+    inputFileName1 = inputFileNames1[ 0 ];
+  }
+
   /** Determine image properties. */
   itk::ImageIOBase::IOPixelType pixelType = itk::ImageIOBase::UNKNOWNPIXELTYPE;
   itk::ImageIOBase::IOComponentType componentType = itk::ImageIOBase::UNKNOWNCOMPONENTTYPE;
@@ -136,7 +194,13 @@ int main( int argc, char **argv )
     filter->m_InputFileName2 = inputFileName2;
     filter->m_OutputFileName = outputFileName;
     filter->m_Seperator      = seperator;
+    filter->m_InputFileNames1 = inputFileNames1;
+    filter->m_InputFileNames2 = inputFileNames2;
+    filter->m_OutputFileNames = outputFileNames;
+    filter->m_NumberOfJobs   = numberOfJobs;
+    filter->m_JobMemoryLimit = jobMemoryLimit;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
@@ -22,6 +22,11 @@
 
 #include "itkImageFileReader.h"
 #include "itkLabelOverlapMeasuresImageFilter.h"
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
+#include <algorithm>
+#include <map>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -41,6 +46,8 @@ public:
     this->m_InputFileName2 = "";
     this->m_OutputFileName = "";
     this->m_Seperator      = "\t";
+    this->m_NumberOfJobs   = 0;
+    this->m_JobMemoryLimit = 0;
   };
   /** Destructor. */
   ~ITKToolsComputeOverlapSummaryBase(){};
@@ -51,6 +58,23 @@ public:
   std::string m_OutputFileName;
   std::string m_Seperator;
 
+  /** The list mode: pairs of images and their output files. If given,
+   * these are processed instead of m_InputFileName1 and m_InputFileName2.
+   */
+  std::vector<std::string> m_InputFileNames1;
+  std::vector<std::string> m_InputFileNames2;
+  std::vector<std::string> m_OutputFileNames;
+
+  /** The maximum number of pairs that are processed concurrently;
+   * 0 means the default number of threads.
+   */
+  unsigned int m_NumberOfJobs;
+
+  /** The approximate memory in MB available for the concurrent pairs;
+   * 0 means unlimited. Bounds the number of jobs further.
+   */
+  unsigned int m_JobMemoryLimit;
+
 }; // end class ITKToolsComputeOverlapSummaryBase
 
 class invalidfilexception: public std::exception
@@ -79,25 +103,237 @@ public:
   ITKToolsComputeOverlapSummary(){};
   ~ITKToolsComputeOverlapSummary(){};
 
+  /** Typedef's. */
+  typedef itk::Image< TComponentType, VDimension >  InputImageType;
+  typedef typename InputImageType::Pointer          InputImagePointer;
+  typedef itk::ImageFileReader<InputImageType>      ReaderType;
+  typedef itk::LabelOverlapMeasuresImageFilter<InputImageType> FilterType;
+
   /** Run function. */
   void Run( void )
   {
-    typedef itk::Image< TComponentType, VDimension >  InputImageType;
-    typedef itk::ImageFileReader<InputImageType>      ReaderType;
-    typedef itk::LabelOverlapMeasuresImageFilter<InputImageType> FilterType;
+    if( this->m_OutputFileNames.size() > 0 )
+    {
+      this->RunList();
+      return;
+    }
 
     typename ReaderType::Pointer reader1 = ReaderType::New();
     reader1->SetFileName( this->m_InputFileName1.c_str() );
     typename ReaderType::Pointer reader2 = ReaderType::New();
     reader2->SetFileName( this->m_InputFileName2.c_str() );
 
+    this->ComputeAndWriteSummary( reader1->GetOutput(), reader2->GetOutput(),
+      this->m_OutputFileName, 0 );
+
+  } // end Run()
+
+protected:
+
+  /** A read-once image, shared by all pairs that use it. */
+  struct CachedImage
+  {
+    CachedImage() : RemainingUses( 0 ) {}
+    InputImagePointer   Image;
+    unsigned int        RemainingUses;
+  };
+  typedef std::map<std::string, CachedImage>        ImageCacheType;
+
+  /** The data shared by the job threads. */
+  struct JobStruct
+  {
+    Self *                      Tool;
+    std::size_t                 NextPair;
+    unsigned int                NumberOfJobs;
+    ImageCacheType              Cache;
+    std::vector<std::string>    Errors;
+    itk::SimpleFastMutexLock    Mutex;
+  };
+
+  /** Process the list of pairs concurrently. Images that occur in more
+   * than one pair, typically the reference segmentations, are read once
+   * and released after their last pair. The number of concurrent pairs
+   * is bounded by m_NumberOfJobs and m_JobMemoryLimit; every pair is
+   * then computed single-threaded.
+   */
+  void RunList( void )
+  {
+    const std::size_t numberOfPairs = this->m_OutputFileNames.size();
+
+    JobStruct str;
+    str.Tool = this;
+    str.NextPair = 0;
+    for( std::size_t i = 0; i < numberOfPairs; ++i )
+    {
+      ++str.Cache[ this->m_InputFileNames1[ i ] ].RemainingUses;
+      ++str.Cache[ this->m_InputFileNames2[ i ] ].RemainingUses;
+    }
+    for( typename ImageCacheType::iterator it = str.Cache.begin(); it != str.Cache.end(); )
+    {
+      if( it->second.RemainingUses < 2 ) str.Cache.erase( it++ );
+      else ++it;
+    }
+
+    /** Determine the number of concurrent jobs. */
+    unsigned int numberOfJobs = this->m_NumberOfJobs > 0
+      ? this->m_NumberOfJobs : itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+    if( this->m_JobMemoryLimit > 0 )
+    {
+      typename ReaderType::Pointer informationReader = ReaderType::New();
+      informationReader->SetFileName( this->m_InputFileNames1[ 0 ].c_str() );
+      informationReader->UpdateOutputInformation();
+      const double imageSizeInMB = static_cast<double>(
+        informationReader->GetOutput()->GetLargestPossibleRegion().GetNumberOfPixels() )
+        * sizeof( TComponentType ) / 1048576.0;
+      const unsigned int jobsForLimit = static_cast<unsigned int>(
+        this->m_JobMemoryLimit / std::max( 2.0 * imageSizeInMB, 1.0 ) );
+      numberOfJobs = std::min( numberOfJobs, std::max( jobsForLimit, 1u ) );
+    }
+    numberOfJobs = std::min( numberOfJobs, static_cast<unsigned int>( numberOfPairs ) );
+    numberOfJobs = std::min( numberOfJobs, static_cast<unsigned int>( ITK_MAX_THREADS ) );
+    str.NumberOfJobs = numberOfJobs;
+
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    threader->SetNumberOfThreads( numberOfJobs );
+    threader->SetSingleMethod( Self::JobThreaderCallback, &str );
+    threader->SingleMethodExecute();
+
+    if( str.Errors.size() > 0 )
+    {
+      std::ostringstream errors;
+      for( std::size_t i = 0; i < str.Errors.size(); ++i )
+      {
+        errors << str.Errors[ i ] << "\n";
+      }
+      itkGenericExceptionMacro( << "ERROR: " << str.Errors.size() << " of "
+        << numberOfPairs << " pairs failed:\n" << errors.str() );
+    }
+  } // end RunList()
+
+
+  /** Every job thread takes the next pair from the list until none is left. */
+  static ITK_THREAD_RETURN_TYPE JobThreaderCallback( void * arg )
+  {
+    typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+    ThreadInfoType * info = static_cast<ThreadInfoType *>( arg );
+    JobStruct * str = static_cast<JobStruct *>( info->UserData );
+    Self * tool = str->Tool;
+    const unsigned int numberOfThreads = str->NumberOfJobs > 1 ? 1 : 0;
+
+    while( true )
+    {
+      str->Mutex.Lock();
+      const std::size_t pair = str->NextPair++;
+      str->Mutex.Unlock();
+      if( pair >= tool->m_OutputFileNames.size() ) break;
+
+      const std::string & fileName1 = tool->m_InputFileNames1[ pair ];
+      const std::string & fileName2 = tool->m_InputFileNames2[ pair ];
+      try
+      {
+        InputImagePointer image1 = tool->GetImage( *str, fileName1 );
+        InputImagePointer image2 = tool->GetImage( *str, fileName2 );
+        tool->ComputeAndWriteSummary( image1, image2,
+          tool->m_OutputFileNames[ pair ], numberOfThreads );
+      }
+      catch( itk::ExceptionObject & excp )
+      {
+        str->Mutex.Lock();
+        str->Errors.push_back( fileName1 + " " + fileName2 + ": " + excp.GetDescription() );
+        str->Mutex.Unlock();
+      }
+      catch( std::exception & excp )
+      {
+        str->Mutex.Lock();
+        str->Errors.push_back( fileName1 + " " + fileName2 + ": " + excp.what() );
+        str->Mutex.Unlock();
+      }
+
+      tool->ReleaseImage( *str, fileName1 );
+      tool->ReleaseImage( *str, fileName2 );
+    }
+
+    return ITK_THREAD_RETURN_VALUE;
+  } // end JobThreaderCallback()
+
+
+  /** Read an image, or take it from the cache if it is shared. The
+   * returned image shares the pixel buffer of the cached image, but not
+   * its pipeline state, so that it can be used by concurrent filters.
+   */
+  InputImagePointer GetImage( JobStruct & str, const std::string & fileName ) const
+  {
+    str.Mutex.Lock();
+    typename ImageCacheType::iterator it = str.Cache.find( fileName );
+    if( it == str.Cache.end() )
+    {
+      str.Mutex.Unlock();
+      return this->ReadImage( fileName );
+    }
+
+    /** The lock is held while reading, so that shared images are read once. */
+    InputImagePointer image = InputImageType::New();
+    try
+    {
+      if( it->second.Image.IsNull() )
+      {
+        it->second.Image = this->ReadImage( fileName );
+      }
+      const InputImageType * cached = it->second.Image;
+      image->CopyInformation( cached );
+      image->SetRegions( cached->GetLargestPossibleRegion() );
+      image->SetPixelContainer( const_cast<InputImageType *>( cached )->GetPixelContainer() );
+    }
+    catch( ... )
+    {
+      str.Mutex.Unlock();
+      throw;
+    }
+    str.Mutex.Unlock();
+
+    return image;
+  } // end GetImage()
+
+
+  /** Release a shared image after its last pair. */
+  void ReleaseImage( JobStruct & str, const std::string & fileName ) const
+  {
+    str.Mutex.Lock();
+    typename ImageCacheType::iterator it = str.Cache.find( fileName );
+    if( it != str.Cache.end() && --it->second.RemainingUses == 0 )
+    {
+      str.Cache.erase( it );
+    }
+    str.Mutex.Unlock();
+  } // end ReleaseImage()
+
+
+  /** Read an image. */
+  InputImagePointer ReadImage( const std::string & fileName ) const
+  {
+    typename ReaderType::Pointer reader = ReaderType::New();
+    reader->SetFileName( fileName.c_str() );
+    reader->Update();
+    InputImagePointer image = reader->GetOutput();
+    image->DisconnectPipeline();
+    return image;
+  } // end ReadImage()
+
+
+  /** Compute the overlap measures of two images and write them to a file.
+   * If numberOfThreads is 0, the default number of threads is used.
+   */
+  void ComputeAndWriteSummary( InputImageType * image1, InputImageType * image2,
+    const std::string & outputFileName, const unsigned int numberOfThreads ) const
+  {
     typename FilterType::Pointer filter = FilterType::New();
-    filter->SetSourceImage( reader1->GetOutput() );
-    filter->SetTargetImage( reader2->GetOutput() );
+    filter->SetSourceImage( image1 );
+    filter->SetTargetImage( image2 );
+    if( numberOfThreads > 0 ) filter->SetNumberOfThreads( numberOfThreads );
     filter->Update();
 
     FILE * pFile;
-    pFile = fopen( this->m_OutputFileName.c_str(), "w" );
+    pFile = fopen( outputFileName.c_str(), "w" );
 
     if( pFile == NULL )
     {
@@ -139,7 +375,7 @@ public:
     }
     fclose ( pFile );
 
-  } // end Run()
+  } // end ComputeAndWriteSummary()
 
 }; // end class ITKToolsComputeOverlapSummary
 
@@ -0,0 +1,170 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+/** \file
+ \brief Compute several reductions of an image in one pass.
+
+ \verbinclude computereductions.help
+ */
+
+/** Setup Mevislab DicomTiff IO support */
+#include "itkUseMevisDicomTiff.h"
+
+#include "itkCommandLineArgumentParser.h"
+#include "ITKToolsHelpers.h"
+#include "computereductions.h"
+
+
+/**
+ * ******************* GetHelpString *******************
+ */
+
+std::string GetHelpString( void )
+{
+  std::stringstream ss;
+  ss << "ITKTools v" << itktools::GetITKToolsVersion() << "\n"
+    << "This program computes several reductions of an image,\n"
+    << "in a single multithreaded pass over the image.\n"
+    << "Usage:\n"
+    << "pxcomputereductions\n"
+    << "  -in      inputFilename\n"
+    << "  -ops     the reductions, any of:\n"
+    << "             SUM:          the sum of the pixels\n"
+    << "             MEAN:         the mean of the pixels\n"
+    << "             COUNTNONZERO: the number and volume of the non-zero pixels, like pxcountnonzerovoxels\n"
+    << "             BOUNDINGBOX:  the bounding box of the pixels > 0, like pxcomputeboundingbox\n"
+    << "             MINIMUM:      the minimum pixel value\n"
+    << "             MAXIMUM:      the maximum pixel value\n"
+    << "  [-p]     the output precision, default = 6\n"
+    << "The results are printed in the order of -ops.\n"
+    << "Supported: 2D, 3D, (unsigned) char, (unsigned) short, (unsigned) int, float, double.";
+
+  return ss.str();
+
+} // end GetHelpString()
+
+
+//-------------------------------------------------------------------------------------
+
+int main( int argc, char **argv )
+{
+  RegisterMevisDicomTiff();
+
+  /** Create a command line argument parser. */
+  itk::CommandLineArgumentParser::Pointer parser = itk::CommandLineArgumentParser::New();
+  parser->SetCommandLineArguments( argc, argv );
+  parser->SetProgramHelpText( GetHelpString() );
+
+  parser->MarkArgumentAsRequired( "-in", "The input filename." );
+  parser->MarkArgumentAsRequired( "-ops", "The reductions." );
+
+  itk::CommandLineArgumentParser::ReturnValue validateArguments = parser->CheckForRequiredArguments();
+
+  if( validateArguments == itk::CommandLineArgumentParser::FAILED )
+  {
+    return EXIT_FAILURE;
+  }
+  else if( validateArguments == itk::CommandLineArgumentParser::HELPREQUESTED )
+  {
+    return EXIT_SUCCESS;
+  }
+
+  /** Get arguments. */
+  std::string inputFileName = "";
+  parser->GetCommandLineArgument( "-in", inputFileName );
+
+  std::vector<std::string> operations;
+  parser->GetCommandLineArgument( "-ops", operations );
+
+  unsigned int precision = 6;
+  parser->GetCommandLineArgument( "-p", precision );
+
+  /** Check the operations. */
+  for( std::size_t i = 0; i < operations.size(); ++i )
+  {
+    const std::string & operation = operations[ i ];
+    if( operation != "SUM" && operation != "MEAN" && operation != "COUNTNONZERO"
+      && operation != "BOUNDINGBOX" && operation != "MINIMUM" && operation != "MAXIMUM" )
+    {
+      std::cerr << "ERROR: unknown reduction \"" << operation << "\"." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  /** Determine image properties. */
+  itk::ImageIOBase::IOPixelType pixelType = itk::ImageIOBase::UNKNOWNPIXELTYPE;
+  itk::ImageIOBase::IOComponentType componentType = itk::ImageIOBase::UNKNOWNCOMPONENTTYPE;
+  unsigned int dim = 0;
+  unsigned int numberOfComponents = 0;
+  bool retgip = itktools::GetImageProperties(
+    inputFileName, pixelType, componentType, dim, numberOfComponents );
+  if( !retgip ) return EXIT_FAILURE;
+
+  /** Check for vector images. */
+  bool retNOCCheck = itktools::NumberOfComponentsCheck( numberOfComponents );
+  if( !retNOCCheck ) return EXIT_FAILURE;
+
+  /** Class that does the work. */
+  ITKToolsComputeReductionsBase * filter = 0;
+
+  try
+  {
+    // now call all possible template combinations.
+    if( !filter ) filter = ITKToolsComputeReductions< 2, char >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsComputeReductions< 2, unsigned char >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsComputeReductions< 2, short >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsComputeReductions< 2, unsigned short >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsComputeReductions< 2, int >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsComputeReductions< 2, unsigned int >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsComputeReductions< 2, float >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsComputeReductions< 2, double >::New( dim, componentType );
+
+#ifdef ITKTOOLS_3D_SUPPORT
+    if( !filter ) filter = ITKToolsComputeReductions< 3, char >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsComputeReductions< 3, unsigned char >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsComputeReductions< 3, short >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsComputeReductions< 3, unsigned short >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsComputeReductions< 3, int >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsComputeReductions< 3, unsigned int >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsComputeReductions< 3, float >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsComputeReductions< 3, double >::New( dim, componentType );
+#endif
+    /** Check if filter was instantiated. */
+    bool supported = itktools::IsFilterSupportedCheck( filter, dim, componentType );
+    if( !supported ) return EXIT_FAILURE;
+
+    /** Set the filter arguments. */
+    filter->m_InputFileName = inputFileName;
+    filter->m_Operations = operations;
+    filter->m_Precision = precision;
+
+    filter->ReadCommonArguments( parser );
+    filter->Run();
+
+    delete filter;
+  }
+  catch( itk::ExceptionObject & excp )
+  {
+    std::cerr << "ERROR: Caught ITK exception: " << excp << std::endl;
+    delete filter;
+    return EXIT_FAILURE;
+  }
+
+  /** End program. */
+  return EXIT_SUCCESS;
+
+} // end main
@@ -0,0 +1,152 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __computereductions_h_
+#define __computereductions_h_
+
+#include "ITKToolsBase.h"
+
+#include "itkImageReductionsFilter.h"
+#include "ITKToolsMemoryMapping.h"
+#include <iomanip>
+
+
+/** \class ITKToolsComputeReductionsBase
+ *
+ * Untemplated pure virtual base class that holds
+ * the Run() function and all required parameters.
+ */
+
+class ITKToolsComputeReductionsBase : public itktools::ITKToolsBase
+{
+public:
+  /** Constructor. */
+  ITKToolsComputeReductionsBase()
+  {
+    this->m_InputFileName = "";
+    this->m_Operations = std::vector<std::string>();
+    this->m_Precision = 6;
+  }
+  /** Destructor. */
+  ~ITKToolsComputeReductionsBase(){};
+
+  /** Input member parameters. */
+  std::string              m_InputFileName;
+  std::vector<std::string> m_Operations;
+  unsigned int             m_Precision;
+
+}; // end ITKToolsComputeReductionsBase
+
+
+/** \class ITKToolsComputeReductions
+ *
+ * Templated class that implements the Run() function
+ * and the New() function for its creation.
+ */
+
+template< unsigned int VDimension, class TComponentType >
+class ITKToolsComputeReductions : public ITKToolsComputeReductionsBase
+{
+public:
+  /** Standard ITKTools stuff. */
+  typedef ITKToolsComputeReductions Self;
+  itktoolsOneTypeNewMacro( Self );
+
+  ITKToolsComputeReductions(){};
+  ~ITKToolsComputeReductions(){};
+
+  /** Run function. */
+  void Run( void )
+  {
+    /** Typedefs. */
+    typedef itk::Image<TComponentType, VDimension>      InputImageType;
+    typedef itk::ImageReductionsFilter<
+      InputImageType>                                   ReductionsFilterType;
+    typedef typename InputImageType::IndexType          IndexType;
+    typedef typename InputImageType::PointType          PointType;
+    typedef typename itk::NumericTraits<
+      TComponentType>::PrintType                        PrintType;
+
+    /** Read input image, memory mapped if possible. */
+    typename InputImageType::Pointer image
+      = itktools::ReadImage<InputImageType>( this->m_InputFileName );
+
+    /** Select the reductions, and compute them in one pass. */
+    typename ReductionsFilterType::Pointer reductions = ReductionsFilterType::New();
+    reductions->SetInput( image );
+    for( std::size_t i = 0; i < this->m_Operations.size(); ++i )
+    {
+      const std::string & operation = this->m_Operations[ i ];
+      if( operation == "SUM" || operation == "MEAN" ) reductions->ComputeSumOn();
+      else if( operation == "COUNTNONZERO" ) reductions->ComputeNonZeroCountOn();
+      else if( operation == "BOUNDINGBOX" ) reductions->ComputeBoundingBoxOn();
+      else if( operation == "MINIMUM" || operation == "MAXIMUM" ) reductions->ComputeMinimumMaximumOn();
+    }
+    this->ObserveProcess( reductions.GetPointer(), "reductions" );
+    reductions->Update();
+
+    /** Print output, in the order of the operations. */
+    std::cout << std::setprecision( this->m_Precision );
+    for( std::size_t i = 0; i < this->m_Operations.size(); ++i )
+    {
+      const std::string & operation = this->m_Operations[ i ];
+      if( operation == "SUM" )
+      {
+        std::cout << "sum: " << reductions->GetSum() << std::endl;
+      }
+      else if( operation == "MEAN" )
+      {
+        std::cout << "mean: " << reductions->GetMean() << std::endl;
+      }
+      else if( operation == "COUNTNONZERO" )
+      {
+        double voxelVolume = 1.0;
+        for( unsigned int d = 0; d < VDimension; ++d )
+        {
+          voxelVolume *= image->GetSpacing()[ d ];
+        }
+        std::cout << "count: " << reductions->GetNonZeroCount() << std::endl;
+        std::cout << "volume: " << reductions->GetNonZeroCount() * voxelVolume / 1000.0 << std::endl;
+      }
+      else if( operation == "BOUNDINGBOX" )
+      {
+        const IndexType & minIndex = reductions->GetBoundingBoxMinimumIndex();
+        const IndexType & maxIndex = reductions->GetBoundingBoxMaximumIndex();
+        PointType minPoint;
+        PointType maxPoint;
+        image->TransformIndexToPhysicalPoint( minIndex, minPoint );
+        image->TransformIndexToPhysicalPoint( maxIndex, maxPoint );
+        std::cout << "MinimumIndex = " << minIndex << "\n"
+          << "MaximumIndex = " << maxIndex << "\n"
+          << "MinimumPoint = " << minPoint << "\n"
+          << "MaximumPoint = " << maxPoint << std::endl;
+      }
+      else if( operation == "MINIMUM" )
+      {
+        std::cout << "minimum: " << static_cast<PrintType>( reductions->GetMinimum() ) << std::endl;
+      }
+      else if( operation == "MAXIMUM" )
+      {
+        std::cout << "maximum: " << static_cast<PrintType>( reductions->GetMaximum() ) << std::endl;
+      }
+    }
+
+  } // end Run()
+
+}; // end class ITKToolsComputeReductions
+
+#endif // end #ifndef __computereductions_h_
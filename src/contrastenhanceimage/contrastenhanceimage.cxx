@@ -53,7 +53,15 @@ std::string GetHelpString( void )
     << "-r1    \tInteger radius of window, dimension 1\n"
     << "[-r2]  \tInteger radius of window, dimension 2\n"
     << "[-LUT] \tUse Lookup-table <true, false>;\n"
-    << "default = true; Faster, but requires more memory.";
+    << "default = true; Faster, but requires more memory.\n"
+    << "[-clahe]\tUse tile-interpolated contrast limited adaptive histogram\n"
+    << "       \tequalization instead: the clipped histograms are computed on a\n"
+    << "       \tgrid of tiles, and their mappings are interpolated per voxel.\n"
+    << "       \tMuch faster; -alpha, -beta and -r are then not used.\n"
+    << "[-tiles]\tThe number of tiles, one value, or one per dimension; default 8\n"
+    << "[-clip]\tThe clip limit, relative to the mean bin count; default 3.0.\n"
+    << "       \t0 disables clipping.\n"
+    << "[-bins]\tThe number of histogram bins; default 256";
 
   return ss.str();
 
@@ -72,8 +80,12 @@ int main( int argc, char** argv )
 
   parser->MarkArgumentAsRequired( "-in", "The input filename." );
   parser->MarkArgumentAsRequired( "-out", "The output filename." );
-  parser->MarkArgumentAsRequired( "-alpha", "Alpha." );
-  parser->MarkArgumentAsRequired( "-beta", "Beta." );
+  const bool useCLAHE = parser->ArgumentExists( "-clahe" );
+  if( !useCLAHE )
+  {
+    parser->MarkArgumentAsRequired( "-alpha", "Alpha." );
+    parser->MarkArgumentAsRequired( "-beta", "Beta." );
+  }
 
   itk::CommandLineArgumentParser::ReturnValue validateArguments = parser->CheckForRequiredArguments();
 
@@ -105,6 +117,15 @@ int main( int argc, char** argv )
   std::vector<unsigned int> radius;
   parser->GetCommandLineArgument( "-r", radius );
 
+  std::vector<unsigned int> numberOfTiles;
+  parser->GetCommandLineArgument( "-tiles", numberOfTiles );
+
+  double clipLimit = 3.0;
+  parser->GetCommandLineArgument( "-clip", clipLimit );
+
+  unsigned int numberOfBins = 256;
+  parser->GetCommandLineArgument( "-bins", numberOfBins );
+
   /** Determine image properties. */
   itk::ImageIOBase::IOPixelType pixelType = itk::ImageIOBase::UNKNOWNPIXELTYPE;
   itk::ImageIOBase::IOComponentType componentType = itk::ImageIOBase::UNKNOWNCOMPONENTTYPE;
@@ -114,6 +135,13 @@ int main( int argc, char** argv )
     inputFileName, pixelType, componentType, dim, numberOfComponents );
   if( !retgip ) return EXIT_FAILURE;
 
+  if( !useCLAHE && radius.size() != dim )
+  {
+    std::cerr << "ERROR: You should specify \"-r\", followed by " << dim
+      << " radii." << std::endl;
+    return EXIT_FAILURE;
+  }
+
   /** Class that does the work. */
   ITKToolsContrastEnhanceImageBase * filter = NULL;
 
@@ -140,7 +168,12 @@ int main( int argc, char** argv )
     filter->m_Beta = beta;
     filter->m_LookUpTable = lookUpTable;
     filter->m_Radius = radius;
+    filter->m_UseCLAHE = useCLAHE;
+    filter->m_NumberOfTiles = numberOfTiles;
+    filter->m_ClipLimit = clipLimit;
+    filter->m_NumberOfBins = numberOfBins;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
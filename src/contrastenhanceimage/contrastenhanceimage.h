@@ -28,6 +28,7 @@
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
 #include "itkAdaptiveHistogramEqualizationImageFilter.h"
+#include "itkTileInterpolatedCLAHEImageFilter.h"
 
 
 /** \class ITKToolsContrastEnhanceImageBase
@@ -47,6 +48,9 @@ public:
     this->m_InputFileName = "";
     this->m_OutputFileName = "";
     this->m_LookUpTable = false;
+    this->m_UseCLAHE = false;
+    this->m_ClipLimit = 3.0;
+    this->m_NumberOfBins = 256;
   };
   /** Destructor. */
   ~ITKToolsContrastEnhanceImageBase(){};
@@ -59,6 +63,12 @@ public:
   bool m_LookUpTable;
   std::vector<unsigned int> m_Radius;
 
+  /** The tile-interpolated CLAHE mode. */
+  bool m_UseCLAHE;
+  std::vector<unsigned int> m_NumberOfTiles;
+  double m_ClipLimit;
+  unsigned int m_NumberOfBins;
+
 }; // end class ITKToolsContrastEnhanceImageBase
 
 
@@ -88,6 +98,37 @@ public:
       ImageType >                                 EnhancerType;
     typedef itk::ImageFileWriter<ImageType>       WriterType;
     typedef typename EnhancerType::ImageSizeType  RadiusType;
+    typedef itk::TileInterpolatedCLAHEImageFilter<
+      ImageType >                                 CLAHEType;
+
+    /** Try to read input image */
+    typename ReaderType::Pointer reader = ReaderType::New();
+    reader->SetFileName( this->m_InputFileName.c_str() );
+
+    typename WriterType::Pointer writer = WriterType::New();
+    writer->SetFileName( this->m_OutputFileName.c_str() );
+
+    /** Tile-interpolated CLAHE. */
+    if( this->m_UseCLAHE )
+    {
+      typename CLAHEType::TilesType tiles;
+      tiles.Fill( 8 );
+      for( unsigned int i = 0; i < VDimension && !this->m_NumberOfTiles.empty(); ++i )
+      {
+        tiles[ i ] = this->m_NumberOfTiles[
+          this->m_NumberOfTiles.size() == VDimension ? i : 0 ];
+      }
+
+      typename CLAHEType::Pointer clahe = CLAHEType::New();
+      clahe->SetNumberOfTiles( tiles );
+      clahe->SetClipLimit( this->m_ClipLimit );
+      clahe->SetNumberOfBins( this->m_NumberOfBins );
+      clahe->SetInput( reader->GetOutput() );
+
+      writer->SetInput( clahe->GetOutput() );
+      writer->Update();
+      return;
+    }
 
     /** vars */
     itk::Size<VDimension> radiusSize;
@@ -96,9 +137,6 @@ public:
       radiusSize[ i ] = this->m_Radius[ i ];
     }
 
-    /** Try to read input image */
-    typename ReaderType::Pointer reader = ReaderType::New();
-    reader->SetFileName( this->m_InputFileName.c_str() );
     reader->Update();
 
     /** Setup pipeline and configure its components */
@@ -109,9 +147,7 @@ public:
     enhancer->SetRadius( radiusSize );
     enhancer->SetInput( reader->GetOutput() );
 
-    typename WriterType::Pointer writer = WriterType::New();
     writer->SetInput( enhancer->GetOutput() );
-    writer->SetFileName( this->m_OutputFileName.c_str() );
     writer->Update();
 
   } // end Run()
@@ -0,0 +1,148 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkTileInterpolatedCLAHEImageFilter_h_
+#define __itkTileInterpolatedCLAHEImageFilter_h_
+
+#include "itkImageToImageFilter.h"
+#include "itkFixedArray.h"
+#include <vector>
+
+
+namespace itk
+{
+
+/** \class TileInterpolatedCLAHEImageFilter
+ * \brief Contrast limited adaptive histogram equalization on a grid of tiles.
+ *
+ * The image is divided in NumberOfTiles tiles per dimension. For every
+ * tile a histogram of NumberOfBins bins over the intensity range of the
+ * image is computed, clipped at ClipLimit times the mean bin count, with
+ * the excess spread evenly over the bins, and turned into an equalizing
+ * mapping. The tiles are processed in parallel. The output at a voxel is
+ * the (bi- or tri-)linear interpolation of the mappings of the 2^D tiles
+ * around it, with the tile centers as nodes; beyond the outer centers the
+ * nearest mappings are used.
+ *
+ * Compared to the AdaptiveHistogramEqualizationImageFilter, which computes
+ * a histogram in a window around every voxel, the cost is a few passes
+ * over the image, independent of the tile size.
+ *
+ * A ClipLimit of 0 disables the clipping, which gives plain adaptive
+ * histogram equalization.
+ *
+ * \ingroup IntensityImageFilters
+ */
+
+template< class TImage >
+class ITK_EXPORT TileInterpolatedCLAHEImageFilter :
+  public ImageToImageFilter< TImage, TImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef TileInterpolatedCLAHEImageFilter    Self;
+  typedef ImageToImageFilter< TImage, TImage > Superclass;
+  typedef SmartPointer<Self>                  Pointer;
+  typedef SmartPointer<const Self>            ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( TileInterpolatedCLAHEImageFilter, ImageToImageFilter );
+
+  itkStaticConstMacro( ImageDimension, unsigned int, TImage::ImageDimension );
+
+  /** Typedefs. */
+  typedef TImage                                      ImageType;
+  typedef typename ImageType::PixelType               PixelType;
+  typedef typename ImageType::RegionType              OutputImageRegionType;
+  typedef typename ImageType::IndexType               IndexType;
+  typedef typename ImageType::SizeType                SizeType;
+  typedef FixedArray< unsigned int,
+    itkGetStaticConstMacro( ImageDimension ) >        TilesType;
+
+  /** Set/Get the number of tiles per dimension. Default 8. */
+  itkSetMacro( NumberOfTiles, TilesType );
+  itkGetConstReferenceMacro( NumberOfTiles, TilesType );
+
+  /** Set/Get the clip limit, relative to the mean bin count. Default 3. */
+  itkSetMacro( ClipLimit, double );
+  itkGetConstMacro( ClipLimit, double );
+
+  /** Set/Get the number of histogram bins. Default 256. For integer images
+   * with a smaller range every value gets its own bin. */
+  itkSetMacro( NumberOfBins, unsigned int );
+  itkGetConstMacro( NumberOfBins, unsigned int );
+
+protected:
+  TileInterpolatedCLAHEImageFilter();
+  virtual ~TileInterpolatedCLAHEImageFilter() {};
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** The mappings need the whole input. */
+  virtual void GenerateInputRequestedRegion( void );
+
+  /** Compute the intensity range, and the mappings of the tiles in
+   * parallel. */
+  virtual void BeforeThreadedGenerateData( void );
+
+  /** Interpolate the mappings of the tiles around every voxel. */
+  void ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+    ThreadIdType threadId );
+
+  /** Every thread computes the mappings of every NumberOfThreads-th tile. */
+  static ITK_THREAD_RETURN_TYPE TileThreaderCallback( void * arg );
+  void ThreadedComputeTileMappings( ThreadIdType threadId, ThreadIdType numberOfThreads );
+
+  /** The region of a tile, from its grid position. */
+  OutputImageRegionType GetTileRegion( const IndexType & tile ) const;
+
+  /** The bin of an intensity. */
+  unsigned int GetBin( double value ) const;
+
+private:
+  TileInterpolatedCLAHEImageFilter( const Self & ); // purposely not implemented
+  void operator=( const Self & );                   // purposely not implemented
+
+  TilesType             m_NumberOfTiles;
+  double                m_ClipLimit;
+  unsigned int          m_NumberOfBins;
+
+  /** The intensity range and the bins actually used. */
+  double                m_Minimum;
+  double                m_Maximum;
+  double                m_BinScale;
+  unsigned int          m_NumberOfUsedBins;
+
+  /** The number of tiles, and per tile the mapped value of every bin. */
+  TilesType             m_Tiles;
+  std::vector<double>   m_Mappings;
+
+  /** Per dimension and index: the lower tile and the weight of the upper. */
+  std::vector<unsigned int> m_LowerTile[ ImageDimension ];
+  std::vector<double>       m_UpperWeight[ ImageDimension ];
+
+}; // end class TileInterpolatedCLAHEImageFilter
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkTileInterpolatedCLAHEImageFilter.txx"
+#endif
+
+#endif // end #ifndef __itkTileInterpolatedCLAHEImageFilter_h_
@@ -0,0 +1,416 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkTileInterpolatedCLAHEImageFilter_txx_
+#define __itkTileInterpolatedCLAHEImageFilter_txx_
+
+#include "itkTileInterpolatedCLAHEImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageLinearConstIteratorWithIndex.h"
+#include "itkImageLinearIteratorWithIndex.h"
+#include "itkNumericTraits.h"
+#include "itkProgressReporter.h"
+#include "vnl/vnl_math.h"
+
+namespace itk
+{
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template< class TImage >
+TileInterpolatedCLAHEImageFilter< TImage >
+::TileInterpolatedCLAHEImageFilter()
+{
+  this->m_NumberOfTiles.Fill( 8 );
+  this->m_ClipLimit = 3.0;
+  this->m_NumberOfBins = 256;
+
+  this->m_Minimum = 0.0;
+  this->m_Maximum = 0.0;
+  this->m_BinScale = 0.0;
+  this->m_NumberOfUsedBins = 1;
+  this->m_Tiles.Fill( 1 );
+
+} // end Constructor
+
+
+/**
+ * ******************* GenerateInputRequestedRegion *******************
+ */
+
+template< class TImage >
+void
+TileInterpolatedCLAHEImageFilter< TImage >
+::GenerateInputRequestedRegion( void )
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  if( this->GetInput() )
+  {
+    ImageType * input = const_cast< ImageType * >( this->GetInput() );
+    input->SetRequestedRegionToLargestPossibleRegion();
+  }
+
+} // end GenerateInputRequestedRegion()
+
+
+/**
+ * ******************* BeforeThreadedGenerateData *******************
+ */
+
+template< class TImage >
+void
+TileInterpolatedCLAHEImageFilter< TImage >
+::BeforeThreadedGenerateData( void )
+{
+  const ImageType * input = this->GetInput();
+  const OutputImageRegionType region = input->GetLargestPossibleRegion();
+  const SizeType size = region.GetSize();
+  if( this->m_NumberOfBins == 0 )
+  {
+    itkExceptionMacro( << "The number of bins should be at least 1." );
+  }
+
+  /** The intensity range of the image. */
+  ImageRegionConstIterator< ImageType > it( input, region );
+  double minimum = NumericTraits<double>::max();
+  double maximum = NumericTraits<double>::NonpositiveMin();
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+  {
+    const double value = static_cast<double>( it.Value() );
+    if( value < minimum ) minimum = value;
+    if( value > maximum ) maximum = value;
+  }
+  this->m_Minimum = minimum;
+  this->m_Maximum = maximum;
+
+  /** The bins; one per value for integer images with a small range. */
+  const double range = maximum - minimum;
+  if( NumericTraits<PixelType>::is_integer && range + 1.0 <= this->m_NumberOfBins )
+  {
+    this->m_NumberOfUsedBins = static_cast<unsigned int>( range + 1.0 );
+    this->m_BinScale = 1.0;
+  }
+  else
+  {
+    this->m_NumberOfUsedBins = this->m_NumberOfBins;
+    this->m_BinScale = range > 0.0 ? this->m_NumberOfBins / range : 0.0;
+  }
+
+  /** The tile grid, and per index the tiles to interpolate. The node of a
+   * tile is its center.
+   */
+  SizeValueType numberOfTiles = 1;
+  for( unsigned int d = 0; d < ImageDimension; ++d )
+  {
+    this->m_Tiles[ d ] = static_cast<unsigned int>( vnl_math_max( SizeValueType( 1 ),
+      vnl_math_min( SizeValueType( this->m_NumberOfTiles[ d ] ), size[ d ] ) ) );
+    numberOfTiles *= this->m_Tiles[ d ];
+
+    const double tiles = this->m_Tiles[ d ];
+    this->m_LowerTile[ d ].resize( size[ d ] );
+    this->m_UpperWeight[ d ].resize( size[ d ] );
+    for( SizeValueType k = 0; k < size[ d ]; ++k )
+    {
+      const double u = ( k + 0.5 ) * tiles / size[ d ] - 0.5;
+      if( u <= 0.0 )
+      {
+        this->m_LowerTile[ d ][ k ] = 0;
+        this->m_UpperWeight[ d ][ k ] = 0.0;
+      }
+      else if( u >= tiles - 1.0 )
+      {
+        this->m_LowerTile[ d ][ k ] = this->m_Tiles[ d ] - 1;
+        this->m_UpperWeight[ d ][ k ] = 0.0;
+      }
+      else
+      {
+        const double lower = vcl_floor( u );
+        this->m_LowerTile[ d ][ k ] = static_cast<unsigned int>( lower );
+        this->m_UpperWeight[ d ][ k ] = u - lower;
+      }
+    }
+  }
+
+  /** The mappings of the tiles, in parallel. */
+  this->m_Mappings.assign( numberOfTiles * this->m_NumberOfUsedBins, 0.0 );
+  this->GetMultiThreader()->SetNumberOfThreads( this->GetNumberOfThreads() );
+  this->GetMultiThreader()->SetSingleMethod( this->TileThreaderCallback, this );
+  this->GetMultiThreader()->SingleMethodExecute();
+
+} // end BeforeThreadedGenerateData()
+
+
+/**
+ * ******************* TileThreaderCallback *******************
+ */
+
+template< class TImage >
+ITK_THREAD_RETURN_TYPE
+TileInterpolatedCLAHEImageFilter< TImage >
+::TileThreaderCallback( void * arg )
+{
+  typedef MultiThreader::ThreadInfoStruct ThreadInfoType;
+  ThreadInfoType * info = static_cast<ThreadInfoType *>( arg );
+  Self * filter = static_cast<Self *>( info->UserData );
+
+  filter->ThreadedComputeTileMappings( info->ThreadID, info->NumberOfThreads );
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end TileThreaderCallback()
+
+
+/**
+ * ******************* ThreadedComputeTileMappings *******************
+ */
+
+template< class TImage >
+void
+TileInterpolatedCLAHEImageFilter< TImage >
+::ThreadedComputeTileMappings( ThreadIdType threadId, ThreadIdType numberOfThreads )
+{
+  const ImageType * input = this->GetInput();
+  const unsigned int bins = this->m_NumberOfUsedBins;
+  const double range = this->m_Maximum - this->m_Minimum;
+  std::vector<double> histogram( bins );
+
+  SizeValueType numberOfTiles = 1;
+  for( unsigned int d = 0; d < ImageDimension; ++d )
+  {
+    numberOfTiles *= this->m_Tiles[ d ];
+  }
+
+  for( SizeValueType t = threadId; t < numberOfTiles; t += numberOfThreads )
+  {
+    /** The grid position of the tile, dimension 0 fastest. */
+    IndexType tile;
+    SizeValueType rest = t;
+    for( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+      tile[ d ] = rest % this->m_Tiles[ d ];
+      rest /= this->m_Tiles[ d ];
+    }
+    const OutputImageRegionType tileRegion = this->GetTileRegion( tile );
+
+    /** The histogram of the tile. */
+    std::fill( histogram.begin(), histogram.end(), 0.0 );
+    ImageRegionConstIterator< ImageType > it( input, tileRegion );
+    for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+      histogram[ this->GetBin( static_cast<double>( it.Value() ) ) ] += 1.0;
+    }
+
+    /** Clip, and spread the excess evenly over the bins. */
+    if( this->m_ClipLimit > 0.0 )
+    {
+      const double clip = vnl_math_max( 1.0, this->m_ClipLimit
+        * static_cast<double>( tileRegion.GetNumberOfPixels() ) / bins );
+      double excess = 0.0;
+      for( unsigned int b = 0; b < bins; ++b )
+      {
+        if( histogram[ b ] > clip )
+        {
+          excess += histogram[ b ] - clip;
+          histogram[ b ] = clip;
+        }
+      }
+      const double spread = excess / bins;
+      for( unsigned int b = 0; b < bins; ++b )
+      {
+        histogram[ b ] += spread;
+      }
+    }
+
+    /** The cumulative histogram, scaled to the intensity range. */
+    for( unsigned int b = 1; b < bins; ++b )
+    {
+      histogram[ b ] += histogram[ b - 1 ];
+    }
+    const double total = histogram[ bins - 1 ];
+    double * mapping = &this->m_Mappings[ t * bins ];
+    for( unsigned int b = 0; b < bins; ++b )
+    {
+      mapping[ b ] = this->m_Minimum
+        + ( total > 0.0 ? range * histogram[ b ] / total : 0.0 );
+    }
+  }
+
+} // end ThreadedComputeTileMappings()
+
+
+/**
+ * ******************* ThreadedGenerateData *******************
+ */
+
+template< class TImage >
+void
+TileInterpolatedCLAHEImageFilter< TImage >
+::ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+  ThreadIdType threadId )
+{
+  typedef ImageLinearConstIteratorWithIndex< ImageType > InputIteratorType;
+  typedef ImageLinearIteratorWithIndex< ImageType >      OutputIteratorType;
+
+  const IndexType start = this->GetInput()->GetLargestPossibleRegion().GetIndex();
+  const unsigned int bins = this->m_NumberOfUsedBins;
+  const unsigned int numberOfCorners = 1u << ImageDimension;
+
+  /** The strides of the tiles in the mappings. */
+  SizeValueType tileStrides[ ImageDimension ];
+  tileStrides[ 0 ] = bins;
+  for( unsigned int d = 1; d < ImageDimension; ++d )
+  {
+    tileStrides[ d ] = tileStrides[ d - 1 ] * this->m_Tiles[ d - 1 ];
+  }
+
+  InputIteratorType inIt( this->GetInput(), outputRegionForThread );
+  OutputIteratorType outIt( this->GetOutput(), outputRegionForThread );
+  inIt.SetDirection( 0 );
+  outIt.SetDirection( 0 );
+  ProgressReporter progress( this, threadId,
+    outputRegionForThread.GetNumberOfPixels() / outputRegionForThread.GetSize()[ 0 ] );
+
+  std::vector<double> cornerWeights( numberOfCorners );
+  std::vector<SizeValueType> cornerOffsets( numberOfCorners );
+  inIt.GoToBegin();
+  outIt.GoToBegin();
+  while( !inIt.IsAtEnd() )
+  {
+    /** The tiles and weights of the other dimensions are fixed on a line. */
+    const IndexType index = inIt.GetIndex();
+    SizeValueType lineOffset = 0;
+    double lineWeights[ ImageDimension ][ 2 ];
+    SizeValueType lineSteps[ ImageDimension ];
+    for( unsigned int d = 1; d < ImageDimension; ++d )
+    {
+      const SizeValueType k = index[ d ] - start[ d ];
+      const double w = this->m_UpperWeight[ d ][ k ];
+      lineOffset += this->m_LowerTile[ d ][ k ] * tileStrides[ d ];
+      lineWeights[ d ][ 0 ] = 1.0 - w;
+      lineWeights[ d ][ 1 ] = w;
+      lineSteps[ d ] = w > 0.0 ? tileStrides[ d ] : 0;
+    }
+
+    SizeValueType k0 = index[ 0 ] - start[ 0 ];
+    while( !inIt.IsAtEndOfLine() )
+    {
+      const double w0 = this->m_UpperWeight[ 0 ][ k0 ];
+      lineWeights[ 0 ][ 0 ] = 1.0 - w0;
+      lineWeights[ 0 ][ 1 ] = w0;
+      lineSteps[ 0 ] = w0 > 0.0 ? tileStrides[ 0 ] : 0;
+      const SizeValueType offset = lineOffset + this->m_LowerTile[ 0 ][ k0 ] * tileStrides[ 0 ]
+        + this->GetBin( static_cast<double>( inIt.Get() ) );
+
+      /** Interpolate the mappings of the 2^D tiles around the voxel. */
+      double value = 0.0;
+      for( unsigned int c = 0; c < numberOfCorners; ++c )
+      {
+        double weight = 1.0;
+        SizeValueType cornerOffset = offset;
+        for( unsigned int d = 0; d < ImageDimension; ++d )
+        {
+          const unsigned int upper = ( c >> d ) & 1u;
+          weight *= lineWeights[ d ][ upper ];
+          cornerOffset += upper * lineSteps[ d ];
+        }
+        if( weight > 0.0 ) value += weight * this->m_Mappings[ cornerOffset ];
+      }
+
+      if( NumericTraits<PixelType>::is_integer )
+      {
+        value = vcl_floor( value + 0.5 );
+      }
+      outIt.Set( static_cast<PixelType>( value ) );
+      ++inIt;
+      ++outIt;
+      ++k0;
+    }
+
+    inIt.NextLine();
+    outIt.NextLine();
+    progress.CompletedPixel();
+  }
+
+} // end ThreadedGenerateData()
+
+
+/**
+ * ******************* GetTileRegion *******************
+ */
+
+template< class TImage >
+typename TileInterpolatedCLAHEImageFilter< TImage >::OutputImageRegionType
+TileInterpolatedCLAHEImageFilter< TImage >
+::GetTileRegion( const IndexType & tile ) const
+{
+  const OutputImageRegionType region = this->GetInput()->GetLargestPossibleRegion();
+  IndexType index;
+  SizeType size;
+  for( unsigned int d = 0; d < ImageDimension; ++d )
+  {
+    const SizeValueType n = region.GetSize()[ d ];
+    const SizeValueType begin = n * tile[ d ] / this->m_Tiles[ d ];
+    const SizeValueType end = n * ( tile[ d ] + 1 ) / this->m_Tiles[ d ];
+    index[ d ] = region.GetIndex()[ d ] + begin;
+    size[ d ] = end - begin;
+  }
+
+  return OutputImageRegionType( index, size );
+
+} // end GetTileRegion()
+
+
+/**
+ * ******************* GetBin *******************
+ */
+
+template< class TImage >
+unsigned int
+TileInterpolatedCLAHEImageFilter< TImage >
+::GetBin( double value ) const
+{
+  const double bin = ( value - this->m_Minimum ) * this->m_BinScale;
+  if( bin <= 0.0 ) return 0;
+  const unsigned int last = this->m_NumberOfUsedBins - 1;
+  return bin >= last ? last : static_cast<unsigned int>( bin );
+
+} // end GetBin()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template< class TImage >
+void
+TileInterpolatedCLAHEImageFilter< TImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "NumberOfTiles: " << this->m_NumberOfTiles << std::endl;
+  os << indent << "ClipLimit: " << this->m_ClipLimit << std::endl;
+  os << indent << "NumberOfBins: " << this->m_NumberOfBins << std::endl;
+
+} // end PrintSelf()
+
+} // end namespace itk
+
+#endif // end #ifndef __itkTileInterpolatedCLAHEImageFilter_txx_
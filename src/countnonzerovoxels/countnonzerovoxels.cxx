@@ -26,9 +26,11 @@
 
 #include "itkCommandLineArgumentParser.h"
 #include "ITKToolsHelpers.h"
+#include "ITKToolsMemoryMapping.h"
 
-#include "itkImageFileReader.h"
-#include "itkImageRegionConstIterator.h"
+#include "itkImageReductionsFilter.h"
+#include "itkParallelReducer.h"
+#include <vector>
 
 
 /**
@@ -41,12 +43,63 @@ std::string GetHelpString( void )
   ss << "ITKTools v" << itktools::GetITKToolsVersion() << "\n"
     << "Usage:\n"
     << "pxcountnonzerovoxels\n"
-    << "  -in      inputFilename";
+    << "  -in      inputFilename\n"
+    << "  [-labels] also count the voxels of every label, in the same pass\n"
+    << "With -labels, a line \"label count volume\" is printed for every\n"
+    << "non-zero label that occurs, in increasing order of the label.";
   return ss.str();
 
 } // end GetHelpString()
 
 
+/**
+ * ******************* LabelCountReducer *******************
+ *
+ * Counts the labels of a block of the buffer in a table, indexed by the
+ * value minus the smallest value. The blocks of the ParallelReducer are
+ * contiguous in the buffer.
+ */
+
+template< class TImage >
+class LabelCountReducer
+{
+public:
+  typedef typename TImage::RegionType     RegionType;
+  typedef typename TImage::PixelType      PixelType;
+  typedef std::vector<std::size_t>        PartialType;
+
+  const TImage *  m_Image;
+  long            m_MinimumValue;
+  std::size_t     m_ValueRange;
+
+  void Initialize( PartialType & partial ) const
+  {
+    partial.assign( this->m_ValueRange, 0 );
+  }
+
+  void Reduce( const RegionType & block, PartialType & partial ) const
+  {
+    const PixelType * buffer = this->m_Image->GetBufferPointer()
+      + this->m_Image->ComputeOffset( block.GetIndex() );
+    const std::size_t numberOfPixels = block.GetNumberOfPixels();
+    std::size_t * counts = &partial[ 0 ];
+    const long minimumValue = this->m_MinimumValue;
+    for( std::size_t p = 0; p < numberOfPixels; ++p )
+    {
+      ++counts[ static_cast<long>( buffer[ p ] ) - minimumValue ];
+    }
+  }
+
+  void Merge( PartialType & partial, const PartialType & other ) const
+  {
+    for( std::size_t v = 0; v < this->m_ValueRange; ++v )
+    {
+      partial[ v ] += other[ v ];
+    }
+  }
+};
+
+
 //-------------------------------------------------------------------------------------
 
 int main( int argc, char *argv[] )
@@ -71,10 +124,15 @@ int main( int argc, char *argv[] )
     return EXIT_SUCCESS;
   }
 
+  /** Threading. */
+  itktools::ReadThreadingArguments( parser );
+
   /** Get arguments. */
   std::string inputFileName;
   parser->GetCommandLineArgument( "-in", inputFileName );
 
+  const bool countLabels = parser->ArgumentExists( "-labels" );
+
   // Some consts.
   const unsigned int  Dimension = 3;
   typedef short PixelType;
@@ -82,16 +140,13 @@ int main( int argc, char *argv[] )
   // TYPEDEF's
   typedef itk::Image< PixelType, Dimension >          ImageType;
   typedef ImageType::SpacingType                      SpacingType;
-  typedef itk::ImageFileReader< ImageType >           ReaderType;
-  typedef itk::ImageRegionConstIterator< ImageType >  IteratorType;
-
-  /** Read image. */
-  ReaderType::Pointer reader = ReaderType::New();
-  reader->SetFileName( inputFileName.c_str() );
+  typedef itk::ImageReductionsFilter< ImageType >     ReductionsFilterType;
 
+  /** Read image. Uncompressed MetaImages of type short are memory mapped. */
+  ImageType::Pointer image;
   try
   {
-    reader->Update();
+    image = itktools::ReadImage<ImageType>( inputFileName );
   }
   catch( itk::ExceptionObject & excp )
   {
@@ -102,28 +157,66 @@ int main( int argc, char *argv[] )
   }
 
   /** Get the spacing. */
-  SpacingType sp = reader->GetOutput()->GetSpacing();
+  SpacingType sp = image->GetSpacing();
   double voxelVolume = 1.0;
   for( unsigned int i = 0; i < Dimension; i++ )
   {
     voxelVolume *= sp[ i ];
   }
 
-  /** Create iterator and counter. */
-  IteratorType it( reader->GetOutput(),
-    reader->GetOutput()->GetLargestPossibleRegion() );
-  it.GoToBegin();
-  std::size_t counter = 0;
-
-  /** Walk over the image. */
-  while ( !it.IsAtEnd() )
+  /** Count the labels, multithreaded. The number of non-zero voxels
+   * follows from the count of label 0.
+   */
+  if( countLabels )
   {
-    if( it.Value() )
+    typedef LabelCountReducer< ImageType >              ReducerType;
+    typedef itk::ParallelReducer< ReducerType >         ParallelReducerType;
+    ReducerType reducer;
+    reducer.m_Image = image;
+    reducer.m_MinimumValue = static_cast<long>( itk::NumericTraits<PixelType>::NonpositiveMin() );
+    reducer.m_ValueRange = static_cast<std::size_t>(
+      static_cast<long>( itk::NumericTraits<PixelType>::max() ) - reducer.m_MinimumValue + 1 );
+
+    /** The counts are exact, so one table per thread suffices. */
+    ParallelReducerType::Pointer parallelReducer = ParallelReducerType::New();
+    parallelReducer->SetReducer( &reducer );
+    parallelReducer->SetRegion( image->GetBufferedRegion() );
+    parallelReducer->ExactMergeOn();
+    parallelReducer->Compute();
+    const std::vector<std::size_t> & counts = parallelReducer->GetResult();
+    const std::size_t numberOfPixels = image->GetBufferedRegion().GetNumberOfPixels();
+    const std::size_t valueRange = reducer.m_ValueRange;
+
+    /** Print to screen. */
+    const std::size_t zeroIndex = static_cast<std::size_t>( -reducer.m_MinimumValue );
+    const std::size_t counter = numberOfPixels - counts[ zeroIndex ];
+    std::cout << "count: " << counter << std::endl;
+    std::cout << "volume: " << counter * voxelVolume / 1000.0 << std::endl;
+    std::cout << "label count volume" << std::endl;
+    for( std::size_t v = 0; v < valueRange; ++v )
     {
-      counter++;
+      if( v == zeroIndex || counts[ v ] == 0 ) continue;
+      std::cout << static_cast<long>( v ) + reducer.m_MinimumValue << " " << counts[ v ]
+        << " " << counts[ v ] * voxelVolume / 1000.0 << std::endl;
     }
-    ++it;
-  } // end while
+
+    return EXIT_SUCCESS;
+  }
+
+  /** Count the non-zero voxels, multithreaded. */
+  ReductionsFilterType::Pointer reductions = ReductionsFilterType::New();
+  reductions->SetInput( image );
+  reductions->ComputeNonZeroCountOn();
+  try
+  {
+    reductions->Update();
+  }
+  catch( itk::ExceptionObject & excp )
+  {
+    std::cerr << "ERROR: Caught ITK exception: " << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+  const std::size_t counter = reductions->GetNonZeroCount();
 
   /** Print to screen. */
   std::cout << "count: " << counter << std::endl;
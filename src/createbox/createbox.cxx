@@ -56,6 +56,8 @@ std::string GetHelpString( void )
     << "  [-ci1]   cornerindex 1\n"
     << "  [-ci2]   cornerindex 2\n"
     << "  [-o]     orientation of the box, default xyz\n"
+    << "  [-aa]    anti-aliasing: the number of sub-scanlines per dimension\n"
+    << "           for the partial volume of the edge voxels, default 0 (binary)\n"
     << "- The user should EITHER specify the input filename OR the output image size.\n"
     << "- The user should EITHER specify the center and the radius,\n"
     << "    OR the positions of two opposite corner points.\n"
@@ -169,6 +171,9 @@ int main( int argc, char** argv )
   std::vector<double> orientation( dim, 0.0 );
   parser->GetCommandLineArgument( "-o", orientation );
 
+  unsigned int subsamples = 0;
+  parser->GetCommandLineArgument( "-aa", subsamples );
+
   /** Additional check. */
   if( ( !retc | !retr | retcp1 | retcp2 | retci1 | retci2 )
     && ( retc | retr | !retcp1 | !retcp2 | retci1 | retci2 )
@@ -259,7 +264,9 @@ int main( int argc, char** argv )
     filter->m_Input2 = input2;
     filter->m_OrientationOfBox = orientation;
     filter->m_BoxDefinition = boxDefinition;
+    filter->m_PartialVolumeSubsamples = subsamples;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
@@ -22,8 +22,9 @@
 #include "ITKToolsHelpers.h"
 #include "CommandLineArgumentHelper.h"
 
-#include "itkBoxSpatialFunction.h"
-#include "itkImageRegionIterator.h"
+#include "itkConvexShapeImageSource.h"
+#include "itkEuler2DTransform.h"
+#include "itkEuler3DTransform.h"
 #include "itkImageFileWriter.h"
 #include "vnl/vnl_math.h"
 
@@ -43,6 +44,7 @@ public:
     this->m_ReferenceImageIOBase = NULL;
     this->m_OutputFileName = "";
     this->m_BoxDefinition = "";
+    this->m_PartialVolumeSubsamples = 0;
   }
   /** Destructor. */
   ~ITKToolsCreateBoxBase(){};
@@ -54,6 +56,7 @@ public:
   std::vector<double> m_Input2;
   std::vector<double> m_OrientationOfBox;
   std::string m_BoxDefinition;
+  unsigned int m_PartialVolumeSubsamples;
 
 }; // end class ITKToolsCreateBoxBase
 
@@ -81,9 +84,11 @@ public:
     /** Typedefs. */
     typedef itk::Image< TComponentType, VDimension >    ImageType;
     typedef itk::ImageFileWriter< ImageType >           ImageWriterType;
-    typedef itk::BoxSpatialFunction< VDimension >       BoxSpatialFunctionType;
-    typedef typename BoxSpatialFunctionType::InputType  InputType;
-    typedef itk::ImageRegionIterator< ImageType >       IteratorType;
+    typedef itk::ConvexShapeImageSource< ImageType >    SourceType;
+    typedef typename SourceType::VectorType             VectorType;
+    typedef typename SourceType::MatrixType             MatrixType;
+    typedef itk::Euler2DTransform< double >             Euler2DTransformType;
+    typedef itk::Euler3DTransform< double >             Euler3DTransformType;
 
     typedef typename ImageType::RegionType              RegionType;
     typedef typename RegionType::SizeType               SizeType;
@@ -117,17 +122,17 @@ public:
       size, spacing, origin, direction,
       sizeITK, spacingITK, originITK, directionITK );
 
-    /** Create output image. */
+    /** An image with the output geometry, to transform the indices. */
     typename ImageType::Pointer image = ImageType::New();
     RegionType region; region.SetSize( sizeITK );
     image->SetRegions( region );
     image->SetSpacing( spacingITK );
     image->SetOrigin( originITK );
     image->SetDirection( directionITK );
-    image->Allocate();
 
     /** Translate input of two opposite corners to center + radius input. */
-    InputType Center, Radius;
+    PointType Center;
+    VectorType Radius;
     PointType point1, point2;
     IndexType index1, index2;
     if( this->m_BoxDefinition == "CornersAsPoints" )
@@ -164,43 +169,64 @@ public:
     {
       for( unsigned int i = 0; i < VDimension; i++ )
       {
-        Center[ i ] = point1[ i ];
-        Radius[ i ] = point2[ i ];
+        Center[ i ] = this->m_Input1[ i ];
+        Radius[ i ] = this->m_Input2[ i ];
       }
     }
 
-    /** Convert box orientation to ITK type. */
-    InputType   orientationOfBoxITK;
-    for( unsigned int i = 0; i < VDimension; i++ )
+    /** The rotation of the box, as in itk::BoxSpatialFunction. */
+    MatrixType rotation;
+    rotation.SetIdentity();
+    if( VDimension == 2 )
     {
-      orientationOfBoxITK[ i ] = this->m_OrientationOfBox[ i ];
+      typename Euler2DTransformType::Pointer euler = Euler2DTransformType::New();
+      euler->SetAngle( this->m_OrientationOfBox[ 0 ] );
+      for( unsigned int i = 0; i < VDimension; i++ )
+      {
+        for( unsigned int j = 0; j < VDimension; j++ )
+        {
+          rotation[ i ][ j ] = euler->GetMatrix()[ i ][ j ];
+        }
+      }
+    }
+    else if( VDimension == 3 )
+    {
+      typename Euler3DTransformType::Pointer euler = Euler3DTransformType::New();
+      euler->SetRotation( this->m_OrientationOfBox[ 0 ],
+        this->m_OrientationOfBox[ 1 ], this->m_OrientationOfBox[ 2 ] );
+      for( unsigned int i = 0; i < VDimension; i++ )
+      {
+        for( unsigned int j = 0; j < VDimension; j++ )
+        {
+          rotation[ i ][ j ] = euler->GetMatrix()[ i ][ j ];
+        }
+      }
     }
 
-    /** Create and initialize box. */
-    typename BoxSpatialFunctionType::Pointer box = BoxSpatialFunctionType::New();
-    box->SetCenter( Center );
-    box->SetRadius( Radius );
-    box->SetOrientation( orientationOfBoxITK );
-
-    /** Create iterator, index and point. */
-    IteratorType it( image, region );
-    it.GoToBegin();
-    PointType point;
-    IndexType index;
-
-    /** Walk over the image. */
-    while ( !it.IsAtEnd() )
+    /** The box is the intersection of the slabs |R_i.(p-c)| < r_i,
+     * with R_i the i-th column of the rotation.
+     */
+    typename SourceType::Pointer source = SourceType::New();
+    source->SetSize( sizeITK );
+    source->SetSpacing( spacingITK );
+    source->SetOrigin( originITK );
+    source->SetDirection( directionITK );
+    source->SetCenter( Center );
+    for( unsigned int i = 0; i < VDimension; i++ )
     {
-      index = it.GetIndex();
-      image->TransformIndexToPhysicalPoint( index, point );
-      it.Set( box->Evaluate( point ) );
-      ++it;
-    } // end while
+      VectorType normal;
+      for( unsigned int j = 0; j < VDimension; j++ )
+      {
+        normal[ j ] = rotation[ j ][ i ];
+      }
+      source->AddSlab( normal, Radius[ i ] );
+    }
+    source->SetPartialVolumeSubsamples( this->m_PartialVolumeSubsamples );
 
     /** Write image. */
     typename ImageWriterType::Pointer writer = ImageWriterType::New();
     writer->SetFileName( this->m_OutputFileName.c_str() );
-    writer->SetInput( image );
+    writer->SetInput( source->GetOutput() );
     writer->Update();
 
   } // end Run()
@@ -28,8 +28,7 @@
 #include "ITKToolsHelpers.h"
 #include "ITKToolsBase.h"
 
-#include "itkCylinderSpatialFunction.h"
-#include "itkImageRegionIteratorWithIndex.h"
+#include "itkConvexShapeImageSource.h"
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
 
@@ -48,6 +47,8 @@ std::string GetHelpString( void )
   << "-out     outputFilename" << std::endl
   << "-c       center (mm)" << std::endl
   << "-r       radii (mm)" << std::endl
+  << "[-aa]    anti-aliasing: the number of sub-scanlines per dimension\n"
+  << "         for the partial volume of the edge voxels, default 0 (binary)" << std::endl
   << "Supported: 2D, 3D.";
   return ss.str();
 } // end GetHelpString()
@@ -65,6 +66,7 @@ public:
     this->m_OutputFileName = "";
     //std::vector<unsigned int> this->m_Center;
     this->m_Radius = 0.0f;
+    this->m_PartialVolumeSubsamples = 0;
   };
   ~ITKToolsCreateCylinderBase(){};
 
@@ -73,6 +75,85 @@ public:
   std::string m_OutputFileName;
   std::vector<unsigned int> m_Center;
   double m_Radius;
+  unsigned int m_PartialVolumeSubsamples;
+
+}; // end CreateCylinderBase
+
+
+template< unsigned int VDimension >
+class ITKToolsCreateCylinder : public ITKToolsCreateCylinderBase
+{
+public:
+  typedef ITKToolsCreateCylinder Self;
+
+  ITKToolsCreateCylinder(){};
+  ~ITKToolsCreateCylinder(){};
+
+  static Self * New( unsigned int dim )
+  {
+    if( VDimension == dim )
+    {
+      return new Self;
+    }
+    return 0;
+  }
+
+  /** Run function. */
+  void Run( void )
+  {
+    /** Typedefs. */
+    typedef float               InputPixelType;
+    typedef unsigned char       OutputPixelType;
+    typedef itk::Image< InputPixelType, VDimension >   InputImageType;
+    typedef itk::Image< OutputPixelType, VDimension >  OutputImageType;
+    typedef itk::ImageFileReader< InputImageType >    ReaderType;
+    typedef itk::ImageFileWriter< OutputImageType >     WriterType;
+    typedef itk::ConvexShapeImageSource< OutputImageType > SourceType;
+    typedef typename SourceType::MatrixType       MatrixType;
+    typedef typename OutputImageType::IndexType   IndexType;
+    typedef typename OutputImageType::PointType   PointType;
+
+    /** Read only the geometry of the test image, not its pixels. */
+    typename ReaderType::Pointer testReader = ReaderType::New();
+    testReader->SetFileName( this->m_InputFileName.c_str() );
+    testReader->UpdateOutputInformation();
+    const InputImageType * testImage = testReader->GetOutput();
+
+    /** Parse the arguments. */
+    PointType Center;
+    IndexType index;
+    for( unsigned int i = 0; i < VDimension; i++ )
+    {
+      index[ i ] = this->m_Center[ i ];
+    }
+    testImage->TransformIndexToPhysicalPoint( index, Center );
+
+    /** The cylinder along the last axis is the quadric
+     * A = diag( 1/r^2, .., 1/r^2, 0 ).
+     */
+    MatrixType A;
+    A.Fill( 0.0 );
+    for( unsigned int i = 0; i < VDimension - 1; i++ )
+    {
+      A[ i ][ i ] = 1.0 / ( this->m_Radius * this->m_Radius );
+    }
+
+    /** Create the image, scanline by scanline. */
+    typename SourceType::Pointer source = SourceType::New();
+    source->SetSize( testImage->GetLargestPossibleRegion().GetSize() );
+    source->SetSpacing( testImage->GetSpacing() );
+    source->SetOrigin( testImage->GetOrigin() );
+    source->SetDirection( testImage->GetDirection() );
+    source->SetCenter( Center );
+    source->SetQuadric( A );
+    source->SetPartialVolumeSubsamples( this->m_PartialVolumeSubsamples );
+
+    /** Write image. */
+    typename WriterType::Pointer writer = WriterType::New();
+    writer->SetFileName( this->m_OutputFileName.c_str() );
+    writer->SetInput( source->GetOutput() );
+    writer->Update();
+  }
 
 }; // end CreateCylinderBase
 
@@ -204,6 +285,9 @@ int main( int argc, char *argv[] )
   double radius = 0.0f;
   parser->GetCommandLineArgument( "-r", radius );
 
+  unsigned int subsamples = 0;
+  parser->GetCommandLineArgument( "-aa", subsamples );
+
   /** Determine image properties. */
   std::string ComponentTypeIn = "short";
   std::string PixelType; //we don't use this
@@ -246,7 +330,9 @@ int main( int argc, char *argv[] )
     createCylinder->m_OutputFileName = outputFileName;
     createCylinder->m_Center = center;
     createCylinder->m_Radius = radius;
+    createCylinder->m_PartialVolumeSubsamples = subsamples;
 
+    createCylinder->ReadCommonArguments( parser );
     createCylinder->Run();
 
     delete createCylinder;
@@ -47,6 +47,8 @@ std::string GetHelpString( void )
     << "[-o]     orientation, default xyz\n"
     << "[-dim]   dimension, default 3\n"
     << "[-pt]    pixelType, default short\n"
+    << "[-aa]    anti-aliasing: the number of sub-scanlines per dimension\n"
+    << "         for the partial volume of the edge voxels, default 0 (binary)\n"
     << "The orientation is a dim*dim matrix, specified in row order.\n"
     << "The user should take care of supplying an orthogonal matrix.\n"
     << "Supported: 2D, 3D, (unsigned) char, (unsigned) short, float, double.";
@@ -106,6 +108,9 @@ int main( int argc, char *argv[] )
   std::vector<double> spacing( dim, 1.0 );
   parser->GetCommandLineArgument( "-sp", spacing );
 
+  unsigned int subsamples = 0;
+  parser->GetCommandLineArgument( "-aa", subsamples );
+
   std::vector<double> orientation( dim * dim, 0.0 );
   bool reto = parser->GetCommandLineArgument( "-o", orientation );
 
@@ -149,7 +154,9 @@ int main( int argc, char *argv[] )
     filter->m_Center = center;
     filter->m_Radius = radius;
     filter->m_Orientation = orientation;
+    filter->m_PartialVolumeSubsamples = subsamples;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
@@ -20,8 +20,7 @@
 
 #include "ITKToolsBase.h"
 
-#include "itkEllipsoidInteriorExteriorSpatialFunction.h"
-#include "itkImageRegionIterator.h"
+#include "itkConvexShapeImageSource.h"
 #include "itkImageFileWriter.h"
 
 
@@ -38,6 +37,7 @@ public:
   ITKToolsCreateEllipsoidBase()
   {
     this->m_OutputFileName = "";
+    this->m_PartialVolumeSubsamples = 0;
   }
   /** Destructor. */
   ~ITKToolsCreateEllipsoidBase(){};
@@ -49,6 +49,7 @@ public:
   std::vector<double> m_Center;
   std::vector<double> m_Radius;
   std::vector<double> m_Orientation;
+  unsigned int m_PartialVolumeSubsamples;
 
 }; // end class ITKToolsCreateEllipsoidBase
 
@@ -75,71 +76,60 @@ public:
   {
     /** Typedefs. */
     typedef itk::Image< TComponentType, VDimension >      ImageType;
-    typedef itk::ImageRegionIterator< ImageType >         IteratorType;
-    typedef itk::EllipsoidInteriorExteriorSpatialFunction<
-      VDimension >                                        SpatialFunctionType;
-    typedef typename SpatialFunctionType::InputType       InputType;
-    typedef typename SpatialFunctionType::OrientationType OrientationType;
+    typedef itk::ConvexShapeImageSource< ImageType >      SourceType;
+    typedef typename SourceType::MatrixType               MatrixType;
     typedef itk::ImageFileWriter< ImageType >             ImageWriterType;
 
     typedef typename ImageType::RegionType                RegionType;
     typedef typename RegionType::SizeType                 SizeType;
     typedef typename RegionType::SizeValueType            SizeValueType;
     typedef typename ImageType::PointType                 PointType;
-    typedef typename ImageType::IndexType                 IndexType;
     typedef typename ImageType::SpacingType               SpacingType;
 
     /** Parse the arguments. */
     SizeType Size;
     SpacingType Spacing;
-    InputType Center;
-    InputType Radius;
-    OrientationType Orientation;
+    PointType Center;
     for( unsigned int i = 0; i < VDimension; i++ )
     {
       Size[ i ] = static_cast<SizeValueType>( this->m_Size[ i ] );
       Spacing[ i ] = this->m_Spacing[ i ];
       Center[ i ] = this->m_Center[ i ];
-      Radius[ i ] = this->m_Radius[ i ];
+    }
+
+    /** The ellipsoid is the quadric A = sum_i o_i o_i^T / ( 0.5 r_i )^2,
+     * with o_i the i-th orientation. The radii are used as the axes of
+     * itk::EllipsoidInteriorExteriorSpatialFunction, as before.
+     */
+    MatrixType A;
+    A.Fill( 0.0 );
+    for( unsigned int i = 0; i < VDimension; i++ )
+    {
+      const double halfAxis = 0.5 * this->m_Radius[ i ];
+      const double weight = 1.0 / ( halfAxis * halfAxis );
       for( unsigned int j = 0; j < VDimension; j++ )
       {
-        Orientation[ i ][ j ] = this->m_Orientation[ i * VDimension + j ];
+        for( unsigned int k = 0; k < VDimension; k++ )
+        {
+          A[ j ][ k ] += weight
+            * this->m_Orientation[ i * VDimension + j ]
+            * this->m_Orientation[ i * VDimension + k ];
+        }
       }
     }
 
-    /** Create image. */
-    RegionType region;
-    region.SetSize( Size );
-    typename ImageType::Pointer image = ImageType::New();
-    image->SetRegions( region );
-    image->SetSpacing( Spacing );
-    image->Allocate();
-
-    /** Create and initialize ellipsoid. */
-    typename SpatialFunctionType::Pointer ellipsoid = SpatialFunctionType::New();
-    ellipsoid->SetCenter( Center );
-    ellipsoid->SetAxes( Radius );
-    ellipsoid->SetOrientations( Orientation );
-
-    /** Create iterator, index and point. */
-    IteratorType it( image, region );
-    it.GoToBegin();
-    PointType point;
-    IndexType index;
-
-    /** Walk over the image. */
-    while ( !it.IsAtEnd() )
-    {
-      index = it.GetIndex();
-      image->TransformIndexToPhysicalPoint( index, point );
-      it.Set( ellipsoid->Evaluate( point ) );
-      ++it;
-    } // end while
+    /** Create the image, scanline by scanline. */
+    typename SourceType::Pointer source = SourceType::New();
+    source->SetSize( Size );
+    source->SetSpacing( Spacing );
+    source->SetCenter( Center );
+    source->SetQuadric( A );
+    source->SetPartialVolumeSubsamples( this->m_PartialVolumeSubsamples );
 
     /** Write image. */
     typename ImageWriterType::Pointer writer = ImageWriterType::New();
     writer->SetFileName( this->m_OutputFileName.c_str() );
-    writer->SetInput( image );
+    writer->SetInput( source->GetOutput() );
     writer->Update();
 
   } // end Run()
@@ -29,7 +29,7 @@
 #include "ITKToolsBase.h"
 
 #include "itkImage.h"
-#include "itkImageRegionIteratorWithIndex.h"
+#include "itkGridImageSource.h"
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
 
@@ -82,6 +82,8 @@ public:
   std::vector<unsigned int> m_Distance;
   bool m_Is2DStack;
 
+  /** The grid source only fills the requested region. */
+  virtual bool GetSupportsStreaming( void ) const { return true; }
 
 }; // end CreateGridImageBase
 
@@ -109,17 +111,16 @@ public:
   {
     /** Typedef's. */
     typedef unsigned char                                   PixelType;
-    typedef itk::Image< PixelType, VDimension >              ImageType;
-    typedef itk::ImageRegionIteratorWithIndex< ImageType >  IteratorType;
+    typedef itk::Image< PixelType, VDimension >             ImageType;
+    typedef itk::GridImageSource< ImageType >               GridSourceType;
     typedef itk::ImageFileReader< ImageType >               ReaderType;
     typedef itk::ImageFileWriter< ImageType >               WriterType;
 
     typedef typename ImageType::SizeType    SizeType;
-    typedef typename ImageType::IndexType   IndexType;
     typedef typename ImageType::SpacingType SpacingType;
 
-    /* Create image and writer. */
-    typename ImageType::Pointer  image  = ImageType::New();
+    /* Create the source and the writer. */
+    typename GridSourceType::Pointer source = GridSourceType::New();
     typename ReaderType::Pointer reader = ReaderType::New();
     typename WriterType::Pointer writer = WriterType::New();
 
@@ -129,11 +130,10 @@ public:
       reader->SetFileName( this->m_InputFileName.c_str() );
       reader->GenerateOutputInformation();
 
-      SizeType size = reader->GetOutput()->GetLargestPossibleRegion().GetSize();
-      image->SetRegions( size );
-      image->SetSpacing( reader->GetOutput()->GetSpacing() );
-      image->SetOrigin( reader->GetOutput()->GetOrigin() );
-      image->SetDirection( reader->GetOutput()->GetDirection() );
+      source->SetSize( reader->GetOutput()->GetLargestPossibleRegion().GetSize() );
+      source->SetSpacing( reader->GetOutput()->GetSpacing() );
+      source->SetOrigin( reader->GetOutput()->GetOrigin() );
+      source->SetDirection( reader->GetOutput()->GetDirection() );
     }
     else
     {
@@ -144,41 +144,25 @@ public:
         size[ i ] = this->m_ImageSize[ i ];
         spacing[ i ] = this->m_ImageSpacing[ i ];
       }
-      image->SetRegions( size );
-      image->SetSpacing( spacing );
+      source->SetSize( size );
+      source->SetSpacing( spacing );
     }
 
-    /** Allocate image. */
-    image->Allocate();
-
-    /* Fill the image. */
-    IteratorType  it( image, image->GetLargestPossibleRegion() );
-    it.GoToBegin();
-    IndexType ind;
-    while ( !it.IsAtEnd() )
+    /** Fill the grid lines directly, in parallel over the slices. */
+    SizeType distance;
+    for( unsigned int i = 0; i < VDimension; ++i )
     {
-      /** Check if on grid. */
-      ind = it.GetIndex();
-      bool onGrid = false;
-      onGrid |= ind[ 0 ] % this->m_Distance[ 0 ] == 0;
-      onGrid |= ind[ 1 ] % this->m_Distance[ 1 ] == 0;
-      if( VDimension == 3 && !m_Is2DStack )
-      {
-        if( ind[ 2 ] % this->m_Distance[ 2 ] != 0 )
-        {
-          onGrid = ind[ 0 ] % this->m_Distance[ 0 ] == 0;
-          onGrid &= ind[ 1 ] % this->m_Distance[ 1 ] == 0;
-        }
-      }
-      /** Set the value and continue. */
-      if( onGrid ) it.Set( 1 );
-      else it.Set( 0 );
-      ++it;
-    } // end while
+      distance[ i ] = this->m_Distance[ i ];
+    }
+    source->SetDistance( distance );
+    source->SetIs2DStack( this->m_Is2DStack );
 
-    /* Write result to file. */
+    /* Write result to file, streamed if requested. */
     writer->SetFileName( this->m_OutputFileName.c_str() );
-    writer->SetInput( image );
+    writer->SetInput( source->GetOutput() );
+    this->SetStreamingOnWriter( writer.GetPointer() );
+    this->ObserveProcess( source.GetPointer(), "grid" );
+    this->ObserveProcess( writer.GetPointer(), "write" );
     writer->Update();
   }
 
@@ -318,6 +302,7 @@ int main( int argc, char *argv[] )
     filter->m_Distance = distance;
     filter->m_Is2DStack = is2DStack;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
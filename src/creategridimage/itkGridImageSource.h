@@ -0,0 +1,121 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkGridImageSource_h_
+#define __itkGridImageSource_h_
+
+#include "itkImageSource.h"
+
+namespace itk
+{
+
+/** \class GridImageSource
+ * \brief Generate an image of grid lines.
+ *
+ * A pixel is on the grid if its index in dimension 0 or 1 is a multiple of
+ * the distance in that dimension. In 3D, the slices whose index in
+ * dimension 2 is not a multiple of the distance only contain the
+ * intersections of the lines, the lines in dimension 2; with
+ * Is2DStack every slice is a 2D grid. The grid is 1, the rest is 0.
+ *
+ * The grid is not tested per pixel. A line in dimension 0 is either
+ * filled completely, or cleared and set at every distance[ 0 ]-th pixel,
+ * or cleared. The lines are filled in parallel over the slices, and the
+ * source only fills the requested region, so the output can be streamed.
+ *
+ * \ingroup DataSources
+ */
+
+template< class TOutputImage >
+class ITK_EXPORT GridImageSource :
+  public ImageSource< TOutputImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef GridImageSource                 Self;
+  typedef ImageSource< TOutputImage >     Superclass;
+  typedef SmartPointer<Self>              Pointer;
+  typedef SmartPointer<const Self>        ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( GridImageSource, ImageSource );
+
+  /** Typedefs. */
+  typedef TOutputImage                                OutputImageType;
+  typedef typename OutputImageType::PixelType         OutputPixelType;
+  typedef typename OutputImageType::RegionType        OutputImageRegionType;
+  typedef typename OutputImageType::SizeType          SizeType;
+  typedef typename OutputImageType::PointType         PointType;
+  typedef typename OutputImageType::SpacingType       SpacingType;
+  typedef typename OutputImageType::DirectionType     DirectionType;
+
+  itkStaticConstMacro( ImageDimension, unsigned int, TOutputImage::ImageDimension );
+
+  /** Set/Get the size, spacing, origin and direction of the output. */
+  itkSetMacro( Size, SizeType );
+  itkGetConstReferenceMacro( Size, SizeType );
+  itkSetMacro( Spacing, SpacingType );
+  itkGetConstReferenceMacro( Spacing, SpacingType );
+  itkSetMacro( Origin, PointType );
+  itkGetConstReferenceMacro( Origin, PointType );
+  itkSetMacro( Direction, DirectionType );
+  itkGetConstReferenceMacro( Direction, DirectionType );
+
+  /** Set/Get the distance in pixels between two grid lines. Default 1. */
+  itkSetMacro( Distance, SizeType );
+  itkGetConstReferenceMacro( Distance, SizeType );
+
+  /** For 3D, create a stack of 2D grids. Default off. */
+  itkSetMacro( Is2DStack, bool );
+  itkGetConstMacro( Is2DStack, bool );
+  itkBooleanMacro( Is2DStack );
+
+protected:
+  GridImageSource();
+  virtual ~GridImageSource() {};
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** Set the geometry of the output. */
+  virtual void GenerateOutputInformation( void );
+
+  /** Fill the lines of the region of a thread. */
+  void ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+    ThreadIdType threadId );
+
+private:
+  GridImageSource( const Self & );  // purposely not implemented
+  void operator=( const Self & );   // purposely not implemented
+
+  SizeType              m_Size;
+  SpacingType           m_Spacing;
+  PointType             m_Origin;
+  DirectionType         m_Direction;
+  SizeType              m_Distance;
+  bool                  m_Is2DStack;
+
+}; // end class GridImageSource
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkGridImageSource.txx"
+#endif
+
+#endif // end #ifndef __itkGridImageSource_h_
@@ -0,0 +1,157 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkGridImageSource_txx_
+#define __itkGridImageSource_txx_
+
+#include "itkGridImageSource.h"
+#include "itkImageLinearIteratorWithIndex.h"
+#include "itkProgressReporter.h"
+#include <algorithm>
+
+namespace itk
+{
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template< class TOutputImage >
+GridImageSource< TOutputImage >
+::GridImageSource()
+{
+  this->m_Size.Fill( 0 );
+  this->m_Spacing.Fill( 1.0 );
+  this->m_Origin.Fill( 0.0 );
+  this->m_Direction.SetIdentity();
+  this->m_Distance.Fill( 1 );
+  this->m_Is2DStack = false;
+
+} // end Constructor
+
+
+/**
+ * ******************* GenerateOutputInformation *******************
+ */
+
+template< class TOutputImage >
+void
+GridImageSource< TOutputImage >
+::GenerateOutputInformation( void )
+{
+  OutputImageType * output = this->GetOutput( 0 );
+  OutputImageRegionType region;
+  region.SetSize( this->m_Size );
+  output->SetLargestPossibleRegion( region );
+  output->SetSpacing( this->m_Spacing );
+  output->SetOrigin( this->m_Origin );
+  output->SetDirection( this->m_Direction );
+
+} // end GenerateOutputInformation()
+
+
+/**
+ * ******************* ThreadedGenerateData *******************
+ */
+
+template< class TOutputImage >
+void
+GridImageSource< TOutputImage >
+::ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+  ThreadIdType threadId )
+{
+  typedef ImageLinearIteratorWithIndex< OutputImageType > IteratorType;
+  typedef typename OutputImageType::IndexType             IndexType;
+
+  const OutputPixelType on = NumericTraits<OutputPixelType>::One;
+  const OutputPixelType off = NumericTraits<OutputPixelType>::Zero;
+  const OffsetValueType distance0 = static_cast<OffsetValueType>( this->m_Distance[ 0 ] );
+  const OffsetValueType start0 = outputRegionForThread.GetIndex()[ 0 ];
+  const SizeValueType length = outputRegionForThread.GetSize()[ 0 ];
+
+  /** The first pixel of the region on a line of dimension 1. */
+  const OffsetValueType first0 = ( ( start0 + distance0 - 1 ) / distance0 ) * distance0 - start0;
+
+  OutputImageType * output = this->GetOutput( 0 );
+  IteratorType it( output, outputRegionForThread );
+  it.SetDirection( 0 );
+  ProgressReporter progress( this, threadId,
+    outputRegionForThread.GetNumberOfPixels() / length );
+
+  it.GoToBegin();
+  while( !it.IsAtEnd() )
+  {
+    const IndexType index = it.GetIndex();
+    OutputPixelType * line = &output->GetPixel( index );
+
+    /** The lines in dimension 0 are in a grid plane, or only cross the
+     * lines in dimension 1 or 2.
+     */
+    bool inPlane = true;
+    if( ImageDimension > 2 && !this->m_Is2DStack )
+    {
+      inPlane = index[ 2 ] % static_cast<OffsetValueType>( this->m_Distance[ 2 ] ) == 0;
+    }
+    const bool onLine1 = index[ 1 ] % static_cast<OffsetValueType>( this->m_Distance[ 1 ] ) == 0;
+
+    if( inPlane && onLine1 )
+    {
+      std::fill( line, line + length, on );
+    }
+    else
+    {
+      std::fill( line, line + length, off );
+      if( inPlane || onLine1 )
+      {
+        for( SizeValueType i = static_cast<SizeValueType>( first0 ); i < length;
+          i += static_cast<SizeValueType>( distance0 ) )
+        {
+          line[ i ] = on;
+        }
+      }
+    }
+
+    it.NextLine();
+    progress.CompletedPixel();
+  }
+
+} // end ThreadedGenerateData()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template< class TOutputImage >
+void
+GridImageSource< TOutputImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "Size: " << this->m_Size << std::endl;
+  os << indent << "Spacing: " << this->m_Spacing << std::endl;
+  os << indent << "Origin: " << this->m_Origin << std::endl;
+  os << indent << "Direction: " << this->m_Direction << std::endl;
+  os << indent << "Distance: " << this->m_Distance << std::endl;
+  os << indent << "Is2DStack: " << this->m_Is2DStack << std::endl;
+
+} // end PrintSelf()
+
+} // end namespace itk
+
+#endif // end #ifndef __itkGridImageSource_txx_
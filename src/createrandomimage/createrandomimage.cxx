@@ -48,12 +48,14 @@ std::string GetHelpString( void )
     << "  -d1      Size of dimension 1\n"
     << "  [-d2]    Size of dimension 2\n"
     << "  [-r]     The resolution of the random image <unsigned long>.\n"
-    << "This determines the number of voxels set to a random value before blurring.\n"
+    << "This determines the number of voxels set to a random value before blurring,\n"
+    << "on average.\n"
     << "If set to 0, all voxels are set to a random value\n"
     << "  [-sigma] The standard deviation of the blurring filter\n"
     << "  [-min]   Minimum pixel value\n"
     << "  [-max]   Maximum pixel value\n"
-    << "  [-seed]  The random seed <int>";
+    << "  [-seed]  The random seed <int>. The voxels are generated in parallel from\n"
+    << "the seed and their position, so the image does not depend on the number of threads.";
   //<< "\t[-d3]  \tSize of dimension 3\n"
   //<< "\t[-d4]  \tSize of dimension 4\n"
   return ss.str();
@@ -129,7 +131,7 @@ int main( int argc, char** argv )
     makeString << "-d" << i;
     unsigned int dimsize = 0;
     bool retdimsize = parser->GetCommandLineArgument( makeString.str(), dimsize );
-    if( !retdimsize )
+    if( retdimsize )
     {
       sizes[ i ] = dimsize;
       nrOfPixels *= sizes[ i ];
@@ -178,6 +180,7 @@ int main( int argc, char** argv )
     filter->m_Rand_seed = rand_seed;
     filter->m_SpaceDimension = spaceDimension;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
@@ -23,24 +23,15 @@
 #include "itkImageFileWriter.h"
 #include "itkArray.h"
 #include "itkImage.h"
-#include "itkVector.h"
-#include "itkImageRandomIteratorWithIndex.h"
-#include "itkImageRegionIterator.h"
-//#include "itkDiscreteGaussianImageFilter.h"
-//#include "itkRecursiveGaussianImageFilter.h"
+#include "itkVectorImage.h"
+#include "itkImageRegionConstIterator.h"
 #include "itkSmoothingRecursiveGaussianImageFilter.h"
-#include "itkCastImageFilter.h"
-#include "itkExtractImageFilter.h"
-#include "itkCompose2DVectorImageFilter.h"
-#include "itkCompose3DVectorImageFilter.h"
-#include "itkExceptionObject.h"
+#include "itkCounterBasedRandomImageSource.h"
 #include "itkNumericTraits.h"
-#include "itkImageToVectorImageFilter.h"
-#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "vnl/vnl_math.h"
 #include <iostream>
 #include <string>
 #include <math.h>
-#include <map>
 
 
 /** \class ITKToolsCreateRandomImageBase
@@ -103,71 +94,34 @@ public:
     typedef float                                           InternalValueType;
 
     /** Typedef's. */
-    typedef itk::Image< TComponentType, VDimension >        ImageType;
-    typedef itk::Image< InternalValueType, VDimension >     InternalImageType;
     typedef itk::Image< TComponentType, VDimension >        ScalarOutputImageType;
     typedef itk::VectorImage< TComponentType, VDimension >  VectorOutputImageType;
-    typedef typename ImageType::Pointer                     ImagePointer;
-    typedef typename InternalImageType::Pointer             InternalImagePointer;
+    typedef itk::Image< InternalValueType, VDimension >     InternalImageType;
 
-    typedef typename ImageType::SizeType      SizeType;
-    typedef typename ImageType::IndexType     IndexType;
-    typedef typename ImageType::PointType     OriginType;
-    typedef typename ImageType::RegionType    RegionType;
+    typedef typename InternalImageType::SizeType    SizeType;
+    typedef typename InternalImageType::IndexType   IndexType;
+    typedef typename InternalImageType::PointType   OriginType;
+    typedef typename InternalImageType::RegionType  RegionType;
 
-    typedef typename InternalImageType::SizeType    InternalSizeType;
-    typedef typename InternalImageType::IndexType   InternalIndexType;
-    typedef typename InternalImageType::PointType   InternalOriginType;
-    typedef typename InternalImageType::RegionType  InternalRegionType;
-    typedef std::vector< InternalImagePointer >     SetOfChannelsType;
+    typedef itk::ImageRegionConstIterator< InternalImageType > IteratorType;
 
-    typedef itk::ImageRandomIteratorWithIndex< InternalImageType >  RandomIteratorType;
-    typedef itk::ImageRegionIterator< InternalImageType >           RegionIteratorType;
+    /** The counter based random source, generating in parallel. */
+    typedef itk::CounterBasedRandomImageSource<
+      InternalImageType >                                 RandomSourceType;
 
     /** Blurring filter */
-    //typedef itk::DiscreteGaussianImageFilter<
-    // InternalImageType, InternalImageType>              BlurFilterType;
     typedef itk::SmoothingRecursiveGaussianImageFilter<
       InternalImageType, InternalImageType>               BlurFilterType;
-    typedef typename BlurFilterType::Pointer              BlurFilterPointer;
-
-    typedef std::vector<BlurFilterPointer>                SetOfBlurrersType;
-
-    typedef itk::CastImageFilter<InternalImageType, ImageType> CastFilterType;
-    typedef typename CastFilterType::Pointer CastFilterPointer;
-    typedef std::vector<CastFilterPointer> SetOfCastersType;
-
-    typedef itk::ExtractImageFilter<ImageType, ImageType> ExtractFilterType;
-    typedef typename ExtractFilterType::Pointer ExtractFilterPointer;
-    typedef std::vector<ExtractFilterPointer> SetOfExtractersType;
 
     /** ImageWriters */
-    typedef itk::ImageFileWriter<VectorOutputImageType> VectorWriterType;
-    typedef typename VectorWriterType::Pointer VectorWriterPointer;
-
-    /** RandomGenerator */
-    typedef itk::Statistics::MersenneTwisterRandomVariateGenerator RandomGeneratorType;
-    typedef RandomGeneratorType::Pointer RandomGeneratorPointer;
-
-    /** Create variables */
-    VectorWriterPointer vectorWriter = 0;
-
-    SetOfChannelsType setOfChannels( this->m_SpaceDimension );
-    SetOfBlurrersType setOfBlurrers( this->m_SpaceDimension );
-    SetOfCastersType setOfCasters( this->m_SpaceDimension );
-    SetOfExtractersType setOfExtracters( this->m_SpaceDimension );
-
-    RandomGeneratorPointer randomGenerator = RandomGeneratorType::GetInstance();
-    bool randomiterating = true;
-
-    /** Set the random seed */
-    randomGenerator->SetSeed( this->m_Rand_seed );
+    typedef itk::ImageFileWriter<ScalarOutputImageType>   ScalarWriterType;
+    typedef itk::ImageFileWriter<VectorOutputImageType>   VectorWriterType;
 
     /** Convert the itkArray to an itkSizeType and calculate nrOfPixels */
-    InternalSizeType internalimagesize;
-    InternalIndexType internalimageindex;
-    InternalOriginType internalimageorigin;
-    InternalRegionType internalimageregion;
+    SizeType internalimagesize;
+    IndexType internalimageindex;
+    OriginType internalimageorigin;
+    RegionType internalimageregion;
     SizeType imagesize;
     IndexType imageindex;
     OriginType imageorigin;
@@ -208,101 +162,104 @@ public:
     imageregion.SetSize( imagesize );
     imageregion.SetIndex( imageindex );
 
-    /** Check whether a random iterator should be used or a region */
-    if( this->m_Resolution == 0 )
+    /** With a resolution, that many voxels are set to a random value on
+     * average, otherwise all voxels are. */
+    double samplingProbability = 1.0;
+    if( this->m_Resolution != 0 )
     {
-      randomiterating = false;
+      samplingProbability = vnl_math_min( 1.0,
+        static_cast<double>( this->m_Resolution )
+        / static_cast<double>( internalimageregion.GetNumberOfPixels() ) );
     }
 
-    /** Create the images */
+    /** Allocate the output, a scalar image for one channel. */
+    typename ScalarOutputImageType::Pointer scalarOutput = 0;
+    typename VectorOutputImageType::Pointer vectorOutput = 0;
+    TComponentType * outputBuffer = 0;
+    if( this->m_SpaceDimension == 1 )
+    {
+      scalarOutput = ScalarOutputImageType::New();
+      scalarOutput->SetRegions( imageregion );
+      scalarOutput->SetOrigin( imageorigin );
+      scalarOutput->Allocate();
+      outputBuffer = scalarOutput->GetBufferPointer();
+    }
+    else
+    {
+      vectorOutput = VectorOutputImageType::New();
+      vectorOutput->SetRegions( imageregion );
+      vectorOutput->SetOrigin( imageorigin );
+      vectorOutput->SetNumberOfComponentsPerPixel( this->m_SpaceDimension );
+      vectorOutput->Allocate();
+      outputBuffer = vectorOutput->GetBufferPointer();
+    }
+
+    /** Generate the channels, one at a time. */
     for( unsigned int i = 0; i < this->m_SpaceDimension; i++ )
     {
-      setOfChannels[ i ] = InternalImageType::New();
-      setOfChannels[ i ]->SetRegions( internalimageregion );
-      setOfChannels[ i ]->SetOrigin( internalimageorigin );
-      setOfChannels[ i ]->SetRequestedRegion( imageregion );
-      setOfChannels[ i ]->Allocate();
-      setOfChannels[ i ]->FillBuffer( itk::NumericTraits<InternalValueType>::Zero );
-
-      /** Setting random values to random points */
-      if( randomiterating )
+      if( samplingProbability < 1.0 )
       {
         std::cout << "Channel" << i
           << ": Setting random values to " << this->m_Resolution << " random points."
           << std::endl;
-        RandomIteratorType iterator
-          = RandomIteratorType( setOfChannels[ i ], setOfChannels[ i ]->GetLargestPossibleRegion() );
-        iterator.SetNumberOfSamples( this->m_Resolution );
-        iterator.GoToBegin();
-
-        while( !iterator.IsAtEnd() )
-        {
-          /** Set a random value to a random point */
-          iterator.Set( static_cast<InternalValueType>(
-            randomGenerator->GetUniformVariate( this->m_Min_value, this->m_Max_value ) ) );
-          ++iterator;
-        }
       }
       else
       {
         std::cout << "Channel" << i
           << ": Setting random values to all voxels in the image."
           << std::endl;
-        RegionIteratorType iterator
-          = RegionIteratorType( setOfChannels[ i ], setOfChannels[ i ]->GetLargestPossibleRegion() );
-        iterator.GoToBegin();
-        while( !iterator.IsAtEnd() )
-        {
-          /** Set a random value to a point */
-          iterator.Set( static_cast<InternalValueType>(
-            randomGenerator->GetUniformVariate( this->m_Min_value, this->m_Max_value ) ) );
-          ++iterator;
-        }
       }
 
+      /** Every channel has its own stream of the seed. */
+      typename RandomSourceType::Pointer randomSource = RandomSourceType::New();
+      randomSource->SetRegion( internalimageregion );
+      randomSource->SetOrigin( internalimageorigin );
+      randomSource->SetMinimum( this->m_Min_value );
+      randomSource->SetMaximum( this->m_Max_value );
+      randomSource->SetSeed( static_cast<unsigned long>( this->m_Rand_seed ) );
+      randomSource->SetStream( i );
+      randomSource->SetSamplingProbability( samplingProbability );
+      randomSource->ReleaseDataFlagOn();
+
       /** The random image is blurred */
       std::cout << "Channel" << i
         << ": Blurring with standard deviation " << this->m_Sigma
         << "." << std::endl;
-      setOfBlurrers[ i ] = BlurFilterType::New();
-      setOfBlurrers[ i ]->SetSigma( this->m_Sigma );
-
-      //setOfBlurrers[ i ]->SetVariance( sigma*sigma );
-      //setOfBlurrers[ i ]->SetUseImageSpacingOff();
-      //setOfBlurrers[ i ]->SetMaximumError(0.01);
-      //setOfBlurrers[ i ]->SetMaximumKernelWidth(maximumKernelWidth);
-      setOfBlurrers[ i ]->SetInput( setOfChannels[ i ] );
-
-      setOfCasters[ i ] = CastFilterType::New();
-      setOfCasters[ i ]->SetInput( setOfBlurrers[ i ]->GetOutput() );
-      //setOfCasters[ i ]->UpdateLargestPossibleRegion();
-
-      setOfExtracters[ i ] = ExtractFilterType::New();
-      setOfExtracters[ i ]->SetInput( setOfCasters[ i ]->GetOutput() );
-      setOfExtracters[ i ]->SetExtractionRegion(imageregion);
-
-      // suppress warnings about exceeding the maximum kernel width,
-      // generated by the blurrers.
-      //  itk::Object::GlobalWarningDisplayOff();
-      setOfExtracters[ i ]->Update();
-      //  itk::Object::GlobalWarningDisplayOn();
-    }
-
-    typedef itk::ImageToVectorImageFilter<ScalarOutputImageType> ImageToVectorImageFilterType;
-    typename ImageToVectorImageFilterType::Pointer imageToVectorImageFilter = ImageToVectorImageFilterType::New();
-    for( unsigned int spaceDimensionIndex = 0; spaceDimensionIndex < this->m_SpaceDimension; ++spaceDimensionIndex )
-    {
-      imageToVectorImageFilter->SetNthInput( spaceDimensionIndex, setOfExtracters[spaceDimensionIndex]->GetOutput() );
+      typename BlurFilterType::Pointer blurrer = BlurFilterType::New();
+      blurrer->SetSigma( this->m_Sigma );
+      blurrer->SetInput( randomSource->GetOutput() );
+      blurrer->GetOutput()->SetRequestedRegion( imageregion );
+      blurrer->Update();
+
+      /** Write the image region of the channel into its component. */
+      const unsigned int numberOfComponents = this->m_SpaceDimension;
+      TComponentType * out = outputBuffer + i;
+      IteratorType it( blurrer->GetOutput(), imageregion );
+      for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+      {
+        *out = static_cast<TComponentType>( it.Get() );
+        out += numberOfComponents;
+      }
     }
-    imageToVectorImageFilter->Update();
 
     std::cout << "Saving image to disk as \""
       << this->m_OutputFileName << "\""
       << std::endl;
 
-    vectorWriter = VectorWriterType::New();
-    vectorWriter->SetInput(imageToVectorImageFilter->GetOutput());
-    vectorWriter->Update();
+    if( scalarOutput.IsNotNull() )
+    {
+      typename ScalarWriterType::Pointer writer = ScalarWriterType::New();
+      writer->SetFileName( this->m_OutputFileName );
+      writer->SetInput( scalarOutput );
+      writer->Update();
+    }
+    else
+    {
+      typename VectorWriterType::Pointer writer = VectorWriterType::New();
+      writer->SetFileName( this->m_OutputFileName );
+      writer->SetInput( vectorOutput );
+      writer->Update();
+    }
 
   } // end Run()
 
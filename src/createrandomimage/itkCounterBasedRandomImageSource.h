@@ -0,0 +1,135 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkCounterBasedRandomImageSource_h_
+#define __itkCounterBasedRandomImageSource_h_
+
+#include "itkImageSource.h"
+
+namespace itk
+{
+
+/** \class CounterBasedRandomImageSource
+ * \brief Generate an image of uniform random values in parallel.
+ *
+ * The value of a voxel is a hash of the seed, the stream number and the
+ * position of the voxel in the output region, instead of the next number
+ * of a sequential generator. The threads fill their regions independently,
+ * and the image is bitwise the same for any number of threads, and for
+ * any order in which the voxels are generated.
+ *
+ * With a SamplingProbability below 1, a voxel gets a random value with
+ * that probability, drawn from its own counter as well, and is zero
+ * otherwise. Different streams give independent images for the same seed,
+ * for example one per channel.
+ *
+ * \ingroup DataSources
+ */
+
+template< class TOutputImage >
+class ITK_EXPORT CounterBasedRandomImageSource :
+  public ImageSource< TOutputImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef CounterBasedRandomImageSource   Self;
+  typedef ImageSource< TOutputImage >     Superclass;
+  typedef SmartPointer<Self>              Pointer;
+  typedef SmartPointer<const Self>        ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( CounterBasedRandomImageSource, ImageSource );
+
+  /** Typedefs. */
+  typedef TOutputImage                                OutputImageType;
+  typedef typename OutputImageType::PixelType         OutputPixelType;
+  typedef typename OutputImageType::RegionType        OutputImageRegionType;
+  typedef typename OutputImageType::PointType         PointType;
+  typedef typename OutputImageType::SpacingType       SpacingType;
+
+  itkStaticConstMacro( ImageDimension, unsigned int, TOutputImage::ImageDimension );
+
+  /** Set/Get the largest possible region of the output. */
+  itkSetMacro( Region, OutputImageRegionType );
+  itkGetConstReferenceMacro( Region, OutputImageRegionType );
+
+  /** Set/Get the origin and the spacing of the output. */
+  itkSetMacro( Origin, PointType );
+  itkGetConstReferenceMacro( Origin, PointType );
+  itkSetMacro( Spacing, SpacingType );
+  itkGetConstReferenceMacro( Spacing, SpacingType );
+
+  /** Set/Get the range of the random values. */
+  itkSetMacro( Minimum, double );
+  itkGetConstMacro( Minimum, double );
+  itkSetMacro( Maximum, double );
+  itkGetConstMacro( Maximum, double );
+
+  /** Set/Get the seed and the stream number. */
+  itkSetMacro( Seed, unsigned long );
+  itkGetConstMacro( Seed, unsigned long );
+  itkSetMacro( Stream, unsigned long );
+  itkGetConstMacro( Stream, unsigned long );
+
+  /** Set/Get the probability that a voxel gets a random value. Default 1. */
+  itkSetClampMacro( SamplingProbability, double, 0.0, 1.0 );
+  itkGetConstMacro( SamplingProbability, double );
+
+protected:
+  CounterBasedRandomImageSource();
+  virtual ~CounterBasedRandomImageSource() {};
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** Set the region, origin and spacing of the output. */
+  virtual void GenerateOutputInformation( void );
+
+  /** Fill the region of a thread. */
+  void ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+    ThreadIdType threadId );
+
+  /** The counter based generator: a uniform number in [0,1), from the
+   * hashed key of seed and stream, and a counter. */
+  static double GetUniform( unsigned long long key, unsigned long long counter );
+
+  /** The SplitMix64 finalizer, a bijective 64 bit mixing function. */
+  static unsigned long long Mix( unsigned long long z );
+
+private:
+  CounterBasedRandomImageSource( const Self & ); // purposely not implemented
+  void operator=( const Self & );                // purposely not implemented
+
+  OutputImageRegionType m_Region;
+  PointType             m_Origin;
+  SpacingType           m_Spacing;
+  double                m_Minimum;
+  double                m_Maximum;
+  unsigned long         m_Seed;
+  unsigned long         m_Stream;
+  double                m_SamplingProbability;
+
+}; // end class CounterBasedRandomImageSource
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkCounterBasedRandomImageSource.txx"
+#endif
+
+#endif // end #ifndef __itkCounterBasedRandomImageSource_h_
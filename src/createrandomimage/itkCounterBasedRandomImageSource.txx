@@ -0,0 +1,184 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkCounterBasedRandomImageSource_txx_
+#define __itkCounterBasedRandomImageSource_txx_
+
+#include "itkCounterBasedRandomImageSource.h"
+#include "itkImageLinearIteratorWithIndex.h"
+#include "itkProgressReporter.h"
+
+namespace itk
+{
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template< class TOutputImage >
+CounterBasedRandomImageSource< TOutputImage >
+::CounterBasedRandomImageSource()
+{
+  this->m_Origin.Fill( 0.0 );
+  this->m_Spacing.Fill( 1.0 );
+  this->m_Minimum = 0.0;
+  this->m_Maximum = 1.0;
+  this->m_Seed = 0;
+  this->m_Stream = 0;
+  this->m_SamplingProbability = 1.0;
+
+} // end Constructor
+
+
+/**
+ * ******************* GenerateOutputInformation *******************
+ */
+
+template< class TOutputImage >
+void
+CounterBasedRandomImageSource< TOutputImage >
+::GenerateOutputInformation( void )
+{
+  OutputImageType * output = this->GetOutput( 0 );
+  output->SetLargestPossibleRegion( this->m_Region );
+  output->SetOrigin( this->m_Origin );
+  output->SetSpacing( this->m_Spacing );
+
+} // end GenerateOutputInformation()
+
+
+/**
+ * ******************* ThreadedGenerateData *******************
+ */
+
+template< class TOutputImage >
+void
+CounterBasedRandomImageSource< TOutputImage >
+::ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+  ThreadIdType threadId )
+{
+  typedef ImageLinearIteratorWithIndex< OutputImageType > IteratorType;
+  typedef typename OutputImageType::IndexType             IndexType;
+
+  /** The strides of the largest possible region, for the counters. */
+  const IndexType start = this->m_Region.GetIndex();
+  unsigned long long strides[ ImageDimension ];
+  strides[ 0 ] = 1;
+  for( unsigned int i = 1; i < ImageDimension; ++i )
+  {
+    strides[ i ] = strides[ i - 1 ] * this->m_Region.GetSize()[ i - 1 ];
+  }
+
+  const unsigned long long key = Mix( Mix( this->m_Seed )
+    ^ ( static_cast<unsigned long long>( this->m_Stream ) + 0x9E3779B97F4A7C15ULL ) );
+  const double range = this->m_Maximum - this->m_Minimum;
+  const bool sampling = this->m_SamplingProbability < 1.0;
+
+  IteratorType it( this->GetOutput(), outputRegionForThread );
+  it.SetDirection( 0 );
+  ProgressReporter progress( this, threadId,
+    outputRegionForThread.GetNumberOfPixels() / outputRegionForThread.GetSize()[ 0 ] );
+
+  it.GoToBegin();
+  while( !it.IsAtEnd() )
+  {
+    /** The offset of the first voxel of the line. */
+    const IndexType index = it.GetIndex();
+    unsigned long long offset = 0;
+    for( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+      offset += static_cast<unsigned long long>( index[ i ] - start[ i ] ) * strides[ i ];
+    }
+
+    /** Two counters per voxel: the value and the sampling draw. */
+    while( !it.IsAtEndOfLine() )
+    {
+      double value = 0.0;
+      if( !sampling
+        || GetUniform( key, 2 * offset + 1 ) < this->m_SamplingProbability )
+      {
+        value = this->m_Minimum + range * GetUniform( key, 2 * offset );
+      }
+      it.Set( static_cast<OutputPixelType>( value ) );
+      ++it;
+      ++offset;
+    }
+
+    it.NextLine();
+    progress.CompletedPixel();
+  }
+
+} // end ThreadedGenerateData()
+
+
+/**
+ * ******************* GetUniform *******************
+ */
+
+template< class TOutputImage >
+double
+CounterBasedRandomImageSource< TOutputImage >
+::GetUniform( unsigned long long key, unsigned long long counter )
+{
+  /** The upper 53 bits of the hash, scaled to [0,1). */
+  const unsigned long long bits = Mix( key + counter * 0x9E3779B97F4A7C15ULL );
+  return static_cast<double>( bits >> 11 ) * ( 1.0 / 9007199254740992.0 );
+
+} // end GetUniform()
+
+
+/**
+ * ******************* Mix *******************
+ */
+
+template< class TOutputImage >
+unsigned long long
+CounterBasedRandomImageSource< TOutputImage >
+::Mix( unsigned long long z )
+{
+  z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+  z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBULL;
+  return z ^ ( z >> 31 );
+
+} // end Mix()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template< class TOutputImage >
+void
+CounterBasedRandomImageSource< TOutputImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "Region: " << this->m_Region << std::endl;
+  os << indent << "Origin: " << this->m_Origin << std::endl;
+  os << indent << "Spacing: " << this->m_Spacing << std::endl;
+  os << indent << "Minimum: " << this->m_Minimum << std::endl;
+  os << indent << "Maximum: " << this->m_Maximum << std::endl;
+  os << indent << "Seed: " << this->m_Seed << std::endl;
+  os << indent << "Stream: " << this->m_Stream << std::endl;
+  os << indent << "SamplingProbability: " << this->m_SamplingProbability << std::endl;
+
+} // end PrintSelf()
+
+} // end namespace itk
+
+#endif // end #ifndef __itkCounterBasedRandomImageSource_txx_
@@ -0,0 +1,249 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+/** \file
+ \brief Create an image with many spheres, ellipsoids and boxes.
+
+ \verbinclude createshapes.help
+ */
+
+/** Setup Mevislab DicomTiff IO support */
+#include "itkUseMevisDicomTiff.h"
+
+#include "itkCommandLineArgumentParser.h"
+#include "ITKToolsHelpers.h"
+#include "createshapes.h"
+#include <fstream>
+
+
+/**
+ * ******************* GetHelpString *******************
+ */
+
+std::string GetHelpString( void )
+{
+  std::stringstream ss;
+  ss << "ITKTools v" << itktools::GetITKToolsVersion() << "\n"
+    << "Usage:\n"
+    << "pxcreateshapes\n"
+    << "  -out     outputFilename\n"
+    << "  -shapes  shape list filename\n"
+    << "  -sz      image size (voxels)\n"
+    << "  [-sp]    image spacing (mm), default 1.0\n"
+    << "  [-io]    image origin (mm), default 0.0\n"
+    << "  [-bg]    background value, default 0\n"
+    << "  [-dim]   dimension, default 3\n"
+    << "  [-opct]  pixelType, default short\n"
+    << "Every line of the shape list is one shape, one of\n"
+    << "  sphere    value c_1 .. c_dim r\n"
+    << "  ellipsoid value c_1 .. c_dim r_1 .. r_dim [o_11 .. o_dimdim]\n"
+    << "  box       value c_1 .. c_dim r_1 .. r_dim [angles]\n"
+    << "with the center c (mm) and radii r (mm) of pxcreatesphere, pxcreateellipsoid\n"
+    << "and pxcreatebox, the orientation matrix of pxcreateellipsoid in row order,\n"
+    << "and the Euler angles (rad) of pxcreatebox. Empty lines and lines starting\n"
+    << "with '#' are skipped. The shapes are painted in the order of the list,\n"
+    << "in a single pass, and only on the scanlines they cover.\n"
+    << "Supported: 2D, 3D, (unsigned) char, (unsigned) short, float, double.";
+
+  return ss.str();
+
+} // end GetHelpString()
+
+
+/**
+ * ******************* ReadShapeList *******************
+ */
+
+bool ReadShapeList( const std::string & fileName, const unsigned int dim,
+  std::vector<std::string> & kinds, std::vector< std::vector<double> > & parameters )
+{
+  std::ifstream file( fileName.c_str() );
+  if( !file.is_open() )
+  {
+    std::cerr << "ERROR: Could not open the shape list \"" << fileName << "\"." << std::endl;
+    return false;
+  }
+
+  const std::size_t numberOfAngles = dim == 2 ? 1 : 3;
+  std::string line;
+  for( unsigned int lineNumber = 1; std::getline( file, line ); lineNumber++ )
+  {
+    std::istringstream lineStream( line );
+    std::string kind;
+    if( !( lineStream >> kind ) || kind[ 0 ] == '#' ) continue;
+
+    std::vector<double> values;
+    double value;
+    while( lineStream >> value ) values.push_back( value );
+    const bool parsed = lineStream.eof();
+
+    /** The value and center, then the radius and the orientation. */
+    const std::size_t n = values.size();
+    bool valid = false;
+    if( kind == "sphere" )
+    {
+      valid = n == 1 + dim + 1;
+    }
+    else if( kind == "ellipsoid" )
+    {
+      valid = n == 1 + 2 * dim || n == 1 + 2 * dim + dim * dim;
+    }
+    else if( kind == "box" )
+    {
+      valid = n == 1 + 2 * dim || n == 1 + 2 * dim + numberOfAngles;
+    }
+    if( !parsed || !valid )
+    {
+      std::cerr << "ERROR: Line " << lineNumber << " of \"" << fileName
+        << "\" is not a valid shape: \"" << line << "\"." << std::endl;
+      return false;
+    }
+    for( std::size_t i = 1 + dim; i < ( kind == "sphere" ? n : 1 + 2 * dim ); i++ )
+    {
+      if( values[ i ] <= 0.0 )
+      {
+        std::cerr << "ERROR: The radii on line " << lineNumber << " of \""
+          << fileName << "\" should be positive." << std::endl;
+        return false;
+      }
+    }
+
+    kinds.push_back( kind );
+    parameters.push_back( values );
+  }
+
+  return true;
+
+} // end ReadShapeList()
+
+//-------------------------------------------------------------------------------------
+
+int main( int argc, char *argv[] )
+{
+  RegisterMevisDicomTiff();
+
+  /** Create a command line argument parser. */
+  itk::CommandLineArgumentParser::Pointer parser = itk::CommandLineArgumentParser::New();
+  parser->SetCommandLineArguments( argc, argv );
+  parser->SetProgramHelpText( GetHelpString() );
+
+  parser->MarkArgumentAsRequired( "-out", "The output filename." );
+  parser->MarkArgumentAsRequired( "-shapes", "The shape list filename." );
+  parser->MarkArgumentAsRequired( "-sz", "The size." );
+
+  itk::CommandLineArgumentParser::ReturnValue validateArguments = parser->CheckForRequiredArguments();
+
+  if( validateArguments == itk::CommandLineArgumentParser::FAILED )
+  {
+    return EXIT_FAILURE;
+  }
+  else if( validateArguments == itk::CommandLineArgumentParser::HELPREQUESTED )
+  {
+    return EXIT_SUCCESS;
+  }
+
+  /** Get arguments. */
+  std::string outputFileName = "";
+  parser->GetCommandLineArgument( "-out", outputFileName );
+
+  std::string shapesFileName = "";
+  parser->GetCommandLineArgument( "-shapes", shapesFileName );
+
+  unsigned int dim = 3;
+  parser->GetCommandLineArgument( "-dim", dim );
+
+  std::vector<unsigned int> size;
+  parser->GetCommandLineArgument( "-sz", size );
+
+  std::vector<double> spacing( dim, 1.0 );
+  parser->GetCommandLineArgument( "-sp", spacing );
+
+  std::vector<double> origin( dim, 0.0 );
+  parser->GetCommandLineArgument( "-io", origin );
+
+  double backgroundValue = 0.0;
+  parser->GetCommandLineArgument( "-bg", backgroundValue );
+
+  std::string componentTypeAsString = "short";
+  parser->GetCommandLineArgument( "-opct", componentTypeAsString );
+  itk::ImageIOBase::IOComponentType componentType
+    = itk::ImageIOBase::GetComponentTypeFromString( componentTypeAsString );
+
+  if( size.size() != dim || spacing.size() != dim || origin.size() != dim )
+  {
+    std::cerr << "ERROR: The size, spacing and origin should have dim elements." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  /** Read the shapes. */
+  std::vector<std::string> shapeKinds;
+  std::vector< std::vector<double> > shapeParameters;
+  if( !ReadShapeList( shapesFileName, dim, shapeKinds, shapeParameters ) )
+  {
+    return EXIT_FAILURE;
+  }
+
+  /** Class that does the work. */
+  ITKToolsCreateShapesBase * filter = 0;
+
+  try
+  {
+    // now call all possible template combinations.
+    if( !filter ) filter = ITKToolsCreateShapes< 2, unsigned char >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsCreateShapes< 2, char >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsCreateShapes< 2, unsigned short >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsCreateShapes< 2, short >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsCreateShapes< 2, float >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsCreateShapes< 2, double >::New( dim, componentType );
+
+#ifdef ITKTOOLS_3D_SUPPORT
+    if( !filter ) filter = ITKToolsCreateShapes< 3, unsigned char >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsCreateShapes< 3, char >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsCreateShapes< 3, unsigned short >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsCreateShapes< 3, short >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsCreateShapes< 3, float >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsCreateShapes< 3, double >::New( dim, componentType );
+#endif
+    /** Check if filter was instantiated. */
+    bool supported = itktools::IsFilterSupportedCheck( filter, dim, componentType );
+    if( !supported ) return EXIT_FAILURE;
+
+    /** Set the filter arguments. */
+    filter->m_OutputFileName = outputFileName;
+    filter->m_Size = size;
+    filter->m_Spacing = spacing;
+    filter->m_Origin = origin;
+    filter->m_BackgroundValue = backgroundValue;
+    filter->m_ShapeKinds = shapeKinds;
+    filter->m_ShapeParameters = shapeParameters;
+
+    filter->ReadCommonArguments( parser );
+    filter->Run();
+
+    delete filter;
+  }
+  catch( itk::ExceptionObject & excp )
+  {
+    std::cerr << "ERROR: Caught ITK exception: " << excp << std::endl;
+    delete filter;
+    return EXIT_FAILURE;
+  }
+
+  /** End program. Return a value. */
+  return EXIT_SUCCESS;
+
+} // end main
@@ -0,0 +1,223 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __createshapes_h_
+#define __createshapes_h_
+
+#include "ITKToolsBase.h"
+
+#include "itkConvexShapeListImageSource.h"
+#include "itkEuler2DTransform.h"
+#include "itkEuler3DTransform.h"
+#include "itkImageFileWriter.h"
+
+
+/** \class ITKToolsCreateShapesBase
+ *
+ * Untemplated pure virtual base class that holds
+ * the Run() function and all required parameters.
+ */
+
+class ITKToolsCreateShapesBase : public itktools::ITKToolsBase
+{
+public:
+  /** Constructor. */
+  ITKToolsCreateShapesBase()
+  {
+    this->m_OutputFileName = "";
+    this->m_BackgroundValue = 0.0;
+  }
+  /** Destructor. */
+  ~ITKToolsCreateShapesBase(){};
+
+  /** Input member parameters. */
+  std::string m_OutputFileName;
+  std::vector<unsigned int> m_Size;
+  std::vector<double> m_Spacing;
+  std::vector<double> m_Origin;
+  double m_BackgroundValue;
+
+  /** The shapes: the kind, sphere, ellipsoid or box, and the value,
+   * center, radius and optional orientation, see the help. */
+  std::vector<std::string> m_ShapeKinds;
+  std::vector< std::vector<double> > m_ShapeParameters;
+
+}; // end class ITKToolsCreateShapesBase
+
+
+/** \class ITKToolsCreateShapes
+ *
+ * Templated class that implements the Run() function
+ * and the New() function for its creation.
+ */
+
+template< unsigned int VDimension, class TComponentType >
+class ITKToolsCreateShapes : public ITKToolsCreateShapesBase
+{
+public:
+  /** Standard ITKTools stuff. */
+  typedef ITKToolsCreateShapes Self;
+  itktoolsOneTypeNewMacro( Self );
+
+  ITKToolsCreateShapes(){};
+  ~ITKToolsCreateShapes(){};
+
+  /** Run function. */
+  void Run( void )
+  {
+    /** Typedefs. */
+    typedef itk::Image< TComponentType, VDimension >      ImageType;
+    typedef itk::ConvexShapeListImageSource< ImageType >  SourceType;
+    typedef typename SourceType::ShapeType                ShapeType;
+    typedef typename SourceType::VectorType               VectorType;
+    typedef typename SourceType::MatrixType               MatrixType;
+    typedef itk::ImageFileWriter< ImageType >             ImageWriterType;
+
+    typedef typename ImageType::RegionType                RegionType;
+    typedef typename RegionType::SizeType                 SizeType;
+    typedef typename RegionType::SizeValueType            SizeValueType;
+    typedef typename ImageType::PointType                 PointType;
+    typedef typename ImageType::SpacingType               SpacingType;
+
+    /** Parse the arguments. */
+    SizeType    Size;
+    SpacingType Spacing;
+    PointType   Origin;
+    for( unsigned int i = 0; i < VDimension; i++ )
+    {
+      Size[ i ] = static_cast<SizeValueType>( this->m_Size[ i ] );
+      Spacing[ i ] = this->m_Spacing[ i ];
+      Origin[ i ] = this->m_Origin[ i ];
+    }
+
+    typename SourceType::Pointer source = SourceType::New();
+    source->SetSize( Size );
+    source->SetSpacing( Spacing );
+    source->SetOrigin( Origin );
+    source->SetBackgroundValue( static_cast<TComponentType>( this->m_BackgroundValue ) );
+
+    /** Convert the shapes as pxcreatesphere, pxcreateellipsoid and
+     * pxcreatebox do.
+     */
+    for( std::size_t s = 0; s < this->m_ShapeKinds.size(); s++ )
+    {
+      const std::string & kind = this->m_ShapeKinds[ s ];
+      const std::vector<double> & par = this->m_ShapeParameters[ s ];
+
+      ShapeType shape;
+      shape.Value = static_cast<TComponentType>( par[ 0 ] );
+      shape.UseQuadric = false;
+      shape.Quadric.SetIdentity();
+      for( unsigned int i = 0; i < VDimension; i++ )
+      {
+        shape.Center[ i ] = par[ 1 + i ];
+      }
+      const std::size_t radiusOffset = 1 + VDimension;
+
+      if( kind == "sphere" )
+      {
+        /** The quadric A = I / r^2. */
+        const double radius = par[ radiusOffset ];
+        shape.UseQuadric = true;
+        shape.Quadric *= 1.0 / ( radius * radius );
+      }
+      else if( kind == "ellipsoid" )
+      {
+        /** The quadric A = sum_i o_i o_i^T / ( 0.5 r_i )^2. */
+        const std::size_t orientationOffset = radiusOffset + VDimension;
+        const bool hasOrientation = par.size() > orientationOffset;
+        shape.UseQuadric = true;
+        shape.Quadric.Fill( 0.0 );
+        for( unsigned int i = 0; i < VDimension; i++ )
+        {
+          const double halfAxis = 0.5 * par[ radiusOffset + i ];
+          const double weight = 1.0 / ( halfAxis * halfAxis );
+          for( unsigned int j = 0; j < VDimension; j++ )
+          {
+            const double oij = hasOrientation
+              ? par[ orientationOffset + i * VDimension + j ] : ( i == j ? 1.0 : 0.0 );
+            for( unsigned int k = 0; k < VDimension; k++ )
+            {
+              const double oik = hasOrientation
+                ? par[ orientationOffset + i * VDimension + k ] : ( i == k ? 1.0 : 0.0 );
+              shape.Quadric[ j ][ k ] += weight * oij * oik;
+            }
+          }
+        }
+      }
+      else if( kind == "box" )
+      {
+        /** The slabs |R_i.(p-c)| < r_i, with R_i the i-th column of the
+         * rotation by the Euler angles. */
+        const std::size_t angleOffset = radiusOffset + VDimension;
+        MatrixType rotation;
+        rotation.SetIdentity();
+        if( par.size() > angleOffset && VDimension == 2 )
+        {
+          typename itk::Euler2DTransform< double >::Pointer euler
+            = itk::Euler2DTransform< double >::New();
+          euler->SetAngle( par[ angleOffset ] );
+          for( unsigned int i = 0; i < VDimension; i++ )
+          {
+            for( unsigned int j = 0; j < VDimension; j++ )
+            {
+              rotation[ i ][ j ] = euler->GetMatrix()[ i ][ j ];
+            }
+          }
+        }
+        else if( par.size() > angleOffset && VDimension == 3 )
+        {
+          typename itk::Euler3DTransform< double >::Pointer euler
+            = itk::Euler3DTransform< double >::New();
+          euler->SetRotation( par[ angleOffset ],
+            par[ angleOffset + 1 ], par[ angleOffset + 2 ] );
+          for( unsigned int i = 0; i < VDimension; i++ )
+          {
+            for( unsigned int j = 0; j < VDimension; j++ )
+            {
+              rotation[ i ][ j ] = euler->GetMatrix()[ i ][ j ];
+            }
+          }
+        }
+        for( unsigned int i = 0; i < VDimension; i++ )
+        {
+          VectorType normal;
+          for( unsigned int j = 0; j < VDimension; j++ )
+          {
+            normal[ j ] = rotation[ j ][ i ];
+          }
+          shape.SlabNormals.push_back( normal );
+          shape.SlabHalfWidths.push_back( par[ radiusOffset + i ] );
+        }
+      }
+      source->AddShape( shape );
+    }
+
+    /** Write image. */
+    typename ImageWriterType::Pointer writer = ImageWriterType::New();
+    writer->SetFileName( this->m_OutputFileName.c_str() );
+    writer->SetInput( source->GetOutput() );
+    this->ObserveProcess( source.GetPointer(), "rasterize" );
+    this->ObserveProcess( writer.GetPointer(), "write" );
+    writer->Update();
+
+  } // end Run()
+
+}; // end class ITKToolsCreateShapes
+
+
+#endif // end #ifndef __createshapes_h_
@@ -154,6 +154,7 @@ int main( int argc, char** argv )
     filter->m_IndexA = indexA;
     filter->m_IndexB = indexB;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
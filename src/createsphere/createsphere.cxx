@@ -46,6 +46,8 @@ std::string GetHelpString( void )
     << "-r       radii (mm)" << std::endl
     << "[-dim]   dimension, default 3" << std::endl
     << "[-pt]    pixelType, default short" << std::endl
+    << "[-aa]    anti-aliasing: the number of sub-scanlines per dimension\n"
+    << "         for the partial volume of the edge voxels, default 0 (binary)" << std::endl
   << "Supported: 2D, 3D, (unsigned) char, (unsigned) short, float, double.";
   return ss.str();
 } // end GetHelpString()
@@ -100,6 +102,9 @@ int main( int argc, char *argv[] )
   std::vector<double> spacing( dim, 1.0 );
   parser->GetCommandLineArgument( "-sp", spacing );
 
+  unsigned int subsamples = 0;
+  parser->GetCommandLineArgument( "-aa", subsamples );
+
   /** String to component type. */
   itk::ImageIOBase::IOComponentType componentType
     = itk::ImageIOBase::GetComponentTypeFromString( componentTypeAsString );
@@ -135,7 +140,9 @@ int main( int argc, char *argv[] )
     filter->m_Spacing = spacing;
     filter->m_Center = center;
     filter->m_Radius = radius;
+    filter->m_PartialVolumeSubsamples = subsamples;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
@@ -20,8 +20,7 @@
 
 #include "ITKToolsBase.h"
 
-#include "itkSphereSpatialFunction.h"
-#include "itkImageRegionIterator.h"
+#include "itkConvexShapeImageSource.h"
 #include "itkImageFileWriter.h"
 
 
@@ -39,6 +38,7 @@ public:
   {
     this->m_OutputFileName = "";
     this->m_Radius = 0.0f;
+    this->m_PartialVolumeSubsamples = 0;
   };
   /** Destructor. */
   ~ITKToolsCreateSphereBase(){};
@@ -49,6 +49,7 @@ public:
   std::vector<double> m_Spacing;
   std::vector<double> m_Center;
   double m_Radius;
+  unsigned int m_PartialVolumeSubsamples;
 
 }; // end class ITKToolsCreateSphereBase
 
@@ -75,22 +76,20 @@ public:
   {
     /** Typedefs. */
     typedef itk::Image<TComponentType, VDimension>        ImageType;
-    typedef itk::ImageRegionIterator< ImageType >         IteratorType;
-    typedef itk::SphereSpatialFunction< VDimension >      SphereSpatialFunctionType;
-    typedef typename SphereSpatialFunctionType::InputType InputType;
+    typedef itk::ConvexShapeImageSource< ImageType >      SourceType;
+    typedef typename SourceType::MatrixType               MatrixType;
     typedef itk::ImageFileWriter< ImageType >             ImageWriterType;
 
     typedef typename ImageType::RegionType                RegionType;
     typedef typename RegionType::SizeType                 SizeType;
     typedef typename RegionType::SizeValueType            SizeValueType;
     typedef typename ImageType::PointType                 PointType;
-    typedef typename ImageType::IndexType                 IndexType;
     typedef typename ImageType::SpacingType               SpacingType;
 
     /** Parse the arguments. */
     SizeType    Size;
     SpacingType Spacing;
-    InputType   Center;
+    PointType   Center;
     for( unsigned int i = 0; i < VDimension; i++ )
     {
       Size[ i ] = static_cast<SizeValueType>( this->m_Size[ i ] );
@@ -98,38 +97,23 @@ public:
       Center[ i ] = static_cast<double>( this->m_Center[ i ] );
     }
 
-    /** Create image. */
-    RegionType region;
-    region.SetSize( Size );
-    typename ImageType::Pointer image = ImageType::New();
-    image->SetRegions( region );
-    image->SetSpacing( Spacing );
-    image->Allocate();
-
-    /** Create and initialize ellipsoid. */
-    typename SphereSpatialFunctionType::Pointer sphere = SphereSpatialFunctionType::New();
-    sphere->SetCenter( Center );
-    sphere->SetRadius( this->m_Radius );
-
-    /** Create iterator, index and point. */
-    IteratorType it( image, region );
-    it.GoToBegin();
-    PointType point;
-    IndexType index;
-
-    /** Walk over the image. */
-    while ( !it.IsAtEnd() )
-    {
-      index = it.GetIndex();
-      image->TransformIndexToPhysicalPoint( index, point );
-      it.Set( sphere->Evaluate( point ) );
-      ++it;
-    }
+    /** The sphere is the quadric with A = I / r^2. */
+    MatrixType A;
+    A.SetIdentity();
+    A *= 1.0 / ( this->m_Radius * this->m_Radius );
+
+    /** Create the image, scanline by scanline. */
+    typename SourceType::Pointer source = SourceType::New();
+    source->SetSize( Size );
+    source->SetSpacing( Spacing );
+    source->SetCenter( Center );
+    source->SetQuadric( A );
+    source->SetPartialVolumeSubsamples( this->m_PartialVolumeSubsamples );
 
     /** Write image. */
     typename ImageWriterType::Pointer writer = ImageWriterType::New();
     writer->SetFileName( this->m_OutputFileName.c_str() );
-    writer->SetInput( image );
+    writer->SetInput( source->GetOutput() );
     writer->Update();
 
   } // end Run()
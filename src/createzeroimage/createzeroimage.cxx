@@ -44,8 +44,12 @@ std::string GetHelpString( void )
     << "  -sz      size\n"
     << "  [-sp]    spacing\n"
     << "  [-o]     origin\n"
+    << "  [-d]     direction, default identity\n"
     << "  [-dim]   dimension, default 3\n"
     << "  [-opct]  pixelType, default short\n"
+    << "The image is written in slabs of at most 256 MB, unless -streams\n"
+    << "or -memoryLimit is given; the size of the output is not limited by\n"
+    << "the memory if the output format supports streamed writing.\n"
     << "Supported: 2D, 3D, (unsigned) char, (unsigned) short, float, double.";
 
   return ss.str();
@@ -197,11 +201,13 @@ int main( int argc, char **argv )
     if( !supported ) return EXIT_FAILURE;
 
     /** Set the filter arguments. */
-    filter->m_OutputFileName = inputFileName;
+    filter->m_OutputFileName = outputFileName;
     filter->m_Size = size;
     filter->m_Spacing = spacing;
     filter->m_Origin = origin;
+    filter->m_Direction = direction;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
@@ -20,6 +20,7 @@
 
 #include "ITKToolsBase.h"
 #include "itkImage.h"
+#include "itkConstantImageSource.h"
 #include "itkImageFileWriter.h"
 
 
@@ -45,6 +46,10 @@ public:
   std::vector<unsigned int> m_Size;
   std::vector<double> m_Spacing;
   std::vector<double> m_Origin;
+  std::vector<double> m_Direction;
+
+  /** The image is generated by the writer, stream by stream. */
+  virtual bool GetSupportsStreaming( void ) const { return true; }
 
 }; // end class ITKToolsCreateZeroImageBase
 
@@ -66,40 +71,60 @@ public:
   ITKToolsCreateZeroImage(){};
   ~ITKToolsCreateZeroImage(){};
 
+  /** The size of the slabs in MB, if no streaming is requested. */
+  itkStaticConstMacro( DefaultMemoryLimit, unsigned int, 256 );
+
   /** Run function. */
   void Run( void )
   {
     /** Typedefs. */
     typedef itk::Image< TComponentType, VDimension >  ImageType;
+    typedef itk::ConstantImageSource< ImageType >     SourceType;
     typedef itk::ImageFileWriter< ImageType >         WriterType;
     typedef typename ImageType::PixelType             PixelType;
     typedef typename ImageType::SizeType              SizeType;
     typedef typename ImageType::SpacingType           SpacingType;
     typedef typename ImageType::PointType             OriginType;
+    typedef typename ImageType::DirectionType         DirectionType;
 
     /** Prepare stuff. */
     SizeType    imSize;
     SpacingType imSpacing;
     OriginType  imOrigin;
+    DirectionType imDirection;
     for( unsigned int i = 0; i < VDimension; i++ )
     {
       imSize[ i ] = this->m_Size[ i ];
       imSpacing[ i ] = this->m_Spacing[ i ];
       imOrigin[ i ] = this->m_Origin[ i ];
+      for( unsigned int j = 0; j < VDimension; j++ )
+      {
+        imDirection[ i ][ j ] = this->m_Direction[ i * VDimension + j ];
+      }
     }
 
-    /** Create image. */
-    typename ImageType::Pointer image = ImageType::New();
-    image->SetRegions( imSize );
-    image->SetOrigin( imOrigin );
-    image->SetSpacing( imSpacing );
-    image->Allocate();
-    image->FillBuffer( itk::NumericTraits<PixelType>::Zero );
-
-    /** Write the image. */
+    /** The image is not allocated as a whole, but generated per stream. */
+    typename SourceType::Pointer source = SourceType::New();
+    source->SetSize( imSize );
+    source->SetSpacing( imSpacing );
+    source->SetOrigin( imOrigin );
+    source->SetDirection( imDirection );
+    source->SetValue( itk::NumericTraits<PixelType>::Zero );
+
+    /** Write the image. Without -streams or -memoryLimit, stream slabs
+     * of at most DefaultMemoryLimit MB, so that the size of the output is
+     * not bounded by the memory.
+     */
     typename WriterType::Pointer writer = WriterType::New();
     writer->SetFileName( this->m_OutputFileName.c_str() );
-    writer->SetInput( image );
+    writer->SetInput( source->GetOutput() );
+    if( this->m_NumberOfStreams == 0 && this->m_MemoryLimit == 0 )
+    {
+      this->m_MemoryLimit = DefaultMemoryLimit;
+    }
+    this->SetStreamingOnWriter( writer.GetPointer() );
+
+    this->ObserveProcess( writer.GetPointer(), "write" );
     writer->Update();
 
   } // end Run()
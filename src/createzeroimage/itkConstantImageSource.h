@@ -0,0 +1,104 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkConstantImageSource_h_
+#define __itkConstantImageSource_h_
+
+#include "itkImageSource.h"
+
+namespace itk
+{
+
+/** \class ConstantImageSource
+ * \brief Generate an image with a constant value.
+ *
+ * Only the requested region is allocated and filled, so that a writer
+ * that streams can write an image of any size with the memory of a
+ * single stream.
+ *
+ * \ingroup DataSources
+ */
+
+template< class TOutputImage >
+class ITK_EXPORT ConstantImageSource :
+  public ImageSource< TOutputImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef ConstantImageSource             Self;
+  typedef ImageSource< TOutputImage >     Superclass;
+  typedef SmartPointer<Self>              Pointer;
+  typedef SmartPointer<const Self>        ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( ConstantImageSource, ImageSource );
+
+  /** Typedefs. */
+  typedef TOutputImage                                OutputImageType;
+  typedef typename OutputImageType::PixelType         OutputPixelType;
+  typedef typename OutputImageType::SizeType          SizeType;
+  typedef typename OutputImageType::PointType         PointType;
+  typedef typename OutputImageType::SpacingType       SpacingType;
+  typedef typename OutputImageType::DirectionType     DirectionType;
+
+  /** Set/Get the geometry of the output. */
+  itkSetMacro( Size, SizeType );
+  itkGetConstReferenceMacro( Size, SizeType );
+  itkSetMacro( Spacing, SpacingType );
+  itkGetConstReferenceMacro( Spacing, SpacingType );
+  itkSetMacro( Origin, PointType );
+  itkGetConstReferenceMacro( Origin, PointType );
+  itkSetMacro( Direction, DirectionType );
+  itkGetConstReferenceMacro( Direction, DirectionType );
+
+  /** Set/Get the value of all pixels. Default zero. */
+  itkSetMacro( Value, OutputPixelType );
+  itkGetConstMacro( Value, OutputPixelType );
+
+protected:
+  ConstantImageSource();
+  virtual ~ConstantImageSource() {};
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** Set the geometry of the output. */
+  virtual void GenerateOutputInformation( void );
+
+  /** Allocate and fill the requested region. */
+  virtual void GenerateData( void );
+
+private:
+  ConstantImageSource( const Self & ); // purposely not implemented
+  void operator=( const Self & );      // purposely not implemented
+
+  SizeType              m_Size;
+  SpacingType           m_Spacing;
+  PointType             m_Origin;
+  DirectionType         m_Direction;
+  OutputPixelType       m_Value;
+
+}; // end class ConstantImageSource
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkConstantImageSource.txx"
+#endif
+
+#endif // end #ifndef __itkConstantImageSource_h_
@@ -0,0 +1,105 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkConstantImageSource_txx_
+#define __itkConstantImageSource_txx_
+
+#include "itkConstantImageSource.h"
+#include "itkNumericTraits.h"
+
+namespace itk
+{
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template< class TOutputImage >
+ConstantImageSource< TOutputImage >
+::ConstantImageSource()
+{
+  this->m_Size.Fill( 0 );
+  this->m_Spacing.Fill( 1.0 );
+  this->m_Origin.Fill( 0.0 );
+  this->m_Direction.SetIdentity();
+  this->m_Value = NumericTraits<OutputPixelType>::Zero;
+
+} // end Constructor
+
+
+/**
+ * ******************* GenerateOutputInformation *******************
+ */
+
+template< class TOutputImage >
+void
+ConstantImageSource< TOutputImage >
+::GenerateOutputInformation( void )
+{
+  OutputImageType * output = this->GetOutput( 0 );
+
+  typename OutputImageType::RegionType region;
+  region.SetSize( this->m_Size );
+  output->SetLargestPossibleRegion( region );
+  output->SetSpacing( this->m_Spacing );
+  output->SetOrigin( this->m_Origin );
+  output->SetDirection( this->m_Direction );
+
+} // end GenerateOutputInformation()
+
+
+/**
+ * ******************* GenerateData *******************
+ */
+
+template< class TOutputImage >
+void
+ConstantImageSource< TOutputImage >
+::GenerateData( void )
+{
+  OutputImageType * output = this->GetOutput( 0 );
+  output->SetBufferedRegion( output->GetRequestedRegion() );
+  output->Allocate();
+  output->FillBuffer( this->m_Value );
+
+} // end GenerateData()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template< class TOutputImage >
+void
+ConstantImageSource< TOutputImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "Size: " << this->m_Size << std::endl;
+  os << indent << "Spacing: " << this->m_Spacing << std::endl;
+  os << indent << "Origin: " << this->m_Origin << std::endl;
+  os << indent << "Direction: " << this->m_Direction << std::endl;
+  os << indent << "Value: "
+    << static_cast<typename NumericTraits<OutputPixelType>::PrintType>( this->m_Value )
+    << std::endl;
+
+} // end PrintSelf()
+
+} // end namespace itk
+
+#endif // end #ifndef __itkConstantImageSource_txx_
@@ -40,20 +40,27 @@ std::string GetHelpString( void )
   ss << "ITKTools v" << itktools::GetITKToolsVersion() << "\n"
     << "Usage:" << std::endl
     << "pxcropimage\n"
-    << "  -in      inputFilename\n"
-    << "  [-out]   outputFilename, default in + CROPPED.mhd\n"
+    << "  -in      inputFilenames\n"
+    << "  [-out]   outputFilenames, default in + CROPPED.mhd\n"
     << "  [-pA]    a point A\n"
     << "  [-pB]    a point B\n"
     << "  [-sz]    size\n"
     << "  [-lb]    lower bound\n"
     << "  [-ub]    upper bound\n"
+    << "  [-mask]  a mask; crop to the bounding box of its pixels > 0\n"
+    << "  [-b]     the margin around the bounding box of the mask, default 0\n"
     << "  [-force] force to extract a region of size sz, pad if necessary\n"
     << "  [-z]     compression flag; if provided, the output image is compressed\n"
     << "pxcropimage can be called in different ways:\n"
     << "1: supply two points with \"-pA\" and \"-pB\".\n"
     << "2: supply a points and a size with \"-pA\" and \"-sz\".\n"
     << "3: supply a lower and an upper bound with \"-lb\" and \"-ub\".\n"
+    << "4: supply a mask of the same size as the inputs with \"-mask\",\n"
+    << "   and possibly a margin with \"-b\". The bounding box is computed once,\n"
+    << "   and the region is cropped from all inputs.\n"
     << "The points are supplied in index coordinates.\n"
+    << "Only the region that is cropped is read from disk, for file formats\n"
+    << "that support streamed reading, such as mhd, nrrd and nii.\n"
     << "Supported: 2D, 3D, (unsigned) char, (unsigned) short, (unsigned) int, (unsigned) long, float, double.";
 
   return ss.str();
@@ -86,12 +93,21 @@ int main( int argc, char **argv )
   }
 
   /** Get arguments. */
-  std::string inputFileName = "";
-  parser->GetCommandLineArgument( "-in", inputFileName );
+  std::vector<std::string> inputFileNames;
+  parser->GetCommandLineArgument( "-in", inputFileNames );
 
-  std::string outputFileName = inputFileName.substr( 0, inputFileName.rfind( "." ) );
-  outputFileName += "CROPPED.mhd";
-  parser->GetCommandLineArgument( "-out", outputFileName );
+  std::vector<std::string> outputFileNames( inputFileNames.size() );
+  for( std::size_t i = 0; i < inputFileNames.size(); ++i )
+  {
+    outputFileNames[ i ] = inputFileNames[ i ].substr( 0, inputFileNames[ i ].rfind( "." ) );
+    outputFileNames[ i ] += "CROPPED.mhd";
+  }
+  bool retout = parser->GetCommandLineArgument( "-out", outputFileNames );
+  if( retout && outputFileNames.size() != inputFileNames.size() )
+  {
+    std::cerr << "ERROR: Supply as many output as input filenames." << std::endl;
+    return EXIT_FAILURE;
+  }
 
   std::vector<int> pA;
   bool retpA = parser->GetCommandLineArgument( "-pA", pA );
@@ -108,35 +124,68 @@ int main( int argc, char **argv )
   std::vector<int> upBound;
   bool retub = parser->GetCommandLineArgument( "-ub", upBound );
 
+  std::string maskFileName = "";
+  bool retmask = parser->GetCommandLineArgument( "-mask", maskFileName );
+
+  std::vector<int> margin( 1, 0 );
+  bool retb = parser->GetCommandLineArgument( "-b", margin );
+
   bool force = parser->ArgumentExists( "-force" );
 
   bool useCompression = parser->ArgumentExists( "-z" );
 
-  /** Determine image properties. */
-  itk::ImageIOBase::IOPixelType pixelType = itk::ImageIOBase::UNKNOWNPIXELTYPE;
-  itk::ImageIOBase::IOComponentType componentType = itk::ImageIOBase::UNKNOWNCOMPONENTTYPE;
+  /** Determine image properties. All inputs should have the same dimension. */
+  std::vector<itk::ImageIOBase::IOComponentType> componentTypes( inputFileNames.size() );
   unsigned int dim = 0;
-  unsigned int numberOfComponents = 0;
-  bool retgip = itktools::GetImageProperties(
-    inputFileName, pixelType, componentType, dim, numberOfComponents );
-  if( !retgip ) return EXIT_FAILURE;
-
-  /** Check for vector images. */
-  bool retNOCCheck = itktools::NumberOfComponentsCheck( numberOfComponents );
-  if( !retNOCCheck ) return EXIT_FAILURE;
+  for( std::size_t i = 0; i < inputFileNames.size(); ++i )
+  {
+    itk::ImageIOBase::IOPixelType pixelType = itk::ImageIOBase::UNKNOWNPIXELTYPE;
+    unsigned int imageDim = 0;
+    unsigned int numberOfComponents = 0;
+    bool retgip = itktools::GetImageProperties(
+      inputFileNames[ i ], pixelType, componentTypes[ i ], imageDim, numberOfComponents );
+    if( !retgip ) return EXIT_FAILURE;
+
+    /** Check for vector images. */
+    bool retNOCCheck = itktools::NumberOfComponentsCheck( numberOfComponents );
+    if( !retNOCCheck ) return EXIT_FAILURE;
+
+    if( i == 0 ) dim = imageDim;
+    if( imageDim != dim )
+    {
+      std::cerr << "ERROR: The input images should have the same dimension." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
 
   /** Check which input option is used:
    * 1: supply two points with -pA and -pB
    * 2: supply a points and a size with -pA and -sz
    * 3: supply a lower and an upper bound with -lb and -ub
+   * 4: supply a mask with -mask
    */
   unsigned int option = 0;
-  if( !CheckWhichInputOption( retpA, retpB, retsz, retlb, retub, option ) )
+  if( !CheckWhichInputOption( retpA, retpB, retsz, retlb, retub, retmask, option ) )
   {
     std::cerr << "ERROR: Check your commandline arguments." << std::endl;
     return EXIT_FAILURE;
   }
 
+  /** Check argument b, the margin around the mask. Values beyond the
+   * dimension are ignored, so that scripts can pass three for any image.
+   */
+  if( retb )
+  {
+    if( margin.size() > dim ) margin.resize( dim );
+    if( !retmask || !ProcessArgument( margin, dim, false ) )
+    {
+      std::cout << "ERROR: The margin b should consist of 1 or Dimension positive values,"
+        << " and is only used with -mask." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  margin.resize( dim, margin[ 0 ] );
+
   /** Check argument pA. Point A should only be positive if not force. */
   if( retpA )
   {
@@ -206,58 +255,79 @@ int main( int argc, char **argv )
     input2 = upBound;
   }
 
-  /** Class that does the work. */
-  ITKToolsCropImageBase * filter = 0;
-
-  try
+  /** Crop all images. With a mask, its bounding box is computed with the
+   * first image only, and reused as two points for the others.
+   */
+  std::vector<int> maskSize;
+  for( std::size_t f = 0; f < inputFileNames.size(); ++f )
   {
-    // now call all possible template combinations.
-    if( !filter ) filter = ITKToolsCropImage< 2, unsigned char >::New( dim, componentType );
-    if( !filter ) filter = ITKToolsCropImage< 2, char >::New( dim, componentType );
-    if( !filter ) filter = ITKToolsCropImage< 2, unsigned short >::New( dim, componentType );
-    if( !filter ) filter = ITKToolsCropImage< 2, short >::New( dim, componentType );
-    if( !filter ) filter = ITKToolsCropImage< 2, unsigned int >::New( dim, componentType );
-    if( !filter ) filter = ITKToolsCropImage< 2, int >::New( dim, componentType );
-    if( !filter ) filter = ITKToolsCropImage< 2, unsigned long >::New( dim, componentType );
-    if( !filter ) filter = ITKToolsCropImage< 2, long >::New( dim, componentType );
-    if( !filter ) filter = ITKToolsCropImage< 2, float >::New( dim, componentType );
-    if( !filter ) filter = ITKToolsCropImage< 2, double >::New( dim, componentType );
+    /** Class that does the work. */
+    ITKToolsCropImageBase * filter = 0;
+    const itk::ImageIOBase::IOComponentType componentType = componentTypes[ f ];
+
+    try
+    {
+      // now call all possible template combinations.
+      if( !filter ) filter = ITKToolsCropImage< 2, unsigned char >::New( dim, componentType );
+      if( !filter ) filter = ITKToolsCropImage< 2, char >::New( dim, componentType );
+      if( !filter ) filter = ITKToolsCropImage< 2, unsigned short >::New( dim, componentType );
+      if( !filter ) filter = ITKToolsCropImage< 2, short >::New( dim, componentType );
+      if( !filter ) filter = ITKToolsCropImage< 2, unsigned int >::New( dim, componentType );
+      if( !filter ) filter = ITKToolsCropImage< 2, int >::New( dim, componentType );
+      if( !filter ) filter = ITKToolsCropImage< 2, unsigned long >::New( dim, componentType );
+      if( !filter ) filter = ITKToolsCropImage< 2, long >::New( dim, componentType );
+      if( !filter ) filter = ITKToolsCropImage< 2, float >::New( dim, componentType );
+      if( !filter ) filter = ITKToolsCropImage< 2, double >::New( dim, componentType );
 
 #ifdef ITKTOOLS_3D_SUPPORT
-    if( !filter ) filter = ITKToolsCropImage< 3, unsigned char >::New( dim, componentType );
-    if( !filter ) filter = ITKToolsCropImage< 3, char >::New( dim, componentType );
-    if( !filter ) filter = ITKToolsCropImage< 3, unsigned short >::New( dim, componentType );
-    if( !filter ) filter = ITKToolsCropImage< 3, short >::New( dim, componentType );
-    if( !filter ) filter = ITKToolsCropImage< 3, unsigned int >::New( dim, componentType );
-    if( !filter ) filter = ITKToolsCropImage< 3, int >::New( dim, componentType );
-    if( !filter ) filter = ITKToolsCropImage< 3, unsigned long >::New( dim, componentType );
-    if( !filter ) filter = ITKToolsCropImage< 3, long >::New( dim, componentType );
-    if( !filter ) filter = ITKToolsCropImage< 3, float >::New( dim, componentType );
-    if( !filter ) filter = ITKToolsCropImage< 3, double >::New( dim, componentType );
+      if( !filter ) filter = ITKToolsCropImage< 3, unsigned char >::New( dim, componentType );
+      if( !filter ) filter = ITKToolsCropImage< 3, char >::New( dim, componentType );
+      if( !filter ) filter = ITKToolsCropImage< 3, unsigned short >::New( dim, componentType );
+      if( !filter ) filter = ITKToolsCropImage< 3, short >::New( dim, componentType );
+      if( !filter ) filter = ITKToolsCropImage< 3, unsigned int >::New( dim, componentType );
+      if( !filter ) filter = ITKToolsCropImage< 3, int >::New( dim, componentType );
+      if( !filter ) filter = ITKToolsCropImage< 3, unsigned long >::New( dim, componentType );
+      if( !filter ) filter = ITKToolsCropImage< 3, long >::New( dim, componentType );
+      if( !filter ) filter = ITKToolsCropImage< 3, float >::New( dim, componentType );
+      if( !filter ) filter = ITKToolsCropImage< 3, double >::New( dim, componentType );
 #endif
-    /** Check if filter was instantiated. */
-    bool supported = itktools::IsFilterSupportedCheck( filter, dim, componentType );
-    if( !supported ) return EXIT_FAILURE;
-
-    /** Set the filter arguments. */
-    filter->m_InputFileName = inputFileName;
-    filter->m_OutputFileName = outputFileName;
-    filter->m_Input1 = input1;
-    filter->m_Input2 = input2;
-    filter->m_Option = option;
-    filter->m_Force = force;
-    filter->m_UseCompression = useCompression;
-
-    filter->Run();
-
-    delete filter;
-  }
-  catch( itk::ExceptionObject & excp )
-  {
-    std::cerr << "ERROR: Caught ITK exception: " << excp << std::endl;
-    delete filter;
-    return EXIT_FAILURE;
-  }
+      /** Check if filter was instantiated. */
+      bool supported = itktools::IsFilterSupportedCheck( filter, dim, componentType );
+      if( !supported ) return EXIT_FAILURE;
+
+      /** Set the filter arguments. */
+      filter->m_InputFileName = inputFileNames[ f ];
+      filter->m_OutputFileName = outputFileNames[ f ];
+      filter->m_MaskFileName = maskFileName;
+      filter->m_MaskSize = maskSize;
+      filter->m_Margin = margin;
+      filter->m_Input1 = input1;
+      filter->m_Input2 = input2;
+      filter->m_Option = option;
+      filter->m_Force = force;
+      filter->m_UseCompression = useCompression;
+
+      filter->ReadCommonArguments( parser );
+      filter->Run();
+
+      /** Reuse the bounding box of the mask. */
+      if( option == 4 )
+      {
+        input1 = filter->m_Input1;
+        input2 = filter->m_Input2;
+        maskSize = filter->m_MaskSize;
+        option = 1;
+      }
+
+      delete filter;
+    }
+    catch( itk::ExceptionObject & excp )
+    {
+      std::cerr << "ERROR: Caught ITK exception: " << excp << std::endl;
+      delete filter;
+      return EXIT_FAILURE;
+    }
+  } // end for all images
 
   /** End program. */
   return EXIT_SUCCESS;
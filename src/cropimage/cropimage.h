@@ -23,6 +23,9 @@
 #include "itkImage.h"
 #include "itkCropImageFilter.h"
 #include "itkConstantPadImageFilter.h"
+#include "itkBoundingBoxImageCalculator.h"
+#include "ITKToolsMemoryMapping.h"
+#include <algorithm>
 
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
@@ -42,6 +45,8 @@ public:
   {
     this->m_InputFileName = "";
     this->m_OutputFileName = "";
+    this->m_MaskFileName = "";
+    this->m_Option = 0;
     this->m_Force = false;
     this->m_UseCompression = false;
   };
@@ -51,12 +56,18 @@ public:
   /** Input member parameters. */
   std::string       m_InputFileName;
   std::string       m_OutputFileName;
+  std::string       m_MaskFileName;
+  std::vector<int>  m_MaskSize;
+  std::vector<int>  m_Margin;
   std::vector<int>  m_Input1;
   std::vector<int>  m_Input2;
   unsigned int      m_Option;
   bool              m_Force;
   bool              m_UseCompression;
 
+  /** The reader, crop and pad filters only process the requested region. */
+  virtual bool GetSupportsStreaming( void ) const { return true; }
+
 }; // end class ITKToolsCropImageBase
 
 
@@ -97,17 +108,13 @@ public:
     typename ReaderType::Pointer reader = ReaderType::New();
     typename WriterType::Pointer writer = WriterType::New();
 
-    /** Prepare stuff. */
-    SizeType input1Size, input2Size;
-    for( unsigned int i = 0; i < Dimension; i++ )
-    {
-      input1Size[ i ] = this->m_Input1[ i ];
-      input2Size[ i ] = this->m_Input2[ i ];
-    }
-
-    /** Read the image. */
+    /** Read only the information of the image. The pixels are read by the
+     * writer's update, and only those of the region that is cropped, for
+     * file formats that support streamed reading.
+     */
     reader->SetFileName( this->m_InputFileName.c_str() );
-    reader->Update();
+    reader->SetUseStreaming( true );
+    reader->UpdateOutputInformation();
 
     /** Get the size of input image. */
     SizeType imageSize = reader->GetOutput()->GetLargestPossibleRegion().GetSize();
@@ -117,6 +124,19 @@ public:
       imSize[ i ] = static_cast<int>( imageSize[ i ] );
     }
 
+    /** With a mask, crop to its bounding box, given as two points. A box
+     * computed before, for another image, is only valid for the same size.
+     */
+    if( this->m_Option == 4 )
+    {
+      this->ComputeMaskBox( imageSize );
+    }
+    else if( !this->m_MaskSize.empty() && this->m_MaskSize != imSize )
+    {
+      itkGenericExceptionMacro( << "ERROR: the mask " << this->m_MaskFileName
+        << " does not have the same size as " << this->m_InputFileName << "." );
+    }
+
     /** Get the lower and upper boundary. */
     std::vector<unsigned long> padLowerBound, padUpperBound;
     std::vector<int> down = GetLowerBoundary(
@@ -137,7 +157,8 @@ public:
     cropFilter->SetUpperBoundaryCropSize( upSize );
 
     /** In case the force option is set to true, we force the
-     * output image to be of the desired size.
+     * output image to be of the desired size. The padding is generated
+     * per requested region, without a padded copy of the input.
      */
     if( this->m_Force )
     {
@@ -161,10 +182,62 @@ public:
     /** Setup and process the pipeline. */
     writer->SetFileName( this->m_OutputFileName.c_str() );
     writer->SetUseCompression( this->m_UseCompression );
+    this->SetStreamingOnWriter( writer.GetPointer() );
+
+    this->ObserveProcess( reader.GetPointer(), "read" );
+    this->ObserveProcess( cropFilter.GetPointer(), "crop" );
+    if( this->m_Force ) this->ObserveProcess( padFilter.GetPointer(), "pad" );
+    this->ObserveProcess( writer.GetPointer(), "write" );
     writer->Update();
 
   } // end Run()
 
+  /** Set the points of option 1 to the bounding box of the pixels > 0 of
+   * the mask, found by scanning inward from the faces, plus the margin,
+   * clamped to the image.
+   */
+  template< class TSize >
+  void ComputeMaskBox( const TSize & imageSize )
+  {
+    typedef itk::Image<float, VDimension>                 MaskImageType;
+    typedef itk::BoundingBoxImageCalculator<MaskImageType> CalculatorType;
+
+    typename MaskImageType::Pointer mask
+      = itktools::ReadImage<MaskImageType>( this->m_MaskFileName );
+    if( mask->GetLargestPossibleRegion().GetSize() != imageSize )
+    {
+      itkGenericExceptionMacro( << "ERROR: the mask " << this->m_MaskFileName
+        << " does not have the same size as " << this->m_InputFileName << "." );
+    }
+
+    typename CalculatorType::Pointer calculator = CalculatorType::New();
+    calculator->SetImage( mask );
+    calculator->Compute();
+    if( calculator->GetIsEmpty() )
+    {
+      itkGenericExceptionMacro( << "ERROR: the mask " << this->m_MaskFileName
+        << " has no pixels > 0." );
+    }
+
+    const typename MaskImageType::IndexType start
+      = mask->GetLargestPossibleRegion().GetIndex();
+    this->m_Margin.resize( VDimension, 0 );
+    this->m_Input1.resize( VDimension );
+    this->m_Input2.resize( VDimension );
+    this->m_MaskSize.resize( VDimension );
+    for( unsigned int i = 0; i < VDimension; i++ )
+    {
+      const int size = static_cast<int>( imageSize[ i ] );
+      const int minimum = static_cast<int>( calculator->GetMinimumIndex()[ i ] - start[ i ] );
+      const int maximum = static_cast<int>( calculator->GetMaximumIndex()[ i ] - start[ i ] );
+      this->m_Input1[ i ] = std::max( minimum - this->m_Margin[ i ], 0 );
+      this->m_Input2[ i ] = std::min( maximum + 1 + this->m_Margin[ i ], size );
+      this->m_MaskSize[ i ] = size;
+    }
+    this->m_Option = 1;
+
+  } // end ComputeMaskBox()
+
 }; // end class ITKToolsCropImage
 
 
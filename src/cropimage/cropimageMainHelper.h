@@ -27,13 +27,20 @@
  * 1: supply two points with -pA and -pB
  * 2: supply a points and a size with -pA and -sz
  * 3: supply a lower and an upper bound with -lb and -ub
+ * 4: supply a mask with -mask
  */
 
 bool CheckWhichInputOption(
   const bool pAGiven, const bool pBGiven, const bool szGiven,
-  const bool lbGiven, const bool ubGiven, unsigned int & arg )
+  const bool lbGiven, const bool ubGiven, const bool maskGiven, unsigned int & arg )
 {
-  if( pAGiven && pBGiven && !szGiven && !lbGiven && !ubGiven )
+  if( maskGiven )
+  {
+    /** A mask given, and nothing else. */
+    arg = 4;
+    return !pAGiven && !pBGiven && !szGiven && !lbGiven && !ubGiven;
+  }
+  else if( pAGiven && pBGiven && !szGiven && !lbGiven && !ubGiven )
   {
     /** Two points given. */
     arg = 1;
@@ -50,7 +50,9 @@ std::string GetHelpString( void )
     << "           with points in the fixed image.\n"
     << "  -ipp2    inputPointFile2: a transformix style input point file\n"
     << "           with the corresponding points in the moving image.\n"
-    << "  [-s]     stiffness: a number that allows to vary between\n"
+    << "           Large point sets can be given in binary: a header line\n"
+    << "           \"binary point <n>\" or \"binary index <n>\", followed by\n"
+    << "           the n*dim coordinates as doubles in native byte order.\n"    << "  [-s]     stiffness: a number that allows to vary between\n"
     << "           interpolating and approximating spline.\n"
     << "           0.0 = interpolating = default.\n"
     << "           Stiffness values are usually rather small,\n"
@@ -64,8 +66,17 @@ std::string GetHelpString( void )
     << "           EBSR: elastic body reciprocal spline\n"
     << "           See ITK documentation and the there cited paper\n"
     << "           for more information on these methods.\n"
-    << "  -out     outputFilename: the name of the resulting deformation field,\n"
+    << "  [-g]     grid spacing: evaluate the kernel transform exactly on a grid\n"
+    << "           with this spacing in voxels, and interpolate the field in between\n"
+    << "           with a cubic B-spline. Default 1, every voxel is evaluated exactly.\n"
+    << "           Every evaluation sums over all points, so for many points a\n"
+    << "           spacing of 2 to 4 is about 2^dim to 4^dim times faster.\n"
+    << "  [-out]   outputFilename: the name of the resulting deformation field,\n"
     << "           which is written as a vector<float/double,dim> image.\n"
+    << "  [-outbspline] the name of an ITK transform file (e.g. .tfm), to which the field\n"
+    << "           is written as a cubic BSplineTransform with a control point spacing\n"
+    << "           of -g voxels; it equals the dense field of the same -g on the image.\n"
+    << "           At least one of -out and -outbspline should be given.\n"
     << "  [-opct]  output pixel component type, choose one of {float, double}, default float.\n"
     << "Supported: 2D, 3D, any scalar input pixeltype.";
 
@@ -87,7 +98,6 @@ int main( int argc, char **argv )
   parser->MarkArgumentAsRequired( "-in1", "The inputImage1 filename." );
   parser->MarkArgumentAsRequired( "-ipp1", "The inputPoints1 filename." );
   parser->MarkArgumentAsRequired( "-ipp2", "The inputPoints2 filename." );
-  parser->MarkArgumentAsRequired( "-out", "The output filename." );
 
   itk::CommandLineArgumentParser::ReturnValue validateArguments = parser->CheckForRequiredArguments();
 
@@ -116,12 +126,24 @@ int main( int argc, char **argv )
   std::string outputImageFileName = "";
   parser->GetCommandLineArgument( "-out", outputImageFileName );
 
+  std::string outputBSplineFileName = "";
+  parser->GetCommandLineArgument( "-outbspline", outputBSplineFileName );
+
+  if( outputImageFileName == "" && outputBSplineFileName == "" )
+  {
+    std::cerr << "ERROR: You should specify \"-out\" and/or \"-outbspline\"." << std::endl;
+    return EXIT_FAILURE;
+  }
+
   std::string kernelName = "TPS";
   parser->GetCommandLineArgument( "-k", kernelName );
 
   double stiffness = 0.0;
   parser->GetCommandLineArgument( "-s", stiffness );
 
+  unsigned int gridSpacing = 1;
+  parser->GetCommandLineArgument( "-g", gridSpacing );
+
   /** Determine image properties. */
   itk::ImageIOBase::IOPixelType pixelType = itk::ImageIOBase::UNKNOWNPIXELTYPE;
   itk::ImageIOBase::IOComponentType componentType = itk::ImageIOBase::UNKNOWNCOMPONENTTYPE;
@@ -163,9 +185,12 @@ int main( int argc, char **argv )
     filter->m_InputPoints1FileName = inputPoints1FileName;
     filter->m_InputPoints2FileName = inputPoints2FileName;
     filter->m_OutputImageFileName = outputImageFileName;
+    filter->m_OutputBSplineFileName = outputBSplineFileName;
     filter->m_KernelName = kernelName;
     filter->m_Stiffness = stiffness;
+    filter->m_GridSpacing = gridSpacing;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
@@ -31,6 +31,9 @@
 #include "itkVolumeSplineKernelTransform.h"
 #include "itkElasticBodySplineKernelTransform.h"
 #include "itkElasticBodyReciprocalSplineKernelTransform.h"
+#include "itkKernelTransformDisplacementFieldSource.h"
+#include "itkBSplineTransform.h"
+#include "itkTransformFileWriter.h"
 #include "vnl/vnl_math.h"
 
 
@@ -51,8 +54,10 @@ public:
     this->m_InputPoints1FileName = "";
     this->m_InputPoints2FileName = "";
     this->m_OutputImageFileName = "";
+    this->m_OutputBSplineFileName = "";
     this->m_KernelName = "";
     this->m_Stiffness = 0.0f;
+    this->m_GridSpacing = 1;
   };
   /** Destructor. */
   ~ITKToolsDeformationFieldGeneratorBase(){};
@@ -63,8 +68,10 @@ public:
   std::string m_InputPoints1FileName;
   std::string m_InputPoints2FileName;
   std::string m_OutputImageFileName;
+  std::string m_OutputBSplineFileName;
   std::string m_KernelName;
   double m_Stiffness;
+  unsigned int m_GridSpacing;
 
 }; // end class ITKToolsDeformationFieldGeneratorBase
 
@@ -99,9 +106,10 @@ public:
     typedef itk::Vector<
       DeformationVectorValueType, VDimension >              DeformationVectorType;
     typedef itk::Image< DeformationVectorType, VDimension > DeformationFieldType;
-    typedef itk::ImageRegionIteratorWithIndex<
-      DeformationFieldType >                                DeformationFieldIteratorType;
+    typedef itk::KernelTransformDisplacementFieldSource<
+      DeformationFieldType, CoordRepType >                  DeformationFieldSourceType;
     typedef itk::ImageFileWriter< DeformationFieldType >    DeformationFieldWriterType;
+    typedef itk::BSplineTransform< CoordRepType, VDimension, 3 > BSplineTransformType;
     typedef typename DeformationFieldType::IndexType        IndexType;
     typedef typename DeformationFieldType::PointType        PointType;
 
@@ -136,7 +144,8 @@ public:
     typename PointSetType::Pointer inputPointSet1 = 0;
     typename PointSetType::Pointer inputPointSet2 = 0;
     typename KernelTransformType::Pointer kernelTransform = 0;
-    typename DeformationFieldType::Pointer deformationField = DeformationFieldType::New();
+    typename DeformationFieldSourceType::Pointer deformationFieldSource
+      = DeformationFieldSourceType::New();
     typename DeformationFieldWriterType::Pointer writer = DeformationFieldWriterType::New();
 
     ipp1Reader->SetFileName( this->m_InputPoints1FileName.c_str() );
@@ -277,31 +286,48 @@ public:
     kernelTransform->SetTargetLandmarks( inputPointSet2 );
     kernelTransform->ComputeWMatrix();
 
-    /** Define the deformation field and an iterator on it */
-    deformationField->SetSpacing( reader1->GetOutput()->GetSpacing() );
-    deformationField->SetOrigin( reader1->GetOutput()->GetOrigin() );
-    deformationField->SetRegions( reader1->GetOutput()->GetLargestPossibleRegion() );
-    deformationField->Allocate();
-    DeformationFieldIteratorType iterator(
-      deformationField, deformationField->GetLargestPossibleRegion() );
-    iterator.GoToBegin();
+    /** Generate the deformation field on the geometry of the first image. */
+    deformationFieldSource->SetRegion( reader1->GetOutput()->GetLargestPossibleRegion() );
+    deformationFieldSource->SetSpacing( reader1->GetOutput()->GetSpacing() );
+    deformationFieldSource->SetOrigin( reader1->GetOutput()->GetOrigin() );
+    deformationFieldSource->SetKernelTransform( kernelTransform );
+    deformationFieldSource->SetGridSpacing( this->m_GridSpacing );
 
-    std::cout << "Generating deformation field. " << std::endl;
-
-    while ( !iterator.IsAtEnd() )
+    /** Write the B-spline of the field, with the grid spacing as the control
+     * point spacing, as an ITK transform that is evaluated where needed. */
+    if( this->m_OutputBSplineFileName != "" )
     {
-      PointType pointin;
-      const IndexType & index = iterator.GetIndex();
-      deformationField->TransformIndexToPhysicalPoint( index, pointin);
-      PointType pointout = kernelTransform->TransformPoint( pointin );
-      DeformationVectorType vec = pointout - pointin;
-      iterator.Set( vec );
-      ++iterator;
+      typedef typename DeformationFieldSourceType::CoefficientImageContainerType
+        CoefficientImageContainerType;
+      std::cout << "Computing the B-spline coefficients, with a control point spacing of "
+        << this->m_GridSpacing << " voxels." << std::endl;
+      CoefficientImageContainerType coefficients;
+      deformationFieldSource->ComputeBSplineCoefficients( coefficients );
+
+      typename BSplineTransformType::CoefficientImageArray coefficientImages;
+      for( unsigned int d = 0; d < VDimension; ++d )
+      {
+        coefficientImages[ d ] = coefficients[ d ];
+      }
+      typename BSplineTransformType::Pointer bsplineTransform = BSplineTransformType::New();
+      bsplineTransform->SetCoefficientImages( coefficientImages );
+
+      std::cout << "Saving the B-spline transform to disk as "
+        << this->m_OutputBSplineFileName << std::endl;
+      itk::TransformFileWriter::Pointer transformWriter = itk::TransformFileWriter::New();
+      transformWriter->SetFileName( this->m_OutputBSplineFileName.c_str() );
+      transformWriter->SetInput( bsplineTransform );
+      transformWriter->Update();
     }
 
+    if( this->m_OutputImageFileName == "" ) return;
+
+    std::cout << "Generating deformation field. " << std::endl;
+    deformationFieldSource->Update();
+
     std::cout << "Saving deformation field to disk as " << this->m_OutputImageFileName << std::endl;
     writer->SetFileName( this->m_OutputImageFileName.c_str() );
-    writer->SetInput( deformationField );
+    writer->SetInput( deformationFieldSource->GetOutput() );
     writer->Update();
 
   } // end Run()
@@ -0,0 +1,161 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkKernelTransformDisplacementFieldSource_h_
+#define __itkKernelTransformDisplacementFieldSource_h_
+
+#include "itkImageSource.h"
+#include "itkKernelTransform.h"
+#include <vector>
+
+namespace itk
+{
+
+/** \class KernelTransformDisplacementFieldSource
+ * \brief Generate the displacement field T(x) - x of a kernel transform.
+ *
+ * The transform is evaluated in parallel over the regions of the threads.
+ * This relies on KernelTransform::TransformPoint() being const with only
+ * local state, which is the case for the ITK4 kernel transforms. The
+ * transform must be ready, i.e. ComputeWMatrix() must have been called.
+ *
+ * Every evaluation sums over all landmarks. With a GridSpacing g > 1 the
+ * transform is only evaluated on a grid with g times the spacing of the
+ * output, and the field in between is interpolated with a cubic B-spline
+ * that interpolates the grid values. This is about g^D times faster, and a
+ * good approximation for the smooth fields of these kernels.
+ *
+ * The B-spline can also be obtained without computing the dense field,
+ * with ComputeBSplineCoefficients(). The coefficient grids are padded by
+ * one point on every side with the mirrored coefficients, so that an
+ * itk::BSplineTransform with these coefficient images equals the
+ * approximated field on the output region, without boundary handling.
+ *
+ * \ingroup DataSources
+ */
+
+template< class TOutputImage, class TTransformPrecisionType = double >
+class ITK_EXPORT KernelTransformDisplacementFieldSource :
+  public ImageSource< TOutputImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef KernelTransformDisplacementFieldSource  Self;
+  typedef ImageSource< TOutputImage >             Superclass;
+  typedef SmartPointer<Self>                      Pointer;
+  typedef SmartPointer<const Self>                ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( KernelTransformDisplacementFieldSource, ImageSource );
+
+  itkStaticConstMacro( ImageDimension, unsigned int, TOutputImage::ImageDimension );
+
+  /** Typedefs. */
+  typedef TOutputImage                                OutputImageType;
+  typedef typename OutputImageType::PixelType         OutputPixelType;
+  typedef typename OutputPixelType::ValueType         OutputComponentType;
+  typedef typename OutputImageType::RegionType        OutputImageRegionType;
+  typedef typename OutputImageType::IndexType         IndexType;
+  typedef typename OutputImageType::PointType         PointType;
+  typedef typename OutputImageType::SpacingType       SpacingType;
+  typedef typename OutputImageType::DirectionType     DirectionType;
+  typedef KernelTransform< TTransformPrecisionType,
+    itkGetStaticConstMacro( ImageDimension ) >        KernelTransformType;
+  typedef Image< double,
+    itkGetStaticConstMacro( ImageDimension ) >        CoefficientImageType;
+
+  /** Set/Get the geometry of the output. */
+  itkSetMacro( Region, OutputImageRegionType );
+  itkGetConstReferenceMacro( Region, OutputImageRegionType );
+  itkSetMacro( Origin, PointType );
+  itkGetConstReferenceMacro( Origin, PointType );
+  itkSetMacro( Spacing, SpacingType );
+  itkGetConstReferenceMacro( Spacing, SpacingType );
+  itkSetMacro( Direction, DirectionType );
+  itkGetConstReferenceMacro( Direction, DirectionType );
+
+  /** Set/Get the kernel transform. */
+  itkSetConstObjectMacro( KernelTransform, KernelTransformType );
+  itkGetConstObjectMacro( KernelTransform, KernelTransformType );
+
+  /** Set/Get the grid spacing of the approximation, in voxels of the
+   * output. Default 1, every voxel is evaluated exactly. */
+  itkSetClampMacro( GridSpacing, unsigned int, 1, NumericTraits<unsigned int>::max() );
+  itkGetConstMacro( GridSpacing, unsigned int );
+
+  /** The coefficient images of the cubic B-spline of every component. */
+  typedef std::vector< typename CoefficientImageType::Pointer > CoefficientImageContainerType;
+
+  /** Compute the padded B-spline coefficients of the field on a grid of
+   * GridSpacing times the output spacing, see above. The transform must be
+   * set, but no update is needed. */
+  void ComputeBSplineCoefficients( CoefficientImageContainerType & coefficients ) const;
+
+protected:
+  KernelTransformDisplacementFieldSource();
+  virtual ~KernelTransformDisplacementFieldSource() {};
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** Set the geometry of the output. */
+  virtual void GenerateOutputInformation( void );
+
+  /** Evaluate the transform on the grid, and compute the B-spline
+   * coefficients, if the field is approximated. */
+  virtual void BeforeThreadedGenerateData( void );
+
+  /** Evaluate or interpolate the field in the region of a thread. */
+  void ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+    ThreadIdType threadId );
+
+  /** Release the coefficients. */
+  virtual void AfterThreadedGenerateData( void );
+
+  /** Evaluate the transform on the grid and compute the interpolating
+   * coefficients, without padding. */
+  void ComputeGridCoefficients( CoefficientImageContainerType & coefficients ) const;
+
+private:
+  KernelTransformDisplacementFieldSource( const Self & ); // purposely not implemented
+  void operator=( const Self & );                         // purposely not implemented
+
+  OutputImageRegionType m_Region;
+  PointType             m_Origin;
+  SpacingType           m_Spacing;
+  DirectionType         m_Direction;
+  unsigned int          m_GridSpacing;
+
+  typename KernelTransformType::ConstPointer  m_KernelTransform;
+
+  /** The B-spline coefficients per component, and per dimension and output
+   * index the offsets in the coefficient buffer and the weights of the
+   * four B-spline taps. */
+  CoefficientImageContainerType                         m_Coefficients;
+  std::vector< std::vector<OffsetValueType> >           m_TapOffsets;
+  std::vector< std::vector<double> >                    m_TapWeights;
+
+}; // end class KernelTransformDisplacementFieldSource
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkKernelTransformDisplacementFieldSource.txx"
+#endif
+
+#endif // end #ifndef __itkKernelTransformDisplacementFieldSource_h_
@@ -0,0 +1,374 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkKernelTransformDisplacementFieldSource_txx_
+#define __itkKernelTransformDisplacementFieldSource_txx_
+
+#include "itkKernelTransformDisplacementFieldSource.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkVectorIndexSelectionCastImageFilter.h"
+#include "itkBSplineDecompositionImageFilter.h"
+#include "itkProgressReporter.h"
+#include <cmath>
+
+namespace itk
+{
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template< class TOutputImage, class TTransformPrecisionType >
+KernelTransformDisplacementFieldSource< TOutputImage, TTransformPrecisionType >
+::KernelTransformDisplacementFieldSource()
+{
+  this->m_Origin.Fill( 0.0 );
+  this->m_Spacing.Fill( 1.0 );
+  this->m_Direction.SetIdentity();
+  this->m_GridSpacing = 1;
+  this->m_KernelTransform = 0;
+
+} // end Constructor
+
+
+/**
+ * ******************* GenerateOutputInformation *******************
+ */
+
+template< class TOutputImage, class TTransformPrecisionType >
+void
+KernelTransformDisplacementFieldSource< TOutputImage, TTransformPrecisionType >
+::GenerateOutputInformation( void )
+{
+  OutputImageType * output = this->GetOutput( 0 );
+  output->SetLargestPossibleRegion( this->m_Region );
+  output->SetOrigin( this->m_Origin );
+  output->SetSpacing( this->m_Spacing );
+  output->SetDirection( this->m_Direction );
+
+} // end GenerateOutputInformation()
+
+
+/**
+ * ******************* BeforeThreadedGenerateData *******************
+ */
+
+template< class TOutputImage, class TTransformPrecisionType >
+void
+KernelTransformDisplacementFieldSource< TOutputImage, TTransformPrecisionType >
+::BeforeThreadedGenerateData( void )
+{
+  if( this->m_KernelTransform.IsNull() )
+  {
+    itkExceptionMacro( << "ERROR: the kernel transform is not set." );
+  }
+
+  this->m_Coefficients.clear();
+  if( this->m_GridSpacing < 2 ) return;
+
+  const unsigned int g = this->m_GridSpacing;
+  this->ComputeGridCoefficients( this->m_Coefficients );
+  const typename CoefficientImageType::RegionType gridRegion
+    = this->m_Coefficients[ 0 ]->GetLargestPossibleRegion();
+
+  /** The four taps of every output index, with mirrored boundaries. */
+  this->m_TapOffsets.resize( ImageDimension );
+  this->m_TapWeights.resize( ImageDimension );
+  OffsetValueType stride = 1;
+  for( unsigned int d = 0; d < ImageDimension; ++d )
+  {
+    const SizeValueType n = this->m_Region.GetSize()[ d ];
+    const OffsetValueType m = static_cast<OffsetValueType>( gridRegion.GetSize()[ d ] );
+    this->m_TapOffsets[ d ].resize( 4 * n );
+    this->m_TapWeights[ d ].resize( 4 * n );
+    for( SizeValueType i = 0; i < n; ++i )
+    {
+      const double x = static_cast<double>( i ) / g;
+      const OffsetValueType base = static_cast<OffsetValueType>( std::floor( x ) );
+      const double t = x - base;
+      double * w = &this->m_TapWeights[ d ][ 4 * i ];
+      w[ 0 ] = ( 1.0 - t ) * ( 1.0 - t ) * ( 1.0 - t ) / 6.0;
+      w[ 1 ] = ( 3.0 * t * t * t - 6.0 * t * t + 4.0 ) / 6.0;
+      w[ 2 ] = ( -3.0 * t * t * t + 3.0 * t * t + 3.0 * t + 1.0 ) / 6.0;
+      w[ 3 ] = t * t * t / 6.0;
+      for( unsigned int k = 0; k < 4; ++k )
+      {
+        OffsetValueType j = 0;
+        if( m > 1 )
+        {
+          const OffsetValueType period = 2 * m - 2;
+          j = ( base - 1 + k ) % period;
+          if( j < 0 ) j += period;
+          if( j >= m ) j = period - j;
+        }
+        this->m_TapOffsets[ d ][ 4 * i + k ] = j * stride;
+      }
+    }
+    stride *= m;
+  }
+
+} // end BeforeThreadedGenerateData()
+
+
+/**
+ * ******************* ComputeGridCoefficients *******************
+ */
+
+template< class TOutputImage, class TTransformPrecisionType >
+void
+KernelTransformDisplacementFieldSource< TOutputImage, TTransformPrecisionType >
+::ComputeGridCoefficients( CoefficientImageContainerType & coefficients ) const
+{
+  typedef VectorIndexSelectionCastImageFilter<
+    OutputImageType, CoefficientImageType >           SelectorType;
+  typedef BSplineDecompositionImageFilter<
+    CoefficientImageType, CoefficientImageType >      DecompositionType;
+
+  if( this->m_KernelTransform.IsNull() )
+  {
+    itkExceptionMacro( << "ERROR: the kernel transform is not set." );
+  }
+
+  /** The grid covers the output, with g times its spacing, starting at
+   * the first voxel of the output region. */
+  const unsigned int g = this->m_GridSpacing;
+  OutputImageRegionType gridRegion;
+  SpacingType gridSpacing;
+  PointType gridOrigin = this->m_Origin;
+  for( unsigned int d = 0; d < ImageDimension; ++d )
+  {
+    const SizeValueType n = this->m_Region.GetSize()[ d ];
+    gridRegion.SetIndex( d, 0 );
+    gridRegion.SetSize( d, n > 1 ? ( n - 2 ) / g + 2 : 1 );
+    gridSpacing[ d ] = this->m_Spacing[ d ] * g;
+    for( unsigned int e = 0; e < ImageDimension; ++e )
+    {
+      gridOrigin[ d ] += this->m_Direction[ d ][ e ]
+        * this->m_Spacing[ e ] * this->m_Region.GetIndex()[ e ];
+    }
+  }
+
+  /** Evaluate the transform exactly on the grid, in parallel. */
+  typename Self::Pointer grid = Self::New();
+  grid->SetRegion( gridRegion );
+  grid->SetOrigin( gridOrigin );
+  grid->SetSpacing( gridSpacing );
+  grid->SetDirection( this->m_Direction );
+  grid->SetKernelTransform( this->m_KernelTransform );
+  grid->SetNumberOfThreads( this->GetNumberOfThreads() );
+  grid->Update();
+
+  /** The interpolating cubic B-spline coefficients of every component. */
+  coefficients.clear();
+  for( unsigned int c = 0; c < ImageDimension; ++c )
+  {
+    typename SelectorType::Pointer selector = SelectorType::New();
+    selector->SetInput( grid->GetOutput() );
+    selector->SetIndex( c );
+
+    typename DecompositionType::Pointer decomposition = DecompositionType::New();
+    decomposition->SetInput( selector->GetOutput() );
+    decomposition->SetSplineOrder( 3 );
+    decomposition->Update();
+    coefficients.push_back( decomposition->GetOutput() );
+  }
+
+} // end ComputeGridCoefficients()
+
+
+/**
+ * ******************* ComputeBSplineCoefficients *******************
+ */
+
+template< class TOutputImage, class TTransformPrecisionType >
+void
+KernelTransformDisplacementFieldSource< TOutputImage, TTransformPrecisionType >
+::ComputeBSplineCoefficients( CoefficientImageContainerType & coefficients ) const
+{
+  typedef ImageRegionIteratorWithIndex< CoefficientImageType > IteratorType;
+  typedef typename CoefficientImageType::IndexType             CoefficientIndexType;
+
+  CoefficientImageContainerType gridCoefficients;
+  this->ComputeGridCoefficients( gridCoefficients );
+  const CoefficientImageType * first = gridCoefficients[ 0 ];
+  const typename CoefficientImageType::SizeType gridSize
+    = first->GetLargestPossibleRegion().GetSize();
+
+  /** One more point on every side. */
+  typename CoefficientImageType::SizeType paddedSize;
+  CoefficientIndexType minusOne;
+  for( unsigned int d = 0; d < ImageDimension; ++d )
+  {
+    paddedSize[ d ] = gridSize[ d ] + 2;
+    minusOne[ d ] = -1;
+  }
+  typename CoefficientImageType::PointType paddedOrigin;
+  first->TransformIndexToPhysicalPoint( minusOne, paddedOrigin );
+
+  /** Copy with the mirrored boundaries of the interpolation. */
+  coefficients.clear();
+  for( unsigned int c = 0; c < ImageDimension; ++c )
+  {
+    typename CoefficientImageType::Pointer padded = CoefficientImageType::New();
+    padded->SetRegions( paddedSize );
+    padded->SetOrigin( paddedOrigin );
+    padded->SetSpacing( first->GetSpacing() );
+    padded->SetDirection( first->GetDirection() );
+    padded->Allocate();
+
+    IteratorType it( padded, padded->GetLargestPossibleRegion() );
+    for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+      CoefficientIndexType index;
+      for( unsigned int d = 0; d < ImageDimension; ++d )
+      {
+        const IndexValueType m = static_cast<IndexValueType>( gridSize[ d ] );
+        IndexValueType j = it.GetIndex()[ d ] - 1;
+        if( m == 1 ) j = 0;
+        else if( j < 0 ) j = -j;
+        else if( j >= m ) j = 2 * m - 2 - j;
+        index[ d ] = j;
+      }
+      it.Set( gridCoefficients[ c ]->GetPixel( index ) );
+    }
+    coefficients.push_back( padded );
+  }
+
+} // end ComputeBSplineCoefficients()
+
+
+/**
+ * ******************* ThreadedGenerateData *******************
+ */
+
+template< class TOutputImage, class TTransformPrecisionType >
+void
+KernelTransformDisplacementFieldSource< TOutputImage, TTransformPrecisionType >
+::ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+  ThreadIdType threadId )
+{
+  typedef ImageRegionIteratorWithIndex< OutputImageType > IteratorType;
+  typedef typename KernelTransformType::InputPointType    InputPointType;
+  typedef typename KernelTransformType::OutputPointType   OutputPointType;
+
+  OutputImageType * output = this->GetOutput();
+  IteratorType it( output, outputRegionForThread );
+  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels(), 100 );
+
+  const bool approximate = !this->m_Coefficients.empty();
+  const unsigned int numberOfTaps = 1u << ( 2 * ImageDimension );
+  std::vector<const double *> coefficients( this->m_Coefficients.size() );
+  for( unsigned int c = 0; c < this->m_Coefficients.size(); ++c )
+  {
+    coefficients[ c ] = this->m_Coefficients[ c ]->GetBufferPointer();
+  }
+
+  it.GoToBegin();
+  while( !it.IsAtEnd() )
+  {
+    const IndexType & index = it.GetIndex();
+    OutputPixelType displacement;
+    if( !approximate )
+    {
+      PointType point;
+      output->TransformIndexToPhysicalPoint( index, point );
+      InputPointType pointIn;
+      for( unsigned int d = 0; d < ImageDimension; ++d ) pointIn[ d ] = point[ d ];
+      const OutputPointType pointOut = this->m_KernelTransform->TransformPoint( pointIn );
+      for( unsigned int d = 0; d < ImageDimension; ++d )
+      {
+        displacement[ d ] = static_cast<OutputComponentType>( pointOut[ d ] - pointIn[ d ] );
+      }
+    }
+    else
+    {
+      /** The tensor product of the taps, two bits per dimension. */
+      SizeValueType position[ ImageDimension ];
+      for( unsigned int d = 0; d < ImageDimension; ++d )
+      {
+        position[ d ] = 4 * static_cast<SizeValueType>( index[ d ] - this->m_Region.GetIndex()[ d ] );
+      }
+      double value[ ImageDimension ];
+      for( unsigned int c = 0; c < ImageDimension; ++c ) value[ c ] = 0.0;
+      for( unsigned int tap = 0; tap < numberOfTaps; ++tap )
+      {
+        double weight = 1.0;
+        OffsetValueType offset = 0;
+        for( unsigned int d = 0; d < ImageDimension; ++d )
+        {
+          const SizeValueType k = position[ d ] + ( ( tap >> ( 2 * d ) ) & 3 );
+          weight *= this->m_TapWeights[ d ][ k ];
+          offset += this->m_TapOffsets[ d ][ k ];
+        }
+        for( unsigned int c = 0; c < ImageDimension; ++c )
+        {
+          value[ c ] += weight * coefficients[ c ][ offset ];
+        }
+      }
+      for( unsigned int c = 0; c < ImageDimension; ++c )
+      {
+        displacement[ c ] = static_cast<OutputComponentType>( value[ c ] );
+      }
+    }
+
+    it.Set( displacement );
+    ++it;
+    progress.CompletedPixel();
+  }
+
+} // end ThreadedGenerateData()
+
+
+/**
+ * ******************* AfterThreadedGenerateData *******************
+ */
+
+template< class TOutputImage, class TTransformPrecisionType >
+void
+KernelTransformDisplacementFieldSource< TOutputImage, TTransformPrecisionType >
+::AfterThreadedGenerateData( void )
+{
+  this->m_Coefficients.clear();
+  this->m_TapOffsets.clear();
+  this->m_TapWeights.clear();
+
+} // end AfterThreadedGenerateData()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template< class TOutputImage, class TTransformPrecisionType >
+void
+KernelTransformDisplacementFieldSource< TOutputImage, TTransformPrecisionType >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "Region: " << this->m_Region << std::endl;
+  os << indent << "Origin: " << this->m_Origin << std::endl;
+  os << indent << "Spacing: " << this->m_Spacing << std::endl;
+  os << indent << "Direction: " << this->m_Direction << std::endl;
+  os << indent << "GridSpacing: " << this->m_GridSpacing << std::endl;
+  os << indent << "KernelTransform: " << this->m_KernelTransform.GetPointer() << std::endl;
+
+} // end PrintSelf()
+
+} // end namespace itk
+
+#endif // end #ifndef __itkKernelTransformDisplacementFieldSource_txx_
@@ -16,7 +16,7 @@
 *
 *=========================================================================*/
 /** \file
- \brief This program converts between deformations (displacement fields) and transformations, and computes the magnitude or Jacobian of a deformation field.
+ \brief This program converts between deformations (displacement fields) and transformations, computes the magnitude or Jacobian of a deformation field, and maps points through it.
 
  \verbinclude deformationfieldoperator.help
  */
@@ -42,16 +42,40 @@ std::string GetHelpString( void )
     << "Usage:" << std::endl
     << "pxdeformationfieldoperator\n"
     << "This program converts between deformations (displacement fields)\n"
-    << "and transformations, and computes the magnitude or Jacobian of a\n"
-    << "deformation field.\n"
+    << "and transformations, computes the magnitude or Jacobian of a\n"
+    << "deformation field, and maps points through it.\n"
     << "  -in      inputFilename\n"
-    << "  [-out]   outputFilename; default: in + {operation}.mhd\n"
+    << "  [-out]   outputFilename; default: in + {operation}.mhd,\n"
+    << "           with POINTS outputpoints.txt\n"
     << "  [-ops]   operation, choose one of {DEF2TRANS, TRANS2DEF,\n"
-    << "           MAGNITUDE, JACOBIAN, DEF2JAC, INVERSE}.\n"
+    << "           MAGNITUDE, JACOBIAN, DEF2JAC, INVERSE, ANALYSIS, COMPOSE, POINTS}.\n"
     << "           default: MAGNITUDE\n"
+    << "  [-outmag] with ANALYSIS, the outputFilename of the magnitude\n"
+    << "  [-outjac] with ANALYSIS, the outputFilename of the Jacobian determinant\n"
+    << "  [-comp]  with COMPOSE, the fields to compose the input with, in order\n"
+    << "  [-ipp]   with POINTS, the input point file, in the transformix format\n"
+    << "  [-opct]  precision of the computation and of the output, choose one of\n"
+    << "           {float, double}, default equal to the input. With float, a double\n"
+    << "           field is converted when it is read, halving the memory usage.\n"
     << "  [-s]     number of streams, default 1\n"
-    << "  [-it]    number of iterations, for the iterative inversion, default 1, increase to get better results\n"
+    << "  [-it]    number of iterations, for the iterative inversion, default 5, increase to get better results\n"
     << "  [-stop]  allowed error, default 0.0, increase to get faster convergence\n"
+    << "The inverse u of the field v is computed by fixed point iteration of u(x) = -v(x + u(x)),\n"
+    << "starting from -v(x), with v linearly interpolated. The iteration stops after -it iterations,\n"
+    << "or when the maximum change of a voxel, in physical units, is not larger than -stop.\n"
+    << "The mean and maximum change of every iteration are printed.\n"
+    << "ANALYSIS reads the field once, and computes the magnitude, the Jacobian determinant\n"
+    << "and their statistics in one pass. It prints the statistics and the number of folds,\n"
+    << "the voxels with a Jacobian determinant <= 0, and writes only the requested outputs.\n"
+    << "COMPOSE computes w(x) = u(x) + v(x + u(x)), for the input u and the first -comp field v,\n"
+    << "and so on for the next fields, on the grid of the input. It is done in float, and written\n"
+    << "as float. With -s streams the output is processed in slabs, and of every -comp field only\n"
+    << "the region that is reached from the slab is read and linearly interpolated.\n"
+    << "POINTS maps every point x of -ipp to x + u(x), for the input u linearly interpolated,\n"
+    << "clamped to the field; indices are indices of the field. The output point file has the\n"
+    << "format of the input, in world coordinates, binary if the input is. The points are sorted\n"
+    << "by their block of the field and interpolated in parallel. Only the bounding box of the\n"
+    << "points is read from the field, with -s streams in slabs along the last dimension.\n"
     << "Supported: 2D, 3D, vector of floats or doubles, number of components\n"
     << "must equal number of dimensions.";
   return ss.str();
@@ -91,7 +115,11 @@ int main( int argc, char **argv )
 
   std::string outputFileName = "";
   parser->GetCommandLineArgument( "-out", outputFileName );
-  if( outputFileName == "" )
+  if( outputFileName == "" && ops == "POINTS" )
+  {
+    outputFileName = "outputpoints.txt";
+  }
+  else if( outputFileName == "" )
   {
     std::string part1 =
       itksys::SystemTools::GetFilenameWithoutLastExtension(inputFileName);
@@ -100,12 +128,27 @@ int main( int argc, char **argv )
     outputFileName = part1 + ops + ext;
   }
 
+  /** The outputs of the analysis. */
+  std::string magnitudeFileName = "";
+  parser->GetCommandLineArgument( "-outmag", magnitudeFileName );
+
+  std::string jacobianFileName = "";
+  parser->GetCommandLineArgument( "-outjac", jacobianFileName );
+
+  /** The fields to compose with. */
+  std::vector<std::string> composeFileNames;
+  parser->GetCommandLineArgument( "-comp", composeFileNames );
+
+  /** The points to transform. */
+  std::string inputPointsFileName = "";
+  parser->GetCommandLineArgument( "-ipp", inputPointsFileName );
+
   /** Support for streaming. */
   unsigned int numberOfStreams = 1;
   parser->GetCommandLineArgument( "-s", numberOfStreams );
 
   /** Parameters for the inversion. */
-  unsigned int numberOfIterations = 1;
+  unsigned int numberOfIterations = 5;
   parser->GetCommandLineArgument( "-it", numberOfIterations );
 
   double stopValue = 0.0;
@@ -132,6 +175,16 @@ int main( int argc, char **argv )
     return EXIT_FAILURE;
   }
 
+  /** The field is processed and written in the precision of -opct.
+   * The reader converts the input on the fly.
+   */
+  std::string componentTypeAsString = "";
+  bool retopct = parser->GetCommandLineArgument( "-opct", componentTypeAsString );
+  if( retopct )
+  {
+    componentType = itk::ImageIOBase::GetComponentTypeFromString( componentTypeAsString );
+  }
+
   /** Class that does the work. */
   ITKToolsDeformationFieldOperatorBase * filter = 0;
 
@@ -156,7 +209,12 @@ int main( int argc, char **argv )
     filter->m_NumberOfStreams = numberOfStreams;
     filter->m_NumberOfIterations = numberOfIterations;
     filter->m_StopValue = stopValue;
+    filter->m_MagnitudeFileName = magnitudeFileName;
+    filter->m_JacobianFileName = jacobianFileName;
+    filter->m_ComposeFileNames = composeFileNames;
+    filter->m_InputPointsFileName = inputPointsFileName;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
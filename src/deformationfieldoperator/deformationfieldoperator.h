@@ -27,7 +27,20 @@
 #include "itkImageRegionIteratorWithIndex.h"
 #include "itkDisplacementFieldJacobianDeterminantFilter.h"
 #include "itkGradientToMagnitudeImageFilter.h"
-#include "itkIterativeInverseDisplacementFieldImageFilter.h"
+#include "itkDisplacementFieldAnalysisImageFilter.h"
+#include "itkFixedPointInverseDisplacementFieldImageFilter.h"
+#include "itkTransformixInputPointFileReader.h"
+#include "itkPointSet.h"
+#include "itkCommand.h"
+#include "itkMultiThreader.h"
+#include <itksys/SystemTools.hxx>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <locale>
+#include <utility>
 
 
 /** \class ITKToolsDeformationFieldOperatorBase
@@ -45,9 +58,11 @@ public:
     this->m_InputFileName = "";
     this->m_OutputFileName = "";
     this->m_Ops = "";
-    this->m_NumberOfStreams = 0;
     this->m_NumberOfIterations = 0;
     this->m_StopValue = 0.0f;
+    this->m_MagnitudeFileName = "";
+    this->m_JacobianFileName = "";
+    this->m_InputPointsFileName = "";
   };
   /** Destructor. */
   ~ITKToolsDeformationFieldOperatorBase(){};
@@ -56,9 +71,15 @@ public:
   std::string m_InputFileName;
   std::string m_OutputFileName;
   std::string m_Ops;
-  unsigned int m_NumberOfStreams;
   unsigned int m_NumberOfIterations;
   double m_StopValue;
+  std::string m_MagnitudeFileName;
+  std::string m_JacobianFileName;
+  std::vector<std::string> m_ComposeFileNames;
+  std::string m_InputPointsFileName;
+
+  /** This tool supports streaming. */
+  virtual bool GetSupportsStreaming( void ) const { return true; }
 
 }; // end class ITKToolsDeformationFieldOperatorBase
 
@@ -97,8 +118,9 @@ public:
 
     /** Read in the inputImage. */
     reader->SetFileName( this->m_InputFileName.c_str() );
-    // temporarily: only streaming support for Jacobian case needed for EMPIRE10 challenge.
-    if( this->m_Ops != "DEF2JAC" && this->m_Ops != "JACOBIAN" )
+    // temporarily: only streaming support for the Jacobian and magnitude cases.
+    if( this->m_Ops != "DEF2JAC" && this->m_Ops != "JACOBIAN" && this->m_Ops != "MAGNITUDE"
+      && this->m_Ops != "COMPOSE" && this->m_Ops != "POINTS" )
     {
       reader->Update();
     }
@@ -127,17 +149,111 @@ public:
     {
       this->ComputeInverse();
     }
+    else if( this->m_Ops == "ANALYSIS" )
+    {
+      this->ComputeAnalysis( workingImage );
+    }
+    else if( this->m_Ops == "COMPOSE" )
+    {
+      this->ComputeComposition();
+    }
+    else if( this->m_Ops == "POINTS" )
+    {
+      this->ComputeTransformedPoints();
+    }
     else
     {
       itkGenericExceptionMacro( << "<< invalid operator: " << this->m_Ops );
     }
   } // end Run()
 
+  /** Helper class to print the errors of the iterations of the inversion. */
+  template< class TFilter >
+  class ShowIterationObject
+  {
+  public:
+    ShowIterationObject( TFilter * f )
+    {
+      this->m_Filter = f;
+    }
+    void ShowIteration()
+    {
+      std::cout << "Iteration " << this->m_Filter->GetElapsedIterations()
+        << ": mean error " << this->m_Filter->GetMeanErrors().back()
+        << ", maximum error " << this->m_Filter->GetMaximumErrors().back() << std::endl;
+    }
+    typename TFilter::Pointer m_Filter;
+  }; // end class ShowIterationObject
+
   /** Helper functions that implement the real functionality. */
   void Deformation2Transformation( VectorImageType * inputImage, bool def2trans );
   void ComputeMagnitude( VectorImageType * inputImage );
   void ComputeJacobian( void );
   void ComputeInverse( void );
+  void ComputeAnalysis( VectorImageType * inputImage );
+  void ComputeComposition( void );
+  void ComputeTransformedPoints( void );
+
+protected:
+
+  /** Typedef's for the composition, which is done in float. */
+  typedef itk::Vector< float, VDimension >              FloatVectorPixelType;
+  typedef itk::Image< FloatVectorPixelType, VDimension > FloatVectorImageType;
+  typedef typename FloatVectorImageType::Pointer        FloatVectorImagePointer;
+  typedef typename FloatVectorImageType::RegionType     RegionType;
+
+  /** The arguments of the threads that add the displacements of the next
+   * field at the current points of a slab. In the first pass the threads
+   * compute the bounding box of the continuous indices of the points in
+   * the next field, in the second pass they interpolate the field.
+   */
+  struct ComposeStruct
+  {
+    bool                m_ComputeBoundingBox;
+    std::size_t         m_NumberOfPixels;
+    float *             m_Displacement;
+    RegionType          m_Slab;
+    double              m_Origin[ VDimension ];
+    double              m_IndexToPoint[ VDimension ][ VDimension ];
+    double              m_FieldOrigin[ VDimension ];
+    double              m_FieldPointToIndex[ VDimension ][ VDimension ];
+    RegionType          m_FieldRegion;
+    RegionType          m_FieldBufferedRegion;
+    const float *       m_Field;
+    std::vector<double> m_Minimum;
+    std::vector<double> m_Maximum;
+  };
+
+  /** Thread callback of the composition. */
+  static ITK_THREAD_RETURN_TYPE ComposeThreaderCallback( void * arg );
+
+  /** The arguments of the threads that add the displacements of a region
+   * of the field to the points. The points m_Order[ m_Begin ] up to
+   * m_Order[ m_End ] lie in that region.
+   */
+  struct TransformPointsStruct
+  {
+    std::size_t         m_Begin;
+    std::size_t         m_End;
+    const std::size_t * m_Order;
+    const double *      m_ContinuousIndices;
+    double *            m_Points;
+    RegionType          m_FieldBufferedRegion;
+    const float *       m_Field;
+  };
+
+  /** Thread callback of the point transformation. */
+  static ITK_THREAD_RETURN_TYPE TransformPointsThreaderCallback( void * arg );
+
+  /** Interpolate a field with the given strides linearly at the continuous
+   * index c, clamped to the buffered region of the field.
+   */
+  static void InterpolateField( const double * c, const float * field,
+    const RegionType & buffered, const std::size_t * stride, double * value );
+
+  /** Read a region of a field, disconnected from its reader. */
+  static FloatVectorImagePointer ReadFieldRegion( const std::string & fileName,
+    const RegionType & region );
 
 }; // end class ITKToolsDeformationFieldOperator
 
@@ -214,11 +330,13 @@ ITKToolsDeformationFieldOperator< VDimension, TComponentType >
   typename WriterType::Pointer writer = WriterType::New();
 
   magnitudeFilter->SetInput( inputImage );
-  magnitudeFilter->Update();
 
-  /** Write the output image. */
+  /** Write the output image. No intermediate calls to Update() are allowed,
+   * otherwise streaming does not work.
+   */
   writer->SetInput( magnitudeFilter->GetOutput() );
   writer->SetFileName( this->m_OutputFileName.c_str() );
+  this->SetStreamingOnWriter( writer.GetPointer() );
   writer->Update();
 
 } // end ComputeMagnitude()
@@ -255,7 +373,7 @@ ITKToolsDeformationFieldOperator< VDimension, TComponentType >
   typename WriterType::Pointer writer = WriterType::New();
   writer->SetInput( defToJacFilter->GetOutput() );
   writer->SetFileName( this->m_OutputFileName.c_str() );
-  writer->SetNumberOfStreamDivisions( this->m_NumberOfStreams );
+  this->SetStreamingOnWriter( writer.GetPointer() );
   writer->Update();
 
 } // end ComputeJacobian()
@@ -274,7 +392,7 @@ ITKToolsDeformationFieldOperator< VDimension, TComponentType >
   /** Typedef's. */
   typedef itk::ImageFileReader< VectorImageType >     ReaderType;
   typedef itk::ImageFileWriter< VectorImageType >     WriterType;
-  typedef itk::IterativeInverseDisplacementFieldImageFilter<
+  typedef itk::FixedPointInverseDisplacementFieldImageFilter<
     VectorImageType, VectorImageType >                InverseDeformationFilterType;
 
   /** Declare filters. */
@@ -291,15 +409,739 @@ ITKToolsDeformationFieldOperator< VDimension, TComponentType >
   inversionFilter->SetNumberOfIterations( this->m_NumberOfIterations );
   inversionFilter->SetStopValue( this->m_StopValue );
 
+  /** Print the convergence of the iterations. */
+  typedef ShowIterationObject< InverseDeformationFilterType > ShowIterationType;
+  ShowIterationType iterationWatch( inversionFilter );
+  typename itk::SimpleMemberCommand<ShowIterationType>::Pointer iterationCommand
+    = itk::SimpleMemberCommand<ShowIterationType>::New();
+  iterationCommand->SetCallbackFunction( &iterationWatch, &ShowIterationType::ShowIteration );
+  inversionFilter->AddObserver( itk::IterationEvent(), iterationCommand );
+
   /** Setup writer.  No intermediate calls to Update() are allowed,
    * otherwise streaming does not work.
    */
   writer->SetInput( inversionFilter->GetOutput() );
   writer->SetFileName( this->m_OutputFileName.c_str() );
-  writer->SetNumberOfStreamDivisions( this->m_NumberOfStreams );
+  this->ObserveProcess( reader.GetPointer(), "read" );
+  this->ObserveProcess( inversionFilter.GetPointer(), "inverse" );
+  this->ObserveProcess( writer.GetPointer(), "write" );
+  this->SetStreamingOnWriter( writer.GetPointer() );
   writer->Update();
 
 } // end ComputeInverse()
 
 
+/**
+ * ******************* ComputeAnalysis ************************
+ * Compute the magnitude, the Jacobian determinant and their statistics
+ * in one pass, and write the requested outputs
+ */
+
+template< unsigned int VDimension, class TComponentType >
+void
+ITKToolsDeformationFieldOperator< VDimension, TComponentType >
+::ComputeAnalysis( VectorImageType * inputImage )
+{
+  /** Typedef's. */
+  typedef itk::DisplacementFieldAnalysisImageFilter<
+    VectorImageType, ScalarImageType >                AnalysisFilterType;
+  typedef typename AnalysisFilterType::StatisticsType StatisticsType;
+  typedef itk::ImageFileWriter< ScalarImageType >     WriterType;
+
+  /** Analyse the field. */
+  typename AnalysisFilterType::Pointer analysisFilter = AnalysisFilterType::New();
+  analysisFilter->SetInput( inputImage );
+  analysisFilter->SetComputeMagnitude( this->m_MagnitudeFileName != "" );
+  analysisFilter->SetComputeJacobian( this->m_JacobianFileName != "" );
+  analysisFilter->Update();
+
+  /** Print the statistics. */
+  const double numberOfVoxels = static_cast<double>(
+    inputImage->GetLargestPossibleRegion().GetNumberOfPixels() );
+  const StatisticsType & magnitude = analysisFilter->GetMagnitudeStatistics();
+  const StatisticsType & jacobian = analysisFilter->GetJacobianStatistics();
+  std::cout << "            min\tmax\tmean\tstd\n"
+    << "magnitude:  " << magnitude.Minimum << "\t" << magnitude.Maximum
+    << "\t" << magnitude.Mean << "\t" << magnitude.Sigma << "\n"
+    << "jacobian:   " << jacobian.Minimum << "\t" << jacobian.Maximum
+    << "\t" << jacobian.Mean << "\t" << jacobian.Sigma << "\n"
+    << "folds:      " << analysisFilter->GetNumberOfFolds() << " ("
+    << 100.0 * analysisFilter->GetNumberOfFolds() / numberOfVoxels
+    << "% of the voxels have a jacobian <= 0)" << std::endl;
+
+  /** Write the requested outputs. */
+  if( this->m_MagnitudeFileName != "" )
+  {
+    typename WriterType::Pointer writer = WriterType::New();
+    writer->SetInput( analysisFilter->GetMagnitudeOutput() );
+    writer->SetFileName( this->m_MagnitudeFileName.c_str() );
+    writer->Update();
+  }
+  if( this->m_JacobianFileName != "" )
+  {
+    typename WriterType::Pointer writer = WriterType::New();
+    writer->SetInput( analysisFilter->GetJacobianOutput() );
+    writer->SetFileName( this->m_JacobianFileName.c_str() );
+    writer->Update();
+  }
+
+} // end ComputeAnalysis()
+
+
+/**
+ * ******************* ReadFieldRegion ************************
+ * Only the requested region is read, if the image format supports it
+ */
+
+template< unsigned int VDimension, class TComponentType >
+typename ITKToolsDeformationFieldOperator< VDimension, TComponentType >::FloatVectorImagePointer
+ITKToolsDeformationFieldOperator< VDimension, TComponentType >
+::ReadFieldRegion( const std::string & fileName, const RegionType & region )
+{
+  typedef itk::ImageFileReader< FloatVectorImageType >  ReaderType;
+
+  typename ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( fileName.c_str() );
+  reader->UpdateOutputInformation();
+  reader->GetOutput()->SetRequestedRegion( region );
+  reader->Update();
+  FloatVectorImagePointer image = reader->GetOutput();
+  image->DisconnectPipeline();
+  return image;
+
+} // end ReadFieldRegion()
+
+
+/**
+ * ******************* InterpolateField ************************
+ */
+
+template< unsigned int VDimension, class TComponentType >
+void
+ITKToolsDeformationFieldOperator< VDimension, TComponentType >
+::InterpolateField( const double * c, const float * field,
+  const RegionType & buffered, const std::size_t * stride, double * value )
+{
+  const unsigned int D = VDimension;
+  std::size_t baseOffset = 0;
+  double fraction[ VDimension ];
+  std::size_t step[ VDimension ];
+  for( unsigned int d = 0; d < D; ++d )
+  {
+    const std::size_t size = buffered.GetSize()[ d ];
+    const double cd = std::min( std::max(
+      c[ d ] - static_cast<double>( buffered.GetIndex()[ d ] ), 0.0 ),
+      static_cast<double>( size - 1 ) );
+    std::size_t base = static_cast<std::size_t>( cd );
+    fraction[ d ] = cd - static_cast<double>( base );
+    step[ d ] = stride[ d ];
+    if( base + 1 >= size )
+    {
+      base = size - 1;
+      fraction[ d ] = 0.0;
+      step[ d ] = 0;
+    }
+    baseOffset += base * stride[ d ];
+  }
+
+  for( unsigned int d = 0; d < D; ++d ) value[ d ] = 0.0;
+  for( unsigned int corner = 0; corner < ( 1u << D ); ++corner )
+  {
+    double weight = 1.0;
+    std::size_t offset = baseOffset;
+    for( unsigned int d = 0; d < D; ++d )
+    {
+      if( corner & ( 1u << d ) )
+      {
+        weight *= fraction[ d ];
+        offset += step[ d ];
+      }
+      else
+      {
+        weight *= 1.0 - fraction[ d ];
+      }
+    }
+    if( weight == 0.0 ) continue;
+    const float * v = field + offset * D;
+    for( unsigned int d = 0; d < D; ++d )
+    {
+      value[ d ] += weight * static_cast<double>( v[ d ] );
+    }
+  }
+
+} // end InterpolateField()
+
+
+/**
+ * ******************* ComposeThreaderCallback ************************
+ * Every thread processes a contiguous part of the slab
+ */
+
+template< unsigned int VDimension, class TComponentType >
+ITK_THREAD_RETURN_TYPE
+ITKToolsDeformationFieldOperator< VDimension, TComponentType >
+::ComposeThreaderCallback( void * arg )
+{
+  itk::MultiThreader::ThreadInfoStruct * info
+    = static_cast<itk::MultiThreader::ThreadInfoStruct *>( arg );
+  ComposeStruct * data = static_cast<ComposeStruct *>( info->UserData );
+
+  const unsigned int D = VDimension;
+  const std::size_t begin = data->m_NumberOfPixels * info->ThreadID / info->NumberOfThreads;
+  const std::size_t end = data->m_NumberOfPixels * ( info->ThreadID + 1 ) / info->NumberOfThreads;
+
+  /** The index of the first voxel in the slab. */
+  std::size_t index[ VDimension ];
+  std::size_t rest = begin;
+  for( unsigned int d = 0; d < D; ++d )
+  {
+    index[ d ] = rest % data->m_Slab.GetSize()[ d ];
+    rest /= data->m_Slab.GetSize()[ d ];
+  }
+
+  /** The strides of the buffered region of the field. */
+  const RegionType & buffered = data->m_FieldBufferedRegion;
+  std::size_t stride[ VDimension ];
+  stride[ 0 ] = 1;
+  for( unsigned int d = 1; d < D; ++d )
+  {
+    stride[ d ] = stride[ d - 1 ] * buffered.GetSize()[ d - 1 ];
+  }
+
+  double * minimum = &data->m_Minimum[ info->ThreadID * D ];
+  double * maximum = &data->m_Maximum[ info->ThreadID * D ];
+  for( std::size_t k = begin; k < end; ++k )
+  {
+    /** The current point x + w(x). */
+    float * w = data->m_Displacement + k * D;
+    double point[ VDimension ];
+    for( unsigned int d = 0; d < D; ++d )
+    {
+      point[ d ] = data->m_Origin[ d ] + w[ d ];
+      for( unsigned int e = 0; e < D; ++e )
+      {
+        point[ d ] += data->m_IndexToPoint[ d ][ e ]
+          * static_cast<double>( data->m_Slab.GetIndex()[ e ] + index[ e ] );
+      }
+    }
+
+    /** Its continuous index in the field, clamped to the field. */
+    double c[ VDimension ];
+    for( unsigned int d = 0; d < D; ++d )
+    {
+      c[ d ] = 0.0;
+      for( unsigned int e = 0; e < D; ++e )
+      {
+        c[ d ] += data->m_FieldPointToIndex[ d ][ e ] * ( point[ e ] - data->m_FieldOrigin[ e ] );
+      }
+      const double first = static_cast<double>( data->m_FieldRegion.GetIndex()[ d ] );
+      const double last = first + static_cast<double>( data->m_FieldRegion.GetSize()[ d ] - 1 );
+      c[ d ] = std::min( std::max( c[ d ], first ), last );
+    }
+
+    if( data->m_ComputeBoundingBox )
+    {
+      for( unsigned int d = 0; d < D; ++d )
+      {
+        minimum[ d ] = std::min( minimum[ d ], c[ d ] );
+        maximum[ d ] = std::max( maximum[ d ], c[ d ] );
+      }
+    }
+    else
+    {
+      /** Interpolate the field linearly within its buffered region. */
+      double value[ VDimension ];
+      InterpolateField( c, data->m_Field, buffered, stride, value );
+
+      for( unsigned int d = 0; d < D; ++d )
+      {
+        w[ d ] = static_cast<float>( w[ d ] + value[ d ] );
+      }
+    }
+
+    /** The next index, first dimension fastest. */
+    for( unsigned int d = 0; d < D; ++d )
+    {
+      if( ++index[ d ] < data->m_Slab.GetSize()[ d ] ) break;
+      index[ d ] = 0;
+    }
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end ComposeThreaderCallback()
+
+
+/**
+ * ******************* ComputeComposition ************************
+ * Compose the input with the fields m_ComposeFileNames: the result is
+ * w(x) = u(x) + v( x + u(x) ), for the input u and the next field v, and
+ * so on. The output is processed in slabs along the last dimension. Of
+ * every next field only the region that is reached from the current slab
+ * is read.
+ */
+
+template< unsigned int VDimension, class TComponentType >
+void
+ITKToolsDeformationFieldOperator< VDimension, TComponentType >
+::ComputeComposition( void )
+{
+  /** Typedef's. */
+  typedef itk::ImageFileReader< FloatVectorImageType >  ReaderType;
+  typedef itk::ImageFileWriter< FloatVectorImageType >  WriterType;
+  typedef typename RegionType::IndexType                IndexType;
+  typedef typename RegionType::SizeType                 SizeType;
+
+  const unsigned int D = VDimension;
+  if( this->m_ComposeFileNames.empty() )
+  {
+    itkGenericExceptionMacro( << "ERROR: COMPOSE needs the fields to compose with, with \"-comp\"." );
+  }
+
+  /** Get the geometry of the output, which is that of the input. */
+  typename ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( this->m_InputFileName.c_str() );
+  reader->UpdateOutputInformation();
+  FloatVectorImageType * input = reader->GetOutput();
+  const RegionType region = input->GetLargestPossibleRegion();
+
+  ComposeStruct data;
+  for( unsigned int d = 0; d < D; ++d )
+  {
+    data.m_Origin[ d ] = input->GetOrigin()[ d ];
+    for( unsigned int e = 0; e < D; ++e )
+    {
+      data.m_IndexToPoint[ d ][ e ] = input->GetDirection()[ d ][ e ] * input->GetSpacing()[ e ];
+    }
+  }
+
+  /** The geometry of the fields to compose with. */
+  const std::size_t numberOfFields = this->m_ComposeFileNames.size();
+  std::vector< FloatVectorImagePointer > fieldInformation( numberOfFields );
+  for( std::size_t i = 0; i < numberOfFields; ++i )
+  {
+    typename ReaderType::Pointer fieldReader = ReaderType::New();
+    fieldReader->SetFileName( this->m_ComposeFileNames[ i ].c_str() );
+    fieldReader->UpdateOutputInformation();
+    fieldInformation[ i ] = fieldReader->GetOutput();
+  }
+
+  /** Estimate the memory needed without streaming: the displacements of
+   * the output, and the reached part of a field, of about the same size.
+   */
+  const double sizeInMB = region.GetNumberOfPixels() * 2.0 * D * sizeof( float ) / 1048576.0;
+
+  /** Determine the slabs. */
+  const unsigned int lastDimension = VDimension - 1;
+  const unsigned int lastSize = region.GetSize()[ lastDimension ];
+  unsigned int numberOfSlabs = this->GetNumberOfStreams( sizeInMB );
+  if( numberOfSlabs < 1 ) numberOfSlabs = 1;
+  if( numberOfSlabs > lastSize ) numberOfSlabs = lastSize;
+
+  /** The output is pasted slab by slab into a new file. */
+  const bool streaming = numberOfSlabs > 1;
+  if( streaming )
+  {
+    itksys::SystemTools::RemoveFile( this->m_OutputFileName.c_str() );
+  }
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  const unsigned int numberOfThreads = threader->GetNumberOfThreads();
+
+  for( unsigned int s = 0; s < numberOfSlabs; ++s )
+  {
+    /** The slab spans the full image in all but the last dimension. */
+    const unsigned int begin = static_cast<unsigned int>(
+      static_cast<unsigned long long>( lastSize ) * s / numberOfSlabs );
+    const unsigned int end = static_cast<unsigned int>(
+      static_cast<unsigned long long>( lastSize ) * ( s + 1 ) / numberOfSlabs );
+    RegionType slab = region;
+    slab.SetIndex( lastDimension, region.GetIndex()[ lastDimension ] + begin );
+    slab.SetSize( lastDimension, end - begin );
+    if( streaming )
+    {
+      std::cout << "Processing slab " << s + 1 << " of " << numberOfSlabs << std::endl;
+    }
+
+    /** The slab of the input is the accumulator of the displacements. */
+    FloatVectorImagePointer displacement = ReadFieldRegion( this->m_InputFileName, slab );
+    data.m_Slab = slab;
+    data.m_NumberOfPixels = slab.GetNumberOfPixels();
+    data.m_Displacement = reinterpret_cast<float *>(
+      displacement->GetBufferPointer() + displacement->ComputeOffset( slab.GetIndex() ) );
+
+    for( std::size_t i = 0; i < numberOfFields; ++i )
+    {
+      const FloatVectorImageType * field = fieldInformation[ i ];
+      const typename FloatVectorImageType::DirectionType & inverseDirection
+        = field->GetInverseDirection();
+      for( unsigned int d = 0; d < D; ++d )
+      {
+        data.m_FieldOrigin[ d ] = field->GetOrigin()[ d ];
+        for( unsigned int e = 0; e < D; ++e )
+        {
+          data.m_FieldPointToIndex[ d ][ e ] = inverseDirection[ d ][ e ] / field->GetSpacing()[ d ];
+        }
+      }
+      data.m_FieldRegion = field->GetLargestPossibleRegion();
+
+      /** The region of the field reached from the current points. */
+      data.m_ComputeBoundingBox = true;
+      data.m_Minimum.assign( numberOfThreads * D, itk::NumericTraits<double>::max() );
+      data.m_Maximum.assign( numberOfThreads * D, itk::NumericTraits<double>::NonpositiveMin() );
+      threader->SetSingleMethod( ComposeThreaderCallback, &data );
+      threader->SingleMethodExecute();
+
+      IndexType reachedIndex;
+      SizeType reachedSize;
+      for( unsigned int d = 0; d < D; ++d )
+      {
+        double minimum = itk::NumericTraits<double>::max();
+        double maximum = itk::NumericTraits<double>::NonpositiveMin();
+        for( unsigned int t = 0; t < numberOfThreads; ++t )
+        {
+          minimum = std::min( minimum, data.m_Minimum[ t * D + d ] );
+          maximum = std::max( maximum, data.m_Maximum[ t * D + d ] );
+        }
+        const itk::OffsetValueType lastIndex = data.m_FieldRegion.GetIndex()[ d ]
+          + static_cast<itk::OffsetValueType>( data.m_FieldRegion.GetSize()[ d ] ) - 1;
+        reachedIndex[ d ] = static_cast<itk::OffsetValueType>( std::floor( minimum ) );
+        const itk::OffsetValueType reachedLast = std::min( lastIndex,
+          static_cast<itk::OffsetValueType>( std::floor( maximum ) ) + 1 );
+        reachedSize[ d ] = reachedLast - reachedIndex[ d ] + 1;
+      }
+      RegionType reached( reachedIndex, reachedSize );
+
+      /** Read that region of the field, and add its displacements. */
+      FloatVectorImagePointer fieldRegion
+        = ReadFieldRegion( this->m_ComposeFileNames[ i ], reached );
+      data.m_FieldBufferedRegion = fieldRegion->GetBufferedRegion();
+      data.m_Field = reinterpret_cast<const float *>( fieldRegion->GetBufferPointer() );
+      data.m_ComputeBoundingBox = false;
+      threader->SingleMethodExecute();
+    }
+
+    /** Write the slab. When streaming, only the slab is pasted into the output file. */
+    typename WriterType::Pointer writer = WriterType::New();
+    writer->SetFileName( this->m_OutputFileName.c_str() );
+    writer->SetInput( displacement );
+    if( streaming )
+    {
+      itk::ImageIORegion ioRegion( VDimension );
+      itk::ImageIORegionAdaptor< VDimension >::Convert(
+        slab, ioRegion, region.GetIndex() );
+      writer->SetIORegion( ioRegion );
+    }
+    writer->Update();
+  }
+
+} // end ComputeComposition()
+
+
+/**
+ * ******************* TransformPointsThreaderCallback ************************
+ * Every thread processes a contiguous part of the sorted points
+ */
+
+template< unsigned int VDimension, class TComponentType >
+ITK_THREAD_RETURN_TYPE
+ITKToolsDeformationFieldOperator< VDimension, TComponentType >
+::TransformPointsThreaderCallback( void * arg )
+{
+  itk::MultiThreader::ThreadInfoStruct * info
+    = static_cast<itk::MultiThreader::ThreadInfoStruct *>( arg );
+  TransformPointsStruct * data = static_cast<TransformPointsStruct *>( info->UserData );
+
+  const unsigned int D = VDimension;
+  const std::size_t numberOfPoints = data->m_End - data->m_Begin;
+  const std::size_t begin = data->m_Begin + numberOfPoints * info->ThreadID / info->NumberOfThreads;
+  const std::size_t end = data->m_Begin + numberOfPoints * ( info->ThreadID + 1 ) / info->NumberOfThreads;
+
+  /** The strides of the buffered region of the field. */
+  const RegionType & buffered = data->m_FieldBufferedRegion;
+  std::size_t stride[ VDimension ];
+  stride[ 0 ] = 1;
+  for( unsigned int d = 1; d < D; ++d )
+  {
+    stride[ d ] = stride[ d - 1 ] * buffered.GetSize()[ d - 1 ];
+  }
+
+  /** Every point is visited once, so the threads write different points. */
+  for( std::size_t k = begin; k < end; ++k )
+  {
+    const std::size_t j = data->m_Order[ k ];
+    double value[ VDimension ];
+    InterpolateField( data->m_ContinuousIndices + j * D, data->m_Field,
+      buffered, stride, value );
+    for( unsigned int d = 0; d < D; ++d )
+    {
+      data->m_Points[ j * D + d ] += value[ d ];
+    }
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end TransformPointsThreaderCallback()
+
+
+/**
+ * ******************* ComputeTransformedPoints ************************
+ * Map the points of m_InputPointsFileName through the input field, x + u(x),
+ * with u linearly interpolated. The points are sorted by the block of the
+ * field they lie in, so that the threads interpolate from nearby memory.
+ * Only the bounding box of the points is read from the field, in slabs of
+ * blocks along the last dimension when streaming.
+ */
+
+template< unsigned int VDimension, class TComponentType >
+void
+ITKToolsDeformationFieldOperator< VDimension, TComponentType >
+::ComputeTransformedPoints( void )
+{
+  /** Typedef's. */
+  typedef itk::ImageFileReader< FloatVectorImageType >  ReaderType;
+  typedef itk::DefaultStaticMeshTraits<
+    double, VDimension, VDimension, double, double, double > MeshTraitsType;
+  typedef itk::PointSet< double, VDimension, MeshTraitsType > PointSetType;
+  typedef itk::TransformixInputPointFileReader<
+    PointSetType >                                      PointReaderType;
+  typedef typename PointSetType::PointType              PointType;
+  typedef typename RegionType::IndexType                IndexType;
+  typedef typename RegionType::SizeType                 SizeType;
+  typedef std::pair< unsigned long long, std::size_t >  KeyType;
+
+  const unsigned int D = VDimension;
+  if( this->m_InputPointsFileName == "" )
+  {
+    itkGenericExceptionMacro( << "ERROR: POINTS needs the points to transform, with \"-ipp\"." );
+  }
+
+  /** Read the points. */
+  typename PointReaderType::Pointer pointReader = PointReaderType::New();
+  pointReader->SetFileName( this->m_InputPointsFileName.c_str() );
+  std::cout << "Reading input point file: " << this->m_InputPointsFileName << std::endl;
+  pointReader->Update();
+  const std::size_t numberOfPoints = pointReader->GetNumberOfPoints();
+  const bool pointsAreIndices = pointReader->GetPointsAreIndices();
+  const bool isBinary = pointReader->GetIsBinary();
+  std::cout << "  Number of specified input points: " << numberOfPoints
+    << ( pointsAreIndices ? ", as indices of the field." : ", in world coordinates." )
+    << std::endl;
+
+  /** Get the geometry of the field. */
+  typename ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( this->m_InputFileName.c_str() );
+  reader->UpdateOutputInformation();
+  const FloatVectorImageType * field = reader->GetOutput();
+  const RegionType region = field->GetLargestPossibleRegion();
+
+  double origin[ VDimension ];
+  double indexToPoint[ VDimension ][ VDimension ];
+  double pointToIndex[ VDimension ][ VDimension ];
+  const typename FloatVectorImageType::DirectionType & inverseDirection
+    = field->GetInverseDirection();
+  for( unsigned int d = 0; d < D; ++d )
+  {
+    origin[ d ] = field->GetOrigin()[ d ];
+    for( unsigned int e = 0; e < D; ++e )
+    {
+      indexToPoint[ d ][ e ] = field->GetDirection()[ d ][ e ] * field->GetSpacing()[ e ];
+      pointToIndex[ d ][ e ] = inverseDirection[ d ][ e ] / field->GetSpacing()[ d ];
+    }
+  }
+
+  /** The points in world coordinates, and their continuous indices in the
+   * field, clamped to the field. Indices are rounded, as transformix does.
+   */
+  std::vector<double> points( numberOfPoints * D );
+  std::vector<double> continuousIndices( numberOfPoints * D );
+  const typename PointSetType::PointsContainer * inputPoints
+    = pointReader->GetOutput()->GetPoints();
+  for( std::size_t j = 0; j < numberOfPoints; ++j )
+  {
+    const PointType & inputPoint = inputPoints->ElementAt( j );
+    double * point = &points[ j * D ];
+    double * c = &continuousIndices[ j * D ];
+    for( unsigned int d = 0; d < D; ++d )
+    {
+      point[ d ] = inputPoint[ d ];
+      if( pointsAreIndices )
+      {
+        point[ d ] = origin[ d ];
+        for( unsigned int e = 0; e < D; ++e )
+        {
+          point[ d ] += indexToPoint[ d ][ e ] * vnl_math_rnd( inputPoint[ e ] );
+        }
+      }
+    }
+    for( unsigned int d = 0; d < D; ++d )
+    {
+      c[ d ] = 0.0;
+      for( unsigned int e = 0; e < D; ++e )
+      {
+        c[ d ] += pointToIndex[ d ][ e ] * ( point[ e ] - origin[ e ] );
+      }
+      const double first = static_cast<double>( region.GetIndex()[ d ] );
+      const double last = first + static_cast<double>( region.GetSize()[ d ] - 1 );
+      c[ d ] = std::min( std::max( c[ d ], first ), last );
+    }
+  }
+  pointReader = 0;
+
+  /** Sort the points by their block of the field, with the last dimension
+   * slowest, so that the points of a slab of blocks are contiguous.
+   */
+  const unsigned long blockSize = 16;
+  unsigned long long numberOfBlocks[ VDimension ];
+  unsigned long long blockStride[ VDimension ];
+  for( unsigned int d = 0; d < D; ++d )
+  {
+    numberOfBlocks[ d ] = ( region.GetSize()[ d ] + blockSize - 1 ) / blockSize;
+    blockStride[ d ] = d == 0 ? 1 : blockStride[ d - 1 ] * numberOfBlocks[ d - 1 ];
+  }
+  std::vector<KeyType> keys( numberOfPoints );
+  for( std::size_t j = 0; j < numberOfPoints; ++j )
+  {
+    unsigned long long key = 0;
+    for( unsigned int d = 0; d < D; ++d )
+    {
+      const double offset = continuousIndices[ j * D + d ] - region.GetIndex()[ d ];
+      key += blockStride[ d ] * static_cast<unsigned long long>( offset / blockSize );
+    }
+    keys[ j ] = KeyType( key, j );
+  }
+  std::sort( keys.begin(), keys.end() );
+  std::vector<std::size_t> order( numberOfPoints );
+  for( std::size_t k = 0; k < numberOfPoints; ++k )
+  {
+    order[ k ] = keys[ k ].second;
+  }
+
+  /** The number of slabs, from the bounding box of all points, which is
+   * what is read without streaming.
+   */
+  std::vector<double> minimum( D, itk::NumericTraits<double>::max() );
+  std::vector<double> maximum( D, itk::NumericTraits<double>::NonpositiveMin() );
+  for( std::size_t j = 0; j < numberOfPoints; ++j )
+  {
+    for( unsigned int d = 0; d < D; ++d )
+    {
+      minimum[ d ] = std::min( minimum[ d ], continuousIndices[ j * D + d ] );
+      maximum[ d ] = std::max( maximum[ d ], continuousIndices[ j * D + d ] );
+    }
+  }
+  double boundingBoxSize = numberOfPoints > 0 ? 1.0 : 0.0;
+  for( unsigned int d = 0; d < D && numberOfPoints > 0; ++d )
+  {
+    boundingBoxSize *= std::floor( maximum[ d ] ) - std::floor( minimum[ d ] ) + 2.0;
+  }
+  const double sizeInMB = boundingBoxSize * D * sizeof( float ) / 1048576.0;
+
+  const unsigned int lastDimension = VDimension - 1;
+  const unsigned long long numberOfLayers = numberOfBlocks[ lastDimension ];
+  unsigned int numberOfSlabs = this->GetNumberOfStreams( sizeInMB );
+  if( numberOfSlabs < 1 ) numberOfSlabs = 1;
+  if( numberOfSlabs > numberOfLayers )
+  {
+    numberOfSlabs = static_cast<unsigned int>( numberOfLayers );
+  }
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  TransformPointsStruct data;
+  data.m_Order = numberOfPoints > 0 ? &order[ 0 ] : 0;
+  data.m_ContinuousIndices = numberOfPoints > 0 ? &continuousIndices[ 0 ] : 0;
+  data.m_Points = numberOfPoints > 0 ? &points[ 0 ] : 0;
+  threader->SetSingleMethod( TransformPointsThreaderCallback, &data );
+
+  for( unsigned int s = 0; s < numberOfSlabs && numberOfPoints > 0; ++s )
+  {
+    /** The points in the layers of blocks of this slab. */
+    const unsigned long long firstKey
+      = blockStride[ lastDimension ] * ( numberOfLayers * s / numberOfSlabs );
+    const unsigned long long endKey
+      = blockStride[ lastDimension ] * ( numberOfLayers * ( s + 1 ) / numberOfSlabs );
+    data.m_Begin = std::lower_bound( keys.begin(), keys.end(),
+      KeyType( firstKey, 0 ) ) - keys.begin();
+    data.m_End = std::lower_bound( keys.begin(), keys.end(),
+      KeyType( endKey, 0 ) ) - keys.begin();
+    if( data.m_Begin == data.m_End ) continue;
+
+    /** The region of the field around these points. */
+    std::vector<double> slabMinimum( D, itk::NumericTraits<double>::max() );
+    std::vector<double> slabMaximum( D, itk::NumericTraits<double>::NonpositiveMin() );
+    for( std::size_t k = data.m_Begin; k < data.m_End; ++k )
+    {
+      const double * c = &continuousIndices[ order[ k ] * D ];
+      for( unsigned int d = 0; d < D; ++d )
+      {
+        slabMinimum[ d ] = std::min( slabMinimum[ d ], c[ d ] );
+        slabMaximum[ d ] = std::max( slabMaximum[ d ], c[ d ] );
+      }
+    }
+    IndexType reachedIndex;
+    SizeType reachedSize;
+    for( unsigned int d = 0; d < D; ++d )
+    {
+      const itk::OffsetValueType lastIndex = region.GetIndex()[ d ]
+        + static_cast<itk::OffsetValueType>( region.GetSize()[ d ] ) - 1;
+      reachedIndex[ d ] = static_cast<itk::OffsetValueType>( std::floor( slabMinimum[ d ] ) );
+      const itk::OffsetValueType reachedLast = std::min( lastIndex,
+        static_cast<itk::OffsetValueType>( std::floor( slabMaximum[ d ] ) ) + 1 );
+      reachedSize[ d ] = reachedLast - reachedIndex[ d ] + 1;
+    }
+    const RegionType reached( reachedIndex, reachedSize );
+    if( numberOfSlabs > 1 )
+    {
+      std::cout << "Processing slab " << s + 1 << " of " << numberOfSlabs
+        << ", " << data.m_End - data.m_Begin << " points" << std::endl;
+    }
+
+    /** Read that region of the field, and add its displacements. */
+    FloatVectorImagePointer fieldRegion = ReadFieldRegion( this->m_InputFileName, reached );
+    data.m_FieldBufferedRegion = fieldRegion->GetBufferedRegion();
+    data.m_Field = reinterpret_cast<const float *>( fieldRegion->GetBufferPointer() );
+    threader->SingleMethodExecute();
+  }
+
+  /** Write the points in the order of the input, in world coordinates, in
+   * the format of the input point file, so that the output can be read by
+   * the tools that read input point files.
+   */
+  std::cout << "Writing the output points to " << this->m_OutputFileName << std::endl;
+  std::ofstream output( this->m_OutputFileName.c_str(), std::ios::out | std::ios::binary );
+  if( !output.is_open() )
+  {
+    itkGenericExceptionMacro( << "ERROR: Unable to open " << this->m_OutputFileName << " for writing." );
+  }
+  output.imbue( std::locale::classic() );
+  if( isBinary )
+  {
+    output << "binary point " << numberOfPoints << "\n";
+    if( numberOfPoints > 0 )
+    {
+      output.write( reinterpret_cast<const char *>( &points[ 0 ] ),
+        numberOfPoints * D * sizeof( double ) );
+    }
+  }
+  else
+  {
+    output << "point\n" << numberOfPoints << "\n";
+    output << std::setprecision( std::numeric_limits<double>::digits10 + 2 );
+    for( std::size_t j = 0; j < numberOfPoints; ++j )
+    {
+      for( unsigned int d = 0; d < D; ++d )
+      {
+        output << ( d == 0 ? "" : " " ) << points[ j * D + d ];
+      }
+      output << "\n";
+    }
+  }
+  if( !output.good() )
+  {
+    itkGenericExceptionMacro( << "ERROR: Unable to write " << this->m_OutputFileName << "." );
+  }
+
+} // end ComputeTransformedPoints()
+
+
 #endif // end #ifndef __deformationfieldoperator_h_
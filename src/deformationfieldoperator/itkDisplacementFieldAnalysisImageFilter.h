@@ -0,0 +1,168 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkDisplacementFieldAnalysisImageFilter_h_
+#define __itkDisplacementFieldAnalysisImageFilter_h_
+
+#include "itkImageToImageFilter.h"
+#include <vector>
+
+
+namespace itk
+{
+
+/** \class DisplacementFieldAnalysisImageFilter
+ * \brief Compute the magnitude and the Jacobian determinant of a
+ * displacement field, and their statistics, in one pass.
+ *
+ * Output 0 is the magnitude |v(x)| and output 1 the determinant of
+ * I + dv/dx. The derivatives are central differences in physical units,
+ * using the spacing but not the direction, and the field is extended
+ * with its border values, as in the DisplacementFieldJacobianDeterminantFilter
+ * with UseImageSpacing on. The outputs are only allocated when they are
+ * requested with SetComputeMagnitude() and SetComputeJacobian().
+ *
+ * Both are computed from one traversal of the field, in which every
+ * thread also accumulates the minimum, maximum, mean and standard
+ * deviation of both, and the number of folds, the voxels where the
+ * determinant is not positive. The statistics are always computed.
+ *
+ * \ingroup ImageToImageFilter MultiThreaded
+ */
+
+template< class TInputImage, class TOutputImage >
+class ITK_EXPORT DisplacementFieldAnalysisImageFilter :
+  public ImageToImageFilter< TInputImage, TOutputImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef DisplacementFieldAnalysisImageFilter            Self;
+  typedef ImageToImageFilter< TInputImage, TOutputImage > Superclass;
+  typedef SmartPointer<Self>                              Pointer;
+  typedef SmartPointer<const Self>                        ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( DisplacementFieldAnalysisImageFilter, ImageToImageFilter );
+
+  itkStaticConstMacro( ImageDimension, unsigned int, TInputImage::ImageDimension );
+
+  /** Typedefs. */
+  typedef TInputImage                                 InputImageType;
+  typedef typename InputImageType::PixelType          InputPixelType;
+  typedef typename InputPixelType::ValueType          InputComponentType;
+  typedef TOutputImage                                OutputImageType;
+  typedef typename OutputImageType::PixelType         OutputPixelType;
+  typedef typename Superclass::OutputImageRegionType  OutputImageRegionType;
+
+  /** Select the outputs to compute. Both are off by default. */
+  itkSetMacro( ComputeMagnitude, bool );
+  itkGetConstMacro( ComputeMagnitude, bool );
+  itkBooleanMacro( ComputeMagnitude );
+  itkSetMacro( ComputeJacobian, bool );
+  itkGetConstMacro( ComputeJacobian, bool );
+  itkBooleanMacro( ComputeJacobian );
+
+  /** Get the outputs. */
+  OutputImageType * GetMagnitudeOutput( void ) { return this->GetOutput( 0 ); }
+  OutputImageType * GetJacobianOutput( void ) { return this->GetOutput( 1 ); }
+
+  /** The statistics of the magnitude or the Jacobian determinant. */
+  struct StatisticsType
+  {
+    double Minimum;
+    double Maximum;
+    double Mean;
+    double Sigma;
+  };
+
+  /** Get the results. */
+  const StatisticsType & GetMagnitudeStatistics( void ) const
+  {
+    return this->m_MagnitudeStatistics;
+  }
+  const StatisticsType & GetJacobianStatistics( void ) const
+  {
+    return this->m_JacobianStatistics;
+  }
+  itkGetConstMacro( NumberOfFolds, SizeValueType );
+
+protected:
+  DisplacementFieldAnalysisImageFilter();
+  virtual ~DisplacementFieldAnalysisImageFilter() {};
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** The filter needs all of its input, and produces all of its output. */
+  virtual void GenerateInputRequestedRegion( void );
+  virtual void EnlargeOutputRequestedRegion( DataObject * data );
+
+  /** Allocate the requested outputs only. */
+  virtual void AllocateOutputs( void );
+
+  /** Initialize and merge the partial results of the threads. */
+  virtual void BeforeThreadedGenerateData( void );
+  virtual void AfterThreadedGenerateData( void );
+
+  /** Analyse the lines of the region of a thread. */
+  void ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+    ThreadIdType threadId );
+
+private:
+  DisplacementFieldAnalysisImageFilter( const Self & ); // purposely not implemented
+  void operator=( const Self & );                       // purposely not implemented
+
+  /** The partial sums of one quantity of one thread. */
+  struct AccumulatorType
+  {
+    double Minimum;
+    double Maximum;
+    double Sum;
+    double SumOfSquares;
+  };
+
+  /** The partial results of one thread. */
+  struct PartialType
+  {
+    AccumulatorType Magnitude;
+    AccumulatorType Jacobian;
+    SizeValueType   NumberOfFolds;
+  };
+
+  /** The statistics of the accumulators of all threads. */
+  static StatisticsType MergeAccumulators(
+    const std::vector<AccumulatorType> & accumulators, double numberOfPixels );
+
+  bool  m_ComputeMagnitude;
+  bool  m_ComputeJacobian;
+
+  std::vector< PartialType >  m_ThreadPartials;
+
+  StatisticsType  m_MagnitudeStatistics;
+  StatisticsType  m_JacobianStatistics;
+  SizeValueType   m_NumberOfFolds;
+
+}; // end class DisplacementFieldAnalysisImageFilter
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkDisplacementFieldAnalysisImageFilter.txx"
+#endif
+
+#endif // end #ifndef __itkDisplacementFieldAnalysisImageFilter_h_
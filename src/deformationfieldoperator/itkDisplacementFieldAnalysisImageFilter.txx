@@ -0,0 +1,323 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkDisplacementFieldAnalysisImageFilter_txx_
+#define __itkDisplacementFieldAnalysisImageFilter_txx_
+
+#include "itkDisplacementFieldAnalysisImageFilter.h"
+#include "itkImageLinearConstIteratorWithIndex.h"
+#include "itkNumericTraits.h"
+#include "itkProgressReporter.h"
+#include "vnl/vnl_det.h"
+#include "vnl/vnl_matrix_fixed.h"
+
+#include <cmath>
+
+namespace itk
+{
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+DisplacementFieldAnalysisImageFilter< TInputImage, TOutputImage >
+::DisplacementFieldAnalysisImageFilter()
+{
+  this->SetNumberOfRequiredOutputs( 2 );
+  this->SetNthOutput( 0, this->MakeOutput( 0 ) );
+  this->SetNthOutput( 1, this->MakeOutput( 1 ) );
+
+  this->m_ComputeMagnitude = false;
+  this->m_ComputeJacobian = false;
+  this->m_NumberOfFolds = 0;
+
+  StatisticsType zero = { 0.0, 0.0, 0.0, 0.0 };
+  this->m_MagnitudeStatistics = zero;
+  this->m_JacobianStatistics = zero;
+
+} // end Constructor
+
+
+/**
+ * ******************* GenerateInputRequestedRegion *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+DisplacementFieldAnalysisImageFilter< TInputImage, TOutputImage >
+::GenerateInputRequestedRegion( void )
+{
+  Superclass::GenerateInputRequestedRegion();
+  if( this->GetInput() )
+  {
+    InputImageType * input = const_cast< InputImageType * >( this->GetInput() );
+    input->SetRequestedRegionToLargestPossibleRegion();
+  }
+
+} // end GenerateInputRequestedRegion()
+
+
+/**
+ * ******************* EnlargeOutputRequestedRegion *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+DisplacementFieldAnalysisImageFilter< TInputImage, TOutputImage >
+::EnlargeOutputRequestedRegion( DataObject * data )
+{
+  Superclass::EnlargeOutputRequestedRegion( data );
+  data->SetRequestedRegionToLargestPossibleRegion();
+
+} // end EnlargeOutputRequestedRegion()
+
+
+/**
+ * ******************* AllocateOutputs *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+DisplacementFieldAnalysisImageFilter< TInputImage, TOutputImage >
+::AllocateOutputs( void )
+{
+  const bool compute[ 2 ] = { this->m_ComputeMagnitude, this->m_ComputeJacobian };
+  for( unsigned int i = 0; i < 2; ++i )
+  {
+    if( !compute[ i ] ) continue;
+    OutputImageType * output = this->GetOutput( i );
+    output->SetBufferedRegion( output->GetRequestedRegion() );
+    output->Allocate();
+  }
+
+} // end AllocateOutputs()
+
+
+/**
+ * ******************* BeforeThreadedGenerateData *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+DisplacementFieldAnalysisImageFilter< TInputImage, TOutputImage >
+::BeforeThreadedGenerateData( void )
+{
+  AccumulatorType accumulator;
+  accumulator.Minimum = NumericTraits<double>::max();
+  accumulator.Maximum = NumericTraits<double>::NonpositiveMin();
+  accumulator.Sum = 0.0;
+  accumulator.SumOfSquares = 0.0;
+
+  PartialType partial;
+  partial.Magnitude = accumulator;
+  partial.Jacobian = accumulator;
+  partial.NumberOfFolds = 0;
+
+  this->m_ThreadPartials.assign( this->GetNumberOfThreads(), partial );
+
+} // end BeforeThreadedGenerateData()
+
+
+/**
+ * ******************* ThreadedGenerateData *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+DisplacementFieldAnalysisImageFilter< TInputImage, TOutputImage >
+::ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+  ThreadIdType threadId )
+{
+  typedef vnl_matrix_fixed< double,
+    itkGetStaticConstMacro( ImageDimension ),
+    itkGetStaticConstMacro( ImageDimension ) >        JacobianType;
+
+  const unsigned int D = ImageDimension;
+  const InputImageType * input = this->GetInput();
+  const typename InputImageType::SizeType size
+    = input->GetBufferedRegion().GetSize();
+  const typename InputImageType::IndexType bufferStart
+    = input->GetBufferedRegion().GetIndex();
+  const InputComponentType * field
+    = reinterpret_cast<const InputComponentType *>( input->GetBufferPointer() );
+  OutputPixelType * magnitudeBuffer = this->m_ComputeMagnitude
+    ? this->GetOutput( 0 )->GetBufferPointer() : 0;
+  OutputPixelType * jacobianBuffer = this->m_ComputeJacobian
+    ? this->GetOutput( 1 )->GetBufferPointer() : 0;
+
+  /** The strides of the field in voxels, and the central difference
+   * factors 1 / ( 2 spacing ). */
+  OffsetValueType stride[ ImageDimension ];
+  double factor[ ImageDimension ];
+  stride[ 0 ] = 1;
+  for( unsigned int d = 0; d < D; ++d )
+  {
+    if( d > 0 ) stride[ d ] = stride[ d - 1 ] * size[ d - 1 ];
+    factor[ d ] = 0.5 / input->GetSpacing()[ d ];
+  }
+
+  PartialType partial = this->m_ThreadPartials[ threadId ];
+  const SizeValueType lineLength = outputRegionForThread.GetSize()[ 0 ];
+  ProgressReporter progress( this, threadId,
+    outputRegionForThread.GetNumberOfPixels() / lineLength );
+
+  typedef ImageLinearConstIteratorWithIndex< InputImageType > IteratorType;
+  IteratorType it( input, outputRegionForThread );
+  it.SetDirection( 0 );
+  it.GoToBegin();
+
+  while( !it.IsAtEnd() )
+  {
+    typename InputImageType::IndexType index = it.GetIndex();
+    OffsetValueType k = input->ComputeOffset( index );
+    for( SizeValueType i = 0; i < lineLength; ++i, ++k, ++index[ 0 ] )
+    {
+      const InputComponentType * v = field + k * D;
+
+      /** The magnitude. */
+      double squaredMagnitude = 0.0;
+      for( unsigned int c = 0; c < D; ++c )
+      {
+        squaredMagnitude += static_cast<double>( v[ c ] ) * v[ c ];
+      }
+      const double magnitude = std::sqrt( squaredMagnitude );
+
+      /** The Jacobian I + dv/dx, with the border values repeated. */
+      JacobianType jacobian;
+      jacobian.set_identity();
+      for( unsigned int d = 0; d < D; ++d )
+      {
+        const OffsetValueType position = index[ d ] - bufferStart[ d ];
+        const OffsetValueType plus
+          = position + 1 < static_cast<OffsetValueType>( size[ d ] ) ? stride[ d ] : 0;
+        const OffsetValueType minus = position > 0 ? stride[ d ] : 0;
+        const InputComponentType * vp = field + ( k + plus ) * D;
+        const InputComponentType * vm = field + ( k - minus ) * D;
+        for( unsigned int c = 0; c < D; ++c )
+        {
+          jacobian( c, d ) += ( static_cast<double>( vp[ c ] ) - vm[ c ] ) * factor[ d ];
+        }
+      }
+      const double determinant = vnl_det( jacobian );
+
+      if( magnitudeBuffer ) magnitudeBuffer[ k ] = static_cast<OutputPixelType>( magnitude );
+      if( jacobianBuffer ) jacobianBuffer[ k ] = static_cast<OutputPixelType>( determinant );
+
+      /** The statistics. */
+      if( magnitude < partial.Magnitude.Minimum ) partial.Magnitude.Minimum = magnitude;
+      if( magnitude > partial.Magnitude.Maximum ) partial.Magnitude.Maximum = magnitude;
+      partial.Magnitude.Sum += magnitude;
+      partial.Magnitude.SumOfSquares += squaredMagnitude;
+      if( determinant < partial.Jacobian.Minimum ) partial.Jacobian.Minimum = determinant;
+      if( determinant > partial.Jacobian.Maximum ) partial.Jacobian.Maximum = determinant;
+      partial.Jacobian.Sum += determinant;
+      partial.Jacobian.SumOfSquares += determinant * determinant;
+      if( determinant <= 0.0 ) ++partial.NumberOfFolds;
+    }
+
+    progress.CompletedPixel();
+    it.NextLine();
+  }
+
+  this->m_ThreadPartials[ threadId ] = partial;
+
+} // end ThreadedGenerateData()
+
+
+/**
+ * ******************* AfterThreadedGenerateData *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+DisplacementFieldAnalysisImageFilter< TInputImage, TOutputImage >
+::AfterThreadedGenerateData( void )
+{
+  std::vector<AccumulatorType> magnitudes;
+  std::vector<AccumulatorType> jacobians;
+  this->m_NumberOfFolds = 0;
+  for( std::size_t t = 0; t < this->m_ThreadPartials.size(); ++t )
+  {
+    magnitudes.push_back( this->m_ThreadPartials[ t ].Magnitude );
+    jacobians.push_back( this->m_ThreadPartials[ t ].Jacobian );
+    this->m_NumberOfFolds += this->m_ThreadPartials[ t ].NumberOfFolds;
+  }
+
+  const double numberOfPixels = static_cast<double>(
+    this->GetInput()->GetBufferedRegion().GetNumberOfPixels() );
+  this->m_MagnitudeStatistics = MergeAccumulators( magnitudes, numberOfPixels );
+  this->m_JacobianStatistics = MergeAccumulators( jacobians, numberOfPixels );
+
+} // end AfterThreadedGenerateData()
+
+
+/**
+ * ******************* MergeAccumulators *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+typename DisplacementFieldAnalysisImageFilter< TInputImage, TOutputImage >::StatisticsType
+DisplacementFieldAnalysisImageFilter< TInputImage, TOutputImage >
+::MergeAccumulators( const std::vector<AccumulatorType> & accumulators,
+  double numberOfPixels )
+{
+  AccumulatorType total = accumulators[ 0 ];
+  for( std::size_t t = 1; t < accumulators.size(); ++t )
+  {
+    if( accumulators[ t ].Minimum < total.Minimum ) total.Minimum = accumulators[ t ].Minimum;
+    if( accumulators[ t ].Maximum > total.Maximum ) total.Maximum = accumulators[ t ].Maximum;
+    total.Sum += accumulators[ t ].Sum;
+    total.SumOfSquares += accumulators[ t ].SumOfSquares;
+  }
+
+  StatisticsType statistics;
+  statistics.Minimum = total.Minimum;
+  statistics.Maximum = total.Maximum;
+  statistics.Mean = total.Sum / numberOfPixels;
+  statistics.Sigma = 0.0;
+  if( numberOfPixels > 1.0 )
+  {
+    const double variance = ( total.SumOfSquares - total.Sum * statistics.Mean )
+      / ( numberOfPixels - 1.0 );
+    if( variance > 0.0 ) statistics.Sigma = std::sqrt( variance );
+  }
+  return statistics;
+
+} // end MergeAccumulators()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+DisplacementFieldAnalysisImageFilter< TInputImage, TOutputImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "ComputeMagnitude: " << this->m_ComputeMagnitude << std::endl;
+  os << indent << "ComputeJacobian: " << this->m_ComputeJacobian << std::endl;
+  os << indent << "NumberOfFolds: " << this->m_NumberOfFolds << std::endl;
+
+} // end PrintSelf()
+
+} // end namespace itk
+
+#endif // end #ifndef __itkDisplacementFieldAnalysisImageFilter_txx_
@@ -0,0 +1,157 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkFixedPointInverseDisplacementFieldImageFilter_h_
+#define __itkFixedPointInverseDisplacementFieldImageFilter_h_
+
+#include "itkImageToImageFilter.h"
+#include "itkMatrix.h"
+#include <vector>
+
+
+namespace itk
+{
+
+/** \class FixedPointInverseDisplacementFieldImageFilter
+ * \brief Invert a displacement field by fixed point iteration.
+ *
+ * The inverse u of a displacement field v satisfies u(x) = -v( x + u(x) ).
+ * Starting from u_0(x) = -v(x), the filter iterates
+ *   u_{k+1}(x) = -v( x + u_k(x) ),
+ * with v linearly interpolated, and clamped to the border of the field.
+ * An iteration is a single threaded pass over all voxels: the new estimate
+ * of a voxel only depends on the previous estimate of that voxel, so the
+ * voxels are independent, and the result does not depend on the number of
+ * threads.
+ *
+ * The error of a voxel is the length of the change |u_{k+1}(x) - u_k(x)|,
+ * which is the residual |u_k(x) + v( x + u_k(x) )| of the previous estimate.
+ * The mean and the maximum error of every iteration are stored, and an
+ * IterationEvent is invoked after every iteration. The iteration stops
+ * after NumberOfIterations iterations, or as soon as the maximum error is
+ * not larger than StopValue. The iteration converges if the field is
+ * locally contracting, i.e. if the displacement gradient is smaller than 1.
+ *
+ * The filter needs its complete input, and generates its complete output.
+ *
+ * \ingroup ImageToImageFilter MultiThreaded
+ */
+
+template< class TInputImage, class TOutputImage >
+class ITK_EXPORT FixedPointInverseDisplacementFieldImageFilter :
+  public ImageToImageFilter< TInputImage, TOutputImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef FixedPointInverseDisplacementFieldImageFilter   Self;
+  typedef ImageToImageFilter< TInputImage, TOutputImage > Superclass;
+  typedef SmartPointer<Self>                              Pointer;
+  typedef SmartPointer<const Self>                        ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( FixedPointInverseDisplacementFieldImageFilter, ImageToImageFilter );
+
+  itkStaticConstMacro( ImageDimension, unsigned int, TInputImage::ImageDimension );
+
+  /** Typedefs. */
+  typedef TInputImage                                 InputImageType;
+  typedef typename InputImageType::PixelType          InputPixelType;
+  typedef typename InputPixelType::ValueType          InputComponentType;
+  typedef TOutputImage                                OutputImageType;
+  typedef typename OutputImageType::Pointer           OutputImagePointer;
+  typedef typename OutputImageType::PixelType         OutputPixelType;
+  typedef typename OutputPixelType::ValueType         OutputComponentType;
+  typedef typename OutputImageType::SizeType          SizeType;
+  typedef Matrix< double,
+    itkGetStaticConstMacro( ImageDimension ),
+    itkGetStaticConstMacro( ImageDimension ) >        MatrixType;
+
+  /** Set/Get the maximum number of iterations after the initial estimate.
+   * Default 5. */
+  itkSetMacro( NumberOfIterations, unsigned int );
+  itkGetConstMacro( NumberOfIterations, unsigned int );
+
+  /** Set/Get the maximum error at which the iteration stops. Default 0. */
+  itkSetMacro( StopValue, double );
+  itkGetConstMacro( StopValue, double );
+
+  /** Get the number of iterations that were done. */
+  itkGetConstMacro( ElapsedIterations, unsigned int );
+
+  /** Get the mean and the maximum error of every iteration. */
+  const std::vector<double> & GetMeanErrors( void ) const { return this->m_MeanErrors; }
+  const std::vector<double> & GetMaximumErrors( void ) const { return this->m_MaximumErrors; }
+
+protected:
+  FixedPointInverseDisplacementFieldImageFilter();
+  virtual ~FixedPointInverseDisplacementFieldImageFilter() {};
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** The filter needs all of its input, and produces all of its output. */
+  virtual void GenerateInputRequestedRegion( void );
+  virtual void EnlargeOutputRequestedRegion( DataObject * data );
+
+  /** Run the iterations. */
+  virtual void GenerateData( void );
+
+  /** The arguments of the threads of one iteration. */
+  struct IterateStruct
+  {
+    const Self *                  m_Filter;
+    const InputComponentType *    m_Field;
+    const OutputComponentType *   m_Current;
+    OutputComponentType *         m_Next;
+    std::vector<double>           m_SumOfErrors;
+    std::vector<double>           m_MaximumError;
+  };
+
+  /** Thread callback of one iteration: every thread updates a contiguous
+   * range of voxels. */
+  static ITK_THREAD_RETURN_TYPE IterateThreaderCallback( void * arg );
+
+  /** Compute the next estimate of the voxels [begin, end). With a null
+   * current estimate the initial estimate -v(x) is computed. */
+  void IterateRange( std::size_t begin, std::size_t end,
+    const InputComponentType * field, const OutputComponentType * current,
+    OutputComponentType * next, double & sumOfErrors, double & maximumError ) const;
+
+private:
+  FixedPointInverseDisplacementFieldImageFilter( const Self & ); // purposely not implemented
+  void operator=( const Self & );                                // purposely not implemented
+
+  unsigned int        m_NumberOfIterations;
+  double              m_StopValue;
+  unsigned int        m_ElapsedIterations;
+  std::vector<double> m_MeanErrors;
+  std::vector<double> m_MaximumErrors;
+
+  /** The physical to index matrix, and the size of the field. */
+  MatrixType          m_PhysicalToIndex;
+  SizeType            m_Size;
+
+}; // end class FixedPointInverseDisplacementFieldImageFilter
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkFixedPointInverseDisplacementFieldImageFilter.txx"
+#endif
+
+#endif // end #ifndef __itkFixedPointInverseDisplacementFieldImageFilter_h_
@@ -0,0 +1,358 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkFixedPointInverseDisplacementFieldImageFilter_txx_
+#define __itkFixedPointInverseDisplacementFieldImageFilter_txx_
+
+#include "itkFixedPointInverseDisplacementFieldImageFilter.h"
+#include "itkMultiThreader.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk
+{
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+FixedPointInverseDisplacementFieldImageFilter< TInputImage, TOutputImage >
+::FixedPointInverseDisplacementFieldImageFilter()
+{
+  this->m_NumberOfIterations = 5;
+  this->m_StopValue = 0.0;
+  this->m_ElapsedIterations = 0;
+  this->m_PhysicalToIndex.SetIdentity();
+  this->m_Size.Fill( 0 );
+
+} // end Constructor
+
+
+/**
+ * ******************* GenerateInputRequestedRegion *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+FixedPointInverseDisplacementFieldImageFilter< TInputImage, TOutputImage >
+::GenerateInputRequestedRegion( void )
+{
+  Superclass::GenerateInputRequestedRegion();
+  if( this->GetInput() )
+  {
+    InputImageType * input = const_cast< InputImageType * >( this->GetInput() );
+    input->SetRequestedRegionToLargestPossibleRegion();
+  }
+
+} // end GenerateInputRequestedRegion()
+
+
+/**
+ * ******************* EnlargeOutputRequestedRegion *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+FixedPointInverseDisplacementFieldImageFilter< TInputImage, TOutputImage >
+::EnlargeOutputRequestedRegion( DataObject * data )
+{
+  Superclass::EnlargeOutputRequestedRegion( data );
+  data->SetRequestedRegionToLargestPossibleRegion();
+
+} // end EnlargeOutputRequestedRegion()
+
+
+/**
+ * ******************* GenerateData *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+FixedPointInverseDisplacementFieldImageFilter< TInputImage, TOutputImage >
+::GenerateData( void )
+{
+  this->AllocateOutputs();
+
+  const InputImageType * input = this->GetInput();
+  OutputImageType * output = this->GetOutput();
+  const unsigned int D = ImageDimension;
+
+  /** A displacement in physical space is a displacement of
+   * spacing^-1 direction^-1 in index space. */
+  this->m_Size = input->GetBufferedRegion().GetSize();
+  const typename InputImageType::DirectionType & inverseDirection
+    = input->GetInverseDirection();
+  for( unsigned int i = 0; i < D; ++i )
+  {
+    for( unsigned int j = 0; j < D; ++j )
+    {
+      this->m_PhysicalToIndex[ i ][ j ] = inverseDirection[ i ][ j ] / input->GetSpacing()[ i ];
+    }
+  }
+
+  const std::size_t numberOfVoxels = input->GetBufferedRegion().GetNumberOfPixels();
+  const InputComponentType * field
+    = reinterpret_cast<const InputComponentType *>( input->GetBufferPointer() );
+  OutputComponentType * result
+    = reinterpret_cast<OutputComponentType *>( output->GetBufferPointer() );
+
+  /** The estimates alternate between the output and a second buffer. */
+  std::vector<OutputComponentType> buffer( numberOfVoxels * D );
+  OutputComponentType * current = result;
+  OutputComponentType * next = &buffer[ 0 ];
+
+  IterateStruct data;
+  data.m_Filter = this;
+  data.m_Field = field;
+  data.m_SumOfErrors.resize( this->GetNumberOfThreads() );
+  data.m_MaximumError.resize( this->GetNumberOfThreads() );
+
+  MultiThreader * threader = this->GetMultiThreader();
+  threader->SetNumberOfThreads( this->GetNumberOfThreads() );
+  threader->SetSingleMethod( IterateThreaderCallback, &data );
+
+  /** The initial estimate -v(x), in the output. */
+  data.m_Current = 0;
+  data.m_Next = current;
+  threader->SingleMethodExecute();
+
+  this->m_ElapsedIterations = 0;
+  this->m_MeanErrors.clear();
+  this->m_MaximumErrors.clear();
+  for( unsigned int k = 0; k < this->m_NumberOfIterations; ++k )
+  {
+    std::fill( data.m_SumOfErrors.begin(), data.m_SumOfErrors.end(), 0.0 );
+    std::fill( data.m_MaximumError.begin(), data.m_MaximumError.end(), 0.0 );
+    data.m_Current = current;
+    data.m_Next = next;
+    threader->SingleMethodExecute();
+    std::swap( current, next );
+
+    /** Merge the errors of the threads. */
+    double sumOfErrors = 0.0;
+    double maximumError = 0.0;
+    for( std::size_t t = 0; t < data.m_SumOfErrors.size(); ++t )
+    {
+      sumOfErrors += data.m_SumOfErrors[ t ];
+      maximumError = std::max( maximumError, data.m_MaximumError[ t ] );
+    }
+    this->m_MeanErrors.push_back( sumOfErrors / static_cast<double>( numberOfVoxels ) );
+    this->m_MaximumErrors.push_back( maximumError );
+    ++this->m_ElapsedIterations;
+
+    this->UpdateProgress( static_cast<float>( k + 1 ) / this->m_NumberOfIterations );
+    this->InvokeEvent( IterationEvent() );
+    if( this->GetAbortGenerateData() )
+    {
+      ProcessAborted e( __FILE__, __LINE__ );
+      e.SetDescription( "Process aborted." );
+      e.SetLocation( ITK_LOCATION );
+      throw e;
+    }
+    if( maximumError <= this->m_StopValue ) break;
+  }
+
+  /** The last estimate may be in the second buffer. */
+  if( current != result )
+  {
+    std::copy( current, current + numberOfVoxels * D, result );
+  }
+
+} // end GenerateData()
+
+
+/**
+ * ******************* IterateThreaderCallback *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+ITK_THREAD_RETURN_TYPE
+FixedPointInverseDisplacementFieldImageFilter< TInputImage, TOutputImage >
+::IterateThreaderCallback( void * arg )
+{
+  MultiThreader::ThreadInfoStruct * info
+    = static_cast<MultiThreader::ThreadInfoStruct *>( arg );
+  IterateStruct * data = static_cast<IterateStruct *>( info->UserData );
+
+  const std::size_t numberOfVoxels
+    = data->m_Filter->GetInput()->GetBufferedRegion().GetNumberOfPixels();
+  const std::size_t begin = numberOfVoxels * info->ThreadID / info->NumberOfThreads;
+  const std::size_t end = numberOfVoxels * ( info->ThreadID + 1 ) / info->NumberOfThreads;
+
+  data->m_Filter->IterateRange( begin, end, data->m_Field, data->m_Current,
+    data->m_Next, data->m_SumOfErrors[ info->ThreadID ],
+    data->m_MaximumError[ info->ThreadID ] );
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end IterateThreaderCallback()
+
+
+/**
+ * ******************* IterateRange *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+FixedPointInverseDisplacementFieldImageFilter< TInputImage, TOutputImage >
+::IterateRange( std::size_t begin, std::size_t end,
+  const InputComponentType * field, const OutputComponentType * current,
+  OutputComponentType * next, double & sumOfErrors, double & maximumError ) const
+{
+  const unsigned int D = ImageDimension;
+  const unsigned int numberOfCorners = 1u << D;
+
+  /** The strides of the field, in voxels. */
+  std::size_t stride[ ImageDimension ];
+  stride[ 0 ] = 1;
+  for( unsigned int d = 1; d < D; ++d )
+  {
+    stride[ d ] = stride[ d - 1 ] * this->m_Size[ d - 1 ];
+  }
+
+  /** The index of the first voxel. */
+  std::size_t index[ ImageDimension ];
+  std::size_t rest = begin;
+  for( unsigned int d = D; d > 0; --d )
+  {
+    index[ d - 1 ] = rest / stride[ d - 1 ];
+    rest -= index[ d - 1 ] * stride[ d - 1 ];
+  }
+
+  double localSum = 0.0;
+  double localMaximum = 0.0;
+  for( std::size_t k = begin; k < end; ++k )
+  {
+    /** The continuous index of x + u(x). */
+    double c[ ImageDimension ];
+    for( unsigned int d = 0; d < D; ++d )
+    {
+      c[ d ] = static_cast<double>( index[ d ] );
+      if( current )
+      {
+        for( unsigned int e = 0; e < D; ++e )
+        {
+          c[ d ] += this->m_PhysicalToIndex[ d ][ e ] * current[ k * D + e ];
+        }
+      }
+    }
+
+    /** The base corner, the fractions, and the steps to the next corner,
+     * clamped to the field. */
+    std::size_t baseOffset = 0;
+    double fraction[ ImageDimension ];
+    std::size_t step[ ImageDimension ];
+    for( unsigned int d = 0; d < D; ++d )
+    {
+      const double last = static_cast<double>( this->m_Size[ d ] - 1 );
+      const double cd = c[ d ] < 0.0 ? 0.0 : ( c[ d ] > last ? last : c[ d ] );
+      std::size_t base = static_cast<std::size_t>( cd );
+      fraction[ d ] = cd - static_cast<double>( base );
+      step[ d ] = stride[ d ];
+      if( base + 1 >= this->m_Size[ d ] )
+      {
+        base = this->m_Size[ d ] - 1;
+        fraction[ d ] = 0.0;
+        step[ d ] = 0;
+      }
+      baseOffset += base * stride[ d ];
+    }
+
+    /** Interpolate the field linearly. */
+    double value[ ImageDimension ];
+    for( unsigned int d = 0; d < D; ++d ) value[ d ] = 0.0;
+    for( unsigned int corner = 0; corner < numberOfCorners; ++corner )
+    {
+      double weight = 1.0;
+      std::size_t offset = baseOffset;
+      for( unsigned int d = 0; d < D; ++d )
+      {
+        if( corner & ( 1u << d ) )
+        {
+          weight *= fraction[ d ];
+          offset += step[ d ];
+        }
+        else
+        {
+          weight *= 1.0 - fraction[ d ];
+        }
+      }
+      if( weight == 0.0 ) continue;
+      const InputComponentType * v = field + offset * D;
+      for( unsigned int d = 0; d < D; ++d )
+      {
+        value[ d ] += weight * static_cast<double>( v[ d ] );
+      }
+    }
+
+    /** The next estimate, and its change. */
+    double error = 0.0;
+    for( unsigned int d = 0; d < D; ++d )
+    {
+      const OutputComponentType u = static_cast<OutputComponentType>( -value[ d ] );
+      if( current )
+      {
+        const double change = static_cast<double>( u ) - static_cast<double>( current[ k * D + d ] );
+        error += change * change;
+      }
+      next[ k * D + d ] = u;
+    }
+    error = std::sqrt( error );
+    localSum += error;
+    if( error > localMaximum ) localMaximum = error;
+
+    /** The next index, first dimension fastest. */
+    for( unsigned int d = 0; d < D; ++d )
+    {
+      if( ++index[ d ] < this->m_Size[ d ] ) break;
+      index[ d ] = 0;
+    }
+  }
+
+  sumOfErrors = localSum;
+  maximumError = localMaximum;
+
+} // end IterateRange()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+FixedPointInverseDisplacementFieldImageFilter< TInputImage, TOutputImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "NumberOfIterations: " << this->m_NumberOfIterations << std::endl;
+  os << indent << "StopValue: " << this->m_StopValue << std::endl;
+  os << indent << "ElapsedIterations: " << this->m_ElapsedIterations << std::endl;
+  if( !this->m_MaximumErrors.empty() )
+  {
+    os << indent << "Final mean error: " << this->m_MeanErrors.back() << std::endl;
+    os << indent << "Final maximum error: " << this->m_MaximumErrors.back() << std::endl;
+  }
+
+} // end PrintSelf()
+
+} // end namespace itk
+
+#endif // end #ifndef __itkFixedPointInverseDisplacementFieldImageFilter_txx_
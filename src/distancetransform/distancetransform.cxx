@@ -26,6 +26,7 @@
 
 #include "itkCommandLineArgumentParser.h"
 #include "ITKToolsHelpers.h"
+#include "ITKToolsProgress.h"
 #include "distancetransform.h"
 
 
@@ -45,6 +46,8 @@ std::string GetHelpString( void )
     << "  -out     outputFilename: the output of distance transform\n"
     << "  [-s]     flag: if set, output squared distances instead of distances\n"
     << "  [-m]     method, one of {Maurer, Danielsson, Morphological, MorphologicalSigned}, default Maurer\n"
+    << "  [-maxDistance] distances are saturated at this value, in mm. For the Morphological\n"
+    << "           methods only the band within it is computed, which is faster. Default: no cutoff.\n"
     << "Note: voxel spacing is taken into account. Voxels inside the\n"
     << "object (=1) receive a negative distance.\n"
     << "Supported: 2D/3D. input: unsigned char, output: float";
@@ -80,6 +83,10 @@ int main( int argc, char **argv )
     return EXIT_SUCCESS;
   }
 
+  /** Threading, progress and cancellation. */
+  itktools::ReadThreadingArguments( parser );
+  itktools::ReadProgressArguments( parser );
+
   /** Get the input segmentation file name (mandatory). */
   std::string inputFileName;
   parser->GetCommandLineArgument( "-in", inputFileName );
@@ -99,6 +106,9 @@ int main( int argc, char **argv )
   unsigned int K = 5;
   parser->GetCommandLineArgument( "-k", K );
 
+  double maximumDistance = 0.0;
+  parser->GetCommandLineArgument( "-maxDistance", maximumDistance );
+
   /** Checks. */
   if( method != "Maurer" && method != "Danielsson"
     && method != "Morphological" && method != "MorphologicalSigned" )
@@ -108,6 +118,12 @@ int main( int argc, char **argv )
     return EXIT_FAILURE;
   }
 
+  if( maximumDistance < 0.0 )
+  {
+    std::cerr << "ERROR: -maxDistance should be positive!" << std::endl;
+    return EXIT_FAILURE;
+  }
+
   if( method == "OrderK" && outputFileNames.size() != 3 )
   {
     std::cerr << "ERROR: the method OrderK requires three output file names!\n";
@@ -161,7 +177,7 @@ int main( int argc, char **argv )
         inputFileName,
         outputFileNames,
         outputSquaredDistance,
-        method, K );
+        method, K, maximumDistance );
     }
     if( Dimension == 3 )
     {
@@ -169,7 +185,7 @@ int main( int argc, char **argv )
         inputFileName,
         outputFileNames,
         outputSquaredDistance,
-        method, K );
+        method, K, maximumDistance );
     }
 
   }
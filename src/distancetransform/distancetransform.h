@@ -24,14 +24,40 @@
 #include "itkExceptionObject.h"
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
+#include "itkImageRegionIterator.h"
 
 #include "itkSignedMaurerDistanceMapImageFilter.h"
 #include "itkSignedDanielssonDistanceMapImageFilter.h"
 #include "itkMorphologicalSignedDistanceTransformImageFilter.h"
 #include "itkMorphologicalDistanceTransformImageFilter.h"
+#include "ITKToolsProgress.h"
 //#include "itkOrderKDistanceTransformImageFilter.h"
 
 
+/*
+ * ******************* SaturateDistance ****************
+ *
+ * Clamps a (signed) distance map to [-cutoff, cutoff], in place.
+ */
+
+template <class TImage>
+void SaturateDistance( TImage * image, const double cutoff )
+{
+  typedef typename TImage::PixelType PixelType;
+  const PixelType upper = static_cast<PixelType>( cutoff );
+  const PixelType lower = static_cast<PixelType>( -cutoff );
+
+  itk::ImageRegionIterator<TImage> it( image, image->GetBufferedRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+  {
+    const PixelType value = it.Get();
+    if( value > upper ) it.Set( upper );
+    else if( value < lower ) it.Set( lower );
+  }
+
+} // end SaturateDistance()
+
+
 /*
  * ******************* DistanceTransform ****************
  *
@@ -43,7 +69,8 @@ void DistanceTransform(
   const std::vector<std::string> & outputFileNames,
   bool outputSquaredDistance,
   const std::string & method,
-  const unsigned int & K )
+  const unsigned int & K,
+  const double maximumDistance )
 {
   const unsigned int              Dimension = NDimensions;
   typedef unsigned char           InputComponentType;
@@ -112,6 +139,7 @@ void DistanceTransform(
   distance_Morphological->SetUseImageSpacing( true );
   distance_Morphological->SetOutsideValue( 1 );
   distance_Morphological->SetSqrDist( outputSquaredDistance );
+  distance_Morphological->SetMaximumDistance( maximumDistance );
 
   /** Setup the Morphological signed distance transform filter. */
   typename MorphologicalSignedDistanceType::Pointer distance_MorphologicalSigned
@@ -120,6 +148,7 @@ void DistanceTransform(
   distance_MorphologicalSigned->SetUseImageSpacing( true );
   distance_MorphologicalSigned->SetInsideIsPositive( false );
   distance_MorphologicalSigned->SetOutsideValue( 0 );
+  distance_MorphologicalSigned->SetMaximumDistance( maximumDistance );
 
   /** Setup the OrderK distance transform filter. */
 //   typename OrderKDistanceType::Pointer distance_OrderK
@@ -141,16 +170,31 @@ void DistanceTransform(
 //   kDistanceWriter->SetFileName( outputFileNames[ 1 ].c_str() );
 //   kIDWriter->SetFileName( outputFileNames[ 2 ].c_str() );
 
+  /** Report progress and allow cancellation, if requested. */
+  itktools::ProgressMonitor::Observe( reader.GetPointer(), "read" );
+  itktools::ProgressMonitor::Observe( distance_Maurer.GetPointer(), "distance" );
+  itktools::ProgressMonitor::Observe( distance_Danielsson.GetPointer(), "distance" );
+  itktools::ProgressMonitor::Observe( distance_Morphological.GetPointer(), "distance" );
+  itktools::ProgressMonitor::Observe( distance_MorphologicalSigned.GetPointer(), "distance" );
+  itktools::ProgressMonitor::Observe( writer.GetPointer(), "write" );
+
+  /** The Maurer and Danielsson filters have no cutoff, their distances
+   * are saturated afterwards, in the units of the output. */
+  const double cutoff = outputSquaredDistance
+    ? maximumDistance * maximumDistance : maximumDistance;
+
   /** Run! */
   if( method == "Maurer" )
   {
     distance_Maurer->Update();
+    if( maximumDistance > 0.0 ) SaturateDistance( distance_Maurer->GetOutput(), cutoff );
     writer->SetInput( distance_Maurer->GetOutput() );
     writer->Update();
   }
   else if( method == "Danielsson" )
   {
     distance_Danielsson->Update();
+    if( maximumDistance > 0.0 ) SaturateDistance( distance_Danielsson->GetOutput(), cutoff );
     writer->SetInput( distance_Danielsson->GetOutput() );
     writer->Update();
   }
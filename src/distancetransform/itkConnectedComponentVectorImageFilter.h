@@ -9,6 +9,8 @@
 #include "itkImage.h"
 #include "itkArray.h"
 #include "itkVectorImage.h"
+#include "itkMultiThreader.h"
+#include <vector>
 
 namespace itk
 {
@@ -32,6 +34,14 @@ namespace itk
  * object size by passing the output of this filter to a
  * RelabelComponentImageFilter.
  *
+ * With ParallelLabeling on (the default) and more than one thread, the
+ * image is split in slabs along the last dimension. Each thread joins the
+ * pixels of its slab in a union-find forest over the pixel offsets, where
+ * every tree is rooted at its first pixel in raster order; the trees are
+ * then joined across the slab boundaries. The labels are finally numbered
+ * as in the sequential pass, so the output is the same for any number of
+ * threads. This needs a temporary of about nine bytes per pixel.
+ *
  * \sa ImageToImageFilter
  */
 
@@ -77,6 +87,7 @@ public:
 
   typedef   typename TInputImage::IndexType       IndexType;
   typedef   typename TInputImage::SizeType        SizeType;
+  typedef   typename TInputImage::OffsetType      OffsetType;
   typedef   typename TOutputImage::RegionType     RegionType;
   typedef   std::list<IndexType>                  ListType;
 
@@ -106,10 +117,20 @@ public:
   itkGetConstReferenceMacro(FullyConnected, bool);
   itkBooleanMacro(FullyConnected);
 
+  /**
+   * Set/Get whether the labelling is multi-threaded, see above. The
+   * result is the same as that of the sequential pass. Default is on.
+   */
+  itkSetMacro(ParallelLabeling, bool);
+  itkGetConstReferenceMacro(ParallelLabeling, bool);
+  itkBooleanMacro(ParallelLabeling);
+
 protected:
   ConnectedComponentVectorImageFilter()
     {
     this->m_FullyConnected = true;
+    this->m_ParallelLabeling = true;
+    this->m_Phase = 0;
     }
   virtual ~ConnectedComponentVectorImageFilter() {}
   void PrintSelf(std::ostream& os, Indent indent) const;
@@ -133,9 +154,40 @@ protected:
  /** Sort an int Array */
   InputPixelType SortArray(const InputPixelType indices);
 
+  /** The multi-threaded labelling. */
+  void ParallelGenerateData();
+
+  /** The slab of a thread, along the last dimension. */
+  RegionType GetSlab( unsigned int slab, unsigned int numberOfSlabs ) const;
+
+  /** Whether two pixels contain the same ids, in any order. */
+  bool HaveSameIDs( const IndexType & index1, const IndexType & index2,
+    std::vector<long> & sorted1, std::vector<long> & sorted2 ) const;
+
+  /** The root of the tree of a pixel, with path halving. */
+  SizeValueType FindRoot( SizeValueType p );
+
+  /** Join the trees of two pixels, the smaller root becomes the root. */
+  void JoinTrees( SizeValueType p, SizeValueType q );
+
+  /** Thread entry: runs the current phase on the slab of the thread. */
+  static ITK_THREAD_RETURN_TYPE ParallelLabelingThreaderCallback( void * arg );
+  void ThreadedLabelingPhase( unsigned int slab, unsigned int numberOfSlabs );
+
 private:
   ConnectedComponentVectorImageFilter(const Self&) {}
   bool m_FullyConnected;
+  bool m_ParallelLabeling;
+
+  /** State of the multi-threaded labelling: the phase, the offsets of the
+   * neighbors before a pixel in raster order, the parent of every pixel,
+   * whether a pixel starts a new label in the sequential pass, and the
+   * number of those per slab. */
+  unsigned int                      m_Phase;
+  std::vector<OffsetType>           m_PreviousOffsets;
+  std::vector<SizeValueType>        m_Parents;
+  std::vector<unsigned char>        m_IsSeed;
+  std::vector<SizeValueType>        m_NumberOfSeeds;
 
 };
 
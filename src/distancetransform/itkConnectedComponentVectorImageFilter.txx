@@ -10,6 +10,8 @@
 #include "itkEquivalencyTable.h"
 #include "itkConstShapedNeighborhoodIterator.h"
 #include "itkConstantBoundaryCondition.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include <algorithm>
 
 
 
@@ -101,6 +103,14 @@ ConnectedComponentVectorImageFilter< TInputImage, TOutputImage >
 {
   itkDebugMacro( << "ComputeVoronoiMap Start");
 
+  const RegionType & requestedRegion = this->GetOutput()->GetRequestedRegion();
+  if( this->m_ParallelLabeling && this->GetNumberOfThreads() > 1
+    && requestedRegion.GetSize()[ ImageDimension - 1 ] > 1 )
+    {
+    this->ParallelGenerateData();
+    return;
+    }
+
   // create an equivalency table
   EquivalencyTable::Pointer eqTable = EquivalencyTable::New();
 
@@ -304,6 +314,310 @@ ConnectedComponentVectorImageFilter< TInputImage, TOutputImage >
     }
 }
 
+/**
+ * The multi-threaded labelling. The sequential pass gives a new label to
+ * every pixel that has no equal previous neighbor, a seed, and the final
+ * label of an object is the label of its first seed in raster order. The
+ * seeds are found locally, the objects with a union-find forest, and the
+ * labels by counting the seeds, which gives the same output.
+ */
+template< class TInputImage, class TOutputImage >
+void
+ConnectedComponentVectorImageFilter< TInputImage, TOutputImage >
+::ParallelGenerateData()
+{
+  OutputImagePointer output = this->GetOutput();
+  this->AllocateOutputs();
+
+  const RegionType region = output->GetRequestedRegion();
+  const SizeValueType numberOfPixels = region.GetNumberOfPixels();
+  const unsigned int lastDimension = ImageDimension - 1;
+
+  // the neighbors that come before a pixel, as activated in GenerateData()
+  this->m_PreviousOffsets.clear();
+  OffsetType offset;
+  offset.Fill( 0 );
+  if( !this->m_FullyConnected )
+    {
+    for( unsigned int d = 0; d < ImageDimension; ++d )
+      {
+      offset[ d ] = -1;
+      this->m_PreviousOffsets.push_back( offset );
+      offset[ d ] = 0;
+      }
+    }
+  else
+    {
+    // all neighbors with a neighborhood index before the center
+    unsigned int numberOfNeighbors = 1;
+    for( unsigned int d = 0; d < ImageDimension; ++d )
+      {
+      numberOfNeighbors *= 3;
+      }
+    for( unsigned int n = 0; n < numberOfNeighbors / 2; ++n )
+      {
+      unsigned int rest = n;
+      for( unsigned int d = 0; d < ImageDimension; ++d )
+        {
+        offset[ d ] = static_cast<long>( rest % 3 ) - 1;
+        rest /= 3;
+        }
+      this->m_PreviousOffsets.push_back( offset );
+      }
+    }
+
+  this->m_Parents.resize( numberOfPixels );
+  this->m_IsSeed.resize( numberOfPixels );
+
+  const unsigned int numberOfSlabs = std::min(
+    static_cast<SizeValueType>( this->GetNumberOfThreads() ),
+    static_cast<SizeValueType>( region.GetSize()[ lastDimension ] ) );
+  this->m_NumberOfSeeds.assign( numberOfSlabs, 0 );
+
+  this->GetMultiThreader()->SetNumberOfThreads( numberOfSlabs );
+  this->GetMultiThreader()->SetSingleMethod(
+    this->ParallelLabelingThreaderCallback, this );
+
+  // phase 1: the seeds, and the trees within every slab
+  this->m_Phase = 1;
+  this->GetMultiThreader()->SingleMethodExecute();
+
+  // join the trees across the slab boundaries; the first plane of a slab
+  // is only a small part of the image, so this is done sequentially
+  std::vector<long> sorted1, sorted2;
+  for( unsigned int slab = 1; slab < numberOfSlabs; ++slab )
+    {
+    RegionType plane = this->GetSlab( slab, numberOfSlabs );
+    typename RegionType::SizeType planeSize = plane.GetSize();
+    planeSize[ lastDimension ] = 1;
+    plane.SetSize( planeSize );
+
+    ImageRegionConstIteratorWithIndex<OutputImageType> pit( output, plane );
+    for( pit.GoToBegin(); !pit.IsAtEnd(); ++pit )
+      {
+      const IndexType here = pit.GetIndex();
+      for( unsigned int i = 0; i < this->m_PreviousOffsets.size(); ++i )
+        {
+        if( this->m_PreviousOffsets[ i ][ lastDimension ] != -1 ) continue;
+        const IndexType there = here + this->m_PreviousOffsets[ i ];
+        if( region.IsInside( there )
+          && this->HaveSameIDs( here, there, sorted1, sorted2 ) )
+          {
+          this->JoinTrees( output->ComputeOffset( here ), output->ComputeOffset( there ) );
+          }
+        }
+      }
+    }
+
+  // phase 2: count the seeds of every slab
+  this->m_Phase = 2;
+  this->GetMultiThreader()->SingleMethodExecute();
+
+  // the number of seeds before every slab
+  SizeValueType numberOfSeeds = 0;
+  for( unsigned int slab = 0; slab < numberOfSlabs; ++slab )
+    {
+    const SizeValueType n = this->m_NumberOfSeeds[ slab ];
+    this->m_NumberOfSeeds[ slab ] = numberOfSeeds;
+    numberOfSeeds += n;
+    }
+  if( numberOfSeeds >= static_cast<SizeValueType>( NumericTraits<OutputPixelType>::max() ) )
+    {
+    itkWarningMacro(<< "ConnectedComponentVectorImageFilter::GenerateData: Number of labels exceeds number of available labels for the output type." );
+    }
+
+  // phase 3: number the seeds, phase 4: label the other pixels by their root
+  this->m_Phase = 3;
+  this->GetMultiThreader()->SingleMethodExecute();
+  this->m_Phase = 4;
+  this->GetMultiThreader()->SingleMethodExecute();
+
+  // free the temporaries
+  std::vector<SizeValueType>().swap( this->m_Parents );
+  std::vector<unsigned char>().swap( this->m_IsSeed );
+  this->m_Phase = 0;
+}
+
+
+template< class TInputImage, class TOutputImage >
+typename ConnectedComponentVectorImageFilter< TInputImage, TOutputImage >::RegionType
+ConnectedComponentVectorImageFilter< TInputImage, TOutputImage >
+::GetSlab( unsigned int slab, unsigned int numberOfSlabs ) const
+{
+  RegionType region = this->GetOutput()->GetRequestedRegion();
+  const unsigned int lastDimension = ImageDimension - 1;
+  typename RegionType::IndexType index = region.GetIndex();
+  typename RegionType::SizeType size = region.GetSize();
+  const SizeValueType n = size[ lastDimension ];
+  const SizeValueType begin = n * slab / numberOfSlabs;
+  const SizeValueType end = n * ( slab + 1 ) / numberOfSlabs;
+  index[ lastDimension ] += begin;
+  size[ lastDimension ] = end - begin;
+  region.SetIndex( index );
+  region.SetSize( size );
+  return region;
+}
+
+
+template< class TInputImage, class TOutputImage >
+bool
+ConnectedComponentVectorImageFilter< TInputImage, TOutputImage >
+::HaveSameIDs( const IndexType & index1, const IndexType & index2,
+  std::vector<long> & sorted1, std::vector<long> & sorted2 ) const
+{
+  const InputImageType * input = this->GetInput();
+  const unsigned int K = input->GetVectorLength();
+  const InputPixelType ids1 = input->GetPixel( index1 );
+  const InputPixelType ids2 = input->GetPixel( index2 );
+  sorted1.resize( K );
+  sorted2.resize( K );
+  for( unsigned int k = 0; k < K; ++k )
+    {
+    sorted1[ k ] = static_cast<long>( ids1[ k ] );
+    sorted2[ k ] = static_cast<long>( ids2[ k ] );
+    }
+  std::sort( sorted1.begin(), sorted1.end() );
+  std::sort( sorted2.begin(), sorted2.end() );
+  return sorted1 == sorted2;
+}
+
+
+template< class TInputImage, class TOutputImage >
+SizeValueType
+ConnectedComponentVectorImageFilter< TInputImage, TOutputImage >
+::FindRoot( SizeValueType p )
+{
+  while( this->m_Parents[ p ] != p )
+    {
+    this->m_Parents[ p ] = this->m_Parents[ this->m_Parents[ p ] ];
+    p = this->m_Parents[ p ];
+    }
+  return p;
+}
+
+
+template< class TInputImage, class TOutputImage >
+void
+ConnectedComponentVectorImageFilter< TInputImage, TOutputImage >
+::JoinTrees( SizeValueType p, SizeValueType q )
+{
+  const SizeValueType rp = this->FindRoot( p );
+  const SizeValueType rq = this->FindRoot( q );
+  if( rp < rq )
+    {
+    this->m_Parents[ rq ] = rp;
+    }
+  else if( rq < rp )
+    {
+    this->m_Parents[ rp ] = rq;
+    }
+}
+
+
+template< class TInputImage, class TOutputImage >
+ITK_THREAD_RETURN_TYPE
+ConnectedComponentVectorImageFilter< TInputImage, TOutputImage >
+::ParallelLabelingThreaderCallback( void * arg )
+{
+  typedef MultiThreader::ThreadInfoStruct ThreadInfoType;
+  ThreadInfoType * info = static_cast<ThreadInfoType *>( arg );
+  Self * filter = static_cast<Self *>( info->UserData );
+
+  filter->ThreadedLabelingPhase( info->ThreadID, info->NumberOfThreads );
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+template< class TInputImage, class TOutputImage >
+void
+ConnectedComponentVectorImageFilter< TInputImage, TOutputImage >
+::ThreadedLabelingPhase( unsigned int slab, unsigned int numberOfSlabs )
+{
+  OutputImageType * output = this->GetOutput();
+  OutputPixelType * labels = output->GetBufferPointer();
+  const RegionType region = output->GetRequestedRegion();
+  const RegionType slabRegion = this->GetSlab( slab, numberOfSlabs );
+  const unsigned int lastDimension = ImageDimension - 1;
+  const IndexValueType slabBegin = slabRegion.GetIndex()[ lastDimension ];
+
+  const SizeValueType first = output->ComputeOffset( slabRegion.GetIndex() );
+  const SizeValueType end = first + slabRegion.GetNumberOfPixels();
+
+  if( this->m_Phase == 1 )
+    {
+    // Every pixel is compared with its previous neighbors in the image,
+    // for the seeds, but only joined with those inside the slab, so that
+    // the threads change disjoint parts of the forest.
+    std::vector<long> sorted1, sorted2;
+    ImageRegionConstIteratorWithIndex<OutputImageType> it( output, slabRegion );
+    SizeValueType p = first;
+    for( it.GoToBegin(); !it.IsAtEnd(); ++it, ++p )
+      {
+      const IndexType here = it.GetIndex();
+      this->m_Parents[ p ] = p;
+      this->m_IsSeed[ p ] = 1;
+      for( unsigned int i = 0; i < this->m_PreviousOffsets.size(); ++i )
+        {
+        const IndexType there = here + this->m_PreviousOffsets[ i ];
+        if( !region.IsInside( there )
+          || !this->HaveSameIDs( here, there, sorted1, sorted2 ) )
+          {
+          continue;
+          }
+        this->m_IsSeed[ p ] = 0;
+        if( there[ lastDimension ] >= slabBegin )
+          {
+          this->JoinTrees( p, output->ComputeOffset( there ) );
+          }
+        }
+      }
+    }
+  else if( this->m_Phase == 2 )
+    {
+    SizeValueType numberOfSeeds = 0;
+    for( SizeValueType p = first; p < end; ++p )
+      {
+      numberOfSeeds += this->m_IsSeed[ p ];
+      }
+    this->m_NumberOfSeeds[ slab ] = numberOfSeeds;
+    }
+  else if( this->m_Phase == 3 )
+    {
+    // the sequential label of a seed is one more than the seeds before it
+    const OutputPixelType maxPossibleLabel = NumericTraits<OutputPixelType>::max();
+    SizeValueType label = this->m_NumberOfSeeds[ slab ];
+    for( SizeValueType p = first; p < end; ++p )
+      {
+      if( this->m_IsSeed[ p ] )
+        {
+        ++label;
+        labels[ p ] = label < static_cast<SizeValueType>( maxPossibleLabel )
+          ? static_cast<OutputPixelType>( label ) : maxPossibleLabel;
+        }
+      }
+    }
+  else if( this->m_Phase == 4 )
+    {
+    // The root of a tree is its first pixel in raster order, a seed, so
+    // it holds the label of the object. The roots are not changed here,
+    // and the forest is only read.
+    for( SizeValueType p = first; p < end; ++p )
+      {
+      SizeValueType root = p;
+      while( this->m_Parents[ root ] != root )
+        {
+        root = this->m_Parents[ root ];
+        }
+      if( root != p )
+        {
+        labels[ p ] = labels[ root ];
+        }
+      }
+    }
+}
+
+
 template< class TInputImage, class TOutputImage >
 void
 ConnectedComponentVectorImageFilter< TInputImage, TOutputImage >
@@ -312,6 +626,7 @@ ConnectedComponentVectorImageFilter< TInputImage, TOutputImage >
   Superclass::PrintSelf(os,indent);
 
   os << indent << "FullyConnected: "  << this->m_FullyConnected << std::endl;
+  os << indent << "ParallelLabeling: "  << this->m_ParallelLabeling << std::endl;
 }
 
 } // end namespace itk
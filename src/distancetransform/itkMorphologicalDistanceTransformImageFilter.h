@@ -98,6 +98,13 @@ public:
   itkGetConstReferenceMacro(SqrDist, bool);
   itkBooleanMacro(SqrDist);
 
+  /** The distances are only computed up to MaximumDistance, in the units
+   * of the output, and are saturated at that value beyond it. This bounds
+   * the search of the parabolic erosion to the band within the cutoff.
+   * The default 0 means no cutoff. */
+  itkSetMacro(MaximumDistance, double);
+  itkGetConstMacro(MaximumDistance, double);
+
 
 #ifdef ITK_USE_CONCEPT_CHECKING
   /** Begin concept checking */
@@ -134,6 +141,7 @@ private:
   typename ThreshType::Pointer m_Thresh;
   typename SqrtType::Pointer m_Sqrt;
   bool m_SqrDist;
+  double m_MaximumDistance;
 };
 
 } // namespace itk
@@ -4,10 +4,8 @@
 #include "itkImageToImageFilter.h"
 #include "itkProgressReporter.h"
 
-#include "itkBinaryThresholdImageFilter.h"
-#include "itkParabolicErodeImageFilter.h"
-#include "itkParabolicDilateImageFilter.h"
-#include "itkMorphSDTHelperImageFilter.h"
+#include "itkMultiThreader.h"
+#include "itkParabolicMorphUtils.h"
 
 namespace itk
 {
@@ -28,6 +26,12 @@ namespace itk
  * square of the largest value of the distance - just use float to be
  * safe.
  *
+ * The signed distance is computed in a single sweep over the dimensions,
+ * in the output buffer: the voxels hold the squared distance to the other
+ * side, positive outside and negative inside, and both sides are eroded
+ * in the same pass over every line. This replaces a separate erosion and
+ * dilation and a pass to combine them, and needs no other image buffers.
+ *
  * The inside is considered to have negative distances. Use
  * InsideIsPositive(bool) to change.
  *
@@ -84,8 +88,6 @@ public:
   /** a type to represent the "kernel radius" */
   typedef typename itk::FixedArray<ScalarRealType, TInputImage::ImageDimension> RadiusType;
 
-  virtual void Modified() const;
-
   /** this describes the input mask - default value 0 - we compute the
   distance from all voxels with value not equal to "OutsideValue" to
   the nearest voxel with value "OutsideValue" */
@@ -108,18 +110,15 @@ public:
      * true.                             */
   itkBooleanMacro( InsideIsPositive );
   /** Is the transform in world or voxel units - default is world */
-  void SetUseImageSpacing(bool uis)
-  {
-    this->m_Erode->SetUseImageSpacing(uis);
-    this->m_Dilate->SetUseImageSpacing(uis);
-    this->Modified();
-  }
-
+  itkSetMacro( UseImageSpacing, bool );
+  itkGetConstReferenceMacro( UseImageSpacing, bool );
 
-  const bool GetUseImageSpacing()
-  {
-    return this->m_Erode->GetUseImageSpacing();
-  }
+  /** The absolute distances are only computed up to MaximumDistance, in
+   * the units of the output, and are saturated at that value beyond it.
+   * This bounds the search of the parabolic erosion and dilation to the
+   * band within the cutoff. The default 0 means no cutoff. */
+  itkSetMacro(MaximumDistance, double);
+  itkGetConstMacro(MaximumDistance, double);
 
 
 
@@ -144,11 +143,13 @@ protected:
   /** Generate Data */
   void GenerateData( void );
 
-  // do everything in the output image type, which should have high precision
-  typedef typename itk::BinaryThresholdImageFilter<InputImageType, OutputImageType> ThreshType;
-  typedef typename itk::ParabolicErodeImageFilter<OutputImageType, OutputImageType> ErodeType;
-  typedef typename itk::ParabolicDilateImageFilter<OutputImageType, OutputImageType> DilateType;
-  typedef typename itk::MorphSDTHelperImageFilter<OutputImageType, OutputImageType> HelperType;
+  /** This filter needs the whole output at once. */
+  void EnlargeOutputRequestedRegion( DataObject * output );
+
+  /** The passes over the dimensions, one thread per piece. */
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback( void * arg );
+  void ThreadedGenerateDataForDimension( unsigned int threadId,
+    unsigned int numberOfThreads );
 
 private:
   MorphologicalSignedDistanceTransformImageFilter(const Self&); //purposely not implemented
@@ -156,10 +157,13 @@ private:
 
   InputPixelType m_OutsideValue;
   bool m_InsideIsPositive;
-  typename ErodeType::Pointer m_Erode;
-  typename DilateType::Pointer m_Dilate;
-  typename ThreshType::Pointer m_Thresh;
-  typename HelperType::Pointer m_Helper;
+  bool m_UseImageSpacing;
+  double m_MaximumDistance;
+
+  /** The squared distance of the voxels without a voxel of the other side
+   * nearby, and the dimension of the current pass. */
+  double m_MaximumSquaredDistance;
+  unsigned int m_CurrentDimension;
 };
 
 } // namespace itk
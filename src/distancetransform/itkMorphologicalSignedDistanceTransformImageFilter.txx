@@ -2,7 +2,9 @@
 #define __itkMorphologicalSignedDistanceTransformImageFilter_txx
 
 #include "itkMorphologicalSignedDistanceTransformImageFilter.h"
-#include "itkProgressAccumulator.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include <algorithm>
 
 namespace itk
 {
@@ -13,27 +15,25 @@ MorphologicalSignedDistanceTransformImageFilter<TInputImage, TOutputImage>
   this->SetNumberOfRequiredOutputs( 1 );
   this->SetNumberOfRequiredInputs( 1 );
 
-  this->m_Erode = ErodeType::New();
-  this->m_Dilate = DilateType::New();
-  this->m_Thresh = ThreshType::New();
-  this->m_Helper = HelperType::New();
-  this->m_Erode->SetScale(0.5);
-  this->m_Dilate->SetScale(0.5);
-  this->SetUseImageSpacing(true);
-  this->SetInsideIsPositive(false);
+  this->m_UseImageSpacing = true;
+  this->m_InsideIsPositive = false;
   this->m_OutsideValue = 0;
+  this->m_MaximumDistance = 0.0;
+  this->m_MaximumSquaredDistance = 0.0;
+  this->m_CurrentDimension = 0;
 
 }
+
 template <typename TInputImage, typename TOutputImage>
 void
 MorphologicalSignedDistanceTransformImageFilter<TInputImage, TOutputImage>
-::Modified() const
+::EnlargeOutputRequestedRegion( DataObject * output )
 {
-  Superclass::Modified();
-  this->m_Erode->Modified();
-  this->m_Dilate->Modified();
-  this->m_Thresh->Modified();
-  this->m_Helper->Modified();
+  TOutputImage * out = dynamic_cast<TOutputImage *>( output );
+  if( out )
+    {
+    out->SetRequestedRegion( out->GetLargestPossibleRegion() );
+    }
 }
 
 template <typename TInputImage, typename TOutputImage>
@@ -41,16 +41,6 @@ void
 MorphologicalSignedDistanceTransformImageFilter<TInputImage, TOutputImage>
 ::GenerateData( void )
 {
-
-  ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
-  progress->SetMiniPipelineFilter(this);
-  // these values are guesses at present - need to profile to get a
-  // real idea
-  progress->RegisterInternalFilter( this->m_Thresh, 0.1f);
-  progress->RegisterInternalFilter( this->m_Erode, 0.4f);
-  progress->RegisterInternalFilter( this->m_Dilate, 0.4f);
-  progress->RegisterInternalFilter( this->m_Helper, 0.1f);
-
   this->AllocateOutputs();
   // figure out the maximum value of distance transform using the
   // image dimensions
@@ -75,37 +65,114 @@ MorphologicalSignedDistanceTransformImageFilter<TInputImage, TOutputImage>
       }
     }
 
-  this->m_Thresh->SetLowerThreshold( this->m_OutsideValue);
-  this->m_Thresh->SetUpperThreshold( this->m_OutsideValue);
-  if(this->GetInsideIsPositive())
+  // the erosion and dilation of the two sides started at plus and minus
+  // MaxDist, which saturated the squared distances at twice that value;
+  // with a cutoff the distances saturate at the cutoff
+  this->m_MaximumSquaredDistance = 2.0 * MaxDist;
+  if( this->m_MaximumDistance > 0.0 )
     {
-    this->m_Thresh->SetOutsideValue(MaxDist);
-    this->m_Thresh->SetInsideValue(-MaxDist);
+    this->m_MaximumSquaredDistance = std::min( this->m_MaximumSquaredDistance,
+      this->m_MaximumDistance * this->m_MaximumDistance );
+    }
+
+  // one sweep over the dimensions, in the output buffer
+  const unsigned int numberOfThreads = this->GetNumberOfThreads();
+  this->GetMultiThreader()->SetNumberOfThreads( numberOfThreads );
+  this->GetMultiThreader()->SetSingleMethod( this->ThreaderCallback, this );
+  for( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    this->m_CurrentDimension = d;
+    this->GetMultiThreader()->SingleMethodExecute();
+    }
+
+}
+
+template <typename TInputImage, typename TOutputImage>
+ITK_THREAD_RETURN_TYPE
+MorphologicalSignedDistanceTransformImageFilter<TInputImage, TOutputImage>
+::ThreaderCallback( void * arg )
+{
+  typedef MultiThreader::ThreadInfoStruct ThreadInfoType;
+  ThreadInfoType * info = static_cast<ThreadInfoType *>( arg );
+  Self * filter = static_cast<Self *>( info->UserData );
+  filter->ThreadedGenerateDataForDimension( info->ThreadID, info->NumberOfThreads );
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template <typename TInputImage, typename TOutputImage>
+void
+MorphologicalSignedDistanceTransformImageFilter<TInputImage, TOutputImage>
+::ThreadedGenerateDataForDimension( unsigned int threadId, unsigned int numberOfThreads )
+{
+  typedef typename TOutputImage::RegionType RegionType;
+  typedef typename NumericTraits<OutputPixelType>::RealType LineRealType;
+
+  TOutputImage * output = this->GetOutput();
+  const unsigned int d = this->m_CurrentDimension;
+
+  // split the outermost axis other than the current one, so that every
+  // thread has complete lines along it
+  RegionType region = output->GetRequestedRegion();
+  int splitAxis = -1;
+  for( int axis = static_cast<int>( ImageDimension ) - 1; axis >= 0; --axis )
+    {
+    if( axis != static_cast<int>( d ) && region.GetSize()[axis] > 1 )
+      {
+      splitAxis = axis;
+      break;
+      }
+    }
+  if( splitAxis < 0 )
+    {
+    if( threadId > 0 ) return;
     }
   else
     {
-    this->m_Thresh->SetOutsideValue(-MaxDist);
-    this->m_Thresh->SetInsideValue(MaxDist);
+    const SizeValueType size = region.GetSize()[splitAxis];
+    const SizeValueType begin = size * threadId / numberOfThreads;
+    const SizeValueType end = size * ( threadId + 1 ) / numberOfThreads;
+    if( begin == end ) return;
+    region.SetIndex( splitAxis, region.GetIndex()[splitAxis] + begin );
+    region.SetSize( splitAxis, end - begin );
     }
 
-  this->m_Thresh->SetInput(this->GetInput());
-  this->m_Erode->SetInput( this->m_Thresh->GetOutput());
-  this->m_Dilate->SetInput( this->m_Thresh->GetOutput());
-#if 1
-  this->m_Helper->SetInput( this->m_Erode->GetOutput());
-  this->m_Helper->SetInput2( this->m_Dilate->GetOutput());
-  this->m_Helper->SetInput3( this->m_Thresh->GetOutput());
-  this->m_Helper->SetVal(MaxDist);
-  this->m_Helper->GraftOutput(this->GetOutput());
-  this->m_Helper->Update();
-  this->GraftOutput( this->m_Helper->GetOutput());
-#else
-  this->m_Dilate->GraftOutput(this->GetOutput());
-  this->m_Dilate->Update();
-  this->GraftOutput( this->m_Dilate->GetOutput());
-#endif
+  const SizeValueType numberOfLines = region.GetNumberOfPixels() / region.GetSize()[d];
+  const float progressPerDimension = 1.0 / ImageDimension;
+  ProgressReporter progress( this, threadId, numberOfLines, 30,
+    d * progressPerDimension, progressPerDimension );
+
+  // the first pass starts with the squared distance saturated, positive
+  // on the side equal to the outside value unless the inside is positive
+  const OutputPixelType maximum = static_cast<OutputPixelType>( this->m_MaximumSquaredDistance );
+  if( d == 0 )
+    {
+    ImageRegionConstIterator<TInputImage> inIt( this->GetInput(), region );
+    ImageRegionIterator<TOutputImage> outIt( output, region );
+    for( ; !inIt.IsAtEnd(); ++inIt, ++outIt )
+      {
+      const bool positive = ( inIt.Get() == this->m_OutsideValue ) != this->m_InsideIsPositive;
+      outIt.Set( positive ? maximum : -maximum );
+      }
+    }
+
+  doSignedOneDimension<TOutputImage, LineRealType>( output, region, progress,
+    d, this->m_UseImageSpacing );
 
+  // the last pass takes the root, keeping the sign
+  if( d == ImageDimension - 1 )
+    {
+    ImageRegionIterator<TOutputImage> outIt( output, region );
+    for( ; !outIt.IsAtEnd(); ++outIt )
+      {
+      const double value = static_cast<double>( outIt.Get() );
+      const double root = vcl_sqrt( std::min( value > 0 ? value : -value,
+        this->m_MaximumSquaredDistance ) );
+      outIt.Set( static_cast<OutputPixelType>( value > 0 ? root : -root ) );
+      }
+    }
 }
+
 template <typename TInputImage, typename TOutputImage>
 void
 MorphologicalSignedDistanceTransformImageFilter<TInputImage, TOutputImage>
@@ -113,7 +180,8 @@ MorphologicalSignedDistanceTransformImageFilter<TInputImage, TOutputImage>
 {
   Superclass::PrintSelf(os,indent);
   os << "Outside Value = " << (OutputPixelType)m_OutsideValue << std::endl;
-  os << "ImageScale = " << this->m_Erode->GetUseImageSpacing() << std::endl;
+  os << "ImageScale = " << this->m_UseImageSpacing << std::endl;
+  os << "MaximumDistance = " << this->m_MaximumDistance << std::endl;
 
 }
 
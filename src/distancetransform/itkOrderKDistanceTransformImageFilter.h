@@ -184,6 +184,19 @@ public:
   /** Set On/Off whether spacing is used. */
   itkBooleanMacro( UseImageSpacing );
 
+  /** Set whether the K-distance map is computed, default true. Without
+   * it, the distances of the K closest objects are recomputed from their
+   * ids when needed, which roughly halves the memory of the filter, for
+   * when only the K-closest-ID map and the Voronoi map are needed. The
+   * ids, and thus these maps, are the same either way. */
+  itkSetMacro( ComputeKDistanceMap, bool );
+
+  /** Get whether the K-distance map is computed. */
+  itkGetConstReferenceMacro( ComputeKDistanceMap, bool );
+
+  /** Set On/Off whether the K-distance map is computed. */
+  itkBooleanMacro( ComputeKDistanceMap );
+
   /** Set the number of closest neighbors to be computed. */
   void SetK( unsigned int K );
 
@@ -236,6 +249,18 @@ protected:
   void UpdateLocalDistance(const IndexType&,
                            const OffsetType&);
 
+  /** The object pixels are stored with int coordinates, which takes half
+   * the memory of an IndexType, for every object pixel of the input. */
+  typedef int                                               CompactIndexValueType;
+  typedef FixedArray< CompactIndexValueType,
+    itkGetStaticConstMacro( InputImageDimension ) >         CompactIndexType;
+
+  /** The distance from a pixel to the object pixel with the given id. */
+  KDistanceValueType ComputeDistance( const IndexType & here, const KIDValueType id ) const;
+
+  /** Convert an index for the lookup table. */
+  CompactIndexType ToCompactIndex( const IndexType & index ) const;
+
 
 
 private:
@@ -246,15 +271,27 @@ private:
   bool                  m_InputIsBinary;
   bool                  m_UseImageSpacing;
   bool                  m_FullyConnected;
+  bool                  m_ComputeKDistanceMap;
 
   unsigned int    m_K;
 
   /** should the constructor or other method reserve memory for m_IndexLookUpTable? */
-  std::vector<IndexType> m_IndexLookUpTable;
+  std::vector<CompactIndexType> m_IndexLookUpTable;
 
   KDistanceImagePointer m_KDistanceImage;
   KIDImagePointer             m_KIDImage;
 
+  /** The buffers of the above, and the spacing used in the distances,
+   * cached for UpdateLocalDistance(), which is called 2^D * D times per pixel. */
+  KDistanceValueType *        m_KDistanceBuffer;
+  KIDValueType *              m_KIDBuffer;
+  double                      m_DistanceSpacing[ InputImageDimension ];
+
+  /** The distance of an empty slot, and scratch space for the distances
+   * of a pixel when the K-distance map is not computed. */
+  KDistanceValueType          m_InfiniteDistance;
+  KDistancePixelType          m_ScratchDistances;
+
 
 }; // end of OrderKDistanceTransformImageFilter class
 
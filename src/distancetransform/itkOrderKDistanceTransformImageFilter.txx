@@ -41,6 +41,10 @@ OrderKDistanceTransformImageFilter<TInputImage, TOutputImage, TKDistanceImage, T
   this->m_UseImageSpacing     = true; // this also
   this->m_FullyConnected    = true;  /// should this be true or false?
   this->m_K                   = 5;
+  this->m_ComputeKDistanceMap = true;
+  this->m_KDistanceBuffer     = 0;
+  this->m_InfiniteDistance    = 0;
+  this->m_KIDBuffer           = 0;
 
   this->SetNumberOfRequiredOutputs( 3 );
 
@@ -138,6 +142,9 @@ OrderKDistanceTransformImageFilter<TInputImage, TOutputImage, TKDistanceImage, T
 
   itkDebugMacro(<< "PrepareData Start");
 
+  // The ids are renumbered from 1 on every update
+  this->m_IndexLookUpTable.clear();
+
   InputImagePointer  inputImage  =
     dynamic_cast<const TInputImage  *>( ProcessObject::GetInput(0) );
 
@@ -188,7 +195,10 @@ OrderKDistanceTransformImageFilter<TInputImage, TOutputImage, TKDistanceImage, T
   kdistanceImage->SetRequestedRegion(
     inputImage->GetRequestedRegion() );
 
-  kdistanceImage->Allocate();
+  if( this->m_ComputeKDistanceMap )
+    {
+    kdistanceImage->Allocate();
+    }
 
 
 
@@ -224,6 +234,8 @@ OrderKDistanceTransformImageFilter<TInputImage, TOutputImage, TKDistanceImage, T
   distanceObect.Fill(2*maxLength);
   distanceObect[0] = 0;
   distanceBackground.Fill(2*maxLength);
+  this->m_InfiniteDistance = 2*maxLength;
+  this->m_ScratchDistances.SetSize( this->m_K );
 
   it.GoToBegin();
   int npt = 1;
@@ -234,14 +246,14 @@ OrderKDistanceTransformImageFilter<TInputImage, TOutputImage, TKDistanceImage, T
       IndexType index = it.GetIndex();
       if( it.Get() )
         {
-        kdistanceImage->SetPixel(index, distanceObect);
+        if( this->m_ComputeKDistanceMap ) kdistanceImage->SetPixel(index, distanceObect);
         idObject[0] = npt++;
         kidImage->SetPixel(index, idObject);
-        this->m_IndexLookUpTable.push_back(index);
+        this->m_IndexLookUpTable.push_back( this->ToCompactIndex( index ) );
         }
       else
         {
-        kdistanceImage->SetPixel(index, distanceBackground);
+        if( this->m_ComputeKDistanceMap ) kdistanceImage->SetPixel(index, distanceBackground);
         kidImage->SetPixel(index, idBackground);
         }
       ++it;
@@ -258,7 +270,7 @@ OrderKDistanceTransformImageFilter<TInputImage, TOutputImage, TKDistanceImage, T
       IndexType index = it.GetIndex();
       if( it.Get()>0 )
         {
-        kdistanceImage->SetPixel(index, distanceObect);
+        if( this->m_ComputeKDistanceMap ) kdistanceImage->SetPixel(index, distanceObect);
         idObject[0] = static_cast< typename KIDPixelType::ValueType >( it.Get() );
         kidImage->SetPixel(index, idObject);
         Element  el;
@@ -268,14 +280,14 @@ OrderKDistanceTransformImageFilter<TInputImage, TOutputImage, TKDistanceImage, T
         }
       else
         {
-        kdistanceImage->SetPixel(index, distanceBackground);
+        if( this->m_ComputeKDistanceMap ) kdistanceImage->SetPixel(index, distanceBackground);
         kidImage->SetPixel(index, idBackground);
         }
       ++it;
       }
      std::sort( indices.begin(), indices.end() );
      for( unsigned int kk=0; kk<indices.size(); kk++)    {
-        this->m_IndexLookUpTable.push_back( indices[kk].index );
+        this->m_IndexLookUpTable.push_back( this->ToCompactIndex( indices[kk].index ) );
         }
     } // End If: Input is binary
 
@@ -318,41 +330,40 @@ OrderKDistanceTransformImageFilter<TInputImage, TOutputImage, TKDistanceImage, T
                       const OffsetType& offset)
 {
 
+  // The pixels of the vector images are accessed in place in the buffers;
+  // a VectorImage pixel is a view on K consecutive buffer elements.
   IndexType  there            = here + offset;
-  typename KDistanceImageType::PixelType kd = this->m_KDistanceImage->GetPixel(here);
-  typename KIDImageType::PixelType       kid_here = this->m_KIDImage->GetPixel(here);
-  typename KIDImageType::PixelType       kid_there = this->m_KIDImage->GetPixel(there);
+  const unsigned long hereOffset  = this->m_KIDImage->ComputeOffset( here ) * this->m_K;
+  const unsigned long thereOffset = this->m_KIDImage->ComputeOffset( there ) * this->m_K;
+  KIDPixelType       kid_here( this->m_KIDBuffer + hereOffset, this->m_K, false );
+  const KIDValueType * kid_there = this->m_KIDBuffer + thereOffset;
+
+  // Without the K-distance map, the distances of the current K closest
+  // objects are recomputed from their ids, with the same expression as
+  // when they were inserted, so that the result is the same.
+  bool haveDistances = this->m_ComputeKDistanceMap;
+  KDistancePixelType kd;
+  if( haveDistances )
+    {
+    kd.SetData( this->m_KDistanceBuffer + hereOffset, this->m_K, false );
+    }
 
   for( unsigned int j=0; j<m_K; j++)
     {
     // instead of this (using distance components), use ID image and this->m_IndexLookUpTable
     if(kid_there[j]>-1)
       {
-      IndexType objectIndex = this->m_IndexLookUpTable[kid_there[j]-1];
-      OffsetType offsetToObject = objectIndex - here;
-
-      typename InputImageType::SpacingType spacing = Self::GetInput()->GetSpacing();
-
-      double sqdist = 0.0;
-      for( unsigned int i=0; i<InputImageDimension; i++ )
+      if( !haveDistances )
         {
-        double v1 = static_cast< double >(  offsetToObject[ i ]  );
-
-        if( this->m_UseImageSpacing)
+        kd.SetData( this->m_ScratchDistances.GetDataPointer(), this->m_K, false );
+        for( unsigned int k=0; k<m_K; k++)
           {
-          double spacingComponent = static_cast< double >(spacing[ i ]);
-          v1 *= spacingComponent;
+          kd[k] = kid_here[k]>-1
+            ? this->ComputeDistance( here, kid_here[k] ) : this->m_InfiniteDistance;
           }
-
-        sqdist +=  v1 * v1;
-        }
-
-      if( !m_SquaredDistance ) {
-        InsertSorted(std::sqrt(sqdist), kid_there[j], kd, kid_here );
-        }
-      else {
-        InsertSorted(sqdist, kid_there[j], kd, kid_here );
+        haveDistances = true;
         }
+      InsertSorted( this->ComputeDistance( here, kid_there[j] ), kid_there[j], kd, kid_here );
       }
     }
 
@@ -360,6 +371,51 @@ OrderKDistanceTransformImageFilter<TInputImage, TOutputImage, TKDistanceImage, T
 
 
 
+/**
+ *  The distance from a pixel to an object pixel, given its id.
+ */
+template <class TInputImage, class TOutputImage, class TKDistanceImage, class TKIDImage >
+typename OrderKDistanceTransformImageFilter<TInputImage, TOutputImage, TKDistanceImage, TKIDImage >::KDistanceValueType
+OrderKDistanceTransformImageFilter<TInputImage, TOutputImage, TKDistanceImage, TKIDImage >
+::ComputeDistance( const IndexType & here, const KIDValueType id ) const
+{
+  const CompactIndexType & objectIndex = this->m_IndexLookUpTable[id-1];
+
+  double sqdist = 0.0;
+  for( unsigned int i=0; i<InputImageDimension; i++ )
+    {
+    const double v1 = static_cast< double >( objectIndex[ i ] - here[ i ] )
+      * this->m_DistanceSpacing[ i ];
+    sqdist +=  v1 * v1;
+    }
+
+  if( !m_SquaredDistance )
+    {
+    return std::sqrt(sqdist);
+    }
+  return sqdist;
+}
+
+
+
+/**
+ *  Convert an index to the compact form stored in the lookup table.
+ */
+template <class TInputImage, class TOutputImage, class TKDistanceImage, class TKIDImage >
+typename OrderKDistanceTransformImageFilter<TInputImage, TOutputImage, TKDistanceImage, TKIDImage >::CompactIndexType
+OrderKDistanceTransformImageFilter<TInputImage, TOutputImage, TKDistanceImage, TKIDImage >
+::ToCompactIndex( const IndexType & index ) const
+{
+  CompactIndexType compact;
+  for( unsigned int i=0; i<InputImageDimension; i++ )
+    {
+    compact[ i ] = static_cast< CompactIndexValueType >( index[ i ] );
+    }
+  return compact;
+}
+
+
+
 /**
  *  Add element (distance and index) to list of nearest neighbors.
  *  Inserts so distances are sorted.
@@ -431,8 +487,6 @@ void
 OrderKDistanceTransformImageFilter<TInputImage, TOutputImage, TKDistanceImage, TKIDImage >
 ::GenerateData()
 {
-
-  std::cerr << "to here inside 1";
   this->PrepareData();
 
   // Specify images and regions.
@@ -441,8 +495,16 @@ OrderKDistanceTransformImageFilter<TInputImage, TOutputImage, TKDistanceImage, T
 
   this->m_KDistanceImage    =  this->GetKDistanceMap();
   this->m_KIDImage          =  this->GetKclosestIDMap();
+  this->m_KDistanceBuffer   =  this->m_KDistanceImage->GetBufferPointer();
+  this->m_KIDBuffer         =  this->m_KIDImage->GetBufferPointer();
 
-  std::cerr << "to here inside 2";
+  // The spacing used in the distances, the same for all visits.
+  typename InputImageType::SpacingType spacing = inputimage->GetSpacing();
+  for( unsigned int i=0; i<InputImageDimension; i++ )
+    {
+    this->m_DistanceSpacing[ i ] = this->m_UseImageSpacing
+      ? static_cast< double >( spacing[ i ] ) : 1.0;
+    }
 
   typename InputImageType::RegionType region  = inputimage->GetLargestPossibleRegion();
 
@@ -474,7 +536,6 @@ OrderKDistanceTransformImageFilter<TInputImage, TOutputImage, TKDistanceImage, T
   OffsetType  offset;
   offset.Fill( 0 );
 
-std::cerr << "to here inside 3";
   itkDebugMacro(<< "GenerateData: Computing distance transform");
   while( !it.IsAtEnd() )
     {
@@ -504,9 +565,7 @@ std::cerr << "to here inside 3";
     }
 
   itkDebugMacro(<< "GenerateData: ComputeVoronoiMap");
-  std::cerr << "to here inside 4";
   this->ComputeVoronoiMap();
-std::cerr << "to here inside 5";
 } // end GenerateData()
 
 
@@ -553,6 +612,7 @@ OrderKDistanceTransformImageFilter<TInputImage, TOutputImage, TKDistanceImage, T
   os << indent << "Input Is Binary   : " << this->m_InputIsBinary << std::endl;
   os << indent << "Use Image Spacing : " << this->m_UseImageSpacing << std::endl;
   os << indent << "Squared Distance  : " << this->m_SquaredDistance << std::endl;
+  os << indent << "Compute K-Distance Map : " << this->m_ComputeKDistanceMap << std::endl;
 
 }
 
@@ -40,7 +40,10 @@ std::string GetHelpString( void )
     << "Usage:\n"
     << "pxenhancement\n"
     << "  -in      inputFilename\n"
-    << "  -out     outputFilename[s]: enhancement [and optionally optimal scales]\n"
+    << "  -out     outputFilename[s]: enhancement [and optionally optimal scales],\n"
+    << "             for several methods first all enhancements, then all scales\n"
+    << "  [-mask]  maskFilename, only compute the enhancement in the mask,\n"
+    << "             the output is zero elsewhere\n"
     << "  [-std]   Gaussian smoothing standard deviation\n"
     << "             1 value: sigma\n"
     << "             3 values: sigmaMin, sigmaMax, nrOfSteps\n"
@@ -48,9 +51,15 @@ std::string GetHelpString( void )
     << "             {0 - Equispaced sigma steps, 1 - Logarithmic sigma steps }\n"
     << "             default: 1 - Logarithmic sigma steps\n"
     << "  [-rescaleoff]   Rescale off. Default on.\n"
+    << "  [-pyramid] compute the large scales on downsampled images, optionally followed\n"
+    << "             by the minimum number of voxels per sigma there, default 4.\n"
+    << "  [-float] compute in float also for double input, which halves the memory of\n"
+    << "             the Hessian; the output is then float. The relative difference\n"
+    << "             of the response is of the order of 1e-6. Default false.\n"
     << "  [-threads] maximum number of threads used, default all.\n"
     << std::endl
-    << "  [-m]     method, choose one of:\n"
+    << "  [-m]     method[s], choose one or more of the following; the Hessian of a\n"
+    << "             scale is then computed once for all methods:\n"
     << "             FrangiVesselness       - Frangi vesselness [1]\n"
     << "             StrainEnergyVesselness - Strain energy vesselness [2]\n"
     << "             ModifiedKrissianVesselness - vesselness based on Krissian paper [3,4]\n"
@@ -131,8 +140,11 @@ int main( int argc, char ** argv )
 
   //parameters.GenerateScalesOutput = ( parameters.outputFileNames.size() == 2 );
 
-  std::string method;
-  bool retmethod = parser->GetCommandLineArgument( "-m", method );
+  std::vector<std::string> methods;
+  parser->GetCommandLineArgument( "-m", methods );
+
+  std::string maskFileName = "";
+  parser->GetCommandLineArgument( "-mask", maskFileName );
 
   std::vector<double> std( 1, 1.0 );
   bool retstd = parser->GetCommandLineArgument( "-std", std );
@@ -142,9 +154,11 @@ int main( int argc, char ** argv )
 
   bool retrescale = parser->ArgumentExists( "-rescaleoff" );
 
-  unsigned int maxThreads = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
-  parser->GetCommandLineArgument( "-threads", maxThreads );
-  itk::MultiThreader::SetGlobalMaximumNumberOfThreads( maxThreads );
+  const bool useFloat = parser->ArgumentExists( "-float" );
+
+  const bool usePyramid = parser->ArgumentExists( "-pyramid" );
+  double pyramidVoxelsPerSigma = 4.0;
+  parser->GetCommandLineArgument( "-pyramid", pyramidVoxelsPerSigma );
 
   // Enhancement filter parameters
   double alpha = 0.5;
@@ -168,9 +182,15 @@ int main( int argc, char ** argv )
     std::cerr << "ERROR: You should specify 1 or 3 values for \"-std\"." << std::endl;
     return EXIT_FAILURE;
   }
-  if ( outputFileNames.size() != 1 && outputFileNames.size() != 2 )
+  if ( usePyramid && pyramidVoxelsPerSigma < 1.0 )
+  {
+    std::cerr << "ERROR: The number of voxels per sigma of \"-pyramid\" should be at least 1." << std::endl;
+    return EXIT_FAILURE;
+  }
+  if ( outputFileNames.size() != methods.size()
+    && outputFileNames.size() != 2 * methods.size() )
   {
-    std::cerr << "ERROR: You should specify 1 or 2 values for \"-out\"." << std::endl;
+    std::cerr << "ERROR: You should specify 1 or 2 values for \"-out\" per method." << std::endl;
     return EXIT_FAILURE;
   }
   if ( retssm && ( sigmaStepMethod != 0 && sigmaStepMethod != 1 ) )
@@ -222,8 +242,9 @@ int main( int argc, char ** argv )
   bool retNOCCheck = itktools::NumberOfComponentsCheck( numberOfComponents );
   if( !retNOCCheck ) return EXIT_FAILURE;
 
-  /** Component type should be at least float. */
-  if ( componentType != itk::ImageIOBase::FLOAT && componentType != itk::ImageIOBase::DOUBLE )
+  /** Component type should be at least float, and is float if requested. */
+  if ( useFloat
+    || ( componentType != itk::ImageIOBase::FLOAT && componentType != itk::ImageIOBase::DOUBLE ) )
   {
     componentType = itk::ImageIOBase::FLOAT;
   }
@@ -246,9 +267,12 @@ int main( int argc, char ** argv )
 
     /** Set the filter arguments. */
     filter->m_InputFileName = inputFileName;
+    filter->m_MaskFileName = maskFileName;
     filter->m_OutputFileNames = outputFileNames;
-    filter->m_Method = method;
+    filter->m_Methods = methods;
     filter->m_Rescale = !retrescale;
+    filter->m_UsePyramid = usePyramid;
+    filter->m_PyramidVoxelsPerSigma = pyramidVoxelsPerSigma;
     filter->m_SigmaStepMethod = sigmaStepMethod;
     filter->m_SigmaMinimum = sigmaMinimum;
     filter->m_SigmaMaximum = sigmaMaximum;
@@ -259,6 +283,7 @@ int main( int argc, char ** argv )
     filter->m_Nu = nu;
     filter->m_Kappa = kappa;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
@@ -54,9 +54,11 @@ public:
   ITKToolsEnhancementBase()
   {
     this->m_InputFileName = "";
-    this->m_Method = "";
+    this->m_MaskFileName = "";
 
     this->m_Rescale = true;
+    this->m_UsePyramid = false;
+    this->m_PyramidVoxelsPerSigma = 4.0;
 
     this->m_SigmaStepMethod = 1;
     this->m_SigmaMinimum = 1.0;
@@ -74,11 +76,14 @@ public:
 
   /** Input member parameters. */
   std::string                 m_InputFileName;
+  std::string                 m_MaskFileName;
   std::vector<std::string>    m_OutputFileNames;
 
-  std::string m_Method;
+  std::vector<std::string>    m_Methods;
 
   bool m_Rescale;
+  bool m_UsePyramid;
+  double m_PyramidVoxelsPerSigma;
 
   unsigned int m_SigmaStepMethod;
   double m_SigmaMinimum;
@@ -126,6 +131,8 @@ public:
     ::GradientMagnitudePixelType                      GradientMagnitudePixelType;
   typedef typename MultiScaleFilterType
     ::EigenValueArrayType                             EigenValueArrayType;
+  typedef typename MultiScaleFilterType::MaskImageType  MaskImageType;
+  typedef itk::ImageFileReader< MaskImageType >       MaskReaderType;
 
   /** Supported functors. */
   typedef itk::Functor::FrangiVesselnessFunctor<
@@ -161,7 +168,8 @@ public:
     typename MultiScaleFilterType::Pointer multiScaleFilter
       = MultiScaleFilterType::New();
 
-    const bool generateScalesOutput = ( this->m_OutputFileNames.size() > 1 );
+    const bool generateScalesOutput
+      = ( this->m_OutputFileNames.size() > this->m_Methods.size() );
 
     multiScaleFilter->SetSigmaMinimum( this->m_SigmaMinimum );
     multiScaleFilter->SetSigmaMaximum( this->m_SigmaMaximum );
@@ -170,10 +178,55 @@ public:
     multiScaleFilter->SetGenerateScalesOutput( generateScalesOutput );
     multiScaleFilter->SetSigmaStepMethod( this->m_SigmaStepMethod );
     multiScaleFilter->SetRescale( this->m_Rescale );
+    multiScaleFilter->SetUsePyramid( this->m_UsePyramid );
+    multiScaleFilter->SetPyramidVoxelsPerSigma( this->m_PyramidVoxelsPerSigma );
     multiScaleFilter->SetInput( reader->GetOutput() );
 
-    /** Setup the requested functor and connect it to the filter. */
-    if ( this->m_Method == "FrangiVesselness" )
+    /** Restrict the computation to the mask. */
+    typename MaskReaderType::Pointer maskReader;
+    if ( !this->m_MaskFileName.empty() )
+    {
+      maskReader = MaskReaderType::New();
+      maskReader->SetFileName( this->m_MaskFileName.c_str() );
+      maskReader->Update();
+      multiScaleFilter->SetMaskImage( maskReader->GetOutput() );
+    }
+
+    /** Setup the requested functors; all share the Hessian of a scale. */
+    for ( std::size_t i = 0; i < this->m_Methods.size(); ++i )
+    {
+      this->AddFunctor( multiScaleFilter, this->m_Methods[ i ] );
+    }
+
+    /** Write enhanced outputs, one per method. The filter runs once. */
+    this->ObserveProcess( reader.GetPointer(), "read" );
+    this->ObserveProcess( multiScaleFilter.GetPointer(), "enhancement" );
+    multiScaleFilter->Update();
+
+    const std::size_t numberOfMethods = this->m_Methods.size();
+    typename WriterType::Pointer writer = WriterType::New();
+    this->ObserveProcess( writer.GetPointer(), "write" );
+    for ( std::size_t i = 0; i < numberOfMethods; ++i )
+    {
+      writer->SetInput( multiScaleFilter->GetResponseOutput( i ) );
+      writer->SetFileName( this->m_OutputFileNames[ i ] );
+      writer->Update();
+
+      /** Write the maximum scale response. */
+      if( generateScalesOutput )
+      {
+        writer->SetInput( multiScaleFilter->GetScalesOutput( i ) );
+        writer->SetFileName( this->m_OutputFileNames[ numberOfMethods + i ] );
+        writer->Update();
+      }
+    }
+
+  } // end Run()
+
+  /** Create the functor of a method, and add it to the filter. */
+  void AddFunctor( MultiScaleFilterType * multiScaleFilter, const std::string & method )
+  {
+    if ( method == "FrangiVesselness" )
     {
       typename FrangiVesselnessFunctorType::Pointer functor
         = FrangiVesselnessFunctorType::New();
@@ -182,9 +235,9 @@ public:
       functor->SetC( this->m_C );
       functor->SetBrightObject( true );
 
-      multiScaleFilter->SetUnaryFunctor( functor );
+      multiScaleFilter->AddUnaryFunctor( functor );
     }
-    else if ( this->m_Method == "StrainEnergyVesselness" )
+    else if ( method == "StrainEnergyVesselness" )
     {
       typename StrainEnergyVesselnessFunctorType::Pointer functor
         = StrainEnergyVesselnessFunctorType::New();
@@ -194,18 +247,17 @@ public:
       functor->SetKappa( this->m_Kappa );
       functor->SetBrightObject( true );
 
-      multiScaleFilter->SetBinaryFunctor( functor );
+      multiScaleFilter->AddBinaryFunctor( functor );
     }
-    else if ( this->m_Method == "ModifiedKrissianVesselness" )
+    else if ( method == "ModifiedKrissianVesselness" )
     {
       typename ModifiedKrissianVesselnessFunctorType::Pointer functor
         = ModifiedKrissianVesselnessFunctorType::New();
       functor->SetBrightObject( true );
 
-      multiScaleFilter->SetUnaryFunctor( functor );
+      multiScaleFilter->AddUnaryFunctor( functor );
     }
-    /** Setup the requested functor and connect it to the filter. */
-    else if ( this->m_Method == "FrangiSheetness" )
+    else if ( method == "FrangiSheetness" )
     {
       typename FrangiSheetnessFunctorType::Pointer functor
         = FrangiSheetnessFunctorType::New();
@@ -214,9 +266,9 @@ public:
       functor->SetC( this->m_C );
       functor->SetBrightObject( true );
 
-      multiScaleFilter->SetUnaryFunctor( functor );
+      multiScaleFilter->AddUnaryFunctor( functor );
     }
-    else if ( this->m_Method == "DescoteauxSheetness" )
+    else if ( method == "DescoteauxSheetness" )
     {
       typename DescoteauxSheetnessFunctorType::Pointer functor
         = DescoteauxSheetnessFunctorType::New();
@@ -225,9 +277,9 @@ public:
       functor->SetC( this->m_C );
       functor->SetBrightObject( true );
 
-      multiScaleFilter->SetUnaryFunctor( functor );
+      multiScaleFilter->AddUnaryFunctor( functor );
     }
-    else if ( this->m_Method == "StrainEnergySheetness" )
+    else if ( method == "StrainEnergySheetness" )
     {
       typename StrainEnergySheetnessFunctorType::Pointer functor
         = StrainEnergySheetnessFunctorType::New();
@@ -237,9 +289,9 @@ public:
       functor->SetKappa( this->m_Kappa );
       functor->SetBrightObject( true );
 
-      multiScaleFilter->SetBinaryFunctor( functor );
+      multiScaleFilter->AddBinaryFunctor( functor );
     }
-    else if ( this->m_Method == "FrangiXiaoSheetness" )
+    else if ( method == "FrangiXiaoSheetness" )
     {
       typename FrangiXiaoSheetnessFunctorType::Pointer functor
         = FrangiXiaoSheetnessFunctorType::New();
@@ -249,9 +301,9 @@ public:
       functor->SetKappa( this->m_Kappa );
       functor->SetBrightObject( true );
 
-      multiScaleFilter->SetBinaryFunctor( functor );
+      multiScaleFilter->AddBinaryFunctor( functor );
     }
-    else if ( this->m_Method == "DescoteauxXiaoSheetness" )
+    else if ( method == "DescoteauxXiaoSheetness" )
     {
       typename DescoteauxXiaoSheetnessFunctorType::Pointer functor
         = DescoteauxXiaoSheetnessFunctorType::New();
@@ -261,28 +313,14 @@ public:
       functor->SetKappa( this->m_Kappa );
       functor->SetBrightObject( true );
 
-      multiScaleFilter->SetBinaryFunctor( functor );
+      multiScaleFilter->AddBinaryFunctor( functor );
     }
     else
     {
-      itkGenericExceptionMacro( << "ERROR: unknown method " << this->m_Method << "!" );
+      itkGenericExceptionMacro( << "ERROR: unknown method " << method << "!" );
     }
 
-    /** Write enhanced output. */
-    typename WriterType::Pointer writer = WriterType::New();
-    writer->SetInput( multiScaleFilter->GetOutput() );
-    writer->SetFileName( this->m_OutputFileNames[ 0 ] );
-    writer->Update();
-
-    /** Write the maximumn scale response. */
-    if( generateScalesOutput )
-    {
-      writer->SetInput( multiScaleFilter->GetOutput( 1 ) );
-      writer->SetFileName( this->m_OutputFileNames[ 1 ] );
-      writer->Update();
-    }
-
-  } // end Run()
+  } // end AddFunctor()
 
 }; // end class ITKToolsEnhancement
 
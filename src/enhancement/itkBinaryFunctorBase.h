@@ -20,6 +20,19 @@
 
 #include "itkObject.h"
 
+/** Overrides EvaluateRange() in a functor deriving from BinaryFunctorBase,
+ * with a loop over the Evaluate() of the class itself. */
+#define itkBinaryFunctorEvaluateRangeMacro()                                  \
+  virtual void EvaluateRange( const typename Superclass::Input1Type * input1, \
+    const typename Superclass::Input2Type * input2,                           \
+    typename Superclass::OutputType * output, const SizeValueType n ) const   \
+  {                                                                           \
+    for( SizeValueType i = 0; i < n; ++i )                                    \
+    {                                                                         \
+      output[ i ] = this->Self::Evaluate( input1[ i ], input2[ i ] );         \
+    }                                                                         \
+  }
+
 namespace itk
 {
 /** \class BinaryFunctorBase
@@ -59,6 +72,20 @@ public:
     return NumericTraits<TOutput>::Zero;
   }
 
+  /** Evaluate n contiguous pairs of values. The filters call this once
+   * per line, so that the virtual call is made once per line instead of
+   * once per pixel. Derived functors override it with
+   * itkBinaryFunctorEvaluateRangeMacro, in which Evaluate() is bound at
+   * compile time and can be inlined. */
+  virtual void EvaluateRange( const TInput1 * input1, const TInput2 * input2,
+    TOutput * output, const SizeValueType n ) const
+  {
+    for( SizeValueType i = 0; i < n; ++i )
+    {
+      output[ i ] = this->Evaluate( input1[ i ], input2[ i ] );
+    }
+  }
+
 protected:
   BinaryFunctorBase(){};
   virtual ~BinaryFunctorBase(){};
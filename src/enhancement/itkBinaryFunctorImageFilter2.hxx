@@ -20,6 +20,7 @@
 
 #include "itkBinaryFunctorImageFilter2.h"
 #include "itkImageRegionIterator.h"
+#include "itkImageLinearIteratorWithIndex.h"
 #include "itkProgressReporter.h"
 
 namespace itk
@@ -204,12 +205,18 @@ BinaryFunctorImageFilter2< TInputImage1, TInputImage2, TOutputImage >
 
   if( inputPtr1 && inputPtr2 )
     {
-    ImageRegionConstIterator< TInputImage1 > inputIt1(inputPtr1, outputRegionForThread);
-    ImageRegionConstIterator< TInputImage2 > inputIt2(inputPtr2, outputRegionForThread);
-
-    ImageRegionIterator< TOutputImage > outputIt(outputPtr, outputRegionForThread);
+    // Walk the region line by line, the functor evaluates a whole line
+    // with a single virtual call.
+    ImageLinearConstIteratorWithIndex< TInputImage1 > inputIt1(inputPtr1, outputRegionForThread);
+    ImageLinearConstIteratorWithIndex< TInputImage2 > inputIt2(inputPtr2, outputRegionForThread);
+    ImageLinearIteratorWithIndex< TOutputImage > outputIt(outputPtr, outputRegionForThread);
+    inputIt1.SetDirection( 0 );
+    inputIt2.SetDirection( 0 );
+    outputIt.SetDirection( 0 );
 
-    ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() );
+    const SizeValueType lineLength = outputRegionForThread.GetSize( 0 );
+    ProgressReporter progress( this, threadId,
+      outputRegionForThread.GetNumberOfPixels() / lineLength );
 
     inputIt1.GoToBegin();
     inputIt2.GoToBegin();
@@ -217,10 +224,11 @@ BinaryFunctorImageFilter2< TInputImage1, TInputImage2, TOutputImage >
 
     while ( !inputIt1.IsAtEnd() )
       {
-      outputIt.Set( m_Functor->Evaluate( inputIt1.Get(), inputIt2.Get() ) );
-      ++inputIt2;
-      ++inputIt1;
-      ++outputIt;
+      m_Functor->EvaluateRange( &inputIt1.Value(), &inputIt2.Value(),
+        &outputIt.Value(), lineLength );
+      inputIt2.NextLine();
+      inputIt1.NextLine();
+      outputIt.NextLine();
       progress.CompletedPixel(); // potential exception thrown here
       }
     }
@@ -115,6 +115,9 @@ public:
     return static_cast<TOutput>( sheetness );
   } // end operator ()
 
+  /** Evaluate a line, with Evaluate() bound at compile time. */
+  itkUnaryFunctorEvaluateRangeMacro();
+
   /** Set parameters */
   itkSetClampMacro( Alpha, double, 0.0, NumericTraits<double>::max() );
   itkSetClampMacro( Beta, double, 0.0, NumericTraits<double>::max() );
@@ -138,6 +138,9 @@ public:
     return static_cast<TOutput>( sheetness );
   } // end Evaluate()
 
+  /** Evaluate a line, with Evaluate() bound at compile time. */
+  itkBinaryFunctorEvaluateRangeMacro();
+
   /** Set parameters */
   itkSetClampMacro( Alpha, double, 0.0, NumericTraits<double>::max() );
   itkSetClampMacro( Beta, double, 0.0, NumericTraits<double>::max() );
@@ -28,9 +28,12 @@
 
 #include "itkSymmetricSecondRankTensor.h"
 #include "itkSymmetricEigenAnalysisImageFilter.h"
+#include "itkSymmetricEigenValuesImageFilter.h"
 #include "itkGradientMagnitudeRecursiveGaussianImageFilter.h"
 #include "itkHessianRecursiveGaussianImageFilter.h"
 #include "itkRescaleIntensityImageFilter.h"
+#include "itkExtractImageFilter.h"
+#include <vector>
 
 namespace itk
 {
@@ -39,6 +42,19 @@ namespace itk
  * \brief A filter to enhance image structures using Hessian
  *     measures in a single scale framework.
  *
+ * If a mask is set, the response is only computed in the bounding box
+ * of the nonzero mask voxels. The derivatives are computed on the input
+ * in that box plus the support of the Gaussian kernels, four sigma, and
+ * so are the eigen analysis and the functor. The output is zero outside
+ * the mask; rescaling is done after masking.
+ *
+ * Several measures can be computed from the same derivatives: every
+ * functor added with AddUnaryFunctor() or AddBinaryFunctor() gives an
+ * output, in the order in which they were added. The Hessian, its
+ * eigenvalues and, if a binary functor is used, the gradient magnitude are
+ * then computed once for all measures. SetUnaryFunctor() and
+ * SetBinaryFunctor() replace all measures by a single one.
+ *
  * \ingroup IntensityImageFilters Singlethreaded
  */
 
@@ -65,6 +81,8 @@ public:
   typedef typename InputImageType::PixelType        InputPixelType;
   typedef typename OutputImageType::PixelType       OutputPixelType;
 
+  typedef typename InputImageType::RegionType       InputImageRegionType;
+
   typedef typename NumericTraits<OutputPixelType>::RealType RealType;
 
   /** Image dimension = 3. */
@@ -95,6 +113,17 @@ public:
   typedef SymmetricEigenAnalysisImageFilter<
     HessianTensorImageType, EigenValueImageType > EigenAnalysisFilterType;
 
+  /** Closed form eigenvalue filter, used in 2D and 3D */
+  typedef SymmetricEigenValuesImageFilter<
+    HessianTensorImageType, EigenValueImageType > EigenValuesFilterType;
+
+  /** Mask image type, and the filter extracting the region of the mask. */
+  typedef Image< unsigned char,
+    itkGetStaticConstMacro( ImageDimension ) >    MaskImageType;
+  typedef typename MaskImageType::Pointer         MaskImagePointer;
+  typedef ExtractImageFilter<
+    InputImageType, InputImageType >              ExtractFilterType;
+
   /** Rescale filter type */
   typedef RescaleIntensityImageFilter<
     OutputImageType, OutputImageType >            RescaleFilterType;
@@ -112,19 +141,40 @@ public:
     OutputImageType >                             BinaryFunctorImageFilterType;
   typedef typename BinaryFunctorImageFilterType::FunctorType BinaryFunctorBaseType;
 
-  /** Set/Get unary functor filter */
+  /** Set the unary functor of a single measure, replacing all measures. */
   virtual void SetUnaryFunctor( UnaryFunctorBaseType * _arg );
-  itkGetObjectMacro( UnaryFunctor, UnaryFunctorBaseType );
 
-  /** Set/Get binary functor filter */
+  /** Set the binary functor of a single measure, replacing all measures. */
   virtual void SetBinaryFunctor( BinaryFunctorBaseType * _arg );
-  itkGetObjectMacro( BinaryFunctor, BinaryFunctorBaseType );
+
+  /** Add a measure computed by a unary or a binary functor. Its response
+   * is the output with the index of the measure. */
+  virtual void AddUnaryFunctor( UnaryFunctorBaseType * _arg );
+  virtual void AddBinaryFunctor( BinaryFunctorBaseType * _arg );
+
+  /** Remove all measures. */
+  virtual void ClearFunctors( void );
+
+  /** Get the number of measures, i.e. of outputs. */
+  unsigned int GetNumberOfMeasures( void ) const
+  {
+    return static_cast<unsigned int>( this->m_UnaryFunctors.size() );
+  }
+
+  /** Get the functor of a measure; 0 if it is of the other kind. */
+  UnaryFunctorBaseType * GetUnaryFunctor( unsigned int measure = 0 ) const;
+  BinaryFunctorBaseType * GetBinaryFunctor( unsigned int measure = 0 ) const;
 
   /** Set/Get macros for Sigma. The current scale used.
    * Sigma should be positive. */
   itkSetClampMacro( Sigma, double, 0.0, NumericTraits<double>::max() );
   itkGetConstReferenceMacro( Sigma, double );
 
+  /** Set/Get the mask. It should have the size of the input. When set,
+   * the response is only computed around the nonzero voxels of it. */
+  itkSetObjectMacro( MaskImage, MaskImageType );
+  itkGetObjectMacro( MaskImage, MaskImageType );
+
   /** Methods to turn on/off flag to rescale function output */
   itkSetMacro( Rescale, bool );
   itkGetConstMacro( Rescale, bool );
@@ -154,6 +204,13 @@ protected:
   virtual void PrintSelf(std::ostream& os, Indent indent) const;
   virtual void GenerateData( void );
 
+  /** Compute the bounding box of the nonzero mask voxels; returns false
+   * if the mask is empty. */
+  bool ComputeMaskBoundingBox( InputImageRegionType & region ) const;
+
+  /** Add a measure; exactly one of the functors is set. */
+  void AddMeasure( UnaryFunctorBaseType * unary, BinaryFunctorBaseType * binary );
+
 private:
   GaussianEnhancementImageFilter(const Self&); //purposely not implemented
   void operator=(const Self&); //purposely not implemented
@@ -162,12 +219,13 @@ private:
   typename GradientMagnitudeFilterType::Pointer   m_GradientMagnitudeFilter;
   typename HessianFilterType::Pointer             m_HessianFilter;
   typename EigenAnalysisFilterType::Pointer       m_SymmetricEigenValueFilter;
-  typename RescaleFilterType::Pointer             m_RescaleFilter;
+  typename EigenValuesFilterType::Pointer         m_ClosedFormEigenValueFilter;
+  typename ExtractFilterType::Pointer             m_ExtractFilter;
+  MaskImagePointer                                m_MaskImage;
 
-  typename UnaryFunctorBaseType::Pointer m_UnaryFunctor;
-  typename BinaryFunctorBaseType::Pointer m_BinaryFunctor;
-  typename UnaryFunctorImageFilterType::Pointer   m_UnaryFunctorFilter;
-  typename BinaryFunctorImageFilterType::Pointer  m_BinaryFunctorFilter;
+  /** The functors of the measures; per measure one of them is set. */
+  std::vector<typename UnaryFunctorBaseType::Pointer>   m_UnaryFunctors;
+  std::vector<typename BinaryFunctorBaseType::Pointer>  m_BinaryFunctors;
 
   double  m_Sigma;
   bool    m_Rescale;
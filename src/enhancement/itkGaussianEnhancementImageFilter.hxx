@@ -19,6 +19,8 @@
 #define __itkGaussianEnhancementImageFilter_hxx
 
 #include "itkGaussianEnhancementImageFilter.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIterator.h"
 
 namespace itk
 {
@@ -31,10 +33,6 @@ template < typename TInPixel, typename TOutPixel >
 GaussianEnhancementImageFilter< TInPixel, TOutPixel >
 ::GaussianEnhancementImageFilter()
 {
-  this->m_UnaryFunctor = NULL;
-  this->m_BinaryFunctor = NULL;
-  this->m_UnaryFunctorFilter = UnaryFunctorImageFilterType::New();//needed to be global?
-  this->m_BinaryFunctorFilter = BinaryFunctorImageFilterType::New();
   this->m_Sigma = 1.0;
   this->m_Rescale = true;
   this->m_NormalizeAcrossScale = true;
@@ -52,17 +50,16 @@ GaussianEnhancementImageFilter< TInPixel, TOutPixel >
   this->m_SymmetricEigenValueFilter->SetDimension( ImageDimension );
   this->m_SymmetricEigenValueFilter->OrderEigenValuesBy(
     EigenAnalysisFilterType::FunctorType::OrderByValue );//OrderByMagnitude?
+  this->m_ClosedFormEigenValueFilter = EigenValuesFilterType::New();
 
-  // Construct the rescale filter
-  this->m_RescaleFilter = RescaleFilterType::New();
-  this->m_RescaleFilter->SetOutputMinimum( 0.0 );
-  this->m_RescaleFilter->SetOutputMaximum( 1.0 );
+  // Construct the filter extracting the region of the mask
+  this->m_ExtractFilter = ExtractFilterType::New();
+  this->m_ExtractFilter->SetDirectionCollapseToSubmatrix();
+  this->m_MaskImage = 0;
 
-  // Allow progressive memory release
+  // Allow progressive memory release. The gradient magnitude and the
+  // eigenvalues are used by all measures, and released in GenerateData().
   this->m_HessianFilter->ReleaseDataFlagOn();
-  this->m_GradientMagnitudeFilter->ReleaseDataFlagOn();
-  this->m_SymmetricEigenValueFilter->ReleaseDataFlagOn();
-  this->m_RescaleFilter->ReleaseDataFlagOn();
 
 } // end Constructor
 
@@ -76,13 +73,10 @@ void
 GaussianEnhancementImageFilter< TInPixel, TOutPixel >
 ::SetUnaryFunctor( UnaryFunctorBaseType * _arg )
 {
-  if ( this->m_UnaryFunctor != _arg )
+  if ( this->GetNumberOfMeasures() != 1 || this->GetUnaryFunctor() != _arg )
   {
-    // Only one of them should be initialized
-    this->m_UnaryFunctor = _arg;
-    this->m_UnaryFunctorFilter->SetFunctor( _arg );
-    this->m_BinaryFunctor = NULL;
-    this->Modified();
+    this->ClearFunctors();
+    this->AddMeasure( _arg, NULL );
   }
 } // end SetUnaryFunctor()
 
@@ -96,17 +90,107 @@ void
 GaussianEnhancementImageFilter< TInPixel, TOutPixel >
 ::SetBinaryFunctor( BinaryFunctorBaseType * _arg )
 {
-  if ( this->m_BinaryFunctor != _arg )
+  if ( this->GetNumberOfMeasures() != 1 || this->GetBinaryFunctor() != _arg )
   {
-    // Only one of them should be initialized
-    this->m_BinaryFunctor = _arg;
-    this->m_BinaryFunctorFilter->SetFunctor( _arg );
-    this->m_UnaryFunctor = NULL;
-    this->Modified();
+    this->ClearFunctors();
+    this->AddMeasure( NULL, _arg );
   }
 } // end SetBinaryFunctor()
 
 
+/**
+ * ********************* AddUnaryFunctor ****************************
+ */
+
+template < typename TInPixel, typename TOutPixel >
+void
+GaussianEnhancementImageFilter< TInPixel, TOutPixel >
+::AddUnaryFunctor( UnaryFunctorBaseType * _arg )
+{
+  this->AddMeasure( _arg, NULL );
+} // end AddUnaryFunctor()
+
+
+/**
+ * ********************* AddBinaryFunctor ****************************
+ */
+
+template < typename TInPixel, typename TOutPixel >
+void
+GaussianEnhancementImageFilter< TInPixel, TOutPixel >
+::AddBinaryFunctor( BinaryFunctorBaseType * _arg )
+{
+  this->AddMeasure( NULL, _arg );
+} // end AddBinaryFunctor()
+
+
+/**
+ * ********************* AddMeasure ****************************
+ */
+
+template < typename TInPixel, typename TOutPixel >
+void
+GaussianEnhancementImageFilter< TInPixel, TOutPixel >
+::AddMeasure( UnaryFunctorBaseType * unary, BinaryFunctorBaseType * binary )
+{
+  this->m_UnaryFunctors.push_back( unary );
+  this->m_BinaryFunctors.push_back( binary );
+
+  // Every measure has an output; the first one always exists.
+  const unsigned int numberOfMeasures = this->GetNumberOfMeasures();
+  if ( numberOfMeasures > 1 )
+  {
+    this->SetNumberOfRequiredOutputs( numberOfMeasures );
+    this->SetNthOutput( numberOfMeasures - 1, this->MakeOutput( numberOfMeasures - 1 ) );
+  }
+  this->Modified();
+} // end AddMeasure()
+
+
+/**
+ * ********************* ClearFunctors ****************************
+ */
+
+template < typename TInPixel, typename TOutPixel >
+void
+GaussianEnhancementImageFilter< TInPixel, TOutPixel >
+::ClearFunctors( void )
+{
+  this->m_UnaryFunctors.clear();
+  this->m_BinaryFunctors.clear();
+  this->SetNumberOfRequiredOutputs( 1 );
+  this->Modified();
+} // end ClearFunctors()
+
+
+/**
+ * ********************* GetUnaryFunctor ****************************
+ */
+
+template < typename TInPixel, typename TOutPixel >
+typename GaussianEnhancementImageFilter< TInPixel, TOutPixel >::UnaryFunctorBaseType *
+GaussianEnhancementImageFilter< TInPixel, TOutPixel >
+::GetUnaryFunctor( unsigned int measure ) const
+{
+  if ( measure >= this->GetNumberOfMeasures() ) return NULL;
+  return this->m_UnaryFunctors[ measure ].GetPointer();
+} // end GetUnaryFunctor()
+
+
+/**
+ * ********************* GetBinaryFunctor ****************************
+ */
+
+template < typename TInPixel, typename TOutPixel >
+typename GaussianEnhancementImageFilter< TInPixel, TOutPixel >::BinaryFunctorBaseType *
+GaussianEnhancementImageFilter< TInPixel, TOutPixel >
+::GetBinaryFunctor( unsigned int measure ) const
+{
+  if ( measure >= this->GetNumberOfMeasures() ) return NULL;
+  return this->m_BinaryFunctors[ measure ].GetPointer();
+} // end GetBinaryFunctor()
+
+
 /**
  * ********************* SetNumberOfThreads ****************************
  */
@@ -121,16 +205,8 @@ GaussianEnhancementImageFilter< TInPixel, TOutPixel >
   this->m_GradientMagnitudeFilter->SetNumberOfThreads( nt );
   this->m_HessianFilter->SetNumberOfThreads( nt );
   this->m_SymmetricEigenValueFilter->SetNumberOfThreads( nt );
-  this->m_RescaleFilter->SetNumberOfThreads( nt );
-
-  if ( this->m_UnaryFunctorFilter.IsNotNull() )
-  {
-    this->m_UnaryFunctorFilter->SetNumberOfThreads( nt );
-  }
-  else if( this->m_BinaryFunctorFilter.IsNotNull() )
-  {
-    this->m_BinaryFunctorFilter->SetNumberOfThreads( nt );
-  }
+  this->m_ClosedFormEigenValueFilter->SetNumberOfThreads( nt );
+  this->m_ExtractFilter->SetNumberOfThreads( nt );
 
   if ( this->GetNumberOfThreads() != ( nt < 1 ? 1 : ( nt > ITK_MAX_THREADS ? ITK_MAX_THREADS : nt ) ) )
   {
@@ -170,76 +246,219 @@ void
 GaussianEnhancementImageFilter< TInPixel, TOutPixel >
 ::GenerateData( void )
 {
-  if ( this->m_UnaryFunctor.IsNull()
-    && this->m_BinaryFunctor.IsNull() )
+  const unsigned int numberOfMeasures = this->GetNumberOfMeasures();
+  if ( numberOfMeasures == 0 )
   {
     itkExceptionMacro( << "ERROR: Missing Functor. "
       << "Please provide functor for multi scale framework." );
   }
 
-  // Define if we going to use gradient magnitude based on if BinaryFunctorFilter
-  // has been provided
-  if ( this->m_BinaryFunctor.IsNotNull() )
+  // The last measure that needs the gradient magnitude, if any.
+  int lastBinaryMeasure = -1;
+  for ( unsigned int m = 0; m < numberOfMeasures; ++m )
+  {
+    if ( this->m_UnaryFunctors[ m ].IsNull() && this->m_BinaryFunctors[ m ].IsNull() )
+    {
+      itkExceptionMacro( << "ERROR: the functor of measure " << m << " is not set." );
+    }
+    if ( this->m_BinaryFunctors[ m ].IsNotNull() ) lastBinaryMeasure = m;
+  }
+
+  // With a mask, compute the response on the bounding box of the mask,
+  // padded with the support of the Gaussian kernels.
+  typename InputImageType::ConstPointer input = this->GetInput();
+  const InputImageRegionType largestRegion = input->GetLargestPossibleRegion();
+  InputImageRegionType responseRegion = largestRegion;
+  const InputImageType * source = input;
+  if ( this->m_MaskImage.IsNotNull() )
+  {
+    if ( this->m_MaskImage->GetLargestPossibleRegion() != largestRegion
+      || this->m_MaskImage->GetBufferedRegion() != largestRegion )
+    {
+      itkExceptionMacro( << "ERROR: the mask should be buffered, "
+        << "and have the size of the input." );
+    }
+
+    if ( !this->ComputeMaskBoundingBox( responseRegion ) )
+    {
+      // Nothing to compute for an empty mask.
+      for ( unsigned int m = 0; m < numberOfMeasures; ++m )
+      {
+        typename OutputImageType::Pointer output = this->GetOutput( m );
+        output->SetBufferedRegion( output->GetRequestedRegion() );
+        output->Allocate();
+        output->FillBuffer( NumericTraits<OutputPixelType>::Zero );
+      }
+      return;
+    }
+
+    typename InputImageRegionType::SizeType radius;
+    for ( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+      radius[ i ] = static_cast<SizeValueType>(
+        vcl_ceil( 4.0 * this->m_Sigma / input->GetSpacing()[ i ] ) ) + 1;
+    }
+    responseRegion.PadByRadius( radius );
+    responseRegion.Crop( largestRegion );
+
+    this->m_ExtractFilter->SetInput( input );
+    this->m_ExtractFilter->SetExtractionRegion( responseRegion );
+    source = this->m_ExtractFilter->GetOutput();
+  }
+
+  // Calculate the gradient magnitude scalar image, once, if a binary
+  // functor needs it.
+  if ( lastBinaryMeasure >= 0 )
   {
-    // Calculate the gradient magnitude scalar image.
-    this->m_GradientMagnitudeFilter->SetInput( this->GetInput() );
+    this->m_GradientMagnitudeFilter->SetInput( source );
     this->m_GradientMagnitudeFilter->SetSigma( this->m_Sigma );
     this->m_GradientMagnitudeFilter->Update();
   }
 
-  // Calculate the eigenvalue vector image.
-  this->m_HessianFilter->SetInput( this->GetInput() );
+  // Calculate the eigenvalue vector image, once for all measures.
+  this->m_HessianFilter->SetInput( source );
   this->m_HessianFilter->SetSigma( this->m_Sigma );
 
-  this->m_SymmetricEigenValueFilter->SetInput( this->m_HessianFilter->GetOutput() );
-  this->m_SymmetricEigenValueFilter->Update();
-
-  if ( this->m_BinaryFunctor.IsNotNull() )
+  // In 2D and 3D the eigenvalues are computed in closed form.
+  typename EigenValueImageType::Pointer eigenValues;
+  if ( ImageDimension == 2 || ImageDimension == 3 )
   {
-    // Calculate binary functor filter.
-    this->m_BinaryFunctorFilter->SetInput1(
-      this->m_GradientMagnitudeFilter->GetOutput() );
-    this->m_BinaryFunctorFilter->SetInput2(
-      this->m_SymmetricEigenValueFilter->GetOutput() );
-    this->m_BinaryFunctorFilter->Update();
+    this->m_ClosedFormEigenValueFilter->SetInput( this->m_HessianFilter->GetOutput() );
+    this->m_ClosedFormEigenValueFilter->Update();
+    eigenValues = this->m_ClosedFormEigenValueFilter->GetOutput();
   }
   else
   {
-    // Calculate unary functor filter.
-    this->m_UnaryFunctorFilter->SetInput(
-      this->m_SymmetricEigenValueFilter->GetOutput() );
-    this->m_UnaryFunctorFilter->Update();
+    this->m_SymmetricEigenValueFilter->SetInput( this->m_HessianFilter->GetOutput() );
+    this->m_SymmetricEigenValueFilter->Update();
+    eigenValues = this->m_SymmetricEigenValueFilter->GetOutput();
   }
 
-  // Apply rescale
-  if( this->m_Rescale )
+  for ( unsigned int m = 0; m < numberOfMeasures; ++m )
   {
-    // Rescale the output to [0,1].
-    if ( this->m_BinaryFunctor.IsNotNull() )
+    typename OutputImageType::Pointer response;
+    if ( this->m_BinaryFunctors[ m ].IsNotNull() )
     {
-      this->m_RescaleFilter->SetInput( this->m_BinaryFunctorFilter->GetOutput() );
+      // Calculate binary functor filter.
+      typename BinaryFunctorImageFilterType::Pointer functorFilter
+        = BinaryFunctorImageFilterType::New();
+      functorFilter->SetFunctor( this->m_BinaryFunctors[ m ] );
+      functorFilter->SetNumberOfThreads( this->GetNumberOfThreads() );
+      functorFilter->SetInput1( this->m_GradientMagnitudeFilter->GetOutput() );
+      functorFilter->SetInput2( eigenValues );
+      functorFilter->Update();
+      response = functorFilter->GetOutput();
     }
     else
     {
-      this->m_RescaleFilter->SetInput( this->m_UnaryFunctorFilter->GetOutput() );
+      // Calculate unary functor filter.
+      typename UnaryFunctorImageFilterType::Pointer functorFilter
+        = UnaryFunctorImageFilterType::New();
+      functorFilter->SetFunctor( this->m_UnaryFunctors[ m ] );
+      functorFilter->SetNumberOfThreads( this->GetNumberOfThreads() );
+      functorFilter->SetInput( eigenValues );
+      functorFilter->Update();
+      response = functorFilter->GetOutput();
     }
-    this->m_RescaleFilter->Update();
 
-    // Put the output of the rescale filter to this filter's output.
-    this->GraftOutput( this->m_RescaleFilter->GetOutput() );
+    // Release the derivatives after their last use.
+    if ( static_cast<int>( m ) == lastBinaryMeasure )
+    {
+      this->m_GradientMagnitudeFilter->GetOutput()->ReleaseData();
+    }
+    if ( m + 1 == numberOfMeasures )
+    {
+      eigenValues->ReleaseData();
+    }
+
+    // Copy the response inside the mask to an image of the input size,
+    // which is zero elsewhere.
+    if ( this->m_MaskImage.IsNotNull() )
+    {
+      typename OutputImageType::Pointer masked = OutputImageType::New();
+      masked->CopyInformation( input );
+      masked->SetRegions( largestRegion );
+      masked->Allocate();
+      masked->FillBuffer( NumericTraits<OutputPixelType>::Zero );
+
+      ImageRegionConstIterator< MaskImageType >   maskIt( this->m_MaskImage, responseRegion );
+      ImageRegionConstIterator< OutputImageType > responseIt( response, responseRegion );
+      ImageRegionIterator< OutputImageType >      maskedIt( masked, responseRegion );
+      for ( ; !maskIt.IsAtEnd(); ++maskIt, ++responseIt, ++maskedIt )
+      {
+        if ( maskIt.Get() != 0 )
+        {
+          maskedIt.Set( responseIt.Get() );
+        }
+      }
+      response->ReleaseData();
+      response = masked;
+    }
+
+    // Apply rescale
+    if( this->m_Rescale )
+    {
+      // Rescale the output to [0,1].
+      typename RescaleFilterType::Pointer rescaleFilter = RescaleFilterType::New();
+      rescaleFilter->SetOutputMinimum( 0.0 );
+      rescaleFilter->SetOutputMaximum( 1.0 );
+      rescaleFilter->SetNumberOfThreads( this->GetNumberOfThreads() );
+      rescaleFilter->SetInput( response );
+      rescaleFilter->Update();
+      response = rescaleFilter->GetOutput();
+    }
+
+    // Put the response to the output of this measure.
+    this->GraftNthOutput( m, response );
   }
-  else
+} // end GenerateData()
+
+
+/**
+ * ********************* ComputeMaskBoundingBox ****************************
+ */
+
+template < typename TInPixel, typename TOutPixel >
+bool
+GaussianEnhancementImageFilter< TInPixel, TOutPixel >
+::ComputeMaskBoundingBox( InputImageRegionType & region ) const
+{
+  typedef typename InputImageRegionType::IndexType IndexType;
+  IndexType minIndex, maxIndex;
+  bool empty = true;
+
+  ImageRegionConstIteratorWithIndex< MaskImageType > it(
+    this->m_MaskImage, this->m_MaskImage->GetLargestPossibleRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
   {
-    if ( this->m_BinaryFunctor.IsNotNull() )
+    if ( it.Get() == 0 ) continue;
+
+    const IndexType & index = it.GetIndex();
+    if ( empty )
     {
-      this->GraftOutput( this->m_BinaryFunctorFilter->GetOutput() );
+      minIndex = index;
+      maxIndex = index;
+      empty = false;
+      continue;
     }
-    else
+    for ( unsigned int i = 0; i < ImageDimension; ++i )
     {
-      this->GraftOutput( this->m_UnaryFunctorFilter->GetOutput() );
+      minIndex[ i ] = vnl_math_min( minIndex[ i ], index[ i ] );
+      maxIndex[ i ] = vnl_math_max( maxIndex[ i ], index[ i ] );
     }
   }
-} // end GenerateData()
+  if ( empty ) return false;
+
+  typename InputImageRegionType::SizeType size;
+  for ( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    size[ i ] = static_cast<SizeValueType>( maxIndex[ i ] - minIndex[ i ] + 1 );
+  }
+  region.SetIndex( minIndex );
+  region.SetSize( size );
+
+  return true;
+} // end ComputeMaskBoundingBox()
 
 
 /**
@@ -256,15 +475,21 @@ GaussianEnhancementImageFilter< TInPixel, TOutPixel >
   os << indent << "Sigma: " << this->m_Sigma << std::endl;
   os << indent << "Rescale: " << this->m_Rescale << std::endl;
   os << indent << "NormalizeAcrossScale: " << this->m_NormalizeAcrossScale << std::endl;
+  os << indent << "MaskImage: " << this->m_MaskImage.GetPointer() << std::endl;
+
+  os << indent << "NumberOfMeasures: " << this->GetNumberOfMeasures() << std::endl;
 
   Indent nextIndent = indent.GetNextIndent();
-  if ( this->m_BinaryFunctorFilter.IsNotNull() )
-  {
-    this->m_BinaryFunctorFilter->Print( os, nextIndent );
-  }
-  else
+  for ( unsigned int m = 0; m < this->GetNumberOfMeasures(); ++m )
   {
-    this->m_UnaryFunctorFilter->Print( os, nextIndent );
+    if ( this->m_BinaryFunctors[ m ].IsNotNull() )
+    {
+      this->m_BinaryFunctors[ m ]->Print( os, nextIndent );
+    }
+    else
+    {
+      this->m_UnaryFunctors[ m ]->Print( os, nextIndent );
+    }
   }
 } // end PrintSelf()
 
@@ -106,6 +106,9 @@ public:
     return static_cast<TOutput>( vesselness );
   } // end operator ()
 
+  /** Evaluate a line, with Evaluate() bound at compile time. */
+  itkUnaryFunctorEvaluateRangeMacro();
+
   /** Set parameters */
   itkSetMacro( BrightObject, bool );
 
@@ -19,6 +19,10 @@
 #define __itkMultiScaleGaussianEnhancementImageFilter_h
 
 #include "itkGaussianEnhancementImageFilter.h"
+#include "itkSmoothingRecursiveGaussianImageFilter.h"
+#include "itkShrinkImageFilter.h"
+#include "itkShiftScaleImageFilter.h"
+#include "itkResampleImageFilter.h"
 
 namespace itk
 {
@@ -34,6 +38,29 @@ namespace itk
  * The filter computes a second output image (accessed by the GetScalesOutput method)
  * containing the scales at which each pixel gave the best response.
  *
+ * With UsePyramid on, the large scales are computed on a downsampled image.
+ * The shrink factor of a dimension is the largest integer that keeps at
+ * least PyramidVoxelsPerSigma voxels per sigma, which bounds the accuracy.
+ * The input is smoothed with the anti-aliasing sigma of the shrink
+ * factors and shrunk. The single scale response is then computed with
+ * the remaining sigma, so that the total smoothing equals sigma, and it is
+ * resampled linearly onto the input grid. With NormalizeAcrossScale the
+ * coarse input is scaled so that the Hessian has the normalization of
+ * sigma; the first order derivatives of the binary functors are then off
+ * by the ratio of the two sigmas, at most 1% for the default of 4 voxels
+ * per sigma. Scales that would not be shrunk are computed at full
+ * resolution as before.
+ *
+ * With a mask, the full resolution scales only compute the response
+ * around the mask, see GaussianEnhancementImageFilter. The output and
+ * the scales are zero outside the mask.
+ *
+ * Several measures can be computed in one run, see AddUnaryFunctor() and
+ * AddBinaryFunctor(): the Hessian and its eigenvalues are then computed
+ * once per scale, and every functor is evaluated on them. Output 2m is
+ * the maximum response of measure m, and output 2m+1 its scales, so that
+ * outputs 0 and 1 are those of the first measure.
+ *
  * \sa GaussianEnhancementImageFilter
  * \sa HessianRecursiveGaussianImageFilter
  * \sa SymmetricEigenAnalysisImageFilter
@@ -73,6 +100,19 @@ public:
   itkStaticConstMacro( ImageDimension, unsigned int,
     InputImageType::ImageDimension );
 
+  /** Single scale filter and pyramid filters for the downsampled scales. */
+  typedef GaussianEnhancementImageFilter<
+    OutputImageType, OutputImageType >                    CoarseScaleFilterType;
+  typedef SmoothingRecursiveGaussianImageFilter<
+    InputImageType, OutputImageType >                     PyramidSmoothingFilterType;
+  typedef ShrinkImageFilter<
+    OutputImageType, OutputImageType >                    PyramidShrinkFilterType;
+  typedef typename PyramidShrinkFilterType::ShrinkFactorsType ShrinkFactorsType;
+  typedef ShiftScaleImageFilter<
+    OutputImageType, OutputImageType >                    PyramidScaleFilterType;
+  typedef ResampleImageFilter<
+    OutputImageType, OutputImageType >                    PyramidResampleFilterType;
+
   /** Types for Scales image */
   typedef OutputPixelType                                 ScalesPixelType;
   typedef Image< ScalesPixelType,
@@ -94,14 +134,31 @@ public:
   typedef typename SingleScaleFilterType::UnaryFunctorBaseType          UnaryFunctorBaseType;
   typedef typename SingleScaleFilterType::BinaryFunctorImageFilterType  BinaryFunctorImageFilterType;
   typedef typename SingleScaleFilterType::BinaryFunctorBaseType         BinaryFunctorBaseType;
+  typedef typename SingleScaleFilterType::MaskImageType                 MaskImageType;
 
-  /** Set/Get unary functor */
+  /** Set the unary functor of a single measure, replacing all measures. */
   virtual void SetUnaryFunctor( UnaryFunctorBaseType * _arg );
-  //itkGetObjectMacro( UnaryFunctor, UnaryFunctorBaseType );
 
-  /** Set/Get binary functor */
+  /** Set the binary functor of a single measure, replacing all measures. */
   virtual void SetBinaryFunctor( BinaryFunctorBaseType * _arg );
-  //itkGetObjectMacro( BinaryFunctor, BinaryFunctorBaseType );
+
+  /** Add a measure computed by a unary or a binary functor. */
+  virtual void AddUnaryFunctor( UnaryFunctorBaseType * _arg );
+  virtual void AddBinaryFunctor( BinaryFunctorBaseType * _arg );
+
+  /** Remove all measures. */
+  virtual void ClearFunctors( void );
+
+  /** Get the number of measures. */
+  unsigned int GetNumberOfMeasures( void ) const
+  {
+    return this->m_GaussianEnhancementFilter->GetNumberOfMeasures();
+  }
+
+  /** Set/Get the mask. It should have the size of the input. When set,
+   * the response is only computed around the nonzero voxels of it. */
+  virtual void SetMaskImage( MaskImageType * _arg );
+  MaskImageType * GetMaskImage( void );
 
   /** Set/Get macros for sigma minimum */
   itkSetClampMacro( SigmaMinimum, double, 0.0, NumericTraits<double>::max() );
@@ -155,6 +212,17 @@ public:
   /** Set logarithmic sigma step method */
   void SetSigmaStepMethodToLogarithmic( void );
 
+  /** Methods to turn on/off computing the large scales on a downsampled
+   * image. Off by default. */
+  itkSetMacro( UsePyramid, bool );
+  itkGetConstMacro( UsePyramid, bool );
+  itkBooleanMacro( UsePyramid );
+
+  /** Set/Get the minimum number of voxels per sigma on a downsampled image.
+   * Larger values are more accurate and shrink less. Default 4. */
+  itkSetClampMacro( PyramidVoxelsPerSigma, double, 1.0, NumericTraits<double>::max() );
+  itkGetConstMacro( PyramidVoxelsPerSigma, double );
+
   /** Methods to turn on/off flag to rescale function output */
   itkSetMacro( Rescale, bool );
   itkGetConstMacro( Rescale, bool );
@@ -173,8 +241,12 @@ public:
   /** Set the number of threads to create when executing. */
   void SetNumberOfThreads( ThreadIdType nt );
 
-  /** Get the image containing the scales at which each pixel gave the best response */
-  const ScalesImageType * GetScalesOutput( void ) const;
+  /** Get the maximum response of a measure. */
+  const OutputImageType * GetResponseOutput( unsigned int measure ) const;
+
+  /** Get the image containing the scales at which each pixel gave the best
+   * response of a measure, by default the first. */
+  const ScalesImageType * GetScalesOutput( unsigned int measure = 0 ) const;
 
   /** This is overloaded to create the Scales and Hessian output images */
   virtual DataObjectPointer MakeOutput( unsigned int idx );
@@ -202,21 +274,61 @@ private:
   MultiScaleGaussianEnhancementImageFilter(const Self&); // purposely not implemented
   void operator=(const Self&);                           // purposely not implemented
 
-  /** Computes the maximum of all single scale responses. */
+  /** Computes the maximum of all single scale responses. The comparison
+   * with the maximum so far and the update of the maximum and the scales
+   * are done in a single threaded pass over the buffers. */
   void UpdateMaximumResponse(
     const OutputImageType * seOutput,
-    const unsigned int & scaleLevel );
+    const unsigned int & scaleLevel,
+    const unsigned int & measure );
+
+  /** Create the two outputs of every measure. */
+  void UpdateNumberOfOutputs( void );
+
+  /** The data of the pass of UpdateMaximumResponse(). */
+  struct MaximumResponseStruct
+  {
+    const OutputPixelType * Response;
+    const unsigned char *   Mask;
+    OutputPixelType *       Maximum;
+    ScalesPixelType *       Scales;
+    SizeValueType           NumberOfPixels;
+    ScalesPixelType         Sigma;
+    bool                    FirstScale;
+    OutputPixelType         InitialValue;
+  };
+
+  /** Update a contiguous chunk of the maximum response. */
+  static ITK_THREAD_RETURN_TYPE MaximumResponseThreaderCallback( void * arg );
 
   /** Compute the current sigma. */
   double ComputeSigmaValue( const unsigned int & scaleLevel );
 
+  /** Compute the shrink factors of sigma; returns false if the scale
+   * is not shrunk at all. */
+  bool ComputeShrinkFactors( const double & sigma, ShrinkFactorsType & factors ) const;
+
+  /** Compute the responses of sigma on the downsampled image, resample
+   * them onto the input grid, and update the maximum responses. */
+  void UpdateCoarseResponses( const double & sigma,
+    const ShrinkFactorsType & factors, const unsigned int & scaleLevel );
+
   /** Single scale filter */
   typename SingleScaleFilterType::Pointer m_GaussianEnhancementFilter;
 
+  /** Pyramid filters */
+  typename CoarseScaleFilterType::Pointer       m_CoarseEnhancementFilter;
+  typename PyramidSmoothingFilterType::Pointer  m_PyramidSmoothingFilter;
+  typename PyramidShrinkFilterType::Pointer     m_PyramidShrinkFilter;
+  typename PyramidScaleFilterType::Pointer      m_PyramidScaleFilter;
+  typename PyramidResampleFilterType::Pointer   m_PyramidResampleFilter;
+
   /** Member variables. */
   bool                 m_NonNegativeHessianBasedMeasure;
   bool                 m_GenerateScalesOutput;
   bool                 m_Rescale;
+  bool                 m_UsePyramid;
+  double               m_PyramidVoxelsPerSigma;
 
   double               m_SigmaMinimum;
   double               m_SigmaMaximum;
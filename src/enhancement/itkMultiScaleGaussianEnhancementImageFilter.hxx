@@ -21,9 +21,8 @@
 #include "itkMultiScaleGaussianEnhancementImageFilter.h"
 
 // ITK include files
-#include "itkImageRegionIterator.h"
-#include "itkImageRegionConstIterator.h"
-#include "itkMaximumImageFilter.h"
+#include "itkMultiThreader.h"
+#include <algorithm>
 
 namespace itk
 {
@@ -46,6 +45,8 @@ MultiScaleGaussianEnhancementImageFilter< TInputImage, TOutputImage >
   this->m_SigmaStepMethod = Self::LogarithmicSigmaSteps;
   this->m_GenerateScalesOutput = false;
   this->m_Rescale = true;
+  this->m_UsePyramid = false;
+  this->m_PyramidVoxelsPerSigma = 4.0;
 
   typename ScalesImageType::Pointer scalesImage = ScalesImageType::New();
   this->ProcessObject::SetNumberOfRequiredOutputs( 2 );
@@ -54,6 +55,17 @@ MultiScaleGaussianEnhancementImageFilter< TInputImage, TOutputImage >
   // Construct GaussianEnhancementImageFilter
   this->m_GaussianEnhancementFilter = SingleScaleFilterType::New();
 
+  // Construct the pyramid filters, releasing the intermediate images
+  this->m_CoarseEnhancementFilter = CoarseScaleFilterType::New();
+  this->m_PyramidSmoothingFilter = PyramidSmoothingFilterType::New();
+  this->m_PyramidShrinkFilter = PyramidShrinkFilterType::New();
+  this->m_PyramidScaleFilter = PyramidScaleFilterType::New();
+  this->m_PyramidResampleFilter = PyramidResampleFilterType::New();
+  this->m_PyramidSmoothingFilter->ReleaseDataFlagOn();
+  this->m_PyramidShrinkFilter->ReleaseDataFlagOn();
+  this->m_PyramidScaleFilter->ReleaseDataFlagOn();
+  this->m_CoarseEnhancementFilter->ReleaseDataFlagOn();
+
 } // end Constructor
 
 
@@ -66,9 +78,12 @@ void
 MultiScaleGaussianEnhancementImageFilter< TInputImage, TOutputImage >
 ::SetUnaryFunctor( UnaryFunctorBaseType * _arg )
 {
-  if ( this->m_GaussianEnhancementFilter->GetUnaryFunctor() != _arg )
+  if ( this->GetNumberOfMeasures() != 1
+    || this->m_GaussianEnhancementFilter->GetUnaryFunctor() != _arg )
   {
     this->m_GaussianEnhancementFilter->SetUnaryFunctor( _arg );
+    this->m_CoarseEnhancementFilter->SetUnaryFunctor( _arg );
+    this->UpdateNumberOfOutputs();
     this->Modified();
   }
 } // end SetUnaryFunctor()
@@ -83,14 +98,116 @@ void
 MultiScaleGaussianEnhancementImageFilter< TInputImage, TOutputImage >
 ::SetBinaryFunctor( BinaryFunctorBaseType * _arg )
 {
-  if ( this->m_GaussianEnhancementFilter->GetBinaryFunctor() != _arg )
+  if ( this->GetNumberOfMeasures() != 1
+    || this->m_GaussianEnhancementFilter->GetBinaryFunctor() != _arg )
   {
     this->m_GaussianEnhancementFilter->SetBinaryFunctor( _arg );
+    this->m_CoarseEnhancementFilter->SetBinaryFunctor( _arg );
+    this->UpdateNumberOfOutputs();
     this->Modified();
   }
 } // end SetBinaryFunctor()
 
 
+/**
+ * ********************* AddUnaryFunctor ****************************
+ */
+
+template< typename TInputImage, typename TOutputImage >
+void
+MultiScaleGaussianEnhancementImageFilter< TInputImage, TOutputImage >
+::AddUnaryFunctor( UnaryFunctorBaseType * _arg )
+{
+  this->m_GaussianEnhancementFilter->AddUnaryFunctor( _arg );
+  this->m_CoarseEnhancementFilter->AddUnaryFunctor( _arg );
+  this->UpdateNumberOfOutputs();
+  this->Modified();
+} // end AddUnaryFunctor()
+
+
+/**
+ * ********************* AddBinaryFunctor ****************************
+ */
+
+template< typename TInputImage, typename TOutputImage >
+void
+MultiScaleGaussianEnhancementImageFilter< TInputImage, TOutputImage >
+::AddBinaryFunctor( BinaryFunctorBaseType * _arg )
+{
+  this->m_GaussianEnhancementFilter->AddBinaryFunctor( _arg );
+  this->m_CoarseEnhancementFilter->AddBinaryFunctor( _arg );
+  this->UpdateNumberOfOutputs();
+  this->Modified();
+} // end AddBinaryFunctor()
+
+
+/**
+ * ********************* ClearFunctors ****************************
+ */
+
+template< typename TInputImage, typename TOutputImage >
+void
+MultiScaleGaussianEnhancementImageFilter< TInputImage, TOutputImage >
+::ClearFunctors( void )
+{
+  this->m_GaussianEnhancementFilter->ClearFunctors();
+  this->m_CoarseEnhancementFilter->ClearFunctors();
+  this->UpdateNumberOfOutputs();
+  this->Modified();
+} // end ClearFunctors()
+
+
+/**
+ * ********************* UpdateNumberOfOutputs ****************************
+ */
+
+template< typename TInputImage, typename TOutputImage >
+void
+MultiScaleGaussianEnhancementImageFilter< TInputImage, TOutputImage >
+::UpdateNumberOfOutputs( void )
+{
+  // A response and a scales output per measure, at least for one measure.
+  const unsigned int numberOfOutputs
+    = 2 * std::max( this->GetNumberOfMeasures(), 1u );
+  for ( unsigned int idx = this->GetNumberOfOutputs(); idx < numberOfOutputs; ++idx )
+  {
+    this->ProcessObject::SetNthOutput( idx, this->MakeOutput( idx ) );
+  }
+  this->ProcessObject::SetNumberOfRequiredOutputs( numberOfOutputs );
+} // end UpdateNumberOfOutputs()
+
+
+/**
+ * ********************* SetMaskImage ****************************
+ */
+
+template< typename TInputImage, typename TOutputImage >
+void
+MultiScaleGaussianEnhancementImageFilter< TInputImage, TOutputImage >
+::SetMaskImage( MaskImageType * _arg )
+{
+  // The downsampled scales are masked in UpdateMaximumResponse().
+  if ( this->m_GaussianEnhancementFilter->GetMaskImage() != _arg )
+  {
+    this->m_GaussianEnhancementFilter->SetMaskImage( _arg );
+    this->Modified();
+  }
+} // end SetMaskImage()
+
+
+/**
+ * ********************* GetMaskImage ****************************
+ */
+
+template< typename TInputImage, typename TOutputImage >
+typename MultiScaleGaussianEnhancementImageFilter< TInputImage, TOutputImage >::MaskImageType *
+MultiScaleGaussianEnhancementImageFilter< TInputImage, TOutputImage >
+::GetMaskImage( void )
+{
+  return this->m_GaussianEnhancementFilter->GetMaskImage();
+} // end GetMaskImage()
+
+
 /**
  * ********************* SetNormalizeAcrossScale ****************************
  */
@@ -103,6 +220,7 @@ MultiScaleGaussianEnhancementImageFilter< TInputImage, TOutputImage >
   if ( this->m_GaussianEnhancementFilter->GetNormalizeAcrossScale() != normalize )
   {
     this->m_GaussianEnhancementFilter->SetNormalizeAcrossScale( normalize );
+    this->m_CoarseEnhancementFilter->SetNormalizeAcrossScale( normalize );
     this->Modified();
   }
 } // end SetNormalizeAcrossScale()
@@ -117,7 +235,7 @@ typename MultiScaleGaussianEnhancementImageFilter< TInputImage, TOutputImage >::
 MultiScaleGaussianEnhancementImageFilter< TInputImage, TOutputImage >
 ::MakeOutput( unsigned int idx )
 {
-  if ( idx == 1 )
+  if ( idx % 2 == 1 )
   {
     return static_cast<DataObject*>( ScalesImageType::New().GetPointer() );
   }
@@ -153,6 +271,11 @@ MultiScaleGaussianEnhancementImageFilter< TInputImage, TOutputImage >
 {
   Superclass::SetNumberOfThreads( nt );
   this->m_GaussianEnhancementFilter->SetNumberOfThreads( nt );
+  this->m_CoarseEnhancementFilter->SetNumberOfThreads( nt );
+  this->m_PyramidSmoothingFilter->SetNumberOfThreads( nt );
+  this->m_PyramidShrinkFilter->SetNumberOfThreads( nt );
+  this->m_PyramidScaleFilter->SetNumberOfThreads( nt );
+  this->m_PyramidResampleFilter->SetNumberOfThreads( nt );
   this->Modified();
 
 } // end SetNumberOfThreads()
@@ -168,26 +291,23 @@ MultiScaleGaussianEnhancementImageFilter< TInputImage, TOutputImage >
 ::GenerateData( void )
 {
   // TODO: Move the allocation to a derived AllocateOutputs method
-  // Allocate the output
-  this->GetOutput()->SetBufferedRegion( this->GetOutput()->GetRequestedRegion() );
-  this->GetOutput()->Allocate();
-  if ( this->m_NonNegativeHessianBasedMeasure )
-  {
-    this->GetOutput()->FillBuffer( itk::NumericTraits<OutputPixelType>::Zero );
-  }
-  else
+  // Allocate the outputs; they are initialized by the update of the
+  // first scale, so they are not filled here.
+  const unsigned int numberOfMeasures = this->GetNumberOfMeasures();
+  for ( unsigned int m = 0; m < numberOfMeasures; ++m )
   {
-    this->GetOutput()->FillBuffer( itk::NumericTraits<OutputPixelType>::NonpositiveMin() );
-  }
+    OutputImageType * output = this->GetOutput( 2 * m );
+    output->SetBufferedRegion( output->GetRequestedRegion() );
+    output->Allocate();
 
-  if ( this->m_GenerateScalesOutput )
-  {
-    typename ScalesImageType::Pointer scalesImage
-      = dynamic_cast<ScalesImageType*>( this->ProcessObject::GetOutput( 1 ) );
+    if ( this->m_GenerateScalesOutput )
+    {
+      typename ScalesImageType::Pointer scalesImage
+        = dynamic_cast<ScalesImageType*>( this->ProcessObject::GetOutput( 2 * m + 1 ) );
 
-    scalesImage->SetBufferedRegion( scalesImage->GetRequestedRegion() );
-    scalesImage->Allocate();
-    scalesImage->FillBuffer( itk::NumericTraits<ScalesPixelType>::Zero );
+      scalesImage->SetBufferedRegion( scalesImage->GetRequestedRegion() );
+      scalesImage->Allocate();
+    }
   }
 
   // Check stuff here before starting
@@ -203,22 +323,40 @@ MultiScaleGaussianEnhancementImageFilter< TInputImage, TOutputImage >
   this->m_GaussianEnhancementFilter->SetInput( input );
   this->m_GaussianEnhancementFilter->SetRescale( this->m_Rescale );
 
+  this->m_CoarseEnhancementFilter->SetRescale( this->m_Rescale );
+
   unsigned int scaleLevel = 0;
   while ( scaleLevel < this->m_NumberOfSigmaSteps )
   {
     // Determine sigma for this level
     double sigma = this->ComputeSigmaValue( scaleLevel );
 
-    // Compute vesselness for this level.
-    this->m_GaussianEnhancementFilter->SetSigma( sigma );
-    this->m_GaussianEnhancementFilter->Update();
+    // Compute vesselness for this level, downsampled if possible.
+    ShrinkFactorsType factors;
+    if ( this->m_UsePyramid && this->ComputeShrinkFactors( sigma, factors ) )
+    {
+      this->UpdateCoarseResponses( sigma, factors, scaleLevel );
+    }
+    else
+    {
+      // All measures share the Hessian of this scale.
+      this->m_GaussianEnhancementFilter->SetSigma( sigma );
+      this->m_GaussianEnhancementFilter->Update();
 
-    // Get the maximum so far.
-    this->UpdateMaximumResponse( this->m_GaussianEnhancementFilter->GetOutput(), scaleLevel );
+      // Get the maximum so far.
+      for ( unsigned int m = 0; m < numberOfMeasures; ++m )
+      {
+        this->UpdateMaximumResponse(
+          this->m_GaussianEnhancementFilter->GetOutput( m ), scaleLevel, m );
+      }
+    }
 
     scaleLevel++;
   }
 
+  // Free the resampled response of the last downsampled scale.
+  this->m_PyramidResampleFilter->GetOutput()->ReleaseData();
+
 } // end GenerateData()
 
 
@@ -231,48 +369,179 @@ void
 MultiScaleGaussianEnhancementImageFilter< TInputImage, TOutputImage >
 ::UpdateMaximumResponse(
   const OutputImageType *seOutput,
-  const unsigned int &scaleLevel )
+  const unsigned int &scaleLevel,
+  const unsigned int &measure )
 {
-  // Generate the scales output.
-  if ( this->m_GenerateScalesOutput )
+  // The buffers are walked in parallel, so they must cover the same region.
+  OutputImageType * output = this->GetOutput( 2 * measure );
+  if ( seOutput->GetBufferedRegion() != output->GetBufferedRegion() )
   {
-    double sigma = this->ComputeSigmaValue( scaleLevel );
+    itkExceptionMacro( << "ERROR: the single scale response does not cover "
+      << "the region of the output." );
+  }
 
-    OutputRegionType outputRegion = this->GetOutput()->GetBufferedRegion();
-    typename ScalesImageType::Pointer scalesImage
-      = static_cast<ScalesImageType*>( this->ProcessObject::GetOutput( 1 ) );
-    ImageRegionIterator<ScalesImageType> scalesIter( scalesImage, outputRegion );
-    ImageRegionConstIterator<OutputImageType> prevMaxResponseIter( this->GetOutput(), outputRegion );
-    ImageRegionConstIterator<OutputImageType> currentResponseIter( seOutput, outputRegion );
-
-    scalesIter.GoToBegin();
-    prevMaxResponseIter.GoToBegin();
-    currentResponseIter.GoToBegin();
-    while ( !scalesIter.IsAtEnd() )
+  MaximumResponseStruct str;
+  str.Response = seOutput->GetBufferPointer();
+  str.Mask = 0;
+  const MaskImageType * mask = this->m_GaussianEnhancementFilter->GetMaskImage();
+  if ( mask )
+  {
+    if ( mask->GetBufferedRegion() != output->GetBufferedRegion() )
     {
-      if ( prevMaxResponseIter.Value() < currentResponseIter.Value() )
-      {
-        scalesIter.Set( static_cast<ScalesPixelType>( sigma ) );
-      }
-      ++scalesIter; ++prevMaxResponseIter; ++currentResponseIter;
+      itkExceptionMacro( << "ERROR: the mask does not cover "
+        << "the region of the output." );
     }
-  } // end if scales image
+    str.Mask = mask->GetBufferPointer();
+  }
+  str.Maximum = output->GetBufferPointer();
+  str.Scales = 0;
+  if ( this->m_GenerateScalesOutput )
+  {
+    str.Scales = static_cast<ScalesImageType*>(
+      this->ProcessObject::GetOutput( 2 * measure + 1 ) )->GetBufferPointer();
+  }
+  str.NumberOfPixels = output->GetBufferedRegion().GetNumberOfPixels();
+  str.Sigma = static_cast<ScalesPixelType>( this->ComputeSigmaValue( scaleLevel ) );
 
-  // Generate the current maximum response.
-  typedef MaximumImageFilter< OutputImageType,
-    OutputImageType, OutputImageType> MaxFilterType;
+  // At the first scale the maximum so far is the initial value.
+  str.FirstScale = scaleLevel == 0;
+  str.InitialValue = this->m_NonNegativeHessianBasedMeasure
+    ? NumericTraits<OutputPixelType>::Zero
+    : NumericTraits<OutputPixelType>::NonpositiveMin();
 
-  typename MaxFilterType::Pointer maxFilter = MaxFilterType::New();
-  maxFilter->SetInput1( this->GetOutput() );
-  maxFilter->SetInput2( seOutput );
-  maxFilter->SetNumberOfThreads(this->GetNumberOfThreads());
-  maxFilter->InPlaceOn();
-  maxFilter->Update();
-  this->GraftOutput( maxFilter->GetOutput() );
+  // Compare, and update the maximum and the scales, in one pass.
+  this->GetMultiThreader()->SetNumberOfThreads( this->GetNumberOfThreads() );
+  this->GetMultiThreader()->SetSingleMethod(
+    Self::MaximumResponseThreaderCallback, &str );
+  this->GetMultiThreader()->SingleMethodExecute();
 
 } // end UpdateMaximumResponse()
 
 
+/**
+ * ********************* MaximumResponseThreaderCallback ****************************
+ */
+
+template< typename TInputImage, typename TOutputImage >
+ITK_THREAD_RETURN_TYPE
+MultiScaleGaussianEnhancementImageFilter< TInputImage, TOutputImage >
+::MaximumResponseThreaderCallback( void * arg )
+{
+  typedef MultiThreader::ThreadInfoStruct ThreadInfoType;
+  ThreadInfoType * info = static_cast<ThreadInfoType *>( arg );
+  const MaximumResponseStruct * str
+    = static_cast<const MaximumResponseStruct *>( info->UserData );
+  const SizeValueType numberOfThreads = info->NumberOfThreads;
+
+  const SizeValueType begin = str->NumberOfPixels * info->ThreadID / numberOfThreads;
+  const SizeValueType end = str->NumberOfPixels * ( info->ThreadID + 1 ) / numberOfThreads;
+  const ScalesPixelType zero = NumericTraits<ScalesPixelType>::Zero;
+  for ( SizeValueType i = begin; i < end; ++i )
+  {
+    if ( str->Mask && str->Mask[ i ] == 0 )
+    {
+      str->Maximum[ i ] = NumericTraits<OutputPixelType>::Zero;
+      if ( str->Scales ) str->Scales[ i ] = zero;
+      continue;
+    }
+
+    const OutputPixelType previous = str->FirstScale ? str->InitialValue : str->Maximum[ i ];
+    const OutputPixelType current = str->Response[ i ];
+    if ( previous < current )
+    {
+      str->Maximum[ i ] = current;
+      if ( str->Scales ) str->Scales[ i ] = str->Sigma;
+    }
+    else if ( str->FirstScale )
+    {
+      str->Maximum[ i ] = previous;
+      if ( str->Scales ) str->Scales[ i ] = zero;
+    }
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+} // end MaximumResponseThreaderCallback()
+
+
+/**
+ * ********************* ComputeShrinkFactors ****************************
+ */
+
+template< typename TInputImage, typename TOutputImage >
+bool
+MultiScaleGaussianEnhancementImageFilter< TInputImage, TOutputImage >
+::ComputeShrinkFactors( const double & sigma, ShrinkFactorsType & factors ) const
+{
+  const typename InputImageType::SpacingType spacing = this->GetInput()->GetSpacing();
+  const typename InputImageType::SizeType size
+    = this->GetInput()->GetLargestPossibleRegion().GetSize();
+
+  bool shrink = false;
+  for ( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    // Keep at least PyramidVoxelsPerSigma voxels per sigma, and 2 voxels.
+    double factor = vcl_floor( sigma / ( this->m_PyramidVoxelsPerSigma * spacing[ i ] ) );
+    factor = std::min( factor, static_cast<double>( size[ i ] / 2 ) );
+    factors[ i ] = factor > 1.0 ? static_cast<unsigned int>( factor ) : 1;
+    shrink |= factors[ i ] > 1;
+  }
+
+  return shrink;
+} // end ComputeShrinkFactors()
+
+
+/**
+ * ********************* UpdateCoarseResponses ****************************
+ */
+
+template< typename TInputImage, typename TOutputImage >
+void
+MultiScaleGaussianEnhancementImageFilter< TInputImage, TOutputImage >
+::UpdateCoarseResponses( const double & sigma,
+  const ShrinkFactorsType & factors, const unsigned int & scaleLevel )
+{
+  // The anti-aliasing sigma of the largest shrink, isotropic so that
+  // the remaining smoothing can be done by the single scale filter.
+  const typename InputImageType::SpacingType spacing = this->GetInput()->GetSpacing();
+  double antiAliasSigma = 0.0;
+  for ( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    if ( factors[ i ] > 1 )
+    {
+      antiAliasSigma = std::max( antiAliasSigma, 0.5 * factors[ i ] * spacing[ i ] );
+    }
+  }
+  const double coarseSigma = vcl_sqrt( sigma * sigma - antiAliasSigma * antiAliasSigma );
+
+  // The Hessian is normalized with the sigma of the single scale filter;
+  // scale the input, on which it depends linearly, to get that of sigma.
+  double scale = 1.0;
+  if ( this->m_GaussianEnhancementFilter->GetNormalizeAcrossScale() )
+  {
+    scale = ( sigma * sigma ) / ( coarseSigma * coarseSigma );
+  }
+
+  this->m_PyramidSmoothingFilter->SetInput( this->GetInput() );
+  this->m_PyramidSmoothingFilter->SetSigma( antiAliasSigma );
+  this->m_PyramidShrinkFilter->SetInput( this->m_PyramidSmoothingFilter->GetOutput() );
+  this->m_PyramidShrinkFilter->SetShrinkFactors( factors );
+  this->m_PyramidScaleFilter->SetInput( this->m_PyramidShrinkFilter->GetOutput() );
+  this->m_PyramidScaleFilter->SetScale( scale );
+  this->m_CoarseEnhancementFilter->SetInput( this->m_PyramidScaleFilter->GetOutput() );
+  this->m_CoarseEnhancementFilter->SetSigma( coarseSigma );
+
+  // Resample every measure linearly onto the grid of the input; the
+  // coarse responses are computed once, by the first update.
+  this->m_PyramidResampleFilter->SetOutputParametersFromImage( this->GetInput() );
+  for ( unsigned int m = 0; m < this->GetNumberOfMeasures(); ++m )
+  {
+    this->m_PyramidResampleFilter->SetInput( this->m_CoarseEnhancementFilter->GetOutput( m ) );
+    this->m_PyramidResampleFilter->Update();
+    this->UpdateMaximumResponse( this->m_PyramidResampleFilter->GetOutput(), scaleLevel, m );
+  }
+} // end UpdateCoarseResponses()
+
+
 /**
  * ********************* ComputeSigmaValue ****************************
  */
@@ -336,6 +605,19 @@ MultiScaleGaussianEnhancementImageFilter< TInputImage, TOutputImage >
 } // end SetSigmaStepMethodToLogarithmic()
 
 
+/**
+ * ********************* GetResponseOutput ****************************
+ */
+
+template< typename TInputImage, typename TOutputImage >
+const typename MultiScaleGaussianEnhancementImageFilter<TInputImage, TOutputImage >::OutputImageType *
+MultiScaleGaussianEnhancementImageFilter< TInputImage, TOutputImage >
+::GetResponseOutput( unsigned int measure ) const
+{
+  return static_cast<const OutputImageType*>(this->ProcessObject::GetOutput(2 * measure));
+} // end GetResponseOutput()
+
+
 /**
  * ********************* GetScalesOutput ****************************
  */
@@ -343,9 +625,9 @@ MultiScaleGaussianEnhancementImageFilter< TInputImage, TOutputImage >
 template< typename TInputImage, typename TOutputImage >
 const typename MultiScaleGaussianEnhancementImageFilter<TInputImage, TOutputImage >::ScalesImageType *
 MultiScaleGaussianEnhancementImageFilter< TInputImage, TOutputImage >
-::GetScalesOutput( void ) const
+::GetScalesOutput( unsigned int measure ) const
 {
-  return static_cast<const ScalesImageType*>(this->ProcessObject::GetOutput(1));
+  return static_cast<const ScalesImageType*>(this->ProcessObject::GetOutput(2 * measure + 1));
 } // end GetScalesOutput()
 
 
@@ -368,6 +650,9 @@ MultiScaleGaussianEnhancementImageFilter< TInputImage, TOutputImage >
     << this->m_NonNegativeHessianBasedMeasure << std::endl;
   os << indent << "GenerateScalesOutput: " << this->m_GenerateScalesOutput << std::endl;
   os << indent << "Rescale: " << this->m_Rescale << std::endl;
+  os << indent << "UsePyramid: " << this->m_UsePyramid << std::endl;
+  os << indent << "PyramidVoxelsPerSigma: " << this->m_PyramidVoxelsPerSigma << std::endl;
+  os << indent << "NumberOfMeasures: " << this->GetNumberOfMeasures() << std::endl;
   os << indent << "NormalizeAcrossScale: "
     << this->m_GaussianEnhancementFilter->GetNormalizeAcrossScale() << std::endl;
 
@@ -170,6 +170,9 @@ public:
 
   } // end Evaluate()
 
+  /** Evaluate a line, with Evaluate() bound at compile time. */
+  itkBinaryFunctorEvaluateRangeMacro();
+
   /** Set parameters */
   itkSetClampMacro( Alpha, double, 0.0, 1.0 );
   itkSetClampMacro( Beta, double, 0.0, NumericTraits<double>::max() );
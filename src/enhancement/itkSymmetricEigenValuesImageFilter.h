@@ -0,0 +1,115 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkSymmetricEigenValuesImageFilter_h
+#define __itkSymmetricEigenValuesImageFilter_h
+
+#include "itkImageToImageFilter.h"
+
+namespace itk
+{
+
+/** \class SymmetricEigenValuesImageFilter
+ * \brief Computes the eigenvalues of an image of symmetric 2x2 or 3x3
+ * tensors in closed form.
+ *
+ * The eigenvalues are computed analytically: for 2x2 tensors from the
+ * roots of the characteristic polynomial, for 3x3 tensors with the
+ * trigonometric solution of the characteristic cubic. The degenerate
+ * cases are handled without branches, so that the kernel is a straight
+ * loop over a batch of pixels, which the compiler can vectorize. Every
+ * thread gathers the tensors of a line in batches, in a structure of
+ * arrays, computes them in double precision and scatters the eigenvalues.
+ *
+ * The eigenvalues are sorted by value in ascending order, like the
+ * OrderByValue option of SymmetricEigenAnalysisImageFilter, of which this
+ * filter is a faster replacement for 2D and 3D tensors. The eigenvectors
+ * are not computed.
+ *
+ * The input pixel type must be a SymmetricSecondRankTensor, the output
+ * pixel type a FixedArray of the image dimension.
+ *
+ * \sa SymmetricEigenAnalysisImageFilter
+ * \ingroup IntensityImageFilters Multithreaded
+ */
+
+template < typename TInputImage, typename TOutputImage >
+class SymmetricEigenValuesImageFilter
+  : public ImageToImageFilter< TInputImage, TOutputImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef SymmetricEigenValuesImageFilter                   Self;
+  typedef ImageToImageFilter< TInputImage, TOutputImage >   Superclass;
+  typedef SmartPointer<Self>                                Pointer;
+  typedef SmartPointer<const Self>                          ConstPointer;
+
+  /** Run-time type information (and related methods) */
+  itkTypeMacro( SymmetricEigenValuesImageFilter, ImageToImageFilter );
+
+  /** Method for creation through the object factory.*/
+  itkNewMacro( Self );
+
+  /** Typedef's. */
+  typedef TInputImage                               InputImageType;
+  typedef TOutputImage                              OutputImageType;
+  typedef typename InputImageType::PixelType        InputPixelType;
+  typedef typename OutputImageType::PixelType       OutputPixelType;
+  typedef typename OutputPixelType::ValueType       OutputValueType;
+  typedef typename OutputImageType::RegionType      OutputImageRegionType;
+  typedef typename OutputImageType::IndexType       IndexType;
+
+  /** Image dimension. */
+  itkStaticConstMacro( ImageDimension, unsigned int, InputImageType::ImageDimension );
+
+  /** The number of pixels that are computed at once. */
+  itkStaticConstMacro( BatchSize, unsigned int, 64 );
+
+protected:
+  SymmetricEigenValuesImageFilter();
+  virtual ~SymmetricEigenValuesImageFilter() {};
+
+  /** Only 2D and 3D tensors are supported. */
+  virtual void BeforeThreadedGenerateData( void );
+
+  /** Computes the eigenvalues of a region, line by line in batches. */
+  virtual void ThreadedGenerateData(
+    const OutputImageRegionType & outputRegionForThread, ThreadIdType threadId );
+
+  /** The kernels. The components are given as separate arrays, in the
+   * order of SymmetricSecondRankTensor; the eigenvalues are written to
+   * e0 <= e1 (<= e2). */
+  static void ComputeEigenValues2D( const unsigned int n,
+    const double * a00, const double * a01, const double * a11,
+    double * e0, double * e1 );
+  static void ComputeEigenValues3D( const unsigned int n,
+    const double * a00, const double * a01, const double * a02,
+    const double * a11, const double * a12, const double * a22,
+    double * e0, double * e1, double * e2 );
+
+private:
+  SymmetricEigenValuesImageFilter(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkSymmetricEigenValuesImageFilter.hxx"
+#endif
+
+#endif
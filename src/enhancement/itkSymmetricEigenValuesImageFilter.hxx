@@ -0,0 +1,212 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkSymmetricEigenValuesImageFilter_hxx
+#define __itkSymmetricEigenValuesImageFilter_hxx
+
+#include "itkSymmetricEigenValuesImageFilter.h"
+#include "itkProgressReporter.h"
+#include "vnl/vnl_math.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk
+{
+
+/**
+ * ********************* Constructor ****************************
+ */
+
+template < typename TInputImage, typename TOutputImage >
+SymmetricEigenValuesImageFilter< TInputImage, TOutputImage >
+::SymmetricEigenValuesImageFilter()
+{
+  this->SetNumberOfRequiredInputs( 1 );
+} // end Constructor
+
+
+/**
+ * ********************* BeforeThreadedGenerateData ****************************
+ */
+
+template < typename TInputImage, typename TOutputImage >
+void
+SymmetricEigenValuesImageFilter< TInputImage, TOutputImage >
+::BeforeThreadedGenerateData( void )
+{
+  if ( ImageDimension != 2 && ImageDimension != 3 )
+  {
+    itkExceptionMacro( << "ERROR: only 2D and 3D tensors are supported, "
+      << "use SymmetricEigenAnalysisImageFilter instead." );
+  }
+} // end BeforeThreadedGenerateData()
+
+
+/**
+ * ********************* ComputeEigenValues2D ****************************
+ */
+
+template < typename TInputImage, typename TOutputImage >
+void
+SymmetricEigenValuesImageFilter< TInputImage, TOutputImage >
+::ComputeEigenValues2D( const unsigned int n,
+  const double * a00, const double * a01, const double * a11,
+  double * e0, double * e1 )
+{
+  for ( unsigned int i = 0; i < n; ++i )
+  {
+    const double mean = 0.5 * ( a00[ i ] + a11[ i ] );
+    const double half = 0.5 * ( a00[ i ] - a11[ i ] );
+    const double radius = std::sqrt( half * half + a01[ i ] * a01[ i ] );
+    e0[ i ] = mean - radius;
+    e1[ i ] = mean + radius;
+  }
+} // end ComputeEigenValues2D()
+
+
+/**
+ * ********************* ComputeEigenValues3D ****************************
+ */
+
+template < typename TInputImage, typename TOutputImage >
+void
+SymmetricEigenValuesImageFilter< TInputImage, TOutputImage >
+::ComputeEigenValues3D( const unsigned int n,
+  const double * a00, const double * a01, const double * a02,
+  const double * a11, const double * a12, const double * a22,
+  double * e0, double * e1, double * e2 )
+{
+  const double twoThirdsPi = 2.0 * vnl_math::pi / 3.0;
+  for ( unsigned int i = 0; i < n; ++i )
+  {
+    // Shift by the mean eigenvalue, B = ( A - q I ) / p.
+    const double q = ( a00[ i ] + a11[ i ] + a22[ i ] ) / 3.0;
+    const double b00 = a00[ i ] - q;
+    const double b11 = a11[ i ] - q;
+    const double b22 = a22[ i ] - q;
+    const double offDiagonal
+      = a01[ i ] * a01[ i ] + a02[ i ] * a02[ i ] + a12[ i ] * a12[ i ];
+    const double p = std::sqrt(
+      ( b00 * b00 + b11 * b11 + b22 * b22 + 2.0 * offDiagonal ) / 6.0 );
+
+    // A multiple of the identity has p = 0: then r = 0 and all
+    // eigenvalues are q, without a branch.
+    const double invp = p > 0.0 ? 1.0 / p : 0.0;
+    const double det = b00 * ( b11 * b22 - a12[ i ] * a12[ i ] )
+      - a01[ i ] * ( a01[ i ] * b22 - a12[ i ] * a02[ i ] )
+      + a02[ i ] * ( a01[ i ] * a12[ i ] - b11 * a02[ i ] );
+    const double r = std::max( -1.0,
+      std::min( 1.0, 0.5 * det * invp * invp * invp ) );
+    const double phi = std::acos( r ) / 3.0;
+
+    // The largest and the smallest, the middle one from the trace.
+    e2[ i ] = q + 2.0 * p * std::cos( phi );
+    e0[ i ] = q + 2.0 * p * std::cos( phi + twoThirdsPi );
+    e1[ i ] = 3.0 * q - e0[ i ] - e2[ i ];
+  }
+} // end ComputeEigenValues3D()
+
+
+/**
+ * ********************* ThreadedGenerateData ****************************
+ */
+
+template < typename TInputImage, typename TOutputImage >
+void
+SymmetricEigenValuesImageFilter< TInputImage, TOutputImage >
+::ThreadedGenerateData(
+  const OutputImageRegionType & outputRegionForThread, ThreadIdType threadId )
+{
+  const InputImageType * input = this->GetInput();
+  OutputImageType * output = this->GetOutput();
+
+  const SizeValueType lineLength = outputRegionForThread.GetSize()[ 0 ];
+  if ( lineLength == 0 ) return;
+  const SizeValueType numberOfLines
+    = outputRegionForThread.GetNumberOfPixels() / lineLength;
+  ProgressReporter progress( this, threadId, numberOfLines );
+
+  // The batch, as a structure of arrays.
+  const unsigned int numberOfComponents = ImageDimension * ( ImageDimension + 1 ) / 2;
+  double components[ 6 ][ BatchSize ];
+  double eigenValues[ 3 ][ BatchSize ];
+
+  const IndexType regionBegin = outputRegionForThread.GetIndex();
+  const IndexType regionLast = outputRegionForThread.GetUpperIndex();
+  IndexType index = regionBegin;
+  for ( SizeValueType line = 0; line < numberOfLines; ++line )
+  {
+    const InputPixelType * in = input->GetBufferPointer() + input->ComputeOffset( index );
+    OutputPixelType * out = output->GetBufferPointer() + output->ComputeOffset( index );
+
+    for ( SizeValueType x = 0; x < lineLength; x += BatchSize )
+    {
+      const unsigned int n = static_cast<unsigned int>(
+        std::min( static_cast<SizeValueType>( BatchSize ), lineLength - x ) );
+
+      // Gather.
+      for ( unsigned int i = 0; i < n; ++i )
+      {
+        const InputPixelType & tensor = in[ x + i ];
+        for ( unsigned int k = 0; k < numberOfComponents; ++k )
+        {
+          components[ k ][ i ] = static_cast<double>( tensor[ k ] );
+        }
+      }
+
+      if ( ImageDimension == 2 )
+      {
+        Self::ComputeEigenValues2D( n, components[ 0 ], components[ 1 ],
+          components[ 2 ], eigenValues[ 0 ], eigenValues[ 1 ] );
+      }
+      else
+      {
+        Self::ComputeEigenValues3D( n, components[ 0 ], components[ 1 ],
+          components[ 2 ], components[ 3 ], components[ 4 ], components[ 5 ],
+          eigenValues[ 0 ], eigenValues[ 1 ], eigenValues[ 2 ] );
+      }
+
+      // Scatter.
+      for ( unsigned int i = 0; i < n; ++i )
+      {
+        OutputPixelType & values = out[ x + i ];
+        for ( unsigned int k = 0; k < ImageDimension; ++k )
+        {
+          values[ k ] = static_cast<OutputValueType>( eigenValues[ k ][ i ] );
+        }
+      }
+    }
+
+    // Go to the next line.
+    for ( unsigned int d = 1; d < ImageDimension; ++d )
+    {
+      if ( index[ d ] < regionLast[ d ] )
+      {
+        ++index[ d ];
+        break;
+      }
+      index[ d ] = regionBegin[ d ];
+    }
+    progress.CompletedPixel();
+  }
+
+} // end ThreadedGenerateData()
+
+} // end namespace itk
+
+#endif
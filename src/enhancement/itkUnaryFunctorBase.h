@@ -20,6 +20,18 @@
 
 #include "itkObject.h"
 
+/** Overrides EvaluateRange() in a functor deriving from UnaryFunctorBase,
+ * with a loop over the Evaluate() of the class itself. */
+#define itkUnaryFunctorEvaluateRangeMacro()                                 \
+  virtual void EvaluateRange( const typename Superclass::InputType * input, \
+    typename Superclass::OutputType * output, const SizeValueType n ) const \
+  {                                                                         \
+    for( SizeValueType i = 0; i < n; ++i )                                  \
+    {                                                                       \
+      output[ i ] = this->Self::Evaluate( input[ i ] );                     \
+    }                                                                       \
+  }
+
 namespace itk
 {
 /** \class UnaryFunctorBase
@@ -48,12 +60,30 @@ public:
   /** Run-time type information (and related methods). */
   itkTypeMacro( UnaryFunctorBase, Object );
 
+  /** Typedefs. */
+  typedef TInput  InputType;
+  typedef TOutput OutputType;
+
   /** This does the real computation */
   virtual TOutput Evaluate( const TInput & value ) const
   {
     return NumericTraits<TOutput>::Zero;
   }
 
+  /** Evaluate n contiguous values. The filters call this once per line,
+   * so that the virtual call is made once per line instead of once per
+   * pixel. Derived functors override it with
+   * itkUnaryFunctorEvaluateRangeMacro, in which Evaluate() is bound at
+   * compile time and can be inlined. */
+  virtual void EvaluateRange( const TInput * input, TOutput * output,
+    const SizeValueType n ) const
+  {
+    for( SizeValueType i = 0; i < n; ++i )
+    {
+      output[ i ] = this->Evaluate( input[ i ] );
+    }
+  }
+
 protected:
   UnaryFunctorBase(){};
   virtual ~UnaryFunctorBase(){};
@@ -19,7 +19,7 @@
 #define __itkUnaryFunctorImageFilter2_hxx
 
 #include "itkUnaryFunctorImageFilter2.h"
-#include "itkImageRegionIterator.h"
+#include "itkImageLinearIteratorWithIndex.h"
 #include "itkProgressReporter.h"
 
 namespace itk
@@ -161,20 +161,26 @@ UnaryFunctorImageFilter2< TInputImage, TOutputImage >
 
   this->CallCopyOutputRegionToInputRegion(inputRegionForThread, outputRegionForThread);
 
-  // Define the iterators
-  ImageRegionConstIterator< TInputImage > inputIt(inputPtr, inputRegionForThread);
-  ImageRegionIterator< TOutputImage >     outputIt(outputPtr, outputRegionForThread);
+  // Walk the regions line by line, the functor evaluates a whole line
+  // with a single virtual call. The lines of the input and output
+  // regions have the same length.
+  ImageLinearConstIteratorWithIndex< TInputImage > inputIt(inputPtr, inputRegionForThread);
+  ImageLinearIteratorWithIndex< TOutputImage >     outputIt(outputPtr, outputRegionForThread);
+  inputIt.SetDirection( 0 );
+  outputIt.SetDirection( 0 );
 
-  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() );
+  const SizeValueType lineLength = outputRegionForThread.GetSize( 0 );
+  ProgressReporter progress( this, threadId,
+    outputRegionForThread.GetNumberOfPixels() / lineLength );
 
   inputIt.GoToBegin();
   outputIt.GoToBegin();
 
   while ( !inputIt.IsAtEnd() )
     {
-    outputIt.Set( m_Functor->Evaluate( inputIt.Get() ) );
-    ++inputIt;
-    ++outputIt;
+    m_Functor->EvaluateRange( &inputIt.Value(), &outputIt.Value(), lineLength );
+    inputIt.NextLine();
+    outputIt.NextLine();
     progress.CompletedPixel();  // potential exception thrown here
     }
 }
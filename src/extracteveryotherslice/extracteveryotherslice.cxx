@@ -152,6 +152,7 @@ int main( int argc, char **argv )
     filter->m_Offset = offset;
     filter->m_Direction = direction;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
@@ -20,8 +20,8 @@
 
 #include "ITKToolsBase.h"
 
-#include "itkImageSliceConstIteratorWithIndex.h"
-#include "itkImageSliceIteratorWithIndex.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
 
@@ -79,23 +79,29 @@ public:
   {
     /** Typedefs. */
     typedef itk::Image< TComponentType, VDimension >    InputImageType;
-    typedef itk::ImageSliceConstIteratorWithIndex<
-      InputImageType >                                  SliceConstIteratorType;
-    typedef itk::ImageSliceIteratorWithIndex<
-      InputImageType >                                  SliceIteratorType;
+    typedef itk::ImageRegionConstIterator<
+      InputImageType >                                  ConstIteratorType;
+    typedef itk::ImageRegionIterator< InputImageType >  IteratorType;
     typedef itk::ImageFileReader< InputImageType >      ReaderType;
     typedef itk::ImageFileWriter< InputImageType >      WriterType;
     typedef typename InputImageType::RegionType         RegionType;
     typedef typename RegionType::IndexType              IndexType;
     typedef typename InputImageType::SizeType           SizeType;
 
-    /** Read in the inputImage. */
+    /** Read the information of the inputImage. If the file format supports
+     * streamed reading, only the slices that are kept are read, one by one.
+     * Otherwise the image is read once, as a whole.
+     */
     typename ReaderType::Pointer reader = ReaderType::New();
     reader->SetFileName( this->m_InputFileName.c_str() );
-    reader->Update();
+    reader->SetUseStreaming( true );
+    reader->UpdateOutputInformation();
+    const bool readSlices = reader->GetImageIO()->CanStreamRead();
+    if( !readSlices ) reader->Update();
+    const RegionType inputRegion = reader->GetOutput()->GetLargestPossibleRegion();
 
     /** Define size of output image. */
-    SizeType sizeIn = reader->GetOutput()->GetLargestPossibleRegion().GetSize();
+    SizeType sizeIn = inputRegion.GetSize();
     SizeType sizeOut = sizeIn;
     float newSize = vcl_ceil(
       ( static_cast<float>( sizeOut[ this->m_Direction ] - this->m_Offset ) )
@@ -104,7 +110,7 @@ public:
 
     /** Define region of output image. */
     RegionType region;
-    region.SetIndex( reader->GetOutput()->GetLargestPossibleRegion().GetIndex() );
+    region.SetIndex( inputRegion.GetIndex() );
     region.SetSize( sizeOut );
 
     /** Create output image. */
@@ -114,65 +120,31 @@ public:
     outputImage->SetRegions( region );
     outputImage->Allocate();
 
-    /** Create iterators. */
-    SliceConstIteratorType itIn( reader->GetOutput(), reader->GetOutput()->GetLargestPossibleRegion() );
-    SliceIteratorType itOut( outputImage, outputImage->GetLargestPossibleRegion() );
-
-    /** Set direction, default slice = z. */
-    if( this->m_Direction == 0 )
-    {
-      itIn.SetFirstDirection(1);
-      itIn.SetSecondDirection(2);
-      itOut.SetFirstDirection(1);
-      itOut.SetSecondDirection(2);
-    }
-    else if( this->m_Direction == 1 )
-    {
-      itIn.SetFirstDirection(0);
-      itIn.SetSecondDirection(2);
-      itOut.SetFirstDirection(0);
-      itOut.SetSecondDirection(2);
-    }
-    else if( this->m_Direction == 2 )
-    {
-      itIn.SetFirstDirection(0);
-      itIn.SetSecondDirection(1);
-      itOut.SetFirstDirection(0);
-      itOut.SetSecondDirection(1);
-    }
-
-    /** Initialize iterators. */
-    itIn.GoToBegin();
-    itOut.GoToBegin();
-    IndexType index= itIn.GetIndex();
-    index[ this->m_Direction ] += this->m_Offset;
-    itIn.SetIndex( index );
-
-    /** Loop over images. */
-    while( !itOut.IsAtEnd() )
+    /** Loop over the output slices, and copy the corresponding input slice. */
+    RegionType sliceIn = inputRegion;
+    RegionType sliceOut = region;
+    sliceIn.SetSize( this->m_Direction, 1 );
+    sliceOut.SetSize( this->m_Direction, 1 );
+    for( unsigned int k = 0; k < sizeOut[ this->m_Direction ]; k++ )
     {
-      while( !itOut.IsAtEndOfSlice() )
+      sliceIn.SetIndex( this->m_Direction, inputRegion.GetIndex()[ this->m_Direction ]
+        + this->m_Offset + k * this->m_EveryOther );
+      sliceOut.SetIndex( this->m_Direction, region.GetIndex()[ this->m_Direction ] + k );
+      if( readSlices )
       {
-        while( !itOut.IsAtEndOfLine() )
-        {
-          itOut.Set( itIn.Get() );
-          ++itIn;
-          ++itOut;
-        }
-        itIn.NextLine();
-        itOut.NextLine();
+        reader->GetOutput()->SetRequestedRegion( sliceIn );
+        reader->Update();
       }
-      itIn.NextSlice();
-      itOut.NextSlice();
 
-      /** Skip some slices in inputImage. */
-      index = itIn.GetIndex();
-      for( unsigned int i = 1; i < this->m_EveryOther; i++ )
+      ConstIteratorType itIn( reader->GetOutput(), sliceIn );
+      IteratorType itOut( outputImage, sliceOut );
+      while( !itOut.IsAtEnd() )
       {
-        index[ this->m_Direction ]++;
+        itOut.Set( itIn.Get() );
+        ++itIn;
+        ++itOut;
       }
-      itIn.SetIndex( index );
-    } // end while
+    } // end for
 
     /** Write the output image. */
     typename WriterType::Pointer writer = WriterType::New();
@@ -151,6 +151,7 @@ int main( int argc, char ** argv )
     filter->m_OutputFileName = outputFileName;
     filter->m_Indices = indices;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
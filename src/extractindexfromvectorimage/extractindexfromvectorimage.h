@@ -19,11 +19,12 @@
 #define __extractindexfromvectorimage_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsHelpers.h"
+#include "ITKToolsImageProperties.h"
+#include "ITKToolsMemoryMapping.h"
 
 #include "itkImageFileReader.h"
-#include "itkImageToVectorImageFilter.h"
 #include "itkImageFileWriter.h"
-#include "itkVectorIndexSelectionCastImageFilter.h"
 
 #include "itkImage.h"
 #include "itkVectorImage.h"
@@ -78,43 +79,143 @@ public:
   {
     /** Use vector image type that dynamically determines vector length: */
     typedef itk::VectorImage< TComponentType, VDimension >  VectorImageType;
-    typedef itk::Image< TComponentType, VDimension >        ScalarImageType;
     typedef itk::ImageFileReader< VectorImageType >         ImageReaderType;
-    typedef itk::VectorIndexSelectionCastImageFilter<
-      VectorImageType, ScalarImageType >                    IndexExtractorType;
     typedef itk::ImageFileWriter< VectorImageType >         ImageWriterType;
 
+    /** For a raw interleaved input, gather the components from the mapped
+     * file, without reading the other components into memory.
+     */
+    if( this->ExtractFromMappedFile<VectorImageType, ImageWriterType>() ) return;
+
     /** Read input image. */
     typename ImageReaderType::Pointer reader = ImageReaderType::New();
     reader->SetFileName( this->m_InputFileName );
     reader->Update();
+    const VectorImageType * input = reader->GetOutput();
+
+    /** Gather the requested components straight from the interleaved
+     * input buffer, without a scalar image per component.
+     */
+    typename VectorImageType::Pointer output = VectorImageType::New();
+    output->CopyInformation( input );
+    output->SetRegions( input->GetBufferedRegion() );
+    output->SetNumberOfComponentsPerPixel( this->m_Indices.size() );
+    output->Allocate();
+    this->GatherComponents( input->GetBufferPointer(),
+      input->GetNumberOfComponentsPerPixel(), output.GetPointer() );
 
-    /** Extract indices. */
+    /** Write output image. */
+    typename ImageWriterType::Pointer writer = ImageWriterType::New();
+    writer->SetFileName( this->m_OutputFileName );
+    writer->SetInput( output );
+    writer->Update();
 
-    // Create the assembler
-    typedef itk::ImageToVectorImageFilter<ScalarImageType> ImageToVectorImageFilterType;
-    typename ImageToVectorImageFilterType::Pointer imageToVectorImageFilter = ImageToVectorImageFilterType::New();
+  } // end Run()
 
-    for( unsigned int i = 0; i < this->m_Indices.size(); ++i )
+  /** Memory map the pixel data of the input, if it is an uncompressed
+   * MetaImage in the native byte order, and copy the requested components
+   * with a strided loop over the mapped pixels. The pages of the file are
+   * only paged in, not copied into the memory of the process; for large
+   * pixels, the pages without a requested component are not read at all.
+   * Returns false if the input can not be mapped.
+   */
+  template< class TVectorImage, class TWriter >
+  bool ExtractFromMappedFile( void )
+  {
+    typedef TVectorImage                         VectorImageType;
+    typedef typename VectorImageType::SizeType   SizeType;
+
+    /** Check the input. */
+    itk::ImageIOBase::Pointer imageIOBase;
+    if( !itktools::GetImageIOBase( this->m_InputFileName, imageIOBase )
+      || imageIOBase->GetNumberOfDimensions() != VDimension
+      || !itktools::IsType<TComponentType>( imageIOBase->GetComponentType() ) )
+    {
+      return false;
+    }
+    const std::size_t inputComponents = imageIOBase->GetNumberOfComponents();
+    const std::size_t outputComponents = this->m_Indices.size();
+    for( std::size_t i = 0; i < outputComponents; ++i )
     {
-      typename IndexExtractorType::Pointer extractor = IndexExtractorType::New();
-      extractor->SetInput( reader->GetOutput() );
-      extractor->SetIndex( this->m_Indices[ i ] );
-      extractor->Update();
-      //extractor->DisconnectPipeline();
+      if( this->m_Indices[ i ] >= inputComponents ) return false;
+    }
 
-      imageToVectorImageFilter->SetNthInput( i, extractor->GetOutput() );
+    /** Get the image geometry. */
+    SizeType size;
+    typename VectorImageType::SpacingType   spacing;
+    typename VectorImageType::PointType     origin;
+    typename VectorImageType::DirectionType direction;
+    std::size_t numberOfPixels = 1;
+    for( unsigned int i = 0; i < VDimension; ++i )
+    {
+      size[ i ] = imageIOBase->GetDimensions( i );
+      spacing[ i ] = imageIOBase->GetSpacing( i );
+      origin[ i ] = imageIOBase->GetOrigin( i );
+      for( unsigned int j = 0; j < VDimension; ++j )
+      {
+        direction[ j ][ i ] = imageIOBase->GetDirection( i )[ j ];
+      }
+      numberOfPixels *= size[ i ];
     }
 
-    imageToVectorImageFilter->Update();
+    /** Map the data file. */
+    const std::size_t dataSize = numberOfPixels * inputComponents * sizeof( TComponentType );
+    std::string dataFileName = "";
+    std::size_t dataOffset = 0;
+    itktools::MemoryMappedFile mappedFile;
+    if( !itktools::GetMemoryMappableDataFile( this->m_InputFileName,
+        imageIOBase, dataSize, dataFileName, dataOffset )
+      || dataOffset % sizeof( TComponentType ) != 0
+      || !mappedFile.Open( dataFileName )
+      || dataOffset + dataSize > mappedFile.GetSize() )
+    {
+      return false;
+    }
+
+    /** Create the output, and gather the components. */
+    typename VectorImageType::Pointer output = VectorImageType::New();
+    output->SetRegions( size );
+    output->SetSpacing( spacing );
+    output->SetOrigin( origin );
+    output->SetDirection( direction );
+    output->SetNumberOfComponentsPerPixel( outputComponents );
+    output->Allocate();
+
+    this->GatherComponents( reinterpret_cast<const TComponentType *>(
+      mappedFile.GetPointer() + dataOffset ), inputComponents, output.GetPointer() );
+    mappedFile.Close();
 
     /** Write output image. */
-    typename ImageWriterType::Pointer writer = ImageWriterType::New();
+    typename TWriter::Pointer writer = TWriter::New();
     writer->SetFileName( this->m_OutputFileName );
-    writer->SetInput( imageToVectorImageFilter->GetOutput() );
+    writer->SetInput( output );
     writer->Update();
 
-  } // end Run()
+    return true;
+
+  } // end ExtractFromMappedFile()
+
+  /** Copy the requested components of every pixel of an interleaved
+   * buffer into the allocated output, with a strided loop.
+   */
+  template< class TVectorImage >
+  void GatherComponents( const TComponentType * in,
+    std::size_t inputComponents, TVectorImage * output )
+  {
+    const std::size_t outputComponents = this->m_Indices.size();
+    const std::size_t numberOfPixels = output->GetBufferedRegion().GetNumberOfPixels();
+    TComponentType * out = output->GetBufferPointer();
+    for( std::size_t p = 0; p < numberOfPixels; ++p )
+    {
+      for( std::size_t i = 0; i < outputComponents; ++i )
+      {
+        out[ i ] = in[ this->m_Indices[ i ] ];
+      }
+      in += inputComponents;
+      out += outputComponents;
+    }
+
+  } // end GatherComponents()
 
 }; // end class ITKToolsExtractIndex
 
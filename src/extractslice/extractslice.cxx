@@ -48,8 +48,13 @@ std::string GetHelpString( void )
     << "  [-out]   output image filename\n"
     << "  [-opct]  pixel type of input and output images;\n"
     << "           default: automatically determined from the first input image.\n"
-    << "  -sn      slice number\n"
+    << "  -sn      slice number, or \"all\" to extract all slices\n"
     << "  [-d]     the dimension from which a slice is extracted, default the z dimension\n"
+    << "  [-w]     windowMinimum windowMaximum: with -sn all, map this window to\n"
+    << "           [0, 255] and write unsigned char slices, e.g. for bmp or png\n"
+    << "With -sn all the volume is read once, and the slices are written in parallel\n"
+    << "to the files given by -out with %d replaced by the slice number,\n"
+    << "e.g. slice%03d.png; without %d in -out, _%03d is added before the extension.\n"
     << "Supported pixel types: (unsigned) char, (unsigned) short, float.";
 
   return ss.str();
@@ -86,11 +91,25 @@ int main( int argc, char ** argv )
   parser->GetCommandLineArgument( "-in", inputFileName );
 
   /** Get the slicenumber which is to be extracted. */
-  unsigned int slicenumber = 0;
-  parser->GetCommandLineArgument( "-sn", slicenumber );
-
   std::string slicenumberstring;
   parser->GetCommandLineArgument( "-sn", slicenumberstring );
+  const bool allSlices = slicenumberstring == "all";
+
+  unsigned int slicenumber = 0;
+  if( !allSlices ) parser->GetCommandLineArgument( "-sn", slicenumber );
+
+  /** Get the window, for all slices. */
+  std::vector<double> window;
+  bool retw = parser->GetCommandLineArgument( "-w", window );
+  if( retw && ( window.size() != 2 || window[ 1 ] < window[ 0 ] ) )
+  {
+    std::cerr << "ERROR: -w should be a minimum and a larger maximum." << std::endl;
+    return EXIT_FAILURE;
+  }
+  if( retw && !allSlices )
+  {
+    std::cerr << "WARNING: -w is only used with -sn all." << std::endl;
+  }
 
   /** Get the dimension in which the slice is to be extracted.
    * The default is the z-direction.
@@ -121,7 +140,7 @@ int main( int argc, char ** argv )
   }
 
   /** Sanity check. */
-  if( slicenumber > imageSize[ which_dimension ] )
+  if( !allSlices && slicenumber > imageSize[ which_dimension ] )
   {
     std::cerr << "ERROR: You selected slice number "
       << slicenumber
@@ -152,7 +171,30 @@ int main( int argc, char ** argv )
   std::string part2 =
     itksys::SystemTools::GetFilenameLastExtension( inputFileName );
   std::string outputFileName = part1 + "_slice_" + direction + "=" + slicenumberstring + part2;
-  parser->GetCommandLineArgument( "-out", outputFileName );
+  if( allSlices ) outputFileName = part1 + "_slice_" + direction + "=%03d" + part2;
+  bool retout = parser->GetCommandLineArgument( "-out", outputFileName );
+
+  /** For all slices the output is a pattern with a single %d. */
+  if( allSlices && retout && outputFileName.find( '%' ) == std::string::npos )
+  {
+    std::string path = itksys::SystemTools::GetFilenamePath( outputFileName );
+    if( !path.empty() ) path += "/";
+    outputFileName = path
+      + itksys::SystemTools::GetFilenameWithoutLastExtension( outputFileName ) + "_%03d"
+      + itksys::SystemTools::GetFilenameLastExtension( outputFileName );
+  }
+  if( allSlices )
+  {
+    const std::string::size_type percent = outputFileName.find( '%' );
+    const std::string::size_type conversion
+      = outputFileName.find_first_not_of( "0123456789", percent + 1 );
+    if( conversion == std::string::npos || outputFileName[ conversion ] != 'd'
+      || outputFileName.find( '%', percent + 1 ) != std::string::npos )
+    {
+      std::cerr << "ERROR: -out should contain a single %d, e.g. slice%03d.png." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
 
   /** Class that does the work. */
   ITKToolsExtractSliceBase * filter = 0;
@@ -176,7 +218,10 @@ int main( int argc, char ** argv )
     filter->m_OutputFileName = outputFileName;
     filter->m_WhichDimension = which_dimension;
     filter->m_Slicenumber = slicenumber;
+    filter->m_AllSlices = allSlices;
+    if( retw ) filter->m_Window = window;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
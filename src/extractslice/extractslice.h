@@ -23,7 +23,13 @@
 #include "itkImageFileReader.h"
 #include "itkExtractImageFilter.h"
 #include "itkImageFileWriter.h"
+#include "itkImageIOFactory.h"
+#include "itkImageLinearConstIteratorWithIndex.h"
+#include "itkIntensityWindowingImageFilter.h"
+#include "itkMultiThreader.h"
+#include <vnl/algo/vnl_determinant.h>
 
+#include <cstdio>
 #include <string>
 #include <vector>
 
@@ -44,6 +50,7 @@ public:
     this->m_OutputFileName = "";
     this->m_Slicenumber = 0;
     this->m_WhichDimension = 0;
+    this->m_AllSlices = false;
   };
   /** Destructor. */
   ~ITKToolsExtractSliceBase(){};
@@ -54,6 +61,11 @@ public:
   unsigned int m_Slicenumber;
   unsigned int m_WhichDimension;
 
+  /** Extract all slices, to m_OutputFileName as a printf pattern of the
+   * slice number; with a window, as unsigned char. */
+  bool m_AllSlices;
+  std::vector<double> m_Window;
+
 }; // end class ITKToolsExtractSliceBase
 
 
@@ -85,6 +97,13 @@ public:
   /** Run function. */
   void Run( void )
   {
+    if( this->m_AllSlices )
+    {
+      if( this->m_Window.size() == 2 ) this->ExtractAllSlices<unsigned char>();
+      else this->ExtractAllSlices<TComponentType>();
+      return;
+    }
+
     /** Some typedef's. */
     typedef itk::Image<TComponentType, 3>         Image3DType;
     typedef itk::Image<TComponentType, 2>         Image2DType;
@@ -97,10 +116,14 @@ public:
     typedef typename Image3DType::SizeType        SizeType;
     typedef typename Image3DType::IndexType       IndexType;
 
-    /** Create reader. */
+    /** Create reader. Only the information is read here, the slice itself
+     * is read when the writer requests it, without reading the rest of the
+     * volume for file formats that support streamed reading.
+     */
     typename ImageReaderType::Pointer reader = ImageReaderType::New();
     reader->SetFileName( this->m_InputFileName.c_str() );
-    reader->Update();
+    reader->SetUseStreaming( true );
+    reader->UpdateOutputInformation();
 
     /** Create extractor. */
     typename ExtractFilterType::Pointer extractor = ExtractFilterType::New();
@@ -133,6 +156,174 @@ public:
 
   } // end Run()
 
+  /** The shared data of the threads that write the slices. */
+  template< class TOutputComponentType >
+  struct SliceThreadStruct
+  {
+    typedef itk::Functor::IntensityWindowingTransform<
+      TComponentType, TOutputComponentType >      WindowingType;
+
+    const itk::Image<TComponentType, 3> *         Image;
+    unsigned int                                  WhichDimension;
+    std::vector< std::string >                    FileNames;
+    std::vector< itk::ImageIOBase::Pointer >      ImageIOs;
+    bool                                          UseWindow;
+    WindowingType                                 Windowing;
+    std::vector< std::string >                    ErrorMessages;
+  };
+
+  /** Read the volume once, and write all its slices, in parallel over
+   * the slices. The slices get the geometry pxextractslice gives a single
+   * slice, and are windowed to [0, 255] if a window is given.
+   */
+  template< class TOutputComponentType >
+  void ExtractAllSlices( void )
+  {
+    typedef itk::Image<TComponentType, 3>           Image3DType;
+    typedef itk::ImageFileReader<Image3DType>       ImageReaderType;
+    typedef SliceThreadStruct<TOutputComponentType> ThreadStructType;
+
+    typename ImageReaderType::Pointer reader = ImageReaderType::New();
+    reader->SetFileName( this->m_InputFileName.c_str() );
+    this->ObserveProcess( reader.GetPointer(), "read" );
+    reader->Update();
+
+    ThreadStructType str;
+    str.Image = reader->GetOutput();
+    str.WhichDimension = this->m_WhichDimension;
+    str.UseWindow = this->m_Window.size() == 2;
+    if( str.UseWindow )
+    {
+      /** The factor and offset are set by the filter, not by the functor. */
+      const double window = this->m_Window[ 1 ] - this->m_Window[ 0 ];
+      const double factor = window > 0.0 ? 255.0 / window : 0.0;
+      str.Windowing.SetWindowMinimum( static_cast<TComponentType>( this->m_Window[ 0 ] ) );
+      str.Windowing.SetWindowMaximum( static_cast<TComponentType>( this->m_Window[ 1 ] ) );
+      str.Windowing.SetOutputMinimum( 0 );
+      str.Windowing.SetOutputMaximum( 255 );
+      str.Windowing.SetFactor( factor );
+      str.Windowing.SetOffset( 0.5 - this->m_Window[ 0 ] * factor );
+    }
+
+    /** The file names, and their IO objects, created here since the
+     * object factories are not meant to be used by several threads. */
+    const unsigned int numberOfSlices
+      = str.Image->GetLargestPossibleRegion().GetSize()[ this->m_WhichDimension ];
+    std::vector<char> fileName( this->m_OutputFileName.size() + 32 );
+    for( unsigned int i = 0; i < numberOfSlices; ++i )
+    {
+      snprintf( &fileName[ 0 ], fileName.size(), this->m_OutputFileName.c_str(), i );
+      str.FileNames.push_back( &fileName[ 0 ] );
+      str.ImageIOs.push_back( itk::ImageIOFactory::CreateImageIO(
+        str.FileNames.back().c_str(), itk::ImageIOFactory::WriteMode ) );
+      if( str.ImageIOs.back().IsNull() )
+      {
+        itkGenericExceptionMacro( << "No ImageIO could be created for \""
+          << str.FileNames.back() << "\"." );
+      }
+    }
+    str.ErrorMessages.resize( numberOfSlices );
+
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    threader->SetNumberOfThreads( std::max( 1u, std::min(
+      numberOfSlices, static_cast<unsigned int>( threader->GetNumberOfThreads() ) ) ) );
+    threader->SetSingleMethod( SliceThreaderCallback<TOutputComponentType>, &str );
+    threader->SingleMethodExecute();
+
+    for( unsigned int i = 0; i < numberOfSlices; ++i )
+    {
+      if( !str.ErrorMessages[ i ].empty() )
+      {
+        itkGenericExceptionMacro( << str.ErrorMessages[ i ] );
+      }
+    }
+
+  } // end ExtractAllSlices()
+
+  /** Extract and write the slices of a thread. */
+  template< class TOutputComponentType >
+  static ITK_THREAD_RETURN_TYPE SliceThreaderCallback( void * arg )
+  {
+    typedef itk::MultiThreader::ThreadInfoStruct      ThreadInfoType;
+    typedef SliceThreadStruct<TOutputComponentType>   ThreadStructType;
+    typedef itk::Image<TComponentType, 3>             Image3DType;
+    typedef itk::Image<TOutputComponentType, 2>       Image2DType;
+    typedef itk::ImageFileWriter<Image2DType>         ImageWriterType;
+    typedef itk::ImageLinearConstIteratorWithIndex<
+      Image3DType >                                   IteratorType;
+
+    ThreadInfoType * info = static_cast<ThreadInfoType *>( arg );
+    ThreadStructType * str = static_cast<ThreadStructType *>( info->UserData );
+
+    const unsigned int numberOfSlices = str->FileNames.size();
+    const unsigned int begin = numberOfSlices * info->ThreadID / info->NumberOfThreads;
+    const unsigned int end = numberOfSlices * ( info->ThreadID + 1 ) / info->NumberOfThreads;
+
+    /** The two dimensions that are kept, and the geometry of a slice,
+     * as ExtractImageFilter sets it with a collapse to the submatrix. */
+    const typename Image3DType::RegionType inputRegion
+      = str->Image->GetLargestPossibleRegion();
+    const unsigned int d = str->WhichDimension;
+    const unsigned int kept[ 2 ] = { d == 0 ? 1u : 0u, d == 2 ? 1u : 2u };
+    typename Image2DType::RegionType sliceRegion;
+    typename Image2DType::SpacingType spacing;
+    typename Image2DType::PointType origin;
+    typename Image2DType::DirectionType direction;
+    for( unsigned int i = 0; i < 2; ++i )
+    {
+      sliceRegion.SetIndex( i, inputRegion.GetIndex()[ kept[ i ] ] );
+      sliceRegion.SetSize( i, inputRegion.GetSize()[ kept[ i ] ] );
+      spacing[ i ] = str->Image->GetSpacing()[ kept[ i ] ];
+      origin[ i ] = str->Image->GetOrigin()[ kept[ i ] ];
+      for( unsigned int j = 0; j < 2; ++j )
+      {
+        direction[ i ][ j ] = str->Image->GetDirection()[ kept[ i ] ][ kept[ j ] ];
+      }
+    }
+    if( vnl_determinant( direction.GetVnlMatrix() ) == 0.0 ) direction.SetIdentity();
+
+    for( unsigned int s = begin; s < end; ++s )
+    {
+      try
+      {
+        typename Image2DType::Pointer slice = Image2DType::New();
+        slice->SetRegions( sliceRegion );
+        slice->SetSpacing( spacing );
+        slice->SetOrigin( origin );
+        slice->SetDirection( direction );
+        slice->Allocate();
+
+        /** Copy the slice, along the first kept dimension. */
+        typename Image3DType::RegionType region = inputRegion;
+        region.SetIndex( d, inputRegion.GetIndex()[ d ] + s );
+        region.SetSize( d, 1 );
+        IteratorType it( str->Image, region );
+        it.SetDirection( kept[ 0 ] );
+        TOutputComponentType * out = slice->GetBufferPointer();
+        for( it.GoToBegin(); !it.IsAtEnd(); it.NextLine() )
+        {
+          for( ; !it.IsAtEndOfLine(); ++it, ++out )
+          {
+            *out = str->UseWindow ? str->Windowing( it.Get() )
+              : static_cast<TOutputComponentType>( it.Get() );
+          }
+        }
+
+        typename ImageWriterType::Pointer writer = ImageWriterType::New();
+        writer->SetFileName( str->FileNames[ s ].c_str() );
+        writer->SetImageIO( str->ImageIOs[ s ] );
+        writer->SetInput( slice );
+        writer->Update();
+      }
+      catch( itk::ExceptionObject & excp )
+      {
+        str->ErrorMessages[ s ] = excp.GetDescription();
+      }
+    }
+
+    return ITK_THREAD_RETURN_VALUE;
+  } // end SliceThreaderCallback()
+
 }; // end class ITKToolsExtractSlice
 
 
@@ -27,14 +27,13 @@
 #include "ITKToolsImageProperties.h"
 #include "ITKToolsHelpers.h"
 
-//#include "itkFFTWRealToComplexConjugateImageFilter.h"
 #include "itkFFTWForwardFFTImageFilter.h"
-//#include "itkFFTWComplexConjugateToRealImageFilter.h"
+#include "itkFFTWRealToHalfHermitianForwardFFTImageFilter.h"
 #include "itkFFTWInverseFFTImageFilter.h"
-#include "itkComplexToRealImageFilter.h"
-#include "itkComplexToImaginaryImageFilter.h"
-//#include "itkComposeComplexImageFilter.h"
+#include "itkFFTWHalfHermitianToRealInverseFFTImageFilter.h"
+#include "itkFFTWGlobalConfiguration.h"
 #include "itkComposeImageFilter.h"
+#include "itkMultiThreader.h"
 
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
@@ -63,10 +62,20 @@ std::string GetHelpString( void )
   << "               2: write the real and imaginary images, default in + Real.mhd and in + Imaginary.mhd" << std::endl
   << "               3: write the complex, real and imaginary images" << std::endl
   << "             backward: only one output, default in + IFFT" << std::endl
+  << "  [-mag]   forward: also write the magnitude of the spectrum" << std::endl
+  << "  [-phase] forward: also write the phase of the spectrum" << std::endl
   << "  [-opct]  the output type" << std::endl
   << "             choose from {float, double}, default float" << std::endl
-//  << "  [-xdim]  the backward transform needs to know if the actual x-dimension was odd or even." << std::endl
-//  << "             choose from {odd, even}, default even" << std::endl
+  << "  [-half]  use the half spectrum of a real image: forward only computes" << std::endl
+  << "             and writes the non-negative x-frequencies, backward expects them." << std::endl
+  << "  [-xdim]  the backward transform of a half spectrum needs to know if the actual x-dimension was odd or even." << std::endl
+  << "             choose from {odd, even}, default even" << std::endl
+  << "  [-wisdom] a directory for the FFTW wisdom, which is read before and" << std::endl
+  << "             written after planning, so that repeated runs on the same size skip planning" << std::endl
+  << "  [-rigor] the FFTW planning rigor, choose from {estimate, measure, patient, exhaustive}," << std::endl
+  << "             default estimate, or measure when -wisdom is given" << std::endl
+  << "The real, imaginary, magnitude and phase images are computed in one pass over the spectrum." << std::endl
+  << "The FFTs use the number of threads of -threads." << std::endl
   << "Supported: 2D, 3D, (unsigned) char, (unsigned) short, (unsigned) int, (unsigned) long, float, double.";
 
   return ss.str();
@@ -80,11 +89,13 @@ if ( componentType == #type && Dimension == dim ) \
 { \
   if ( op == "forward" ) \
   { \
-    FFTImage< type, dim >( inputFileNames[ 0 ], outputFileNames ); \
+    FFTImage< type, dim >( inputFileNames[ 0 ], outputFileNames, \
+      magnitudeFileName, phaseFileName, halfSpectrum ); \
   } \
   else \
   { \
-    IFFTImage< type, dim >( inputFileNames, outputFileNames[ 0 ] ); \
+    IFFTImage< type, dim >( inputFileNames, outputFileNames[ 0 ], \
+      halfSpectrum, xdim == "odd" ); \
   } \
 }
 
@@ -93,12 +104,16 @@ if ( componentType == #type && Dimension == dim ) \
 /* Declare FFTImage. */
 template< class PixelType, unsigned int Dimension >
 void FFTImage( const std::string & inputFileName,
-  const std::vector<std::string> & outputFileNames );
+  const std::vector<std::string> & outputFileNames,
+  const std::string & magnitudeFileName,
+  const std::string & phaseFileName,
+  bool halfSpectrum );
 
 /* Declare IFFTImage. */
 template< class PixelType, unsigned int Dimension >
 void IFFTImage( const std::vector<std::string> & inputFileNames,
-  const std::string & outputFileName );
+  const std::string & outputFileName,
+  bool halfSpectrum, bool actualXDimensionIsOdd );
 
 /** Declare other functions. */
 std::string GetHelpString( void );
@@ -128,6 +143,9 @@ int main( int argc, char **argv )
     return EXIT_SUCCESS;
   }
 
+  /** Threading. */
+  itktools::ReadThreadingArguments( parser );
+
   /** Get arguments. */
   std::vector<std::string>  inputFileNames;
   parser->GetCommandLineArgument( "-in", inputFileNames );
@@ -141,8 +159,22 @@ int main( int argc, char **argv )
   std::string componentType = "float";
   bool retopct = parser->GetCommandLineArgument( "-opct", componentType );
 
-  //std::string xdim = "even";
-  //bool retxdim = parser->GetCommandLineArgument( "-xdim", xdim );
+  std::string magnitudeFileName = "";
+  parser->GetCommandLineArgument( "-mag", magnitudeFileName );
+
+  std::string phaseFileName = "";
+  parser->GetCommandLineArgument( "-phase", phaseFileName );
+
+  const bool halfSpectrum = parser->ArgumentExists( "-half" );
+
+  std::string xdim = "even";
+  bool retxdim = parser->GetCommandLineArgument( "-xdim", xdim );
+
+  std::string wisdomDirectory = "";
+  bool retwisdom = parser->GetCommandLineArgument( "-wisdom", wisdomDirectory );
+
+  std::string rigor = retwisdom ? "measure" : "estimate";
+  parser->GetCommandLineArgument( "-rigor", rigor );
 
   /** Check operator. */
   op = itksys::SystemTools::LowerCase( op );
@@ -165,7 +197,7 @@ int main( int argc, char **argv )
     return 1;
   }
 
-  /** Check xdim. 
+  /** Check xdim. */
   if ( op == "backward" && retxdim )
   {
     if ( xdim != "odd" && xdim != "even" )
@@ -174,7 +206,25 @@ int main( int argc, char **argv )
       return 1;
     }
   }
-  */
+
+  /** Setup FFTW planning: the rigor and the wisdom cache. */
+  rigor = itksys::SystemTools::LowerCase( rigor );
+  int planRigor = FFTW_ESTIMATE;
+  if ( rigor == "measure" ) planRigor = FFTW_MEASURE;
+  else if ( rigor == "patient" ) planRigor = FFTW_PATIENT;
+  else if ( rigor == "exhaustive" ) planRigor = FFTW_EXHAUSTIVE;
+  else if ( rigor != "estimate" )
+  {
+    std::cerr << "ERROR: \"-rigor\" should be one of {estimate, measure, patient, exhaustive}." << std::endl;
+    return 1;
+  }
+  itk::FFTWGlobalConfiguration::SetPlanRigor( planRigor );
+  if ( retwisdom )
+  {
+    itk::FFTWGlobalConfiguration::SetWisdomCacheBase( wisdomDirectory );
+    itk::FFTWGlobalConfiguration::SetReadWisdomCache( true );
+    itk::FFTWGlobalConfiguration::SetWriteWisdomCache( true );
+  }
 
   /** Check output names. */
   if ( outputFileNames.size() == 0 )
@@ -182,10 +232,11 @@ int main( int argc, char **argv )
     std::string inputpart = inputFileNames[ 0 ].substr( 0, inputFileNames[ 0 ].rfind( "." ) );
     if ( op == "forward" )
     {
-    outputFileNames.resize( 3 );
-      outputFileNames[ 0 ] = inputpart + "Complex.mhd";
-      outputFileNames[ 1 ] = inputpart + "Real.mhd";
-      outputFileNames[ 2 ] = inputpart + "Imaginary.mhd";
+      const std::string half = halfSpectrum ? "Half" : "";
+      outputFileNames.resize( 3 );
+      outputFileNames[ 0 ] = inputpart + half + "Complex.mhd";
+      outputFileNames[ 1 ] = inputpart + half + "Real.mhd";
+      outputFileNames[ 2 ] = inputpart + half + "Imaginary.mhd";
     }
     else if ( op == "backward" )
     {
@@ -255,33 +306,100 @@ int main( int argc, char **argv )
 } // end main()
 
 
+  /*
+   * ******************* WriteSpectrumComponents *******************
+   * Compute the requested real, imaginary, magnitude and phase images in
+   * one pass over the spectrum, and write them. Empty names are skipped.
+   */
+
+template< class PixelType, unsigned int Dimension >
+void WriteSpectrumComponents(
+  const itk::Image< std::complex< PixelType >, Dimension > * spectrum,
+  const std::vector<std::string> & componentFileNames )
+{
+  /** Typedefs. */
+  typedef itk::Image< PixelType, Dimension >        ImageType;
+  typedef itk::ImageFileWriter< ImageType >         WriterType;
+  typedef std::complex< PixelType >                 ComplexType;
+
+  /** Allocate the images that are written. */
+  std::vector< typename ImageType::Pointer > components( 4 );
+  std::vector< PixelType * > buffers( 4, static_cast<PixelType *>( 0 ) );
+  for ( unsigned int c = 0; c < 4; ++c )
+  {
+    if ( componentFileNames[ c ] == "" ) continue;
+    components[ c ] = ImageType::New();
+    components[ c ]->CopyInformation( spectrum );
+    components[ c ]->SetRegions( spectrum->GetBufferedRegion() );
+    components[ c ]->Allocate();
+    buffers[ c ] = components[ c ]->GetBufferPointer();
+  }
+
+  /** One pass over the spectrum. */
+  const ComplexType * in = spectrum->GetBufferPointer();
+  const std::size_t n = spectrum->GetBufferedRegion().GetNumberOfPixels();
+  for ( std::size_t i = 0; i < n; ++i )
+  {
+    const ComplexType & z = in[ i ];
+    if ( buffers[ 0 ] ) buffers[ 0 ][ i ] = z.real();
+    if ( buffers[ 1 ] ) buffers[ 1 ][ i ] = z.imag();
+    if ( buffers[ 2 ] ) buffers[ 2 ][ i ] = std::abs( z );
+    if ( buffers[ 3 ] ) buffers[ 3 ][ i ] = std::arg( z );
+  }
+
+  /** Write them. */
+  for ( unsigned int c = 0; c < 4; ++c )
+  {
+    if ( componentFileNames[ c ] == "" ) continue;
+    typename WriterType::Pointer writer = WriterType::New();
+    writer->SetFileName( componentFileNames[ c ].c_str() );
+    writer->SetInput( components[ c ] );
+    writer->Update();
+    components[ c ] = 0;
+  }
+
+} // end WriteSpectrumComponents()
+
+
   /*
    * ******************* FFTImage *******************
    */
 
 template< class PixelType, unsigned int Dimension >
 void FFTImage( const std::string & inputFileName,
-  const std::vector<std::string> & outputFileNames )
+  const std::vector<std::string> & outputFileNames,
+  const std::string & magnitudeFileName,
+  const std::string & phaseFileName,
+  bool halfSpectrum )
 {
   /** Typedefs. */
   typedef itk::Image< PixelType, Dimension >        ImageType;
+  typedef itk::Image<
+    std::complex< PixelType >, Dimension >          ComplexImageType;
   typedef itk::ImageFileReader< ImageType >         ReaderType;
-  typedef itk::ImageFileWriter< ImageType >         WriterType;
-  typedef itk::FFTWForwardFFTImageFilter< 
-    ImageType >                                     FFTFilterType;
-  typedef typename FFTFilterType::OutputImageType   ComplexImageType;
+  typedef itk::ImageToImageFilter<
+    ImageType, ComplexImageType >                   BaseFFTFilterType;
+  typedef itk::FFTWForwardFFTImageFilter<
+    ImageType, ComplexImageType >                   FFTFilterType;
+  typedef itk::FFTWRealToHalfHermitianForwardFFTImageFilter<
+    ImageType, ComplexImageType >                   HalfFFTFilterType;
   typedef itk::ImageFileWriter< ComplexImageType >  ComplexWriterType;
-  typedef itk::ComplexToRealImageFilter<
-    ComplexImageType, ImageType >                   RealFilterType;
-  typedef itk::ComplexToImaginaryImageFilter<
-    ComplexImageType, ImageType >                   ImaginaryFilterType;
 
   /** Read the image as float or double. */
   typename ReaderType::Pointer reader = ReaderType::New();
   reader->SetFileName( inputFileName.c_str() );
 
-  /** Compute the FFT of the image. */
-  typename FFTFilterType::Pointer fftFilter = FFTFilterType::New();
+  /** Compute the FFT of the image, the full or the half spectrum. */
+  typename BaseFFTFilterType::Pointer fftFilter = 0;
+  if ( halfSpectrum )
+  {
+    fftFilter = HalfFFTFilterType::New().GetPointer();
+  }
+  else
+  {
+    fftFilter = FFTFilterType::New().GetPointer();
+  }
+  fftFilter->SetNumberOfThreads( itk::MultiThreader::GetGlobalDefaultNumberOfThreads() );
   fftFilter->SetInput( reader->GetOutput() );
   fftFilter->Update();
 
@@ -297,33 +415,23 @@ void FFTImage( const std::string & inputFileName,
     complexWriter->SetInput( fftFilter->GetOutput() );
     complexWriter->Update();
   }
-  if ( outputFileNames.size() > 1 )
-  {
-    typename RealFilterType::Pointer realFilter = RealFilterType::New();
-    realFilter->SetInput( fftFilter->GetOutput() );
-
-    typename ImaginaryFilterType::Pointer imaginaryFilter = ImaginaryFilterType::New();
-    imaginaryFilter->SetInput( fftFilter->GetOutput() );
-
-    typename WriterType::Pointer writer1 = WriterType::New();
-    typename WriterType::Pointer writer2 = WriterType::New();
-
-    if ( outputFileNames.size() == 2 )
-    {
-      writer1->SetFileName( outputFileNames[ 0 ].c_str() );
-      writer2->SetFileName( outputFileNames[ 1 ].c_str() );
-    }
-    else
-    {
-      writer1->SetFileName( outputFileNames[ 1 ].c_str() );
-      writer2->SetFileName( outputFileNames[ 2 ].c_str() );
-    }
-    writer1->SetInput( realFilter->GetOutput() );
-    writer1->Update();
 
-    writer2->SetInput( imaginaryFilter->GetOutput() );
-    writer2->Update();
+  /** The real, imaginary, magnitude and phase images. */
+  std::vector<std::string> componentFileNames( 4, "" );
+  if ( outputFileNames.size() == 2 )
+  {
+    componentFileNames[ 0 ] = outputFileNames[ 0 ];
+    componentFileNames[ 1 ] = outputFileNames[ 1 ];
+  }
+  else if ( outputFileNames.size() > 2 )
+  {
+    componentFileNames[ 0 ] = outputFileNames[ 1 ];
+    componentFileNames[ 1 ] = outputFileNames[ 2 ];
   }
+  componentFileNames[ 2 ] = magnitudeFileName;
+  componentFileNames[ 3 ] = phaseFileName;
+  WriteSpectrumComponents< PixelType, Dimension >(
+    fftFilter->GetOutput(), componentFileNames );
 
 } // end FFTImage()
 
@@ -334,22 +442,39 @@ void FFTImage( const std::string & inputFileName,
 
 template< class PixelType, unsigned int Dimension >
 void IFFTImage( const std::vector<std::string> & inputFileNames,
-  const std::string & outputFileName )
+  const std::string & outputFileName,
+  bool halfSpectrum, bool actualXDimensionIsOdd )
 {
   /** Typedefs. */
   typedef itk::Image< PixelType, Dimension >            ImageType;
   typedef itk::Image< 
     std::complex< PixelType >, Dimension >                ComplexImageType;
+  typedef itk::ImageToImageFilter<
+    ComplexImageType, ImageType >                       BaseIFFTFilterType;
   typedef itk::FFTWInverseFFTImageFilter<
-    ComplexImageType >                                  IFFTFilterType;
+    ComplexImageType, ImageType >                       IFFTFilterType;
+  typedef itk::FFTWHalfHermitianToRealInverseFFTImageFilter<
+    ComplexImageType, ImageType >                       HalfIFFTFilterType;
   typedef itk::ImageFileReader< ImageType >             ReaderType;
   typedef itk::ImageFileReader< ComplexImageType >      ComplexReaderType;
   typedef itk::ComposeImageFilter<
     ImageType, ComplexImageType>                        ComposeComplexImageFilterType;
   typedef itk::ImageFileWriter< ImageType >             WriterType;
 
-  /** The IFFT of the image. */
-  typename IFFTFilterType::Pointer ifftFilter = IFFTFilterType::New();
+  /** The IFFT of the image, of the full or the half spectrum. The half
+   * spectrum needs to know if the actual x-dimension was odd or even. */
+  typename BaseIFFTFilterType::Pointer ifftFilter = 0;
+  if ( halfSpectrum )
+  {
+    typename HalfIFFTFilterType::Pointer halfFilter = HalfIFFTFilterType::New();
+    halfFilter->SetActualXDimensionIsOdd( actualXDimensionIsOdd );
+    ifftFilter = halfFilter.GetPointer();
+  }
+  else
+  {
+    ifftFilter = IFFTFilterType::New().GetPointer();
+  }
+  ifftFilter->SetNumberOfThreads( itk::MultiThreader::GetGlobalDefaultNumberOfThreads() );
 
   /** Read one complex image, or two scalar images, which need to
    * be combined into one complex image. */
@@ -373,17 +498,6 @@ void IFFTImage( const std::vector<std::string> & inputFileNames,
     ifftFilter->SetInput( composer->GetOutput() );
   }
 
-  /** Setup IFFT filter. 
-  if ( xdim == "odd" )
-  {
-    ifftFilter->SetActualXDimensionIsOdd( true );
-  }
-  else
-  {
-    ifftFilter->SetActualXDimensionIsOdd( false );
-  }
-  */
-
   /** Write the output image. */
   typename WriterType::Pointer writer = WriterType::New();
   writer->SetFileName( outputFileName.c_str() );
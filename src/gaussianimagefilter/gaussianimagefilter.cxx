@@ -43,14 +43,23 @@ std::string GetHelpString( void )
     << "  -in      inputFilename\n"
     << "  [-out]   outputFilename, default in + BLURRED.mhd\n"
     << "  [-std]   sigma, for each dimension, default 1.0\n"
+    << "  [-sigmas] a list of sigmas, all computed in one run from a single read\n"
+    << "           of the input; the sigma is inserted before the extension of the\n"
+    << "           output filename, e.g. outSigma2.mhd. Overrides -std.\n"
     << "  [-ord]   order, for each dimension, default zero\n"
     << "             0: zero order = blurring\n"
     << "             1: first order = gradient\n"
     << "             2: second order derivative\n"
     << "  [-mag]   compute the magnitude of the separate blurrings, default false\n"
     << "  [-lap]   compute the laplacian, default false\n"
-    << "  [-inv]   compute invariants, choose one of\n"
+    << "  [-inv]   compute invariants, choose one or more of\n"
     << "           {LiLi, LiLijLj, LiLijLjkLk, Lii, LijLji, LijLjkLki}\n"
+    << "           with more than one, the invariant name is inserted before\n"
+    << "           the extension of the output filename\n"
+    << "  [-float] store the derivatives and the Hessian of the invariants in float\n"
+    << "           instead of double, halving their memory, default false.\n"
+    << "           The Gaussians are computed in float anyway; the relative\n"
+    << "           difference of the invariants is of the order of 1e-6.\n"
     << "  [-opct]  output pixel type, default equal to input\n"
     << "Supported: 2D, 3D, (unsigned) char, (unsigned) short, (unsigned) int, (unsigned) long, float, double.";
 
@@ -90,6 +99,9 @@ int main( int argc, char ** argv )
   sigma.push_back( 1.0 ); // default 1.0 for each resolution
   parser->GetCommandLineArgument( "-std", sigma );
 
+  std::vector<float> sigmas;
+  bool retsigmas = parser->GetCommandLineArgument( "-sigmas", sigmas );
+
   std::vector<unsigned int> order;
   parser->GetCommandLineArgument( "-ord", order );
 
@@ -101,8 +113,10 @@ int main( int argc, char ** argv )
 
   bool retlap = parser->ArgumentExists( "-lap" );
 
-  std::string invariant = "LiLi";
-  bool retinv = parser->GetCommandLineArgument( "-inv", invariant );
+  std::vector<std::string> invariants( 1, "LiLi" );
+  bool retinv = parser->GetCommandLineArgument( "-inv", invariants );
+
+  const bool useFloat = parser->ArgumentExists( "-float" );
 
   std::string componentTypeAsString = "";
   bool retopct = parser->GetCommandLineArgument( "-opct", componentTypeAsString );
@@ -163,6 +177,13 @@ int main( int argc, char ** argv )
     }
   }
 
+  /** Check the list of sigmas. */
+  if( retsigmas && sigmas.empty() )
+  {
+    std::cerr << "ERROR: \"-sigmas\" should be followed by at least one sigma!" << std::endl;
+    return EXIT_FAILURE;
+  }
+
   /** Check sigma. */
   if( sigma.size() != 1 && sigma.size() != dim )
   {
@@ -200,9 +221,12 @@ int main( int argc, char ** argv )
     filter->m_OutputFileName = outputFileName;
     filter->m_WhichOperation = whichOperation;
     filter->m_Sigma = sigma;
+    filter->m_Sigmas = sigmas;
     filter->m_Order = order;
-    filter->m_Invariant = invariant;
+    filter->m_Invariants = invariants;
+    filter->m_UseFloat = useFloat;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
@@ -29,6 +29,8 @@
 #include "itkImageRegionIterator.h"
 #include "itkImageFileWriter.h"
 
+#include <sstream>
+
 
 /** \class ITKToolsContrastEnhanceImageBase
  *
@@ -45,7 +47,8 @@ public:
     this->m_InputFileName = "";
     this->m_OutputFileName = "";
     this->m_WhichOperation = "Gaussian";
-    this->m_Invariant = "LiLi";
+    this->m_Invariants.assign( 1, "LiLi" );
+    this->m_UseFloat = false;
   };
   /** Destructor. */
   ~ITKToolsGaussianBase(){};
@@ -55,8 +58,10 @@ public:
   std::string                 m_OutputFileName;
   std::string                 m_WhichOperation;
   std::vector<float>          m_Sigma;
+  std::vector<float>          m_Sigmas;
   std::vector<unsigned int>   m_Order;
-  std::string                 m_Invariant;
+  std::vector<std::string>    m_Invariants;
+  bool                        m_UseFloat;
 
 }; // end class ITKToolsGaussianBase
 
@@ -79,9 +84,45 @@ public:
   ~ITKToolsGaussian(){};
 
   typedef itk::Image< TComponentType, VDimension >  OutputImageType;
+  typedef float                                     InputPixelType;
+  typedef itk::Image< InputPixelType, VDimension >  InputImageType;
+  typedef itk::ImageFileReader< InputImageType >    ReaderType;
 
   /** Run function. */
   void Run( void )
+  {
+    /** Read the input image once, for all scales. */
+    typename ReaderType::Pointer reader = ReaderType::New();
+    reader->SetFileName( this->m_InputFileName );
+    reader->Update();
+    this->m_InputImage = reader->GetOutput();
+
+    if ( this->m_Sigmas.empty() )
+    {
+      this->RunOperation();
+      return;
+    }
+
+    /** Compute every scale, inserting the sigma before the extension
+     * of the output filename. */
+    const std::string outputFileName = this->m_OutputFileName;
+    std::string::size_type dot = outputFileName.rfind( "." );
+    if( dot == std::string::npos ) dot = outputFileName.size();
+    for ( std::size_t k = 0; k < this->m_Sigmas.size(); ++k )
+    {
+      std::ostringstream name;
+      name << outputFileName.substr( 0, dot ) << "Sigma" << this->m_Sigmas[ k ]
+        << outputFileName.substr( dot );
+      this->m_Sigma.assign( 1, this->m_Sigmas[ k ] );
+      this->m_OutputFileName = name.str();
+      this->RunOperation();
+    }
+    this->m_OutputFileName = outputFileName;
+
+  } // end Run();
+
+  /** Run the requested operation at the current sigma. */
+  void RunOperation( void )
   {
     if ( this->m_WhichOperation == "Gaussian" )
     {
@@ -97,9 +138,16 @@ public:
     }
     else if ( this->m_WhichOperation == "Invariants" )
     {
-      this->GaussianImageFilterInvariants();
+      if ( this->m_UseFloat )
+      {
+        this->template GaussianImageFilterInvariants< float >();
+      }
+      else
+      {
+        this->template GaussianImageFilterInvariants< double >();
+      }
     }
-  } // end Run();
+  } // end RunOperation();
 
   /**
    * ******************* GaussianImageFilter *******************
@@ -165,10 +213,21 @@ public:
    * L_{ij}L_{jk}L_{ki}    trace(H H H)
    *
    * where g is the gradient and H the Hessian, both computed using Gaussian
-   * derivatives at scale sigma.
+   * derivatives at scale sigma. They are stored in images of
+   * TInternalRealType, float halves the memory of the Hessian.
+   *
+   * Several invariants are computed in one run, from the same derivatives.
+   * With more than one, the name of the invariant is inserted before the
+   * extension of the output filename.
    */
+  template< class TInternalRealType >
   void GaussianImageFilterInvariants( void );
 
+protected:
+
+  /** The input image, read once by Run(). */
+  typename InputImageType::Pointer m_InputImage;
+
 }; // end class ITKToolsGaussian
 
 // \todo: move to hxx
@@ -183,19 +242,12 @@ ITKToolsGaussian< VDimension, TComponentType >
 ::GaussianImageFilter( void )
 {
   /** Typedef's. */
-  typedef float                                           InputPixelType;
-  typedef itk::Image< InputPixelType, VDimension >        InputImageType;
-  typedef itk::ImageFileReader< InputImageType >          ReaderType;
   typedef itk::SmoothingRecursiveGaussianImageFilter2<
     InputImageType, OutputImageType >                     FilterType;
   typedef typename FilterType::OrderType                  OrderType;
   typedef typename FilterType::SigmaType                  SigmaType;
   typedef itk::ImageFileWriter< OutputImageType >         WriterType;
 
-  /** Read in the input image. */
-  typename ReaderType::Pointer reader = ReaderType::New();
-  reader->SetFileName( this->m_InputFileName );
-
   /** Setup the this->m_Order and this->m_Sigma. */
   OrderType orderFA;
   SigmaType sigmaFA;
@@ -209,7 +261,7 @@ ITKToolsGaussian< VDimension, TComponentType >
   /** Setup the smoothing filter. */
   typename FilterType::Pointer filter = FilterType::New();
   filter->SetNormalizeAcrossScale( false );
-  filter->SetInput( reader->GetOutput() );
+  filter->SetInput( this->m_InputImage );
   filter->SetSigma( sigmaFA );
   filter->SetOrder( orderFA );
 
@@ -232,9 +284,6 @@ ITKToolsGaussian< VDimension, TComponentType >
 ::GaussianImageFilterMagnitude( void )
 {
   /** Typedef's. */
-  typedef float                                           InputPixelType;
-  typedef itk::Image< InputPixelType, VDimension >        InputImageType;
-  typedef itk::ImageFileReader< InputImageType >          ReaderType;
   typedef itk::SmoothingRecursiveGaussianImageFilter2<
     InputImageType, InputImageType >                      SmoothingFilterType;
   typedef typename SmoothingFilterType::Pointer           SmoothingFilterPointer;
@@ -248,10 +297,6 @@ ITKToolsGaussian< VDimension, TComponentType >
     VectorImageType, OutputImageType >                    MagnitudeFilterType;
   typedef itk::ImageFileWriter< OutputImageType >         WriterType;
 
-  /** Read in the input image. */
-  typename ReaderType::Pointer reader = ReaderType::New();
-  reader->SetFileName( this->m_InputFileName );
-
   /** Setup the this->m_Order and this->m_Sigma. */
   OrderType orderFA;
   SigmaType sigmaFA;
@@ -273,7 +318,7 @@ ITKToolsGaussian< VDimension, TComponentType >
     OrderType order2; order2.Fill( 0 ); order2[ i ] = orderFA[ i ];
 
     smoothingFilter[ i ] = SmoothingFilterType::New();
-    smoothingFilter[ i ]->SetInput( reader->GetOutput() );
+    smoothingFilter[ i ]->SetInput( this->m_InputImage );
     smoothingFilter[ i ]->SetNormalizeAcrossScale( false );
     smoothingFilter[ i ]->SetSigma( sigmaFA );
     smoothingFilter[ i ]->SetOrder( order2 );
@@ -307,9 +352,6 @@ ITKToolsGaussian< VDimension, TComponentType >
 {
   /** Typedef's. */
   typedef typename OutputImageType::PixelType             OutputPixelType;
-  typedef float                                           InputPixelType;
-  typedef itk::Image< InputPixelType, VDimension >         InputImageType;
-  typedef itk::ImageFileReader< InputImageType >          ReaderType;
   typedef itk::SmoothingRecursiveGaussianImageFilter2<
     InputImageType, InputImageType >                      SmoothingFilterType;
   typedef typename SmoothingFilterType::Pointer           SmoothingFilterPointer;
@@ -319,10 +361,6 @@ ITKToolsGaussian< VDimension, TComponentType >
   typedef itk::ImageRegionIterator< OutputImageType >     IteratorType;
   typedef itk::ImageFileWriter< OutputImageType >         WriterType;
 
-  /** Read in the input image. */
-  typename ReaderType::Pointer reader = ReaderType::New();
-  reader->SetFileName( this->m_InputFileName );
-
   /** Setup this->m_Sigma. */
   SigmaType sigmaFA; sigmaFA.Fill( this->m_Sigma[ 0 ] );
   if( this->m_Sigma.size() == VDimension )
@@ -340,7 +378,7 @@ ITKToolsGaussian< VDimension, TComponentType >
     /** Setup smoothing filter. */
     OrderType order; order.Fill( 0 ); order[ i ] = 2;
     smoothingFilter[ i ] = SmoothingFilterType::New();
-    smoothingFilter[ i ]->SetInput( reader->GetOutput() );
+    smoothingFilter[ i ]->SetInput( this->m_InputImage );
     smoothingFilter[ i ]->SetNormalizeAcrossScale( false );
     smoothingFilter[ i ]->SetSigma( sigmaFA );
     smoothingFilter[ i ]->SetOrder( order );
@@ -349,8 +387,8 @@ ITKToolsGaussian< VDimension, TComponentType >
 
   /** Create output image. */
   typename OutputImageType::Pointer outputImage = OutputImageType::New();
-  outputImage->CopyInformation( reader->GetOutput() );
-  outputImage->SetRegions( reader->GetOutput()->GetLargestPossibleRegion() );
+  outputImage->CopyInformation( this->m_InputImage );
+  outputImage->SetRegions( this->m_InputImage->GetLargestPossibleRegion() );
   outputImage->Allocate();
 
   /** Setup iterators. */
@@ -391,25 +429,19 @@ ITKToolsGaussian< VDimension, TComponentType >
  */
 
 template< unsigned int VDimension, class TComponentType >
+template< class TInternalRealType >
 void
 ITKToolsGaussian< VDimension, TComponentType >
 ::GaussianImageFilterInvariants( void )
 {
   /** Typedef's. */
   typedef typename OutputImageType::PixelType             OutputPixelType;
-  typedef float                                           InputPixelType;
-  typedef itk::Image< InputPixelType, VDimension >         InputImageType;
-  typedef itk::ImageFileReader< InputImageType >          ReaderType;
   typedef itk::GaussianInvariantsImageFilter<
-    InputImageType, OutputImageType >                     InvariantFilterType;
+    InputImageType, OutputImageType, TInternalRealType >  InvariantFilterType;
   typedef typename InvariantFilterType::Pointer           InvariantFilterPointer;
   typedef typename InvariantFilterType::SigmaType         SigmaType;
   typedef itk::ImageFileWriter< OutputImageType >         WriterType;
 
-  /** Read in the input image. */
-  typename ReaderType::Pointer reader = ReaderType::New();
-  reader->SetFileName( this->m_InputFileName );
-
   /** Setup this->m_Sigma. */
   SigmaType sigmaFA; sigmaFA.Fill( this->m_Sigma[ 0 ] );
   if( this->m_Sigma.size() == VDimension )
@@ -420,17 +452,31 @@ ITKToolsGaussian< VDimension, TComponentType >
     }
   }
 
-  /** Setup this->m_Invariant filter. */
+  /** Setup the invariant filter. */
   InvariantFilterPointer invariantFilter = InvariantFilterType::New();
   invariantFilter->SetSigma( sigmaFA );
-  invariantFilter->SetInvariant( this->m_Invariant );
-  invariantFilter->SetInput( reader->GetOutput() );
+  invariantFilter->SetInvariants( this->m_Invariants );
+  invariantFilter->SetInput( this->m_InputImage );
+  invariantFilter->Update();
+
+  /** Write the images. */
+  const std::size_t numberOfInvariants = this->m_Invariants.size();
+  std::string::size_type dot = this->m_OutputFileName.rfind( "." );
+  if( dot == std::string::npos ) dot = this->m_OutputFileName.size();
+  for( std::size_t k = 0; k < numberOfInvariants; ++k )
+  {
+    std::string outputFileName = this->m_OutputFileName;
+    if( numberOfInvariants > 1 )
+    {
+      outputFileName = this->m_OutputFileName.substr( 0, dot )
+        + this->m_Invariants[ k ] + this->m_OutputFileName.substr( dot );
+    }
 
-  /** Write image. */
-  typename WriterType::Pointer writer = WriterType::New();
-  writer->SetFileName( this->m_OutputFileName );
-  writer->SetInput( invariantFilter->GetOutput() );
-  writer->Update();
+    typename WriterType::Pointer writer = WriterType::New();
+    writer->SetFileName( outputFileName );
+    writer->SetInput( invariantFilter->GetOutput( k ) );
+    writer->Update();
+  }
 
 } // end GaussianImageFilterInvariants()
 
@@ -22,6 +22,9 @@
 #include "itkHessianRecursiveGaussianImageFilter2.h"
 #include "itkFixedArray.h"
 
+#include <string>
+#include <vector>
+
 
 namespace itk
 {
@@ -29,11 +32,27 @@ namespace itk
 /** \class GaussianInvariantsImageFilter
  * \brief Computes the
  *
+ * Any set of the invariants can be computed in one run, output i being
+ * invariant i. The first order derivatives are only computed if one of
+ * the invariants needs them, and so is the Hessian. All invariants are
+ * computed in one pass over these, after which they are released.
+ *
+ * The first order derivatives and the Hessian are stored in images of
+ * TInternalRealType, by default the real type of the input. With float
+ * the Hessian takes half the memory of double, SymmetricSecondRankTensor
+ * pixels of 24 instead of 48 bytes in 3D. The recursive Gaussians run in
+ * float anyway, see SmoothingRecursiveGaussianImageFilter2 and
+ * HessianRecursiveGaussianImageFilter2, so this only rounds the stored
+ * results, a relative error of about 1e-7 per component. The invariants
+ * themselves are computed in double from these components.
+ *
  * \ingroup IntensityImageFilters
  * \ingroup Singlethreaded
  */
 
-template < typename TInputImage,typename TOutputImage = TInputImage >
+template < typename TInputImage,typename TOutputImage = TInputImage,
+  typename TInternalRealType = typename NumericTraits<
+    typename TInputImage::PixelType >::ScalarRealType >
 class ITK_EXPORT GaussianInvariantsImageFilter:
     public ImageToImageFilter< TInputImage, TOutputImage >
 {
@@ -66,8 +85,12 @@ public:
     InputPixelType>::RealType                               RealType;
   typedef typename NumericTraits<
     InputPixelType>::ScalarRealType                         ScalarRealType;
-  typedef Image< ScalarRealType,
+  typedef TInternalRealType                                 InternalRealType;
+  typedef Image< InternalRealType,
     itkGetStaticConstMacro( ImageDimension ) >              RealImageType;
+  typedef Image< SymmetricSecondRankTensor< InternalRealType,
+    itkGetStaticConstMacro( ImageDimension ) >,
+    itkGetStaticConstMacro( ImageDimension ) >              HessianImageType;
 
   /** Typedef's for gradient and Hessian computers. */
   typedef SmoothingRecursiveGaussianImageFilter2<
@@ -75,7 +98,7 @@ public:
   typedef typename DerivativeFilterType::Pointer            DerivativeFilterPointer;
   typedef typename DerivativeFilterType::OrderType          OrderType;
   typedef HessianRecursiveGaussianImageFilter2<
-    InputImageType >                                        HessianFilterType;
+    InputImageType, HessianImageType >                      HessianFilterType;
   typedef typename HessianFilterType::Pointer               HessianFilterPointer;
   typedef typename HessianFilterType::OutputImageType       HessianOutputImageType;
   typedef typename HessianOutputImageType::PixelType        HessianPixelType;
@@ -94,6 +117,13 @@ public:
   /** Set which invariant is computed. */
   void SetInvariant( std::string arg );
 
+  /** Set which invariants are computed, one output for each. */
+  void SetInvariants( const std::vector<std::string> & arg );
+  const std::vector<std::string> & GetInvariants( void ) const
+  {
+    return this->m_Invariants;
+  }
+
 #ifdef ITK_USE_CONCEPT_CHECKING
   /** Begin concept checking */
   itkConceptMacro( InputHasNumericTraitsCheck,
@@ -126,7 +156,14 @@ private:
   /** Member variables. */
   bool        m_NormalizeAcrossScale;
   SigmaType   m_Sigma;
-  std::string m_Invariant;
+  std::vector<std::string> m_Invariants;
+
+  /** The supported invariants. */
+  typedef enum { InvariantLiLi = 0, InvariantLiLijLj, InvariantLiLijLjkLk,
+    InvariantLii, InvariantLijLji, InvariantLijLjkLki } InvariantIdType;
+
+  /** Get the id of an invariant name; throws for unknown names. */
+  InvariantIdType GetInvariantId( const std::string & name ) const;
 
   std::vector< DerivativeFilterPointer >  m_DerivativeFilters;
   HessianFilterPointer                    m_HessianFilter;
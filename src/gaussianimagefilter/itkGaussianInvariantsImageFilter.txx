@@ -25,6 +25,7 @@
 #include "vnl/vnl_matrix.h"
 #include "vnl/vnl_trace.h"
 #include "itkProgressAccumulator.h"
+#include <algorithm>
 
 
 namespace itk
@@ -33,13 +34,13 @@ namespace itk
 /**
  * Constructor
  */
-template <typename TInputImage, typename TOutputImage >
-GaussianInvariantsImageFilter<TInputImage,TOutputImage>
+template <typename TInputImage, typename TOutputImage, typename TInternalRealType>
+GaussianInvariantsImageFilter<TInputImage,TOutputImage,TInternalRealType>
 ::GaussianInvariantsImageFilter()
 {
   /** Initialize variables. */
   this->m_NormalizeAcrossScale = false;
-  this->m_Invariant = "";
+  this->m_Invariants.clear();
 
   /** Setup the derivative filters. */
   this->m_DerivativeFilters.resize( ImageDimension );
@@ -66,9 +67,9 @@ GaussianInvariantsImageFilter<TInputImage,TOutputImage>
 /**
  * Set value of Sigma
  */
-template <typename TInputImage, typename TOutputImage>
+template <typename TInputImage, typename TOutputImage, typename TInternalRealType>
 void
-GaussianInvariantsImageFilter<TInputImage,TOutputImage>
+GaussianInvariantsImageFilter<TInputImage,TOutputImage,TInternalRealType>
 ::SetSigma( const ScalarRealType sigma )
 {
   SigmaType sigmaFA;
@@ -80,9 +81,9 @@ GaussianInvariantsImageFilter<TInputImage,TOutputImage>
 /**
  * Set value of Sigma
  */
-template <typename TInputImage, typename TOutputImage>
+template <typename TInputImage, typename TOutputImage, typename TInternalRealType>
 void
-GaussianInvariantsImageFilter<TInputImage,TOutputImage>
+GaussianInvariantsImageFilter<TInputImage,TOutputImage,TInternalRealType>
 ::SetSigma( const SigmaType sigma )
 {
   if( this->m_Sigma != sigma )
@@ -104,9 +105,9 @@ GaussianInvariantsImageFilter<TInputImage,TOutputImage>
 /**
  * Set Normalize Across Scale Space
  */
-template <typename TInputImage, typename TOutputImage>
+template <typename TInputImage, typename TOutputImage, typename TInternalRealType>
 void
-GaussianInvariantsImageFilter<TInputImage,TOutputImage>
+GaussianInvariantsImageFilter<TInputImage,TOutputImage,TInternalRealType>
 ::SetNormalizeAcrossScale( const bool arg )
 {
   if( this->m_NormalizeAcrossScale != arg )
@@ -129,26 +130,73 @@ GaussianInvariantsImageFilter<TInputImage,TOutputImage>
  * Set invariant
  */
 
-template <typename TInputImage, typename TOutputImage>
+template <typename TInputImage, typename TOutputImage, typename TInternalRealType>
 void
-GaussianInvariantsImageFilter<TInputImage,TOutputImage>
+GaussianInvariantsImageFilter<TInputImage,TOutputImage,TInternalRealType>
 ::SetInvariant( std::string arg )
 {
-  if( this->m_Invariant != arg )
+  this->SetInvariants( std::vector<std::string>( 1, arg ) );
+
+} // end SetInvariant()
+
+
+/**
+ * Set the invariants
+ */
+
+template <typename TInputImage, typename TOutputImage, typename TInternalRealType>
+void
+GaussianInvariantsImageFilter<TInputImage,TOutputImage,TInternalRealType>
+::SetInvariants( const std::vector<std::string> & arg )
+{
+  if( this->m_Invariants != arg )
   {
-    this->m_Invariant = arg;
+    this->m_Invariants = arg;
+
+    /** Create an output for each invariant. */
+    const unsigned int numberOfOutputs = std::max<std::size_t>( arg.size(), 1 );
+    this->SetNumberOfRequiredOutputs( numberOfOutputs );
+    for( unsigned int i = 1; i < numberOfOutputs; ++i )
+    {
+      if( !this->GetOutput( i ) )
+      {
+        this->SetNthOutput( i, this->MakeOutput( i ) );
+      }
+    }
     this->Modified();
   }
 
-} // end SetInvariant()
+} // end SetInvariants()
+
+
+/**
+ * Get the id of an invariant
+ */
+
+template <typename TInputImage, typename TOutputImage, typename TInternalRealType>
+typename GaussianInvariantsImageFilter<TInputImage,TOutputImage,TInternalRealType>::InvariantIdType
+GaussianInvariantsImageFilter<TInputImage,TOutputImage,TInternalRealType>
+::GetInvariantId( const std::string & name ) const
+{
+  if( name == "LiLi" ) return InvariantLiLi;
+  if( name == "LiLijLj" ) return InvariantLiLijLj;
+  if( name == "LiLijLjkLk" ) return InvariantLiLijLjkLk;
+  if( name == "Lii" ) return InvariantLii;
+  if( name == "LijLji" ) return InvariantLijLji;
+  if( name == "LijLjkLki" ) return InvariantLijLjkLki;
+
+  itkExceptionMacro( << "ERROR: the invariant \"" << name << "\" is not implemented" );
+  return InvariantLiLi;
+
+} // end GetInvariantId()
 
 
 //
 //
 //
-template <typename TInputImage, typename TOutputImage>
+template <typename TInputImage, typename TOutputImage, typename TInternalRealType>
 void
-GaussianInvariantsImageFilter<TInputImage,TOutputImage>
+GaussianInvariantsImageFilter<TInputImage,TOutputImage,TInternalRealType>
 ::GenerateInputRequestedRegion() throw(InvalidRequestedRegionError)
 {
   // call the superclass' implementation of this method. this should
@@ -156,7 +204,7 @@ GaussianInvariantsImageFilter<TInputImage,TOutputImage>
   Superclass::GenerateInputRequestedRegion();
 
   // This filter needs all of the input
-  typename GaussianInvariantsImageFilter<TInputImage,TOutputImage>
+  typename GaussianInvariantsImageFilter<TInputImage,TOutputImage,TInternalRealType>
     ::InputImagePointer image = const_cast<InputImageType *>( this->GetInput() );
   if( image )
     {
@@ -168,9 +216,9 @@ GaussianInvariantsImageFilter<TInputImage,TOutputImage>
 //
 //
 //
-template <typename TInputImage, typename TOutputImage>
+template <typename TInputImage, typename TOutputImage, typename TInternalRealType>
 void
-GaussianInvariantsImageFilter<TInputImage,TOutputImage>
+GaussianInvariantsImageFilter<TInputImage,TOutputImage,TInternalRealType>
 ::EnlargeOutputRequestedRegion(DataObject *output)
 {
   TOutputImage *out = dynamic_cast<TOutputImage*>(output);
@@ -184,9 +232,9 @@ GaussianInvariantsImageFilter<TInputImage,TOutputImage>
 /**
  * Compute filter for Gaussian kernel
  */
-template <typename TInputImage, typename TOutputImage >
+template <typename TInputImage, typename TOutputImage, typename TInternalRealType>
 void
-GaussianInvariantsImageFilter<TInputImage,TOutputImage >
+GaussianInvariantsImageFilter<TInputImage,TOutputImage,TInternalRealType>
 ::GenerateData( void )
 {
   /** Typedefs. */
@@ -201,124 +249,167 @@ GaussianInvariantsImageFilter<TInputImage,TOutputImage >
   InputImageConstPointer input( this->GetInput() );
   //if( input )
 
-  /** Allocate output image. */
-  OutputImagePointer output = this->GetOutput();
-  output->SetRegions( input->GetRequestedRegion() );
-  output->Allocate();
+  /** Check the invariants, and which derivatives they need. */
+  const unsigned int numberOfInvariants = this->m_Invariants.size();
+  if( numberOfInvariants == 0 )
+  {
+    itkExceptionMacro( << "ERROR: no invariant is set" );
+  }
+  std::vector<InvariantIdType> invariantIds( numberOfInvariants );
+  bool needGradient = false;
+  bool needHessian = false;
+  for( unsigned int k = 0; k < numberOfInvariants; k++ )
+  {
+    invariantIds[ k ] = this->GetInvariantId( this->m_Invariants[ k ] );
+    needGradient |= invariantIds[ k ] <= InvariantLiLijLjkLk;
+    needHessian |= invariantIds[ k ] != InvariantLiLi;
+  }
+
+  /** Allocate the output images. */
+  std::vector< OutputIteratorType > outIt( numberOfInvariants );
+  for( unsigned int k = 0; k < numberOfInvariants; k++ )
+  {
+    OutputImagePointer output = this->GetOutput( k );
+    output->SetRegions( input->GetRequestedRegion() );
+    output->Allocate();
+    outIt[ k ] = OutputIteratorType( output, output->GetLargestPossibleRegion() );
+    outIt[ k ].GoToBegin();
+  }
 
   /** Create a process accumulator for tracking the progress of this minipipeline. */
   ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
   progress->SetMiniPipelineFilter( this );
 
   /** Register the filters. */
-  for( unsigned int i = 0; i < ImageDimension; i++ )
+  const float numberOfFilters
+    = ( needGradient ? ImageDimension : 0.0 ) + ( needHessian ? 1.0 : 0.0 );
+  if( needGradient )
   {
-    progress->RegisterInternalFilter(
-      this->m_DerivativeFilters[ i ], 1.0 / ( ImageDimension + 1.0 ) );
+    for( unsigned int i = 0; i < ImageDimension; i++ )
+    {
+      progress->RegisterInternalFilter(
+        this->m_DerivativeFilters[ i ], 1.0 / numberOfFilters );
+    }
   }
-  progress->RegisterInternalFilter(
-    this->m_HessianFilter, 1.0 / ( ImageDimension + 1.0 ) );
-
-  /** Compute derivatives and Hessian. */
-  for( unsigned int i = 0; i < ImageDimension; i++ )
+  if( needHessian )
   {
-    this->m_DerivativeFilters[ i ]->SetInput( input );
-    this->m_DerivativeFilters[ i ]->Update();
+    progress->RegisterInternalFilter(
+      this->m_HessianFilter, 1.0 / numberOfFilters );
   }
-  this->m_HessianFilter->SetInput( input );
-  this->m_HessianFilter->Update();
 
-  /** Setup iterators. */
+  /** Compute the derivatives and the Hessian, once. */
   std::vector< DerivativeIteratorType > derIt( ImageDimension );
-  for( unsigned int i = 0; i < ImageDimension; i++ )
+  if( needGradient )
+  {
+    for( unsigned int i = 0; i < ImageDimension; i++ )
+    {
+      this->m_DerivativeFilters[ i ]->SetInput( input );
+      this->m_DerivativeFilters[ i ]->Update();
+      derIt[ i ] = DerivativeIteratorType(
+        this->m_DerivativeFilters[ i ]->GetOutput(),
+        this->m_DerivativeFilters[ i ]->GetOutput()->GetLargestPossibleRegion() );
+      derIt[ i ].GoToBegin();
+    }
+  }
+  HessianIteratorType hesIt;
+  if( needHessian )
   {
-    derIt[ i ] = DerivativeIteratorType(
-      this->m_DerivativeFilters[ i ]->GetOutput(),
-      this->m_DerivativeFilters[ i ]->GetOutput()->GetLargestPossibleRegion() );
-    derIt[ i ].GoToBegin();
+    this->m_HessianFilter->SetInput( input );
+    this->m_HessianFilter->Update();
+    hesIt = HessianIteratorType(
+      this->m_HessianFilter->GetOutput(),
+      this->m_HessianFilter->GetOutput()->GetLargestPossibleRegion() );
+    hesIt.GoToBegin();
   }
-  HessianIteratorType hesIt(
-    this->m_HessianFilter->GetOutput(),
-    this->m_HessianFilter->GetOutput()->GetLargestPossibleRegion() );
-  hesIt.GoToBegin();
-  OutputIteratorType outIt( output, output->GetLargestPossibleRegion() );
-  outIt.GoToBegin();
 
   /** Initialize temporary variables. */
   vnl_vector< ScalarRealType > gradient( ImageDimension, 0.0 );
   vnl_matrix< ScalarRealType > H( ImageDimension, ImageDimension, 0.0 );
 
-  /** Loop over the output image. */
-  while ( !outIt.IsAtEnd() )
+  /** Loop over the output images. */
+  while ( !outIt[ 0 ].IsAtEnd() )
   {
     /** Construct gradient. */
-    for( unsigned int i = 0; i < ImageDimension; i++ )
+    if( needGradient )
     {
-      gradient[ i ] = derIt[ i ].Value();
-      ++derIt[ i ];
+      for( unsigned int i = 0; i < ImageDimension; i++ )
+      {
+        gradient[ i ] = derIt[ i ].Value();
+        ++derIt[ i ];
+      }
     }
 
     /** Construct Hessian. */
-    HessianPixelType hes = hesIt.Value();
-    for( unsigned int row = 0; row < ImageDimension; row++ )
+    if( needHessian )
     {
-      for( unsigned int col = 0; col < ImageDimension; col++ )
+      const HessianPixelType & hes = hesIt.Value();
+      for( unsigned int row = 0; row < ImageDimension; row++ )
       {
-        H[ row ][ col ] = hes( row, col );
+        for( unsigned int col = 0; col < ImageDimension; col++ )
+        {
+          H[ row ][ col ] = hes( row, col );
+        }
       }
+      ++hesIt;
     }
 
-    /** Compute the invariant. */
-    ScalarRealType outValue = 0.0;
-    if( this->m_Invariant == "LiLi" )
-    {
-      /** LiLi = gradient magnitude */
-      outValue = gradient.magnitude();
-    }
-    else if( this->m_Invariant == "LiLijLj" )
-    {
-      /** LiLijLj = g^T H g */
-      outValue = dot_product( gradient * H, gradient );
-    }
-    else if( this->m_Invariant == "LiLijLjkLk" )
-    {
-      /** LiLijLjkLk = g^T H H g */
-      outValue = dot_product( gradient * ( H * H ), gradient );
-    }
-    else if( this->m_Invariant == "Lii" )
-    {
-      /** Lii = trace( H ) = Laplacian */
-      outValue = vnl_trace( H );
-    }
-    else if( this->m_Invariant == "LijLji" )
-    {
-      /** LijLji = trace( H H ) */
-      outValue = vnl_trace( H * H );
-    }
-    else if( this->m_Invariant == "LijLjkLki" )
+    /** Compute the invariants. */
+    for( unsigned int k = 0; k < numberOfInvariants; k++ )
     {
-      /** LijLjkLki = trace( H H H ) */
-      outValue = vnl_trace( H * H * H );
+      ScalarRealType outValue = 0.0;
+      switch( invariantIds[ k ] )
+      {
+      case InvariantLiLi:
+        /** LiLi = gradient magnitude */
+        outValue = gradient.magnitude();
+        break;
+      case InvariantLiLijLj:
+        /** LiLijLj = g^T H g */
+        outValue = dot_product( gradient * H, gradient );
+        break;
+      case InvariantLiLijLjkLk:
+        /** LiLijLjkLk = g^T H H g */
+        outValue = dot_product( gradient * ( H * H ), gradient );
+        break;
+      case InvariantLii:
+        /** Lii = trace( H ) = Laplacian */
+        outValue = vnl_trace( H );
+        break;
+      case InvariantLijLji:
+        /** LijLji = trace( H H ) */
+        outValue = vnl_trace( H * H );
+        break;
+      case InvariantLijLjkLki:
+        /** LijLjkLki = trace( H H H ) */
+        outValue = vnl_trace( H * H * H );
+        break;
+      }
+
+      /** Set the output value. */
+      outIt[ k ].Set( static_cast< OutputPixelType >( outValue ) );
+      ++outIt[ k ];
     }
-    else
+  }
+
+  /** Release the derivatives, no invariant needs them anymore. */
+  if( needGradient )
+  {
+    for( unsigned int i = 0; i < ImageDimension; i++ )
     {
-      itkExceptionMacro( << "ERROR: the invariant \"" << this->m_Invariant << "\" is not implemented" );
+      this->m_DerivativeFilters[ i ]->GetOutput()->ReleaseData();
     }
-
-    /** Set the output value. */
-    outIt.Set( static_cast< OutputPixelType >( outValue ) );
-
-    /** Update iterator. */
-    ++hesIt;
-    ++outIt;
+  }
+  if( needHessian )
+  {
+    this->m_HessianFilter->GetOutput()->ReleaseData();
   }
 
 } // end GenerateData()
 
 
-template <typename TInputImage, typename TOutputImage>
+template <typename TInputImage, typename TOutputImage, typename TInternalRealType>
 void
-GaussianInvariantsImageFilter<TInputImage,TOutputImage>
+GaussianInvariantsImageFilter<TInputImage,TOutputImage,TInternalRealType>
 ::PrintSelf(std::ostream& os, Indent indent) const
 {
   Superclass::PrintSelf(os,indent);
@@ -34,7 +34,7 @@
 #ifndef __itkHessianRecursiveGaussianImageFilter2_h_
 #define __itkHessianRecursiveGaussianImageFilter2_h_
 
-#include "itkRecursiveGaussianImageFilter.h"
+#include "itkMultiLineRecursiveGaussianImageFilter.h"
 #include "itkNthElementImageAdaptor.h"
 #include "itkImage.h"
 #include "itkSymmetricSecondRankTensor.h"
@@ -109,14 +109,14 @@ public:
   typedef typename OutputImageAdaptorType::Pointer    OutputImageAdaptorPointer;
 
   /**  Smoothing filter type */
-  typedef RecursiveGaussianImageFilter<
+  typedef MultiLineRecursiveGaussianImageFilter<
     RealImageType, RealImageType >                    GaussianFilterType;
 
   /**  Derivative filter type, it will be the first in the pipeline  */
-  typedef RecursiveGaussianImageFilter<
+  typedef MultiLineRecursiveGaussianImageFilter<
     InputImageType, RealImageType >                   DerivativeFilterAType;
   typedef typename DerivativeFilterAType::Pointer     DerivativeFilterAPointer;
-  typedef RecursiveGaussianImageFilter<
+  typedef MultiLineRecursiveGaussianImageFilter<
     RealImageType, RealImageType >                    DerivativeFilterBType;
   typedef typename DerivativeFilterBType::Pointer     DerivativeFilterBPointer;
 
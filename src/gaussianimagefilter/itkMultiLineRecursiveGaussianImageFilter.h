@@ -0,0 +1,97 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkMultiLineRecursiveGaussianImageFilter_h_
+#define __itkMultiLineRecursiveGaussianImageFilter_h_
+
+#include "itkRecursiveGaussianImageFilter.h"
+
+namespace itk
+{
+
+/** \class MultiLineRecursiveGaussianImageFilter
+ * \brief A RecursiveGaussianImageFilter that filters several lines at once.
+ *
+ * The recursion of the IIR filter runs along a line, so a single line
+ * cannot be vectorized. This filter gathers NumberOfLanes neighboring
+ * lines in an interleaved buffer, sample i of lane l at i * NumberOfLanes + l,
+ * and runs the causal and anti-causal recursions on all lanes at once.
+ * The inner loops over the lanes have no dependencies and are contiguous
+ * in memory, so that the compiler vectorizes them for float and double.
+ * Consecutive lines of the iterator are neighbors in the first other
+ * dimension, so for the directions other than x the gather reads
+ * contiguous memory as well.
+ *
+ * The coefficients are those of RecursiveGaussianImageFilter, and so are
+ * the boundary conditions and the order of the arithmetic, so the result
+ * is the same as that of the superclass.
+ *
+ * \sa RecursiveGaussianImageFilter
+ * \ingroup ImageFeatureExtraction
+ */
+
+template< typename TInputImage, typename TOutputImage = TInputImage >
+class ITK_EXPORT MultiLineRecursiveGaussianImageFilter :
+  public RecursiveGaussianImageFilter< TInputImage, TOutputImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef MultiLineRecursiveGaussianImageFilter                     Self;
+  typedef RecursiveGaussianImageFilter< TInputImage, TOutputImage > Superclass;
+  typedef SmartPointer<Self>                                        Pointer;
+  typedef SmartPointer<const Self>                                  ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( MultiLineRecursiveGaussianImageFilter, RecursiveGaussianImageFilter );
+
+  /** Typedefs. */
+  typedef typename Superclass::RealType               RealType;
+  typedef typename Superclass::ScalarRealType         ScalarRealType;
+  typedef typename Superclass::OutputImageRegionType  OutputImageRegionType;
+  typedef typename TOutputImage::PixelType            OutputPixelType;
+
+  /** The number of lines that are filtered at once. */
+  itkStaticConstMacro( NumberOfLanes, unsigned int, 8 );
+
+protected:
+  MultiLineRecursiveGaussianImageFilter() {};
+  virtual ~MultiLineRecursiveGaussianImageFilter() {};
+
+  /** Filter the lines of the region in batches of NumberOfLanes. */
+  void ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+    ThreadIdType threadId );
+
+  /** Apply the recursions to the interleaved lines of length ln. */
+  void FilterDataArrays( RealType * outs, const RealType * data,
+    RealType * scratch, const SizeValueType ln ) const;
+
+private:
+  MultiLineRecursiveGaussianImageFilter( const Self & ); // purposely not implemented
+  void operator=( const Self & );                        // purposely not implemented
+
+}; // end class MultiLineRecursiveGaussianImageFilter
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkMultiLineRecursiveGaussianImageFilter.txx"
+#endif
+
+#endif // end #ifndef __itkMultiLineRecursiveGaussianImageFilter_h_
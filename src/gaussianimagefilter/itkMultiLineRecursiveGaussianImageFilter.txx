@@ -0,0 +1,213 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkMultiLineRecursiveGaussianImageFilter_txx_
+#define __itkMultiLineRecursiveGaussianImageFilter_txx_
+
+#include "itkMultiLineRecursiveGaussianImageFilter.h"
+#include "itkImageLinearConstIteratorWithIndex.h"
+#include "itkImageLinearIteratorWithIndex.h"
+#include "itkProgressReporter.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/**
+ * ******************* ThreadedGenerateData *******************
+ */
+
+template< typename TInputImage, typename TOutputImage >
+void
+MultiLineRecursiveGaussianImageFilter< TInputImage, TOutputImage >
+::ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+  ThreadIdType threadId )
+{
+  typedef ImageLinearConstIteratorWithIndex< TInputImage >  InputIteratorType;
+  typedef ImageLinearIteratorWithIndex< TOutputImage >      OutputIteratorType;
+
+  const unsigned int lanes = NumberOfLanes;
+  const unsigned int direction = this->GetDirection();
+  const SizeValueType ln = outputRegionForThread.GetSize()[ direction ];
+  if ( ln < 4 )
+  {
+    itkExceptionMacro( << "The number of pixels along direction " << direction
+      << " is less than 4. This filter requires a minimum of four pixels "
+      << "along the dimension to be processed." );
+  }
+
+  InputIteratorType inputIt( this->GetInput(), outputRegionForThread );
+  OutputIteratorType outputIt( this->GetOutput(), outputRegionForThread );
+  inputIt.SetDirection( direction );
+  outputIt.SetDirection( direction );
+
+  // The interleaved buffers. The lanes of an incomplete last batch keep
+  // the data of the batch before, which is filtered but not stored.
+  std::vector<RealType> inps( ln * lanes, NumericTraits<RealType>::Zero );
+  std::vector<RealType> outs( ln * lanes, NumericTraits<RealType>::Zero );
+  std::vector<RealType> scratch( ln * lanes, NumericTraits<RealType>::Zero );
+
+  const SizeValueType numberOfLines = outputRegionForThread.GetNumberOfPixels() / ln;
+  ProgressReporter progress( this, threadId, numberOfLines, 10 );
+
+  inputIt.GoToBegin();
+  outputIt.GoToBegin();
+  while ( !inputIt.IsAtEnd() )
+  {
+    // Gather the next batch of lines.
+    unsigned int numberOfLanes = 0;
+    for ( ; numberOfLanes < lanes && !inputIt.IsAtEnd(); ++numberOfLanes )
+    {
+      RealType * inp = &inps[ numberOfLanes ];
+      while ( !inputIt.IsAtEndOfLine() )
+      {
+        *inp = static_cast<RealType>( inputIt.Get() );
+        inp += lanes;
+        ++inputIt;
+      }
+      inputIt.NextLine();
+    }
+
+    this->FilterDataArrays( &outs[ 0 ], &inps[ 0 ], &scratch[ 0 ], ln );
+
+    // Scatter the filtered lines.
+    for ( unsigned int l = 0; l < numberOfLanes; ++l )
+    {
+      const RealType * out = &outs[ l ];
+      while ( !outputIt.IsAtEndOfLine() )
+      {
+        outputIt.Set( static_cast<OutputPixelType>( *out ) );
+        out += lanes;
+        ++outputIt;
+      }
+      outputIt.NextLine();
+      progress.CompletedPixel();
+    }
+  }
+
+} // end ThreadedGenerateData()
+
+
+/**
+ * ******************* FilterDataArrays *******************
+ */
+
+template< typename TInputImage, typename TOutputImage >
+void
+MultiLineRecursiveGaussianImageFilter< TInputImage, TOutputImage >
+::FilterDataArrays( RealType * outs, const RealType * data,
+  RealType * scratch, const SizeValueType ln ) const
+{
+  const unsigned int L = NumberOfLanes;
+
+  // Copy the coefficients, so that the loops do not read them through this.
+  const ScalarRealType n0 = this->m_N0, n1 = this->m_N1, n2 = this->m_N2, n3 = this->m_N3;
+  const ScalarRealType d1 = this->m_D1, d2 = this->m_D2, d3 = this->m_D3, d4 = this->m_D4;
+  const ScalarRealType m1 = this->m_M1, m2 = this->m_M2, m3 = this->m_M3, m4 = this->m_M4;
+  const ScalarRealType bn1 = this->m_BN1, bn2 = this->m_BN2, bn3 = this->m_BN3, bn4 = this->m_BN4;
+  const ScalarRealType bm1 = this->m_BM1, bm2 = this->m_BM2, bm3 = this->m_BM3, bm4 = this->m_BM4;
+
+  /** Causal direction pass, the first value is assumed to extend to infinity. */
+  for ( unsigned int l = 0; l < L; ++l )
+  {
+    const RealType v1 = data[ l ];
+    const RealType * d = data + l;
+    RealType * s = scratch + l;
+    s[ 0 ]     = RealType( v1 * n0 + v1 * n1 + v1 * n2 + v1 * n3 );
+    s[ L ]     = RealType( d[ L ] * n0 + v1 * n1 + v1 * n2 + v1 * n3 );
+    s[ 2 * L ] = RealType( d[ 2 * L ] * n0 + d[ L ] * n1 + v1 * n2 + v1 * n3 );
+    s[ 3 * L ] = RealType( d[ 3 * L ] * n0 + d[ 2 * L ] * n1 + d[ L ] * n2 + v1 * n3 );
+
+    s[ 0 ]     -= RealType( v1 * bn1 + v1 * bn2 + v1 * bn3 + v1 * bn4 );
+    s[ L ]     -= RealType( s[ 0 ] * d1 + v1 * bn2 + v1 * bn3 + v1 * bn4 );
+    s[ 2 * L ] -= RealType( s[ L ] * d1 + s[ 0 ] * d2 + v1 * bn3 + v1 * bn4 );
+    s[ 3 * L ] -= RealType( s[ 2 * L ] * d1 + s[ L ] * d2 + s[ 0 ] * d3 + v1 * bn4 );
+  }
+
+  for ( SizeValueType i = 4; i < ln; ++i )
+  {
+    // The samples i, i-1, .., i-4 of all lanes.
+    const RealType * d0 = data + i * L;
+    const RealType * d1p = d0 - L;
+    const RealType * d2p = d1p - L;
+    const RealType * d3p = d2p - L;
+    RealType * s0 = scratch + i * L;
+    const RealType * s1 = s0 - L;
+    const RealType * s2 = s1 - L;
+    const RealType * s3 = s2 - L;
+    const RealType * s4 = s3 - L;
+    for ( unsigned int l = 0; l < L; ++l )
+    {
+      s0[ l ]  = RealType( d0[ l ] * n0 + d1p[ l ] * n1 + d2p[ l ] * n2 + d3p[ l ] * n3 );
+      s0[ l ] -= RealType( s1[ l ] * d1 + s2[ l ] * d2 + s3[ l ] * d3 + s4[ l ] * d4 );
+    }
+  }
+
+  /** Store the causal result. */
+  for ( SizeValueType i = 0; i < ln * L; ++i )
+  {
+    outs[ i ] = scratch[ i ];
+  }
+
+  /** Anti-causal direction pass, the last value is assumed to extend to infinity. */
+  for ( unsigned int l = 0; l < L; ++l )
+  {
+    const RealType v2 = data[ ( ln - 1 ) * L + l ];
+    const RealType * d = data + ( ln - 4 ) * L + l;
+    RealType * s = scratch + ( ln - 4 ) * L + l;
+    s[ 3 * L ] = RealType( v2 * m1 + v2 * m2 + v2 * m3 + v2 * m4 );
+    s[ 2 * L ] = RealType( d[ 3 * L ] * m1 + v2 * m2 + v2 * m3 + v2 * m4 );
+    s[ L ]     = RealType( d[ 2 * L ] * m1 + d[ 3 * L ] * m2 + v2 * m3 + v2 * m4 );
+    s[ 0 ]     = RealType( d[ L ] * m1 + d[ 2 * L ] * m2 + d[ 3 * L ] * m3 + v2 * m4 );
+
+    s[ 3 * L ] -= RealType( v2 * bm1 + v2 * bm2 + v2 * bm3 + v2 * bm4 );
+    s[ 2 * L ] -= RealType( s[ 3 * L ] * d1 + v2 * bm2 + v2 * bm3 + v2 * bm4 );
+    s[ L ]     -= RealType( s[ 2 * L ] * d1 + s[ 3 * L ] * d2 + v2 * bm3 + v2 * bm4 );
+    s[ 0 ]     -= RealType( s[ L ] * d1 + s[ 2 * L ] * d2 + s[ 3 * L ] * d3 + v2 * bm4 );
+  }
+
+  for ( SizeValueType i = ln - 4; i > 0; --i )
+  {
+    // The samples i, .., i+3 of the input and i-1, .., i+3 of the result.
+    const RealType * d0 = data + i * L;
+    const RealType * d1p = d0 + L;
+    const RealType * d2p = d1p + L;
+    const RealType * d3p = d2p + L;
+    RealType * s0 = scratch + ( i - 1 ) * L;
+    const RealType * s1 = s0 + L;
+    const RealType * s2 = s1 + L;
+    const RealType * s3 = s2 + L;
+    const RealType * s4 = s3 + L;
+    for ( unsigned int l = 0; l < L; ++l )
+    {
+      s0[ l ]  = RealType( d0[ l ] * m1 + d1p[ l ] * m2 + d2p[ l ] * m3 + d3p[ l ] * m4 );
+      s0[ l ] -= RealType( s1[ l ] * d1 + s2[ l ] * d2 + s3[ l ] * d3 + s4[ l ] * d4 );
+    }
+  }
+
+  /** Roll the anti-causal part into the output. */
+  for ( SizeValueType i = 0; i < ln * L; ++i )
+  {
+    outs[ i ] += scratch[ i ];
+  }
+
+} // end FilterDataArrays()
+
+} // end namespace itk
+
+#endif // end #ifndef __itkMultiLineRecursiveGaussianImageFilter_txx_
@@ -34,7 +34,7 @@
 #ifndef __itkSmoothingRecursiveGaussianImageFilter2_h_
 #define __itkSmoothingRecursiveGaussianImageFilter2_h_
 
-#include "itkRecursiveGaussianImageFilter.h"
+#include "itkMultiLineRecursiveGaussianImageFilter.h"
 #include "itkCastImageFilter.h"
 #include "itkImage.h"
 #include "itkPixelTraits.h"
@@ -88,11 +88,11 @@ public:
     itkGetStaticConstMacro(ImageDimension) >      RealImageType;
 
   /**  The first in the pipeline  */
-  typedef RecursiveGaussianImageFilter<
+  typedef MultiLineRecursiveGaussianImageFilter<
     InputImageType, RealImageType >               FirstGaussianFilterType;
 
   /**  Smoothing filter type */
-  typedef RecursiveGaussianImageFilter<
+  typedef MultiLineRecursiveGaussianImageFilter<
     RealImageType, RealImageType >                InternalGaussianFilterType;
 
   /**  The last in the pipeline  */
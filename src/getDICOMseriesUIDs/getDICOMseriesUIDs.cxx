@@ -25,7 +25,7 @@
 #include "ITKToolsHelpers.h"
 #include <iostream>
 #include <itksys/SystemTools.hxx>
-#include "itkGDCMSeriesFileNames.h"
+#include "ITKToolsDICOMSeriesIndex.h"
 
 
 /**
@@ -41,7 +41,11 @@ std::string GetHelpString( void )
   << "  -in      inputDirectoryName" << std::endl
   << "  [-r]     add restrictions to generate a unique seriesUID" << std::endl
   << "           e.g. \"0020|0012\" to add a check for acquisition" << std::endl
-  << "number.";
+  << "number." << std::endl
+  << "  [-index] index file, which stores the headers of the files;" << std::endl
+  << "           a next run only parses new and changed files" << std::endl
+  << "  [-threads] number of threads parsing the headers, default all" << std::endl
+  << "Only the tags needed for the seriesUID are parsed, in parallel.";
 
   return ss.str();
 
@@ -76,6 +80,12 @@ int main( int argc, char **argv )
   std::vector<std::string> restrictions;
   parser->GetCommandLineArgument( "-r", restrictions );
 
+  std::string indexFileName = "";
+  parser->GetCommandLineArgument( "-index", indexFileName );
+
+  unsigned int numberOfThreads = 0;
+  parser->GetCommandLineArgument( "-threads", numberOfThreads );
+
   /** Make sure last character of inputDirectoryName != "/".
    * Otherwise FileIsDirectory() won't work.
    */
@@ -95,18 +105,23 @@ int main( int argc, char **argv )
     return EXIT_FAILURE;
   }
 
-  typedef itk::GDCMSeriesFileNames                GDCMNamesGeneratorType;
-  typedef std::vector< std::string >              FileNamesContainerType;
-
   /** Get the seriesUIDs from the DICOM directory. */
-  GDCMNamesGeneratorType::Pointer nameGenerator = GDCMNamesGeneratorType::New();
-  nameGenerator->SetUseSeriesDetails( true );
+  itktools::DICOMSeriesIndex seriesIndex;
+  seriesIndex.SetDirectory( inputDirectoryName );
   for( unsigned int i = 0; i < restrictions.size(); ++i )
   {
-    nameGenerator->AddSeriesRestriction( restrictions[ i ] );
+    seriesIndex.AddSeriesRestriction( restrictions[ i ] );
+  }
+  seriesIndex.SetIndexFileName( indexFileName );
+  seriesIndex.SetNumberOfThreads( numberOfThreads );
+
+  std::string errorMessage = "";
+  if( !seriesIndex.Update( errorMessage ) )
+  {
+    std::cerr << errorMessage << std::endl;
+    return EXIT_FAILURE;
   }
-  nameGenerator->SetInputDirectory( inputDirectoryName.c_str() );
-  FileNamesContainerType seriesNames = nameGenerator->GetSeriesUIDs();
+  std::vector<std::string> seriesNames = seriesIndex.GetSeriesIdentifiers();
 
   /** Check. */
   if( !seriesNames.size() )
@@ -23,11 +23,18 @@
 
 #include "itkCommandLineArgumentParser.h"
 #include "ITKToolsHelpers.h"
+#include "ITKToolsDICOMSeriesIndex.h"
 
 #include <itksys/SystemTools.hxx>
-#include "itkImageSeriesReader.h"
 #include "itkGDCMImageIO.h"
-#include "itkGDCMSeriesFileNames.h"
+
+#include "gdcmReader.h"
+#include "gdcmStringFilter.h"
+#include "gdcmTag.h"
+#include "gdcmTransferSyntax.h"
+
+#include <cstdlib>
+#include <set>
 
 
 /**
@@ -40,16 +47,204 @@ std::string GetHelpString( void )
   ss << "ITKTools v" << itktools::GetITKToolsVersion() << "\n"
     << "Usage:\n"
     << "pxgetdicominformation\n"
-    << "  -in      inputDirectoryName\n"
+    << "  -in      inputDirectoryName, or one or more DICOM files\n"
     << "  [-s]     seriesUID\n"
     << "  [-r]     add restrictions to generate a unique seriesUID\n"
     << "           e.g. \"0020|0012\" to add a check for acquisition number.\n"
-    << "By default the first series encountered is used.";
+    << "  [-t]     only print these tags, e.g. \"0010|0010\" \"0018|0050\"\n"
+    << "By default the first series encountered is used.\n"
+    << "Only the header is read, which stops before the pixel data, and with\n"
+    << "-t after the last requested tag.";
 
   return ss.str();
 
 } // end GetHelpString()
 
+
+/**
+ * ******************* GetValue *******************
+ *
+ * The value of a tag "gggg|eeee" as a string, without the padding;
+ * empty if the tag is not present.
+ */
+
+std::string GetValue( const gdcm::Reader & reader, const std::string & tagString )
+{
+  gdcm::Tag tag;
+  tag.ReadFromPipeSeparatedString( tagString.c_str() );
+  const gdcm::DataSet & dataSet = reader.GetFile().GetDataSet();
+  const gdcm::FileMetaInformation & header = reader.GetFile().GetHeader();
+  if( !dataSet.FindDataElement( tag ) && !header.FindDataElement( tag ) ) return "";
+
+  gdcm::StringFilter stringFilter;
+  stringFilter.SetFile( reader.GetFile() );
+  std::string value = stringFilter.ToString( tag );
+  const std::string::size_type end = value.find_last_not_of( std::string( " \0", 2 ) );
+  value.erase( end == std::string::npos ? 0 : end + 1 );
+
+  return value;
+
+} // end GetValue()
+
+
+/**
+ * ******************* GetValueFromList *******************
+ *
+ * Value number i of a backslash separated value, or defaultValue.
+ */
+
+double GetValueFromList( const std::string & value, unsigned int i, double defaultValue )
+{
+  std::istringstream stream( value );
+  std::string item;
+  for( unsigned int j = 0; std::getline( stream, item, '\\' ); ++j )
+  {
+    if( j == i ) return atof( item.c_str() );
+  }
+
+  return defaultValue;
+
+} // end GetValueFromList()
+
+
+/**
+ * ******************* PrintInformation *******************
+ */
+
+void PrintInformation( const gdcm::Reader & reader, unsigned int numberOfSlices )
+{
+  /** The stored component type, as GDCMImageIO reports it without rescaling. */
+  const int bitsAllocated = atoi( GetValue( reader, "0028|0100" ).c_str() );
+  const bool isSigned = GetValue( reader, "0028|0103" ) == "1";
+  itk::ImageIOBase::IOComponentType componentType = itk::ImageIOBase::UNKNOWNCOMPONENTTYPE;
+  if( bitsAllocated == 8 ) componentType = isSigned ? itk::ImageIOBase::CHAR : itk::ImageIOBase::UCHAR;
+  if( bitsAllocated == 16 ) componentType = isSigned ? itk::ImageIOBase::SHORT : itk::ImageIOBase::USHORT;
+  if( bitsAllocated == 32 ) componentType = isSigned ? itk::ImageIOBase::INT : itk::ImageIOBase::UINT;
+  std::string samplesPerPixel = GetValue( reader, "0028|0002" );
+  if( samplesPerPixel == "" ) samplesPerPixel = "1";
+  const itk::ImageIOBase::IOPixelType pixelType = samplesPerPixel == "3"
+    ? itk::ImageIOBase::RGB : itk::ImageIOBase::SCALAR;
+
+  /** A multi-frame file holds all slices. */
+  const unsigned int numberOfFrames = atoi( GetValue( reader, "0028|0008" ).c_str() );
+  if( numberOfFrames > 1 ) numberOfSlices = numberOfFrames;
+
+  /** Get general image information. The pixel spacing is stored as the
+   * row spacing, along y, followed by the column spacing, along x.
+   */
+  const std::string pixelSpacing = GetValue( reader, "0028|0030" );
+  std::string sliceSpacing = GetValue( reader, "0018|0088" );
+  if( sliceSpacing == "" ) sliceSpacing = GetValue( reader, "0018|0050" );
+  const std::string imagePosition = GetValue( reader, "0020|0032" );
+  std::string rescaleIntercept = GetValue( reader, "0028|1052" );
+  if( rescaleIntercept == "" ) rescaleIntercept = "0";
+  std::string rescaleSlope = GetValue( reader, "0028|1053" );
+  if( rescaleSlope == "" ) rescaleSlope = "1";
+  const gdcm::TransferSyntax transferSyntax
+    = gdcm::TransferSyntax::GetTSType( GetValue( reader, "0002|0010" ).c_str() );
+
+  /** Print the general image information. */
+  std::cout << "General image information:\n";
+  std::cout << "dimension:        " << ( numberOfSlices > 1 ? 3 : 2 ) << std::endl;
+  std::cout << "# components:     " << samplesPerPixel << std::endl;
+  std::cout << "pixel type:       "
+    << itk::ImageIOBase::GetPixelTypeAsString( pixelType )
+    << ", "
+    << itk::ImageIOBase::GetComponentTypeAsString( componentType )
+    << std::endl;
+  std::cout << "size:             " << GetValue( reader, "0028|0011" ) << " "
+    << GetValue( reader, "0028|0010" ) << " " << numberOfSlices << std::endl;
+  std::cout << "spacing:          " << GetValueFromList( pixelSpacing, 1, 1.0 ) << " "
+    << GetValueFromList( pixelSpacing, 0, 1.0 ) << " "
+    << GetValueFromList( sliceSpacing, 0, 1.0 ) << std::endl;
+  std::cout << "origin:           " << GetValueFromList( imagePosition, 0, 0.0 ) << " "
+    << GetValueFromList( imagePosition, 1, 0.0 ) << " "
+    << GetValueFromList( imagePosition, 2, 0.0 ) << std::endl;
+  std::cout << "image orientation:" << GetValue( reader, "0020|0037" ) << std::endl;
+  std::cout << "rescale intercept:" << rescaleIntercept << std::endl;
+  std::cout << "rescale slope:    " << rescaleSlope << std::endl;
+  std::cout << "use compression:  " << transferSyntax.IsEncapsulated() << std::endl;
+
+  /** Print patient information. */
+  std::cout << "\nPatient information:\n";
+  std::cout << "patient name:     " << GetValue( reader, "0010|0010" ) << std::endl;
+  std::cout << "age:              " << GetValue( reader, "0010|1010" ) << std::endl;
+  std::cout << "sex:              " << GetValue( reader, "0010|0040" ) << std::endl;
+  std::cout << "DOB:              " << GetValue( reader, "0010|0030" ) << std::endl;
+  std::cout << "ID:               " << GetValue( reader, "0010|0020" ) << std::endl;
+  std::cout << "body part:        " << GetValue( reader, "0018|0015" ) << std::endl;
+  std::cout << "position:         " << GetValue( reader, "0018|5100" ) << std::endl;
+
+  /** Print study information. */
+  itk::GDCMImageIO::Pointer gdcmIO = itk::GDCMImageIO::New();
+  std::cout << "\nStudy information:\n";
+  std::cout << "study UID:        " << GetValue( reader, "0020|000d" ) << std::endl;
+  std::cout << "UID prefix:       " << gdcmIO->GetUIDPrefix() << std::endl;
+  std::cout << "study date:       " << GetValue( reader, "0008|0020" ) << std::endl;
+  std::cout << "study time:       " << GetValue( reader, "0008|0030" ) << std::endl;
+  std::cout << "description:      " << GetValue( reader, "0008|1030" ) << std::endl;
+  std::cout << "ID:               " << GetValue( reader, "0020|0010" ) << std::endl;
+  std::cout << "protocol name:    " << GetValue( reader, "0018|1030" ) << std::endl;
+
+  /** Print series information. */
+  std::cout << "\nSeries information:\n";
+  std::cout << "series UID:       " << GetValue( reader, "0020|000e" ) << std::endl;
+  std::cout << "# series:         " << GetValue( reader, "0020|1000" ) << std::endl;
+  std::cout << "# related series: " << GetValue( reader, "0020|1206" ) << std::endl;
+  std::cout << "series date:      " << GetValue( reader, "0008|0021" ) << std::endl;
+  std::cout << "series time:      " << GetValue( reader, "0008|0031" ) << std::endl;
+
+  /** Print scanner information. */
+  std::cout << "\nScanner information:\n";
+  std::cout << "institution:      " << GetValue( reader, "0008|0080" ) << std::endl;
+  std::cout << "modality:         " << GetValue( reader, "0008|0060" ) << std::endl;
+  std::cout << "manufacturer:     " << GetValue( reader, "0008|0070" ) << std::endl;
+  std::cout << "model:            " << GetValue( reader, "0008|1090" ) << std::endl;
+  std::cout << "scan options:     " << GetValue( reader, "0018|0022" ) << std::endl;
+  std::cout << "conv. kernel:     " << GetValue( reader, "0018|1210" ) << std::endl;
+
+  /** Print acquisition information. */
+  std::cout << "\nAcquisition information:\n";
+  std::cout << "acquisition date: " << GetValue( reader, "0008|0022" ) << std::endl;
+  std::cout << "acquisition time: " << GetValue( reader, "0008|0032" ) << std::endl;
+  std::cout << "KVP:              " << GetValue( reader, "0018|0060" ) << std::endl;
+  std::cout << "exposure time:    " << GetValue( reader, "0018|1150" ) << std::endl;
+  std::cout << "XRayTubeCurrent:  " << GetValue( reader, "0018|1151" ) << std::endl;
+  std::cout << "exposure:         " << GetValue( reader, "0018|1152" ) << std::endl;
+
+} // end PrintInformation()
+
+
+/**
+ * ******************* ReadHeader *******************
+ *
+ * Read the header of a file, up to the pixel data, or if tags are given
+ * only up to the last of them.
+ */
+
+bool ReadHeader( const std::string & fileName,
+  const std::vector<std::string> & tags, gdcm::Reader & reader )
+{
+  reader.SetFileName( fileName.c_str() );
+  if( tags.empty() )
+  {
+    std::set<gdcm::Tag> skipTags;
+    return reader.ReadUpToTag( gdcm::Tag( 0x7fe0, 0x0010 ), skipTags );
+  }
+
+  std::set<gdcm::Tag> selectedTags;
+  for( std::size_t i = 0; i < tags.size(); ++i )
+  {
+    gdcm::Tag tag;
+    tag.ReadFromPipeSeparatedString( tags[ i ].c_str() );
+    selectedTags.insert( tag );
+  }
+  return reader.ReadSelectedTags( selectedTags );
+
+} // end ReadHeader()
+
+//-------------------------------------------------------------------------------------
+
 int main( int argc, char **argv )
 {
   /** Create a command line argument parser. */
@@ -71,8 +266,8 @@ int main( int argc, char **argv )
   }
 
   /** Get arguments. */
-  std::string inputDirectoryName = "";
-  parser->GetCommandLineArgument( "-in", inputDirectoryName );
+  std::vector<std::string> inputNames;
+  parser->GetCommandLineArgument( "-in", inputNames );
 
   std::string seriesNumber = "";
   parser->GetCommandLineArgument( "-s", seriesNumber );
@@ -80,230 +275,82 @@ int main( int argc, char **argv )
   std::vector<std::string> restrictions;
   parser->GetCommandLineArgument( "-r", restrictions );
 
-  /** Make sure last character of inputDirectoryName != "/".
-   * Otherwise FileIsDirectory() won't work.
-   */
-  if( inputDirectoryName.rfind( "/" ) == inputDirectoryName.size() - 1 )
-  {
-    inputDirectoryName.erase( inputDirectoryName.size() - 1, 1 );
-  }
-
-  /** Check if inputDirectoryName is a directory. */
-  bool exists = itksys::SystemTools::FileExists( inputDirectoryName.c_str() );
-  bool isDir = itksys::SystemTools::FileIsDirectory( inputDirectoryName.c_str() );
-  isDir &= exists;
-  if( !isDir )
-  {
-    std::cerr << "ERROR: " << inputDirectoryName
-      << " does not exist or is no directory." << std::endl;
-    return EXIT_FAILURE;
-  }
-
-  /** Some typedefs. */
-  typedef itk::Image< short, 3>               ImageType;
-  typedef itk::ImageSeriesReader< ImageType > SeriesReaderType;
-  typedef itk::GDCMImageIO                    GDCMImageIOType;
-  typedef itk::GDCMSeriesFileNames            GDCMNamesGeneratorType;
-  typedef std::vector< std::string >          FileNamesContainerType;
+  std::vector<std::string> tags;
+  parser->GetCommandLineArgument( "-t", tags );
 
-  /** Get the seriesUIDs from the DICOM directory.
-   * With SetUseSeriesDetails( true ) series UIDs are generated that
-   * are unique and therefore extra long.
+  /** A directory: take the first file of the series, which is found by
+   * parsing only the tags of the series identifiers.
    */
-  GDCMNamesGeneratorType::Pointer nameGenerator = GDCMNamesGeneratorType::New();
-  nameGenerator->SetUseSeriesDetails( true );
-  for( unsigned int i = 0; i < restrictions.size(); ++i )
+  std::vector<std::string> fileNames;
+  unsigned int numberOfSlices = 1;
+  std::string inputDirectoryName = inputNames.empty() ? "" : inputNames[ 0 ];
+  if( inputDirectoryName.size() > 1
+    && inputDirectoryName.rfind( "/" ) == inputDirectoryName.size() - 1 )
   {
-    nameGenerator->AddSeriesRestriction( restrictions[ i ] );
+    inputDirectoryName.erase( inputDirectoryName.size() - 1, 1 );
   }
-  nameGenerator->SetInputDirectory( inputDirectoryName.c_str() );
-
-  /** Generate the file names corresponding to the series. */
-  FileNamesContainerType fileNames;
-  if( seriesNumber == "" )
+  if( inputNames.size() == 1
+    && itksys::SystemTools::FileIsDirectory( inputDirectoryName.c_str() ) )
   {
-    fileNames = nameGenerator->GetInputFileNames();
+    itktools::DICOMSeriesIndex seriesIndex;
+    seriesIndex.SetDirectory( inputDirectoryName );
+    for( unsigned int i = 0; i < restrictions.size(); ++i )
+    {
+      seriesIndex.AddSeriesRestriction( restrictions[ i ] );
+    }
+    std::string errorMessage = "";
+    if( !seriesIndex.Update( errorMessage ) )
+    {
+      std::cerr << errorMessage << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    const std::vector<std::string> seriesFileNames = seriesIndex.GetFileNames( seriesNumber );
+    if( !seriesFileNames.size() )
+    {
+      std::cerr << "ERROR: no DICOM series in directory "
+        << inputDirectoryName << "." << std::endl;
+      return EXIT_FAILURE;
+    }
+    fileNames.push_back( seriesFileNames[ 0 ] );
+    numberOfSlices = seriesFileNames.size();
   }
   else
   {
-    fileNames = nameGenerator->GetFileNames( seriesNumber );
-  }
-
-  /** Check if there is at least one dicom file in the directory. */
-  if( !fileNames.size() )
-  {
-    std::cerr << "ERROR: no DICOM series in directory "
-      << inputDirectoryName << "." << std::endl;
-    return EXIT_FAILURE;
+    fileNames = inputNames;
   }
 
-  /** Create a test reader. */
-  SeriesReaderType::Pointer testReader = SeriesReaderType::New();
-  GDCMImageIOType::Pointer gdcmIO = GDCMImageIOType::New();
-  testReader->SetImageIO( gdcmIO );
-  testReader->SetFileNames( fileNames );
-
-  /** Try reading image information. */
-  try
-  {
-    testReader->GenerateOutputInformation();
-  }
-  catch( itk::ExceptionObject & excp )
+  /** Print the information of every file. */
+  int returnValue = EXIT_SUCCESS;
+  for( std::size_t i = 0; i < fileNames.size(); ++i )
   {
-    std::cerr << "ExceptionObject caught !"  << std::endl;
-    std::cerr << excp <<  std::endl;
-    return EXIT_FAILURE;
+    gdcm::Reader reader;
+    if( !ReadHeader( fileNames[ i ], tags, reader ) )
+    {
+      std::cerr << "ERROR: could not read the DICOM header of "
+        << fileNames[ i ] << "." << std::endl;
+      returnValue = EXIT_FAILURE;
+      continue;
+    }
+
+    if( fileNames.size() > 1 )
+    {
+      std::cout << ( i > 0 ? "\n" : "" ) << "File: " << fileNames[ i ] << "\n";
+    }
+    if( tags.empty() )
+    {
+      PrintInformation( reader, numberOfSlices );
+    }
+    else
+    {
+      for( std::size_t j = 0; j < tags.size(); ++j )
+      {
+        std::cout << tags[ j ] << " " << GetValue( reader, tags[ j ] ) << std::endl;
+      }
+    }
   }
 
-  /** Get general image information from the dicomIO. */
-  unsigned int sizeX = gdcmIO->GetDimensions( 0 );
-  unsigned int sizeY = gdcmIO->GetDimensions( 1 );
-  unsigned int sizeZ = fileNames.size();//gdcmIO->GetDimensions( 2 );
-  double spacingX = gdcmIO->GetSpacing( 0 );
-  double spacingY = gdcmIO->GetSpacing( 1 );
-  double spacingZ = gdcmIO->GetSpacing( 2 );
-  double originX = gdcmIO->GetOrigin( 0 );
-  double originY = gdcmIO->GetOrigin( 1 );
-  double originZ = gdcmIO->GetOrigin( 2 );
-  std::string orientation = "";
-  gdcmIO->GetValueFromTag( "0020|0037", orientation );
-
-  /** Print the general image information. */
-  std::cout << "General image information:\n";
-  std::cout << "dimension:        " << gdcmIO->GetNumberOfDimensions() << std::endl;
-  std::cout << "# components:     " << gdcmIO->GetNumberOfComponents() << std::endl;
-  std::cout << "pixel type:       "
-    << gdcmIO->GetPixelTypeAsString( gdcmIO->GetPixelType() )
-    << ", "
-    << gdcmIO->GetComponentTypeAsString( gdcmIO->GetComponentType() )
-    << std::endl;
-  std::cout << "size:             " << sizeX << " " << sizeY << " " << sizeZ << std::endl;
-  std::cout << "spacing:          " << spacingX << " " << spacingY << " " << spacingZ << std::endl;
-  std::cout << "origin:           " << originX << " " << originY << " " << originZ << std::endl;
-  std::cout << "image orientation:" << orientation << std::endl;
-  std::cout << "rescale intercept:" << gdcmIO->GetRescaleIntercept() << std::endl;
-  std::cout << "rescale slope:    " << gdcmIO->GetRescaleSlope() << std::endl;
-  std::cout << "use compression:  " << gdcmIO->GetUseCompression() << std::endl;
-
-  /** Get patient information from the dicomIO. */
-  const unsigned int maxSize = 255;
-  char patientName[maxSize];
-  gdcmIO->GetPatientName( patientName );
-  char patientAge[maxSize];
-  gdcmIO->GetPatientAge( patientAge );
-  char patientSex[maxSize];
-  gdcmIO->GetPatientSex( patientSex );
-  char patientDOB[maxSize];
-  gdcmIO->GetPatientDOB( patientDOB );
-  char patientID[maxSize];
-  gdcmIO->GetPatientID( patientID );
-  char bodypart[maxSize];
-  gdcmIO->GetBodyPart( bodypart );
-  std::string position = "";
-  gdcmIO->GetValueFromTag( "0018|5100", position );
-  std::string viewPosition = "";
-  gdcmIO->GetValueFromTag( "0018|5101", viewPosition );
-
-  /** Print patient information. */
-  std::cout << "\nPatient information:\n";
-  std::cout << "patient name:     " << patientName << std::endl;
-  std::cout << "age:              " << patientAge << std::endl;
-  std::cout << "sex:              " << patientSex << std::endl;
-  std::cout << "DOB:              " << patientDOB << std::endl;
-  std::cout << "ID:               " << patientID << std::endl;
-  std::cout << "body part:        " << bodypart << std::endl;
-  std::cout << "position:         " << position << std::endl;
-
-  /** Get study information from the dicomIO. */
-  char noSeries[maxSize];
-  gdcmIO->GetNumberOfSeriesInStudy( noSeries );
-  char noRelatedSeries[maxSize];
-  gdcmIO->GetNumberOfStudyRelatedSeries( noRelatedSeries );
-  std::string studyDate = "";
-  gdcmIO->GetValueFromTag( "0008|0020", studyDate );
-  std::string studyTime = "";
-  gdcmIO->GetValueFromTag( "0008|0030", studyTime );
-  char studyDesc[maxSize];
-  gdcmIO->GetStudyDescription( studyDesc );
-  char studyID[maxSize];
-  gdcmIO->GetStudyID( studyID );
-  std::string protocolName = "";
-  gdcmIO->GetValueFromTag( "0018|1030", protocolName );
-
-  /** Print study information. */
-  std::cout << "\nStudy information:\n";
-  std::cout << "study UID:        " << gdcmIO->GetStudyInstanceUID() << std::endl;
-  std::cout << "UID prefix:       " << gdcmIO->GetUIDPrefix() << std::endl;
-  std::cout << "study date:       " << studyDate << std::endl;
-  std::cout << "study time:       " << studyTime << std::endl;
-  std::cout << "description:      " << studyDesc << std::endl;
-  std::cout << "ID:               " << studyID << std::endl;
-  std::cout << "protocol name:    " << protocolName << std::endl;
-
-  /** Get series information. */
-  std::string seriesDate = "";
-  gdcmIO->GetValueFromTag( "0008|0021", seriesDate );
-  std::string seriesTime = "";
-  gdcmIO->GetValueFromTag( "0008|0031", seriesTime );
-
-  /** Print series information. */
-  std::cout << "\nSeries information:\n";
-  std::cout << "series UID:       " << gdcmIO->GetSeriesInstanceUID() << std::endl;
-  std::cout << "# series:         " << noSeries << std::endl;
-  std::cout << "# related series: " << noRelatedSeries << std::endl;
-  std::cout << "series date:      " << seriesDate << std::endl;
-  std::cout << "series time:      " << seriesTime << std::endl;
-
-  /** Get scanner information from the dicomIO. */
-  char modality[maxSize];
-  gdcmIO->GetModality( modality );
-  char manufacturer[maxSize];
-  gdcmIO->GetManufacturer( manufacturer );
-  char model[maxSize];
-  gdcmIO->GetModel( model );
-  char scanOptions[maxSize];
-  gdcmIO->GetScanOptions( scanOptions );
-  char institution[maxSize];
-  gdcmIO->GetInstitution( institution );
-  std::string convolutionKernel = "";
-  gdcmIO->GetValueFromTag( "0018|1210", convolutionKernel );
-
-  /** Print scanner information. */
-  std::cout << "\nScanner information:\n";
-  std::cout << "institution:      " << institution << std::endl;
-  std::cout << "modality:         " << modality << std::endl;
-  std::cout << "manufacturer:     " << manufacturer << std::endl;
-  std::cout << "model:            " << model << std::endl;
-  std::cout << "scan options:     " << scanOptions << std::endl;
-  std::cout << "conv. kernel:     " << convolutionKernel << std::endl;
-
-  /** Get acquisition information from the dicomIO. */
-  std::string acquisitionDate = "";
-  gdcmIO->GetValueFromTag( "0008|0022", acquisitionDate );
-  std::string acquisitionTime = "";
-  gdcmIO->GetValueFromTag( "0008|0032", acquisitionTime );
-  std::string kvp = "";
-  gdcmIO->GetValueFromTag( "0018|0060", kvp );
-  std::string exposureTime = "";
-  gdcmIO->GetValueFromTag( "0018|1150", exposureTime );
-  std::string xRayTubeCurrent = "";
-  gdcmIO->GetValueFromTag( "0018|1151", xRayTubeCurrent );
-  std::string exposure = "";
-  gdcmIO->GetValueFromTag( "0018|1152", exposure );
-
-  /** Print acquisition information. */
-  std::cout << "\nAcquisition information:\n";
-  std::cout << "acquisition date: " << acquisitionDate << std::endl;
-  std::cout << "acquisition time: " << acquisitionTime << std::endl;
-  std::cout << "KVP:              " << kvp << std::endl;
-  std::cout << "exposure time:    " << exposureTime << std::endl;
-  std::cout << "XRayTubeCurrent:  " << xRayTubeCurrent << std::endl;
-  std::cout << "exposure:         " << exposure << std::endl;
-
-//  GetLabelFromTag(const std::string &tag, std::string &labelId)
-  //  GetValueFromTag(const std::string &tag, std::string &value)
-
-  /** End  program. Return success. */
-  return EXIT_SUCCESS;
+  /** End  program. */
+  return returnValue;
 
 }  // end main
@@ -25,7 +25,10 @@
 #include "itkUseMevisDicomTiff.h"
 
 #include "itkCommandLineArgumentParser.h"
+#include "ITKToolsBase.h"
+#include "ITKToolsChecksum.h"
 #include "ITKToolsHelpers.h"
+#include "ITKToolsImageProperties.h"
 #include "itkImage.h"
 #include "itkImageIOBase.h"
 #include "itkImageFileReader.h"
@@ -53,16 +56,193 @@ std::string GetHelpString( void )
     << "  [-o]     origin\n"
     << "  [-dc]    direction cosines\n"
     << "  [-all]   all of the above\n"
+    << "  [-checksum] checksum of the pixel data, computed in parallel\n"
+    << "  [-cache] keep the checksum in inputFileName.checksum, and reuse it\n"
+    << "           while the file does not change\n"
     << "Image information about the inputFileName is printed to screen.\n"
     << "Only one option should be given, e.g. -sp, then the spacing is printed.\n"
     << "  [-i]     index, if this option is given only e.g.\n"
-    << "spacing[index] is printed.";
+    << "spacing[index] is printed.\n"
+    << "OR pxgetimageinformation\n"
+    << "  -in      inputFileNames, or @manifest\n"
+    << "  [-format] output format, csv or json, default csv\n"
+    << "  [-checksum] add the checksum of the pixel data\n"
+    << "  [-cache] keep and reuse the checksums, see above\n"
+    << "  [-threads] maximum number of headers read concurrently\n"
+    << "All image information of all inputFileNames is printed as one table,\n"
+    << "one row or object per file. Only the headers are read, in parallel.\n"
+    << "Files whose header cannot be read are reported, and get an empty\n"
+    << "row or an \"error\" field.\n"
+    << "The checksum is taken over the decoded pixels, and is the same for\n"
+    << "the same image in any file format; pximagecompare -checksum uses it.";
 
   return ss.str();
 
 } // end GetHelpString()
 
 
+/**
+ * ******************* EscapeString *******************
+ */
+
+/** Quote a string for csv, or for json. */
+std::string EscapeString( const std::string & value, bool json )
+{
+  std::string escaped = "\"";
+  for( std::size_t i = 0; i < value.size(); ++i )
+  {
+    const char c = value[ i ];
+    if( c == '"' ) escaped += json ? "\\\"" : "\"\"";
+    else if( json && c == '\\' ) escaped += "\\\\";
+    else if( json && c == '\n' ) escaped += "\\n";
+    else escaped += c;
+  }
+  return escaped + "\"";
+
+} // end EscapeString()
+
+
+/**
+ * ******************* PrintValues *******************
+ */
+
+/** Print a list of values, separated by spaces for csv, or as a json array. */
+template< class T >
+void PrintValues( const std::vector<T> & values, bool json )
+{
+  std::cout << ( json ? "[" : "" );
+  for( std::size_t i = 0; i < values.size(); ++i )
+  {
+    if( i > 0 ) std::cout << ( json ? ", " : " " );
+    std::cout << values[ i ];
+  }
+  std::cout << ( json ? "]" : "" );
+
+} // end PrintValues()
+
+
+/**
+ * ******************* PrintImageInformationTable *******************
+ */
+
+/** Print the information of many images, as csv or json. The headers
+ * are read in parallel first, and cached. With checksum, the pixel data
+ * of every image is read as well. Returns false if any header or
+ * checksum could not be read.
+ */
+bool PrintImageInformationTable(
+  const std::vector<std::string> & inputFileNames, bool json,
+  bool checksum, bool useCacheFile )
+{
+  /** Failures are reported by ValidateImageHeaders(), the other files are
+   * still printed. */
+  bool success = itktools::ValidateImageHeaders( inputFileNames );
+
+  std::cout << std::fixed << std::setprecision( 6 );
+  if( json )
+  {
+    std::cout << "[\n";
+  }
+  else
+  {
+    std::cout << "file,dimension,pixeltype,componenttype,components,"
+      << "size,spacing,origin,direction" << ( checksum ? ",checksum" : "" ) << "\n";
+  }
+
+  for( std::size_t f = 0; f < inputFileNames.size(); ++f )
+  {
+    itk::ImageIOBase::Pointer imageIOBase
+      = itktools::GetCachedImageIOBase( inputFileNames[ f ] );
+    const std::string name = EscapeString( inputFileNames[ f ], json );
+
+    if( imageIOBase.IsNull() )
+    {
+      if( json )
+      {
+        std::cout << "  {\"file\": " << name << ", \"error\": "
+          << EscapeString( "could not read the header", true ) << "}";
+      }
+      else
+      {
+        std::cout << name << ",,,,,,,," << ( checksum ? "," : "" );
+      }
+    }
+    else
+    {
+      const unsigned int dim = imageIOBase->GetNumberOfDimensions();
+      std::vector<itk::SizeValueType> size( dim );
+      std::vector<double> spacing( dim ), origin( dim ), direction;
+      for( unsigned int i = 0; i < dim; ++i )
+      {
+        size[ i ] = imageIOBase->GetDimensions( i );
+        spacing[ i ] = imageIOBase->GetSpacing( i );
+        origin[ i ] = imageIOBase->GetOrigin( i );
+        const std::vector<double> dir = imageIOBase->GetDirection( i );
+        direction.insert( direction.end(), dir.begin(), dir.end() );
+      }
+      const std::string pixelType
+        = imageIOBase->GetPixelTypeAsString( imageIOBase->GetPixelType() );
+      const std::string componentType
+        = imageIOBase->GetComponentTypeAsString( imageIOBase->GetComponentType() );
+
+      /** The checksum reads the pixel data; failures leave it empty. */
+      std::string imageChecksum = "";
+      std::string errorMessage = "";
+      if( checksum && !itktools::GetImageChecksum( inputFileNames[ f ],
+        useCacheFile, imageChecksum, errorMessage ) )
+      {
+        std::cerr << "ERROR: Could not compute the checksum of \""
+          << inputFileNames[ f ] << "\": " << errorMessage << std::endl;
+        success = false;
+      }
+
+      if( json )
+      {
+        std::cout << "  {\"file\": " << name
+          << ", \"dimension\": " << dim
+          << ", \"pixeltype\": " << EscapeString( pixelType, true )
+          << ", \"componenttype\": " << EscapeString( componentType, true )
+          << ", \"components\": " << imageIOBase->GetNumberOfComponents()
+          << ", \"size\": ";
+        PrintValues( size, true );
+        std::cout << ", \"spacing\": ";
+        PrintValues( spacing, true );
+        std::cout << ", \"origin\": ";
+        PrintValues( origin, true );
+        std::cout << ", \"direction\": ";
+        PrintValues( direction, true );
+        if( checksum )
+        {
+          std::cout << ", \"checksum\": " << EscapeString( imageChecksum, true );
+        }
+        std::cout << "}";
+      }
+      else
+      {
+        std::cout << name << "," << dim << "," << pixelType << ","
+          << componentType << "," << imageIOBase->GetNumberOfComponents() << ",";
+        PrintValues( size, false );
+        std::cout << ",";
+        PrintValues( spacing, false );
+        std::cout << ",";
+        PrintValues( origin, false );
+        std::cout << ",";
+        PrintValues( direction, false );
+        if( checksum ) std::cout << "," << imageChecksum;
+      }
+    }
+
+    if( json && f + 1 < inputFileNames.size() ) std::cout << ",";
+    std::cout << "\n";
+  }
+
+  if( json ) std::cout << "]\n";
+
+  return success;
+
+} // end PrintImageInformationTable()
+
+
 //-------------------------------------------------------------------------------------
 
 int main( int argc, char **argv )
@@ -88,8 +268,43 @@ int main( int argc, char **argv )
   }
 
   /** Get arguments. */
-  std::string inputFileName = "";
-  parser->GetCommandLineArgument( "-in", inputFileName );
+  std::vector<std::string> inputFileNames;
+  parser->GetCommandLineArgument( "-in", inputFileNames );
+
+  std::string format = "";
+  bool retformat = parser->GetCommandLineArgument( "-format", format );
+  bool exchecksum = parser->ArgumentExists( "-checksum" );
+  bool excache = parser->ArgumentExists( "-cache" );
+
+  /** Many files, or a table format: print a table of all headers. */
+  if( inputFileNames.size() > 1 || retformat )
+  {
+    if( format != "" && format != "csv" && format != "json" )
+    {
+      std::cerr << "ERROR: -format should be csv or json." << std::endl;
+      return EXIT_FAILURE;
+    }
+    itktools::ReadThreadingArguments( parser );
+    const bool success = PrintImageInformationTable( inputFileNames,
+      format == "json", exchecksum, excache );
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+  const std::string inputFileName = inputFileNames[ 0 ];
+
+  /** Print the checksum of the pixel data. */
+  if( exchecksum )
+  {
+    itktools::ReadThreadingArguments( parser );
+    std::string checksum = "";
+    std::string errorMessage = "";
+    if( !itktools::GetImageChecksum( inputFileName, excache, checksum, errorMessage ) )
+    {
+      std::cerr << "ERROR: Could not compute the checksum: " << errorMessage << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::cout << checksum;
+    return EXIT_SUCCESS;
+  }
 
   int index = -1;
   bool reti = parser->GetCommandLineArgument( "-i", index );
@@ -45,6 +45,8 @@ std::string GetHelpString( void )
     << "  -in      inputFileName\n"
     << "  -out     outputFileName\n"
     << "  -[mask]  maskFileName\n"
+    << "  [-cache] without a mask, take the histogram from the statistics file\n"
+    << "           in + .statistics if it is valid, and otherwise write it there\n"
     << "Supported: 2D, 3D, (unsigned) char, (unsigned) short, (unsigned) int";
 
   return ss.str();
@@ -86,6 +88,8 @@ int main( int argc, char** argv )
   std::string maskFileName = "";
   parser->GetCommandLineArgument( "-mask", maskFileName );
 
+  const bool useCacheFile = parser->ArgumentExists( "-cache" );
+
   /** Determine image properties. */
   itk::ImageIOBase::IOPixelType pixelType = itk::ImageIOBase::UNKNOWNPIXELTYPE;
   itk::ImageIOBase::IOComponentType componentType = itk::ImageIOBase::UNKNOWNCOMPONENTTYPE;
@@ -127,7 +131,9 @@ int main( int argc, char** argv )
     filter->m_InputFileName = inputFileName;
     filter->m_OutputFileName = outputFileName;
     filter->m_MaskFileName = maskFileName;
+    filter->m_UseCacheFile = useCacheFile;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
@@ -19,6 +19,7 @@
 #define __histogramequalizeimage_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsStatisticsCache.h"
 
 #include "itkImageFileReader.h"
 #include "itkHistogramEqualizationImageFilter.h"
@@ -40,6 +41,7 @@ public:
     this->m_InputFileName = "";
     this->m_OutputFileName = "";
     this->m_MaskFileName = "";
+    this->m_UseCacheFile = false;
   };
   /** Destructor. */
   ~ITKToolsHistogramEqualizeImageBase(){};
@@ -48,6 +50,7 @@ public:
   std::string m_InputFileName;
   std::string m_OutputFileName;
   std::string m_MaskFileName;
+  bool m_UseCacheFile;
 
 }; // end class ITKToolsHistogramEqualizeImageBase
 
@@ -111,10 +114,40 @@ public:
     {
       enhancer->SetMask( maskReader->GetOutput() );
     }
+
+    /** Without a mask, the histogram may be known from the statistics file
+     * of the input, which saves two passes over the image. */
+    const bool useCacheFile = this->m_UseCacheFile && this->m_MaskFileName == "";
+    itktools::ImageStatistics imageStatistics;
+    bool cached = false;
+    if( useCacheFile && itktools::ReadStatisticsCache( this->m_InputFileName,
+      itktools::GetReadComponentType<ImageType>(), imageStatistics )
+      && imageStatistics.HasHistogram() )
+    {
+      enhancer->SetValueHistogram(
+        static_cast<TComponentType>( imageStatistics.HistogramMinimum ),
+        imageStatistics.Histogram );
+      cached = true;
+    }
+
     writer->SetInput( enhancer->GetOutput() );
     writer->SetFileName( this->m_OutputFileName.c_str() );
     writer->Update();
 
+    /** Store the histogram for the next run. */
+    if( useCacheFile && !cached
+      && enhancer->GetValueHistogram().size() <= itktools::MaximumNumberOfHistogramValues )
+    {
+      const typename EnhancerType::HistogramType & histogram
+        = enhancer->GetValueHistogram();
+      imageStatistics = itktools::ImageStatistics();
+      imageStatistics.HistogramMinimum = enhancer->GetMin();
+      imageStatistics.Histogram.assign( histogram.begin(), histogram.end() );
+      imageStatistics.ComputeMomentsFromHistogram();
+      itktools::WriteStatisticsCache( this->m_InputFileName,
+        reader->GetOutput(), imageStatistics );
+    }
+
   } // end Run()
 
 }; // end class ITKToolsHistogramEqualizeImage
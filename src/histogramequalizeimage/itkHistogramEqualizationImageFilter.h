@@ -20,6 +20,9 @@
 
 #include "itkImageToImageFilter.h"
 #include "itkArray.h"
+#include "itkMaskSpanImageCalculator.h"
+#include "itkParallelReducer.h"
+#include <vector>
 
 
 namespace itk
@@ -32,6 +35,13 @@ namespace itk
  * In contrast to the AdaptiveHistogramEqualizationImageFilter it is not adaptive
  * and therefore faster.
  *
+ * The minimum, the maximum and the histogram are computed in parallel by a
+ * ParallelReducer, in partial histograms per thread that are merged before
+ * the cumulative histogram is made. The cumulative mapping is a dense LUT over the
+ * intensity range, applied to the buffer of the input. A histogram known
+ * from an earlier run can be given with SetValueHistogram(), in which case
+ * the input is only read to apply the LUT.
+ *
  * \ingroup IntensityImageFilters
  *
  */
@@ -84,6 +94,7 @@ public:
   typedef unsigned char                           MaskPixelType;
   typedef Image<MaskPixelType, ImageDimension>    MaskImageType;
   typedef typename MaskImageType::Pointer         MaskImagePointer;
+  typedef MaskSpanImageCalculator<MaskImageType>  MaskSpansType;
 
   /** Set/Get mask */
   itkSetObjectMacro( Mask, MaskImageType );
@@ -92,6 +103,25 @@ public:
   //itkSetMacro( NumberOfBins, unsigned int );
   //itkGetConstReferenceMacro( NumberOfBins, unsigned int );
 
+  /** The histogram of the (masked) input image, one bin per value. */
+  typedef std::vector<unsigned long> HistogramType;
+
+  /** Use this histogram, e.g. known from an earlier run, instead of
+   * scanning the input image for it: counts[ i ] pixels with value
+   * minimum + i. It should be that of the (masked) input image.
+   */
+  void SetValueHistogram( const InputImagePixelType & minimum,
+    const std::vector<double> & counts );
+
+  /** Get the histogram after Update(): bin i holds the number of pixels
+   * with value GetMinimum() + i. */
+  const HistogramType & GetValueHistogram( void ) const
+  {
+    return this->m_ValueHistogram;
+  }
+  itkGetConstMacro( Min, InputImagePixelType );
+  itkGetConstMacro( Max, InputImagePixelType );
+
 protected:
   HistogramEqualizationImageFilter();
   ~HistogramEqualizationImageFilter();
@@ -106,10 +136,69 @@ protected:
   double              m_MeanFrequency;
   MaskImagePointer    m_Mask;
 
+  /** The inside of the mask, for the histogram passes. */
+  typename MaskSpansType::Pointer m_MaskSpans;
+
+  /** The histogram, set by the user or computed. */
+  HistogramType       m_ValueHistogram;
+  bool                m_ValueHistogramSetByUser;
+
+  /** The partial results of the threads. */
+  struct MinimumMaximumType
+  {
+    InputImagePixelType Minimum;
+    InputImagePixelType Maximum;
+    unsigned long       NumberOfValidPixels;
+  };
+
+  /** The reducers of the two passes of BeforeThreadedGenerateData(). */
+  class MinimumMaximumReducerType
+  {
+  public:
+    typedef OutputImageRegionType       RegionType;
+    typedef MinimumMaximumType          PartialType;
+    const Self * m_Filter;
+    void Initialize( PartialType & partial ) const;
+    void Reduce( const RegionType & block, PartialType & partial ) const
+    {
+      this->m_Filter->ComputeMinimumMaximum( block, partial );
+    }
+    void Merge( PartialType & partial, const PartialType & other ) const;
+  };
+
+  class HistogramReducerType
+  {
+  public:
+    typedef OutputImageRegionType       RegionType;
+    typedef HistogramType               PartialType;
+    const Self * m_Filter;
+    void Initialize( PartialType & partial ) const
+    {
+      partial.assign( this->m_Filter->m_NumberOfBins, 0 );
+    }
+    void Reduce( const RegionType & block, PartialType & partial ) const
+    {
+      this->m_Filter->ComputeHistogram( block, partial );
+    }
+    void Merge( PartialType & partial, const PartialType & other ) const;
+  };
+
   /** Initialize some accumulators before the threads run.
    * Create a LUT */
   virtual void BeforeThreadedGenerateData( void );
 
+  /** Add the minimum, the maximum and the number of valid pixels of a
+   * block. */
+  void ComputeMinimumMaximum(
+    const OutputImageRegionType & block, MinimumMaximumType & partial ) const;
+
+  /** Add the histogram of a block. */
+  void ComputeHistogram(
+    const OutputImageRegionType & block, HistogramType & hist ) const;
+
+  /** Compute the LUT from the histogram. */
+  void ComputeLUT( void );
+
   /** Tally accumulated in threads. */
   virtual void AfterThreadedGenerateData( void );
 
@@ -36,6 +36,7 @@ HistogramEqualizationImageFilter<TImage>
   this->m_Max = itk::NumericTraits<InputImagePixelType>::NonpositiveMin();
   this->m_MeanFrequency = 1.0;
   this->m_NumberOfBins = 1;
+  this->m_ValueHistogramSetByUser = false;
 }
 
 template<class TImage>
@@ -49,54 +50,54 @@ void
 HistogramEqualizationImageFilter<TImage>
 ::BeforeThreadedGenerateData( void )
 {
-  typedef ImageRegionConstIterator<InputImageType>   ImageIteratorType;
-  typedef ImageRegionConstIterator<MaskImageType>    MaskIteratorType;
+  const ThreadIdType numberOfThreads = this->GetNumberOfThreads();
 
-  /** Use a mask or not */
-  bool useMask = false;
-  if( this->GetMask() )
+  /** With a histogram given by the user the image is not scanned. */
+  if( this->m_ValueHistogramSetByUser )
   {
-    useMask = true;
+    this->m_NumberOfBins = this->m_ValueHistogram.size();
+    unsigned long numberOfValidPixels = 0;
+    for( std::size_t i = 0; i < this->m_ValueHistogram.size(); ++i )
+    {
+      numberOfValidPixels += this->m_ValueHistogram[ i ];
+    }
+    this->m_MeanFrequency =
+      static_cast<double>( numberOfValidPixels ) /
+      static_cast<double>( this->m_NumberOfBins );
+    this->ComputeLUT();
+    return;
   }
 
-  /** Compute minimum and maximum of the input image */
-  ImageIteratorType it( this->GetInput(), this->GetOutput()->GetRequestedRegion() );
-  MaskIteratorType maskIt;
-  if( useMask )
+  /** The inside of the mask as spans, so that the histogram passes only
+   * visit the pixels inside the mask. */
+  this->m_MaskSpans = 0;
+  if( this->GetMask() )
   {
-    maskIt = MaskIteratorType( this->GetMask(), this->GetOutput()->GetRequestedRegion() );
-    maskIt.GoToBegin();
+    this->m_MaskSpans = MaskSpansType::New();
+    this->m_MaskSpans->SetMaskImage( this->GetMask() );
+    this->m_MaskSpans->SetRegion( this->GetOutput()->GetRequestedRegion() );
+    this->m_MaskSpans->SetNumberOfThreads( numberOfThreads );
+    this->m_MaskSpans->Compute();
   }
 
-  InputImagePixelType tempmin = itk::NumericTraits<InputImagePixelType>::max();
-  InputImagePixelType tempmax =
-    itk::NumericTraits<InputImagePixelType>::NonpositiveMin();
-
-  unsigned long numberOfValidPixels = 0;
-  it.GoToBegin();
-  while ( !it.IsAtEnd() )
-  {
-    bool validPixel = true;
-    if( useMask )
-    {
-      validPixel = static_cast<bool>( maskIt.Value() );
-      ++maskIt;
-    }
-    if( validPixel )
-    {
-      ++numberOfValidPixels;
-      const InputImagePixelType & current = it.Value();
-      if( current < tempmin )
-      {
-        tempmin = current;
-      }
-      if( current > tempmax )
-      {
-        tempmax = current;
-      }
-    }
-    ++it;
-  }
+  /** Compute minimum and maximum of the input image. The results are
+   * exact, so one partial per thread suffices. */
+  MinimumMaximumReducerType minimumMaximumReducer;
+  minimumMaximumReducer.m_Filter = this;
+
+  typedef ParallelReducer< MinimumMaximumReducerType > MinimumMaximumParallelReducerType;
+  typename MinimumMaximumParallelReducerType::Pointer minimumMaximumParallelReducer
+    = MinimumMaximumParallelReducerType::New();
+  minimumMaximumParallelReducer->SetReducer( &minimumMaximumReducer );
+  minimumMaximumParallelReducer->SetRegion( this->GetOutput()->GetRequestedRegion() );
+  minimumMaximumParallelReducer->SetNumberOfThreads( numberOfThreads );
+  minimumMaximumParallelReducer->ExactMergeOn();
+  minimumMaximumParallelReducer->Compute();
+  const MinimumMaximumType & minimumMaximum = minimumMaximumParallelReducer->GetResult();
+
+  const InputImagePixelType tempmin = minimumMaximum.Minimum;
+  const InputImagePixelType tempmax = minimumMaximum.Maximum;
+  const unsigned long numberOfValidPixels = minimumMaximum.NumberOfValidPixels;
 
   this->m_Min = tempmin;
   this->m_Max = tempmax;
@@ -108,38 +109,52 @@ HistogramEqualizationImageFilter<TImage>
     static_cast<double>( numberOfValidPixels ) /
     static_cast<double>( this->m_NumberOfBins );
 
-  /** Compute the histogram of the input image */
-  typedef itk::Array<unsigned long> HistogramType;
-  HistogramType hist( this->m_NumberOfBins );
-  hist.Fill( 0 );
-  it.GoToBegin();
-  if( useMask )
+  /** Compute the histogram of the input image, in partial histograms. For
+   * a wide intensity range fewer threads are used, to bound the memory of
+   * the partial histograms.
+   */
+  const unsigned long maximumNumberOfPartialBins = 1UL << 24;
+  ThreadIdType numberOfHistograms = numberOfThreads;
+  if( static_cast<unsigned long>( numberOfHistograms ) * this->m_NumberOfBins
+    > maximumNumberOfPartialBins )
   {
-    maskIt.GoToBegin();
-  }
-  while ( !it.IsAtEnd() )
-  {
-    bool validPixel = true;
-    if( useMask )
-    {
-      validPixel = static_cast<bool>( maskIt.Value() );
-      ++maskIt;
-    }
-    if( validPixel )
-    {
-      // assuming integer pixel type of binsize 1
-      hist[ static_cast<unsigned int>( it.Value() - tempmin ) ]++;
-    }
-    ++it;
+    numberOfHistograms = static_cast<ThreadIdType>( vnl_math_max( 1UL,
+      maximumNumberOfPartialBins / this->m_NumberOfBins ) );
   }
+  HistogramReducerType histogramReducer;
+  histogramReducer.m_Filter = this;
+
+  typedef ParallelReducer< HistogramReducerType > HistogramParallelReducerType;
+  typename HistogramParallelReducerType::Pointer histogramParallelReducer
+    = HistogramParallelReducerType::New();
+  histogramParallelReducer->SetReducer( &histogramReducer );
+  histogramParallelReducer->SetRegion( this->GetOutput()->GetRequestedRegion() );
+  histogramParallelReducer->SetNumberOfThreads( numberOfHistograms );
+  histogramParallelReducer->ExactMergeOn();
+  histogramParallelReducer->Compute();
+  this->m_ValueHistogram = histogramParallelReducer->GetResult();
+  histogramParallelReducer = 0;
+  this->m_MaskSpans = 0;
+
+  this->ComputeLUT();
+
+} // end BeforeThreadedGenerateData()
 
-  /** convert it to a cumulative histogram */
+
+template<class TImage>
+void
+HistogramEqualizationImageFilter<TImage>
+::ComputeLUT( void )
+{
+  /** convert the histogram to a cumulative histogram */
+  HistogramType hist = this->m_ValueHistogram;
   for( unsigned int i = 1; i < this->m_NumberOfBins; i++ )
   {
     hist[ i ] += hist[i-1];
   }
 
   /** Compute LUT */
+  const InputImagePixelType tempmin = this->m_Min;
   this->m_LUT.SetSize(this->m_NumberOfBins);
   for( unsigned int i = 0; i < this->m_NumberOfBins; i++ )
   {
@@ -149,7 +164,150 @@ HistogramEqualizationImageFilter<TImage>
       -1.0 + tempmin + vcl_floor( static_cast<double>( hist[ i ] ) / this->m_MeanFrequency + 0.5 ) ) );
   }
 
-} // end BeforeThreadedGenerateData()
+} // end ComputeLUT()
+
+
+template<class TImage>
+void
+HistogramEqualizationImageFilter<TImage>
+::SetValueHistogram( const InputImagePixelType & minimum,
+  const std::vector<double> & counts )
+{
+  this->m_ValueHistogram.resize( counts.size() );
+  for( std::size_t i = 0; i < counts.size(); ++i )
+  {
+    this->m_ValueHistogram[ i ] = static_cast<unsigned long>( counts[ i ] );
+  }
+  this->m_Min = minimum;
+  this->m_Max = static_cast<InputImagePixelType>(
+    static_cast<double>( minimum ) + counts.size() - 1.0 );
+  this->m_ValueHistogramSetByUser = !counts.empty();
+  this->Modified();
+
+} // end SetValueHistogram()
+
+
+template<class TImage>
+void
+HistogramEqualizationImageFilter<TImage>
+::MinimumMaximumReducerType::Initialize( PartialType & partial ) const
+{
+  partial.Minimum = itk::NumericTraits<InputImagePixelType>::max();
+  partial.Maximum = itk::NumericTraits<InputImagePixelType>::NonpositiveMin();
+  partial.NumberOfValidPixels = 0;
+
+} // end MinimumMaximumReducerType::Initialize()
+
+
+template<class TImage>
+void
+HistogramEqualizationImageFilter<TImage>
+::MinimumMaximumReducerType::Merge( PartialType & partial, const PartialType & other ) const
+{
+  if( other.Minimum < partial.Minimum ) partial.Minimum = other.Minimum;
+  if( other.Maximum > partial.Maximum ) partial.Maximum = other.Maximum;
+  partial.NumberOfValidPixels += other.NumberOfValidPixels;
+
+} // end MinimumMaximumReducerType::Merge()
+
+
+template<class TImage>
+void
+HistogramEqualizationImageFilter<TImage>
+::HistogramReducerType::Merge( PartialType & partial, const PartialType & other ) const
+{
+  for( std::size_t i = 0; i < partial.size(); ++i )
+  {
+    partial[ i ] += other[ i ];
+  }
+
+} // end HistogramReducerType::Merge()
+
+
+template<class TImage>
+void
+HistogramEqualizationImageFilter<TImage>
+::ComputeMinimumMaximum(
+  const OutputImageRegionType & region, MinimumMaximumType & partial ) const
+{
+  typedef ImageRegionConstIterator<InputImageType>   ImageIteratorType;
+
+  InputImagePixelType tempmin = partial.Minimum;
+  InputImagePixelType tempmax = partial.Maximum;
+  unsigned long numberOfValidPixels = 0;
+
+  if( this->m_MaskSpans )
+  {
+    SizeValueType spanBegin, spanEnd;
+    OutputImageRegionType spanRegion;
+    this->m_MaskSpans->GetSpanRange( region, spanBegin, spanEnd );
+    for( SizeValueType s = spanBegin; s < spanEnd; ++s )
+    {
+      if( !this->m_MaskSpans->GetSpanRegion( s, region, spanRegion ) ) continue;
+      numberOfValidPixels += spanRegion.GetNumberOfPixels();
+      for( ImageIteratorType it( this->GetInput(), spanRegion ); !it.IsAtEnd(); ++it )
+      {
+        const InputImagePixelType & current = it.Value();
+        if( current < tempmin ) tempmin = current;
+        if( current > tempmax ) tempmax = current;
+      }
+    }
+  }
+  else
+  {
+    ImageIteratorType it( this->GetInput(), region );
+    for( ; !it.IsAtEnd(); ++it )
+    {
+      const InputImagePixelType & current = it.Value();
+      if( current < tempmin ) tempmin = current;
+      if( current > tempmax ) tempmax = current;
+    }
+    numberOfValidPixels = region.GetNumberOfPixels();
+  }
+
+  partial.Minimum = tempmin;
+  partial.Maximum = tempmax;
+  partial.NumberOfValidPixels += numberOfValidPixels;
+
+} // end ComputeMinimumMaximum()
+
+
+template<class TImage>
+void
+HistogramEqualizationImageFilter<TImage>
+::ComputeHistogram(
+  const OutputImageRegionType & region, HistogramType & hist ) const
+{
+  typedef ImageRegionConstIterator<InputImageType>   ImageIteratorType;
+
+  // assuming integer pixel type of binsize 1
+  unsigned long * bins = &hist[ 0 ];
+  const InputImagePixelType tempmin = this->m_Min;
+
+  if( this->m_MaskSpans )
+  {
+    SizeValueType spanBegin, spanEnd;
+    OutputImageRegionType spanRegion;
+    this->m_MaskSpans->GetSpanRange( region, spanBegin, spanEnd );
+    for( SizeValueType s = spanBegin; s < spanEnd; ++s )
+    {
+      if( !this->m_MaskSpans->GetSpanRegion( s, region, spanRegion ) ) continue;
+      for( ImageIteratorType it( this->GetInput(), spanRegion ); !it.IsAtEnd(); ++it )
+      {
+        ++bins[ static_cast<unsigned int>( it.Value() - tempmin ) ];
+      }
+    }
+  }
+  else
+  {
+    ImageIteratorType it( this->GetInput(), region );
+    for( ; !it.IsAtEnd(); ++it )
+    {
+      ++bins[ static_cast<unsigned int>( it.Value() - tempmin ) ];
+    }
+  }
+
+} // end ComputeHistogram()
 
 
 template<class TImage>
@@ -172,45 +330,39 @@ HistogramEqualizationImageFilter<TImage>
   typedef ImageRegionIterator<OutputImageType>       OutputImageIteratorType;
   typedef ImageRegionConstIterator<MaskImageType>    MaskIteratorType;
 
-  /** Use a mask or not */
-  bool useMask = false;
-  if( this->GetMask() ) useMask = true;
-
   InputImageIteratorType  it( this->GetInput(), outputRegionForThread );
   OutputImageIteratorType ot( this->GetOutput(), outputRegionForThread );
-  MaskIteratorType maskIt;
-  if( useMask )
-  {
-    maskIt = MaskIteratorType( this->GetMask(), outputRegionForThread );
-    maskIt.GoToBegin();
-  }
 
   // support progress methods/callbacks
   ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() );
 
-  LUTType & lut = this->m_LUT;
-  InputImagePixelType & tempmin = this->m_Min;
+  const OutputImagePixelType * lut = this->m_LUT.data_block();
+  const InputImagePixelType tempmin = this->m_Min;
 
-  // shift and scale the input pixels
-  while( !it.IsAtEnd() )
+  // map the input pixels through the LUT
+  if( this->GetMask() )
   {
-    bool validPixel = true;
-    if( useMask )
+    MaskIteratorType maskIt( this->GetMask(), outputRegionForThread );
+    for( ; !it.IsAtEnd(); ++it, ++ot, ++maskIt )
     {
-      validPixel = static_cast<bool>( maskIt.Value() );
-      ++maskIt;
+      if( maskIt.Value() )
+      {
+        ot.Set( lut[ static_cast<unsigned int>( it.Value() - tempmin ) ] );
+      }
+      else
+      {
+        ot.Set( it.Value() ); // original?
+      }
+      progress.CompletedPixel();
     }
-    if( validPixel )
+  }
+  else
+  {
+    for( ; !it.IsAtEnd(); ++it, ++ot )
     {
       ot.Set( lut[ static_cast<unsigned int>( it.Value() - tempmin ) ] );
+      progress.CompletedPixel();
     }
-    else
-    {
-      ot.Set( it.Value() ); // original?
-    }
-    ++it;
-    ++ot;
-    progress.CompletedPixel();
   }
 } // end ThreadedGenerateData()
 
@@ -0,0 +1,279 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+/** \file
+ \brief Evaluate an expression over images in one pass.
+
+ \verbinclude imagecalculator.help
+ */
+
+/** Setup Mevislab DicomTiff IO support */
+#include "itkUseMevisDicomTiff.h"
+
+#include "itkCommandLineArgumentParser.h"
+#include "ITKToolsHelpers.h"
+#include "imagecalculator.h"
+
+
+/**
+ * ******************* GetHelpString *******************
+ */
+
+std::string GetHelpString( void )
+{
+  std::stringstream ss;
+  ss << "ITKTools v" << itktools::GetITKToolsVersion() << "\n"
+    << "Evaluates an expression over images, pixel by pixel.\n"
+    << "The expression is compiled once and computed in a single\n"
+    << "multi-threaded pass, without temporary images, instead of chaining\n"
+    << "pxbinaryimageoperator and pxunaryimageoperator calls.\n"
+    << "Usage:\npximagecalculator\n"
+    << "  -in      inputFilenames, as name=filename, or just filename, in which\n"
+    << "           case the inputs are named a, b, c, ...;\n"
+    << "           use @file to read them from a manifest\n"
+    << "  -e       the expression, e.g. \"(a-b)*(mask>0)/c+1\"\n"
+    << "  -out     outputFilename\n"
+    << "  [-z]     compression flag; if provided, the output image is compressed\n"
+    << "  [-opct]  output component type, by default the largest of the input images\n"
+    << "             choose one of: {[unsigned_]{char,short,int,long},float,double}\n"
+    << "  [-p]     print the compiled program\n"
+    << "The expression is computed in double precision, and the result\n"
+    << "saturates for integer output types. Logical operators and\n"
+    << "comparisons give 1 or 0.\n"
+    << itk::ImageExpression::GetHelpString() << "\n"
+    << "Supported: 2D, 3D, (unsigned) char, (unsigned) short, (unsigned) int, (unsigned) long, float, double.";
+
+  return ss.str();
+
+} // end GetHelpString()
+
+//-------------------------------------------------------------------------------------
+
+int main( int argc, char **argv )
+{
+  RegisterMevisDicomTiff();
+
+  /** Create a command line argument parser. */
+  itk::CommandLineArgumentParser::Pointer parser = itk::CommandLineArgumentParser::New();
+  parser->SetCommandLineArguments( argc, argv );
+  parser->SetProgramHelpText( GetHelpString() );
+
+  parser->MarkArgumentAsRequired( "-in", "The input filename." );
+  parser->MarkArgumentAsRequired( "-e", "The expression." );
+  parser->MarkArgumentAsRequired( "-out", "The output filename." );
+
+  itk::CommandLineArgumentParser::ReturnValue validateArguments = parser->CheckForRequiredArguments();
+
+  if( validateArguments == itk::CommandLineArgumentParser::FAILED )
+  {
+    return EXIT_FAILURE;
+  }
+  else if( validateArguments == itk::CommandLineArgumentParser::HELPREQUESTED )
+  {
+    return EXIT_SUCCESS;
+  }
+
+  /** Get arguments. */
+  std::vector<std::string> inputs;
+  parser->GetCommandLineArgument( "-in", inputs );
+
+  std::string expression = "";
+  parser->GetCommandLineArgument( "-e", expression );
+
+  std::string outputFileName = "";
+  parser->GetCommandLineArgument( "-out", outputFileName );
+
+  std::string opct = "";
+  bool retopct = parser->GetCommandLineArgument( "-opct", opct );
+
+  const bool useCompression = parser->ArgumentExists( "-z" );
+  const bool printProgram = parser->ArgumentExists( "-p" );
+
+  /** Split the inputs into names and file names. */
+  std::vector<std::string> variableNames;
+  std::vector<std::string> inputFileNames;
+  for( unsigned int i = 0; i < inputs.size(); ++i )
+  {
+    const std::string::size_type pos = inputs[ i ].find( '=' );
+    bool hasName = pos != std::string::npos && pos > 0
+      && ( std::isalpha( static_cast<unsigned char>( inputs[ i ][ 0 ] ) ) || inputs[ i ][ 0 ] == '_' );
+    for( std::string::size_type k = 1; hasName && k < pos; ++k )
+    {
+      hasName = std::isalnum( static_cast<unsigned char>( inputs[ i ][ k ] ) ) || inputs[ i ][ k ] == '_';
+    }
+
+    if( hasName )
+    {
+      variableNames.push_back( inputs[ i ].substr( 0, pos ) );
+      inputFileNames.push_back( inputs[ i ].substr( pos + 1 ) );
+    }
+    else if( i < 26 )
+    {
+      variableNames.push_back( std::string( 1, static_cast<char>( 'a' + i ) ) );
+      inputFileNames.push_back( inputs[ i ] );
+    }
+    else
+    {
+      std::cerr << "ERROR: name the inputs, as name=filename, for more than 26 inputs." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  for( unsigned int i = 0; i < variableNames.size(); ++i )
+  {
+    for( unsigned int j = 0; j < i; ++j )
+    {
+      if( variableNames[ i ] == variableNames[ j ] )
+      {
+        std::cerr << "ERROR: the name \"" << variableNames[ i ] << "\" is used for two inputs." << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  /** Read the headers of all inputs before processing starts. */
+  if( !itktools::ValidateImageHeaders( inputFileNames ) ) return EXIT_FAILURE;
+
+  /** Determine image properties. The inputs are converted to float if
+   * that is exact for all of them, and to double otherwise. */
+  itk::ImageIOBase::IOComponentType componentTypeIn = itk::ImageIOBase::FLOAT;
+  itk::ImageIOBase::IOComponentType componentTypeOut = itk::ImageIOBase::UCHAR;
+  unsigned int dim = 2;
+  std::vector<unsigned int> imageSize;
+  for( unsigned int i = 0; i < inputFileNames.size(); ++i )
+  {
+    itk::ImageIOBase::IOPixelType pixelType_i;
+    itk::ImageIOBase::IOComponentType componentType_i;
+    unsigned int dim_i = 2;
+    unsigned int numberOfComponents_i = 1;
+    std::vector<unsigned int> imageSize_i;
+    bool retgip = itktools::GetImageProperties( inputFileNames[ i ],
+      pixelType_i, componentType_i, dim_i, numberOfComponents_i, imageSize_i );
+    if( !retgip ) return EXIT_FAILURE;
+
+    if( !itktools::NumberOfComponentsCheck( numberOfComponents_i ) ) return EXIT_FAILURE;
+
+    if( i == 0 )
+    {
+      dim = dim_i;
+      imageSize = imageSize_i;
+      componentTypeOut = componentType_i;
+    }
+    else if( dim_i != dim || imageSize_i != imageSize )
+    {
+      std::cerr << "ERROR: the input images have different sizes." << std::endl;
+      return EXIT_FAILURE;
+    }
+    componentTypeOut = itktools::GetLargestComponentType( componentTypeOut, componentType_i );
+
+    if( componentType_i != itk::ImageIOBase::CHAR
+      && componentType_i != itk::ImageIOBase::UCHAR
+      && componentType_i != itk::ImageIOBase::SHORT
+      && componentType_i != itk::ImageIOBase::USHORT
+      && componentType_i != itk::ImageIOBase::FLOAT )
+    {
+      componentTypeIn = itk::ImageIOBase::DOUBLE;
+    }
+  }
+
+  /** Let the user override the output component type. */
+  if( retopct )
+  {
+    componentTypeOut = itk::ImageIOBase::GetComponentTypeFromString( opct );
+    if( !itktools::ComponentTypeIsValid( componentTypeOut ) )
+    {
+      std::cerr << "ERROR: the you specified an invalid opct." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  /** Class that does the work. */
+  ITKToolsImageCalculatorBase * filter = NULL;
+
+  try
+  {
+    // now call all possible template combinations.
+    if( !filter ) filter = ITKToolsImageCalculator< 2, float, char >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 2, float, unsigned char >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 2, float, short >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 2, float, unsigned short >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 2, float, int >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 2, float, unsigned int >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 2, float, long >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 2, float, unsigned long >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 2, float, float >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 2, float, double >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 2, double, char >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 2, double, unsigned char >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 2, double, short >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 2, double, unsigned short >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 2, double, int >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 2, double, unsigned int >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 2, double, long >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 2, double, unsigned long >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 2, double, float >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 2, double, double >::New( dim, componentTypeIn, componentTypeOut );
+
+#ifdef ITKTOOLS_3D_SUPPORT
+    if( !filter ) filter = ITKToolsImageCalculator< 3, float, char >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 3, float, unsigned char >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 3, float, short >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 3, float, unsigned short >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 3, float, int >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 3, float, unsigned int >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 3, float, long >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 3, float, unsigned long >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 3, float, float >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 3, float, double >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 3, double, char >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 3, double, unsigned char >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 3, double, short >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 3, double, unsigned short >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 3, double, int >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 3, double, unsigned int >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 3, double, long >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 3, double, unsigned long >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 3, double, float >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsImageCalculator< 3, double, double >::New( dim, componentTypeIn, componentTypeOut );
+#endif
+    /** Check if filter was instantiated. */
+    bool supported = itktools::IsFilterSupportedCheck( filter, dim, componentTypeIn, componentTypeOut );
+    if( !supported ) return EXIT_FAILURE;
+
+    /** Set the filter arguments. */
+    filter->m_InputFileNames = inputFileNames;
+    filter->m_VariableNames = variableNames;
+    filter->m_OutputFileName = outputFileName;
+    filter->m_Expression = expression;
+    filter->m_UseCompression = useCompression;
+    filter->m_PrintProgram = printProgram;
+
+    filter->ReadCommonArguments( parser );
+    filter->Run();
+
+    delete filter;
+  }
+  catch( itk::ExceptionObject & excp )
+  {
+    std::cerr << "ERROR: Caught ITK exception: " << excp << std::endl;
+    delete filter;
+    return EXIT_FAILURE;
+  }
+
+  /** End program. */
+  return EXIT_SUCCESS;
+
+} // end main
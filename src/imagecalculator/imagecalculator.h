@@ -0,0 +1,143 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __imagecalculator_h_
+#define __imagecalculator_h_
+
+#include "ITKToolsBase.h"
+#include "ITKToolsImageProperties.h"
+
+#include "itkImage.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkExpressionImageFilter.h"
+
+#include <vector>
+
+
+/** \class ITKToolsImageCalculatorBase
+ *
+ * Untemplated pure virtual base class that holds
+ * the Run() function and all required parameters.
+ */
+
+class ITKToolsImageCalculatorBase : public itktools::ITKToolsBase
+{
+public:
+  /** Constructor. */
+  ITKToolsImageCalculatorBase()
+  {
+    this->m_OutputFileName = "";
+    this->m_Expression = "";
+    this->m_UseCompression = false;
+    this->m_PrintProgram = false;
+  };
+  /** Destructor. */
+  ~ITKToolsImageCalculatorBase(){};
+
+  /** Input member parameters. */
+  std::vector<std::string>  m_InputFileNames;
+  std::vector<std::string>  m_VariableNames;
+  std::string               m_OutputFileName;
+  std::string               m_Expression;
+  bool                      m_UseCompression;
+  bool                      m_PrintProgram;
+
+  /** This tool supports streaming. */
+  virtual bool GetSupportsStreaming( void ) const { return true; }
+
+}; // end class ITKToolsImageCalculatorBase
+
+
+/** \class ITKToolsImageCalculator
+ *
+ * Templated class that implements the Run() function
+ * and the New() function for its creation.
+ */
+
+template< unsigned int VDimension, class TInputComponentType, class TOutputComponentType >
+class ITKToolsImageCalculator : public ITKToolsImageCalculatorBase
+{
+public:
+  /** Standard ITKTools stuff. */
+  typedef ITKToolsImageCalculator Self;
+  itktoolsTwoTypeNewMacro( Self );
+
+  ITKToolsImageCalculator(){};
+  ~ITKToolsImageCalculator(){};
+
+  /** Run function. */
+  void Run( void )
+  {
+    /** Typedefs. */
+    typedef itk::Image< TInputComponentType, VDimension >   InputImageType;
+    typedef itk::Image< TOutputComponentType, VDimension >  OutputImageType;
+    typedef itk::ImageFileReader< InputImageType >          ReaderType;
+    typedef itk::ImageFileWriter< OutputImageType >         WriterType;
+    typedef itk::ExpressionImageFilter<
+      InputImageType, OutputImageType >                     FilterType;
+
+    /** Read the input images. */
+    std::vector<typename ReaderType::Pointer> readers( this->m_InputFileNames.size() );
+    for( unsigned int i = 0; i < this->m_InputFileNames.size(); ++i )
+    {
+      readers[ i ] = ReaderType::New();
+      readers[ i ]->SetFileName( this->m_InputFileNames[ i ] );
+      itktools::SetCachedImageIOBase( readers[ i ].GetPointer() );
+    }
+
+    /** Set up the filter, which compiles the expression into one kernel. */
+    typename FilterType::Pointer filter = FilterType::New();
+    for( unsigned int i = 0; i < this->m_InputFileNames.size(); ++i )
+    {
+      filter->SetInput( i, readers[ i ]->GetOutput() );
+    }
+    filter->SetVariableNames( this->m_VariableNames );
+    filter->SetExpression( this->m_Expression );
+
+    /** Write the image to disk */
+    typename WriterType::Pointer writer = WriterType::New();
+    writer->SetFileName( this->m_OutputFileName.c_str() );
+    writer->SetInput( filter->GetOutput() );
+    writer->SetUseCompression( this->m_UseCompression );
+
+    /** Every stream reads a slab of all inputs, so account for them in the
+     * memory limit.
+     */
+    this->SetStreamingOnWriter( writer.GetPointer(),
+      static_cast<double>( this->m_InputFileNames.size() * sizeof( TInputComponentType ) ) );
+
+    if( this->m_PrintProgram )
+    {
+      filter->UpdateOutputInformation();
+      std::cout << filter->GetImageExpression().GetProgramAsString();
+    }
+
+    for( unsigned int i = 0; i < this->m_InputFileNames.size(); ++i )
+    {
+      this->ObserveProcess( readers[ i ].GetPointer(), "read" );
+    }
+    this->ObserveProcess( filter.GetPointer(), "expression" );
+    this->ObserveProcess( writer.GetPointer(), "write" );
+    writer->Update();
+
+  } // end Run()
+
+}; // end class ITKToolsImageCalculator
+
+
+#endif // end #ifndef __imagecalculator_h_
@@ -0,0 +1,121 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkExpressionImageFilter_h_
+#define __itkExpressionImageFilter_h_
+
+#include "itkImageToImageFilter.h"
+#include "itkImageExpression.h"
+
+#include <string>
+#include <vector>
+
+namespace itk
+{
+
+/** \class ExpressionImageFilter
+ * \brief Compute an expression over any number of input images in one
+ * multi-threaded pass.
+ *
+ * Input i is variable i of the expression, which is named by
+ * SetVariableNames(). The expression is compiled by ImageExpression when
+ * the output information is generated, so that errors are reported
+ * before any image data is read. The threads convert the runs of
+ * contiguous pixels of their region to double, a block at a time, run the
+ * program on the block and cast the result to the output type. The result
+ * saturates for integer output types. All inputs have the same type and
+ * geometry, and must be itk::Images.
+ *
+ * \ingroup IntensityImageFilters MultiThreaded
+ */
+
+template< class TInputImage, class TOutputImage >
+class ITK_EXPORT ExpressionImageFilter :
+  public ImageToImageFilter< TInputImage, TOutputImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef ExpressionImageFilter             Self;
+  typedef ImageToImageFilter<
+    TInputImage, TOutputImage >             Superclass;
+  typedef SmartPointer<Self>                Pointer;
+  typedef SmartPointer<const Self>          ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( ExpressionImageFilter, ImageToImageFilter );
+
+  /** Typedefs. */
+  typedef TInputImage                                 InputImageType;
+  typedef TOutputImage                                OutputImageType;
+  typedef typename InputImageType::PixelType          InputPixelType;
+  typedef typename OutputImageType::PixelType         OutputPixelType;
+  typedef typename Superclass::OutputImageRegionType  OutputImageRegionType;
+
+  itkStaticConstMacro( ImageDimension, unsigned int, TOutputImage::ImageDimension );
+
+  /** Set/Get the expression. */
+  itkSetStringMacro( Expression );
+  itkGetStringMacro( Expression );
+
+  /** Set/Get the names of the inputs in the expression. */
+  void SetVariableNames( const std::vector<std::string> & names )
+  {
+    if( this->m_VariableNames != names )
+    {
+      this->m_VariableNames = names;
+      this->Modified();
+    }
+  }
+  const std::vector<std::string> & GetVariableNames( void ) const
+  { return this->m_VariableNames; }
+
+  /** Get the compiled expression. */
+  const ImageExpression & GetImageExpression( void ) const
+  { return this->m_ImageExpression; }
+
+protected:
+  ExpressionImageFilter() {};
+  virtual ~ExpressionImageFilter() {};
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** Compile the expression. */
+  virtual void GenerateOutputInformation( void );
+
+  /** Evaluate the expression on the region of a thread. */
+  void ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+    ThreadIdType threadId );
+
+private:
+  ExpressionImageFilter( const Self & ); // purposely not implemented
+  void operator=( const Self & );        // purposely not implemented
+
+  std::string               m_Expression;
+  std::vector<std::string>  m_VariableNames;
+  ImageExpression           m_ImageExpression;
+
+}; // end class ExpressionImageFilter
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkExpressionImageFilter.txx"
+#endif
+
+#endif // end #ifndef __itkExpressionImageFilter_h_
@@ -0,0 +1,186 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkExpressionImageFilter_txx_
+#define __itkExpressionImageFilter_txx_
+
+#include "itkExpressionImageFilter.h"
+#include "itkUnaryFunctors.h"
+#include "itkProgressReporter.h"
+
+#include <algorithm>
+
+namespace itk
+{
+
+/**
+ * ******************* GenerateOutputInformation *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+ExpressionImageFilter< TInputImage, TOutputImage >
+::GenerateOutputInformation( void )
+{
+  Superclass::GenerateOutputInformation();
+
+  if( this->m_VariableNames.size() != this->GetNumberOfInputs() )
+  {
+    itkExceptionMacro( << "The number of variable names ("
+      << this->m_VariableNames.size() << ") differs from the number of inputs ("
+      << this->GetNumberOfInputs() << ")." );
+  }
+  this->m_ImageExpression.Parse( this->m_Expression, this->m_VariableNames );
+
+} // end GenerateOutputInformation()
+
+
+/**
+ * ******************* ThreadedGenerateData *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+ExpressionImageFilter< TInputImage, TOutputImage >
+::ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+  ThreadIdType threadId )
+{
+  typedef typename OutputImageRegionType::SizeType    SizeType;
+  typedef typename OutputImageRegionType::IndexType   IndexType;
+
+  const unsigned int numberOfInputs = this->GetNumberOfInputs();
+  OutputImageType * outputPtr = this->GetOutput( 0 );
+  std::vector<const InputImageType *> inputPtrs( numberOfInputs );
+  for( unsigned int j = 0; j < numberOfInputs; ++j )
+  {
+    inputPtrs[ j ] = this->GetInput( j );
+  }
+
+  const SizeType size = outputRegionForThread.GetSize();
+  if( outputRegionForThread.GetNumberOfPixels() == 0 ) return;
+
+  /** The run of contiguous pixels: the region spans all the buffers in
+   * the dimensions below runDimension. */
+  SizeValueType runLength = size[ 0 ];
+  unsigned int runDimension = 0;
+  while( runDimension + 1 < ImageDimension )
+  {
+    bool spans = size[ runDimension ]
+      == outputPtr->GetBufferedRegion().GetSize()[ runDimension ];
+    for( unsigned int j = 0; j < numberOfInputs; ++j )
+    {
+      spans &= size[ runDimension ]
+        == inputPtrs[ j ]->GetBufferedRegion().GetSize()[ runDimension ];
+    }
+    if( !spans ) break;
+    ++runDimension;
+    runLength *= size[ runDimension ];
+  }
+  const SizeValueType numberOfRuns
+    = outputRegionForThread.GetNumberOfPixels() / runLength;
+
+  /** The blocks of the inputs converted to double, and the workspace of
+   * the program, local to this thread. Unused inputs are not converted. */
+  const ImageExpression & expression = this->m_ImageExpression;
+  const SizeValueType blockLength = ImageExpression::GetBlockLength();
+  std::vector<double> buffers( numberOfInputs * blockLength );
+  std::vector<double> result( blockLength );
+  std::vector<double> workspace( expression.GetWorkspaceSize() + 1 );
+  std::vector<const double *> blocks( numberOfInputs );
+  std::vector<bool> used( numberOfInputs );
+  for( unsigned int j = 0; j < numberOfInputs; ++j )
+  {
+    blocks[ j ] = &buffers[ j * blockLength ];
+    used[ j ] = expression.IsVariableUsed( j );
+  }
+
+  ProgressReporter progress( this, threadId, numberOfRuns );
+
+  IndexType index = outputRegionForThread.GetIndex();
+  const IndexType start = index;
+  std::vector<const InputPixelType *> in( numberOfInputs );
+  for( SizeValueType r = 0; r < numberOfRuns; ++r )
+  {
+    for( unsigned int j = 0; j < numberOfInputs; ++j )
+    {
+      in[ j ] = inputPtrs[ j ]->GetBufferPointer() + inputPtrs[ j ]->ComputeOffset( index );
+    }
+    OutputPixelType * out
+      = outputPtr->GetBufferPointer() + outputPtr->ComputeOffset( index );
+
+    for( SizeValueType first = 0; first < runLength; first += blockLength )
+    {
+      const SizeValueType n = std::min( blockLength, runLength - first );
+      for( unsigned int j = 0; j < numberOfInputs; ++j )
+      {
+        if( !used[ j ] ) continue;
+        const InputPixelType * inj = in[ j ] + first;
+        double * block = &buffers[ j * blockLength ];
+        for( SizeValueType i = 0; i < n; ++i )
+        {
+          block[ i ] = static_cast<double>( inj[ i ] );
+        }
+      }
+
+      expression.Evaluate( blocks, &result[ 0 ], n, &workspace[ 0 ] );
+
+      OutputPixelType * outBlock = out + first;
+      for( SizeValueType i = 0; i < n; ++i )
+      {
+        outBlock[ i ] = Functor::SaturateCast<OutputPixelType>( result[ i ] );
+      }
+    }
+    progress.CompletedPixel();
+
+    /** The start of the next run. */
+    for( unsigned int d = runDimension + 1; d < ImageDimension; ++d )
+    {
+      if( ++index[ d ] < start[ d ] + static_cast<OffsetValueType>( size[ d ] ) )
+      {
+        break;
+      }
+      index[ d ] = start[ d ];
+    }
+  }
+
+} // end ThreadedGenerateData()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+ExpressionImageFilter< TInputImage, TOutputImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "Expression: " << this->m_Expression << std::endl;
+  os << indent << "VariableNames:";
+  for( unsigned int j = 0; j < this->m_VariableNames.size(); ++j )
+  {
+    os << " " << this->m_VariableNames[ j ];
+  }
+  os << std::endl;
+
+} // end PrintSelf()
+
+} // end namespace itk
+
+#endif // end #ifndef __itkExpressionImageFilter_txx_
@@ -0,0 +1,764 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#include "itkImageExpression.h"
+
+#include "itkMacro.h"
+#include "vnl/vnl_math.h"
+#include "itkBinaryFunctors.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+namespace itk
+{
+
+/** The maximum depth of the stack of the program. */
+static const unsigned int MaximumStackDepth = 64;
+
+/** The names of the instructions, in the order of OpCodeType. */
+static const char * const OpCodeNames[] = {
+  "push", "const",
+  "add", "subtract", "multiply", "divide", "mod", "pow",
+  "min", "max", "absdiff", "hypot", "atan2",
+  "less", "lessequal", "greater", "greaterequal", "equal", "notequal", "and", "or",
+  "negate", "not", "abs", "sqrt", "exp", "log", "log10", "sin", "cos", "tan",
+  "asin", "acos", "atan", "floor", "ceil", "round", "sign",
+  "select" };
+
+/** The scalar functions of the instructions that have no functor in
+ * itkBinaryFunctors.h. */
+static inline double ModuloFunction( double a, double b ) { return vcl_fmod( a, b ); }
+static inline double ArcTan2Function( double a, double b ) { return vcl_atan2( a, b ); }
+static inline double LessFunction( double a, double b ) { return a < b ? 1.0 : 0.0; }
+static inline double LessEqualFunction( double a, double b ) { return a <= b ? 1.0 : 0.0; }
+static inline double GreaterFunction( double a, double b ) { return a > b ? 1.0 : 0.0; }
+static inline double GreaterEqualFunction( double a, double b ) { return a >= b ? 1.0 : 0.0; }
+static inline double EqualFunction( double a, double b ) { return a == b ? 1.0 : 0.0; }
+static inline double NotEqualFunction( double a, double b ) { return a != b ? 1.0 : 0.0; }
+static inline double AndFunction( double a, double b ) { return ( a != 0.0 && b != 0.0 ) ? 1.0 : 0.0; }
+static inline double OrFunction( double a, double b ) { return ( a != 0.0 || b != 0.0 ) ? 1.0 : 0.0; }
+
+static inline double NegateFunction( double a ) { return -a; }
+static inline double NotFunction( double a ) { return a == 0.0 ? 1.0 : 0.0; }
+static inline double AbsFunction( double a ) { return a < 0.0 ? -a : a; }
+static inline double SqrtFunction( double a ) { return vcl_sqrt( a ); }
+static inline double ExpFunction( double a ) { return vcl_exp( a ); }
+static inline double LogFunction( double a ) { return vcl_log( a ); }
+static inline double Log10Function( double a ) { return vcl_log10( a ); }
+static inline double SinFunction( double a ) { return vcl_sin( a ); }
+static inline double CosFunction( double a ) { return vcl_cos( a ); }
+static inline double TanFunction( double a ) { return vcl_tan( a ); }
+static inline double ArcSinFunction( double a ) { return vcl_asin( a ); }
+static inline double ArcCosFunction( double a ) { return vcl_acos( a ); }
+static inline double ArcTanFunction( double a ) { return vcl_atan( a ); }
+static inline double FloorFunction( double a ) { return vcl_floor( a ); }
+static inline double CeilFunction( double a ) { return vcl_ceil( a ); }
+static inline double RoundFunction( double a ) { return vcl_floor( a + 0.5 ); }
+static inline double SignFunction( double a ) { return a > 0.0 ? 1.0 : ( a < 0.0 ? -1.0 : 0.0 ); }
+
+/** The loops of the instructions. */
+template< double (*TFunction)( double ) >
+static inline void ApplyUnary( const double * a, double * r, SizeValueType n )
+{
+  for( SizeValueType i = 0; i < n; ++i ) r[ i ] = TFunction( a[ i ] );
+}
+
+template< double (*TFunction)( double, double ) >
+static inline void ApplyBinary( const double * a, const double * b, double * r, SizeValueType n )
+{
+  for( SizeValueType i = 0; i < n; ++i ) r[ i ] = TFunction( a[ i ], b[ i ] );
+}
+
+template< class TFunctor >
+static inline void ApplyBinaryFunctor( const double * a, const double * b, double * r, SizeValueType n )
+{
+  TFunctor functor;
+  for( SizeValueType i = 0; i < n; ++i ) r[ i ] = functor( a[ i ], b[ i ] );
+}
+
+
+/**
+ * ******************* Constructor *******************
+ */
+
+ImageExpression::ImageExpression()
+{
+  this->m_StackDepth = 0;
+  this->m_MaximumStackDepth = 0;
+  this->m_Position = 0;
+
+} // end Constructor
+
+
+/**
+ * ******************* Parse *******************
+ */
+
+void
+ImageExpression::Parse( const std::string & expression,
+  const std::vector<std::string> & variableNames )
+{
+  this->m_Expression = expression;
+  this->m_VariableNames = variableNames;
+  this->m_Position = 0;
+  this->m_Program.clear();
+  this->m_StackDepth = 0;
+  this->m_MaximumStackDepth = 0;
+
+  this->ParseSelect();
+  this->SkipSpaces();
+  if( this->m_Position != this->m_Expression.size() )
+  {
+    this->ThrowError( "unexpected character" );
+  }
+
+} // end Parse()
+
+
+/**
+ * ******************* ParseSelect *******************
+ */
+
+void
+ImageExpression::ParseSelect( void )
+{
+  this->ParseOr();
+  if( this->Accept( "?" ) )
+  {
+    this->ParseSelect();
+    this->Expect( ":" );
+    this->ParseSelect();
+    this->Emit( Select );
+  }
+
+} // end ParseSelect()
+
+
+/**
+ * ******************* ParseOr *******************
+ */
+
+void
+ImageExpression::ParseOr( void )
+{
+  this->ParseAnd();
+  while( this->Accept( "||" ) )
+  {
+    this->ParseAnd();
+    this->Emit( Or );
+  }
+
+} // end ParseOr()
+
+
+/**
+ * ******************* ParseAnd *******************
+ */
+
+void
+ImageExpression::ParseAnd( void )
+{
+  this->ParseComparison();
+  while( this->Accept( "&&" ) )
+  {
+    this->ParseComparison();
+    this->Emit( And );
+  }
+
+} // end ParseAnd()
+
+
+/**
+ * ******************* ParseComparison *******************
+ */
+
+void
+ImageExpression::ParseComparison( void )
+{
+  this->ParseSum();
+  while( true )
+  {
+    /** The two character tokens first. */
+    OpCodeType opCode;
+    if( this->Accept( "==" ) ) opCode = Equal;
+    else if( this->Accept( "!=" ) ) opCode = NotEqual;
+    else if( this->Accept( "<=" ) ) opCode = LessEqual;
+    else if( this->Accept( ">=" ) ) opCode = GreaterEqual;
+    else if( this->Accept( "<" ) ) opCode = Less;
+    else if( this->Accept( ">" ) ) opCode = Greater;
+    else break;
+
+    this->ParseSum();
+    this->Emit( opCode );
+  }
+
+} // end ParseComparison()
+
+
+/**
+ * ******************* ParseSum *******************
+ */
+
+void
+ImageExpression::ParseSum( void )
+{
+  this->ParseProduct();
+  while( true )
+  {
+    OpCodeType opCode;
+    if( this->Accept( "+" ) ) opCode = Add;
+    else if( this->Accept( "-" ) ) opCode = Subtract;
+    else break;
+
+    this->ParseProduct();
+    this->Emit( opCode );
+  }
+
+} // end ParseSum()
+
+
+/**
+ * ******************* ParseProduct *******************
+ */
+
+void
+ImageExpression::ParseProduct( void )
+{
+  this->ParseUnary();
+  while( true )
+  {
+    OpCodeType opCode;
+    if( this->Accept( "*" ) ) opCode = Multiply;
+    else if( this->Accept( "/" ) ) opCode = Divide;
+    else if( this->Accept( "%" ) ) opCode = Modulo;
+    else break;
+
+    this->ParseUnary();
+    this->Emit( opCode );
+  }
+
+} // end ParseProduct()
+
+
+/**
+ * ******************* ParseUnary *******************
+ */
+
+void
+ImageExpression::ParseUnary( void )
+{
+  if( this->Accept( "-" ) )
+  {
+    this->ParseUnary();
+    this->Emit( Negate );
+  }
+  else if( this->Accept( "+" ) )
+  {
+    this->ParseUnary();
+  }
+  else if( this->Accept( "!" ) )
+  {
+    this->ParseUnary();
+    this->Emit( Not );
+  }
+  else
+  {
+    this->ParsePower();
+  }
+
+} // end ParseUnary()
+
+
+/**
+ * ******************* ParsePower *******************
+ */
+
+void
+ImageExpression::ParsePower( void )
+{
+  this->ParsePrimary();
+
+  /** Right associative, and -a^b is -(a^b), a^-b is a^(-b). */
+  if( this->Accept( "^" ) )
+  {
+    this->ParseUnary();
+    this->Emit( Power );
+  }
+
+} // end ParsePower()
+
+
+/**
+ * ******************* ParsePrimary *******************
+ */
+
+void
+ImageExpression::ParsePrimary( void )
+{
+  this->SkipSpaces();
+  if( this->m_Position >= this->m_Expression.size() )
+  {
+    this->ThrowError( "unexpected end of the expression" );
+  }
+
+  /** A subexpression. */
+  if( this->Accept( "(" ) )
+  {
+    this->ParseSelect();
+    this->Expect( ")" );
+    return;
+  }
+
+  /** A number. */
+  const char * begin = this->m_Expression.c_str() + this->m_Position;
+  const char c = *begin;
+  if( std::isdigit( static_cast<unsigned char>( c ) ) || c == '.' )
+  {
+    char * end = 0;
+    const double value = std::strtod( begin, &end );
+    if( end == begin ) this->ThrowError( "invalid number" );
+    this->m_Position += end - begin;
+    this->Emit( PushConstant, 0, value );
+    return;
+  }
+
+  /** A name. */
+  if( !std::isalpha( static_cast<unsigned char>( c ) ) && c != '_' )
+  {
+    this->ThrowError( "expected a number, a name or (" );
+  }
+  const std::string::size_type nameBegin = this->m_Position;
+  while( this->m_Position < this->m_Expression.size()
+    && ( std::isalnum( static_cast<unsigned char>( this->m_Expression[ this->m_Position ] ) )
+    || this->m_Expression[ this->m_Position ] == '_' ) )
+  {
+    ++this->m_Position;
+  }
+  const std::string name = this->m_Expression.substr(
+    nameBegin, this->m_Position - nameBegin );
+
+  /** A variable, which takes precedence over the constants and functions. */
+  for( unsigned int j = 0; j < this->m_VariableNames.size(); ++j )
+  {
+    if( this->m_VariableNames[ j ] == name )
+    {
+      this->Emit( PushVariable, j );
+      return;
+    }
+  }
+
+  /** A function. */
+  if( this->Accept( "(" ) )
+  {
+    unsigned int numberOfArguments = 0;
+    if( !this->Accept( ")" ) )
+    {
+      do
+      {
+        this->ParseSelect();
+        ++numberOfArguments;
+
+        /** min, max and mean of many arguments, pairwise. */
+        if( numberOfArguments > 1 )
+        {
+          if( name == "min" ) this->Emit( Minimum );
+          else if( name == "max" ) this->Emit( Maximum );
+          else if( name == "mean" ) this->Emit( Add );
+        }
+      } while( this->Accept( "," ) );
+      this->Expect( ")" );
+    }
+
+    struct FunctionType { const char * m_Name; OpCodeType m_OpCode; unsigned int m_Arguments; };
+    static const FunctionType functions[] = {
+      { "abs", Abs, 1 }, { "sqrt", Sqrt, 1 }, { "exp", Exp, 1 },
+      { "log", Log, 1 }, { "ln", Log, 1 }, { "log10", Log10, 1 },
+      { "sin", Sin, 1 }, { "cos", Cos, 1 }, { "tan", Tan, 1 },
+      { "asin", ArcSin, 1 }, { "acos", ArcCos, 1 }, { "atan", ArcTan, 1 },
+      { "floor", Floor, 1 }, { "ceil", Ceil, 1 }, { "round", Round, 1 },
+      { "sign", Sign, 1 },
+      { "pow", Power, 2 }, { "mod", Modulo, 2 }, { "atan2", ArcTan2, 2 },
+      { "absdiff", AbsoluteDifference, 2 }, { "hypot", Magnitude, 2 } };
+
+    if( name == "min" || name == "max" || name == "mean" )
+    {
+      if( numberOfArguments < 1 )
+      {
+        this->ThrowError( "function " + name + " needs at least one argument" );
+      }
+      if( name == "mean" && numberOfArguments > 1 )
+      {
+        this->Emit( PushConstant, 0, static_cast<double>( numberOfArguments ) );
+        this->Emit( Divide );
+      }
+      return;
+    }
+    for( unsigned int f = 0; f < sizeof( functions ) / sizeof( FunctionType ); ++f )
+    {
+      if( name == functions[ f ].m_Name )
+      {
+        if( numberOfArguments != functions[ f ].m_Arguments )
+        {
+          std::ostringstream message;
+          message << "function " << name << " takes "
+            << functions[ f ].m_Arguments << " argument(s)";
+          this->ThrowError( message.str() );
+        }
+        this->Emit( functions[ f ].m_OpCode );
+        return;
+      }
+    }
+    this->ThrowError( "unknown function " + name );
+  }
+
+  /** A constant. */
+  if( name == "pi" )
+  {
+    this->Emit( PushConstant, 0, vnl_math::pi );
+    return;
+  }
+
+  this->ThrowError( "unknown variable " + name );
+
+} // end ParsePrimary()
+
+
+/**
+ * ******************* SkipSpaces *******************
+ */
+
+void
+ImageExpression::SkipSpaces( void )
+{
+  while( this->m_Position < this->m_Expression.size()
+    && std::isspace( static_cast<unsigned char>( this->m_Expression[ this->m_Position ] ) ) )
+  {
+    ++this->m_Position;
+  }
+
+} // end SkipSpaces()
+
+
+/**
+ * ******************* Accept *******************
+ */
+
+bool
+ImageExpression::Accept( const char * token )
+{
+  this->SkipSpaces();
+  const std::string::size_type length = std::strlen( token );
+  if( this->m_Expression.compare( this->m_Position, length, token ) != 0 )
+  {
+    return false;
+  }
+
+  /** Do not take the first character of a two character operator. */
+  if( length == 1 && this->m_Position + 1 < this->m_Expression.size() )
+  {
+    const char next = this->m_Expression[ this->m_Position + 1 ];
+    if( ( token[ 0 ] == '<' || token[ 0 ] == '>' || token[ 0 ] == '!' ) && next == '=' )
+    {
+      return false;
+    }
+  }
+
+  this->m_Position += length;
+  return true;
+
+} // end Accept()
+
+
+/**
+ * ******************* Expect *******************
+ */
+
+void
+ImageExpression::Expect( const char * token )
+{
+  if( !this->Accept( token ) )
+  {
+    this->ThrowError( std::string( "expected " ) + token );
+  }
+
+} // end Expect()
+
+
+/**
+ * ******************* ThrowError *******************
+ */
+
+void
+ImageExpression::ThrowError( const std::string & message ) const
+{
+  itkGenericExceptionMacro( << "Error in the expression \"" << this->m_Expression
+    << "\" at position " << this->m_Position << ": " << message << "." );
+
+} // end ThrowError()
+
+
+/**
+ * ******************* GetNumberOfOperands *******************
+ */
+
+unsigned int
+ImageExpression::GetNumberOfOperands( OpCodeType opCode )
+{
+  if( opCode == PushVariable || opCode == PushConstant ) return 0;
+  if( opCode == Select ) return 3;
+  if( opCode >= Negate ) return 1;
+  return 2;
+
+} // end GetNumberOfOperands()
+
+
+/**
+ * ******************* Emit *******************
+ */
+
+void
+ImageExpression::Emit( OpCodeType opCode, unsigned int variable, double value )
+{
+  Instruction instruction;
+  instruction.m_OpCode = opCode;
+  instruction.m_Variable = variable;
+  instruction.m_Value = value;
+
+  const unsigned int operands = GetNumberOfOperands( opCode );
+  if( operands == 0 )
+  {
+    if( ++this->m_StackDepth > MaximumStackDepth )
+    {
+      this->ThrowError( "the expression is nested too deeply" );
+    }
+    this->m_MaximumStackDepth
+      = std::max( this->m_MaximumStackDepth, this->m_StackDepth );
+    this->m_Program.push_back( instruction );
+    return;
+  }
+  this->m_StackDepth -= operands - 1;
+
+  /** Fold the instruction if all its operands are constants. */
+  const std::vector<Instruction>::size_type size = this->m_Program.size();
+  bool constant = true;
+  for( unsigned int k = 1; k <= operands; ++k )
+  {
+    constant &= this->m_Program[ size - k ].m_OpCode == PushConstant;
+  }
+  if( !constant )
+  {
+    this->m_Program.push_back( instruction );
+    return;
+  }
+
+  this->m_Program.push_back( instruction );
+  std::vector<double> workspace( operands * GetBlockLength() );
+  double result = 0.0;
+  this->Execute( &this->m_Program[ size - operands ], &this->m_Program[ 0 ] + size + 1,
+    std::vector<const double *>(), &result, 1, &workspace[ 0 ] );
+  this->m_Program.resize( size - operands + 1 );
+  this->m_Program.back().m_OpCode = PushConstant;
+  this->m_Program.back().m_Variable = 0;
+  this->m_Program.back().m_Value = result;
+
+} // end Emit()
+
+
+/**
+ * ******************* IsVariableUsed *******************
+ */
+
+bool
+ImageExpression::IsVariableUsed( unsigned int j ) const
+{
+  for( std::vector<Instruction>::size_type i = 0; i < this->m_Program.size(); ++i )
+  {
+    if( this->m_Program[ i ].m_OpCode == PushVariable
+      && this->m_Program[ i ].m_Variable == j )
+    {
+      return true;
+    }
+  }
+  return false;
+
+} // end IsVariableUsed()
+
+
+/**
+ * ******************* Evaluate *******************
+ */
+
+void
+ImageExpression::Evaluate( const std::vector<const double *> & inputs,
+  double * output, SizeValueType n, double * workspace ) const
+{
+  this->Execute( &this->m_Program[ 0 ], &this->m_Program[ 0 ] + this->m_Program.size(),
+    inputs, output, n, workspace );
+
+} // end Evaluate()
+
+
+/**
+ * ******************* Execute *******************
+ */
+
+void
+ImageExpression::Execute( const Instruction * begin, const Instruction * end,
+  const std::vector<const double *> & inputs, double * output,
+  SizeValueType n, double * workspace ) const
+{
+  typedef itk::Functor::ADDITION<double, double, double>            AdditionType;
+  typedef itk::Functor::MINUS<double, double, double>               MinusType;
+  typedef itk::Functor::TIMES<double, double, double>               TimesType;
+  typedef itk::Functor::DIVIDE<double, double, double>              DivideType;
+  typedef itk::Functor::POWER<double, double, double>               PowerType;
+  typedef itk::Functor::MINIMUM<double, double, double>             MinimumType;
+  typedef itk::Functor::MAXIMUM<double, double, double>             MaximumType;
+  typedef itk::Functor::ABSOLUTEDIFFERENCE<double, double, double>  AbsoluteDifferenceType;
+  typedef itk::Functor::BINARYMAGNITUDE<double, double, double>     MagnitudeType;
+
+  /** The stack points to the variables or to the slots of the workspace,
+   * one block per stack level. The two extra entries are the unused
+   * operands of the instructions at the top. */
+  const SizeValueType blockLength = GetBlockLength();
+  const double * stack[ MaximumStackDepth + 2 ] = { 0 };
+  unsigned int top = 0;
+
+  for( const Instruction * instruction = begin; instruction != end; ++instruction )
+  {
+    if( instruction->m_OpCode == PushVariable )
+    {
+      stack[ top++ ] = inputs[ instruction->m_Variable ];
+      continue;
+    }
+
+    /** The result is stored in the slot of the first operand. */
+    top -= GetNumberOfOperands( instruction->m_OpCode );
+    double * r = workspace + top * blockLength;
+    const double * a = stack[ top ];
+    const double * b = stack[ top + 1 ];
+    const double * c = stack[ top + 2 ];
+
+    switch( instruction->m_OpCode )
+    {
+      case PushConstant:
+        std::fill( r, r + n, instruction->m_Value );
+        break;
+      case Add: ApplyBinaryFunctor<AdditionType>( a, b, r, n ); break;
+      case Subtract: ApplyBinaryFunctor<MinusType>( a, b, r, n ); break;
+      case Multiply: ApplyBinaryFunctor<TimesType>( a, b, r, n ); break;
+      case Divide: ApplyBinaryFunctor<DivideType>( a, b, r, n ); break;
+      case Power: ApplyBinaryFunctor<PowerType>( a, b, r, n ); break;
+      case Minimum: ApplyBinaryFunctor<MinimumType>( a, b, r, n ); break;
+      case Maximum: ApplyBinaryFunctor<MaximumType>( a, b, r, n ); break;
+      case AbsoluteDifference: ApplyBinaryFunctor<AbsoluteDifferenceType>( a, b, r, n ); break;
+      case Magnitude: ApplyBinaryFunctor<MagnitudeType>( a, b, r, n ); break;
+      case Modulo: ApplyBinary<ModuloFunction>( a, b, r, n ); break;
+      case ArcTan2: ApplyBinary<ArcTan2Function>( a, b, r, n ); break;
+      case Less: ApplyBinary<LessFunction>( a, b, r, n ); break;
+      case LessEqual: ApplyBinary<LessEqualFunction>( a, b, r, n ); break;
+      case Greater: ApplyBinary<GreaterFunction>( a, b, r, n ); break;
+      case GreaterEqual: ApplyBinary<GreaterEqualFunction>( a, b, r, n ); break;
+      case Equal: ApplyBinary<EqualFunction>( a, b, r, n ); break;
+      case NotEqual: ApplyBinary<NotEqualFunction>( a, b, r, n ); break;
+      case And: ApplyBinary<AndFunction>( a, b, r, n ); break;
+      case Or: ApplyBinary<OrFunction>( a, b, r, n ); break;
+      case Negate: ApplyUnary<NegateFunction>( a, r, n ); break;
+      case Not: ApplyUnary<NotFunction>( a, r, n ); break;
+      case Abs: ApplyUnary<AbsFunction>( a, r, n ); break;
+      case Sqrt: ApplyUnary<SqrtFunction>( a, r, n ); break;
+      case Exp: ApplyUnary<ExpFunction>( a, r, n ); break;
+      case Log: ApplyUnary<LogFunction>( a, r, n ); break;
+      case Log10: ApplyUnary<Log10Function>( a, r, n ); break;
+      case Sin: ApplyUnary<SinFunction>( a, r, n ); break;
+      case Cos: ApplyUnary<CosFunction>( a, r, n ); break;
+      case Tan: ApplyUnary<TanFunction>( a, r, n ); break;
+      case ArcSin: ApplyUnary<ArcSinFunction>( a, r, n ); break;
+      case ArcCos: ApplyUnary<ArcCosFunction>( a, r, n ); break;
+      case ArcTan: ApplyUnary<ArcTanFunction>( a, r, n ); break;
+      case Floor: ApplyUnary<FloorFunction>( a, r, n ); break;
+      case Ceil: ApplyUnary<CeilFunction>( a, r, n ); break;
+      case Round: ApplyUnary<RoundFunction>( a, r, n ); break;
+      case Sign: ApplyUnary<SignFunction>( a, r, n ); break;
+      case Select:
+        for( SizeValueType i = 0; i < n; ++i )
+        {
+          r[ i ] = a[ i ] != 0.0 ? b[ i ] : c[ i ];
+        }
+        break;
+      default:
+        break;
+    }
+    stack[ top++ ] = r;
+  }
+
+  std::copy( stack[ 0 ], stack[ 0 ] + n, output );
+
+} // end Execute()
+
+
+/**
+ * ******************* GetProgramAsString *******************
+ */
+
+std::string
+ImageExpression::GetProgramAsString( void ) const
+{
+  std::ostringstream program;
+  for( std::vector<Instruction>::size_type i = 0; i < this->m_Program.size(); ++i )
+  {
+    const Instruction & instruction = this->m_Program[ i ];
+    program << OpCodeNames[ instruction.m_OpCode ];
+    if( instruction.m_OpCode == PushVariable )
+    {
+      program << " " << this->m_VariableNames[ instruction.m_Variable ];
+    }
+    else if( instruction.m_OpCode == PushConstant )
+    {
+      program << " " << instruction.m_Value;
+    }
+    program << "\n";
+  }
+  return program.str();
+
+} // end GetProgramAsString()
+
+
+/**
+ * ******************* GetHelpString *******************
+ */
+
+std::string
+ImageExpression::GetHelpString( void )
+{
+  std::ostringstream ss;
+  ss << "operators, from low to high precedence:\n"
+    << "  c ? x : y, ||, &&, == != < <= > >=, + -, * / %, -x !x, x ^ y\n"
+    << "functions:\n"
+    << "  abs, sqrt, exp, log (ln), log10, sin, cos, tan, asin, acos, atan,\n"
+    << "  floor, ceil, round, sign, pow( x, y ), mod( x, y ), atan2( y, x ),\n"
+    << "  absdiff( x, y ), hypot( x, y ), min( ... ), max( ... ), mean( ... )\n"
+    << "constants: numbers and pi";
+  return ss.str();
+
+} // end GetHelpString()
+
+} // end namespace itk
@@ -0,0 +1,148 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkImageExpression_h_
+#define __itkImageExpression_h_
+
+#include "itkIntTypes.h"
+#include <string>
+#include <vector>
+
+namespace itk
+{
+
+/** \class ImageExpression
+ * \brief An arithmetic and logical expression over named images, compiled
+ * to a program that is evaluated on blocks of pixels.
+ *
+ * The expression is parsed once into a postfix program for a stack
+ * machine. Every instruction works on a whole block of pixels at a time,
+ * so that the cost of dispatching an instruction is shared by the pixels
+ * of the block, and the loop of an instruction is a simple loop that the
+ * compiler vectorizes. A formula like (a-b)*mask/c+1 is thus computed in
+ * one pass over the images, without temporary images. Subexpressions of
+ * constants are folded when the expression is parsed.
+ *
+ * The syntax, from low to high precedence:
+ *   c ? x : y                 select
+ *   ||  &&                    logical or, and
+ *   ==  !=  <  <=  >  >=      comparisons, 1 if true, 0 otherwise
+ *   +  -                      addition, subtraction
+ *   *  /  %                   multiplication, division, modulo
+ *   -x  !x                    negation, logical not
+ *   x ^ y                     power, right associative
+ *   f( x ), f( x, y )         functions, see GetHelpString()
+ * and numbers, variable names and the constant pi. Division by zero gives
+ * the largest double, as for pxbinaryimageoperator.
+ */
+
+class ImageExpression
+{
+public:
+  ImageExpression();
+  ~ImageExpression() {};
+
+  /** Parse the expression over the variables. Throws an
+   * itk::ExceptionObject for a syntax error or an unknown name. */
+  void Parse( const std::string & expression,
+    const std::vector<std::string> & variableNames );
+
+  /** Evaluate the program for n pixels, n at most GetBlockLength().
+   * inputs[ j ] points to the n values of variable j. The workspace is
+   * GetWorkspaceSize() doubles, one per thread. */
+  void Evaluate( const std::vector<const double *> & inputs,
+    double * output, SizeValueType n, double * workspace ) const;
+
+  /** The number of pixels that Evaluate() processes at most at a time. */
+  static SizeValueType GetBlockLength( void ) { return 512; }
+
+  /** The size of the workspace that Evaluate() needs. */
+  SizeValueType GetWorkspaceSize( void ) const
+  { return this->m_MaximumStackDepth * GetBlockLength(); }
+
+  /** Whether a variable is used in the expression. */
+  bool IsVariableUsed( unsigned int j ) const;
+
+  /** The program, one instruction per line, for debugging. */
+  std::string GetProgramAsString( void ) const;
+
+  /** The list of the operators and functions. */
+  static std::string GetHelpString( void );
+
+protected:
+
+  /** The instructions of the stack machine. */
+  enum OpCodeType {
+    PushVariable, PushConstant,
+    Add, Subtract, Multiply, Divide, Modulo, Power,
+    Minimum, Maximum, AbsoluteDifference, Magnitude, ArcTan2,
+    Less, LessEqual, Greater, GreaterEqual, Equal, NotEqual, And, Or,
+    Negate, Not, Abs, Sqrt, Exp, Log, Log10, Sin, Cos, Tan,
+    ArcSin, ArcCos, ArcTan, Floor, Ceil, Round, Sign,
+    Select };
+
+  struct Instruction
+  {
+    OpCodeType    m_OpCode;
+    unsigned int  m_Variable;
+    double        m_Value;
+  };
+
+  /** The recursive descent parser, one function per precedence level. */
+  void ParseSelect( void );
+  void ParseOr( void );
+  void ParseAnd( void );
+  void ParseComparison( void );
+  void ParseSum( void );
+  void ParseProduct( void );
+  void ParseUnary( void );
+  void ParsePower( void );
+  void ParsePrimary( void );
+
+  /** Skip spaces, and accept the token if it is next. */
+  bool Accept( const char * token );
+  void Expect( const char * token );
+  void SkipSpaces( void );
+  void ThrowError( const std::string & message ) const;
+
+  /** Append an instruction, after folding constant operands. */
+  void Emit( OpCodeType opCode, unsigned int variable = 0, double value = 0.0 );
+
+  /** The number of operands of an instruction. */
+  static unsigned int GetNumberOfOperands( OpCodeType opCode );
+
+  /** Run the instructions [begin, end) on the stack. */
+  void Execute( const Instruction * begin, const Instruction * end,
+    const std::vector<const double *> & inputs, double * output,
+    SizeValueType n, double * workspace ) const;
+
+private:
+
+  std::vector<Instruction>  m_Program;
+  std::vector<std::string>  m_VariableNames;
+  unsigned int              m_StackDepth;
+  unsigned int              m_MaximumStackDepth;
+
+  /** The state of the parser. */
+  std::string               m_Expression;
+  std::string::size_type    m_Position;
+
+}; // end class ImageExpression
+
+} // end namespace itk
+
+#endif // end #ifndef __itkImageExpression_h_
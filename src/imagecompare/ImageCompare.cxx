@@ -25,6 +25,7 @@
 #include "itkUseMevisDicomTiff.h"
 
 #include "itkCommandLineArgumentParser.h"
+#include "ITKToolsChecksum.h"
 #include "ITKToolsHelpers.h"
 
 #include "itkNumericTraits.h"
@@ -37,6 +38,8 @@
 
 #include "itkImageSource.h" // This should not be necessary after ITK patch is merged
 #include "itkTestingComparisonImageFilter.h"
+#include "itkMultiThreader.h"
+#include <cmath>
 
 
 /**
@@ -50,7 +53,27 @@ std::string GetHelpString( void )
     << "Usage:\n"
     << "pximagecompare\n"
     << "  -test      image filename to test against baseline\n"
-    << "  -base      baseline image filename";
+    << "  -base      baseline image filename\n"
+    << "  [-checksum] compare the checksums of the pixel data first; if they\n"
+    << "             are equal, the images are equal without a full comparison\n"
+    << "  [-testchecksum] known checksum of the test image\n"
+    << "  [-basechecksum] known checksum of the baseline image\n"
+    << "  [-cache]   keep and reuse the checksums in filename.checksum\n"
+    << "  [-tolerance] the largest absolute difference of equal pixels; default 0\n"
+    << "  [-earlyexit] stop at the first slab with a difference beyond the\n"
+    << "             tolerance, without counting the differences or writing\n"
+    << "             a difference image\n"
+    << "  [-types]   the component types should be equal as well\n"
+    << "  [-streams] the number of slabs the images are compared in;\n"
+    << "             default: slabs of about 256 MB per image\n"
+    << "The checksums are those of pxgetimageinformation -checksum. Different\n"
+    << "checksums do not mean different images, e.g. when the component\n"
+    << "types differ, so then the images are compared as usual.\n"
+    << "The headers are compared first: images whose sizes or numbers of\n"
+    << "components differ are not read. The pixels are then compared slab by\n"
+    << "slab, in parallel. Only when differences are found is the whole image\n"
+    << "compared again, to count them and write the difference image\n"
+    << "test_DIFF.ext.";
   return ss.str();
 
 } // end GetHelpString()
@@ -61,6 +84,158 @@ std::string GetHelpString( void )
 // must be compared, change this variable.
 static const unsigned int ITK_TEST_DIMENSION_MAX = 6;
 
+typedef itk::Image<double,ITK_TEST_DIMENSION_MAX>           ImageType;
+
+
+/**
+ * ******************* CompareStruct *******************
+ */
+
+struct CompareStruct
+{
+  const double *              m_Test;
+  const double *              m_Baseline;
+  std::size_t                 m_NumberOfPixels;
+  double                      m_Tolerance;
+  bool                        m_EarlyExit;
+  std::vector<std::size_t>    m_NumberOfDifferences;
+  volatile bool               m_Stop;
+};
+
+
+/**
+ * ******************* CompareThreaderCallback *******************
+ * Every thread counts the differences beyond the tolerance in a
+ * contiguous part of the buffers, in chunks. With early exit the threads
+ * stop after the chunk in which any thread found a difference.
+ */
+
+ITK_THREAD_RETURN_TYPE CompareThreaderCallback( void * arg )
+{
+  itk::MultiThreader::ThreadInfoStruct * info
+    = static_cast<itk::MultiThreader::ThreadInfoStruct *>( arg );
+  CompareStruct * data = static_cast<CompareStruct *>( info->UserData );
+
+  const std::size_t n = data->m_NumberOfPixels;
+  const std::size_t begin = n * info->ThreadID / info->NumberOfThreads;
+  const std::size_t end = n * ( info->ThreadID + 1 ) / info->NumberOfThreads;
+  const std::size_t chunkSize = 1 << 16;
+  const double tolerance = data->m_Tolerance;
+
+  std::size_t numberOfDifferences = 0;
+  for( std::size_t chunk = begin; chunk < end && !data->m_Stop; chunk += chunkSize )
+  {
+    const std::size_t chunkEnd = std::min( end, chunk + chunkSize );
+    for( std::size_t i = chunk; i < chunkEnd; ++i )
+    {
+      if( std::abs( data->m_Test[ i ] - data->m_Baseline[ i ] ) > tolerance )
+      {
+        ++numberOfDifferences;
+      }
+    }
+    if( numberOfDifferences > 0 && data->m_EarlyExit ) data->m_Stop = true;
+  }
+  data->m_NumberOfDifferences[ info->ThreadID ] = numberOfDifferences;
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end CompareThreaderCallback()
+
+
+/**
+ * ******************* ReadSlab *******************
+ * Only the slab is read, if the image format supports it.
+ */
+
+ImageType::Pointer ReadSlab( const std::string & fileName,
+  const ImageType::RegionType & slab )
+{
+  typedef itk::ImageFileReader<ImageType>                     ReaderType;
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( fileName );
+  reader->UpdateOutputInformation();
+  reader->GetOutput()->SetRequestedRegion( slab );
+  reader->Update();
+  ImageType::Pointer image = reader->GetOutput();
+  image->DisconnectPipeline();
+  return image;
+
+} // end ReadSlab()
+
+
+/**
+ * ******************* StreamedCompare *******************
+ * Compare the images slab by slab along the last dimension, in parallel
+ * within a slab. Returns the number of differences, or with early exit
+ * a nonzero number as soon as a slab differs.
+ */
+
+std::size_t StreamedCompare(
+  const std::string & testImageFileName,
+  const std::string & baselineImageFileName,
+  const ImageType::SizeType & size,
+  double tolerance, bool earlyExit, unsigned int numberOfSlabs )
+{
+  /** The last dimension that is not 1. */
+  unsigned int slabDimension = 0;
+  for( unsigned int i = 0; i < ITK_TEST_DIMENSION_MAX; ++i )
+  {
+    if( size[ i ] > 1 ) slabDimension = i;
+  }
+  const itk::SizeValueType slabLength = size[ slabDimension ];
+  if( numberOfSlabs == 0 )
+  {
+    double megaBytes = sizeof( double );
+    for( unsigned int i = 0; i < ITK_TEST_DIMENSION_MAX; ++i ) megaBytes *= size[ i ];
+    megaBytes /= 1024.0 * 1024.0;
+    numberOfSlabs = static_cast<unsigned int>( std::ceil( megaBytes / 256.0 ) );
+  }
+  numberOfSlabs = static_cast<unsigned int>( std::max( itk::SizeValueType( 1 ),
+    std::min( itk::SizeValueType( numberOfSlabs ), slabLength ) ) );
+
+  CompareStruct data;
+  data.m_Tolerance = tolerance;
+  data.m_EarlyExit = earlyExit;
+  data.m_Stop = false;
+
+  std::size_t numberOfDifferences = 0;
+  for( unsigned int s = 0; s < numberOfSlabs; ++s )
+  {
+    const itk::SizeValueType slabBegin = slabLength * s / numberOfSlabs;
+    const itk::SizeValueType slabEnd = slabLength * ( s + 1 ) / numberOfSlabs;
+    ImageType::IndexType index;
+    index.Fill( 0 );
+    index[ slabDimension ] = slabBegin;
+    ImageType::SizeType slabSize = size;
+    slabSize[ slabDimension ] = slabEnd - slabBegin;
+    const ImageType::RegionType slab( index, slabSize );
+
+    ImageType::Pointer test = ReadSlab( testImageFileName, slab );
+    ImageType::Pointer baseline = ReadSlab( baselineImageFileName, slab );
+
+    /** The readers may buffer more than the slab, which is contiguous
+     * in the buffer nonetheless. */
+    data.m_Test = test->GetBufferPointer() + test->ComputeOffset( index );
+    data.m_Baseline = baseline->GetBufferPointer() + baseline->ComputeOffset( index );
+    data.m_NumberOfPixels = slab.GetNumberOfPixels();
+
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    data.m_NumberOfDifferences.assign( threader->GetNumberOfThreads(), 0 );
+    threader->SetSingleMethod( CompareThreaderCallback, &data );
+    threader->SingleMethodExecute();
+    for( std::size_t t = 0; t < data.m_NumberOfDifferences.size(); ++t )
+    {
+      numberOfDifferences += data.m_NumberOfDifferences[ t ];
+    }
+    if( earlyExit && numberOfDifferences > 0 ) break;
+  }
+
+  return numberOfDifferences;
+
+} // end StreamedCompare()
+
+
 int main( int argc, char **argv )
 {
   RegisterMevisDicomTiff();
@@ -83,14 +258,111 @@ int main( int argc, char **argv )
     return EXIT_SUCCESS;
   }
 
+  /** Threading. */
+  itktools::ReadThreadingArguments( parser );
+
   std::string testImageFileName;
   parser->GetCommandLineArgument( "-test", testImageFileName );
 
   std::string baselineImageFileName;
   parser->GetCommandLineArgument( "-base", baselineImageFileName );
 
+  /** Equal checksums of the pixel data short-cut the comparison. */
+  if( parser->ArgumentExists( "-checksum" ) )
+  {
+    const bool useCacheFile = parser->ArgumentExists( "-cache" );
+    std::string testChecksum = "";
+    std::string baselineChecksum = "";
+    std::string errorMessage = "";
+    parser->GetCommandLineArgument( "-testchecksum", testChecksum );
+    parser->GetCommandLineArgument( "-basechecksum", baselineChecksum );
+    if( ( testChecksum != "" || itktools::GetImageChecksum(
+        testImageFileName, useCacheFile, testChecksum, errorMessage ) )
+      && ( baselineChecksum != "" || itktools::GetImageChecksum(
+        baselineImageFileName, useCacheFile, baselineChecksum, errorMessage ) )
+      && testChecksum == baselineChecksum )
+    {
+      return EXIT_SUCCESS;
+    }
+  }
+
+  /** Compare the headers first. */
+  itk::ImageIOBase::IOPixelType testPixelType, baselinePixelType;
+  itk::ImageIOBase::IOComponentType testComponentType, baselineComponentType;
+  unsigned int testDimension = 0, baselineDimension = 0;
+  unsigned int testNumberOfComponents = 0, baselineNumberOfComponents = 0;
+  std::vector<unsigned int> testImageSize, baselineImageSize;
+  if( !itktools::GetImageProperties( testImageFileName, testPixelType, testComponentType,
+      testDimension, testNumberOfComponents, testImageSize )
+    || !itktools::GetImageProperties( baselineImageFileName, baselinePixelType,
+      baselineComponentType, baselineDimension, baselineNumberOfComponents, baselineImageSize ) )
+  {
+    return EXIT_FAILURE;
+  }
+  if( testDimension > ITK_TEST_DIMENSION_MAX || baselineDimension > ITK_TEST_DIMENSION_MAX )
+  {
+    std::cerr << "The images have more than " << ITK_TEST_DIMENSION_MAX
+      << " dimensions!" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  /** The sizes in 6D, as the images are read. */
+  ImageType::SizeType headerTestSize, headerBaselineSize;
+  headerTestSize.Fill( 1 );
+  headerBaselineSize.Fill( 1 );
+  for( unsigned int i = 0; i < testDimension; ++i ) headerTestSize[ i ] = testImageSize[ i ];
+  for( unsigned int i = 0; i < baselineDimension; ++i ) headerBaselineSize[ i ] = baselineImageSize[ i ];
+  if( headerTestSize != headerBaselineSize )
+  {
+    std::cerr << "The size of the Baseline image and Test image do not match!" << std::endl;
+    std::cerr << "Baseline image: " << baselineImageFileName
+      << " has size " << headerBaselineSize << std::endl;
+    std::cerr << "Test image:     " << testImageFileName
+      << " has size " << headerTestSize << std::endl;
+    return EXIT_FAILURE;
+  }
+  if( testNumberOfComponents != baselineNumberOfComponents )
+  {
+    std::cerr << "The number of components of the Baseline image ("
+      << baselineNumberOfComponents << ") and Test image ("
+      << testNumberOfComponents << ") do not match!" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if( parser->ArgumentExists( "-types" ) && testComponentType != baselineComponentType )
+  {
+    std::cerr << "The component type of the Baseline image ("
+      << itk::ImageIOBase::GetComponentTypeAsString( baselineComponentType )
+      << ") and Test image ("
+      << itk::ImageIOBase::GetComponentTypeAsString( testComponentType )
+      << ") do not match!" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  /** Compare the pixels, streamed, stopping early if asked. Only images
+   * that differ are compared again below, for the difference image. */
+  double tolerance = 0.0;
+  parser->GetCommandLineArgument( "-tolerance", tolerance );
+  const bool earlyExit = parser->ArgumentExists( "-earlyexit" );
+  unsigned int numberOfSlabs = 0;
+  parser->GetCommandLineArgument( "-streams", numberOfSlabs );
+  try
+  {
+    const std::size_t numberOfDifferences = StreamedCompare( testImageFileName,
+      baselineImageFileName, headerTestSize, tolerance, earlyExit, numberOfSlabs );
+    if( numberOfDifferences == 0 ) return EXIT_SUCCESS;
+    if( earlyExit )
+    {
+      std::cerr << "The images differ!" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  catch( itk::ExceptionObject & excp )
+  {
+    std::cerr << "Error during comparing image: " << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
   // Read images
-  typedef itk::Image<double,ITK_TEST_DIMENSION_MAX>           ImageType;
   typedef itk::ImageFileReader<ImageType>                     ReaderType;
 
   // Read the baseline file
@@ -138,6 +410,7 @@ int main( int argc, char **argv )
   // Now compare the two images
   typedef itk::Testing::ComparisonImageFilter< ImageType, ImageType > ComparisonFilterType;
   ComparisonFilterType::Pointer comparisonFilter = ComparisonFilterType::New();
+  comparisonFilter->SetDifferenceThreshold( tolerance );
   comparisonFilter->SetTestInput(testReader->GetOutput());
   comparisonFilter->SetValidInput(baselineReader->GetOutput());
   try
@@ -39,7 +39,7 @@ std::string GetHelpString( void )
   ss << "ITKTools v" << itktools::GetITKToolsVersion() << "\n"
     << "Usage:\n"
     << "pximagetovectorimage\n"
-    << "  -in      inputFilenames, at least 2\n"
+    << "  -in      inputFilenames, at least 2; use @file to read them from a manifest\n"
     << "  [-out]   outputFilename, default VECTOR.mhd\n"
     << "  [-s]     number of streams, default 1.\n"
     << "Supported: 2D, 3D, (unsigned) char, (unsigned) short,\n"
@@ -78,6 +78,9 @@ int main( int argc, char ** argv )
   std::vector<std::string>  inputFileNames( 0, "" );
   parser->GetCommandLineArgument( "-in", inputFileNames );
 
+  /** Read the headers of all inputs before processing starts. */
+  if( !itktools::ValidateImageHeaders( inputFileNames ) ) return EXIT_FAILURE;
+
   std::string outputFileName = "VECTOR.mhd";
   parser->GetCommandLineArgument( "-out", outputFileName );
 
@@ -138,6 +141,7 @@ int main( int argc, char ** argv )
     filter->m_OutputFileName = outputFileName;
     filter->m_NumberOfStreams = numberOfStreams;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
@@ -21,9 +21,8 @@
 #include "ITKToolsBase.h"
 
 #include "itkImageFileReader.h"
-#include "itkImageToVectorImageFilter.h"
+#include "itkInterleaveVectorImagesFilter.h"
 #include "itkImageFileWriter.h"
-#include "itkVectorIndexSelectionCastImageFilter.h"
 
 
 /** \class ITKToolsImagesToVectorImageBase
@@ -39,7 +38,6 @@ public:
   ITKToolsImagesToVectorImageBase()
   {
     this->m_OutputFileName = "";
-    this->m_NumberOfStreams = 0;
   };
   /** Destructor. */
   ~ITKToolsImagesToVectorImageBase(){};
@@ -47,7 +45,9 @@ public:
   /** Input member parameters. */
   std::vector<std::string> m_InputFileNames;
   std::string m_OutputFileName;
-  unsigned int m_NumberOfStreams;
+
+  /** The inputs are read and interleaved region by region. */
+  virtual bool GetSupportsStreaming( void ) const { return true; }
 
 }; // end class ITKToolsImagesToVectorImageBase
 
@@ -74,59 +74,47 @@ public:
   {
     /** Typedef's. */
     typedef itk::VectorImage< TComponentType, VDimension >    VectorImageType;
-    typedef VectorImageType                                   OutputImageType;
     typedef itk::ImageFileReader< VectorImageType >           ReaderType;
-    typedef itk::Image< TComponentType, VDimension >          ScalarImageType;
+    typedef itk::InterleaveVectorImagesFilter<
+      VectorImageType >                                       InterleaveFilterType;
     typedef itk::ImageFileWriter< VectorImageType >           WriterType;
 
-    /** Read in the input images. */
+    /** Create the readers and the filter that interleaves their components.
+     * The inputs are read region by region, when the writer requests them.
+     */
+    typename InterleaveFilterType::Pointer interleaver = InterleaveFilterType::New();
     std::vector<typename ReaderType::Pointer> readers( this->m_InputFileNames.size() );
+    std::cout << "There are " << this->m_InputFileNames.size() << " input images." << std::endl;
     for( unsigned int i = 0; i < this->m_InputFileNames.size(); ++i )
     {
       readers[ i ] = ReaderType::New();
       readers[ i ]->SetFileName( this->m_InputFileNames[ i ] );
-      readers[ i ]->Update();
+      readers[ i ]->SetUseStreaming( true );
+      readers[ i ]->UpdateOutputInformation();
+      std::cout << "There are " << readers[ i ]->GetOutput()->GetNumberOfComponentsPerPixel()
+        << " components in image " << i << std::endl;
+      interleaver->SetInput( i, readers[ i ]->GetOutput() );
     }
 
-    /** Create assembler. */
-    typedef itk::ImageToVectorImageFilter< ScalarImageType > ImageToVectorImageFilterType;
-    typename ImageToVectorImageFilterType::Pointer imageToVectorImageFilter
-      = ImageToVectorImageFilterType::New();
-
-    // For each input image
-    std::cout << "There are " << this->m_InputFileNames.size() << " input images." << std::endl;
-    unsigned int currentOutputIndex = 0;
-    for( unsigned int inputImageIndex = 0; inputImageIndex < this->m_InputFileNames.size(); ++inputImageIndex )
-    {
-      typedef itk::VectorIndexSelectionCastImageFilter<VectorImageType, ScalarImageType> ComponentExtractionType;
-
-      // For each component of the current image
-      std::cout << "There are " << readers[inputImageIndex]->GetOutput()->GetNumberOfComponentsPerPixel()
-        << " components in image " << inputImageIndex << std::endl;
-      for( unsigned int component = 0;
-        component < readers[inputImageIndex]->GetOutput()->GetNumberOfComponentsPerPixel(); ++component )
-      {
-        typename ComponentExtractionType::Pointer componentExtractionFilter = ComponentExtractionType::New();
-        componentExtractionFilter->SetIndex( component );
-        componentExtractionFilter->SetInput( readers[inputImageIndex]->GetOutput() );
-        componentExtractionFilter->Update();
-
-        imageToVectorImageFilter->SetNthInput( currentOutputIndex, componentExtractionFilter->GetOutput());
-        currentOutputIndex++;
-      }
-    }
-
-    imageToVectorImageFilter->Update();
-
+    interleaver->UpdateOutputInformation();
     std::cout << "Output image has "
-      << imageToVectorImageFilter->GetOutput()->GetNumberOfComponentsPerPixel()
+      << interleaver->GetOutput()->GetNumberOfComponentsPerPixel()
       << " components." << std::endl;
 
     /** Write vector image. */
     typename WriterType::Pointer writer = WriterType::New();
     writer->SetFileName( this->m_OutputFileName );
-    writer->SetInput( imageToVectorImageFilter->GetOutput() );
-    writer->SetNumberOfStreamDivisions( this->m_NumberOfStreams );
+    writer->SetInput( interleaver->GetOutput() );
+    /** The buffers of the inputs are as large as the output. */
+    this->SetStreamingOnWriter( writer.GetPointer(), static_cast<double>(
+      interleaver->GetOutput()->GetNumberOfComponentsPerPixel() * sizeof( TComponentType ) ) );
+
+    for( unsigned int i = 0; i < readers.size(); ++i )
+    {
+      this->ObserveProcess( readers[ i ].GetPointer(), "read" );
+    }
+    this->ObserveProcess( interleaver.GetPointer(), "interleave" );
+    this->ObserveProcess( writer.GetPointer(), "write" );
     writer->Update();
 
   } // end Run()
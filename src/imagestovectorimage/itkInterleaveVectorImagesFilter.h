@@ -0,0 +1,95 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkInterleaveVectorImagesFilter_h_
+#define __itkInterleaveVectorImagesFilter_h_
+
+#include "itkImageToImageFilter.h"
+
+namespace itk
+{
+
+/** \class InterleaveVectorImagesFilter
+ * \brief Concatenate the components of several vector images.
+ *
+ * The output pixel consists of the components of the first input, followed
+ * by those of the second input, and so on. The components are copied
+ * straight from the input buffers into the interleaved output buffer, per
+ * scanline, without intermediate scalar images. The filter is region
+ * based, so the inputs are read and the output is written stream by
+ * stream if the writer streams.
+ *
+ * All inputs should have the same size; the output has the information of
+ * the first input.
+ *
+ * \ingroup IntensityImageFilters
+ */
+
+template< class TImage >
+class ITK_EXPORT InterleaveVectorImagesFilter :
+  public ImageToImageFilter< TImage, TImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef InterleaveVectorImagesFilter          Self;
+  typedef ImageToImageFilter< TImage, TImage >  Superclass;
+  typedef SmartPointer<Self>                    Pointer;
+  typedef SmartPointer<const Self>              ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( InterleaveVectorImagesFilter, ImageToImageFilter );
+
+  /** Typedefs. */
+  typedef TImage                                  ImageType;
+  typedef typename ImageType::InternalPixelType   InternalPixelType;
+  typedef typename ImageType::RegionType          RegionType;
+  typedef typename ImageType::IndexType           IndexType;
+  typedef typename Superclass::OutputImageRegionType OutputImageRegionType;
+
+  itkStaticConstMacro( ImageDimension, unsigned int, TImage::ImageDimension );
+
+protected:
+  InterleaveVectorImagesFilter() {};
+  virtual ~InterleaveVectorImagesFilter() {};
+
+  /** The number of components of the output is the sum of those of the
+   * inputs. */
+  virtual void GenerateOutputInformation( void );
+
+  /** Check that the inputs have the same size. */
+  virtual void BeforeThreadedGenerateData( void );
+
+  /** Copy the components of the inputs into the output. */
+  void ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+    ThreadIdType threadId );
+
+private:
+  InterleaveVectorImagesFilter( const Self & ); // purposely not implemented
+  void operator=( const Self & );               // purposely not implemented
+
+}; // end class InterleaveVectorImagesFilter
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkInterleaveVectorImagesFilter.txx"
+#endif
+
+#endif // end #ifndef __itkInterleaveVectorImagesFilter_h_
@@ -0,0 +1,137 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkInterleaveVectorImagesFilter_txx_
+#define __itkInterleaveVectorImagesFilter_txx_
+
+#include "itkInterleaveVectorImagesFilter.h"
+#include "itkProgressReporter.h"
+
+namespace itk
+{
+
+/**
+ * ******************* GenerateOutputInformation *******************
+ */
+
+template< class TImage >
+void
+InterleaveVectorImagesFilter< TImage >
+::GenerateOutputInformation( void )
+{
+  Superclass::GenerateOutputInformation();
+
+  unsigned int numberOfComponents = 0;
+  for( unsigned int i = 0; i < this->GetNumberOfInputs(); ++i )
+  {
+    numberOfComponents += this->GetInput( i )->GetNumberOfComponentsPerPixel();
+  }
+  this->GetOutput()->SetNumberOfComponentsPerPixel( numberOfComponents );
+
+} // end GenerateOutputInformation()
+
+
+/**
+ * ******************* BeforeThreadedGenerateData *******************
+ */
+
+template< class TImage >
+void
+InterleaveVectorImagesFilter< TImage >
+::BeforeThreadedGenerateData( void )
+{
+  const RegionType region = this->GetInput( 0 )->GetLargestPossibleRegion();
+  for( unsigned int i = 1; i < this->GetNumberOfInputs(); ++i )
+  {
+    if( this->GetInput( i )->GetLargestPossibleRegion() != region )
+    {
+      itkExceptionMacro( << "ERROR: input " << i
+        << " does not have the same size as the first input." );
+    }
+  }
+
+} // end BeforeThreadedGenerateData()
+
+
+/**
+ * ******************* ThreadedGenerateData *******************
+ */
+
+template< class TImage >
+void
+InterleaveVectorImagesFilter< TImage >
+::ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+  ThreadIdType threadId )
+{
+  ImageType * output = this->GetOutput();
+  const std::size_t outputComponents = output->GetNumberOfComponentsPerPixel();
+
+  const IndexType regionIndex = outputRegionForThread.GetIndex();
+  const typename RegionType::SizeType regionSize = outputRegionForThread.GetSize();
+  const std::size_t lineLength = regionSize[ 0 ];
+  if( lineLength == 0 ) return;
+  const std::size_t numberOfLines
+    = outputRegionForThread.GetNumberOfPixels() / lineLength;
+
+  ProgressReporter progress( this, threadId, numberOfLines );
+
+  /** Walk over the scanlines of the region. */
+  IndexType lineStart = regionIndex;
+  for( std::size_t l = 0; l < numberOfLines; ++l )
+  {
+    InternalPixelType * out = output->GetBufferPointer()
+      + output->ComputeOffset( lineStart ) * outputComponents;
+
+    /** Copy the components of the inputs to their place in the pixels. */
+    std::size_t first = 0;
+    for( unsigned int i = 0; i < this->GetNumberOfInputs(); ++i )
+    {
+      const ImageType * input = this->GetInput( i );
+      const std::size_t inputComponents = input->GetNumberOfComponentsPerPixel();
+      const InternalPixelType * in = input->GetBufferPointer()
+        + input->ComputeOffset( lineStart ) * inputComponents;
+      for( std::size_t p = 0; p < lineLength; ++p )
+      {
+        InternalPixelType * outPixel = out + p * outputComponents + first;
+        const InternalPixelType * inPixel = in + p * inputComponents;
+        for( std::size_t c = 0; c < inputComponents; ++c )
+        {
+          outPixel[ c ] = inPixel[ c ];
+        }
+      }
+      first += inputComponents;
+    }
+    progress.CompletedPixel();
+
+    /** Go to the next scanline. */
+    for( unsigned int i = 1; i < ImageDimension; ++i )
+    {
+      ++lineStart[ i ];
+      if( lineStart[ i ] < static_cast<typename IndexType::IndexValueType>(
+        regionIndex[ i ] + regionSize[ i ] ) )
+      {
+        break;
+      }
+      lineStart[ i ] = regionIndex[ i ];
+    }
+  }
+
+} // end ThreadedGenerateData()
+
+} // end namespace itk
+
+#endif // end #ifndef __itkInterleaveVectorImagesFilter_txx_
@@ -48,7 +48,9 @@ std::string GetHelpString( void )
     << "Supported: 2D, 3D, (unsigned) char, (unsigned) short, (unsigned) int,\n"
     << "(unsigned) long, float, double.\n"
     << "If \"-pt\" is used, the input is immediately converted to that particular\n"
-    << "type, after which the intensity replacement is performed.";
+    << "type, after which the intensity replacement is performed.\n"
+    << "Integer images are replaced with a lookup table, so that the number of\n"
+    << "replacements hardly affects the run time.";
 
   return ss.str();
 
@@ -157,6 +159,7 @@ int main( int argc, char ** argv )
     filter->m_InValues = inValues;
     filter->m_OutValues = outValues;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
@@ -22,6 +22,7 @@
 
 #include "itkImageFileReader.h"
 #include "itkChangeLabelImageFilter.h"
+#include "itkLookupTableImageFilter.h"
 #include "itkImageFileWriter.h"
 
 
@@ -84,44 +85,74 @@ public:
     typedef itk::ImageFileReader< InputImageType >          ReaderType;
     typedef itk::ChangeLabelImageFilter<
       InputImageType, OutputImageType >                     ReplaceFilterType;
+    typedef itk::LookupTableImageFilter<
+      InputImageType, OutputImageType >                     LookupTableFilterType;
     typedef itk::ImageFileWriter< OutputImageType >         WriterType;
+    typedef itk::InPlaceImageFilter<
+      InputImageType, OutputImageType >                     BaseFilterType;
 
     /** Read in the input image. */
     typename ReaderType::Pointer reader = ReaderType::New();
-    typename ReplaceFilterType::Pointer replaceFilter = ReplaceFilterType::New();
     typename WriterType::Pointer writer = WriterType::New();
 
     /** Set up reader */
     reader->SetFileName( this->m_InputFileName );
 
-    /** Setup the the input and the 'change map' of the replace filter. */
-    replaceFilter->SetInput( reader->GetOutput() );
+    /** Convert the replacements. */
+    std::vector<InputPixelType> inValues( this->m_InValues.size() );
+    std::vector<OutputPixelType> outValues( this->m_InValues.size() );
     if( itk::NumericTraits<OutputPixelType>::is_integer )
     {
       for( unsigned int i = 0; i < this->m_InValues.size(); ++i )
       {
-        const InputPixelType inval = static_cast< InputPixelType >(
+        inValues[ i ] = static_cast< InputPixelType >(
           atoi( this->m_InValues[ i ].c_str() )   );
-        const OutputPixelType outval = static_cast< OutputPixelType >(
+        outValues[ i ] = static_cast< OutputPixelType >(
           atoi( this->m_OutValues[ i ].c_str() )   );
-        replaceFilter->SetChange( inval, outval );
       }
     }
     else
     {
       for( unsigned int i = 0; i < this->m_InValues.size(); ++i )
       {
-        const InputPixelType inval = static_cast< InputPixelType >(
+        inValues[ i ] = static_cast< InputPixelType >(
           atof( this->m_InValues[ i ].c_str() )   );
-        const OutputPixelType outval = static_cast< OutputPixelType >(
+        outValues[ i ] = static_cast< OutputPixelType >(
           atof( this->m_OutValues[ i ].c_str() )   );
-        replaceFilter->SetChange( inval, outval );
       }
     }
 
+    /** Integer images use a dense lookup table, over the full range for
+     * types of up to 16 bits, and over the range of the replacements
+     * otherwise. The 'change map' of ChangeLabelImageFilter is used for
+     * floating point images, and for a range of more than 2^20 values.
+     */
+    typename BaseFilterType::Pointer filter;
+    typename LookupTableFilterType::Pointer lookupTableFilter = LookupTableFilterType::New();
+    if( itk::NumericTraits<InputPixelType>::is_integer
+      && lookupTableFilter->SetReplacements( inValues, outValues, 1ULL << 20 ) )
+    {
+      filter = lookupTableFilter.GetPointer();
+    }
+    else
+    {
+      typename ReplaceFilterType::Pointer replaceFilter = ReplaceFilterType::New();
+      for( unsigned int i = 0; i < inValues.size(); ++i )
+      {
+        replaceFilter->SetChange( inValues[ i ], outValues[ i ] );
+      }
+      filter = replaceFilter.GetPointer();
+    }
+    filter->SetInput( reader->GetOutput() );
+    filter->InPlaceOn();
+
     /** Set up writer. */
     writer->SetFileName( this->m_OutputFileName );
-    writer->SetInput( replaceFilter->GetOutput() );
+    writer->SetInput( filter->GetOutput() );
+
+    this->ObserveProcess( reader.GetPointer(), "read" );
+    this->ObserveProcess( filter.GetPointer(), "replace" );
+    this->ObserveProcess( writer.GetPointer(), "write" );
     writer->Update();
 
   } // end Run()
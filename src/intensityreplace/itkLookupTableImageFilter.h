@@ -0,0 +1,108 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkLookupTableImageFilter_h_
+#define __itkLookupTableImageFilter_h_
+
+#include "itkInPlaceImageFilter.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/** \class LookupTableImageFilter
+ * \brief Replace the values of an integer image by a dense lookup table.
+ *
+ * The table holds the output values of the inputs
+ * TableMinimum, .., TableMinimum + table size - 1. Other inputs are cast to
+ * the output unchanged. Compared to ChangeLabelImageFilter, which looks
+ * up every pixel in a std::map, the cost per pixel is one load,
+ * independent of the number of replacements. When the table covers the
+ * full range of the input type, as is affordable for types of up to 16
+ * bits, the range check is skipped, and the loop over a run of
+ * contiguous pixels is a plain gather.
+ *
+ * The input pixel type must be an integer type, and the images must be
+ * itk::Images.
+ *
+ * \ingroup IntensityImageFilters MultiThreaded
+ */
+
+template< class TInputImage, class TOutputImage >
+class ITK_EXPORT LookupTableImageFilter :
+  public InPlaceImageFilter< TInputImage, TOutputImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef LookupTableImageFilter            Self;
+  typedef InPlaceImageFilter<
+    TInputImage, TOutputImage >             Superclass;
+  typedef SmartPointer<Self>                Pointer;
+  typedef SmartPointer<const Self>          ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( LookupTableImageFilter, InPlaceImageFilter );
+
+  /** Typedefs. */
+  typedef typename TInputImage::PixelType             InputPixelType;
+  typedef typename TOutputImage::PixelType            OutputPixelType;
+  typedef typename Superclass::OutputImageRegionType  OutputImageRegionType;
+  typedef std::vector<OutputPixelType>                TableType;
+
+  itkStaticConstMacro( ImageDimension, unsigned int, TOutputImage::ImageDimension );
+
+  /** Set the table and the input value of its first entry. */
+  void SetTable( const TableType & table, long long tableMinimum );
+  const TableType & GetTable( void ) const { return this->m_Table; }
+  itkGetConstMacro( TableMinimum, long long );
+
+  /** Fill a table over [minimum, maximum] with the identity, set the
+   * replacements, and set it. Returns false if the range of the
+   * replacements is too large for a table of maximumTableSize entries. */
+  bool SetReplacements( const std::vector<InputPixelType> & inValues,
+    const std::vector<OutputPixelType> & outValues,
+    unsigned long long maximumTableSize );
+
+protected:
+  LookupTableImageFilter();
+  virtual ~LookupTableImageFilter() {};
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** Look up the runs of contiguous pixels of the region. */
+  void ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+    ThreadIdType threadId );
+
+private:
+  LookupTableImageFilter( const Self & ); // purposely not implemented
+  void operator=( const Self & );         // purposely not implemented
+
+  TableType   m_Table;
+  long long   m_TableMinimum;
+
+}; // end class LookupTableImageFilter
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkLookupTableImageFilter.txx"
+#endif
+
+#endif // end #ifndef __itkLookupTableImageFilter_h_
@@ -0,0 +1,215 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkLookupTableImageFilter_txx_
+#define __itkLookupTableImageFilter_txx_
+
+#include "itkLookupTableImageFilter.h"
+#include "itkProgressReporter.h"
+
+#include <algorithm>
+
+namespace itk
+{
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+LookupTableImageFilter< TInputImage, TOutputImage >
+::LookupTableImageFilter()
+{
+  this->m_TableMinimum = 0;
+
+} // end Constructor
+
+
+/**
+ * ******************* SetTable *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+LookupTableImageFilter< TInputImage, TOutputImage >
+::SetTable( const TableType & table, long long tableMinimum )
+{
+  this->m_Table = table;
+  this->m_TableMinimum = tableMinimum;
+  this->Modified();
+
+} // end SetTable()
+
+
+/**
+ * ******************* SetReplacements *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+bool
+LookupTableImageFilter< TInputImage, TOutputImage >
+::SetReplacements( const std::vector<InputPixelType> & inValues,
+  const std::vector<OutputPixelType> & outValues,
+  unsigned long long maximumTableSize )
+{
+  /** The full range of types of up to 16 bits, the range of the
+   * replacements otherwise. */
+  long long minimum = 0;
+  long long maximum = -1;
+  if( sizeof( InputPixelType ) <= 2 )
+  {
+    minimum = static_cast<long long>( NumericTraits<InputPixelType>::NonpositiveMin() );
+    maximum = static_cast<long long>( NumericTraits<InputPixelType>::max() );
+  }
+  else if( !inValues.empty() )
+  {
+    minimum = maximum = static_cast<long long>( inValues[ 0 ] );
+    for( unsigned int i = 1; i < inValues.size(); ++i )
+    {
+      minimum = std::min( minimum, static_cast<long long>( inValues[ i ] ) );
+      maximum = std::max( maximum, static_cast<long long>( inValues[ i ] ) );
+    }
+  }
+  if( static_cast<unsigned long long>( maximum - minimum + 1 ) > maximumTableSize )
+  {
+    return false;
+  }
+
+  /** The identity, and the replacements in order, so that the last of
+   * equal input values wins, as for ChangeLabelImageFilter. */
+  TableType table( static_cast<std::size_t>( maximum - minimum + 1 ) );
+  for( std::size_t k = 0; k < table.size(); ++k )
+  {
+    table[ k ] = static_cast<OutputPixelType>( minimum + static_cast<long long>( k ) );
+  }
+  for( unsigned int i = 0; i < inValues.size(); ++i )
+  {
+    table[ static_cast<std::size_t>( static_cast<long long>( inValues[ i ] ) - minimum ) ]
+      = outValues[ i ];
+  }
+  this->SetTable( table, minimum );
+  return true;
+
+} // end SetReplacements()
+
+
+/**
+ * ******************* ThreadedGenerateData *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+LookupTableImageFilter< TInputImage, TOutputImage >
+::ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+  ThreadIdType threadId )
+{
+  typedef typename OutputImageRegionType::SizeType    SizeType;
+  typedef typename OutputImageRegionType::IndexType   IndexType;
+
+  const TInputImage * inputPtr = this->GetInput();
+  TOutputImage * outputPtr = this->GetOutput( 0 );
+
+  const SizeType size = outputRegionForThread.GetSize();
+  const SizeType inputSize = inputPtr->GetBufferedRegion().GetSize();
+  const SizeType outputSize = outputPtr->GetBufferedRegion().GetSize();
+  if( outputRegionForThread.GetNumberOfPixels() == 0 ) return;
+
+  /** The run of contiguous pixels: the region spans both buffers in the
+   * dimensions below runDimension. */
+  SizeValueType runLength = size[ 0 ];
+  unsigned int runDimension = 0;
+  while( runDimension + 1 < ImageDimension
+    && size[ runDimension ] == inputSize[ runDimension ]
+    && size[ runDimension ] == outputSize[ runDimension ] )
+  {
+    ++runDimension;
+    runLength *= size[ runDimension ];
+  }
+  const SizeValueType numberOfRuns
+    = outputRegionForThread.GetNumberOfPixels() / runLength;
+
+  /** The table is shifted, so that it is indexed by the input value. */
+  const long long tableMinimum = this->m_TableMinimum;
+  const unsigned long long tableSize = this->m_Table.size();
+  const OutputPixelType * table = this->m_Table.empty() ? 0 : &this->m_Table[ 0 ];
+  const bool fullRange = tableSize > 0
+    && sizeof( InputPixelType ) < sizeof( long long )
+    && tableMinimum <= static_cast<long long>( NumericTraits<InputPixelType>::NonpositiveMin() )
+    && tableMinimum + static_cast<long long>( tableSize ) - 1
+    >= static_cast<long long>( NumericTraits<InputPixelType>::max() );
+
+  ProgressReporter progress( this, threadId, numberOfRuns );
+
+  IndexType index = outputRegionForThread.GetIndex();
+  const IndexType start = index;
+  for( SizeValueType r = 0; r < numberOfRuns; ++r )
+  {
+    const InputPixelType * in
+      = inputPtr->GetBufferPointer() + inputPtr->ComputeOffset( index );
+    OutputPixelType * out
+      = outputPtr->GetBufferPointer() + outputPtr->ComputeOffset( index );
+    if( fullRange )
+    {
+      for( SizeValueType i = 0; i < runLength; ++i )
+      {
+        out[ i ] = table[ static_cast<long long>( in[ i ] ) - tableMinimum ];
+      }
+    }
+    else
+    {
+      for( SizeValueType i = 0; i < runLength; ++i )
+      {
+        const unsigned long long k = static_cast<unsigned long long>(
+          static_cast<long long>( in[ i ] ) - tableMinimum );
+        out[ i ] = k < tableSize ? table[ k ] : static_cast<OutputPixelType>( in[ i ] );
+      }
+    }
+    progress.CompletedPixel();
+
+    /** The start of the next run. */
+    for( unsigned int d = runDimension + 1; d < ImageDimension; ++d )
+    {
+      if( ++index[ d ] < start[ d ] + static_cast<OffsetValueType>( size[ d ] ) )
+      {
+        break;
+      }
+      index[ d ] = start[ d ];
+    }
+  }
+
+} // end ThreadedGenerateData()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+LookupTableImageFilter< TInputImage, TOutputImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "TableMinimum: " << this->m_TableMinimum << std::endl;
+  os << indent << "TableSize: " << this->m_Table.size() << std::endl;
+
+} // end PrintSelf()
+
+} // end namespace itk
+
+#endif // end #ifndef __itkLookupTableImageFilter_txx_
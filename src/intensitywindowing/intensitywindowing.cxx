@@ -41,7 +41,11 @@ std::string GetHelpString( void )
     << "pxintensitywindowing\n"
     << "  -in      inputFilename\n"
     << "  [-out]   outputFilename, default in + WINDOWED.mhd\n"
-    << "  -w       windowMinimum windowMaximum\n"
+    << "  [-w]     windowMinimum windowMaximum\n"
+    << "  [-wp]    lowerPercentage upperPercentage, the window between these\n"
+    << "           percentiles of the input image, instead of -w\n"
+    << "  [-cache] take the histogram for -wp from the statistics file\n"
+    << "           in + .statistics if it is valid, and otherwise write it there\n"
     << "  [-pt]    pixel type of input and output images\n"
     << "           default: automatically determined from the first input image.\n"
     << "Supported: 2D, 3D, (unsigned) char, (unsigned) short, (unsigned) int, float.";
@@ -83,30 +87,50 @@ int main( int argc, char **argv )
   outputFileName += "WINDOWED.mhd";
   parser->GetCommandLineArgument( "-out", outputFileName );
 
-  /** Get the window. */
+  /** Get the window, or the percentiles for it. */
   std::vector<double> window;
   bool retw = parser->GetCommandLineArgument( "-w", window );
+  std::vector<double> windowPercentiles;
+  bool retwp = parser->GetCommandLineArgument( "-wp", windowPercentiles );
+
+  const bool useCacheFile = parser->ArgumentExists( "-cache" );
 
   /** Check if the required arguments are given. */
-  if( !retw )
+  if( retw == retwp )
   {
-    std::cerr << "ERROR: You should specify \"-w\"." << std::endl;
+    std::cerr << "ERROR: You should specify either \"-w\" or \"-wp\"." << std::endl;
     return EXIT_FAILURE;
   }
 
+  /** Check the percentiles. */
+  if( retwp )
+  {
+    if( windowPercentiles.size() != 2 )
+    {
+      std::cerr << "ERROR: The percentiles should consist of two numbers." << std::endl;
+      return EXIT_FAILURE;
+    }
+    if( !( 0.0 <= windowPercentiles[ 0 ] && windowPercentiles[ 0 ] < windowPercentiles[ 1 ]
+      && windowPercentiles[ 1 ] <= 100.0 ) )
+    {
+      std::cerr << "ERROR: The percentiles should increase, between 0 and 100." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
   /** Check window. */
-  if( window.size() != 2 )
+  if( retw && window.size() != 2 )
   {
     std::cout << "ERROR: The window should consist of two numbers." << std::endl;
     return EXIT_FAILURE;
   }
-  if( window[ 1 ] < window[ 0 ] )
+  if( retw && window[ 1 ] < window[ 0 ] )
   {
     double temp = window[ 0 ];
     window[ 0 ] = window[ 1 ];
     window[ 1 ] = temp;
   }
-  if( window[ 0 ] == window[ 1 ] )
+  if( retw && window[ 0 ] == window[ 1 ] )
   {
     std::cerr << "ERROR: The window should be larger." << std::endl;
     return EXIT_FAILURE;
@@ -156,7 +180,10 @@ int main( int argc, char **argv )
     filter->m_OutputFileName = outputFileName;
     filter->m_InputFileName = inputFileName;
     filter->m_Window = window;
+    filter->m_WindowPercentiles = windowPercentiles;
+    filter->m_UseCacheFile = useCacheFile;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
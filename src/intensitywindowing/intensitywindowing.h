@@ -19,11 +19,14 @@
 #define __intensitywindowing_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsStatisticsCache.h"
 
 #include "itkImage.h"
 #include "itkIntensityWindowingImageFilter.h"
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
+#include "itkNumericTraits.h"
+#include <algorithm>
 
 
 /** \class ITKToolsIntensityWindowingBase
@@ -40,6 +43,7 @@ public:
   {
     this->m_InputFileName = "";
     this->m_OutputFileName = "";
+    this->m_UseCacheFile = false;
   };
   /** Destructor. */
   ~ITKToolsIntensityWindowingBase(){};
@@ -48,6 +52,8 @@ public:
   std::string m_InputFileName;
   std::string m_OutputFileName;
   std::vector<double> m_Window;
+  std::vector<double> m_WindowPercentiles;
+  bool m_UseCacheFile;
 
 }; // end class ITKToolsIntensityWindowingBase
 
@@ -88,6 +94,15 @@ public:
     /** Setup the pipeline. */
     reader->SetFileName( this->m_InputFileName.c_str() );
     writer->SetFileName( this->m_OutputFileName.c_str() );
+    if( !this->m_WindowPercentiles.empty() )
+    {
+      this->ComputePercentileWindow( reader.GetPointer() );
+      if( !( this->m_Window[ 0 ] < this->m_Window[ 1 ] ) )
+      {
+        itkGenericExceptionMacro( << "The window from the percentiles is empty: ["
+          << this->m_Window[ 0 ] << ", " << this->m_Window[ 1 ] << "]." );
+      }
+    }
     InputPixelType min = static_cast<InputPixelType>( this->m_Window[ 0 ] );
     InputPixelType max = static_cast<InputPixelType>( this->m_Window[ 1 ] );
     windowfilter->SetWindowMinimum( min );
@@ -95,13 +110,72 @@ public:
     windowfilter->SetOutputMinimum( min );
     windowfilter->SetOutputMaximum( max );
 
-    /** Connect and execute the pipeline. */
+    /** Connect and execute the pipeline, in the buffer of the reader. */
     windowfilter->SetInput( reader->GetOutput() );
+    windowfilter->InPlaceOn();
     writer->SetInput( windowfilter->GetOutput() );
     writer->Update();
 
   } // end Run()
 
+  /** Compute the window from the percentiles of the input image, from the
+   * histogram in its statistics file if valid. Otherwise the image is read,
+   * and for an integer image its histogram is computed, and stored if
+   * requested. For other images, or a too wide range, the percentiles are
+   * selected from a copy of the pixels, with the same rank definition as
+   * itktools::ImageStatistics::GetPercentile().
+   */
+  template< class TReader >
+  void ComputePercentileWindow( TReader * reader )
+  {
+    typedef typename TReader::OutputImageType           ImageType;
+
+    this->m_Window.assign( 2, 0.0 );
+    itktools::ImageStatistics imageStatistics;
+    if( !( this->m_UseCacheFile && itktools::ReadStatisticsCache(
+      this->m_InputFileName, itktools::GetReadComponentType<ImageType>(),
+      imageStatistics ) && imageStatistics.HasHistogram() ) )
+    {
+      reader->Update();
+      const ImageType * image = reader->GetOutput();
+      const TComponentType * buffer = image->GetBufferPointer();
+      const std::size_t numberOfPixels
+        = image->GetBufferedRegion().GetNumberOfPixels();
+
+      bool histogramComputed = false;
+      if( itk::NumericTraits<TComponentType>::is_integer && numberOfPixels > 0 )
+      {
+        const TComponentType minimum = *std::min_element( buffer, buffer + numberOfPixels );
+        const TComponentType maximum = *std::max_element( buffer, buffer + numberOfPixels );
+        histogramComputed = itktools::ComputeValueHistogram( image,
+          static_cast<double>( minimum ), static_cast<double>( maximum ), imageStatistics );
+        if( histogramComputed && this->m_UseCacheFile )
+        {
+          imageStatistics.ComputeMomentsFromHistogram();
+          itktools::WriteStatisticsCache( this->m_InputFileName, image, imageStatistics );
+        }
+      }
+
+      if( !histogramComputed )
+      {
+        std::vector<TComponentType> values( buffer, buffer + numberOfPixels );
+        for( unsigned int i = 0; i < 2; ++i )
+        {
+          const double fraction = this->m_WindowPercentiles[ i ] / 100.0;
+          const std::size_t rank = numberOfPixels == 0 ? 0
+            : static_cast<std::size_t>( fraction * ( numberOfPixels - 1.0 ) );
+          std::nth_element( values.begin(), values.begin() + rank, values.end() );
+          this->m_Window[ i ] = values.empty() ? 0.0 : values[ rank ];
+        }
+        return;
+      }
+    }
+
+    this->m_Window[ 0 ] = imageStatistics.GetPercentile( this->m_WindowPercentiles[ 0 ] );
+    this->m_Window[ 1 ] = imageStatistics.GetPercentile( this->m_WindowPercentiles[ 1 ] );
+
+  } // end ComputePercentileWindow()
+
 }; // end IntensityWindowing
 
 #endif // end #ifndef __intensitywindowing_h_
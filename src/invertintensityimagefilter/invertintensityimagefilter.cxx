@@ -41,6 +41,10 @@ std::string GetHelpString( void )
     << "pxinvertintensityimagefilter\n"
     << "  -in      inputFilename\n"
     << "  [-out]   outputFilename; default: in + INVERTED.mhd\n"
+    << "  [-max]   the maximum; default: the maximum of the image, over all components\n"
+    << "The result is max - in, clamped to the range of the pixel type. The maximum is\n"
+    << "computed in one pass over the image, and it is inverted in place in another.\n"
+    << "With -max given the image is read once, and -streams or -memoryLimit can be used.\n"
     << "Supported: 2D, 3D, (unsigned) char, (unsigned) short, float, double.";
 
   return ss.str();
@@ -78,6 +82,9 @@ int main( int argc, char ** argv )
   outputFileName += "INVERTED.mhd";
   parser->GetCommandLineArgument( "-out", outputFileName );
 
+  double maximum = 0.0;
+  const bool useMaximum = parser->GetCommandLineArgument( "-max", maximum );
+
   /** Determine image properties. */
   itk::ImageIOBase::IOPixelType pixelType = itk::ImageIOBase::UNKNOWNPIXELTYPE;
   itk::ImageIOBase::IOComponentType componentType = itk::ImageIOBase::UNKNOWNCOMPONENTTYPE;
@@ -119,7 +126,10 @@ int main( int argc, char ** argv )
     /** Set the filter arguments. */
     filter->m_OutputFileName = outputFileName;
     filter->m_InputFileName = inputFileName;
+    filter->m_Maximum = maximum;
+    filter->m_UseMaximum = useMaximum;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
@@ -22,14 +22,12 @@
 
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
+#include "itkVectorImage.h"
 
-#include "itkStatisticsImageFilter.h"
-#include "itkInvertIntensityImageFilter.h"
-
-// Vector image support
-#include "itkVectorIndexSelectionCastImageFilter.h" // decompose
-#include "itkImageToVectorImageFilter.h" // reassemble
-#include "itkChannelByChannelVectorImageFilter2.h"
+#include "itkVectorComponentStatisticsImageFilter.h"
+#include "itkVectorShiftScaleImageFilter.h"
+#include <algorithm>
+#include <vector>
 
 
 /** \class ITKToolsInvertIntensityBase
@@ -46,6 +44,8 @@ public:
   {
     this->m_InputFileName = "";
     this->m_OutputFileName = "";
+    this->m_Maximum = 0.0;
+    this->m_UseMaximum = false;
   };
   /** Destructor. */
   ~ITKToolsInvertIntensityBase(){};
@@ -53,11 +53,16 @@ public:
   /** Input member parameters. */
   std::string m_InputFileName;
   std::string m_OutputFileName;
+  double m_Maximum;
+  bool m_UseMaximum;
+
+  /** Only with a given maximum the pipeline is region-local. */
+  virtual bool GetSupportsStreaming( void ) const { return this->m_UseMaximum; }
 
 }; // end class ITKToolsInvertIntensityBase
 
 
-/** \class ITKToolsLogicalImageOperator
+/** \class ITKToolsInvertIntensity
  *
  * Templated class that implements the Run() function
  * and the New() function for its creation.
@@ -78,66 +83,48 @@ public:
   void Run( void )
   {
     /** Some typedef's. */
-    typedef itk::Image<TComponentType, VDimension>              ScalarImageType;
-    typedef typename ScalarImageType::PixelType                 InputPixelType;
-    typedef itk::VectorImage< InputPixelType,
-      ScalarImageType::ImageDimension >                         VectorImageType;
+    typedef itk::VectorImage< TComponentType, VDimension >      VectorImageType;
     typedef itk::ImageFileReader< VectorImageType >             ReaderType;
     typedef itk::ImageFileWriter< VectorImageType >             WriterType;
-    typedef itk::StatisticsImageFilter< ScalarImageType >       StatisticsFilterType;
-    typedef typename StatisticsFilterType::RealType             RealType;
-    typedef itk::InvertIntensityImageFilter< ScalarImageType >  InvertIntensityFilterType;
+    typedef itk::VectorComponentStatisticsImageFilter<
+      VectorImageType >                                         StatisticsFilterType;
+    typedef itk::VectorShiftScaleImageFilter< VectorImageType > InvertFilterType;
 
     /** Create reader. */
     typename ReaderType::Pointer reader = ReaderType::New();
     reader->SetFileName( this->m_InputFileName.c_str() );
-
-    // In this case, we must manually disassemble the image rather than use a
-    // ChannelByChannel filter because the image is not the output,
-    // but rather the GetMaximum() function is what we want.
-
-    // Create the disassembler
-    typedef itk::VectorIndexSelectionCastImageFilter<VectorImageType, ScalarImageType> IndexSelectionType;
-    typename IndexSelectionType::Pointer indexSelectionFilter = IndexSelectionType::New();
-    indexSelectionFilter->SetInput( reader->GetOutput() );
-
-    // Initialize so that any number will be bigger than this one
-    TComponentType max = std::numeric_limits<TComponentType>::min();
-
-    // Get the max of each channel, keeping the largest
-    for( unsigned int channel = 0; channel < reader->GetOutput()->GetNumberOfComponentsPerPixel(); channel++ )
+    reader->UpdateOutputInformation();
+    const unsigned int numberOfChannels
+      = reader->GetOutput()->GetNumberOfComponentsPerPixel();
+
+    /** Get the maximum over all channels in one threaded pass,
+     * unless it is given.
+     */
+    double max = this->m_Maximum;
+    if( !this->m_UseMaximum )
     {
-      // Extract the current channel
-      indexSelectionFilter->SetIndex( channel );
-      indexSelectionFilter->Update();
-
-      /** Create statistics filter. */
+      reader->Update();
       typename StatisticsFilterType::Pointer statistics = StatisticsFilterType::New();
-      statistics->SetInput( indexSelectionFilter->GetOutput() );
+      statistics->SetInput( reader->GetOutput() );
       statistics->Update();
-      if( statistics->GetMaximum() > max )
-      {
-        max = statistics->GetMaximum();
-      }
+      const std::vector<double> & maxima = statistics->GetMaximum();
+      max = *std::max_element( maxima.begin(), maxima.end() );
     }
 
-    /** Create invert filter. */
-    typename InvertIntensityFilterType::Pointer invertFilter = InvertIntensityFilterType::New();
-    invertFilter->SetMaximum( max );
-
-    // Setup the filter to apply the invert filter to every channel
-    typedef itk::ChannelByChannelVectorImageFilter2<
-      VectorImageType, InvertIntensityFilterType >        ChannelByChannelInvertType;
-    typename ChannelByChannelInvertType::Pointer channelByChannelInvertFilter
-      = ChannelByChannelInvertType::New();
-    channelByChannelInvertFilter->SetInput( reader->GetOutput() );
-    channelByChannelInvertFilter->SetFilter( invertFilter );
-    channelByChannelInvertFilter->Update();
+    /** Invert all channels in one pass, new = max - old, in place in
+     * the buffer of the reader.
+     */
+    typename InvertFilterType::Pointer invertFilter = InvertFilterType::New();
+    invertFilter->SetInput( reader->GetOutput() );
+    invertFilter->SetScale( std::vector<double>( numberOfChannels, -1.0 ) );
+    invertFilter->SetShift( std::vector<double>( numberOfChannels, max ) );
+    invertFilter->InPlaceOn();
 
     /** Create writer. */
     typename WriterType::Pointer writer = WriterType::New();
     writer->SetFileName( this->m_OutputFileName.c_str() );
-    writer->SetInput( channelByChannelInvertFilter->GetOutput() );
+    writer->SetInput( invertFilter->GetOutput() );
+    this->SetStreamingOnWriter( writer.GetPointer() );
     writer->Update();
 
   } // end Run()
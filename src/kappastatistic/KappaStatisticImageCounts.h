@@ -0,0 +1,265 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __KappaStatisticImageCounts_h_
+#define __KappaStatisticImageCounts_h_
+
+#include "ITKToolsBase.h"
+
+#include "itkImageFileReader.h"
+#include "itkMultiThreader.h"
+#include "itkNumericTraits.h"
+
+#include <string>
+#include <vector>
+
+
+/** \class ITKToolsKappaStatisticImageCountsBase
+ *
+ * Untemplated pure virtual base class that holds
+ * the Run() function and all required parameters.
+ *
+ * Run() reads a set of label images of the same size, one per observer,
+ * and summarizes the ratings of all pixels, such that the kappa statistic
+ * can be computed without listing every pixel as an observation:
+ * - the category counts: the number of ratings in every category,
+ *   summed over the observers;
+ * - the number of pairs of observers that agree, summed over the pixels;
+ * - for two observers, the confusion matrix.
+ * The categories are the labels that occur in any of the images.
+ */
+
+class ITKToolsKappaStatisticImageCountsBase : public itktools::ITKToolsBase
+{
+public:
+  /** Constructor. */
+  ITKToolsKappaStatisticImageCountsBase()
+  {
+    this->m_NumberOfObservations = 0;
+    this->m_NumberOfAgreeingPairs = 0.0;
+  };
+  /** Destructor. */
+  ~ITKToolsKappaStatisticImageCountsBase(){};
+
+  /** Input member parameters. */
+  std::vector<std::string> m_InputFileNames;
+
+  /** Output member parameters. */
+  std::vector<long> m_Labels;
+  unsigned int m_NumberOfObservations;
+  std::vector<double> m_CategoryCounts;
+  double m_NumberOfAgreeingPairs;
+  std::vector< std::vector<unsigned int> > m_ConfusionMatrix;
+
+}; // end class ITKToolsKappaStatisticImageCountsBase
+
+
+/** \class ITKToolsKappaStatisticImageCounts
+ *
+ * Templated class that implements the Run() function
+ * and the New() function for its creation.
+ *
+ * The pixels are counted in two multi-threaded passes over the image
+ * buffers: the first finds the labels that occur, the second counts
+ * the ratings in per-thread tables, which are merged afterwards.
+ */
+
+template< unsigned int VDimension, class TComponentType >
+class ITKToolsKappaStatisticImageCounts : public ITKToolsKappaStatisticImageCountsBase
+{
+public:
+  /** Standard ITKTools stuff. */
+  typedef ITKToolsKappaStatisticImageCounts Self;
+  itktoolsOneTypeNewMacro( Self );
+
+  ITKToolsKappaStatisticImageCounts(){};
+  ~ITKToolsKappaStatisticImageCounts(){};
+
+  /** Typedef's. */
+  typedef TComponentType                              PixelType;
+  typedef itk::Image<PixelType, VDimension>           ImageType;
+  typedef typename ImageType::Pointer                 ImagePointer;
+  typedef itk::ImageFileReader<ImageType>             ReaderType;
+
+  /** Run function. */
+  void Run( void )
+  {
+    const std::size_t numberOfObservers = this->m_InputFileNames.size();
+
+    /** Read the images. */
+    ThreadStruct str;
+    str.Images.resize( numberOfObservers );
+    for( std::size_t i = 0; i < numberOfObservers; ++i )
+    {
+      typename ReaderType::Pointer reader = ReaderType::New();
+      reader->SetFileName( this->m_InputFileNames[ i ].c_str() );
+      reader->Update();
+      str.Images[ i ] = reader->GetOutput();
+      if( str.Images[ i ]->GetLargestPossibleRegion()
+        != str.Images[ 0 ]->GetLargestPossibleRegion() )
+      {
+        itkGenericExceptionMacro( << "ERROR: the image " << this->m_InputFileNames[ i ]
+          << " does not have the same size as " << this->m_InputFileNames[ 0 ] << "." );
+      }
+    }
+    str.NumberOfPixels = str.Images[ 0 ]->GetLargestPossibleRegion().GetNumberOfPixels();
+    str.MinimumValue = static_cast<long>( itk::NumericTraits<PixelType>::NonpositiveMin() );
+    const std::size_t valueRange = static_cast<std::size_t>(
+      static_cast<long>( itk::NumericTraits<PixelType>::max() ) - str.MinimumValue + 1 );
+
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    const unsigned int numberOfThreads = threader->GetNumberOfThreads();
+    threader->SetSingleMethod( Self::ThreaderCallback, &str );
+
+    /** First pass: find the labels that occur. */
+    str.Pass = 0;
+    str.Presence.assign( numberOfThreads, std::vector<unsigned char>( valueRange, 0 ) );
+    threader->SingleMethodExecute();
+
+    /** Map the labels to the category indices. */
+    str.CategoryIndices.assign( valueRange, 0 );
+    this->m_Labels.clear();
+    for( std::size_t v = 0; v < valueRange; ++v )
+    {
+      bool present = false;
+      for( unsigned int t = 0; t < numberOfThreads; ++t )
+      {
+        present |= str.Presence[ t ][ v ] != 0;
+      }
+      if( present )
+      {
+        str.CategoryIndices[ v ] = this->m_Labels.size();
+        this->m_Labels.push_back( str.MinimumValue + static_cast<long>( v ) );
+      }
+    }
+    str.Presence.clear();
+    const std::size_t k = this->m_Labels.size();
+
+    /** Second pass: count the ratings. */
+    str.Pass = 1;
+    str.CategoryCounts.assign( numberOfThreads, std::vector<std::size_t>( k, 0 ) );
+    str.AgreeingPairs.assign( numberOfThreads, 0 );
+    str.ConfusionMatrices.assign( numberOfThreads,
+      std::vector<std::size_t>( numberOfObservers == 2 ? k * k : 0, 0 ) );
+    threader->SingleMethodExecute();
+
+    /** Merge the tables of the threads, in thread order. */
+    this->m_NumberOfObservations = static_cast<unsigned int>( str.NumberOfPixels );
+    this->m_CategoryCounts.assign( k, 0.0 );
+    this->m_NumberOfAgreeingPairs = 0.0;
+    this->m_ConfusionMatrix.assign(
+      numberOfObservers == 2 ? k : 0, std::vector<unsigned int>( k, 0 ) );
+    for( unsigned int t = 0; t < numberOfThreads; ++t )
+    {
+      for( std::size_t j = 0; j < k; ++j )
+      {
+        this->m_CategoryCounts[ j ] += str.CategoryCounts[ t ][ j ];
+      }
+      this->m_NumberOfAgreeingPairs += str.AgreeingPairs[ t ];
+      for( std::size_t i = 0; i < this->m_ConfusionMatrix.size(); ++i )
+      {
+        for( std::size_t j = 0; j < k; ++j )
+        {
+          this->m_ConfusionMatrix[ i ][ j ] += str.ConfusionMatrices[ t ][ i * k + j ];
+        }
+      }
+    }
+
+  } // end Run()
+
+protected:
+
+  /** The data shared by the threads. */
+  struct ThreadStruct
+  {
+    std::vector<ImagePointer>                   Images;
+    std::size_t                                 NumberOfPixels;
+    long                                        MinimumValue;
+    unsigned int                                Pass;
+    std::vector< std::vector<unsigned char> >   Presence;
+    std::vector<std::size_t>                    CategoryIndices;
+    std::vector< std::vector<std::size_t> >     CategoryCounts;
+    std::vector<std::size_t>                    AgreeingPairs;
+    std::vector< std::vector<std::size_t> >     ConfusionMatrices;
+  };
+
+  /** Process a contiguous chunk of the pixels. */
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback( void * arg )
+  {
+    typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+    ThreadInfoType * info = static_cast<ThreadInfoType *>( arg );
+    ThreadStruct * str = static_cast<ThreadStruct *>( info->UserData );
+    const unsigned int threadId = info->ThreadID;
+    const std::size_t numberOfThreads = info->NumberOfThreads;
+
+    const std::size_t numberOfObservers = str->Images.size();
+    const std::size_t begin = str->NumberOfPixels * threadId / numberOfThreads;
+    const std::size_t end = str->NumberOfPixels * ( threadId + 1 ) / numberOfThreads;
+
+    std::vector<const PixelType *> buffers( numberOfObservers );
+    for( std::size_t i = 0; i < numberOfObservers; ++i )
+    {
+      buffers[ i ] = str->Images[ i ]->GetBufferPointer();
+    }
+
+    if( str->Pass == 0 )
+    {
+      unsigned char * presence = &str->Presence[ threadId ][ 0 ];
+      for( std::size_t i = 0; i < numberOfObservers; ++i )
+      {
+        for( std::size_t p = begin; p < end; ++p )
+        {
+          presence[ static_cast<long>( buffers[ i ][ p ] ) - str->MinimumValue ] = 1;
+        }
+      }
+      return ITK_THREAD_RETURN_VALUE;
+    }
+
+    const std::size_t * categoryIndices = &str->CategoryIndices[ 0 ];
+    std::vector<std::size_t> & categoryCounts = str->CategoryCounts[ threadId ];
+    std::vector<std::size_t> & confusionMatrix = str->ConfusionMatrices[ threadId ];
+    const std::size_t k = categoryCounts.size();
+    std::vector<std::size_t> ratings( numberOfObservers );
+    std::size_t agreeingPairs = 0;
+    for( std::size_t p = begin; p < end; ++p )
+    {
+      for( std::size_t i = 0; i < numberOfObservers; ++i )
+      {
+        ratings[ i ] = categoryIndices[
+          static_cast<long>( buffers[ i ][ p ] ) - str->MinimumValue ];
+        ++categoryCounts[ ratings[ i ] ];
+      }
+      for( std::size_t i = 0; i < numberOfObservers; ++i )
+      {
+        for( std::size_t j = i + 1; j < numberOfObservers; ++j )
+        {
+          if( ratings[ i ] == ratings[ j ] ) ++agreeingPairs;
+        }
+      }
+      if( numberOfObservers == 2 )
+      {
+        ++confusionMatrix[ ratings[ 0 ] * k + ratings[ 1 ] ];
+      }
+    }
+    str->AgreeingPairs[ threadId ] = agreeingPairs;
+
+    return ITK_THREAD_RETURN_VALUE;
+  } // end ThreaderCallback()
+
+}; // end class ITKToolsKappaStatisticImageCounts
+
+#endif // end #ifndef __KappaStatisticImageCounts_h_
@@ -13,9 +13,76 @@ CohenWeightedKappaStatistic
 ::CohenWeightedKappaStatistic()
 {
   this->m_WeightsName = "";
+  this->m_UseConfusionMatrix = false;
 } // end constructor
 
 
+/**
+ * *************** SetObservations ****************
+ */
+
+void CohenWeightedKappaStatistic
+::SetObservations( const SamplesType observations )
+{
+  Superclass::SetObservations( observations );
+  this->m_UseConfusionMatrix = false;
+} // end SetObservations()
+
+
+/**
+ * *************** SetConfusionMatrix ****************
+ */
+
+void CohenWeightedKappaStatistic
+::SetConfusionMatrix( const SamplesType & confusionMatrix )
+{
+  /** Check that the confusion matrix is a non-empty square matrix. */
+  const unsigned int k = confusionMatrix.size();
+  CountType N = 0;
+  bool check = k > 0;
+  for( unsigned int i = 0; i < k; ++i )
+  {
+    if( confusionMatrix[ i ].size() != k ) check = false;
+    for( unsigned int j = 0; j < confusionMatrix[ i ].size(); ++j )
+    {
+      N += confusionMatrix[ i ][ j ];
+    }
+  }
+  if( !check || N == 0 )
+  {
+    InvalidArgumentError exp(__FILE__, __LINE__);
+    std::ostringstream message;
+    message << "itk::ERROR: " << this->GetNameOfClass()
+      << "(" << this << "): "
+      << "Invalid confusion matrix.";
+    exp.SetDescription( message.str() );
+    exp.SetLocation( ITK_LOCATION );
+    throw exp;
+  }
+
+  this->Modified();
+  this->m_Observations.clear();
+  this->m_ConfusionMatrix = confusionMatrix;
+  this->m_UseConfusionMatrix = true;
+  this->SetNumberOfObservers( 2 );
+  this->SetNumberOfObservations( N );
+  this->SetNumberOfCategories( k );
+
+} // end SetConfusionMatrix()
+
+
+/**
+ * *************** GetConfusionMatrix ****************
+ */
+
+CohenWeightedKappaStatistic::SamplesType
+CohenWeightedKappaStatistic
+::GetConfusionMatrix( void ) const
+{
+  return this->m_ConfusionMatrix;
+} // end GetConfusionMatrix()
+
+
 /**
  * *************** CheckObservations ****************
  */
@@ -199,19 +266,12 @@ void CohenWeightedKappaStatistic
 
 
 /**
- * *************** ComputeKappaStatisticValue ****************
+ * *************** PrepareWeights ****************
  */
 
 void CohenWeightedKappaStatistic
-::ComputeKappaStatisticValue( double & Po, double & Pe, double & kappa )
+::PrepareWeights( const unsigned int k )
 {
-  /** The observations has to be set previously by the user. */
-  this->CheckObservations( this->m_Observations );
-
-  /** Get some numbers. */
-  unsigned int N = this->GetNumberOfObservations();
-  unsigned int k = this->GetNumberOfCategories();
-
   /** Check if the weights are set. */
   if( this->m_WeightsName == "" )
   {
@@ -231,8 +291,106 @@ void CohenWeightedKappaStatistic
     this->InitializeWeights( this->m_WeightsName, k );
   }
 
-  /** Compute the observation matrix. */
-  this->ComputeConfusionMatrix( N, k );
+} // end PrepareWeights()
+
+
+/**
+ * *************** ComputePatternCounts ****************
+ */
+
+void CohenWeightedKappaStatistic
+::ComputePatternCounts( std::vector< double > & patternCounts )
+{
+  /** The observations or the confusion matrix has to be set previously by the user. */
+  if( !this->m_UseConfusionMatrix )
+  {
+    this->CheckObservations( this->m_Observations );
+  }
+
+  unsigned int N = this->GetNumberOfObservations();
+  unsigned int k = this->GetNumberOfCategories();
+  this->PrepareWeights( k );
+  if( !this->m_UseConfusionMatrix )
+  {
+    this->ComputeConfusionMatrix( N, k );
+  }
+
+  patternCounts.resize( k * k );
+  for( unsigned int i = 0; i < k; ++i )
+  {
+    for( unsigned int j = 0; j < k; ++j )
+    {
+      patternCounts[ i * k + j ] = this->m_ConfusionMatrix[ i ][ j ];
+    }
+  }
+
+} // end ComputePatternCounts()
+
+
+/**
+ * *************** ComputeKappaFromPatternCounts ****************
+ */
+
+double CohenWeightedKappaStatistic
+::ComputeKappaFromPatternCounts( const std::vector< double > & patternCounts ) const
+{
+  /** As in ComputeKappaStatisticValue(), with f_{ij} = patternCounts[ i * k + j ]. */
+  const unsigned int k = this->m_Weights.size();
+  std::vector< double > row( k, 0.0 );
+  std::vector< double > col( k, 0.0 );
+  double N = 0.0;
+  for( unsigned int i = 0; i < k; ++i )
+  {
+    for( unsigned int j = 0; j < k; ++j )
+    {
+      row[ i ] += patternCounts[ i * k + j ];
+      col[ j ] += patternCounts[ i * k + j ];
+    }
+    N += row[ i ];
+  }
+
+  double Po = 0.0, Pe = 0.0;
+  for( unsigned int i = 0; i < k; ++i )
+  {
+    for( unsigned int j = 0; j < k; ++j )
+    {
+      Po += this->m_Weights[ i ][ j ] * patternCounts[ i * k + j ];
+      Pe += this->m_Weights[ i ][ j ] * row[ i ] * col[ j ];
+    }
+  }
+  Po /= N;
+  Pe /= N * N;
+
+  return ( Po - Pe ) / ( 1.0 - Pe );
+
+} // end ComputeKappaFromPatternCounts()
+
+
+/**
+ * *************** ComputeKappaStatisticValue ****************
+ */
+
+void CohenWeightedKappaStatistic
+::ComputeKappaStatisticValue( double & Po, double & Pe, double & kappa )
+{
+  /** The observations or the confusion matrix has to be set previously by the user. */
+  if( !this->m_UseConfusionMatrix )
+  {
+    this->CheckObservations( this->m_Observations );
+  }
+
+  /** Get some numbers. */
+  unsigned int N = this->GetNumberOfObservations();
+  unsigned int k = this->GetNumberOfCategories();
+
+  /** Check and compute the weights. */
+  this->PrepareWeights( k );
+
+  /** Compute the observation matrix, unless it was set. */
+  if( !this->m_UseConfusionMatrix )
+  {
+    this->ComputeConfusionMatrix( N, k );
+  }
 
   /** We are ready to compute the kappa statistic.
    * This is done in parts:
@@ -260,7 +418,7 @@ void CohenWeightedKappaStatistic
     }
   }
   Po /= N;
-  Pe /= N * N;
+  Pe /= static_cast<double>( N ) * N;
 
   // the above can probably be done in one loop over i and j,
   // but this is much better readable.
@@ -279,35 +437,25 @@ void CohenWeightedKappaStatistic
 ::ComputeKappaStatisticValueAndStandardDeviation(
   double & Po, double & Pe, double & kappa, double & std, const bool & compare )
 {
-  /** The observations has to be set previously by the user. */
-  this->CheckObservations( this->m_Observations );
+  /** The observations or the confusion matrix has to be set previously by the user. */
+  if( !this->m_UseConfusionMatrix )
+  {
+    this->CheckObservations( this->m_Observations );
+  }
 
   /** Get some numbers. */
   unsigned int N = this->GetNumberOfObservations();
   unsigned int k = this->GetNumberOfCategories();
 
-  /** Check if the weights are set. */
-  if( this->m_WeightsName == "" )
-  {
-    InvalidArgumentError exp(__FILE__, __LINE__);
-    std::ostringstream message;
-    message << "itk::ERROR: " << this->GetNameOfClass()
-      << "(" << this << "): "
-      << "Weights not initialized.";
-    exp.SetDescription( message.str() );
-    exp.SetLocation( ITK_LOCATION );
-    throw exp;
-  }
+  /** Check and compute the weights. */
+  this->PrepareWeights( k );
 
-  /** Compute the weights if only the weights name is set. */
-  if( this->m_WeightsName != "user_defined" )
+  /** Compute the observation matrix, unless it was set. */
+  if( !this->m_UseConfusionMatrix )
   {
-    this->InitializeWeights( this->m_WeightsName, k );
+    this->ComputeConfusionMatrix( N, k );
   }
 
-  /** Compute the observation matrix. */
-  this->ComputeConfusionMatrix( N, k );
-
   /** We are ready to compute the kappa statistic.
    * This is done in parts:
    * - calculate the row and column totals of the confusion matrix
@@ -340,7 +488,7 @@ void CohenWeightedKappaStatistic
     barwj[ i ] /= N;
   }
   Po /= N;
-  Pe /= N * N;
+  Pe /= static_cast<double>( N ) * N;
 
   // the above can probably be done in one loop over i and j,
   // but this is much better readable.
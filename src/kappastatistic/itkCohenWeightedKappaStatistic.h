@@ -63,6 +63,18 @@ public:
   typedef Superclass::SamplesType   SamplesType;
   typedef std::vector< std::vector<double> > WeightsType;
 
+  /** Set the observations. This overrides a previously set confusion matrix. */
+  virtual void SetObservations( const SamplesType observations );
+
+  /** Set the confusion matrix directly, instead of the observations.
+   * An element f_{ij} denotes the number of times that observer 1 rates
+   * a subject in category i and observer 2 in category j. This allows
+   * to compute kappa for e.g. two label images, without listing every
+   * pixel as an observation. Setting the observations overrides it.
+   */
+  virtual void SetConfusionMatrix( const SamplesType & confusionMatrix );
+  SamplesType GetConfusionMatrix( void ) const;
+
   /** Set and get the weights. */
   virtual void SetWeights( const WeightsType & weights );
   virtual void SetWeights( const std::string & weights );
@@ -88,6 +100,13 @@ protected:
   /** Function to check if the input is valid. */
   virtual bool CheckWeights( const WeightsType & weights ) const;
 
+  /** For the bootstrap, the patterns are the k * k cells of the confusion matrix. */
+  virtual void ComputePatternCounts( std::vector< double > & patternCounts );
+
+  /** Compute the weighted kappa from a resampled confusion matrix. */
+  virtual double ComputeKappaFromPatternCounts(
+    const std::vector< double > & patternCounts ) const;
+
 private:
   CohenWeightedKappaStatistic(const Self&); // purposely not implemented
   void operator=(const Self&);       // purposely not implemented
@@ -100,10 +119,14 @@ private:
    */
   void ComputeConfusionMatrix( const unsigned int N, const unsigned int k );
 
+  /** A helper function that checks and initializes the weights. */
+  void PrepareWeights( const unsigned int k );
+
   /** Member variables. */
   std::string m_WeightsName;
   WeightsType m_Weights;
   SamplesType m_ConfusionMatrix;
+  bool        m_UseConfusionMatrix;
 
 }; // end class CohenWeightedKappaStatistic
 
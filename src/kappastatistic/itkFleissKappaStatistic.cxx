@@ -1,5 +1,8 @@
 #include "itkFleissKappaStatistic.h"
 
+#include <algorithm>
+#include <map>
+
 namespace itk {
 namespace Statistics {
 
@@ -11,16 +14,18 @@ namespace Statistics {
 FleissKappaStatistic
 ::FleissKappaStatistic()
 {
+  this->m_UsePooledObservations = false;
+  this->m_NumberOfAgreeingPairs = 0.0;
 } // end constructor
 
 
 /**
- * *************** ComputeObservationMatrix ****************
+ * *************** ComputeSubjectCounts ****************
  */
 
 void FleissKappaStatistic
-::ComputeObservationMatrix( const unsigned int n,
-  const unsigned int N, const unsigned int k )
+::ComputeSubjectCounts( const unsigned int i,
+  SampleType & ratings, SampleType & row ) const
 {
   /**
    * n:  the number of observers
@@ -33,27 +38,202 @@ void FleissKappaStatistic
    * An element n_{ij} of the observation matrix should denote
    * the number of observers that give observation / subject / case
    * i a rating in category j.
+   *
+   * Only the nonzero n_{ij} of row i are computed, from the sorted
+   * category indices of the n ratings of subject i.
    */
-
-  /** Construct the observation matrix. */
-  this->m_ObservationMatrix.resize( 0 );
-  this->m_ObservationMatrix.resize( N );
-  for( unsigned int i = 0; i < N; ++i )
+  const unsigned int n = this->m_Observations.size();
+  ratings.resize( n );
+  for( unsigned int l = 0; l < n; ++l )
   {
-    this->m_ObservationMatrix[ i ].resize( k, 0 );
+    ratings[ l ] = this->m_Indices.find( this->m_Observations[ l ][ i ] )->second;
   }
+  std::sort( ratings.begin(), ratings.end() );
 
-  /** We loop over the observations, and increase the correct bin. */
+  row.clear();
   for( unsigned int l = 0; l < n; ++l )
   {
-    for( unsigned int i = 0; i < N; ++i )
+    if( l > 0 && ratings[ l ] == ratings[ l - 1 ] )
+    {
+      ++row.back();
+    }
+    else
+    {
+      row.push_back( ratings[ l ] );
+      row.push_back( 1 );
+    }
+  }
+
+} // end ComputeSubjectCounts()
+
+
+/** The data shared by the threads of ComputeProportions(). The sums
+ * are integers, so that the result does not depend on the number of
+ * threads.
+ */
+struct FleissKappaStatistic::ProportionsThreadStruct
+{
+  const FleissKappaStatistic *                    Kappa;
+  unsigned int                                    NumberOfObservations;
+  std::vector< std::vector< unsigned long long > > CategoryCounts;
+  std::vector< unsigned long long >               AgreeingPairs;
+};
+
+
+/**
+ * *************** SetObservations ****************
+ */
+
+void FleissKappaStatistic
+::SetObservations( const SamplesType observations )
+{
+  Superclass::SetObservations( observations );
+  this->m_UsePooledObservations = false;
+} // end SetObservations()
+
+
+/**
+ * *************** SetPooledObservations ****************
+ */
+
+void FleissKappaStatistic
+::SetPooledObservations( const CountType numberOfObservers,
+  const CountType numberOfObservations,
+  const CategoryCountsType & categoryCounts,
+  const double numberOfAgreeingPairs )
+{
+  /** Check that the category counts add up to n * N ratings. */
+  double total = 0.0;
+  for( unsigned int j = 0; j < categoryCounts.size(); ++j )
+  {
+    total += categoryCounts[ j ];
+  }
+  const double numberOfRatings
+    = static_cast<double>( numberOfObservers ) * numberOfObservations;
+  const double numberOfPairs = numberOfObservations
+    * ( numberOfObservers * ( numberOfObservers - 1.0 ) / 2.0 );
+  if( numberOfObservers < 2 || numberOfObservations < 1
+    || total != numberOfRatings
+    || numberOfAgreeingPairs < 0.0 || numberOfAgreeingPairs > numberOfPairs )
+  {
+    InvalidArgumentError exp(__FILE__, __LINE__);
+    std::ostringstream message;
+    message << "itk::ERROR: " << this->GetNameOfClass()
+      << "(" << this << "): "
+      << "Invalid pooled observations.";
+    exp.SetDescription( message.str() );
+    exp.SetLocation( ITK_LOCATION );
+    throw exp;
+  }
+
+  this->Modified();
+  this->m_Observations.clear();
+  this->m_Patterns.clear();
+  this->m_CategoryCounts = categoryCounts;
+  this->m_NumberOfAgreeingPairs = numberOfAgreeingPairs;
+  this->m_UsePooledObservations = true;
+  this->SetNumberOfObservers( numberOfObservers );
+  this->SetNumberOfObservations( numberOfObservations );
+  this->SetNumberOfCategories( categoryCounts.size() );
+
+} // end SetPooledObservations()
+
+
+/**
+ * *************** ComputeProportions ****************
+ */
+
+void FleissKappaStatistic
+::ComputeProportions( const unsigned int n, const unsigned int N,
+  const unsigned int k, std::vector< double > & p, double & Po )
+{
+  p.assign( k, 0.0 );
+  Po = 0.0;
+
+  /** For pooled observations: sum_j n_{ij} ( n_{ij} - 1 ) is twice
+   * the number of agreeing pairs of observers for subject i.
+   */
+  if( this->m_UsePooledObservations )
+  {
+    for( unsigned int j = 0; j < k; ++j )
+    {
+      p[ j ] = this->m_CategoryCounts[ j ] / ( static_cast<double>( n ) * N );
+    }
+    Po = 2.0 * this->m_NumberOfAgreeingPairs / ( n * ( n - 1.0 ) ) / N;
+    return;
+  }
+
+  /** Stream over the subjects in parallel; every thread sums the
+   * ratings per category and sum_j n_{ij} ( n_{ij} - 1 ) of its subjects.
+   */
+  ProportionsThreadStruct str;
+  str.Kappa = this;
+  str.NumberOfObservations = N;
+  MultiThreader::Pointer threader = MultiThreader::New();
+  if( N < static_cast<unsigned int>( threader->GetNumberOfThreads() ) )
+  {
+    threader->SetNumberOfThreads( std::max( N, 1u ) );
+  }
+  const unsigned int numberOfThreads = threader->GetNumberOfThreads();
+  str.CategoryCounts.assign( numberOfThreads, std::vector< unsigned long long >( k, 0 ) );
+  str.AgreeingPairs.assign( numberOfThreads, 0 );
+  threader->SetSingleMethod( Self::ProportionsThreaderCallback, &str );
+  threader->SingleMethodExecute();
+
+  /** Calculate p[ j ] and Po, the average of the P[ i ]. */
+  unsigned long long agreeingPairs = 0;
+  for( unsigned int t = 0; t < numberOfThreads; ++t )
+  {
+    for( unsigned int j = 0; j < k; ++j )
+    {
+      p[ j ] += static_cast<double>( str.CategoryCounts[ t ][ j ] );
+    }
+    agreeingPairs += str.AgreeingPairs[ t ];
+  }
+  for( unsigned int j = 0; j < k; ++j )
+  {
+    p[ j ] /= static_cast<double>( n ) * N;
+  }
+  Po = static_cast<double>( agreeingPairs ) / ( n * ( n - 1.0 ) ) / N;
+
+} // end ComputeProportions()
+
+
+/**
+ * *************** ProportionsThreaderCallback ****************
+ */
+
+ITK_THREAD_RETURN_TYPE FleissKappaStatistic
+::ProportionsThreaderCallback( void * arg )
+{
+  typedef MultiThreader::ThreadInfoStruct ThreadInfoType;
+  ThreadInfoType * info = static_cast<ThreadInfoType *>( arg );
+  ProportionsThreadStruct * str
+    = static_cast<ProportionsThreadStruct *>( info->UserData );
+
+  const unsigned int N = str->NumberOfObservations;
+  const unsigned int begin = static_cast<unsigned int>(
+    static_cast<unsigned long long>( N ) * info->ThreadID / info->NumberOfThreads );
+  const unsigned int end = static_cast<unsigned int>(
+    static_cast<unsigned long long>( N ) * ( info->ThreadID + 1 ) / info->NumberOfThreads );
+
+  std::vector< unsigned long long > & counts = str->CategoryCounts[ info->ThreadID ];
+  unsigned long long agreeingPairs = 0;
+  SampleType ratings, row;
+  for( unsigned int i = begin; i < end; ++i )
+  {
+    str->Kappa->ComputeSubjectCounts( i, ratings, row );
+    for( unsigned int e = 0; e < row.size(); e += 2 )
     {
-      unsigned int ind = this->m_Indices[ this->m_Observations[ l ][ i ] ];
-      this->m_ObservationMatrix[ i ][ ind ]++;
+      const unsigned long long nij = row[ e + 1 ];
+      counts[ row[ e ] ] += nij;
+      agreeingPairs += nij * ( nij - 1 );
     }
   }
+  str->AgreeingPairs[ info->ThreadID ] = agreeingPairs;
 
-} // end ComputeObservationMatrix()
+  return ITK_THREAD_RETURN_VALUE;
+} // end ProportionsThreaderCallback()
 
 
 /**
@@ -64,49 +244,29 @@ void FleissKappaStatistic
 ::ComputeKappaStatisticValue( double & Po, double & Pe, double & kappa )
 {
   /** The observations has to be set previously by the user. */
-  this->CheckObservations( this->m_Observations );
+  if( !this->m_UsePooledObservations )
+  {
+    this->CheckObservations( this->m_Observations );
+  }
 
   /** Get some numbers. */
   unsigned int n = this->GetNumberOfObservers();
   unsigned int N = this->GetNumberOfObservations();
   unsigned int k = this->GetNumberOfCategories();
 
-  /** Compute the observation matrix. */
-  this->ComputeObservationMatrix( n, N, k );
-
   /** We are ready to compute the kappa statistic.
    * This is done in parts:
-   * - calculate p[ j ] and Pe
-   * - calculate P[ i ] and Po
+   * - calculate p[ j ] and Po
+   * - calculate Pe
    */
-  std::vector< double > p( k, 0.0 );
-  std::vector< double > P( N, 0.0 );
-  Po = Pe = kappa = 0.0;
+  std::vector< double > p;
+  this->ComputeProportions( n, N, k, p, Po );
+  Pe = kappa = 0.0;
   for( unsigned int j = 0; j < k; ++j )
   {
-    for( unsigned int i = 0; i < N; ++i )
-    {
-      p[ j ] += static_cast<double>( this->m_ObservationMatrix[ i ][ j ] );
-    }
-    p[ j ] /= static_cast<double>( n * N );
     Pe += p[ j ] * p[ j ];
   }
 
-  for( unsigned int i = 0; i < N; ++i )
-  {
-    for( unsigned int j = 0; j < k; ++j )
-    {
-      double nij = static_cast<double>( this->m_ObservationMatrix[ i ][ j ] );
-      P[ i ] += nij * nij - nij;
-    }
-    P[ i ] /= n * ( n - 1.0 );
-    Po += P[ i ];
-  }
-  Po /= N;
-
-  // the above can probably be done in one loop over i and j,
-  // but this is much better readable.
-
   /** Compute kappa. */
   kappa = ( Po - Pe ) / ( 1.0 - Pe );
 
@@ -122,55 +282,35 @@ void FleissKappaStatistic
   double & Po, double & Pe, double & kappa, double & std, const bool & compare )
 {
   /** The observations has to be set previously by the user. */
-  this->CheckObservations( this->m_Observations );
+  if( !this->m_UsePooledObservations )
+  {
+    this->CheckObservations( this->m_Observations );
+  }
 
   /** Get some numbers. */
   unsigned int n = this->GetNumberOfObservers();
   unsigned int N = this->GetNumberOfObservations();
   unsigned int k = this->GetNumberOfCategories();
 
-  /** Compute the observation matrix. */
-  this->ComputeObservationMatrix( n, N, k );
-
   /** We are ready to compute the kappa statistic.
    * This is done in parts:
-   * - calculate p[ j ] and Pe
-   * - calculate P[ i ] and Po
+   * - calculate p[ j ] and Po
+   * - calculate Pe
    */
-  std::vector< double > p( k, 0.0 );
-  std::vector< double > P( N, 0.0 );
+  std::vector< double > p;
+  this->ComputeProportions( n, N, k, p, Po );
   double p3 = 0.0;
-  Po = Pe = kappa = std = 0.0;
+  Pe = kappa = std = 0.0;
   for( unsigned int j = 0; j < k; ++j )
   {
-    for( unsigned int i = 0; i < N; ++i )
-    {
-      p[ j ] += static_cast<double>( this->m_ObservationMatrix[ i ][ j ] );
-    }
-    p[ j ] /= static_cast<double>( n * N );
     Pe += p[ j ] * p[ j ];
     p3 += p[ j ] * p[ j ] * p[ j ];
   }
 
-  for( unsigned int i = 0; i < N; ++i )
-  {
-    for( unsigned int j = 0; j < k; ++j )
-    {
-      double nij = static_cast<double>( this->m_ObservationMatrix[ i ][ j ] );
-      P[ i ] += nij * nij - nij;
-    }
-    P[ i ] /= n * ( n - 1.0 );
-    Po += P[ i ];
-  }
-  Po /= N;
-
-  // the above can probably be done in one loop over i and j,
-  // but this is much better readable.
-
   /** Compute the standard deviation. */
   std = Pe - ( 2.0 * n - 3.0 ) * Pe * Pe + 2.0 * ( n - 2.0 ) * p3;
   std /= ( 1.0 - Pe ) * ( 1.0 - Pe );
-  std *= 2.0 / ( N * n * ( n - 1.0 ) );
+  std *= 2.0 / ( static_cast<double>( N ) * n * ( n - 1.0 ) );
   std = vcl_sqrt( std );
 
   /** Compute kappa. */
@@ -179,6 +319,90 @@ void FleissKappaStatistic
 } // end ComputeKappaStatisticValueAndStandardDeviation()
 
 
+/**
+ * *************** ComputePatternCounts ****************
+ */
+
+void FleissKappaStatistic
+::ComputePatternCounts( std::vector< double > & patternCounts )
+{
+  if( this->m_UsePooledObservations )
+  {
+    InvalidArgumentError exp(__FILE__, __LINE__);
+    std::ostringstream message;
+    message << "itk::ERROR: " << this->GetNameOfClass()
+      << "(" << this << "): "
+      << "The bootstrap requires the observations, not pooled observations.";
+    exp.SetDescription( message.str() );
+    exp.SetLocation( ITK_LOCATION );
+    throw exp;
+  }
+  this->CheckObservations( this->m_Observations );
+
+  /** Count the distinct compressed rows n_{i.} of the observation matrix. */
+  const unsigned int N = this->GetNumberOfObservations();
+  std::map< SampleType, double > rows;
+  SampleType ratings, row;
+  for( unsigned int i = 0; i < N; ++i )
+  {
+    this->ComputeSubjectCounts( i, ratings, row );
+    rows[ row ] += 1.0;
+  }
+
+  this->m_Patterns.clear();
+  patternCounts.clear();
+  std::map< SampleType, double >::const_iterator it;
+  for( it = rows.begin(); it != rows.end(); ++it )
+  {
+    this->m_Patterns.push_back( it->first );
+    patternCounts.push_back( it->second );
+  }
+
+} // end ComputePatternCounts()
+
+
+/**
+ * *************** ComputeKappaFromPatternCounts ****************
+ */
+
+double FleissKappaStatistic
+::ComputeKappaFromPatternCounts( const std::vector< double > & patternCounts ) const
+{
+  /** As in ComputeKappaStatisticValue(), where every distinct row of
+   * the observation matrix occurs patternCounts[ r ] times. The rows hold
+   * the pairs j, n_{rj} of the nonzero counts.
+   */
+  const double n = this->GetNumberOfObservers();
+  const unsigned int k = this->GetNumberOfCategories();
+  std::vector< double > p( k, 0.0 );
+  double N = 0.0, Po = 0.0, Pe = 0.0;
+  for( unsigned int r = 0; r < this->m_Patterns.size(); ++r )
+  {
+    const double count = patternCounts[ r ];
+    if( count == 0.0 ) continue;
+    const SampleType & row = this->m_Patterns[ r ];
+    double Pr = 0.0;
+    for( unsigned int e = 0; e < row.size(); e += 2 )
+    {
+      const double nrj = static_cast<double>( row[ e + 1 ] );
+      p[ row[ e ] ] += count * nrj;
+      Pr += nrj * nrj - nrj;
+    }
+    Po += count * Pr / ( n * ( n - 1.0 ) );
+    N += count;
+  }
+  Po /= N;
+  for( unsigned int j = 0; j < k; ++j )
+  {
+    p[ j ] /= n * N;
+    Pe += p[ j ] * p[ j ];
+  }
+
+  return ( Po - Pe ) / ( 1.0 - Pe );
+
+} // end ComputeKappaFromPatternCounts()
+
+
 /**
  * *************** PrintSelf ****************
  */
@@ -189,19 +413,18 @@ FleissKappaStatistic
 {
   Superclass::PrintSelf( os, indent );
 
-  /** Print the observation matrix. */
-  unsigned int N = this->m_ObservationMatrix.size();
-  unsigned int k = 0;
-  if( N > 0 ) k = this->m_ObservationMatrix[ 0 ].size();
-  if( N > 0 && k > 0 )
+  /** The observation matrix is not stored; print its distinct rows when
+   * they were computed for the bootstrap, as the pairs j:n_{ij}. */
+  os << indent << "UsePooledObservations: " << this->m_UsePooledObservations << std::endl;
+  if( !this->m_Patterns.empty() )
   {
-    os << indent << "Observation matrix:" << std::endl;
-    for( unsigned int i = 0; i < N; ++i )
+    os << indent << "Distinct rows of the observation matrix:" << std::endl;
+    for( unsigned int r = 0; r < this->m_Patterns.size(); ++r )
     {
       os << indent;
-      for( unsigned int j = 0; j < k; ++j )
+      for( unsigned int e = 0; e < this->m_Patterns[ r ].size(); e += 2 )
       {
-        os << this->m_ObservationMatrix[ i ][ j ] << " ";
+        os << this->m_Patterns[ r ][ e ] << ":" << this->m_Patterns[ r ][ e + 1 ] << " ";
       }
       os << std::endl;
     }
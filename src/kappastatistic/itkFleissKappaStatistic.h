@@ -62,6 +62,23 @@ public:
   typedef Superclass::CategoryType  CategoryType;
   typedef Superclass::SampleType    SampleType;
   typedef Superclass::SamplesType   SamplesType;
+  typedef Superclass::CountType     CountType;
+  typedef std::vector< double >     CategoryCountsType;
+
+  /** Set the observations. This overrides previously set pooled observations. */
+  virtual void SetObservations( const SamplesType observations );
+
+  /** Set pooled observations directly, instead of the observations.
+   * Fleiss' kappa only depends on the number of ratings in every category,
+   * summed over all observers and subjects, and on the number of pairs of
+   * observers that agree, summed over all subjects. This allows to compute
+   * kappa for e.g. a set of label images, without listing every pixel as
+   * an observation. Setting the observations overrides it.
+   */
+  virtual void SetPooledObservations( const CountType numberOfObservers,
+    const CountType numberOfObservations,
+    const CategoryCountsType & categoryCounts,
+    const double numberOfAgreeingPairs );
 
   /** The function that computes the kappa statistic value. */
   virtual void ComputeKappaStatisticValue( double & Po, double & Pe,
@@ -76,17 +93,46 @@ protected:
   virtual ~FleissKappaStatistic() {};
   void PrintSelf( std::ostream& os, Indent indent ) const;
 
+  /** For the bootstrap, the patterns are the distinct rows of the
+   * observation matrix, stored compressed. This requires the observations;
+   * pooled observations can not be resampled.
+   */
+  virtual void ComputePatternCounts( std::vector< double > & patternCounts );
+
+  /** Compute kappa from resampled counts of the distinct rows. */
+  virtual double ComputeKappaFromPatternCounts(
+    const std::vector< double > & patternCounts ) const;
+
 private:
   FleissKappaStatistic(const Self&); // purposely not implemented
   void operator=(const Self&);       // purposely not implemented
 
-  /** A helper function that calculate the observation matrix,
-   * i.e. the n_{ij}.
+  /** A helper function that computes row i of the observation matrix,
+   * i.e. the n_{ij}, in compressed form: the row holds the pairs j, n_{ij}
+   * of the nonzero counts, sorted by j. A subject has at most n nonzero
+   * counts, so the dense N by k matrix is never stored. The ratings are
+   * a buffer of size n.
+   */
+  void ComputeSubjectCounts( const unsigned int i,
+    SampleType & ratings, SampleType & row ) const;
+
+  /** A helper function that computes the proportion p_j of all ratings
+   * in category j and the observed agreement Po, either from the
+   * observations or from the pooled observations. The observations are
+   * streamed subject by subject, in parallel.
    */
-  void ComputeObservationMatrix( const unsigned int n,
-    const unsigned int N, const unsigned int k );
+  void ComputeProportions( const unsigned int n, const unsigned int N,
+    const unsigned int k, std::vector< double > & p, double & Po );
+
+  /** The data shared by the threads of ComputeProportions(), and their
+   * callback. */
+  struct ProportionsThreadStruct;
+  static ITK_THREAD_RETURN_TYPE ProportionsThreaderCallback( void * arg );
 
-  SamplesType m_ObservationMatrix;
+  SamplesType         m_Patterns;
+  bool                m_UsePooledObservations;
+  CategoryCountsType  m_CategoryCounts;
+  double              m_NumberOfAgreeingPairs;
 
 }; // end class FleissKappaStatistic
 
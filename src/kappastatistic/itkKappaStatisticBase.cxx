@@ -1,5 +1,9 @@
 #include "itkKappaStatisticBase.h"
 
+#include "itkMultiThreader.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include <algorithm>
+
 namespace itk {
 namespace Statistics {
 
@@ -157,6 +161,182 @@ bool KappaStatisticBase
 } // end CheckObservations()
 
 
+/** The data shared by the bootstrap threads. */
+struct KappaStatisticBase::BootstrapThreadStruct
+{
+  const KappaStatisticBase *  Kappa;
+  std::vector< double >       Probabilities;
+  std::vector< unsigned int > Aliases;
+  unsigned long               NumberOfObservations;
+  unsigned int                Seed;
+  KappaValuesType *           Kappas;
+};
+
+
+/**
+ * *************** ComputeBootstrapKappaValues ****************
+ */
+
+void KappaStatisticBase
+::ComputeBootstrapKappaValues( const unsigned int numberOfSamples,
+  const unsigned int seed, KappaValuesType & kappas )
+{
+  /** Summarize the observations. */
+  std::vector< double > patternCounts;
+  this->ComputePatternCounts( patternCounts );
+  const unsigned int P = patternCounts.size();
+  double N = 0.0;
+  for( unsigned int p = 0; p < P; ++p )
+  {
+    N += patternCounts[ p ];
+  }
+  if( P == 0 || N < 1.0 )
+  {
+    InvalidArgumentError exp(__FILE__, __LINE__);
+    std::ostringstream message;
+    message << "itk::ERROR: " << this->GetNameOfClass()
+      << "(" << this << "): "
+      << "No observations to resample.";
+    exp.SetDescription( message.str() );
+    exp.SetLocation( ITK_LOCATION );
+    throw exp;
+  }
+
+  /** Construct the alias table of the pattern distribution (Vose),
+   * so that every draw takes constant time.
+   */
+  BootstrapThreadStruct str;
+  str.Kappa = this;
+  str.Probabilities.assign( P, 1.0 );
+  str.Aliases.resize( P );
+  str.NumberOfObservations = static_cast<unsigned long>( N + 0.5 );
+  str.Seed = seed;
+  str.Kappas = &kappas;
+
+  std::vector< double > scaled( P );
+  std::vector< unsigned int > small, large;
+  for( unsigned int p = 0; p < P; ++p )
+  {
+    str.Aliases[ p ] = p;
+    scaled[ p ] = patternCounts[ p ] * P / N;
+    if( scaled[ p ] < 1.0 ) small.push_back( p );
+    else large.push_back( p );
+  }
+  while( !small.empty() && !large.empty() )
+  {
+    const unsigned int s = small.back(); small.pop_back();
+    const unsigned int l = large.back();
+    str.Probabilities[ s ] = scaled[ s ];
+    str.Aliases[ s ] = l;
+    scaled[ l ] -= 1.0 - scaled[ s ];
+    if( scaled[ l ] < 1.0 )
+    {
+      large.pop_back();
+      small.push_back( l );
+    }
+  }
+
+  /** Compute the resamplings in parallel. */
+  kappas.assign( numberOfSamples, 0.0 );
+  MultiThreader::Pointer threader = MultiThreader::New();
+  if( numberOfSamples < static_cast<unsigned int>( threader->GetNumberOfThreads() ) )
+  {
+    threader->SetNumberOfThreads( std::max( numberOfSamples, 1u ) );
+  }
+  threader->SetSingleMethod( Self::BootstrapThreaderCallback, &str );
+  threader->SingleMethodExecute();
+
+} // end ComputeBootstrapKappaValues()
+
+
+/**
+ * *************** BootstrapThreaderCallback ****************
+ */
+
+ITK_THREAD_RETURN_TYPE KappaStatisticBase
+::BootstrapThreaderCallback( void * arg )
+{
+  typedef MultiThreader::ThreadInfoStruct                   ThreadInfoType;
+  typedef MersenneTwisterRandomVariateGenerator             RandomGeneratorType;
+  ThreadInfoType * info = static_cast<ThreadInfoType *>( arg );
+  BootstrapThreadStruct * str
+    = static_cast<BootstrapThreadStruct *>( info->UserData );
+
+  const unsigned int numberOfSamples = str->Kappas->size();
+  const unsigned int begin = static_cast<unsigned int>(
+    static_cast<unsigned long long>( numberOfSamples ) * info->ThreadID / info->NumberOfThreads );
+  const unsigned int end = static_cast<unsigned int>(
+    static_cast<unsigned long long>( numberOfSamples ) * ( info->ThreadID + 1 ) / info->NumberOfThreads );
+
+  const unsigned int P = str->Probabilities.size();
+  std::vector< double > counts( P );
+  RandomGeneratorType::Pointer generator = RandomGeneratorType::New();
+  for( unsigned int b = begin; b < end; ++b )
+  {
+    generator->Initialize( str->Seed + b );
+    std::fill( counts.begin(), counts.end(), 0.0 );
+    for( unsigned long i = 0; i < str->NumberOfObservations; ++i )
+    {
+      const double x = generator->GetVariateWithOpenUpperRange() * P;
+      unsigned int p = std::min( static_cast<unsigned int>( x ), P - 1 );
+      if( x - p >= str->Probabilities[ p ] ) p = str->Aliases[ p ];
+      ++counts[ p ];
+    }
+    ( *str->Kappas )[ b ] = str->Kappa->ComputeKappaFromPatternCounts( counts );
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+} // end BootstrapThreaderCallback()
+
+
+/**
+ * *************** ComputeBootstrapConfidenceInterval ****************
+ */
+
+void KappaStatisticBase
+::ComputeBootstrapConfidenceInterval( const unsigned int numberOfSamples,
+  const double confidence, const unsigned int seed,
+  double & lower, double & upper, double & std )
+{
+  if( numberOfSamples == 0 )
+  {
+    InvalidArgumentError exp(__FILE__, __LINE__);
+    std::ostringstream message;
+    message << "itk::ERROR: " << this->GetNameOfClass()
+      << "(" << this << "): "
+      << "The number of bootstrap samples should be positive.";
+    exp.SetDescription( message.str() );
+    exp.SetLocation( ITK_LOCATION );
+    throw exp;
+  }
+
+  KappaValuesType kappas;
+  this->ComputeBootstrapKappaValues( numberOfSamples, seed, kappas );
+  std::sort( kappas.begin(), kappas.end() );
+
+  /** The percentile interval. */
+  const double alpha = ( 1.0 - confidence ) / 2.0;
+  const unsigned int last = kappas.size() - 1;
+  lower = kappas[ static_cast<unsigned int>( alpha * last + 0.5 ) ];
+  upper = kappas[ static_cast<unsigned int>( ( 1.0 - alpha ) * last + 0.5 ) ];
+
+  /** The standard deviation. */
+  double mean = 0.0;
+  for( unsigned int b = 0; b < kappas.size(); ++b )
+  {
+    mean += kappas[ b ];
+  }
+  mean /= kappas.size();
+  std = 0.0;
+  for( unsigned int b = 0; b < kappas.size(); ++b )
+  {
+    std += ( kappas[ b ] - mean ) * ( kappas[ b ] - mean );
+  }
+  std = kappas.size() > 1 ? vcl_sqrt( std / ( kappas.size() - 1.0 ) ) : 0.0;
+
+} // end ComputeBootstrapConfidenceInterval()
+
+
 /**
  * *************** PrintSelf ****************
  */
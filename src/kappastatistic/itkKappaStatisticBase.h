@@ -20,6 +20,7 @@
 
 #include "itkObject.h"
 #include "itkObjectFactory.h"
+#include "itkMultiThreader.h"
 #include <vector>
 #include <map>
 #include "vnl/vnl_math.h"
@@ -87,6 +88,27 @@ public:
   virtual void ComputeKappaStatisticValueAndStandardDeviation(
     double & Po, double & Pe, double & kappa, double & std, const bool & compare ) = 0;
 
+  /** The kappa values of bootstrap resamplings. */
+  typedef std::vector< double >       KappaValuesType;
+
+  /** Compute the kappa value of numberOfSamples bootstrap resamplings of
+   * the observations. Every resampling draws N observations with
+   * replacement. The observations are summarized once into the counts of
+   * their distinct patterns, so that a resampling only redraws these
+   * counts. The resamplings are distributed over the threads; resampling
+   * b uses its own random stream, initialized with seed + b, so that the
+   * result does not depend on the number of threads.
+   */
+  virtual void ComputeBootstrapKappaValues( const unsigned int numberOfSamples,
+    const unsigned int seed, KappaValuesType & kappas );
+
+  /** Compute the percentile confidence interval of kappa, from
+   * numberOfSamples bootstrap resamplings, and their standard deviation.
+   */
+  virtual void ComputeBootstrapConfidenceInterval( const unsigned int numberOfSamples,
+    const double confidence, const unsigned int seed,
+    double & lower, double & upper, double & std );
+
 protected:
   KappaStatisticBase();
   virtual ~KappaStatisticBase() {};
@@ -95,6 +117,24 @@ protected:
   /** Function to check if the input is valid. */
   virtual bool CheckObservations( const SamplesType & observations ) const;
 
+  /** Set the numbers directly, for subclasses that accept summarized
+   * observations instead of m_Observations.
+   */
+  itkSetMacro( NumberOfObservers, CountType );
+  itkSetMacro( NumberOfObservations, CountType );
+  itkSetMacro( NumberOfCategories, CountType );
+
+  /** Summarize the observations for the bootstrap: patternCounts[ p ] is
+   * the number of observations with the (subclass defined) pattern p.
+   */
+  virtual void ComputePatternCounts( std::vector< double > & patternCounts ) = 0;
+
+  /** Compute kappa from resampled pattern counts. This is called
+   * concurrently from several threads.
+   */
+  virtual double ComputeKappaFromPatternCounts(
+    const std::vector< double > & patternCounts ) const = 0;
+
   SamplesType m_Observations;
   std::map<unsigned int,unsigned int>  m_Indices;
 
@@ -102,6 +142,10 @@ private:
   KappaStatisticBase(const Self&); // purposely not implemented
   void operator=(const Self&);     // purposely not implemented
 
+  /** The data shared by the bootstrap threads, and their callback. */
+  struct BootstrapThreadStruct;
+  static ITK_THREAD_RETURN_TYPE BootstrapThreaderCallback( void * arg );
+
   /** Compute the number of observers. */
   virtual void ComputeNumberOfObservers( void );
 
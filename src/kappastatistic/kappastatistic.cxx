@@ -23,6 +23,7 @@
 #include "itkCommandLineArgumentParser.h"
 #include "ITKToolsHelpers.h"
 #include "KappaStatisticMainHelper.h"
+#include "KappaStatisticImageCounts.h"
 
 #include "itkFleissKappaStatistic.h"
 #include "itkCohenWeightedKappaStatistic.h"
@@ -39,6 +40,9 @@ std::string GetHelpString( void )
     << "Usage:" << std::endl
     << "pxkappastatistic" << std::endl
     << "  -in      inputFilename" << std::endl
+    << "  [-images] label image filenames, one per observer, instead of \"-in\" and \"-c\"" << std::endl
+    << "           every pixel is an observation; the images are summarized in a" << std::endl
+    << "           multi-threaded pass, without writing the pixels to a text file." << std::endl
     << "  -type    the type of the kappa test:" << std::endl
     << "             fleiss: unweighted, for many observers" << std::endl
     << "             cohen: weighted, for two observers only" << std::endl
@@ -51,6 +55,11 @@ std::string GetHelpString( void )
     << "  [-cmp]   use this option to specify a kappa to which you want to compare" << std::endl
     << "           the found kappa. The returned standard deviation is different if" << std::endl
     << "           this option is not specified." << std::endl
+    << "  [-bootstrap] the number of bootstrap resamplings of the observations," << std::endl
+    << "           to compute a percentile confidence interval of kappa in parallel" << std::endl
+    << "           for fleiss, not in combination with \"-images\"" << std::endl
+    << "  [-confidence] the confidence level of the interval, default 0.95" << std::endl
+    << "  [-seed]  the seed of the bootstrap random streams, default 0" << std::endl
     << "  [-out]   output, choose one of {kappa,all,ALL}, default all" << std::endl
     << "             kappa: only print the kappa-value" << std::endl
     << "             all: print all" << std::endl
@@ -59,6 +68,7 @@ std::string GetHelpString( void )
     << "The input file should be in a certain format. No text is allowed." << std::endl
     << "No headers are allowed. The data samples should be displayed in columns." << std::endl
     << "Columns should be separated by a single space or tab." << std::endl
+    << "Supported images: 2D, 3D, (unsigned) char, (unsigned) short." << std::endl
     << "For more information about the kappa statistic and this implementation, read the tex-file found in the repository.";
 
   return ss.str();
@@ -72,9 +82,15 @@ int main( int argc, char **argv )
   parser->SetCommandLineArguments( argc, argv );
   parser->SetProgramHelpText( GetHelpString() );
 
-  parser->MarkArgumentAsRequired( "-in", "The input filename." );
+  std::vector<std::string> imageFileNames;
+  bool retimages = parser->GetCommandLineArgument( "-images", imageFileNames );
+
+  if( !retimages )
+  {
+    parser->MarkArgumentAsRequired( "-in", "The input filename." );
+    parser->MarkArgumentAsRequired( "-c", "Columns." );
+  }
   parser->MarkArgumentAsRequired( "-type", "The type." );
-  parser->MarkArgumentAsRequired( "-c", "Columns." );
 
   itk::CommandLineArgumentParser::ReturnValue validateArguments = parser->CheckForRequiredArguments();
 
@@ -87,6 +103,9 @@ int main( int argc, char **argv )
     return EXIT_SUCCESS;
   }
 
+  /** Threading. */
+  itktools::ReadThreadingArguments( parser );
+
   /** Get arguments. */
   std::string inputFileName = "";
   bool retin = parser->GetCommandLineArgument( "-in", inputFileName );
@@ -111,6 +130,15 @@ int main( int argc, char **argv )
   double kappacmp = 0.0;
   bool retcmp = parser->GetCommandLineArgument( "-cmp", kappacmp );
 
+  unsigned int bootstrapSamples = 0;
+  parser->GetCommandLineArgument( "-bootstrap", bootstrapSamples );
+
+  double confidence = 0.95;
+  parser->GetCommandLineArgument( "-confidence", confidence );
+
+  unsigned int seed = 0;
+  parser->GetCommandLineArgument( "-seed", seed );
+
   /** Check command line arguments. */
   type = itksys::SystemTools::LowerCase( type );
   if( type != "fleiss" && type != "cohen" )
@@ -119,7 +147,19 @@ int main( int argc, char **argv )
     return EXIT_FAILURE;
   }
 
-  if( columns.size() < 2 )
+  if( retimages && imageFileNames.size() < 2 )
+  {
+    std::cerr << "ERROR: You should specify at least two images with \"-images\"." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if( retimages && type == "cohen" && imageFileNames.size() != 2 )
+  {
+    std::cerr << "ERROR: The cohen kappa requires exactly two images." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if( !retimages && columns.size() < 2 )
   {
     std::cerr << "ERROR: You should specify at least two columns with \"-c\"." << std::endl;
     return EXIT_FAILURE;
@@ -132,12 +172,67 @@ int main( int argc, char **argv )
     return EXIT_FAILURE;
   }
 
+  if( confidence <= 0.0 || confidence >= 1.0 )
+  {
+    std::cerr << "ERROR: The confidence should be between 0 and 1." << std::endl;
+    return EXIT_FAILURE;
+  }
+
   if( retcmp ) exstd = true;
 
-  /** Read the input file. */
+  /** Read the input file, or summarize the input images. */
   std::vector< std::vector<unsigned int> > matrix;
-  retin = GetInputData( inputFileName, columns, matrix );
-  if( !retin ) return EXIT_FAILURE;
+  ITKToolsKappaStatisticImageCountsBase * counts = 0;
+  if( !retimages )
+  {
+    retin = GetInputData( inputFileName, columns, matrix );
+    if( !retin ) return EXIT_FAILURE;
+  }
+  else
+  {
+    /** Determine image properties. */
+    itk::ImageIOBase::IOPixelType pixelType = itk::ImageIOBase::UNKNOWNPIXELTYPE;
+    itk::ImageIOBase::IOComponentType componentType = itk::ImageIOBase::UNKNOWNCOMPONENTTYPE;
+    unsigned int dim = 0;
+    unsigned int numberOfComponents = 0;
+    bool retgip = itktools::GetImageProperties(
+      imageFileNames[ 0 ], pixelType, componentType, dim, numberOfComponents );
+    if( !retgip ) return EXIT_FAILURE;
+
+    /** Check for vector images. */
+    bool retNOCCheck = itktools::NumberOfComponentsCheck( numberOfComponents );
+    if( !retNOCCheck ) return EXIT_FAILURE;
+
+    try
+    {
+      // now call all possible template combinations.
+      if( !counts ) counts = ITKToolsKappaStatisticImageCounts< 2, char >::New( dim, componentType );
+      if( !counts ) counts = ITKToolsKappaStatisticImageCounts< 2, unsigned char >::New( dim, componentType );
+      if( !counts ) counts = ITKToolsKappaStatisticImageCounts< 2, short >::New( dim, componentType );
+      if( !counts ) counts = ITKToolsKappaStatisticImageCounts< 2, unsigned short >::New( dim, componentType );
+
+#ifdef ITKTOOLS_3D_SUPPORT
+      if( !counts ) counts = ITKToolsKappaStatisticImageCounts< 3, char >::New( dim, componentType );
+      if( !counts ) counts = ITKToolsKappaStatisticImageCounts< 3, unsigned char >::New( dim, componentType );
+      if( !counts ) counts = ITKToolsKappaStatisticImageCounts< 3, short >::New( dim, componentType );
+      if( !counts ) counts = ITKToolsKappaStatisticImageCounts< 3, unsigned short >::New( dim, componentType );
+#endif
+      /** Check if filter was instantiated. */
+      bool supported = itktools::IsFilterSupportedCheck( counts, dim, componentType );
+      if( !supported ) return EXIT_FAILURE;
+
+      /** Set the filter arguments. */
+      counts->m_InputFileNames = imageFileNames;
+
+      counts->Run();
+    }
+    catch( itk::ExceptionObject & excp )
+    {
+      std::cerr << "ERROR: Caught ITK exception: " << excp << std::endl;
+      delete counts;
+      return EXIT_FAILURE;
+    }
+  }
 
   /** Typedefs. */
   typedef itk::Statistics::FleissKappaStatistic         FleissType;
@@ -149,13 +244,23 @@ int main( int argc, char **argv )
   CohenType::Pointer cohen = CohenType::New();
   unsigned int n = 0, N = 0, k = 0;
   double Po, Pe, kappa, std;
+  double lower = 0.0, upper = 0.0, bootstrapStd = 0.0;
 
   /** Compute kappa. */
   try
   {
     if( type == "fleiss" )
     {
-      fleiss->SetObservations( matrix );
+      if( counts )
+      {
+        fleiss->SetPooledObservations( imageFileNames.size(),
+          counts->m_NumberOfObservations, counts->m_CategoryCounts,
+          counts->m_NumberOfAgreeingPairs );
+      }
+      else
+      {
+        fleiss->SetObservations( matrix );
+      }
 
       n = fleiss->GetNumberOfObservers();
       N = fleiss->GetNumberOfObservations();
@@ -169,10 +274,23 @@ int main( int argc, char **argv )
       {
         fleiss->ComputeKappaStatisticValue( Po, Pe, kappa );
       }
+
+      if( bootstrapSamples > 0 )
+      {
+        fleiss->ComputeBootstrapConfidenceInterval(
+          bootstrapSamples, confidence, seed, lower, upper, bootstrapStd );
+      }
     }
     else if( type == "cohen" )
     {
-      cohen->SetObservations( matrix );
+      if( counts )
+      {
+        cohen->SetConfusionMatrix( counts->m_ConfusionMatrix );
+      }
+      else
+      {
+        cohen->SetObservations( matrix );
+      }
 
       n = cohen->GetNumberOfObservers();
       N = cohen->GetNumberOfObservations();
@@ -187,11 +305,18 @@ int main( int argc, char **argv )
       {
         cohen->ComputeKappaStatisticValue( Po, Pe, kappa );
       }
+
+      if( bootstrapSamples > 0 )
+      {
+        cohen->ComputeBootstrapConfidenceInterval(
+          bootstrapSamples, confidence, seed, lower, upper, bootstrapStd );
+      }
     }
   }
   catch( itk::ExceptionObject & excp )
   {
     std::cerr << "ERROR: Caught ITK exception: " << excp << std::endl;
+    delete counts;
     return EXIT_FAILURE;
   }
 
@@ -206,6 +331,15 @@ int main( int argc, char **argv )
     std::cout << "# observers:    " << n << std::endl;
     std::cout << "# observations: " << N << std::endl;
     std::cout << "# categories:   " << k << std::endl;
+    if( counts )
+    {
+      std::cout << "Categories:    ";
+      for( std::size_t i = 0; i < counts->m_Labels.size(); ++i )
+      {
+        std::cout << " " << counts->m_Labels[ i ];
+      }
+      std::cout << std::endl;
+    }
     if( type == "cohen" )
     {
       std::cout << "WeightsName:    " << cohen->GetWeightsName() << std::endl;
@@ -219,6 +353,14 @@ int main( int argc, char **argv )
       std::cout << "standard deviation:    " << std << std::endl;
     }
 
+    if( bootstrapSamples > 0 )
+    {
+      std::cout << "bootstrap samples:     " << bootstrapSamples << std::endl;
+      std::cout << "bootstrap std:         " << bootstrapStd << std::endl;
+      std::cout << "confidence interval:   [" << lower << ", " << upper
+        << "] (" << 100.0 * confidence << "%)" << std::endl;
+    }
+
     if( output == "ALL" )
     {
       if( type == "fleiss" ) fleiss->Print( std::cout );
@@ -227,6 +369,7 @@ int main( int argc, char **argv )
   }
 
   /** End program. */
+  delete counts;
   return EXIT_SUCCESS;
 
 } // end main
@@ -0,0 +1,117 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkWordParallelLogicalImageFilter_h_
+#define __itkWordParallelLogicalImageFilter_h_
+
+#include "itkInPlaceImageFilter.h"
+#include "itkBinaryLogicalFunctors.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/** \class WordParallelLogicalImageFilter
+ * \brief Logical operators on binary images of one byte per pixel, eight
+ * pixels at a time.
+ *
+ * The pixels of binary images with the values 0 and 1 are the bytes of
+ * 64 bit words with only the lowest bit of every byte set. The logical
+ * operators then follow from the bitwise operators on the words, with the
+ * negation an exclusive or with 0x0101010101010101. The filter loads
+ * eight pixels per word from each input, with one instruction per
+ * operator, where the functor filters need one per pixel. The number of
+ * nonzero pixels of the output is the sum of the bytes of the words,
+ * which is counted on the fly.
+ *
+ * With two inputs the filter computes the operator given by SetOperator,
+ * with one input it computes NOT. The inputs must be binary, see
+ * IsBinary(); the pixel type must be (unsigned) char, and the images
+ * must be itk::Images.
+ *
+ * \ingroup IntensityImageFilters MultiThreaded
+ */
+
+template< class TImage >
+class ITK_EXPORT WordParallelLogicalImageFilter :
+  public InPlaceImageFilter< TImage, TImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef WordParallelLogicalImageFilter      Self;
+  typedef InPlaceImageFilter< TImage, TImage > Superclass;
+  typedef SmartPointer<Self>                  Pointer;
+  typedef SmartPointer<const Self>            ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( WordParallelLogicalImageFilter, InPlaceImageFilter );
+
+  /** Typedefs. */
+  typedef TImage                                      ImageType;
+  typedef typename ImageType::PixelType               PixelType;
+  typedef typename Superclass::OutputImageRegionType  OutputImageRegionType;
+  typedef unsigned long long                          WordType;
+
+  itkStaticConstMacro( ImageDimension, unsigned int, TImage::ImageDimension );
+
+  /** Set/Get the operator for two inputs. Default AND. */
+  itkSetEnumMacro( Operator, BinaryFunctorEnum );
+  itkGetEnumMacro( Operator, BinaryFunctorEnum );
+
+  /** Get the number of nonzero pixels of the output. */
+  itkGetConstMacro( NumberOfNonzeroPixels, SizeValueType );
+
+  /** Whether all pixels of the buffer of an image are 0 or 1. */
+  static bool IsBinary( const ImageType * image );
+
+protected:
+  WordParallelLogicalImageFilter();
+  virtual ~WordParallelLogicalImageFilter() {};
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** Reset and sum the counts of the threads. */
+  virtual void BeforeThreadedGenerateData( void );
+  virtual void AfterThreadedGenerateData( void );
+
+  /** Apply the operator to the runs of contiguous pixels of the region. */
+  void ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+    ThreadIdType threadId );
+
+  /** Apply the operator to a word, or a pixel, of the inputs. */
+  inline WordType Apply( WordType a, WordType b, WordType one ) const;
+
+private:
+  WordParallelLogicalImageFilter( const Self & ); // purposely not implemented
+  void operator=( const Self & );                 // purposely not implemented
+
+  BinaryFunctorEnum           m_Operator;
+  SizeValueType               m_NumberOfNonzeroPixels;
+  std::vector<SizeValueType>  m_ThreadCounts;
+
+}; // end class WordParallelLogicalImageFilter
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkWordParallelLogicalImageFilter.txx"
+#endif
+
+#endif // end #ifndef __itkWordParallelLogicalImageFilter_h_
@@ -0,0 +1,237 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkWordParallelLogicalImageFilter_txx_
+#define __itkWordParallelLogicalImageFilter_txx_
+
+#include "itkWordParallelLogicalImageFilter.h"
+#include "itkProgressReporter.h"
+
+#include <cstring>
+
+namespace itk
+{
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template< class TImage >
+WordParallelLogicalImageFilter< TImage >
+::WordParallelLogicalImageFilter()
+{
+  this->m_Operator = AND;
+  this->m_NumberOfNonzeroPixels = 0;
+
+} // end Constructor
+
+
+/**
+ * ******************* IsBinary *******************
+ */
+
+template< class TImage >
+bool
+WordParallelLogicalImageFilter< TImage >
+::IsBinary( const ImageType * image )
+{
+  const PixelType * buffer = image->GetBufferPointer();
+  const SizeValueType n = image->GetBufferedRegion().GetNumberOfPixels();
+  const WordType one = 0x0101010101010101ULL;
+
+  /** All bits but the lowest of every byte are zero. */
+  SizeValueType i = 0;
+  for( ; i + sizeof( WordType ) <= n; i += sizeof( WordType ) )
+  {
+    WordType word;
+    std::memcpy( &word, buffer + i, sizeof( WordType ) );
+    if( word & ~one ) return false;
+  }
+  for( ; i < n; ++i )
+  {
+    if( buffer[ i ] != 0 && buffer[ i ] != 1 ) return false;
+  }
+  return true;
+
+} // end IsBinary()
+
+
+/**
+ * ******************* BeforeThreadedGenerateData *******************
+ */
+
+template< class TImage >
+void
+WordParallelLogicalImageFilter< TImage >
+::BeforeThreadedGenerateData( void )
+{
+  this->m_ThreadCounts.assign( this->GetNumberOfThreads(), 0 );
+
+} // end BeforeThreadedGenerateData()
+
+
+/**
+ * ******************* AfterThreadedGenerateData *******************
+ */
+
+template< class TImage >
+void
+WordParallelLogicalImageFilter< TImage >
+::AfterThreadedGenerateData( void )
+{
+  this->m_NumberOfNonzeroPixels = 0;
+  for( unsigned int t = 0; t < this->m_ThreadCounts.size(); ++t )
+  {
+    this->m_NumberOfNonzeroPixels += this->m_ThreadCounts[ t ];
+  }
+
+} // end AfterThreadedGenerateData()
+
+
+/**
+ * ******************* Apply *******************
+ */
+
+template< class TImage >
+typename WordParallelLogicalImageFilter< TImage >::WordType
+WordParallelLogicalImageFilter< TImage >
+::Apply( WordType a, WordType b, WordType one ) const
+{
+  switch( this->m_Operator )
+  {
+    case AND:     return a & b;
+    case OR:      return a | b;
+    case XOR:     return a ^ b;
+    case ANDNOT:  return a & ( b ^ one );
+    case ORNOT:   return a | ( b ^ one );
+    case NOT_XOR: return a ^ b ^ one;
+    case NOT_OR:  return ( a | b ) ^ one;
+    case NOT_AND: return ( a & b ) ^ one;
+    case DUMMY:   return one;
+  }
+  return 0;
+
+} // end Apply()
+
+
+/**
+ * ******************* ThreadedGenerateData *******************
+ */
+
+template< class TImage >
+void
+WordParallelLogicalImageFilter< TImage >
+::ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+  ThreadIdType threadId )
+{
+  typedef typename OutputImageRegionType::SizeType    SizeType;
+  typedef typename OutputImageRegionType::IndexType   IndexType;
+
+  const bool unary = this->GetNumberOfInputs() < 2;
+  const ImageType * input1 = this->GetInput( 0 );
+  const ImageType * input2 = unary ? input1 : this->GetInput( 1 );
+  ImageType * output = this->GetOutput( 0 );
+
+  const SizeType size = outputRegionForThread.GetSize();
+  if( outputRegionForThread.GetNumberOfPixels() == 0 ) return;
+
+  /** The run of contiguous pixels: the region spans all the buffers in
+   * the dimensions below runDimension. */
+  SizeValueType runLength = size[ 0 ];
+  unsigned int runDimension = 0;
+  while( runDimension + 1 < ImageDimension
+    && size[ runDimension ] == input1->GetBufferedRegion().GetSize()[ runDimension ]
+    && size[ runDimension ] == input2->GetBufferedRegion().GetSize()[ runDimension ]
+    && size[ runDimension ] == output->GetBufferedRegion().GetSize()[ runDimension ] )
+  {
+    ++runDimension;
+    runLength *= size[ runDimension ];
+  }
+  const SizeValueType numberOfRuns
+    = outputRegionForThread.GetNumberOfPixels() / runLength;
+
+  const WordType one = 0x0101010101010101ULL;
+  SizeValueType count = 0;
+  ProgressReporter progress( this, threadId, numberOfRuns );
+
+  IndexType index = outputRegionForThread.GetIndex();
+  const IndexType start = index;
+  for( SizeValueType r = 0; r < numberOfRuns; ++r )
+  {
+    const PixelType * in1 = input1->GetBufferPointer() + input1->ComputeOffset( index );
+    const PixelType * in2 = input2->GetBufferPointer() + input2->ComputeOffset( index );
+    PixelType * out = output->GetBufferPointer() + output->ComputeOffset( index );
+
+    /** Eight pixels at a time. The sum of the bytes of a word is at most
+     * eight, so it is found in the top byte of the product with one. */
+    SizeValueType i = 0;
+    for( ; i + sizeof( WordType ) <= runLength; i += sizeof( WordType ) )
+    {
+      WordType a, b;
+      std::memcpy( &a, in1 + i, sizeof( WordType ) );
+      std::memcpy( &b, in2 + i, sizeof( WordType ) );
+      const WordType c = unary ? a ^ one : this->Apply( a, b, one );
+      std::memcpy( out + i, &c, sizeof( WordType ) );
+      count += static_cast<SizeValueType>( ( c * one ) >> 56 );
+    }
+
+    /** The remaining pixels. */
+    for( ; i < runLength; ++i )
+    {
+      const WordType a = static_cast<WordType>( in1[ i ] );
+      const WordType b = static_cast<WordType>( in2[ i ] );
+      const WordType c = unary ? a ^ 1 : this->Apply( a, b, 1 );
+      out[ i ] = static_cast<PixelType>( c );
+      count += static_cast<SizeValueType>( c );
+    }
+    progress.CompletedPixel();
+
+    /** The start of the next run. */
+    for( unsigned int d = runDimension + 1; d < ImageDimension; ++d )
+    {
+      if( ++index[ d ] < start[ d ] + static_cast<OffsetValueType>( size[ d ] ) )
+      {
+        break;
+      }
+      index[ d ] = start[ d ];
+    }
+  }
+
+  this->m_ThreadCounts[ threadId ] = count;
+
+} // end ThreadedGenerateData()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template< class TImage >
+void
+WordParallelLogicalImageFilter< TImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "Operator: " << this->m_Operator << std::endl;
+  os << indent << "NumberOfNonzeroPixels: " << this->m_NumberOfNonzeroPixels << std::endl;
+
+} // end PrintSelf()
+
+} // end namespace itk
+
+#endif // end #ifndef __itkWordParallelLogicalImageFilter_txx_
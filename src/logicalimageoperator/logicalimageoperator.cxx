@@ -62,8 +62,11 @@ std::string GetHelpString( void )
     << "           Internally this expression is simplified.\n"
     << "  [-z]     compression flag; if provided, the output image is compressed\n"
     << "  [-arg]   argument, necessary for some ops\n"
+    << "  [-count] print the number of nonzero voxels of the output\n"
     << "  [-dim]   dimension, default: automatically determined from inputimage1\n"
     << "  [-pt]    pixelType, default: automatically determined from inputimage1\n"
+    << "Binary (unsigned) char images with values 0 and 1 are processed eight\n"
+    << "voxels at a time.\n"
     << "Supported: 2D, 3D, (unsigned) short, (unsigned) char.\n"
     << "NOTE: for historical reasons this functionality is not part of the unary or binary image operator." << std::endl;
 
@@ -107,6 +110,7 @@ int main( int argc, char **argv )
   bool retarg = parser->GetCommandLineArgument( "-arg", argument );
 
   const bool useCompression = parser->ArgumentExists( "-z" );
+  const bool printCount = parser->ArgumentExists( "-count" );
 
   /** Check if the required arguments are given. */
   if( inputFileNames.size() != 2 && ops != "NOT" && ops != "NOT_NOT" && ops != "EQUAL" )
@@ -198,7 +202,10 @@ int main( int argc, char **argv )
     filter->m_UseCompression = useCompression;
     filter->m_Argument = argument;
     filter->m_Unary = unary;
+    filter->m_NumberOfComponents = numberOfComponents;
+    filter->m_PrintCount = printCount;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
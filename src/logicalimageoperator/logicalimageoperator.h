@@ -22,6 +22,7 @@
 #include "itkBinaryFunctorImageFilter.h"
 #include "itkUnaryLogicalFunctors.h"
 #include "itkBinaryLogicalFunctors.h"
+#include "itkWordParallelLogicalImageFilter.h"
 
 #include "itkVectorImage.h"
 #include "itkImageFileReader.h"
@@ -55,6 +56,8 @@ public:
     this->m_UseCompression = false;
     this->m_Argument = 0.0f;
     this->m_Unary = false;
+    this->m_NumberOfComponents = 1;
+    this->m_PrintCount = false;
   };
   /** Destructor. */
   ~ITKToolsLogicalImageOperatorBase(){};
@@ -67,6 +70,8 @@ public:
   bool m_UseCompression;
   double m_Argument;
   bool m_Unary; // is the operator to be performed unary? (else it is binary)
+  unsigned int m_NumberOfComponents;
+  bool m_PrintCount;
 
 }; // end class ITKToolsLogicalImageOperatorBase
 
@@ -88,20 +93,172 @@ public:
   ITKToolsLogicalImageOperator(){};
   ~ITKToolsLogicalImageOperator(){};
 
+  /** Typedefs. */
+  typedef itk::VectorImage<TComponentType, VDimension>  VectorImageType;
+  typedef itk::Image<TComponentType, VDimension>        ScalarImageType;
+
+  /** A pair indicating which functor should be used for an operator,
+   * and whether the arguments should be swapped.
+   */
+  typedef std::pair< BinaryFunctorEnum, bool >        BinaryOperatorType;
+  typedef std::map<std::string, BinaryOperatorType>   BinaryOperatorMapType;
+
   /** Run function. */
   void Run( void )
   {
-    if( this->m_Unary ) this->RunUnary();
+    if( this->m_NumberOfComponents == 1 ) this->RunScalar();
+    else if( this->m_Unary ) this->RunUnary();
     else this->RunBinary();
 
   } // end Run()
 
+  /** RunScalar function, for images with one component. Binary images of
+   * one byte per pixel are processed eight pixels at a time.
+   */
+  void RunScalar( void )
+  {
+    /** Typedefs. */
+    typedef itk::ImageFileReader< ScalarImageType >       ReaderType;
+    typedef itk::ImageFileWriter< ScalarImageType >       WriterType;
+    typedef itk::WordParallelLogicalImageFilter<
+      ScalarImageType >                                   WordParallelFilterType;
+
+    /** Read the images. */
+    typename ReaderType::Pointer reader1 = ReaderType::New();
+    reader1->SetFileName( this->m_InputFileName1.c_str() );
+    this->ObserveProcess( reader1.GetPointer(), "read input 1" );
+    reader1->Update();
+
+    typename ReaderType::Pointer reader2 = ReaderType::New();
+    if( !this->m_Unary )
+    {
+      reader2->SetFileName( this->m_InputFileName2.c_str() );
+      this->ObserveProcess( reader2.GetPointer(), "read input 2" );
+      reader2->Update();
+    }
+
+    /** Set up the operator. */
+    const bool equal = this->m_Unary && this->m_Ops == "EQUAL";
+    BinaryOperatorType logicalOperator( AND, false );
+    if( !this->m_Unary )
+    {
+      BinaryOperatorMapType binaryOperatorMap = GetBinaryOperatorMap();
+      if( binaryOperatorMap.count( this->m_Ops ) == 0 )
+      {
+        std::cerr << "ERROR: The desired operator is unknown: " << this->m_Ops << std::endl;
+        return;
+      }
+      logicalOperator = binaryOperatorMap[ this->m_Ops ];
+    }
+    typename ScalarImageType::Pointer input1 = reader1->GetOutput();
+    typename ScalarImageType::Pointer input2 = reader2->GetOutput();
+    if( logicalOperator.second ) std::swap( input1, input2 );
+
+    /** Binary images of bytes are processed as words, see
+     * itk::WordParallelLogicalImageFilter. Other images use the functors.
+     */
+    const bool wordParallel = sizeof( TComponentType ) == 1 && !equal
+      && WordParallelFilterType::IsBinary( input1 )
+      && ( this->m_Unary || WordParallelFilterType::IsBinary( input2 ) );
+
+    typename itk::InPlaceImageFilter<ScalarImageType, ScalarImageType>::Pointer logicalFilter;
+    typename WordParallelFilterType::Pointer wordParallelFilter;
+    if( wordParallel )
+    {
+      wordParallelFilter = WordParallelFilterType::New();
+      wordParallelFilter->SetOperator( logicalOperator.first );
+      logicalFilter = wordParallelFilter.GetPointer();
+    }
+    else if( this->m_Unary )
+    {
+      UnaryLogicalFunctorFactory<ScalarImageType> unaryFactory;
+      logicalFilter = unaryFactory.GetFilter( equal ? EQUAL : NOT,
+        static_cast<TComponentType>( this->m_Argument ) );
+    }
+    else
+    {
+      BinaryLogicalFunctorFactory<ScalarImageType> binaryFactory;
+      logicalFilter = binaryFactory.GetFilter( logicalOperator.first );
+    }
+    logicalFilter->SetInput( 0, input1 );
+    if( !this->m_Unary ) logicalFilter->SetInput( 1, input2 );
+
+    /** Write the image to disk */
+    typename WriterType::Pointer writer = WriterType::New();
+    writer->SetFileName( this->m_OutputFileName.c_str() );
+    writer->SetInput( logicalFilter->GetOutput() );
+    writer->SetUseCompression( this->m_UseCompression );
+
+    this->ObserveProcess( logicalFilter.GetPointer(), "logical operator" );
+    this->ObserveProcess( writer.GetPointer(), "write" );
+    writer->Update();
+
+    /** The number of nonzero pixels of the output. */
+    if( this->m_PrintCount )
+    {
+      unsigned long count = 0;
+      if( wordParallel )
+      {
+        count = wordParallelFilter->GetNumberOfNonzeroPixels();
+      }
+      else
+      {
+        const ScalarImageType * output = logicalFilter->GetOutput();
+        const TComponentType * buffer = output->GetBufferPointer();
+        const unsigned long n = output->GetBufferedRegion().GetNumberOfPixels();
+        for( unsigned long i = 0; i < n; ++i )
+        {
+          if( buffer[ i ] != 0 ) ++count;
+        }
+      }
+      std::cout << count << std::endl;
+    }
+
+  } // end RunScalar()
+
+  /** The simplification map, see RunBinary(). */
+  static BinaryOperatorMapType GetBinaryOperatorMap( void )
+  {
+    BinaryOperatorMapType binaryOperatorMap;
+    binaryOperatorMap["AND"]        = BinaryOperatorType(AND, false);
+    binaryOperatorMap["OR"]         = BinaryOperatorType(OR, false);
+    binaryOperatorMap["XOR"]        = BinaryOperatorType(XOR, false);
+    binaryOperatorMap["ANDNOT"]     = BinaryOperatorType(ANDNOT, false);
+    binaryOperatorMap["ORNOT"]      = BinaryOperatorType(ORNOT, false);
+    binaryOperatorMap["XORNOT"]     = BinaryOperatorType(NOT_XOR, false);
+
+    binaryOperatorMap["NOTAND"]     = BinaryOperatorType(ANDNOT, true);
+    binaryOperatorMap["NOTOR"]      = BinaryOperatorType(ORNOT, true);
+    binaryOperatorMap["NOTXOR"]     = BinaryOperatorType(NOT_XOR, false);
+
+    binaryOperatorMap["NOTANDNOT"]  = BinaryOperatorType(NOT_OR, false);
+    binaryOperatorMap["NOTORNOT"]   = BinaryOperatorType(NOT_AND, false);
+    binaryOperatorMap["NOTXORNOT"]  = BinaryOperatorType(XOR, false);
+
+    binaryOperatorMap["NOT_AND"]    = BinaryOperatorType(NOT_AND, false);
+    binaryOperatorMap["NOT_OR"]     = BinaryOperatorType(NOT_OR, false);
+    binaryOperatorMap["NOT_XOR"]    = BinaryOperatorType(NOT_XOR, false);
+    binaryOperatorMap["NOT_NOT"]    = BinaryOperatorType(DUMMY, false);
+
+    binaryOperatorMap["NOT_ANDNOT"] = BinaryOperatorType(ORNOT, true);
+    binaryOperatorMap["NOT_ORNOT"]  = BinaryOperatorType(ANDNOT, true);
+    binaryOperatorMap["NOT_XORNOT"] = BinaryOperatorType(XOR, false);
+
+    binaryOperatorMap["NOT_NOTAND"] = BinaryOperatorType(ORNOT, false);
+    binaryOperatorMap["NOT_NOTOR"]  = BinaryOperatorType(ANDNOT, false);
+    binaryOperatorMap["NOT_NOTXOR"] = BinaryOperatorType(XOR, false);
+
+    binaryOperatorMap["NOT_NOTANDNOT"] = BinaryOperatorType(OR, false);
+    binaryOperatorMap["NOT_NOTORNOT"]  = BinaryOperatorType(AND, false);
+    binaryOperatorMap["NOT_NOTXORNOT"] = BinaryOperatorType(NOT_XOR, false);
+    return binaryOperatorMap;
+
+  } // end GetBinaryOperatorMap()
+
   /** RunUnary function. */
   void RunUnary( void )
   {
     /** Typedefs. */
-    typedef itk::VectorImage<TComponentType, VDimension>  VectorImageType;
-    typedef itk::Image<TComponentType, VDimension>        ScalarImageType;
     typedef itk::ImageFileReader< VectorImageType >       ReaderType;
     typedef itk::ImageFileWriter< VectorImageType >       WriterType;
 
@@ -116,11 +273,11 @@ public:
     std::cout << "Done reading image1." << std::endl;
 
     UnaryFunctorEnum unaryOperation;
-    if( this->m_Ops.compare( "EQUAL" ) )
+    if( this->m_Ops == "EQUAL" )
     {
       unaryOperation = EQUAL;
     }
-    else if( this->m_Ops.compare( "NOT" ) )
+    else if( this->m_Ops == "NOT" )
     {
       unaryOperation = NOT;
     }
@@ -171,17 +328,9 @@ public:
   void RunBinary( void )
   {
     /** Typedefs. */
-    typedef itk::VectorImage<TComponentType, VDimension>  VectorImageType;
-    typedef itk::Image<TComponentType, VDimension>        ScalarImageType;
     typedef itk::ImageFileReader< VectorImageType >       ReaderType;
     typedef itk::ImageFileWriter< VectorImageType >       WriterType;
 
-    /** A pair indicating which functor should be used for an operator,
-     * and whether the arguments should be swapped.
-     */
-    typedef std::pair< BinaryFunctorEnum, bool >        BinaryOperatorType;
-    typedef std::map<std::string, BinaryOperatorType>   BinaryOperatorMapType;
-
     /** Declarations. */
     typename ReaderType::Pointer reader1 = ReaderType::New();
     typename ReaderType::Pointer reader2 = ReaderType::New();
@@ -199,38 +348,7 @@ public:
      * example2: (!A) & B = NOTAND(A,B) = ANDNOT(B,A) = B & (!A)
      */
 
-    BinaryOperatorMapType binaryOperatorMap;
-    binaryOperatorMap["AND"]        = BinaryOperatorType(AND, false);
-    binaryOperatorMap["OR"]         = BinaryOperatorType(OR, false);
-    binaryOperatorMap["XOR"]        = BinaryOperatorType(XOR, false);
-    binaryOperatorMap["ANDNOT"]     = BinaryOperatorType(ANDNOT, false);
-    binaryOperatorMap["ORNOT"]      = BinaryOperatorType(ORNOT, false);
-    binaryOperatorMap["XORNOT"]     = BinaryOperatorType(NOT_XOR, false);
-
-    binaryOperatorMap["NOTAND"]     = BinaryOperatorType(ANDNOT, true);
-    binaryOperatorMap["NOTOR"]      = BinaryOperatorType(ORNOT, true);
-    binaryOperatorMap["NOTXOR"]     = BinaryOperatorType(NOT_XOR, false);
-
-    binaryOperatorMap["NOTANDNOT"]  = BinaryOperatorType(NOT_OR, false);
-    binaryOperatorMap["NOTORNOT"]   = BinaryOperatorType(NOT_AND, false);
-    binaryOperatorMap["NOTXORNOT"]  = BinaryOperatorType(XOR, false);
-
-    binaryOperatorMap["NOT_AND"]    = BinaryOperatorType(NOT_AND, false);
-    binaryOperatorMap["NOT_OR"]     = BinaryOperatorType(NOT_OR, false);
-    binaryOperatorMap["NOT_XOR"]    = BinaryOperatorType(NOT_XOR, false);
-    binaryOperatorMap["NOT_NOT"]    = BinaryOperatorType(DUMMY, false);
-
-    binaryOperatorMap["NOT_ANDNOT"] = BinaryOperatorType(ORNOT, true);
-    binaryOperatorMap["NOT_ORNOT"]  = BinaryOperatorType(ANDNOT, true);
-    binaryOperatorMap["NOT_XORNOT"] = BinaryOperatorType(XOR, false);
-
-    binaryOperatorMap["NOT_NOTAND"] = BinaryOperatorType(ORNOT, false);
-    binaryOperatorMap["NOT_NOTOR"]  = BinaryOperatorType(ANDNOT, false);
-    binaryOperatorMap["NOT_NOTXOR"] = BinaryOperatorType(XOR, false);
-
-    binaryOperatorMap["NOT_NOTANDNOT"] = BinaryOperatorType(OR, false);
-    binaryOperatorMap["NOT_NOTORNOT"]  = BinaryOperatorType(AND, false);
-    binaryOperatorMap["NOT_NOTXORNOT"] = BinaryOperatorType(NOT_XOR, false);
+    BinaryOperatorMapType binaryOperatorMap = GetBinaryOperatorMap();
 
     /** Read the images. */
     reader1->SetFileName( this->m_InputFileName1.c_str() );
@@ -40,13 +40,19 @@ std::string GetHelpString( void )
     << "This program creates a mean and standard deviation image of a set of images.\n"
     << "Usage:\n"
     << "pxmeanstdimage\n"
-    << "  -in        list of inputFilenames\n"
+    << "  -in        list of inputFilenames; use @file to read them from a manifest,\n"
+    << "             optionally with the mask filename in the second column\n"
 	<< "  -inMask    list of inputMaskFilenames\n"
     << "  [-outmean] outputFilename for mean image; always written as float\n"
     << "  [-outstd]  outputFilename for standard deviation image; always written as float,\n"
 	<< "  [-popstd]  population standard deviation flag; if provided, use population standard deviation\n"
 	<< "             rather than sample standard deviation (divide by N instead of N-1)\n"
+    << "  [-welford] accumulate the mean and standard deviation with Welford's method, in double\n"
+    << "             precision, instead of the sums of X and X^2 in float\n"
     << "  [-z]       compression flag; if provided, the output image is compressed\n"
+    << "With -streams or -memoryLimit the images are processed in slabs along the last\n"
+    << "dimension, reading only one slab of every input at a time; this requires input\n"
+    << "and output formats that support streaming, like uncompressed mhd.\n"
     << "Supported: 2D, 3D, (unsigned) char, (unsigned) short, float, double.";
 
   return ss.str();
@@ -83,7 +89,16 @@ int main( int argc, char **argv )
   parser->GetCommandLineArgument( "-in", inputFileNames );
   
   std::vector<std::string> inputMaskFileNames;
-  parser->GetCommandLineArgument( "-inMask", inputMaskFileNames );
+  bool retinMask = parser->GetCommandLineArgument( "-inMask", inputMaskFileNames );
+  if( !retinMask )
+  {
+    /** The masks can also be given in the second column of an -in manifest. */
+    parser->GetManifestColumn( "-in", 1, inputMaskFileNames );
+  }
+
+  /** Read the headers of all inputs before processing starts. */
+  if( !itktools::ValidateImageHeaders( inputFileNames ) ) return EXIT_FAILURE;
+  if( !itktools::ValidateImageHeaders( inputMaskFileNames ) ) return EXIT_FAILURE;
 
   std::string outputFileNameMean = "";
   parser->GetCommandLineArgument( "-outmean", outputFileNameMean );
@@ -96,6 +111,9 @@ int main( int argc, char **argv )
   /** Use population standard deviation */
   const bool usePopulationStd = parser->ArgumentExists( "-popstd" );
 
+  /** Use Welford's method */
+  const bool useWelford = parser->ArgumentExists( "-welford" );
+
   /** Use compression */
   const bool useCompression = parser->ArgumentExists( "-z" );
 
@@ -153,7 +171,9 @@ int main( int argc, char **argv )
     filter->m_CalcStd = retoutstd;
 	filter->m_UsePopulationStd = usePopulationStd;
 	filter->m_UseCompression = useCompression;
+    filter->m_UseWelford = useWelford;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
@@ -21,6 +21,7 @@
 #include "ITKToolsBase.h"
 
 #include "itkImage.h"
+#include "itkMultiThreader.h"
 #include <string>
 #include <vector>
 
@@ -45,6 +46,7 @@ public:
     this->m_CalcStd = false;
 	this->m_UsePopulationStd = false;
 	this->m_UseCompression = false;
+    this->m_UseWelford = false;
   };
   /** Destructor. */
   ~ITKToolsMeanStdImageBase(){};
@@ -58,6 +60,10 @@ public:
   bool                     m_CalcStd;\
   bool                     m_UsePopulationStd;
   bool                     m_UseCompression;
+  bool                     m_UseWelford;
+
+  /** This tool supports streaming, by processing the images in slabs. */
+  virtual bool GetSupportsStreaming( void ) const { return true; }
 
 }; // end class ITKToolsMeanStdImageBase
 
@@ -82,6 +88,8 @@ public:
   /** Typedef. */
   typedef itk::Image< TComponentType, VDimension >  InputImageType;
   typedef itk::Image< float, VDimension >           OutputImageType;
+  typedef typename InputImageType::Pointer          InputImagePointer;
+  typedef typename InputImageType::RegionType       RegionType;
 
   /** Run function. */
   void Run( void )
@@ -106,6 +114,58 @@ public:
     const bool calc_std, const std::string & outputFileNameStd,
 	const bool population_std, const bool use_compression);
 
+protected:
+
+  /** The arguments of the thread that reads the next image and mask. */
+  struct ReadStruct
+  {
+    std::string       m_FileName;
+    std::string       m_MaskFileName;
+    RegionType        m_Region;
+    InputImagePointer m_Image;
+    InputImagePointer m_Mask;
+    std::string       m_ErrorMessage;
+  };
+
+  /** The arguments of the threads that accumulate one image. */
+  struct AccumulateStruct
+  {
+    const TComponentType * m_Input;
+    const TComponentType * m_Mask;
+    std::size_t            m_NumberOfPixels;
+    unsigned int           m_Index;
+    bool                   m_UseWelford;
+    float *                m_Sum;
+    float *                m_SumOfSquares;
+    float *                m_Count;
+    double *               m_Mean;
+    double *               m_SumOfSquaredDeviations;
+  };
+
+  /** Compute the mean and std of one slab of the images. */
+  void ComputeSlab(
+    const std::vector<std::string> & inputFileNames,
+    const std::vector<std::string> & inputMaskFileNames,
+    const bool calc_std, const bool population_std,
+    const RegionType & region, const RegionType & slab,
+    OutputImageType * mean, OutputImageType * std );
+
+  /** Write one slab of an output image. */
+  void WriteSlab( OutputImageType * image, const std::string & fileName,
+    const RegionType & slab, const bool streaming, const bool use_compression );
+
+  /** Read a region of an image, disconnected from its reader. */
+  static InputImagePointer ReadInputImage( const std::string & fileName,
+    const RegionType & region );
+
+  /** The pixels of a slab in the buffer of an image. */
+  static const TComponentType * GetSlabBuffer( const InputImageType * image,
+    const RegionType & slab );
+
+  /** Thread callbacks. */
+  static ITK_THREAD_RETURN_TYPE ReadThreaderCallback( void * arg );
+  static ITK_THREAD_RETURN_TYPE AccumulateThreaderCallback( void * arg );
+
 }; // end class MeanStdImage
 
 #include "meanstdimage.hxx"
@@ -20,6 +20,170 @@
 
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
+#include "itkImageRegionIterator.h"
+#include "itkMultiThreader.h"
+#include <itksys/SystemTools.hxx>
+
+/**
+ * ******************* ReadThreaderCallback *******************
+ *
+ * Reads a slab of the next image, and optionally of its mask, on a
+ * background thread.
+ */
+
+template< unsigned int VDimension, class TComponentType >
+ITK_THREAD_RETURN_TYPE
+ITKToolsMeanStdImage< VDimension, TComponentType >
+::ReadThreaderCallback( void * arg )
+{
+  itk::MultiThreader::ThreadInfoStruct * info
+    = static_cast<itk::MultiThreader::ThreadInfoStruct *>( arg );
+  ReadStruct * data = static_cast<ReadStruct *>( info->UserData );
+
+  try
+  {
+    data->m_Image = ReadInputImage( data->m_FileName, data->m_Region );
+    if( data->m_MaskFileName != "" )
+    {
+      data->m_Mask = ReadInputImage( data->m_MaskFileName, data->m_Region );
+    }
+  }
+  catch( itk::ExceptionObject & excp )
+  {
+    data->m_ErrorMessage = excp.GetDescription();
+  }
+  catch( std::exception & excp )
+  {
+    data->m_ErrorMessage = excp.what();
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end ReadThreaderCallback()
+
+
+/**
+ * ******************* ReadInputImage *******************
+ *
+ * Only the requested region is read, if the image format supports it.
+ */
+
+template< unsigned int VDimension, class TComponentType >
+typename ITKToolsMeanStdImage< VDimension, TComponentType >::InputImagePointer
+ITKToolsMeanStdImage< VDimension, TComponentType >
+::ReadInputImage( const std::string & fileName, const RegionType & region )
+{
+  typedef itk::ImageFileReader< InputImageType >        ReaderType;
+
+  typename ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( fileName.c_str() );
+  reader->UpdateOutputInformation();
+  if( reader->GetOutput()->GetLargestPossibleRegion().IsInside( region ) )
+  {
+    reader->GetOutput()->SetRequestedRegion( region );
+  }
+  reader->Update();
+  InputImagePointer image = reader->GetOutput();
+  image->DisconnectPipeline();
+  return image;
+
+} // end ReadInputImage()
+
+
+/**
+ * ******************* GetSlabBuffer *******************
+ *
+ * A slab spans the full image in all but the last dimension, so it is
+ * contiguous in the buffer of an image that contains it.
+ */
+
+template< unsigned int VDimension, class TComponentType >
+const TComponentType *
+ITKToolsMeanStdImage< VDimension, TComponentType >
+::GetSlabBuffer( const InputImageType * image, const RegionType & slab )
+{
+  const RegionType & buffered = image->GetBufferedRegion();
+  bool contiguous = buffered.IsInside( slab );
+  for( unsigned int d = 0; d + 1 < VDimension; ++d )
+  {
+    contiguous &= buffered.GetSize()[ d ] == slab.GetSize()[ d ];
+  }
+  if( !contiguous )
+  {
+    itkGenericExceptionMacro( << "ERROR: the buffered region of an input does not contain the slab "
+      << slab.GetIndex() << " " << slab.GetSize() );
+  }
+  return image->GetBufferPointer() + image->ComputeOffset( slab.GetIndex() );
+
+} // end GetSlabBuffer()
+
+
+/**
+ * ******************* AccumulateThreaderCallback *******************
+ *
+ * Adds one image to the accumulators. Every thread processes a
+ * contiguous part of the buffers.
+ */
+
+template< unsigned int VDimension, class TComponentType >
+ITK_THREAD_RETURN_TYPE
+ITKToolsMeanStdImage< VDimension, TComponentType >
+::AccumulateThreaderCallback( void * arg )
+{
+  itk::MultiThreader::ThreadInfoStruct * info
+    = static_cast<itk::MultiThreader::ThreadInfoStruct *>( arg );
+  const AccumulateStruct * data = static_cast<AccumulateStruct *>( info->UserData );
+
+  const std::size_t begin = data->m_NumberOfPixels * info->ThreadID / info->NumberOfThreads;
+  const std::size_t end = data->m_NumberOfPixels * ( info->ThreadID + 1 ) / info->NumberOfThreads;
+  const TComponentType * input = data->m_Input;
+  const TComponentType * mask = data->m_Mask;
+
+  if( data->m_UseWelford )
+  {
+    /** Welford's update of the running mean and squared deviations. */
+    for( std::size_t k = begin; k < end; ++k )
+    {
+      if( mask && mask[ k ] == 0 ) continue;
+      const double value = static_cast<double>( input[ k ] );
+      const double count = data->m_Count ? ++data->m_Count[ k ] : data->m_Index + 1.0;
+      const double delta = value - data->m_Mean[ k ];
+      data->m_Mean[ k ] += delta / count;
+      if( data->m_SumOfSquaredDeviations )
+      {
+        data->m_SumOfSquaredDeviations[ k ] += delta * ( value - data->m_Mean[ k ] );
+      }
+    }
+  }
+  else
+  {
+    /** Create two maps for calculating the mean and std: sum(X) and sum(X^2) */
+    float * sum = data->m_Sum;
+    float * sumOfSquares = data->m_SumOfSquares;
+    for( std::size_t k = begin; k < end; ++k )
+    {
+      if( mask && mask[ k ] == 0 ) continue;
+      sum[ k ] = sum[ k ] + input[ k ];
+      if( sumOfSquares )
+      {
+        sumOfSquares[ k ] = sumOfSquares[ k ] + ( input[ k ] * input[ k ] );
+      }
+      if( data->m_Count ) data->m_Count[ k ] = data->m_Count[ k ] + 1;
+    }
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end AccumulateThreaderCallback()
+
+
+/**
+ * ******************* MeanStdImage *******************
+ *
+ * The images are processed in slabs along the last dimension, if
+ * streaming is requested: every slab is read from all inputs, reduced,
+ * and written to the outputs, before the next slab is read.
+ */
 
 template< unsigned int VDimension, class TComponentType >
 void
@@ -35,197 +199,364 @@ ITKToolsMeanStdImage< VDimension, TComponentType >
   const bool use_compression)
 {
   /** TYPEDEF's. */
-  typedef typename InputImageType::Pointer              ImagePointer;
-  typedef typename OutputImageType::Pointer             OutImagePointer;
   typedef itk::ImageFileReader< InputImageType >        ReaderType;
-  typedef itk::ImageFileWriter< OutputImageType >       WriterType;
-  typedef typename InputImageType::PixelType            PixelType;
-  typedef typename ReaderType::Pointer                  ReaderPointer;
-  typedef typename WriterType::Pointer                  WriterPointer;
+  typedef typename OutputImageType::Pointer             OutImagePointer;
+
+  /** Get the region of the first image. */
+  typename ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( inputFileNames[ 0 ].c_str() );
+  reader->UpdateOutputInformation();
+  const RegionType region = reader->GetOutput()->GetLargestPossibleRegion();
+
+  /** Estimate the memory needed without streaming: the current and the
+   * prefetched input and mask, and the accumulators and outputs.
+   */
+  const bool hasMasks = inputMaskFileNames.size() != 0;
+  double bytesPerPixel = 2.0 * sizeof( TComponentType ) * ( hasMasks ? 2.0 : 1.0 )
+    + 2.0 * sizeof( float ) + ( hasMasks ? sizeof( float ) : 0.0 );
+  if( this->m_UseWelford )
+  {
+    bytesPerPixel += ( calc_std ? 2.0 : 1.0 ) * sizeof( double );
+  }
+  else if( calc_std )
+  {
+    bytesPerPixel += sizeof( float );
+  }
+  const double sizeInMB = region.GetNumberOfPixels() * bytesPerPixel / 1048576.0;
+
+  /** Determine the slabs. */
+  const unsigned int lastDimension = VDimension - 1;
+  const unsigned int lastSize = region.GetSize()[ lastDimension ];
+  unsigned int numberOfSlabs = this->GetNumberOfStreams( sizeInMB );
+  if( numberOfSlabs < 1 ) numberOfSlabs = 1;
+  if( numberOfSlabs > lastSize ) numberOfSlabs = lastSize;
+
+  const bool streaming = numberOfSlabs > 1;
+  if( streaming && use_compression )
+  {
+    itkGenericExceptionMacro( << "ERROR: compression can not be combined with streaming." );
+  }
+
+  /** The outputs are pasted slab by slab into a new file. */
+  if( streaming )
+  {
+    if( calc_mean ) itksys::SystemTools::RemoveFile( outputFileNameMean.c_str() );
+    if( calc_std ) itksys::SystemTools::RemoveFile( outputFileNameStd.c_str() );
+  }
+
+  for( unsigned int s = 0; s < numberOfSlabs; ++s )
+  {
+    /** The slab spans the full image in all but the last dimension. */
+    const unsigned int begin = static_cast<unsigned int>(
+      static_cast<unsigned long long>( lastSize ) * s / numberOfSlabs );
+    const unsigned int end = static_cast<unsigned int>(
+      static_cast<unsigned long long>( lastSize ) * ( s + 1 ) / numberOfSlabs );
+    RegionType slab = region;
+    slab.SetIndex( lastDimension, region.GetIndex()[ lastDimension ] + begin );
+    slab.SetSize( lastDimension, end - begin );
+    if( streaming )
+    {
+      std::cout << "Processing slab " << s + 1 << " of " << numberOfSlabs << std::endl;
+    }
+
+    /** Create the output images, of the full size but with the slab only buffered. */
+    OutImagePointer mean = OutputImageType::New();
+    OutImagePointer std = OutputImageType::New();
+    mean->CopyInformation( reader->GetOutput() );
+    std->CopyInformation( reader->GetOutput() );
+    mean->SetBufferedRegion( slab );
+    std->SetBufferedRegion( slab );
+    mean->SetRequestedRegion( slab );
+    std->SetRequestedRegion( slab );
+    mean->Allocate();
+    std->Allocate();
+
+    this->ComputeSlab( inputFileNames, inputMaskFileNames, calc_std,
+      population_std, region, slab, mean, std );
+
+    /** Write the output images */
+    if( calc_mean )
+    {
+      this->WriteSlab( mean, outputFileNameMean, slab, streaming, use_compression );
+    }
+
+    if( calc_std )
+    {
+      this->WriteSlab( std, outputFileNameStd, slab, streaming, use_compression );
+    }
+  }
+
+} // end MeanStdImage()
+
+
+/**
+ * ******************* ComputeSlab *******************
+ */
+
+template< unsigned int VDimension, class TComponentType >
+void
+ITKToolsMeanStdImage< VDimension, TComponentType >
+::ComputeSlab(
+  const std::vector<std::string> & inputFileNames,
+  const std::vector<std::string> & inputMaskFileNames,
+  const bool calc_std,
+  const bool population_std,
+  const RegionType & region,
+  const RegionType & slab,
+  OutputImageType * mean,
+  OutputImageType * std )
+{
+  /** TYPEDEF's. */
+  typedef typename OutputImageType::Pointer             OutImagePointer;
+  typedef itk::Image< double, VDimension >              RealImageType;
+  typedef typename RealImageType::Pointer               RealImagePointer;
 
   /** DECLARATION'S. */
   const unsigned int nrInputs = inputFileNames.size();
   const unsigned int nrMasks = inputMaskFileNames.size();
-  
-  ReaderPointer inReader;
-  ReaderPointer inMaskReader;
-  WriterPointer writer_mean = WriterType::New();
-  WriterPointer writer_std = WriterType::New();
-  
-  OutImagePointer mean = OutputImageType::New();
+  const bool useWelford = this->m_UseWelford;
+
   OutImagePointer sq_mean = OutputImageType::New();
-  OutImagePointer std = OutputImageType::New();
   OutImagePointer nr_images = OutputImageType::New();
-  
-  itk::ImageRegionConstIterator<InputImageType> input_iterator;
-  itk::ImageRegionConstIterator<InputImageType> mask_iterator;
-  itk::ImageRegionIterator<OutputImageType> mean_iterator;
-  itk::ImageRegionIterator<OutputImageType> sq_mean_iterator;
-  itk::ImageRegionIterator<OutputImageType> std_iterator;
-  itk::ImageRegionIterator<OutputImageType> nr_images_iterator;
-
-  /** Create temporary & output images */
-  inReader = ReaderType::New();
-  inReader->SetFileName( inputFileNames[0].c_str() );
-  inReader->Update();
+  RealImagePointer welfordMean = RealImageType::New();
+  RealImagePointer welfordSumOfSquaredDeviations = RealImageType::New();
 
-  mean->CopyInformation( inReader->GetOutput() );
-  sq_mean->CopyInformation( inReader->GetOutput() );
-  std->CopyInformation( inReader->GetOutput() );
-
-  mean->SetRegions( inReader->GetOutput()->GetLargestPossibleRegion().GetSize() );
-  sq_mean->SetRegions( inReader->GetOutput()->GetLargestPossibleRegion().GetSize() );
-  std->SetRegions( inReader->GetOutput()->GetLargestPossibleRegion().GetSize() );
-
-  mean->Allocate();
-  sq_mean->Allocate();
-  std->Allocate();
+  /** Read the first image and mask. */
+  std::cout << "Reading image " << inputFileNames[ 0 ] << std::endl;
+  InputImagePointer image = ReadInputImage( inputFileNames[ 0 ], slab );
+  InputImagePointer mask;
+  if( nrMasks != 0 )
+  {
+    std::cout << "Reading mask " << inputMaskFileNames[ 0 ] << std::endl;
+    mask = ReadInputImage( inputMaskFileNames[ 0 ], slab );
+  }
 
+  /** Create temporary images */
   mean->FillBuffer( 0.0 );
-  sq_mean->FillBuffer( 0.0 );
   std->FillBuffer( 0.0 );
-  
-  mean_iterator = itk::ImageRegionIterator<OutputImageType>( mean, mean->GetRequestedRegion() );
-  sq_mean_iterator = itk::ImageRegionIterator<OutputImageType>( sq_mean, sq_mean->GetRequestedRegion() );
-  std_iterator = itk::ImageRegionIterator<OutputImageType>( std, std->GetRequestedRegion() );
-  
-  /** Checking if there are masks and initialising the iterator*/
-  if (nrMasks != 0 )
-  {
-    inMaskReader = ReaderType::New();
-    inMaskReader->SetFileName( inputMaskFileNames[0].c_str() );
-    inMaskReader->Update();
-	
-    nr_images->CopyInformation( inReader->GetOutput() );
-    nr_images->SetRegions( inReader->GetOutput()->GetLargestPossibleRegion().GetSize() );
+  if( useWelford )
+  {
+    welfordMean->SetRegions( slab );
+    welfordMean->Allocate();
+    welfordMean->FillBuffer( 0.0 );
+    if( calc_std )
+    {
+      welfordSumOfSquaredDeviations->SetRegions( slab );
+      welfordSumOfSquaredDeviations->Allocate();
+      welfordSumOfSquaredDeviations->FillBuffer( 0.0 );
+    }
+  }
+  else if( calc_std )
+  {
+    sq_mean->SetRegions( slab );
+    sq_mean->Allocate();
+    sq_mean->FillBuffer( 0.0 );
+  }
+
+  /** Checking if there are masks and initialising the count */
+  if( nrMasks != 0 )
+  {
+    nr_images->SetRegions( slab );
     nr_images->Allocate();
-    nr_images->FillBuffer(0);
-	nr_images_iterator = itk::ImageRegionIterator<OutputImageType>( nr_images, nr_images->GetRequestedRegion() );
+    nr_images->FillBuffer( 0 );
   }
-  /** Loop over all images and create sum(X) and sum(X^2) which is required for E(X) and E(X^2) */
+
+  /** The arguments of the accumulation threads. */
+  AccumulateStruct accumulate;
+  accumulate.m_NumberOfPixels = slab.GetNumberOfPixels();
+  accumulate.m_UseWelford = useWelford;
+  accumulate.m_Sum = useWelford ? 0 : mean->GetBufferPointer();
+  accumulate.m_SumOfSquares = ( !useWelford && calc_std ) ? sq_mean->GetBufferPointer() : 0;
+  accumulate.m_Count = nrMasks != 0 ? nr_images->GetBufferPointer() : 0;
+  accumulate.m_Mean = useWelford ? welfordMean->GetBufferPointer() : 0;
+  accumulate.m_SumOfSquaredDeviations = ( useWelford && calc_std )
+    ? welfordSumOfSquaredDeviations->GetBufferPointer() : 0;
+
+  itk::MultiThreader::Pointer accumulator = itk::MultiThreader::New();
+  itk::MultiThreader::Pointer prefetcher = itk::MultiThreader::New();
+
+  /** Loop over all images. While an image is accumulated, the next image
+   * and mask are read on a background thread.
+   */
   for( unsigned int i = 0; i < nrInputs; ++i )
   {
-    std::cout << "Reading image " << inputFileNames[ i ].c_str() << std::endl;
-    inReader = ReaderType::New();
-    inReader->SetFileName( inputFileNames[ i ].c_str() );
-    inReader->Update();
-	
-    input_iterator = itk::ImageRegionConstIterator<InputImageType>(
-      inReader->GetOutput(), inReader->GetOutput()->GetRequestedRegion() );	
-	  
-    input_iterator.GoToBegin();
-    mean_iterator.GoToBegin();
-    sq_mean_iterator.GoToBegin();
-	
-	/** Reading the masks if needed*/
-	if (nrMasks != 0 )
-	{
-	  std::cout << "Reading mask " << inputMaskFileNames[ i ].c_str() << std::endl;
-	  inMaskReader = ReaderType::New();
-      inMaskReader->SetFileName( inputMaskFileNames[ i ].c_str() );
-      inMaskReader->Update();
-	  
-
-	  mask_iterator = itk::ImageRegionConstIterator<InputImageType>(
-        inMaskReader->GetOutput(), inMaskReader->GetOutput()->GetRequestedRegion() );
-
-	  mask_iterator.GoToBegin();
-	  nr_images_iterator.GoToBegin();
-	}
-	/** Create two maps for calculating the mean and std: sum(X) and sum(X^2) */
-    for (; !mean_iterator.IsAtEnd(); ++mean_iterator, ++sq_mean_iterator, ++input_iterator)
-    {	
-      /** Calculating the mean if there are no masks or if the mask is not zero in current voxel*/  	
-	  if (nrMasks == 0 || mask_iterator.Get() !=0)
-	  {
-	    mean_iterator.Set( mean_iterator.Get() + input_iterator.Get() );
-	    if( calc_std )
-  	      sq_mean_iterator.Set( sq_mean_iterator.Get() + (input_iterator.Get() * input_iterator.Get()) );
-
-	  }
-	  if (nrMasks != 0)
-	  {
-	    /** If masks are used, the number of the images used for the mean for each voxel is updated*/
-	    if (mask_iterator.Get() != 0 )
-		{
-		  nr_images_iterator.Set( nr_images_iterator.Get() + 1);
-		}  
-		/** Update iterators if we are in fact using masks*/
-		++mask_iterator;
-		++nr_images_iterator;
-	  }
-	}
+    /** Start reading the next image. */
+    ReadStruct next;
+    int prefetchThread = -1;
+    if( i + 1 < nrInputs )
+    {
+      next.m_FileName = inputFileNames[ i + 1 ];
+      next.m_MaskFileName = nrMasks != 0 ? inputMaskFileNames[ i + 1 ] : "";
+      next.m_Region = slab;
+      std::cout << "Reading image " << next.m_FileName << std::endl;
+      if( nrMasks != 0 )
+      {
+        std::cout << "Reading mask " << next.m_MaskFileName << std::endl;
+      }
+      prefetchThread = prefetcher->SpawnThread( ReadThreaderCallback, &next );
+    }
+
+    /** Accumulate the current image, if it fits. */
+    std::string errorMessage = "";
+    if( image->GetLargestPossibleRegion().GetSize() != region.GetSize() )
+    {
+      errorMessage = "The size of " + inputFileNames[ i ] + " differs from the first image.";
+    }
+    else if( nrMasks != 0 && mask->GetLargestPossibleRegion().GetSize() != region.GetSize() )
+    {
+      errorMessage = "The size of " + inputMaskFileNames[ i ] + " differs from the first image.";
+    }
+    else
+    {
+      try
+      {
+        accumulate.m_Input = GetSlabBuffer( image, slab );
+        accumulate.m_Mask = nrMasks != 0 ? GetSlabBuffer( mask, slab ) : 0;
+        accumulate.m_Index = i;
+        accumulator->SetSingleMethod( AccumulateThreaderCallback, &accumulate );
+        accumulator->SingleMethodExecute();
+      }
+      catch( itk::ExceptionObject & excp )
+      {
+        errorMessage = excp.GetDescription();
+      }
+    }
+
+    /** Wait for the next image. */
+    if( prefetchThread >= 0 )
+    {
+      prefetcher->TerminateThread( prefetchThread );
+      if( errorMessage == "" ) errorMessage = next.m_ErrorMessage;
+    }
+    if( errorMessage != "" )
+    {
+      itkGenericExceptionMacro( << "ERROR: " << errorMessage );
+    }
+    image = next.m_Image;
+    mask = next.m_Mask;
   }
 
   /** Calculate mean and standard deviation using:
       mean = ( SUM(X) / N )
       std  = sqrt( E(X^2) - (E(X))^2 ) for population standard deviation
       std  = sqrt(N / (N-1)) * sqrt( E(X^2) - (E(X))^2 ) for sample standard deviation
+    or with Welford's method, from the running mean M and squared deviations S:
+      mean = M
+      std  = sqrt( S / N ) or sqrt( S / (N-1) )
   */
-  mean_iterator.GoToBegin();
-  sq_mean_iterator.GoToBegin();
-  std_iterator.GoToBegin();
-  nr_images_iterator.GoToBegin();
-  
-  /** Denominator for the 1/N calculations and sample_std_factor N/(N-1) to get sample std from population std */
-  float denominator( 1.0f / nrInputs );
-  float sample_std_factor = std::sqrt(((float) nrInputs) / ((float) nrInputs - 1));
-
-  for (; !mean_iterator.IsAtEnd(); ++mean_iterator, ++sq_mean_iterator, ++std_iterator)
-  {
-    if (nrMasks != 0)
-	{
-	  if (nr_images_iterator.Get() > 1)
-	  {
-	    denominator = 1 / nr_images_iterator.Get();
-	    sample_std_factor = std::sqrt(((float) nr_images_iterator.Get()) / ((float) nr_images_iterator.Get() - 1));
-	  }
-	  else
-	  {
-	    denominator = nr_images_iterator.Get();
-	    sample_std_factor = 0;
-	  }
-	  ++nr_images_iterator;
-	}
-	
-	/** Calculate mean and mean of squares */
-	mean_iterator.Set( denominator * mean_iterator.Get() );
-	sq_mean_iterator.Set( denominator * sq_mean_iterator.Get() );
-	
-	/** Calculate standard deviation */
-	
-	if (calc_std)
-	{
-	  if (population_std) // Calculate either sample or population standard deviation
-	  { 
-	    std_iterator.Set( std::sqrt(
-	      (float) std::abs( sq_mean_iterator.Get() - (mean_iterator.Get() * mean_iterator.Get() ) ) ) );
-	  } 
-	  else
-	  {
-	    std_iterator.Set( sample_std_factor * std::sqrt(
-	      (float) std::abs( sq_mean_iterator.Get() - (mean_iterator.Get() * mean_iterator.Get() ) ) ) );
-	  }
-	}
-  }
-  
-  /** Write the output images */
-  if( calc_mean )
-  {
-    writer_mean->SetFileName( outputFileNameMean.c_str() );
-    writer_mean->SetInput( mean );
-	writer_mean->SetUseCompression( use_compression );
-    writer_mean->Update();
-  }
-
-  if( calc_std )
-  {
-    writer_std->SetFileName( outputFileNameStd.c_str() );
-    writer_std->SetInput( std );
-	writer_std->SetUseCompression( use_compression );
-    writer_std->Update();
+  itk::ImageRegionIterator<OutputImageType> mean_iterator( mean, slab );
+  itk::ImageRegionIterator<OutputImageType> std_iterator( std, slab );
+  itk::ImageRegionIterator<OutputImageType> sq_mean_iterator;
+  itk::ImageRegionIterator<OutputImageType> nr_images_iterator;
+  if( !useWelford && calc_std )
+  {
+    sq_mean_iterator = itk::ImageRegionIterator<OutputImageType>( sq_mean, slab );
+  }
+  if( nrMasks != 0 )
+  {
+    nr_images_iterator = itk::ImageRegionIterator<OutputImageType>( nr_images, slab );
+  }
+  if( useWelford )
+  {
+    const double * welfordMeanBuffer = welfordMean->GetBufferPointer();
+    const double * sumOfSquaredDeviations = accumulate.m_SumOfSquaredDeviations;
+    for( std::size_t k = 0; !mean_iterator.IsAtEnd(); ++k, ++mean_iterator, ++std_iterator )
+    {
+      double count = static_cast<double>( nrInputs );
+      if( nrMasks != 0 )
+      {
+        count = nr_images_iterator.Get();
+        ++nr_images_iterator;
+      }
+
+      mean_iterator.Set( static_cast<float>( welfordMeanBuffer[ k ] ) );
+      if( calc_std )
+      {
+        const double divisor = population_std ? count : count - 1.0;
+        std_iterator.Set( divisor > 0.0
+          ? static_cast<float>( std::sqrt( sumOfSquaredDeviations[ k ] / divisor ) ) : 0.0f );
+      }
+    }
   }
+  else
+  {
+    /** Denominator for the 1/N calculations and sample_std_factor N/(N-1) to get sample std from population std */
+    float denominator( 1.0f / nrInputs );
+    float sample_std_factor = std::sqrt(((float) nrInputs) / ((float) nrInputs - 1));
 
-} // end MeanStdImage()
+    for (; !mean_iterator.IsAtEnd(); ++mean_iterator, ++std_iterator)
+    {
+      if (nrMasks != 0)
+      {
+        if (nr_images_iterator.Get() > 1)
+        {
+          denominator = 1 / nr_images_iterator.Get();
+          sample_std_factor = std::sqrt(((float) nr_images_iterator.Get()) / ((float) nr_images_iterator.Get() - 1));
+        }
+        else
+        {
+          denominator = nr_images_iterator.Get();
+          sample_std_factor = 0;
+        }
+        ++nr_images_iterator;
+      }
+
+      /** Calculate mean */
+      mean_iterator.Set( denominator * mean_iterator.Get() );
+
+      /** Calculate mean of squares and standard deviation */
+      if (calc_std)
+      {
+        sq_mean_iterator.Set( denominator * sq_mean_iterator.Get() );
+        if (population_std) // Calculate either sample or population standard deviation
+        {
+          std_iterator.Set( std::sqrt(
+            (float) std::abs( sq_mean_iterator.Get() - (mean_iterator.Get() * mean_iterator.Get() ) ) ) );
+        }
+        else
+        {
+          std_iterator.Set( sample_std_factor * std::sqrt(
+            (float) std::abs( sq_mean_iterator.Get() - (mean_iterator.Get() * mean_iterator.Get() ) ) ) );
+        }
+        ++sq_mean_iterator;
+      }
+    }
+  }
+
+} // end ComputeSlab()
+
+
+/**
+ * ******************* WriteSlab *******************
+ *
+ * When streaming, only the slab is pasted into the output file.
+ */
+
+template< unsigned int VDimension, class TComponentType >
+void
+ITKToolsMeanStdImage< VDimension, TComponentType >
+::WriteSlab(
+  OutputImageType * image,
+  const std::string & fileName,
+  const RegionType & slab,
+  const bool streaming,
+  const bool use_compression )
+{
+  typedef itk::ImageFileWriter< OutputImageType >       WriterType;
+
+  typename WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName( fileName.c_str() );
+  writer->SetInput( image );
+  writer->SetUseCompression( use_compression );
+  if( streaming )
+  {
+    itk::ImageIORegion ioRegion( VDimension );
+    itk::ImageIORegionAdaptor< VDimension >::Convert(
+      slab, ioRegion, image->GetLargestPossibleRegion().GetIndex() );
+    writer->SetIORegion( ioRegion );
+  }
+  writer->Update();
+
+} // end WriteSlab()
 
 #endif // end #ifndef __meanstdimage_hxx_
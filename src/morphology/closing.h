@@ -175,8 +175,12 @@ void closingParabolic(
     radiusArray.SetElement( i, radius1D );
   }
 
-  /** Setup the filter. */
+  /** Setup the filter. Binary images go through the lower envelope,
+   * which gives the same result at a cost independent of the radius. */
+  reader->Update();
   filter->SetUseImageSpacing( false );
+  filter->SetUseLowerEnvelope( itk::IsBinaryImage( reader->GetOutput() ) );
+  filter->InPlaceOn(); // reuse the buffer of the reader
   filter->SetScale( radiusArray );
   filter->SetInput( reader->GetOutput() );
 
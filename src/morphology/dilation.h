@@ -7,6 +7,7 @@
 #include "itkBinaryDilateImageFilter.h"
 #include "itkDilateObjectMorphologyImageFilter.h"
 #include "itkParabolicDilateImageFilter.h"
+#include "itkLabelDilateImageFilter.h"
 
 
 /**
@@ -280,8 +281,12 @@ void dilationParabolic(
     radiusArray.SetElement( i, radius1D );
   }
 
-  /** Setup the filter. */
+  /** Setup the filter. Binary images go through the lower envelope,
+   * which gives the same result at a cost independent of the radius. */
+  reader->Update();
   filter->SetUseImageSpacing( false );
+  filter->SetUseLowerEnvelope( itk::IsBinaryImage( reader->GetOutput() ) );
+  filter->InPlaceOn(); // reuse the buffer of the reader
   filter->SetScale( radiusArray );
   filter->SetInput( reader->GetOutput() );
 
@@ -293,3 +298,58 @@ void dilationParabolic(
 
 } // end dilationParabolic()
 
+
+/**
+ * ******************* dilationLabel *******************
+ */
+
+template< class ImageType >
+void dilationLabel(
+  const std::string & inputFileName,
+  const std::string & outputFileName,
+  const std::vector<unsigned int> & radius,
+  const std::vector<std::string> & bin,
+  const bool useCompression )
+{
+  /** Typedefs. */
+  typedef typename ImageType::PixelType               PixelType;
+  const unsigned int Dimension = ImageType::ImageDimension;
+  typedef itk::ImageFileReader< ImageType >           ReaderType;
+  typedef itk::ImageFileWriter< ImageType >           WriterType;
+  typedef itk::LabelDilateImageFilter< ImageType >    FilterType;
+  typedef typename FilterType::RadiusType             RadiusType;
+
+  /** Declarations. */
+  typename ReaderType::Pointer reader = ReaderType::New();
+  typename WriterType::Pointer writer = WriterType::New();
+  typename FilterType::Pointer filter = FilterType::New();
+
+  /** Setup the reader. */
+  reader->SetFileName( inputFileName.c_str() );
+
+  /** Get the background value. */
+  PixelType background = itk::NumericTraits<PixelType>::Zero;
+  if( bin.size() == 2 )
+  {
+    background = static_cast<PixelType>( atoi( bin[ 1 ].c_str() ) );
+  }
+
+  /** Get the radius. */
+  RadiusType radiusArray;
+  for( unsigned int i = 0; i < Dimension; ++i )
+  {
+    radiusArray[ i ] = radius[ i ];
+  }
+
+  /** Setup the filter. */
+  filter->SetRadius( radiusArray );
+  filter->SetBackgroundValue( background );
+  filter->SetInput( reader->GetOutput() );
+
+  /** Write the output image. */
+  writer->SetFileName( outputFileName.c_str() );
+  writer->SetInput( filter->GetOutput() );
+  writer->SetUseCompression( useCompression );
+  writer->Update();
+
+} // end dilationLabel()
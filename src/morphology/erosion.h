@@ -286,8 +286,12 @@ void erosionParabolic(
     radiusArray.SetElement( i, radius1D );
   }
 
-  /** Setup the filter. */
+  /** Setup the filter. Binary images go through the lower envelope,
+   * which gives the same result at a cost independent of the radius. */
+  reader->Update();
   erosion->SetUseImageSpacing( false );
+  erosion->SetUseLowerEnvelope( itk::IsBinaryImage( reader->GetOutput() ) );
+  erosion->InPlaceOn(); // reuse the buffer of the reader
   erosion->SetScale( radiusArray );
   erosion->SetInput( reader->GetOutput() );
 
@@ -4,6 +4,9 @@
 
 #include "itkFlatStructuringElement.h"
 #include "itkMorphologicalGradientImageFilter.h"
+#include "itkParabolicErodeImageFilter.h"
+#include "itkParabolicDilateImageFilter.h"
+#include "itkSubtractImageFilter.h"
 
 
 /**
@@ -59,3 +62,83 @@ void gradient(
   writer->Update();
 
 } // end gradient()
+
+
+/**
+ * ******************* gradientParabolic *******************
+ */
+
+template< class ImageType >
+void gradientParabolic(
+  const std::string & inputFileName,
+  const std::string & outputFileName,
+  const std::vector<unsigned int> & radius,
+  const bool useCompression )
+{
+  /** Typedefs. */
+  const unsigned int Dimension = ImageType::ImageDimension;
+  typedef itk::ImageFileReader< ImageType >           ReaderType;
+  typedef itk::ImageFileWriter< ImageType >           WriterType;
+  typedef itk::ParabolicErodeImageFilter<
+    ImageType, ImageType >                            ErodeFilterType;
+  typedef itk::ParabolicDilateImageFilter<
+    ImageType, ImageType >                            DilateFilterType;
+  typedef itk::SubtractImageFilter<
+    ImageType, ImageType, ImageType >                 SubtractFilterType;
+  typedef typename ErodeFilterType::RadiusType        RadiusType;
+  typedef typename ErodeFilterType::ScalarRealType    ScalarRealType;
+
+  /** Declarations. */
+  typename ReaderType::Pointer reader = ReaderType::New();
+  typename WriterType::Pointer writer = WriterType::New();
+  typename ErodeFilterType::Pointer erosion = ErodeFilterType::New();
+  typename DilateFilterType::Pointer dilation = DilateFilterType::New();
+  typename SubtractFilterType::Pointer subtracter = SubtractFilterType::New();
+
+  /** Read the input image. */
+  reader->SetFileName( inputFileName.c_str() );
+  reader->Update();
+  typename ImageType::Pointer image = reader->GetOutput();
+  image->DisconnectPipeline();
+
+  /** Get the correct radius. */
+  RadiusType      radiusArray;
+  ScalarRealType  radius1D = 0.0;
+  for( unsigned int i = 0; i < Dimension; ++i )
+  {
+    // Very specific computation for the parabolic filter:
+    radius1D = static_cast<ScalarRealType>( radius[ i ] ) ;//+ 1.0;
+    radius1D = radius1D * radius1D / 2.0 + 1.0;
+    radiusArray.SetElement( i, radius1D );
+  }
+
+  /** The gradient is the dilation minus the erosion. The erosion is
+   * computed first, in a buffer of its own. Then the dilation and the
+   * subtraction are done in place in the buffer of the input image, so
+   * that only two images are in memory. */
+  const bool binary = itk::IsBinaryImage( image.GetPointer() );
+  erosion->SetUseImageSpacing( false );
+  erosion->SetUseLowerEnvelope( binary );
+  erosion->SetScale( radiusArray );
+  erosion->SetInput( image );
+  erosion->Update();
+  typename ImageType::Pointer eroded = erosion->GetOutput();
+  eroded->DisconnectPipeline();
+
+  dilation->SetUseImageSpacing( false );
+  dilation->SetUseLowerEnvelope( binary );
+  dilation->SetScale( radiusArray );
+  dilation->InPlaceOn();
+  dilation->SetInput( image );
+
+  subtracter->InPlaceOn();
+  subtracter->SetInput1( dilation->GetOutput() );
+  subtracter->SetInput2( eroded );
+
+  /** Write the output image. */
+  writer->SetFileName( outputFileName.c_str() );
+  writer->SetInput( subtracter->GetOutput() );
+  writer->SetUseCompression( useCompression );
+  writer->Update();
+
+} // end gradientParabolic()
@@ -0,0 +1,127 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkLabelDilateImageFilter_h
+#define __itkLabelDilateImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkSize.h"
+#include <vector>
+
+
+namespace itk
+{
+
+/** \class LabelDilateImageFilter
+ * \brief Dilate all labels of a label image at once, with a ball.
+ *
+ * Every background voxel within the ball of Radius around a voxel of some
+ * label gets the label of the nearest such voxel; the labeled voxels keep
+ * their own. This is the union of the binary dilations of every label with
+ * a BinaryBallStructuringElement of the same radius, where a voxel that is
+ * reached by several labels goes to the nearest one, and of equally near
+ * ones to the smallest label.
+ *
+ * The ball contains the offsets k with sum_i ( k_i / ( r_i + 0.5 ) )^2 <= 1.
+ * Scaled by the product of the ( 2 r_i + 1 )^2 this is an integer weighted
+ * squared distance, which is computed exactly, together with the label of
+ * the nearest voxel, in one pass per dimension: every voxel takes the
+ * minimum of the distances along its line within the radius, plus the
+ * squared offset. The distances beyond the ball are saturated. The passes
+ * are threaded over the lines, and the cost is linear in the radius,
+ * instead of in the number of labels times the volume of the ball.
+ *
+ * \ingroup MathematicalMorphologyImageFilters
+ */
+
+template< class TImage >
+class ITK_EXPORT LabelDilateImageFilter :
+  public ImageToImageFilter< TImage, TImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef LabelDilateImageFilter                Self;
+  typedef ImageToImageFilter< TImage, TImage >  Superclass;
+  typedef SmartPointer<Self>                    Pointer;
+  typedef SmartPointer<const Self>              ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( LabelDilateImageFilter, ImageToImageFilter );
+
+  itkStaticConstMacro( ImageDimension, unsigned int, TImage::ImageDimension );
+
+  /** Typedefs. */
+  typedef TImage                                ImageType;
+  typedef typename ImageType::PixelType         PixelType;
+  typedef typename ImageType::RegionType        RegionType;
+  typedef Size< itkGetStaticConstMacro( ImageDimension ) > RadiusType;
+
+  /** Set/Get the radius of the ball, in voxels. */
+  itkSetMacro( Radius, RadiusType );
+  itkGetConstReferenceMacro( Radius, RadiusType );
+
+  /** Set/Get the value of the voxels without a label. Default 0. */
+  itkSetMacro( BackgroundValue, PixelType );
+  itkGetConstMacro( BackgroundValue, PixelType );
+
+protected:
+  LabelDilateImageFilter();
+  virtual ~LabelDilateImageFilter() {};
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** This filter needs the whole input and output at once. */
+  void GenerateInputRequestedRegion( void );
+  void EnlargeOutputRequestedRegion( DataObject * output );
+
+  /** Run the passes over the dimensions. */
+  void GenerateData( void );
+
+  /** The passes, one piece of the lines of the current dimension per thread. */
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback( void * arg );
+  void ThreadedGenerateDataForDimension( unsigned int threadId,
+    unsigned int numberOfThreads );
+
+private:
+  LabelDilateImageFilter( const Self & ); // purposely not implemented
+  void operator=( const Self & );         // purposely not implemented
+
+  RadiusType      m_Radius;
+  PixelType       m_BackgroundValue;
+
+  /** The weight of the squared offset per dimension, the squared distance
+   * of the border of the ball, and the saturated distance beyond it. */
+  std::vector<unsigned long long> m_Weights;
+  unsigned long long              m_BallDistance;
+  unsigned long long              m_Infinity;
+
+  /** The weighted squared distance to the nearest label of every voxel,
+   * in buffer order, and the dimension of the current pass. */
+  std::vector<unsigned long long> m_Distances;
+  unsigned int                    m_CurrentDimension;
+
+}; // end class LabelDilateImageFilter
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkLabelDilateImageFilter.txx"
+#endif
+
+#endif // end #ifndef __itkLabelDilateImageFilter_h
@@ -0,0 +1,285 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkLabelDilateImageFilter_txx
+#define __itkLabelDilateImageFilter_txx
+
+#include "itkLabelDilateImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIterator.h"
+#include "itkMultiThreader.h"
+#include "itkProgressReporter.h"
+
+#include <algorithm>
+
+
+namespace itk
+{
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template< class TImage >
+LabelDilateImageFilter< TImage >
+::LabelDilateImageFilter()
+{
+  this->m_Radius.Fill( 1 );
+  this->m_BackgroundValue = NumericTraits<PixelType>::Zero;
+  this->m_BallDistance = 0;
+  this->m_Infinity = 0;
+  this->m_CurrentDimension = 0;
+
+} // end Constructor
+
+
+/**
+ * ******************* GenerateInputRequestedRegion *******************
+ */
+
+template< class TImage >
+void
+LabelDilateImageFilter< TImage >
+::GenerateInputRequestedRegion( void )
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  ImageType * input = const_cast<ImageType *>( this->GetInput() );
+  if( input )
+  {
+    input->SetRequestedRegionToLargestPossibleRegion();
+  }
+
+} // end GenerateInputRequestedRegion()
+
+
+/**
+ * ******************* EnlargeOutputRequestedRegion *******************
+ */
+
+template< class TImage >
+void
+LabelDilateImageFilter< TImage >
+::EnlargeOutputRequestedRegion( DataObject * output )
+{
+  ImageType * out = dynamic_cast<ImageType *>( output );
+  if( out )
+  {
+    out->SetRequestedRegionToLargestPossibleRegion();
+  }
+
+} // end EnlargeOutputRequestedRegion()
+
+
+/**
+ * ******************* GenerateData *******************
+ */
+
+template< class TImage >
+void
+LabelDilateImageFilter< TImage >
+::GenerateData( void )
+{
+  this->AllocateOutputs();
+
+  /** The ball sum_i ( k_i / ( r_i + 0.5 ) )^2 <= 1, multiplied by the
+   * product of the ( 2 r_i + 1 )^2, so that all weights are integers.
+   */
+  unsigned long long product = 1;
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    const unsigned long long size = 2 * this->m_Radius[ i ] + 1;
+    product *= size * size;
+  }
+  this->m_Weights.resize( ImageDimension );
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    const unsigned long long size = 2 * this->m_Radius[ i ] + 1;
+    this->m_Weights[ i ] = 4 * ( product / ( size * size ) );
+  }
+  this->m_BallDistance = product;
+  this->m_Infinity = product + 1;
+
+  /** One pass per dimension, threaded over the lines of that dimension. */
+  this->m_Distances.resize( this->GetOutput()->GetBufferedRegion().GetNumberOfPixels() );
+  this->GetMultiThreader()->SetNumberOfThreads( this->GetNumberOfThreads() );
+  this->GetMultiThreader()->SetSingleMethod( this->ThreaderCallback, this );
+  for( unsigned int d = 0; d < ImageDimension; ++d )
+  {
+    this->m_CurrentDimension = d;
+    this->GetMultiThreader()->SingleMethodExecute();
+  }
+  std::vector<unsigned long long>().swap( this->m_Distances );
+
+} // end GenerateData()
+
+
+/**
+ * ******************* ThreaderCallback *******************
+ */
+
+template< class TImage >
+ITK_THREAD_RETURN_TYPE
+LabelDilateImageFilter< TImage >
+::ThreaderCallback( void * arg )
+{
+  typedef MultiThreader::ThreadInfoStruct ThreadInfoType;
+  ThreadInfoType * info = static_cast<ThreadInfoType *>( arg );
+  Self * filter = static_cast<Self *>( info->UserData );
+  filter->ThreadedGenerateDataForDimension( info->ThreadID, info->NumberOfThreads );
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end ThreaderCallback()
+
+
+/**
+ * ******************* ThreadedGenerateDataForDimension *******************
+ */
+
+template< class TImage >
+void
+LabelDilateImageFilter< TImage >
+::ThreadedGenerateDataForDimension( unsigned int threadId, unsigned int numberOfThreads )
+{
+  ImageType * output = this->GetOutput();
+  const unsigned int d = this->m_CurrentDimension;
+
+  /** Split the outermost axis other than the current one, so that every
+   * thread has whole lines.
+   */
+  RegionType region = output->GetRequestedRegion();
+  int splitAxis = -1;
+  for( int axis = static_cast<int>( ImageDimension ) - 1; axis >= 0; --axis )
+  {
+    if( axis != static_cast<int>( d ) && region.GetSize()[ axis ] > 1 )
+    {
+      splitAxis = axis;
+      break;
+    }
+  }
+  if( splitAxis < 0 )
+  {
+    if( threadId > 0 ) return;
+  }
+  else
+  {
+    const SizeValueType size = region.GetSize()[ splitAxis ];
+    const SizeValueType begin = size * threadId / numberOfThreads;
+    const SizeValueType end = size * ( threadId + 1 ) / numberOfThreads;
+    if( begin == end ) return;
+    region.SetIndex( splitAxis, region.GetIndex()[ splitAxis ] + begin );
+    region.SetSize( splitAxis, end - begin );
+  }
+
+  const PixelType background = this->m_BackgroundValue;
+  const unsigned long long infinity = this->m_Infinity;
+  PixelType * labels = output->GetBufferPointer();
+  unsigned long long * distances = &this->m_Distances[ 0 ];
+
+  /** The first pass starts from the labeled voxels of the input. */
+  if( d == 0 )
+  {
+    ImageRegionConstIterator<ImageType> inIt( this->GetInput(), region );
+    ImageRegionIterator<ImageType> outIt( output, region );
+    for( ; !inIt.IsAtEnd(); ++inIt, ++outIt )
+    {
+      const PixelType label = inIt.Get();
+      outIt.Set( label );
+      distances[ output->ComputeOffset( outIt.GetIndex() ) ]
+        = label != background ? 0 : infinity;
+    }
+  }
+
+  /** Every voxel takes the nearest label along its line, within the radius. */
+  const long lineLength = region.GetSize()[ d ];
+  const long radius = static_cast<long>( this->m_Radius[ d ] );
+  const unsigned long long weight = this->m_Weights[ d ];
+  const OffsetValueType stride = output->GetOffsetTable()[ d ];
+  std::vector<unsigned long long> lineDistances( lineLength );
+  std::vector<PixelType> lineLabels( lineLength );
+
+  RegionType lineStarts = region;
+  lineStarts.SetSize( d, 1 );
+  const float progressPerDimension = 1.0 / ImageDimension;
+  ProgressReporter progress( this, threadId, lineStarts.GetNumberOfPixels(), 30,
+    d * progressPerDimension, progressPerDimension );
+
+  ImageRegionConstIteratorWithIndex<ImageType> it( output, lineStarts );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+  {
+    const OffsetValueType start = output->ComputeOffset( it.GetIndex() );
+    for( long pos = 0; pos < lineLength; ++pos )
+    {
+      lineDistances[ pos ] = distances[ start + pos * stride ];
+      lineLabels[ pos ] = labels[ start + pos * stride ];
+    }
+
+    for( long pos = 0; pos < lineLength; ++pos )
+    {
+      unsigned long long best = infinity;
+      PixelType bestLabel = background;
+      const long first = std::max( pos - radius, 0L );
+      const long last = std::min( pos + radius, lineLength - 1 );
+      for( long q = first; q <= last; ++q )
+      {
+        if( lineDistances[ q ] == infinity ) continue;
+        const unsigned long long k = static_cast<unsigned long long>( q > pos ? q - pos : pos - q );
+        const unsigned long long value = lineDistances[ q ] + weight * k * k;
+        if( value < best || ( value == best && lineLabels[ q ] < bestLabel ) )
+        {
+          best = value;
+          bestLabel = lineLabels[ q ];
+        }
+      }
+      if( best > this->m_BallDistance )
+      {
+        best = infinity;
+        bestLabel = background;
+      }
+      distances[ start + pos * stride ] = best;
+      labels[ start + pos * stride ] = bestLabel;
+    }
+
+    progress.CompletedPixel();
+  }
+
+} // end ThreadedGenerateDataForDimension()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template< class TImage >
+void
+LabelDilateImageFilter< TImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "Radius: " << this->m_Radius << std::endl;
+  os << indent << "BackgroundValue: "
+    << static_cast<typename NumericTraits<PixelType>::PrintType>( this->m_BackgroundValue )
+    << std::endl;
+
+} // end PrintSelf()
+
+} // end namespace itk
+
+#endif // end #ifndef __itkLabelDilateImageFilter_txx
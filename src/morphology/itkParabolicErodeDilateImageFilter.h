@@ -1,9 +1,11 @@
 #ifndef __itkParabolicErodeDilateImageFilter_h
 #define __itkParabolicErodeDilateImageFilter_h
 
-#include "itkImageToImageFilter.h"
+#include "itkInPlaceImageFilter.h"
 #include "itkNumericTraits.h"
 #include "itkProgressReporter.h"
+#include "itkSimpleFastMutexLock.h"
+#include <vector>
 
 namespace itk
 {
@@ -36,6 +38,10 @@ namespace itk
  * This filter is threaded. Threading mechanism derived from
  * SignedMaurerDistanceMap extensions by Gaetan Lehman
  *
+ * Every line is read into a buffer before it is written, so the filter
+ * can run in place on its input, with InPlaceOn(), when the input and
+ * output types are the same. It is off by default.
+ *
  * \author Richard Beare, Department of Medicine, Monash University,
  * Australia.  <Richard.Beare@med.monash.edu.au>
  *
@@ -46,13 +52,13 @@ template <typename TInputImage,
     bool doDilate,
           typename TOutputImage= TInputImage >
 class ITK_EXPORT ParabolicErodeDilateImageFilter:
-    public ImageToImageFilter<TInputImage,TOutputImage>
+    public InPlaceImageFilter<TInputImage,TOutputImage>
 {
 
 public:
   /** Standard class typedefs. */
   typedef ParabolicErodeDilateImageFilter  Self;
-  typedef ImageToImageFilter<TInputImage,TOutputImage> Superclass;
+  typedef InPlaceImageFilter<TInputImage,TOutputImage> Superclass;
   typedef SmartPointer<Self>                   Pointer;
   typedef SmartPointer<const Self>        ConstPointer;
 
@@ -60,7 +66,7 @@ public:
   itkNewMacro(Self);
 
   /** Runtime information support. */
-  itkTypeMacro(ParabolicErodeDilateImageFilter, ImageToImageFilter);
+  itkTypeMacro(ParabolicErodeDilateImageFilter, InPlaceImageFilter);
 
   /** Pixel Type of the input image */
   typedef TInputImage                                    InputImageType;
@@ -109,6 +115,17 @@ public:
   itkSetMacro(UseImageSpacing, bool);
   itkGetConstReferenceMacro(UseImageSpacing, bool);
   itkBooleanMacro(UseImageSpacing);
+
+  /**
+   * Set/Get whether the lines are computed as the lower envelope of the
+   * parabolas, as in a distance transform, instead of with the contact
+   * point search. The result is the same, and the cost does not depend on
+   * the scale, which pays off for binary images and large scales -
+   * default is false
+   */
+  itkSetMacro(UseLowerEnvelope, bool);
+  itkGetConstReferenceMacro(UseLowerEnvelope, bool);
+  itkBooleanMacro(UseLowerEnvelope);
   /** Image related typedefs. */
 
 #ifdef ITK_USE_CONCEPT_CHECKING
@@ -129,14 +146,28 @@ protected:
 
   /** Generate Data */
   void GenerateData( void );
-  int SplitRequestedRegion(int i, int num, OutputImageRegionType& splitRegion);
-  void ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, ThreadIdType threadId );
+
+  /** The lines of a pass are processed in batches, which the threads
+   * take from a shared counter until none are left, so that all threads
+   * stay busy whatever the shape of the image. A batch is a region of
+   * whole lines in the current dimension. */
+  static ITK_THREAD_RETURN_TYPE BatchThreaderCallback( void * arg );
+
+  /** Set up the batches of the current dimension. */
+  void InitializeBatches( unsigned int numberOfThreads );
+
+  /** Get the region of the next batch, false if none are left. */
+  bool GetNextBatch( OutputImageRegionType& batchRegion );
+
+  /** Process the lines of the current dimension in a region. */
+  void GenerateDataForRegion(const OutputImageRegionType& region, ProgressReporter& progress );
 
 //  virtual void GenerateInputRequestedRegion() throw(InvalidRequestedRegionError);
   // Override since the filter produces the entire dataset.
   void EnlargeOutputRequestedRegion(DataObject *output);
 
   bool m_UseImageSpacing;
+  bool m_UseLowerEnvelope;
 
 private:
   ParabolicErodeDilateImageFilter(const Self&); //purposely not implemented
@@ -146,6 +177,16 @@ private:
 
   int m_MagnitudeSign;
   int m_CurrentDimension;
+
+  /** The batches of the current dimension: the axes along which the
+   * requested region is split, the number of pieces along each, and the
+   * next batch to be processed. */
+  std::vector<unsigned int>   m_BatchAxes;
+  std::vector<SizeValueType>  m_BatchPieces;
+  SizeValueType               m_NumberOfBatches;
+  SizeValueType               m_NextBatch;
+  SizeValueType               m_NumberOfLinesPerThread;
+  SimpleFastMutexLock         m_BatchLock;
 };
 
 } // end namespace itk
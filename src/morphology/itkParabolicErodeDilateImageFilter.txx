@@ -24,6 +24,8 @@ ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>
 {
   this->SetNumberOfRequiredOutputs( 1 );
   this->SetNumberOfRequiredInputs( 1 );
+  // running in place changes the input, so it has to be asked for
+  this->InPlaceOff();
 // needs to be selected according to erosion/dilation
 
   if(doDilate)
@@ -37,68 +39,13 @@ ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>
     this->m_MagnitudeSign = -1;
     }
   this->m_UseImageSpacing = false;
+  this->m_UseLowerEnvelope = false;
+  this->m_CurrentDimension = 0;
+  this->m_NumberOfBatches = 0;
+  this->m_NextBatch = 0;
+  this->m_NumberOfLinesPerThread = 0;
 }
 
-template <typename TInputImage, bool doDilate, typename TOutputImage>
-int
-ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>
-::SplitRequestedRegion(int i, int num, OutputImageRegionType& splitRegion)
-{
-  // Get the output pointer
-  OutputImageType * outputPtr = this->GetOutput();
-  const typename TOutputImage::SizeType& requestedRegionSize
-    = outputPtr->GetRequestedRegion().GetSize();
-
-  int splitAxis;
-  typename TOutputImage::IndexType splitIndex;
-  typename TOutputImage::SizeType splitSize;
-
-  // Initialize the splitRegion to the output requested region
-  splitRegion = outputPtr->GetRequestedRegion();
-  splitIndex = splitRegion.GetIndex();
-  splitSize = splitRegion.GetSize();
-
-  // split on the outermost dimension available
-  // and avoid the current dimension
-  splitAxis = outputPtr->GetImageDimension() - 1;
-  while (requestedRegionSize[splitAxis] == 1 || splitAxis == (int)m_CurrentDimension)
-    {
-    --splitAxis;
-    if(splitAxis < 0)
-      { // cannot split
-      itkDebugMacro("  Cannot Split");
-      return 1;
-      }
-    }
-
-  // determine the actual number of pieces that will be generated
-  typename TOutputImage::SizeType::SizeValueType range = requestedRegionSize[splitAxis];
-  int valuesPerThread = (int)::ceil(range/(double)num);
-  int maxThreadIdUsed = (int)::ceil(range/(double)valuesPerThread) - 1;
-
-  // Split the region
-  if(i < maxThreadIdUsed)
-    {
-    splitIndex[splitAxis] += i*valuesPerThread;
-    splitSize[splitAxis] = valuesPerThread;
-    }
-  if(i == maxThreadIdUsed)
-    {
-    splitIndex[splitAxis] += i*valuesPerThread;
-    // last thread needs to process the "rest" dimension being split
-    splitSize[splitAxis] = splitSize[splitAxis] - i*valuesPerThread;
-    }
-
-  // set the split region ivars
-  splitRegion.SetIndex( splitIndex );
-  splitRegion.SetSize( splitSize );
-
-  itkDebugMacro("  Split Piece: " << splitRegion );
-
-  return maxThreadIdUsed + 1;
-}
-
-
 template <typename TInputImage, bool doDilate, typename TOutputImage>
 void
 ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>
@@ -152,48 +99,138 @@ ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage >
   typename TOutputImage::Pointer       outputImage(   this->GetOutput()        );
 
   //const unsigned int imageDimension = inputImage->GetImageDimension();
-  outputImage->SetBufferedRegion( outputImage->GetRequestedRegion() );
-  outputImage->Allocate();
+  // the output may reuse the buffer of the input, see InPlaceOn()
+  this->AllocateOutputs();
   // Set up the multithreaded processing
-  typename ImageSource< TOutputImage >::ThreadStruct str;
-  str.Filter = this;
-  this->GetMultiThreader()->SetNumberOfThreads(this->GetNumberOfThreads());
-  this->GetMultiThreader()->SetSingleMethod(this->ThreaderCallback, &str);
+  const unsigned int numberOfThreads = this->GetNumberOfThreads();
+  this->GetMultiThreader()->SetNumberOfThreads( numberOfThreads );
+  this->GetMultiThreader()->SetSingleMethod( this->BatchThreaderCallback, this );
 
   // multithread the execution
   for( unsigned int d=0; d<ImageDimension; d++ )
     {
     this->m_CurrentDimension = d;
+    this->InitializeBatches( this->GetMultiThreader()->GetNumberOfThreads() );
     this->GetMultiThreader()->SingleMethodExecute();
     }
 
 }
 
 template <typename TInputImage, bool doDilate, typename TOutputImage>
-void
+ITK_THREAD_RETURN_TYPE
 ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>
-::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, ThreadIdType threadId )
+::BatchThreaderCallback( void * arg )
 {
-  // compute the number of rows first, so we can setup a progress reporter
-  typename std::vector< unsigned int > NumberOfRows;
-  InputSizeType   size   = outputRegionForThread.GetSize();
+  typedef MultiThreader::ThreadInfoStruct ThreadInfoType;
+  ThreadInfoType * info = static_cast<ThreadInfoType *>( arg );
+  Self * filter = static_cast<Self *>( info->UserData );
+
+  // All threads take batches until none are left, so each processes
+  // about the same number of lines, which is what thread 0 reports.
+  float progressPerDimension = 1.0/ImageDimension;
+  ProgressReporter progress( filter, info->ThreadID,
+    filter->m_NumberOfLinesPerThread, 30,
+    filter->m_CurrentDimension * progressPerDimension, progressPerDimension );
 
-  for( unsigned int i = 0; i < InputImageDimension; i++ )
+  OutputImageRegionType batchRegion;
+  while( filter->GetNextBatch( batchRegion ) )
+    {
+    filter->GenerateDataForRegion( batchRegion, progress );
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+void
+ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>
+::InitializeBatches( unsigned int numberOfThreads )
+{
+  const OutputImageRegionType & requestedRegion = this->GetOutput()->GetRequestedRegion();
+  const OutputSizeType & size = requestedRegion.GetSize();
+
+  // several batches per thread, so that threads finishing early find work
+  const SizeValueType targetNumberOfBatches = 8 * numberOfThreads;
+
+  // split the outer axes first, all but the current one, and x last,
+  // since the lines of a batch are processed in blocks along x
+  this->m_BatchAxes.clear();
+  this->m_BatchPieces.clear();
+  this->m_NumberOfBatches = 1;
+  for( int axis = static_cast<int>( ImageDimension ) - 1; axis >= 0; --axis )
     {
-    NumberOfRows.push_back( 1 );
-    for( unsigned int d = 0; d < InputImageDimension; d++)
+    if( axis == this->m_CurrentDimension || size[axis] == 1 )
+      {
+      continue;
+      }
+    this->m_BatchAxes.push_back( axis );
+    if( this->m_NumberOfBatches * size[axis] <= targetNumberOfBatches )
+      {
+      this->m_BatchPieces.push_back( size[axis] );
+      this->m_NumberOfBatches *= size[axis];
+      }
+    else
       {
-      if( d != i )
-        {
-        NumberOfRows[ i ] *= size[ d ];
-        }
+      // no more pieces than pixels, so no batch is empty
+      const SizeValueType pieces = ( targetNumberOfBatches + this->m_NumberOfBatches - 1 )
+        / this->m_NumberOfBatches;
+      this->m_BatchPieces.push_back( pieces );
+      this->m_NumberOfBatches *= pieces;
+      break;
       }
     }
-  float progressPerDimension = 1.0/ImageDimension;
+  this->m_NextBatch = 0;
+
+  const SizeValueType numberOfLines
+    = requestedRegion.GetNumberOfPixels() / size[this->m_CurrentDimension];
+  this->m_NumberOfLinesPerThread = ( numberOfLines + numberOfThreads - 1 ) / numberOfThreads;
+
+  itkDebugMacro( "  Number of batches: " << this->m_NumberOfBatches );
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+bool
+ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>
+::GetNextBatch( OutputImageRegionType& batchRegion )
+{
+  this->m_BatchLock.Lock();
+  SizeValueType batch = this->m_NextBatch;
+  if( batch < this->m_NumberOfBatches )
+    {
+    ++this->m_NextBatch;
+    }
+  this->m_BatchLock.Unlock();
+  if( batch >= this->m_NumberOfBatches )
+    {
+    return false;
+    }
 
-  ProgressReporter * progress = new ProgressReporter(this, threadId, NumberOfRows[m_CurrentDimension], 30, this->m_CurrentDimension * progressPerDimension, progressPerDimension);
+  // the batch number gives the piece along every batch axis
+  batchRegion = this->GetOutput()->GetRequestedRegion();
+  typename OutputImageRegionType::IndexType index = batchRegion.GetIndex();
+  OutputSizeType size = batchRegion.GetSize();
+  for( unsigned int i = 0; i < this->m_BatchAxes.size(); ++i )
+    {
+    const unsigned int axis = this->m_BatchAxes[i];
+    const SizeValueType pieces = this->m_BatchPieces[i];
+    const SizeValueType piece = batch % pieces;
+    batch /= pieces;
+    const SizeValueType begin = size[axis] * piece / pieces;
+    const SizeValueType end = size[axis] * ( piece + 1 ) / pieces;
+    index[axis] += begin;
+    size[axis] = end - begin;
+    }
+  batchRegion.SetIndex( index );
+  batchRegion.SetSize( size );
 
+  return true;
+}
 
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+void
+ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>
+::GenerateDataForRegion(const OutputImageRegionType& region, ProgressReporter& progress )
+{
   typedef ImageLinearConstIteratorWithIndex< TInputImage  >  InputConstIteratorType;
   typedef ImageLinearIteratorWithIndex< TOutputImage >  OutputIteratorType;
 
@@ -206,11 +243,6 @@ ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>
   typename TInputImage::ConstPointer   inputImage(    this->GetInput ()   );
   typename TOutputImage::Pointer       outputImage(   this->GetOutput()        );
 
-
-  outputImage->SetBufferedRegion( outputImage->GetRequestedRegion() );
-  outputImage->Allocate();
-  RegionType region = outputRegionForThread;
-
   InputConstIteratorType  inputIterator(  inputImage,  region );
   OutputIteratorType      outputIterator( outputImage, region );
   OutputConstIteratorType inputIteratorStage2( outputImage, region );
@@ -237,12 +269,13 @@ ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>
 
       doOneDimension<InputConstIteratorType,OutputIteratorType,
   RealType, OutputPixelType, doDilate>(inputIterator, outputIterator,
-               *progress, LineLength, 0,
+               progress, LineLength, 0,
                this->m_MagnitudeSign,
                this->m_UseImageSpacing,
                this->m_Extreme,
                image_scale,
-               this->m_Scale[0]);
+               this->m_Scale[0],
+               this->m_UseLowerEnvelope);
       }
     else
       {
@@ -265,19 +298,19 @@ ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>
       // other dimensions
       if( this->m_Scale[m_CurrentDimension] > 0)
   {
-  // create a vector to buffer lines
-  unsigned long LineLength = region.GetSize()[m_CurrentDimension];
   //RealType magnitude = 1.0/(2.0 * this->m_Scale[dd]);
       RealType image_scale = this->GetInput()->GetSpacing()[m_CurrentDimension];
 
-      doOneDimension<OutputConstIteratorType,OutputIteratorType,
-  RealType, OutputPixelType, doDilate>(inputIteratorStage2, outputIterator,
-               *progress, LineLength, this->m_CurrentDimension,
+      // the lines are strided in memory, process them in blocks
+      doOneDimensionBlocked<TOutputImage,
+  RealType, OutputPixelType, doDilate>(outputImage.GetPointer(), region,
+               progress, this->m_CurrentDimension,
                this->m_MagnitudeSign,
                this->m_UseImageSpacing,
                this->m_Extreme,
                image_scale,
-               this->m_Scale[m_CurrentDimension]);
+               this->m_Scale[m_CurrentDimension],
+               this->m_UseLowerEnvelope);
   }
     }
 }
@@ -297,6 +330,7 @@ ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>
     {
     os << "Scale in voxels: " << this->m_Scale << std::endl;
     }
+  os << "UseLowerEnvelope: " << this->m_UseLowerEnvelope << std::endl;
 }
 
 
@@ -2,8 +2,12 @@
 #define __itkParabolicUtils_h
 
 #include <itkArray.h>
+#include <algorithm>
+#include <vector>
 
 #include "itkProgressReporter.h"
+#include "itkImageLinearConstIteratorWithIndex.h"
+#include "itkImageRegionConstIterator.h"
 namespace itk {
 template <class LineBufferType, class RealType, bool doDilate>
 void DoLine(LineBufferType &LineBuf, LineBufferType &tmpLineBuf,
@@ -51,6 +55,114 @@ void DoLine(LineBufferType &LineBuf, LineBufferType &tmpLineBuf,
     }
 }
 
+/** The buffers of DoLineEnvelope, resized as needed. */
+template <class RealType>
+struct LineEnvelopeBuffers
+{
+  std::vector<long>     m_Parabolas;
+  std::vector<RealType> m_Boundaries;
+  std::vector<RealType> m_Values;
+};
+
+/** The same erosion or dilation of a line as DoLine, as the lower
+ * envelope of the parabolas, in the way of a distance transform
+ * (Felzenszwalb and Huttenlocher, Distance transforms of sampled
+ * functions, 2004). The cost is linear in the line length whatever the
+ * scale, where the contact point search of DoLine grows with the distance
+ * to the contact points, as in binary images with a large scale. Every
+ * value is evaluated with the expression of DoLine, from the best of the
+ * parabolas of the envelope around it, so the result is the same. */
+template <class LineBufferType, class RealType, bool doDilate>
+void DoLineEnvelope(LineBufferType &LineBuf,
+      const RealType magnitude, const RealType m_Extreme,
+      LineEnvelopeBuffers<RealType> &buffers)
+{
+  const long LineLength = LineBuf.size();
+  if( LineLength == 0 )
+    {
+    return;
+    }
+  std::vector<long> & parabolas = buffers.m_Parabolas;
+  std::vector<RealType> & boundaries = buffers.m_Boundaries;
+  std::vector<RealType> & values = buffers.m_Values;
+  parabolas.resize( LineLength );
+  boundaries.resize( LineLength + 1 );
+
+  // a dilation is the erosion of the negated line, by width (x - q)^2
+  const RealType width = doDilate ? magnitude : -magnitude;
+  const RealType sign = doDilate ? -1 : 1;
+  const RealType infinity = NumericTraits<RealType>::max();
+
+  // the lower envelope, the parabola of position parabolas[k] is the
+  // lowest between boundaries[k] and boundaries[k + 1]
+  long k = 0;
+  parabolas[0] = 0;
+  boundaries[0] = -infinity;
+  boundaries[1] = infinity;
+  for (long q = 1; q < LineLength; q++)
+    {
+    const RealType hq = sign * LineBuf[q] + width * q * q;
+    long v = parabolas[k];
+    RealType s = ( hq - sign * LineBuf[v] - width * v * v ) / ( 2 * width * ( q - v ) );
+    while( s <= boundaries[k] )
+      {
+      --k;
+      v = parabolas[k];
+      s = ( hq - sign * LineBuf[v] - width * v * v ) / ( 2 * width * ( q - v ) );
+      }
+    ++k;
+    parabolas[k] = q;
+    boundaries[k] = s;
+    boundaries[k + 1] = infinity;
+    }
+  const long numberOfParabolas = k + 1;
+
+  // the line is overwritten, keep the values of the parabolas
+  values.resize( numberOfParabolas );
+  for (long j = 0; j < numberOfParabolas; j++)
+    {
+    values[j] = LineBuf[parabolas[j]];
+    }
+  k = 0;
+  for (long pos = 0; pos < LineLength; pos++)
+    {
+    while( boundaries[k + 1] < pos )
+      {
+      ++k;
+      }
+    RealType BaseVal = (RealType)m_Extreme;
+    const long first = std::max( k - 1, 0L );
+    const long last = std::min( k + 1, numberOfParabolas - 1 );
+    for (long j = first; j <= last; j++)
+      {
+      const long krange = parabolas[j] - pos;
+      RealType T = values[j] - magnitude * krange * krange;
+      if(doDilate ? (T >= BaseVal) : (T <= BaseVal) )
+        {
+        BaseVal = T;
+        }
+      }
+    LineBuf[pos] = BaseVal;
+    }
+}
+
+/** Erode or dilate a line with DoLine, or with DoLineEnvelope. */
+template <class LineBufferType, class RealType, bool doDilate>
+void DoLineWith(LineBufferType &LineBuf, LineBufferType &tmpLineBuf,
+      const RealType magnitude, const RealType m_Extreme,
+      const bool useLowerEnvelope, LineEnvelopeBuffers<RealType> &buffers)
+{
+  if( useLowerEnvelope )
+    {
+    DoLineEnvelope<LineBufferType, RealType, doDilate>(LineBuf, magnitude,
+      m_Extreme, buffers);
+    }
+  else
+    {
+    DoLine<LineBufferType, RealType, doDilate>(LineBuf, tmpLineBuf, magnitude, m_Extreme);
+    }
+}
+
 template <class TInIter, class TOutIter, class RealType,
     class OutputPixelType, bool doDilate>
 void doOneDimension(TInIter &inputIterator, TOutIter &outputIterator,
@@ -61,7 +173,8 @@ void doOneDimension(TInIter &inputIterator, TOutIter &outputIterator,
         const bool m_UseImageSpacing,
         const RealType m_Extreme,
         const RealType image_scale,
-        const RealType Sigma)
+        const RealType Sigma,
+        const bool useLowerEnvelope = false)
 {
 //  typedef typename std::vector<RealType> LineBufferType;
 
@@ -76,6 +189,7 @@ void doOneDimension(TInIter &inputIterator, TOutIter &outputIterator,
   const RealType magnitude = m_MagnitudeSign * 1.0/(2.0 * Sigma/(iscale*iscale));
   LineBufferType LineBuf(LineLength);
   LineBufferType tmpLineBuf(LineLength);
+  LineEnvelopeBuffers<RealType> envelopeBuffers;
   inputIterator.SetDirection(direction);
   outputIterator.SetDirection(direction);
   inputIterator.GoToBegin();
@@ -93,7 +207,8 @@ void doOneDimension(TInIter &inputIterator, TOutIter &outputIterator,
       ++inputIterator;
       }
 
-    DoLine<LineBufferType, RealType, doDilate>(LineBuf, tmpLineBuf, magnitude, m_Extreme);
+    DoLineWith<LineBufferType, RealType, doDilate>(LineBuf, tmpLineBuf, magnitude,
+      m_Extreme, useLowerEnvelope, envelopeBuffers);
     // copy the line back
     unsigned int j=0;
     while( !outputIterator.IsAtEndOfLine() )
@@ -110,5 +225,244 @@ void doOneDimension(TInIter &inputIterator, TOutIter &outputIterator,
 }
 
 
+
+/** Process the lines along a direction other than x in blocks of
+ * adjacent lines. The lines of a block are neighbours in x, so that
+ * they are gathered from, and scattered back to, contiguous memory: a
+ * tile holding the block is filled one row of the image at a time,
+ * instead of one strided pixel at a time per line. Every line of the
+ * tile is then processed by DoLine, so the result is the same as with
+ * doOneDimension. The image is processed in place and its buffered
+ * region must contain the region. The direction must not be 0, those
+ * lines are contiguous already and are handled by doOneDimension. */
+template <class TImage, class RealType, class OutputPixelType, bool doDilate>
+void doOneDimensionBlocked(TImage *image,
+        const typename TImage::RegionType &region,
+        ProgressReporter &progress,
+        const unsigned direction,
+        const int m_MagnitudeSign,
+        const bool m_UseImageSpacing,
+        const RealType m_Extreme,
+        const RealType image_scale,
+        const RealType Sigma,
+        const bool useLowerEnvelope = false)
+{
+  typedef typename itk::Array<RealType> LineBufferType;
+  typedef typename TImage::PixelType    PixelType;
+  typedef typename TImage::RegionType   RegionType;
+
+  // the number of lines per block; a tile of this many lines of doubles
+  // stays in the cache for the usual line lengths
+  const unsigned long BlockSize = 16;
+
+  RealType iscale = 1.0;
+  if( m_UseImageSpacing)
+    {
+    iscale = image_scale;
+    }
+  const RealType magnitude = m_MagnitudeSign * 1.0/(2.0 * Sigma/(iscale*iscale));
+
+  const long LineLength = region.GetSize()[direction];
+  const long RowLength = region.GetSize()[0];
+  const long LineStride = image->GetOffsetTable()[direction];
+
+  std::vector<RealType> tile( BlockSize * LineLength );
+  LineBufferType LineBuf;
+  LineBufferType tmpLineBuf(LineLength);
+  LineEnvelopeBuffers<RealType> envelopeBuffers;
+
+  // visit the rows in x of the first slice across the direction
+  RegionType rowRegion = region;
+  typename RegionType::SizeType rowSize = rowRegion.GetSize();
+  rowSize[direction] = 1;
+  rowRegion.SetSize( rowSize );
+  ImageLinearConstIteratorWithIndex<TImage> rowIterator( image, rowRegion );
+  rowIterator.SetDirection( 0 );
+  rowIterator.GoToBegin();
+
+  PixelType * buffer = image->GetBufferPointer();
+  while( !rowIterator.IsAtEnd() )
+    {
+    PixelType * row = buffer + image->ComputeOffset( rowIterator.GetIndex() );
+    for( long x0 = 0; x0 < RowLength; x0 += BlockSize )
+      {
+      const long numberOfLines = std::min( static_cast<long>( BlockSize ), RowLength - x0 );
+
+      // gather the block, one contiguous piece of a row at a time
+      for( long pos = 0; pos < LineLength; pos++ )
+        {
+        const PixelType * in = row + x0 + pos * LineStride;
+        for( long b = 0; b < numberOfLines; b++ )
+          {
+          tile[b * LineLength + pos] = static_cast<RealType>( in[b] );
+          }
+        }
+
+      for( long b = 0; b < numberOfLines; b++ )
+        {
+        LineBuf.SetData( &tile[b * LineLength], LineLength, false );
+        DoLineWith<LineBufferType, RealType, doDilate>(LineBuf, tmpLineBuf, magnitude,
+          m_Extreme, useLowerEnvelope, envelopeBuffers);
+        progress.CompletedPixel();
+        }
+
+      // scatter the block back
+      for( long pos = 0; pos < LineLength; pos++ )
+        {
+        PixelType * out = row + x0 + pos * LineStride;
+        for( long b = 0; b < numberOfLines; b++ )
+          {
+          out[b] = static_cast<OutputPixelType>( tile[b * LineLength + pos] );
+          }
+        }
+      }
+    rowIterator.NextLine();
+    }
+}
+
+/** The squared signed distance along a line, in one go for both sides.
+ * The line holds the squared distance to the nearest voxel of the other
+ * side found so far, positive on one side and negative on the other. The
+ * voxels of the other side have distance 0, so the two sides are two
+ * parabolic erosions, of the positive and of the negated negative part,
+ * and every voxel keeps the result of its own side. The sign of a voxel
+ * never changes, since the distance to the other side is never 0. */
+template <class LineBufferType, class RealType>
+void DoSignedLine(LineBufferType &LineBuf, LineBufferType &tmpLineBuf,
+      LineBufferType &positiveBuf, LineBufferType &negativeBuf,
+      const RealType magnitude)
+{
+  const long LineLength = LineBuf.size();
+  for (long pos = 0; pos < LineLength; pos++)
+    {
+    positiveBuf[pos] = std::max( LineBuf[pos], static_cast<RealType>( 0 ) );
+    negativeBuf[pos] = std::max( -LineBuf[pos], static_cast<RealType>( 0 ) );
+    }
+  const RealType extreme = NumericTraits<RealType>::max();
+  DoLine<LineBufferType, RealType, false>(positiveBuf, tmpLineBuf, magnitude, extreme);
+  DoLine<LineBufferType, RealType, false>(negativeBuf, tmpLineBuf, magnitude, extreme);
+  for (long pos = 0; pos < LineLength; pos++)
+    {
+    LineBuf[pos] = LineBuf[pos] > 0 ? positiveBuf[pos] : -negativeBuf[pos];
+    }
+}
+
+/** Process the lines of a region along a direction with DoSignedLine,
+ * in place. The lines along x are contiguous and processed one by one,
+ * the others are processed in blocks of adjacent lines, gathered and
+ * scattered a row at a time as in doOneDimensionBlocked. The distances
+ * are in world units if m_UseImageSpacing. */
+template <class TImage, class RealType>
+void doSignedOneDimension(TImage *image,
+        const typename TImage::RegionType &region,
+        ProgressReporter &progress,
+        const unsigned direction,
+        const bool m_UseImageSpacing)
+{
+  typedef typename itk::Array<RealType> LineBufferType;
+  typedef typename TImage::PixelType    PixelType;
+  typedef typename TImage::RegionType   RegionType;
+
+  const unsigned long BlockSize = direction == 0 ? 1 : 16;
+
+  RealType iscale = 1.0;
+  if( m_UseImageSpacing)
+    {
+    iscale = image->GetSpacing()[direction];
+    }
+  // the erosion with scale 0.5, so that the result is the squared distance
+  const RealType magnitude = -iscale*iscale;
+
+  const long LineLength = region.GetSize()[direction];
+  const long RowLength = direction == 0 ? 1 : region.GetSize()[0];
+  const long LineStride = image->GetOffsetTable()[direction];
+
+  std::vector<RealType> tile( BlockSize * LineLength );
+  LineBufferType LineBuf;
+  LineBufferType tmpLineBuf(LineLength);
+  LineBufferType positiveBuf(LineLength);
+  LineBufferType negativeBuf(LineLength);
+
+  // visit the starts of the lines, the rows in x of the first slice
+  // across the direction, or the first voxels of the lines along x
+  RegionType rowRegion = region;
+  typename RegionType::SizeType rowSize = rowRegion.GetSize();
+  rowSize[direction] = 1;
+  rowRegion.SetSize( rowSize );
+  ImageLinearConstIteratorWithIndex<TImage> rowIterator( image, rowRegion );
+  rowIterator.SetDirection( 0 );
+  rowIterator.GoToBegin();
+
+  PixelType * buffer = image->GetBufferPointer();
+  while( !rowIterator.IsAtEnd() )
+    {
+    PixelType * row = buffer + image->ComputeOffset( rowIterator.GetIndex() );
+    for( long x0 = 0; x0 < RowLength; x0 += BlockSize )
+      {
+      const long numberOfLines = std::min( static_cast<long>( BlockSize ), RowLength - x0 );
+
+      for( long pos = 0; pos < LineLength; pos++ )
+        {
+        const PixelType * in = row + x0 + pos * LineStride;
+        for( long b = 0; b < numberOfLines; b++ )
+          {
+          tile[b * LineLength + pos] = static_cast<RealType>( in[b] );
+          }
+        }
+
+      for( long b = 0; b < numberOfLines; b++ )
+        {
+        LineBuf.SetData( &tile[b * LineLength], LineLength, false );
+        DoSignedLine<LineBufferType, RealType>(LineBuf, tmpLineBuf,
+          positiveBuf, negativeBuf, magnitude);
+        progress.CompletedPixel();
+        }
+
+      for( long pos = 0; pos < LineLength; pos++ )
+        {
+        PixelType * out = row + x0 + pos * LineStride;
+        for( long b = 0; b < numberOfLines; b++ )
+          {
+          out[b] = static_cast<PixelType>( tile[b * LineLength + pos] );
+          }
+        }
+      }
+    rowIterator.NextLine();
+    }
+}
+
+/** Whether the buffer of an image has at most two distinct values. The
+ * lines of a binary image have their contact points far away for large
+ * scales, which is when the lower envelope pays off. */
+template <class TImage>
+bool IsBinaryImage(const TImage *image)
+{
+  typedef typename TImage::PixelType PixelType;
+  ImageRegionConstIterator<TImage> it( image, image->GetBufferedRegion() );
+  it.GoToBegin();
+  if( it.IsAtEnd() )
+    {
+    return true;
+    }
+  const PixelType first = it.Get();
+  PixelType second = first;
+  bool haveSecond = false;
+  for( ; !it.IsAtEnd(); ++it )
+    {
+    const PixelType value = it.Get();
+    if( value == first || ( haveSecond && value == second ) )
+      {
+      continue;
+      }
+    if( haveSecond )
+      {
+      return false;
+      }
+    second = value;
+    haveSecond = true;
+    }
+  return true;
+}
+
 }
 #endif
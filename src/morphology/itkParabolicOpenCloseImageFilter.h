@@ -1,7 +1,7 @@
 #ifndef __itkParabolicOpenCloseImageFilter_h
 #define __itkParabolicOpenCloseImageFilter_h
 
-#include "itkImageToImageFilter.h"
+#include "itkInPlaceImageFilter.h"
 #include "itkNumericTraits.h"
 #include "itkProgressReporter.h"
 
@@ -18,6 +18,10 @@ namespace itk
  * This filter is threaded. Threading mechanism derived from
  * SignedMaurerDistanceMap extensions by Gaetan Lehman
  *
+ * Every line is read into a buffer before it is written, so the filter
+ * can run in place on its input, with InPlaceOn(), when the input and
+ * output types are the same. It is off by default.
+ *
  * \sa itkParabolicErodeDilateImageFilter
  *
  * \author Richard Beare, Department of Medicine, Monash University,
@@ -28,13 +32,13 @@ template <typename TInputImage,
     bool doOpen,
           typename TOutputImage= TInputImage >
 class ITK_EXPORT ParabolicOpenCloseImageFilter:
-    public ImageToImageFilter<TInputImage,TOutputImage>
+    public InPlaceImageFilter<TInputImage,TOutputImage>
 {
 
 public:
   /** Standard class typedefs. */
   typedef ParabolicOpenCloseImageFilter  Self;
-  typedef ImageToImageFilter<TInputImage,TOutputImage> Superclass;
+  typedef InPlaceImageFilter<TInputImage,TOutputImage> Superclass;
   typedef SmartPointer<Self>                   Pointer;
   typedef SmartPointer<const Self>        ConstPointer;
 
@@ -42,7 +46,7 @@ public:
   itkNewMacro(Self);
 
   /** Runtime information support. */
-  itkTypeMacro(ParabolicOpenCloseImageFilter, ImageToImageFilter);
+  itkTypeMacro(ParabolicOpenCloseImageFilter, InPlaceImageFilter);
 
 
   /** Pixel Type of the input image */
@@ -92,6 +96,17 @@ public:
   itkGetConstReferenceMacro(UseImageSpacing, bool);
   itkBooleanMacro(UseImageSpacing);
 
+  /**
+   * Set/Get whether the lines are computed as the lower envelope of the
+   * parabolas, as in a distance transform, instead of with the contact
+   * point search. The result is the same, and the cost does not depend on
+   * the scale, which pays off for binary images and large scales -
+   * default is false
+   */
+  itkSetMacro(UseLowerEnvelope, bool);
+  itkGetConstReferenceMacro(UseLowerEnvelope, bool);
+  itkBooleanMacro(UseLowerEnvelope);
+
 #ifdef ITK_USE_CONCEPT_CHECKING
   /** Begin concept checking */
   itkConceptMacro(SameDimension,
@@ -128,6 +143,7 @@ private:
   int m_CurrentDimension;
   int m_Stage;
   bool m_UseImageSpacing;
+  bool m_UseLowerEnvelope;
 };
 
 } // end namespace itk
@@ -25,6 +25,8 @@ ParabolicOpenCloseImageFilter<TInputImage, doOpen, TOutputImage>
 {
   this->SetNumberOfRequiredOutputs( 1 );
   this->SetNumberOfRequiredInputs( 1 );
+  // running in place changes the input, so it has to be asked for
+  this->InPlaceOff();
 
   // needs to be selected according to erosion/dilation
   if(doOpen)
@@ -46,6 +48,7 @@ ParabolicOpenCloseImageFilter<TInputImage, doOpen, TOutputImage>
   this->m_Extreme = this->m_Extreme1;
   this->m_MagnitudeSign = this->m_MagnitudeSign1;
   this->m_UseImageSpacing = false;
+  this->m_UseLowerEnvelope = false;
   this->m_Stage=1;  // indicate whether we are on the first pass or the second
 }
 
@@ -174,8 +177,8 @@ ParabolicOpenCloseImageFilter<TInputImage, doOpen, TOutputImage >
 
   //const unsigned int imageDimension = inputImage->GetImageDimension();
 
-  outputImage->SetBufferedRegion( outputImage->GetRequestedRegion() );
-  outputImage->Allocate();
+  // the output may reuse the buffer of the input, see InPlaceOn()
+  this->AllocateOutputs();
 
   // Set up the multithreaded processing
   typename ImageSource< TOutputImage >::ThreadStruct str;
@@ -250,8 +253,6 @@ ParabolicOpenCloseImageFilter<TInputImage, doOpen, TOutputImage >
 
   //const unsigned int imageDimension = inputImage->GetImageDimension();
 
-  outputImage->SetBufferedRegion( outputImage->GetRequestedRegion() );
-  outputImage->Allocate();
   RegionType region = outputRegionForThread;
 
 
@@ -279,7 +280,8 @@ ParabolicOpenCloseImageFilter<TInputImage, doOpen, TOutputImage >
                 this->m_UseImageSpacing,
                 this->m_Extreme,
                 image_scale,
-                this->m_Scale[0]);
+                this->m_Scale[0],
+                this->m_UseLowerEnvelope);
   }
       else
   {
@@ -301,17 +303,18 @@ ParabolicOpenCloseImageFilter<TInputImage, doOpen, TOutputImage >
     else
       {
       // now deal with the other dimensions for first stage
-      unsigned long LineLength = region.GetSize()[m_CurrentDimension];
+      // the lines are strided in memory, process them in blocks
       RealType image_scale = this->GetInput()->GetSpacing()[m_CurrentDimension];
 
-      doOneDimension<OutputConstIteratorType,OutputIteratorType,
-  RealType, OutputPixelType, !doOpen>(inputIteratorStage2, outputIterator,
-              *progress, LineLength, this->m_CurrentDimension,
+      doOneDimensionBlocked<TOutputImage,
+  RealType, OutputPixelType, !doOpen>(outputImage.GetPointer(), region,
+              *progress, this->m_CurrentDimension,
               this->m_MagnitudeSign,
               this->m_UseImageSpacing,
               this->m_Extreme,
               image_scale,
-              this->m_Scale[m_CurrentDimension]);
+              this->m_Scale[m_CurrentDimension],
+              this->m_UseLowerEnvelope);
 
       }
     }
@@ -324,14 +327,31 @@ ParabolicOpenCloseImageFilter<TInputImage, doOpen, TOutputImage >
       unsigned long LineLength = region.GetSize()[m_CurrentDimension];
       RealType image_scale = this->GetInput()->GetSpacing()[m_CurrentDimension];
 
-      doOneDimension<OutputConstIteratorType,OutputIteratorType,
-  RealType, OutputPixelType, doOpen>(inputIteratorStage2, outputIterator,
-             *progress, LineLength, this->m_CurrentDimension,
-             this->m_MagnitudeSign,
-             this->m_UseImageSpacing,
-             this->m_Extreme,
-             image_scale,
-             this->m_Scale[m_CurrentDimension]);
+      if( this->m_CurrentDimension == 0 )
+        {
+        doOneDimension<OutputConstIteratorType,OutputIteratorType,
+    RealType, OutputPixelType, doOpen>(inputIteratorStage2, outputIterator,
+               *progress, LineLength, this->m_CurrentDimension,
+               this->m_MagnitudeSign,
+               this->m_UseImageSpacing,
+               this->m_Extreme,
+               image_scale,
+               this->m_Scale[m_CurrentDimension],
+              this->m_UseLowerEnvelope);
+        }
+      else
+        {
+        // the lines are strided in memory, process them in blocks
+        doOneDimensionBlocked<TOutputImage,
+    RealType, OutputPixelType, doOpen>(outputImage.GetPointer(), region,
+               *progress, this->m_CurrentDimension,
+               this->m_MagnitudeSign,
+               this->m_UseImageSpacing,
+               this->m_Extreme,
+               image_scale,
+               this->m_Scale[m_CurrentDimension],
+              this->m_UseLowerEnvelope);
+        }
       }
     }
 }
@@ -351,6 +371,7 @@ ParabolicOpenCloseImageFilter<TInputImage, doOpen, TOutputImage>
     {
     os << "Scale in voxels: " << this->m_Scale << std::endl;
     }
+  os << "UseLowerEnvelope: " << this->m_UseLowerEnvelope << std::endl;
 }
 
 
@@ -96,6 +96,20 @@ public:
   }
   itkBooleanMacro(UseImageSpacing);
 
+  void SetUseLowerEnvelope(bool B)
+  {
+    if( B != this->GetUseLowerEnvelope() )
+      {
+      this->m_MorphFilt->SetUseLowerEnvelope(B);
+      this->Modified();
+      }
+  }
+  bool GetUseLowerEnvelope() const
+  {
+    return(this->m_MorphFilt->GetUseLowerEnvelope());
+  }
+  itkBooleanMacro(UseLowerEnvelope);
+
 
   itkSetMacro(SafeBorder, bool);
   itkGetConstReferenceMacro(SafeBorder, bool);
@@ -56,6 +56,10 @@ ParabolicOpenCloseSafeBorderImageFilter<TInputImage, doOpen, TOutputImage>
     inputImage = this->GetInput();
     }
 
+  // The padded image is internal, so the morphology can work in its
+  // buffer instead of allocating a second padded image. The input of
+  // this filter itself must not be changed.
+  this->m_MorphFilt->SetInPlace( this->m_SafeBorder );
   this->m_MorphFilt->SetInput(inputImage);
   progress->RegisterInternalFilter( this->m_MorphFilt, 0.8f);
 
@@ -69,6 +73,8 @@ ParabolicOpenCloseSafeBorderImageFilter<TInputImage, doOpen, TOutputImage>
     this->m_CropFilt->GraftOutput( this->GetOutput() );
     this->m_CropFilt->Update();
     this->GraftOutput( this->m_CropFilt->GetOutput() );
+    // the padded result is not needed after cropping
+    this->m_MorphFilt->GetOutput()->ReleaseData();
     }
   else
     {
@@ -7,6 +7,7 @@
 #include "opening.h"
 #include "closing.h"
 #include "gradient.h"
+#include "sequence.h"
 
 
 /** run: A macro to call a function. */
@@ -41,7 +42,26 @@ if( operation == #function ) \
   if( componentType == #ctype && Dimension == dim ) \
   { \
     typedef itk::Image< ctype, dim > ImageType; \
-    function< ImageType >( inputFileName, outputFileName, radius, algorithm, useCompression ); \
+    if( type == "parabolic" ) \
+    { \
+      function##Parabolic< ImageType >( inputFileName, outputFileName, radius, useCompression ); \
+    } \
+    else \
+    { \
+      function< ImageType >( inputFileName, outputFileName, radius, algorithm, useCompression ); \
+    } \
+    supported = true; \
+  } \
+}
+
+/** run3: A macro to call a function on a label image. */
+#define run3( function, ctype, dim ) \
+if( operation == #function && type == "label" ) \
+{ \
+  if( componentType == #ctype && Dimension == dim ) \
+  { \
+    typedef itk::Image< ctype, dim > ImageType; \
+    function##Label< ImageType >( inputFileName, outputFileName, radius, bin, useCompression ); \
     supported = true; \
   } \
 }
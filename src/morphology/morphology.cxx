@@ -41,8 +41,9 @@ std::string GetHelpString( void )
     << "Usage:\n"
     << "pxmorphology\n"
     << "  -in      inputFilename\n"
-    << "  -op      operation, choose one of {erosion, dilation, opening, closing, gradient}\n"
-    << "  [-type]  type, choose one of {grayscale, binary, parabolic}, default grayscale\n"
+    << "  -op      operation, choose one of {erosion, dilation, opening, closing,\n"
+    << "           openclose, closeopen, gradient}\n"
+    << "  [-type]  type, choose one of {grayscale, binary, parabolic, label}, default grayscale\n"
     << "  [-out]   outputFilename, default in_operation_type.extension\n"
     << "  [-z]     compression flag; if provided, the output image is compressed\n"
     << "  -r       radius\n"
@@ -52,6 +53,16 @@ std::string GetHelpString( void )
     << "           BASIC = 0, HISTO = 1, ANCHOR = 2, VHGW = 3, default 0\n"
     << "           BASIC and HISTO have radius dependent performance, ANCHOR and VHGW not\n"
     << "  [-opct]  pixelType, default: automatically determined from input image\n"
+    << "The operations openclose and closeopen perform an opening followed by a closing,\n"
+    << "  and a closing followed by an opening, in a single pipeline.\n"
+    << "  With type parabolic the filters work in place in the buffer of the input.\n"
+    << "  For binary inputs the parabolic filters compute every line as a distance\n"
+    << "  transform, with the same result, in a time independent of the radius.\n"
+    << "For op=dilation, type label dilates all labels of a label image at once, with a\n"
+    << "  ball of the radius; a voxel reached by several labels gets the nearest one,\n"
+    << "  and of equally near ones the smallest; the background is the second -bin value.\n"
+    << "For op=gradient, type parabolic uses parabolic erosion and dilation, other types\n"
+    << "  use the flat box structuring element and the algorithm given by -a.\n"
     << "For grayscale filters, supply the boundary condition.\n"
     << "  This value defaults to the maximum pixel value.\n"
     << "For binary filters, supply the foreground and background value.\n"
@@ -64,6 +75,8 @@ std::string GetHelpString( void )
     << "    pxmorphology -in input.mhd -op dilation -type binary -out output.mhd -r 1\n"
     << "  2) Dilate a binary image (255 = foreground, 0 = background)\n"
     << "    pxmorphology -in input.mhd -op dilation -type binary -out output.mhd -r 1 -bin 255 0\n"
+    << "  3) Dilate all labels of a parcellation by 2 voxels, without collisions\n"
+    << "    pxmorphology -in labels.mhd -op dilation -type label -out output.mhd -r 2\n"
     << "Supported: 2D, 3D, (unsigned) char, (unsigned) short.";
 
   return ss.str();
@@ -122,6 +135,9 @@ int main( int argc, char *argv[] )
     return EXIT_SUCCESS;
   }
 
+  /** Threading. */
+  itktools::ReadThreadingArguments( parser );
+
   /** Get arguments. */
   std::string inputFileName = "";
   parser->GetCommandLineArgument( "-in", inputFileName );
@@ -161,14 +177,21 @@ int main( int argc, char *argv[] )
     && operation != "dilation"
     && operation != "opening"
     && operation != "closing"
+    && operation != "openclose"
+    && operation != "closeopen"
     && operation != "gradient" )
   {
-    std::cerr << "ERROR: \"-op\" should be one of {erosion, dilation, opening, closing, gradient}." << std::endl;
+    std::cerr << "ERROR: \"-op\" should be one of {erosion, dilation, opening, closing, openclose, closeopen, gradient}." << std::endl;
+    return EXIT_FAILURE;
+  }
+  if( type != "grayscale" && type != "binary" && type != "parabolic" && type != "label" )
+  {
+    std::cerr << "ERROR: \"-type\" should be one of {grayscale, binary, parabolic, label}." << std::endl;
     return EXIT_FAILURE;
   }
-  if( type != "grayscale" && type != "binary" && type != "parabolic" )
+  if( type == "label" && operation != "dilation" )
   {
-    std::cerr << "ERROR: \"-type\" should be one of {grayscale, binary, parabolic}." << std::endl;
+    std::cerr << "ERROR: \"-type label\" is only supported for \"-op dilation\"." << std::endl;
     return EXIT_FAILURE;
   }
   if( retbin && bin.size() != 2 )
@@ -26,6 +26,10 @@ bool Morphology2D(
   run( dilation, char, 2 );
   run( dilation, unsigned short, 2 );
   run( dilation, short, 2 );
+  run3( dilation, unsigned char, 2 );
+  run3( dilation, char, 2 );
+  run3( dilation, unsigned short, 2 );
+  run3( dilation, short, 2 );
 
   /** Opening. */
   run( opening, unsigned char, 2 );
@@ -39,6 +43,18 @@ bool Morphology2D(
   run( closing, unsigned short, 2 );
   run( closing, short, 2 );
 
+  /** Opening followed by closing. */
+  run( openclose, unsigned char, 2 );
+  run( openclose, char, 2 );
+  run( openclose, unsigned short, 2 );
+  run( openclose, short, 2 );
+
+  /** Closing followed by opening. */
+  run( closeopen, unsigned char, 2 );
+  run( closeopen, char, 2 );
+  run( closeopen, unsigned short, 2 );
+  run( closeopen, short, 2 );
+
   /** Gradient. */
   run2( gradient, unsigned char, 2 );
   run2( gradient, char, 2 );
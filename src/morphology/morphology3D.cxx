@@ -26,6 +26,10 @@ bool Morphology3D(
   run( dilation, char, 3 );
   run( dilation, unsigned short, 3 );
   run( dilation, short, 3 );
+  run3( dilation, unsigned char, 3 );
+  run3( dilation, char, 3 );
+  run3( dilation, unsigned short, 3 );
+  run3( dilation, short, 3 );
 
   /** Opening. */
   run( opening, unsigned char, 3 );
@@ -39,6 +43,18 @@ bool Morphology3D(
   run( closing, unsigned short, 3 );
   run( closing, short, 3 );
 
+  /** Opening followed by closing. */
+  run( openclose, unsigned char, 3 );
+  run( openclose, char, 3 );
+  run( openclose, unsigned short, 3 );
+  run( openclose, short, 3 );
+
+  /** Closing followed by opening. */
+  run( closeopen, unsigned char, 3 );
+  run( closeopen, char, 3 );
+  run( closeopen, unsigned short, 3 );
+  run( closeopen, short, 3 );
+
   /** Gradient. */
   run2( gradient, unsigned char, 3 );
   run2( gradient, char, 3 );
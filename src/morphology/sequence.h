@@ -0,0 +1,320 @@
+
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+
+#include "itkBinaryBallStructuringElement.h"
+#include "itkGrayscaleMorphologicalOpeningImageFilter.h"
+#include "itkGrayscaleMorphologicalClosingImageFilter.h"
+#include "itkBinaryMorphologicalOpeningImageFilter.h"
+#include "itkBinaryMorphologicalClosingImageFilter.h"
+#include "itkParabolicOpenImageFilter.h"
+#include "itkParabolicCloseImageFilter.h"
+
+/** The sequences openclose (an opening followed by a closing) and
+ * closeopen (a closing followed by an opening) are computed in a single
+ * pipeline. The data of the reader and of the first filter is released
+ * as soon as it has been used. The parabolic filters run in place, so
+ * that the whole sequence works in the buffer of the reader.
+ */
+
+/**
+ * ******************* sequenceWrite *******************
+ */
+
+template< class ImageType, class OpeningFilterType, class ClosingFilterType >
+void sequenceWrite(
+  const std::string & inputFileName,
+  const std::string & outputFileName,
+  OpeningFilterType * opening,
+  ClosingFilterType * closing,
+  const bool openFirst,
+  const bool useCompression )
+{
+  /** Typedefs. */
+  typedef itk::ImageFileReader< ImageType >           ReaderType;
+  typedef itk::ImageFileWriter< ImageType >           WriterType;
+
+  /** Declarations. */
+  typename ReaderType::Pointer reader = ReaderType::New();
+  typename WriterType::Pointer writer = WriterType::New();
+
+  /** Setup the reader. */
+  reader->SetFileName( inputFileName.c_str() );
+  reader->ReleaseDataFlagOn();
+
+  /** Connect the filters in the requested order. */
+  if( openFirst )
+  {
+    opening->SetInput( reader->GetOutput() );
+    opening->ReleaseDataFlagOn();
+    closing->SetInput( opening->GetOutput() );
+    writer->SetInput( closing->GetOutput() );
+  }
+  else
+  {
+    closing->SetInput( reader->GetOutput() );
+    closing->ReleaseDataFlagOn();
+    opening->SetInput( closing->GetOutput() );
+    writer->SetInput( opening->GetOutput() );
+  }
+
+  /** Write the output image. */
+  writer->SetFileName( outputFileName.c_str() );
+  writer->SetUseCompression( useCompression );
+  writer->Update();
+
+} // end sequenceWrite()
+
+
+/**
+ * ******************* sequenceGrayscale *******************
+ */
+
+template< class ImageType >
+void sequenceGrayscale(
+  const std::string & inputFileName,
+  const std::string & outputFileName,
+  const std::vector<unsigned int> & radius,
+  const bool openFirst,
+  const bool useCompression )
+{
+  /** Typedefs. */
+  typedef typename ImageType::PixelType               PixelType;
+  const unsigned int Dimension = ImageType::ImageDimension;
+  typedef itk::BinaryBallStructuringElement<
+    PixelType, Dimension >                            StructuringElementType;
+  typedef typename StructuringElementType::RadiusType RadiusType;
+  typedef itk::GrayscaleMorphologicalOpeningImageFilter<
+    ImageType, ImageType, StructuringElementType >    OpeningFilterType;
+  typedef itk::GrayscaleMorphologicalClosingImageFilter<
+    ImageType, ImageType, StructuringElementType >    ClosingFilterType;
+
+  /** Declarations. */
+  typename OpeningFilterType::Pointer opening = OpeningFilterType::New();
+  typename ClosingFilterType::Pointer closing = ClosingFilterType::New();
+
+  /** Create the structuring element. */
+  RadiusType  radiusarray;
+  for( unsigned int i = 0; i < Dimension; i++ )
+  {
+    radiusarray.SetElement( i, radius[ i ] );
+  }
+  StructuringElementType  S_ball;
+  S_ball.SetRadius( radiusarray );
+  S_ball.CreateStructuringElement();
+
+  /** Setup the filters. */
+  opening->SetKernel( S_ball );
+  closing->SetKernel( S_ball );
+
+  /** Run the sequence. */
+  sequenceWrite< ImageType >( inputFileName, outputFileName,
+    opening.GetPointer(), closing.GetPointer(), openFirst, useCompression );
+
+} // end sequenceGrayscale()
+
+
+/**
+ * ******************* sequenceBinary *******************
+ */
+
+template< class ImageType >
+void sequenceBinary(
+  const std::string & inputFileName,
+  const std::string & outputFileName,
+  const std::vector<unsigned int> & radius,
+  const std::vector<std::string> & bin,
+  const bool openFirst,
+  const bool useCompression )
+{
+  /** Typedefs. */
+  typedef typename ImageType::PixelType               PixelType;
+  const unsigned int Dimension = ImageType::ImageDimension;
+  typedef itk::BinaryBallStructuringElement<
+    PixelType, Dimension >                            StructuringElementType;
+  typedef typename StructuringElementType::RadiusType RadiusType;
+  typedef itk::BinaryMorphologicalOpeningImageFilter<
+    ImageType, ImageType, StructuringElementType >    OpeningFilterType;
+  typedef itk::BinaryMorphologicalClosingImageFilter<
+    ImageType, ImageType, StructuringElementType >    ClosingFilterType;
+
+  /** Declarations. */
+  typename OpeningFilterType::Pointer opening = OpeningFilterType::New();
+  typename ClosingFilterType::Pointer closing = ClosingFilterType::New();
+
+  /** Get foreground and background values. */
+  std::vector<PixelType> values( 2 );
+  values[ 0 ] = itk::NumericTraits<PixelType>::One;
+  values[ 1 ] = itk::NumericTraits<PixelType>::Zero;
+  if( bin.size() == 2 )
+  {
+    for( unsigned int i = 0; i < 2; ++i )
+    {
+      if( itk::NumericTraits<PixelType>::is_integer )
+      {
+        values[ i ] = static_cast<PixelType>( atoi( bin[ i ].c_str() ) );
+      }
+      else
+      {
+        values[ i ] = static_cast<PixelType>( atof( bin[ i ].c_str() ) );
+      }
+    }
+  }
+
+  /** Create the structuring element. */
+  RadiusType  radiusarray;
+  for( unsigned int i = 0; i < Dimension; i++ )
+  {
+    radiusarray.SetElement( i, radius[ i ] );
+  }
+  StructuringElementType  S_ball;
+  S_ball.SetRadius( radiusarray );
+  S_ball.CreateStructuringElement();
+
+  /** Setup the filters. */
+  opening->SetForegroundValue( values[ 0 ] );
+  opening->SetBackgroundValue( values[ 1 ] );
+  opening->SetKernel( S_ball );
+  closing->SetForegroundValue( values[ 0 ] );
+  closing->SetKernel( S_ball );
+
+  /** Run the sequence. */
+  sequenceWrite< ImageType >( inputFileName, outputFileName,
+    opening.GetPointer(), closing.GetPointer(), openFirst, useCompression );
+
+} // end sequenceBinary()
+
+
+/**
+ * ******************* sequenceParabolic *******************
+ */
+
+template< class ImageType >
+void sequenceParabolic(
+  const std::string & inputFileName,
+  const std::string & outputFileName,
+  const std::vector<unsigned int> & radius,
+  const bool openFirst,
+  const bool useCompression )
+{
+  /** Typedefs. */
+  const unsigned int Dimension = ImageType::ImageDimension;
+  typedef itk::ParabolicOpenImageFilter<
+    ImageType, ImageType >                            OpeningFilterType;
+  typedef itk::ParabolicCloseImageFilter<
+    ImageType, ImageType >                            ClosingFilterType;
+  typedef typename OpeningFilterType::RadiusType      RadiusType;
+  typedef typename OpeningFilterType::ScalarRealType  ScalarRealType;
+
+  /** Declarations. */
+  typename OpeningFilterType::Pointer opening = OpeningFilterType::New();
+  typename ClosingFilterType::Pointer closing = ClosingFilterType::New();
+
+  /** Get the correct radius. */
+  RadiusType      radiusArray;
+  ScalarRealType  radius1D = 0.0;
+  for( unsigned int i = 0; i < Dimension; ++i )
+  {
+    // Very specific computation for the parabolic filter:
+    radius1D = static_cast<ScalarRealType>( radius[ i ] ) ;//+ 1.0;
+    radius1D = radius1D * radius1D / 2.0 + 1.0;
+    radiusArray.SetElement( i, radius1D );
+  }
+
+  /** Setup the filters, both work in the buffer of the reader. */
+  opening->SetUseImageSpacing( false );
+  opening->SetScale( radiusArray );
+  opening->InPlaceOn();
+  closing->SetUseImageSpacing( false );
+  closing->SetScale( radiusArray );
+  closing->InPlaceOn();
+
+  /** Run the sequence. */
+  sequenceWrite< ImageType >( inputFileName, outputFileName,
+    opening.GetPointer(), closing.GetPointer(), openFirst, useCompression );
+
+} // end sequenceParabolic()
+
+
+/**
+ * ******************* openclose *******************
+ */
+
+template< class ImageType >
+void opencloseGrayscale(
+  const std::string & inputFileName,
+  const std::string & outputFileName,
+  const std::vector<unsigned int> & radius,
+  const std::string & boundaryCondition,
+  const bool useCompression )
+{
+  sequenceGrayscale< ImageType >( inputFileName, outputFileName,
+    radius, true, useCompression );
+} // end opencloseGrayscale()
+
+
+template< class ImageType >
+void opencloseBinary(
+  const std::string & inputFileName,
+  const std::string & outputFileName,
+  const std::vector<unsigned int> & radius,
+  const std::vector<std::string> & bin,
+  const bool useCompression )
+{
+  sequenceBinary< ImageType >( inputFileName, outputFileName,
+    radius, bin, true, useCompression );
+} // end opencloseBinary()
+
+
+template< class ImageType >
+void opencloseParabolic(
+  const std::string & inputFileName,
+  const std::string & outputFileName,
+  const std::vector<unsigned int> & radius,
+  const bool useCompression )
+{
+  sequenceParabolic< ImageType >( inputFileName, outputFileName,
+    radius, true, useCompression );
+} // end opencloseParabolic()
+
+
+/**
+ * ******************* closeopen *******************
+ */
+
+template< class ImageType >
+void closeopenGrayscale(
+  const std::string & inputFileName,
+  const std::string & outputFileName,
+  const std::vector<unsigned int> & radius,
+  const std::string & boundaryCondition,
+  const bool useCompression )
+{
+  sequenceGrayscale< ImageType >( inputFileName, outputFileName,
+    radius, false, useCompression );
+} // end closeopenGrayscale()
+
+
+template< class ImageType >
+void closeopenBinary(
+  const std::string & inputFileName,
+  const std::string & outputFileName,
+  const std::vector<unsigned int> & radius,
+  const std::vector<std::string> & bin,
+  const bool useCompression )
+{
+  sequenceBinary< ImageType >( inputFileName, outputFileName,
+    radius, bin, false, useCompression );
+} // end closeopenBinary()
+
+
+template< class ImageType >
+void closeopenParabolic(
+  const std::string & inputFileName,
+  const std::string & outputFileName,
+  const std::vector<unsigned int> & radius,
+  const bool useCompression )
+{
+  sequenceParabolic< ImageType >( inputFileName, outputFileName,
+    radius, false, useCompression );
+} // end closeopenParabolic()
@@ -0,0 +1,246 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+/** \file
+ \brief The multi-call binary containing all tools.
+
+ Built with ITKTOOLS_BUILD_MULTICALL. The tool is selected by the name
+ the binary is called with, e.g. through a link pxcastconvert -> pxtools,
+ or by the first argument, e.g. "pxtools castconvert -in ...".
+ The pseudo tool pipeline, or a link pxpipeline, runs several tools
+ in this process, passing images in memory.
+ */
+
+#include "ITKToolsBatch.h"
+#include "ITKToolsHelpers.h"
+#include "ITKToolsMultiCallTools.h"
+#include "itkMemoryImageIO.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+/**
+ * ******************* GetHelpString *******************
+ */
+
+std::string GetHelpString( void )
+{
+  std::stringstream ss;
+  ss << "ITKTools v" << itktools::GetITKToolsVersion() << "\n"
+    << "This program contains all ITKTools in a single binary.\n"
+    << "Usage:\n"
+    << "pxtools tool [arguments]\n"
+    << "  or call it through a link named after the tool, e.g. pxcastconvert.\n"
+    << "  The tool can be given with or without the px prefix.\n"
+    << "pxtools pipeline [-keep] tool [arguments] -- tool [arguments] -- ...\n"
+    << "  runs the tools one after the other in this process. An image named\n"
+    << "  mem:name, e.g. \"-out mem:smooth\" and \"-in mem:smooth\" of the next\n"
+    << "  tool, is kept in memory instead of on disk, and released after the\n"
+    << "  last tool that names it, unless -keep is given. The pipeline stops\n"
+    << "  at the first tool that fails.\n"
+    << "Available tools:\n";
+  for( unsigned int i = 0; ITKToolsMultiCallTools[ i ].m_Name != 0; ++i )
+  {
+    ss << "  " << ITKToolsMultiCallTools[ i ].m_Name << "\n";
+  }
+
+  return ss.str();
+
+} // end GetHelpString()
+
+
+/**
+ * ******************* FindTool *******************
+ *
+ * Find a tool by name, with or without "px", and with or without
+ * a directory and the extension of the executable.
+ */
+
+const ITKToolsMultiCallToolType * FindTool( const std::string & path )
+{
+  std::string name = path;
+  const std::string::size_type slash = name.find_last_of( "/\\" );
+  if( slash != std::string::npos ) name = name.substr( slash + 1 );
+  if( name.size() > 4 && name.substr( name.size() - 4 ) == ".exe" )
+  {
+    name = name.substr( 0, name.size() - 4 );
+  }
+  if( name.substr( 0, 2 ) != "px" ) name = "px" + name;
+
+  for( unsigned int i = 0; ITKToolsMultiCallTools[ i ].m_Name != 0; ++i )
+  {
+    if( name == ITKToolsMultiCallTools[ i ].m_Name )
+    {
+      return &ITKToolsMultiCallTools[ i ];
+    }
+  }
+  return 0;
+
+} // end FindTool()
+
+
+/**
+ * ******************* RunPipeline *******************
+ *
+ * Run the stages, separated by "--", in order. The in-memory images are
+ * released after the last stage that names them.
+ */
+
+int RunPipeline( int argc, char ** argv )
+{
+  /** Split the arguments into the stages. */
+  bool keep = false;
+  std::vector< std::vector<std::string> > stages( 1 );
+  for( int i = 1; i < argc; ++i )
+  {
+    const std::string arg = argv[ i ];
+    if( arg == "-keep" && stages.size() == 1 && stages[ 0 ].empty() )
+    {
+      keep = true;
+    }
+    else if( arg == "--" )
+    {
+      stages.push_back( std::vector<std::string>() );
+    }
+    else
+    {
+      stages.back().push_back( arg );
+    }
+  }
+
+  /** Check the stages, and find the last stage that names an image. */
+  std::vector<const ITKToolsMultiCallToolType *> tools( stages.size(), 0 );
+  std::map<std::string, std::size_t> lastUse;
+  for( std::size_t s = 0; s < stages.size(); ++s )
+  {
+    if( stages[ s ].empty() )
+    {
+      std::cerr << "ERROR: Stage " << s + 1 << " of the pipeline is empty." << std::endl;
+      return EXIT_FAILURE;
+    }
+    tools[ s ] = FindTool( stages[ s ][ 0 ] );
+    if( !tools[ s ] )
+    {
+      std::cerr << "ERROR: Unknown tool \"" << stages[ s ][ 0 ]
+        << "\" in stage " << s + 1 << " of the pipeline." << std::endl;
+      return EXIT_FAILURE;
+    }
+    for( std::size_t a = 1; a < stages[ s ].size(); ++a )
+    {
+      if( itk::MemoryImageIO::IsMemoryFileName( stages[ s ][ a ] ) )
+      {
+        lastUse[ stages[ s ][ a ] ] = s;
+      }
+    }
+  }
+
+  /** The memory images are only found with the registered factory. */
+  itktools::RegisterImageIOFactories();
+
+  /** The -threads and -affinity of a stage only apply to that stage. */
+  const itktools::ThreadingState threadingState = itktools::GetThreadingState();
+  for( std::size_t s = 0; s < stages.size(); ++s )
+  {
+    /** The tool sees its name as program name, and its own arguments. */
+    std::vector<char *> stageArgv;
+    std::string name = tools[ s ]->m_Name;
+    stageArgv.push_back( &name[ 0 ] );
+    for( std::size_t a = 1; a < stages[ s ].size(); ++a )
+    {
+      stageArgv.push_back( &stages[ s ][ a ][ 0 ] );
+    }
+    stageArgv.push_back( 0 );
+
+    const int result = tools[ s ]->m_Main(
+      static_cast<int>( stageArgv.size() ) - 1, &stageArgv[ 0 ] );
+
+    /** A stage may overwrite a file that an earlier stage read, so the
+     * cached headers are not valid for the next stage. */
+    itktools::ClearImageIOBaseCache();
+    itktools::SetThreadingState( threadingState );
+    if( result != EXIT_SUCCESS )
+    {
+      std::cerr << "ERROR: Stage " << s + 1 << " of the pipeline, " << name
+        << ", failed." << std::endl;
+      itk::MemoryImageIO::RemoveAllImages();
+      return result;
+    }
+
+    /** Release the images that are not used anymore. */
+    if( keep ) continue;
+    for( std::map<std::string, std::size_t>::const_iterator it = lastUse.begin();
+      it != lastUse.end(); ++it )
+    {
+      if( it->second == s ) itk::MemoryImageIO::RemoveImage( it->first );
+    }
+  }
+
+  return EXIT_SUCCESS;
+
+} // end RunPipeline()
+
+
+//-------------------------------------------------------------------------------------
+
+int main( int argc, char ** argv )
+{
+  /** Dispatch on the name of the program, e.g. through a link pxcastconvert. */
+  std::string programName = argv[ 0 ];
+  const std::string::size_type slash = programName.find_last_of( "/\\" );
+  if( slash != std::string::npos ) programName = programName.substr( slash + 1 );
+  if( programName == "pxpipeline" || programName == "pxpipeline.exe" )
+  {
+    return RunPipeline( argc, argv );
+  }
+  const ITKToolsMultiCallToolType * tool = FindTool( argv[ 0 ] );
+  if( tool )
+  {
+    return itktools::RunToolMain( argc, argv, tool->m_Main );
+  }
+
+  /** Otherwise, the first argument is the tool. The tool then sees
+   * its name as program name, and the remaining arguments.
+   */
+  if( argc < 2 || std::string( argv[ 1 ] ) == "--help"
+    || std::string( argv[ 1 ] ) == "-help" )
+  {
+    std::cerr << GetHelpString() << std::endl;
+    return argc < 2 ? EXIT_FAILURE : EXIT_SUCCESS;
+  }
+
+  const std::string toolName = argv[ 1 ];
+  if( toolName == "pipeline" || toolName == "pxpipeline" )
+  {
+    return RunPipeline( argc - 1, argv + 1 );
+  }
+
+  tool = FindTool( argv[ 1 ] );
+  if( !tool )
+  {
+    std::cerr << "ERROR: Unknown tool \"" << argv[ 1 ] << "\".\n"
+      << "Call pxtools --help for a list of tools." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return itktools::RunToolMain( argc - 1, argv + 1, tool->m_Main );
+
+} // end main
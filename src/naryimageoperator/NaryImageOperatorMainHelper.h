@@ -29,7 +29,7 @@
  * ******************* DetermineImageProperties *******************
  */
 
-int DetermineImageProperties(
+static int DetermineImageProperties(
   const std::vector<std::string> & inputFileNames,
   itk::ImageIOBase::IOComponentType & componentTypeIn,
   itk::ImageIOBase::IOComponentType & componentTypeOut,
@@ -40,14 +40,15 @@ int DetermineImageProperties(
   unsigned int inputDimension1 = 2;
   unsigned int numberOfComponents1 = 1;
   std::vector<unsigned int> imagesize1( inputDimension1, 0 );
-  int retgip1 = itktools::GetImageProperties(
+  bool retgip1 = itktools::GetImageProperties(
     inputFileNames[ 0 ],
     inputPixelType1,
     componentTypeIn,
     inputDimension1,
     numberOfComponents1,
     imagesize1 );
-  if( retgip1 ) return retgip1;
+  if( !retgip1 ) return EXIT_FAILURE;
+  inputDimension = inputDimension1;
 
   /** Determine image properties of other images. */
   itk::ImageIOBase::IOPixelType inputPixelType_i;
@@ -57,14 +58,14 @@ int DetermineImageProperties(
   std::vector<unsigned int> imagesize_i;
   for( unsigned int i = 1; i < inputFileNames.size(); i++ )
   {
-    int retgip_i = itktools::GetImageProperties(
-      inputFileNames[ 1 ],
+    bool retgip_i = itktools::GetImageProperties(
+      inputFileNames[ i ],
       inputPixelType_i,
       componentTypeIn_i,
       inputDimension_i,
       numberOfComponents_i,
       imagesize_i );
-    if( retgip_i ) return retgip_i;
+    if( !retgip_i ) return EXIT_FAILURE;
 
     /** Check the input. */
     if( inputPixelType1 != inputPixelType_i )
@@ -84,10 +85,6 @@ int DetermineImageProperties(
       std::cerr << "ERROR: the input images are of different dimension." << std::endl;
       return EXIT_FAILURE;
     }
-    else
-    {
-      inputDimension = inputDimension1;
-    }
 
     if( imagesize1 != imagesize_i )
     {
@@ -97,17 +94,17 @@ int DetermineImageProperties(
 
     /** The output type is the largest of the input types. */
     componentTypeOut = itktools::GetLargestComponentType( componentTypeOut, componentTypeIn_i );
-  }
 
-  /** The input type is set to long or double, depending on the output type. */
-  bool outIsInteger = itktools::ComponentTypeIsInteger( componentTypeOut );
-  if( outIsInteger )
-  {
-    componentTypeIn = itk::ImageIOBase::LONG;
-  }
-  else
-  {
-    componentTypeIn = itk::ImageIOBase::DOUBLE;
+    /** The inputs are read as the largest of their types. A signed and an
+     * unsigned type of the same size need the next larger signed type. */
+    if( componentTypeIn != componentTypeIn_i
+      && itktools::RemoveUnsignedFromComponentType( componentTypeIn )
+      == itktools::RemoveUnsignedFromComponentType( componentTypeIn_i ) )
+    {
+      componentTypeIn = itktools::RemoveUnsignedFromComponentType( componentTypeIn )
+        == itk::ImageIOBase::CHAR ? itk::ImageIOBase::SHORT : itk::ImageIOBase::LONG;
+    }
+    componentTypeIn = itktools::GetLargestComponentType( componentTypeIn, componentTypeIn_i );
   }
 
   /** Return a value. */
@@ -120,7 +117,7 @@ int DetermineImageProperties(
  * ******************* CheckOperator *******************
  */
 
-int CheckOperator( std::string & operatoR )
+static int CheckOperator( std::string & operatoR )
 {
   if( operatoR == "ADDITION" || operatoR == "ADD" || operatoR == "PLUS" )
   {
@@ -222,7 +219,7 @@ int CheckOperator( std::string & operatoR )
    * ******************* OperatorNeedsArgument *******************
    */
 
-bool OperatorNeedsArgument( const std::string & operatoR )
+static bool OperatorNeedsArgument( const std::string & operatoR )
 {
   /** A map to store if OperatorNeedsArgument. */
   std::map< std::string, bool > operatorMap;
@@ -256,7 +253,7 @@ bool OperatorNeedsArgument( const std::string & operatoR )
  * ******************* CheckOperatorAndArgument *******************
  */
 
-bool CheckOperatorAndArgument(
+static bool CheckOperatorAndArgument(
   const std::string & operatoR,
   const std::string & argument,
   const bool & retarg )
@@ -29,6 +29,7 @@
 #include "naryimageoperator.h"
 
 #include "NaryImageOperatorMainHelper.h"
+#include "ITKToolsModules.h"
 
 
 /**
@@ -41,7 +42,7 @@ std::string GetHelpString( void )
   ss << "ITKTools v" << itktools::GetITKToolsVersion() << "\n"
     << "Performs n-ary operations on multiple (n) images.\n"
     << "Usage:\npxnaryimageoperator\n"
-    << "  -in      inputFilenames, at least 2\n"
+    << "  -in      inputFilenames, at least 2; use @file to read them from a manifest\n"
     << "  -out     outputFilename\n"
     << "  -ops     n-ary operator of the following form:\n"
     << "           {+,-,*,/,^,%}\n"
@@ -62,6 +63,10 @@ std::string GetHelpString( void )
     << "  [-s]     number of streams, default equals number of inputs.\n"
     << "  [-opct]  output component type, by default the largest of the two input images\n"
     << "             choose one of: {[unsigned_]{char,short,int,long},float,double}\n"
+    << "  [-internalType] the type in which other floating point combinations\n"
+    << "             are read and computed, choose one of {float, double}, default double\n"
+    << "The images are processed in slabs, one per stream. The inputs are read\n"
+    << "in their own component type if possible, and promoted per pixel.\n"
     << "Supported: 2D, 3D, (unsigned) char, (unsigned) short, (unsigned) int, (unsigned) long, float, double.";
 
   return ss.str();
@@ -98,6 +103,9 @@ int main( int argc, char **argv )
   std::vector<std::string> inputFileNames;
   parser->GetCommandLineArgument( "-in", inputFileNames );
 
+  /** Read the headers of all inputs before processing starts. */
+  if( !itktools::ValidateImageHeaders( inputFileNames ) ) return EXIT_FAILURE;
+
   std::string outputFileName = "";
   parser->GetCommandLineArgument( "-out", outputFileName );
 
@@ -116,6 +124,9 @@ int main( int argc, char **argv )
   unsigned int numberOfStreams = inputFileNames.size();
   parser->GetCommandLineArgument( "-s", numberOfStreams );
 
+  itk::ImageIOBase::IOComponentType internalComponentType = itk::ImageIOBase::DOUBLE;
+  if( !itktools::GetInternalComponentType( parser, internalComponentType ) ) return EXIT_FAILURE;
+
   /** You should specify at least two input files. */
   if( inputFileNames.size() < 2 )
   {
@@ -141,10 +152,6 @@ int main( int argc, char **argv )
       return EXIT_FAILURE;
     }
 
-    if( !itktools::ComponentTypeIsInteger( componentTypeOut ) )
-    {
-      componentTypeIn = itk::ImageIOBase::DOUBLE;
-    }
   }
 
   /** Check if a valid operator is given. */
@@ -161,7 +168,89 @@ int main( int argc, char **argv )
 
   try
   {
-    // now call all possible template combinations.
+    /** The inputs are read in their own component type, so that a stream
+     * holds a slab of each input in that type only. The functors promote
+     * the values within the kernel. */
+#ifdef ITKTOOLS_USE_MODULES
+    if( componentTypeIn == itk::ImageIOBase::UCHAR
+      || componentTypeIn == itk::ImageIOBase::CHAR
+      || componentTypeIn == itk::ImageIOBase::USHORT
+      || componentTypeIn == itk::ImageIOBase::SHORT
+      || componentTypeIn == itk::ImageIOBase::FLOAT )
+    {
+      filter = itktools::NewFromModule< ITKToolsNaryImageOperatorBase >(
+        "naryimageoperator", dim, componentTypeIn, componentTypeOut );
+    }
+#else
+    if( !filter ) filter = ITKToolsNaryImageOperator< 2, unsigned char, char >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 2, unsigned char, unsigned char >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 2, unsigned char, short >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 2, unsigned char, unsigned short >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 2, unsigned char, float >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 2, unsigned char, double >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 2, char, char >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 2, char, unsigned char >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 2, char, short >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 2, char, unsigned short >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 2, char, float >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 2, char, double >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 2, unsigned short, char >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 2, unsigned short, unsigned char >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 2, unsigned short, short >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 2, unsigned short, unsigned short >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 2, unsigned short, float >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 2, unsigned short, double >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 2, short, char >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 2, short, unsigned char >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 2, short, short >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 2, short, unsigned short >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 2, short, float >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 2, short, double >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 2, float, float >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 2, float, double >::New( dim, componentTypeIn, componentTypeOut );
+#ifdef ITKTOOLS_3D_SUPPORT
+    if( !filter ) filter = ITKToolsNaryImageOperator< 3, unsigned char, char >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 3, unsigned char, unsigned char >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 3, unsigned char, short >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 3, unsigned char, unsigned short >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 3, unsigned char, float >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 3, unsigned char, double >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 3, char, char >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 3, char, unsigned char >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 3, char, short >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 3, char, unsigned short >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 3, char, float >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 3, char, double >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 3, unsigned short, char >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 3, unsigned short, unsigned char >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 3, unsigned short, short >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 3, unsigned short, unsigned short >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 3, unsigned short, float >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 3, unsigned short, double >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 3, short, char >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 3, short, unsigned char >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 3, short, short >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 3, short, unsigned short >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 3, short, float >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 3, short, double >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 3, float, float >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 3, float, double >::New( dim, componentTypeIn, componentTypeOut );
+#endif
+#endif // ITKTOOLS_USE_MODULES
+
+    /** Other combinations read the inputs as long, or in the internal type. */
+    if( !filter )
+    {
+      componentTypeIn = itktools::ComponentTypeIsInteger( componentTypeOut )
+        ? itk::ImageIOBase::LONG : internalComponentType;
+    }
+#ifdef ITKTOOLS_USE_MODULES
+    if( !filter )
+    {
+      filter = itktools::NewFromModule< ITKToolsNaryImageOperatorBase >(
+        "naryimageoperator", dim, componentTypeIn, componentTypeOut );
+    }
+#else
     if( !filter ) filter = ITKToolsNaryImageOperator< 2, long, char >::New( dim, componentTypeIn, componentTypeOut );
     if( !filter ) filter = ITKToolsNaryImageOperator< 2, long, unsigned char >::New( dim, componentTypeIn, componentTypeOut );
     if( !filter ) filter = ITKToolsNaryImageOperator< 2, long, short >::New( dim, componentTypeIn, componentTypeOut );
@@ -172,6 +261,8 @@ int main( int argc, char **argv )
     if( !filter ) filter = ITKToolsNaryImageOperator< 2, long, unsigned long >::New( dim, componentTypeIn, componentTypeOut );
     if( !filter ) filter = ITKToolsNaryImageOperator< 2, double, float >::New( dim, componentTypeIn, componentTypeOut );
     if( !filter ) filter = ITKToolsNaryImageOperator< 2, double, double >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 2, float, float >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 2, float, double >::New( dim, componentTypeIn, componentTypeOut );
 
 #ifdef ITKTOOLS_3D_SUPPORT
     if( !filter ) filter = ITKToolsNaryImageOperator< 3, long, char >::New( dim, componentTypeIn, componentTypeOut );
@@ -184,7 +275,10 @@ int main( int argc, char **argv )
     if( !filter ) filter = ITKToolsNaryImageOperator< 3, long, unsigned long >::New( dim, componentTypeIn, componentTypeOut );
     if( !filter ) filter = ITKToolsNaryImageOperator< 3, double, float >::New( dim, componentTypeIn, componentTypeOut );
     if( !filter ) filter = ITKToolsNaryImageOperator< 3, double, double >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 3, float, float >::New( dim, componentTypeIn, componentTypeOut );
+    if( !filter ) filter = ITKToolsNaryImageOperator< 3, float, double >::New( dim, componentTypeIn, componentTypeOut );
 #endif
+#endif // ITKTOOLS_USE_MODULES
     /** Check if filter was instantiated. */
     bool supported = itktools::IsFilterSupportedCheck( filter, dim, componentTypeIn, componentTypeOut );
     if( !supported ) return EXIT_FAILURE;
@@ -197,6 +291,7 @@ int main( int argc, char **argv )
     filter->m_NumberOfStreams = numberOfStreams;
     filter->m_Arg = argument;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
@@ -25,6 +25,7 @@
 #include "itkImageFileWriter.h"
 
 #include "NaryFilterFactory.h"
+#include "ITKToolsImageProperties.h"
 
 #include <vector>
 #include <itksys/SystemTools.hxx>
@@ -45,7 +46,6 @@ public:
     this->m_OutputFileName = "";
     this->m_NaryOperatorName = "";
     this->m_UseCompression = false;
-    this->m_NumberOfStreams = 0;
     this->m_Arg = "";
   };
   /** Destructor. */
@@ -56,9 +56,11 @@ public:
   std::string       m_OutputFileName;
   std::string       m_NaryOperatorName;
   bool              m_UseCompression;
-  unsigned int      m_NumberOfStreams;
   std::string       m_Arg;
 
+  /** This tool supports streaming. */
+  virtual bool GetSupportsStreaming( void ) const { return true; }
+
 }; // end class ITKToolsNaryImageOperatorBase
 
 
@@ -94,6 +96,7 @@ public:
     {
       readers[ i ] = ReaderType::New();
       readers[ i ]->SetFileName( this->m_InputFileNames[ i ] );
+      itktools::SetCachedImageIOBase( readers[ i ].GetPointer() );
     }
 
     std::map <std::string, NaryFilterEnum> naryOperatorMap;
@@ -134,7 +137,18 @@ public:
     writer->SetFileName( this->m_OutputFileName.c_str() );
     writer->SetInput( naryFilter->GetOutput() );
     writer->SetUseCompression( this->m_UseCompression );
-    writer->SetNumberOfStreamDivisions( this->m_NumberOfStreams );
+    /** Every stream reads a slab of all inputs, so account for them in the
+     * memory limit.
+     */
+    this->SetStreamingOnWriter( writer.GetPointer(),
+      static_cast<double>( this->m_InputFileNames.size() * sizeof( TInputComponentType ) ) );
+
+    for( unsigned int i = 0; i < this->m_InputFileNames.size(); ++i )
+    {
+      this->ObserveProcess( readers[ i ].GetPointer(), "read" );
+    }
+    this->ObserveProcess( naryFilter.GetPointer(), "nary operator" );
+    this->ObserveProcess( writer.GetPointer(), "write" );
     writer->Update();
 
   } // end Run()
@@ -24,6 +24,9 @@
 #include "itkImageToImageFilter.h"
 #include "itkImageRegionIterator.h"
 #include "itkImageRegionConstIterator.h"
+#include "itkMultiThreader.h"
+
+#include <vector>
 
 
 namespace itk
@@ -43,6 +46,31 @@ namespace itk
  * to perform some matrix manipulations. This filter gives the same output
  * as the Matlab function princomp.
  *
+ * The mean and the covariance matrix are accumulated in a single
+ * multi-threaded pass over the inputs. Every thread processes blocks of
+ * pixels, computes the mean and the scatter matrix of a block around the
+ * block mean, and merges them into its partial result. The partial results
+ * of the threads are merged in a fixed order. The principal components are
+ * computed in a threaded pass over the output region, which reads the
+ * inputs, subtracts the mean on the fly and writes all outputs at once.
+ * So no copy of the inputs is made and the memory use does not depend on
+ * the image size.
+ *
+ * For many feature images, of which only a few principal components are
+ * needed, the full eigen decomposition of the covariance matrix can be
+ * replaced by a truncated one. A randomized subspace iteration then
+ * computes only the required eigen vectors, at a cost of O(D^2 k) instead
+ * of O(D^3) for D feature images and k components. The eigen values are
+ * then only those of the required components.
+ *
+ * The accumulated statistics, the number of pixels, the mean and the
+ * scatter matrix, can be taken from a previous run with SetPriorStatistics().
+ * The scatter of the inputs is then merged with them, so that the pixels of
+ * a new set of feature images are added to a model in one pass over the new
+ * images only, after which only the D by D eigen analysis is redone. With
+ * ComputePrincipalComponentImagesOff() the outputs are not computed, so
+ * that only the statistics and the eigen analysis are updated.
+ *
  * \ingroup ??
  */
 
@@ -98,6 +126,45 @@ public:
   virtual void SetNumberOfPrincipalComponentsRequired( unsigned int n );
   itkGetConstMacro( NumberOfPrincipalComponentsRequired, unsigned int );
 
+  /** Compute only the eigen vectors of the required principal components,
+   * with a randomized subspace iteration. Default false.
+   */
+  itkSetMacro( TruncatedEigenAnalysis, bool );
+  itkGetConstMacro( TruncatedEigenAnalysis, bool );
+  itkBooleanMacro( TruncatedEigenAnalysis );
+
+  /** Set/Get the number of power iterations of the truncated eigen
+   * analysis. More iterations give more accurate eigen vectors when the
+   * eigen values decay slowly. Default 4.
+   */
+  itkSetMacro( NumberOfPowerIterations, unsigned int );
+  itkGetConstMacro( NumberOfPowerIterations, unsigned int );
+
+  /** Set the statistics of previously seen pixels of the same feature
+   * images: their number, mean and scatter matrix, the sum of the outer
+   * products of the deviations from the mean. The scatter of the current
+   * inputs is merged with it.
+   */
+  virtual void SetPriorStatistics( SizeValueType numberOfSamples,
+    const VectorOfDoubleType & mean, const MatrixOfDoubleType & scatter );
+
+  /** Remove the prior statistics. */
+  virtual void ClearPriorStatistics( void );
+
+  /** Get the statistics of all pixels, including the prior ones, after an
+   * update, as needed for SetPriorStatistics() of a next update.
+   */
+  itkGetConstMacro( NumberOfSamples, SizeValueType );
+  itkGetConstReferenceMacro( MeanOfFeatureImages, VectorOfDoubleType );
+  itkGetConstReferenceMacro( ScatterMatrix, MatrixOfDoubleType );
+
+  /** Set/Get whether the principal component images are computed.
+   * Default true.
+   */
+  itkSetMacro( ComputePrincipalComponentImages, bool );
+  itkGetConstMacro( ComputePrincipalComponentImages, bool );
+  itkBooleanMacro( ComputePrincipalComponentImages );
+
   /** Get the eigen values. */
   itkGetConstReferenceMacro( EigenValues, VectorOfDoubleType );
 
@@ -145,24 +212,56 @@ private:
 
   /** Private functions to perform the PCA. */
   virtual void PerformPCA( void );
-  virtual void CalculateMeanOfFeatureImages( void );
-  virtual void CenterFeatureImages( void );
   virtual void CalculateCovarianceMatrix( void );
   virtual void PerformEigenAnalysis( void );
+  virtual void PerformTruncatedEigenAnalysis( unsigned int k );
+
+  /** Make the columns of a matrix orthonormal, with modified Gram-Schmidt. */
+  static void OrthonormalizeColumns( MatrixOfDoubleType & matrix );
+  virtual void ComputePrincipalComponents( void );
+
+  /** The count, mean and scatter matrix of a set of pixels. */
+  struct ScatterType
+  {
+    SizeValueType       m_Count;
+    VectorOfDoubleType  m_Mean;
+    MatrixOfDoubleType  m_Scatter;
+  };
+
+  /** Merge the scatter b of a disjoint set of pixels into a. */
+  static void MergeScatter( ScatterType & a, const ScatterType & b );
+
+  /** Accumulate the scatter of a chunk of the pixels. */
+  static ITK_THREAD_RETURN_TYPE CovarianceThreaderCallback( void * arg );
+  void ThreadedCalculateScatter( unsigned int threadId, unsigned int numberOfThreads );
+
+  /** Compute the principal components of a piece of the output region. */
+  static ITK_THREAD_RETURN_TYPE PrincipalComponentsThreaderCallback( void * arg );
+  void ThreadedComputePrincipalComponents( unsigned int threadId, unsigned int numberOfThreads );
+
+  /** The prior statistics, with a count of zero if there are none. */
+  ScatterType           m_PriorStatistics;
 
   /** Private variables to store results. */
   VectorOfDoubleType    m_MeanOfFeatureImages;
-  MatrixOfDoubleType    m_CenteredFeatureImages;
+  MatrixOfDoubleType    m_ScatterMatrix;
+  SizeValueType         m_NumberOfSamples;
 
   MatrixOfDoubleType    m_CovarianceMatrix;
   MatrixOfDoubleType    m_EigenVectors;
   VectorOfDoubleType    m_EigenValues;
   VectorOfDoubleType    m_NormalisedEigenValues;
-  MatrixOfDoubleType    m_PrincipalComponents;
+
+  /** The buffers of the inputs, and the partial scatters of the threads. */
+  std::vector< const InputImagePixelType * >  m_InputBuffers;
+  std::vector< ScatterType >                  m_ThreadScatters;
 
   unsigned int          m_NumberOfPixels;
   unsigned int          m_NumberOfFeatureImages;
   unsigned int          m_NumberOfPrincipalComponentsRequired;
+  bool                  m_TruncatedEigenAnalysis;
+  unsigned int          m_NumberOfPowerIterations;
+  bool                  m_ComputePrincipalComponentImages;
 
 }; // end class PCAImageToImageFilter
 
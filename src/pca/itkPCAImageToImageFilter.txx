@@ -22,7 +22,9 @@
 
 #include "vnl/vnl_math.h"
 #include <vnl/algo/vnl_symmetric_eigensystem.h>
-#include <vnl/vnl_fastops.h>
+#include <vnl/vnl_random.h>
+
+#include <algorithm>
 
 namespace itk
 {
@@ -35,18 +37,22 @@ namespace itk
     PCAImageToImageFilter< TInputImage, TOutputImage >
     ::PCAImageToImageFilter( void )
   {
+    this->m_PriorStatistics.m_Count = 0;
     this->m_MeanOfFeatureImages.set_size( 0 );
-    this->m_CenteredFeatureImages.set_size( 0, 0 );
+    this->m_ScatterMatrix.set_size( 0, 0 );
+    this->m_NumberOfSamples = 0;
 
     this->m_CovarianceMatrix.set_size( 0, 0 );
     this->m_EigenVectors.set_size( 0, 0 );
     this->m_EigenValues.set_size( 0 );
     this->m_NormalisedEigenValues.set_size( 0 );
-    this->m_PrincipalComponents.set_size( 0, 0 );
 
     this->m_NumberOfPixels = 0;
     this->m_NumberOfFeatureImages = 0;
     this->m_NumberOfPrincipalComponentsRequired = 0;
+    this->m_TruncatedEigenAnalysis = false;
+    this->m_NumberOfPowerIterations = 4;
+    this->m_ComputePrincipalComponentImages = true;
 
   } // end Constructor()
 
@@ -196,6 +202,49 @@ namespace itk
   } // end SetNumberOfFeatureImages()
 
 
+  /**
+   * ********************* SetPriorStatistics ****************************
+   */
+
+  template< class TInputImage, class TOutputImage >
+    void
+    PCAImageToImageFilter< TInputImage, TOutputImage >
+    ::SetPriorStatistics( SizeValueType numberOfSamples,
+    const VectorOfDoubleType & mean, const MatrixOfDoubleType & scatter )
+  {
+    if( mean.size() != scatter.rows() || scatter.rows() != scatter.cols() )
+    {
+      itkExceptionMacro( << "The prior mean and scatter matrix do not have matching sizes." );
+    }
+
+    this->m_PriorStatistics.m_Count = numberOfSamples;
+    this->m_PriorStatistics.m_Mean = mean;
+    this->m_PriorStatistics.m_Scatter = scatter;
+    this->Modified();
+
+  } // end SetPriorStatistics()
+
+
+  /**
+   * ********************* ClearPriorStatistics ****************************
+   */
+
+  template< class TInputImage, class TOutputImage >
+    void
+    PCAImageToImageFilter< TInputImage, TOutputImage >
+    ::ClearPriorStatistics( void )
+  {
+    if( this->m_PriorStatistics.m_Count != 0 )
+    {
+      this->m_PriorStatistics.m_Count = 0;
+      this->m_PriorStatistics.m_Mean.set_size( 0 );
+      this->m_PriorStatistics.m_Scatter.set_size( 0, 0 );
+      this->Modified();
+    }
+
+  } // end ClearPriorStatistics()
+
+
   /**
    * ********************* GenerateData ****************************
    */
@@ -207,8 +256,9 @@ namespace itk
   {
     /** Do the principal component analysis. */
     this->PerformPCA();
+    if( !this->m_ComputePrincipalComponentImages ) return;
 
-    /** Allocate memory for each output. ??Why here? */
+    /** Allocate memory for each output. */
     unsigned int numberOfOutputs =
       static_cast<unsigned int>( this->GetNumberOfOutputs() );
 
@@ -219,32 +269,8 @@ namespace itk
       output->Allocate();
     }
 
-    /** Create the output images. This is a matter of converting
-     * the vnl_matrix of principal components to images.
-     */
-    for( unsigned int i = 0; i < numberOfOutputs; ++i )
-    {
-      /** Extract one column vector at a time. This is faster
-       * than extracting the column every time, but comes at
-       * the cost of some additional memory use.
-       */
-
-      /** Create iterator. */
-      OutputImageIterator iter( this->GetOutput( i ), this->GetOutput( i )->GetRequestedRegion() );
-      iter.GoToBegin();
-      unsigned int pix = 0;
-
-      /** Fill this output with a principal component. */
-      while ( !iter.IsAtEnd() )
-      {
-        iter.Set( static_cast< OutputImagePixelType >( this->m_PrincipalComponents[ pix ][ i ] ) );
-        ++iter;
-        ++pix;
-      }
-    }
-
-    /** Maybe remove principal components? */
-    //this->m_PrincipalComponents.set_size( 0, 0 );
+    /** Fill the outputs with the principal components. */
+    this->ComputePrincipalComponents();
 
   } // end GenerateData()
 
@@ -259,11 +285,25 @@ namespace itk
     ::PerformPCA( void )
   {
     /** Get the number of pixels. */
-    this->m_NumberOfPixels = this->GetInput( 0 )->GetBufferedRegion().GetNumberOfPixels();
+    const typename TInputImage::RegionType & region
+      = this->GetInput( 0 )->GetBufferedRegion();
+    this->m_NumberOfPixels = region.GetNumberOfPixels();
+
+    /** The pixels are accessed in the buffers directly, so that the threads
+     * can start anywhere. This requires the same buffered region for all inputs.
+     */
+    this->m_InputBuffers.resize( this->m_NumberOfFeatureImages );
+    for( unsigned int i = 0; i < this->m_NumberOfFeatureImages; ++i )
+    {
+      if( this->GetInput( i )->GetBufferedRegion() != region )
+      {
+        itkExceptionMacro( << "BufferedRegion of input " << i
+          << " is not equal to the BufferedRegion of input 0" );
+      }
+      this->m_InputBuffers[ i ] = this->GetInput( i )->GetBufferPointer();
+    }
 
     this->CheckNumberOfOutputs();
-    this->CalculateMeanOfFeatureImages();
-    this->CenterFeatureImages();
     this->CalculateCovarianceMatrix();
     this->PerformEigenAnalysis();
 
@@ -302,116 +342,186 @@ namespace itk
 
 
   /**
-   * ********************* CalculateMeanOfFeatureImages ****************************
+   * ********************* CalculateCovarianceMatrix ****************************
    */
 
   template< class TInputImage, class TOutputImage >
     void
     PCAImageToImageFilter< TInputImage, TOutputImage >
-    ::CalculateMeanOfFeatureImages( void )
+    ::CalculateCovarianceMatrix( void )
   {
-    /** Get pointers to the input and setup iterators. */
-    std::vector< InputImageConstPointer >   inputImages( this->m_NumberOfFeatureImages );
-    std::vector< InputImageConstIterator >  iterators( this->m_NumberOfFeatureImages );
-
-    for( unsigned int i = 0; i < this->m_NumberOfFeatureImages; i++ )
+    /** Accumulate the partial scatters of the threads. */
+    this->m_ThreadScatters.resize( this->GetMultiThreader()->GetNumberOfThreads() );
+    this->GetMultiThreader()->SetSingleMethod( this->CovarianceThreaderCallback, this );
+    this->GetMultiThreader()->SingleMethodExecute();
+
+    /** Merge them in thread order, so that the result is reproducible. */
+    ScatterType total = this->m_ThreadScatters[ 0 ];
+    for( unsigned int t = 1; t < this->m_ThreadScatters.size(); ++t )
     {
-      inputImages[ i ] = this->GetInput( i );
-
-      iterators[ i ] = InputImageConstIterator(
-        inputImages[ i ], inputImages[ i ]->GetBufferedRegion() );
-      iterators[ i ].GoToBegin();
+      MergeScatter( total, this->m_ThreadScatters[ t ] );
     }
+    this->m_ThreadScatters.clear();
 
-    /** Calculate for each training image its mean. */
-    this->m_MeanOfFeatureImages.set_size( this->m_NumberOfFeatureImages );
-    this->m_MeanOfFeatureImages.fill( 0.0 );
-
-    for( unsigned int im = 0; im < this->m_NumberOfFeatureImages; ++im )
+    /** Add the pixels of previous runs. */
+    if( this->m_PriorStatistics.m_Count > 0 )
     {
-      for( unsigned int pix = 0; pix < this->m_NumberOfPixels; pix++ )
+      if( this->m_PriorStatistics.m_Mean.size() != this->m_NumberOfFeatureImages )
       {
-        this->m_MeanOfFeatureImages[ im ] += iterators[ im ].Get();
-        ++iterators[ im ];
+        itkExceptionMacro( << "The prior statistics are of "
+          << this->m_PriorStatistics.m_Mean.size() << " feature images, instead of "
+          << this->m_NumberOfFeatureImages << "." );
       }
+      ScatterType prior = this->m_PriorStatistics;
+      MergeScatter( prior, total );
+      total = prior;
+    }
+
+    this->m_NumberOfSamples = total.m_Count;
+    this->m_MeanOfFeatureImages = total.m_Mean;
+    this->m_ScatterMatrix = total.m_Scatter;
+    this->m_CovarianceMatrix = total.m_Scatter;
+
+    /** Divide. */
+    if( this->m_NumberOfSamples > 1 )
+    {
+      this->m_CovarianceMatrix /= static_cast<double>( this->m_NumberOfSamples - 1 );
+    }
+    else
+    {
+      this->m_CovarianceMatrix.fill( 0.0 );
     }
-    this->m_MeanOfFeatureImages /= this->m_NumberOfPixels;
 
-  } // end CalculateMeanOfFeatureImages()
+  } // end CalculateCovarianceMatrix()
 
 
   /**
-   * ********************* CenterFeatureImages ****************************
+   * ********************* MergeScatter ****************************
    */
 
   template< class TInputImage, class TOutputImage >
     void
     PCAImageToImageFilter< TInputImage, TOutputImage >
-    ::CenterFeatureImages( void )
+    ::MergeScatter( ScatterType & a, const ScatterType & b )
   {
-    /** Get pointers to the input and setup iterators. */
-    std::vector< InputImageConstIterator >  iterators( this->m_NumberOfFeatureImages );
-
-    for( unsigned int i = 0; i < this->m_NumberOfFeatureImages; i++ )
+    /** The pairwise update of Chan, Golub and LeVeque. */
+    if( b.m_Count == 0 ) return;
+    if( a.m_Count == 0 )
     {
-      iterators[ i ] = InputImageConstIterator(
-        this->GetInput( i ), this->GetInput( i )->GetBufferedRegion() );
-      iterators[ i ].GoToBegin();
+      a = b;
+      return;
     }
 
-    /** Set the proper size of the centered training images. */
-    this->m_CenteredFeatureImages.set_size(
-      this->m_NumberOfPixels, this->m_NumberOfFeatureImages );
+    const double na = static_cast<double>( a.m_Count );
+    const double nb = static_cast<double>( b.m_Count );
+    const double n = na + nb;
+    const VectorOfDoubleType delta = b.m_Mean - a.m_Mean;
 
-    /** Center the training images by subtracting the mean. */
-    for( unsigned int i = 0; i < this->m_NumberOfFeatureImages; ++i )
-    {
-      for( unsigned int pix = 0; pix < this->m_NumberOfPixels; pix++ )
-      {
+    a.m_Scatter += b.m_Scatter;
+    a.m_Scatter += outer_product( delta, delta ) * ( na * nb / n );
+    a.m_Mean += delta * ( nb / n );
+    a.m_Count += b.m_Count;
 
-        this->m_CenteredFeatureImages[ pix ][ i ] =
-          (iterators[ i ]).Get() - this->m_MeanOfFeatureImages[ i ];
-        ++iterators[ i ];
-      }
-    }
+  } // end MergeScatter()
 
-    /** TODO: Try to remove the input images, for memory efficiency.
-     * However, this also depends on other references to the input.
-     * We could try an InPlaceImageFilter.
-     */
 
-  } // end CenterFeatureImages()
+  /**
+   * ********************* CovarianceThreaderCallback ****************************
+   */
+
+  template< class TInputImage, class TOutputImage >
+    ITK_THREAD_RETURN_TYPE
+    PCAImageToImageFilter< TInputImage, TOutputImage >
+    ::CovarianceThreaderCallback( void * arg )
+  {
+    typedef MultiThreader::ThreadInfoStruct ThreadInfoType;
+    ThreadInfoType * info = static_cast<ThreadInfoType *>( arg );
+    Self * filter = static_cast<Self *>( info->UserData );
+
+    filter->ThreadedCalculateScatter( info->ThreadID, info->NumberOfThreads );
+
+    return ITK_THREAD_RETURN_VALUE;
+  } // end CovarianceThreaderCallback()
 
 
   /**
-   * ********************* CalculateCovarianceMatrix ****************************
+   * ********************* ThreadedCalculateScatter ****************************
    */
 
   template< class TInputImage, class TOutputImage >
     void
     PCAImageToImageFilter< TInputImage, TOutputImage >
-    ::CalculateCovarianceMatrix( void )
+    ::ThreadedCalculateScatter( unsigned int threadId, unsigned int numberOfThreads )
   {
-    /** Calculate the inner product of the centered training data.
-     * The slow and memory consuming alternative is:
-     * this->m_CovarianceMatrix =
-     *   this->m_CenteredTrainingImages.transpose() *
-     *   this->m_CenteredTrainingImages;
-     * The vnl function AtA is fast and memory efficient.
-     */
-    vnl_fastops::AtA( this->m_CovarianceMatrix, this->m_CenteredFeatureImages );
-
-    /** Divide. */
-    if( this->m_NumberOfPixels != 1 )
+    const unsigned int D = this->m_NumberOfFeatureImages;
+    const SizeValueType N = this->m_NumberOfPixels;
+    const SizeValueType begin = N * threadId / numberOfThreads;
+    const SizeValueType end = N * ( threadId + 1 ) / numberOfThreads;
+
+    /** The partial result of this thread. */
+    ScatterType & partial = this->m_ThreadScatters[ threadId ];
+    partial.m_Count = 0;
+    partial.m_Mean.set_size( D );
+    partial.m_Mean.fill( 0.0 );
+    partial.m_Scatter.set_size( D, D );
+    partial.m_Scatter.fill( 0.0 );
+
+    /** The pixels are processed in blocks, stored pixel by pixel. */
+    const SizeValueType blockSize = 4096;
+    std::vector<double> block( blockSize * D );
+    ScatterType blockScatter;
+    blockScatter.m_Mean.set_size( D );
+    blockScatter.m_Scatter.set_size( D, D );
+
+    for( SizeValueType blockBegin = begin; blockBegin < end; blockBegin += blockSize )
     {
-      this->m_CovarianceMatrix /= ( this->m_NumberOfPixels - 1 );
-    }
-    else
-    {
-      this->m_CovarianceMatrix.fill( 0.0 );
+      const SizeValueType nb = std::min( blockSize, end - blockBegin );
+
+      /** Gather the block and compute its mean. */
+      for( unsigned int i = 0; i < D; ++i )
+      {
+        const InputImagePixelType * input = this->m_InputBuffers[ i ] + blockBegin;
+        double sum = 0.0;
+        for( SizeValueType p = 0; p < nb; ++p )
+        {
+          block[ p * D + i ] = static_cast<double>( input[ p ] );
+          sum += block[ p * D + i ];
+        }
+        blockScatter.m_Mean[ i ] = sum / nb;
+      }
+
+      /** The scatter matrix of the block around its mean, upper triangle. */
+      blockScatter.m_Count = nb;
+      blockScatter.m_Scatter.fill( 0.0 );
+      for( SizeValueType p = 0; p < nb; ++p )
+      {
+        double * x = &block[ p * D ];
+        for( unsigned int i = 0; i < D; ++i )
+        {
+          x[ i ] -= blockScatter.m_Mean[ i ];
+        }
+        for( unsigned int i = 0; i < D; ++i )
+        {
+          double * row = blockScatter.m_Scatter[ i ];
+          const double xi = x[ i ];
+          for( unsigned int j = i; j < D; ++j )
+          {
+            row[ j ] += xi * x[ j ];
+          }
+        }
+      }
+      for( unsigned int i = 0; i < D; ++i )
+      {
+        for( unsigned int j = 0; j < i; ++j )
+        {
+          blockScatter.m_Scatter[ i ][ j ] = blockScatter.m_Scatter[ j ][ i ];
+        }
+      }
+
+      MergeScatter( partial, blockScatter );
     }
 
-  } // end CalculateCovarianceMatrix()
+  } // end ThreadedCalculateScatter()
 
 
   /**
@@ -423,6 +533,15 @@ namespace itk
     PCAImageToImageFilter< TInputImage, TOutputImage >
     ::PerformEigenAnalysis( void )
   {
+    /** Compute only the required components, if requested and useful. */
+    const unsigned int numberOfOutputs = this->GetNumberOfOutputs();
+    if( this->m_TruncatedEigenAnalysis
+      && numberOfOutputs < this->m_NumberOfFeatureImages )
+    {
+      this->PerformTruncatedEigenAnalysis( numberOfOutputs );
+      return;
+    }
+
     /** Perform the eigen analysis. */
     vnl_symmetric_eigensystem< double > eigenSystem( this->m_CovarianceMatrix );
 
@@ -438,16 +557,210 @@ namespace itk
     this->m_NormalisedEigenValues = this->m_EigenValues;
     this->m_NormalisedEigenValues.normalize();
 
-    /** Calculate the principal components.
-     * This is done by multiplying the training data with the eigen vectors.
+  } // end PerformEigenAnalysis()
+
+
+  /**
+   * ********************* PerformTruncatedEigenAnalysis ****************************
+   */
+
+  template< class TInputImage, class TOutputImage >
+    void
+    PCAImageToImageFilter< TInputImage, TOutputImage >
+    ::PerformTruncatedEigenAnalysis( unsigned int k )
+  {
+    /** The subspace is somewhat larger than k, for accuracy. */
+    const unsigned int D = this->m_NumberOfFeatureImages;
+    const unsigned int L = vnl_math_min( D, k + 10 );
+
+    /** Start from a random subspace, with a fixed seed for reproducibility. */
+    vnl_random random( 1234567 );
+    MatrixOfDoubleType Q( D, L );
+    for( unsigned int i = 0; i < D; ++i )
+    {
+      for( unsigned int j = 0; j < L; ++j )
+      {
+        Q[ i ][ j ] = random.normal();
+      }
+    }
+    OrthonormalizeColumns( Q );
+
+    /** Subspace iteration: the largest eigen vectors come to dominate Q. */
+    for( unsigned int it = 0; it < this->m_NumberOfPowerIterations; ++it )
+    {
+      Q = this->m_CovarianceMatrix * Q;
+      OrthonormalizeColumns( Q );
+    }
+
+    /** Rayleigh-Ritz: the eigen analysis of the projected covariance matrix. */
+    const MatrixOfDoubleType CQ = this->m_CovarianceMatrix * Q;
+    const MatrixOfDoubleType B = Q.transpose() * CQ;
+    vnl_symmetric_eigensystem< double > eigenSystem( B );
+
+    /** Get the k largest eigen vectors and values. */
+    MatrixOfDoubleType eigenVectors = Q * eigenSystem.V;
+    eigenVectors.fliplr();
+    this->m_EigenVectors = eigenVectors.extract( D, k );
+
+    VectorOfDoubleType eigenValues = (eigenSystem.D).diagonal();
+    eigenValues.flip();
+    this->m_EigenValues = eigenValues.extract( k );
+
+    /** Also get a normalised version. */
+    this->m_NormalisedEigenValues = this->m_EigenValues;
+    this->m_NormalisedEigenValues.normalize();
+
+  } // end PerformTruncatedEigenAnalysis()
+
+
+  /**
+   * ********************* OrthonormalizeColumns ****************************
+   */
+
+  template< class TInputImage, class TOutputImage >
+    void
+    PCAImageToImageFilter< TInputImage, TOutputImage >
+    ::OrthonormalizeColumns( MatrixOfDoubleType & matrix )
+  {
+    const unsigned int rows = matrix.rows();
+    const unsigned int cols = matrix.cols();
+    for( unsigned int j = 0; j < cols; ++j )
+    {
+      /** Remove the components along the previous columns. */
+      for( unsigned int jj = 0; jj < j; ++jj )
+      {
+        double dot = 0.0;
+        for( unsigned int i = 0; i < rows; ++i )
+        {
+          dot += matrix[ i ][ j ] * matrix[ i ][ jj ];
+        }
+        for( unsigned int i = 0; i < rows; ++i )
+        {
+          matrix[ i ][ j ] -= dot * matrix[ i ][ jj ];
+        }
+      }
+
+      /** Normalize, a column in the span of the previous ones becomes zero. */
+      double norm = 0.0;
+      for( unsigned int i = 0; i < rows; ++i )
+      {
+        norm += matrix[ i ][ j ] * matrix[ i ][ j ];
+      }
+      norm = vcl_sqrt( norm );
+      const double scale = norm > 1e-300 ? 1.0 / norm : 0.0;
+      for( unsigned int i = 0; i < rows; ++i )
+      {
+        matrix[ i ][ j ] *= scale;
+      }
+    }
+
+  } // end OrthonormalizeColumns()
+
+
+  /**
+   * ********************* ComputePrincipalComponents ****************************
+   */
+
+  template< class TInputImage, class TOutputImage >
+    void
+    PCAImageToImageFilter< TInputImage, TOutputImage >
+    ::ComputePrincipalComponents( void )
+  {
+    /** The principal components are the centered inputs multiplied with
+     * the eigen vectors, computed per pixel in a threaded pass over the
+     * requested region of the outputs.
      */
-    this->m_PrincipalComponents =
-      this->m_CenteredFeatureImages * this->m_EigenVectors;
+    this->GetMultiThreader()->SetSingleMethod( this->PrincipalComponentsThreaderCallback, this );
+    this->GetMultiThreader()->SingleMethodExecute();
 
-    /** The CenteredFeatureImages can now be removed for memory efficiency. */
-    this->m_CenteredFeatureImages.set_size( 0, 0 );
+  } // end ComputePrincipalComponents()
 
-  } // end PerformEigenAnalysis()
+
+  /**
+   * ********************* PrincipalComponentsThreaderCallback ****************************
+   */
+
+  template< class TInputImage, class TOutputImage >
+    ITK_THREAD_RETURN_TYPE
+    PCAImageToImageFilter< TInputImage, TOutputImage >
+    ::PrincipalComponentsThreaderCallback( void * arg )
+  {
+    typedef MultiThreader::ThreadInfoStruct ThreadInfoType;
+    ThreadInfoType * info = static_cast<ThreadInfoType *>( arg );
+    Self * filter = static_cast<Self *>( info->UserData );
+
+    filter->ThreadedComputePrincipalComponents( info->ThreadID, info->NumberOfThreads );
+
+    return ITK_THREAD_RETURN_VALUE;
+  } // end PrincipalComponentsThreaderCallback()
+
+
+  /**
+   * ********************* ThreadedComputePrincipalComponents ****************************
+   */
+
+  template< class TInputImage, class TOutputImage >
+    void
+    PCAImageToImageFilter< TInputImage, TOutputImage >
+    ::ThreadedComputePrincipalComponents( unsigned int threadId, unsigned int numberOfThreads )
+  {
+    /** The region of this thread, split like in ThreadedGenerateData. */
+    typename OutputImageType::RegionType region;
+    const unsigned int total = this->SplitRequestedRegion( threadId, numberOfThreads, region );
+    if( threadId >= total ) return;
+
+    /** The eigen vectors of the requested components, as a contiguous
+     * D x K array, and the mean.
+     */
+    const unsigned int D = this->m_NumberOfFeatureImages;
+    const unsigned int K = this->GetNumberOfOutputs();
+    std::vector<double> eigenVectors( D * K );
+    for( unsigned int i = 0; i < D; ++i )
+    {
+      for( unsigned int j = 0; j < K; ++j )
+      {
+        eigenVectors[ i * K + j ] = this->m_EigenVectors[ i ][ j ];
+      }
+    }
+    const VectorOfDoubleType & mean = this->m_MeanOfFeatureImages;
+
+    /** Setup iterators over all inputs and outputs. */
+    std::vector< InputImageConstIterator > inputIterators( D );
+    for( unsigned int i = 0; i < D; ++i )
+    {
+      inputIterators[ i ] = InputImageConstIterator( this->GetInput( i ), region );
+      inputIterators[ i ].GoToBegin();
+    }
+    std::vector< OutputImageIterator > outputIterators( K );
+    for( unsigned int j = 0; j < K; ++j )
+    {
+      outputIterators[ j ] = OutputImageIterator( this->GetOutput( j ), region );
+      outputIterators[ j ].GoToBegin();
+    }
+
+    /** Project every pixel, centered on the fly, on all components at once. */
+    std::vector<double> pcs( K );
+    while( !outputIterators[ 0 ].IsAtEnd() )
+    {
+      std::fill( pcs.begin(), pcs.end(), 0.0 );
+      for( unsigned int i = 0; i < D; ++i )
+      {
+        const double centered = inputIterators[ i ].Get() - mean[ i ];
+        ++inputIterators[ i ];
+        const double * v = &eigenVectors[ i * K ];
+        for( unsigned int j = 0; j < K; ++j )
+        {
+          pcs[ j ] += centered * v[ j ];
+        }
+      }
+      for( unsigned int j = 0; j < K; ++j )
+      {
+        outputIterators[ j ].Set( static_cast< OutputImagePixelType >( pcs[ j ] ) );
+        ++outputIterators[ j ];
+      }
+    }
+
+  } // end ThreadedComputePrincipalComponents()
 
 
   /**
@@ -469,6 +782,16 @@ namespace itk
       << this->m_NumberOfFeatureImages << std::endl;
     os << indent << "NumberOfPixels: "
       << this->m_NumberOfPixels << std::endl;
+    os << indent << "TruncatedEigenAnalysis: "
+      << this->m_TruncatedEigenAnalysis << std::endl;
+    os << indent << "NumberOfPowerIterations: "
+      << this->m_NumberOfPowerIterations << std::endl;
+    os << indent << "NumberOfPriorSamples: "
+      << this->m_PriorStatistics.m_Count << std::endl;
+    os << indent << "NumberOfSamples: "
+      << this->m_NumberOfSamples << std::endl;
+    os << indent << "ComputePrincipalComponentImages: "
+      << this->m_ComputePrincipalComponentImages << std::endl;
 
     os << indent << "CovarianceMatrix: " << std::endl;
     for( unsigned int i = 0; i < this->m_CovarianceMatrix.size(); i++ )
@@ -43,6 +43,15 @@ std::string GetHelpString( void )
     << "  [-out]   outputDirectory, default equal to the inputFilename directory\n"
     << "  [-opc]   the number of principal components that you want to output, default all\n"
     << "  [-opct]  output pixel component type, default derived from the input image\n"
+    << "  [-trunc] compute only the required principal components, with a randomized\n"
+    << "           subspace iteration instead of a full eigen decomposition,\n"
+    << "           which is much faster for many input images\n"
+    << "  [-internalType] the type the inputs are read as, float or double, default double;\n"
+    << "           float halves the memory, the covariances are accumulated in double\n"
+    << "  [-inmodel]  a model of a previous run, of the same feature images; the pixels of\n"
+    << "           the inputs are added to its statistics, so that only the inputs are read\n"
+    << "  [-outmodel] write the model: the number of pixels, mean and scatter matrix\n"
+    << "  [-modelonly] only update the model and the eigen analysis, without pc images\n"
     << "Supported: 2D, 3D, (unsigned) char, (unsigned) short, (unsigned) int, (unsigned) long, float, double.";
 
   return ss.str();
@@ -87,9 +96,23 @@ int main( int argc, char **argv )
   unsigned int numberOfPCs = inputFileNames.size();
   parser->GetCommandLineArgument( "-npc", numberOfPCs );
 
+  const bool truncatedEigenAnalysis = parser->ArgumentExists( "-trunc" );
+
+  std::string inputModelFileName = "";
+  parser->GetCommandLineArgument( "-inmodel", inputModelFileName );
+  std::string outputModelFileName = "";
+  parser->GetCommandLineArgument( "-outmodel", outputModelFileName );
+  const bool modelOnly = parser->ArgumentExists( "-modelonly" );
+
   std::string componentTypeString = "";
   bool retopct = parser->GetCommandLineArgument( "-opct", componentTypeString );
 
+  itk::ImageIOBase::IOComponentType internalComponentType = itk::ImageIOBase::DOUBLE;
+  if( !itktools::GetInternalComponentType( parser, internalComponentType ) )
+  {
+    return EXIT_FAILURE;
+  }
+
   /** Check that numberOfOutputs <= numberOfInputs. */
   if( numberOfPCs > inputFileNames.size() )
   {
@@ -124,28 +147,48 @@ int main( int argc, char **argv )
   try
   {
     // now call all possible template combinations.
-    if( !filter ) filter = ITKToolsPCA< 2, unsigned char >::New( dim, componentType );
-    if( !filter ) filter = ITKToolsPCA< 2, char >::New( dim, componentType );
-    if( !filter ) filter = ITKToolsPCA< 2, unsigned short >::New( dim, componentType );
-    if( !filter ) filter = ITKToolsPCA< 2, short >::New( dim, componentType );
-    if( !filter ) filter = ITKToolsPCA< 2, unsigned int >::New( dim, componentType );
-    if( !filter ) filter = ITKToolsPCA< 2, int >::New( dim, componentType );
-    if( !filter ) filter = ITKToolsPCA< 2, unsigned long >::New( dim, componentType );
-    if( !filter ) filter = ITKToolsPCA< 2, long >::New( dim, componentType );
-    if( !filter ) filter = ITKToolsPCA< 2, float >::New( dim, componentType );
-    if( !filter ) filter = ITKToolsPCA< 2, double >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsPCA< 2, unsigned char, double >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 2, char, double >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 2, unsigned short, double >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 2, short, double >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 2, unsigned int, double >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 2, int, double >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 2, unsigned long, double >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 2, long, double >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 2, float, double >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 2, double, double >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 2, unsigned char, float >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 2, char, float >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 2, unsigned short, float >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 2, short, float >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 2, unsigned int, float >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 2, int, float >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 2, unsigned long, float >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 2, long, float >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 2, float, float >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 2, double, float >::New( dim, componentType, internalComponentType );
 
 #ifdef ITKTOOLS_3D_SUPPORT
-    if( !filter ) filter = ITKToolsPCA< 3, unsigned char >::New( dim, componentType );
-    if( !filter ) filter = ITKToolsPCA< 3, char >::New( dim, componentType );
-    if( !filter ) filter = ITKToolsPCA< 3, unsigned short >::New( dim, componentType );
-    if( !filter ) filter = ITKToolsPCA< 3, short >::New( dim, componentType );
-    if( !filter ) filter = ITKToolsPCA< 3, unsigned int >::New( dim, componentType );
-    if( !filter ) filter = ITKToolsPCA< 3, int >::New( dim, componentType );
-    if( !filter ) filter = ITKToolsPCA< 3, unsigned long >::New( dim, componentType );
-    if( !filter ) filter = ITKToolsPCA< 3, long >::New( dim, componentType );
-    if( !filter ) filter = ITKToolsPCA< 3, float >::New( dim, componentType );
-    if( !filter ) filter = ITKToolsPCA< 3, double >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsPCA< 3, unsigned char, double >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 3, char, double >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 3, unsigned short, double >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 3, short, double >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 3, unsigned int, double >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 3, int, double >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 3, unsigned long, double >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 3, long, double >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 3, float, double >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 3, double, double >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 3, unsigned char, float >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 3, char, float >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 3, unsigned short, float >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 3, short, float >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 3, unsigned int, float >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 3, int, float >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 3, unsigned long, float >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 3, long, float >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 3, float, float >::New( dim, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsPCA< 3, double, float >::New( dim, componentType, internalComponentType );
 #endif
     /** Check if filter was instantiated. */
     bool supported = itktools::IsFilterSupportedCheck( filter, dim, componentType );
@@ -155,7 +198,12 @@ int main( int argc, char **argv )
     filter->m_InputFileNames = inputFileNames;
     filter->m_OutputDirectory = outputDirectory;
     filter->m_NumberOfPCs = numberOfPCs;
+    filter->m_TruncatedEigenAnalysis = truncatedEigenAnalysis;
+    filter->m_InputModelFileName = inputModelFileName;
+    filter->m_OutputModelFileName = outputModelFileName;
+    filter->m_ModelOnly = modelOnly;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
@@ -21,6 +21,9 @@
 #include "ITKToolsBase.h"
 
 #include <itksys/SystemTools.hxx>
+#include <fstream>
+#include <iomanip>
+#include <limits>
 #include <sstream>
 #include "itkPCAImageToImageFilter.h"
 #include "itkImageFileReader.h"
@@ -41,6 +44,10 @@ public:
   {
     this->m_OutputDirectory = "";
     this->m_NumberOfPCs = 0;
+    this->m_TruncatedEigenAnalysis = false;
+    this->m_InputModelFileName = "";
+    this->m_OutputModelFileName = "";
+    this->m_ModelOnly = false;
   };
   /** Destructor. */
   ~ITKToolsPCABase(){};
@@ -49,6 +56,58 @@ public:
   std::vector< std::string > m_InputFileNames;
   std::string m_OutputDirectory;
   unsigned int m_NumberOfPCs;
+  bool m_TruncatedEigenAnalysis;
+  std::string m_InputModelFileName;
+  std::string m_OutputModelFileName;
+  bool m_ModelOnly;
+
+  /** Read a model: the number of pixels seen, and the mean and the scatter
+   * matrix of the feature images, as written by WriteModel(). */
+  static void ReadModel( const std::string & fileName,
+    unsigned long & numberOfSamples,
+    vnl_vector<double> & mean, vnl_matrix<double> & scatter )
+  {
+    std::ifstream file( fileName.c_str() );
+    std::string magic;
+    unsigned int D = 0;
+    file >> magic >> D >> numberOfSamples;
+    if( !file || magic != "ITKToolsPCAModel" || D == 0 )
+    {
+      itkGenericExceptionMacro( << "ERROR: " << fileName << " is not a PCA model." );
+    }
+    mean.set_size( D );
+    scatter.set_size( D, D );
+    for( unsigned int i = 0; i < D; ++i ) file >> mean[ i ];
+    for( unsigned int i = 0; i < D; ++i )
+    {
+      for( unsigned int j = 0; j < D; ++j ) file >> scatter[ i ][ j ];
+    }
+    if( !file )
+    {
+      itkGenericExceptionMacro( << "ERROR: the PCA model " << fileName << " is truncated." );
+    }
+  } // end ReadModel()
+
+  /** Write a model, in text, with enough digits to read it back exactly. */
+  static void WriteModel( const std::string & fileName,
+    const unsigned long numberOfSamples,
+    const vnl_vector<double> & mean, const vnl_matrix<double> & scatter )
+  {
+    std::ofstream file( fileName.c_str() );
+    file << std::setprecision( std::numeric_limits<double>::digits10 + 2 );
+    file << "ITKToolsPCAModel " << mean.size() << " " << numberOfSamples << "\n";
+    for( unsigned int i = 0; i < mean.size(); ++i ) file << mean[ i ] << " ";
+    file << "\n";
+    for( unsigned int i = 0; i < scatter.rows(); ++i )
+    {
+      for( unsigned int j = 0; j < scatter.cols(); ++j ) file << scatter[ i ][ j ] << " ";
+      file << "\n";
+    }
+    if( !file )
+    {
+      itkGenericExceptionMacro( << "ERROR: could not write the PCA model " << fileName << "." );
+    }
+  } // end WriteModel()
 
 }; // end class ITKToolsPCABase
 
@@ -59,13 +118,13 @@ public:
  * and the New() function for its creation.
  */
 
-template< unsigned int VDimension, class TComponentType >
+template< unsigned int VDimension, class TComponentType, class TInternalType >
 class ITKToolsPCA : public ITKToolsPCABase
 {
 public:
   /** Standard ITKTools stuff. */
   typedef ITKToolsPCA Self;
-  itktoolsOneTypeNewMacro( Self );
+  itktoolsOneTypeWithInternalTypeNewMacro( Self );
 
   ITKToolsPCA(){};
   ~ITKToolsPCA(){};
@@ -75,12 +134,12 @@ public:
   {
     /** Typedefs. */
     typedef itk::Image< TComponentType, VDimension >      OutputImageType;
-    typedef itk::Image< double, VDimension >              DoubleImageType;
+    typedef itk::Image< TInternalType, VDimension >       InternalImageType;
     typedef itk::PCAImageToImageFilter<
-      DoubleImageType, OutputImageType >                  PCAEstimatorType;
+      InternalImageType, OutputImageType >                PCAEstimatorType;
     typedef typename PCAEstimatorType::VectorOfDoubleType VectorOfDoubleType;
     typedef typename PCAEstimatorType::MatrixOfDoubleType MatrixOfDoubleType;
-    typedef itk::ImageFileReader< DoubleImageType >       ReaderType;
+    typedef itk::ImageFileReader< InternalImageType >     ReaderType;
     typedef typename ReaderType::Pointer                  ReaderPointer;
     typedef itk::ImageFileWriter< OutputImageType >       WriterType;
     typedef typename WriterType::Pointer                  WriterPointer;
@@ -92,6 +151,23 @@ public:
     typename PCAEstimatorType::Pointer pcaEstimator = PCAEstimatorType::New();
     pcaEstimator->SetNumberOfFeatureImages( noInputs );
     pcaEstimator->SetNumberOfPrincipalComponentsRequired( this->m_NumberOfPCs );
+    pcaEstimator->SetTruncatedEigenAnalysis( this->m_TruncatedEigenAnalysis );
+    pcaEstimator->SetComputePrincipalComponentImages( !this->m_ModelOnly );
+
+    /** Continue from the statistics of a previous run. */
+    if( this->m_InputModelFileName != "" )
+    {
+      unsigned long numberOfSamples = 0;
+      VectorOfDoubleType mean;
+      MatrixOfDoubleType scatter;
+      ReadModel( this->m_InputModelFileName, numberOfSamples, mean, scatter );
+      if( mean.size() != noInputs )
+      {
+        itkGenericExceptionMacro( << "ERROR: the model " << this->m_InputModelFileName
+          << " is of " << mean.size() << " feature images, instead of " << noInputs << "." );
+      }
+      pcaEstimator->SetPriorStatistics( numberOfSamples, mean, scatter );
+    }
 
     /** For all inputs... */
     std::vector<ReaderPointer> readers( noInputs );
@@ -109,6 +185,13 @@ public:
     /** Do the PCA analysis. */
     pcaEstimator->Update();
 
+    /** Save the updated statistics. */
+    if( this->m_OutputModelFileName != "" )
+    {
+      WriteModel( this->m_OutputModelFileName, pcaEstimator->GetNumberOfSamples(),
+        pcaEstimator->GetMeanOfFeatureImages(), pcaEstimator->GetScatterMatrix() );
+    }
+
     /** Get eigenvalues and vectors, and print it to screen. */
     //pcaEstimator->Print( std::cout );
     VectorOfDoubleType vec = pcaEstimator->GetEigenValues();
@@ -122,12 +205,13 @@ public:
     std::cout << std::endl;
 
     std::cout << "Eigenvectors: " << std::endl;
-    for( unsigned int i = 0; i < vec.size(); ++i )
+    for( unsigned int i = 0; i < mat.rows(); ++i )
     {
       std::cout << mat.get_row( i ) << std::endl;
     }
 
     /** Setup and process the pipeline. */
+    if( this->m_ModelOnly ) return;
     unsigned int noo = pcaEstimator->GetNumberOfOutputs();
     std::vector<WriterPointer> writers( noo );
     for( unsigned int i = 0; i < noo; ++i )
@@ -156,6 +156,7 @@ int main( int argc, char ** argv )
     filter->m_OutputFileName = outputFileName;
     filter->m_Direction = direction;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
@@ -23,6 +23,9 @@
 #include "itkImageFileReader.h"
 #include "itkFlipImageFilter.h"
 #include "itkImageFileWriter.h"
+#include "itkMultiThreader.h"
+
+#include <algorithm>
 
 
 /** \class ITKToolsUnaryImageOperatorBase
@@ -87,24 +90,111 @@ public:
 
     /** Read in the input image. */
     typename ReaderType::Pointer reader = ReaderType::New();
-    typename ReflectFilterType::Pointer reflectFilter = ReflectFilterType::New();
-    typename WriterType::Pointer writer = WriterType::New();
-
-    /** Set up pipeline. */
     reader->SetFileName( this->m_InputFileName );
-
+    this->ObserveProcess( reader.GetPointer(), "read" );
+    reader->Update();
+    typename InputImageType::Pointer image = reader->GetOutput();
+    image->DisconnectPipeline();
+
+    /** The flip filter only computes the geometry of the output; the origin
+     * and direction are the same as without the in-place reflection.
+     */
+    typename ReflectFilterType::Pointer reflectFilter = ReflectFilterType::New();
     itk::FixedArray<bool, Dimension> flipAxes(false);
     flipAxes[m_Direction] = true;
-
     reflectFilter->SetFlipAxes( flipAxes );
+    reflectFilter->SetInput( image );
+    reflectFilter->UpdateOutputInformation();
+    const typename InputImageType::PointType origin
+      = reflectFilter->GetOutput()->GetOrigin();
+    const typename InputImageType::DirectionType direction
+      = reflectFilter->GetOutput()->GetDirection();
+
+    /** Reflect the buffer in place, and set the geometry. */
+    ReflectStruct str;
+    str.Buffer = image->GetBufferPointer();
+    const typename InputImageType::SizeType size
+      = image->GetBufferedRegion().GetSize();
+    str.Length = size[ this->m_Direction ];
+    str.Stride = 1;
+    for( unsigned int i = 0; i < this->m_Direction; ++i ) str.Stride *= size[ i ];
+    str.NumberOfBlocks = image->GetBufferedRegion().GetNumberOfPixels()
+      / ( str.Length * str.Stride );
+
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    threader->SetSingleMethod( Self::ThreaderCallback, &str );
+    threader->SingleMethodExecute();
+
+    image->SetOrigin( origin );
+    image->SetDirection( direction );
+
+    /** Write the output image. */
+    typename WriterType::Pointer writer = WriterType::New();
     writer->SetFileName( this->m_OutputFileName );
-
-    reflectFilter->SetInput( reader->GetOutput() );
-    writer->SetInput( reflectFilter->GetOutput() );
+    writer->SetInput( image );
+    this->ObserveProcess( writer.GetPointer(), "write" );
     writer->Update();
 
   } // end Run()
 
+protected:
+
+  /** The buffer is a sequence of NumberOfBlocks blocks of Length lines of
+   * Stride contiguous pixels along the reflected direction.
+   */
+  struct ReflectStruct
+  {
+    TComponentType *  Buffer;
+    std::size_t       Length;
+    std::size_t       Stride;
+    std::size_t       NumberOfBlocks;
+  };
+
+  /** Reflect a contiguous part of the buffer. Along x every line is
+   * reversed; along another direction the mirrored rows or slices of
+   * Stride pixels are swapped, so that both are read and written once and
+   * contiguously, without a second buffer.
+   */
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback( void * arg )
+  {
+    typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+    ThreadInfoType * info = static_cast<ThreadInfoType *>( arg );
+    ReflectStruct * str = static_cast<ReflectStruct *>( info->UserData );
+    const std::size_t threadId = info->ThreadID;
+    const std::size_t numberOfThreads = info->NumberOfThreads;
+
+    const std::size_t n = str->Length;
+    const std::size_t stride = str->Stride;
+    if( stride == 1 )
+    {
+      /** Reverse the lines of this thread. */
+      const std::size_t begin = str->NumberOfBlocks * threadId / numberOfThreads;
+      const std::size_t end = str->NumberOfBlocks * ( threadId + 1 ) / numberOfThreads;
+      for( std::size_t l = begin; l < end; ++l )
+      {
+        TComponentType * line = str->Buffer + l * n;
+        std::reverse( line, line + n );
+      }
+      return ITK_THREAD_RETURN_VALUE;
+    }
+
+    /** Swap the pairs of mirrored rows of this thread. */
+    const std::size_t half = n / 2;
+    const std::size_t numberOfPairs = str->NumberOfBlocks * half;
+    const std::size_t begin = numberOfPairs * threadId / numberOfThreads;
+    const std::size_t end = numberOfPairs * ( threadId + 1 ) / numberOfThreads;
+    for( std::size_t p = begin; p < end; ++p )
+    {
+      const std::size_t block = p / half;
+      const std::size_t i = p % half;
+      TComponentType * blockStart = str->Buffer + block * n * stride;
+      TComponentType * row = blockStart + i * stride;
+      std::swap_ranges( row, row + stride, blockStart + ( n - 1 - i ) * stride );
+    }
+    return ITK_THREAD_RETURN_VALUE;
+
+  } // end ThreaderCallback()
+
 }; // end Reflect
 
 
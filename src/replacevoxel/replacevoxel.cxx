@@ -26,6 +26,7 @@
 
 #include "itkCommandLineArgumentParser.h"
 #include "ITKToolsHelpers.h"
+#include "ITKToolsColumnReader.h"
 #include "replacevoxel.h"
 
 
@@ -42,8 +43,15 @@ std::string GetHelpString( void )
     << "pxreplacevoxel\n"
     << "  -in      inputFilename\n"
     << "  [-out]   outputFilename, default in + VOXELREPLACED.mhd\n"
-    << "  -vox     input voxel index\n"
-    << "  -val     value that replaces the voxel\n"
+    << "  [-vox]   input voxel index\n"
+    << "  [-val]   value that replaces the voxel\n"
+    << "  [-list]  a text file with a voxel per line: the index followed by the value\n"
+    << "  [-inplace] change the voxels of the input file itself, instead of writing -out\n"
+    << "Either \"-vox\" and \"-val\", or \"-list\" need to be specified.\n"
+    << "With -inplace, the voxels of an uncompressed MetaImage (mhd/raw or mha) in the\n"
+    << "byte order of this machine are written directly at their offsets in the data file,\n"
+    << "so that the time does not depend on the image size. Other files are read and\n"
+    << "written completely.\n"
     << "Supported: 2D, 3D, (unsigned) char, (unsigned) short, (unsigned) int,\n"
     << "(unsigned) long, float, double.";
 
@@ -63,8 +71,11 @@ int main( int argc, char ** argv )
   parser->SetProgramHelpText( GetHelpString() );
 
   parser->MarkArgumentAsRequired( "-in", "The input filename." );
-  parser->MarkArgumentAsRequired( "-vox", "Voxel." );
-  parser->MarkArgumentAsRequired( "-val", "Value." );
+
+  std::vector<std::string> exactlyOneArguments;
+  exactlyOneArguments.push_back( "-vox" );
+  exactlyOneArguments.push_back( "-list" );
+  parser->MarkExactlyOneOfArgumentsAsRequired( exactlyOneArguments );
 
   itk::CommandLineArgumentParser::ReturnValue validateArguments = parser->CheckForRequiredArguments();
 
@@ -86,10 +97,25 @@ int main( int argc, char ** argv )
   parser->GetCommandLineArgument( "-out", outputFileName );
 
   std::vector< unsigned int > voxel;
-  parser->GetCommandLineArgument( "-vox", voxel );
+  const bool retvox = parser->GetCommandLineArgument( "-vox", voxel );
+
+  double value = 0;
+  const bool retval = parser->GetCommandLineArgument( "-val", value );
 
-  double value = 0; // This is a required argument, but we must initialize it to prevent compiler warnings.
-  parser->GetCommandLineArgument( "-val", value );
+  std::string listFileName = "";
+  const bool retlist = parser->GetCommandLineArgument( "-list", listFileName );
+
+  const bool inPlace = parser->ArgumentExists( "-inplace" );
+  if( inPlace && parser->ArgumentExists( "-out" ) )
+  {
+    std::cerr << "ERROR: \"-inplace\" can not be combined with \"-out\"." << std::endl;
+    return EXIT_FAILURE;
+  }
+  if( retvox && !retval )
+  {
+    std::cerr << "ERROR: You should specify \"-val\" with \"-vox\"." << std::endl;
+    return EXIT_FAILURE;
+  }
 
   /** Determine image properties. */
   itk::ImageIOBase::IOPixelType pixelType = itk::ImageIOBase::UNKNOWNPIXELTYPE;
@@ -105,12 +131,54 @@ int main( int argc, char ** argv )
   if( !retNOCCheck ) return EXIT_FAILURE;
 
   /** Check if the specified voxel-size has Dimension number of components. */
-  if( voxel.size() != dim )
+  std::vector< std::vector<unsigned int> > voxels;
+  std::vector<double> values;
+  if( retvox )
   {
-    std::cerr << "ERROR: You should specify "
-      << dim
-      << " numbers with \"-vox\"." << std::endl;
-    return EXIT_FAILURE;
+    if( voxel.size() != dim )
+    {
+      std::cerr << "ERROR: You should specify "
+        << dim
+        << " numbers with \"-vox\"." << std::endl;
+      return EXIT_FAILURE;
+    }
+    voxels.push_back( voxel );
+    values.push_back( value );
+  }
+
+  /** Read the voxels and values from the list, one voxel per line. */
+  if( retlist )
+  {
+    std::vector<unsigned int> columns;
+    std::vector< std::vector<double> > columnData;
+    unsigned int numberOfColumns = 0;
+    if( !itktools::ReadNumericColumns( listFileName, columns, columnData, numberOfColumns ) )
+    {
+      return EXIT_FAILURE;
+    }
+    if( numberOfColumns != dim + 1 )
+    {
+      std::cerr << "ERROR: The lines of " << listFileName << " should have "
+        << dim + 1 << " columns, the index and the value." << std::endl;
+      return EXIT_FAILURE;
+    }
+    const std::size_t numberOfVoxels = columnData.empty() ? 0 : columnData[ 0 ].size();
+    voxels.resize( numberOfVoxels, std::vector<unsigned int>( dim ) );
+    values.resize( numberOfVoxels );
+    for( std::size_t v = 0; v < numberOfVoxels; ++v )
+    {
+      for( unsigned int i = 0; i < dim; ++i )
+      {
+        if( columnData[ i ][ v ] < 0.0 )
+        {
+          std::cerr << "ERROR: invalid voxel index on line " << v + 1
+            << " of " << listFileName << "." << std::endl;
+          return EXIT_FAILURE;
+        }
+        voxels[ v ][ i ] = static_cast<unsigned int>( columnData[ i ][ v ] );
+      }
+      values[ v ] = columnData[ dim ][ v ];
+    }
   }
 
   /** Class that does the work. */
@@ -119,12 +187,28 @@ int main( int argc, char ** argv )
   try
   {
     // now call all possible template combinations.
+    if( !filter ) filter = ITKToolsReplaceVoxel< 2, char >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsReplaceVoxel< 2, unsigned char >::New( dim, componentType );
     if( !filter ) filter = ITKToolsReplaceVoxel< 2, short >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsReplaceVoxel< 2, unsigned short >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsReplaceVoxel< 2, int >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsReplaceVoxel< 2, unsigned int >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsReplaceVoxel< 2, long >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsReplaceVoxel< 2, unsigned long >::New( dim, componentType );
     if( !filter ) filter = ITKToolsReplaceVoxel< 2, float >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsReplaceVoxel< 2, double >::New( dim, componentType );
 
 #ifdef ITKTOOLS_3D_SUPPORT
+    if( !filter ) filter = ITKToolsReplaceVoxel< 3, char >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsReplaceVoxel< 3, unsigned char >::New( dim, componentType );
     if( !filter ) filter = ITKToolsReplaceVoxel< 3, short >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsReplaceVoxel< 3, unsigned short >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsReplaceVoxel< 3, int >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsReplaceVoxel< 3, unsigned int >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsReplaceVoxel< 3, long >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsReplaceVoxel< 3, unsigned long >::New( dim, componentType );
     if( !filter ) filter = ITKToolsReplaceVoxel< 3, float >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsReplaceVoxel< 3, double >::New( dim, componentType );
 #endif
     /** Check if filter was instantiated. */
     bool supported = itktools::IsFilterSupportedCheck( filter, dim, componentType );
@@ -133,9 +217,11 @@ int main( int argc, char ** argv )
     /** Set the filter arguments. */
     filter->m_InputFileName = inputFileName;
     filter->m_OutputFileName = outputFileName;
-    filter->m_Voxel = voxel;
-    filter->m_Value = value;
+    filter->m_Voxels = voxels;
+    filter->m_Values = values;
+    filter->m_InPlace = inPlace;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
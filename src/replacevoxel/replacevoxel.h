@@ -19,9 +19,14 @@
 #define __replacevoxel_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsImageProperties.h"
+#include "ITKToolsMemoryMapping.h"
 
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
+#include <itksys/SystemTools.hxx>
+
+#include <fstream>
 
 
 /** \class ITKToolsReplaceVoxelBase
@@ -38,7 +43,7 @@ public:
   {
     this->m_InputFileName = "";
     this->m_OutputFileName = "";
-    this->m_Value = 0.0f;
+    this->m_InPlace = false;
   };
   /** Destructor. */
   ~ITKToolsReplaceVoxelBase(){};
@@ -46,8 +51,9 @@ public:
   /** Input member parameters. */
   std::string m_InputFileName;
   std::string m_OutputFileName;
-  std::vector<unsigned int> m_Voxel;
-  double m_Value;
+  std::vector< std::vector<unsigned int> > m_Voxels;
+  std::vector<double> m_Values;
+  bool m_InPlace;
 
 }; // end class ITKToolsReplaceVoxelBase
 
@@ -69,49 +75,136 @@ public:
   ITKToolsReplaceVoxel(){};
   ~ITKToolsReplaceVoxel(){};
 
+  /** Typedefs. */
+  typedef TComponentType                        PixelType;
+  typedef itk::Image< PixelType, VDimension >   ImageType;
+  typedef typename ImageType::SizeType          SizeType;
+  typedef typename ImageType::IndexType         IndexType;
+
   /** Run function. */
   void Run( void )
   {
-    typedef TComponentType                        PixelType;
-    typedef itk::Image< PixelType, VDimension >   ImageType;
-    typedef typename ImageType::SizeType          SizeType;
-    typedef typename ImageType::IndexType         IndexType;
+    /** Read the header, and check the voxels. */
+    itk::ImageIOBase::Pointer imageIOBase;
+    if( !itktools::GetImageIOBase( this->m_InputFileName, imageIOBase ) )
+    {
+      itkGenericExceptionMacro( << "ERROR: could not read " << this->m_InputFileName );
+    }
+
+    SizeType size;
+    for( unsigned int i = 0; i < VDimension; ++i )
+    {
+      size[ i ] = imageIOBase->GetDimensions( i );
+    }
+    for( std::size_t v = 0; v < this->m_Voxels.size(); ++v )
+    {
+      for( unsigned int i = 0; i < VDimension; ++i )
+      {
+        if( this->m_Voxels[ v ][ i ] > size[ i ] - 1 )
+        {
+          itkGenericExceptionMacro( << "ERROR: invalid voxel index." );
+        }
+      }
+    }
+
+    /** Patch the voxels in the file itself, if it is raw data. */
+    if( this->m_InPlace && this->PatchDataFile( imageIOBase, size ) )
+    {
+      return;
+    }
+
+    /** Otherwise read the input image. */
     typedef itk::ImageFileReader< ImageType >     ReaderType;
     typedef itk::ImageFileWriter< ImageType >     WriterType;
-
-    /** Read in the input image. */
     typename ReaderType::Pointer reader = ReaderType::New();
     typename WriterType::Pointer writer = WriterType::New();
-
-    /** Read input image. */
     reader->SetFileName( this->m_InputFileName );
     reader->Update();
     typename ImageType::Pointer image = reader->GetOutput();
 
-    /** Check size. */
-    SizeType size = image->GetLargestPossibleRegion().GetSize();
+    /** Set the values to the voxels. */
+    for( std::size_t v = 0; v < this->m_Voxels.size(); ++v )
+    {
+      image->SetPixel( this->GetIndex( v ), static_cast<PixelType>( this->m_Values[ v ] ) );
+    }
+
+    /** Write output image. */
+    writer->SetFileName( this->m_InPlace ? this->m_InputFileName : this->m_OutputFileName );
+    writer->SetInput( image );
+    writer->Update();
+
+  } // end Run()
+
+protected:
+
+  /** The index of voxel v. */
+  IndexType GetIndex( const std::size_t v ) const
+  {
+    IndexType index;
     for( unsigned int i = 0; i < VDimension; ++i )
     {
-      if( this->m_Voxel[ i ] < 0 || this->m_Voxel[ i ] > size[ i ] - 1 )
+      index[ i ] = this->m_Voxels[ v ][ i ];
+    }
+    return index;
+
+  } // end GetIndex()
+
+
+  /** Write the values at their offsets in the data file of an uncompressed
+   * MetaImage in the byte order of this machine, so that only the changed
+   * voxels are written. Returns false, without writing anything, for all
+   * other files.
+   */
+  bool PatchDataFile( itk::ImageIOBase * imageIOBase, const SizeType & size ) const
+  {
+    std::size_t numberOfPixels = 1;
+    for( unsigned int i = 0; i < VDimension; ++i )
+    {
+      numberOfPixels *= size[ i ];
+    }
+
+    const std::size_t dataSize = numberOfPixels * sizeof( PixelType );
+    std::string dataFileName = "";
+    std::size_t dataOffset = 0;
+    if( !itktools::GetMemoryMappableDataFile( this->m_InputFileName,
+      imageIOBase, dataSize, dataFileName, dataOffset ) )
+    {
+      return false;
+    }
+    if( itksys::SystemTools::FileLength( dataFileName.c_str() ) < dataOffset + dataSize )
+    {
+      return false;
+    }
+
+    std::fstream dataFile( dataFileName.c_str(),
+      std::ios::in | std::ios::out | std::ios::binary );
+    if( !dataFile.is_open() ) return false;
+
+    for( std::size_t v = 0; v < this->m_Voxels.size(); ++v )
+    {
+      /** The offset of the voxel in the buffer, first index fastest. */
+      std::size_t offset = 0;
+      std::size_t stride = 1;
+      for( unsigned int i = 0; i < VDimension; ++i )
       {
-        itkGenericExceptionMacro( << "ERROR: invalid voxel index." );
+        offset += this->m_Voxels[ v ][ i ] * stride;
+        stride *= size[ i ];
       }
+
+      const PixelType value = static_cast<PixelType>( this->m_Values[ v ] );
+      dataFile.seekp( static_cast<std::streamoff>( dataOffset + offset * sizeof( PixelType ) ) );
+      dataFile.write( reinterpret_cast<const char *>( &value ), sizeof( PixelType ) );
     }
 
-    /** Set the value to the voxel. */
-    IndexType index;
-    for( unsigned int i = 0; i < VDimension; ++i )
+    dataFile.close();
+    if( dataFile.fail() )
     {
-      index[ i ] = this->m_Voxel[ i ];
+      itkGenericExceptionMacro( << "ERROR: could not write the voxels to " << dataFileName );
     }
-    image->SetPixel( index, static_cast<PixelType>( this->m_Value ) );
 
-    /** Write output image. */
-    writer->SetFileName( this->m_OutputFileName );
-    writer->SetInput( image );
-    writer->Update();
+    return true;
 
-  } // end Run()
+  } // end PatchDataFile()
 
 }; // end class ITKToolsReplaceVoxel
 
@@ -0,0 +1,130 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkVectorComponentStatisticsImageFilter_h_
+#define __itkVectorComponentStatisticsImageFilter_h_
+
+#include "itkImageToImageFilter.h"
+#include <vector>
+
+
+namespace itk
+{
+
+/** \class VectorComponentStatisticsImageFilter
+ * \brief Compute the minimum, maximum, mean and sigma of every component
+ * of a vector image in one pass.
+ *
+ * The components of a pixel are adjacent in the buffer of a VectorImage,
+ * so the filter reads the buffer line by line and updates the statistics
+ * of all components from the same line, instead of extracting one scalar
+ * image per component. Every thread accumulates the extrema, the sum and
+ * the sum of squares of its region, which are merged after the threaded
+ * pass. The sigma is the unbiased one, as of the StatisticsImageFilter.
+ *
+ * The filter passes its input through unmodified.
+ */
+
+template< class TInputImage >
+class ITK_EXPORT VectorComponentStatisticsImageFilter :
+  public ImageToImageFilter< TInputImage, TInputImage >
+{
+public:
+  /** Standard Self typedef */
+  typedef VectorComponentStatisticsImageFilter  Self;
+  typedef ImageToImageFilter<
+    TInputImage, TInputImage >                  Superclass;
+  typedef SmartPointer<Self>                    Pointer;
+  typedef SmartPointer<const Self>              ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Runtime information support. */
+  itkTypeMacro( VectorComponentStatisticsImageFilter, ImageToImageFilter );
+
+  /** Image related typedefs. */
+  typedef TInputImage                                 InputImageType;
+  typedef typename InputImageType::Pointer            InputImagePointer;
+  typedef typename InputImageType::RegionType         RegionType;
+  typedef typename InputImageType::IndexType          IndexType;
+  typedef typename InputImageType::InternalPixelType  ComponentType;
+
+  itkStaticConstMacro( ImageDimension, unsigned int,
+    InputImageType::ImageDimension );
+
+  /** The statistics, one value per component. */
+  typedef std::vector<double>                         StatisticsType;
+
+  /** Get the results. */
+  const StatisticsType & GetMinimum( void ) const { return this->m_Minimum; }
+  const StatisticsType & GetMaximum( void ) const { return this->m_Maximum; }
+  const StatisticsType & GetMean( void ) const { return this->m_Mean; }
+  const StatisticsType & GetSigma( void ) const { return this->m_Sigma; }
+
+protected:
+  VectorComponentStatisticsImageFilter(){};
+  ~VectorComponentStatisticsImageFilter(){};
+  void PrintSelf( std::ostream& os, Indent indent ) const;
+
+  /** Pass the input through unmodified. */
+  void AllocateOutputs( void );
+
+  /** Initialize the partial results. */
+  void BeforeThreadedGenerateData( void );
+
+  /** Merge the partial results of the threads. */
+  void AfterThreadedGenerateData( void );
+
+  /** Multi-thread version GenerateData. */
+  void ThreadedGenerateData( const RegionType & outputRegionForThread,
+    ThreadIdType threadId );
+
+  /** The filter needs all of its input, and produces all of its output. */
+  void GenerateInputRequestedRegion( void );
+  void EnlargeOutputRequestedRegion( DataObject *data );
+
+private:
+  VectorComponentStatisticsImageFilter( const Self& ); // purposely not implemented
+  void operator=( const Self& ); // purposely not implemented
+
+  /** The partial results of one thread, one value per component. */
+  struct PartialType
+  {
+    std::vector<ComponentType>  Minimum;
+    std::vector<ComponentType>  Maximum;
+    std::vector<double>         Sum;
+    std::vector<double>         SumOfSquares;
+  };
+
+  std::vector< PartialType >  m_ThreadPartials;
+
+  StatisticsType  m_Minimum;
+  StatisticsType  m_Maximum;
+  StatisticsType  m_Mean;
+  StatisticsType  m_Sigma;
+
+}; // end class VectorComponentStatisticsImageFilter
+
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkVectorComponentStatisticsImageFilter.txx"
+#endif
+
+#endif // end #ifndef __itkVectorComponentStatisticsImageFilter_h_
@@ -0,0 +1,243 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkVectorComponentStatisticsImageFilter_txx_
+#define __itkVectorComponentStatisticsImageFilter_txx_
+
+#include "itkVectorComponentStatisticsImageFilter.h"
+
+#include "itkImageLinearConstIteratorWithIndex.h"
+#include "itkNumericTraits.h"
+#include "itkProgressReporter.h"
+#include "vnl/vnl_math.h"
+
+
+namespace itk
+{
+
+/**
+ * ********************* GenerateInputRequestedRegion ****************************
+ */
+
+template< class TInputImage >
+void
+VectorComponentStatisticsImageFilter< TInputImage >
+::GenerateInputRequestedRegion( void )
+{
+  Superclass::GenerateInputRequestedRegion();
+  if( this->GetInput() )
+  {
+    InputImagePointer image =
+      const_cast< InputImageType * >( this->GetInput() );
+    image->SetRequestedRegionToLargestPossibleRegion();
+  }
+
+} // end GenerateInputRequestedRegion()
+
+
+/**
+ * ********************* EnlargeOutputRequestedRegion ****************************
+ */
+
+template< class TInputImage >
+void
+VectorComponentStatisticsImageFilter< TInputImage >
+::EnlargeOutputRequestedRegion( DataObject * data )
+{
+  Superclass::EnlargeOutputRequestedRegion( data );
+  data->SetRequestedRegionToLargestPossibleRegion();
+
+} // end EnlargeOutputRequestedRegion()
+
+
+/**
+ * ********************* AllocateOutputs ****************************
+ */
+
+template< class TInputImage >
+void
+VectorComponentStatisticsImageFilter< TInputImage >
+::AllocateOutputs( void )
+{
+  /** Pass the input through as the output. */
+  InputImagePointer image = const_cast< InputImageType * >( this->GetInput() );
+  this->GraftOutput( image );
+
+} // end AllocateOutputs()
+
+
+/**
+ * ********************* BeforeThreadedGenerateData ****************************
+ */
+
+template< class TInputImage >
+void
+VectorComponentStatisticsImageFilter< TInputImage >
+::BeforeThreadedGenerateData( void )
+{
+  const unsigned int numberOfComponents
+    = this->GetInput()->GetNumberOfComponentsPerPixel();
+
+  PartialType partial;
+  partial.Minimum.assign( numberOfComponents, NumericTraits<ComponentType>::max() );
+  partial.Maximum.assign( numberOfComponents, NumericTraits<ComponentType>::NonpositiveMin() );
+  partial.Sum.assign( numberOfComponents, 0.0 );
+  partial.SumOfSquares.assign( numberOfComponents, 0.0 );
+
+  this->m_ThreadPartials.assign( this->GetNumberOfThreads(), partial );
+
+} // end BeforeThreadedGenerateData()
+
+
+/**
+ * ********************* ThreadedGenerateData ****************************
+ *
+ * A line of the region is a contiguous run of lineLength * numberOfComponents
+ * values in the buffer, which are read once for all components.
+ */
+
+template< class TInputImage >
+void
+VectorComponentStatisticsImageFilter< TInputImage >
+::ThreadedGenerateData( const RegionType & outputRegionForThread,
+  ThreadIdType threadId )
+{
+  const InputImageType * input = this->GetInput();
+  const unsigned int numberOfComponents = input->GetNumberOfComponentsPerPixel();
+  const ComponentType * buffer = input->GetBufferPointer();
+  const SizeValueType lineLength = outputRegionForThread.GetSize()[ 0 ];
+  PartialType & partial = this->m_ThreadPartials[ threadId ];
+
+  /** Local copies, so that the inner loop does not go through the vectors. */
+  std::vector<ComponentType> minimum( partial.Minimum );
+  std::vector<ComponentType> maximum( partial.Maximum );
+  std::vector<double> sum( numberOfComponents, 0.0 );
+  std::vector<double> sumOfSquares( numberOfComponents, 0.0 );
+
+  ProgressReporter progress( this, threadId,
+    outputRegionForThread.GetNumberOfPixels() / lineLength );
+
+  typedef ImageLinearConstIteratorWithIndex< InputImageType > IteratorType;
+  IteratorType it( input, outputRegionForThread );
+  it.SetDirection( 0 );
+  it.GoToBegin();
+
+  while( !it.IsAtEnd() )
+  {
+    const ComponentType * line = buffer
+      + input->ComputeOffset( it.GetIndex() ) * numberOfComponents;
+    for( SizeValueType i = 0; i < lineLength; ++i )
+    {
+      for( unsigned int c = 0; c < numberOfComponents; ++c, ++line )
+      {
+        const ComponentType value = *line;
+        if( value < minimum[ c ] ) minimum[ c ] = value;
+        if( value > maximum[ c ] ) maximum[ c ] = value;
+        const double realValue = static_cast<double>( value );
+        sum[ c ] += realValue;
+        sumOfSquares[ c ] += realValue * realValue;
+      }
+    }
+
+    progress.CompletedPixel();
+    it.NextLine();
+  }
+
+  partial.Minimum = minimum;
+  partial.Maximum = maximum;
+  partial.Sum = sum;
+  partial.SumOfSquares = sumOfSquares;
+
+} // end ThreadedGenerateData()
+
+
+/**
+ * ********************* AfterThreadedGenerateData ****************************
+ */
+
+template< class TInputImage >
+void
+VectorComponentStatisticsImageFilter< TInputImage >
+::AfterThreadedGenerateData( void )
+{
+  const unsigned int numberOfComponents
+    = this->GetInput()->GetNumberOfComponentsPerPixel();
+  const double numberOfPixels = static_cast<double>(
+    this->GetInput()->GetLargestPossibleRegion().GetNumberOfPixels() );
+
+  this->m_Minimum.assign( numberOfComponents, 0.0 );
+  this->m_Maximum.assign( numberOfComponents, 0.0 );
+  this->m_Mean.assign( numberOfComponents, 0.0 );
+  this->m_Sigma.assign( numberOfComponents, 0.0 );
+
+  for( unsigned int c = 0; c < numberOfComponents; ++c )
+  {
+    ComponentType minimum = this->m_ThreadPartials[ 0 ].Minimum[ c ];
+    ComponentType maximum = this->m_ThreadPartials[ 0 ].Maximum[ c ];
+    double sum = 0.0;
+    double sumOfSquares = 0.0;
+    for( std::size_t t = 0; t < this->m_ThreadPartials.size(); ++t )
+    {
+      const PartialType & partial = this->m_ThreadPartials[ t ];
+      if( partial.Minimum[ c ] < minimum ) minimum = partial.Minimum[ c ];
+      if( partial.Maximum[ c ] > maximum ) maximum = partial.Maximum[ c ];
+      sum += partial.Sum[ c ];
+      sumOfSquares += partial.SumOfSquares[ c ];
+    }
+
+    const double mean = sum / numberOfPixels;
+    double variance = 0.0;
+    if( numberOfPixels > 1.0 )
+    {
+      variance = ( sumOfSquares - sum * sum / numberOfPixels ) / ( numberOfPixels - 1.0 );
+    }
+
+    this->m_Minimum[ c ] = static_cast<double>( minimum );
+    this->m_Maximum[ c ] = static_cast<double>( maximum );
+    this->m_Mean[ c ] = mean;
+    this->m_Sigma[ c ] = variance > 0.0 ? vcl_sqrt( variance ) : 0.0;
+  }
+
+  this->m_ThreadPartials.clear();
+
+} // end AfterThreadedGenerateData()
+
+
+/**
+ * ********************* PrintSelf ****************************
+ */
+
+template< class TInputImage >
+void
+VectorComponentStatisticsImageFilter< TInputImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  for( std::size_t c = 0; c < this->m_Minimum.size(); ++c )
+  {
+    os << indent << "Component " << c << ": minimum " << this->m_Minimum[ c ]
+      << ", maximum " << this->m_Maximum[ c ]
+      << ", mean " << this->m_Mean[ c ]
+      << ", sigma " << this->m_Sigma[ c ] << std::endl;
+  }
+
+} // end PrintSelf()
+
+} // end namespace itk
+
+#endif // end #ifndef __itkVectorComponentStatisticsImageFilter_txx_
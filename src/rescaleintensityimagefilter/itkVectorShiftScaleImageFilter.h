@@ -0,0 +1,106 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkVectorShiftScaleImageFilter_h_
+#define __itkVectorShiftScaleImageFilter_h_
+
+#include "itkInPlaceImageFilter.h"
+#include <vector>
+
+
+namespace itk
+{
+
+/** \class VectorShiftScaleImageFilter
+ * \brief Map every component c of a vector image linearly, to
+ * value * Scale[c] + Shift[c].
+ *
+ * All components are mapped in one pass over the buffer, line by line.
+ * The result is clamped to the range of the pixel type and cast, as by
+ * the ShiftScaleImageFilter. The filter can run in place.
+ *
+ * \ingroup IntensityImageFilters MultiThreaded
+ */
+
+template< class TImage >
+class ITK_EXPORT VectorShiftScaleImageFilter :
+  public InPlaceImageFilter< TImage, TImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef VectorShiftScaleImageFilter           Self;
+  typedef InPlaceImageFilter< TImage, TImage >  Superclass;
+  typedef SmartPointer<Self>                    Pointer;
+  typedef SmartPointer<const Self>              ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( VectorShiftScaleImageFilter, InPlaceImageFilter );
+
+  /** Typedefs. */
+  typedef TImage                                      ImageType;
+  typedef typename ImageType::InternalPixelType       ComponentType;
+  typedef typename Superclass::OutputImageRegionType  OutputImageRegionType;
+  typedef std::vector<double>                         ParametersType;
+
+  itkStaticConstMacro( ImageDimension, unsigned int, TImage::ImageDimension );
+
+  /** Set/Get the scale and the shift, one value per component. */
+  void SetScale( const ParametersType & scale )
+  {
+    this->m_Scale = scale; this->Modified();
+  }
+  const ParametersType & GetScale( void ) const { return this->m_Scale; }
+  void SetShift( const ParametersType & shift )
+  {
+    this->m_Shift = shift; this->Modified();
+  }
+  const ParametersType & GetShift( void ) const { return this->m_Shift; }
+
+protected:
+  VectorShiftScaleImageFilter();
+  virtual ~VectorShiftScaleImageFilter() {};
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** The output has as many components as the input. */
+  virtual void GenerateOutputInformation( void );
+
+  /** Check the number of parameters. */
+  virtual void BeforeThreadedGenerateData( void );
+
+  /** Map the lines of the region of a thread. */
+  void ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+    ThreadIdType threadId );
+
+private:
+  VectorShiftScaleImageFilter( const Self & ); // purposely not implemented
+  void operator=( const Self & );              // purposely not implemented
+
+  ParametersType  m_Scale;
+  ParametersType  m_Shift;
+
+}; // end class VectorShiftScaleImageFilter
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkVectorShiftScaleImageFilter.txx"
+#endif
+
+#endif // end #ifndef __itkVectorShiftScaleImageFilter_h_
@@ -0,0 +1,157 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkVectorShiftScaleImageFilter_txx_
+#define __itkVectorShiftScaleImageFilter_txx_
+
+#include "itkVectorShiftScaleImageFilter.h"
+
+#include "itkImageLinearConstIteratorWithIndex.h"
+#include "itkNumericTraits.h"
+#include "itkProgressReporter.h"
+
+
+namespace itk
+{
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template< class TImage >
+VectorShiftScaleImageFilter< TImage >
+::VectorShiftScaleImageFilter()
+{
+  this->InPlaceOff();
+
+} // end Constructor
+
+
+/**
+ * ******************* GenerateOutputInformation *******************
+ */
+
+template< class TImage >
+void
+VectorShiftScaleImageFilter< TImage >
+::GenerateOutputInformation( void )
+{
+  Superclass::GenerateOutputInformation();
+
+  this->GetOutput()->SetNumberOfComponentsPerPixel(
+    this->GetInput()->GetNumberOfComponentsPerPixel() );
+
+} // end GenerateOutputInformation()
+
+
+/**
+ * ******************* BeforeThreadedGenerateData *******************
+ */
+
+template< class TImage >
+void
+VectorShiftScaleImageFilter< TImage >
+::BeforeThreadedGenerateData( void )
+{
+  const unsigned int numberOfComponents
+    = this->GetInput()->GetNumberOfComponentsPerPixel();
+  if( this->m_Scale.size() != numberOfComponents
+    || this->m_Shift.size() != numberOfComponents )
+  {
+    itkExceptionMacro( << "The scale and the shift should have "
+      << numberOfComponents << " values, one per component." );
+  }
+
+} // end BeforeThreadedGenerateData()
+
+
+/**
+ * ******************* ThreadedGenerateData *******************
+ */
+
+template< class TImage >
+void
+VectorShiftScaleImageFilter< TImage >
+::ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+  ThreadIdType threadId )
+{
+  const ImageType * input = this->GetInput();
+  ImageType * output = this->GetOutput();
+  const unsigned int numberOfComponents = input->GetNumberOfComponentsPerPixel();
+  const ComponentType * inputBuffer = input->GetBufferPointer();
+  ComponentType * outputBuffer = output->GetBufferPointer();
+  const SizeValueType lineLength = outputRegionForThread.GetSize()[ 0 ];
+
+  const double lowest = static_cast<double>( NumericTraits<ComponentType>::NonpositiveMin() );
+  const double highest = static_cast<double>( NumericTraits<ComponentType>::max() );
+  const std::vector<double> scale( this->m_Scale );
+  const std::vector<double> shift( this->m_Shift );
+
+  ProgressReporter progress( this, threadId,
+    outputRegionForThread.GetNumberOfPixels() / lineLength );
+
+  typedef ImageLinearConstIteratorWithIndex< ImageType > IteratorType;
+  IteratorType it( input, outputRegionForThread );
+  it.SetDirection( 0 );
+  it.GoToBegin();
+
+  while( !it.IsAtEnd() )
+  {
+    const ComponentType * in = inputBuffer
+      + input->ComputeOffset( it.GetIndex() ) * numberOfComponents;
+    ComponentType * out = outputBuffer
+      + output->ComputeOffset( it.GetIndex() ) * numberOfComponents;
+    for( SizeValueType i = 0; i < lineLength; ++i )
+    {
+      for( unsigned int c = 0; c < numberOfComponents; ++c, ++in, ++out )
+      {
+        double value = static_cast<double>( *in ) * scale[ c ] + shift[ c ];
+        if( value < lowest ) value = lowest;
+        else if( value > highest ) value = highest;
+        *out = static_cast<ComponentType>( value );
+      }
+    }
+
+    progress.CompletedPixel();
+    it.NextLine();
+  }
+
+} // end ThreadedGenerateData()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template< class TImage >
+void
+VectorShiftScaleImageFilter< TImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  for( std::size_t c = 0; c < this->m_Scale.size(); ++c )
+  {
+    os << indent << "Component " << c << ": scale " << this->m_Scale[ c ]
+      << ", shift " << this->m_Shift[ c ] << std::endl;
+  }
+
+} // end PrintSelf()
+
+} // end namespace itk
+
+#endif // end #ifndef __itkVectorShiftScaleImageFilter_txx_
@@ -45,9 +45,15 @@ std::string GetHelpString( void )
     << "  [-mv]    mean variance, default: 0.0 1.0\n"
     << "  [-opct]  pixel type of input and output images;\n"
     << "           default: automatically determined from the first input image.\n"
+    << "  [-cache] take the minimum, maximum, mean and sigma of the input from the\n"
+    << "           statistics file in + .statistics, shared with pxstatisticsonimage,\n"
+    << "           pxthresholdimage, pxhistogramequalizeimage and pxintensitywindowing,\n"
+    << "           as long as the input did not change; otherwise store them there.\n"
     << "Either \"-mm\" or \"-mv\" need to be specified.\n"
     << "Supported: 2D, 3D, (unsigned) char, (unsigned) short, (unsigned) int, float.\n"
-    << "When applied to vector images, this program performs the operation on each channel separately.";
+    << "When applied to vector images, this program performs the operation on each channel separately.\n"
+    << "The statistics of all channels are computed in one pass over the image,\n"
+    << "and all channels are rescaled in one pass, in place.";
 
   return ss.str();
 
@@ -97,6 +103,8 @@ int main( int argc, char **argv )
   meanvariance[ 1 ] = 1.0;
   bool retmv = parser->GetCommandLineArgument( "-mv", meanvariance );
 
+  const bool useCacheFile = parser->ArgumentExists( "-cache" );
+
   /** Check if the extrema are given (correctly). */
   if( retmm )
   {
@@ -197,7 +205,9 @@ int main( int argc, char **argv )
     filter->m_OutputFileName = outputFileName;
     filter->m_Values = values;
     filter->m_ValuesAreExtrema = valuesAreExtrema;
+    filter->m_UseCacheFile = useCacheFile;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
@@ -19,15 +19,14 @@
 #define __rescaleintensityimagefilter_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsStatisticsCache.h"
 
-#include "itkImage.h"
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
-#include "itkImageToVectorImageFilter.h"
-#include "itkRescaleIntensityImageFilter.h"
-#include "itkShiftScaleImageFilter.h"
-#include "itkStatisticsImageFilter.h"
-#include "itkVectorIndexSelectionCastImageFilter.h"
+#include "itkImageIOBase.h"
+#include "itkVectorComponentStatisticsImageFilter.h"
+#include "itkVectorImage.h"
+#include "itkVectorShiftScaleImageFilter.h"
 
 #include "vnl/vnl_math.h"
 
@@ -47,6 +46,7 @@ public:
     this->m_InputFileName = "";
     this->m_OutputFileName = "";
     this->m_ValuesAreExtrema = false;
+    this->m_UseCacheFile = false;
   };
   /** Destructor. */
   ~ITKToolsRescaleIntensityImageFilterBase(){};
@@ -56,6 +56,7 @@ public:
   std::string m_OutputFileName;
   std::vector<double> m_Values;
   bool m_ValuesAreExtrema;
+  bool m_UseCacheFile;
 
 }; // end class ITKToolsRescaleIntensityImageFilterBase
 
@@ -81,106 +82,116 @@ public:
   void Run( void )
   {
     /** TYPEDEF's. */
-    typedef itk::Image<TComponentType, VDimension>        ScalarImageType;
     typedef itk::VectorImage<TComponentType, VDimension>  VectorImageType;
 
     typedef itk::ImageFileReader< VectorImageType >       ReaderType;
-    typedef itk::RescaleIntensityImageFilter<
-      ScalarImageType, ScalarImageType >                  RescalerType;
-    typedef itk::StatisticsImageFilter< ScalarImageType > StatisticsType;
-    typedef itk::ShiftScaleImageFilter<
-      ScalarImageType, ScalarImageType >                  ShiftScalerType;
+    typedef itk::VectorComponentStatisticsImageFilter<
+      VectorImageType >                                   StatisticsType;
+    typedef itk::VectorShiftScaleImageFilter<
+      VectorImageType >                                   ShiftScalerType;
     typedef itk::ImageFileWriter< VectorImageType >       WriterType;
-    typedef typename ScalarImageType::PixelType           PixelType;
-    typedef typename StatisticsType::RealType             RealType;
 
     /** DECLARATION'S. */
     typename ReaderType::Pointer reader = ReaderType::New();
     typename WriterType::Pointer writer = WriterType::New();
-    typename RescalerType::Pointer    filter;
-    typename StatisticsType::Pointer  statistics;
-    typename ShiftScalerType::Pointer shiftscaler;
+    typename ShiftScalerType::Pointer shiftscaler = ShiftScalerType::New();
 
     /** Read in the inputImage. */
     reader->SetFileName( this->m_InputFileName.c_str() );
     reader->Update();
-
-    // Setup type to disassemble the components
-    typedef itk::VectorIndexSelectionCastImageFilter<VectorImageType, ScalarImageType> IndexSelectionType;
-
-    // Setup the filter to reassemble the components
-    typedef itk::ImageToVectorImageFilter<ScalarImageType> ImageToVectorImageFilterType;
-    typename ImageToVectorImageFilterType::Pointer imageToVectorImageFilter = ImageToVectorImageFilterType::New();
-
-    for( unsigned int component = 0; component < reader->GetOutput()->GetNumberOfComponentsPerPixel(); ++component)
+    const unsigned int numberOfComponents
+      = reader->GetOutput()->GetNumberOfComponentsPerPixel();
+
+    /** Compute the statistics of all components in one pass,
+     * unless they are in the cache file.
+     */
+    itktools::ImageStatistics cachedStatistics;
+    std::vector<double> minimum, maximum, mean, sigma;
+    if( this->m_UseCacheFile && itktools::ReadStatisticsCache( this->m_InputFileName,
+      itktools::GetReadComponentType<VectorImageType>(), cachedStatistics )
+      && cachedStatistics.Minimum.size() == numberOfComponents )
+    {
+      minimum = cachedStatistics.Minimum;
+      maximum = cachedStatistics.Maximum;
+      mean = cachedStatistics.Mean;
+      sigma = cachedStatistics.Sigma;
+    }
+    else
+    {
+      typename StatisticsType::Pointer statistics = StatisticsType::New();
+      statistics->SetInput( reader->GetOutput() );
+      statistics->Update();
+      minimum = statistics->GetMinimum();
+      maximum = statistics->GetMaximum();
+      mean = statistics->GetMean();
+      sigma = statistics->GetSigma();
+
+      if( this->m_UseCacheFile )
+      {
+        itktools::ImageStatistics imageStatistics;
+        imageStatistics.NumberOfPixels = static_cast<double>(
+          reader->GetOutput()->GetLargestPossibleRegion().GetNumberOfPixels() );
+        imageStatistics.Minimum = minimum;
+        imageStatistics.Maximum = maximum;
+        imageStatistics.Mean = mean;
+        imageStatistics.Sigma = sigma;
+        itktools::WriteStatisticsCache( this->m_InputFileName,
+          reader->GetOutput(), imageStatistics );
+      }
+    }
+
+    /** If the input values are extrema (minimum and maximum), then the
+     * components are mapped linearly to that range, as by the
+     * RescaleIntensityImageFilter. Otherwise, the values represent the
+     * desired mean and variance, and the components are shifted and scaled
+     * to get those.
+     */
+    std::vector<double> scale( numberOfComponents, 0.0 );
+    std::vector<double> shift( numberOfComponents, 0.0 );
+    for( unsigned int c = 0; c < numberOfComponents; ++c )
     {
-      typename IndexSelectionType::Pointer indexSelectionFilter = IndexSelectionType::New();
-      indexSelectionFilter->SetIndex(component);
-      indexSelectionFilter->SetInput(reader->GetOutput());
-      indexSelectionFilter->Update();
-
-      /** If the input values are extrema (minimum and maximum),
-       * then an IntensityRescaler is used. Otherwise, the values represent
-       * the desired mean and variance and a ShiftScaler is used.
-       */
       if( this->m_ValuesAreExtrema )
       {
-        /** Create instance. */
-        filter = RescalerType::New();
-
         /** Define the extrema. */
-        PixelType min, max;
+        double min, max;
         if( this->m_Values[ 0 ] == 0.0 && this->m_Values[ 1 ] == 0.0 )
         {
-          min = itk::NumericTraits<PixelType>::NonpositiveMin();
-          max = itk::NumericTraits<PixelType>::max();
+          min = static_cast<double>( itk::NumericTraits<TComponentType>::NonpositiveMin() );
+          max = static_cast<double>( itk::NumericTraits<TComponentType>::max() );
         }
         else
         {
-          min = static_cast<PixelType>( this->m_Values[ 0 ] );
-          max = static_cast<PixelType>( this->m_Values[ 1 ] );
+          min = static_cast<double>( static_cast<TComponentType>( this->m_Values[ 0 ] ) );
+          max = static_cast<double>( static_cast<TComponentType>( this->m_Values[ 1 ] ) );
         }
 
-        /** Setup the filter. */
-        filter->SetInput( indexSelectionFilter->GetOutput() );
-        filter->SetOutputMinimum( min );
-        filter->SetOutputMaximum( max );
-        filter->Update();
-
-        /** Setup the recombining. */
-        imageToVectorImageFilter->SetNthInput(component, filter->GetOutput());
+        if( minimum[ c ] != maximum[ c ] )
+        {
+          scale[ c ] = ( max - min ) / ( maximum[ c ] - minimum[ c ] );
+        }
+        else if( maximum[ c ] != 0.0 )
+        {
+          scale[ c ] = ( max - min ) / maximum[ c ];
+        }
+        shift[ c ] = min - minimum[ c ] * scale[ c ];
 
       } // end if values are extrema
       else
       {
-        /** Create instances. */
-        statistics = StatisticsType::New();
-        shiftscaler = ShiftScalerType::New();
-
-        /** Calculate image statistics. */
-        statistics->SetInput( indexSelectionFilter->GetOutput() );
-        statistics->Update();
-
-        /** Get mean and variance of input image. */
-        RealType mean = statistics->GetMean();
-        RealType sigma = statistics->GetSigma();
-
-        /** Setup the shiftscaler. */
-        shiftscaler->SetInput( indexSelectionFilter->GetOutput() );
-        shiftscaler->SetShift( this->m_Values[ 0 ] * sigma / vcl_sqrt( this->m_Values[ 1 ] ) - mean );
-        shiftscaler->SetScale( vcl_sqrt( this->m_Values[ 1 ] ) / sigma );
-        shiftscaler->Update();
-
-        /** Setup the recombining. */
-        imageToVectorImageFilter->SetNthInput(component, shiftscaler->GetOutput());
+        scale[ c ] = vcl_sqrt( this->m_Values[ 1 ] ) / sigma[ c ];
+        shift[ c ] = this->m_Values[ 0 ] - mean[ c ] * scale[ c ];
 
       } // end if values are mean and variance
-    }// end component loop
+    } // end component loop
 
-    imageToVectorImageFilter->Update();
-    writer->SetInput(imageToVectorImageFilter->GetOutput());
+    /** Rescale all components in one pass, in the buffer of the reader. */
+    shiftscaler->SetInput( reader->GetOutput() );
+    shiftscaler->SetScale( scale );
+    shiftscaler->SetShift( shift );
+    shiftscaler->InPlaceOn();
 
     /** Write the output image. */
+    writer->SetInput( shiftscaler->GetOutput() );
     writer->SetFileName( this->m_OutputFileName.c_str() );
     writer->Update();
 
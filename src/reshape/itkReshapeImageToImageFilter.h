@@ -65,6 +65,15 @@ public:
   /***/
   itkSetMacro( OutputSize, SizeType );
 
+  /** Let the output share the pixel buffer of the input, instead of copying
+   * it, if the number of pixels does not change. The reshape then takes no
+   * time and no memory. Since the input and output use the same buffer, a
+   * change of one changes the other. Default false.
+   */
+  itkSetMacro( ShareInputBuffer, bool );
+  itkGetConstMacro( ShareInputBuffer, bool );
+  itkBooleanMacro( ShareInputBuffer );
+
   /** FlipImageFilter produces an image with different origin and
    * direction than the input image. As such, FlipImageFilter needs to
    * provide an implementation for GenerateOutputInformation() in
@@ -111,6 +120,7 @@ private:
 
   /** Private variables. */
   SizeType  m_OutputSize;
+  bool      m_ShareInputBuffer;
 
 }; // end class ReshapeImageToImageFilter
 
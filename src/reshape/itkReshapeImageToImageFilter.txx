@@ -33,6 +33,7 @@ ReshapeImageToImageFilter< TInputImage >
 {
   this->m_OutputSize.Fill( NumericTraits<
     typename SizeType::SizeValueType>::Zero );
+  this->m_ShareInputBuffer = false;
 
 } // end Constructor()
 
@@ -108,10 +109,6 @@ ReshapeImageToImageFilter< TInputImage >
   ImageConstPointer input = this->GetInput();
   ImagePointer output = this->GetOutput();
 
-  /** Allocate memory. */
-  output->Allocate();
-  output->FillBuffer( NumericTraits<ImagePixelType>::Zero );
-
   /** Get the number of pixels. */
   unsigned long numVoxelsInput = input->GetLargestPossibleRegion().GetNumberOfPixels();
   unsigned long numVoxelsOutput = 1;
@@ -121,6 +118,20 @@ ReshapeImageToImageFilter< TInputImage >
   }
   unsigned long minVoxels = numVoxelsInput < numVoxelsOutput ? numVoxelsInput : numVoxelsOutput;
 
+  /** Only the size changes, so the output can use the input buffer. */
+  if( this->m_ShareInputBuffer && numVoxelsInput == numVoxelsOutput
+    && input->GetBufferedRegion() == input->GetLargestPossibleRegion() )
+  {
+    output->SetBufferedRegion( output->GetLargestPossibleRegion() );
+    output->SetPixelContainer(
+      const_cast< TInputImage * >( input.GetPointer() )->GetPixelContainer() );
+    return;
+  }
+
+  /** Allocate memory. */
+  output->Allocate();
+  output->FillBuffer( NumericTraits<ImagePixelType>::Zero );
+
   /** Copy pixels. */
   memcpy( output->GetBufferPointer(), input->GetBufferPointer(),
     sizeof( ImagePixelType ) * minVoxels );
@@ -142,6 +153,7 @@ ReshapeImageToImageFilter< TInputImage >
 
   /** Print the member variables. */
   os << indent << "OutputSize: " << this->m_OutputSize << std::endl;
+  os << indent << "ShareInputBuffer: " << this->m_ShareInputBuffer << std::endl;
 
 } // end PrintSelf()
 
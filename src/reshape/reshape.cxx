@@ -43,6 +43,9 @@ std::string GetHelpString( void )
     << "  -in      inputFilename\n"
     << "  [-out]   outputFileName, default inputFileName_reshaped\n"
     << "  -s       size of the output image\n"
+    << "  [-header] write only a new header, that refers to the data of the input;\n"
+    << "           for an uncompressed mhd input and output, with the same\n"
+    << "           number of pixels\n"
     << "Supported: 2D, 3D, (unsigned) char, (unsigned) short, (unsigned) int, (unsigned) long, float, double.";
 
   return ss.str();
@@ -88,6 +91,8 @@ int main( int argc, char **argv )
   std::vector<unsigned long> outputSize;
   parser->GetCommandLineArgument( "-s", outputSize );
 
+  bool headerOnly = parser->ArgumentExists( "-header" );
+
   /** Determine image properties. */
   itk::ImageIOBase::IOPixelType pixelType = itk::ImageIOBase::UNKNOWNPIXELTYPE;
   itk::ImageIOBase::IOComponentType componentType = itk::ImageIOBase::UNKNOWNCOMPONENTTYPE;
@@ -146,7 +151,9 @@ int main( int argc, char **argv )
     filter->m_InputFileName = inputFileName;
     filter->m_OutputFileName = outputFileName;
     filter->m_OutputSize = outputSize;
+    filter->m_HeaderOnly = headerOnly;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
@@ -24,6 +24,8 @@
 #include "itkReshapeImageToImageFilter.h"
 #include "itkImageFileWriter.h"
 #include <itksys/SystemTools.hxx>
+#include <fstream>
+#include <sstream>
 
 
 /** \class ITKToolsUnaryImageOperatorBase
@@ -40,6 +42,7 @@ public:
   {
     this->m_InputFileName = "";
     this->m_OutputFileName = "";
+    this->m_HeaderOnly = false;
   };
   /** Destructor. */
   ~ITKToolsReshapeBase(){};
@@ -48,6 +51,94 @@ public:
   std::string m_InputFileName;
   std::string m_OutputFileName;
   std::vector<unsigned long> m_OutputSize;
+  bool m_HeaderOnly;
+
+  /** For an uncompressed mhd input with a separate data file and an mhd
+   * output, write only a header with the new size, that refers to the data
+   * file of the input. Returns false if that is not possible.
+   */
+  bool WriteHeaderOnly( void ) const
+  {
+    typedef itksys::SystemTools ST;
+    if( ST::LowerCase( ST::GetFilenameLastExtension( this->m_InputFileName ) ) != ".mhd"
+      || ST::LowerCase( ST::GetFilenameLastExtension( this->m_OutputFileName ) ) != ".mhd" )
+    {
+      return false;
+    }
+
+    /** Read the header, and check the data file and the number of pixels. */
+    std::ifstream input( this->m_InputFileName.c_str() );
+    if( !input.is_open() ) return false;
+    std::vector<std::string> lines;
+    std::string line;
+    std::size_t dimSizeLine = 0, dataFileLine = 0;
+    std::string dataFile = "";
+    unsigned long numberOfPixels = 0;
+    while( std::getline( input, line ) )
+    {
+      const std::string::size_type eq = line.find( '=' );
+      const std::string key = eq == std::string::npos ? ""
+        : ST::TrimWhitespace( line.substr( 0, eq ) );
+      const std::string value = eq == std::string::npos ? ""
+        : ST::TrimWhitespace( line.substr( eq + 1 ) );
+      if( key == "CompressedData" && ST::LowerCase( value ) == "true" )
+      {
+        return false;
+      }
+      else if( key == "DimSize" )
+      {
+        std::istringstream dims( value );
+        unsigned long d = 0;
+        numberOfPixels = 1;
+        while( dims >> d ) numberOfPixels *= d;
+        dimSizeLine = lines.size();
+      }
+      else if( key == "ElementDataFile" )
+      {
+        dataFile = value;
+        dataFileLine = lines.size();
+      }
+      lines.push_back( line );
+    }
+
+    unsigned long numberOfOutputPixels = 1;
+    for( std::size_t i = 0; i < this->m_OutputSize.size(); ++i )
+    {
+      numberOfOutputPixels *= this->m_OutputSize[ i ];
+    }
+    if( dataFile.empty() || ST::LowerCase( dataFile ) == "local"
+      || ST::LowerCase( dataFile ) == "list" || dataFile.find( '%' ) != std::string::npos
+      || numberOfPixels != numberOfOutputPixels )
+    {
+      return false;
+    }
+
+    /** Refer to the data file relative to the directory of the output. */
+    const std::string inputDirectory = ST::GetFilenamePath(
+      ST::CollapseFullPath( this->m_InputFileName.c_str() ) );
+    const std::string outputDirectory = ST::GetFilenamePath(
+      ST::CollapseFullPath( this->m_OutputFileName.c_str() ) );
+    const std::string fullDataFile = ST::CollapseFullPath( dataFile.c_str(), inputDirectory.c_str() );
+    std::ostringstream dimSize;
+    dimSize << "DimSize =";
+    for( std::size_t i = 0; i < this->m_OutputSize.size(); ++i )
+    {
+      dimSize << " " << this->m_OutputSize[ i ];
+    }
+    lines[ dimSizeLine ] = dimSize.str();
+    lines[ dataFileLine ] = "ElementDataFile = "
+      + ST::RelativePath( outputDirectory.c_str(), fullDataFile.c_str() );
+
+    /** Write the new header. */
+    std::ofstream output( this->m_OutputFileName.c_str() );
+    if( !output.is_open() ) return false;
+    for( std::size_t i = 0; i < lines.size(); ++i )
+    {
+      output << lines[ i ] << "\n";
+    }
+    return output.good();
+
+  } // end WriteHeaderOnly()
 
 }; // end class ITKToolsReshapeBase
 
@@ -86,14 +177,24 @@ public:
       size[ i ] = this->m_OutputSize[ i ];
     }
 
+    /** Only write a new header, if requested and possible. */
+    if( this->m_HeaderOnly )
+    {
+      if( this->WriteHeaderOnly() ) return;
+      std::cerr << "WARNING: only a new header can be written for an "
+        << "uncompressed mhd input and output with the same number of "
+        << "pixels. The data is copied instead." << std::endl;
+    }
+
     /** Reader. */
     typename ReaderType::Pointer reader = ReaderType::New();
     reader->SetFileName( this->m_InputFileName.c_str() );
 
-    /** Reshaper. */
+    /** Reshaper. The output uses the buffer of the input, no copy is made. */
     typename ReshapeFilterType::Pointer reshaper = ReshapeFilterType::New();
     reshaper->SetInput( reader->GetOutput() );
     reshaper->SetOutputSize( size );
+    reshaper->ShareInputBufferOn();
     reshaper->Update();
 
     /** Writer. */
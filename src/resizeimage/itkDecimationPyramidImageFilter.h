@@ -0,0 +1,162 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkDecimationPyramidImageFilter_h_
+#define __itkDecimationPyramidImageFilter_h_
+
+#include "itkImageToImageFilter.h"
+#include "itkFixedArray.h"
+#include <vector>
+
+namespace itk
+{
+
+/** \class DecimationPyramidImageFilter
+ * \brief Compute all levels of an image pyramid in one pass, each level
+ * from the previous one, with an integer shrink factor per axis.
+ *
+ * Output k is the input shrunk k + 1 times by the ShrinkFactors, so that
+ * it has the size floor( n / f^(k+1) ), at least 1, and the spacing
+ * s f^(k+1). A voxel of a level is at the center of the block of f voxels
+ * of the previous level it replaces, so the origin of a level is shifted
+ * by ( f - 1 ) / 2 voxels of the previous level, along the direction of
+ * the input. The start index of every level is 0.
+ *
+ * The decimation kernel is either
+ *   - Block: the mean of the block of f voxels along an axis, a box
+ *     filter followed by subsampling,
+ *   - Gaussian: a Gaussian with sigma f / 2 voxels around the center of
+ *     the block, truncated at 3 sigma, normalized, and clamped at the
+ *     border of the image.
+ * Both are separable: a level is computed in one pass per shrunk axis,
+ * in parallel over the lines, with the weights of an axis computed once.
+ * The levels are cascaded in a buffer of doubles, so that integer pixel
+ * types are only rounded once per level, for the output.
+ *
+ * \ingroup MultiResolution
+ */
+
+template< class TInputImage, class TOutputImage >
+class ITK_EXPORT DecimationPyramidImageFilter :
+  public ImageToImageFilter< TInputImage, TOutputImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef DecimationPyramidImageFilter    Self;
+  typedef ImageToImageFilter<
+    TInputImage, TOutputImage >           Superclass;
+  typedef SmartPointer<Self>              Pointer;
+  typedef SmartPointer<const Self>        ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( DecimationPyramidImageFilter, ImageToImageFilter );
+
+  itkStaticConstMacro( ImageDimension, unsigned int, TInputImage::ImageDimension );
+
+  /** Typedefs. */
+  typedef TInputImage                                 InputImageType;
+  typedef TOutputImage                                OutputImageType;
+  typedef typename OutputImageType::PixelType         OutputPixelType;
+  typedef typename OutputImageType::RegionType        OutputImageRegionType;
+  typedef typename OutputImageType::SizeType          SizeType;
+  typedef typename OutputImageType::SpacingType       SpacingType;
+  typedef typename OutputImageType::PointType         PointType;
+  typedef FixedArray< unsigned int,
+    itkGetStaticConstMacro( ImageDimension ) >        ShrinkFactorsType;
+
+  /** The decimation kernels. */
+  typedef enum { Block, Gaussian } KernelType;
+
+  /** Set/Get the number of levels, which is the number of outputs. Default 1. */
+  void SetNumberOfLevels( unsigned int numberOfLevels );
+  itkGetConstMacro( NumberOfLevels, unsigned int );
+
+  /** Set/Get the shrink factors of a level, at least 1. Default 2. */
+  itkSetMacro( ShrinkFactors, ShrinkFactorsType );
+  itkGetConstReferenceMacro( ShrinkFactors, ShrinkFactorsType );
+
+  /** Set/Get the decimation kernel. Default Gaussian. */
+  itkSetMacro( Kernel, KernelType );
+  itkGetConstMacro( Kernel, KernelType );
+
+protected:
+  DecimationPyramidImageFilter();
+  virtual ~DecimationPyramidImageFilter() {};
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** Every output has the size, spacing and origin of its level. */
+  virtual void GenerateOutputInformation( void );
+
+  /** The whole input and all of every output are needed. */
+  virtual void GenerateInputRequestedRegion( void );
+  virtual void GenerateOutputRequestedRegion( DataObject * output );
+  virtual void EnlargeOutputRequestedRegion( DataObject * output );
+
+  /** Shrink the levels one by one, the axes one by one. */
+  virtual void GenerateData( void );
+
+  /** The taps of an output sample along an axis. */
+  struct TapsType
+  {
+    std::vector<std::size_t>  Index;
+    std::vector<double>       Weight;
+  };
+  typedef std::vector<TapsType>   TapsTableType;
+
+  /** Compute the taps of all samples of an axis of inputLength samples,
+   * shrunk by the factor to outputLength samples.
+   */
+  void ComputeTaps( std::size_t inputLength, std::size_t outputLength,
+    unsigned int factor, TapsTableType & taps ) const;
+
+  /** The buffer is a sequence of NumberOfBlocks blocks, of Length lines
+   * of Stride contiguous values along the axis.
+   */
+  struct PassStruct
+  {
+    const double *        Input;
+    double *              Output;
+    std::size_t           InputLength;
+    std::size_t           OutputLength;
+    std::size_t           Stride;
+    std::size_t           NumberOfBlocks;
+    const TapsTableType * Taps;
+  };
+
+  /** The shrunk lines of a thread. */
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback( void * arg );
+
+private:
+  DecimationPyramidImageFilter( const Self & ); // purposely not implemented
+  void operator=( const Self & );               // purposely not implemented
+
+  unsigned int          m_NumberOfLevels;
+  ShrinkFactorsType     m_ShrinkFactors;
+  KernelType            m_Kernel;
+
+}; // end class DecimationPyramidImageFilter
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkDecimationPyramidImageFilter.txx"
+#endif
+
+#endif // end #ifndef __itkDecimationPyramidImageFilter_h_
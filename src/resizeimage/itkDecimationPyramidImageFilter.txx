@@ -0,0 +1,385 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkDecimationPyramidImageFilter_txx_
+#define __itkDecimationPyramidImageFilter_txx_
+
+#include "itkDecimationPyramidImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkContinuousIndex.h"
+#include "itkMultiThreader.h"
+#include "itkNumericTraits.h"
+#include "vnl/vnl_math.h"
+
+#include <algorithm>
+
+namespace itk
+{
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+DecimationPyramidImageFilter< TInputImage, TOutputImage >
+::DecimationPyramidImageFilter()
+{
+  this->m_NumberOfLevels = 0;
+  this->m_ShrinkFactors.Fill( 2 );
+  this->m_Kernel = Gaussian;
+  this->SetNumberOfLevels( 1 );
+
+} // end Constructor
+
+
+/**
+ * ******************* SetNumberOfLevels *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+DecimationPyramidImageFilter< TInputImage, TOutputImage >
+::SetNumberOfLevels( unsigned int numberOfLevels )
+{
+  numberOfLevels = std::max( numberOfLevels, 1u );
+  if( this->m_NumberOfLevels == numberOfLevels ) return;
+
+  /** An output per level. */
+  this->m_NumberOfLevels = numberOfLevels;
+  this->SetNumberOfRequiredOutputs( numberOfLevels );
+  for( unsigned int k = this->GetNumberOfOutputs(); k < numberOfLevels; ++k )
+  {
+    this->SetNthOutput( k, this->MakeOutput( k ) );
+  }
+  this->Modified();
+
+} // end SetNumberOfLevels()
+
+
+/**
+ * ******************* GenerateOutputInformation *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+DecimationPyramidImageFilter< TInputImage, TOutputImage >
+::GenerateOutputInformation( void )
+{
+  Superclass::GenerateOutputInformation();
+
+  const InputImageType * input = this->GetInput();
+  if( !input ) return;
+
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    if( this->m_ShrinkFactors[ i ] < 1 )
+    {
+      itkExceptionMacro( << "The shrink factors should be at least 1." );
+    }
+  }
+
+  /** Every level from the previous one. The center of the first block of
+   * the previous level is the origin of the next.
+   */
+  typedef ContinuousIndex< double, ImageDimension > ContinuousIndexType;
+  ContinuousIndexType center;
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    center[ i ] = input->GetLargestPossibleRegion().GetIndex()[ i ];
+  }
+
+  SizeType size = input->GetLargestPossibleRegion().GetSize();
+  SpacingType spacing = input->GetSpacing();
+  double scale = 1.0;
+  for( unsigned int k = 0; k < this->m_NumberOfLevels; ++k )
+  {
+    for( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+      const unsigned int f = this->m_ShrinkFactors[ i ];
+      center[ i ] += 0.5 * ( f - 1.0 ) * vcl_pow( static_cast<double>( f ), static_cast<double>( k ) );
+      size[ i ] = std::max( size[ i ] / f, static_cast<typename SizeType::SizeValueType>( 1 ) );
+      spacing[ i ] *= f;
+    }
+    PointType origin;
+    input->TransformContinuousIndexToPhysicalPoint( center, origin );
+
+    OutputImageType * output = this->GetOutput( k );
+    if( !output ) continue;
+    OutputImageRegionType region;
+    region.SetSize( size );
+    output->SetLargestPossibleRegion( region );
+    output->SetSpacing( spacing );
+    output->SetOrigin( origin );
+  }
+
+} // end GenerateOutputInformation()
+
+
+/**
+ * ******************* GenerateInputRequestedRegion *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+DecimationPyramidImageFilter< TInputImage, TOutputImage >
+::GenerateInputRequestedRegion( void )
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  InputImageType * input = const_cast<InputImageType *>( this->GetInput() );
+  if( input ) input->SetRequestedRegionToLargestPossibleRegion();
+
+} // end GenerateInputRequestedRegion()
+
+
+/**
+ * ******************* GenerateOutputRequestedRegion *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+DecimationPyramidImageFilter< TInputImage, TOutputImage >
+::GenerateOutputRequestedRegion( DataObject * itkNotUsed( output ) )
+{
+  /** The levels have different sizes, so the requested region of one
+   * output says nothing about the others; all are computed.
+   */
+  for( unsigned int k = 0; k < this->GetNumberOfOutputs(); ++k )
+  {
+    OutputImageType * output = this->GetOutput( k );
+    if( output ) output->SetRequestedRegionToLargestPossibleRegion();
+  }
+
+} // end GenerateOutputRequestedRegion()
+
+
+/**
+ * ******************* EnlargeOutputRequestedRegion *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+DecimationPyramidImageFilter< TInputImage, TOutputImage >
+::EnlargeOutputRequestedRegion( DataObject * output )
+{
+  Superclass::EnlargeOutputRequestedRegion( output );
+  output->SetRequestedRegionToLargestPossibleRegion();
+
+} // end EnlargeOutputRequestedRegion()
+
+
+/**
+ * ******************* GenerateData *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+DecimationPyramidImageFilter< TInputImage, TOutputImage >
+::GenerateData( void )
+{
+  /** Copy the input to a buffer of doubles. */
+  const InputImageType * input = this->GetInput();
+  typename InputImageType::RegionType inputRegion = input->GetLargestPossibleRegion();
+  SizeType size = inputRegion.GetSize();
+  std::vector<double> current( inputRegion.GetNumberOfPixels() );
+  std::vector<double> next;
+  ImageRegionConstIterator<InputImageType> itIn( input, inputRegion );
+  for( std::size_t i = 0; !itIn.IsAtEnd(); ++itIn, ++i )
+  {
+    current[ i ] = static_cast<double>( itIn.Get() );
+  }
+
+  const bool isInteger = NumericTraits<OutputPixelType>::is_integer;
+  const double minimum = static_cast<double>( NumericTraits<OutputPixelType>::NonpositiveMin() );
+  const double maximum = static_cast<double>( NumericTraits<OutputPixelType>::max() );
+  for( unsigned int k = 0; k < this->m_NumberOfLevels; ++k )
+  {
+    /** Shrink the axes of this level one by one. */
+    for( unsigned int axis = 0; axis < ImageDimension; ++axis )
+    {
+      const unsigned int factor = this->m_ShrinkFactors[ axis ];
+      const std::size_t outputLength = std::max<std::size_t>( size[ axis ] / factor, 1 );
+      if( factor == 1 || current.empty() ) continue;
+
+      TapsTableType taps;
+      this->ComputeTaps( size[ axis ], outputLength, factor, taps );
+
+      PassStruct str;
+      str.InputLength = size[ axis ];
+      str.OutputLength = outputLength;
+      str.Stride = 1;
+      for( unsigned int i = 0; i < axis; ++i ) str.Stride *= size[ i ];
+      str.NumberOfBlocks = current.size() / ( str.InputLength * str.Stride );
+      str.Taps = &taps;
+
+      next.assign( str.NumberOfBlocks * str.OutputLength * str.Stride, 0.0 );
+      str.Input = &current[ 0 ];
+      str.Output = &next[ 0 ];
+
+      this->GetMultiThreader()->SetNumberOfThreads( this->GetNumberOfThreads() );
+      this->GetMultiThreader()->SetSingleMethod( Self::ThreaderCallback, &str );
+      this->GetMultiThreader()->SingleMethodExecute();
+
+      current.swap( next );
+      size[ axis ] = outputLength;
+    }
+
+    /** Copy the level to its output, within the range of the pixel type. */
+    OutputImageType * output = this->GetOutput( k );
+    output->SetBufferedRegion( output->GetRequestedRegion() );
+    output->Allocate();
+    ImageRegionIterator<OutputImageType> itOut( output, output->GetRequestedRegion() );
+    for( std::size_t i = 0; !itOut.IsAtEnd() && i < current.size(); ++itOut, ++i )
+    {
+      double value = std::min( maximum, std::max( minimum, current[ i ] ) );
+      if( isInteger ) value = vcl_floor( value + 0.5 );
+      itOut.Set( static_cast<OutputPixelType>( value ) );
+    }
+
+    this->UpdateProgress( static_cast<float>( k + 1 ) / this->m_NumberOfLevels );
+  }
+
+} // end GenerateData()
+
+
+/**
+ * ******************* ComputeTaps *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+DecimationPyramidImageFilter< TInputImage, TOutputImage >
+::ComputeTaps( std::size_t inputLength, std::size_t outputLength,
+  unsigned int factor, TapsTableType & taps ) const
+{
+  const long n = static_cast<long>( inputLength );
+  const double sigma = 0.5 * factor;
+  const long radius = static_cast<long>( vcl_ceil( 3.0 * sigma ) );
+
+  taps.assign( outputLength, TapsType() );
+  for( std::size_t j = 0; j < outputLength; ++j )
+  {
+    TapsType & t = taps[ j ];
+    const long first = static_cast<long>( j * factor );
+    if( this->m_Kernel == Block )
+    {
+      /** The mean of the block, clamped for an axis shorter than a block. */
+      for( long i = first; i < first + static_cast<long>( factor ); ++i )
+      {
+        t.Index.push_back( static_cast<std::size_t>( std::min( i, n - 1 ) ) );
+        t.Weight.push_back( 1.0 / factor );
+      }
+      continue;
+    }
+
+    /** The Gaussian around the center of the block, clamped at the border. */
+    const double c = first + 0.5 * ( factor - 1.0 );
+    double sum = 0.0;
+    for( long i = static_cast<long>( vcl_ceil( c ) ) - radius;
+      i <= static_cast<long>( vcl_floor( c ) ) + radius; ++i )
+    {
+      const double x = ( i - c ) / sigma;
+      const double w = vcl_exp( -0.5 * x * x );
+      t.Index.push_back( static_cast<std::size_t>( std::min( std::max( i, 0L ), n - 1 ) ) );
+      t.Weight.push_back( w );
+      sum += w;
+    }
+    for( std::size_t tap = 0; tap < t.Weight.size(); ++tap ) t.Weight[ tap ] /= sum;
+  }
+
+} // end ComputeTaps()
+
+
+/**
+ * ******************* ThreaderCallback *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+ITK_THREAD_RETURN_TYPE
+DecimationPyramidImageFilter< TInputImage, TOutputImage >
+::ThreaderCallback( void * arg )
+{
+  typedef MultiThreader::ThreadInfoStruct ThreadInfoType;
+  ThreadInfoType * info = static_cast<ThreadInfoType *>( arg );
+  PassStruct * str = static_cast<PassStruct *>( info->UserData );
+  const std::size_t threadId = info->ThreadID;
+  const std::size_t numberOfThreads = info->NumberOfThreads;
+
+  /** The lines of this thread. A line is a block and an offset within it. */
+  const std::size_t stride = str->Stride;
+  const std::size_t numberOfLines = str->NumberOfBlocks * stride;
+  const std::size_t begin = numberOfLines * threadId / numberOfThreads;
+  const std::size_t end = numberOfLines * ( threadId + 1 ) / numberOfThreads;
+  const TapsTableType & taps = *str->Taps;
+
+  /** Shrink the lines. The lines of a block with consecutive offsets are
+   * contiguous, and are shrunk together.
+   */
+  std::size_t l = begin;
+  while( l < end )
+  {
+    const std::size_t block = l / stride;
+    const std::size_t k0 = l % stride;
+    const std::size_t k1 = std::min( stride, k0 + ( end - l ) );
+    const double * in = str->Input + block * str->InputLength * stride;
+    double * out = str->Output + block * str->OutputLength * stride;
+
+    for( std::size_t j = 0; j < str->OutputLength; ++j )
+    {
+      double * o = out + j * stride;
+      const TapsType & t = taps[ j ];
+      std::fill( o + k0, o + k1, 0.0 );
+      for( std::size_t tap = 0; tap < t.Index.size(); ++tap )
+      {
+        const double w = t.Weight[ tap ];
+        const double * ip = in + t.Index[ tap ] * stride;
+        for( std::size_t k = k0; k < k1; ++k )
+        {
+          o[ k ] += w * ip[ k ];
+        }
+      }
+    }
+    l += k1 - k0;
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end ThreaderCallback()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+DecimationPyramidImageFilter< TInputImage, TOutputImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "NumberOfLevels: " << this->m_NumberOfLevels << std::endl;
+  os << indent << "ShrinkFactors: " << this->m_ShrinkFactors << std::endl;
+  os << indent << "Kernel: "
+    << ( this->m_Kernel == Block ? "Block" : "Gaussian" ) << std::endl;
+
+} // end PrintSelf()
+
+} // end namespace itk
+
+#endif // end #ifndef __itkDecimationPyramidImageFilter_txx_
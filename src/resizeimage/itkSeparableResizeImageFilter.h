@@ -0,0 +1,173 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkSeparableResizeImageFilter_h_
+#define __itkSeparableResizeImageFilter_h_
+
+#include "itkImageToImageFilter.h"
+#include <vector>
+
+namespace itk
+{
+
+/** \class SeparableResizeImageFilter
+ * \brief Resize an image with a separable interpolation, one axis at a time.
+ *
+ * The output has the origin, start index and direction of the input, and
+ * a new size and spacing; a voxel of the output is sampled at the same
+ * physical position in the input, as ResampleImageFilter does with an
+ * identity transform for an input with an identity direction. Since the
+ * sampling positions of an axis are the same for all lines, the
+ * interpolation weights are computed once per axis, and the image is
+ * resampled in D passes of 1D interpolation, in parallel over the lines.
+ *
+ * The InterpolationOrder is 0 for nearest neighbour, 1 for linear and 2-5
+ * for B-spline interpolation, with the same results as the interpolate
+ * image functions of ITK. For B-splines the coefficients are computed per
+ * line in the pass of the axis, as BSplineDecompositionImageFilter does.
+ *
+ * With UseAntiAliasing, an axis that is downsampled by a factor r > 1 is
+ * instead filtered with the B-spline kernel of the interpolation order
+ * (the triangle for linear), stretched by r and normalized, which combines
+ * the low-pass prefilter and the interpolation in one pass. Nearest
+ * neighbour interpolation is never anti-aliased, so that labels remain
+ * labels.
+ *
+ * Voxels outside the input get the DefaultPixelValue.
+ *
+ * \ingroup GeometricTransforms
+ */
+
+template< class TInputImage, class TOutputImage >
+class ITK_EXPORT SeparableResizeImageFilter :
+  public ImageToImageFilter< TInputImage, TOutputImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef SeparableResizeImageFilter      Self;
+  typedef ImageToImageFilter<
+    TInputImage, TOutputImage >           Superclass;
+  typedef SmartPointer<Self>              Pointer;
+  typedef SmartPointer<const Self>        ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( SeparableResizeImageFilter, ImageToImageFilter );
+
+  itkStaticConstMacro( ImageDimension, unsigned int, TInputImage::ImageDimension );
+
+  /** Typedefs. */
+  typedef TInputImage                                 InputImageType;
+  typedef TOutputImage                                OutputImageType;
+  typedef typename OutputImageType::PixelType         OutputPixelType;
+  typedef typename OutputImageType::RegionType        OutputImageRegionType;
+  typedef typename OutputImageType::SizeType          SizeType;
+  typedef typename OutputImageType::SpacingType       SpacingType;
+
+  /** Set/Get the size and the spacing of the output. */
+  itkSetMacro( OutputSize, SizeType );
+  itkGetConstReferenceMacro( OutputSize, SizeType );
+  itkSetMacro( OutputSpacing, SpacingType );
+  itkGetConstReferenceMacro( OutputSpacing, SpacingType );
+
+  /** Set/Get the interpolation order, 0 to 5. Default 1. */
+  itkSetClampMacro( InterpolationOrder, unsigned int, 0, 5 );
+  itkGetConstMacro( InterpolationOrder, unsigned int );
+
+  /** Set/Get whether downsampled axes are anti-aliased. Default false. */
+  itkSetMacro( UseAntiAliasing, bool );
+  itkGetConstMacro( UseAntiAliasing, bool );
+  itkBooleanMacro( UseAntiAliasing );
+
+  /** Set/Get the value of voxels outside the input. Default 0. */
+  itkSetMacro( DefaultPixelValue, OutputPixelType );
+  itkGetConstMacro( DefaultPixelValue, OutputPixelType );
+
+protected:
+  SeparableResizeImageFilter();
+  virtual ~SeparableResizeImageFilter() {};
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** The output has a new size and spacing. */
+  virtual void GenerateOutputInformation( void );
+
+  /** The whole input is needed. */
+  virtual void GenerateInputRequestedRegion( void );
+  virtual void EnlargeOutputRequestedRegion( DataObject * output );
+
+  /** Resample the axes one by one. */
+  virtual void GenerateData( void );
+
+  /** The taps of an output sample along an axis. No taps means outside. */
+  struct TapsType
+  {
+    std::vector<std::size_t>  Index;
+    std::vector<double>       Weight;
+  };
+  typedef std::vector<TapsType>   TapsTableType;
+
+  /** Compute the taps of all output samples along an axis. */
+  void ComputeTaps( unsigned int axis, bool antiAliasing, TapsTableType & taps ) const;
+
+  /** The buffer is a sequence of NumberOfBlocks blocks, of Length lines
+   * of Stride contiguous values along the axis.
+   */
+  struct PassStruct
+  {
+    double *              Input;
+    double *              Output;
+    std::size_t           InputLength;
+    std::size_t           OutputLength;
+    std::size_t           Stride;
+    std::size_t           NumberOfBlocks;
+    unsigned int          SplineOrder;
+    const TapsTableType * Taps;
+    double                DefaultValue;
+  };
+
+  /** A pass of a thread: the B-spline coefficients of its lines, if
+   * SplineOrder is at least 2, and the resampled lines.
+   */
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback( void * arg );
+
+  /** The B-spline coefficients of a line, in place. */
+  static void DataToCoefficients( std::vector<double> & c, unsigned int splineOrder );
+
+  /** The centered B-spline of order n at x. */
+  static double BSpline( unsigned int n, double x );
+
+private:
+  SeparableResizeImageFilter( const Self & ); // purposely not implemented
+  void operator=( const Self & );             // purposely not implemented
+
+  SizeType              m_OutputSize;
+  SpacingType           m_OutputSpacing;
+  unsigned int          m_InterpolationOrder;
+  bool                  m_UseAntiAliasing;
+  OutputPixelType       m_DefaultPixelValue;
+
+}; // end class SeparableResizeImageFilter
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkSeparableResizeImageFilter.txx"
+#endif
+
+#endif // end #ifndef __itkSeparableResizeImageFilter_h_
@@ -0,0 +1,516 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkSeparableResizeImageFilter_txx_
+#define __itkSeparableResizeImageFilter_txx_
+
+#include "itkSeparableResizeImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkMultiThreader.h"
+#include "itkNumericTraits.h"
+#include "vnl/vnl_math.h"
+
+#include <algorithm>
+
+namespace itk
+{
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+SeparableResizeImageFilter< TInputImage, TOutputImage >
+::SeparableResizeImageFilter()
+{
+  this->m_OutputSize.Fill( 0 );
+  this->m_OutputSpacing.Fill( 1.0 );
+  this->m_InterpolationOrder = 1;
+  this->m_UseAntiAliasing = false;
+  this->m_DefaultPixelValue = NumericTraits<OutputPixelType>::Zero;
+
+} // end Constructor
+
+
+/**
+ * ******************* GenerateOutputInformation *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+SeparableResizeImageFilter< TInputImage, TOutputImage >
+::GenerateOutputInformation( void )
+{
+  Superclass::GenerateOutputInformation();
+
+  const InputImageType * input = this->GetInput();
+  OutputImageType * output = this->GetOutput();
+  if( !input || !output ) return;
+
+  OutputImageRegionType region;
+  region.SetIndex( input->GetLargestPossibleRegion().GetIndex() );
+  region.SetSize( this->m_OutputSize );
+  output->SetLargestPossibleRegion( region );
+  output->SetSpacing( this->m_OutputSpacing );
+
+} // end GenerateOutputInformation()
+
+
+/**
+ * ******************* GenerateInputRequestedRegion *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+SeparableResizeImageFilter< TInputImage, TOutputImage >
+::GenerateInputRequestedRegion( void )
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  InputImageType * input = const_cast<InputImageType *>( this->GetInput() );
+  if( input ) input->SetRequestedRegionToLargestPossibleRegion();
+
+} // end GenerateInputRequestedRegion()
+
+
+/**
+ * ******************* EnlargeOutputRequestedRegion *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+SeparableResizeImageFilter< TInputImage, TOutputImage >
+::EnlargeOutputRequestedRegion( DataObject * output )
+{
+  Superclass::EnlargeOutputRequestedRegion( output );
+  output->SetRequestedRegionToLargestPossibleRegion();
+
+} // end EnlargeOutputRequestedRegion()
+
+
+/**
+ * ******************* GenerateData *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+SeparableResizeImageFilter< TInputImage, TOutputImage >
+::GenerateData( void )
+{
+  const InputImageType * input = this->GetInput();
+  OutputImageType * output = this->GetOutput();
+  output->SetBufferedRegion( output->GetRequestedRegion() );
+  output->Allocate();
+
+  /** Copy the input to a buffer of doubles. */
+  typename InputImageType::RegionType inputRegion = input->GetLargestPossibleRegion();
+  SizeType size = inputRegion.GetSize();
+  std::vector<double> current( inputRegion.GetNumberOfPixels() );
+  std::vector<double> next;
+  ImageRegionConstIterator<InputImageType> itIn( input, inputRegion );
+  for( std::size_t i = 0; !itIn.IsAtEnd(); ++itIn, ++i )
+  {
+    current[ i ] = static_cast<double>( itIn.Get() );
+  }
+
+  /** Resample the axes one by one. */
+  const SpacingType inputSpacing = input->GetSpacing();
+  for( unsigned int axis = 0; axis < ImageDimension; ++axis )
+  {
+    const bool sameSampling = size[ axis ] == this->m_OutputSize[ axis ]
+      && inputSpacing[ axis ] == this->m_OutputSpacing[ axis ];
+    if( sameSampling ) continue;
+
+    const bool antiAliasing = this->m_UseAntiAliasing
+      && this->m_InterpolationOrder > 0
+      && this->m_OutputSpacing[ axis ] > inputSpacing[ axis ];
+    TapsTableType taps;
+    this->ComputeTaps( axis, antiAliasing, taps );
+
+    PassStruct str;
+    str.InputLength = size[ axis ];
+    str.OutputLength = this->m_OutputSize[ axis ];
+    str.Stride = 1;
+    for( unsigned int i = 0; i < axis; ++i ) str.Stride *= size[ i ];
+    str.NumberOfBlocks = current.size() / ( str.InputLength * str.Stride );
+    str.SplineOrder = ( this->m_InterpolationOrder > 1 && !antiAliasing )
+      ? this->m_InterpolationOrder : 0;
+    str.Taps = &taps;
+    str.DefaultValue = static_cast<double>( this->m_DefaultPixelValue );
+
+    next.assign( str.NumberOfBlocks * str.OutputLength * str.Stride, 0.0 );
+    if( current.empty() || next.empty() ) break;
+    str.Input = &current[ 0 ];
+    str.Output = &next[ 0 ];
+
+    this->GetMultiThreader()->SetNumberOfThreads( this->GetNumberOfThreads() );
+    this->GetMultiThreader()->SetSingleMethod( Self::ThreaderCallback, &str );
+    this->GetMultiThreader()->SingleMethodExecute();
+
+    current.swap( next );
+    size[ axis ] = this->m_OutputSize[ axis ];
+    this->UpdateProgress( static_cast<float>( axis + 1 ) / ImageDimension );
+  }
+
+  /** Copy the result to the output, within the range of the pixel type. */
+  const double minimum = static_cast<double>( NumericTraits<OutputPixelType>::NonpositiveMin() );
+  const double maximum = static_cast<double>( NumericTraits<OutputPixelType>::max() );
+  ImageRegionIterator<OutputImageType> itOut( output, output->GetRequestedRegion() );
+  for( std::size_t i = 0; !itOut.IsAtEnd() && i < current.size(); ++itOut, ++i )
+  {
+    itOut.Set( static_cast<OutputPixelType>(
+      std::min( maximum, std::max( minimum, current[ i ] ) ) ) );
+  }
+
+} // end GenerateData()
+
+
+/**
+ * ******************* ComputeTaps *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+SeparableResizeImageFilter< TInputImage, TOutputImage >
+::ComputeTaps( unsigned int axis, bool antiAliasing, TapsTableType & taps ) const
+{
+  const InputImageType * input = this->GetInput();
+  const long start = input->GetLargestPossibleRegion().GetIndex()[ axis ];
+  const long n = static_cast<long>( input->GetLargestPossibleRegion().GetSize()[ axis ] );
+  const double ratio = this->m_OutputSpacing[ axis ] / input->GetSpacing()[ axis ];
+  const unsigned int order = this->m_InterpolationOrder;
+
+  taps.assign( this->m_OutputSize[ axis ], TapsType() );
+  for( std::size_t j = 0; j < taps.size(); ++j )
+  {
+    /** The continuous index in the input, relative to the start. An output
+     * index and its input position are both relative to the same origin.
+     */
+    const double c = static_cast<double>( start + static_cast<long>( j ) ) * ratio - start;
+    if( c < -0.5 || c >= n - 0.5 ) continue;
+
+    TapsType & t = taps[ j ];
+    if( order == 0 )
+    {
+      /** Nearest neighbour, rounding half up. */
+      const long i = static_cast<long>( vcl_floor( c + 0.5 ) );
+      t.Index.push_back( static_cast<std::size_t>( std::min( std::max( i, 0L ), n - 1 ) ) );
+      t.Weight.push_back( 1.0 );
+    }
+    else if( antiAliasing )
+    {
+      /** The kernel stretched by the ratio, clamped at the border. */
+      const double halfWidth = 0.5 * ratio * ( order + 1 );
+      const long first = static_cast<long>( vcl_ceil( c - halfWidth ) );
+      const long last = static_cast<long>( vcl_floor( c + halfWidth ) );
+      double sum = 0.0;
+      for( long i = first; i <= last; ++i )
+      {
+        const double w = BSpline( order, ( i - c ) / ratio );
+        if( w <= 0.0 ) continue;
+        t.Index.push_back( static_cast<std::size_t>( std::min( std::max( i, 0L ), n - 1 ) ) );
+        t.Weight.push_back( w );
+        sum += w;
+      }
+      for( std::size_t k = 0; k < t.Weight.size(); ++k ) t.Weight[ k ] /= sum;
+    }
+    else if( order == 1 )
+    {
+      /** Linear, clamped at the border. */
+      const long i = static_cast<long>( vcl_floor( c ) );
+      const double f = c - i;
+      t.Index.push_back( static_cast<std::size_t>( std::max( i, 0L ) ) );
+      t.Weight.push_back( 1.0 - f );
+      t.Index.push_back( static_cast<std::size_t>( std::min( i + 1, n - 1 ) ) );
+      t.Weight.push_back( f );
+    }
+    else
+    {
+      /** B-spline, with mirrored coefficients at the border. */
+      const long first = ( order % 2 == 1 )
+        ? static_cast<long>( vcl_floor( c ) ) - static_cast<long>( order / 2 )
+        : static_cast<long>( vcl_floor( c + 0.5 ) ) - static_cast<long>( order / 2 );
+      const long length2 = 2 * n - 2;
+      for( long i = first; i <= first + static_cast<long>( order ); ++i )
+      {
+        long m = 0;
+        if( n > 1 )
+        {
+          m = i < 0 ? -i - length2 * ( ( -i ) / length2 ) : i - length2 * ( i / length2 );
+          if( m >= n ) m = length2 - m;
+        }
+        t.Index.push_back( static_cast<std::size_t>( m ) );
+        t.Weight.push_back( BSpline( order, c - i ) );
+      }
+    }
+  }
+
+} // end ComputeTaps()
+
+
+/**
+ * ******************* ThreaderCallback *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+ITK_THREAD_RETURN_TYPE
+SeparableResizeImageFilter< TInputImage, TOutputImage >
+::ThreaderCallback( void * arg )
+{
+  typedef MultiThreader::ThreadInfoStruct ThreadInfoType;
+  ThreadInfoType * info = static_cast<ThreadInfoType *>( arg );
+  PassStruct * str = static_cast<PassStruct *>( info->UserData );
+  const std::size_t threadId = info->ThreadID;
+  const std::size_t numberOfThreads = info->NumberOfThreads;
+
+  /** The lines of this thread. A line is a block and an offset within it. */
+  const std::size_t stride = str->Stride;
+  const std::size_t numberOfLines = str->NumberOfBlocks * stride;
+  const std::size_t begin = numberOfLines * threadId / numberOfThreads;
+  const std::size_t end = numberOfLines * ( threadId + 1 ) / numberOfThreads;
+  const TapsTableType & taps = *str->Taps;
+
+  /** The B-spline coefficients of the lines. */
+  if( str->SplineOrder > 1 )
+  {
+    std::vector<double> line( str->InputLength );
+    for( std::size_t l = begin; l < end; ++l )
+    {
+      double * data = str->Input
+        + ( l / stride ) * str->InputLength * stride + l % stride;
+      for( std::size_t i = 0; i < str->InputLength; ++i ) line[ i ] = data[ i * stride ];
+      DataToCoefficients( line, str->SplineOrder );
+      for( std::size_t i = 0; i < str->InputLength; ++i ) data[ i * stride ] = line[ i ];
+    }
+  }
+
+  /** Resample the lines. The lines of a block with consecutive offsets
+   * are contiguous, and are resampled together.
+   */
+  std::size_t l = begin;
+  while( l < end )
+  {
+    const std::size_t block = l / stride;
+    const std::size_t k0 = l % stride;
+    const std::size_t k1 = std::min( stride, k0 + ( end - l ) );
+    const double * in = str->Input + block * str->InputLength * stride;
+    double * out = str->Output + block * str->OutputLength * stride;
+
+    for( std::size_t j = 0; j < str->OutputLength; ++j )
+    {
+      double * o = out + j * stride;
+      const TapsType & t = taps[ j ];
+      if( t.Index.empty() )
+      {
+        std::fill( o + k0, o + k1, str->DefaultValue );
+        continue;
+      }
+      std::fill( o + k0, o + k1, 0.0 );
+      for( std::size_t tap = 0; tap < t.Index.size(); ++tap )
+      {
+        const double w = t.Weight[ tap ];
+        const double * ip = in + t.Index[ tap ] * stride;
+        for( std::size_t k = k0; k < k1; ++k )
+        {
+          o[ k ] += w * ip[ k ];
+        }
+      }
+    }
+    l += k1 - k0;
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end ThreaderCallback()
+
+
+/**
+ * ******************* DataToCoefficients *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+SeparableResizeImageFilter< TInputImage, TOutputImage >
+::DataToCoefficients( std::vector<double> & c, unsigned int splineOrder )
+{
+  const long n = static_cast<long>( c.size() );
+  if( n == 1 ) return;
+
+  /** The poles of the recursive filter, as in BSplineDecompositionImageFilter. */
+  std::vector<double> poles;
+  switch( splineOrder )
+  {
+    case 2:
+      poles.push_back( vcl_sqrt( 8.0 ) - 3.0 );
+      break;
+    case 3:
+      poles.push_back( vcl_sqrt( 3.0 ) - 2.0 );
+      break;
+    case 4:
+      poles.push_back( vcl_sqrt( 664.0 - vcl_sqrt( 438976.0 ) ) + vcl_sqrt( 304.0 ) - 19.0 );
+      poles.push_back( vcl_sqrt( 664.0 + vcl_sqrt( 438976.0 ) ) - vcl_sqrt( 304.0 ) - 19.0 );
+      break;
+    case 5:
+      poles.push_back( vcl_sqrt( 135.0 / 2.0 - vcl_sqrt( 17745.0 / 4.0 ) )
+        + vcl_sqrt( 105.0 / 4.0 ) - 13.0 / 2.0 );
+      poles.push_back( vcl_sqrt( 135.0 / 2.0 + vcl_sqrt( 17745.0 / 4.0 ) )
+        - vcl_sqrt( 105.0 / 4.0 ) - 13.0 / 2.0 );
+      break;
+    default:
+      return;
+  }
+
+  /** The overall gain. */
+  double lambda = 1.0;
+  for( std::size_t k = 0; k < poles.size(); ++k )
+  {
+    lambda *= ( 1.0 - poles[ k ] ) * ( 1.0 - 1.0 / poles[ k ] );
+  }
+  for( long i = 0; i < n; ++i ) c[ i ] *= lambda;
+
+  const double tolerance = 1e-10;
+  for( std::size_t k = 0; k < poles.size(); ++k )
+  {
+    const double z = poles[ k ];
+
+    /** The initial causal coefficient, with mirrored boundaries. */
+    const long horizon = static_cast<long>(
+      vcl_ceil( vcl_log( tolerance ) / vcl_log( vcl_abs( z ) ) ) );
+    double sum = c[ 0 ];
+    if( horizon < n )
+    {
+      double zn = z;
+      for( long i = 1; i < horizon; ++i )
+      {
+        sum += zn * c[ i ];
+        zn *= z;
+      }
+    }
+    else
+    {
+      double zn = z;
+      const double iz = 1.0 / z;
+      double z2n = vcl_pow( z, static_cast<double>( n - 1 ) );
+      sum += z2n * c[ n - 1 ];
+      z2n *= z2n * iz;
+      for( long i = 1; i <= n - 2; ++i )
+      {
+        sum += ( zn + z2n ) * c[ i ];
+        zn *= z;
+        z2n *= iz;
+      }
+      sum /= ( 1.0 - zn * zn );
+    }
+    c[ 0 ] = sum;
+
+    /** Causal recursion. */
+    for( long i = 1; i < n; ++i ) c[ i ] += z * c[ i - 1 ];
+
+    /** The initial anti-causal coefficient, and the anti-causal recursion. */
+    c[ n - 1 ] = ( z / ( z * z - 1.0 ) ) * ( z * c[ n - 2 ] + c[ n - 1 ] );
+    for( long i = n - 2; i >= 0; --i ) c[ i ] = z * ( c[ i + 1 ] - c[ i ] );
+  }
+
+} // end DataToCoefficients()
+
+
+/**
+ * ******************* BSpline *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+double
+SeparableResizeImageFilter< TInputImage, TOutputImage >
+::BSpline( unsigned int n, double x )
+{
+  x = vcl_abs( x );
+  const double x2 = x * x;
+  switch( n )
+  {
+    case 0:
+      if( x < 0.5 ) return 1.0;
+      return x == 0.5 ? 0.5 : 0.0;
+    case 1:
+      return x < 1.0 ? 1.0 - x : 0.0;
+    case 2:
+      if( x < 0.5 ) return 0.75 - x2;
+      if( x < 1.5 ) return 0.5 * ( x - 1.5 ) * ( x - 1.5 );
+      return 0.0;
+    case 3:
+      if( x < 1.0 ) return 2.0 / 3.0 - x2 + 0.5 * x2 * x;
+      if( x < 2.0 ) return ( 2.0 - x ) * ( 2.0 - x ) * ( 2.0 - x ) / 6.0;
+      return 0.0;
+    case 4:
+      if( x < 0.5 ) return 115.0 / 192.0 - 0.625 * x2 + 0.25 * x2 * x2;
+      if( x < 1.5 )
+      {
+        return ( 55.0 + 20.0 * x - 120.0 * x2 + 80.0 * x2 * x - 16.0 * x2 * x2 ) / 96.0;
+      }
+      if( x < 2.5 )
+      {
+        const double y = 5.0 - 2.0 * x;
+        return y * y * y * y / 384.0;
+      }
+      return 0.0;
+    case 5:
+      if( x < 1.0 )
+      {
+        return 11.0 / 20.0 - 0.5 * x2 + 0.25 * x2 * x2 - x2 * x2 * x / 12.0;
+      }
+      if( x < 2.0 )
+      {
+        return 17.0 / 40.0 + 0.625 * x - 1.75 * x2 + 1.25 * x2 * x
+          - 0.375 * x2 * x2 + x2 * x2 * x / 24.0;
+      }
+      if( x < 3.0 )
+      {
+        const double y = 3.0 - x;
+        return y * y * y * y * y / 120.0;
+      }
+      return 0.0;
+    default:
+      return 0.0;
+  }
+
+} // end BSpline()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+SeparableResizeImageFilter< TInputImage, TOutputImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "OutputSize: " << this->m_OutputSize << std::endl;
+  os << indent << "OutputSpacing: " << this->m_OutputSpacing << std::endl;
+  os << indent << "InterpolationOrder: " << this->m_InterpolationOrder << std::endl;
+  os << indent << "UseAntiAliasing: " << this->m_UseAntiAliasing << std::endl;
+  os << indent << "DefaultPixelValue: "
+    << static_cast<typename NumericTraits<OutputPixelType>::PrintType>(
+    this->m_DefaultPixelValue ) << std::endl;
+
+} // end PrintSelf()
+
+} // end namespace itk
+
+#endif // end #ifndef __itkSeparableResizeImageFilter_txx_
@@ -44,8 +44,14 @@ std::string GetHelpString( void )
     << "  [-f]     factor\n"
     << "  [-sp]    spacing\n"
     << "  [-io]    interpolation order, default 1\n"
+    << "  [-aa]    anti-aliasing of the axes that are downsampled, for order > 0\n"
+    << "  [-levels] number of pyramid levels, each shrinking the previous one\n"
+    << "  [-pf]    integer shrink factor per level, default 2\n"
+    << "  [-kernel] decimation kernel of the levels, choose one of {block, gaussian}, default gaussian\n"
     << "  [-dim]   dimension, default 3\n"
-    << "One of -f and -sp should be given.\n"
+    << "One of -f, -sp and -levels should be given.\n"
+    << "With -levels all levels are computed from a single read of the input,\n"
+    << "each from the previous one, and level k is written to out + _Lk.\n"
     << "Supported: 2D, 3D, (unsigned) char, (unsigned) short, (unsigned) int, (unsigned) long, float, double.";
 
   return ss.str();
@@ -68,6 +74,7 @@ int main( int argc, char **argv )
   std::vector<std::string> exactlyOneArguments;
   exactlyOneArguments.push_back( "-f" );
   exactlyOneArguments.push_back( "-sp" );
+  exactlyOneArguments.push_back( "-levels" );
   parser->MarkExactlyOneOfArgumentsAsRequired( exactlyOneArguments );
 
   itk::CommandLineArgumentParser::ReturnValue validateArguments = parser->CheckForRequiredArguments();
@@ -102,6 +109,17 @@ int main( int argc, char **argv )
   unsigned int interpolationOrder = 1;
   parser->GetCommandLineArgument( "-io", interpolationOrder );
 
+  const bool useAntiAliasing = parser->ArgumentExists( "-aa" );
+
+  unsigned int numberOfLevels = 0;
+  bool retlevels = parser->GetCommandLineArgument( "-levels", numberOfLevels );
+
+  std::vector<unsigned int> shrinkFactors( 1, 2 );
+  parser->GetCommandLineArgument( "-pf", shrinkFactors );
+
+  std::string pyramidKernel = "gaussian";
+  parser->GetCommandLineArgument( "-kernel", pyramidKernel );
+
   /** Check factor and spacing. */
   if( retf )
   {
@@ -120,6 +138,38 @@ int main( int argc, char **argv )
     }
   }
 
+  if( retlevels )
+  {
+    if( numberOfLevels < 1 )
+    {
+      std::cout << "ERROR: The number of levels should be at least 1." << std::endl;
+      return EXIT_FAILURE;
+    }
+    if( shrinkFactors.size() != Dimension && shrinkFactors.size() != 1 )
+    {
+      std::cout << "ERROR: The number of shrink factors should be 1 or Dimension." << std::endl;
+      return EXIT_FAILURE;
+    }
+    if( pyramidKernel != "block" && pyramidKernel != "gaussian" )
+    {
+      std::cout << "ERROR: The kernel should be one of {block, gaussian}." << std::endl;
+      return EXIT_FAILURE;
+    }
+    for( unsigned int i = 0; i < shrinkFactors.size(); i++ )
+    {
+      if( shrinkFactors[ i ] < 1 )
+      {
+        std::cout << "ERROR: The shrink factors should be at least 1." << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+    shrinkFactors.resize( Dimension, shrinkFactors[ 0 ] );
+
+    /** The factor or spacing is not used. */
+    factor.assign( Dimension, 1.0 );
+    retf = true;
+  }
+
   /** Get the factor or spacing. */
   double vector0 = ( retf ? factor[ 0 ] : spacing[ 0 ] );
   std::vector<double> factorOrSpacing( Dimension, vector0 );
@@ -195,7 +245,12 @@ int main( int argc, char **argv )
     filter->m_FactorOrSpacing = factorOrSpacing;
     filter->m_IsFactor = isFactor;
     filter->m_InterpolationOrder = interpolationOrder;
+    filter->m_UseAntiAliasing = useAntiAliasing;
+    filter->m_NumberOfLevels = numberOfLevels;
+    filter->m_ShrinkFactors = shrinkFactors;
+    filter->m_PyramidKernel = pyramidKernel;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
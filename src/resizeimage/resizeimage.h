@@ -24,6 +24,8 @@
 #include "itkResampleImageFilter.h"
 #include "itkNearestNeighborInterpolateImageFunction.h"
 #include "itkBSplineInterpolateImageFunction.h"
+#include "itkSeparableResizeImageFilter.h"
+#include "itkDecimationPyramidImageFilter.h"
 
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
@@ -45,6 +47,9 @@ public:
     this->m_OutputFileName = "";
     this->m_IsFactor = false;
     this->m_InterpolationOrder = 0;
+    this->m_UseAntiAliasing = false;
+    this->m_NumberOfLevels = 0;
+    this->m_PyramidKernel = "gaussian";
   };
   /** Destructor. */
   ~ITKToolsResizeImageBase(){};
@@ -55,6 +60,10 @@ public:
   std::vector<double> m_FactorOrSpacing;
   bool m_IsFactor;
   unsigned int m_InterpolationOrder;
+  bool m_UseAntiAliasing;
+  unsigned int m_NumberOfLevels;
+  std::vector<unsigned int> m_ShrinkFactors;
+  std::string m_PyramidKernel;
 
 }; // end class ITKToolsResizeImageBase
 
@@ -88,6 +97,8 @@ public:
       InputImageType, double >                          NNInterpolatorType;
     typedef itk::BSplineInterpolateImageFunction<
       InputImageType >                                  BSplineInterpolatorType;
+    typedef itk::SeparableResizeImageFilter<
+      InputImageType, InputImageType >                  SeparableResizerType;
 
     typedef typename InputImageType::SizeType         SizeType;
     typedef typename InputImageType::SpacingType      SpacingType;
@@ -109,6 +120,13 @@ public:
     inputImage = reader->GetOutput();
     inputImage->Update();
 
+    /** A pyramid mode: all levels from one read. */
+    if( this->m_NumberOfLevels > 0 )
+    {
+      this->RunPyramid( inputImage );
+      return;
+    }
+
     /** Prepare stuff. */
     SpacingType inputSpacing  = inputImage->GetSpacing();
     SizeType    inputSize     = inputImage->GetLargestPossibleRegion().GetSize();
@@ -132,6 +150,34 @@ public:
       }
     }
 
+    /** The resizing is separable if the axes of the input are the axes of
+     * the world, which the output has. Then every axis is resampled with
+     * 1D interpolation weights that are computed once.
+     */
+    typename InputImageType::DirectionType identity;
+    identity.SetIdentity();
+    if( inputImage->GetDirection() == identity && this->m_InterpolationOrder <= 5 )
+    {
+      typename SeparableResizerType::Pointer resizer = SeparableResizerType::New();
+      resizer->SetInput( inputImage );
+      resizer->SetOutputSize( outputSize );
+      resizer->SetOutputSpacing( outputSpacing );
+      resizer->SetInterpolationOrder( this->m_InterpolationOrder );
+      resizer->SetUseAntiAliasing( this->m_UseAntiAliasing );
+
+      writer->SetFileName( this->m_OutputFileName.c_str() );
+      writer->SetInput( resizer->GetOutput() );
+      this->ObserveProcess( resizer.GetPointer(), "resize" );
+      this->ObserveProcess( writer.GetPointer(), "write" );
+      writer->Update();
+      return;
+    }
+    if( this->m_UseAntiAliasing )
+    {
+      std::cerr << "WARNING: anti-aliasing is only supported for an input "
+        << "with an identity direction, and is not applied." << std::endl;
+    }
+
     /** Setup the pipeline. */
     resampler->SetInput( inputImage );
     resampler->SetSize( outputSize );
@@ -160,6 +206,50 @@ public:
 
   } // end Run()
 
+
+  /** Write the levels of a pyramid of the input, each level computed from
+   * the previous one, to the output file name with _L<level> appended.
+   */
+  template< class TImage >
+  void RunPyramid( TImage * inputImage )
+  {
+    typedef itk::DecimationPyramidImageFilter< TImage, TImage > PyramidType;
+    typedef itk::ImageFileWriter< TImage >                      WriterType;
+
+    typename PyramidType::ShrinkFactorsType factors;
+    for( unsigned int i = 0; i < VDimension; i++ )
+    {
+      factors[ i ] = this->m_ShrinkFactors[ i ];
+    }
+
+    typename PyramidType::Pointer pyramid = PyramidType::New();
+    pyramid->SetInput( inputImage );
+    pyramid->SetNumberOfLevels( this->m_NumberOfLevels );
+    pyramid->SetShrinkFactors( factors );
+    pyramid->SetKernel( this->m_PyramidKernel == "block"
+      ? PyramidType::Block : PyramidType::Gaussian );
+    this->ObserveProcess( pyramid.GetPointer(), "pyramid" );
+    pyramid->Update();
+
+    /** The level is inserted before the extension. */
+    const std::string::size_type dot = this->m_OutputFileName.rfind( "." );
+    const std::string base = this->m_OutputFileName.substr( 0, dot );
+    const std::string extension = dot == std::string::npos
+      ? std::string( ".mhd" ) : this->m_OutputFileName.substr( dot );
+    for( unsigned int k = 0; k < this->m_NumberOfLevels; k++ )
+    {
+      std::ostringstream fileName;
+      fileName << base << "_L" << k + 1 << extension;
+
+      typename WriterType::Pointer writer = WriterType::New();
+      writer->SetFileName( fileName.str().c_str() );
+      writer->SetInput( pyramid->GetOutput( k ) );
+      this->ObserveProcess( writer.GetPointer(), "write" );
+      writer->Update();
+    }
+
+  } // end RunPyramid()
+
 }; // end class ITKToolsResizeImage
 
 #endif // end #ifndef __resizeimage_h_
@@ -6,6 +6,7 @@
 #include "itkBSplineKernelFunction.h"
 #include "itkInterpolateImageFunction.h"
 #include "itkMersenneTwisterRandomVariateGenerator.h"
+#include <vector>
 
 namespace itk
 {
@@ -28,6 +29,16 @@ namespace itk
  * ProcessObject::GenerateInputRequestedRegion() and
  * ProcessObject::GenerateOutputInformation().
  *
+ * With UseRayCasting on, the filter shoots rays instead: every output
+ * voxel is the (interpolated) input value at r along the direction
+ * (theta, phi) from the center of rotation. The sines and cosines of the
+ * angles are tabulated once, and the continuous input index is stepped
+ * incrementally along every ray. The output is generated in parallel
+ * over the angular bins, and is deterministic. The mask is then sampled
+ * with nearest neighbor interpolation: where it is zero, or outside the
+ * input, the output is zero. Because of that, this mode is not suited to
+ * masks that are thinner than the sampling distance of the rays.
+ *
  * \ingroup GeometricTransforms
  */
 template < class TInputImage, class TOutputImage >
@@ -129,6 +140,12 @@ public:
    * \sa ProcessObject::GenerateInputRequestedRegion() */
   virtual void GenerateInputRequestedRegion();
 
+  /** Set/Get whether to shoot rays instead of using the Parzen window
+   * approach. Default false. */
+  itkSetMacro( UseRayCasting, bool );
+  itkGetConstMacro( UseRayCasting, bool );
+  itkBooleanMacro( UseRayCasting );
+
   /** Get the random generator; useful to set its seed */
   itkGetObjectMacro( RandomGenerator, RandomGeneratorType );
 
@@ -151,6 +168,14 @@ protected:
   /** Function that does the work */
   virtual void GenerateData( void );
 
+  /** Tabulate the sines and cosines of the angles, for the ray casting. */
+  virtual void BeforeThreadedGenerateData( void );
+
+  /** Shoot the rays of the angular bins of a thread. */
+  virtual void ThreadedGenerateData(
+    const OutputImageRegionType & outputRegionForThread,
+    ThreadIdType threadId );
+
   /** Generate a point randomly in a bounding box. */
   inline void GenerateRandomCoordinate(
     const PointType & inputPoint,
@@ -170,6 +195,13 @@ private:
   SizeType                m_OutputSize;       // Size of the output image
   PointType               m_CenterOfRotation;
   unsigned int            m_MaximumNumberOfSamplesPerVoxel;
+  bool                    m_UseRayCasting;
+
+  /** The tables of the ray casting. */
+  std::vector<double>     m_CosTheta;
+  std::vector<double>     m_SinTheta;
+  std::vector<double>     m_CosPhi;
+  std::vector<double>     m_SinPhi;
 
   MaskImagePointer        m_MaskImage;
   typename InterpolatorType::Pointer m_Interpolator;
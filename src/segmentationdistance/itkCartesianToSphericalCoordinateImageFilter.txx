@@ -8,6 +8,7 @@
 #include "itkImageRegionIterator.h"
 #include "itkImageRegionConstIterator.h"
 #include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageLinearIteratorWithIndex.h"
 #include "vnl/vnl_math.h"
 #include "itkNumericTraits.h"
 
@@ -30,6 +31,7 @@ CartesianToSphericalCoordinateImageFilter<TInputImage, TOutputImage>
   this->m_Interpolator = 0;
   this->m_MaskImage = 0;
   this->m_MaximumNumberOfSamplesPerVoxel = 5;
+  this->m_UseRayCasting = false;
 
   this->m_RandomGenerator = RandomGeneratorType::GetInstance();
 
@@ -52,6 +54,7 @@ CartesianToSphericalCoordinateImageFilter<TInputImage, TOutputImage>
   os << indent << "OutputStartIndex: " << this->m_OutputStartIndex << std::endl;
   os << indent << "OutputSpacing: " << this->m_OutputSpacing << std::endl;
   os << indent << "OutputOrigin: " << this->m_OutputOrigin << std::endl;
+  os << indent << "UseRayCasting: " << this->m_UseRayCasting << std::endl;
 
   return;
 }
@@ -181,6 +184,13 @@ void
 CartesianToSphericalCoordinateImageFilter<TInputImage,TOutputImage>
 ::GenerateData( void )
 {
+  /** Shoot rays, in parallel, by the ThreadedGenerateData(). */
+  if( this->m_UseRayCasting )
+  {
+    this->Superclass::GenerateData();
+    return;
+  }
+
   InputImageConstPointer inputImage = this->GetInput();
   OutputImagePointer outputImage = this->GetOutput();
 
@@ -504,6 +514,145 @@ CartesianToSphericalCoordinateImageFilter<TInputImage,TOutputImage>
 
 } // end GenerateData
 
+/**
+ * BeforeThreadedGenerateData
+ */
+template< class TInputImage, class TOutputImage >
+void
+CartesianToSphericalCoordinateImageFilter<TInputImage,TOutputImage>
+::BeforeThreadedGenerateData( void )
+{
+  if( this->m_Interpolator.IsNotNull() )
+  {
+    this->m_Interpolator->SetInputImage( this->GetInput() );
+  }
+
+  /** theta_j = j dtheta and phi_k = k dphi, the same for every radius. */
+  const SizeType size = this->m_OutputSize;
+  this->m_CosTheta.resize( size[1] );
+  this->m_SinTheta.resize( size[1] );
+  for( unsigned int j = 0; j < size[1]; ++j )
+  {
+    const double theta = j * this->m_OutputSpacing[1];
+    this->m_CosTheta[ j ] = vcl_cos( theta );
+    this->m_SinTheta[ j ] = vcl_sin( theta );
+  }
+  this->m_CosPhi.resize( size[2] );
+  this->m_SinPhi.resize( size[2] );
+  for( unsigned int k = 0; k < size[2]; ++k )
+  {
+    const double phi = k * this->m_OutputSpacing[2];
+    this->m_CosPhi[ k ] = vcl_cos( phi );
+    this->m_SinPhi[ k ] = vcl_sin( phi );
+  }
+
+} // end BeforeThreadedGenerateData()
+
+
+/**
+ * ThreadedGenerateData
+ */
+template< class TInputImage, class TOutputImage >
+void
+CartesianToSphericalCoordinateImageFilter<TInputImage,TOutputImage>
+::ThreadedGenerateData(
+  const OutputImageRegionType & outputRegionForThread,
+  ThreadIdType threadId )
+{
+  typedef ImageLinearIteratorWithIndex< OutputImageType > OutputIteratorType;
+  typedef typename InputImageType::IndexType              InputIndexType;
+  typedef typename InputIndexType::IndexValueType         IndexValueType;
+
+  const InputImageType * inputImage = this->GetInput();
+  OutputImageType * outputImage = this->GetOutput();
+  const InputImageRegionType inputRegion = inputImage->GetBufferedRegion();
+  const bool useInterpolator = this->m_Interpolator.IsNotNull();
+  const bool useMask = this->m_MaskImage.IsNotNull();
+
+  /** The continuous index of the center, and the physical to index matrix. */
+  ContinuousIndexType center;
+  inputImage->TransformPhysicalPointToContinuousIndex( this->m_CenterOfRotation, center );
+  double physicalToIndex[ InputImageDimension ][ InputImageDimension ];
+  for( unsigned int i = 0; i < InputImageDimension; ++i )
+  {
+    for( unsigned int j = 0; j < InputImageDimension; ++j )
+    {
+      physicalToIndex[ i ][ j ] = inputImage->GetInverseDirection()[ i ][ j ]
+        / inputImage->GetSpacing()[ i ];
+    }
+  }
+
+  OutputIteratorType outIt( outputImage, outputRegionForThread );
+  outIt.SetDirection( 0 );
+  ProgressReporter progress( this, threadId,
+    outputRegionForThread.GetNumberOfPixels() / outputRegionForThread.GetSize()[0] );
+
+  outIt.GoToBegin();
+  while( !outIt.IsAtEnd() )
+  {
+    /** The step of the continuous index along the ray, per radial bin. */
+    const IndexType & index = outIt.GetIndex();
+    double direction[ 3 ];
+    direction[0] = this->m_SinPhi[ index[2] ] * this->m_CosTheta[ index[1] ];
+    direction[1] = this->m_SinPhi[ index[2] ] * this->m_SinTheta[ index[1] ];
+    direction[2] = this->m_CosPhi[ index[2] ];
+    ContinuousIndexType step;
+    ContinuousIndexType cindex;
+    for( unsigned int i = 0; i < InputImageDimension; ++i )
+    {
+      step[ i ] = 0.0;
+      for( unsigned int j = 0; j < InputImageDimension; ++j )
+      {
+        step[ i ] += physicalToIndex[ i ][ j ] * direction[ j ];
+      }
+      step[ i ] *= this->m_OutputSpacing[0];
+      cindex[ i ] = center[ i ] + index[0] * step[ i ];
+    }
+
+    while( !outIt.IsAtEndOfLine() )
+    {
+      InputIndexType nearest;
+      for( unsigned int i = 0; i < InputImageDimension; ++i )
+      {
+        nearest[ i ] = static_cast<IndexValueType>( vcl_floor( cindex[ i ] + 0.5 ) );
+      }
+
+      double value = 0.0;
+      bool valid = inputRegion.IsInside( nearest );
+      if( valid && useMask )
+      {
+        valid = this->m_MaskImage->GetPixel( nearest ) != 0;
+      }
+      if( valid && useInterpolator )
+      {
+        valid = this->m_Interpolator->IsInsideBuffer( cindex );
+        if( valid ) value = this->m_Interpolator->EvaluateAtContinuousIndex( cindex );
+      }
+      else if( valid )
+      {
+        value = inputImage->GetPixel( nearest );
+      }
+
+      if( NumericTraits<OutputPixelType>::is_integer )
+      {
+        outIt.Set( static_cast<OutputPixelType>( vnl_math_rnd( value ) ) );
+      }
+      else
+      {
+        outIt.Set( static_cast<OutputPixelType>( value ) );
+      }
+
+      for( unsigned int i = 0; i < InputImageDimension; ++i ) cindex[ i ] += step[ i ];
+      ++outIt;
+    }
+
+    outIt.NextLine();
+    progress.CompletedPixel();
+  }
+
+} // end ThreadedGenerateData()
+
+
 /**
 * ******************* GenerateRandomCoordinate *******************
 */
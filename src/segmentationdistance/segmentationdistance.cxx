@@ -49,6 +49,13 @@ std::string GetHelpString( void )
     << "  [-p]     phi size; the size of the phi dimension. default: 90, which yields a spacing of 2 degrees.\n"
     << "  [-car]   skip the polar transform and return two output images (outputFileNameDIST and outputFileNameEDGE): true or false; default = false\n"
     << "           The EDGE output image is an edge mask for inputfile2. The DIST output image contains the distance at each edge pixel to the first inputFile.\n"
+    << "  [-narrowband] compute the distances to the edge of inputImage1 only in a band of one voxel around the edge of inputImage2,\n"
+    << "           exactly, using a kd-tree of the edge points of inputImage1, instead of the full distance maps of both images.\n"
+    << "           This is much faster and uses less memory for large images with small objects.\n"
+    << "  [-ray]   do the spherical transforms by shooting rays from the center, in parallel, instead of\n"
+    << "           distributing every voxel with random samples over the spherical grid. This is much\n"
+    << "           faster and deterministic, but the edge is then sampled with nearest neighbour\n"
+    << "           interpolation, so use a radial resolution finer than the voxel size.\n"
     << "Supported: 3D short for inputImage1, and everything convertable to short.\n"
     << "           3D short for inputImage2, and everything convertable to short.";
 
@@ -130,6 +137,9 @@ int main( int argc, char **argv )
     cartesianonly = true;
   }
 
+  const bool narrowBand = parser->ArgumentExists( "-narrowband" );
+  const bool rayCasting = parser->ArgumentExists( "-ray" );
+
   /** Determine image properties. */
   itk::ImageIOBase::IOPixelType pixelType = itk::ImageIOBase::UNKNOWNPIXELTYPE;
   itk::ImageIOBase::IOComponentType componentType = itk::ImageIOBase::UNKNOWNCOMPONENTTYPE;
@@ -173,7 +183,10 @@ int main( int argc, char **argv )
     filter->m_Thetasize = thetasize;
     filter->m_Phisize = phisize;
     filter->m_Cartesianonly = cartesianonly;
+    filter->m_NarrowBand = narrowBand;
+    filter->m_RayCasting = rayCasting;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
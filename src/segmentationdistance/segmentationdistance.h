@@ -19,6 +19,7 @@
 #define __segmentationdistance_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsBufferPool.h"
 
 #include "itkImage.h"
 #include "itkExceptionObject.h"
@@ -39,6 +40,9 @@
 #include "itkExtractImageFilter.h"
 #include "itkImageFileWriter.h"
 #include "itkLinearInterpolateImageFunction.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkListSample.h"
+#include "itkKdTreeGenerator.h"
 
 template< class InputImageType1, class InputImageType2, class ImageType >
 void SegmentationDistanceHelper(
@@ -53,7 +57,9 @@ void SegmentationDistanceHelper(
   unsigned int thetasize,
   unsigned int phisize,
   bool cartesianonly,
-  bool invertedImage  );
+  bool invertedImage,
+  bool narrowBand,
+  bool rayCasting );
 
 /** \class ITKToolsSegmentationDistanceBase
  *
@@ -74,6 +80,8 @@ public:
     this->m_Thetasize = 0;
     this->m_Phisize = 0;
     this->m_Cartesianonly = false;
+    this->m_NarrowBand = false;
+    this->m_RayCasting = false;
   };
   /** Destructor. */
   ~ITKToolsSegmentationDistanceBase(){};
@@ -87,6 +95,8 @@ public:
   unsigned int m_Thetasize;
   unsigned int m_Phisize;
   bool m_Cartesianonly;
+  bool m_NarrowBand;
+  bool m_RayCasting;
 
 }; // end class ITKToolsSegmentationDistanceBase
 
@@ -124,6 +134,14 @@ public:
 
     typedef itk::Image<PixelType, OutputDimension>      OutputImageType;
 
+    /** The padded inputs, their inverses and the many same-sized
+     * temporaries of the distance computations recycle their buffers.
+     */
+    itktools::RegisterPooledImageType<ImageType>();
+    itktools::RegisterPooledImageType<InputImageType1>();
+    itktools::RegisterPooledImageType<InputImageType2>();
+    itktools::RegisterPooledImageType<OutputImageType>();
+
     typedef itk::ImageFileReader<InputImageType1>       ReaderType1;
     typedef itk::ImageFileReader<InputImageType2>       ReaderType2;
     typedef itk::ConstantPadImageFilter<
@@ -206,7 +224,8 @@ public:
 
     SegmentationDistanceHelper<InputImageType1, InputImageType2, ImageType>(
       padder1->GetOutput(), padder2->GetOutput(), accum1, accum2, dist, edge,
-      cor, this->m_Samples, this->m_Thetasize, this->m_Phisize, this->m_Cartesianonly, false );
+      cor, this->m_Samples, this->m_Thetasize, this->m_Phisize, this->m_Cartesianonly, false,
+      this->m_NarrowBand, this->m_RayCasting );
 
     /** Compute 1 minus the input images */
     typename InputImageType1::Pointer invInputImage1 = InputImageType1::New();
@@ -247,7 +266,8 @@ public:
 
     SegmentationDistanceHelper<InputImageType1, InputImageType2, ImageType>(
       invInputImage1, invInputImage2, accum1inv, accum2inv, distinv, edgeinv,
-      cor, this->m_Samples, this->m_Thetasize, this->m_Phisize, this->m_Cartesianonly, true);
+      cor, this->m_Samples, this->m_Thetasize, this->m_Phisize, this->m_Cartesianonly, true,
+      this->m_NarrowBand, this->m_RayCasting );
 
     //
     if ( this->m_Cartesianonly )
@@ -359,7 +379,9 @@ public:
     unsigned int thetasize,
     unsigned int phisize,
     bool cartesianonly,
-    bool invertedImage  )
+    bool invertedImage,
+    bool narrowBand,
+    bool rayCasting )
   {
     /** constants */
     const unsigned int Dimension = ImageType::ImageDimension;
@@ -396,6 +418,8 @@ public:
     typedef itk::ImageRegionIterator<
       ImageType>                                        OutputIteratorType;
 
+    itktools::RegisterPooledImageType<MaskImageType>();
+
     /** Instantiate filters */
     typename DistanceMapFilterType1::Pointer distanceMapFilter1 =
       DistanceMapFilterType1::New();
@@ -414,21 +438,11 @@ public:
     typename AccumulatorType::Pointer accumulator1 = AccumulatorType::New();
     typename AccumulatorType::Pointer accumulator2 = AccumulatorType::New();
 
-    /** Compute the distance map of image 1 */
-    distanceMapFilter1->SetInput( inputImage1 );
-    distanceMapFilter1->SetUseImageSpacing( true );
-    distanceMapFilter1->SetSquaredDistance( false );
-    std::cout << "Computing distance map D of input image 1..." << std::endl;
-    distanceMapFilter1->Update();
-    std::cout << "Distance map computed." << std::endl;
-
-    /** Compute the distance map of image 2 */
-    distanceMapFilter2->SetInput( inputImage2 );
-    distanceMapFilter2->SetUseImageSpacing( true );
-    distanceMapFilter2->SetSquaredDistance( false );
-    std::cout << "Computing distance map D of input image 2..." << std::endl;
-    distanceMapFilter2->Update();
-    std::cout << "Distance map computed." << std::endl;
+    /** Compute the distance map of image 1, and the edge image of image 2:
+     * exactly, but only in a narrow band around the edge of image 2,
+     * or everywhere, using distance maps of both images.
+     */
+    typename ImageType::Pointer distanceMap1 = 0;
 
     /** Compute minimum spacing */
     double minSpacing = itk::NumericTraits<double>::max();
@@ -438,20 +452,48 @@ public:
       minSpacing = vnl_math_min( minSpacing, inputSpacing[ i ]);
     }
 
-    /** Find distanceMap2==0 pixels */
-    thresholder->SetInput( distanceMapFilter2->GetOutput() );
-    thresholder->SetUpperThreshold(minSpacing*0.5);
-    thresholder->SetLowerThreshold(-minSpacing*0.5);
-    thresholder->SetInsideValue(1.0);
-    thresholder->SetOutsideValue(0.0);
-    std::cout << "Thresholding distance map 2..." << std::endl;
-    thresholder->Update();
-    std::cout << "Done thresholding." << std::endl;
-
-    /** Save for the caller of this function */
-    edgeImage = thresholder->GetOutput();
+    if( narrowBand )
+    {
+      std::cout << "Computing distance map D of input image 1 near the edge of image 2..." << std::endl;
+      this->template ComputeNarrowBandDistances<InputImageType1, InputImageType2, ImageType>(
+        inputImage1, inputImage2, distanceMap1, edgeImage );
+      std::cout << "Distance map computed." << std::endl;
+    }
+    else
+    {
+      /** Compute the distance map of image 1 */
+      distanceMapFilter1->SetInput( inputImage1 );
+      distanceMapFilter1->SetUseImageSpacing( true );
+      distanceMapFilter1->SetSquaredDistance( false );
+      std::cout << "Computing distance map D of input image 1..." << std::endl;
+      distanceMapFilter1->Update();
+      std::cout << "Distance map computed." << std::endl;
+      distanceMap1 = distanceMapFilter1->GetOutput();
+
+      /** Compute the distance map of image 2 */
+      distanceMapFilter2->SetInput( inputImage2 );
+      distanceMapFilter2->SetUseImageSpacing( true );
+      distanceMapFilter2->SetSquaredDistance( false );
+      std::cout << "Computing distance map D of input image 2..." << std::endl;
+      distanceMapFilter2->Update();
+      std::cout << "Distance map computed." << std::endl;
+
+      /** Find distanceMap2==0 pixels */
+      thresholder->SetInput( distanceMapFilter2->GetOutput() );
+      thresholder->SetUpperThreshold(minSpacing*0.5);
+      thresholder->SetLowerThreshold(-minSpacing*0.5);
+      thresholder->SetInsideValue(1.0);
+      thresholder->SetOutsideValue(0.0);
+      std::cout << "Thresholding distance map 2..." << std::endl;
+      thresholder->Update();
+      std::cout << "Done thresholding." << std::endl;
+
+      /** Save for the caller of this function */
+      edgeImage = thresholder->GetOutput();
+    }
+
     multiplier2->SetInput1( edgeImage );
-    multiplier2->SetInput2( distanceMapFilter1->GetOutput() );
+    multiplier2->SetInput2( distanceMap1 );
     multiplier2->Update();
     distanceTransformOnEdge = multiplier2->GetOutput();
     if( cartesianonly )
@@ -521,7 +563,7 @@ public:
     std::cout << "r = " << rtpSize[0] << std::endl;
     rtpSize[1] = thetasize;
     rtpSize[2] = phisize;
-    cscFilter1->SetInput( distanceMapFilter1->GetOutput() );
+    cscFilter1->SetInput( distanceMap1 );
     cscFilter1->SetMaskImage( toMaskImageCaster->GetOutput() );
     cscFilter1->SetOutputSize( rtpSize);
     cscFilter1->SetCenterOfRotation( cor );
@@ -533,6 +575,8 @@ public:
     cscFilter2->SetCenterOfRotation( cor );
     cscFilter2->SetMaximumNumberOfSamplesPerVoxel(samples);
     cscFilter2->SetInterpolator( interpolator2);
+    cscFilter1->SetUseRayCasting( rayCasting );
+    cscFilter2->SetUseRayCasting( rayCasting );
     std::cout << "Computing spherical transforms of D and E: S(D) and S(E)..." << std::endl;
     cscFilter1->GetRandomGenerator()->SetSeed(12345);
     cscFilter1->Update();
@@ -564,6 +608,158 @@ public:
 
   } // end SegmentationDistanceHelper()
 
+
+  /*
+   * ******************* ComputeNarrowBandDistances ****************
+   *
+   * Compute the signed distance map of image 1 only in a narrow band of
+   * one voxel around the edge of image 2, which is all that is used of it.
+   * The edge of an image consists of the object voxels that have a
+   * face-connected background neighbour, i.e. the zero level of its
+   * signed distance map. The distances to the edge of image 1 are found
+   * exactly with a kd-tree of its edge points, and are negative inside
+   * the object, as for the SignedMaurerDistanceMapImageFilter.
+   * Outside the band the distance map is zero.
+   */
+
+  template< class InputImageType1, class InputImageType2, class ImageType >
+  void ComputeNarrowBandDistances(
+    const InputImageType1 * inputImage1,
+    const InputImageType2 * inputImage2,
+    typename ImageType::Pointer & distanceMap1,
+    typename ImageType::Pointer & edgeImage )
+  {
+    /** constants */
+    const unsigned int Dimension = ImageType::ImageDimension;
+    typedef typename ImageType::PixelType               PixelType;
+    typedef typename ImageType::RegionType              RegionType;
+    typedef typename ImageType::IndexType               IndexType;
+    typedef typename ImageType::SizeType                SizeType;
+    typedef typename ImageType::PointType               PointType;
+    typedef itk::Vector<double, Dimension>              MeasurementVectorType;
+    typedef itk::Statistics::ListSample<
+      MeasurementVectorType >                           SampleType;
+    typedef itk::Statistics::KdTreeGenerator<
+      SampleType >                                      TreeGeneratorType;
+    typedef typename TreeGeneratorType::KdTreeType      TreeType;
+    typedef typename TreeType::InstanceIdentifierVectorType NeighborsType;
+    typedef itk::ImageRegionConstIteratorWithIndex<
+      InputImageType1 >                                 IteratorType1;
+    typedef itk::ImageRegionConstIteratorWithIndex<
+      InputImageType2 >                                 IteratorType2;
+    typedef itk::ImageRegionConstIteratorWithIndex<
+      ImageType >                                       BandIteratorType;
+
+    const RegionType region = inputImage1->GetLargestPossibleRegion();
+    if( inputImage2->GetLargestPossibleRegion() != region )
+    {
+      itkGenericExceptionMacro( << "ERROR: the input images do not have the same size." );
+    }
+
+    /** The kd-tree of the edge points of image 1. */
+    typename SampleType::Pointer edgePoints1 = SampleType::New();
+    edgePoints1->SetMeasurementVectorSize( Dimension );
+    for( IteratorType1 it( inputImage1, region ); !it.IsAtEnd(); ++it )
+    {
+      if( this->IsEdgeVoxel( inputImage1, it.GetIndex() ) )
+      {
+        PointType point;
+        inputImage1->TransformIndexToPhysicalPoint( it.GetIndex(), point );
+        edgePoints1->PushBack( point.GetVectorFromOrigin() );
+      }
+    }
+    if( edgePoints1->Size() == 0 )
+    {
+      itkGenericExceptionMacro( << "ERROR: input image 1 does not contain an object." );
+    }
+    typename TreeGeneratorType::Pointer treeGenerator = TreeGeneratorType::New();
+    treeGenerator->SetSample( edgePoints1 );
+    treeGenerator->SetBucketSize( 16 );
+    treeGenerator->Update();
+    typename TreeType::ConstPointer tree = treeGenerator->GetOutput();
+
+    /** Allocate the outputs. */
+    distanceMap1 = ImageType::New();
+    distanceMap1->CopyInformation( inputImage1 );
+    distanceMap1->SetRegions( region );
+    distanceMap1->Allocate();
+    distanceMap1->FillBuffer( itk::NumericTraits<PixelType>::Zero );
+    edgeImage = ImageType::New();
+    edgeImage->CopyInformation( inputImage1 );
+    edgeImage->SetRegions( region );
+    edgeImage->Allocate();
+    edgeImage->FillBuffer( itk::NumericTraits<PixelType>::Zero );
+    std::vector<bool> computed( region.GetNumberOfPixels(), false );
+
+    /** Compute the distances in the band around every edge voxel of image 2. */
+    NeighborsType neighbors;
+    for( IteratorType2 it( inputImage2, region ); !it.IsAtEnd(); ++it )
+    {
+      if( !this->IsEdgeVoxel( inputImage2, it.GetIndex() ) ) continue;
+      edgeImage->SetPixel( it.GetIndex(), itk::NumericTraits<PixelType>::One );
+
+      RegionType band;
+      IndexType bandIndex = it.GetIndex();
+      SizeType bandSize;
+      for( unsigned int i = 0; i < Dimension; ++i )
+      {
+        bandIndex[ i ] -= 1;
+        bandSize[ i ] = 3;
+      }
+      band.SetIndex( bandIndex );
+      band.SetSize( bandSize );
+      band.Crop( region );
+
+      for( BandIteratorType bit( distanceMap1, band ); !bit.IsAtEnd(); ++bit )
+      {
+        const IndexType & index = bit.GetIndex();
+        const std::size_t offset = distanceMap1->ComputeOffset( index );
+        if( computed[ offset ] ) continue;
+        computed[ offset ] = true;
+
+        PointType point;
+        distanceMap1->TransformIndexToPhysicalPoint( index, point );
+        const MeasurementVectorType query = point.GetVectorFromOrigin();
+        tree->Search( query, 1u, neighbors );
+        double distance = ( edgePoints1->GetMeasurementVector( neighbors[ 0 ] ) - query ).GetNorm();
+        if( inputImage1->GetPixel( index ) != itk::NumericTraits<
+          typename InputImageType1::PixelType >::Zero )
+        {
+          distance = -distance;
+        }
+        distanceMap1->SetPixel( index, static_cast<PixelType>( distance ) );
+      }
+    }
+
+  } // end ComputeNarrowBandDistances()
+
+
+  /** An edge voxel is an object voxel with a face-connected background
+   * neighbour; voxels outside the image count as background.
+   */
+  template< class TInputImage >
+  bool IsEdgeVoxel( const TInputImage * image, const typename TInputImage::IndexType & index ) const
+  {
+    typedef typename TInputImage::PixelType InputPixelType;
+    const InputPixelType background = itk::NumericTraits<InputPixelType>::Zero;
+    if( image->GetPixel( index ) == background ) return false;
+
+    const typename TInputImage::RegionType & region = image->GetLargestPossibleRegion();
+    for( unsigned int i = 0; i < TInputImage::ImageDimension; ++i )
+    {
+      for( int step = -1; step <= 1; step += 2 )
+      {
+        typename TInputImage::IndexType neighbor = index;
+        neighbor[ i ] += step;
+        if( !region.IsInside( neighbor ) || image->GetPixel( neighbor ) == background )
+        {
+          return true;
+        }
+      }
+    }
+    return false;
+  } // end IsEdgeVoxel()
+
 }; // end class ITKToolsSegmentationDistance
 
 #endif // end #ifndef __segmentationdistance_h_
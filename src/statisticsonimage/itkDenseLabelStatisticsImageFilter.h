@@ -0,0 +1,204 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef _itkDenseLabelStatisticsImageFilter_h_
+#define _itkDenseLabelStatisticsImageFilter_h_
+
+#include "itkImageToImageFilter.h"
+#include "itkNumericTraits.h"
+#include "itkQuantileSketch.h"
+#include <vector>
+
+
+namespace itk
+{
+
+/** \class DenseLabelStatisticsImageFilter
+ * \brief Compute the statistics of an image for all labels of a label
+ * image at once.
+ *
+ * For every label value present in the label image, the filter computes
+ * the number of pixels, minimum, maximum, mean, standard deviation,
+ * variance, sum and absolute mean, and optionally the mean and standard
+ * deviation of the log of the pixels and a QuantileSketch, in a single
+ * threaded pass over the image. An optional mask restricts all labels.
+ *
+ * Unlike itk::LabelStatisticsImageFilter, every thread accumulates in a
+ * dense table indexed by the label value, which is fast when the labels
+ * are a small range of integers, like for an organ segmentation. The range
+ * is determined from the label image beforehand, and may not exceed
+ * MaximumLabelRange. The mean and variance are accumulated with Welford's
+ * method, for numerical stability.
+ *
+ * The filter passes its input through unmodified.
+ */
+
+template< class TInputImage, class TLabelImage >
+class ITK_EXPORT DenseLabelStatisticsImageFilter :
+  public ImageToImageFilter< TInputImage, TInputImage >
+{
+public:
+  /** Standard Self typedef */
+  typedef DenseLabelStatisticsImageFilter   Self;
+  typedef ImageToImageFilter<
+    TInputImage, TInputImage >              Superclass;
+  typedef SmartPointer<Self>                Pointer;
+  typedef SmartPointer<const Self>          ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Runtime information support. */
+  itkTypeMacro( DenseLabelStatisticsImageFilter, ImageToImageFilter );
+
+  /** Image related typedefs. */
+  typedef TInputImage                               InputImageType;
+  typedef typename InputImageType::Pointer          InputImagePointer;
+  typedef typename InputImageType::RegionType       RegionType;
+  typedef typename InputImageType::PixelType        PixelType;
+  typedef TLabelImage                               LabelImageType;
+  typedef typename LabelImageType::Pointer          LabelImagePointer;
+  typedef typename LabelImageType::PixelType        LabelPixelType;
+
+  itkStaticConstMacro( ImageDimension, unsigned int,
+    InputImageType::ImageDimension );
+
+  /** Mask type, as in the StatisticsImageFilter. */
+  typedef Image< unsigned char,
+    itkGetStaticConstMacro( ImageDimension ) >      MaskType;
+  typedef typename MaskType::Pointer                MaskPointer;
+
+  /** Type to use for computations. */
+  typedef typename NumericTraits<PixelType>::RealType RealType;
+  typedef QuantileSketch< RealType >                QuantileSketchType;
+
+  /** The statistics of one label. */
+  struct LabelStatisticsType
+  {
+    LabelPixelType      Label;
+    SizeValueType       Count;
+    PixelType           Minimum;
+    PixelType           Maximum;
+    RealType            Mean;
+    RealType            Sigma;
+    RealType            Variance;
+    RealType            Sum;
+    RealType            AbsoluteMean;
+    RealType            MeanOfLog;
+    RealType            SigmaOfLog;
+    QuantileSketchType  Sketch;
+  };
+  typedef std::vector< LabelStatisticsType >        LabelStatisticsContainerType;
+
+  /** Set/Get the label image. */
+  itkSetObjectMacro( LabelImage, LabelImageType );
+  itkGetConstObjectMacro( LabelImage, LabelImageType );
+
+  /** Set/Get the mask. */
+  itkSetObjectMacro( Mask, MaskType );
+  itkGetConstObjectMacro( Mask, MaskType );
+
+  /** Also compute the mean and standard deviation of the log of the pixels.
+   * Default: false.
+   */
+  itkSetMacro( ComputeGeometricStatistics, bool );
+  itkGetConstMacro( ComputeGeometricStatistics, bool );
+
+  /** Also fill a quantile sketch for every label. Default: false. */
+  itkSetMacro( ComputeQuantileSketches, bool );
+  itkGetConstMacro( ComputeQuantileSketches, bool );
+
+  /** The maximum number of label values between the smallest and the largest
+   * label, which determines the size of the tables. Default: 65536.
+   */
+  itkSetMacro( MaximumLabelRange, SizeValueType );
+  itkGetConstMacro( MaximumLabelRange, SizeValueType );
+
+  /** Return the statistics of all labels that occur inside the mask,
+   * sorted by label value.
+   */
+  const LabelStatisticsContainerType & GetLabelStatistics( void ) const
+  { return this->m_LabelStatistics; }
+
+protected:
+  DenseLabelStatisticsImageFilter();
+  ~DenseLabelStatisticsImageFilter(){};
+  void PrintSelf( std::ostream& os, Indent indent ) const;
+
+  /** Pass the input through unmodified. */
+  void AllocateOutputs( void );
+
+  /** Determine the label range and initialize the tables. */
+  void BeforeThreadedGenerateData( void );
+
+  /** Merge the tables of the threads. */
+  void AfterThreadedGenerateData( void );
+
+  /** Multi-thread version GenerateData. */
+  void ThreadedGenerateData( const RegionType & outputRegionForThread,
+    ThreadIdType threadId );
+
+  /** The filter needs all of its input, and produces all of its output. */
+  void GenerateInputRequestedRegion( void );
+  void EnlargeOutputRequestedRegion( DataObject *data );
+
+private:
+  DenseLabelStatisticsImageFilter( const Self& ); // purposely not implemented
+  void operator=( const Self& ); // purposely not implemented
+
+  /** The running statistics of one label in one thread. */
+  struct AccumulatorType
+  {
+    SizeValueType Count;
+    PixelType     Minimum;
+    PixelType     Maximum;
+    RealType      Mean;
+    RealType      SumOfSquaredDeviations;
+    RealType      Sum;
+    RealType      AbsoluteSum;
+    RealType      LogMean;
+    RealType      LogSumOfSquaredDeviations;
+  };
+
+  /** Merge the statistics of b into a. */
+  static void MergeAccumulators( AccumulatorType & a, const AccumulatorType & b );
+
+  LabelImagePointer   m_LabelImage;
+  MaskPointer         m_Mask;
+  bool                m_ComputeGeometricStatistics;
+  bool                m_ComputeQuantileSketches;
+  SizeValueType       m_MaximumLabelRange;
+
+  /** The smallest label, which has index 0 in the tables. */
+  LabelPixelType      m_MinimumLabel;
+
+  /** A table for every thread. */
+  std::vector< std::vector< AccumulatorType > >     m_ThreadAccumulators;
+  std::vector< std::vector< QuantileSketchType > >  m_ThreadQuantileSketches;
+
+  LabelStatisticsContainerType m_LabelStatistics;
+
+}; // end class DenseLabelStatisticsImageFilter
+
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkDenseLabelStatisticsImageFilter.txx"
+#endif
+
+#endif // end #ifndef _itkDenseLabelStatisticsImageFilter_h_
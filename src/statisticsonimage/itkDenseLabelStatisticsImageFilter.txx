@@ -0,0 +1,342 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef _itkDenseLabelStatisticsImageFilter_txx_
+#define _itkDenseLabelStatisticsImageFilter_txx_
+
+#include "itkDenseLabelStatisticsImageFilter.h"
+
+#include "itkImageRegionConstIterator.h"
+#include "itkMinimumMaximumImageCalculator.h"
+#include "itkProgressReporter.h"
+#include "vnl/vnl_math.h"
+
+
+namespace itk
+{
+
+/**
+ * ********************* Constructor ****************************
+ */
+
+template< class TInputImage, class TLabelImage >
+DenseLabelStatisticsImageFilter< TInputImage, TLabelImage >
+::DenseLabelStatisticsImageFilter()
+{
+  this->m_LabelImage = 0;
+  this->m_Mask = 0;
+  this->m_ComputeGeometricStatistics = false;
+  this->m_ComputeQuantileSketches = false;
+  this->m_MaximumLabelRange = 65536;
+  this->m_MinimumLabel = NumericTraits<LabelPixelType>::Zero;
+
+} // end Constructor
+
+
+/**
+ * ********************* GenerateInputRequestedRegion ****************************
+ */
+
+template< class TInputImage, class TLabelImage >
+void
+DenseLabelStatisticsImageFilter< TInputImage, TLabelImage >
+::GenerateInputRequestedRegion( void )
+{
+  Superclass::GenerateInputRequestedRegion();
+  if( this->GetInput() )
+  {
+    InputImagePointer image =
+      const_cast< InputImageType * >( this->GetInput() );
+    image->SetRequestedRegionToLargestPossibleRegion();
+  }
+
+} // end GenerateInputRequestedRegion()
+
+
+/**
+ * ********************* EnlargeOutputRequestedRegion ****************************
+ */
+
+template< class TInputImage, class TLabelImage >
+void
+DenseLabelStatisticsImageFilter< TInputImage, TLabelImage >
+::EnlargeOutputRequestedRegion( DataObject * data )
+{
+  Superclass::EnlargeOutputRequestedRegion( data );
+  data->SetRequestedRegionToLargestPossibleRegion();
+
+} // end EnlargeOutputRequestedRegion()
+
+
+/**
+ * ********************* AllocateOutputs ****************************
+ */
+
+template< class TInputImage, class TLabelImage >
+void
+DenseLabelStatisticsImageFilter< TInputImage, TLabelImage >
+::AllocateOutputs( void )
+{
+  /** Pass the input through as the output. */
+  InputImagePointer image = const_cast< InputImageType * >( this->GetInput() );
+  this->GraftOutput( image );
+
+} // end AllocateOutputs()
+
+
+/**
+ * ********************* BeforeThreadedGenerateData ****************************
+ */
+
+template< class TInputImage, class TLabelImage >
+void
+DenseLabelStatisticsImageFilter< TInputImage, TLabelImage >
+::BeforeThreadedGenerateData( void )
+{
+  if( this->m_LabelImage.IsNull() )
+  {
+    itkExceptionMacro( << "No label image is set." );
+  }
+  if( this->m_LabelImage->GetLargestPossibleRegion() != this->GetInput()->GetLargestPossibleRegion() )
+  {
+    itkExceptionMacro( << "The label image should have the same size as the input image." );
+  }
+
+  /** Determine the range of the labels. This only reads the label image. */
+  typedef MinimumMaximumImageCalculator< LabelImageType > CalculatorType;
+  typename CalculatorType::Pointer calculator = CalculatorType::New();
+  calculator->SetImage( this->m_LabelImage );
+  calculator->Compute();
+  this->m_MinimumLabel = calculator->GetMinimum();
+  const double range = static_cast<double>( calculator->GetMaximum() )
+    - static_cast<double>( calculator->GetMinimum() ) + 1.0;
+  if( range > static_cast<double>( this->m_MaximumLabelRange ) )
+  {
+    itkExceptionMacro( << "The labels range from " << calculator->GetMinimum()
+      << " to " << calculator->GetMaximum() << ", which is more than the maximum of "
+      << this->m_MaximumLabelRange << " label values." );
+  }
+  const std::size_t numberOfLabels = static_cast<std::size_t>( range );
+
+  /** Initialize the tables of the threads. */
+  AccumulatorType empty;
+  empty.Count = 0;
+  empty.Minimum = NumericTraits<PixelType>::max();
+  empty.Maximum = NumericTraits<PixelType>::NonpositiveMin();
+  empty.Mean = empty.SumOfSquaredDeviations = empty.Sum = empty.AbsoluteSum
+    = empty.LogMean = empty.LogSumOfSquaredDeviations = NumericTraits<RealType>::Zero;
+
+  const ThreadIdType numberOfThreads = this->GetNumberOfThreads();
+  this->m_ThreadAccumulators.assign( numberOfThreads,
+    std::vector< AccumulatorType >( numberOfLabels, empty ) );
+  this->m_ThreadQuantileSketches.clear();
+  if( this->m_ComputeQuantileSketches )
+  {
+    this->m_ThreadQuantileSketches.assign( numberOfThreads,
+      std::vector< QuantileSketchType >( numberOfLabels ) );
+  }
+  this->m_LabelStatistics.clear();
+
+} // end BeforeThreadedGenerateData()
+
+
+/**
+ * ********************* ThreadedGenerateData ****************************
+ */
+
+template< class TInputImage, class TLabelImage >
+void
+DenseLabelStatisticsImageFilter< TInputImage, TLabelImage >
+::ThreadedGenerateData( const RegionType & outputRegionForThread, ThreadIdType threadId )
+{
+  const bool useMask = this->m_Mask.IsNotNull();
+  const bool computeGeometricStatistics = this->m_ComputeGeometricStatistics;
+  const LabelPixelType minimumLabel = this->m_MinimumLabel;
+  AccumulatorType * accumulators = &( this->m_ThreadAccumulators[ threadId ][ 0 ] );
+  QuantileSketchType * sketches = 0;
+  if( this->m_ComputeQuantileSketches )
+  {
+    sketches = &( this->m_ThreadQuantileSketches[ threadId ][ 0 ] );
+  }
+
+  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() );
+
+  ImageRegionConstIterator< InputImageType > itIm( this->GetInput(), outputRegionForThread );
+  ImageRegionConstIterator< LabelImageType > itLabel( this->m_LabelImage, outputRegionForThread );
+  ImageRegionConstIterator< MaskType > itMask;
+  if( useMask )
+  {
+    itMask = ImageRegionConstIterator< MaskType >( this->m_Mask, outputRegionForThread );
+  }
+
+  while( !itIm.IsAtEnd() )
+  {
+    if( !useMask || itMask.Value() )
+    {
+      const PixelType value = itIm.Get();
+      const RealType realValue = static_cast<RealType>( value );
+      const std::size_t index = static_cast<std::size_t>( itLabel.Get() - minimumLabel );
+      AccumulatorType & a = accumulators[ index ];
+
+      /** Welford's update of the mean and the squared deviations. */
+      ++a.Count;
+      const RealType count = static_cast<RealType>( a.Count );
+      const RealType delta = realValue - a.Mean;
+      a.Mean += delta / count;
+      a.SumOfSquaredDeviations += delta * ( realValue - a.Mean );
+      a.Sum += realValue;
+      a.AbsoluteSum += vnl_math_abs( realValue );
+      if( value < a.Minimum ) a.Minimum = value;
+      if( value > a.Maximum ) a.Maximum = value;
+
+      if( computeGeometricStatistics )
+      {
+        const RealType logValue = static_cast<RealType>(
+          vcl_log( static_cast<double>( value ) ) );
+        const RealType logDelta = logValue - a.LogMean;
+        a.LogMean += logDelta / count;
+        a.LogSumOfSquaredDeviations += logDelta * ( logValue - a.LogMean );
+      }
+
+      if( sketches )
+      {
+        sketches[ index ].Add( realValue );
+      }
+    }
+    ++itIm;
+    ++itLabel;
+    if( useMask ) ++itMask;
+    progress.CompletedPixel();
+  }
+
+} // end ThreadedGenerateData()
+
+
+/**
+ * ********************* MergeAccumulators ****************************
+ */
+
+template< class TInputImage, class TLabelImage >
+void
+DenseLabelStatisticsImageFilter< TInputImage, TLabelImage >
+::MergeAccumulators( AccumulatorType & a, const AccumulatorType & b )
+{
+  if( b.Count == 0 ) return;
+  if( a.Count == 0 )
+  {
+    a = b;
+    return;
+  }
+
+  /** Combine the squared deviations of two sets with different means. */
+  const RealType countA = static_cast<RealType>( a.Count );
+  const RealType countB = static_cast<RealType>( b.Count );
+  const RealType count = countA + countB;
+  const RealType delta = b.Mean - a.Mean;
+  const RealType logDelta = b.LogMean - a.LogMean;
+
+  a.SumOfSquaredDeviations += b.SumOfSquaredDeviations + delta * delta * countA * countB / count;
+  a.LogSumOfSquaredDeviations += b.LogSumOfSquaredDeviations + logDelta * logDelta * countA * countB / count;
+  a.Mean += delta * countB / count;
+  a.LogMean += logDelta * countB / count;
+  a.Count += b.Count;
+  a.Sum += b.Sum;
+  a.AbsoluteSum += b.AbsoluteSum;
+  if( b.Minimum < a.Minimum ) a.Minimum = b.Minimum;
+  if( b.Maximum > a.Maximum ) a.Maximum = b.Maximum;
+
+} // end MergeAccumulators()
+
+
+/**
+ * ********************* AfterThreadedGenerateData ****************************
+ */
+
+template< class TInputImage, class TLabelImage >
+void
+DenseLabelStatisticsImageFilter< TInputImage, TLabelImage >
+::AfterThreadedGenerateData( void )
+{
+  const std::size_t numberOfThreads = this->m_ThreadAccumulators.size();
+  const std::size_t numberOfLabels = this->m_ThreadAccumulators[ 0 ].size();
+
+  for( std::size_t label = 0; label < numberOfLabels; ++label )
+  {
+    /** Merge the threads. */
+    AccumulatorType total = this->m_ThreadAccumulators[ 0 ][ label ];
+    for( std::size_t i = 1; i < numberOfThreads; ++i )
+    {
+      MergeAccumulators( total, this->m_ThreadAccumulators[ i ][ label ] );
+    }
+    if( total.Count == 0 ) continue;
+
+    /** Compute the statistics; the variance is the unbiased estimate. */
+    const RealType count = static_cast<RealType>( total.Count );
+    LabelStatisticsType statistics;
+    statistics.Label = static_cast<LabelPixelType>( this->m_MinimumLabel + label );
+    statistics.Count = total.Count;
+    statistics.Minimum = total.Minimum;
+    statistics.Maximum = total.Maximum;
+    statistics.Mean = total.Mean;
+    statistics.Variance = total.Count > 1
+      ? total.SumOfSquaredDeviations / ( count - 1.0 ) : NumericTraits<RealType>::Zero;
+    statistics.Sigma = vcl_sqrt( statistics.Variance );
+    statistics.Sum = total.Sum;
+    statistics.AbsoluteMean = total.AbsoluteSum / count;
+    statistics.MeanOfLog = total.LogMean;
+    statistics.SigmaOfLog = total.Count > 1
+      ? vcl_sqrt( total.LogSumOfSquaredDeviations / ( count - 1.0 ) ) : NumericTraits<RealType>::Zero;
+    if( this->m_ComputeQuantileSketches )
+    {
+      for( std::size_t i = 0; i < numberOfThreads; ++i )
+      {
+        statistics.Sketch.Merge( this->m_ThreadQuantileSketches[ i ][ label ] );
+      }
+    }
+    this->m_LabelStatistics.push_back( statistics );
+  }
+
+  this->m_ThreadAccumulators.clear();
+  this->m_ThreadQuantileSketches.clear();
+
+} // end AfterThreadedGenerateData()
+
+
+/**
+ * ********************* PrintSelf ****************************
+ */
+
+template< class TInputImage, class TLabelImage >
+void
+DenseLabelStatisticsImageFilter< TInputImage, TLabelImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "LabelImage: " << this->m_LabelImage.GetPointer() << std::endl;
+  os << indent << "Mask: " << this->m_Mask.GetPointer() << std::endl;
+  os << indent << "ComputeGeometricStatistics: " << this->m_ComputeGeometricStatistics << std::endl;
+  os << indent << "ComputeQuantileSketches: " << this->m_ComputeQuantileSketches << std::endl;
+  os << indent << "MaximumLabelRange: " << this->m_MaximumLabelRange << std::endl;
+  os << indent << "NumberOfLabels: " << this->m_LabelStatistics.size() << std::endl;
+
+} // end PrintSelf()
+
+
+} // end namespace itk
+
+#endif // end #ifndef _itkDenseLabelStatisticsImageFilter_txx_
@@ -0,0 +1,129 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef _itkQuantileSketch_h_
+#define _itkQuantileSketch_h_
+
+#include <vector>
+
+
+namespace itk
+{
+
+/** \class QuantileSketch
+ * \brief QuantileSketch estimates quantiles of a stream of values,
+ * using bounded memory.
+ *
+ * The values are summarized by a t-digest: a sorted list of centroids
+ * (mean and weight), of which the weight is small near the minimum and
+ * maximum and larger in the middle. The quantiles are interpolated between
+ * the centroids. The error is therefore smallest for the tails, and for
+ * the median in the order of 1/compression of the range of the values.
+ * No minimum and maximum are needed beforehand.
+ *
+ * Sketches of separate parts of the data can be merged, so that e.g.
+ * every thread fills its own sketch. The memory use is in the order of
+ * the compression parameter, independent of the number of values.
+ *
+ * Reference:
+ * T. Dunning and O. Ertl, Computing extremely accurate quantiles using
+ * t-digests, 2019.
+ *
+ * This is a plain value class; it can be copied and stored in containers.
+ */
+
+template< class TRealType = double >
+class QuantileSketch
+{
+public:
+  /** Standard typedefs. */
+  typedef QuantileSketch      Self;
+  typedef TRealType           RealType;
+
+  /** Constructor. A larger compression gives more accurate quantiles,
+   * at the cost of more memory and time.
+   */
+  QuantileSketch( RealType compression = 200.0 );
+
+  /** Add a value with a weight. */
+  void Add( RealType value, RealType weight = 1.0 );
+
+  /** Add the values of another sketch. */
+  void Merge( const Self & other );
+
+  /** Merge the buffered values into the centroids. This is done
+   * automatically when needed.
+   */
+  void Compress( void ) const;
+
+  /** Estimate the quantile q, with 0 <= q <= 1. Returns 0 if the sketch
+   * is empty.
+   */
+  RealType Quantile( RealType q ) const;
+
+  /** Get the total weight, i.e. the number of values when all
+   * weights are 1.
+   */
+  RealType GetTotalWeight( void ) const
+  { return this->m_TotalWeight; }
+
+  /** Get the smallest and the largest value added. */
+  RealType GetMinimum( void ) const
+  { return this->m_Minimum; }
+  RealType GetMaximum( void ) const
+  { return this->m_Maximum; }
+
+  /** Get the number of centroids, which determines the memory use. */
+  unsigned long GetNumberOfCentroids( void ) const;
+
+  /** Get the compression. */
+  RealType GetCompression( void ) const
+  { return this->m_Compression; }
+
+protected:
+
+  struct CentroidType
+  {
+    RealType Mean;
+    RealType Weight;
+    bool operator<( const CentroidType & other ) const
+    { return this->Mean < other.Mean; }
+  };
+
+  /** Maps a quantile to the scale on which every centroid has size 1, and back. */
+  RealType QuantileToScale( RealType q ) const;
+  RealType ScaleToQuantile( RealType k ) const;
+
+  RealType        m_Compression;
+  RealType        m_TotalWeight;
+  RealType        m_Minimum;
+  RealType        m_Maximum;
+
+  /** The sorted centroids, and the values added since the last Compress(). */
+  mutable std::vector<CentroidType> m_Centroids;
+  mutable std::vector<CentroidType> m_Buffer;
+
+}; // end class QuantileSketch
+
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkQuantileSketch.txx"
+#endif
+
+#endif // end #ifndef _itkQuantileSketch_h_
@@ -0,0 +1,255 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef _itkQuantileSketch_txx_
+#define _itkQuantileSketch_txx_
+
+#include "itkQuantileSketch.h"
+
+#include "itkNumericTraits.h"
+#include "vnl/vnl_math.h"
+#include <algorithm>
+#include <cmath>
+
+
+namespace itk
+{
+
+/**
+ * ********************* Constructor ****************************
+ */
+
+template< class TRealType >
+QuantileSketch< TRealType >
+::QuantileSketch( RealType compression )
+{
+  this->m_Compression = vnl_math_max( compression, static_cast<RealType>( 10.0 ) );
+  this->m_TotalWeight = NumericTraits<RealType>::Zero;
+  this->m_Minimum = NumericTraits<RealType>::max();
+  this->m_Maximum = NumericTraits<RealType>::NonpositiveMin();
+
+} // end Constructor
+
+
+/**
+ * ********************* Add ****************************
+ */
+
+template< class TRealType >
+void
+QuantileSketch< TRealType >
+::Add( RealType value, RealType weight )
+{
+  if( !( weight > NumericTraits<RealType>::Zero ) ) return;
+
+  CentroidType centroid;
+  centroid.Mean = value;
+  centroid.Weight = weight;
+  this->m_Buffer.push_back( centroid );
+
+  this->m_TotalWeight += weight;
+  this->m_Minimum = vnl_math_min( this->m_Minimum, value );
+  this->m_Maximum = vnl_math_max( this->m_Maximum, value );
+
+  /** The buffer amortizes the sorting in Compress(). */
+  if( this->m_Buffer.size() >= static_cast<std::size_t>( 5.0 * this->m_Compression ) )
+  {
+    this->Compress();
+  }
+
+} // end Add()
+
+
+/**
+ * ********************* Merge ****************************
+ */
+
+template< class TRealType >
+void
+QuantileSketch< TRealType >
+::Merge( const Self & other )
+{
+  if( other.m_TotalWeight == NumericTraits<RealType>::Zero ) return;
+
+  this->m_Buffer.insert( this->m_Buffer.end(),
+    other.m_Centroids.begin(), other.m_Centroids.end() );
+  this->m_Buffer.insert( this->m_Buffer.end(),
+    other.m_Buffer.begin(), other.m_Buffer.end() );
+
+  this->m_TotalWeight += other.m_TotalWeight;
+  this->m_Minimum = vnl_math_min( this->m_Minimum, other.m_Minimum );
+  this->m_Maximum = vnl_math_max( this->m_Maximum, other.m_Maximum );
+
+  this->Compress();
+
+} // end Merge()
+
+
+/**
+ * ********************* QuantileToScale ****************************
+ *
+ * The k1 scale function of the t-digest: k(q) = delta / (2 pi) asin( 2q - 1 ).
+ */
+
+template< class TRealType >
+typename QuantileSketch< TRealType >::RealType
+QuantileSketch< TRealType >
+::QuantileToScale( RealType q ) const
+{
+  return this->m_Compression / ( 2.0 * vnl_math::pi )
+    * std::asin( 2.0 * q - 1.0 );
+
+} // end QuantileToScale()
+
+
+/**
+ * ********************* ScaleToQuantile ****************************
+ */
+
+template< class TRealType >
+typename QuantileSketch< TRealType >::RealType
+QuantileSketch< TRealType >
+::ScaleToQuantile( RealType k ) const
+{
+  if( k >= this->m_Compression / 4.0 ) return 1.0;
+  return ( std::sin( k * 2.0 * vnl_math::pi / this->m_Compression ) + 1.0 ) / 2.0;
+
+} // end ScaleToQuantile()
+
+
+/**
+ * ********************* Compress ****************************
+ *
+ * Sort all centroids and merge neighbours, as long as the merged centroid
+ * spans at most one unit on the scale k.
+ */
+
+template< class TRealType >
+void
+QuantileSketch< TRealType >
+::Compress( void ) const
+{
+  if( this->m_Buffer.empty() ) return;
+
+  std::vector<CentroidType> all;
+  all.reserve( this->m_Centroids.size() + this->m_Buffer.size() );
+  all.insert( all.end(), this->m_Centroids.begin(), this->m_Centroids.end() );
+  all.insert( all.end(), this->m_Buffer.begin(), this->m_Buffer.end() );
+  this->m_Buffer.clear();
+  std::sort( all.begin(), all.end() );
+
+  const RealType totalWeight = this->m_TotalWeight;
+  std::vector<CentroidType> & centroids = this->m_Centroids;
+  centroids.clear();
+
+  CentroidType current = all[ 0 ];
+  RealType weightSoFar = NumericTraits<RealType>::Zero;
+  RealType quantileLimit = this->ScaleToQuantile( this->QuantileToScale( 0.0 ) + 1.0 );
+  for( std::size_t i = 1; i < all.size(); ++i )
+  {
+    const RealType proposedWeight = current.Weight + all[ i ].Weight;
+    if( ( weightSoFar + proposedWeight ) / totalWeight <= quantileLimit )
+    {
+      /** Merge into the current centroid. */
+      current.Mean += ( all[ i ].Mean - current.Mean ) * all[ i ].Weight / proposedWeight;
+      current.Weight = proposedWeight;
+    }
+    else
+    {
+      /** Start a new centroid. */
+      weightSoFar += current.Weight;
+      centroids.push_back( current );
+      quantileLimit = this->ScaleToQuantile(
+        this->QuantileToScale( weightSoFar / totalWeight ) + 1.0 );
+      current = all[ i ];
+    }
+  }
+  centroids.push_back( current );
+
+} // end Compress()
+
+
+/**
+ * ********************* Quantile ****************************
+ *
+ * Every centroid is thought to be centered at its mean. The quantile is
+ * interpolated linearly between the means of neighbouring centroids, and
+ * between the minimum or maximum and the outer centroids.
+ */
+
+template< class TRealType >
+typename QuantileSketch< TRealType >::RealType
+QuantileSketch< TRealType >
+::Quantile( RealType q ) const
+{
+  this->Compress();
+
+  const std::vector<CentroidType> & centroids = this->m_Centroids;
+  if( centroids.empty() ) return NumericTraits<RealType>::Zero;
+  if( q <= 0.0 ) return this->m_Minimum;
+  if( q >= 1.0 ) return this->m_Maximum;
+  if( centroids.size() == 1 ) return centroids[ 0 ].Mean;
+
+  const RealType index = q * this->m_TotalWeight;
+
+  /** Between the minimum and the first centroid. */
+  RealType weightSoFar = centroids[ 0 ].Weight / 2.0;
+  if( index < weightSoFar )
+  {
+    return this->m_Minimum
+      + ( centroids[ 0 ].Mean - this->m_Minimum ) * index / weightSoFar;
+  }
+
+  /** Between two centroids. */
+  for( std::size_t i = 0; i + 1 < centroids.size(); ++i )
+  {
+    const RealType step = ( centroids[ i ].Weight + centroids[ i + 1 ].Weight ) / 2.0;
+    if( index < weightSoFar + step )
+    {
+      const RealType t = ( index - weightSoFar ) / step;
+      return centroids[ i ].Mean + t * ( centroids[ i + 1 ].Mean - centroids[ i ].Mean );
+    }
+    weightSoFar += step;
+  }
+
+  /** Between the last centroid and the maximum. */
+  const CentroidType & last = centroids.back();
+  const RealType t = vnl_math_min( static_cast<RealType>( 1.0 ),
+    ( index - weightSoFar ) / ( last.Weight / 2.0 ) );
+  return last.Mean + t * ( this->m_Maximum - last.Mean );
+
+} // end Quantile()
+
+
+/**
+ * ********************* GetNumberOfCentroids ****************************
+ */
+
+template< class TRealType >
+unsigned long
+QuantileSketch< TRealType >
+::GetNumberOfCentroids( void ) const
+{
+  this->Compress();
+  return static_cast<unsigned long>( this->m_Centroids.size() );
+
+} // end GetNumberOfCentroids()
+
+
+} // end namespace itk
+
+#endif // end #ifndef _itkQuantileSketch_txx_
@@ -0,0 +1,170 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef _itkSlabSampleStatistics_h_
+#define _itkSlabSampleStatistics_h_
+
+#include <vector>
+#include <cstddef>
+
+
+namespace itk
+{
+
+/** \class SlabSampleStatistics
+ * \brief SlabSampleStatistics estimates the statistics of an image from
+ * a sample of its slabs, with confidence intervals.
+ *
+ * The values of every sampled slab are added with AddSlab(). The slabs
+ * should be a simple random sample, without replacement, of the
+ * NumberOfSlabs slabs of the image. The mean, the standard deviation and
+ * the quantiles are estimated from the pooled values, i.e. as ratio
+ * estimators, so that slabs with fewer values, e.g. because of a mask,
+ * weigh less.
+ *
+ * The values within a slab are correlated, so the slabs, not the values,
+ * are the units of the sample. The variance of the mean and of the
+ * standard deviation are estimated with the delete-one-slab jackknife,
+ * with the finite population correction; the intervals use the Student
+ * t distribution with one degree of freedom less than the number of
+ * sampled slabs. The intervals of the quantiles are found with the method
+ * of Woodruff: the interval of the fraction of values below the quantile,
+ * estimated in the same way, is mapped back through the sample quantiles.
+ * When all slabs are sampled, the statistics are exact and the intervals
+ * have zero width.
+ *
+ * Reference:
+ * R.S. Woodruff, Confidence intervals for medians and other position
+ * measures, Journal of the American Statistical Association, 1952.
+ *
+ * All sampled values are kept, for the quantiles.
+ */
+
+template< class TRealType = double >
+class SlabSampleStatistics
+{
+public:
+  /** Standard typedefs. */
+  typedef SlabSampleStatistics  Self;
+  typedef TRealType             RealType;
+
+  /** Constructor, for a sample of the given number of slabs, and the
+   * confidence level of the intervals, e.g. 0.95.
+   */
+  SlabSampleStatistics( unsigned long numberOfSlabs = 1,
+    RealType confidenceLevel = 0.95 );
+
+  /** Add the values of a sampled slab; may be empty. */
+  void AddSlab( const std::vector<RealType> & values );
+
+  /** Get the number of slabs of the image, and of the sample. */
+  unsigned long GetNumberOfSlabs( void ) const
+  { return this->m_NumberOfSlabs; }
+  unsigned long GetNumberOfSampledSlabs( void ) const
+  { return static_cast<unsigned long>( this->m_Slabs.size() ); }
+
+  /** Get the confidence level of the intervals. */
+  RealType GetConfidenceLevel( void ) const
+  { return this->m_ConfidenceLevel; }
+
+  /** Get the number of sampled values, and the estimated number of
+   * values in all slabs.
+   */
+  std::size_t GetNumberOfValues( void ) const
+  { return this->m_Values.size(); }
+  RealType GetEstimatedNumberOfValues( void ) const;
+
+  /** Get the smallest and the largest sampled value. */
+  RealType GetMinimum( void ) const
+  { return this->m_Minimum; }
+  RealType GetMaximum( void ) const
+  { return this->m_Maximum; }
+
+  /** Estimate the mean, and its confidence interval. */
+  RealType GetMean( void ) const;
+  void GetMeanInterval( RealType & lower, RealType & upper ) const;
+
+  /** Get half the width of the confidence interval of the mean. */
+  RealType GetMeanHalfWidth( void ) const;
+
+  /** Estimate the standard deviation, and its confidence interval. */
+  RealType GetSigma( void ) const;
+  void GetSigmaInterval( RealType & lower, RealType & upper ) const;
+
+  /** Estimate the quantile q, with 0 <= q <= 1, and its confidence interval. */
+  RealType Quantile( RealType q ) const;
+  void GetQuantileInterval( RealType q, RealType & lower, RealType & upper ) const;
+
+protected:
+
+  /** The sums of a slab; the values are shifted by m_Reference, the first
+   * value, which avoids the cancellation in the variance.
+   */
+  struct SlabType
+  {
+    std::size_t Offset;
+    std::size_t Count;
+    RealType    Sum;
+    RealType    SumOfSquares;
+  };
+
+  /** The mean and the variance of the values without the given slab;
+   * of all values if slab is the number of slabs.
+   */
+  RealType ComputeMean( std::size_t slab ) const;
+  RealType ComputeVariance( std::size_t slab ) const;
+
+  /** The number of values of every sampled slab that are at most value. */
+  void ComputeCountsBelow( RealType value, std::vector<std::size_t> & counts ) const;
+
+  /** The jackknife variance of an estimator, from its estimates without
+   * every slab. Returns infinity if it cannot be estimated.
+   */
+  RealType ComputeJackknifeVariance( const std::vector<RealType> & estimates ) const;
+
+  /** Half the width of the interval of an estimator with the given variance. */
+  RealType ComputeHalfWidth( RealType variance ) const;
+
+  /** The quantile of the pooled values. */
+  RealType ComputeQuantile( RealType q ) const;
+
+  unsigned long   m_NumberOfSlabs;
+  RealType        m_ConfidenceLevel;
+  RealType        m_Reference;
+  RealType        m_Minimum;
+  RealType        m_Maximum;
+  std::size_t     m_Count;
+  RealType        m_Sum;
+  RealType        m_SumOfSquares;
+
+  /** The sampled slabs, and their values, sorted per slab. */
+  std::vector<SlabType> m_Slabs;
+  std::vector<RealType> m_Values;
+
+  /** All values sorted, for the quantiles; sorted when first needed. */
+  mutable std::vector<RealType> m_SortedValues;
+
+}; // end class SlabSampleStatistics
+
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkSlabSampleStatistics.txx"
+#endif
+
+#endif // end #ifndef _itkSlabSampleStatistics_h_
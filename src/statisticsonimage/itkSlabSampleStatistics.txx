@@ -0,0 +1,418 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef _itkSlabSampleStatistics_txx_
+#define _itkSlabSampleStatistics_txx_
+
+#include "itkSlabSampleStatistics.h"
+
+#include "itkNumericTraits.h"
+#include "itkTDistribution.h"
+#include "vnl/vnl_math.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+
+namespace itk
+{
+
+/**
+ * ********************* Constructor ****************************
+ */
+
+template< class TRealType >
+SlabSampleStatistics< TRealType >
+::SlabSampleStatistics( unsigned long numberOfSlabs, RealType confidenceLevel )
+{
+  this->m_NumberOfSlabs = numberOfSlabs;
+  this->m_ConfidenceLevel = confidenceLevel;
+  this->m_Reference = NumericTraits<RealType>::Zero;
+  this->m_Minimum = NumericTraits<RealType>::max();
+  this->m_Maximum = NumericTraits<RealType>::NonpositiveMin();
+  this->m_Count = 0;
+  this->m_Sum = NumericTraits<RealType>::Zero;
+  this->m_SumOfSquares = NumericTraits<RealType>::Zero;
+
+} // end Constructor
+
+
+/**
+ * ********************* AddSlab ****************************
+ */
+
+template< class TRealType >
+void
+SlabSampleStatistics< TRealType >
+::AddSlab( const std::vector<RealType> & values )
+{
+  if( this->m_Count == 0 && !values.empty() )
+  {
+    this->m_Reference = values[ 0 ];
+  }
+
+  SlabType slab;
+  slab.Offset = this->m_Values.size();
+  slab.Count = values.size();
+  slab.Sum = NumericTraits<RealType>::Zero;
+  slab.SumOfSquares = NumericTraits<RealType>::Zero;
+  for( std::size_t i = 0; i < values.size(); ++i )
+  {
+    const RealType value = values[ i ];
+    const RealType shifted = value - this->m_Reference;
+    slab.Sum += shifted;
+    slab.SumOfSquares += shifted * shifted;
+    this->m_Minimum = vnl_math_min( this->m_Minimum, value );
+    this->m_Maximum = vnl_math_max( this->m_Maximum, value );
+  }
+
+  this->m_Values.insert( this->m_Values.end(), values.begin(), values.end() );
+  std::sort( this->m_Values.begin() + slab.Offset, this->m_Values.end() );
+  this->m_Slabs.push_back( slab );
+
+  this->m_Count += slab.Count;
+  this->m_Sum += slab.Sum;
+  this->m_SumOfSquares += slab.SumOfSquares;
+
+} // end AddSlab()
+
+
+/**
+ * ********************* GetEstimatedNumberOfValues ****************************
+ */
+
+template< class TRealType >
+typename SlabSampleStatistics< TRealType >::RealType
+SlabSampleStatistics< TRealType >
+::GetEstimatedNumberOfValues( void ) const
+{
+  if( this->m_Slabs.empty() ) return NumericTraits<RealType>::Zero;
+  return static_cast<RealType>( this->m_Count )
+    * static_cast<RealType>( this->m_NumberOfSlabs )
+    / static_cast<RealType>( this->m_Slabs.size() );
+
+} // end GetEstimatedNumberOfValues()
+
+
+/**
+ * ********************* GetMean ****************************
+ */
+
+template< class TRealType >
+typename SlabSampleStatistics< TRealType >::RealType
+SlabSampleStatistics< TRealType >
+::GetMean( void ) const
+{
+  return this->ComputeMean( this->m_Slabs.size() );
+
+} // end GetMean()
+
+
+/**
+ * ********************* GetMeanHalfWidth ****************************
+ */
+
+template< class TRealType >
+typename SlabSampleStatistics< TRealType >::RealType
+SlabSampleStatistics< TRealType >
+::GetMeanHalfWidth( void ) const
+{
+  std::vector<RealType> estimates( this->m_Slabs.size() );
+  for( std::size_t i = 0; i < this->m_Slabs.size(); ++i )
+  {
+    estimates[ i ] = this->ComputeMean( i );
+  }
+  return this->ComputeHalfWidth( this->ComputeJackknifeVariance( estimates ) );
+
+} // end GetMeanHalfWidth()
+
+
+/**
+ * ********************* GetMeanInterval ****************************
+ */
+
+template< class TRealType >
+void
+SlabSampleStatistics< TRealType >
+::GetMeanInterval( RealType & lower, RealType & upper ) const
+{
+  const RealType mean = this->GetMean();
+  const RealType halfWidth = this->GetMeanHalfWidth();
+  lower = mean - halfWidth;
+  upper = mean + halfWidth;
+
+} // end GetMeanInterval()
+
+
+/**
+ * ********************* GetSigma ****************************
+ */
+
+template< class TRealType >
+typename SlabSampleStatistics< TRealType >::RealType
+SlabSampleStatistics< TRealType >
+::GetSigma( void ) const
+{
+  return std::sqrt( this->ComputeVariance( this->m_Slabs.size() ) );
+
+} // end GetSigma()
+
+
+/**
+ * ********************* GetSigmaInterval ****************************
+ */
+
+template< class TRealType >
+void
+SlabSampleStatistics< TRealType >
+::GetSigmaInterval( RealType & lower, RealType & upper ) const
+{
+  std::vector<RealType> estimates( this->m_Slabs.size() );
+  for( std::size_t i = 0; i < this->m_Slabs.size(); ++i )
+  {
+    estimates[ i ] = std::sqrt( this->ComputeVariance( i ) );
+  }
+  const RealType sigma = this->GetSigma();
+  const RealType halfWidth
+    = this->ComputeHalfWidth( this->ComputeJackknifeVariance( estimates ) );
+  lower = vnl_math_max( sigma - halfWidth, NumericTraits<RealType>::Zero );
+  upper = sigma + halfWidth;
+
+} // end GetSigmaInterval()
+
+
+/**
+ * ********************* Quantile ****************************
+ */
+
+template< class TRealType >
+typename SlabSampleStatistics< TRealType >::RealType
+SlabSampleStatistics< TRealType >
+::Quantile( RealType q ) const
+{
+  return this->ComputeQuantile( q );
+
+} // end Quantile()
+
+
+/**
+ * ********************* GetQuantileInterval ****************************
+ */
+
+template< class TRealType >
+void
+SlabSampleStatistics< TRealType >
+::GetQuantileInterval( RealType q, RealType & lower, RealType & upper ) const
+{
+  const std::size_t numberOfSlabs = this->m_Slabs.size();
+  const RealType quantile = this->ComputeQuantile( q );
+  if( this->m_Count == 0 )
+  {
+    lower = upper = quantile;
+    return;
+  }
+
+  /** The fraction of the values below the quantile, without every slab. */
+  std::vector<std::size_t> counts;
+  this->ComputeCountsBelow( quantile, counts );
+  std::size_t total = 0;
+  for( std::size_t i = 0; i < numberOfSlabs; ++i )
+  {
+    total += counts[ i ];
+  }
+  std::vector<RealType> estimates( numberOfSlabs );
+  for( std::size_t i = 0; i < numberOfSlabs; ++i )
+  {
+    const std::size_t count = this->m_Count - this->m_Slabs[ i ].Count;
+    estimates[ i ] = count > 0
+      ? static_cast<RealType>( total - counts[ i ] ) / static_cast<RealType>( count )
+      : static_cast<RealType>( total ) / static_cast<RealType>( this->m_Count );
+  }
+
+  /** Map the interval of the fraction back to the values. */
+  const RealType halfWidth
+    = this->ComputeHalfWidth( this->ComputeJackknifeVariance( estimates ) );
+  lower = this->ComputeQuantile( vnl_math_max( q - halfWidth, NumericTraits<RealType>::Zero ) );
+  upper = this->ComputeQuantile( vnl_math_min( q + halfWidth, NumericTraits<RealType>::One ) );
+
+} // end GetQuantileInterval()
+
+
+/**
+ * ********************* ComputeMean ****************************
+ */
+
+template< class TRealType >
+typename SlabSampleStatistics< TRealType >::RealType
+SlabSampleStatistics< TRealType >
+::ComputeMean( std::size_t slab ) const
+{
+  std::size_t count = this->m_Count;
+  RealType sum = this->m_Sum;
+  if( slab < this->m_Slabs.size() )
+  {
+    count -= this->m_Slabs[ slab ].Count;
+    sum -= this->m_Slabs[ slab ].Sum;
+  }
+  if( count == 0 ) return this->m_Reference;
+  return this->m_Reference + sum / static_cast<RealType>( count );
+
+} // end ComputeMean()
+
+
+/**
+ * ********************* ComputeVariance ****************************
+ */
+
+template< class TRealType >
+typename SlabSampleStatistics< TRealType >::RealType
+SlabSampleStatistics< TRealType >
+::ComputeVariance( std::size_t slab ) const
+{
+  std::size_t count = this->m_Count;
+  RealType sum = this->m_Sum;
+  RealType sumOfSquares = this->m_SumOfSquares;
+  if( slab < this->m_Slabs.size() )
+  {
+    count -= this->m_Slabs[ slab ].Count;
+    sum -= this->m_Slabs[ slab ].Sum;
+    sumOfSquares -= this->m_Slabs[ slab ].SumOfSquares;
+  }
+  if( count < 2 ) return NumericTraits<RealType>::Zero;
+  const RealType n = static_cast<RealType>( count );
+  return vnl_math_max( ( sumOfSquares - sum * sum / n ) / ( n - 1.0 ),
+    NumericTraits<RealType>::Zero );
+
+} // end ComputeVariance()
+
+
+/**
+ * ********************* ComputeCountsBelow ****************************
+ */
+
+template< class TRealType >
+void
+SlabSampleStatistics< TRealType >
+::ComputeCountsBelow( RealType value, std::vector<std::size_t> & counts ) const
+{
+  counts.resize( this->m_Slabs.size() );
+  for( std::size_t i = 0; i < this->m_Slabs.size(); ++i )
+  {
+    typename std::vector<RealType>::const_iterator begin
+      = this->m_Values.begin() + this->m_Slabs[ i ].Offset;
+    typename std::vector<RealType>::const_iterator end
+      = begin + this->m_Slabs[ i ].Count;
+    counts[ i ] = std::upper_bound( begin, end, value ) - begin;
+  }
+
+} // end ComputeCountsBelow()
+
+
+/**
+ * ********************* ComputeJackknifeVariance ****************************
+ */
+
+template< class TRealType >
+typename SlabSampleStatistics< TRealType >::RealType
+SlabSampleStatistics< TRealType >
+::ComputeJackknifeVariance( const std::vector<RealType> & estimates ) const
+{
+  /** All slabs sampled: exact. */
+  const std::size_t m = estimates.size();
+  if( m >= this->m_NumberOfSlabs ) return NumericTraits<RealType>::Zero;
+  if( m < 2 ) return std::numeric_limits<RealType>::infinity();
+
+  RealType mean = NumericTraits<RealType>::Zero;
+  for( std::size_t i = 0; i < m; ++i )
+  {
+    mean += estimates[ i ];
+  }
+  mean /= static_cast<RealType>( m );
+
+  RealType sumOfSquares = NumericTraits<RealType>::Zero;
+  for( std::size_t i = 0; i < m; ++i )
+  {
+    sumOfSquares += ( estimates[ i ] - mean ) * ( estimates[ i ] - mean );
+  }
+
+  /** The finite population correction, for sampling without replacement. */
+  const RealType fraction = static_cast<RealType>( m )
+    / static_cast<RealType>( this->m_NumberOfSlabs );
+  return ( 1.0 - fraction ) * static_cast<RealType>( m - 1 )
+    / static_cast<RealType>( m ) * sumOfSquares;
+
+} // end ComputeJackknifeVariance()
+
+
+/**
+ * ********************* ComputeHalfWidth ****************************
+ */
+
+template< class TRealType >
+typename SlabSampleStatistics< TRealType >::RealType
+SlabSampleStatistics< TRealType >
+::ComputeHalfWidth( RealType variance ) const
+{
+  if( !( variance > NumericTraits<RealType>::Zero ) ) return NumericTraits<RealType>::Zero;
+  if( variance == std::numeric_limits<RealType>::infinity() ) return variance;
+
+  typedef Statistics::TDistribution         DistributionType;
+  DistributionType::ParametersType degreesOfFreedom( 1 );
+  degreesOfFreedom[ 0 ] = static_cast<double>( this->m_Slabs.size() - 1 );
+  const RealType t = DistributionType::InverseCDF(
+    0.5 + 0.5 * this->m_ConfidenceLevel, degreesOfFreedom );
+
+  return t * std::sqrt( variance );
+
+} // end ComputeHalfWidth()
+
+
+/**
+ * ********************* ComputeQuantile ****************************
+ */
+
+template< class TRealType >
+typename SlabSampleStatistics< TRealType >::RealType
+SlabSampleStatistics< TRealType >
+::ComputeQuantile( RealType q ) const
+{
+  if( this->m_Values.empty() ) return NumericTraits<RealType>::Zero;
+  if( this->m_SortedValues.size() != this->m_Values.size() )
+  {
+    this->m_SortedValues = this->m_Values;
+    std::sort( this->m_SortedValues.begin(), this->m_SortedValues.end() );
+  }
+
+  /** Interpolate linearly between the order statistics. */
+  const RealType position = vnl_math_max( NumericTraits<RealType>::Zero,
+    vnl_math_min( q, NumericTraits<RealType>::One ) )
+    * static_cast<RealType>( this->m_SortedValues.size() - 1 );
+  const std::size_t index = static_cast<std::size_t>( position );
+  if( index + 1 >= this->m_SortedValues.size() )
+  {
+    return this->m_SortedValues.back();
+  }
+  const RealType weight = position - static_cast<RealType>( index );
+  return ( 1.0 - weight ) * this->m_SortedValues[ index ]
+    + weight * this->m_SortedValues[ index + 1 ];
+
+} // end ComputeQuantile()
+
+
+} // end namespace itk
+
+#endif // end #ifndef _itkSlabSampleStatistics_txx_
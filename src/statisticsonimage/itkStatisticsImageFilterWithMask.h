@@ -44,8 +44,12 @@
 
 #include "itkImageToImageFilter.h"
 #include "itkNumericTraits.h"
-#include "itkArray.h"
 #include "itkSimpleDataObjectDecorator.h"
+#include "itkHistogram.h"
+#include "itkQuantileSketch.h"
+#include "itkMaskSpanImageCalculator.h"
+#include "itkParallelReducer.h"
+#include <vector>
 
 
 namespace itk {
@@ -60,9 +64,28 @@ namespace itk {
  * recomputed if a downstream filter changes.
  *
  * The filter passes its input through unmodified.  The filter is
- * threaded. It computes statistics in each thread then combines them in
+ * threaded, with a ParallelReducer: it computes statistics for blocks of
+ * the image, which are merged in a fixed order, and then combines them in
  * its AfterThreadedGenerate method.
  *
+ * In the same pass over the image, the filter optionally computes the
+ * mean and standard deviation of the logarithm of the pixels, from which
+ * the geometric mean and standard deviation follow, and fills a histogram.
+ * The histogram should be initialized with the desired bins; pixels outside
+ * its range are not counted. Only pixels inside the mask are used for all
+ * of these, so that no masked copy of the image is needed. Also optionally,
+ * a QuantileSketch is filled, from which quantiles can be estimated
+ * without a histogram, and without knowing the minimum and maximum.
+ *
+ * By default, the sums and sums of squares are accumulated per block,
+ * which is fast, but may suffer from cancellation in the variance for
+ * large images with a large mean. The result does not depend on the
+ * number of threads. With UseStableAccumulation on, the statistics are instead
+ * computed per line of the image, with two passes over the line, and
+ * merged pairwise in a fixed order. This is numerically stable and gives
+ * the same result for any number of threads. It costs some memory for
+ * every line of the image.
+ *
  * \ingroup MathematicalStatisticsImageFilters
  */
 template<class TInputImage>
@@ -102,6 +125,14 @@ public:
   /** Smart Pointer type to a DataObject. */
   typedef typename DataObject::Pointer DataObjectPointer;
 
+  /** Histogram typedefs. */
+  typedef Statistics::Histogram< double >                 HistogramType;
+  typedef typename HistogramType::Pointer                 HistogramPointer;
+  typedef typename HistogramType::AbsoluteFrequencyType   AbsoluteFrequencyType;
+
+  /** Quantile sketch typedef. */
+  typedef QuantileSketch< RealType >                      QuantileSketchType;
+
   /** Type of DataObjects used for scalar outputs */
   typedef SimpleDataObjectDecorator<RealType>  RealObjectType;
   typedef SimpleDataObjectDecorator<PixelType> PixelObjectType;
@@ -113,6 +144,7 @@ public:
   typedef Image< unsigned char,
     itkGetStaticConstMacro( ImageDimension ) >    MaskType;
   typedef typename MaskType::Pointer              MaskPointer;
+  typedef MaskSpanImageCalculator< MaskType >     MaskSpansType;
 
   /** Return the computed Minimum. */
   PixelType GetMinimum() const
@@ -165,6 +197,37 @@ public:
   itkSetObjectMacro(Mask, MaskType);
   itkGetConstObjectMacro(Mask, MaskType);
 
+  /** Also compute the mean and standard deviation of the log of the pixels.
+   * Default: false.
+   */
+  itkSetMacro( ComputeGeometricStatistics, bool );
+  itkGetConstMacro( ComputeGeometricStatistics, bool );
+
+  /** Return the computed mean and standard deviation of the log of the pixels. */
+  itkGetConstMacro( MeanOfLog, RealType );
+  itkGetConstMacro( SigmaOfLog, RealType );
+
+  /** Set/Get an initialized histogram, to be filled in the same pass.
+   * Default: none.
+   */
+  itkSetObjectMacro( Histogram, HistogramType );
+  itkGetObjectMacro( Histogram, HistogramType );
+
+  /** Also fill a quantile sketch. Default: false. */
+  itkSetMacro( ComputeQuantileSketch, bool );
+  itkGetConstMacro( ComputeQuantileSketch, bool );
+
+  /** Return the quantile sketch of the pixels. */
+  const QuantileSketchType & GetQuantileSketch( void ) const
+  { return this->m_QuantileSketch; }
+
+  /** Compute the statistics per line and merge them pairwise, see above.
+   * Default: false.
+   */
+  itkSetMacro( UseStableAccumulation, bool );
+  itkGetConstMacro( UseStableAccumulation, bool );
+  itkBooleanMacro( UseStableAccumulation );
+
 protected:
   StatisticsImageFilter();
   ~StatisticsImageFilter(){};
@@ -179,9 +242,8 @@ protected:
   /** Do final mean and variance computation from data accumulated in threads. */
   void AfterThreadedGenerateData( void );
 
-  /** Multi-thread version GenerateData. */
-  void ThreadedGenerateData( const RegionType & outputRegionForThread,
-    ThreadIdType threadId );
+  /** Reduce the image with a ParallelReducer. */
+  void GenerateData( void );
 
   // Override since the filter needs all the data for the algorithm
   void GenerateInputRequestedRegion( void );
@@ -189,18 +251,123 @@ protected:
   // Override since the filter produces all of its output
   void EnlargeOutputRequestedRegion( DataObject *data );
 
-  MaskPointer m_Mask;
+  MaskPointer       m_Mask;
+
+  /** The inside of the mask, computed before the threads run. */
+  typename MaskSpansType::Pointer m_MaskSpans;
+  bool              m_ComputeGeometricStatistics;
+  RealType          m_MeanOfLog;
+  RealType          m_SigmaOfLog;
+  HistogramPointer  m_Histogram;
+  bool              m_UseStableAccumulation;
+  bool              m_ComputeQuantileSketch;
+  QuantileSketchType  m_QuantileSketch;
 
 private:
   StatisticsImageFilter(const Self&); //purposely not implemented
   void operator=(const Self&); //purposely not implemented
 
-  Array<RealType>  m_ThreadSum;
-  Array<RealType>  m_ThreadAbsoluteSum;
-  Array<RealType>  m_SumOfSquares;
-  Array<long>      m_Count;
-  Array<PixelType> m_ThreadMin;
-  Array<PixelType> m_ThreadMax;
+  /** The statistics of one line, or of a merged set of lines.
+   * Instead of the sum of squares, the sum of squared deviations from
+   * the mean is stored.
+   */
+  struct LineStatisticsType
+  {
+    SizeValueType Count;
+    RealType      Sum;
+    RealType      AbsoluteSum;
+    RealType      SumOfSquaredDeviations;
+    RealType      LogSum;
+    RealType      LogSumOfSquaredDeviations;
+  };
+
+  /** Merge the statistics of b into a. */
+  static void MergeLineStatistics( LineStatisticsType & a, const LineStatisticsType & b );
+
+  /** The statistics of every line, for UseStableAccumulation. */
+  std::vector< LineStatisticsType > m_LineStatistics;
+
+  /** The partial statistics of a block. With UseStableAccumulation, only
+   * the minimum, the maximum, the histogram and the quantile sketch are
+   * used; the rest is in the statistics of the lines. */
+  struct PartialType
+  {
+    SizeValueType Count;
+    RealType      Sum;
+    RealType      AbsoluteSum;
+    RealType      SumOfSquares;
+    RealType      LogSum;
+    RealType      LogSumOfSquares;
+    PixelType     Minimum;
+    PixelType     Maximum;
+    std::vector<AbsoluteFrequencyType>  Frequencies;
+    QuantileSketchType                  QuantileSketch;
+  };
+
+  /** The reducer of the ParallelReducer. */
+  class ReducerType
+  {
+  public:
+    typedef typename Self::RegionType   RegionType;
+    typedef typename Self::PartialType  PartialType;
+    Self * m_Filter;
+    void Initialize( PartialType & partial ) const;
+    void Reduce( const RegionType & block, PartialType & partial ) const
+    {
+      if( this->m_Filter->m_UseStableAccumulation )
+      {
+        this->m_Filter->ReduceBlockPerLine( block, partial );
+      }
+      else
+      {
+        this->m_Filter->ReduceBlock( block, partial );
+      }
+    }
+    void Merge( PartialType & partial, const PartialType & other ) const;
+  };
+
+  /** Add the pixels of a block to a partial. */
+  void ReduceBlock( const RegionType & block, PartialType & partial ) const;
+
+  /** ReduceBlock for UseStableAccumulation, which also stores the
+   * statistics of the lines of the block. */
+  void ReduceBlockPerLine( const RegionType & block, PartialType & partial );
+
+  /** The merged partial of all blocks. */
+  PartialType m_Total;
+
+  /** The bounds of the bins of the histogram, and the number of bins per
+   * unit, set before the threads run. */
+  std::vector<double> m_HistogramBinMinimums;
+  std::vector<double> m_HistogramBinMaximums;
+  double              m_HistogramBinScale;
+
+  /** The bin of a value, as Histogram::GetIndex() would give, but for
+   * uniform bins in constant time: the bin is computed from the value,
+   * and corrected with the bounds of the bins. Values outside the bins
+   * are passed to the histogram. Returns false if there is no bin. */
+  bool GetHistogramBin( double value, std::size_t & bin,
+    typename HistogramType::MeasurementVectorType & measurement,
+    typename HistogramType::IndexType & histogramIndex ) const
+  {
+    const std::size_t numberOfBins = this->m_HistogramBinMinimums.size();
+    if( numberOfBins > 0 && value >= this->m_HistogramBinMinimums[ 0 ]
+      && value < this->m_HistogramBinMaximums[ numberOfBins - 1 ] )
+    {
+      const double position
+        = ( value - this->m_HistogramBinMinimums[ 0 ] ) * this->m_HistogramBinScale;
+      bin = position < static_cast<double>( numberOfBins )
+        ? static_cast<std::size_t>( position ) : numberOfBins - 1;
+      while( bin > 0 && value < this->m_HistogramBinMinimums[ bin ] ) --bin;
+      while( bin + 1 < numberOfBins && !( value < this->m_HistogramBinMaximums[ bin ] ) ) ++bin;
+      return true;
+    }
+
+    measurement[ 0 ] = value;
+    if( !this->m_Histogram->GetIndex( measurement, histogramIndex ) ) return false;
+    bin = this->m_Histogram->GetInstanceIdentifier( histogramIndex );
+    return true;
+  }
 
 } ; // end of class
 
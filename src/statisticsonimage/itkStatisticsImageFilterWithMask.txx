@@ -37,15 +37,15 @@
 #include "itkStatisticsImageFilterWithMask.h"
 
 #include "itkImageRegionConstIterator.h"
+#include "itkImageLinearConstIteratorWithIndex.h"
 #include "itkNumericTraits.h"
-#include "itkProgressReporter.h"
 
 
 namespace itk {
 
 template<class TInputImage>
 StatisticsImageFilter<TInputImage>
-::StatisticsImageFilter(): m_ThreadSum(1), m_ThreadAbsoluteSum(1), m_SumOfSquares(1), m_Count(1), m_ThreadMin(1), m_ThreadMax(1)
+::StatisticsImageFilter()
 {
   // first output is a copy of the image, DataObject created by
   // superclass
@@ -76,6 +76,13 @@ StatisticsImageFilter<TInputImage>
   this->GetSumOutput()->Set( NumericTraits<RealType>::Zero );
 
   this->m_Mask = 0;
+  this->m_ComputeGeometricStatistics = false;
+  this->m_MeanOfLog = NumericTraits<RealType>::max();
+  this->m_SigmaOfLog = NumericTraits<RealType>::max();
+  this->m_Histogram = 0;
+  this->m_HistogramBinScale = 0.0;
+  this->m_UseStableAccumulation = false;
+  this->m_ComputeQuantileSketch = false;
 }
 
 
@@ -271,21 +278,55 @@ StatisticsImageFilter<TInputImage>
 {
   int numberOfThreads = this->GetNumberOfThreads();
 
-  // Resize the thread temporaries
-  this->m_Count.SetSize(numberOfThreads);
-  this->m_SumOfSquares.SetSize(numberOfThreads);
-  this->m_ThreadSum.SetSize(numberOfThreads);
-  this->m_ThreadAbsoluteSum.SetSize(numberOfThreads);
-  this->m_ThreadMin.SetSize(numberOfThreads);
-  this->m_ThreadMax.SetSize(numberOfThreads);
-
-  // Initialize the temporaries
-  this->m_Count.Fill(NumericTraits<long>::Zero);
-  this->m_ThreadSum.Fill(NumericTraits<RealType>::Zero);
-  this->m_ThreadAbsoluteSum.Fill(NumericTraits<RealType>::Zero);
-  this->m_SumOfSquares.Fill(NumericTraits<RealType>::Zero);
-  this->m_ThreadMin.Fill(NumericTraits<PixelType>::max());
-  this->m_ThreadMax.Fill(NumericTraits<PixelType>::NonpositiveMin());
+  // The inside of the mask as spans, so that the threads only visit the
+  // pixels inside the mask
+  this->m_MaskSpans = 0;
+  if( this->m_Mask.IsNotNull() )
+  {
+    this->m_MaskSpans = MaskSpansType::New();
+    this->m_MaskSpans->SetMaskImage( this->m_Mask );
+    this->m_MaskSpans->SetRegion( this->GetOutput()->GetRequestedRegion() );
+    this->m_MaskSpans->SetNumberOfThreads( numberOfThreads );
+    this->m_MaskSpans->Compute();
+  }
+
+  // One record for every line of the image
+  this->m_LineStatistics.clear();
+  if( this->m_UseStableAccumulation )
+  {
+    const RegionType & region = this->GetOutput()->GetRequestedRegion();
+    const LineStatisticsType empty = {
+      0, NumericTraits<RealType>::Zero, NumericTraits<RealType>::Zero,
+      NumericTraits<RealType>::Zero, NumericTraits<RealType>::Zero,
+      NumericTraits<RealType>::Zero };
+    this->m_LineStatistics.resize(
+      region.GetNumberOfPixels() / region.GetSize( 0 ), empty );
+  }
+
+  // The bounds of the bins, for GetHistogramBin()
+  this->m_HistogramBinMinimums.clear();
+  this->m_HistogramBinMaximums.clear();
+  this->m_HistogramBinScale = 0.0;
+  if( this->m_Histogram.IsNotNull() && this->m_Histogram->GetMeasurementVectorSize() == 1
+    && this->m_Histogram->Size() > 0 )
+  {
+    const std::size_t numberOfBins = this->m_Histogram->Size();
+    for( std::size_t bin = 0; bin < numberOfBins; ++bin )
+    {
+      this->m_HistogramBinMinimums.push_back( this->m_Histogram->GetBinMin( 0, bin ) );
+      this->m_HistogramBinMaximums.push_back( this->m_Histogram->GetBinMax( 0, bin ) );
+    }
+    const double range = this->m_HistogramBinMaximums.back() - this->m_HistogramBinMinimums[ 0 ];
+    if( range > 0.0 )
+    {
+      this->m_HistogramBinScale = static_cast<double>( numberOfBins ) / range;
+    }
+    else
+    {
+      this->m_HistogramBinMinimums.clear();
+      this->m_HistogramBinMaximums.clear();
+    }
+  }
 
 }
 
@@ -294,12 +335,11 @@ void
 StatisticsImageFilter<TInputImage>
 ::AfterThreadedGenerateData( void )
 {
-  int i;
+  this->m_MaskSpans = 0;
+
   long count;
   RealType sumOfSquares;
 
-  int numberOfThreads = this->GetNumberOfThreads();
-
   PixelType minimum;
   PixelType maximum;
   RealType  mean;
@@ -309,36 +349,50 @@ StatisticsImageFilter<TInputImage>
   RealType  sum;
   RealType  abssum;
 
-  sum = sumOfSquares = abssum = NumericTraits<RealType>::Zero;
-  count = 0;
-
-  // Find the min/max over all threads and accumulate count, sum and
-  // sum of squares
-  minimum = NumericTraits<PixelType>::max();
-  maximum = NumericTraits<PixelType>::NonpositiveMin();
-  for( i = 0; i < numberOfThreads; i++ )
+  // The merged partial of the blocks
+  const PartialType & partial = this->m_Total;
+  count = partial.Count;
+  sum = partial.Sum;
+  abssum = partial.AbsoluteSum;
+  sumOfSquares = partial.SumOfSquares;
+  minimum = partial.Minimum;
+  maximum = partial.Maximum;
+
+  // Merge the statistics of the lines pairwise, in a fixed order, so that
+  // the result does not depend on the number of threads
+  LineStatisticsType total = { 0 };
+  if( this->m_UseStableAccumulation )
     {
-    count += this->m_Count[ i ];
-    sum += this->m_ThreadSum[ i ];
-    abssum += this->m_ThreadAbsoluteSum[ i ];
-    sumOfSquares += this->m_SumOfSquares[ i ];
-
-    if( this->m_ThreadMin[ i ] < minimum)
+    std::vector<LineStatisticsType> & lines = this->m_LineStatistics;
+    for( std::size_t step = 1; step < lines.size(); step *= 2 )
       {
-      minimum = this->m_ThreadMin[ i ];
-      }
-    if( this->m_ThreadMax[ i ] > maximum)
-      {
-      maximum = this->m_ThreadMax[ i ];
+      for( std::size_t line = 0; line + step < lines.size(); line += 2 * step )
+        {
+        MergeLineStatistics( lines[ line ], lines[ line + step ] );
+        }
       }
+    total = lines[ 0 ];
+    this->m_LineStatistics.clear();
+
+    count = total.Count;
+    sum = total.Sum;
+    abssum = total.AbsoluteSum;
     }
+
   // compute statistics
   mean = sum / static_cast<RealType>( count );
   absmean = abssum / static_cast<RealType>( count );
 
   // unbiased estimate
-  variance = (sumOfSquares - (sum*sum / static_cast<RealType>(count)))
-    / (static_cast<RealType>(count) - 1);
+  if( this->m_UseStableAccumulation )
+    {
+    variance = total.SumOfSquaredDeviations / (static_cast<RealType>(count) - 1);
+    }
+  else
+    {
+    variance = (sumOfSquares - (sum*sum / static_cast<RealType>(count)))
+      / (static_cast<RealType>(count) - 1);
+    }
   // in case of numerical errors the variance might be <0.
   variance = vnl_math_max(0.0, variance);
   sigma = vcl_sqrt(variance);
@@ -351,34 +405,169 @@ StatisticsImageFilter<TInputImage>
   this->GetSigmaOutput()->Set( sigma );
   this->GetVarianceOutput()->Set( variance );
   this->GetSumOutput()->Set( sum );
+
+  // The statistics of the log of the pixels, computed the same way
+  if( this->m_ComputeGeometricStatistics )
+  {
+    RealType logSum = partial.LogSum;
+    RealType logSumOfSquares = partial.LogSumOfSquares;
+    RealType logVariance = ( logSumOfSquares - ( logSum * logSum / static_cast<RealType>( count ) ) )
+      / ( static_cast<RealType>( count ) - 1 );
+    if( this->m_UseStableAccumulation )
+    {
+      logSum = total.LogSum;
+      logVariance = total.LogSumOfSquaredDeviations / ( static_cast<RealType>( count ) - 1 );
+    }
+    logVariance = vnl_math_max( 0.0, logVariance );
+    this->m_MeanOfLog = logSum / static_cast<RealType>( count );
+    this->m_SigmaOfLog = vcl_sqrt( logVariance );
+  }
+
+  // The merged histogram and quantile sketch
+  if( this->m_Histogram.IsNotNull() )
+  {
+    const std::size_t numberOfBins = this->m_Histogram->Size();
+    for( std::size_t bin = 0; bin < numberOfBins; ++bin )
+    {
+      this->m_Histogram->SetFrequency( bin, partial.Frequencies[ bin ] );
+    }
+  }
+  this->m_QuantileSketch = partial.QuantileSketch;
+  this->m_Total = PartialType();
+}
+
+template<class TInputImage>
+void
+StatisticsImageFilter<TInputImage>
+::GenerateData( void )
+{
+  this->AllocateOutputs();
+  this->BeforeThreadedGenerateData();
+
+  ReducerType reducer;
+  reducer.m_Filter = this;
+
+  typedef ParallelReducer< ReducerType > ParallelReducerType;
+  typename ParallelReducerType::Pointer parallelReducer = ParallelReducerType::New();
+  parallelReducer->SetReducer( &reducer );
+  parallelReducer->SetRegion( this->GetOutput()->GetRequestedRegion() );
+  parallelReducer->SetNumberOfThreads( this->GetNumberOfThreads() );
+  parallelReducer->SetProgressFilter( this );
+  parallelReducer->Compute();
+  this->m_Total = parallelReducer->GetResult();
+  parallelReducer = 0;
+
+  this->AfterThreadedGenerateData();
+}
+
+template<class TInputImage>
+void
+StatisticsImageFilter<TInputImage>
+::ReducerType::Initialize( PartialType & partial ) const
+{
+  partial.Count = 0;
+  partial.Sum = NumericTraits<RealType>::Zero;
+  partial.AbsoluteSum = NumericTraits<RealType>::Zero;
+  partial.SumOfSquares = NumericTraits<RealType>::Zero;
+  partial.LogSum = NumericTraits<RealType>::Zero;
+  partial.LogSumOfSquares = NumericTraits<RealType>::Zero;
+  partial.Minimum = NumericTraits<PixelType>::max();
+  partial.Maximum = NumericTraits<PixelType>::NonpositiveMin();
+  partial.Frequencies.clear();
+  if( this->m_Filter->m_Histogram.IsNotNull() )
+  {
+    partial.Frequencies.assign( this->m_Filter->m_Histogram->Size(), 0 );
+  }
+  partial.QuantileSketch = QuantileSketchType();
+}
+
+template<class TInputImage>
+void
+StatisticsImageFilter<TInputImage>
+::ReducerType::Merge( PartialType & partial, const PartialType & other ) const
+{
+  partial.Count += other.Count;
+  partial.Sum += other.Sum;
+  partial.AbsoluteSum += other.AbsoluteSum;
+  partial.SumOfSquares += other.SumOfSquares;
+  partial.LogSum += other.LogSum;
+  partial.LogSumOfSquares += other.LogSumOfSquares;
+  if( other.Minimum < partial.Minimum )
+  {
+    partial.Minimum = other.Minimum;
+  }
+  if( other.Maximum > partial.Maximum )
+  {
+    partial.Maximum = other.Maximum;
+  }
+  for( std::size_t bin = 0; bin < partial.Frequencies.size(); ++bin )
+  {
+    partial.Frequencies[ bin ] += other.Frequencies[ bin ];
+  }
+  if( this->m_Filter->m_ComputeQuantileSketch )
+  {
+    partial.QuantileSketch.Merge( other.QuantileSketch );
+  }
 }
 
 template<class TInputImage>
 void
 StatisticsImageFilter<TInputImage>
-::ThreadedGenerateData( const RegionType& outputRegionForThread, ThreadIdType threadId )
+::ReduceBlock( const RegionType& block, PartialType & partial ) const
 {
   RealType realValue;
   PixelType value;
 
-  RealType sum = NumericTraits< RealType >::Zero;
-  RealType absoluteSum = NumericTraits< RealType >::Zero;
-  RealType sumOfSquares = NumericTraits< RealType >::Zero;
-  SizeValueType count = NumericTraits< SizeValueType >::Zero;
-  PixelType min = NumericTraits< PixelType >::max();
-  PixelType max = NumericTraits< PixelType >::NonpositiveMin();
+  RealType sum = partial.Sum;
+  RealType absoluteSum = partial.AbsoluteSum;
+  RealType sumOfSquares = partial.SumOfSquares;
+  RealType logSum = partial.LogSum;
+  RealType logSumOfSquares = partial.LogSumOfSquares;
+  SizeValueType count = partial.Count;
+  PixelType min = partial.Minimum;
+  PixelType max = partial.Maximum;
+
+  const bool useMask = this->m_Mask.IsNotNull();
+  const bool computeGeometricStatistics = this->m_ComputeGeometricStatistics;
+  const HistogramType * histogram = this->m_Histogram.GetPointer();
+  QuantileSketchType * quantileSketch = 0;
+  if( this->m_ComputeQuantileSketch )
+  {
+    quantileSketch = &( partial.QuantileSketch );
+  }
 
-  // support progress methods/callbacks
-  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() );
+  // Reuse the measurement and index, to avoid allocations per pixel
+  typename HistogramType::MeasurementVectorType measurement( 1 );
+  typename HistogramType::IndexType histogramIndex( 1 );
+  AbsoluteFrequencyType * frequencies = 0;
+  if( histogram )
+  {
+    frequencies = &( partial.Frequencies[ 0 ] );
+  }
 
-  if( this->m_Mask.IsNull() )
+  // Without a mask the block is visited as one span, with a mask only
+  // the parts of the spans of the mask inside the block
+  SizeValueType spanBegin = 0;
+  SizeValueType spanEnd = 1;
+  if( useMask )
   {
-    ImageRegionConstIterator<TInputImage> it( this->GetInput(), outputRegionForThread );
+    this->m_MaskSpans->GetSpanRange( block, spanBegin, spanEnd );
+  }
+
+  // do the work
+  RegionType spanRegion = block;
+  for( SizeValueType span = spanBegin; span < spanEnd; ++span )
+  {
+    if( useMask && !this->m_MaskSpans->GetSpanRegion(
+      span, block, spanRegion ) )
+    {
+      continue;
+    }
 
-    // do the work
-    while( !it.IsAtEnd() )
+    ImageRegionConstIterator< InputImageType > itIm( this->GetInput(), spanRegion );
+    for( ; !itIm.IsAtEnd(); ++itIm )
     {
-      value = it.Get();
+      value = itIm.Get();
       realValue = static_cast<RealType>( value );
       if( value < min )
       {
@@ -393,52 +582,249 @@ StatisticsImageFilter<TInputImage>
       absoluteSum += vnl_math_abs(realValue);
       sumOfSquares += (realValue * realValue);
       ++count;
-      ++it;
-      progress.CompletedPixel();
-    } // end while
-  } //end if
-  else
-  { //use a mask
-    ImageRegionConstIterator< InputImageType > itIm(
-      this->GetInput(), outputRegionForThread );
-    ImageRegionConstIterator< MaskType > itMask(
-      this->m_Mask, outputRegionForThread );
-    itIm.GoToBegin();
-    itMask.GoToBegin();
-    // do the work
-    while ( !itIm.IsAtEnd() )
+
+      if( computeGeometricStatistics )
+      {
+        const RealType logValue = static_cast<RealType>(
+          vcl_log( static_cast<double>( value ) ) );
+        logSum += logValue;
+        logSumOfSquares += logValue * logValue;
+      }
+
+      std::size_t bin = 0;
+      if( histogram && this->GetHistogramBin(
+        static_cast<double>( value ), bin, measurement, histogramIndex ) )
+      {
+        ++frequencies[ bin ];
+      }
+
+      if( quantileSketch )
+      {
+        quantileSketch->Add( realValue );
+      }
+    }
+  } // end for
+
+  partial.Sum = sum;
+  partial.AbsoluteSum = absoluteSum;
+  partial.SumOfSquares = sumOfSquares;
+  partial.Count = count;
+  partial.Minimum = min;
+  partial.Maximum = max;
+  partial.LogSum = logSum;
+  partial.LogSumOfSquares = logSumOfSquares;
+
+} // end ReduceBlock()
+
+
+template<class TInputImage>
+void
+StatisticsImageFilter<TInputImage>
+::ReduceBlockPerLine( const RegionType& region, PartialType & partial )
+{
+  // The lines are numbered within the requested region; the blocks of the
+  // ParallelReducer consist of whole lines
+  const RegionType & requestedRegion = this->GetOutput()->GetRequestedRegion();
+
+  const InputImageType * input = this->GetInput();
+  const MaskType * mask = this->m_Mask.GetPointer();
+  const bool computeGeometricStatistics = this->m_ComputeGeometricStatistics;
+  const HistogramType * histogram = this->m_Histogram.GetPointer();
+  QuantileSketchType * quantileSketch = 0;
+  if( this->m_ComputeQuantileSketch )
+  {
+    quantileSketch = &( partial.QuantileSketch );
+  }
+  const SizeValueType lineLength = region.GetSize( 0 );
+
+  PixelType min = partial.Minimum;
+  PixelType max = partial.Maximum;
+
+  // Line buffers: the weight is 1 inside and 0 outside the mask, and the
+  // values outside the mask are set to 0, so that the loops below need no
+  // branches on the mask
+  std::vector<PixelType> lineBuffer( lineLength );
+  std::vector<RealType> weights( lineLength, NumericTraits<RealType>::One );
+  std::vector<RealType> values( lineLength );
+  std::vector<RealType> logValues( computeGeometricStatistics ? lineLength : 0 );
+
+  typename HistogramType::MeasurementVectorType measurement( 1 );
+  typename HistogramType::IndexType histogramIndex( 1 );
+  AbsoluteFrequencyType * frequencies = 0;
+  if( histogram )
+  {
+    frequencies = &( partial.Frequencies[ 0 ] );
+  }
+
+  // The lines without spans of the mask are skipped; their records stay empty
+  const MaskSpansType * maskSpans = this->m_MaskSpans.GetPointer();
+  SizeValueType span = 0;
+  SizeValueType spanEnd = 0;
+  if( maskSpans )
+  {
+    maskSpans->GetSpanRange( region, span, spanEnd );
+  }
+
+  ImageLinearConstIteratorWithIndex< InputImageType > itLine( input, region );
+  itLine.SetDirection( 0 );
+  for( itLine.GoToBegin(); !itLine.IsAtEnd(); itLine.NextLine() )
+  {
+    const IndexType index = itLine.GetIndex();
+    if( maskSpans )
     {
-      if( itMask.Value() )
+      while( span < spanEnd
+        && MaskSpansType::CompareLines( maskSpans->GetSpans()[ span ].Index, index ) < 0 )
+      {
+        ++span;
+      }
+      if( span == spanEnd
+        || MaskSpansType::CompareLines( maskSpans->GetSpans()[ span ].Index, index ) != 0 )
       {
-        value = itIm.Get();
-        realValue = static_cast<RealType>( value );
-        if( value < min )
+        continue;
+      }
+    }
+
+    // Copy the line with the iterator, so that image adaptors, which
+    // compute their pixels on the fly, are supported too
+    for( SizeValueType i = 0; !itLine.IsAtEndOfLine(); ++i, ++itLine )
+    {
+      lineBuffer[ i ] = itLine.Get();
+    }
+    const PixelType * pixels = &( lineBuffer[ 0 ] );
+    if( mask )
+    {
+      const unsigned char * maskPixels
+        = mask->GetBufferPointer() + mask->ComputeOffset( index );
+      for( SizeValueType i = 0; i < lineLength; ++i )
+      {
+        weights[ i ] = maskPixels[ i ] ? NumericTraits<RealType>::One : NumericTraits<RealType>::Zero;
+      }
+    }
+
+    // First pass: count, sums, minimum and maximum
+    RealType count = NumericTraits<RealType>::Zero;
+    RealType sum = NumericTraits<RealType>::Zero;
+    RealType absoluteSum = NumericTraits<RealType>::Zero;
+    for( SizeValueType i = 0; i < lineLength; ++i )
+    {
+      const bool inside = weights[ i ] != NumericTraits<RealType>::Zero;
+      const PixelType value = pixels[ i ];
+      const RealType realValue = inside ? static_cast<RealType>( value ) : NumericTraits<RealType>::Zero;
+      values[ i ] = realValue;
+      count += weights[ i ];
+      sum += realValue;
+      absoluteSum += vnl_math_abs( realValue );
+      min = ( inside && value < min ) ? value : min;
+      max = ( inside && value > max ) ? value : max;
+    }
+
+    RealType logSum = NumericTraits<RealType>::Zero;
+    if( computeGeometricStatistics )
+    {
+      for( SizeValueType i = 0; i < lineLength; ++i )
+      {
+        logValues[ i ] = weights[ i ] != NumericTraits<RealType>::Zero
+          ? static_cast<RealType>( vcl_log( static_cast<double>( values[ i ] ) ) )
+          : NumericTraits<RealType>::Zero;
+        logSum += logValues[ i ];
+      }
+    }
+
+    // Second pass: the squared deviations from the mean of the line
+    RealType sumOfSquaredDeviations = NumericTraits<RealType>::Zero;
+    RealType logSumOfSquaredDeviations = NumericTraits<RealType>::Zero;
+    if( count > NumericTraits<RealType>::Zero )
+    {
+      const RealType mean = sum / count;
+      for( SizeValueType i = 0; i < lineLength; ++i )
+      {
+        const RealType deviation = values[ i ] - mean;
+        sumOfSquaredDeviations += weights[ i ] * deviation * deviation;
+      }
+      if( computeGeometricStatistics )
+      {
+        const RealType logMean = logSum / count;
+        for( SizeValueType i = 0; i < lineLength; ++i )
         {
-          min = value;
+          const RealType deviation = logValues[ i ] - logMean;
+          logSumOfSquaredDeviations += weights[ i ] * deviation * deviation;
         }
-        if( value > max )
+      }
+    }
+
+    if( histogram )
+    {
+      for( SizeValueType i = 0; i < lineLength; ++i )
+      {
+        if( weights[ i ] == NumericTraits<RealType>::Zero ) continue;
+        std::size_t bin = 0;
+        if( this->GetHistogramBin(
+          static_cast<double>( pixels[ i ] ), bin, measurement, histogramIndex ) )
         {
-          max = value;
+          ++frequencies[ bin ];
         }
+      }
+    }
 
-        sum += realValue;
-        absoluteSum += vnl_math_abs(realValue);
-        sumOfSquares += (realValue * realValue);
-        ++count;
+    if( quantileSketch )
+    {
+      for( SizeValueType i = 0; i < lineLength; ++i )
+      {
+        if( weights[ i ] == NumericTraits<RealType>::Zero ) continue;
+        quantileSketch->Add( values[ i ] );
       }
-      ++itIm; ++itMask;
-      progress.CompletedPixel();
-    } // end while
-  } // end else
+    }
+
+    // Store the statistics of this line
+    SizeValueType line = 0;
+    SizeValueType stride = 1;
+    for( unsigned int d = 1; d < ImageDimension; ++d )
+    {
+      line += static_cast<SizeValueType>( index[ d ] - requestedRegion.GetIndex( d ) ) * stride;
+      stride *= requestedRegion.GetSize( d );
+    }
+    LineStatisticsType & statistics = this->m_LineStatistics[ line ];
+    statistics.Count = static_cast<SizeValueType>( count );
+    statistics.Sum = sum;
+    statistics.AbsoluteSum = absoluteSum;
+    statistics.SumOfSquaredDeviations = sumOfSquaredDeviations;
+    statistics.LogSum = logSum;
+    statistics.LogSumOfSquaredDeviations = logSumOfSquaredDeviations;
+  } // end for
+
+  partial.Minimum = min;
+  partial.Maximum = max;
+
+} // end ReduceBlockPerLine()
+
+
+template<class TInputImage>
+void
+StatisticsImageFilter<TInputImage>
+::MergeLineStatistics( LineStatisticsType & a, const LineStatisticsType & b )
+{
+  if( b.Count == 0 ) return;
+  if( a.Count == 0 )
+  {
+    a = b;
+    return;
+  }
+
+  // Combine the squared deviations of two sets with different means
+  const RealType countA = static_cast<RealType>( a.Count );
+  const RealType countB = static_cast<RealType>( b.Count );
+  const RealType factor = countA * countB / ( countA + countB );
+  const RealType delta = b.Sum / countB - a.Sum / countA;
+  const RealType logDelta = b.LogSum / countB - a.LogSum / countA;
 
-  this->m_ThreadSum[threadId] = sum;
-  this->m_ThreadAbsoluteSum[threadId] = absoluteSum;
-  this->m_SumOfSquares[threadId] = sumOfSquares;
-  this->m_Count[threadId] = count;
-  this->m_ThreadMin[threadId] = min;
-  this->m_ThreadMax[threadId] = max;
+  a.SumOfSquaredDeviations += b.SumOfSquaredDeviations + factor * delta * delta;
+  a.LogSumOfSquaredDeviations += b.LogSumOfSquaredDeviations + factor * logDelta * logDelta;
+  a.Count += b.Count;
+  a.Sum += b.Sum;
+  a.AbsoluteSum += b.AbsoluteSum;
+  a.LogSum += b.LogSum;
 
-} // end ThreadedGenerateData()
+} // end MergeLineStatistics()
 
 
 template <class TImage>
@@ -457,6 +843,12 @@ StatisticsImageFilter<TImage>
   os << indent << "Absolute Mean: "     << this->GetAbsoluteMean() << std::endl;
   os << indent << "Sigma: "    << this->GetSigma() << std::endl;
   os << indent << "Variance: " << this->GetVariance() << std::endl;
+  os << indent << "ComputeGeometricStatistics: " << this->m_ComputeGeometricStatistics << std::endl;
+  os << indent << "MeanOfLog: " << this->m_MeanOfLog << std::endl;
+  os << indent << "SigmaOfLog: " << this->m_SigmaOfLog << std::endl;
+  os << indent << "Histogram: " << this->m_Histogram.GetPointer() << std::endl;
+  os << indent << "UseStableAccumulation: " << this->m_UseStableAccumulation << std::endl;
+  os << indent << "ComputeQuantileSketch: " << this->m_ComputeQuantileSketch << std::endl;
 }
 
 
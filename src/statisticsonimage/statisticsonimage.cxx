@@ -48,12 +48,45 @@ std::string GetHelpString( void )
     << "  [-mask]  MaskFileName, mask should have the same size as the input image\n"
     << "           and be of pixeltype (convertable to) unsigned char,\n"
     << "           1 = within mask, 0 = outside mask;\n"
+    << "  [-labels] LabelFileName, compute the statistics of every label at once,\n"
+    << "           in a single pass, and print them as a table; the percentiles\n"
+    << "           are then estimated with a quantile sketch per label;\n"
+    << "           with -out, the table is written to that file instead;\n"
+    << "           the labels should be integers, from a range of at most 65536;\n"
     << "  [-b]     NumberOfBins to use for histogram, default: 100;\n"
     << "           for an accurate estimate of median and quartiles\n"
     << "           for integer images, choose the number of bins\n"
     << "           much larger (~100x) than the number of gray values.\n"
     << "           if equal 0, then the intensity range (max - min) is chosen.\n"
+    << "  [-range] minimum and maximum of the histogram; the histogram is then\n"
+    << "           computed in the same pass as the other statistics, instead of\n"
+    << "           in a second pass over the intensity range; values outside the\n"
+    << "           range are not counted.\n"
     << "  [-s]     select which to compute {arithmetic, geometric, histogram}, default all;\n"
+    << "  [-sketch] estimate the median, quartiles and 15th percentile with a\n"
+    << "           quantile sketch, in the same pass as the other statistics,\n"
+    << "           instead of with a histogram in a separate pass;\n"
+    << "           this needs no bins, and bounded memory;\n"
+    << "           the histogram is then only computed if -out is given.\n"
+    << "  [-sample] fraction of the slabs, the slices along the last dimension,\n"
+    << "           from which the statistics are estimated, 0 < fraction <= 1;\n"
+    << "           only the sampled slabs are read if the image format can stream;\n"
+    << "           the mean, stdev and percentiles are printed with confidence\n"
+    << "           intervals; no histogram or geometric statistics are computed;\n"
+    << "           with -targetError, the maximum fraction, default 1.\n"
+    << "  [-targetError] sample slabs until half the confidence interval of the\n"
+    << "           mean is at most this error, in the units of the image.\n"
+    << "  [-sampleMode] the order of the sampled slabs {random, strided},\n"
+    << "           default random; strided spreads them evenly over the image.\n"
+    << "  [-seed]  seed of the random sample, default 0.\n"
+    << "  [-confidence] confidence level of the intervals, default 0.95.\n"
+    << "  [-internalType] the type of the gray values or vector magnitudes,\n"
+    << "           float or double, default double; float halves the memory of\n"
+    << "           scalar images, the sums are accumulated in double either way.\n"
+    << "  [-cache] store the statistics of a scalar image without -mask and\n"
+    << "           -labels in in + .statistics, where e.g. pxrescaleintensityimagefilter,\n"
+    << "           pxthresholdimage and pxhistogramequalizeimage find them with -cache;\n"
+    << "           for integer images this includes the histogram of all values.\n"
     << "Supported: 2D, 3D, 4D, float, (unsigned) short, (unsigned) char, 1, 2 or 3 components per pixel.\n"
     << "For 4D, only 1 or 4 components per pixel are supported.";
 
@@ -64,10 +97,8 @@ std::string GetHelpString( void )
 
 //-------------------------------------------------------------------------------------
 
-int main( int argc, char ** argv )
+int StatisticsOnImageMain( int argc, char ** argv )
 {
-  RegisterMevisDicomTiff();
-
   /** Create a command line argument parser. */
   itk::CommandLineArgumentParser::Pointer parser = itk::CommandLineArgumentParser::New();
   parser->SetCommandLineArguments( argc, argv );
@@ -93,6 +124,9 @@ int main( int argc, char ** argv )
   std::string maskFileName = "";
   parser->GetCommandLineArgument( "-mask", maskFileName );
 
+  std::string labelFileName = "";
+  parser->GetCommandLineArgument( "-labels", labelFileName );
+
   std::string histogramOutputFileName = "";
   parser->GetCommandLineArgument( "-out", histogramOutputFileName );
 
@@ -102,6 +136,37 @@ int main( int argc, char ** argv )
   std::string select = "";
   bool rets = parser->GetCommandLineArgument( "-s", select );
 
+  const bool useQuantileSketch = parser->ArgumentExists( "-sketch" );
+
+  std::vector<double> histogramRange;
+  bool retr = parser->GetCommandLineArgument( "-range", histogramRange );
+
+  const bool useCacheFile = parser->ArgumentExists( "-cache" );
+
+  const bool useSampling = parser->ArgumentExists( "-sample" )
+    || parser->ArgumentExists( "-targetError" );
+
+  double sampleFraction = 1.0;
+  parser->GetCommandLineArgument( "-sample", sampleFraction );
+
+  double targetError = 0.0;
+  bool rett = parser->GetCommandLineArgument( "-targetError", targetError );
+
+  std::string sampleMode = "random";
+  parser->GetCommandLineArgument( "-sampleMode", sampleMode );
+
+  unsigned int seed = 0;
+  parser->GetCommandLineArgument( "-seed", seed );
+
+  double confidenceLevel = 0.95;
+  parser->GetCommandLineArgument( "-confidence", confidenceLevel );
+
+  itk::ImageIOBase::IOComponentType internalComponentType = itk::ImageIOBase::DOUBLE;
+  if( !itktools::GetInternalComponentType( parser, internalComponentType ) )
+  {
+    return EXIT_FAILURE;
+  }
+
   /** Check selection. */
   if( rets && ( select != "arithmetic" && select != "geometric"
     && select != "histogram" ) )
@@ -111,6 +176,47 @@ int main( int argc, char ** argv )
     return EXIT_FAILURE;
   }
 
+  if( retr && ( histogramRange.size() != 2 || !( histogramRange[ 0 ] < histogramRange[ 1 ] ) ) )
+  {
+    std::cerr << "ERROR: -range should be a minimum and a larger maximum"
+      << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if( useSampling )
+  {
+    if( !( sampleFraction > 0.0 && sampleFraction <= 1.0 ) )
+    {
+      std::cerr << "ERROR: -sample should be a fraction larger than 0 and at most 1"
+        << std::endl;
+      return EXIT_FAILURE;
+    }
+    if( rett && !( targetError > 0.0 ) )
+    {
+      std::cerr << "ERROR: -targetError should be positive" << std::endl;
+      return EXIT_FAILURE;
+    }
+    if( sampleMode != "random" && sampleMode != "strided" )
+    {
+      std::cerr << "ERROR: -sampleMode should be one of {random, strided}"
+        << std::endl;
+      return EXIT_FAILURE;
+    }
+    if( !( confidenceLevel > 0.0 && confidenceLevel < 1.0 ) )
+    {
+      std::cerr << "ERROR: -confidence should be larger than 0 and smaller than 1"
+        << std::endl;
+      return EXIT_FAILURE;
+    }
+    if( labelFileName != "" || histogramOutputFileName != "" || select == "geometric"
+      || useCacheFile )
+    {
+      std::cerr << "ERROR: -sample and -targetError cannot be combined with "
+        << "-labels, -out, -s geometric or -cache" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
   /** Determine image properties. */
   itk::ImageIOBase::IOPixelType pixelType = itk::ImageIOBase::UNKNOWNPIXELTYPE;
   itk::ImageIOBase::IOComponentType componentType = itk::ImageIOBase::UNKNOWNCOMPONENTTYPE;
@@ -135,18 +241,26 @@ int main( int argc, char ** argv )
   try
   {
     // now call all possible template combinations.
-    if( !filter ) filter = ITKToolsStatisticsOnImage< 2, 1, float >::New( dim, numberOfComponents, componentType );
-    if( !filter ) filter = ITKToolsStatisticsOnImage< 2, 2, float >::New( dim, numberOfComponents, componentType );
-    if( !filter ) filter = ITKToolsStatisticsOnImage< 2, 3, float >::New( dim, numberOfComponents, componentType );
+    if( !filter ) filter = ITKToolsStatisticsOnImage< 2, 1, float, double >::New( dim, numberOfComponents, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsStatisticsOnImage< 2, 1, float, float >::New( dim, numberOfComponents, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsStatisticsOnImage< 2, 2, float, double >::New( dim, numberOfComponents, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsStatisticsOnImage< 2, 2, float, float >::New( dim, numberOfComponents, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsStatisticsOnImage< 2, 3, float, double >::New( dim, numberOfComponents, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsStatisticsOnImage< 2, 3, float, float >::New( dim, numberOfComponents, componentType, internalComponentType );
 
 #ifdef ITKTOOLS_3D_SUPPORT
-    if( !filter ) filter = ITKToolsStatisticsOnImage< 3, 1, float >::New( dim, numberOfComponents, componentType );
-    if( !filter ) filter = ITKToolsStatisticsOnImage< 3, 2, float >::New( dim, numberOfComponents, componentType );
-    if( !filter ) filter = ITKToolsStatisticsOnImage< 3, 3, float >::New( dim, numberOfComponents, componentType );
+    if( !filter ) filter = ITKToolsStatisticsOnImage< 3, 1, float, double >::New( dim, numberOfComponents, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsStatisticsOnImage< 3, 1, float, float >::New( dim, numberOfComponents, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsStatisticsOnImage< 3, 2, float, double >::New( dim, numberOfComponents, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsStatisticsOnImage< 3, 2, float, float >::New( dim, numberOfComponents, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsStatisticsOnImage< 3, 3, float, double >::New( dim, numberOfComponents, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsStatisticsOnImage< 3, 3, float, float >::New( dim, numberOfComponents, componentType, internalComponentType );
 #endif
 #ifdef ITKTOOLS_4D_SUPPORT
-    if( !filter ) filter = ITKToolsStatisticsOnImage< 4, 1, float >::New( dim, numberOfComponents, componentType );
-    if( !filter ) filter = ITKToolsStatisticsOnImage< 4, 4, float >::New( dim, numberOfComponents, componentType );
+    if( !filter ) filter = ITKToolsStatisticsOnImage< 4, 1, float, double >::New( dim, numberOfComponents, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsStatisticsOnImage< 4, 1, float, float >::New( dim, numberOfComponents, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsStatisticsOnImage< 4, 4, float, double >::New( dim, numberOfComponents, componentType, internalComponentType );
+    if( !filter ) filter = ITKToolsStatisticsOnImage< 4, 4, float, float >::New( dim, numberOfComponents, componentType, internalComponentType );
 #endif
     /** Check if filter was instantiated. */
     bool supported = itktools::IsFilterSupportedCheck( filter, dim, componentType );
@@ -155,10 +269,21 @@ int main( int argc, char ** argv )
     /** Set the filter arguments. */
     filter->m_InputFileName = inputFileName;
     filter->m_MaskFileName = maskFileName;
+    filter->m_LabelFileName = labelFileName;
     filter->m_HistogramOutputFileName = histogramOutputFileName;
     filter->m_NumberOfBins = numberOfBins;
     filter->m_Select = select;
-
+    filter->m_UseQuantileSketch = useQuantileSketch;
+    filter->m_HistogramRange = histogramRange;
+    filter->m_UseSampling = useSampling;
+    filter->m_SampleFraction = sampleFraction;
+    filter->m_TargetError = targetError;
+    filter->m_SampleMode = sampleMode;
+    filter->m_Seed = seed;
+    filter->m_ConfidenceLevel = confidenceLevel;
+    filter->m_UseCacheFile = useCacheFile;
+
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
@@ -173,4 +298,15 @@ int main( int argc, char ** argv )
   /** End program. */
   return EXIT_SUCCESS;
 
+} // end StatisticsOnImageMain()
+
+
+//-------------------------------------------------------------------------------------
+
+int main( int argc, char ** argv )
+{
+  RegisterMevisDicomTiff();
+
+  return StatisticsOnImageMain( argc, argv );
+
 } // end main
@@ -19,10 +19,11 @@
 #define __statisticsonimage_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsBufferPool.h"
+#include "ITKToolsStatisticsCache.h"
 
-#include "itkImageToImageFilter.h"
 #include "itkStatisticsImageFilterWithMask.h"
-#include "itkScalarImageToHistogramGenerator2.h"
+#include "itkDenseLabelStatisticsImageFilter.h"
 
 
 /** \class ITKToolsStatisticsOnImageBase
@@ -39,9 +40,18 @@ public:
   {
     this->m_InputFileName = "";
     this->m_MaskFileName = "";
+    this->m_LabelFileName = "";
     this->m_HistogramOutputFileName = "";
     this->m_NumberOfBins = 0;
     this->m_Select = "";
+    this->m_UseQuantileSketch = false;
+    this->m_UseSampling = false;
+    this->m_SampleFraction = 1.0;
+    this->m_TargetError = 0.0;
+    this->m_SampleMode = "random";
+    this->m_Seed = 0;
+    this->m_ConfidenceLevel = 0.95;
+    this->m_UseCacheFile = false;
   };
   /** Destructor. */
   ~ITKToolsStatisticsOnImageBase(){};
@@ -49,9 +59,19 @@ public:
   /** Input member parameters. */
   std::string m_InputFileName;
   std::string m_MaskFileName;
+  std::string m_LabelFileName;
   std::string m_HistogramOutputFileName;
   unsigned int m_NumberOfBins;
   std::string m_Select;
+  bool m_UseQuantileSketch;
+  std::vector<double> m_HistogramRange;
+  bool m_UseSampling;
+  double m_SampleFraction;
+  double m_TargetError;
+  std::string m_SampleMode;
+  unsigned int m_Seed;
+  double m_ConfidenceLevel;
+  bool m_UseCacheFile;
 
 }; // end class StatisticsOnImageBase
 
@@ -62,7 +82,8 @@ public:
  * and the New() function for its creation.
  */
 
-template< unsigned int VDimension, unsigned int VNumberOfComponents, class TComponentType >
+template< unsigned int VDimension, unsigned int VNumberOfComponents,
+  class TComponentType, class TInternalType >
 class ITKToolsStatisticsOnImage : public ITKToolsStatisticsOnImageBase
 {
 public:
@@ -72,9 +93,12 @@ public:
   ITKToolsStatisticsOnImage(){};
   ~ITKToolsStatisticsOnImage(){};
 
-  static Self * New( unsigned int dim, unsigned int numberOfComponents, itk::ImageIOBase::IOComponentType componentType )
+  static Self * New( unsigned int dim, unsigned int numberOfComponents,
+    itk::ImageIOBase::IOComponentType componentType,
+    itk::ImageIOBase::IOComponentType internalComponentType )
   {
     if( itktools::IsType<TComponentType>( componentType )
+      && itktools::IsType<TInternalType>( internalComponentType )
       && VDimension == dim && VNumberOfComponents == numberOfComponents )
     {
       return new Self;
@@ -83,28 +107,74 @@ public:
   }
 
   /** Typedefs */
-  typedef double                                      InternalPixelType;
+  typedef TInternalType                               InternalPixelType;
   typedef itk::Image<InternalPixelType, VDimension>   InternalImageType;
-  typedef itk::ImageToImageFilter<
-    InternalImageType, InternalImageType>             BaseFilterType;
-  typedef itk::StatisticsImageFilter<
-    InternalImageType >                               StatisticsFilterType;
-  typedef itk::Statistics::ScalarImageToHistogramGenerator2<
-    InternalImageType >                               HistogramGeneratorType;
+  typedef itk::Image<unsigned char, VDimension>       MaskImageType;
+  typedef itk::Image<int, VDimension>                 LabelImageType;
+  typedef itk::Vector<TComponentType, VNumberOfComponents>  VectorPixelType;
+  typedef itk::Image<VectorPixelType, VDimension>     VectorImageType;
+  typedef typename InternalImageType::RegionType      RegionType;
 
   /** Run function. */
   void Run( void );
 
+  /** Helper function, for a scalar image or a magnitude image adaptor. */
+  template< class TImage >
+  void ComputeStatisticsOrLabelStatistics(
+    TImage * inputImage,
+    MaskImageType * maskImage );
+
   /** Helper function. */
+  template< class TStatisticsFilter >
   void ComputeStatistics(
-    InternalImageType * inputImage,
-    BaseFilterType * maskerOrCopier,
-    StatisticsFilterType * statistics,
-    HistogramGeneratorType * histogramGenerator,
-    unsigned int numberOfBins, // Type is defined in ScalarImageToHistogramGenerator2
+    typename TStatisticsFilter::InputImageType * inputImage,
+    TStatisticsFilter * statistics,
+    unsigned int numberOfBins,
     const std::string & histogramOutputFileName,
     const std::string & select );
 
+  /** Helper function. */
+  template< class TImage >
+  void ComputeLabelStatistics(
+    TImage * inputImage,
+    MaskImageType * maskImage );
+
+  /** Helper function, estimates the statistics from a sample of the slabs,
+   * for a scalar or a vector image.
+   */
+  template< class TImage >
+  void ComputeSampledStatistics( void );
+
+  /** Helper function, the order in which the slabs are sampled. */
+  void GetSampleOrder( unsigned long numberOfSlabs,
+    std::vector<unsigned long> & order ) const;
+
+  /** Helper function, returns the first pixel of a slab of an image file.
+   * The slab is taken from the image if it is buffered there, and is read
+   * from the file otherwise, in which case it replaces the image.
+   */
+  template< class TImage >
+  const typename TImage::PixelType * GetSampledSlab(
+    const std::string & fileName,
+    const RegionType & slab,
+    typename TImage::Pointer & image );
+
+  /** Helper functions, the value of a pixel in the statistics. */
+  static double GetSampleValue( const InternalPixelType & pixel )
+  {
+    return static_cast<double>( pixel );
+  }
+  static double GetSampleValue( const VectorPixelType & pixel )
+  {
+    return static_cast<double>( pixel.GetNorm() );
+  }
+
+  /** Helper function, stores the statistics of a scalar image in the
+   * statistics file of the input, for the other tools: the moments, and
+   * for integer values the histogram with a bin per value.
+   */
+  void WriteStatisticsCache( InternalImageType * image );
+
   /** Helper function. */
   void DetermineHistogramMaximum(
     const InternalPixelType & maxPixelValue,
@@ -112,6 +182,16 @@ public:
     const unsigned int & numberOfBins,
     InternalPixelType & histogramMax );
 
+  /** Helper function, a histogram of numberOfBins bins over [lower, upper]. */
+  template< class THistogram >
+  typename THistogram::Pointer CreateHistogram(
+    unsigned int numberOfBins, double lower, double upper );
+
+protected:
+
+  /** The moments of the whole image, for the statistics file. */
+  itktools::ImageStatistics m_ImageStatistics;
+
 }; // end class ITKToolsStatisticsOnImage
 
 #include "statisticsonimage.hxx"
@@ -18,11 +18,11 @@
 #ifndef __statisticsonimage_hxx_
 #define __statisticsonimage_hxx_
 
+#include "ITKToolsMemoryMapping.h"
+#include "itkVectorMagnitudeImageAdaptor.h"
+#include "itkSlabSampleStatistics.h"
 #include "itkImageFileReader.h"
-#include "itkCastImageFilter.h"
-#include "itkGradientToMagnitudeImageFilter.h"
-#include "itkMaskImageFilter.h"
-#include "itkLogImageFilter.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
 
 #include "statisticsprinters.h"
 
@@ -31,86 +31,60 @@
  * ************************ Run **************************
  */
 
-template< unsigned int VDimension, unsigned int VNumberOfComponents, class TComponentType >
+template< unsigned int VDimension, unsigned int VNumberOfComponents,
+  class TComponentType, class TInternalType >
 void
-ITKToolsStatisticsOnImage< VDimension, VNumberOfComponents, TComponentType >
+ITKToolsStatisticsOnImage< VDimension, VNumberOfComponents, TComponentType, TInternalType >
 ::Run( void )
 {
   /** Typedefs. */
-  typedef TComponentType ScalarPixelType;
+  typedef itk::VectorMagnitudeImageAdaptor<
+    VectorImageType, InternalPixelType >              MagnitudeImageType;
 
-  typedef unsigned char MaskPixelType;
-  typedef itk::Vector<TComponentType, VNumberOfComponents>  VectorPixelType;
-  typedef itk::Image<ScalarPixelType, VDimension>     ScalarImageType;
-  typedef itk::Image<VectorPixelType, VDimension>     VectorImageType;
-  typedef itk::Image<MaskPixelType, VDimension>       MaskImageType;
-
-  typedef itk::ImageFileReader< ScalarImageType >     ScalarReaderType;
-  typedef itk::ImageFileReader< InternalImageType >   InternalScalarReaderType;
-  typedef itk::ImageFileReader< VectorImageType >     VectorReaderType;
-  typedef itk::ImageFileReader< MaskImageType >       MaskReaderType;
-  typedef itk::CastImageFilter<
-    InternalImageType, InternalImageType>             CopierType;
-  typedef itk::GradientToMagnitudeImageFilter<
-    VectorImageType, InternalImageType >              MagnitudeFilterType;
-
-  typedef itk::MaskImageFilter< InternalImageType,
-    MaskImageType, InternalImageType >                MaskerType;
-  typedef typename
-    HistogramGeneratorType::HistogramType             HistogramType;
+  /** The images that are read, and the label images of the label
+   * statistics, recycle their buffers across the jobs of a batch.
+   */
+  itktools::RegisterPooledImageType<InternalImageType>();
+  itktools::RegisterPooledImageType<MaskImageType>();
+  itktools::RegisterPooledImageType<LabelImageType>();
+  itktools::RegisterPooledImageType<VectorImageType>();
 
-  /** Create StatisticsFilter. */
-  typename StatisticsFilterType::Pointer statistics
-    = StatisticsFilterType::New();
+  /** Estimate the statistics from a sample of the slabs. */
+  if( this->m_UseSampling )
+  {
+    if( VNumberOfComponents == 1 )
+    {
+      this->template ComputeSampledStatistics<InternalImageType>();
+    }
+    else
+    {
+      this->template ComputeSampledStatistics<VectorImageType>();
+    }
+    return;
+  }
 
-  /** Read mask */
-  typename MaskReaderType::Pointer maskReader;
-  typename BaseFilterType::Pointer maskerOrCopier
-    = (CopierType::New()).GetPointer();
+  /** Read mask; the statistics and the histogram only use the pixels inside the mask. */
+  typename MaskImageType::Pointer maskImage;
   if( this->m_MaskFileName != "" )
   {
-    /** Read mask */
-    maskReader = MaskReaderType::New();
-    maskReader->SetFileName( this->m_MaskFileName.c_str() );
-    maskReader->Update();
-
-    /** Set mask. */
-    statistics->SetMask( maskReader->GetOutput() );
-
-    /** Prepare filter that applies masking to an image by
-    * replacing all pixels that fall outside the mask by
-    * -infinity. Needed for histogram.
-    */
-    typename MaskerType::Pointer maskFilter = MaskerType::New();
-    maskFilter->SetInput2( maskReader->GetOutput() );
-    maskFilter->SetOutsideValue(
-      itk::NumericTraits<InternalPixelType>::NonpositiveMin() );
-    maskerOrCopier = maskFilter.GetPointer();
+    maskImage = itktools::ReadImage<MaskImageType>( this->m_MaskFileName );
   }
 
-  /** Create histogram generator. */
-  typename HistogramGeneratorType::Pointer histogramGenerator
-    = HistogramGeneratorType::New();
-
   /** For scalar images. */
   if( VNumberOfComponents == 1 )
   {
     std::cout << "Statistics are computed on the gray values." << std::endl;
 
-    typename InternalScalarReaderType::Pointer reader
-      = InternalScalarReaderType::New();
-    reader->SetFileName( this->m_InputFileName.c_str() );
-    reader->Update();
+    /** Read the input image, memory mapped if possible. */
+    typename InternalImageType::Pointer image
+      = itktools::ReadImage<InternalImageType>( this->m_InputFileName );
+
+    this->template ComputeStatisticsOrLabelStatistics<InternalImageType>( image, maskImage );
 
-    /** Call the generic ComputeStatistics function. */
-    this->ComputeStatistics(
-      reader->GetOutput(),
-      maskerOrCopier,
-      statistics,
-      histogramGenerator,
-      this->m_NumberOfBins,
-      this->m_HistogramOutputFileName,
-      this->m_Select );
+    if( this->m_UseCacheFile && !maskImage && this->m_LabelFileName == "" )
+    {
+      this->WriteStatisticsCache( image );
+    }
 
   } // end scalar images
   /** For vector images. */
@@ -118,112 +92,192 @@ ITKToolsStatisticsOnImage< VDimension, VNumberOfComponents, TComponentType >
   {
     std::cout << "Statistics are computed on the magnitude of the vectors." << std::endl;
 
-    typename VectorReaderType::Pointer reader = VectorReaderType::New();
-    reader->SetFileName( this->m_InputFileName.c_str() );
+    typename VectorImageType::Pointer vectorImage
+      = itktools::ReadImage<VectorImageType>( this->m_InputFileName );
 
-    typename MagnitudeFilterType::Pointer magnitudeFilter = MagnitudeFilterType::New();
-    magnitudeFilter->SetInput( reader->GetOutput() );
-    std::cout << "Computing magnitude image ..." << std::endl;
-    magnitudeFilter->Update();
+    /** The magnitudes are computed when the pixels are read,
+     * instead of in a separate magnitude image.
+     */
+    typename MagnitudeImageType::Pointer magnitudeImage = MagnitudeImageType::New();
+    magnitudeImage->SetImage( vectorImage );
 
-    /** Call the generic ComputeStatistics function */
-    this->ComputeStatistics(
-      magnitudeFilter->GetOutput(),
-      maskerOrCopier,
-      statistics,
-      histogramGenerator,
-      this->m_NumberOfBins,
-      this->m_HistogramOutputFileName,
-      this->m_Select );
+    this->template ComputeStatisticsOrLabelStatistics<MagnitudeImageType>( magnitudeImage, maskImage );
 
   } // end vector images
 } // end Run()
 
 
+/**
+ * ************************ ComputeStatisticsOrLabelStatistics **************************
+ */
+
+template< unsigned int VDimension, unsigned int VNumberOfComponents,
+  class TComponentType, class TInternalType >
+template< class TImage >
+void
+ITKToolsStatisticsOnImage< VDimension, VNumberOfComponents, TComponentType, TInternalType >
+::ComputeStatisticsOrLabelStatistics(
+  TImage * inputImage,
+  MaskImageType * maskImage )
+{
+  /** Compute the statistics of all labels at once. */
+  if( this->m_LabelFileName != "" )
+  {
+    this->template ComputeLabelStatistics<TImage>( inputImage, maskImage );
+    return;
+  }
+
+  /** Create StatisticsFilter. Accumulate per line, which is numerically
+   * stable for large images, and independent of the number of threads.
+   */
+  typedef itk::StatisticsImageFilter< TImage >        StatisticsFilterType;
+  typename StatisticsFilterType::Pointer statistics
+    = StatisticsFilterType::New();
+  statistics->SetUseStableAccumulation( true );
+  statistics->SetMask( maskImage );
+
+  /** Call the generic ComputeStatistics function. */
+  this->template ComputeStatistics<StatisticsFilterType>(
+    inputImage,
+    statistics,
+    this->m_NumberOfBins,
+    this->m_HistogramOutputFileName,
+    this->m_Select );
+
+  /** Keep the moments of the whole image. */
+  if( !maskImage )
+  {
+    this->m_ImageStatistics = itktools::ImageStatistics();
+    this->m_ImageStatistics.NumberOfPixels
+      = inputImage->GetLargestPossibleRegion().GetNumberOfPixels();
+    this->m_ImageStatistics.Minimum.assign( 1, static_cast<double>( statistics->GetMinimum() ) );
+    this->m_ImageStatistics.Maximum.assign( 1, static_cast<double>( statistics->GetMaximum() ) );
+    this->m_ImageStatistics.Mean.assign( 1, static_cast<double>( statistics->GetMean() ) );
+    this->m_ImageStatistics.Sigma.assign( 1, static_cast<double>( statistics->GetSigma() ) );
+  }
+
+} // end ComputeStatisticsOrLabelStatistics()
+
+
+/**
+ * ************************ WriteStatisticsCache **************************
+ */
+
+template< unsigned int VDimension, unsigned int VNumberOfComponents,
+  class TComponentType, class TInternalType >
+void
+ITKToolsStatisticsOnImage< VDimension, VNumberOfComponents, TComponentType, TInternalType >
+::WriteStatisticsCache( InternalImageType * image )
+{
+  if( !this->m_ImageStatistics.HasMoments() ) return;
+  itktools::ImageStatistics statistics = this->m_ImageStatistics;
+
+  /** Add the histogram of integer values, unless it was stored before. */
+  if( itk::NumericTraits<TComponentType>::is_integer )
+  {
+    itktools::ImageStatistics stored;
+    const bool storedHistogram = itktools::ReadStatisticsCache( this->m_InputFileName,
+      itktools::GetReadComponentType<InternalImageType>(), stored )
+      && stored.HasHistogram();
+    if( !storedHistogram )
+    {
+      itktools::ComputeValueHistogram( image,
+        statistics.Minimum[ 0 ], statistics.Maximum[ 0 ], statistics );
+    }
+  }
+
+  std::cout << "Writing the statistics to " << this->m_InputFileName
+    << ".statistics ..." << std::endl;
+  itktools::WriteStatisticsCache( this->m_InputFileName, image, statistics );
+
+} // end WriteStatisticsCache()
+
+
 /**
  * ************************ ComputeStatistics **************************
  *
- * Generic template function that computes statistics on an input image
- * Assumes that the number of histogram bins and the marginal scale are set
- * in the histogramGenerator, that the maskerOrCopier has been initialized
- * to a (dummy) caster or to a MaskFilterType with mask set, and that the
- * statistics filter has been initialized.
+ * Generic template function that computes statistics on an input image.
+ * Assumes that the statistics filter has been initialized, with a mask if
+ * needed.
  *
- * This function is only to be used by the StatisticsOnImage function.
- * It is quite specific and not really well over thought. Introduced to avoid
- * duplication of code.
+ * The arithmetic and geometric statistics are computed in a single pass
+ * over the image, optionally with a quantile sketch. The histogram needs
+ * a second pass, since its bins depend on the minimum and maximum, unless
+ * its range is given with -range.
  */
 
-template< unsigned int VDimension, unsigned int VNumberOfComponents, class TComponentType >
+template< unsigned int VDimension, unsigned int VNumberOfComponents,
+  class TComponentType, class TInternalType >
+template< class TStatisticsFilter >
 void
-ITKToolsStatisticsOnImage< VDimension, VNumberOfComponents, TComponentType >
+ITKToolsStatisticsOnImage< VDimension, VNumberOfComponents, TComponentType, TInternalType >
 ::ComputeStatistics(
-  InternalImageType * inputImage,
-  BaseFilterType * maskerOrCopier,
-  StatisticsFilterType * statistics,
-  HistogramGeneratorType * histogramGenerator,
-  unsigned int numberOfBins, // Type is defined in ScalarImageToHistogramGenerator2
+  typename TStatisticsFilter::InputImageType * inputImage,
+  TStatisticsFilter * statistics,
+  unsigned int numberOfBins,
   const std::string & histogramOutputFileName,
   const std::string & select )
 {
-  typedef typename
-    HistogramGeneratorType::HistogramType             HistogramType;
-  typedef typename HistogramGeneratorType::RealPixelType   RealPixelType;
+  typedef TStatisticsFilter                           StatisticsFilterType;
   typedef typename StatisticsFilterType::PixelType    PixelType;
-  typedef InternalImageType                           InputImageType;
-  typedef itk::LogImageFilter<
-    InputImageType, InputImageType>                   LogFilterType;
-
-  /** Arithmetic mean */
-  PixelType maxPixelValue = 1;
-  PixelType minPixelValue = 0;
-  if( select == "arithmetic" || select == "" || select == "histogram" )
-  {
-    std::cout << "Computing arithmetic statistics ..." << std::endl;
+  typedef typename StatisticsFilterType::HistogramType  HistogramType;
+  typedef typename StatisticsFilterType::QuantileSketchType QuantileSketchType;
 
-    statistics->SetInput( inputImage );
-    statistics->Update();
+  const bool arithmetic = select == "arithmetic" || select == "";
+  const bool geometric = select == "geometric" || select == "";
+  const bool histogram = select == "histogram" || select == "";
+  const bool quantileSketch = histogram && this->m_UseQuantileSketch;
 
-    /** Only print if not histogram selected. */
-    if( select != "histogram" )
+  /** Arithmetic and geometric mean/std, in one pass. */
+  if( arithmetic || geometric )
+  {
+    std::cout << "Computing "
+      << ( arithmetic ? ( geometric ? "arithmetic and geometric" : "arithmetic" ) : "geometric" )
+      << " statistics ..." << std::endl;
+  }
+  /** With a given range, the histogram is filled in the same pass. */
+  const bool singlePass = histogram && this->m_HistogramRange.size() == 2
+    && !( quantileSketch && histogramOutputFileName == "" );
+  typename HistogramType::Pointer histogramObject;
+  if( singlePass )
+  {
+    std::cout << "Computing histogram statistics ..." << std::endl;
+    if( numberOfBins == 0 )
     {
-      PrintStatistics<StatisticsFilterType>( statistics );
+      numberOfBins = static_cast<unsigned int>(
+        this->m_HistogramRange[ 1 ] - this->m_HistogramRange[ 0 ] );
+      numberOfBins = numberOfBins > 0 ? numberOfBins : 1;
     }
-    if( select == "arithmetic" ) return;
-
-    /** Save for later use for the histogram bin size. */
-    maxPixelValue = statistics->GetMaximum();
-    minPixelValue = statistics->GetMinimum();
+    histogramObject = this->template CreateHistogram<HistogramType>( numberOfBins,
+      this->m_HistogramRange[ 0 ], this->m_HistogramRange[ 1 ] );
+    statistics->SetHistogram( histogramObject );
   }
 
-  /** Geometric mean/std: */
-  if( select == "geometric" || select == "" )
-  {
-    std::cout << "Computing geometric statistics ..." << std::endl;
-
-    typename LogFilterType::Pointer logger = LogFilterType::New();
-    logger->SetInput( inputImage );
-    statistics->SetInput( logger->GetOutput() );
-    statistics->Update();
+  statistics->SetComputeGeometricStatistics( geometric );
+  statistics->SetComputeQuantileSketch( quantileSketch );
+  statistics->SetInput( inputImage );
+  statistics->Update();
 
+  if( arithmetic )
+  {
+    PrintStatistics<StatisticsFilterType>( statistics );
+  }
+  if( geometric )
+  {
     PrintGeometricStatistics<StatisticsFilterType>( statistics );
-
-    if( select == "geometric" ) return;
   }
+  if( quantileSketch )
+  {
+    PrintQuantileStatistics<QuantileSketchType>( statistics->GetQuantileSketch() );
+  }
+  if( !histogram ) return;
+  if( quantileSketch && histogramOutputFileName == "" ) return;
 
-  /** Histogram statistics. */
-  if( select == "histogram" || select == "" )
+  if( !singlePass )
   {
-    /** Prepare for the histogram. */
-    maskerOrCopier->SetInput( inputImage );
-    std::string maskerOrCopierName = maskerOrCopier->GetNameOfClass();
-    if( maskerOrCopierName == "MaskImageFilter" )
-    {
-      std::cout << "Replacing all pixels outside the mask by -infinity,\n  ";
-      std::cout << "to make sure they are not included in the histogram ..."
-        << std::endl;
-    }
-    maskerOrCopier->Update();
+    /** Save for the histogram bin size. */
+    PixelType maxPixelValue = statistics->GetMaximum();
+    PixelType minPixelValue = statistics->GetMinimum();
 
     /** If the user specified 0, the number of bins is equal to the intensity range. */
     if( numberOfBins == 0 )
@@ -235,30 +289,330 @@ ITKToolsStatisticsOnImage< VDimension, VNumberOfComponents, TComponentType >
     PixelType histogramMax;
     this->DetermineHistogramMaximum( maxPixelValue, minPixelValue, numberOfBins, histogramMax );
 
-    /** Computing histogram statistics. */
+    /** Create the histogram, and fill it in a second pass. */
     std::cout << "Computing histogram statistics ..." << std::endl;
 
-    histogramGenerator->SetAutoMinMax( false );
-    histogramGenerator->SetNumberOfBins( numberOfBins );
-    histogramGenerator->SetHistogramMin( static_cast<RealPixelType>( minPixelValue ) );
-    histogramGenerator->SetHistogramMax( histogramMax );
-    histogramGenerator->SetInput( maskerOrCopier->GetOutput() );
-    histogramGenerator->Compute();
+    histogramObject = this->template CreateHistogram<HistogramType>( numberOfBins,
+      static_cast<double>( minPixelValue ), static_cast<double>( histogramMax ) );
 
+    statistics->SetComputeGeometricStatistics( false );
+    statistics->SetComputeQuantileSketch( false );
+    statistics->SetHistogram( histogramObject );
+    statistics->Update();
+  }
+
+  /** The percentiles were already estimated by the sketch. */
+  if( quantileSketch )
+  {
+    WriteHistogram<HistogramType>( histogramObject, histogramOutputFileName );
+  }
+  else
+  {
     PrintHistogramStatistics<HistogramType>(
-      histogramGenerator->GetOutput(), histogramOutputFileName );
+      histogramObject, histogramOutputFileName );
   }
 
 } // end ComputeStatistics()
 
 
+/**
+ * ************************ ComputeLabelStatistics **************************
+ *
+ * Computes the statistics of every label in the label image, in a single
+ * pass over the input image, and prints them as a table. The percentiles
+ * are estimated with a quantile sketch per label, since a histogram per label
+ * would need a second pass.
+ */
+
+template< unsigned int VDimension, unsigned int VNumberOfComponents,
+  class TComponentType, class TInternalType >
+template< class TImage >
+void
+ITKToolsStatisticsOnImage< VDimension, VNumberOfComponents, TComponentType, TInternalType >
+::ComputeLabelStatistics(
+  TImage * inputImage,
+  MaskImageType * maskImage )
+{
+  typedef itk::DenseLabelStatisticsImageFilter<
+    TImage, LabelImageType >                          LabelStatisticsFilterType;
+
+  const std::string & select = this->m_Select;
+  const bool geometric = select == "geometric" || select == "";
+  const bool quantiles = select == "histogram" || select == "";
+
+  /** Read the label image. */
+  typename LabelImageType::Pointer labelImage
+    = itktools::ReadImage<LabelImageType>( this->m_LabelFileName );
+
+  /** Compute. */
+  std::cout << "Computing the statistics of all labels ..." << std::endl;
+  typename LabelStatisticsFilterType::Pointer labelStatistics
+    = LabelStatisticsFilterType::New();
+  labelStatistics->SetInput( inputImage );
+  labelStatistics->SetLabelImage( labelImage );
+  labelStatistics->SetMask( maskImage );
+  labelStatistics->SetComputeGeometricStatistics( geometric );
+  labelStatistics->SetComputeQuantileSketches( quantiles );
+  labelStatistics->Update();
+
+  /** Print the table to screen, or to the output file. */
+  if( this->m_HistogramOutputFileName == "" )
+  {
+    PrintLabelStatistics( labelStatistics->GetLabelStatistics(),
+      geometric, quantiles, std::cout );
+  }
+  else
+  {
+    std::cout << "The table is written to file: "
+      << this->m_HistogramOutputFileName << std::endl;
+    std::ofstream tableFile( this->m_HistogramOutputFileName.c_str() );
+    if( !tableFile.is_open() )
+    {
+      itkGenericExceptionMacro( << "ERROR: Output file for the table cannot be opened!" );
+    }
+    PrintLabelStatistics( labelStatistics->GetLabelStatistics(),
+      geometric, quantiles, tableFile );
+  }
+
+} // end ComputeLabelStatistics()
+
+
+/**
+ * ************************ ComputeSampledStatistics **************************
+ *
+ * Estimates the statistics from a sample of the slabs, the slices along
+ * the last dimension, with confidence intervals. If the image format can
+ * stream, only the sampled slabs are read; otherwise the image is read
+ * once, memory mapped if possible, so that still only the sampled slabs
+ * are scanned.
+ *
+ * With a sample fraction only, that fraction of the slabs is sampled.
+ * With a target error, slabs are added until the confidence interval of
+ * the mean is at most twice the target error wide, or until the sample
+ * fraction is reached.
+ */
+
+template< unsigned int VDimension, unsigned int VNumberOfComponents,
+  class TComponentType, class TInternalType >
+template< class TImage >
+void
+ITKToolsStatisticsOnImage< VDimension, VNumberOfComponents, TComponentType, TInternalType >
+::ComputeSampledStatistics( void )
+{
+  typedef typename TImage::PixelType                  PixelType;
+  typedef itk::ImageFileReader< TImage >              ReaderType;
+  typedef itk::ImageFileReader< MaskImageType >       MaskReaderType;
+  typedef itk::SlabSampleStatistics< double >         SampleStatisticsType;
+
+  const bool arithmetic = this->m_Select == "arithmetic" || this->m_Select == "";
+  const bool quantiles = this->m_Select == "histogram" || this->m_Select == "";
+
+  /** Get the region, and read the whole image if it cannot stream. */
+  typename ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( this->m_InputFileName.c_str() );
+  reader->UpdateOutputInformation();
+  const RegionType region = reader->GetOutput()->GetLargestPossibleRegion();
+  typename TImage::Pointer image;
+  if( !reader->GetImageIO()->CanStreamRead() )
+  {
+    image = itktools::ReadImage<TImage>( this->m_InputFileName );
+  }
+
+  typename MaskImageType::Pointer maskImage;
+  if( this->m_MaskFileName != "" )
+  {
+    typename MaskReaderType::Pointer maskReader = MaskReaderType::New();
+    maskReader->SetFileName( this->m_MaskFileName.c_str() );
+    maskReader->UpdateOutputInformation();
+    if( maskReader->GetOutput()->GetLargestPossibleRegion() != region )
+    {
+      itkGenericExceptionMacro( << "ERROR: the mask should have the same size as the input image." );
+    }
+    if( !maskReader->GetImageIO()->CanStreamRead() )
+    {
+      maskImage = itktools::ReadImage<MaskImageType>( this->m_MaskFileName );
+    }
+  }
+
+  /** The number of slabs to sample, at least two. */
+  const unsigned int lastDimension = VDimension - 1;
+  const unsigned long numberOfSlabs = region.GetSize()[ lastDimension ];
+  const unsigned long minimumNumberOfSlabs = std::min<unsigned long>( 2, numberOfSlabs );
+  const unsigned long maximumNumberOfSlabs = std::max( minimumNumberOfSlabs,
+    std::min( numberOfSlabs, static_cast<unsigned long>(
+      vcl_ceil( this->m_SampleFraction * numberOfSlabs ) ) ) );
+  unsigned long numberOfSampledSlabs = maximumNumberOfSlabs;
+  if( this->m_TargetError > 0.0 )
+  {
+    numberOfSampledSlabs = std::min( maximumNumberOfSlabs,
+      std::max<unsigned long>( 4, numberOfSlabs / 100 ) );
+  }
+
+  std::vector<unsigned long> order;
+  this->GetSampleOrder( numberOfSlabs, order );
+
+  /** Sample the slabs; every prefix of the order is a sample. */
+  std::cout << "Estimating the statistics from a " << this->m_SampleMode
+    << " sample of the " << numberOfSlabs << " slabs ..." << std::endl;
+  SampleStatisticsType sample( numberOfSlabs, this->m_ConfidenceLevel );
+  std::vector<double> values;
+  unsigned long next = 0;
+  while( true )
+  {
+    for( ; next < numberOfSampledSlabs; ++next )
+    {
+      RegionType slab = region;
+      slab.SetIndex( lastDimension, region.GetIndex()[ lastDimension ] + order[ next ] );
+      slab.SetSize( lastDimension, 1 );
+
+      const PixelType * pixels = this->template GetSampledSlab<TImage>(
+        this->m_InputFileName, slab, image );
+      const unsigned char * maskPixels = 0;
+      if( this->m_MaskFileName != "" )
+      {
+        maskPixels = this->template GetSampledSlab<MaskImageType>(
+          this->m_MaskFileName, slab, maskImage );
+      }
+
+      values.clear();
+      const std::size_t numberOfPixels = slab.GetNumberOfPixels();
+      for( std::size_t i = 0; i < numberOfPixels; ++i )
+      {
+        if( maskPixels == 0 || maskPixels[ i ] != 0 )
+        {
+          values.push_back( GetSampleValue( pixels[ i ] ) );
+        }
+      }
+      sample.AddSlab( values );
+    }
+
+    if( !( this->m_TargetError > 0.0 ) ) break;
+    const double halfWidth = sample.GetMeanHalfWidth();
+    std::cout << "\tsampled " << numberOfSampledSlabs << " slabs, mean +/- "
+      << halfWidth << std::endl;
+    if( halfWidth <= this->m_TargetError ) break;
+    if( numberOfSampledSlabs == maximumNumberOfSlabs )
+    {
+      std::cout << "The target error is not reached with the maximum sample fraction." << std::endl;
+      break;
+    }
+    numberOfSampledSlabs = std::min( maximumNumberOfSlabs,
+      numberOfSampledSlabs + std::max<unsigned long>( 1, numberOfSampledSlabs / 2 ) );
+  }
+
+  PrintSampledStatistics<SampleStatisticsType>( sample, arithmetic, quantiles );
+
+} // end ComputeSampledStatistics()
+
+
+/**
+ * ************************ GetSampleOrder **************************
+ *
+ * A random order is a random permutation of the slabs. A strided order
+ * visits the slabs in bit-reversed order, so every prefix is spread
+ * evenly over the image: first the slab in the middle, then those at a
+ * quarter and three quarter, etc.
+ */
+
+template< unsigned int VDimension, unsigned int VNumberOfComponents,
+  class TComponentType, class TInternalType >
+void
+ITKToolsStatisticsOnImage< VDimension, VNumberOfComponents, TComponentType, TInternalType >
+::GetSampleOrder( unsigned long numberOfSlabs,
+  std::vector<unsigned long> & order ) const
+{
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator RandomGeneratorType;
+
+  order.clear();
+  order.reserve( numberOfSlabs );
+  if( this->m_SampleMode == "strided" )
+  {
+    unsigned int bits = 0;
+    while( ( 1UL << bits ) < numberOfSlabs ) ++bits;
+    for( unsigned long i = 0; i < ( 1UL << bits ); ++i )
+    {
+      unsigned long reversed = 0;
+      for( unsigned int b = 0; b < bits; ++b )
+      {
+        reversed |= ( ( i >> b ) & 1UL ) << ( bits - 1 - b );
+      }
+      if( reversed < numberOfSlabs ) order.push_back( reversed );
+    }
+    return;
+  }
+
+  /** A Fisher-Yates shuffle, reproducible with the seed. */
+  for( unsigned long i = 0; i < numberOfSlabs; ++i )
+  {
+    order.push_back( i );
+  }
+  RandomGeneratorType::Pointer generator = RandomGeneratorType::New();
+  generator->Initialize( this->m_Seed );
+  for( unsigned long i = numberOfSlabs; i > 1; --i )
+  {
+    const unsigned long j = generator->GetIntegerVariate( i - 1 );
+    std::swap( order[ i - 1 ], order[ j ] );
+  }
+
+} // end GetSampleOrder()
+
+
+/**
+ * ************************ GetSampledSlab **************************
+ *
+ * A slab spans the full image in all but the last dimension, so it is
+ * contiguous in the buffer of an image that contains it.
+ */
+
+template< unsigned int VDimension, unsigned int VNumberOfComponents,
+  class TComponentType, class TInternalType >
+template< class TImage >
+const typename TImage::PixelType *
+ITKToolsStatisticsOnImage< VDimension, VNumberOfComponents, TComponentType, TInternalType >
+::GetSampledSlab(
+  const std::string & fileName,
+  const RegionType & slab,
+  typename TImage::Pointer & image )
+{
+  typedef itk::ImageFileReader< TImage >              ReaderType;
+
+  if( image.IsNull() || !image->GetBufferedRegion().IsInside( slab ) )
+  {
+    typename ReaderType::Pointer reader = ReaderType::New();
+    reader->SetFileName( fileName.c_str() );
+    reader->SetUseStreaming( true );
+    reader->UpdateOutputInformation();
+    reader->GetOutput()->SetRequestedRegion( slab );
+    reader->Update();
+    image = reader->GetOutput();
+    image->DisconnectPipeline();
+  }
+
+  const RegionType & buffered = image->GetBufferedRegion();
+  bool contiguous = buffered.IsInside( slab );
+  for( unsigned int d = 0; d + 1 < VDimension; ++d )
+  {
+    contiguous &= buffered.GetSize()[ d ] == slab.GetSize()[ d ];
+  }
+  if( !contiguous )
+  {
+    itkGenericExceptionMacro( << "ERROR: the slab " << slab.GetIndex()
+      << " " << slab.GetSize() << " of " << fileName << " could not be read." );
+  }
+
+  return image->GetBufferPointer() + image->ComputeOffset( slab.GetIndex() );
+
+} // end GetSampledSlab()
+
+
 /**
  * ******************* DetermineHistogramMaximum *******************
  */
 
-template< unsigned int VDimension, unsigned int VNumberOfComponents, class TComponentType >
+template< unsigned int VDimension, unsigned int VNumberOfComponents,
+  class TComponentType, class TInternalType >
 void
-ITKToolsStatisticsOnImage< VDimension, VNumberOfComponents, TComponentType >
+ITKToolsStatisticsOnImage< VDimension, VNumberOfComponents, TComponentType, TInternalType >
 ::DetermineHistogramMaximum(
   const InternalPixelType & maxPixelValue,
   const InternalPixelType & minPixelValue,
@@ -309,9 +663,8 @@ ITKToolsStatisticsOnImage< VDimension, VNumberOfComponents, TComponentType >
   if( histogramMax <= maxPixelValue )
   {
     /** Overflow occurred; maximum was already maximum of pixeltype;
-     * We could solve this somehow (by adding a ClipBinsAtUpperBound(bool)
-     * function to the itkScalarImageToHistogramGenerator2, and calling it
-     * with argument 'false'), but the situation is quite unlikely; anyway,
+     * We could solve this somehow (by calling SetClipBinsAtEnds(false)
+     * on the histogram), but the situation is quite unlikely; anyway,
      * mostly something is going wrong when a float image has value
      * infinity somewhere.
      */
@@ -325,5 +678,30 @@ ITKToolsStatisticsOnImage< VDimension, VNumberOfComponents, TComponentType >
 } // end DetermineHistogramMaximum()
 
 
+/**
+ * ******************* CreateHistogram *******************
+ */
+
+template< unsigned int VDimension, unsigned int VNumberOfComponents,
+  class TComponentType, class TInternalType >
+template< class THistogram >
+typename THistogram::Pointer
+ITKToolsStatisticsOnImage< VDimension, VNumberOfComponents, TComponentType, TInternalType >
+::CreateHistogram( unsigned int numberOfBins, double lower, double upper )
+{
+  typename THistogram::Pointer histogram = THistogram::New();
+  typename THistogram::SizeType size( 1 );
+  typename THistogram::MeasurementVectorType lowerBound( 1 );
+  typename THistogram::MeasurementVectorType upperBound( 1 );
+  size.Fill( numberOfBins );
+  lowerBound[ 0 ] = lower;
+  upperBound[ 0 ] = upper;
+  histogram->SetMeasurementVectorSize( 1 );
+  histogram->Initialize( size, lowerBound, upperBound );
+
+  return histogram;
+
+} // end CreateHistogram()
+
 #endif // #ifndef __statisticsonimage_hxx_
 
@@ -22,7 +22,7 @@
 #include <fstream>
 #include <iomanip>
 
-/** this file defines three function that print statistics information */
+/** this file defines functions that print statistics information */
 
 /**
  * Print the results of an itk::StatisticsImageFilter
@@ -45,9 +45,9 @@ void PrintStatistics( const TStatisticsFilter * statistics )
 
 
 /**
- * Print the results of an itk::StatisticsImageFilter
- * Assume that statistics were calculated on the log
- * of the actual image. exp gives the Geometric mean.
+ * Print the geometric results of an itk::StatisticsImageFilter
+ * Assume that the statistics of the log of the actual image
+ * were computed. exp gives the Geometric mean.
  */
 
 template<class TStatisticsFilter>
@@ -55,14 +55,71 @@ void PrintGeometricStatistics( const TStatisticsFilter * statistics )
 {
   /** Print to screen. */
   std::cout << std::setprecision(10);
-  double geometricmean = vcl_exp( statistics->GetMean() );
-  double geometricstdev = vcl_exp( statistics->GetSigma() );
+  double geometricmean = vcl_exp( statistics->GetMeanOfLog() );
+  double geometricstdev = vcl_exp( statistics->GetSigmaOfLog() );
   std::cout << "\tgeometric mean : " << geometricmean << std::endl;
   std::cout << "\tgeometric stdev: " << geometricstdev << std::endl;
 
 } // end PrintGeometricStatistics()
 
 
+/**
+ * Write a histogram to a file
+ */
+
+template<class THistogram>
+void WriteHistogram( const THistogram * histogram,
+  const std::string & histogramOutputFileName )
+{
+  if( histogramOutputFileName == "" ) return;
+
+  typedef typename THistogram::AbsoluteFrequencyType AbsoluteFrequencyType;
+  typename THistogram::TotalAbsoluteFrequencyType nrOfPixels = histogram->GetTotalFrequency();
+
+  std::cout << "Histogram is written to file: " <<
+    histogramOutputFileName << " ..." << std::endl;
+  std::ofstream histogramOutputFile;
+  histogramOutputFile.open( histogramOutputFileName.c_str() );
+  if( !histogramOutputFile.is_open() )
+  {
+    itkGenericExceptionMacro(<< "ERROR: Output file for histogram cannot be opened!");
+  }
+  histogramOutputFile << std::fixed;
+  histogramOutputFile << std::showpoint;
+  histogramOutputFile << std::setprecision(16);
+  histogramOutputFile
+    << "nr"
+    << "\t"
+    << "min"
+    << "\t"
+    << "max"
+    << "\t"
+    << "freq"
+    << "\t"
+    << "prob"
+    << std::endl;
+  for (unsigned long i = 0; i < histogram->GetSize(0); ++i )
+  {
+    AbsoluteFrequencyType freq = histogram->GetFrequency(i,0);
+    double prob = static_cast<double>(freq) / static_cast<double>(nrOfPixels);
+    histogramOutputFile
+      << i
+      << "\t"
+      << histogram->GetBinMin(0,i)
+      << "\t"
+      << histogram->GetBinMax(0,i)
+      << "\t"
+      << freq
+      << "\t"
+      << prob
+      << std::endl;
+  } // end for
+  histogramOutputFile.close();
+  std::cout << "Done writing histogram to file." << std::endl;
+
+} // end WriteHistogram()
+
+
 /**
  * Print histogram statistics
  */
@@ -74,7 +131,6 @@ void PrintHistogramStatistics( const THistogram * histogram,
   /** Print to screen. */
   //median, quartiles, histogram, percentiles.
 
-  typedef typename THistogram::AbsoluteFrequencyType AbsoluteFrequencyType;
   typename THistogram::TotalAbsoluteFrequencyType nrOfPixels = histogram->GetTotalFrequency();
   double median = histogram->Quantile(0, 0.5);
   double fifteenthpercentile = histogram->Quantile( 0, 0.15 );
@@ -91,51 +147,117 @@ void PrintHistogramStatistics( const THistogram * histogram,
   std::cout << "\t15th percentile: \t" << fifteenthpercentile << std::endl;
 
   /** Print histogram to output file */
-  if( histogramOutputFileName != "" )
+  WriteHistogram<THistogram>( histogram, histogramOutputFileName );
+
+} // end PrintHistogramStatistics()
+
+
+/**
+ * Print the percentiles estimated by a quantile sketch
+ */
+
+template<class TQuantileSketch>
+void PrintQuantileStatistics( const TQuantileSketch & sketch )
+{
+  /** Print to screen. */
+  std::cout << std::setprecision( 10 );
+  std::cout << "\tnumber of pixels:\t" << sketch.GetTotalWeight() << std::endl;
+  std::cout << "\tmedian:          \t" << sketch.Quantile( 0.5 ) << std::endl;
+  std::cout << "\t1st quartile:    \t" << sketch.Quantile( 0.25 ) << std::endl;
+  std::cout << "\t3rd quartile:    \t" << sketch.Quantile( 0.75 ) << std::endl;
+  std::cout << "\t15th percentile: \t" << sketch.Quantile( 0.15 ) << std::endl;
+
+} // end PrintQuantileStatistics()
+
+
+/**
+ * Print the statistics estimated from a sample of slabs, with their
+ * confidence intervals
+ */
+
+template<class TSampleStatistics>
+void PrintSampledStatistics( const TSampleStatistics & sample,
+  const bool arithmetic, const bool quantiles )
+{
+  double lower = 0.0;
+  double upper = 0.0;
+
+  /** Print to screen. */
+  std::cout << std::setprecision( 10 );
+  std::cout << "Estimated from " << sample.GetNumberOfSampledSlabs()
+    << " of " << sample.GetNumberOfSlabs() << " slabs, with "
+    << 100.0 * sample.GetConfidenceLevel() << "% confidence intervals:" << std::endl;
+  std::cout << "\tnumber of pixels: " << sample.GetEstimatedNumberOfValues()
+    << " (" << sample.GetNumberOfValues() << " sampled)" << std::endl;
+  if( arithmetic )
+  {
+    std::cout << "\tmin of sample   : " << sample.GetMinimum() << std::endl;
+    std::cout << "\tmax of sample   : " << sample.GetMaximum() << std::endl;
+    sample.GetMeanInterval( lower, upper );
+    std::cout << "\tarithmetic mean : " << sample.GetMean()
+      << "\t[" << lower << ", " << upper << "]" << std::endl;
+    sample.GetSigmaInterval( lower, upper );
+    std::cout << "\tarithmetic stdev: " << sample.GetSigma()
+      << "\t[" << lower << ", " << upper << "]" << std::endl;
+  }
+  if( quantiles )
   {
-    std::cout << "Histogram is written to file: " <<
-      histogramOutputFileName << " ..." << std::endl;
-    std::ofstream histogramOutputFile;
-    histogramOutputFile.open( histogramOutputFileName.c_str() );
-    if( !histogramOutputFile.is_open() )
+    const double q[ 4 ] = { 0.5, 0.25, 0.75, 0.15 };
+    const char * names[ 4 ] = { "median:          ", "1st quartile:    ",
+      "3rd quartile:    ", "15th percentile: " };
+    for( unsigned int i = 0; i < 4; ++i )
     {
-      itkGenericExceptionMacro(<< "ERROR: Output file for histogram cannot be opened!");
+      sample.GetQuantileInterval( q[ i ], lower, upper );
+      std::cout << "\t" << names[ i ] << "\t" << sample.Quantile( q[ i ] )
+        << "\t[" << lower << ", " << upper << "]" << std::endl;
     }
-    histogramOutputFile << std::fixed;
-    histogramOutputFile << std::showpoint;
-    histogramOutputFile << std::setprecision(16);
-    histogramOutputFile
-      << "nr"
-      << "\t"
-      << "min"
-      << "\t"
-      << "max"
-      << "\t"
-      << "freq"
-      << "\t"
-      << "prob"
-      << std::endl;
-    for (unsigned long i = 0; i < histogram->GetSize(0); ++i )
+  }
+
+} // end PrintSampledStatistics()
+
+
+/**
+ * Print the statistics of all labels as a tab separated table
+ */
+
+template<class TLabelStatisticsContainer>
+void PrintLabelStatistics( const TLabelStatisticsContainer & labelStatistics,
+  const bool geometric, const bool quantiles, std::ostream & os )
+{
+  os << std::setprecision( 10 );
+  os << "label\tcount\tmin\tmax\tmean\tstdev\tvar\tsum\tabsmean";
+  if( geometric ) os << "\tgeomean\tgeostdev";
+  if( quantiles ) os << "\tmedian\tquartile1\tquartile3\tpercentile15";
+  os << std::endl;
+
+  for( std::size_t i = 0; i < labelStatistics.size(); ++i )
+  {
+    const typename TLabelStatisticsContainer::value_type & statistics = labelStatistics[ i ];
+    os << statistics.Label
+      << "\t" << statistics.Count
+      << "\t" << statistics.Minimum
+      << "\t" << statistics.Maximum
+      << "\t" << statistics.Mean
+      << "\t" << statistics.Sigma
+      << "\t" << statistics.Variance
+      << "\t" << statistics.Sum
+      << "\t" << statistics.AbsoluteMean;
+    if( geometric )
     {
-      AbsoluteFrequencyType freq = histogram->GetFrequency(i,0);
-      double prob = static_cast<double>(freq) / static_cast<double>(nrOfPixels);
-      histogramOutputFile
-        << i
-        << "\t"
-        << histogram->GetBinMin(0,i)
-        << "\t"
-        << histogram->GetBinMax(0,i)
-        << "\t"
-        << freq
-        << "\t"
-        << prob
-        << std::endl;
-    } // end for
-    histogramOutputFile.close();
-    std::cout << "Done writing histogram to file." << std::endl;
-  } // end if
+      os << "\t" << vcl_exp( statistics.MeanOfLog )
+        << "\t" << vcl_exp( statistics.SigmaOfLog );
+    }
+    if( quantiles )
+    {
+      os << "\t" << statistics.Sketch.Quantile( 0.5 )
+        << "\t" << statistics.Sketch.Quantile( 0.25 )
+        << "\t" << statistics.Sketch.Quantile( 0.75 )
+        << "\t" << statistics.Sketch.Quantile( 0.15 );
+    }
+    os << std::endl;
+  }
 
-} // end PrintHistogramStatistics()
+} // end PrintLabelStatistics()
 
 
 #endif // #ifndef __statisticsprinters_h
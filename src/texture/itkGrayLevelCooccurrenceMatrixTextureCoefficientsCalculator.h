@@ -37,6 +37,8 @@
 #include "itkHistogram.h"
 #include "itkMacro.h"
 
+#include <vector>
+
 namespace itk {
 namespace Statistics {
 
@@ -147,6 +149,15 @@ public:
   /** Triggers the computation of the histogram. */
   virtual void Compute( void );
 
+  /** Compute the requested features, given as TextureFeatureName values,
+   * from a flat dense co-occurrence matrix of counts, with
+   * matrix[ i + j * binsPerAxis ] the count of cell i, j. This avoids
+   * the histogram, and the sums that the requested features do not need.
+   * The other features are set to 0.
+   */
+  virtual void ComputeFromMatrix( const unsigned int * matrix,
+    unsigned int binsPerAxis, const std::vector<unsigned int> & features );
+
   /** Connects the GLCM histogram over which the features are going to be computed. */
   itkSetObjectMacro( Histogram, HistogramType );
   itkGetObjectMacro( Histogram, HistogramType );
@@ -202,6 +202,183 @@ GrayLevelCooccurrenceMatrixTextureCoefficientsCalculator< THistogram >
 } // end Compute()
 
 
+/**
+ * ********************* ComputeFromMatrix ****************************
+ */
+
+template< class THistogram >
+void
+GrayLevelCooccurrenceMatrixTextureCoefficientsCalculator< THistogram >
+::ComputeFromMatrix( const unsigned int * matrix,
+  unsigned int binsPerAxis, const std::vector<unsigned int> & features )
+{
+  /** Reset the feature values. */
+  this->ResetFeatureValues();
+
+  /** Which features are requested. */
+  bool requested[ 8 ] = { false, false, false, false, false, false, false, false };
+  for( unsigned int k = 0; k < features.size(); ++k )
+  {
+    if( features[ k ] < 8 ) requested[ features[ k ] ] = true;
+  }
+
+  /** Which sums are needed for the requested features. */
+  const bool computeEnergy   = requested[ Energy ];
+  const bool computeEntropy  = requested[ Entropy ];
+  const bool computeMoments3 = requested[ ClusterShade ] || requested[ ClusterProminence ];
+  const bool computeMoments2 = requested[ Correlation ] || computeMoments3;
+  const bool computeMoments4 = requested[ ClusterProminence ];
+  const bool computeIDM      = requested[ InverseDifferenceMoment ];
+  const bool computeInertia  = requested[ Inertia ];
+  const bool computeHaralick = requested[ HaralickCorrelation ];
+
+  /** Get the total frequency. */
+  const unsigned int numberOfCells = binsPerAxis * binsPerAxis;
+  double totalFrequency = 0.0;
+  for( unsigned int k = 0; k < numberOfCells; ++k )
+  {
+    totalFrequency += matrix[ k ];
+  }
+
+  /** Temporary variables. */
+  double pixelSum_0, pixelSum_00, pixelSum_01, pixelSum_11,
+    pixelSum_000, pixelSum_001, pixelSum_011, pixelSum_111,
+    pixelSum_0000, pixelSum_0001, pixelSum_0011, pixelSum_0111, pixelSum_1111;
+  pixelSum_0
+    = pixelSum_00 = pixelSum_01 = pixelSum_11
+    = pixelSum_000 = pixelSum_001 = pixelSum_011 = pixelSum_111
+    = pixelSum_0000 = pixelSum_0001 = pixelSum_0011
+    = pixelSum_0111 = pixelSum_1111 = 0.0;
+  std::vector<double> marginalSums( computeHaralick ? binsPerAxis : 0, 0.0 );
+
+  /** Walk over the matrix in the order of the histogram, with i fastest. */
+  const double log2 = vcl_log(2.);
+  for( unsigned int j = 0; j < binsPerAxis; ++j )
+  {
+    const unsigned int * row = matrix + j * binsPerAxis;
+    for( unsigned int i = 0; i < binsPerAxis; ++i )
+    {
+      /** No use doing these calculations if we're just multiplying by zero. */
+      if( row[ i ] == 0 ) continue;
+
+      /** Normalize frequency. */
+      const double frequency = static_cast<double>( row[ i ] ) / totalFrequency;
+      const long i0 = i;
+      const long i1 = j;
+
+      if( computeEnergy )
+      {
+        this->m_Energy += frequency * frequency;
+      }
+      if( computeEntropy )
+      {
+        this->m_Entropy -= ( frequency > 0.0001 ) ? frequency * vcl_log( frequency ) / log2 : 0.0;
+      }
+      if( computeMoments2 )
+      {
+        pixelSum_0     += i0 * frequency;
+        pixelSum_00    += i0 * i0 * frequency;
+        pixelSum_01    += i0 * i1 * frequency;
+      }
+      if( computeIDM )
+      {
+        this->m_InverseDifferenceMoment += frequency /
+          ( 1.0 + ( i0 - i1 ) * ( i0 - i1 ) );
+      }
+      if( computeInertia )
+      {
+        this->m_Inertia += ( i0 - i1 ) * ( i0 - i1 ) * frequency;
+      }
+      if( computeMoments3 )
+      {
+        pixelSum_11    += i1 * i1 * frequency;
+        pixelSum_000   += i0 * i0 * i0 * frequency;
+        pixelSum_001   += i0 * i0 * i1 * frequency;
+        pixelSum_011   += i0 * i1 * i1 * frequency;
+        pixelSum_111   += i1 * i1 * i1 * frequency;
+      }
+      if( computeMoments4 )
+      {
+        pixelSum_0000  += i0 * i0 * i0 * i0 * frequency;
+        pixelSum_0001  += i0 * i0 * i0 * i1 * frequency;
+        pixelSum_0011  += i0 * i0 * i1 * i1 * frequency;
+        pixelSum_0111  += i0 * i1 * i1 * i1 * frequency;
+        pixelSum_1111  += i1 * i1 * i1 * i1 * frequency;
+      }
+      if( computeHaralick )
+      {
+        marginalSums[ i0 ] += frequency;
+        this->m_HaralickCorrelation += i0 * i1 * frequency;
+      }
+    }
+  }
+
+  /** Compute intermediate values. */
+  const double pixelMean = pixelSum_0;
+  const double pixelMean2 = pixelMean * pixelMean;
+  const double pixelMean3 = pixelMean2 * pixelMean;
+  const double pixelMean4 = pixelMean3 * pixelMean;
+  const double pixelVariance = pixelSum_00 - pixelMean * pixelMean;
+
+  /** Compute the remaining features. */
+  if( requested[ Correlation ] )
+  {
+    this->m_Correlation = ( pixelSum_01 - pixelMean * pixelMean )
+      / pixelVariance;
+  }
+
+  if( requested[ ClusterShade ] )
+  {
+    this->m_ClusterShade =
+      + 16 * pixelMean3
+      -  6 * pixelMean * pixelSum_00
+      +      pixelSum_000
+      - 12 * pixelMean * pixelSum_01
+      +  3 * pixelSum_001
+      -  6 * pixelMean * pixelSum_11
+      +  3 * pixelSum_011
+      + pixelSum_111;
+  }
+
+  if( computeMoments4 )
+  {
+    this->m_ClusterProminence =
+      - 48 * pixelMean4
+      + 24 * pixelMean2 * pixelSum_00
+      -  8 * pixelMean  * pixelSum_000
+      +      pixelSum_0000
+      + 48 * pixelMean2 * pixelSum_01
+      - 24 * pixelMean  * pixelSum_001
+      +  4 * pixelSum_0001
+      + 24 * pixelMean2 * pixelSum_11
+      - 24 * pixelMean  * pixelSum_011
+      +  6 * pixelSum_0011
+      -  8 * pixelMean  * pixelSum_111
+      +  4 * pixelSum_0111
+      +      pixelSum_1111;
+  }
+
+  if( computeHaralick )
+  {
+    /** Compute marginal mean and variance needed for the HaralickCorrelation. */
+    double marginalMean = 0.0;
+    double marginalSquareMean = 0.0;
+    for( unsigned int i = 0; i < binsPerAxis; ++i )
+    {
+      marginalMean += marginalSums[ i ];
+      marginalSquareMean += marginalSums[ i ] * marginalSums[ i ];
+    }
+    double marginalVariance = marginalSquareMean - marginalMean * marginalMean / binsPerAxis;
+    marginalVariance /= binsPerAxis;
+    marginalMean /= binsPerAxis;
+
+    this->m_HaralickCorrelation -= marginalMean * marginalMean;
+    this->m_HaralickCorrelation /= marginalVariance;
+  }
+
+} // end ComputeFromMatrix()
+
+
 /**
  * ********************* GetFeature ****************************
  */
@@ -39,6 +39,19 @@ namespace itk
  *   the itk::GreyLevelCooccurrenceMatrixTextureCoefficientsCalculator class \n
  * - each feature value is copied to the corresponding output image.
  *
+ * The co-occurrence matrix is not rebuilt for every pixel. Along a line in
+ * the x direction the neighborhood of the next pixel differs from the
+ * current one by two slabs, so the pairs of the leaving slab are removed
+ * from the matrix and those of the entering slab are added. This reduces
+ * the cost per pixel from O(r^D) to O(r^(D-1)). The matrix is a flat dense
+ * array of counts per thread. The input is quantized once beforehand to an
+ * image of bin indices, of 8 bits for up to 254 bins and of 16 bits
+ * otherwise, from which the co-occurrence pairs are counted directly. The
+ * bin image is padded by the largest offset, so that the pairs of all
+ * offsets and scales of a pixel are read from the bins around it in one
+ * go, without bounds checks. The number of histogram bins is at most 65534. The feature calculator
+ * computes only the requested features directly from this array.
+ *
  * This last class is based on several papers from Haralick and Conners:
  *
  * Haralick, R.M., K. Shanmugam and I. Dinstein. 1973.  Textural Features for
@@ -86,6 +99,7 @@ public:
   typedef typename InputImageType::PixelType        InputImagePixelType;
   typedef typename InputImageType::RegionType       InputImageRegionType;
   typedef typename InputImageType::SizeType         InputImageSizeType;
+  typedef typename InputImageType::IndexType        InputImageIndexType;
   typedef TOutputImage                              OutputImageType;
   typedef typename OutputImageType::PixelType       OutputImagePixelType;
   typedef typename OutputImageType::Pointer         OutputImagePointer;
@@ -116,8 +130,17 @@ public:
    *  *****
    */
 
-  /** Set the number of requested output texture features. */
-  itkSetClampMacro( NumberOfRequestedOutputs, unsigned int, 1, 8 );
+  /** Set the number of requested output texture features. This requests
+   * the first n features, in the order of TextureFeatureName.
+   */
+  virtual void SetNumberOfRequestedOutputs( unsigned int n );
+
+  /** Set the requested output texture features, as TextureFeatureName values.
+   * Output i is feature features[ i ]. Only these outputs are allocated,
+   * and only the terms they need are accumulated.
+   */
+  virtual void SetRequestedFeatures( const std::vector<unsigned int> & features );
+  virtual const std::vector<unsigned int> & GetRequestedFeatures( void ) const;
 
   /** Set the size of the neighborhood over which local texture is computed. */
   itkSetMacro( NeighborhoodRadius, unsigned int );
@@ -188,8 +211,27 @@ private:
   virtual void ComputeDefaultOffsets( std::vector<unsigned int> scales );
   virtual void ComputeHistogramMinimumAndMaximum( void );
 
+  /** Private functions to quantize the input to an image of bin indices. */
+  virtual void ComputeBinImage( void );
+  template< class TBinPixel >
+  void QuantizeInput( std::vector<TBinPixel> & binImage,
+    SizeValueType binImageSize ) const;
+
+  /** The offset of an index in the padded bin image. */
+  OffsetValueType GetBinImageOffset( const InputImageIndexType & index ) const;
+
+  /** Add the co-occurrence pairs of the pixels in region to the flat
+   * co-occurrence matrix, or remove them if add is false.
+   */
+  void UpdateMatrix( std::vector<unsigned int> & matrix,
+    const InputImageRegionType & region, bool add ) const;
+  template< class TBinPixel >
+  void UpdateMatrixFromBins( std::vector<unsigned int> & matrix,
+    const InputImageRegionType & region, bool add,
+    const TBinPixel * binImage ) const;
+
   /** Private variables to store results. */
-  unsigned int              m_NumberOfRequestedOutputs;
+  std::vector<unsigned int> m_RequestedFeatures;
   unsigned int              m_NeighborhoodRadius;
 
   /** Private variables for the offsets. */
@@ -205,6 +247,19 @@ private:
   bool                      m_HistogramMaximumSetManually;
   bool                      m_NormalizeHistogram;
 
+  /** The histogram bin of every input pixel, in buffer order, or
+   * m_NumberOfHistogramBins if the pixel is outside the histogram range.
+   * The bin image is padded by the largest offset with the latter value.
+   * Only one of them is used, depending on the number of bins.
+   */
+  std::vector<unsigned char>  m_BinImage8;
+  std::vector<unsigned short> m_BinImage16;
+  InputImageIndexType         m_BinImageOrigin;
+  OffsetValueType             m_BinImageStrides[ InputImageDimension ];
+
+  /** The offsets in the padded bin image. */
+  std::vector<OffsetValueType> m_BufferOffsets;
+
 }; // end class TextureImageToImageFilter
 
 
@@ -21,10 +21,12 @@
 #include "itkTextureImageToImageFilter.h"
 
 #include "../statisticsonimage/itkStatisticsImageFilterWithMask.h"
-#include "itkConstNeighborhoodIterator.h"
+#include "itkImageLinearConstIteratorWithIndex.h"
 #include "itkImageRegionIterator.h"
 #include "itkProgressReporter.h"
 
+#include <algorithm>
+
 
 namespace itk
 {
@@ -37,7 +39,7 @@ template< class TInputImage, class TOutputImage >
 TextureImageToImageFilter< TInputImage, TOutputImage >
 ::TextureImageToImageFilter()
 {
-  this->m_NumberOfRequestedOutputs = 8;
+  this->SetNumberOfRequestedOutputs( 8 );
   this->m_NeighborhoodRadius = 3;
 
   this->m_OffsetsSetManually = false;
@@ -61,6 +63,70 @@ TextureImageToImageFilter< TInputImage, TOutputImage >
 } // end Constructor()
 
 
+/**
+ * ********************* SetNumberOfRequestedOutputs ****************************
+ */
+
+template < class TInputImage, class TOutputImage >
+void
+TextureImageToImageFilter< TInputImage, TOutputImage >
+::SetNumberOfRequestedOutputs( unsigned int n )
+{
+  n = std::max( 1u, std::min( n, 8u ) );
+  std::vector<unsigned int> features( n );
+  for( unsigned int i = 0; i < n; ++i )
+  {
+    features[ i ] = i;
+  }
+  this->SetRequestedFeatures( features );
+
+} // end SetNumberOfRequestedOutputs()
+
+
+/**
+ * ********************* SetRequestedFeatures ****************************
+ */
+
+template < class TInputImage, class TOutputImage >
+void
+TextureImageToImageFilter< TInputImage, TOutputImage >
+::SetRequestedFeatures( const std::vector<unsigned int> & features )
+{
+  if( features.empty() || features.size() > 8 )
+  {
+    itkExceptionMacro( << "Between 1 and 8 features should be requested, not "
+      << features.size() << "." );
+  }
+  for( unsigned int i = 0; i < features.size(); ++i )
+  {
+    if( features[ i ] > Statistics::HaralickCorrelation )
+    {
+      itkExceptionMacro( << "Unknown texture feature " << features[ i ] << "." );
+    }
+  }
+
+  if( features != this->m_RequestedFeatures )
+  {
+    this->m_RequestedFeatures = features;
+    this->Modified();
+  }
+
+} // end SetRequestedFeatures()
+
+
+/**
+ * ********************* GetRequestedFeatures ****************************
+ */
+
+template < class TInputImage, class TOutputImage >
+const std::vector<unsigned int> &
+TextureImageToImageFilter< TInputImage, TOutputImage >
+::GetRequestedFeatures( void ) const
+{
+  return this->m_RequestedFeatures;
+} // end GetRequestedFeatures()
+
+
 /**
  * ********************* SetHistogramMinimum ****************************
  */
@@ -199,7 +265,7 @@ TextureImageToImageFilter< TInputImage, TOutputImage >
   inputPtr->Update();
 
   /** Create outputs. */
-  this->SetAndCreateOutputs( this->m_NumberOfRequestedOutputs );
+  this->SetAndCreateOutputs( this->m_RequestedFeatures.size() );
 
   /** Compute the minimum and maximum histogram entries. */
   this->ComputeHistogramMinimumAndMaximum();
@@ -207,6 +273,9 @@ TextureImageToImageFilter< TInputImage, TOutputImage >
   /** Compute the offsets. */
   this->ComputeDefaultOffsets( this->m_OffsetScales );
 
+  /** Compute the histogram bins of the input pixels. */
+  this->ComputeBinImage();
+
 } // end BeforeThreadedGenerateData()
 
 
@@ -222,30 +291,18 @@ TextureImageToImageFilter< TInputImage, TOutputImage >
   /** Support for progress methods/callbacks. */
   ProgressReporter progress( this, threadId, regionForThread.GetNumberOfPixels() );
 
-  /** Setup the local co-occurrence matrix generator. */
-  typename CooccurrenceMatrixGeneratorType::Pointer cmGenerator
-    = CooccurrenceMatrixGeneratorType::New();
-  cmGenerator->SetInput( this->GetInput() );
-  cmGenerator->SetOffsets( this->m_Offsets );
-  cmGenerator->SetNumberOfBinsPerAxis( this->m_NumberOfHistogramBins );
-  cmGenerator->SetPixelValueMinMax( this->m_HistogramMinimum, this->m_HistogramMaximum );
-  cmGenerator->SetNormalize( this->m_NormalizeHistogram );
+  /** Setup the local co-occurrence matrix. */
+  const unsigned int bins = this->m_NumberOfHistogramBins;
+  std::vector<unsigned int> matrix( bins * bins, 0 );
 
   /** Setup local texture feature calculator. */
   typename TextureCalculatorType::Pointer cmCalculator
     = TextureCalculatorType::New();
 
   /** Typedefs. */
-  typedef ConstNeighborhoodIterator< InputImageType >         ConstNeighborhoodIteratorType;
-  typedef typename ConstNeighborhoodIteratorType::RadiusType  RadiusType;
+  typedef ImageLinearConstIteratorWithIndex< InputImageType > LineIteratorType;
   typedef ImageRegionIterator< OutputImageType >              OutputIteratorType;
 
-  /** Setup a neigborhood iterator over the input image. */
-  RadiusType radius;
-  radius.Fill( this->m_NeighborhoodRadius );
-  ConstNeighborhoodIteratorType nit( radius, this->GetInput(), regionForThread );
-  nit.GoToBegin();
-
   /** Setup iterators over the output images. */
   const unsigned int noo = this->GetNumberOfOutputs();
   std::vector< OutputIteratorType > outputIterators( noo );
@@ -255,42 +312,302 @@ TextureImageToImageFilter< TInputImage, TOutputImage >
     outputIterators[ i ].GoToBegin();
   }
 
-  /** Loop over the input region. */
-  InputImageRegionType localRegion;
-  while ( !nit.IsAtEnd() )
+  /** The neighborhood and the extent of the image along the lines. */
+  const IndexValueType radius = this->m_NeighborhoodRadius;
+  const InputImageRegionType & largestRegion = this->GetInput()->GetLargestPossibleRegion();
+  const IndexValueType largestBegin = largestRegion.GetIndex()[ 0 ];
+  const IndexValueType largestEnd
+    = largestBegin + static_cast<IndexValueType>( largestRegion.GetSize()[ 0 ] );
+  const SizeValueType lineLength = regionForThread.GetSize()[ 0 ];
+  InputImageSizeType localSize;
+  localSize.Fill( 2 * this->m_NeighborhoodRadius + 1 );
+
+  /** Loop over the lines of the input region in the x direction. */
+  LineIteratorType lit( this->GetInput(), regionForThread );
+  lit.SetDirection( 0 );
+  for ( lit.GoToBegin(); !lit.IsAtEnd(); lit.NextLine() )
   {
-    /** Construct a local neighborhood over which GLCM computation takes place.
-     * The regions have to be cropped with the largest possible region
-     * of the input image, to avoid problems at the border.
-     * Note that a larger subimage than localRegion is actually used for
-     * computing the co-occurrence matrix, because of the offsets.
+    /** Construct the neighborhood of the first pixel of the line over which
+     * GLCM computation takes place. The region has to be cropped with the
+     * largest possible region of the input image, to avoid problems at the
+     * border. Note that a larger subimage than localRegion is actually used
+     * for computing the co-occurrence matrix, because of the offsets.
      */
-    localRegion = nit.GetBoundingBoxAsImageRegion();
-    localRegion.Crop( this->GetInput()->GetLargestPossibleRegion() );
+    const InputImageIndexType lineIndex = lit.GetIndex();
+    InputImageIndexType localIndex;
+    for( unsigned int i = 0; i < InputImageDimension; ++i )
+    {
+      localIndex[ i ] = lineIndex[ i ] - radius;
+    }
+    InputImageRegionType localRegion( localIndex, localSize );
+    localRegion.Crop( largestRegion );
 
-    /** Generate the co-occurrence over a local region only. */
-    cmGenerator->SetComputeRegion( localRegion );
-    cmGenerator->Compute();
+    /** Generate the co-occurrence matrix of the first pixel from scratch. */
+    std::fill( matrix.begin(), matrix.end(), 0 );
+    this->UpdateMatrix( matrix, localRegion, true );
 
-    /** Compute texture features from this co-occurrence matrix. */
-    cmCalculator->SetHistogram( cmGenerator->GetOutput() );
-    cmCalculator->Compute();
+    /** The slabs have the extent of the neighborhood in the other directions. */
+    InputImageRegionType slab = localRegion;
+    slab.SetSize( 0, 1 );
 
-    /** Copy the requested texture features to the outputs and update iterators. */
-    for( unsigned int ii = 0; ii < noo; ++ii )
+    for( SizeValueType x = 0; x < lineLength; ++x )
     {
-      outputIterators[ ii ].Set( cmCalculator->GetFeature( ii ) );
-      ++outputIterators[ ii ];
-    }
-    ++nit;
+      /** Slide the neighborhood one pixel along the line. */
+      if( x > 0 )
+      {
+        const IndexValueType center = lineIndex[ 0 ] + static_cast<IndexValueType>( x );
+        if( center - radius - 1 >= largestBegin )
+        {
+          slab.SetIndex( 0, center - radius - 1 );
+          this->UpdateMatrix( matrix, slab, false );
+        }
+        if( center + radius < largestEnd )
+        {
+          slab.SetIndex( 0, center + radius );
+          this->UpdateMatrix( matrix, slab, true );
+        }
+      }
 
-    progress.CompletedPixel();
+      /** Compute the requested texture features from this co-occurrence matrix. */
+      cmCalculator->ComputeFromMatrix( &matrix[ 0 ], bins, this->m_RequestedFeatures );
 
-  } // end while
+      /** Copy the requested texture features to the outputs and update iterators. */
+      for( unsigned int ii = 0; ii < noo; ++ii )
+      {
+        outputIterators[ ii ].Set( cmCalculator->GetFeature( this->m_RequestedFeatures[ ii ] ) );
+        ++outputIterators[ ii ];
+      }
+
+      progress.CompletedPixel();
+
+    } // end for x
+  } // end for lines
 
 } // end ThreadedGenerateData()
 
 
+/**
+ * ********************* ComputeBinImage ****************************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+TextureImageToImageFilter< TInputImage, TOutputImage >
+::ComputeBinImage( void )
+{
+  /** One more value than the number of bins is needed, for the pixels
+   * outside the histogram range.
+   */
+  const unsigned int bins = this->m_NumberOfHistogramBins;
+  if( bins > NumericTraits<unsigned short>::max() - 1 )
+  {
+    itkExceptionMacro( << "The number of histogram bins (" << bins
+      << ") should be smaller than "
+      << NumericTraits<unsigned short>::max() << "." );
+  }
+
+  /** The bin image is padded by the largest offset in every direction,
+   * so that the pixel at an offset never lies outside of it.
+   */
+  const InputImageType * input = this->GetInput();
+  const InputImageRegionType & bufferedRegion = input->GetBufferedRegion();
+  InputImageSizeType padding;
+  padding.Fill( 0 );
+  for( unsigned int k = 0; k < this->m_Offsets->Size(); ++k )
+  {
+    const OffsetType offset = this->m_Offsets->GetElement( k );
+    for( unsigned int i = 0; i < InputImageDimension; ++i )
+    {
+      const SizeValueType extent
+        = static_cast<SizeValueType>( offset[ i ] < 0 ? -offset[ i ] : offset[ i ] );
+      padding[ i ] = std::max( padding[ i ], extent );
+    }
+  }
+  SizeValueType stride = 1;
+  for( unsigned int i = 0; i < InputImageDimension; ++i )
+  {
+    this->m_BinImageOrigin[ i ] = bufferedRegion.GetIndex()[ i ]
+      - static_cast<IndexValueType>( padding[ i ] );
+    this->m_BinImageStrides[ i ] = static_cast<OffsetValueType>( stride );
+    stride *= bufferedRegion.GetSize()[ i ] + 2 * padding[ i ];
+  }
+
+  /** Quantize to the smallest type that fits. */
+  if( bins < NumericTraits<unsigned char>::max() )
+  {
+    this->m_BinImage16.clear();
+    this->QuantizeInput( this->m_BinImage8, stride );
+  }
+  else
+  {
+    this->m_BinImage8.clear();
+    this->QuantizeInput( this->m_BinImage16, stride );
+  }
+
+  /** The offsets in the bin image. */
+  this->m_BufferOffsets.resize( this->m_Offsets->Size() );
+  for( unsigned int k = 0; k < this->m_Offsets->Size(); ++k )
+  {
+    const OffsetType offset = this->m_Offsets->GetElement( k );
+    OffsetValueType bufferOffset = 0;
+    for( unsigned int i = 0; i < InputImageDimension; ++i )
+    {
+      bufferOffset += offset[ i ] * this->m_BinImageStrides[ i ];
+    }
+    this->m_BufferOffsets[ k ] = bufferOffset;
+  }
+
+} // end ComputeBinImage()
+
+
+/**
+ * ********************* QuantizeInput ****************************
+ */
+
+template< class TInputImage, class TOutputImage >
+template< class TBinPixel >
+void
+TextureImageToImageFilter< TInputImage, TOutputImage >
+::QuantizeInput( std::vector<TBinPixel> & binImage, SizeValueType binImageSize ) const
+{
+  /** The bins are those of ScalarImageToGrayLevelCooccurrenceMatrixGenerator:
+   * equally sized from the minimum up to the maximum plus one. The padding
+   * gets the bin of the pixels outside the histogram range.
+   */
+  typedef ImageLinearConstIteratorWithIndex< InputImageType > LineIteratorType;
+  const InputImageType * input = this->GetInput();
+  const unsigned int bins = this->m_NumberOfHistogramBins;
+  const double lower = static_cast<double>( this->m_HistogramMinimum );
+  const double upper = static_cast<double>( this->m_HistogramMaximum + 1 );
+  const double scale = bins / ( upper - lower );
+
+  binImage.assign( binImageSize, static_cast<TBinPixel>( bins ) );
+  LineIteratorType it( input, input->GetBufferedRegion() );
+  it.SetDirection( 0 );
+  for( it.GoToBegin(); !it.IsAtEnd(); it.NextLine() )
+  {
+    TBinPixel * bit = &binImage[ this->GetBinImageOffset( it.GetIndex() ) ];
+    for( ; !it.IsAtEndOfLine(); ++it, ++bit )
+    {
+      const InputImagePixelType value = it.Get();
+      if( value < this->m_HistogramMinimum || value > this->m_HistogramMaximum )
+      {
+        continue;
+      }
+      const unsigned int bin = static_cast<unsigned int>(
+        ( static_cast<double>( value ) - lower ) * scale );
+      *bit = static_cast<TBinPixel>( std::min( bin, bins - 1 ) );
+    }
+  }
+
+} // end QuantizeInput()
+
+
+/**
+ * ********************* GetBinImageOffset ****************************
+ */
+
+template< class TInputImage, class TOutputImage >
+OffsetValueType
+TextureImageToImageFilter< TInputImage, TOutputImage >
+::GetBinImageOffset( const InputImageIndexType & index ) const
+{
+  OffsetValueType offset = 0;
+  for( unsigned int i = 0; i < InputImageDimension; ++i )
+  {
+    offset += ( index[ i ] - this->m_BinImageOrigin[ i ] ) * this->m_BinImageStrides[ i ];
+  }
+  return offset;
+
+} // end GetBinImageOffset()
+
+
+/**
+ * ********************* UpdateMatrix ****************************
+ */
+
+template< class TInputImage, class TOutputImage >
+void
+TextureImageToImageFilter< TInputImage, TOutputImage >
+::UpdateMatrix( std::vector<unsigned int> & matrix,
+  const InputImageRegionType & region, bool add ) const
+{
+  if( !this->m_BinImage8.empty() )
+  {
+    this->UpdateMatrixFromBins( matrix, region, add, &this->m_BinImage8[ 0 ] );
+  }
+  else
+  {
+    this->UpdateMatrixFromBins( matrix, region, add, &this->m_BinImage16[ 0 ] );
+  }
+
+} // end UpdateMatrix()
+
+
+/**
+ * ********************* UpdateMatrixFromBins ****************************
+ */
+
+template< class TInputImage, class TOutputImage >
+template< class TBinPixel >
+void
+TextureImageToImageFilter< TInputImage, TOutputImage >
+::UpdateMatrixFromBins( std::vector<unsigned int> & matrix,
+  const InputImageRegionType & region, bool add,
+  const TBinPixel * binImage ) const
+{
+  /** The pairs are those of ScalarImageToGrayLevelCooccurrenceMatrixGenerator:
+   * a pixel in the region and the pixel at an offset, which may lie outside
+   * the region but not outside the image, both within the histogram range.
+   * Outside the image the padded bin image has the out of range bin, so the
+   * pairs of all offsets are read from the bins around a pixel without any
+   * bounds checks, line by line.
+   */
+  const SizeValueType numberOfPixels = region.GetNumberOfPixels();
+  if( numberOfPixels == 0 ) return;
+
+  const unsigned int bins = this->m_NumberOfHistogramBins;
+  const unsigned int numberOfOffsets = this->m_BufferOffsets.size();
+  const OffsetValueType * bufferOffsets = &this->m_BufferOffsets[ 0 ];
+  const unsigned int increment = add ? 1 : static_cast<unsigned int>( -1 );
+  const InputImageSizeType & size = region.GetSize();
+  const SizeValueType numberOfLines = numberOfPixels / size[ 0 ];
+
+  OffsetValueType lineOffset = this->GetBinImageOffset( region.GetIndex() );
+  InputImageSizeType position;
+  position.Fill( 0 );
+  for( SizeValueType line = 0; line < numberOfLines; ++line )
+  {
+    const TBinPixel * centerBins = binImage + lineOffset;
+    for( SizeValueType x = 0; x < size[ 0 ]; ++x )
+    {
+      const unsigned int centerBin = centerBins[ x ];
+      if( centerBin == bins ) continue;
+
+      for( unsigned int k = 0; k < numberOfOffsets; ++k )
+      {
+        const unsigned int bin = centerBins[ x + bufferOffsets[ k ] ];
+        if( bin == bins ) continue;
+
+        /** Both co-occurrence combinations, modulo 2^32 when removing. */
+        matrix[ centerBin + bin * bins ] += increment;
+        matrix[ bin + centerBin * bins ] += increment;
+      }
+    }
+
+    /** The next line of the region. */
+    for( unsigned int i = 1; i < InputImageDimension; ++i )
+    {
+      lineOffset += this->m_BinImageStrides[ i ];
+      if( ++position[ i ] < size[ i ] ) break;
+      lineOffset -= static_cast<OffsetValueType>( size[ i ] ) * this->m_BinImageStrides[ i ];
+      position[ i ] = 0;
+    }
+  }
+
+} // end UpdateMatrixFromBins()
+
+
 /**
  * ********************* SetAndCreateOutputs ****************************
  */
@@ -425,8 +742,12 @@ TextureImageToImageFilter< TInputImage, TOutputImage >
   /** Print the member variables. */
   os << indent << "NeighborhoodRadius: "
     << this->m_NeighborhoodRadius << std::endl;
-  os << indent << "NumberOfRequestedOutputs: "
-    << this->m_NumberOfRequestedOutputs << std::endl;
+  os << indent << "RequestedFeatures: ";
+  for( unsigned int i = 0; i < this->m_RequestedFeatures.size(); ++i )
+  {
+    os << this->m_RequestedFeatures[ i ] << " ";
+  }
+  os << std::endl;
 
   os << indent << "OffsetsSetManually: "
     << this->m_OffsetsSetManually << std::endl;
@@ -28,6 +28,8 @@
 #include "ITKToolsHelpers.h"
 #include "texture.h"
 
+#include <algorithm>
+
 
 /**
  * ******************* GetHelpString *******************
@@ -46,6 +48,12 @@ std::string GetHelpString( void )
     << "  [-os]    the desired offset scales to compute the GLCM, default 1, but can be e.g. 1 2 4\n"
     << "  [-b]     the number of bins of the GLCM, default 128\n"
     << "  [-noo]   the number of filter feature outputs, default all 8\n"
+    << "  [-f]     the filter features to compute, overrides -noo, choose from:\n"
+    << "           energy, entropy, correlation, inverseDifferenceMoment, inertia,\n"
+    << "           clusterShade, clusterProminence, HaralickCorrelation\n"
+    << "  [-local] also compute the local mean and variance over the neighborhood,\n"
+    << "           written to localMean.mhd and localVariance.mhd;\n"
+    << "           with -noo 0 only these are computed\n"
     << "  [-opct]  output pixel component type, default float\n"
     << "Supported: 2D, 3D, any input image type, float or double output type.";
 
@@ -100,6 +108,11 @@ int main( int argc, char **argv )
   unsigned int numberOfOutputs = 8;
   parser->GetCommandLineArgument( "-noo", numberOfOutputs );
 
+  std::vector<std::string> featureNames;
+  parser->GetCommandLineArgument( "-f", featureNames );
+
+  const bool computeLocalStatistics = parser->ArgumentExists( "-local" );
+
   std::string componentTypeOutString = "float";
   parser->GetCommandLineArgument( "-opct", componentTypeOutString );
 
@@ -111,11 +124,26 @@ int main( int argc, char **argv )
     return EXIT_FAILURE;
   }
 
-  /** Threads. */
-  unsigned int maximumNumberOfThreads
-    = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
-  itk::MultiThreader::SetGlobalMaximumNumberOfThreads(
-    maximumNumberOfThreads );
+  /** Convert the feature names to the feature numbers. */
+  const std::vector<std::string> knownFeatureNames = GetTextureFeatureNames();
+  std::vector<unsigned int> features;
+  for( unsigned int i = 0; i < featureNames.size(); ++i )
+  {
+    std::vector<std::string>::const_iterator pos = std::find(
+      knownFeatureNames.begin(), knownFeatureNames.end(), featureNames[ i ] );
+    if( pos == knownFeatureNames.end() )
+    {
+      std::cerr << "ERROR: Unknown feature \"" << featureNames[ i ] << "\"." << std::endl;
+      return EXIT_FAILURE;
+    }
+    features.push_back( static_cast<unsigned int>( pos - knownFeatureNames.begin() ) );
+  }
+  if( features.size() > 8 )
+  {
+    std::cerr << "ERROR: The maximum number of outputs is 8. You requested "
+      << features.size() << "." << std::endl;
+    return EXIT_FAILURE;
+  }
 
   /** Determine image properties. */
   itk::ImageIOBase::IOPixelType pixelType = itk::ImageIOBase::UNKNOWNPIXELTYPE;
@@ -161,7 +189,10 @@ int main( int argc, char **argv )
     filter->m_OffsetScales = offsetScales;
     filter->m_NumberOfBins = numberOfBins;
     filter->m_NumberOfOutputs = numberOfOutputs;
+    filter->m_Features = features;
+    filter->m_ComputeLocalStatistics = computeLocalStatistics;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
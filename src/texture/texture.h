@@ -23,11 +23,31 @@
 #include <itksys/SystemTools.hxx>
 
 #include "itkTextureImageToImageFilter.h"
+#include "itkBoxMeanVarianceImageFilter.h"
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
 #include "itkMultiThreader.h"
 
 
+/** The names of the texture features, in the order of
+ * itk::Statistics::TextureFeatureName, as used for the output file names.
+ */
+inline std::vector< std::string > GetTextureFeatureNames( void )
+{
+  std::vector< std::string > names( 8, "" );
+  names[ 0 ] = "energy";
+  names[ 1 ] = "entropy";
+  names[ 2 ] = "correlation";
+  names[ 3 ] = "inverseDifferenceMoment";
+  names[ 4 ] = "inertia";
+  names[ 5 ] = "clusterShade";
+  names[ 6 ] = "clusterProminence";
+  names[ 7 ] = "HaralickCorrelation";
+  return names;
+
+} // end GetTextureFeatureNames()
+
+
 /** \class ITKToolsTextureBase
  *
  * Untemplated pure virtual base class that holds
@@ -45,6 +65,7 @@ public:
     this->m_NeighborhoodRadius = 0;
     this->m_NumberOfBins = 0;
     this->m_NumberOfOutputs = 0;
+    this->m_ComputeLocalStatistics = false;
   };
   /** Destructor. */
   ~ITKToolsTextureBase(){};
@@ -56,6 +77,8 @@ public:
   std::vector< unsigned int > m_OffsetScales;
   unsigned int m_NumberOfBins;
   unsigned int m_NumberOfOutputs;
+  std::vector< unsigned int > m_Features;
+  bool m_ComputeLocalStatistics;
 
 }; // end class ITKToolsTextureBase
 
@@ -101,12 +124,41 @@ public:
     typedef itk::Image<TOutputComponentType, VDimension>  OutputImageType;
     typedef itk::TextureImageToImageFilter<
       InputImageType, OutputImageType >                   TextureFilterType;
+    typedef itk::BoxMeanVarianceImageFilter<
+      InputImageType, OutputImageType >                   BoxFilterType;
     typedef itk::ImageFileReader< InputImageType >        ReaderType;
     typedef itk::ImageFileWriter< OutputImageType >       WriterType;
 
     /** Read the input. */
     typename ReaderType::Pointer reader = ReaderType::New();
     reader->SetFileName( this->m_InputFileName.c_str() );
+    this->ObserveProcess( reader.GetPointer(), "read" );
+
+    /** The local mean and variance over the same neighborhood, with
+     * running sums, in O(1) per pixel for any radius.
+     */
+    if( this->m_ComputeLocalStatistics )
+    {
+      typename BoxFilterType::Pointer boxFilter = BoxFilterType::New();
+      boxFilter->SetInput( reader->GetOutput() );
+      boxFilter->SetRadius( this->m_NeighborhoodRadius );
+      this->ObserveProcess( boxFilter.GetPointer(), "local statistics" );
+
+      typename WriterType::Pointer meanWriter = WriterType::New();
+      meanWriter->SetFileName( ( this->m_OutputDirectory + "localMean.mhd" ).c_str() );
+      meanWriter->SetInput( boxFilter->GetMeanOutput() );
+      this->ObserveProcess( meanWriter.GetPointer(), "write" );
+      meanWriter->Update();
+
+      typename WriterType::Pointer varianceWriter = WriterType::New();
+      varianceWriter->SetFileName( ( this->m_OutputDirectory + "localVariance.mhd" ).c_str() );
+      varianceWriter->SetInput( boxFilter->GetVarianceOutput() );
+      this->ObserveProcess( varianceWriter.GetPointer(), "write" );
+      varianceWriter->Update();
+    }
+
+    /** Only the local statistics are requested. */
+    if( this->m_Features.empty() && this->m_NumberOfOutputs == 0 ) return;
 
     /** Setup the filter filter. */
     typename TextureFilterType::Pointer textureFilter = TextureFilterType::New();
@@ -115,7 +167,14 @@ public:
     textureFilter->SetOffsetScales( this->m_OffsetScales );
     textureFilter->SetNumberOfHistogramBins( this->m_NumberOfBins );
     textureFilter->SetNormalizeHistogram( false );
-    textureFilter->SetNumberOfRequestedOutputs( this->m_NumberOfOutputs );
+    if( this->m_Features.empty() )
+    {
+      textureFilter->SetNumberOfRequestedOutputs( this->m_NumberOfOutputs );
+    }
+    else
+    {
+      textureFilter->SetRequestedFeatures( this->m_Features );
+    }
 
     /** Create and attach a progress observer. */
     ShowProgressObject progressWatch( textureFilter );
@@ -124,23 +183,21 @@ public:
     progressCommand->SetCallbackFunction( &progressWatch, &ShowProgressObject::ShowProgress );
     textureFilter->AddObserver( itk::ProgressEvent(), progressCommand );
 
+    this->ObserveProcess( textureFilter.GetPointer(), "texture" );
+
     /** Create the output file names. */
-    std::vector< std::string > outputFileNames( 8, "" );
-    outputFileNames[ 0 ] = this->m_OutputDirectory + "energy.mhd";
-    outputFileNames[ 1 ] = this->m_OutputDirectory + "entropy.mhd";
-    outputFileNames[ 2 ] = this->m_OutputDirectory + "correlation.mhd";
-    outputFileNames[ 3 ] = this->m_OutputDirectory + "inverseDifferenceMoment.mhd";
-    outputFileNames[ 4 ] = this->m_OutputDirectory + "inertia.mhd";
-    outputFileNames[ 5 ] = this->m_OutputDirectory + "clusterShade.mhd";
-    outputFileNames[ 6 ] = this->m_OutputDirectory + "clusterProminence.mhd";
-    outputFileNames[ 7 ] = this->m_OutputDirectory + "HaralickCorrelation.mhd";
+    const std::vector< std::string > featureNames = GetTextureFeatureNames();
+    const std::vector< unsigned int > & features = textureFilter->GetRequestedFeatures();
 
     /** Setup and process the pipeline. */
-    for( unsigned int i = 0; i < this->m_NumberOfOutputs; ++i )
+    for( unsigned int i = 0; i < features.size(); ++i )
     {
+      const std::string outputFileName
+        = this->m_OutputDirectory + featureNames[ features[ i ] ] + ".mhd";
       typename WriterType::Pointer writer = WriterType::New();
-      writer->SetFileName( outputFileNames[ i ].c_str() );
+      writer->SetFileName( outputFileName.c_str() );
       writer->SetInput( textureFilter->GetOutput( i ) );
+      this->ObserveProcess( writer.GetPointer(), "write" );
       writer->Update();
     }
   } // end Run()
@@ -50,8 +50,8 @@
 #endif
 
 #include "itkImageToImageFilter.h"
-#include "itkOtsuThresholdCalculator.h"
 #include "itkNumericTraits.h"
+#include "itkMultiThreader.h"
 
 #include "itkVector.h"
 #include "itkPointSet.h"
@@ -117,9 +117,6 @@ public:
   typedef typename ROIFilterType::Pointer
     ROIFilterPointer;
 
-  typedef OtsuThresholdCalculator< InputImageType >       OtsuThresholdType;
-  typedef typename OtsuThresholdType::Pointer             OtsuThresholdPointer;
-
   typedef Vector< InputCoordType, 1 >         VectorType;
   typedef Image< VectorType, ImageDimension > VectorImageType;
   typedef typename VectorImageType::PixelType VectorPixelType;
@@ -168,6 +165,20 @@ public:
   itkSetMacro(InsideValue, OutputPixelType);
   itkGetConstReferenceMacro(InsideValue, OutputPixelType);
 
+  /** Assemble the histograms of the local windows from an integral
+   * histogram over blocks of the image, which is built once. The blocks of
+   * a window are then added in O(bins) time, only the voxels of the window
+   * outside whole blocks are visited. The histogram bins span the range of
+   * the whole image instead of that of the window. Default off.
+   */
+  itkSetMacro(UseIntegralHistogram, bool);
+  itkGetConstMacro(UseIntegralHistogram, bool);
+  itkBooleanMacro(UseIntegralHistogram);
+
+  /** The size of the blocks of the integral histogram, default 8. */
+  itkSetMacro(IntegralHistogramBlockSize, unsigned int);
+  itkGetConstMacro(IntegralHistogramBlockSize, unsigned int);
+
   OutputImagePointer GetThresholdImage()
     {
     return this->m_Threshold;
@@ -186,6 +197,36 @@ protected:
   void ComputeRandomPointSet();
   void GenerateData();
 
+  /** The local thresholds of the samples are independent, and are computed
+   * in parallel. Every thread computes the thresholds of a chunk of the
+   * samples, reusing one histogram.
+   */
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback( void * arg );
+  void ThreadedComputeLocalThresholds( unsigned int threadId, unsigned int numberOfThreads );
+
+  /** Compute the Otsu threshold of a region of the input, as
+   * OtsuThresholdImageCalculator does, using histogram as workspace.
+   */
+  InputCoordType ComputeLocalThreshold( const InputImageRegionType & region,
+    std::vector<double> & histogram ) const;
+
+  /** Compute the Otsu threshold of a window from the integral histogram. */
+  InputCoordType ComputeLocalThresholdFromIntegralHistogram(
+    const InputImageRegionType & region, std::vector<double> & histogram ) const;
+
+  /** Find the bin of maximum between-class variance in the bins first to
+   * last of a histogram of counts, relative to first. The counts are
+   * normalized in place.
+   */
+  unsigned int ComputeOtsuBin( std::vector<double> & histogram,
+    unsigned int first, unsigned int last ) const;
+
+  /** Build the integral histogram over the blocks of the input. */
+  void ComputeIntegralHistogram();
+
+  /** The global histogram bin of a value. */
+  unsigned int GetGlobalBin( InputPixelType value ) const;
+
   InputSizeType m_Radius;
   unsigned int m_NumberOfHistogramBins;
   unsigned int m_NumberOfControlPoints;
@@ -198,6 +239,17 @@ protected:
   PointSetPointer m_PointSet;
   OutputImagePointer m_Threshold;
 
+  /** The integral histogram: for every corner of the block grid the counts
+   * of the voxels in all blocks before it, bins per corner.
+   */
+  bool m_UseIntegralHistogram;
+  unsigned int m_IntegralHistogramBlockSize;
+  std::vector<unsigned int> m_IntegralHistogram;
+  SizeValueType m_CornerStrides[ ImageDimension ];
+  InputPixelType m_GlobalMinimum;
+  InputPixelType m_GlobalMaximum;
+  double m_GlobalBinMultiplier;
+
 private:
 
   AdaptiveOtsuThresholdImageFilter( const Self&);   // intentionally not implemented
@@ -43,6 +43,12 @@
 
 #include "itkAdaptiveOtsuThresholdImageFilter.h"
 
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "vnl/vnl_math.h"
+
+#include <algorithm>
+#include <vector>
+
 namespace itk
 {
 //  Software Guide : BeginCodeSnippet
@@ -60,6 +66,11 @@ AdaptiveOtsuThresholdImageFilter()
   this->m_InsideValue = 1;
 
   this->m_PointSet = NULL;
+  this->m_UseIntegralHistogram = false;
+  this->m_IntegralHistogramBlockSize = 8;
+  this->m_GlobalMinimum = NumericTraits<InputPixelType>::Zero;
+  this->m_GlobalMaximum = NumericTraits<InputPixelType>::Zero;
+  this->m_GlobalBinMultiplier = 0.0;
 
   this->Superclass::SetNumberOfRequiredInputs( 1 );
   this->Superclass::SetNumberOfRequiredOutputs( 1 );
@@ -131,40 +142,25 @@ AdaptiveOtsuThresholdImageFilter<TInputImage, TOutputImage>
   InputImageRegionType inputRegion = input->GetLargestPossibleRegion();
   InputSizeType inputSize = inputRegion.GetSize();
 
-  InputIndexType startIndex;
-  InputImageRegionType region;
-  region.SetSize( this->m_Radius );
-
-  PointSetPointType point;
-  VectorPixelType V;
-
   if( !m_PointSet )
     {
     ComputeRandomPointSet();
     }
 
-  PointsContainerPointer
-    pointscontainer = this->m_PointSet->GetPoints();
-  PointDataContainerPointer pointdatacontainer =  this->m_PointSet->GetPointData();
-  for( unsigned long i = 0; i < this->m_NumberOfSamples; i++ )
-  {
-    point = pointscontainer->GetElement( i );
-    input->TransformPhysicalPointToIndex( point, startIndex );
-    region.SetIndex( startIndex );
-
-    ROIFilterPointer roi = ROIFilterType::New();
-    roi->SetInput( input );
-    roi->SetRegionOfInterest( region );
-    roi->Update();
-
-    OtsuThresholdPointer otsu = OtsuThresholdType::New();
-    otsu->SetImage( roi->GetOutput() );
-    otsu->SetNumberOfHistogramBins( this->m_NumberOfHistogramBins);
-    otsu->Compute();
-
-    V[0] = static_cast<InputCoordType>( otsu->GetThreshold() );
-    pointdatacontainer->SetElement( i, V );
-  }
+  // Compute the local thresholds of all samples in parallel, the point
+  // data is sized beforehand so that the threads only set elements
+  if( !this->m_PointSet->GetPointData() )
+    {
+    this->m_PointSet->SetPointData( PointDataContainer::New() );
+    }
+  this->m_PointSet->GetPointData()->Reserve( this->m_NumberOfSamples );
+  if( this->m_UseIntegralHistogram )
+    {
+    this->ComputeIntegralHistogram();
+    }
+  this->GetMultiThreader()->SetSingleMethod( this->ThreaderCallback, this );
+  this->GetMultiThreader()->SingleMethodExecute();
+  this->m_IntegralHistogram.clear();
 
   typename SDAFilterType::ArrayType ncps;
   ncps.Fill( this->m_NumberOfControlPoints );
@@ -214,6 +210,365 @@ AdaptiveOtsuThresholdImageFilter<TInputImage, TOutputImage>
     }
 }
 
+template< class TInputImage, class TOutputImage >
+ITK_THREAD_RETURN_TYPE
+AdaptiveOtsuThresholdImageFilter<TInputImage, TOutputImage>
+::ThreaderCallback( void * arg )
+{
+  typedef MultiThreader::ThreadInfoStruct ThreadInfoType;
+  ThreadInfoType * info = static_cast<ThreadInfoType *>( arg );
+  Self * filter = static_cast<Self *>( info->UserData );
+
+  filter->ThreadedComputeLocalThresholds( info->ThreadID, info->NumberOfThreads );
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< class TInputImage, class TOutputImage >
+void
+AdaptiveOtsuThresholdImageFilter<TInputImage, TOutputImage>
+::ThreadedComputeLocalThresholds( unsigned int threadId, unsigned int numberOfThreads )
+{
+  InputConstImagePointer input = this->GetInput();
+  const InputImageRegionType & bufferedRegion = input->GetBufferedRegion();
+
+  PointsContainerPointer
+    pointscontainer = this->m_PointSet->GetPoints();
+  PointDataContainerPointer
+    pointdatacontainer = this->m_PointSet->GetPointData();
+
+  // The histogram is the workspace of this thread, for all its samples
+  std::vector<double> histogram( this->m_NumberOfHistogramBins );
+
+  InputIndexType startIndex;
+  InputImageRegionType region;
+  region.SetSize( this->m_Radius );
+  VectorPixelType V;
+
+  const unsigned long n = this->m_NumberOfSamples;
+  const unsigned long begin = n * threadId / numberOfThreads;
+  const unsigned long end = n * ( threadId + 1 ) / numberOfThreads;
+  for( unsigned long i = begin; i < end; i++ )
+    {
+    input->TransformPhysicalPointToIndex( pointscontainer->GetElement( i ), startIndex );
+    region.SetIndex( startIndex );
+    region.SetSize( this->m_Radius );
+    region.Crop( bufferedRegion );
+
+    if( this->m_UseIntegralHistogram )
+      {
+      V[0] = this->ComputeLocalThresholdFromIntegralHistogram( region, histogram );
+      }
+    else
+      {
+      V[0] = this->ComputeLocalThreshold( region, histogram );
+      }
+    pointdatacontainer->SetElement( i, V );
+    }
+}
+
+template< class TInputImage, class TOutputImage >
+typename AdaptiveOtsuThresholdImageFilter<TInputImage, TOutputImage>::InputCoordType
+AdaptiveOtsuThresholdImageFilter<TInputImage, TOutputImage>
+::ComputeLocalThreshold( const InputImageRegionType & region,
+  std::vector<double> & histogram ) const
+{
+  const unsigned int bins = this->m_NumberOfHistogramBins;
+  if( region.GetNumberOfPixels() == 0 || bins == 0 )
+    {
+    return NumericTraits<InputCoordType>::Zero;
+    }
+
+  // compute the local max and min
+  InputIteratorType iter( this->GetInput(), region );
+  InputPixelType imageMin = NumericTraits<InputPixelType>::max();
+  InputPixelType imageMax = NumericTraits<InputPixelType>::NonpositiveMin();
+  for( iter.GoToBegin(); !iter.IsAtEnd(); ++iter )
+    {
+    const InputPixelType current = iter.Get();
+    imageMin = imageMin > current ? current : imageMin;
+    imageMax = imageMax < current ? current : imageMax;
+    }
+
+  if( imageMin >= imageMax )
+    {
+    return static_cast<InputCoordType>( imageMin );
+    }
+
+  // fill the histogram
+  std::fill( histogram.begin(), histogram.end(), 0.0 );
+  const double binMultiplier = static_cast<double>( bins ) /
+    static_cast<double>( imageMax - imageMin );
+  for( iter.GoToBegin(); !iter.IsAtEnd(); ++iter )
+    {
+    const InputPixelType value = iter.Get();
+    unsigned int binNumber = 0;
+    if( value != imageMin )
+      {
+      binNumber = static_cast<unsigned int>(
+        vcl_ceil( ( value - imageMin ) * binMultiplier ) ) - 1;
+      if( binNumber == bins ) // in case of rounding errors
+        {
+        binNumber -= 1;
+        }
+      }
+    histogram[binNumber] += 1.0;
+    }
+
+  const unsigned int maxBinNumber = this->ComputeOtsuBin( histogram, 0, bins - 1 );
+
+  return static_cast<InputCoordType>( static_cast<InputPixelType>(
+    imageMin + ( maxBinNumber + 1 ) / binMultiplier ) );
+}
+
+template< class TInputImage, class TOutputImage >
+unsigned int
+AdaptiveOtsuThresholdImageFilter<TInputImage, TOutputImage>
+::ComputeOtsuBin( std::vector<double> & histogram,
+  unsigned int first, unsigned int last ) const
+{
+  double totalPixels = 0.0;
+  for( unsigned int j = first; j <= last; j++ )
+    {
+    totalPixels += histogram[j];
+    }
+
+  // normalize the frequencies
+  double totalMean = 0.0;
+  for( unsigned int j = first; j <= last; j++ )
+    {
+    histogram[j] /= totalPixels;
+    totalMean += (j-first+1) * histogram[j];
+    }
+
+  // compute Otsu's threshold by maximizing the between-class variance
+  double freqLeft = histogram[first];
+  double meanLeft = 1.0;
+  double meanRight = ( totalMean - freqLeft ) / ( 1.0 - freqLeft );
+  double maxVarBetween = freqLeft * ( 1.0 - freqLeft ) *
+    vnl_math_sqr( meanLeft - meanRight );
+  unsigned int maxBinNumber = 0;
+
+  double freqLeftOld = freqLeft;
+  double meanLeftOld = meanLeft;
+  for( unsigned int j = 1; j <= last - first; j++ )
+    {
+    freqLeft += histogram[first+j];
+    meanLeft = ( meanLeftOld * freqLeftOld + (j+1) * histogram[first+j] ) / freqLeft;
+    if( freqLeft == 1.0 )
+      {
+      meanRight = 0.0;
+      }
+    else
+      {
+      meanRight = ( totalMean - meanLeft * freqLeft ) / ( 1.0 - freqLeft );
+      }
+    const double varBetween = freqLeft * ( 1.0 - freqLeft ) *
+      vnl_math_sqr( meanLeft - meanRight );
+    if( varBetween > maxVarBetween )
+      {
+      maxVarBetween = varBetween;
+      maxBinNumber = j;
+      }
+
+    freqLeftOld = freqLeft;
+    meanLeftOld = meanLeft;
+    }
+
+  return maxBinNumber;
+}
+
+template< class TInputImage, class TOutputImage >
+unsigned int
+AdaptiveOtsuThresholdImageFilter<TInputImage, TOutputImage>
+::GetGlobalBin( InputPixelType value ) const
+{
+  if( value == this->m_GlobalMinimum )
+    {
+    return 0;
+    }
+  unsigned int binNumber = static_cast<unsigned int>(
+    vcl_ceil( ( value - this->m_GlobalMinimum ) * this->m_GlobalBinMultiplier ) ) - 1;
+  if( binNumber == this->m_NumberOfHistogramBins ) // in case of rounding errors
+    {
+    binNumber -= 1;
+    }
+  return binNumber;
+}
+
+template< class TInputImage, class TOutputImage >
+void
+AdaptiveOtsuThresholdImageFilter<TInputImage, TOutputImage>
+::ComputeIntegralHistogram()
+{
+  InputConstImagePointer input = this->GetInput();
+  const InputImageRegionType & region = input->GetBufferedRegion();
+  const unsigned int bins = this->m_NumberOfHistogramBins;
+  const unsigned int blockSize = this->m_IntegralHistogramBlockSize;
+
+  // the global range of the bins
+  InputIteratorType iter( input, region );
+  this->m_GlobalMinimum = NumericTraits<InputPixelType>::max();
+  this->m_GlobalMaximum = NumericTraits<InputPixelType>::NonpositiveMin();
+  for( iter.GoToBegin(); !iter.IsAtEnd(); ++iter )
+    {
+    const InputPixelType current = iter.Get();
+    this->m_GlobalMinimum = this->m_GlobalMinimum > current ? current : this->m_GlobalMinimum;
+    this->m_GlobalMaximum = this->m_GlobalMaximum < current ? current : this->m_GlobalMaximum;
+    }
+  this->m_GlobalBinMultiplier = this->m_GlobalMinimum < this->m_GlobalMaximum
+    ? static_cast<double>( bins ) /
+      static_cast<double>( this->m_GlobalMaximum - this->m_GlobalMinimum )
+    : 0.0;
+
+  // the corners of the block grid, one more than the number of blocks
+  SizeValueType numberOfCorners = 1;
+  for( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    this->m_CornerStrides[d] = numberOfCorners;
+    numberOfCorners *= ( region.GetSize()[d] + blockSize - 1 ) / blockSize + 1;
+    }
+  this->m_IntegralHistogram.assign( numberOfCorners * bins, 0 );
+
+  // count the voxels of block g at corner g + 1
+  typedef ImageRegionConstIteratorWithIndex< InputImageType > IndexIteratorType;
+  IndexIteratorType it( input, region );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    SizeValueType corner = 0;
+    for( unsigned int d = 0; d < ImageDimension; d++ )
+      {
+      corner += ( ( it.GetIndex()[d] - region.GetIndex()[d] ) / blockSize + 1 )
+        * this->m_CornerStrides[d];
+      }
+    this->m_IntegralHistogram[ corner * bins + this->GetGlobalBin( it.Get() ) ]++;
+    }
+
+  // the prefix sums along every dimension
+  for( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    const SizeValueType stride = this->m_CornerStrides[d];
+    const SizeValueType extent = ( d + 1 < ImageDimension )
+      ? this->m_CornerStrides[d+1] / stride : numberOfCorners / stride;
+    for( SizeValueType c = 0; c < numberOfCorners; c++ )
+      {
+      if( ( c / stride ) % extent == 0 ) continue;
+      unsigned int * current = &this->m_IntegralHistogram[ c * bins ];
+      const unsigned int * previous = &this->m_IntegralHistogram[ ( c - stride ) * bins ];
+      for( unsigned int j = 0; j < bins; j++ )
+        {
+        current[j] += previous[j];
+        }
+      }
+    }
+}
+
+template< class TInputImage, class TOutputImage >
+typename AdaptiveOtsuThresholdImageFilter<TInputImage, TOutputImage>::InputCoordType
+AdaptiveOtsuThresholdImageFilter<TInputImage, TOutputImage>
+::ComputeLocalThresholdFromIntegralHistogram(
+  const InputImageRegionType & region, std::vector<double> & histogram ) const
+{
+  const unsigned int bins = this->m_NumberOfHistogramBins;
+  if( region.GetNumberOfPixels() == 0 || bins == 0 )
+    {
+    return NumericTraits<InputCoordType>::Zero;
+    }
+  if( this->m_GlobalMinimum >= this->m_GlobalMaximum )
+    {
+    return static_cast<InputCoordType>( this->m_GlobalMinimum );
+    }
+
+  // the whole blocks inside the window, relative to the buffered region
+  InputConstImagePointer input = this->GetInput();
+  const InputImageRegionType & bufferedRegion = input->GetBufferedRegion();
+  const InputIndexValueType blockSize = this->m_IntegralHistogramBlockSize;
+  InputIndexValueType lo[ ImageDimension ], hi[ ImageDimension ];
+  InputIndexValueType blockLo[ ImageDimension ], blockHi[ ImageDimension ];
+  bool hasBlocks = true;
+  for( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    lo[d] = region.GetIndex()[d] - bufferedRegion.GetIndex()[d];
+    hi[d] = lo[d] + static_cast<InputIndexValueType>( region.GetSize()[d] );
+    blockLo[d] = ( lo[d] + blockSize - 1 ) / blockSize;
+    blockHi[d] = hi[d] / blockSize;
+    if( hi[d] == static_cast<InputIndexValueType>( bufferedRegion.GetSize()[d] ) )
+      {
+      // the last block may be smaller
+      blockHi[d] = ( hi[d] + blockSize - 1 ) / blockSize;
+      }
+    hasBlocks &= blockLo[d] < blockHi[d];
+    }
+
+  // add the blocks by inclusion-exclusion over the corners
+  std::fill( histogram.begin(), histogram.end(), 0.0 );
+  if( hasBlocks )
+    {
+    for( unsigned int k = 0; k < ( 1u << ImageDimension ); k++ )
+      {
+      SizeValueType corner = 0;
+      int sign = 1;
+      for( unsigned int d = 0; d < ImageDimension; d++ )
+        {
+        if( k & ( 1u << d ) )
+          {
+          corner += blockHi[d] * this->m_CornerStrides[d];
+          }
+        else
+          {
+          corner += blockLo[d] * this->m_CornerStrides[d];
+          sign = -sign;
+          }
+        }
+      const unsigned int * counts = &this->m_IntegralHistogram[ corner * bins ];
+      for( unsigned int j = 0; j < bins; j++ )
+        {
+        histogram[j] += sign * static_cast<double>( counts[j] );
+        }
+      }
+    }
+
+  // add the voxels outside the blocks, line by line
+  InputImageRegionType lines = region;
+  lines.SetSize( 0, 1 );
+  typedef ImageRegionConstIteratorWithIndex< InputImageType > IndexIteratorType;
+  IndexIteratorType it( input, lines );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    bool inBlocks = hasBlocks;
+    for( unsigned int d = 1; d < ImageDimension && inBlocks; d++ )
+      {
+      const InputIndexValueType i = it.GetIndex()[d] - bufferedRegion.GetIndex()[d];
+      inBlocks = i >= blockLo[d] * blockSize && i < blockHi[d] * blockSize;
+      }
+    const InputPixelType * line = input->GetBufferPointer() + input->ComputeOffset( it.GetIndex() );
+    for( InputIndexValueType x = 0; x < hi[0] - lo[0]; x++ )
+      {
+      const InputIndexValueType i = lo[0] + x;
+      if( inBlocks && i >= blockLo[0] * blockSize && i < blockHi[0] * blockSize )
+        {
+        continue;
+        }
+      histogram[ this->GetGlobalBin( line[x] ) ] += 1.0;
+      }
+    }
+
+  // Otsu on the occupied bins
+  unsigned int first = 0;
+  while( first < bins && histogram[first] == 0.0 ) first++;
+  unsigned int last = bins - 1;
+  while( last > first && histogram[last] == 0.0 ) last--;
+  if( first == last )
+    {
+    return static_cast<InputCoordType>( static_cast<InputPixelType>(
+      this->m_GlobalMinimum + ( first + 1 ) / this->m_GlobalBinMultiplier ) );
+    }
+  const unsigned int maxBinNumber = this->ComputeOtsuBin( histogram, first, last );
+
+  return static_cast<InputCoordType>( static_cast<InputPixelType>(
+    this->m_GlobalMinimum + ( first + maxBinNumber + 1 ) / this->m_GlobalBinMultiplier ) );
+}
+
 template< class TInputImage, class TOutputImage >
 void
 AdaptiveOtsuThresholdImageFilter<TInputImage, TOutputImage>::
@@ -232,6 +587,10 @@ PrintSelf( std::ostream& os, Indent indent ) const
     std::endl;
   os << indent << "Number of histogram bins: " << GetNumberOfHistogramBins() <<
     std::endl;
+  os << indent << "Use integral histogram: " << GetUseIntegralHistogram() <<
+    std::endl;
+  os << indent << "Integral histogram block size: " << GetIntegralHistogramBlockSize() <<
+    std::endl;
   os << indent << "Inside value: " << GetInsideValue() <<
     std::endl;
   os << indent << "Outside value: " << GetOutsideValue() <<
@@ -0,0 +1,95 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkHistogramMomentTables_h
+#define __itkHistogramMomentTables_h
+
+#include <vector>
+#include <cstddef>
+
+namespace itk
+{
+
+/** \class HistogramMomentTables
+ * \brief Prefix sums of the counts and of the first and second moments of
+ * a histogram, for the moments of any range of bins in constant time.
+ *
+ * The moments are over the bin index i: the sums of h_i, i h_i and
+ * i^2 h_i over the bins [begin, end). Threshold calculators that evaluate
+ * a criterion for every split of the histogram use them, so that the
+ * class statistics of a split cost O(1) instead of O(L) for L bins.
+ *
+ * \ingroup Operators
+ */
+class HistogramMomentTables
+{
+public:
+  /** Type of the histogram, the number of pixels per bin. */
+  typedef std::vector<double> HistogramType;
+
+  HistogramMomentTables() {}
+  explicit HistogramMomentTables( const HistogramType & histogram )
+  {
+    this->SetHistogram( histogram );
+  }
+
+  /** Compute the tables of a histogram. */
+  void SetHistogram( const HistogramType & histogram )
+  {
+    const std::size_t numberOfBins = histogram.size();
+    this->m_Count.assign( numberOfBins + 1, 0.0 );
+    this->m_FirstMoment.assign( numberOfBins + 1, 0.0 );
+    this->m_SecondMoment.assign( numberOfBins + 1, 0.0 );
+    for( std::size_t i = 0; i < numberOfBins; ++i )
+    {
+      const double x = static_cast<double>( i );
+      this->m_Count[ i + 1 ] = this->m_Count[ i ] + histogram[ i ];
+      this->m_FirstMoment[ i + 1 ] = this->m_FirstMoment[ i ] + x * histogram[ i ];
+      this->m_SecondMoment[ i + 1 ] = this->m_SecondMoment[ i ] + x * x * histogram[ i ];
+    }
+  }
+
+  /** The number of bins. */
+  std::size_t GetNumberOfBins( void ) const
+  {
+    return this->m_Count.empty() ? 0 : this->m_Count.size() - 1;
+  }
+
+  /** The moments of the bins [begin, end). */
+  double GetCount( std::size_t begin, std::size_t end ) const
+  {
+    return this->m_Count[ end ] - this->m_Count[ begin ];
+  }
+  double GetFirstMoment( std::size_t begin, std::size_t end ) const
+  {
+    return this->m_FirstMoment[ end ] - this->m_FirstMoment[ begin ];
+  }
+  double GetSecondMoment( std::size_t begin, std::size_t end ) const
+  {
+    return this->m_SecondMoment[ end ] - this->m_SecondMoment[ begin ];
+  }
+
+private:
+  std::vector<double> m_Count;
+  std::vector<double> m_FirstMoment;
+  std::vector<double> m_SecondMoment;
+
+}; // end class HistogramMomentTables
+
+} // end namespace itk
+
+#endif // end #ifndef __itkHistogramMomentTables_h
@@ -21,6 +21,8 @@
 #include "itkObjectFactory.h"
 #include "itkNumericTraits.h"
 
+#include <vector>
+
 namespace itk
 {
 
@@ -32,7 +34,11 @@ namespace itk
  * histogram of image intensities, and it tries to find the best mixture of two distributions
  * that fits the histogram with minimum error. This calculator provides two options for the mixture
  * which are a mixture of Gaussians and a mixture of Poissons. The minimum error threshold is the
- * one that minimizes the error criterion function, which depends on the chosen mixture type
+ * one that minimizes the error criterion function, which depends on the chosen mixture type.
+ * The class statistics of every candidate threshold come from the prefix sums of
+ * HistogramMomentTables, so that all thresholds are evaluated in O(L) for L bins.
+ * A histogram computed before, with the same binning, can be passed with SetHistogram(),
+ * so that the image is not scanned again.
  * \warning This method assumes that the input image consists of scalar pixel
  * types.
  *
@@ -76,6 +82,14 @@ public:
   /** Compute the MinError's threshold for the input image. */
   void Compute( void );
 
+  /** Type of the histogram, the number of pixels per bin. */
+  typedef std::vector<double> HistogramType;
+
+  /** Use this histogram instead of scanning the input image. The bins span
+   * the range [minimum, maximum], as in OtsuThresholdWithMaskImageCalculator. */
+  void SetHistogram( const HistogramType & histogram,
+    const PixelType & minimum, const PixelType & maximum );
+
   /** This function sets the option to use a mixture of Gaussians */
   void UseGaussianMixture(bool);
 
@@ -120,6 +134,11 @@ private:
   double           m_StdRight;
   unsigned int       m_UseGaussian;
   unsigned int       m_usePoisson;
+
+  HistogramType      m_Histogram;
+  PixelType          m_HistogramMinimum;
+  PixelType          m_HistogramMaximum;
+  bool               m_HistogramSetByUser;
 };
 
 } // end namespace itk
@@ -20,6 +20,7 @@
 #include "itkMinErrorThresholdImageCalculator.h"
 #include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkMinimumMaximumImageCalculator.h"
+#include "itkHistogramMomentTables.h"
 
 #include "vnl/vnl_math.h"
 #include <limits>
@@ -46,6 +47,9 @@ MinErrorThresholdImageCalculator<TInputImage>
   this->m_StdRight = 0.0;
   this->m_UseGaussian = 0;
   this->m_usePoisson = 1;
+  this->m_HistogramMinimum = NumericTraits<PixelType>::Zero;
+  this->m_HistogramMaximum = NumericTraits<PixelType>::Zero;
+  this->m_HistogramSetByUser = false;
 }
 
 
@@ -80,73 +84,96 @@ MinErrorThresholdImageCalculator<TInputImage>
 
   unsigned int j, i;
 
-  if( !m_Image ) { return; }
-  if( !m_RegionSetByUser )
-    {
-    this->m_Region = this->m_Image->GetRequestedRegion();
-    }
-
-  double totalPixels = (double) this->m_Region.GetNumberOfPixels();
-  if( totalPixels == 0 ) { return; }
-
-
-  // compute image max and min
-  typedef MinimumMaximumImageCalculator<TInputImage> RangeCalculator;
-  typename RangeCalculator::Pointer rangeCalculator = RangeCalculator::New();
-  rangeCalculator->SetImage( this->m_Image );
-  rangeCalculator->Compute();
-
-  PixelType imageMin = rangeCalculator->GetMinimum();
-  PixelType imageMax = rangeCalculator->GetMaximum();
-
-  if( imageMin >= imageMax )
-    {
-    this->m_Threshold = imageMin;
-    return;
-    }
+  PixelType imageMin, imageMax;
+  double totalPixels = 0.0;
+  double binMultiplier = 0.0;
 
   // create the histogram and the error functions
   std::vector<double> relativeFrequency;
   std::vector<double> errorFunctionPois;
   std::vector<double> errorFunctionGaus;
 
-  relativeFrequency.resize( this->m_NumberOfHistogramBins );
-  errorFunctionPois.resize( this->m_NumberOfHistogramBins );
-  errorFunctionGaus.resize( this->m_NumberOfHistogramBins );
-  for ( j = 0; j < this->m_NumberOfHistogramBins; j++ )
+  if( this->m_HistogramSetByUser )
     {
-    relativeFrequency[j] = errorFunctionPois[j] = errorFunctionGaus[j] = 0.0;
+    imageMin = this->m_HistogramMinimum;
+    imageMax = this->m_HistogramMaximum;
+    if( imageMin >= imageMax || this->m_Histogram.empty() )
+      {
+      this->m_Threshold = imageMin;
+      return;
+      }
+
+    relativeFrequency = this->m_Histogram;
+    for ( j = 0; j < this->m_NumberOfHistogramBins; j++ )
+      {
+      totalPixels += relativeFrequency[j];
+      }
+    if( totalPixels == 0 ) { return; }
+
+    binMultiplier = (double) this->m_NumberOfHistogramBins /
+      (double) ( imageMax - imageMin );
     }
+  else
+    {
+    if( !m_Image ) { return; }
+    if( !m_RegionSetByUser )
+      {
+      this->m_Region = this->m_Image->GetRequestedRegion();
+      }
 
-  double binMultiplier = (double) this->m_NumberOfHistogramBins /
-    (double) ( imageMax - imageMin );
+    totalPixels = (double) this->m_Region.GetNumberOfPixels();
+    if( totalPixels == 0 ) { return; }
 
-  typedef ImageRegionConstIteratorWithIndex<TInputImage> Iterator;
-  Iterator iter( this->m_Image, this->m_Region );
+    // compute image max and min
+    typedef MinimumMaximumImageCalculator<TInputImage> RangeCalculator;
+    typename RangeCalculator::Pointer rangeCalculator = RangeCalculator::New();
+    rangeCalculator->SetImage( this->m_Image );
+    rangeCalculator->Compute();
 
-  while ( !iter.IsAtEnd() )
-    {
-    unsigned int binNumber;
-    PixelType value = iter.Get();
+    imageMin = rangeCalculator->GetMinimum();
+    imageMax = rangeCalculator->GetMaximum();
 
-    if( value == imageMin )
+    if( imageMin >= imageMax )
       {
-      binNumber = 0;
+      this->m_Threshold = imageMin;
+      return;
       }
-    else
+
+    relativeFrequency.assign( this->m_NumberOfHistogramBins, 0.0 );
+
+    binMultiplier = (double) this->m_NumberOfHistogramBins /
+      (double) ( imageMax - imageMin );
+
+    typedef ImageRegionConstIteratorWithIndex<TInputImage> Iterator;
+    Iterator iter( this->m_Image, this->m_Region );
+
+    while ( !iter.IsAtEnd() )
       {
-      binNumber = (unsigned int) vcl_ceil((value - imageMin) * binMultiplier ) - 1;
-      if( binNumber == this->m_NumberOfHistogramBins ) // in case of rounding errors
+      unsigned int binNumber;
+      PixelType value = iter.Get();
+
+      if( value == imageMin )
         {
-        binNumber -= 1;
+        binNumber = 0;
+        }
+      else
+        {
+        binNumber = (unsigned int) vcl_ceil((value - imageMin) * binMultiplier ) - 1;
+        if( binNumber == this->m_NumberOfHistogramBins ) // in case of rounding errors
+          {
+          binNumber -= 1;
+          }
         }
-      }
 
-    relativeFrequency[binNumber] += 1.0;
-    ++iter;
+      relativeFrequency[binNumber] += 1.0;
+      ++iter;
 
+      }
     }
 
+  errorFunctionPois.assign( this->m_NumberOfHistogramBins, 0.0 );
+  errorFunctionGaus.assign( this->m_NumberOfHistogramBins, 0.0 );
+
   // normalize the histogram
   double totalMean = 0.0;
   for ( j = 0; j < this->m_NumberOfHistogramBins; j++ )
@@ -156,7 +183,11 @@ MinErrorThresholdImageCalculator<TInputImage>
     }
 
 
-  // compute MinError threshold that minimizes the error criterion function
+  // compute MinError threshold that minimizes the error criterion function;
+  // the class statistics of every threshold come from the moment tables
+  const HistogramMomentTables moments( relativeFrequency );
+  const std::size_t numberOfBins = this->m_NumberOfHistogramBins;
+
   //Initialize mixture parameters to zeros
   double priorRight = 0.0;
   double priorLeft = 0.0;
@@ -169,38 +200,18 @@ MinErrorThresholdImageCalculator<TInputImage>
 
   for ( j = 1; j < this->m_NumberOfHistogramBins-1; j++ )
     {
-    //compute the current parameters for left (background) mixture component
-    priorLeft = 0.0; //Prior Probability
-    meanLeft = 0.0; //mean
-    varLeft = 0.0; //variance
-    for ( i=0; i<=j; i++ )
-      {
-      priorLeft+=relativeFrequency[ i ];
-      meanLeft+=(i*relativeFrequency[ i ]);
-      }
-    meanLeft/=priorLeft;
-    for ( i=0; i<=j; i++ )
-      {
-      varLeft+=(vnl_math_sqr(i-meanLeft)*relativeFrequency[ i ]);
-      }
-    varLeft/=priorLeft;
+    //the current parameters for left (background) mixture component, bins [0, j]
+    priorLeft = moments.GetCount( 0, j + 1 ); //Prior Probability
+    meanLeft = moments.GetFirstMoment( 0, j + 1 ) / priorLeft; //mean
+    varLeft = vnl_math_max( 0.0,
+      moments.GetSecondMoment( 0, j + 1 ) / priorLeft - vnl_math_sqr( meanLeft ) ); //variance
     stdLeft = vcl_sqrt(varLeft); //standard deviation
 
-    //compute the current parameters for right (foreground) mixture component
-    priorRight = 0.0; //Prior Probability
-    meanRight = 0.0; //mean
-    varRight = 0.0; //variance
-    for ( i=j+1; i<m_NumberOfHistogramBins; i++ )
-      {
-      priorRight+=relativeFrequency[ i ];
-      meanRight+=(i*relativeFrequency[ i ]);
-      }
-    meanRight/=priorRight;
-    for ( i=j+1; i<m_NumberOfHistogramBins; i++ )
-      {
-      varRight+=(vnl_math_sqr(i-meanRight)*relativeFrequency[ i ]);
-      }
-    varRight/=priorRight;
+    //the current parameters for right (foreground) mixture component, bins [j+1, L)
+    priorRight = moments.GetCount( j + 1, numberOfBins ); //Prior Probability
+    meanRight = moments.GetFirstMoment( j + 1, numberOfBins ) / priorRight; //mean
+    varRight = vnl_math_max( 0.0,
+      moments.GetSecondMoment( j + 1, numberOfBins ) / priorRight - vnl_math_sqr( meanRight ) ); //variance
     stdRight = vcl_sqrt(varRight); //standard deviation
     //Make sure you don't end up with zero values for the parameters
     priorLeft += std::numeric_limits<long double>::epsilon();
@@ -236,39 +247,21 @@ MinErrorThresholdImageCalculator<TInputImage>
     this->m_Threshold = static_cast<PixelType>( imageMin +
                                         (i+1) / binMultiplier );
 
-  //estimate the parameters of the resulting mixture
-  for (j=0; j<=i; j++)
-    {
-    this->m_PriorLeft+=relativeFrequency[j];
-    this->m_AlphaLeft+=(j*relativeFrequency[j]);
-    }
-  this->m_AlphaLeft/= this->m_PriorLeft;
-
-  for ( j=i+1; j<m_NumberOfHistogramBins; j++)
-    {
-    this->m_PriorRight+=relativeFrequency[j];
-    this->m_AlphaRight+=(j*relativeFrequency[j]);
-    }
-  this->m_AlphaRight/= this->m_PriorRight;
-
+  //estimate the parameters of the resulting mixture, bins [0, i] and [i+1, L)
+  this->m_PriorLeft = moments.GetCount( 0, i + 1 );
+  this->m_AlphaLeft = moments.GetFirstMoment( 0, i + 1 ) / this->m_PriorLeft;
+  this->m_PriorRight = moments.GetCount( i + 1, numberOfBins );
+  this->m_AlphaRight = moments.GetFirstMoment( i + 1, numberOfBins ) / this->m_PriorRight;
 
   if( this->m_UseGaussian)
     {
-    varLeft = 0.0;
-    for (j=0; j<=i; j++)
-      {
-      varLeft+=(vnl_math_sqr(j-m_AlphaLeft)*relativeFrequency[j]);
-      }
-    varLeft/=m_PriorLeft;
-    this->m_StdLeft=vcl_sqrt(varLeft);
+    varLeft = moments.GetSecondMoment( 0, i + 1 ) / this->m_PriorLeft
+      - vnl_math_sqr( this->m_AlphaLeft );
+    this->m_StdLeft=vcl_sqrt( vnl_math_max( 0.0, varLeft ) );
 
-    varRight = 0.0;
-    for ( j=i+1; j<m_NumberOfHistogramBins; j++)
-      {
-      varRight+=(vnl_math_sqr(j-m_AlphaRight)*relativeFrequency[j]);
-      }
-    varRight/=m_PriorRight;
-    this->m_StdRight=vcl_sqrt(varRight);
+    varRight = moments.GetSecondMoment( i + 1, numberOfBins ) / this->m_PriorRight
+      - vnl_math_sqr( this->m_AlphaRight );
+    this->m_StdRight=vcl_sqrt( vnl_math_max( 0.0, varRight ) );
     }
   this->m_AlphaLeft= imageMin + ( this->m_AlphaLeft+1) / binMultiplier ;
   this->m_AlphaRight= imageMin + ( this->m_AlphaRight+1) / binMultiplier ;
@@ -276,6 +269,22 @@ MinErrorThresholdImageCalculator<TInputImage>
   this->m_StdRight/= binMultiplier ;
 }
 
+template<class TInputImage>
+void
+MinErrorThresholdImageCalculator<TInputImage>
+::SetHistogram( const HistogramType & histogram,
+  const PixelType & minimum, const PixelType & maximum )
+{
+  this->m_Histogram = histogram;
+  this->m_HistogramMinimum = minimum;
+  this->m_HistogramMaximum = maximum;
+  this->m_HistogramSetByUser = true;
+  if( !histogram.empty() )
+    {
+    this->m_NumberOfHistogramBins = histogram.size();
+    }
+}
+
 template<class TInputImage>
 void
 MinErrorThresholdImageCalculator<TInputImage>
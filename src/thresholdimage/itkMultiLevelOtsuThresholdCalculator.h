@@ -0,0 +1,127 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkMultiLevelOtsuThresholdCalculator_h
+#define __itkMultiLevelOtsuThresholdCalculator_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkNumericTraits.h"
+#include "itkHistogramMomentTables.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/** \class MultiLevelOtsuThresholdCalculator
+ * \brief Computes the Otsu thresholds that split a histogram in more
+ * than two classes, by dynamic programming.
+ *
+ * The thresholds maximize the between-class variance, which for classes c
+ * of w_c pixels with a sum of bin indices s_c is, up to a constant, the
+ * sum of s_c^2 / w_c. With the prefix sums of HistogramMomentTables, the term of a class of bins [a, b) is found in constant time,
+ * and the best split of the first b bins in c classes is the best split of
+ * some first a bins in c - 1 classes, plus the class [a, b). This gives
+ * the optimum of the exhaustive search of OtsuMultipleThresholdsCalculator
+ * in O( k L^2 ) time for k thresholds and L bins, instead of O( L^k ).
+ * Every class has at least one bin; of equal splits the one with the
+ * lowest thresholds is taken.
+ *
+ * The histogram is given with SetHistogram(), with its range, as computed
+ * by OtsuThresholdWithMaskImageCalculator, and a threshold at the start of
+ * bin b is minimum + b ( maximum - minimum ) / L.
+ *
+ * \ingroup Operators
+ */
+template <class TInputImage>
+class ITK_EXPORT MultiLevelOtsuThresholdCalculator : public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef MultiLevelOtsuThresholdCalculator Self;
+  typedef Object                            Superclass;
+  typedef SmartPointer<Self>                Pointer;
+  typedef SmartPointer<const Self>          ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( MultiLevelOtsuThresholdCalculator, Object );
+
+  /** Type definition for the input image pixel type. */
+  typedef typename TInputImage::PixelType PixelType;
+
+  /** Type of the histogram, the number of pixels per bin. */
+  typedef std::vector<double> HistogramType;
+
+  /** Type of the thresholds. */
+  typedef std::vector<PixelType> ThresholdVectorType;
+
+  /** Set the histogram, of which the bins span [minimum, maximum]. */
+  void SetHistogram( const HistogramType & histogram,
+    const PixelType & minimum, const PixelType & maximum );
+
+  /** Set/Get the number of thresholds. Default 1. */
+  itkSetClampMacro( NumberOfThresholds, unsigned int, 1,
+                    NumericTraits<unsigned int>::max() );
+  itkGetConstMacro( NumberOfThresholds, unsigned int );
+
+  /** Compute the thresholds. */
+  void Compute( void );
+
+  /** Get the thresholds, in increasing order. There are fewer thresholds
+   * than asked for if the histogram has too few bins. */
+  const ThresholdVectorType & GetThresholds( void ) const
+  {
+    return this->m_Thresholds;
+  }
+
+  /** Get the between-class variance of the thresholds, in squared bins. */
+  itkGetConstMacro( BetweenClassVariance, double );
+
+protected:
+  MultiLevelOtsuThresholdCalculator();
+  virtual ~MultiLevelOtsuThresholdCalculator() {};
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** The term of the class of bins [a, b). */
+  static double ClassTerm( const HistogramMomentTables & moments,
+    std::size_t a, std::size_t b );
+
+private:
+  MultiLevelOtsuThresholdCalculator( const Self & ); // purposely not implemented
+  void operator=( const Self & );                    // purposely not implemented
+
+  HistogramType         m_Histogram;
+  PixelType             m_HistogramMinimum;
+  PixelType             m_HistogramMaximum;
+  unsigned int          m_NumberOfThresholds;
+  ThresholdVectorType   m_Thresholds;
+  double                m_BetweenClassVariance;
+
+};
+
+} // end namespace itk
+
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkMultiLevelOtsuThresholdCalculator.txx"
+#endif
+
+#endif
@@ -0,0 +1,164 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkMultiLevelOtsuThresholdCalculator_txx
+#define __itkMultiLevelOtsuThresholdCalculator_txx
+
+#include "itkMultiLevelOtsuThresholdCalculator.h"
+
+#include "vnl/vnl_math.h"
+#include <algorithm>
+
+namespace itk
+{
+
+/**
+ * Constructor
+ */
+template<class TInputImage>
+MultiLevelOtsuThresholdCalculator<TInputImage>
+::MultiLevelOtsuThresholdCalculator()
+{
+  this->m_HistogramMinimum = NumericTraits<PixelType>::Zero;
+  this->m_HistogramMaximum = NumericTraits<PixelType>::Zero;
+  this->m_NumberOfThresholds = 1;
+  this->m_BetweenClassVariance = 0.0;
+}
+
+
+/*
+ * Set the histogram
+ */
+template<class TInputImage>
+void
+MultiLevelOtsuThresholdCalculator<TInputImage>
+::SetHistogram( const HistogramType & histogram,
+  const PixelType & minimum, const PixelType & maximum )
+{
+  this->m_Histogram = histogram;
+  this->m_HistogramMinimum = minimum;
+  this->m_HistogramMaximum = maximum;
+  this->Modified();
+}
+
+
+/*
+ * Compute the thresholds
+ */
+template<class TInputImage>
+void
+MultiLevelOtsuThresholdCalculator<TInputImage>
+::Compute( void )
+{
+  this->m_Thresholds.clear();
+  this->m_BetweenClassVariance = 0.0;
+
+  const std::size_t numberOfBins = this->m_Histogram.size();
+  const PixelType imageMin = this->m_HistogramMinimum;
+  const PixelType imageMax = this->m_HistogramMaximum;
+  if( imageMin >= imageMax || numberOfBins < 2 ) { return; }
+
+  // the moments of any range of bins in constant time
+  const HistogramMomentTables moments( this->m_Histogram );
+  const double totalPixels = moments.GetCount( 0, numberOfBins );
+  if( totalPixels == 0.0 ) { return; }
+
+  // best[ b ] is the best sum of the terms of the first b bins in c classes,
+  // and start[ c ][ b ] the first bin of the last of these classes
+  const std::size_t numberOfClasses = std::min<std::size_t>(
+    this->m_NumberOfThresholds + 1, numberOfBins );
+  std::vector<double> best( numberOfBins + 1 ), previous( numberOfBins + 1 );
+  std::vector< std::vector<std::size_t> > start( numberOfClasses,
+    std::vector<std::size_t>( numberOfBins + 1, 0 ) );
+  for( std::size_t b = 1; b <= numberOfBins; ++b )
+  {
+    best[ b ] = ClassTerm( moments, 0, b );
+  }
+  for( std::size_t c = 1; c < numberOfClasses; ++c )
+  {
+    best.swap( previous );
+
+    // with c + 1 classes, the first b bins have at least c + 1 bins; the
+    // last level only needs all bins
+    const std::size_t firstB = ( c + 1 == numberOfClasses ) ? numberOfBins : c + 1;
+    for( std::size_t b = firstB; b <= numberOfBins; ++b )
+    {
+      double bestValue = -1.0;
+      std::size_t bestStart = c;
+      for( std::size_t a = c; a < b; ++a )
+      {
+        const double value = previous[ a ] + ClassTerm( moments, a, b );
+        if( value > bestValue )
+        {
+          bestValue = value;
+          bestStart = a;
+        }
+      }
+      best[ b ] = bestValue;
+      start[ c ][ b ] = bestStart;
+    }
+  }
+
+  // the between-class variance, and the thresholds by backtracking
+  const double mean = moments.GetFirstMoment( 0, numberOfBins ) / totalPixels;
+  this->m_BetweenClassVariance = best[ numberOfBins ] / totalPixels - mean * mean;
+
+  std::vector<std::size_t> boundaries( numberOfClasses - 1 );
+  std::size_t b = numberOfBins;
+  for( std::size_t c = numberOfClasses - 1; c > 0; --c )
+  {
+    b = start[ c ][ b ];
+    boundaries[ c - 1 ] = b;
+  }
+
+  const double binWidth = static_cast<double>( imageMax - imageMin ) / numberOfBins;
+  for( std::size_t i = 0; i < boundaries.size(); ++i )
+  {
+    this->m_Thresholds.push_back( static_cast<PixelType>(
+      imageMin + boundaries[ i ] * binWidth ) );
+  }
+}
+
+
+/*
+ * The term s^2 / w of the class of bins [a, b)
+ */
+template<class TInputImage>
+double
+MultiLevelOtsuThresholdCalculator<TInputImage>
+::ClassTerm( const HistogramMomentTables & moments, std::size_t a, std::size_t b )
+{
+  const double w = moments.GetCount( a, b );
+  return w > 0.0 ? vnl_math_sqr( moments.GetFirstMoment( a, b ) ) / w : 0.0;
+}
+
+
+template<class TInputImage>
+void
+MultiLevelOtsuThresholdCalculator<TInputImage>
+::PrintSelf( std::ostream& os, Indent indent ) const
+{
+  Superclass::PrintSelf(os,indent);
+
+  os << indent << "NumberOfThresholds: " << this->m_NumberOfThresholds << std::endl;
+  os << indent << "NumberOfHistogramBins: " << this->m_Histogram.size() << std::endl;
+  os << indent << "BetweenClassVariance: " << this->m_BetweenClassVariance << std::endl;
+}
+
+} // end namespace itk
+
+#endif
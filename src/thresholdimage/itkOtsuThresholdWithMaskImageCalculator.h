@@ -20,6 +20,10 @@
 #include "itkObject.h"
 #include "itkObjectFactory.h"
 #include "itkNumericTraits.h"
+#include "itkMaskSpanImageCalculator.h"
+#include "itkParallelReducer.h"
+
+#include <vector>
 
 namespace itk
 {
@@ -32,6 +36,12 @@ namespace itk
  * histogram of image intensities. The basic idea is to maximize the
  * between-class variance.
  *
+ * The histogram can be computed separately with ComputeHistogram(), and
+ * a histogram computed before can be passed with SetHistogram(), so that
+ * several calculators share a single scan of the image. The minimum, the
+ * maximum and the histogram are computed in parallel by a ParallelReducer,
+ * in partial histograms per thread, which are exact.
+ *
  * This class is templated over the input image type.
  *
  * \warning This method assumes that the input image consists of scalar pixel
@@ -77,6 +87,7 @@ public:
     itkGetStaticConstMacro( ImageDimension ) >      MaskImageType;
   typedef typename MaskImageType::Pointer           MaskImagePointer;
   typedef typename MaskImageType::ConstPointer      MaskImageConstPointer;
+  typedef MaskSpanImageCalculator< MaskImageType >  MaskSpansType;
 
   /** Set the input image. */
   itkSetConstObjectMacro(Image,ImageType);
@@ -84,9 +95,39 @@ public:
   /** Set the mask image */
   itkSetObjectMacro( MaskImage, MaskImageType );
 
+  /** Type of the histogram, the number of pixels per bin. */
+  typedef std::vector<double> HistogramType;
+
   /** Compute the Otsu's threshold for the input image. */
   void Compute( void );
 
+  /** Compute the histogram of the (masked) input image, without the
+   * threshold. The bins span the range [HistogramMinimum, HistogramMaximum]. */
+  void ComputeHistogram( void );
+
+  /** Use this histogram and range instead of scanning the input image. */
+  void SetHistogram( const HistogramType & histogram,
+    const PixelType & minimum, const PixelType & maximum );
+
+  /** Use this minimum and maximum of the (masked) input image in
+   * ComputeHistogram(), e.g. known from an earlier run, instead of
+   * scanning the image for them. */
+  void SetImageMinimumMaximum( const PixelType & minimum, const PixelType & maximum );
+
+  /** Compute the histogram from the number of pixels of every value,
+   * counts[ i ] pixels with value minimumValue + i, instead of from the
+   * image. For integer images the result is the same as that of
+   * ComputeHistogram(), without scanning the image. */
+  void SetValueHistogram( const double minimumValue, const std::vector<double> & counts );
+
+  /** Get the histogram and its range. */
+  const HistogramType & GetHistogram( void ) const
+  {
+    return this->m_Histogram;
+  }
+  itkGetConstMacro( HistogramMinimum, PixelType );
+  itkGetConstMacro( HistogramMaximum, PixelType );
+
   /** Return the Otsu's threshold value. */
   itkGetConstMacro(Threshold,PixelType);
 
@@ -98,11 +139,72 @@ public:
   /** Set the region over which the values will be computed */
   void SetRegion( const RegionType & region );
 
+  /** Set/Get the number of threads of the histogram. Default the global default. */
+  itkSetMacro( NumberOfThreads, ThreadIdType );
+  itkGetConstMacro( NumberOfThreads, ThreadIdType );
+
 protected:
   OtsuThresholdWithMaskImageCalculator();
   virtual ~OtsuThresholdWithMaskImageCalculator() {};
   void PrintSelf(std::ostream& os, Indent indent) const;
 
+  /** The minimum and maximum of the pixels of a block. */
+  struct MinimumMaximumType
+  {
+    PixelType Minimum;
+    PixelType Maximum;
+  };
+
+  /** The reducers of the ParallelReducer, see there. */
+  class MinimumMaximumReducerType
+  {
+  public:
+    typedef typename TInputImage::RegionType RegionType;
+    typedef MinimumMaximumType          PartialType;
+    const Self * m_Calculator;
+    void Initialize( PartialType & partial ) const
+    {
+      partial.Minimum = NumericTraits<PixelType>::max();
+      partial.Maximum = NumericTraits<PixelType>::NonpositiveMin();
+    }
+    void Reduce( const RegionType & block, PartialType & partial ) const
+    {
+      this->m_Calculator->ComputeMinimumMaximum( block, partial );
+    }
+    void Merge( PartialType & partial, const PartialType & other ) const
+    {
+      if( other.Minimum < partial.Minimum ) partial.Minimum = other.Minimum;
+      if( other.Maximum > partial.Maximum ) partial.Maximum = other.Maximum;
+    }
+  };
+
+  class HistogramReducerType
+  {
+  public:
+    typedef typename TInputImage::RegionType RegionType;
+    typedef HistogramType               PartialType;
+    const Self * m_Calculator;
+    void Initialize( PartialType & partial ) const
+    {
+      partial.assign( this->m_Calculator->m_NumberOfHistogramBins, 0.0 );
+    }
+    void Reduce( const RegionType & block, PartialType & partial ) const
+    {
+      this->m_Calculator->ComputeBlockHistogram( block, partial );
+    }
+    void Merge( PartialType & partial, const PartialType & other ) const
+    {
+      for( std::size_t i = 0; i < partial.size(); ++i ) partial[ i ] += other[ i ];
+    }
+  };
+
+  /** Add the pixels of a block, inside the mask, to a partial result. */
+  void ComputeMinimumMaximum( const RegionType & block, MinimumMaximumType & partial ) const;
+  void ComputeBlockHistogram( const RegionType & block, HistogramType & partial ) const;
+
+  /** The bin of a value, for the current histogram range. */
+  unsigned int ComputeBinNumber( const PixelType & value, const double binMultiplier ) const;
+
 private:
   OtsuThresholdWithMaskImageCalculator(const Self&); //purposely not implemented
   void operator=(const Self&); //purposely not implemented
@@ -114,6 +216,18 @@ private:
   RegionType            m_Region;
   bool                  m_RegionSetByUser;
 
+  HistogramType         m_Histogram;
+  PixelType             m_HistogramMinimum;
+  PixelType             m_HistogramMaximum;
+  bool                  m_HistogramSetByUser;
+  PixelType             m_ImageMinimum;
+  PixelType             m_ImageMaximum;
+  bool                  m_MinimumMaximumSetByUser;
+  ThreadIdType          m_NumberOfThreads;
+
+  /** The spans of the mask, while the histogram is computed. */
+  typename MaskSpansType::Pointer m_MaskSpans;
+
 };
 
 } // end namespace itk
@@ -19,7 +19,6 @@
 
 #include "itkOtsuThresholdWithMaskImageCalculator.h"
 
-#include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkImageRegionConstIterator.h"
 
 #include "vnl/vnl_math.h"
@@ -39,18 +38,28 @@ OtsuThresholdWithMaskImageCalculator<TInputImage>
   this->m_Threshold = NumericTraits<PixelType>::Zero;
   this->m_NumberOfHistogramBins = 128;
   this->m_RegionSetByUser = false;
+  this->m_HistogramMinimum = NumericTraits<PixelType>::Zero;
+  this->m_HistogramMaximum = NumericTraits<PixelType>::Zero;
+  this->m_HistogramSetByUser = false;
+  this->m_ImageMinimum = NumericTraits<PixelType>::Zero;
+  this->m_ImageMaximum = NumericTraits<PixelType>::Zero;
+  this->m_MinimumMaximumSetByUser = false;
+  this->m_NumberOfThreads = MultiThreader::GetGlobalDefaultNumberOfThreads();
 }
 
 
 /*
- * Compute the Otsu's threshold
+ * Compute the histogram
  */
 template<class TInputImage>
 void
 OtsuThresholdWithMaskImageCalculator<TInputImage>
-::Compute( void )
+::ComputeHistogram( void )
 {
-  unsigned int j;
+  this->m_Histogram.clear();
+  this->m_HistogramMinimum = NumericTraits<PixelType>::Zero;
+  this->m_HistogramMaximum = NumericTraits<PixelType>::Zero;
+  this->m_HistogramSetByUser = false;
 
   if( !m_Image ) { return; }
   if( !m_RegionSetByUser )
@@ -58,99 +67,262 @@ OtsuThresholdWithMaskImageCalculator<TInputImage>
     this->m_Region = this->m_Image->GetRequestedRegion();
   }
 
-  double totalPixels = (double) this->m_Region.GetNumberOfPixels();
-  if( totalPixels == 0 ) { return; }
-  totalPixels = 0.0;
+  if( this->m_Region.GetNumberOfPixels() == 0 ) { return; }
 
-  typedef ImageRegionConstIteratorWithIndex<ImageType> IteratorType;
-  IteratorType iter( this->m_Image, this->m_Region );
-  iter.GoToBegin();
-
-  typedef ImageRegionConstIterator<MaskImageType> MaskIteratorType;
-  MaskIteratorType itMask;
+  // With a mask only its spans inside the region are visited
+  this->m_MaskSpans = 0;
   if( this->m_MaskImage )
   {
-    itMask = MaskIteratorType( this->m_MaskImage, this->m_Region );
-    itMask.GoToBegin();
+    this->m_MaskSpans = MaskSpansType::New();
+    this->m_MaskSpans->SetMaskImage( this->m_MaskImage );
+    this->m_MaskSpans->SetRegion( this->m_Region );
+    this->m_MaskSpans->SetNumberOfThreads( this->m_NumberOfThreads );
+    this->m_MaskSpans->Compute();
   }
 
-  // compute image max and min
-  PixelType imageMin = NumericTraits<PixelType>::max();
-  PixelType imageMax = NumericTraits<PixelType>::NonpositiveMin();
-  while ( !iter.IsAtEnd() )
+  // unless they were given, compute image max and min, in parallel; the
+  // merge is exact
+  PixelType imageMin = this->m_ImageMinimum;
+  PixelType imageMax = this->m_ImageMaximum;
+  if( !this->m_MinimumMaximumSetByUser )
   {
-    if( this->m_MaskImage && itMask.Value() == 0 )
-    {
-      ++iter; ++itMask;
-      continue;
-    }
-
-    PixelType current = iter.Value();
-    imageMin = imageMin > current ? current : imageMin;
-    imageMax = imageMax < current ? current : imageMax;
-
-    ++iter;
-    if( this->m_MaskImage ) ++itMask;
+    MinimumMaximumReducerType minimumMaximumReducer;
+    minimumMaximumReducer.m_Calculator = this;
+
+    typedef ParallelReducer< MinimumMaximumReducerType > MinimumMaximumParallelReducerType;
+    typename MinimumMaximumParallelReducerType::Pointer minimumMaximumParallelReducer
+      = MinimumMaximumParallelReducerType::New();
+    minimumMaximumParallelReducer->SetReducer( &minimumMaximumReducer );
+    minimumMaximumParallelReducer->SetRegion( this->m_Region );
+    minimumMaximumParallelReducer->SetNumberOfThreads( this->m_NumberOfThreads );
+    minimumMaximumParallelReducer->ExactMergeOn();
+    minimumMaximumParallelReducer->Compute();
+
+    imageMin = minimumMaximumParallelReducer->GetResult().Minimum;
+    imageMax = minimumMaximumParallelReducer->GetResult().Maximum;
   }
-
+  this->m_HistogramMinimum = imageMin;
+  this->m_HistogramMaximum = imageMax;
   if( imageMin >= imageMax )
   {
-    this->m_Threshold = imageMin;
+    this->m_MaskSpans = 0;
     return;
   }
 
-  // create a histogram
-  std::vector<double> relativeFrequency;
-  relativeFrequency.resize( this->m_NumberOfHistogramBins );
-  for ( j = 0; j < this->m_NumberOfHistogramBins; j++ )
+  // create a histogram, in partial histograms per thread; the counts are
+  // integers, so the merge is exact
+  HistogramReducerType histogramReducer;
+  histogramReducer.m_Calculator = this;
+
+  typedef ParallelReducer< HistogramReducerType > HistogramParallelReducerType;
+  typename HistogramParallelReducerType::Pointer histogramParallelReducer
+    = HistogramParallelReducerType::New();
+  histogramParallelReducer->SetReducer( &histogramReducer );
+  histogramParallelReducer->SetRegion( this->m_Region );
+  histogramParallelReducer->SetNumberOfThreads( this->m_NumberOfThreads );
+  histogramParallelReducer->ExactMergeOn();
+  histogramParallelReducer->Compute();
+  this->m_Histogram = histogramParallelReducer->GetResult();
+  this->m_MaskSpans = 0;
+}
+
+
+/*
+ * The minimum and maximum of a block
+ */
+template<class TInputImage>
+void
+OtsuThresholdWithMaskImageCalculator<TInputImage>
+::ComputeMinimumMaximum( const RegionType & block, MinimumMaximumType & partial ) const
+{
+  typedef ImageRegionConstIterator<ImageType> IteratorType;
+
+  // the spans of the mask in the block, or the block as one span
+  SizeValueType spanBegin = 0, spanEnd = 1;
+  if( this->m_MaskSpans ) this->m_MaskSpans->GetSpanRange( block, spanBegin, spanEnd );
+
+  PixelType imageMin = partial.Minimum;
+  PixelType imageMax = partial.Maximum;
+  RegionType spanRegion = block;
+  for( SizeValueType s = spanBegin; s < spanEnd; ++s )
+  {
+    if( this->m_MaskSpans && !this->m_MaskSpans->GetSpanRegion( s, block, spanRegion ) ) continue;
+    for( IteratorType iter( this->m_Image, spanRegion ); !iter.IsAtEnd(); ++iter )
     {
-    relativeFrequency[j] = 0.0;
+      PixelType current = iter.Value();
+      imageMin = imageMin > current ? current : imageMin;
+      imageMax = imageMax < current ? current : imageMax;
     }
+  }
+  partial.Minimum = imageMin;
+  partial.Maximum = imageMax;
+}
 
-  double binMultiplier = (double) this->m_NumberOfHistogramBins /
-    (double) ( imageMax - imageMin );
 
-  iter.GoToBegin();
-  if( this->m_MaskImage ) itMask.GoToBegin();
-  while ( !iter.IsAtEnd() )
+/*
+ * The histogram of a block
+ */
+template<class TInputImage>
+void
+OtsuThresholdWithMaskImageCalculator<TInputImage>
+::ComputeBlockHistogram( const RegionType & block, HistogramType & partial ) const
+{
+  typedef ImageRegionConstIterator<ImageType> IteratorType;
+
+  const PixelType imageMin = this->m_HistogramMinimum;
+  const double binMultiplier = (double) this->m_NumberOfHistogramBins /
+    (double) ( this->m_HistogramMaximum - imageMin );
+
+  SizeValueType spanBegin = 0, spanEnd = 1;
+  if( this->m_MaskSpans ) this->m_MaskSpans->GetSpanRange( block, spanBegin, spanEnd );
+
+  RegionType spanRegion = block;
+  for( SizeValueType s = spanBegin; s < spanEnd; ++s )
   {
-    if( this->m_MaskImage && itMask.Value() == 0 )
+    if( this->m_MaskSpans && !this->m_MaskSpans->GetSpanRegion( s, block, spanRegion ) ) continue;
+    for( IteratorType iter( this->m_Image, spanRegion ); !iter.IsAtEnd(); ++iter )
     {
-      ++iter; ++itMask;
-      continue;
+      partial[ this->ComputeBinNumber( iter.Get(), binMultiplier ) ] += 1.0;
     }
+  }
+}
 
-    unsigned int binNumber;
-    PixelType value = iter.Get();
 
-    if( value == imageMin )
-      {
-      binNumber = 0;
-      }
-    else
-      {
-      binNumber = (unsigned int) vcl_ceil((value - imageMin) * binMultiplier ) - 1;
-      if( binNumber == this->m_NumberOfHistogramBins ) // in case of rounding errors
-        {
-        binNumber -= 1;
-        }
-      }
+/*
+ * The bin of a value
+ */
+template<class TInputImage>
+unsigned int
+OtsuThresholdWithMaskImageCalculator<TInputImage>
+::ComputeBinNumber( const PixelType & value, const double binMultiplier ) const
+{
+  const PixelType imageMin = this->m_HistogramMinimum;
+  if( value == imageMin )
+    {
+    return 0;
+    }
+
+  unsigned int binNumber = (unsigned int) vcl_ceil((value - imageMin) * binMultiplier ) - 1;
+  if( binNumber == this->m_NumberOfHistogramBins ) // in case of rounding errors
+    {
+    binNumber -= 1;
+    }
+  return binNumber;
+}
 
-    relativeFrequency[binNumber] += 1.0;
-    totalPixels += 1.0;
 
-    ++iter;
-    if( this->m_MaskImage ) ++itMask;
+/*
+ * Set the minimum and maximum of the image
+ */
+template<class TInputImage>
+void
+OtsuThresholdWithMaskImageCalculator<TInputImage>
+::SetImageMinimumMaximum( const PixelType & minimum, const PixelType & maximum )
+{
+  this->m_ImageMinimum = minimum;
+  this->m_ImageMaximum = maximum;
+  this->m_MinimumMaximumSetByUser = true;
+}
+
+
+/*
+ * Compute the histogram from the number of pixels per value
+ */
+template<class TInputImage>
+void
+OtsuThresholdWithMaskImageCalculator<TInputImage>
+::SetValueHistogram( const double minimumValue, const std::vector<double> & counts )
+{
+  this->m_Histogram.clear();
+  this->m_HistogramMinimum = NumericTraits<PixelType>::Zero;
+  this->m_HistogramMaximum = NumericTraits<PixelType>::Zero;
+  this->m_HistogramSetByUser = true;
+
+  // the range of the values that occur
+  std::size_t first = 0, last = counts.size();
+  while( first < counts.size() && counts[ first ] == 0.0 ) ++first;
+  while( last > first && counts[ last - 1 ] == 0.0 ) --last;
+  if( first == last ) { return; }
+  this->m_HistogramMinimum = static_cast<PixelType>( minimumValue + first );
+  this->m_HistogramMaximum = static_cast<PixelType>( minimumValue + ( last - 1 ) );
+  if( this->m_HistogramMinimum >= this->m_HistogramMaximum ) { return; }
+
+  // every value falls in one bin, as in ComputeBlockHistogram()
+  const double binMultiplier = (double) this->m_NumberOfHistogramBins /
+    (double) ( this->m_HistogramMaximum - this->m_HistogramMinimum );
+  this->m_Histogram.assign( this->m_NumberOfHistogramBins, 0.0 );
+  for( std::size_t i = first; i < last; ++i )
+  {
+    if( counts[ i ] == 0.0 ) continue;
+    const PixelType value = static_cast<PixelType>( minimumValue + i );
+    this->m_Histogram[ this->ComputeBinNumber( value, binMultiplier ) ] += counts[ i ];
+  }
+}
+
+
+/*
+ * Set a precomputed histogram
+ */
+template<class TInputImage>
+void
+OtsuThresholdWithMaskImageCalculator<TInputImage>
+::SetHistogram( const HistogramType & histogram,
+  const PixelType & minimum, const PixelType & maximum )
+{
+  this->m_Histogram = histogram;
+  this->m_HistogramMinimum = minimum;
+  this->m_HistogramMaximum = maximum;
+  this->m_HistogramSetByUser = true;
+  if( !histogram.empty() )
+  {
+    this->m_NumberOfHistogramBins = histogram.size();
+  }
+}
+
+
+/*
+ * Compute the Otsu's threshold
+ */
+template<class TInputImage>
+void
+OtsuThresholdWithMaskImageCalculator<TInputImage>
+::Compute( void )
+{
+  unsigned int j;
+
+  if( !this->m_HistogramSetByUser )
+  {
+    if( !m_Image ) { return; }
+    this->ComputeHistogram();
   }
 
+  const PixelType imageMin = this->m_HistogramMinimum;
+  const PixelType imageMax = this->m_HistogramMaximum;
+  if( imageMin >= imageMax || this->m_Histogram.empty() )
+  {
+    this->m_Threshold = imageMin;
+    return;
+  }
+
+  const unsigned long numberOfBins = this->m_Histogram.size();
+  double totalPixels = 0.0;
+  for ( j = 0; j < numberOfBins; j++ )
+    {
+    totalPixels += this->m_Histogram[j];
+    }
+  if( totalPixels == 0 ) { return; }
+
   // normalize the frequencies
+  std::vector<double> relativeFrequency( numberOfBins );
   double totalMean = 0.0;
-  for ( j = 0; j < this->m_NumberOfHistogramBins; j++ )
+  for ( j = 0; j < numberOfBins; j++ )
     {
-    relativeFrequency[j] /= totalPixels;
+    relativeFrequency[j] = this->m_Histogram[j] / totalPixels;
     totalMean += (j+1) * relativeFrequency[j];
     }
 
+  double binMultiplier = (double) numberOfBins /
+    (double) ( imageMax - imageMin );
 
   // compute Otsu's threshold by maximizing the between-class
   // variance
@@ -165,7 +337,7 @@ OtsuThresholdWithMaskImageCalculator<TInputImage>
   double freqLeftOld = freqLeft;
   double meanLeftOld = meanLeft;
 
-  for ( j = 1; j < this->m_NumberOfHistogramBins; j++ )
+  for ( j = 1; j < numberOfBins; j++ )
     {
     freqLeft += relativeFrequency[j];
     meanLeft = ( meanLeftOld * freqLeftOld +
@@ -42,19 +42,25 @@ std::string GetHelpString( void )
     << "pxthresholdimage\n"
     << "  -in        inputFilename\n"
     << "  [-out]     outputFilename; default in + THRESHOLDED.mhd\n"
-    << "  [-mask]    maskFilename, optional for \"OtsuThreshold\", required for \"KappaSigmaThreshold\"\n"
-    << "  [-m]       method, choose one of \n"
+    << "  [-mask]    maskFilename, optional for \"OtsuThreshold\" and \"FastOtsuMultipleThreshold\",\n"
+    << "             required for \"KappaSigmaThreshold\"\n"
+    << "  [-m]       method(s), choose one or more of \n"
     << "               {Threshold, OtsuThreshold, OtsuMultipleThreshold,\n"
+    << "               FastOtsuMultipleThreshold,\n"
     << "               AdaptiveOtsuThreshold, RobustAutomaticThreshold,\n"
     << "               KappaSigmaThreshold, MinErrorThreshold }\n"
     << "             default \"Threshold\"\n"
+    << "             The input is read once for all methods. For more than one method\n"
+    << "             the method name is inserted before the extension of the output,\n"
+    << "             and a table of the thresholds is printed.\n"
     << "  [-t1]      lower threshold, for \"Threshold\", default -infinity\n"
     << "  [-t2]      upper threshold, for \"Threshold\", default 1.0\n"
     << "  [-inside]  inside value, default 0\n"
     << "  [-outside] outside value, default 1\n"
-    << "  [-t]       number of thresholds, for \"OtsuMultipleThreshold\", default 1\n"
-    << "  [-b]       number of histogram bins, for \"OtsuThreshold\", \"MinErrorThreshold\"\n"
-    << "               and \"AdaptiveOtsuThreshold\", default 128\n"
+    << "  [-t]       number of thresholds, for \"OtsuMultipleThreshold\" and\n"
+    << "               \"FastOtsuMultipleThreshold\", default 1\n"
+    << "  [-b]       number of histogram bins, for \"OtsuThreshold\", \"MinErrorThreshold\",\n"
+    << "               \"FastOtsuMultipleThreshold\" and \"AdaptiveOtsuThreshold\", default 128\n"
     << "  [-r]       radius, for \"AdaptiveOtsuThreshold\", default 8\n"
     << "  [-cp]      number of control points, for \"AdaptiveOtsuThreshold\", default 50\n"
     << "  [-l]       number of levels, for \"AdaptiveOtsuThreshold\", default 3\n"
@@ -65,7 +71,10 @@ std::string GetHelpString( void )
     << "  [-iter]    number of iterations, for \"KappaSigmaThreshold\", default 2\n"
     << "  [-mv]      mask value, for \"KappaSigmaThreshold\", default 1\n"
     << "  [-mt]      mixture type (1 - Gaussians, 2 - Poissons), for \"MinErrorThreshold\", default 1\n"
-    << "  [-z]       compression flag; if provided, the output image is compressed\n\n"
+    << "  [-z]       compression flag; if provided, the output image is compressed\n"
+    << "  [-cache]   without a mask, take the histogram of the histogram based methods,\n"
+    << "               or its range, from the statistics file in + .statistics,\n"
+    << "               written by e.g. pxstatisticsonimage -cache, if it is valid\n\n"
     << "Supported: 2D, 3D, 4D, (unsigned) char, (unsigned) short, float, double.";
 
   return ss.str();
@@ -107,8 +116,8 @@ int main( int argc, char **argv )
   std::string maskFileName = "";
   parser->GetCommandLineArgument( "-mask", maskFileName );
 
-  std::string method = "Threshold";
-  parser->GetCommandLineArgument( "-m", method );
+  std::vector<std::string> methods( 1, "Threshold" );
+  parser->GetCommandLineArgument( "-m", methods );
 
   double threshold1 = itk::NumericTraits<double>::NonpositiveMin();
   parser->GetCommandLineArgument( "-t1", threshold1 );
@@ -161,25 +170,32 @@ int main( int argc, char **argv )
   bool useCompression = parser->ArgumentExists( "-z" );
 
   /** Checks. */
-  if( method != "Threshold"
-    && method != "OtsuThreshold"
-    && method != "OtsuMultipleThreshold"
-    && method != "AdaptiveOtsuThreshold"
-    && method != "RobustAutomaticThreshold"
-    && method != "KappaSigmaThreshold"
-    && method != "MinErrorThreshold" )
+  for( std::size_t k = 0; k < methods.size(); ++k )
   {
-    std::cerr << "ERROR: method \"-m\" should be one of { Threshold, "
-      << "OtsuThreshold, OtsuMultipleThreshold, AdaptiveOtsuThreshold, "
-      << "RobustAutomaticThreshold, KappaSigmaThreshold, MinErrorThreshold }." << std::endl;
-    return EXIT_FAILURE;
-  }
-  if( method == "KappaSigmaThreshold" && maskFileName == "" )
-  {
-    std::cerr << "ERROR: the method \"KappaSigmaThreshold\" requires setting a mask using \"-mask\"." << std::endl;
-    return EXIT_FAILURE;
+    const std::string & method = methods[ k ];
+    if( method != "Threshold"
+      && method != "OtsuThreshold"
+      && method != "OtsuMultipleThreshold"
+      && method != "FastOtsuMultipleThreshold"
+      && method != "AdaptiveOtsuThreshold"
+      && method != "RobustAutomaticThreshold"
+      && method != "KappaSigmaThreshold"
+      && method != "MinErrorThreshold" )
+    {
+      std::cerr << "ERROR: method \"-m\" should be one of { Threshold, "
+        << "OtsuThreshold, OtsuMultipleThreshold, FastOtsuMultipleThreshold, AdaptiveOtsuThreshold, "
+        << "RobustAutomaticThreshold, KappaSigmaThreshold, MinErrorThreshold }." << std::endl;
+      return EXIT_FAILURE;
+    }
+    if( method == "KappaSigmaThreshold" && maskFileName == "" )
+    {
+      std::cerr << "ERROR: the method \"KappaSigmaThreshold\" requires setting a mask using \"-mask\"." << std::endl;
+      return EXIT_FAILURE;
+    }
   }
 
+  const bool useCacheFile = parser->ArgumentExists( "-cache" );
+
   /** Determine image properties. */
   itk::ImageIOBase::IOPixelType pixelType = itk::ImageIOBase::UNKNOWNPIXELTYPE;
   itk::ImageIOBase::IOComponentType componentType = itk::ImageIOBase::UNKNOWNCOMPONENTTYPE;
@@ -235,7 +251,7 @@ int main( int argc, char **argv )
     filter->m_Iterations = iterations;
     filter->m_MaskFileName = maskFileName;
     filter->m_MaskValue = maskValue;
-    filter->m_Method = method;
+    filter->m_Methods = methods;
     filter->m_MixtureType = mixtureType;
     filter->m_NumThresholds = numThresholds;
     filter->m_OutputFileName = outputFileName;
@@ -245,7 +261,9 @@ int main( int argc, char **argv )
     filter->m_Threshold1 = threshold1;
     filter->m_Threshold2 = threshold2;
     filter->m_UseCompression = useCompression;
+    filter->m_UseCacheFile = useCacheFile;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
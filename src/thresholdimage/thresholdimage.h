@@ -19,8 +19,13 @@
 #define __thresholdimage_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsStatisticsCache.h"
 #include "itkImage.h"
+#include "itkImageFileReader.h"
+#include "itkOtsuThresholdWithMaskImageCalculator.h"
 #include <string>
+#include <vector>
+#include <iomanip>
 
 
 /** \class ITKToolsThresholdImageBase
@@ -41,7 +46,7 @@ public:
     this->m_Iterations = 0;
     this->m_MaskFileName = "";
     this->m_MaskValue = 0;
-    this->m_Method = "";
+    this->m_Methods.clear();
     this->m_MixtureType = 0;
     this->m_NumThresholds = 0;
     this->m_OutputFileName = "";
@@ -52,6 +57,7 @@ public:
     this->m_Threshold1 = 0.0f;
     this->m_Threshold2 = 0.0f;
     this->m_UseCompression = false;
+    this->m_UseCacheFile = false;
   };
   /** Destructor. */
   ~ITKToolsThresholdImageBase(){};
@@ -61,7 +67,7 @@ public:
   std::string   m_OutputFileName;
   std::string   m_MaskFileName;
 
-  std::string m_Method;
+  std::vector<std::string> m_Methods;
 
   unsigned int m_NumThresholds;
   double m_Threshold1;
@@ -78,6 +84,7 @@ public:
   double        m_Sigma;
   bool          m_Supported;
   bool          m_UseCompression;
+  bool          m_UseCacheFile;
 
 }; // end class ITKToolsThresholdImageBase
 
@@ -99,90 +106,192 @@ public:
   ITKToolsThresholdImage(){};
   ~ITKToolsThresholdImage(){};
 
-  /** Typedef. */
-  typedef itk::Image< TComponentType, VDimension > InputImageType;
+  /** Typedef's. */
+  typedef itk::Image< TComponentType, VDimension >      InputImageType;
+  typedef itk::Image< unsigned char, VDimension >       MaskImageType;
+  typedef itk::OtsuThresholdWithMaskImageCalculator<
+    InputImageType >                                    HistogramCalculatorType;
 
   /** Run function. */
   void Run( void )
   {
-    if( this->m_Method == "Threshold" )
-    {
-      this->ThresholdImage(
-        this->m_InputFileName, this->m_OutputFileName,
-        this->m_Inside, this->m_Outside,
-        this->m_Threshold1, this->m_Threshold2,
-        this->m_UseCompression );
-    }
-    else if( this->m_Method == "OtsuThreshold" )
-    {
-      this->OtsuThresholdImage(
-        this->m_InputFileName, this->m_OutputFileName, this->m_MaskFileName,
-        this->m_Inside, this->m_Outside,
-        this->m_Bins,
-        this->m_UseCompression );
-    }
-    else if( this->m_Method == "OtsuMultipleThreshold" )
-    {
-      this->OtsuMultipleThresholdImage(
-        this->m_InputFileName, this->m_OutputFileName, this->m_MaskFileName,
-        this->m_Inside, this->m_Outside,
-        this->m_Bins, this->m_NumThresholds,
-        this->m_UseCompression );
-    }
-    else if( this->m_Method == "RobustAutomaticThreshold" )
+    typedef itk::ImageFileReader< InputImageType >      ReaderType;
+    typedef itk::ImageFileReader< MaskImageType >       MaskReaderType;
+
+    /** Read the input image and the mask once, for all methods. */
+    typename ReaderType::Pointer reader = ReaderType::New();
+    reader->SetFileName( this->m_InputFileName.c_str() );
+    reader->Update();
+    typename InputImageType::Pointer inputImage = reader->GetOutput();
+
+    typename MaskImageType::Pointer maskImage = 0;
+    if( this->m_MaskFileName != "" )
     {
-      this->RobustAutomaticThresholdImage(
-        this->m_InputFileName, this->m_OutputFileName,
-        this->m_Inside, this->m_Outside,
-        this->m_Pow,
-        this->m_UseCompression );
+      typename MaskReaderType::Pointer maskReader = MaskReaderType::New();
+      maskReader->SetFileName( this->m_MaskFileName.c_str() );
+      maskReader->Update();
+      maskImage = maskReader->GetOutput();
     }
-    else if( this->m_Method == "KappaSigmaThreshold" )
+
+    /** The histogram is shared by the histogram based methods. Without a
+     * mask, it is derived from the statistics file of the input if possible,
+     * or else its range is taken from there.
+     */
+    itktools::ImageStatistics imageStatistics;
+    const bool cached = this->m_UseCacheFile && this->m_MaskFileName == ""
+      && itktools::ReadStatisticsCache( this->m_InputFileName,
+        itktools::GetReadComponentType<InputImageType>(), imageStatistics );
+    typename HistogramCalculatorType::Pointer histogramCalculator = 0;
+    for( std::size_t k = 0; k < this->m_Methods.size(); ++k )
     {
-      this->KappaSigmaThresholdImage(
-        this->m_InputFileName, this->m_OutputFileName, this->m_MaskFileName,
-        this->m_Inside, this->m_Outside,
-        this->m_MaskValue, this->m_Sigma, this->m_Iterations,
-        this->m_UseCompression );
+      if( !histogramCalculator && ( this->m_Methods[ k ] == "OtsuThreshold"
+        || this->m_Methods[ k ] == "FastOtsuMultipleThreshold"
+        || this->m_Methods[ k ] == "MinErrorThreshold" ) )
+      {
+        histogramCalculator = HistogramCalculatorType::New();
+        histogramCalculator->SetImage( inputImage );
+        histogramCalculator->SetMaskImage( maskImage );
+        histogramCalculator->SetNumberOfHistogramBins( this->m_Bins );
+        if( cached && imageStatistics.HasHistogram() )
+        {
+          histogramCalculator->SetValueHistogram(
+            imageStatistics.HistogramMinimum, imageStatistics.Histogram );
+          continue;
+        }
+        if( cached && imageStatistics.HasMoments() )
+        {
+          histogramCalculator->SetImageMinimumMaximum(
+            static_cast<TComponentType>( imageStatistics.Minimum[ 0 ] ),
+            static_cast<TComponentType>( imageStatistics.Maximum[ 0 ] ) );
+        }
+        histogramCalculator->ComputeHistogram();
+      }
     }
-    else if( this->m_Method == "MinErrorThreshold" )
+
+    /** Apply the methods, one output per method. */
+    const std::size_t numberOfMethods = this->m_Methods.size();
+    std::vector< std::vector<double> > thresholds( numberOfMethods );
+    std::string::size_type dot = this->m_OutputFileName.rfind( "." );
+    if( dot == std::string::npos ) dot = this->m_OutputFileName.size();
+    for( std::size_t k = 0; k < numberOfMethods; ++k )
     {
-      this->MinErrorThresholdImage(
-        this->m_InputFileName, this->m_OutputFileName,
-        this->m_Inside, this->m_Outside,
-        this->m_Bins, this->m_MixtureType,
-        this->m_UseCompression );
+      const std::string & method = this->m_Methods[ k ];
+      std::string outputFileName = this->m_OutputFileName;
+      if( numberOfMethods > 1 )
+      {
+        outputFileName = this->m_OutputFileName.substr( 0, dot )
+          + method + this->m_OutputFileName.substr( dot );
+      }
+
+      if( method == "Threshold" )
+      {
+        thresholds[ k ] = this->ThresholdImage(
+          inputImage, outputFileName,
+          this->m_Inside, this->m_Outside,
+          this->m_Threshold1, this->m_Threshold2,
+          this->m_UseCompression );
+      }
+      else if( method == "OtsuThreshold" )
+      {
+        thresholds[ k ] = this->OtsuThresholdImage(
+          inputImage, outputFileName, histogramCalculator,
+          this->m_Inside, this->m_Outside,
+          this->m_UseCompression );
+      }
+      else if( method == "OtsuMultipleThreshold" )
+      {
+        thresholds[ k ] = this->OtsuMultipleThresholdImage(
+          inputImage, outputFileName,
+          this->m_Inside, this->m_Outside,
+          this->m_Bins, this->m_NumThresholds,
+          this->m_UseCompression );
+      }
+      else if( method == "FastOtsuMultipleThreshold" )
+      {
+        thresholds[ k ] = this->FastOtsuMultipleThresholdImage(
+          inputImage, outputFileName, histogramCalculator,
+          this->m_NumThresholds,
+          this->m_UseCompression );
+      }
+      else if( method == "RobustAutomaticThreshold" )
+      {
+        thresholds[ k ] = this->RobustAutomaticThresholdImage(
+          inputImage, outputFileName,
+          this->m_Inside, this->m_Outside,
+          this->m_Pow,
+          this->m_UseCompression );
+      }
+      else if( method == "KappaSigmaThreshold" )
+      {
+        thresholds[ k ] = this->KappaSigmaThresholdImage(
+          inputImage, outputFileName, maskImage,
+          this->m_Inside, this->m_Outside,
+          this->m_MaskValue, this->m_Sigma, this->m_Iterations,
+          this->m_UseCompression );
+      }
+      else if( method == "MinErrorThreshold" )
+      {
+        /** The shared histogram is masked, this method uses the whole image. */
+        thresholds[ k ] = this->MinErrorThresholdImage(
+          inputImage, outputFileName,
+          maskImage.IsNull() ? histogramCalculator.GetPointer() : 0,
+          this->m_Inside, this->m_Outside,
+          this->m_Bins, this->m_MixtureType,
+          this->m_UseCompression );
+      }
+      else
+      {
+        std::cerr << "Not supported!" << std::endl;
+        return;
+      }
     }
-    else
+
+    /** Print the table of thresholds. */
+    if( numberOfMethods > 1 )
     {
-      std::cerr << "Not supported!" << std::endl;
-      return;
+      std::cout << std::left << std::setw( 28 ) << "method" << "threshold(s)" << std::endl;
+      for( std::size_t k = 0; k < numberOfMethods; ++k )
+      {
+        std::cout << std::left << std::setw( 28 ) << this->m_Methods[ k ];
+        for( std::size_t i = 0; i < thresholds[ k ].size(); ++i )
+        {
+          std::cout << ( i == 0 ? "" : " " ) << thresholds[ k ][ i ];
+        }
+        std::cout << std::endl;
+      }
     }
+
   } // end Run()
 
   /** Function to perform normal thresholding. */
-  void ThresholdImage(
-    const std::string & inputFileName, const std::string & outputFileName,
+  std::vector<double> ThresholdImage(
+    InputImageType * inputImage, const std::string & outputFileName,
     const double & inside, const double & outside,
     const double & threshold1, const double & threshold2,
     const bool & useCompression );
 
-  /** Function to perform Otsu thresholding. */
-  void OtsuThresholdImage(
-    const std::string & inputFileName, const std::string & outputFileName,
-    const std::string & maskFileName,
+  /** Function to perform Otsu thresholding, on the histogram of the
+   * histogram calculator. */
+  std::vector<double> OtsuThresholdImage(
+    InputImageType * inputImage, const std::string & outputFileName,
+    const HistogramCalculatorType * histogramCalculator,
     const double & inside, const double & outside,
-    const unsigned int & bins,
     const bool & useCompression );
 
   /** Function to perform Otsu thresholding with multiple thresholds. */
-  void OtsuMultipleThresholdImage(
-    const std::string & inputFileName, const std::string & outputFileName,
-    const std::string & itkNotUsed( maskFileName ),
+  std::vector<double> OtsuMultipleThresholdImage(
+    InputImageType * inputImage, const std::string & outputFileName,
     const double & inside, const double & outside,
     const unsigned int & bins, const unsigned int & numThresholds,
     const bool & useCompression );
 
+  /** Function to perform Otsu thresholding with multiple thresholds, by
+   * dynamic programming on the histogram of the histogram calculator. */
+  std::vector<double> FastOtsuMultipleThresholdImage(
+    InputImageType * inputImage, const std::string & outputFileName,
+    const HistogramCalculatorType * histogramCalculator,
+    const unsigned int & numThresholds, const bool & useCompression );
+
   /** Function to perform Otsu thresholding with an adaptive threshold. */
 //   void AdaptiveOtsuThresholdImage(
 //     const std::string & inputFileName, const std::string & outputFileName,
@@ -191,22 +300,24 @@ public:
 //     const unsigned int & samples, const unsigned int & splineOrder );
 
   /** Function to perform thresholding using .. . */
-  void RobustAutomaticThresholdImage(
-    const std::string & inputFileName, const std::string & outputFileName,
+  std::vector<double> RobustAutomaticThresholdImage(
+    InputImageType * inputImage, const std::string & outputFileName,
     const double & inside, const double & outside,
     const double & pow, const bool & useCompression );
 
   /** Function to perform thresholding using ... . */
-  void KappaSigmaThresholdImage(
-    const std::string & inputFileName, const std::string & outputFileName,
-    const std::string & maskFileName,
+  std::vector<double> KappaSigmaThresholdImage(
+    InputImageType * inputImage, const std::string & outputFileName,
+    MaskImageType * maskImage,
     const double & inside, const double & outside, const unsigned int & maskValue,
     const double & sigma, const unsigned int & iterations,
     const bool & useCompression );
 
-  /** Function to perform thresholding using .. . */
-  void MinErrorThresholdImage(
-    const std::string & inputFileName, const std::string & outputFileName,
+  /** Function to perform thresholding using .. . If a histogram calculator
+   * is given, its histogram is used instead of scanning the image again. */
+  std::vector<double> MinErrorThresholdImage(
+    InputImageType * inputImage, const std::string & outputFileName,
+    const HistogramCalculatorType * histogramCalculator,
     const double & inside, const double & outside,
     const unsigned int & bins, const unsigned int & mixtureType,
     const bool & useCompression );
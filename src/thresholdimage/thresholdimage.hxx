@@ -18,17 +18,17 @@
 #ifndef __thresholdimage_hxx_
 #define __thresholdimage_hxx_
 
-#include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
 
 #include "itkGradientMagnitudeRecursiveGaussianImageFilter.h"
 #include "itkBinaryThresholdImageFilter.h"
-#include "itkOtsuThresholdWithMaskImageFilter.h"
 #include "itkOtsuMultipleThresholdsImageFilter.h"
+#include "itkMultiLevelOtsuThresholdCalculator.h"
+#include "itkThresholdLabelerImageFilter.h"
 #include "itkAdaptiveOtsuThresholdImageFilter.h"
 #include "itkRobustAutomaticThresholdImageFilter.h"
 #include "itkKappaSigmaThresholdImageFilter.h"
-#include "itkMinErrorThresholdImageFilter.h"
+#include "itkMinErrorThresholdImageCalculator.h"
 
 
 /**
@@ -36,10 +36,10 @@
  */
 
 template< unsigned int VDimension, class TComponentType >
-void
+std::vector<double>
 ITKToolsThresholdImage< VDimension, TComponentType >
 ::ThresholdImage(
-  const std::string & inputFileName,
+  InputImageType * inputImage,
   const std::string & outputFileName,
   const double & inside,
   const double & outside,
@@ -51,20 +51,15 @@ ITKToolsThresholdImage< VDimension, TComponentType >
   typedef typename InputImageType::PixelType          InputPixelType;
   typedef InputImageType                              OutputImageType;
   typedef InputPixelType                              OutputPixelType;
-  typedef itk::ImageFileReader< InputImageType >      ReaderType;
   typedef itk::BinaryThresholdImageFilter<
     InputImageType, OutputImageType>                  ThresholderType;
   typedef itk::ImageFileWriter< OutputImageType >     WriterType;
 
   /** Declarations. */
   InputPixelType lowerthreshold;
-  typename ReaderType::Pointer reader = ReaderType::New();
   typename ThresholderType::Pointer thresholder = ThresholderType::New();
   typename WriterType::Pointer writer = WriterType::New();
 
-  /** Read in the inputImage. */
-  reader->SetFileName( inputFileName.c_str() );
-
   /** Apply the threshold. */
   lowerthreshold = static_cast<InputPixelType>( vnl_math_max(
     static_cast<double>( itk::NumericTraits<InputPixelType>::NonpositiveMin() ),
@@ -73,7 +68,7 @@ ITKToolsThresholdImage< VDimension, TComponentType >
   thresholder->SetUpperThreshold( static_cast<InputPixelType>( threshold2 ) );
   thresholder->SetInsideValue( static_cast<InputPixelType>( inside ) );
   thresholder->SetOutsideValue( static_cast<InputPixelType>( outside ) );
-  thresholder->SetInput( reader->GetOutput() );
+  thresholder->SetInput( inputImage );
 
   /** Write the output image. */
   writer->SetInput( thresholder->GetOutput() );
@@ -81,6 +76,12 @@ ITKToolsThresholdImage< VDimension, TComponentType >
   writer->SetUseCompression( useCompression );
   writer->Update();
 
+  /** Return the thresholds. */
+  std::vector<double> thresholds( 2 );
+  thresholds[ 0 ] = static_cast<double>( thresholder->GetLowerThreshold() );
+  thresholds[ 1 ] = static_cast<double>( thresholder->GetUpperThreshold() );
+  return thresholds;
+
 } // end ThresholdImage()
 
 
@@ -89,15 +90,14 @@ ITKToolsThresholdImage< VDimension, TComponentType >
  */
 
 template< unsigned int VDimension, class TComponentType >
-void
+std::vector<double>
 ITKToolsThresholdImage< VDimension, TComponentType >
 ::OtsuThresholdImage(
-  const std::string & inputFileName,
+  InputImageType * inputImage,
   const std::string & outputFileName,
-  const std::string & maskFileName,
+  const HistogramCalculatorType * histogramCalculator,
   const double & inside,
   const double & outside,
-  const unsigned int & bins,
   const bool & useCompression )
 {
   /** Typedef's. */
@@ -105,34 +105,28 @@ ITKToolsThresholdImage< VDimension, TComponentType >
 
   typedef typename InputImageType::PixelType            InputPixelType;
   typedef unsigned char                                 OutputPixelType;
-  typedef unsigned char                                 MaskPixelType;
-  typedef itk::Image< MaskPixelType, ImageDimension >   MaskImageType;
   typedef itk::Image< OutputPixelType, ImageDimension > OutputImageType;
-  typedef itk::ImageFileReader< InputImageType >        ReaderType;
-  typedef itk::ImageFileReader< MaskImageType >         MaskReaderType;
-  typedef itk::OtsuThresholdWithMaskImageFilter<
+  typedef itk::BinaryThresholdImageFilter<
     InputImageType, OutputImageType>                    ThresholderType;
   typedef itk::ImageFileWriter< OutputImageType >       WriterType;
 
   /** Declarations. */
-  typename ReaderType::Pointer reader1 = ReaderType::New();
-  typename MaskReaderType::Pointer reader2 = MaskReaderType::New();
+  typename HistogramCalculatorType::Pointer calculator = HistogramCalculatorType::New();
   typename ThresholderType::Pointer thresholder = ThresholderType::New();
   typename WriterType::Pointer writer = WriterType::New();
 
-  /** Read in the inputImage. */
-  reader1->SetFileName( inputFileName.c_str() );
+  /** Compute the threshold on the shared histogram. */
+  calculator->SetHistogram( histogramCalculator->GetHistogram(),
+    histogramCalculator->GetHistogramMinimum(),
+    histogramCalculator->GetHistogramMaximum() );
+  calculator->Compute();
 
-  /** Apply the threshold. */
-  thresholder->SetNumberOfHistogramBins( bins );
+  /** Apply the threshold, as OtsuThresholdWithMaskImageFilter does. */
+  thresholder->SetLowerThreshold( itk::NumericTraits<InputPixelType>::NonpositiveMin() );
+  thresholder->SetUpperThreshold( calculator->GetThreshold() );
   thresholder->SetInsideValue( static_cast<OutputPixelType>( inside ) );
   thresholder->SetOutsideValue( static_cast<OutputPixelType>( outside ) );
-  thresholder->SetInput( reader1->GetOutput() );
-  if( maskFileName != "" )
-  {
-    reader2->SetFileName( maskFileName.c_str() );
-    thresholder->SetMaskImage( reader2->GetOutput() );
-  }
+  thresholder->SetInput( inputImage );
 
   /** Write the output image. */
   writer->SetInput( thresholder->GetOutput() );
@@ -140,6 +134,8 @@ ITKToolsThresholdImage< VDimension, TComponentType >
   writer->SetUseCompression( useCompression );
   writer->Update();
 
+  return std::vector<double>( 1, static_cast<double>( calculator->GetThreshold() ) );
+
 } // end OtsuThresholdImage()
 
 
@@ -148,12 +144,11 @@ ITKToolsThresholdImage< VDimension, TComponentType >
  */
 
 template< unsigned int VDimension, class TComponentType >
-void
+std::vector<double>
 ITKToolsThresholdImage< VDimension, TComponentType >
 ::OtsuMultipleThresholdImage(
-  const std::string & inputFileName,
+  InputImageType * inputImage,
   const std::string & outputFileName,
-  const std::string & itkNotUsed( maskFileName ),
   const double & inside,
   const double & outside,
   const unsigned int & bins,
@@ -163,37 +158,22 @@ ITKToolsThresholdImage< VDimension, TComponentType >
   /** Typedef's. */
   const unsigned int ImageDimension = InputImageType::ImageDimension;
 
-  typedef typename InputImageType::PixelType            InputPixelType;
   typedef unsigned char                                 OutputPixelType;
-  typedef unsigned char                                 MaskPixelType;
-  typedef itk::Image< MaskPixelType, ImageDimension >   MaskImageType;
   typedef itk::Image< OutputPixelType, ImageDimension > OutputImageType;
-  typedef itk::ImageFileReader< InputImageType >        ReaderType;
-  typedef itk::ImageFileReader< MaskImageType >         MaskReaderType;
   typedef itk::OtsuMultipleThresholdsImageFilter<
     InputImageType, OutputImageType>                    ThresholderType;
   typedef itk::ImageFileWriter< OutputImageType >       WriterType;
 
   /** Declarations. */
-  typename ReaderType::Pointer reader1 = ReaderType::New();
-  //typename MaskReaderType::Pointer reader2 = MaskReaderType::New();
   typename ThresholderType::Pointer thresholder = ThresholderType::New();
   typename WriterType::Pointer writer = WriterType::New();
 
-  /** Read in the inputImage. */
-  reader1->SetFileName( inputFileName.c_str() );
-
   /** Apply the threshold. */
-  thresholder->SetInput( reader1->GetOutput() );
+  thresholder->SetInput( inputImage );
   thresholder->SetNumberOfHistogramBins( bins );
   //thresholder->SetInsideValue( static_cast<InputPixelType>( inside ) );
   //thresholder->SetOutsideValue( static_cast<InputPixelType>( outside ) );
   thresholder->SetNumberOfThresholds( numThresholds );
-//   if( maskFileName != "" )
-//   {
-//     reader2->SetFileName( maskFileName.c_str() );
-//     thresholder->SetMaskImage( reader2->GetOutput() );
-//   }
 
   /** Write the output image. */
   writer->SetInput( thresholder->GetOutput() );
@@ -201,62 +181,77 @@ ITKToolsThresholdImage< VDimension, TComponentType >
   writer->SetUseCompression( useCompression );
   writer->Update();
 
+  /** Return the thresholds. */
+  std::vector<double> thresholds;
+  for( std::size_t i = 0; i < thresholder->GetThresholds().size(); ++i )
+  {
+    thresholds.push_back( static_cast<double>( thresholder->GetThresholds()[ i ] ) );
+  }
+  return thresholds;
+
 } // end OtsuMultipleThresholdImage()
 
 
-// /**
-//  * ******************* AdaptiveOtsuThresholdImage *******************
-//  */
-//
-// template< unsigned int VDimension, class TComponentType >
-// void
-// ITKToolsThresholdImage< VDimension, TComponentType >
-// ::AdaptiveOtsuThresholdImage(
-//   const std::string & inputFileName,
-//   const std::string & outputFileName,
-//   const unsigned int & radius,
-//   const unsigned int & bins,
-//   const unsigned int & controlPoints,
-//   const unsigned int & levels,
-//   const unsigned int & samples,
-//   const unsigned int & splineOrder )
-// {
-//   /** Typedef's. */
-//   const unsigned int ImageDimension = InputImageType::ImageDimension;
-//
-//   typedef unsigned char                                 OutputPixelType;
-//   typedef itk::Image< OutputPixelType, ImageDimension > OutputImageType;
-//   typedef itk::ImageFileReader< InputImageType >        ReaderType;
-//   typedef itk::AdaptiveOtsuThresholdImageFilter<
-//     InputImageType, OutputImageType>                    ThresholderType;
-//   typedef itk::ImageFileWriter< OutputImageType >       WriterType;
-//   typedef ThresholderType::InputSizeType                RadiusType;
-//
-//   /** Declarations. */
-//   typename ReaderType::Pointer reader = ReaderType::New();
-//   typename ThresholderType::Pointer thresholder = ThresholderType::New();
-//   typename WriterType::Pointer writer = WriterType::New();
-//   RadiusType Radius; Radius.Fill( radius );
-//
-//   /** Read in the inputImage. */
-//   reader->SetFileName( inputFileName.c_str() );
-//
-//   /** Apply the threshold. */
-//   thresholder->SetRadius( Radius );
-//   thresholder->SetNumberOfHistogramBins( bins );
-//   thresholder->SetNumberOfControlPoints( controlPoints );
-//   thresholder->SetNumberOfLevels( levels );
-//   thresholder->SetNumberOfSamples( samples );
-//   thresholder->SetSplineOrder( splineOrder );
-//   thresholder->SetInsideValue( 1 );
-//   thresholder->SetOutsideValue( 0 );
-//   thresholder->SetInput( reader->GetOutput() );
-//
-//   /** Write the output image. */
-//   writer->SetInput( thresholder->GetOutput() );
-//   writer->SetFileName( outputFileName.c_str() );
-//   writer->Update();
-//
+/**
+ * ******************* FastOtsuMultipleThresholdImage *******************
+ */
+
+template< unsigned int VDimension, class TComponentType >
+std::vector<double>
+ITKToolsThresholdImage< VDimension, TComponentType >
+::FastOtsuMultipleThresholdImage(
+  InputImageType * inputImage,
+  const std::string & outputFileName,
+  const HistogramCalculatorType * histogramCalculator,
+  const unsigned int & numThresholds,
+  const bool & useCompression )
+{
+  /** Typedef's. */
+  const unsigned int ImageDimension = InputImageType::ImageDimension;
+
+  typedef unsigned char                                 OutputPixelType;
+  typedef itk::Image< OutputPixelType, ImageDimension > OutputImageType;
+  typedef itk::MultiLevelOtsuThresholdCalculator<
+    InputImageType >                                    CalculatorType;
+  typedef itk::ThresholdLabelerImageFilter<
+    InputImageType, OutputImageType>                    LabelerType;
+  typedef itk::ImageFileWriter< OutputImageType >       WriterType;
+
+  /** Declarations. */
+  typename CalculatorType::Pointer calculator = CalculatorType::New();
+  typename LabelerType::Pointer labeler = LabelerType::New();
+  typename WriterType::Pointer writer = WriterType::New();
+
+  /** Compute the thresholds on the shared histogram. */
+  calculator->SetHistogram( histogramCalculator->GetHistogram(),
+    histogramCalculator->GetHistogramMinimum(),
+    histogramCalculator->GetHistogramMaximum() );
+  calculator->SetNumberOfThresholds( numThresholds );
+  calculator->Compute();
+
+  /** Label the classes 0 to the number of thresholds, as
+   * OtsuMultipleThresholdsImageFilter does. */
+  labeler->SetInput( inputImage );
+  labeler->SetThresholds( calculator->GetThresholds() );
+  labeler->SetLabelOffset( 0 );
+
+  /** Write the output image. */
+  writer->SetInput( labeler->GetOutput() );
+  writer->SetFileName( outputFileName.c_str() );
+  writer->SetUseCompression( useCompression );
+  writer->Update();
+
+  /** Return the thresholds. */
+  std::vector<double> thresholds;
+  for( std::size_t i = 0; i < calculator->GetThresholds().size(); ++i )
+  {
+    thresholds.push_back( static_cast<double>( calculator->GetThresholds()[ i ] ) );
+  }
+  return thresholds;
+
+} // end FastOtsuMultipleThresholdImage()
+
+
 // } // end AdaptiveOtsuThresholdImage()
 
 
@@ -265,10 +260,10 @@ ITKToolsThresholdImage< VDimension, TComponentType >
  */
 
 template< unsigned int VDimension, class TComponentType >
-void
+std::vector<double>
 ITKToolsThresholdImage< VDimension, TComponentType >
 ::RobustAutomaticThresholdImage(
-  const std::string & inputFileName,
+  InputImageType * inputImage,
   const std::string & outputFileName,
   const double & inside,
   const double & outside,
@@ -278,12 +273,10 @@ ITKToolsThresholdImage< VDimension, TComponentType >
   /** Typedef's. */
   const unsigned int ImageDimension = InputImageType::ImageDimension;
 
-  typedef typename InputImageType::PixelType            InputPixelType;
   typedef unsigned char                                 OutputPixelType;
   typedef float                                         GMPixelType;
   typedef itk::Image< OutputPixelType, ImageDimension > OutputImageType;
   typedef itk::Image< GMPixelType, ImageDimension >     GMImageType;
-  typedef itk::ImageFileReader< InputImageType >        ReaderType;
   typedef itk::GradientMagnitudeRecursiveGaussianImageFilter<
     InputImageType, GMImageType >                       GMFilterType;
   typedef itk::RobustAutomaticThresholdImageFilter<
@@ -291,16 +284,12 @@ ITKToolsThresholdImage< VDimension, TComponentType >
   typedef itk::ImageFileWriter< OutputImageType >       WriterType;
 
   /** Declarations. */
-  typename ReaderType::Pointer reader = ReaderType::New();
   typename GMFilterType::Pointer gradientFilter = GMFilterType::New();
   typename ThresholderType::Pointer thresholder = ThresholderType::New();
   typename WriterType::Pointer writer = WriterType::New();
 
-  /** Read in the inputImage. */
-  reader->SetFileName( inputFileName.c_str() );
-
   /** Get the gradient magnitude of the input. */
-  gradientFilter->SetInput( reader->GetOutput() );
+  gradientFilter->SetInput( inputImage );
   gradientFilter->SetSigma( 1.0 );
   gradientFilter->SetNormalizeAcrossScale( false );
 
@@ -308,7 +297,7 @@ ITKToolsThresholdImage< VDimension, TComponentType >
   thresholder->SetPow( pow );
   thresholder->SetInsideValue( static_cast<OutputPixelType>( inside ) );
   thresholder->SetOutsideValue( static_cast<OutputPixelType>( outside ) );
-  thresholder->SetInput( reader->GetOutput() );
+  thresholder->SetInput( inputImage );
   thresholder->SetGradientImage( gradientFilter->GetOutput() );
 
   /** Write the output image. */
@@ -317,6 +306,8 @@ ITKToolsThresholdImage< VDimension, TComponentType >
   writer->SetUseCompression( useCompression );
   writer->Update();
 
+  return std::vector<double>( 1, static_cast<double>( thresholder->GetThreshold() ) );
+
 } // end RobustAutomaticThresholdImage()
 
 
@@ -325,12 +316,12 @@ ITKToolsThresholdImage< VDimension, TComponentType >
  */
 
 template< unsigned int VDimension, class TComponentType >
-void
+std::vector<double>
 ITKToolsThresholdImage< VDimension, TComponentType >
 ::KappaSigmaThresholdImage(
-  const std::string & inputFileName,
+  InputImageType * inputImage,
   const std::string & outputFileName,
-  const std::string & maskFileName,
+  MaskImageType * maskImage,
   const double & inside,
   const double & outside,
   const unsigned int & maskValue,
@@ -341,35 +332,24 @@ ITKToolsThresholdImage< VDimension, TComponentType >
   /** Typedef's. */
   const unsigned int ImageDimension = InputImageType::ImageDimension;
 
-  typedef typename InputImageType::PixelType            InputPixelType;
   typedef unsigned char                                 OutputPixelType;
-  typedef unsigned char                                 MaskPixelType;
-  typedef itk::Image< MaskPixelType, ImageDimension >   MaskImageType;
   typedef itk::Image< OutputPixelType, ImageDimension > OutputImageType;
-  typedef itk::ImageFileReader< InputImageType >        ReaderType;
-  typedef itk::ImageFileReader< MaskImageType >         MaskReaderType;
   typedef itk::KappaSigmaThresholdImageFilter<
     InputImageType, MaskImageType, OutputImageType >    ThresholderType;
   typedef itk::ImageFileWriter< OutputImageType >       WriterType;
 
   /** Declarations. */
-  typename ReaderType::Pointer reader1 = ReaderType::New();
-  typename MaskReaderType::Pointer reader2 = MaskReaderType::New();
   typename ThresholderType::Pointer thresholder = ThresholderType::New();
   typename WriterType::Pointer writer = WriterType::New();
 
-  /** Read in the inputImage. */
-  reader1->SetFileName( inputFileName.c_str() );
-  reader2->SetFileName( maskFileName.c_str() );
-
   /** Apply the threshold. */
   thresholder->SetMaskValue( maskValue );
   thresholder->SetSigmaFactor( sigma );
   thresholder->SetNumberOfIterations( iterations );
   thresholder->SetInsideValue( static_cast<OutputPixelType>( inside ) );
   thresholder->SetOutsideValue( static_cast<OutputPixelType>( outside ) );
-  thresholder->SetInput( reader1->GetOutput() );
-  thresholder->SetMaskImage( reader2->GetOutput() );
+  thresholder->SetInput( inputImage );
+  thresholder->SetMaskImage( maskImage );
 
   /** Write the output image. */
   writer->SetInput( thresholder->GetOutput() );
@@ -377,6 +357,8 @@ ITKToolsThresholdImage< VDimension, TComponentType >
   writer->SetUseCompression( useCompression );
   writer->Update();
 
+  return std::vector<double>( 1, static_cast<double>( thresholder->GetThreshold() ) );
+
 } // end KappaSigmaThresholdImage()
 
 
@@ -385,11 +367,12 @@ ITKToolsThresholdImage< VDimension, TComponentType >
  */
 
 template< unsigned int VDimension, class TComponentType >
-void
+std::vector<double>
 ITKToolsThresholdImage< VDimension, TComponentType >
 ::MinErrorThresholdImage(
-  const std::string & inputFileName,
+  InputImageType * inputImage,
   const std::string & outputFileName,
+  const HistogramCalculatorType * histogramCalculator,
   const double & inside,
   const double & outside,
   const unsigned int & bins,
@@ -402,26 +385,36 @@ ITKToolsThresholdImage< VDimension, TComponentType >
   typedef typename InputImageType::PixelType            InputPixelType;
   typedef unsigned char                                 OutputPixelType;
   typedef itk::Image< OutputPixelType, ImageDimension > OutputImageType;
-  typedef itk::ImageFileReader< InputImageType >        ReaderType;
-  typedef itk::MinErrorThresholdImageFilter<
-    InputImageType, OutputImageType >                   ThresholderType;
+  typedef itk::MinErrorThresholdImageCalculator<
+    InputImageType >                                    CalculatorType;
+  typedef itk::BinaryThresholdImageFilter<
+    InputImageType, OutputImageType>                    ThresholderType;
   typedef itk::ImageFileWriter< OutputImageType >       WriterType;
 
   /** Declarations. */
-  typename ReaderType::Pointer reader = ReaderType::New();
-
+  typename CalculatorType::Pointer calculator = CalculatorType::New();
   typename ThresholderType::Pointer thresholder = ThresholderType::New();
   typename WriterType::Pointer writer = WriterType::New();
 
-  /** Read in the inputImage. */
-  reader->SetFileName( inputFileName.c_str() );
+  /** Compute the threshold, on the shared histogram if there is one.
+   * The mixture type is interpreted as in MinErrorThresholdImageFilter. */
+  calculator->SetImage( inputImage );
+  calculator->SetNumberOfHistogramBins( bins );
+  calculator->UseGaussianMixture( mixtureType != 1 );
+  if( histogramCalculator )
+  {
+    calculator->SetHistogram( histogramCalculator->GetHistogram(),
+      histogramCalculator->GetHistogramMinimum(),
+      histogramCalculator->GetHistogramMaximum() );
+  }
+  calculator->Compute();
 
-  /** Apply the threshold. */
-  thresholder->SetNumberOfHistogramBins( bins );
-  thresholder->SetMixtureType( mixtureType );
+  /** Apply the threshold, as MinErrorThresholdImageFilter does. */
+  thresholder->SetLowerThreshold( itk::NumericTraits<InputPixelType>::NonpositiveMin() );
+  thresholder->SetUpperThreshold( calculator->GetThreshold() );
   thresholder->SetInsideValue( static_cast<OutputPixelType>( inside ) );
   thresholder->SetOutsideValue( static_cast<OutputPixelType>( outside ) );
-  thresholder->SetInput( reader->GetOutput() );
+  thresholder->SetInput( inputImage );
 
   /** Write the output image. */
   writer->SetInput( thresholder->GetOutput() );
@@ -429,6 +422,8 @@ ITKToolsThresholdImage< VDimension, TComponentType >
   writer->SetUseCompression( useCompression );
   writer->Update();
 
+  return std::vector<double>( 1, static_cast<double>( calculator->GetThreshold() ) );
+
 } // end MinErrorThresholdImage()
 
 
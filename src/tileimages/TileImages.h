@@ -21,8 +21,8 @@
 #include "ITKToolsBase.h"
 
 #include "itkImageFileReader.h"
-#include "itkTileImageFilter.h"
 #include "itkImageFileWriter.h"
+#include "TileImagesReader.h"
 
 
 /** \class ITKToolsTileImagesBase
@@ -39,6 +39,7 @@ public:
   {
     this->m_OutputFileName = "";
     this->m_Defaultvalue = 0.0;
+    this->m_NumberOfJobs = 0;
   };
   /** Destructor. */
   ~ITKToolsTileImagesBase(){};
@@ -48,6 +49,7 @@ public:
   std::string               m_OutputFileName;
   std::vector<unsigned int> m_Layout;
   double                    m_Defaultvalue;
+  unsigned int              m_NumberOfJobs; // 0: the number of threads
 
 }; // end class ITKToolsTileImagesBase
 
@@ -69,43 +71,118 @@ public:
   ITKToolsTileImages(){};
   ~ITKToolsTileImages(){};
 
-  /** Run function. */
+  /** Run function.
+   * The layout of the output is computed from the headers of the inputs.
+   * The output is allocated once, and the inputs are then read, in
+   * parallel, directly into their region of the output; only the inputs
+   * being read are in memory besides the output.
+   */
   void Run( void )
   {
   /** Some typedef's. */
     typedef itk::Image<TComponentType, VDimension>      ImageType;
     typedef itk::ImageFileReader<ImageType>             ImageReaderType;
-    typedef itk::TileImageFilter<ImageType, ImageType>  TilerType;
     typedef itk::ImageFileWriter<ImageType>             ImageWriterType;
+    typedef typename ImageType::RegionType              RegionType;
+    typedef typename ImageType::SizeType                SizeType;
+    typedef typename ImageType::IndexType               IndexType;
 
-    /** Copy layout into a fixed array. */
+    const std::size_t numberOfInputs = this->m_InputFileNames.size();
+    if( this->m_Layout.size() != VDimension )
+    {
+      itkGenericExceptionMacro( << "ERROR: the layout should have "
+        << VDimension << " values." );
+    }
+
+    /** Copy layout into a fixed array; the first 0 is computed to fit all
+     * inputs, as in itk::TileImageFilter, other 0's become 1. */
     itk::FixedArray< unsigned int, VDimension > Layout;
+    std::size_t numberOfFixedTiles = 1;
     for( unsigned int i = 0; i < VDimension; i++ )
     {
       Layout[ i ] = this->m_Layout[ i ];
+      if( Layout[ i ] > 0 ) numberOfFixedTiles *= Layout[ i ];
+    }
+    for( unsigned int i = 0; i < VDimension; i++ )
+    {
+      if( Layout[ i ] == 0 )
+      {
+        Layout[ i ] = static_cast<unsigned int>(
+          ( numberOfInputs + numberOfFixedTiles - 1 ) / numberOfFixedTiles );
+        numberOfFixedTiles *= Layout[ i ];
+      }
+    }
+    if( numberOfFixedTiles < numberOfInputs )
+    {
+      itkGenericExceptionMacro( << "ERROR: the layout has room for "
+        << numberOfFixedTiles << " images, but " << numberOfInputs << " are given." );
     }
 
-    /** Cast the defaultvalue. */
-    TComponentType defaultValue = static_cast<TComponentType>( this->m_Defaultvalue );
+    /** Read the headers only: the sizes, and the geometry of the first. */
+    std::vector<SizeType> sizes( numberOfInputs );
+    typename ImageType::Pointer tiledImage = ImageType::New();
+    for( std::size_t k = 0; k < numberOfInputs; ++k )
+    {
+      typename ImageReaderType::Pointer reader = ImageReaderType::New();
+      reader->SetFileName( this->m_InputFileNames[ k ].c_str() );
+      reader->UpdateOutputInformation();
+      sizes[ k ] = reader->GetOutput()->GetLargestPossibleRegion().GetSize();
+      if( k == 0 ) tiledImage->CopyInformation( reader->GetOutput() );
+    }
 
-    /** Create tiler. */
-    typename TilerType::Pointer tiler = TilerType::New();
-    tiler->SetLayout( Layout );
-    tiler->SetDefaultPixelValue( defaultValue );
+    /** The grid position of every input, dimension 0 fastest, and the
+     * extent of every row of the grid: the largest input in it. */
+    std::vector< std::vector<unsigned int> > positions( numberOfInputs,
+      std::vector<unsigned int>( VDimension ) );
+    std::vector< std::vector<itk::SizeValueType> > offsets( VDimension );
+    SizeType outputSize;
+    for( unsigned int i = 0; i < VDimension; i++ )
+    {
+      std::vector<itk::SizeValueType> extents( Layout[ i ], 0 );
+      for( std::size_t k = 0; k < numberOfInputs; ++k )
+      {
+        std::size_t stride = 1;
+        for( unsigned int j = 0; j < i; j++ ) stride *= Layout[ j ];
+        positions[ k ][ i ] = static_cast<unsigned int>( ( k / stride ) % Layout[ i ] );
+        extents[ positions[ k ][ i ] ]
+          = std::max( extents[ positions[ k ][ i ] ], sizes[ k ][ i ] );
+      }
+      offsets[ i ].assign( Layout[ i ] + 1, 0 );
+      for( unsigned int j = 0; j < Layout[ i ]; j++ )
+      {
+        offsets[ i ][ j + 1 ] = offsets[ i ][ j ] + extents[ j ];
+      }
+      outputSize[ i ] = offsets[ i ][ Layout[ i ] ];
+    }
 
-    /** Read input images and set it into the tiler. */
-    for( unsigned int i = 0; i < this->m_InputFileNames.size(); i++ )
+    /** The destination region of every input. */
+    std::vector<RegionType> destinationRegions( numberOfInputs );
+    for( std::size_t k = 0; k < numberOfInputs; ++k )
     {
-      typename ImageReaderType::Pointer reader = ImageReaderType::New();
-      reader->SetFileName( this->m_InputFileNames[ i ].c_str() );
-      reader->Update();
-      tiler->SetInput( i, reader->GetOutput() );
+      IndexType index;
+      for( unsigned int i = 0; i < VDimension; i++ )
+      {
+        index[ i ] = offsets[ i ][ positions[ k ][ i ] ];
+      }
+      destinationRegions[ k ] = RegionType( index, sizes[ k ] );
     }
 
+    /** Allocate the output, filled with the default value. */
+    IndexType outputIndex;
+    outputIndex.Fill( 0 );
+    tiledImage->SetRegions( RegionType( outputIndex, outputSize ) );
+    tiledImage->Allocate();
+    tiledImage->FillBuffer( static_cast<TComponentType>( this->m_Defaultvalue ) );
+
+    /** Read the inputs into place. */
+    ReadTilesIntoImage< ImageType >( this->m_InputFileNames,
+      destinationRegions, tiledImage.GetPointer(), this->m_NumberOfJobs > 0
+      ? this->m_NumberOfJobs : itk::MultiThreader::GetGlobalDefaultNumberOfThreads() );
+
     /** Write to disk. */
     typename ImageWriterType::Pointer writer = ImageWriterType::New();
     writer->SetFileName( this->m_OutputFileName.c_str() );
-    writer->SetInput( tiler->GetOutput() );
+    writer->SetInput( tiledImage );
     writer->Update();
 
   }// end Run()
@@ -20,8 +20,9 @@
 
 #include "ITKToolsBase.h"
 
-#include "itkImageSeriesReader.h"
+#include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
+#include "TileImagesReader.h"
 
 
 /** \class TileImages2D3DBase
@@ -38,6 +39,7 @@ public:
   {
     this->m_OutputFileName = "";
     this->m_Zspacing = 1.0;
+    this->m_NumberOfJobs = 0;
   };
   /** Destructor. */
   ~ITKToolsTileImages2D3DBase(){};
@@ -46,6 +48,130 @@ public:
   std::vector<std::string> m_InputFileNames;
   std::string m_OutputFileName;
   double m_Zspacing;
+  unsigned int m_NumberOfJobs; // 0: the number of threads
+
+}; // end class ITKToolsTileImages2D3DBase
+
+
+/** \class ITKToolsTileImages2D3D
+ *
+ * Templated class that implements the Run() function
+ * and the New() function for its creation.
+ */
+
+template< class TComponentType >
+class ITKToolsTileImages2D3D : public ITKToolsTileImages2D3DBase
+{
+public:
+  /** Standard ITKTools stuff. */
+  typedef ITKToolsTileImages2D3D Self;
+
+  static Self * New( itk::ImageIOBase::IOComponentType componentType )
+  {
+    if( itktools::IsType<TComponentType>( componentType ) )
+    {
+      return new Self;
+    }
+    return 0;
+  }
+
+  ITKToolsTileImages2D3D(){};
+  ~ITKToolsTileImages2D3D(){};
+
+  /** Run function.
+   * The size and geometry of the stack are computed from the headers of
+   * the slices. The volume is allocated once, and the slices are then read,
+   * in parallel, directly into their slice of the volume.
+   */
+  void Run( void )
+  {
+    /** Define image type. */
+    const unsigned int Dimension = 3;
+
+    /** Some typedef's. */
+    typedef itk::Image<TComponentType, Dimension>       ImageType;
+    typedef typename ImageType::SpacingType             SpacingType;
+    typedef typename ImageType::PointType               PointType;
+    typedef typename ImageType::RegionType              RegionType;
+    typedef typename ImageType::SizeType                SizeType;
+    typedef typename ImageType::IndexType               IndexType;
+    typedef itk::ImageFileReader<ImageType>             ImageReaderType;
+    typedef itk::ImageFileWriter<ImageType>             ImageWriterType;
+
+    /** Read the headers of the slices only. A 2D slice is read as a 3D
+     * image of one slice. */
+    const std::size_t numberOfSlices = this->m_InputFileNames.size();
+    typename ImageType::Pointer tiledImage = ImageType::New();
+    SizeType sliceSize;
+    PointType firstOrigin, lastOrigin;
+    for( std::size_t k = 0; k < numberOfSlices; ++k )
+    {
+      typename ImageReaderType::Pointer reader = ImageReaderType::New();
+      reader->SetFileName( this->m_InputFileNames[ k ].c_str() );
+      reader->UpdateOutputInformation();
+      const SizeType size = reader->GetOutput()->GetLargestPossibleRegion().GetSize();
+      if( k == 0 )
+      {
+        tiledImage->CopyInformation( reader->GetOutput() );
+        sliceSize = size;
+        firstOrigin = reader->GetOutput()->GetOrigin();
+      }
+      else if( size != sliceSize )
+      {
+        itkGenericExceptionMacro( << "ERROR: the size of " << this->m_InputFileNames[ k ]
+          << " differs from the size of " << this->m_InputFileNames[ 0 ] << "." );
+      }
+      if( size[ 2 ] != 1 )
+      {
+        itkGenericExceptionMacro( << "ERROR: " << this->m_InputFileNames[ k ]
+          << " is not a 2D image." );
+      }
+      if( k + 1 == numberOfSlices ) lastOrigin = reader->GetOutput()->GetOrigin();
+    }
+
+    /** The spacing between the slices: set by the user, or the distance
+     * between the origins of the slices, as the series reader does, or 1.0. */
+    SpacingType spacing = tiledImage->GetSpacing();
+    if( this->m_Zspacing > 0.0 )
+    {
+      spacing[ 2 ] = this->m_Zspacing;
+    }
+    else
+    {
+      const double distance = firstOrigin.EuclideanDistanceTo( lastOrigin )
+        / static_cast<double>( numberOfSlices - 1 );
+      spacing[ 2 ] = distance > 0.0 ? distance : 1.0;
+    }
+    tiledImage->SetSpacing( spacing );
+
+    /** Allocate the volume, and the slice of every input. */
+    SizeType outputSize = sliceSize;
+    outputSize[ 2 ] = numberOfSlices;
+    IndexType outputIndex;
+    outputIndex.Fill( 0 );
+    tiledImage->SetRegions( RegionType( outputIndex, outputSize ) );
+    tiledImage->Allocate();
+
+    std::vector<RegionType> destinationRegions( numberOfSlices );
+    for( std::size_t k = 0; k < numberOfSlices; ++k )
+    {
+      IndexType index = outputIndex;
+      index[ 2 ] = k;
+      destinationRegions[ k ] = RegionType( index, sliceSize );
+    }
+
+    /** Read the slices into place. */
+    ReadTilesIntoImage< ImageType >( this->m_InputFileNames,
+      destinationRegions, tiledImage.GetPointer(), this->m_NumberOfJobs > 0
+      ? this->m_NumberOfJobs : itk::MultiThreader::GetGlobalDefaultNumberOfThreads() );
+
+    /** Write to disk. */
+    typename ImageWriterType::Pointer writer = ImageWriterType::New();
+    writer->SetFileName( this->m_OutputFileName.c_str() );
+    writer->SetInput( tiledImage );
+    writer->Update();
+
+  } // end Run()
 
 }; // end class ITKToolsTileImages2D3DBase
 
@@ -0,0 +1,151 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __TileImagesReader_h_
+#define __TileImagesReader_h_
+
+#include "itkImageFileReader.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
+
+#include <string>
+#include <vector>
+
+
+/**
+ * ******************* TileReadStruct *******************
+ * The shared work queue of the tile reading: the next input to read.
+ */
+
+template< class TImage >
+struct TileReadStruct
+{
+  typedef typename TImage::RegionType RegionType;
+
+  const std::vector<std::string> *  m_FileNames;
+  const std::vector<RegionType> *   m_DestinationRegions;
+  TImage *                          m_Output;
+  std::vector<std::string> *        m_ErrorMessages;
+  std::size_t                       m_NextInput;
+  itk::SimpleFastMutexLock          m_Lock;
+};
+
+
+/**
+ * ******************* TileReadThreaderCallback *******************
+ * Every job takes the next input from the queue, reads it and copies it
+ * to its destination region, until the queue is empty. An input is
+ * released as soon as it is copied.
+ */
+
+template< class TImage >
+ITK_THREAD_RETURN_TYPE TileReadThreaderCallback( void * arg )
+{
+  typedef itk::ImageFileReader< TImage >            ReaderType;
+  typedef itk::ImageRegionConstIterator< TImage >   InputIteratorType;
+  typedef itk::ImageRegionIterator< TImage >        OutputIteratorType;
+
+  itk::MultiThreader::ThreadInfoStruct * info
+    = static_cast<itk::MultiThreader::ThreadInfoStruct *>( arg );
+  TileReadStruct< TImage > * data
+    = static_cast<TileReadStruct< TImage > *>( info->UserData );
+
+  const std::size_t n = data->m_FileNames->size();
+  while( true )
+  {
+    data->m_Lock.Lock();
+    const std::size_t k = data->m_NextInput++;
+    data->m_Lock.Unlock();
+    if( k >= n ) break;
+
+    const std::string & fileName = ( *data->m_FileNames )[ k ];
+    const typename TImage::RegionType & destination = ( *data->m_DestinationRegions )[ k ];
+    try
+    {
+      typename ReaderType::Pointer reader = ReaderType::New();
+      reader->SetFileName( fileName.c_str() );
+      reader->Update();
+      const TImage * input = reader->GetOutput();
+      const typename TImage::RegionType & source = input->GetLargestPossibleRegion();
+      if( source.GetSize() != destination.GetSize() )
+      {
+        itkGenericExceptionMacro( << "The size of " << fileName
+          << " differs from the size in its header." );
+      }
+
+      InputIteratorType it( input, source );
+      OutputIteratorType ot( data->m_Output, destination );
+      for( ; !it.IsAtEnd(); ++it, ++ot )
+      {
+        ot.Set( it.Get() );
+      }
+    }
+    catch( itk::ExceptionObject & excp )
+    {
+      ( *data->m_ErrorMessages )[ k ] = excp.GetDescription();
+    }
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end TileReadThreaderCallback()
+
+
+/**
+ * ******************* ReadTilesIntoImage *******************
+ * Read the inputs directly into their destination regions of the
+ * allocated output, with at most numberOfJobs inputs read concurrently.
+ */
+
+template< class TImage >
+void ReadTilesIntoImage(
+  const std::vector<std::string> & fileNames,
+  const std::vector<typename TImage::RegionType> & destinationRegions,
+  TImage * output, unsigned int numberOfJobs )
+{
+  std::vector<std::string> errorMessages( fileNames.size(), "" );
+  TileReadStruct< TImage > data;
+  data.m_FileNames = &fileNames;
+  data.m_DestinationRegions = &destinationRegions;
+  data.m_Output = output;
+  data.m_ErrorMessages = &errorMessages;
+  data.m_NextInput = 0;
+
+  if( numberOfJobs > fileNames.size() )
+  {
+    numberOfJobs = static_cast<unsigned int>( fileNames.size() );
+  }
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads( numberOfJobs > 0 ? numberOfJobs : 1 );
+  threader->SetSingleMethod( TileReadThreaderCallback< TImage >, &data );
+  threader->SingleMethodExecute();
+
+  for( std::size_t k = 0; k < fileNames.size(); ++k )
+  {
+    if( errorMessages[ k ] != "" )
+    {
+      itkGenericExceptionMacro( << "ERROR: could not read " << fileNames[ k ]
+        << ": " << errorMessages[ k ] );
+    }
+  }
+
+} // end ReadTilesIntoImage()
+
+
+#endif // end #ifndef __TileImagesReader_h_
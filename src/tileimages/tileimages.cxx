@@ -19,7 +19,7 @@
  \brief Either tiles a stack of 2D images into a 3D image, or tiles nD images to form another nD image.
 
  This program tiles a stacks of 2D images into a 3D image.
- This is done by employing an itk::SeriesFileReader.
+ The slices are read in parallel directly into their place in the 3D image.
  \verbinclude tileimages.help
  */
 
@@ -43,11 +43,10 @@ std::string GetHelpString( void )
     << "pxtileimages EITHER tiles a stack of 2D images into a 3D image,\n"
     << "OR tiles nD images to form another nD image.\n"
     << "In the last case the way to tile is specified by a layout.\n"
-    << "To stack a pile of 2D images an itk::SeriesFileReader is employed.\n"
     << "If no layout is specified with \"-ly\" 2D-3D tiling is done,\n"
     << "otherwise 2D-2D or 3D-3D tiling is performed.\n"
     << "Usage:  \npxtileimages\n"
-    << "  -in      input image filenames, at least 2\n"
+    << "  -in      input image filenames, at least 2; use @file to read them from a manifest\n"
     << "  -out     output image filename\n"
     << "  [-pt]    pixel type of input and output images\n"
     << "           default: automatically determined from the first input image\n"
@@ -61,6 +60,9 @@ std::string GetHelpString( void )
     << "           example: in 2D for 4 images \"-ly 4 1\" (or \"-ly 0 1\") results in\n"
     << "             im1 im2 im3 im4\n"
     << "  [-d]     default value, by default 0.\n"
+    << "  [-jobs]  the number of images read concurrently, by default the number of threads.\n"
+    << "The output layout is computed from the image headers; the inputs are then\n"
+    << "read one by one directly into their place in the output.\n"
     << "Supported pixel types: (unsigned) char, (unsigned) short, float.";
 
   return ss.str();
@@ -103,6 +105,9 @@ int main( int argc, char ** argv )
     return EXIT_FAILURE;
   }
 
+  /** Read the headers of all inputs before processing starts. */
+  if( !itktools::ValidateImageHeaders( inputFileNames ) ) return EXIT_FAILURE;
+
   /** Get the outputFileName. */
   std::string outputFileName = "";
   parser->GetCommandLineArgument( "-out", outputFileName );
@@ -119,6 +124,10 @@ int main( int argc, char ** argv )
   double defaultvalue = 0.0;
   parser->GetCommandLineArgument( "-d", defaultvalue );
 
+  /** Get the number of concurrent reads. */
+  unsigned int numberOfJobs = 0;
+  parser->GetCommandLineArgument( "-jobs", numberOfJobs );
+
   /** Determine image properties. */
   itk::ImageIOBase::IOPixelType pixelType = itk::ImageIOBase::UNKNOWNPIXELTYPE;
   itk::ImageIOBase::IOComponentType componentType = itk::ImageIOBase::UNKNOWNCOMPONENTTYPE;
@@ -163,7 +172,9 @@ int main( int argc, char ** argv )
       filterTile2D3D->m_InputFileNames = inputFileNames;
       filterTile2D3D->m_OutputFileName = outputFileName;
       filterTile2D3D->m_Zspacing = zspacing;
+      filterTile2D3D->m_NumberOfJobs = numberOfJobs;
 
+      filterTile2D3D->ReadCommonArguments( parser );
       filterTile2D3D->Run();
 
       delete filterTile2D3D;
@@ -205,7 +216,9 @@ int main( int argc, char ** argv )
       filter->m_OutputFileName = outputFileName;
       filter->m_Layout = layout;
       filter->m_Defaultvalue = defaultvalue;
+      filter->m_NumberOfJobs = numberOfJobs;
 
+      filter->ReadCommonArguments( parser );
       filter->Run();
 
       delete filter;
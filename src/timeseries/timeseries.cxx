@@ -0,0 +1,180 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+/** \file
+ \brief Process a 4D image frame by frame.
+
+ \verbinclude timeseries.help
+ */
+
+/** Setup Mevislab DicomTiff IO support */
+#include "itkUseMevisDicomTiff.h"
+
+#include "itkCommandLineArgumentParser.h"
+#include "ITKToolsHelpers.h"
+#include "timeseries.h"
+
+
+/**
+ * ******************* GetHelpString *******************
+ */
+
+std::string GetHelpString( void )
+{
+  std::stringstream ss;
+  ss << "ITKTools v" << itktools::GetITKToolsVersion() << "\n"
+    << "This program processes a 4D image one 3D frame at a time.\n"
+    << "Usage:\n"
+    << "pxtimeseries\n"
+    << "  -in          inputFilename, the last dimension is time\n"
+    << "  [-outmean]   outputFilename for the temporal mean image; always written as float\n"
+    << "  [-outstd]    outputFilename for the temporal standard deviation image; always written as float\n"
+    << "  [-outframes] outputFilename for the frames; frame t is written to <name>_T<t>.<ext>\n"
+    << "  [-out]       outputFilename for the 4D image of the processed frames\n"
+    << "  [-stats]     print the minimum, maximum, mean and std of every frame\n"
+    << "  [-frames]    the frames to process, in this order; default all\n"
+    << "  [-sigma]     smooth every frame with a Gaussian of this sigma (mm) first\n"
+    << "  [-popstd]    population standard deviation flag; if provided, use population standard deviation\n"
+    << "               rather than sample standard deviation (divide by N instead of N-1)\n"
+    << "  [-z]         compression flag; if provided, the 3D outputs are compressed\n"
+    << "At least one of -outmean, -outstd, -outframes, -out and -stats should be given.\n"
+    << "Only one frame is read at a time, while the previous frame is processed;\n"
+    << "this requires an input format that supports streaming, like uncompressed mhd,\n"
+    << "otherwise the input is read as a whole. The -out image is written frame by\n"
+    << "frame, which requires an output format that supports streaming as well.\n"
+    << "Supported: 4D, (unsigned) char, (unsigned) short, float, double.";
+
+  return ss.str();
+
+} // end GetHelpString()
+
+
+//-------------------------------------------------------------------------------------
+
+int main( int argc, char **argv )
+{
+  RegisterMevisDicomTiff();
+
+  /** Create a command line argument parser. */
+  itk::CommandLineArgumentParser::Pointer parser = itk::CommandLineArgumentParser::New();
+  parser->SetCommandLineArguments( argc, argv );
+  parser->SetProgramHelpText( GetHelpString() );
+
+  parser->MarkArgumentAsRequired( "-in", "The input filename." );
+
+  itk::CommandLineArgumentParser::ReturnValue validateArguments = parser->CheckForRequiredArguments();
+
+  if( validateArguments == itk::CommandLineArgumentParser::FAILED )
+  {
+    return EXIT_FAILURE;
+  }
+  else if( validateArguments == itk::CommandLineArgumentParser::HELPREQUESTED )
+  {
+    return EXIT_SUCCESS;
+  }
+
+  /** Get arguments. */
+  std::string inputFileName = "";
+  parser->GetCommandLineArgument( "-in", inputFileName );
+
+  std::string outputFileName = "";
+  parser->GetCommandLineArgument( "-out", outputFileName );
+
+  std::string outputFileNameMean = "";
+  parser->GetCommandLineArgument( "-outmean", outputFileNameMean );
+
+  std::string outputFileNameStd = "";
+  parser->GetCommandLineArgument( "-outstd", outputFileNameStd );
+
+  std::string outputFileNameFrames = "";
+  parser->GetCommandLineArgument( "-outframes", outputFileNameFrames );
+
+  std::vector<unsigned int> frames;
+  parser->GetCommandLineArgument( "-frames", frames );
+
+  double sigma = 0.0;
+  parser->GetCommandLineArgument( "-sigma", sigma );
+
+  const bool printStatistics = parser->ArgumentExists( "-stats" );
+  const bool usePopulationStd = parser->ArgumentExists( "-popstd" );
+  const bool useCompression = parser->ArgumentExists( "-z" );
+
+  if( outputFileName == "" && outputFileNameMean == "" && outputFileNameStd == ""
+    && outputFileNameFrames == "" && !printStatistics )
+  {
+    std::cerr << "ERROR: At least one of -outmean, -outstd, -outframes, -out and -stats should be given." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  /** Determine image properties. */
+  itk::ImageIOBase::IOPixelType pixelType = itk::ImageIOBase::UNKNOWNPIXELTYPE;
+  itk::ImageIOBase::IOComponentType componentType = itk::ImageIOBase::UNKNOWNCOMPONENTTYPE;
+  unsigned int dim = 0;
+  unsigned int numberOfComponents = 0;
+  bool retgip = itktools::GetImageProperties(
+    inputFileName, pixelType, componentType, dim, numberOfComponents );
+  if( !retgip ) return EXIT_FAILURE;
+
+  /** Check for vector images. */
+  bool retNOCCheck = itktools::NumberOfComponentsCheck( numberOfComponents );
+  if( !retNOCCheck ) return EXIT_FAILURE;
+
+  /** Class that does the work. */
+  ITKToolsTimeSeriesBase * filter = 0;
+
+  try
+  {
+    // now call all possible template combinations.
+    if( !filter ) filter = ITKToolsTimeSeries< 4, char >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsTimeSeries< 4, unsigned char >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsTimeSeries< 4, short >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsTimeSeries< 4, unsigned short >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsTimeSeries< 4, float >::New( dim, componentType );
+    if( !filter ) filter = ITKToolsTimeSeries< 4, double >::New( dim, componentType );
+
+    /** Check if filter was instantiated. */
+    bool supported = itktools::IsFilterSupportedCheck( filter, dim, componentType );
+    if( !supported ) return EXIT_FAILURE;
+
+    /** Set the filter arguments. */
+    filter->m_InputFileName = inputFileName;
+    filter->m_OutputFileName = outputFileName;
+    filter->m_OutputFileNameMean = outputFileNameMean;
+    filter->m_OutputFileNameStd = outputFileNameStd;
+    filter->m_OutputFileNameFrames = outputFileNameFrames;
+    filter->m_Frames = frames;
+    filter->m_Sigma = sigma;
+    filter->m_PrintStatistics = printStatistics;
+    filter->m_UsePopulationStd = usePopulationStd;
+    filter->m_UseCompression = useCompression;
+
+    filter->ReadCommonArguments( parser );
+    filter->Run();
+
+    delete filter;
+  }
+  catch( itk::ExceptionObject & excp )
+  {
+    std::cerr << "ERROR: Caught ITK exception: " << excp << std::endl;
+    delete filter;
+    return EXIT_FAILURE;
+  }
+
+  /** End program. */
+  return EXIT_SUCCESS;
+
+} // end main
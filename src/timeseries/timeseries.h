@@ -0,0 +1,169 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __timeseries_h_
+#define __timeseries_h_
+
+#include "ITKToolsBase.h"
+
+#include "itkImage.h"
+#include "itkImageFileReader.h"
+#include "itkMultiThreader.h"
+#include <string>
+#include <vector>
+
+
+/** \class ITKToolsTimeSeriesBase
+ *
+ * Untemplated pure virtual base class that holds
+ * the Run() function and all required parameters.
+ */
+
+class ITKToolsTimeSeriesBase : public itktools::ITKToolsBase
+{
+public:
+  /** Constructor. */
+  ITKToolsTimeSeriesBase()
+  {
+    this->m_InputFileName = "";
+    this->m_OutputFileName = "";
+    this->m_OutputFileNameMean = "";
+    this->m_OutputFileNameStd = "";
+    this->m_OutputFileNameFrames = "";
+    this->m_Frames = std::vector<unsigned int>();
+    this->m_Sigma = 0.0;
+    this->m_PrintStatistics = false;
+    this->m_UsePopulationStd = false;
+    this->m_UseCompression = false;
+  };
+  /** Destructor. */
+  ~ITKToolsTimeSeriesBase(){};
+
+  /** Input member parameters. */
+  std::string               m_InputFileName;
+  std::string               m_OutputFileName;
+  std::string               m_OutputFileNameMean;
+  std::string               m_OutputFileNameStd;
+  std::string               m_OutputFileNameFrames;
+  std::vector<unsigned int> m_Frames;
+  double                    m_Sigma;
+  bool                      m_PrintStatistics;
+  bool                      m_UsePopulationStd;
+  bool                      m_UseCompression;
+
+}; // end class ITKToolsTimeSeriesBase
+
+
+/** \class ITKToolsTimeSeries
+ *
+ * Templated class that implements the Run() function
+ * and the New() function for its creation.
+ *
+ * The last dimension of the input is time. The frames, the images of
+ * one dimension less, are read one at a time, while the previous frame
+ * is processed, so that only two frames and the temporal accumulators
+ * are in memory, regardless of the number of frames.
+ */
+
+template< unsigned int VDimension, class TComponentType >
+class ITKToolsTimeSeries : public ITKToolsTimeSeriesBase
+{
+public:
+  /** Standard ITKTools stuff. */
+  typedef ITKToolsTimeSeries Self;
+  itktoolsOneTypeNewMacro( Self );
+
+  ITKToolsTimeSeries(){};
+  ~ITKToolsTimeSeries(){};
+
+  /** Typedef. */
+  itkStaticConstMacro( FrameDimension, unsigned int, VDimension - 1 );
+  typedef itk::Image< TComponentType, VDimension >        InputImageType;
+  typedef itk::Image< TComponentType, FrameDimension >    FrameImageType;
+  typedef itk::Image< float, FrameDimension >             OutputImageType;
+  typedef typename InputImageType::Pointer                InputImagePointer;
+  typedef typename InputImageType::RegionType             RegionType;
+  typedef typename FrameImageType::Pointer                FramePointer;
+  typedef itk::ImageFileReader< InputImageType >          ReaderType;
+
+  /** Run function. */
+  void Run( void );
+
+protected:
+
+  /** The arguments of the thread that reads the next frame. */
+  struct ReadStruct
+  {
+    const Self *  m_Tool;
+    unsigned int  m_Frame;
+    FramePointer  m_Image;
+    std::string   m_ErrorMessage;
+  };
+
+  /** The statistics of (a part of) one frame. */
+  struct StatisticsStruct
+  {
+    double m_Count;
+    double m_Minimum;
+    double m_Maximum;
+    double m_Mean;
+    double m_SumOfSquaredDeviations;
+  };
+
+  /** The arguments of the threads that accumulate one frame. */
+  struct AccumulateStruct
+  {
+    const TComponentType *          m_Input;
+    std::size_t                     m_NumberOfPixels;
+    double                          m_NumberOfFrames;
+    double *                        m_Mean;
+    double *                        m_SumOfSquaredDeviations;
+    std::vector<StatisticsStruct> * m_Statistics;
+  };
+
+  /** Read one frame. Only its part of the file is read, if the image
+   * format supports streaming; otherwise from m_FullImage. */
+  FramePointer ReadFrame( const unsigned int frame ) const;
+
+  /** Smooth a frame, if requested. */
+  FramePointer FilterFrame( FrameImageType * frame ) const;
+
+  /** Paste a frame into the 4D output file. */
+  void WriteFrame( FrameImageType * image, const unsigned int position ) const;
+
+  /** Write a 3D image. */
+  template< class TImage >
+  void WriteImage( TImage * image, const std::string & fileName ) const;
+
+  /** Combine the statistics of two parts of a frame. */
+  static void MergeStatistics( StatisticsStruct & total, const StatisticsStruct & part );
+
+  /** Thread callbacks. */
+  static ITK_THREAD_RETURN_TYPE ReadThreaderCallback( void * arg );
+  static ITK_THREAD_RETURN_TYPE AccumulateThreaderCallback( void * arg );
+
+  /** The geometry of the input, and the input itself if it can not be
+   * read frame by frame. */
+  typename ReaderType::Pointer  m_Reader;
+  RegionType                    m_InputRegion;
+  InputImagePointer             m_FullImage;
+
+}; // end class ITKToolsTimeSeries
+
+#include "timeseries.hxx"
+
+#endif // end #ifndef __timeseries_h_
@@ -0,0 +1,518 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __timeseries_hxx_
+#define __timeseries_hxx_
+
+#include "itkImageFileWriter.h"
+#include "itkImageRegionIterator.h"
+#include "itkMultiThreader.h"
+#include "itkSmoothingRecursiveGaussianImageFilter.h"
+#include <itksys/SystemTools.hxx>
+#include <algorithm>
+#include <iomanip>
+
+
+/**
+ * ******************* ReadThreaderCallback *******************
+ *
+ * Reads the next frame on a background thread.
+ */
+
+template< unsigned int VDimension, class TComponentType >
+ITK_THREAD_RETURN_TYPE
+ITKToolsTimeSeries< VDimension, TComponentType >
+::ReadThreaderCallback( void * arg )
+{
+  itk::MultiThreader::ThreadInfoStruct * info
+    = static_cast<itk::MultiThreader::ThreadInfoStruct *>( arg );
+  ReadStruct * data = static_cast<ReadStruct *>( info->UserData );
+
+  try
+  {
+    data->m_Image = data->m_Tool->ReadFrame( data->m_Frame );
+  }
+  catch( itk::ExceptionObject & excp )
+  {
+    data->m_ErrorMessage = excp.GetDescription();
+  }
+  catch( std::exception & excp )
+  {
+    data->m_ErrorMessage = excp.what();
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end ReadThreaderCallback()
+
+
+/**
+ * ******************* ReadFrame *******************
+ *
+ * A frame spans the full image in all but the last dimension, so it is
+ * contiguous in the buffer of an image that contains it. When only the
+ * frame is read, the frame image shares the buffer of the reader.
+ */
+
+template< unsigned int VDimension, class TComponentType >
+typename ITKToolsTimeSeries< VDimension, TComponentType >::FramePointer
+ITKToolsTimeSeries< VDimension, TComponentType >
+::ReadFrame( const unsigned int frame ) const
+{
+  RegionType frameRegion = this->m_InputRegion;
+  frameRegion.SetIndex( FrameDimension, this->m_InputRegion.GetIndex()[ FrameDimension ] + frame );
+  frameRegion.SetSize( FrameDimension, 1 );
+
+  InputImagePointer image = this->m_FullImage;
+  if( image.IsNull() )
+  {
+    typename ReaderType::Pointer reader = ReaderType::New();
+    reader->SetFileName( this->m_InputFileName.c_str() );
+    reader->SetUseStreaming( true );
+    reader->UpdateOutputInformation();
+    reader->GetOutput()->SetRequestedRegion( frameRegion );
+    reader->Update();
+    image = reader->GetOutput();
+    image->DisconnectPipeline();
+  }
+
+  /** The geometry of the frame is that of the first dimensions. */
+  typename FrameImageType::RegionType region;
+  typename FrameImageType::SpacingType spacing;
+  typename FrameImageType::PointType origin;
+  typename FrameImageType::DirectionType direction;
+  for( unsigned int d = 0; d < FrameDimension; ++d )
+  {
+    region.SetIndex( d, frameRegion.GetIndex()[ d ] );
+    region.SetSize( d, frameRegion.GetSize()[ d ] );
+    spacing[ d ] = image->GetSpacing()[ d ];
+    origin[ d ] = image->GetOrigin()[ d ];
+    for( unsigned int e = 0; e < FrameDimension; ++e )
+    {
+      direction[ d ][ e ] = image->GetDirection()[ d ][ e ];
+    }
+  }
+
+  FramePointer frameImage = FrameImageType::New();
+  frameImage->SetRegions( region );
+  frameImage->SetSpacing( spacing );
+  frameImage->SetOrigin( origin );
+  frameImage->SetDirection( direction );
+
+  const RegionType & buffered = image->GetBufferedRegion();
+  bool contiguous = buffered.IsInside( frameRegion );
+  for( unsigned int d = 0; d < FrameDimension; ++d )
+  {
+    contiguous &= buffered.GetSize()[ d ] == frameRegion.GetSize()[ d ];
+  }
+  if( !contiguous )
+  {
+    itkGenericExceptionMacro( << "ERROR: frame " << frame << " of "
+      << this->m_InputFileName << " could not be read." );
+  }
+
+  if( buffered == frameRegion )
+  {
+    frameImage->SetPixelContainer( image->GetPixelContainer() );
+  }
+  else
+  {
+    frameImage->Allocate();
+    const TComponentType * source
+      = image->GetBufferPointer() + image->ComputeOffset( frameRegion.GetIndex() );
+    std::copy( source, source + region.GetNumberOfPixels(), frameImage->GetBufferPointer() );
+  }
+
+  return frameImage;
+
+} // end ReadFrame()
+
+
+/**
+ * ******************* FilterFrame *******************
+ */
+
+template< unsigned int VDimension, class TComponentType >
+typename ITKToolsTimeSeries< VDimension, TComponentType >::FramePointer
+ITKToolsTimeSeries< VDimension, TComponentType >
+::FilterFrame( FrameImageType * frame ) const
+{
+  typedef itk::SmoothingRecursiveGaussianImageFilter<
+    FrameImageType, FrameImageType >                    SmootherType;
+
+  if( this->m_Sigma <= 0.0 ) return frame;
+
+  typename SmootherType::Pointer smoother = SmootherType::New();
+  smoother->SetInput( frame );
+  smoother->SetSigma( this->m_Sigma );
+  smoother->Update();
+  FramePointer output = smoother->GetOutput();
+  output->DisconnectPipeline();
+  return output;
+
+} // end FilterFrame()
+
+
+/**
+ * ******************* WriteFrame *******************
+ *
+ * The frame is pasted at its position into the output file, without
+ * copying, by wrapping its buffer in an image of the full dimension.
+ */
+
+template< unsigned int VDimension, class TComponentType >
+void
+ITKToolsTimeSeries< VDimension, TComponentType >
+::WriteFrame( FrameImageType * image, const unsigned int position ) const
+{
+  typedef itk::ImageFileWriter< InputImageType >        WriterType;
+
+  RegionType outputRegion = this->m_InputRegion;
+  outputRegion.SetSize( FrameDimension, this->m_Frames.size() );
+  RegionType frameRegion = outputRegion;
+  frameRegion.SetIndex( FrameDimension, outputRegion.GetIndex()[ FrameDimension ] + position );
+  frameRegion.SetSize( FrameDimension, 1 );
+
+  InputImagePointer output = InputImageType::New();
+  output->CopyInformation( this->m_Reader->GetOutput() );
+  output->SetLargestPossibleRegion( outputRegion );
+  output->SetBufferedRegion( frameRegion );
+  output->SetRequestedRegion( frameRegion );
+  output->SetPixelContainer( image->GetPixelContainer() );
+
+  itk::ImageIORegion ioRegion( VDimension );
+  itk::ImageIORegionAdaptor< VDimension >::Convert(
+    frameRegion, ioRegion, outputRegion.GetIndex() );
+
+  typename WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName( this->m_OutputFileName.c_str() );
+  writer->SetInput( output );
+  writer->SetIORegion( ioRegion );
+  writer->Update();
+
+} // end WriteFrame()
+
+
+/**
+ * ******************* WriteImage *******************
+ */
+
+template< unsigned int VDimension, class TComponentType >
+template< class TImage >
+void
+ITKToolsTimeSeries< VDimension, TComponentType >
+::WriteImage( TImage * image, const std::string & fileName ) const
+{
+  typedef itk::ImageFileWriter< TImage >                WriterType;
+
+  typename WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName( fileName.c_str() );
+  writer->SetInput( image );
+  writer->SetUseCompression( this->m_UseCompression );
+  writer->Update();
+
+} // end WriteImage()
+
+
+/**
+ * ******************* MergeStatistics *******************
+ *
+ * Chan's formula for the mean and squared deviations of the union.
+ */
+
+template< unsigned int VDimension, class TComponentType >
+void
+ITKToolsTimeSeries< VDimension, TComponentType >
+::MergeStatistics( StatisticsStruct & total, const StatisticsStruct & part )
+{
+  if( part.m_Count == 0.0 ) return;
+
+  const double count = total.m_Count + part.m_Count;
+  const double delta = part.m_Mean - total.m_Mean;
+  total.m_Mean += delta * part.m_Count / count;
+  total.m_SumOfSquaredDeviations += part.m_SumOfSquaredDeviations
+    + delta * delta * total.m_Count * part.m_Count / count;
+  total.m_Count = count;
+  total.m_Minimum = std::min( total.m_Minimum, part.m_Minimum );
+  total.m_Maximum = std::max( total.m_Maximum, part.m_Maximum );
+
+} // end MergeStatistics()
+
+
+/**
+ * ******************* AccumulateThreaderCallback *******************
+ *
+ * Adds one frame to the temporal accumulators, with Welford's method,
+ * and computes the statistics of the frame. Every thread processes a
+ * contiguous part of the buffers.
+ */
+
+template< unsigned int VDimension, class TComponentType >
+ITK_THREAD_RETURN_TYPE
+ITKToolsTimeSeries< VDimension, TComponentType >
+::AccumulateThreaderCallback( void * arg )
+{
+  itk::MultiThreader::ThreadInfoStruct * info
+    = static_cast<itk::MultiThreader::ThreadInfoStruct *>( arg );
+  const AccumulateStruct * data = static_cast<AccumulateStruct *>( info->UserData );
+
+  const std::size_t begin = data->m_NumberOfPixels * info->ThreadID / info->NumberOfThreads;
+  const std::size_t end = data->m_NumberOfPixels * ( info->ThreadID + 1 ) / info->NumberOfThreads;
+  const TComponentType * input = data->m_Input;
+  double * mean = data->m_Mean;
+  double * sumOfSquaredDeviations = data->m_SumOfSquaredDeviations;
+  StatisticsStruct & statistics = ( *data->m_Statistics )[ info->ThreadID ];
+
+  for( std::size_t k = begin; k < end; ++k )
+  {
+    const double value = static_cast<double>( input[ k ] );
+    if( mean )
+    {
+      const double delta = value - mean[ k ];
+      mean[ k ] += delta / data->m_NumberOfFrames;
+      if( sumOfSquaredDeviations )
+      {
+        sumOfSquaredDeviations[ k ] += delta * ( value - mean[ k ] );
+      }
+    }
+
+    statistics.m_Count += 1.0;
+    const double delta = value - statistics.m_Mean;
+    statistics.m_Mean += delta / statistics.m_Count;
+    statistics.m_SumOfSquaredDeviations += delta * ( value - statistics.m_Mean );
+    statistics.m_Minimum = std::min( statistics.m_Minimum, value );
+    statistics.m_Maximum = std::max( statistics.m_Maximum, value );
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end AccumulateThreaderCallback()
+
+
+/**
+ * ******************* Run *******************
+ *
+ * The frames are processed in the order given. While a frame is
+ * processed, the next one is read on a background thread.
+ */
+
+template< unsigned int VDimension, class TComponentType >
+void
+ITKToolsTimeSeries< VDimension, TComponentType >
+::Run( void )
+{
+  /** Read the geometry of the input. If the file format supports
+   * streamed reading, the frames are read one by one. Otherwise the
+   * image is read once, as a whole.
+   */
+  this->m_Reader = ReaderType::New();
+  this->m_Reader->SetFileName( this->m_InputFileName.c_str() );
+  this->m_Reader->SetUseStreaming( true );
+  this->m_Reader->UpdateOutputInformation();
+  this->m_InputRegion = this->m_Reader->GetOutput()->GetLargestPossibleRegion();
+  const unsigned int numberOfFrames = this->m_InputRegion.GetSize()[ FrameDimension ];
+  if( !this->m_Reader->GetImageIO()->CanStreamRead() )
+  {
+    std::cerr << "WARNING: " << this->m_InputFileName
+      << " can not be read frame by frame, it is read as a whole." << std::endl;
+    this->m_Reader->Update();
+    this->m_FullImage = this->m_Reader->GetOutput();
+    this->m_FullImage->DisconnectPipeline();
+  }
+
+  /** By default all frames are processed. */
+  if( this->m_Frames.empty() )
+  {
+    for( unsigned int t = 0; t < numberOfFrames; ++t ) this->m_Frames.push_back( t );
+  }
+  for( std::size_t i = 0; i < this->m_Frames.size(); ++i )
+  {
+    if( this->m_Frames[ i ] >= numberOfFrames )
+    {
+      itkGenericExceptionMacro( << "ERROR: frame " << this->m_Frames[ i ]
+        << " does not exist, the input has " << numberOfFrames << " frames." );
+    }
+  }
+
+  const bool calc_mean = this->m_OutputFileNameMean != "";
+  const bool calc_std = this->m_OutputFileNameStd != "";
+  const bool writeFrames = this->m_OutputFileNameFrames != "";
+  const bool writeOutput = this->m_OutputFileName != "";
+  if( writeOutput && this->m_UseCompression )
+  {
+    itkGenericExceptionMacro( << "ERROR: compression can not be combined with -out." );
+  }
+
+  /** The output is pasted frame by frame into a new file. */
+  if( writeOutput ) itksys::SystemTools::RemoveFile( this->m_OutputFileName.c_str() );
+
+  /** The frame files get the frame number before the extension. */
+  const std::string::size_type dot = this->m_OutputFileNameFrames.rfind( "." );
+  const std::string base = this->m_OutputFileNameFrames.substr( 0, dot );
+  const std::string extension = dot == std::string::npos
+    ? std::string( ".mhd" ) : this->m_OutputFileNameFrames.substr( dot );
+
+  /** Read the first frame. */
+  const unsigned int nrFrames = this->m_Frames.size();
+  std::cout << "Reading frame " << this->m_Frames[ 0 ] << std::endl;
+  FramePointer image = this->ReadFrame( this->m_Frames[ 0 ] );
+
+  /** The geometry of the outputs, without a buffer. */
+  typename OutputImageType::Pointer meanImage = OutputImageType::New();
+  typename OutputImageType::Pointer stdImage = OutputImageType::New();
+  meanImage->CopyInformation( image );
+  stdImage->CopyInformation( image );
+  meanImage->SetRegions( image->GetLargestPossibleRegion() );
+  stdImage->SetRegions( image->GetLargestPossibleRegion() );
+
+  /** The temporal accumulators. */
+  const std::size_t numberOfPixels = image->GetLargestPossibleRegion().GetNumberOfPixels();
+  std::vector<double> welfordMean( ( calc_mean || calc_std ) ? numberOfPixels : 0, 0.0 );
+  std::vector<double> welfordSumOfSquaredDeviations( calc_std ? numberOfPixels : 0, 0.0 );
+
+  itk::MultiThreader::Pointer accumulator = itk::MultiThreader::New();
+  itk::MultiThreader::Pointer prefetcher = itk::MultiThreader::New();
+  std::vector<StatisticsStruct> statistics( accumulator->GetNumberOfThreads() );
+
+  AccumulateStruct accumulate;
+  accumulate.m_NumberOfPixels = numberOfPixels;
+  accumulate.m_Mean = welfordMean.empty() ? 0 : &welfordMean[ 0 ];
+  accumulate.m_SumOfSquaredDeviations
+    = welfordSumOfSquaredDeviations.empty() ? 0 : &welfordSumOfSquaredDeviations[ 0 ];
+  accumulate.m_Statistics = &statistics;
+
+  if( this->m_PrintStatistics )
+  {
+    std::cout << "frame\tminimum\tmaximum\tmean\tstd" << std::endl;
+  }
+
+  for( unsigned int i = 0; i < nrFrames; ++i )
+  {
+    /** Start reading the next frame. */
+    ReadStruct next;
+    next.m_Tool = this;
+    int prefetchThread = -1;
+    if( i + 1 < nrFrames )
+    {
+      next.m_Frame = this->m_Frames[ i + 1 ];
+      std::cout << "Reading frame " << next.m_Frame << std::endl;
+      prefetchThread = prefetcher->SpawnThread( ReadThreaderCallback, &next );
+    }
+
+    /** Process the current frame. */
+    std::string errorMessage = "";
+    try
+    {
+      if( image->GetLargestPossibleRegion().GetNumberOfPixels() != numberOfPixels )
+      {
+        itkGenericExceptionMacro( << "ERROR: frame " << this->m_Frames[ i ]
+          << " differs in size from the first frame." );
+      }
+      FramePointer frame = this->FilterFrame( image );
+
+      /** Accumulate it, and compute its statistics. */
+      StatisticsStruct empty;
+      empty.m_Count = 0.0;
+      empty.m_Minimum = itk::NumericTraits<double>::max();
+      empty.m_Maximum = itk::NumericTraits<double>::NonpositiveMin();
+      empty.m_Mean = 0.0;
+      empty.m_SumOfSquaredDeviations = 0.0;
+      std::fill( statistics.begin(), statistics.end(), empty );
+
+      accumulate.m_Input = frame->GetBufferPointer();
+      accumulate.m_NumberOfFrames = i + 1.0;
+      accumulator->SetSingleMethod( AccumulateThreaderCallback, &accumulate );
+      accumulator->SingleMethodExecute();
+
+      if( this->m_PrintStatistics )
+      {
+        StatisticsStruct total = empty;
+        for( std::size_t t = 0; t < statistics.size(); ++t )
+        {
+          MergeStatistics( total, statistics[ t ] );
+        }
+        const double divisor = this->m_UsePopulationStd ? total.m_Count : total.m_Count - 1.0;
+        std::cout << std::setprecision( 8 ) << this->m_Frames[ i ]
+          << "\t" << total.m_Minimum
+          << "\t" << total.m_Maximum
+          << "\t" << total.m_Mean
+          << "\t" << ( divisor > 0.0 ? std::sqrt( total.m_SumOfSquaredDeviations / divisor ) : 0.0 )
+          << std::endl;
+      }
+
+      /** Write it. */
+      if( writeFrames )
+      {
+        std::ostringstream fileName;
+        fileName << base << "_T" << this->m_Frames[ i ] << extension;
+        this->WriteImage( frame.GetPointer(), fileName.str() );
+      }
+      if( writeOutput )
+      {
+        this->WriteFrame( frame, i );
+      }
+    }
+    catch( itk::ExceptionObject & excp )
+    {
+      errorMessage = excp.GetDescription();
+    }
+
+    /** Wait for the next frame. */
+    if( prefetchThread >= 0 )
+    {
+      prefetcher->TerminateThread( prefetchThread );
+      if( errorMessage == "" ) errorMessage = next.m_ErrorMessage;
+    }
+    if( errorMessage != "" )
+    {
+      itkGenericExceptionMacro( << "ERROR: " << errorMessage );
+    }
+    image = next.m_Image;
+  }
+
+  /** The temporal mean and standard deviation, from the running mean M
+   * and squared deviations S of Welford's method:
+   *   mean = M
+   *   std  = sqrt( S / N ) or sqrt( S / (N-1) )
+   */
+  if( calc_mean )
+  {
+    meanImage->Allocate();
+    float * buffer = meanImage->GetBufferPointer();
+    for( std::size_t k = 0; k < numberOfPixels; ++k )
+    {
+      buffer[ k ] = static_cast<float>( welfordMean[ k ] );
+    }
+    this->WriteImage( meanImage.GetPointer(), this->m_OutputFileNameMean );
+  }
+
+  if( calc_std )
+  {
+    stdImage->Allocate();
+    float * buffer = stdImage->GetBufferPointer();
+    const double divisor = this->m_UsePopulationStd ? nrFrames : nrFrames - 1.0;
+    for( std::size_t k = 0; k < numberOfPixels; ++k )
+    {
+      buffer[ k ] = divisor > 0.0
+        ? static_cast<float>( std::sqrt( welfordSumOfSquaredDeviations[ k ] / divisor ) ) : 0.0f;
+    }
+    this->WriteImage( stdImage.GetPointer(), this->m_OutputFileNameStd );
+  }
+
+} // end Run()
+
+#endif // end #ifndef __timeseries_hxx_
@@ -22,11 +22,12 @@
  */
 #include "itkCommandLineArgumentParser.h"
 #include "ITKToolsHelpers.h"
+#include "ITKToolsImageProperties.h"
+#include "ITKToolsColumnReader.h"
+#include "ttest.h"
 
 #include <vector>
-#include <fstream>
 #include <iomanip>
-#include <itksys/SystemTools.hxx>
 #include "itkTDistribution.h"
 
 
@@ -53,15 +54,32 @@ std::string GetHelpString( void )
     << "  [-p]     the output precision, default = 8:\n"
     << "The input file should be in a certain format. No text is allowed.\n"
     << "No headers are allowed. The data samples should be displayed in columns.\n"
-    << "Columns should be separated by a single space or tab.";
+    << "Columns should be separated by spaces or tabs.\n"
+    << "\n"
+    << "Alternatively, a voxelwise t-test is performed on two sets of images:\n"
+    << "pxttest\n"
+    << "  -in1     the first set of images\n"
+    << "  -in2     the second set of images; for a paired t-test,\n"
+    << "           the i-th image is paired with the i-th image of -in1\n"
+    << "  [-outt]  outputFilename for the t-value map\n"
+    << "  [-outp]  outputFilename for the p-value map\n"
+    << "  [-tail]  one or two tailed, defauls = 2\n"
+    << "  [-type]  the type of the t-test, default = 1, see above\n"
+    << "  [-z]     compression flag; if provided, the output images are compressed\n"
+    << "  [-perm]  number of permutations for the family-wise error corrected p-values,\n"
+    << "           with the maximum statistic, default 0: no correction;\n"
+    << "           the paired test flips the signs of the differences, the others relabel\n"
+    << "           the images of both sets; all samples are kept in memory\n"
+    << "  [-outpc] outputFilename for the corrected p-value map, required with -perm;\n"
+    << "           for -tail 1 it tests a mean of -in1 larger than that of -in2\n"
+    << "  [-seed]  the seed of the permutations, default 0\n"
+    << "The maps are written as float.\n"
+    << "Supported: 2D, 3D, any scalar pixel type.";
 
   return ss.str();
 
 } // end GetHelpString()
 
-/* Declare ReadInputData. */
-bool ReadInputData( const std::string & filename, std::vector<std::vector<double> > & matrix );
-
 /* Declare ComputeTValue. */
 bool ComputeTValue( const std::vector<double> & samples1,
     const std::vector<double> & samples2, const unsigned int type,
@@ -69,6 +87,9 @@ bool ComputeTValue( const std::vector<double> & samples1,
     double & mean1, double & mean2, double & meandiff,
     double & std1, double & std2, double & stddiff );
 
+/* Declare ImageTTest. */
+static int ImageTTest( itk::CommandLineArgumentParser * parser );
+
 /* Declare ComputeMeanAndStandardDeviation. */
 void ComputeMeanAndStandardDeviation(
   const std::vector<double> & samples1,
@@ -85,8 +106,10 @@ int main( int argc, char **argv )
   parser->SetCommandLineArguments( argc, argv );
   parser->SetProgramHelpText( GetHelpString() );
 
-  parser->MarkArgumentAsRequired( "-in", "The input filename." );
-  parser->MarkArgumentAsRequired( "-c", "Columns." );
+  std::vector<std::string> exactlyOneArguments;
+  exactlyOneArguments.push_back( "-in" );
+  exactlyOneArguments.push_back( "-in1" );
+  parser->MarkExactlyOneOfArgumentsAsRequired( exactlyOneArguments );
 
   itk::CommandLineArgumentParser::ReturnValue validateArguments = parser->CheckForRequiredArguments();
 
@@ -99,6 +122,15 @@ int main( int argc, char **argv )
     return EXIT_SUCCESS;
   }
 
+  /** Threading. */
+  itktools::ReadThreadingArguments( parser );
+
+  /** The voxelwise t-test on images. */
+  if( parser->ArgumentExists( "-in1" ) )
+  {
+    return ImageTTest( parser );
+  }
+
   /** Get arguments. */
   std::string inputFileName = "";
   parser->GetCommandLineArgument( "-in", inputFileName );
@@ -119,6 +151,11 @@ int main( int argc, char **argv )
   parser->GetCommandLineArgument( "-p", precision );
 
   /** Check command line arguments. */
+  if( !parser->ArgumentExists( "-c" ) )
+  {
+    std::cerr << "ERROR: You should specify two different columns with \"-c\"." << std::endl;
+    return EXIT_FAILURE;
+  }
   if( columns.size() != 2 )
   {
     std::cerr << "ERROR: You should specify two different columns with \"-c\"." << std::endl;
@@ -135,41 +172,27 @@ int main( int argc, char **argv )
     return EXIT_FAILURE;
   }
 
-  /** Read the input file. */
-  std::vector< std::vector<double> > matrix;
-  bool readSuccess = ReadInputData( inputFileName, matrix );
+  /** Read the two requested columns of the input file. */
+  std::vector< std::vector<double> > samples;
+  unsigned int numberOfColumns = 0;
+  bool readSuccess = itktools::ReadNumericColumns(
+    inputFileName, columns, samples, numberOfColumns );
   if( !readSuccess)
   {
     std::cerr << "ERROR: Something went wrong reading \""
       << inputFileName << "\"." << std::endl;
     return EXIT_FAILURE;
   }
+  const std::vector<double> & samples1 = samples[ 0 ];
+  const std::vector<double> & samples2 = samples[ 1 ];
 
   /** Check if there are at least two data points. */
-  if( matrix.size() < 2 )
+  if( samples1.size() < 2 )
   {
     std::cerr << "ERROR: Each column should contain at least two samples." << std::endl;
     return EXIT_FAILURE;
   }
 
-  /** Check if the requested columns exists. */
-  if( matrix[ 0 ].size() - 1 < columns[ 0 ] ||
-    matrix[ 0 ].size() - 1 < columns[ 1 ] )
-  {
-    std::cerr << "ERROR: Requesting an unexisting column. There are only "
-      << matrix[ 0 ].size() << " columns." << std::endl;
-    return EXIT_FAILURE;
-  }
-
-  /** Extract the two requested columns. */
-  std::vector<double> samples1( matrix.size() ), samples2( matrix.size() );
-  for( unsigned int i = 0; i < matrix.size(); ++i )
-  {
-    samples1[ i ] = matrix[ i ][ columns[ 0 ] ];
-    samples2[ i ] = matrix[ i ][ columns[ 1 ] ];
-    //std::cout << samples1[ i ] << " " << samples2[ i ] << std::endl;
-  }
-
   /** Compute the t value. */
   double tValue = 0.0;
   double mean1, mean2, meandiff, std1, std2, stddiff;
@@ -213,71 +236,127 @@ int main( int argc, char **argv )
 
 
 /*
- * ******************* ReadInputData *******************
- *
- * This function reads the specified input text file.
- * No error checking is done. Each line of the file should
- * consist of an equal amount of elements. Each column should
- * contain the data samples over which a t-test is performed.
- * The file should not contain text, and no headers.
+ * ******************* ImageTTest *******************
  */
 
-bool ReadInputData( const std::string & filename, std::vector<std::vector<double> > & matrix )
+static int ImageTTest( itk::CommandLineArgumentParser * parser )
 {
-  /** Open file for reading. */
-  std::ifstream file( filename.c_str() );
-  std::string line;
+  /** Get arguments. */
+  std::vector<std::string> inputFileNames1;
+  parser->GetCommandLineArgument( "-in1", inputFileNames1 );
+
+  std::vector<std::string> inputFileNames2;
+  parser->GetCommandLineArgument( "-in2", inputFileNames2 );
+
+  std::string outputFileNameT = "";
+  parser->GetCommandLineArgument( "-outt", outputFileNameT );
+
+  std::string outputFileNameP = "";
+  parser->GetCommandLineArgument( "-outp", outputFileNameP );
+
+  unsigned int tail = 2;
+  parser->GetCommandLineArgument( "-tail", tail );
+
+  unsigned int type = 1;
+  parser->GetCommandLineArgument( "-type", type );
+
+  const bool useCompression = parser->ArgumentExists( "-z" );
+
+  std::string outputFileNameCorrectedP = "";
+  parser->GetCommandLineArgument( "-outpc", outputFileNameCorrectedP );
 
-  /** Read the file line by line. */
-  if( file.is_open() )
+  unsigned int numberOfPermutations = 0;
+  parser->GetCommandLineArgument( "-perm", numberOfPermutations );
+
+  unsigned int seed = 0;
+  parser->GetCommandLineArgument( "-seed", seed );
+
+  /** Check command line arguments. */
+  if( inputFileNames1.size() < 2 || inputFileNames2.size() < 2 )
+  {
+    std::cerr << "ERROR: \"-in1\" and \"-in2\" should both contain at least two images." << std::endl;
+    return EXIT_FAILURE;
+  }
+  if( type < 1 || type > 3 )
+  {
+    std::cerr << "ERROR: This type is not supported. Choose one of {1,2,3}." << std::endl;
+    return EXIT_FAILURE;
+  }
+  if( type == 1 && inputFileNames1.size() != inputFileNames2.size() )
+  {
+    std::cerr << "ERROR: requested a paired t-test, but the sets of images have unequal length." << std::endl;
+    return EXIT_FAILURE;
+  }
+  if( outputFileNameT == "" && outputFileNameP == "" && outputFileNameCorrectedP == "" )
   {
-    /** Read the first line to find out how long it is. */
-    std::getline( file, line );
+    std::cerr << "ERROR: You should specify \"-outt\", \"-outp\" and/or \"-outpc\"." << std::endl;
+    return EXIT_FAILURE;
+  }
+  if( ( numberOfPermutations > 0 ) != ( outputFileNameCorrectedP != "" ) )
+  {
+    std::cerr << "ERROR: \"-perm\" and \"-outpc\" should be given together." << std::endl;
+    return EXIT_FAILURE;
+  }
 
-    /** We use the function:
-     * static kwsys_stl::vector<String> SplitString( const char* s,
-     *   char separator = '/', bool isPath = false );
-     * The columns are assumed to be separated by one space ' ' or one tab '\t'.
-     */
-    std::vector<itksys::String> linevec1 = itksys::SystemTools::SplitString(
-      line.c_str(), ' ', false );
-    std::vector<itksys::String> linevec2 = itksys::SystemTools::SplitString(
-      line.c_str(), '\t', false );
-    unsigned int linelength = linevec1.size() > linevec2.size() ? linevec1.size() : linevec2.size();
-
-    /** Read and convert the first line. */
-    std::istringstream lineSS1( line.c_str() );
-    std::vector<double> linevec( linelength );
-    for( unsigned int i = 0; i < linelength; i++ )
-    {
-      lineSS1 >> linevec[ i ];
-    }
-    matrix.push_back( linevec );
+  /** Read the headers of all inputs before processing starts. */
+  if( !itktools::ValidateImageHeaders( inputFileNames1 ) ) return EXIT_FAILURE;
+  if( !itktools::ValidateImageHeaders( inputFileNames2 ) ) return EXIT_FAILURE;
 
-    /** Read the remaining lines. */
-    while ( !file.eof() )
-    {
-      std::getline( file, line );
-      std::istringstream lineSS( line.c_str() );
-      for( unsigned int i = 0; i < linelength; i++ )
-      {
-        lineSS >> linevec[ i ];
-      }
-      matrix.push_back( linevec );
-    } // end reading file
-
-    /** Remove last line. */
-    matrix.resize( matrix.size() - 1 );
+  /** Determine image properties. */
+  itk::ImageIOBase::IOPixelType pixelType = itk::ImageIOBase::UNKNOWNPIXELTYPE;
+  itk::ImageIOBase::IOComponentType componentType = itk::ImageIOBase::UNKNOWNCOMPONENTTYPE;
+  unsigned int dim = 0;
+  unsigned int numberOfComponents = 0;
+  bool retgip = itktools::GetImageProperties(
+    inputFileNames1[ 0 ], pixelType, componentType, dim, numberOfComponents );
+  if( !retgip ) return EXIT_FAILURE;
+
+  /** Check for vector images. */
+  bool retNOCCheck = itktools::NumberOfComponentsCheck( numberOfComponents );
+  if( !retNOCCheck ) return EXIT_FAILURE;
+
+  /** Class that does the work. */
+  ITKToolsTTestImageBase * filter = 0;
+
+  try
+  {
+    // now call all possible template combinations.
+    if( !filter ) filter = ITKToolsTTestImage< 2 >::New( dim );
+#ifdef ITKTOOLS_3D_SUPPORT
+    if( !filter ) filter = ITKToolsTTestImage< 3 >::New( dim );
+#endif
+    /** Check if filter was instantiated. */
+    bool supported = itktools::IsFilterSupportedCheck( filter, dim, componentType );
+    if( !supported ) return EXIT_FAILURE;
+
+    /** Set the filter arguments. */
+    filter->m_InputFileNames1 = inputFileNames1;
+    filter->m_InputFileNames2 = inputFileNames2;
+    filter->m_OutputFileNameT = outputFileNameT;
+    filter->m_OutputFileNameP = outputFileNameP;
+    filter->m_Tail = tail;
+    filter->m_Type = type;
+    filter->m_UseCompression = useCompression;
+    filter->m_OutputFileNameCorrectedP = outputFileNameCorrectedP;
+    filter->m_NumberOfPermutations = numberOfPermutations;
+    filter->m_Seed = seed;
+
+    filter->ReadCommonArguments( parser );
+    filter->Run();
+
+    delete filter;
   }
-  else
+  catch( itk::ExceptionObject & excp )
   {
-    return false;
+    std::cerr << "ERROR: Caught ITK exception: " << excp << std::endl;
+    delete filter;
+    return EXIT_FAILURE;
   }
 
-  /** Return a value. */
-  return true;
+  /** End program. */
+  return EXIT_SUCCESS;
 
-} // end ReadInputData()
+} // end ImageTTest()
 
 
 /*
@@ -0,0 +1,203 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __ttest_h_
+#define __ttest_h_
+
+#include "ITKToolsBase.h"
+
+#include "itkImage.h"
+#include "itkMultiThreader.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include <string>
+#include <vector>
+
+
+/** \class ITKToolsTTestImageBase
+ *
+ * Untemplated pure virtual base class that holds
+ * the Run() function and all required parameters.
+ */
+
+class ITKToolsTTestImageBase : public itktools::ITKToolsBase
+{
+public:
+  /** Constructor. */
+  ITKToolsTTestImageBase()
+  {
+    this->m_InputFileNames1 = std::vector<std::string>();
+    this->m_InputFileNames2 = std::vector<std::string>();
+    this->m_OutputFileNameT = "";
+    this->m_OutputFileNameP = "";
+    this->m_Tail = 2;
+    this->m_Type = 1;
+    this->m_UseCompression = false;
+    this->m_OutputFileNameCorrectedP = "";
+    this->m_NumberOfPermutations = 0;
+    this->m_Seed = 0;
+  };
+  /** Destructor. */
+  ~ITKToolsTTestImageBase(){};
+
+  /** Input member parameters. */
+  std::vector<std::string> m_InputFileNames1;
+  std::vector<std::string> m_InputFileNames2;
+  std::string              m_OutputFileNameT;
+  std::string              m_OutputFileNameP;
+  unsigned int             m_Tail;
+  unsigned int             m_Type;
+  bool                     m_UseCompression;
+  std::string              m_OutputFileNameCorrectedP;
+  unsigned int             m_NumberOfPermutations;
+  unsigned int             m_Seed;
+
+}; // end class ITKToolsTTestImageBase
+
+
+/** \class ITKToolsTTestImage
+ *
+ * Templated class that implements the Run() function
+ * and the New() function for its creation.
+ *
+ * The images are read one at a time, and accumulated voxelwise with
+ * Welford's method in double precision. The t- and p-values are then
+ * computed in a multithreaded pass.
+ *
+ * With permutations, the family-wise error corrected p-values are computed
+ * with the maximum statistic. The samples are kept in a voxel-major layout,
+ * the samples of a voxel contiguous, and the permutations are distributed
+ * over the threads. Permutation b uses its own random stream, initialized
+ * with seed + b, so the result does not depend on the number of threads.
+ * A thread evaluates a batch of permutations in one pass over the voxels.
+ * The paired test flips the signs of the differences; the two-sample tests
+ * relabel the samples of both sets.
+ */
+
+template< unsigned int VDimension >
+class ITKToolsTTestImage : public ITKToolsTTestImageBase
+{
+public:
+  /** Standard ITKTools stuff. */
+  typedef ITKToolsTTestImage Self;
+
+  ITKToolsTTestImage(){};
+  ~ITKToolsTTestImage(){};
+
+  static Self * New( unsigned int dim )
+  {
+    if( VDimension == dim ) return new Self;
+    return 0;
+  }
+
+  /** Typedefs. */
+  typedef itk::Image< float, VDimension >           ImageType;
+  typedef typename ImageType::Pointer               ImagePointer;
+  typedef itk::Image< double, VDimension >          RealImageType;
+  typedef typename RealImageType::Pointer           RealImagePointer;
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator RandomGeneratorType;
+
+  /** Run function. */
+  void Run( void );
+
+protected:
+
+  /** The running mean and sum of squared deviations of one set of samples. */
+  struct MomentsStruct
+  {
+    double * m_Mean;
+    double * m_SumOfSquaredDeviations;
+  };
+
+  /** The arguments of the accumulation threads. */
+  struct AccumulateStruct
+  {
+    const float *  m_Input1;
+    const float *  m_Input2;
+    std::size_t    m_NumberOfPixels;
+    unsigned int   m_Index;
+    MomentsStruct  m_Moments;
+  };
+
+  /** The arguments of the threads that compute the t- and p-values. */
+  struct TValueStruct
+  {
+    std::size_t    m_NumberOfPixels;
+    unsigned int   m_Type;
+    unsigned int   m_Tail;
+    double         m_Count1;
+    double         m_Count2;
+    MomentsStruct  m_Moments1;
+    MomentsStruct  m_Moments2;
+    float *        m_TValues;
+    float *        m_PValues;
+  };
+
+  /** The arguments of the permutation threads. In pass 0 the threads
+   * compute the statistic of every voxel for the unpermuted samples, in
+   * pass 1 the maximum statistic of the permutations. */
+  struct PermutationStruct
+  {
+    const float *          m_Samples;
+    std::size_t            m_NumberOfPixels;
+    unsigned int           m_NumberOfSamples;
+    unsigned int           m_Count1;
+    unsigned int           m_Type;
+    unsigned int           m_Tail;
+    unsigned int           m_Seed;
+    unsigned int           m_Pass;
+    float *                m_Statistics;
+    std::vector<double>    m_ThreadMaxima;
+    std::vector<double>    m_Maxima;
+  };
+
+  /** The number of permutations a thread evaluates per pass over the voxels. */
+  itkStaticConstMacro( PermutationBatchSize, unsigned int, 16 );
+
+  /** The statistic of a voxel from the sums of the (weighted) samples:
+   * the sum and sum of squares of the differences, or of both sets. It is
+   * t for the one-tailed and |t| for the two-tailed test. */
+  static double ComputeStatistic( unsigned int type, unsigned int tail,
+    double n1, double sum1, double sumOfSquares1,
+    double n2, double sum2, double sumOfSquares2 );
+
+  /** The weights of permutation b: signs for the paired test, the
+   * indicators of the first set for the two-sample tests. Permutation 0
+   * is the identity. */
+  static void ComputePermutationWeights( const PermutationStruct * data,
+    unsigned int b, RandomGeneratorType * generator,
+    std::vector<unsigned int> & order, float * weights );
+
+  /** Compute the corrected p-values from the voxel-major samples. */
+  void ComputeCorrectedPValues( const std::vector<float> & samples,
+    std::size_t numberOfPixels, ImageType * pValues );
+
+  /** Read an image, disconnected from its reader. */
+  static ImagePointer ReadImage( const std::string & fileName );
+
+  /** Allocate a zero image of the same size as the first input. */
+  static RealImagePointer CreateAccumulator( const ImageType * image );
+
+  /** Thread callbacks. */
+  static ITK_THREAD_RETURN_TYPE AccumulateThreaderCallback( void * arg );
+  static ITK_THREAD_RETURN_TYPE TValueThreaderCallback( void * arg );
+  static ITK_THREAD_RETURN_TYPE PermutationThreaderCallback( void * arg );
+
+}; // end class ITKToolsTTestImage
+
+#include "ttest.hxx"
+
+#endif // end #ifndef __ttest_h_
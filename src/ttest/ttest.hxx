@@ -0,0 +1,608 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __ttest_hxx_
+#define __ttest_hxx_
+
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkTDistribution.h"
+#include <algorithm>
+#include <limits>
+
+
+/**
+ * ******************* ReadImage *******************
+ */
+
+template< unsigned int VDimension >
+typename ITKToolsTTestImage< VDimension >::ImagePointer
+ITKToolsTTestImage< VDimension >
+::ReadImage( const std::string & fileName )
+{
+  typedef itk::ImageFileReader< ImageType >   ReaderType;
+
+  typename ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( fileName.c_str() );
+  reader->Update();
+  ImagePointer image = reader->GetOutput();
+  image->DisconnectPipeline();
+  return image;
+
+} // end ReadImage()
+
+
+/**
+ * ******************* CreateAccumulator *******************
+ */
+
+template< unsigned int VDimension >
+typename ITKToolsTTestImage< VDimension >::RealImagePointer
+ITKToolsTTestImage< VDimension >
+::CreateAccumulator( const ImageType * image )
+{
+  RealImagePointer accumulator = RealImageType::New();
+  accumulator->SetRegions( image->GetLargestPossibleRegion().GetSize() );
+  accumulator->Allocate();
+  accumulator->FillBuffer( 0.0 );
+  return accumulator;
+
+} // end CreateAccumulator()
+
+
+/**
+ * ******************* AccumulateThreaderCallback *******************
+ *
+ * Adds one sample, or for the paired test the difference of two samples,
+ * to the running mean and sum of squared deviations. Every thread
+ * processes a contiguous part of the buffers.
+ */
+
+template< unsigned int VDimension >
+ITK_THREAD_RETURN_TYPE
+ITKToolsTTestImage< VDimension >
+::AccumulateThreaderCallback( void * arg )
+{
+  itk::MultiThreader::ThreadInfoStruct * info
+    = static_cast<itk::MultiThreader::ThreadInfoStruct *>( arg );
+  const AccumulateStruct * data = static_cast<AccumulateStruct *>( info->UserData );
+
+  const std::size_t begin = data->m_NumberOfPixels * info->ThreadID / info->NumberOfThreads;
+  const std::size_t end = data->m_NumberOfPixels * ( info->ThreadID + 1 ) / info->NumberOfThreads;
+  const double count = data->m_Index + 1.0;
+  double * mean = data->m_Moments.m_Mean;
+  double * sumOfSquaredDeviations = data->m_Moments.m_SumOfSquaredDeviations;
+
+  for( std::size_t k = begin; k < end; ++k )
+  {
+    double value = static_cast<double>( data->m_Input1[ k ] );
+    if( data->m_Input2 ) value -= static_cast<double>( data->m_Input2[ k ] );
+    const double delta = value - mean[ k ];
+    mean[ k ] += delta / count;
+    sumOfSquaredDeviations[ k ] += delta * ( value - mean[ k ] );
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end AccumulateThreaderCallback()
+
+
+/**
+ * ******************* TValueThreaderCallback *******************
+ *
+ * Computes the t- and p-value of every voxel:
+ *   1: paired,       t = mean(X1-X2) sqrt(N) / std(X1-X2), dof = N-1
+ *   2: two-sample equal variance, with the pooled variance, dof = N1+N2-2
+ *   3: two-sample unequal variance (Welch), with the Welch-Satterthwaite dof
+ * A voxel without variance gets t = 0 and p = 1.
+ */
+
+template< unsigned int VDimension >
+ITK_THREAD_RETURN_TYPE
+ITKToolsTTestImage< VDimension >
+::TValueThreaderCallback( void * arg )
+{
+  typedef itk::Statistics::TDistribution    DistributionType;
+
+  itk::MultiThreader::ThreadInfoStruct * info
+    = static_cast<itk::MultiThreader::ThreadInfoStruct *>( arg );
+  const TValueStruct * data = static_cast<TValueStruct *>( info->UserData );
+
+  const std::size_t begin = data->m_NumberOfPixels * info->ThreadID / info->NumberOfThreads;
+  const std::size_t end = data->m_NumberOfPixels * ( info->ThreadID + 1 ) / info->NumberOfThreads;
+  const double n1 = data->m_Count1;
+  const double n2 = data->m_Count2;
+  const double tailFactor = data->m_Tail == 2 ? 2.0 : 1.0;
+  DistributionType::ParametersType degreesOfFreedom( 1 );
+
+  for( std::size_t k = begin; k < end; ++k )
+  {
+    const double mean1 = data->m_Moments1.m_Mean[ k ];
+    const double ssd1 = data->m_Moments1.m_SumOfSquaredDeviations[ k ];
+
+    double difference = mean1;
+    double standardError = 0.0;
+    if( data->m_Type == 1 )
+    {
+      standardError = vcl_sqrt( ssd1 / ( n1 - 1.0 ) / n1 );
+      degreesOfFreedom[ 0 ] = n1 - 1.0;
+    }
+    else
+    {
+      const double mean2 = data->m_Moments2.m_Mean[ k ];
+      const double ssd2 = data->m_Moments2.m_SumOfSquaredDeviations[ k ];
+      difference = mean1 - mean2;
+      if( data->m_Type == 2 )
+      {
+        const double pooledVariance = ( ssd1 + ssd2 ) / ( n1 + n2 - 2.0 );
+        standardError = vcl_sqrt( pooledVariance * ( 1.0 / n1 + 1.0 / n2 ) );
+        degreesOfFreedom[ 0 ] = n1 + n2 - 2.0;
+      }
+      else
+      {
+        const double v1 = ssd1 / ( n1 - 1.0 ) / n1;
+        const double v2 = ssd2 / ( n2 - 1.0 ) / n2;
+        standardError = vcl_sqrt( v1 + v2 );
+        degreesOfFreedom[ 0 ] = ( v1 + v2 ) * ( v1 + v2 )
+          / ( v1 * v1 / ( n1 - 1.0 ) + v2 * v2 / ( n2 - 1.0 ) );
+      }
+    }
+
+    if( standardError > 0.0 )
+    {
+      const double tValue = difference / standardError;
+      data->m_TValues[ k ] = static_cast<float>( tValue );
+      data->m_PValues[ k ] = static_cast<float>( tailFactor
+        * DistributionType::CDF( -vcl_abs( tValue ), degreesOfFreedom ) );
+    }
+    else
+    {
+      data->m_TValues[ k ] = 0.0f;
+      data->m_PValues[ k ] = 1.0f;
+    }
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end TValueThreaderCallback()
+
+
+/**
+ * ******************* ComputeStatistic *******************
+ *
+ * As TValueThreaderCallback(), from sums instead of running moments.
+ * A sum of squared deviations that is zero up to rounding counts as zero,
+ * so that constant voxels get t = 0 for every permutation.
+ */
+
+template< unsigned int VDimension >
+double
+ITKToolsTTestImage< VDimension >
+::ComputeStatistic( unsigned int type, unsigned int tail,
+  double n1, double sum1, double sumOfSquares1,
+  double n2, double sum2, double sumOfSquares2 )
+{
+  const double tolerance = 1e-10;
+  const double mean1 = sum1 / n1;
+  double ssd1 = sumOfSquares1 - sum1 * mean1;
+  if( ssd1 <= tolerance * sumOfSquares1 ) ssd1 = 0.0;
+
+  double difference = mean1;
+  double standardError = 0.0;
+  if( type == 1 )
+  {
+    standardError = vcl_sqrt( ssd1 / ( n1 - 1.0 ) / n1 );
+  }
+  else
+  {
+    const double mean2 = sum2 / n2;
+    double ssd2 = sumOfSquares2 - sum2 * mean2;
+    if( ssd2 <= tolerance * sumOfSquares2 ) ssd2 = 0.0;
+    difference = mean1 - mean2;
+    if( type == 2 )
+    {
+      const double pooledVariance = ( ssd1 + ssd2 ) / ( n1 + n2 - 2.0 );
+      standardError = vcl_sqrt( pooledVariance * ( 1.0 / n1 + 1.0 / n2 ) );
+    }
+    else
+    {
+      standardError = vcl_sqrt( ssd1 / ( n1 - 1.0 ) / n1 + ssd2 / ( n2 - 1.0 ) / n2 );
+    }
+  }
+
+  if( !( standardError > 0.0 ) ) return 0.0;
+  const double tValue = difference / standardError;
+  return tail == 2 ? vcl_abs( tValue ) : tValue;
+
+} // end ComputeStatistic()
+
+
+/**
+ * ******************* ComputePermutationWeights *******************
+ */
+
+template< unsigned int VDimension >
+void
+ITKToolsTTestImage< VDimension >
+::ComputePermutationWeights( const PermutationStruct * data,
+  unsigned int b, RandomGeneratorType * generator,
+  std::vector<unsigned int> & order, float * weights )
+{
+  const unsigned int S = data->m_NumberOfSamples;
+  const bool paired = data->m_Type == 1;
+  if( b > 0 ) generator->Initialize( data->m_Seed + b );
+
+  /** Flip the signs of the differences. */
+  if( paired )
+  {
+    for( unsigned int s = 0; s < S; ++s )
+    {
+      weights[ s ] = ( b == 0 || generator->GetVariateWithOpenUpperRange() < 0.5 )
+        ? 1.0f : -1.0f;
+    }
+    return;
+  }
+
+  /** Draw the first set, with a partial Fisher-Yates shuffle. */
+  order.resize( S );
+  for( unsigned int s = 0; s < S; ++s ) order[ s ] = s;
+  for( unsigned int s = 0; s < data->m_Count1 && b > 0; ++s )
+  {
+    const unsigned int r = s + generator->GetIntegerVariate( S - 1 - s );
+    std::swap( order[ s ], order[ r ] );
+  }
+  std::fill( weights, weights + S, 0.0f );
+  for( unsigned int s = 0; s < data->m_Count1; ++s )
+  {
+    weights[ order[ s ] ] = 1.0f;
+  }
+
+} // end ComputePermutationWeights()
+
+
+/**
+ * ******************* PermutationThreaderCallback *******************
+ *
+ * Pass 0: the statistic of every voxel of a contiguous part of the
+ * buffer, without permutation. Pass 1: the maximum statistic of a
+ * contiguous range of permutations, in batches, so that the samples of a
+ * voxel are read once per batch.
+ */
+
+template< unsigned int VDimension >
+ITK_THREAD_RETURN_TYPE
+ITKToolsTTestImage< VDimension >
+::PermutationThreaderCallback( void * arg )
+{
+  itk::MultiThreader::ThreadInfoStruct * info
+    = static_cast<itk::MultiThreader::ThreadInfoStruct *>( arg );
+  PermutationStruct * data = static_cast<PermutationStruct *>( info->UserData );
+
+  const unsigned int S = data->m_NumberOfSamples;
+  const bool paired = data->m_Type == 1;
+  const double n1 = paired ? S : data->m_Count1;
+  const double n2 = paired ? 0.0 : S - data->m_Count1;
+  const unsigned int batchSize = data->m_Pass == 0 ? 1 : PermutationBatchSize;
+
+  /** The voxels and permutations of this thread. */
+  std::size_t voxelBegin = 0;
+  std::size_t voxelEnd = data->m_NumberOfPixels;
+  unsigned int permutationBegin = 0;
+  unsigned int permutationEnd = 1;
+  if( data->m_Pass == 0 )
+  {
+    voxelBegin = data->m_NumberOfPixels * info->ThreadID / info->NumberOfThreads;
+    voxelEnd = data->m_NumberOfPixels * ( info->ThreadID + 1 ) / info->NumberOfThreads;
+  }
+  else
+  {
+    const unsigned long long B = data->m_Maxima.size() - 1;
+    permutationBegin = 1 + static_cast<unsigned int>( B * info->ThreadID / info->NumberOfThreads );
+    permutationEnd = 1 + static_cast<unsigned int>( B * ( info->ThreadID + 1 ) / info->NumberOfThreads );
+  }
+
+  RandomGeneratorType::Pointer generator = RandomGeneratorType::New();
+  std::vector<unsigned int> order;
+  std::vector<float> weights( batchSize * S );
+  double threadMaximum = -std::numeric_limits<double>::max();
+
+  for( unsigned int batch = permutationBegin; batch < permutationEnd; batch += batchSize )
+  {
+    const unsigned int count = std::min( batchSize, permutationEnd - batch );
+    double maxima[ PermutationBatchSize ];
+    for( unsigned int p = 0; p < count; ++p )
+    {
+      ComputePermutationWeights( data, batch + p, generator, order, &weights[ p * S ] );
+      maxima[ p ] = -std::numeric_limits<double>::max();
+    }
+
+    for( std::size_t k = voxelBegin; k < voxelEnd; ++k )
+    {
+      /** The totals do not change under permutation. */
+      const float * x = data->m_Samples + k * S;
+      double sum = 0.0, sumOfSquares = 0.0;
+      for( unsigned int s = 0; s < S; ++s )
+      {
+        sum += x[ s ];
+        sumOfSquares += static_cast<double>( x[ s ] ) * x[ s ];
+      }
+
+      for( unsigned int p = 0; p < count; ++p )
+      {
+        const float * w = &weights[ p * S ];
+        double sum1 = 0.0, sumOfSquares1 = 0.0;
+        for( unsigned int s = 0; s < S; ++s )
+        {
+          const double wx = static_cast<double>( w[ s ] ) * x[ s ];
+          sum1 += wx;
+          sumOfSquares1 += wx * x[ s ];
+        }
+
+        /** Rounded to float, as the statistic map. */
+        const float statistic = paired
+          ? static_cast<float>( ComputeStatistic( 1, data->m_Tail,
+              n1, sum1, sumOfSquares, 0.0, 0.0, 0.0 ) )
+          : static_cast<float>( ComputeStatistic( data->m_Type, data->m_Tail,
+              n1, sum1, sumOfSquares1, n2, sum - sum1, sumOfSquares - sumOfSquares1 ) );
+        maxima[ p ] = std::max( maxima[ p ], static_cast<double>( statistic ) );
+        if( data->m_Pass == 0 ) data->m_Statistics[ k ] = statistic;
+      }
+    }
+
+    for( unsigned int p = 0; p < count; ++p )
+    {
+      if( data->m_Pass == 1 ) data->m_Maxima[ batch + p ] = maxima[ p ];
+      threadMaximum = std::max( threadMaximum, maxima[ p ] );
+    }
+  }
+  data->m_ThreadMaxima[ info->ThreadID ] = threadMaximum;
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end PermutationThreaderCallback()
+
+
+/**
+ * ******************* ComputeCorrectedPValues *******************
+ *
+ * The corrected p-value of a voxel is the fraction of the permutations,
+ * including the identity, of which the maximum statistic is at least the
+ * statistic of the voxel.
+ */
+
+template< unsigned int VDimension >
+void
+ITKToolsTTestImage< VDimension >
+::ComputeCorrectedPValues( const std::vector<float> & samples,
+  std::size_t numberOfPixels, ImageType * pValues )
+{
+  const unsigned int B = this->m_NumberOfPermutations;
+
+  PermutationStruct data;
+  data.m_Samples = &samples[ 0 ];
+  data.m_NumberOfPixels = numberOfPixels;
+  data.m_NumberOfSamples = samples.size() / numberOfPixels;
+  data.m_Count1 = this->m_InputFileNames1.size();
+  data.m_Type = this->m_Type;
+  data.m_Tail = this->m_Tail;
+  data.m_Seed = this->m_Seed;
+  data.m_Statistics = pValues->GetBufferPointer();
+  data.m_Maxima.assign( B + 1, 0.0 );
+
+  /** The statistics without permutation, stored in the output. */
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  data.m_Pass = 0;
+  data.m_ThreadMaxima.assign( threader->GetNumberOfThreads(), 0.0 );
+  threader->SetSingleMethod( PermutationThreaderCallback, &data );
+  threader->SingleMethodExecute();
+  data.m_Maxima[ 0 ] = *std::max_element(
+    data.m_ThreadMaxima.begin(), data.m_ThreadMaxima.end() );
+
+  /** The permutations. */
+  std::cout << "Computing " << B << " permutations." << std::endl;
+  if( B < static_cast<unsigned int>( threader->GetNumberOfThreads() ) )
+  {
+    threader->SetNumberOfThreads( std::max( B, 1u ) );
+  }
+  data.m_Pass = 1;
+  data.m_ThreadMaxima.assign( threader->GetNumberOfThreads(), 0.0 );
+  threader->SetSingleMethod( PermutationThreaderCallback, &data );
+  threader->SingleMethodExecute();
+
+  /** Replace the statistics by the corrected p-values. */
+  std::vector<double> maxima = data.m_Maxima;
+  std::sort( maxima.begin(), maxima.end() );
+  float * statistics = pValues->GetBufferPointer();
+  for( std::size_t k = 0; k < numberOfPixels; ++k )
+  {
+    const std::size_t count = maxima.end() - std::lower_bound(
+      maxima.begin(), maxima.end(), static_cast<double>( statistics[ k ] ) );
+    statistics[ k ] = static_cast<float>( count ) / static_cast<float>( B + 1 );
+  }
+
+  /** A corrected p-value of at most 0.05 requires that at most m of the
+   * maxima reach the statistic. */
+  const unsigned int m = static_cast<unsigned int>( 0.05 * ( B + 1 ) );
+  if( m > 0 )
+  {
+    std::cout << "Voxels with a statistic above " << maxima[ B - m ]
+      << " have a corrected p-value of at most 0.05." << std::endl;
+  }
+
+} // end ComputeCorrectedPValues()
+
+
+/**
+ * ******************* Run *******************
+ */
+
+template< unsigned int VDimension >
+void
+ITKToolsTTestImage< VDimension >
+::Run( void )
+{
+  /** TYPEDEF's. */
+  typedef itk::ImageFileWriter< ImageType >   WriterType;
+
+  const bool paired = this->m_Type == 1;
+  const unsigned int nrInputs1 = this->m_InputFileNames1.size();
+  const unsigned int nrInputs2 = this->m_InputFileNames2.size();
+
+  /** The first image determines the size. */
+  ImagePointer first = ReadImage( this->m_InputFileNames1[ 0 ] );
+  const typename ImageType::SizeType size = first->GetLargestPossibleRegion().GetSize();
+
+  /** The moments of the differences, or of both sets. */
+  RealImagePointer mean1 = CreateAccumulator( first );
+  RealImagePointer ssd1 = CreateAccumulator( first );
+  RealImagePointer mean2;
+  RealImagePointer ssd2;
+  if( !paired )
+  {
+    mean2 = CreateAccumulator( first );
+    ssd2 = CreateAccumulator( first );
+  }
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  AccumulateStruct accumulate;
+  accumulate.m_NumberOfPixels = first->GetLargestPossibleRegion().GetNumberOfPixels();
+
+  /** For the permutations, the samples in voxel-major order: the
+   * differences, or the first set followed by the second. */
+  const bool permute = this->m_NumberOfPermutations > 0;
+  const unsigned int nrSamples = paired ? nrInputs1 : nrInputs1 + nrInputs2;
+  std::vector<float> samples;
+  if( permute )
+  {
+    std::cout << "Keeping " << nrSamples << " samples of "
+      << accumulate.m_NumberOfPixels << " voxels for the permutations." << std::endl;
+    samples.resize( accumulate.m_NumberOfPixels * nrSamples );
+  }
+
+  /** Accumulate the images, one set or pair of images at a time. */
+  const unsigned int nrSets = paired ? 1 : 2;
+  for( unsigned int set = 0; set < nrSets; ++set )
+  {
+    const std::vector<std::string> & fileNames
+      = set == 0 ? this->m_InputFileNames1 : this->m_InputFileNames2;
+    accumulate.m_Moments.m_Mean = set == 0
+      ? mean1->GetBufferPointer() : mean2->GetBufferPointer();
+    accumulate.m_Moments.m_SumOfSquaredDeviations = set == 0
+      ? ssd1->GetBufferPointer() : ssd2->GetBufferPointer();
+
+    for( unsigned int i = 0; i < fileNames.size(); ++i )
+    {
+      std::cout << "Reading image " << fileNames[ i ] << std::endl;
+      ImagePointer image1 = ( set == 0 && i == 0 ) ? first : ReadImage( fileNames[ i ] );
+      ImagePointer image2;
+      if( paired )
+      {
+        std::cout << "Reading image " << this->m_InputFileNames2[ i ] << std::endl;
+        image2 = ReadImage( this->m_InputFileNames2[ i ] );
+      }
+
+      if( image1->GetLargestPossibleRegion().GetSize() != size )
+      {
+        itkGenericExceptionMacro( << "ERROR: the size of " << fileNames[ i ]
+          << " differs from the first image." );
+      }
+      if( paired && image2->GetLargestPossibleRegion().GetSize() != size )
+      {
+        itkGenericExceptionMacro( << "ERROR: the size of " << this->m_InputFileNames2[ i ]
+          << " differs from the first image." );
+      }
+
+      accumulate.m_Input1 = image1->GetBufferPointer();
+      accumulate.m_Input2 = paired ? image2->GetBufferPointer() : 0;
+      accumulate.m_Index = i;
+      threader->SetSingleMethod( AccumulateThreaderCallback, &accumulate );
+      threader->SingleMethodExecute();
+
+      if( permute )
+      {
+        const unsigned int column = set == 0 ? i : nrInputs1 + i;
+        for( std::size_t k = 0; k < accumulate.m_NumberOfPixels; ++k )
+        {
+          float value = accumulate.m_Input1[ k ];
+          if( paired ) value -= accumulate.m_Input2[ k ];
+          samples[ k * nrSamples + column ] = value;
+        }
+      }
+    }
+  }
+
+  /** Compute the t- and p-maps. */
+  ImagePointer tValues = ImageType::New();
+  ImagePointer pValues = ImageType::New();
+  tValues->CopyInformation( first );
+  pValues->CopyInformation( first );
+  first = 0;
+  tValues->SetRegions( size );
+  pValues->SetRegions( size );
+  tValues->Allocate();
+  pValues->Allocate();
+
+  TValueStruct tValueData;
+  tValueData.m_NumberOfPixels = accumulate.m_NumberOfPixels;
+  tValueData.m_Type = this->m_Type;
+  tValueData.m_Tail = this->m_Tail;
+  tValueData.m_Count1 = static_cast<double>( nrInputs1 );
+  tValueData.m_Count2 = static_cast<double>( nrInputs2 );
+  tValueData.m_Moments1.m_Mean = mean1->GetBufferPointer();
+  tValueData.m_Moments1.m_SumOfSquaredDeviations = ssd1->GetBufferPointer();
+  tValueData.m_Moments2.m_Mean = paired ? 0 : mean2->GetBufferPointer();
+  tValueData.m_Moments2.m_SumOfSquaredDeviations = paired ? 0 : ssd2->GetBufferPointer();
+  tValueData.m_TValues = tValues->GetBufferPointer();
+  tValueData.m_PValues = pValues->GetBufferPointer();
+  threader->SetSingleMethod( TValueThreaderCallback, &tValueData );
+  threader->SingleMethodExecute();
+
+  /** Write the output images. */
+  if( this->m_OutputFileNameT != "" )
+  {
+    typename WriterType::Pointer writer = WriterType::New();
+    writer->SetFileName( this->m_OutputFileNameT.c_str() );
+    writer->SetInput( tValues );
+    writer->SetUseCompression( this->m_UseCompression );
+    writer->Update();
+  }
+
+  if( this->m_OutputFileNameP != "" )
+  {
+    typename WriterType::Pointer writer = WriterType::New();
+    writer->SetFileName( this->m_OutputFileNameP.c_str() );
+    writer->SetInput( pValues );
+    writer->SetUseCompression( this->m_UseCompression );
+    writer->Update();
+  }
+
+  /** Compute and write the corrected p-map, reusing the written p-map. */
+  if( permute )
+  {
+    tValues = 0;
+    this->ComputeCorrectedPValues( samples, accumulate.m_NumberOfPixels, pValues );
+
+    typename WriterType::Pointer writer = WriterType::New();
+    writer->SetFileName( this->m_OutputFileNameCorrectedP.c_str() );
+    writer->SetInput( pValues );
+    writer->SetUseCompression( this->m_UseCompression );
+    writer->Update();
+  }
+
+} // end Run()
+
+#endif // end #ifndef __ttest_hxx_
@@ -59,6 +59,9 @@ public:
   std::vector<std::string> m_Arguments;
   bool m_UseCompression;
 
+  /** This tool supports streaming. */
+  virtual bool GetSupportsStreaming( void ) const { return true; }
+
 }; // end class ITKToolsUnaryImageOperatorBase
 
 
@@ -94,6 +97,7 @@ public:
     /** Read the image. */
     typename ReaderType::Pointer reader = ReaderType::New();
     reader->SetFileName( this->m_InputFileName.c_str() );
+    itktools::SetCachedImageIOBase( reader.GetPointer() );
 
     /** Define a helper map. */
     std::map< std::string, UnaryFunctorEnum> stringToEnumMap;
@@ -134,15 +138,25 @@ public:
     typename itk::InPlaceImageFilter<InputImageType, OutputImageType>::Pointer unaryFilter
       = unaryFunctorFactory.GetFilter( stringToEnumMap[ this->m_UnaryOperatorName ], this->m_Arguments );
 
-    /** Connect the pipeline. */
+    /** Connect the pipeline. The output reuses the input buffer, if the
+     * types are the same. */
     unaryFilter->SetInput( reader->GetOutput() );
+    unaryFilter->InPlaceOn();
+    const bool inPlace
+      = dynamic_cast<OutputImageType *>( reader->GetOutput() ) != 0;
 
     /** Write the image to disk */
     typename WriterType::Pointer writer = WriterType::New();
     writer->SetFileName( this->m_OutputFileName.c_str() );
     writer->SetInput( unaryFilter->GetOutput() );
     writer->SetUseCompression( this->m_UseCompression );
-    writer->Update();
+    this->SetStreamingOnWriter( writer.GetPointer(),
+      inPlace ? 0.0 : sizeof( InputPixelType ) );
+
+    this->ObserveProcess( reader.GetPointer(), "read" );
+    this->ObserveProcess( unaryFilter.GetPointer(), "unary operator" );
+    this->ObserveProcess( writer.GetPointer(), "write" );
+    this->UpdateWriter( writer.GetPointer() );
 
   } // end Run()
 
@@ -28,7 +28,7 @@
  * ******************* CheckOps *******************
  */
 
-int CheckOps( std::string & ops, bool isInteger )
+static int CheckOps( std::string & ops, bool isInteger )
 {
   /** A map to store if there are integer and double versions
    * of the functor. */
@@ -89,7 +89,7 @@ int CheckOps( std::string & ops, bool isInteger )
  * ******************* OperatorNeedsArgument *******************
  */
 
-bool OperatorNeedsArgument( const std::string & ops )
+static bool OperatorNeedsArgument( const std::string & ops )
 {
   /** A map to store if OperatorNeedsArgument. */
   std::map< std::string, bool > operatorMap;
@@ -133,7 +133,7 @@ bool OperatorNeedsArgument( const std::string & ops )
  * ******************* CreateOutputFileName *******************
  */
 
-void CreateOutputFileName( const std::string & inputFileName,
+static void CreateOutputFileName( const std::string & inputFileName,
   std::string & outputFileName,
   const std::string & ops, const std::string & arg )
 {
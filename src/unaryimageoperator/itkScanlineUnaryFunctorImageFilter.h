@@ -0,0 +1,92 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkScanlineUnaryFunctorImageFilter_h_
+#define __itkScanlineUnaryFunctorImageFilter_h_
+
+#include "itkUnaryFunctorImageFilter.h"
+
+namespace itk
+{
+
+/** \class ScanlineUnaryFunctorImageFilter
+ * \brief A UnaryFunctorImageFilter that applies the functor to runs of
+ * contiguous pixels.
+ *
+ * Instead of an iterator per pixel, the functor is applied in a plain
+ * loop over raw pointers, out[ i ] = functor( in[ i ] ), that the compiler
+ * vectorizes for the arithmetic functors. The loop runs over the longest
+ * stretch of memory that is contiguous in both the input and the output
+ * buffer: a scanline in general, and the whole region of a thread when
+ * the regions span the buffers in all but the last dimension. The
+ * functor is copied per thread, so that its arguments are kept in
+ * registers. The loop is also compiled for AVX2 and AVX-512, and the
+ * variant of the CPU is selected at run time, see itktools::SIMDDispatch.
+ *
+ * The result is the same as that of UnaryFunctorImageFilter. This filter
+ * is for itk::Image only, whose pixels are stored contiguously.
+ *
+ * \ingroup IntensityImageFilters MultiThreaded
+ */
+
+template< class TInputImage, class TOutputImage, class TFunction >
+class ITK_EXPORT ScanlineUnaryFunctorImageFilter :
+  public UnaryFunctorImageFilter< TInputImage, TOutputImage, TFunction >
+{
+public:
+  /** Standard class typedefs. */
+  typedef ScanlineUnaryFunctorImageFilter   Self;
+  typedef UnaryFunctorImageFilter<
+    TInputImage, TOutputImage, TFunction >  Superclass;
+  typedef SmartPointer<Self>                Pointer;
+  typedef SmartPointer<const Self>          ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( ScanlineUnaryFunctorImageFilter, UnaryFunctorImageFilter );
+
+  /** Typedefs. */
+  typedef typename Superclass::OutputImageRegionType  OutputImageRegionType;
+  typedef typename Superclass::FunctorType            FunctorType;
+  typedef typename TInputImage::PixelType             InputPixelType;
+  typedef typename TOutputImage::PixelType            OutputPixelType;
+
+  itkStaticConstMacro( ImageDimension, unsigned int, TOutputImage::ImageDimension );
+
+protected:
+  ScanlineUnaryFunctorImageFilter() {};
+  virtual ~ScanlineUnaryFunctorImageFilter() {};
+
+  /** Apply the functor to the runs of contiguous pixels of the region. */
+  void ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+    ThreadIdType threadId );
+
+private:
+  ScanlineUnaryFunctorImageFilter( const Self & ); // purposely not implemented
+  void operator=( const Self & );                  // purposely not implemented
+
+}; // end class ScanlineUnaryFunctorImageFilter
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkScanlineUnaryFunctorImageFilter.txx"
+#endif
+
+#endif // end #ifndef __itkScanlineUnaryFunctorImageFilter_h_
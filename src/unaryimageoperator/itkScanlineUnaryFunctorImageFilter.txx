@@ -0,0 +1,141 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkScanlineUnaryFunctorImageFilter_txx_
+#define __itkScanlineUnaryFunctorImageFilter_txx_
+
+#include "itkScanlineUnaryFunctorImageFilter.h"
+#include "itkProgressReporter.h"
+#include "ITKToolsSIMD.h"
+
+namespace itk
+{
+
+/**
+ * ******************* ScanlineUnaryFunctorRun *******************
+ */
+
+/** The loop over a run, and its variants for the instruction sets; the
+ * functor is inlined into each of them. */
+template< class TFunction, class TInputPixel, class TOutputPixel >
+inline void ScanlineUnaryFunctorRun( TFunction & functor,
+  const TInputPixel * in, TOutputPixel * out, const SizeValueType runLength )
+{
+  for( SizeValueType i = 0; i < runLength; ++i )
+  {
+    out[ i ] = functor( in[ i ] );
+  }
+} // end ScanlineUnaryFunctorRun()
+
+#ifdef ITKTOOLS_SIMD_TARGETS
+template< class TFunction, class TInputPixel, class TOutputPixel >
+ITKTOOLS_TARGET_AVX2 void ScanlineUnaryFunctorRunAVX2( TFunction & functor,
+  const TInputPixel * in, TOutputPixel * out, const SizeValueType runLength )
+{
+  ITKTOOLS_SIMD_BEGIN
+  ScanlineUnaryFunctorRun( functor, in, out, runLength );
+} // end ScanlineUnaryFunctorRunAVX2()
+
+template< class TFunction, class TInputPixel, class TOutputPixel >
+ITKTOOLS_TARGET_AVX512 void ScanlineUnaryFunctorRunAVX512( TFunction & functor,
+  const TInputPixel * in, TOutputPixel * out, const SizeValueType runLength )
+{
+  ITKTOOLS_SIMD_BEGIN
+  ScanlineUnaryFunctorRun( functor, in, out, runLength );
+} // end ScanlineUnaryFunctorRunAVX512()
+#endif
+
+
+/**
+ * ******************* ThreadedGenerateData *******************
+ */
+
+template< class TInputImage, class TOutputImage, class TFunction >
+void
+ScanlineUnaryFunctorImageFilter< TInputImage, TOutputImage, TFunction >
+::ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+  ThreadIdType threadId )
+{
+  typedef typename OutputImageRegionType::SizeType    SizeType;
+  typedef typename OutputImageRegionType::IndexType   IndexType;
+
+  const TInputImage * inputPtr = this->GetInput();
+  TOutputImage * outputPtr = this->GetOutput( 0 );
+
+  const SizeType size = outputRegionForThread.GetSize();
+  const SizeType inputSize = inputPtr->GetBufferedRegion().GetSize();
+  const SizeType outputSize = outputPtr->GetBufferedRegion().GetSize();
+  if( outputRegionForThread.GetNumberOfPixels() == 0 ) return;
+
+  /** The run of contiguous pixels: the region spans both buffers in the
+   * dimensions below runDimension. */
+  SizeValueType runLength = size[ 0 ];
+  unsigned int runDimension = 0;
+  while( runDimension + 1 < ImageDimension
+    && size[ runDimension ] == inputSize[ runDimension ]
+    && size[ runDimension ] == outputSize[ runDimension ] )
+  {
+    ++runDimension;
+    runLength *= size[ runDimension ];
+  }
+  const SizeValueType numberOfRuns
+    = outputRegionForThread.GetNumberOfPixels() / runLength;
+
+  /** A copy of the functor, local to this thread. */
+  FunctorType functor = this->GetFunctor();
+  ProgressReporter progress( this, threadId, numberOfRuns );
+
+  /** The variant of the loop for the instruction set of this CPU. */
+  typedef void (*RunFunctionType)( FunctorType &,
+    const InputPixelType *, OutputPixelType *, const SizeValueType );
+  itktools::SIMDDispatch< RunFunctionType > dispatch(
+    &ScanlineUnaryFunctorRun< FunctorType, InputPixelType, OutputPixelType > );
+#ifdef ITKTOOLS_SIMD_TARGETS
+  dispatch.Set( itktools::SIMDAVX2,
+    &ScanlineUnaryFunctorRunAVX2< FunctorType, InputPixelType, OutputPixelType > );
+  dispatch.Set( itktools::SIMDAVX512,
+    &ScanlineUnaryFunctorRunAVX512< FunctorType, InputPixelType, OutputPixelType > );
+#endif
+  const RunFunctionType run = dispatch.Get();
+
+  IndexType index = outputRegionForThread.GetIndex();
+  const IndexType start = index;
+  for( SizeValueType r = 0; r < numberOfRuns; ++r )
+  {
+    const InputPixelType * in
+      = inputPtr->GetBufferPointer() + inputPtr->ComputeOffset( index );
+    OutputPixelType * out
+      = outputPtr->GetBufferPointer() + outputPtr->ComputeOffset( index );
+    run( functor, in, out, runLength );
+    progress.CompletedPixel();
+
+    /** The start of the next run. */
+    for( unsigned int d = runDimension + 1; d < ImageDimension; ++d )
+    {
+      if( ++index[ d ] < start[ d ] + static_cast<OffsetValueType>( size[ d ] ) )
+      {
+        break;
+      }
+      index[ d ] = start[ d ];
+    }
+  }
+
+} // end ThreadedGenerateData()
+
+} // end namespace itk
+
+#endif // end #ifndef __itkScanlineUnaryFunctorImageFilter_txx_
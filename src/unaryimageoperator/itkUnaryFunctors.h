@@ -20,6 +20,7 @@
 
 #include "vnl/vnl_math.h"
 #include "itkNumericTraits.h"
+#include "itkScanlineUnaryFunctorImageFilter.h"
 
 /** All available unary operators. */
 enum UnaryFunctorEnum{ PLUS, RMINUS, LMINUS, TIMES, LDIVIDE, RDIVIDE,
@@ -32,7 +33,26 @@ namespace itk {
 
 namespace Functor {
 
-/** Arithmetic functors which use m_Argument. */
+/** Cast a floating point result to the output type, clamped to the range
+ * of the output type if that is an integer type. Integer results are
+ * cast as is. The clamping compiles to min/max instructions, so that it
+ * does not keep the loops of ScanlineUnaryFunctorImageFilter from being
+ * vectorized.
+ */
+template< class TOutput, class TValue >
+inline TOutput SaturateCast( const TValue & value )
+{
+  if( NumericTraits<TOutput>::is_integer && !NumericTraits<TValue>::is_integer )
+  {
+    const TValue lo = static_cast<TValue>( NumericTraits<TOutput>::NonpositiveMin() );
+    const TValue hi = static_cast<TValue>( NumericTraits<TOutput>::max() );
+    return static_cast<TOutput>( value < lo ? lo : ( value > hi ? hi : value ) );
+  }
+  return static_cast<TOutput>( value );
+}
+
+/** Arithmetic functors which use m_Argument. The results of PLUS, RMINUS,
+ * LMINUS, TIMES, RDIVIDE, LDIVIDE and LINEAR saturate, see SaturateCast. */
 template< class TInput, class TArgument=TInput, class TOutput=TInput >
 class PLUS
 {
@@ -41,7 +61,7 @@ public:
   ~PLUS() {};
   inline TOutput operator()( const TInput & A )
   {
-    return static_cast<TOutput>( A + this->m_Argument );
+    return SaturateCast<TOutput>( A + this->m_Argument );
   }
   void SetArgument( TArgument arg ){ this->m_Argument = arg; };
 private:
@@ -56,7 +76,7 @@ public:
   ~RMINUS() {};
   inline TOutput operator()( const TInput & A )
   {
-    return static_cast<TOutput>( A - this->m_Argument ); //==A+(-Arg)
+    return SaturateCast<TOutput>( A - this->m_Argument ); //==A+(-Arg)
   }
   void SetArgument( TArgument arg ){ this->m_Argument = arg; };
 private:
@@ -71,7 +91,7 @@ public:
   ~LMINUS() {};
   inline TOutput operator()( const TInput & A )
   {
-    return static_cast<TOutput>( this->m_Argument - A );
+    return SaturateCast<TOutput>( this->m_Argument - A );
   }
   void SetArgument( TArgument arg ){ this->m_Argument = arg; };
 private:
@@ -86,7 +106,7 @@ public:
   ~TIMES() {};
   inline TOutput operator()( const TInput & A )
   {
-    return static_cast<TOutput>( A * this->m_Argument );
+    return SaturateCast<TOutput>( A * this->m_Argument );
   }
   void SetArgument( TArgument arg ){ this->m_Argument = arg; };
 private:
@@ -101,7 +121,7 @@ public:
   ~RDIVIDE() {};
   inline TOutput operator()( const TInput & A )
   {
-    return static_cast<TOutput>( A / this->m_Argument );
+    return SaturateCast<TOutput>( A / this->m_Argument );
   }
   void SetArgument( TArgument arg ){ this->m_Argument = arg; };
 private:
@@ -116,7 +136,7 @@ public:
   ~LDIVIDE() {};
   inline TOutput operator()( const TInput & A )
   {
-    return static_cast<TOutput>( this->m_Argument / A );
+    return SaturateCast<TOutput>( this->m_Argument / A );
   }
   void SetArgument( TArgument arg ){ this->m_Argument = arg; };
 private:
@@ -561,7 +581,7 @@ public:
   ~LINEAR() {};
   inline TOutput operator()( const TInput & A )
   {
-    return static_cast<TOutput>( this->m_Argument1 * A + this->m_Argument2 );
+    return SaturateCast<TOutput>( this->m_Argument1 * A + this->m_Argument2 );
   }
   void SetArgument1( TArgument arg ){ this->m_Argument1 = arg; };
   void SetArgument2( TArgument arg ){ this->m_Argument2 = arg; };
@@ -612,7 +632,7 @@ struct UnaryFunctorFactory
     /** Create UnaryFunctorImageFilter with requested functor and set arguments. */
     if( filterType == PLUS )
     {
-      typedef itk::UnaryFunctorImageFilter< TInputImage, TOutputImage,
+      typedef itk::ScanlineUnaryFunctorImageFilter< TInputImage, TOutputImage,
         itk::Functor::PLUS< InputPixelType, TArgument, OutputPixelType > >  FilterType;
       typename FilterType::Pointer filter = FilterType::New();
       filter->GetFunctor().SetArgument( argument );
@@ -620,7 +640,7 @@ struct UnaryFunctorFactory
     }
     else if( filterType == RMINUS )
     {
-      typedef itk::UnaryFunctorImageFilter< TInputImage, TOutputImage,
+      typedef itk::ScanlineUnaryFunctorImageFilter< TInputImage, TOutputImage,
         itk::Functor::RMINUS< InputPixelType, TArgument, OutputPixelType > >  FilterType;
       typename FilterType::Pointer filter = FilterType::New();
       filter->GetFunctor().SetArgument( argument );
@@ -628,7 +648,7 @@ struct UnaryFunctorFactory
     }
     else if( filterType == LMINUS )
     {
-      typedef itk::UnaryFunctorImageFilter< TInputImage, TOutputImage,
+      typedef itk::ScanlineUnaryFunctorImageFilter< TInputImage, TOutputImage,
         itk::Functor::LMINUS< InputPixelType, TArgument, OutputPixelType > >  FilterType;
       typename FilterType::Pointer filter = FilterType::New();
       filter->GetFunctor().SetArgument( argument );
@@ -636,7 +656,7 @@ struct UnaryFunctorFactory
     }
     else if( filterType == TIMES )
     {
-      typedef itk::UnaryFunctorImageFilter< TInputImage, TOutputImage,
+      typedef itk::ScanlineUnaryFunctorImageFilter< TInputImage, TOutputImage,
         itk::Functor::TIMES< InputPixelType, TArgument, OutputPixelType > >  FilterType;
       typename FilterType::Pointer filter = FilterType::New();
       filter->GetFunctor().SetArgument( argument );
@@ -644,7 +664,7 @@ struct UnaryFunctorFactory
     }
     else if( filterType == LDIVIDE )
     {
-      typedef itk::UnaryFunctorImageFilter< TInputImage, TOutputImage,
+      typedef itk::ScanlineUnaryFunctorImageFilter< TInputImage, TOutputImage,
         itk::Functor::LDIVIDE< InputPixelType, TArgument, OutputPixelType > >  FilterType;
       typename FilterType::Pointer filter = FilterType::New();
       filter->GetFunctor().SetArgument( argument );
@@ -652,7 +672,7 @@ struct UnaryFunctorFactory
     }
     else if( filterType == RDIVIDE )
     {
-      typedef itk::UnaryFunctorImageFilter< TInputImage, TOutputImage,
+      typedef itk::ScanlineUnaryFunctorImageFilter< TInputImage, TOutputImage,
         itk::Functor::RDIVIDE< InputPixelType, TArgument, OutputPixelType > >  FilterType;
       typename FilterType::Pointer filter = FilterType::New();
       filter->GetFunctor().SetArgument( argument );
@@ -660,7 +680,7 @@ struct UnaryFunctorFactory
     }
     else if( filterType == RMODINT )
     {
-      typedef itk::UnaryFunctorImageFilter< TInputImage, TOutputImage,
+      typedef itk::ScanlineUnaryFunctorImageFilter< TInputImage, TOutputImage,
         itk::Functor::RMODINT< InputPixelType, TArgument, OutputPixelType > >  FilterType;
       typename FilterType::Pointer filter = FilterType::New();
       filter->GetFunctor().SetArgument( argument );
@@ -668,7 +688,7 @@ struct UnaryFunctorFactory
     }
     else if( filterType == RMODDOUBLE )
     {
-      typedef itk::UnaryFunctorImageFilter< TInputImage, TOutputImage,
+      typedef itk::ScanlineUnaryFunctorImageFilter< TInputImage, TOutputImage,
         itk::Functor::RMODDOUBLE< InputPixelType, TArgument, OutputPixelType > >  FilterType;
       typename FilterType::Pointer filter = FilterType::New();
       filter->GetFunctor().SetArgument( argument );
@@ -676,7 +696,7 @@ struct UnaryFunctorFactory
     }
     else if( filterType == LMODINT )
     {
-      typedef itk::UnaryFunctorImageFilter< TInputImage, TOutputImage,
+      typedef itk::ScanlineUnaryFunctorImageFilter< TInputImage, TOutputImage,
         itk::Functor::LMODINT< InputPixelType, TArgument, OutputPixelType > >  FilterType;
       typename FilterType::Pointer filter = FilterType::New();
       filter->GetFunctor().SetArgument( argument );
@@ -684,7 +704,7 @@ struct UnaryFunctorFactory
     }
     else if( filterType == LMODDOUBLE )
     {
-      typedef itk::UnaryFunctorImageFilter< TInputImage, TOutputImage,
+      typedef itk::ScanlineUnaryFunctorImageFilter< TInputImage, TOutputImage,
         itk::Functor::LMODDOUBLE< InputPixelType, TArgument, OutputPixelType > >  FilterType;
       typename FilterType::Pointer filter = FilterType::New();
       filter->GetFunctor().SetArgument( argument );
@@ -692,7 +712,7 @@ struct UnaryFunctorFactory
     }
     else if( filterType == NLOG )
     {
-      typedef itk::UnaryFunctorImageFilter< TInputImage, TOutputImage,
+      typedef itk::ScanlineUnaryFunctorImageFilter< TInputImage, TOutputImage,
         itk::Functor::NLOG< InputPixelType, TArgument, OutputPixelType > >  FilterType;
       typename FilterType::Pointer filter = FilterType::New();
       filter->GetFunctor().SetArgument( argument );
@@ -701,7 +721,7 @@ struct UnaryFunctorFactory
     /** In the following filters, the argument is always double */
     else if( filterType == RPOWER )
     {
-      typedef itk::UnaryFunctorImageFilter< TInputImage, TOutputImage,
+      typedef itk::ScanlineUnaryFunctorImageFilter< TInputImage, TOutputImage,
         itk::Functor::RPOWER< InputPixelType, double, OutputPixelType > >  FilterType;
       typename FilterType::Pointer filter = FilterType::New();
       filter->GetFunctor().SetArgument( argument );
@@ -709,7 +729,7 @@ struct UnaryFunctorFactory
     }
     else if( filterType == LPOWER )
     {
-      typedef itk::UnaryFunctorImageFilter< TInputImage, TOutputImage,
+      typedef itk::ScanlineUnaryFunctorImageFilter< TInputImage, TOutputImage,
         itk::Functor::LPOWER< InputPixelType, double, OutputPixelType > >  FilterType;
       typename FilterType::Pointer filter = FilterType::New();
       filter->GetFunctor().SetArgument( argument );
@@ -718,126 +738,126 @@ struct UnaryFunctorFactory
     /** The following filters do not use the argument at all.*/
     else if( filterType == NEG )
     {
-      typedef itk::UnaryFunctorImageFilter< TInputImage, TOutputImage,
+      typedef itk::ScanlineUnaryFunctorImageFilter< TInputImage, TOutputImage,
         itk::Functor::NEG< InputPixelType, TArgument, OutputPixelType > >  FilterType;
       typename FilterType::Pointer filter = FilterType::New();
       return filter.GetPointer();
     }
     else if( filterType == SIGNINT )
     {
-      typedef itk::UnaryFunctorImageFilter< TInputImage, TOutputImage,
+      typedef itk::ScanlineUnaryFunctorImageFilter< TInputImage, TOutputImage,
         itk::Functor::SIGNINT< InputPixelType, TArgument, OutputPixelType > >  FilterType;
       typename FilterType::Pointer filter = FilterType::New();
       return filter.GetPointer();
     }
     else if( filterType == SIGNDOUBLE )
     {
-      typedef itk::UnaryFunctorImageFilter< TInputImage, TOutputImage,
+      typedef itk::ScanlineUnaryFunctorImageFilter< TInputImage, TOutputImage,
         itk::Functor::SIGNDOUBLE< InputPixelType, TArgument, OutputPixelType > >  FilterType;
       typename FilterType::Pointer filter = FilterType::New();
       return filter.GetPointer();
     }
     else if( filterType == ABSINT )
     {
-      typedef itk::UnaryFunctorImageFilter< TInputImage, TOutputImage,
+      typedef itk::ScanlineUnaryFunctorImageFilter< TInputImage, TOutputImage,
         itk::Functor::ABSINT< InputPixelType, TArgument, OutputPixelType > >  FilterType;
       typename FilterType::Pointer filter = FilterType::New();
       return filter.GetPointer();
     }
     else if( filterType == ABSDOUBLE )
     {
-      typedef itk::UnaryFunctorImageFilter< TInputImage, TOutputImage,
+      typedef itk::ScanlineUnaryFunctorImageFilter< TInputImage, TOutputImage,
         itk::Functor::ABSDOUBLE< InputPixelType, TArgument, OutputPixelType > >  FilterType;
       typename FilterType::Pointer filter = FilterType::New();
       return filter.GetPointer();
     }
     else if( filterType == FLOOR )
     {
-      typedef itk::UnaryFunctorImageFilter< TInputImage, TOutputImage,
+      typedef itk::ScanlineUnaryFunctorImageFilter< TInputImage, TOutputImage,
         itk::Functor::FLOOR< InputPixelType, TArgument, OutputPixelType > >  FilterType;
       typename FilterType::Pointer filter = FilterType::New();
       return filter.GetPointer();
     }
     else if( filterType == CEIL )
     {
-      typedef itk::UnaryFunctorImageFilter< TInputImage, TOutputImage,
+      typedef itk::ScanlineUnaryFunctorImageFilter< TInputImage, TOutputImage,
         itk::Functor::CEIL< InputPixelType, TArgument, OutputPixelType > >  FilterType;
       typename FilterType::Pointer filter = FilterType::New();
       return filter.GetPointer();
     }
     else if( filterType == ROUND )
     {
-      typedef itk::UnaryFunctorImageFilter< TInputImage, TOutputImage,
+      typedef itk::ScanlineUnaryFunctorImageFilter< TInputImage, TOutputImage,
         itk::Functor::ROUND< InputPixelType, TArgument, OutputPixelType > >  FilterType;
       typename FilterType::Pointer filter = FilterType::New();
       return filter.GetPointer();
     }
     else if( filterType == LN )
     {
-      typedef itk::UnaryFunctorImageFilter< TInputImage, TOutputImage,
+      typedef itk::ScanlineUnaryFunctorImageFilter< TInputImage, TOutputImage,
         itk::Functor::LN< InputPixelType, TArgument, OutputPixelType > >  FilterType;
       typename FilterType::Pointer filter = FilterType::New();
       return filter.GetPointer();
     }
     else if( filterType == LOG10 )
     {
-      typedef itk::UnaryFunctorImageFilter< TInputImage, TOutputImage,
+      typedef itk::ScanlineUnaryFunctorImageFilter< TInputImage, TOutputImage,
         itk::Functor::LOG10< InputPixelType, TArgument, OutputPixelType > >  FilterType;
       typename FilterType::Pointer filter = FilterType::New();
       return filter.GetPointer();
     }
     else if( filterType == EXP )
     {
-      typedef itk::UnaryFunctorImageFilter< TInputImage, TOutputImage,
+      typedef itk::ScanlineUnaryFunctorImageFilter< TInputImage, TOutputImage,
         itk::Functor::EXP< InputPixelType, TArgument, OutputPixelType > >  FilterType;
       typename FilterType::Pointer filter = FilterType::New();
       return filter.GetPointer();
     }
     else if( filterType == SIN )
     {
-      typedef itk::UnaryFunctorImageFilter< TInputImage, TOutputImage,
+      typedef itk::ScanlineUnaryFunctorImageFilter< TInputImage, TOutputImage,
         itk::Functor::SIN< InputPixelType, TArgument, OutputPixelType > >  FilterType;
       typename FilterType::Pointer filter = FilterType::New();
       return filter.GetPointer();
     }
     else if( filterType == COS )
     {
-      typedef itk::UnaryFunctorImageFilter< TInputImage, TOutputImage,
+      typedef itk::ScanlineUnaryFunctorImageFilter< TInputImage, TOutputImage,
         itk::Functor::COS< InputPixelType, TArgument, OutputPixelType > >  FilterType;
       typename FilterType::Pointer filter = FilterType::New();
       return filter.GetPointer();
     }
     else if( filterType == TAN )
     {
-      typedef itk::UnaryFunctorImageFilter< TInputImage, TOutputImage,
+      typedef itk::ScanlineUnaryFunctorImageFilter< TInputImage, TOutputImage,
         itk::Functor::TAN< InputPixelType, TArgument, OutputPixelType > >  FilterType;
       typename FilterType::Pointer filter = FilterType::New();
       return filter.GetPointer();
     }
     else if( filterType == ARCSIN )
     {
-      typedef itk::UnaryFunctorImageFilter< TInputImage, TOutputImage,
+      typedef itk::ScanlineUnaryFunctorImageFilter< TInputImage, TOutputImage,
         itk::Functor::ARCSIN< InputPixelType, TArgument, OutputPixelType > >  FilterType;
       typename FilterType::Pointer filter = FilterType::New();
       return filter.GetPointer();
     }
     else if( filterType == ARCCOS )
     {
-      typedef itk::UnaryFunctorImageFilter< TInputImage, TOutputImage,
+      typedef itk::ScanlineUnaryFunctorImageFilter< TInputImage, TOutputImage,
         itk::Functor::ARCCOS< InputPixelType, TArgument, OutputPixelType > >  FilterType;
       typename FilterType::Pointer filter = FilterType::New();
       return filter.GetPointer();
     }
     else if( filterType == ARCTAN )
     {
-      typedef itk::UnaryFunctorImageFilter< TInputImage, TOutputImage,
+      typedef itk::ScanlineUnaryFunctorImageFilter< TInputImage, TOutputImage,
         itk::Functor::ARCTAN< InputPixelType, TArgument, OutputPixelType > >  FilterType;
       typename FilterType::Pointer filter = FilterType::New();
       return filter.GetPointer();
     }
     else if( filterType == LINEAR )
     {
-      typedef itk::UnaryFunctorImageFilter< TInputImage, TOutputImage,
+      typedef itk::ScanlineUnaryFunctorImageFilter< TInputImage, TOutputImage,
         itk::Functor::LINEAR< InputPixelType, double, OutputPixelType > >  FilterType;
       typename FilterType::Pointer filter = FilterType::New();
       filter->GetFunctor().SetArgument1( argument1 );
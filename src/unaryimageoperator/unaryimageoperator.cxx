@@ -27,6 +27,7 @@
 #include "itkCommandLineArgumentParser.h"
 #include "UnaryImageOperatorMainHelper.h"
 #include "UnaryImageOperatorHelper.h"
+#include "ITKToolsModules.h"
 
 
 /**
@@ -57,6 +58,11 @@ std::string GetHelpString( void )
     << "  [-out]   outputFilename, default in + <ops> + <arg> + .mhd\n"
     << "  [-z]     compression flag; if provided, the output image is compressed\n"
     << "  [-opct]  outputPixelComponentType, default: same as input image\n"
+    << "The results of +, -, *, / and LINEAR are clamped to the range of an\n"
+    << "integer output type.\n"
+    << "If the output component type equals the input, the output is\n"
+    << "computed in place. With -memoryLimit or -streams the image is\n"
+    << "processed in pieces.\n"
     << "Supported: 2D, 3D, (unsigned) char, (unsigned) short, (unsigned) int, float.";
   return ss.str();
 
@@ -178,6 +184,11 @@ int main( int argc, char **argv )
 
   try
   {
+#ifdef ITKTOOLS_USE_MODULES
+    // only load the instantiation of this combination
+    filter = itktools::NewFromModule< ITKToolsUnaryImageOperatorBase >(
+      "unaryimageoperator", dim, inputType, outputType );
+#else
     // now call all possible template combinations.
     if( !filter ) filter = ITKToolsUnaryImageOperator< 2, int, unsigned char >::New( dim, inputType, outputType );
     if( !filter ) filter = ITKToolsUnaryImageOperator< 2, int, char >::New( dim, inputType, outputType );
@@ -212,6 +223,7 @@ int main( int argc, char **argv )
     if( !filter ) filter = ITKToolsUnaryImageOperator< 3, double, int >::New( dim, inputType, outputType );
     if( !filter ) filter = ITKToolsUnaryImageOperator< 3, double, float >::New( dim, inputType, outputType );
 #endif
+#endif // ITKTOOLS_USE_MODULES
     /** Check if filter was instantiated. */
     bool supported = itktools::IsFilterSupportedCheck( filter, dim, inputType, outputType );
     if( !supported ) return EXIT_FAILURE;
@@ -223,6 +235,7 @@ int main( int argc, char **argv )
     filter->m_UseCompression = useCompression;
     filter->m_Arguments = arguments;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
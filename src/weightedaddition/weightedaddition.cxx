@@ -42,6 +42,11 @@ std::string GetHelpString( void )
     << "  -in      inputFilenames\n"
     << "  -w       weightFilenames\n"
     << "  -out     outputFilename; always written as float\n"
+    << "The weighted inputs are added one at a time to the output, while the next input\n"
+    << "and weight are read on a background thread.\n"
+    << "With -streams or -memoryLimit the images are processed in slabs along the last\n"
+    << "dimension, reading only one slab of every input at a time; this requires input\n"
+    << "and output formats that support streaming, like uncompressed mhd.\n"
     << "Supported: 2D, 3D, (unsigned) short, (unsigned) char, float.";
 
   return ss.str();
@@ -120,6 +125,7 @@ int main( int argc, char **argv )
     filter->m_WeightFileNames = weightFileNames;
     filter->m_OutputFileName = outputFileName;
 
+    filter->ReadCommonArguments( parser );
     filter->Run();
 
     delete filter;
@@ -21,10 +21,9 @@
 #include "ITKToolsBase.h"
 
 #include "itkImage.h"
-#include "itkImageFileReader.h"
-#include "itkImageFileWriter.h"
-#include "itkNaryAddImageFilter.h"
-#include "itkMultiplyImageFilter.h"
+#include "itkMultiThreader.h"
+#include <string>
+#include <vector>
 
 
 /** \class ITKToolsWeightedAdditionBase
@@ -49,6 +48,9 @@ public:
   std::vector<std::string> m_WeightFileNames;
   std::string m_OutputFileName;
 
+  /** This tool supports streaming, by processing the images in slabs. */
+  virtual bool GetSupportsStreaming( void ) const { return true; }
+
 }; // end class ITKToolsWeightedAdditionBase
 
 
@@ -69,57 +71,58 @@ public:
   ITKToolsWeightedAddition(){};
   ~ITKToolsWeightedAddition(){};
 
+  /** Typedef. */
+  typedef itk::Image< TComponentType, VDimension >  InputImageType;
+  typedef typename InputImageType::Pointer          InputImagePointer;
+  typedef typename InputImageType::RegionType       RegionType;
+
   /** Run function. */
-  void Run( void )
+  void Run( void );
+
+protected:
+
+  /** The arguments of the thread that reads the next input and weight. */
+  struct ReadStruct
+  {
+    std::string       m_FileName;
+    std::string       m_WeightFileName;
+    RegionType        m_Region;
+    InputImagePointer m_Image;
+    InputImagePointer m_Weight;
+    std::string       m_ErrorMessage;
+  };
+
+  /** The arguments of the threads that accumulate one weighted input. */
+  struct AccumulateStruct
   {
-    /** TYPEDEF's. */
-    typedef itk::Image< TComponentType, VDimension >      InputImageType;
-    typedef itk::ImageFileReader< InputImageType >        ReaderType;
-    typedef itk::MultiplyImageFilter<
-      InputImageType, InputImageType, InputImageType>     MultiplierType;
-    typedef itk::NaryAddImageFilter<
-      InputImageType, InputImageType >                    AdderType;
-    typedef itk::ImageFileWriter< InputImageType >        WriterType;
-    typedef typename InputImageType::PixelType            PixelType;
-    typedef typename ReaderType::Pointer                  ReaderPointer;
-    typedef typename MultiplierType::Pointer              MultiplierPointer;
-    typedef typename AdderType::Pointer                   AdderPointer;
-    typedef typename WriterType::Pointer                  WriterPointer;
-
-    /** DECLARATION'S. */
-    unsigned int nrInputs = this->m_InputFileNames.size();
-    if( this->m_WeightFileNames.size() != nrInputs )
-    {
-      itkGenericExceptionMacro( << "ERROR: Number of weight images does not equal number of input images!" );
-    }
-
-    std::vector< ReaderPointer > inReaders( nrInputs );
-    std::vector< ReaderPointer > wReaders( nrInputs );
-    std::vector< MultiplierPointer > multipliers( nrInputs );
-    AdderPointer adder = AdderType::New();
-    WriterPointer writer = WriterType::New();
-
-    for( unsigned int i = 0; i < nrInputs; ++i )
-    {
-      inReaders[ i ] = ReaderType::New();
-      inReaders[ i ]->SetFileName( this->m_InputFileNames[ i ].c_str() );
-      wReaders[ i ] = ReaderType::New();
-      wReaders[ i ]->SetFileName( this->m_WeightFileNames[ i ].c_str() );
-      multipliers[ i ] = MultiplierType::New();
-      multipliers[ i ]->SetInput(0, inReaders[ i ]->GetOutput() );
-      multipliers[ i ]->SetInput(1, wReaders[ i ]->GetOutput() );
-      multipliers[ i ]->InPlaceOn();
-      adder->SetInput(i, multipliers[ i ]->GetOutput() );
-    }
-
-    /** Write the output image. */
-    writer->SetFileName( this->m_OutputFileName.c_str() );
-    writer->SetInput( adder->GetOutput() );
-    writer->Update();
-
-  } // end Run()
+    const TComponentType * m_Input;
+    const TComponentType * m_Weight;
+    TComponentType *       m_Output;
+    std::size_t            m_NumberOfPixels;
+  };
+
+  /** Compute the weighted sum of one slab of the images. */
+  void ComputeSlab( const RegionType & region, const RegionType & slab,
+    InputImageType * output );
+
+  /** Write one slab of the output image. */
+  void WriteSlab( InputImageType * image, const RegionType & slab,
+    const bool streaming );
+
+  /** Read a region of an image, disconnected from its reader. */
+  static InputImagePointer ReadInputImage( const std::string & fileName,
+    const RegionType & region );
+
+  /** The pixels of a slab in the buffer of an image. */
+  static const TComponentType * GetSlabBuffer( const InputImageType * image,
+    const RegionType & slab );
+
+  /** Thread callbacks. */
+  static ITK_THREAD_RETURN_TYPE ReadThreaderCallback( void * arg );
+  static ITK_THREAD_RETURN_TYPE AccumulateThreaderCallback( void * arg );
 
 }; // end class ITKToolsWeightedAddition
 
+#include "weightedaddition.hxx"
 
 #endif // end #ifndef __weightedaddition_h_
@@ -0,0 +1,341 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __weightedaddition_hxx_
+#define __weightedaddition_hxx_
+
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkMultiThreader.h"
+#include <itksys/SystemTools.hxx>
+
+/**
+ * ******************* ReadThreaderCallback *******************
+ *
+ * Reads a slab of the next input and of its weight on a background thread.
+ */
+
+template< unsigned int VDimension, class TComponentType >
+ITK_THREAD_RETURN_TYPE
+ITKToolsWeightedAddition< VDimension, TComponentType >
+::ReadThreaderCallback( void * arg )
+{
+  itk::MultiThreader::ThreadInfoStruct * info
+    = static_cast<itk::MultiThreader::ThreadInfoStruct *>( arg );
+  ReadStruct * data = static_cast<ReadStruct *>( info->UserData );
+
+  try
+  {
+    data->m_Image = ReadInputImage( data->m_FileName, data->m_Region );
+    data->m_Weight = ReadInputImage( data->m_WeightFileName, data->m_Region );
+  }
+  catch( itk::ExceptionObject & excp )
+  {
+    data->m_ErrorMessage = excp.GetDescription();
+  }
+  catch( std::exception & excp )
+  {
+    data->m_ErrorMessage = excp.what();
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end ReadThreaderCallback()
+
+
+/**
+ * ******************* ReadInputImage *******************
+ *
+ * Only the requested region is read, if the image format supports it.
+ */
+
+template< unsigned int VDimension, class TComponentType >
+typename ITKToolsWeightedAddition< VDimension, TComponentType >::InputImagePointer
+ITKToolsWeightedAddition< VDimension, TComponentType >
+::ReadInputImage( const std::string & fileName, const RegionType & region )
+{
+  typedef itk::ImageFileReader< InputImageType >        ReaderType;
+
+  typename ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( fileName.c_str() );
+  reader->UpdateOutputInformation();
+  if( reader->GetOutput()->GetLargestPossibleRegion().IsInside( region ) )
+  {
+    reader->GetOutput()->SetRequestedRegion( region );
+  }
+  reader->Update();
+  InputImagePointer image = reader->GetOutput();
+  image->DisconnectPipeline();
+  return image;
+
+} // end ReadInputImage()
+
+
+/**
+ * ******************* GetSlabBuffer *******************
+ *
+ * A slab spans the full image in all but the last dimension, so it is
+ * contiguous in the buffer of an image that contains it.
+ */
+
+template< unsigned int VDimension, class TComponentType >
+const TComponentType *
+ITKToolsWeightedAddition< VDimension, TComponentType >
+::GetSlabBuffer( const InputImageType * image, const RegionType & slab )
+{
+  const RegionType & buffered = image->GetBufferedRegion();
+  bool contiguous = buffered.IsInside( slab );
+  for( unsigned int d = 0; d + 1 < VDimension; ++d )
+  {
+    contiguous &= buffered.GetSize()[ d ] == slab.GetSize()[ d ];
+  }
+  if( !contiguous )
+  {
+    itkGenericExceptionMacro( << "ERROR: the buffered region of an input does not contain the slab "
+      << slab.GetIndex() << " " << slab.GetSize() );
+  }
+  return image->GetBufferPointer() + image->ComputeOffset( slab.GetIndex() );
+
+} // end GetSlabBuffer()
+
+
+/**
+ * ******************* AccumulateThreaderCallback *******************
+ *
+ * Adds one weighted input to the output, out += w * in. Every thread
+ * processes a contiguous part of the buffers.
+ */
+
+template< unsigned int VDimension, class TComponentType >
+ITK_THREAD_RETURN_TYPE
+ITKToolsWeightedAddition< VDimension, TComponentType >
+::AccumulateThreaderCallback( void * arg )
+{
+  itk::MultiThreader::ThreadInfoStruct * info
+    = static_cast<itk::MultiThreader::ThreadInfoStruct *>( arg );
+  const AccumulateStruct * data = static_cast<AccumulateStruct *>( info->UserData );
+
+  const std::size_t begin = data->m_NumberOfPixels * info->ThreadID / info->NumberOfThreads;
+  const std::size_t end = data->m_NumberOfPixels * ( info->ThreadID + 1 ) / info->NumberOfThreads;
+  const TComponentType * input = data->m_Input;
+  const TComponentType * weight = data->m_Weight;
+  TComponentType * output = data->m_Output;
+
+  for( std::size_t k = begin; k < end; ++k )
+  {
+    output[ k ] += weight[ k ] * input[ k ];
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end AccumulateThreaderCallback()
+
+
+/**
+ * ******************* Run *******************
+ *
+ * The images are processed in slabs along the last dimension, if
+ * streaming is requested: every slab is read from all inputs, summed,
+ * and written to the output, before the next slab is read.
+ */
+
+template< unsigned int VDimension, class TComponentType >
+void
+ITKToolsWeightedAddition< VDimension, TComponentType >
+::Run( void )
+{
+  /** TYPEDEF's. */
+  typedef itk::ImageFileReader< InputImageType >        ReaderType;
+
+  if( this->m_WeightFileNames.size() != this->m_InputFileNames.size() )
+  {
+    itkGenericExceptionMacro( << "ERROR: Number of weight images does not equal number of input images!" );
+  }
+
+  /** Get the region of the first image. */
+  typename ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( this->m_InputFileNames[ 0 ].c_str() );
+  reader->UpdateOutputInformation();
+  const RegionType region = reader->GetOutput()->GetLargestPossibleRegion();
+
+  /** Estimate the memory needed without streaming: the current and the
+   * prefetched input and weight, and the output.
+   */
+  const double bytesPerPixel = 5.0 * sizeof( TComponentType );
+  const double sizeInMB = region.GetNumberOfPixels() * bytesPerPixel / 1048576.0;
+
+  /** Determine the slabs. */
+  const unsigned int lastDimension = VDimension - 1;
+  const unsigned int lastSize = region.GetSize()[ lastDimension ];
+  unsigned int numberOfSlabs = this->GetNumberOfStreams( sizeInMB );
+  if( numberOfSlabs < 1 ) numberOfSlabs = 1;
+  if( numberOfSlabs > lastSize ) numberOfSlabs = lastSize;
+
+  /** The output is pasted slab by slab into a new file. */
+  const bool streaming = numberOfSlabs > 1;
+  if( streaming )
+  {
+    itksys::SystemTools::RemoveFile( this->m_OutputFileName.c_str() );
+  }
+
+  for( unsigned int s = 0; s < numberOfSlabs; ++s )
+  {
+    /** The slab spans the full image in all but the last dimension. */
+    const unsigned int begin = static_cast<unsigned int>(
+      static_cast<unsigned long long>( lastSize ) * s / numberOfSlabs );
+    const unsigned int end = static_cast<unsigned int>(
+      static_cast<unsigned long long>( lastSize ) * ( s + 1 ) / numberOfSlabs );
+    RegionType slab = region;
+    slab.SetIndex( lastDimension, region.GetIndex()[ lastDimension ] + begin );
+    slab.SetSize( lastDimension, end - begin );
+    if( streaming )
+    {
+      std::cout << "Processing slab " << s + 1 << " of " << numberOfSlabs << std::endl;
+    }
+
+    /** Create the output image, of the full size but with the slab only
+     * buffered. It is the only accumulator, for any number of inputs.
+     */
+    InputImagePointer output = InputImageType::New();
+    output->CopyInformation( reader->GetOutput() );
+    output->SetBufferedRegion( slab );
+    output->SetRequestedRegion( slab );
+    output->Allocate();
+    output->FillBuffer( itk::NumericTraits<TComponentType>::Zero );
+
+    this->ComputeSlab( region, slab, output );
+    this->WriteSlab( output, slab, streaming );
+  }
+
+} // end Run()
+
+
+/**
+ * ******************* ComputeSlab *******************
+ */
+
+template< unsigned int VDimension, class TComponentType >
+void
+ITKToolsWeightedAddition< VDimension, TComponentType >
+::ComputeSlab(
+  const RegionType & region,
+  const RegionType & slab,
+  InputImageType * output )
+{
+  const unsigned int nrInputs = this->m_InputFileNames.size();
+
+  /** Read the first input and weight. */
+  InputImagePointer image = ReadInputImage( this->m_InputFileNames[ 0 ], slab );
+  InputImagePointer weight = ReadInputImage( this->m_WeightFileNames[ 0 ], slab );
+
+  /** The arguments of the accumulation threads. */
+  AccumulateStruct accumulate;
+  accumulate.m_NumberOfPixels = slab.GetNumberOfPixels();
+  accumulate.m_Output = output->GetBufferPointer();
+
+  itk::MultiThreader::Pointer accumulator = itk::MultiThreader::New();
+  itk::MultiThreader::Pointer prefetcher = itk::MultiThreader::New();
+
+  /** Loop over all inputs. While an input is accumulated, the next input
+   * and weight are read on a background thread.
+   */
+  for( unsigned int i = 0; i < nrInputs; ++i )
+  {
+    /** Start reading the next input. */
+    ReadStruct next;
+    int prefetchThread = -1;
+    if( i + 1 < nrInputs )
+    {
+      next.m_FileName = this->m_InputFileNames[ i + 1 ];
+      next.m_WeightFileName = this->m_WeightFileNames[ i + 1 ];
+      next.m_Region = slab;
+      prefetchThread = prefetcher->SpawnThread( ReadThreaderCallback, &next );
+    }
+
+    /** Accumulate the current input, if it fits. */
+    std::string errorMessage = "";
+    if( image->GetLargestPossibleRegion().GetSize() != region.GetSize() )
+    {
+      errorMessage = "The size of " + this->m_InputFileNames[ i ] + " differs from the first image.";
+    }
+    else if( weight->GetLargestPossibleRegion().GetSize() != region.GetSize() )
+    {
+      errorMessage = "The size of " + this->m_WeightFileNames[ i ] + " differs from the first image.";
+    }
+    else
+    {
+      try
+      {
+        accumulate.m_Input = GetSlabBuffer( image, slab );
+        accumulate.m_Weight = GetSlabBuffer( weight, slab );
+        accumulator->SetSingleMethod( AccumulateThreaderCallback, &accumulate );
+        accumulator->SingleMethodExecute();
+      }
+      catch( itk::ExceptionObject & excp )
+      {
+        errorMessage = excp.GetDescription();
+      }
+    }
+
+    /** Wait for the next input. */
+    if( prefetchThread >= 0 )
+    {
+      prefetcher->TerminateThread( prefetchThread );
+      if( errorMessage == "" ) errorMessage = next.m_ErrorMessage;
+    }
+    if( errorMessage != "" )
+    {
+      itkGenericExceptionMacro( << "ERROR: " << errorMessage );
+    }
+    image = next.m_Image;
+    weight = next.m_Weight;
+  }
+
+} // end ComputeSlab()
+
+
+/**
+ * ******************* WriteSlab *******************
+ *
+ * When streaming, only the slab is pasted into the output file.
+ */
+
+template< unsigned int VDimension, class TComponentType >
+void
+ITKToolsWeightedAddition< VDimension, TComponentType >
+::WriteSlab(
+  InputImageType * image,
+  const RegionType & slab,
+  const bool streaming )
+{
+  typedef itk::ImageFileWriter< InputImageType >        WriterType;
+
+  typename WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName( this->m_OutputFileName.c_str() );
+  writer->SetInput( image );
+  if( streaming )
+  {
+    itk::ImageIORegion ioRegion( VDimension );
+    itk::ImageIORegionAdaptor< VDimension >::Convert(
+      slab, ioRegion, image->GetLargestPossibleRegion().GetIndex() );
+    writer->SetIORegion( ioRegion );
+  }
+  writer->Update();
+
+} // end WriteSlab()
+
+#endif // end #ifndef __weightedaddition_hxx_